@@ -8,7 +8,11 @@
 ######################################################################
 
 # [关键配置] 保留 axcontainer 用于支持 ActiveX (如读取 .xls)
-QT += core gui axcontainer svg printsupport core5compat concurrent
+QT += core gui axcontainer svg printsupport core5compat concurrent network
+
+# [硬件加速] QCustomPlot 的 OpenGL (FBO) 绘图路径；是否启用由系统设置决定，初始化失败时自动回退为软件绘图
+QT += opengl
+DEFINES += QCUSTOMPLOT_USE_OPENGL
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -30,19 +34,14 @@ win32: RC_ICONS = Resource/PWT.ico
 # 数学库链接
 unix: LIBS += -lm
 win32: LIBS += -lm
+win32: LIBS += -lopengl32
 
 # ----------------------------------------------------
 # 第三方库路径配置
 # ----------------------------------------------------
 
-# Eigen 矩阵库
-INCLUDEPATH += D:/08YYYXXX/eigen-3.3.8
-
-# Boost 库
-INCLUDEPATH += D:/08YYYXXX/boost_1_89_0
-
-# QXlsx Excel读写库
-include(D:/08YYYXXX/QXlsx-master/QXlsx/QXlsx.pri)
+# 计算核心 (求解器、导数、抽样与拟合；含 Eigen、Boost 路径)，与命令行批处理 cli/ 共用
+include(computecore.pri)
 
 # ----------------------------------------------------
 # 项目源文件配置
@@ -54,12 +53,18 @@ HEADERS += \
            chartsetting2.h \
            chartwidget.h \
            chartwindow.h \
+           columnexpression.h \
+           compactseries.h \
            datacalculate.h \
+           datachangeset.h \
            datacolumndialog.h \
+           dataexportservice.h \
            dataimportdialog.h \
            datasinglesheet.h \
+           datavalidator.h \
+           deconvolution.h \
+           fittingbatchdialog.h \
            fittingchart.h \
-           fittingcore.h \
            fittingdatadialog.h \
            fittingmultiples.h \
            fittingnewdialog.h \
@@ -67,14 +72,20 @@ HEADERS += \
            fittingparameterchart.h \
            fittingreport.h \
            fittingsamplingdialog.h \
+           gaugemonitordialog.h \
+           gaugestreamreader.h \
+           graphlod.h \
+           jointfitdialog.h \
+           jsonvectorcache.h \
            modelmanager.h \
            modelparameter.h \
+           modelpreviewpipeline.h \
            modelselect.h \
-           modelsolver01-06.h \
            mousezoom.h \
            newprojectdialog.h \
            paramselectdialog.h \
            mainwindow.h \
+           memorydiagnosticsdialog.h \
            monitorbtn.h \
            monitostatew.h \
            navbtn.h \
@@ -82,16 +93,27 @@ HEADERS += \
            plottingdialog2.h \
            plottingdialog3.h \
            plottingdialog4.h \
-           pressurederivativecalculator.h \
            pressurederivativecalculator1.h \
+           projectautosaver.h \
+           projecttablestore.h \
+           sensitivitystudy.h \
+           sensitivitystudydialog.h \
            settingswidget.h \
            qcustomplot.h \
+           sheetfilterproxy.h \
+           sheetundostack.h \
+           startupprofile.h \
            styleselectordialog.h \
+           texttablereader.h \
+           theorycurvecache.h \
+           timestampparser.h \
            wt_datawidget.h \
            wt_fittingwidget.h \
            wt_modelwidget.h \
            wt_plottingwidget.h \
-           wt_projectwidget.h
+           wt_projectwidget.h \
+           xlsxstream.h \
+           ziparchive.h
 
 FORMS += \
          chartsetting1.ui \
@@ -129,12 +151,17 @@ SOURCES += \
            chartsetting2.cpp \
            chartwidget.cpp \
            chartwindow.cpp \
+           columnexpression.cpp \
+           compactseries.cpp \
            datacalculate.cpp \
            datacolumndialog.cpp \
+           dataexportservice.cpp \
            dataimportdialog.cpp \
            datasinglesheet.cpp \
+           datavalidator.cpp \
+           deconvolution.cpp \
+           fittingbatchdialog.cpp \
            fittingchart.cpp \
-           fittingcore.cpp \
            fittingdatadialog.cpp \
            fittingmultiples.cpp \
            fittingnewdialog.cpp \
@@ -142,15 +169,21 @@ SOURCES += \
            fittingparameterchart.cpp \
            fittingreport.cpp \
            fittingsamplingdialog.cpp \
+           gaugemonitordialog.cpp \
+           gaugestreamreader.cpp \
+           graphlod.cpp \
+           jointfitdialog.cpp \
+           jsonvectorcache.cpp \
            modelmanager.cpp \
            modelparameter.cpp \
+           modelpreviewpipeline.cpp \
            modelselect.cpp \
-           modelsolver01-06.cpp \
            mousezoom.cpp \
            newprojectdialog.cpp \
            paramselectdialog.cpp \
            main.cpp \
            mainwindow.cpp \
+           memorydiagnosticsdialog.cpp \
            monitorbtn.cpp \
            monitostatew.cpp \
            navbtn.cpp \
@@ -158,16 +191,27 @@ SOURCES += \
            plottingdialog2.cpp \
            plottingdialog3.cpp \
            plottingdialog4.cpp \
-           pressurederivativecalculator.cpp \
            pressurederivativecalculator1.cpp \
+           projectautosaver.cpp \
+           projecttablestore.cpp \
+           sensitivitystudy.cpp \
+           sensitivitystudydialog.cpp \
            settingswidget.cpp \
            qcustomplot.cpp \
+           sheetfilterproxy.cpp \
+           sheetundostack.cpp \
+           startupprofile.cpp \
            styleselectordialog.cpp \
+           texttablereader.cpp \
+           theorycurvecache.cpp \
+           timestampparser.cpp \
            wt_datawidget.cpp \
            wt_fittingwidget.cpp \
            wt_modelwidget.cpp \
            wt_plottingwidget.cpp \
-           wt_projectwidget.cpp
+           wt_projectwidget.cpp \
+           xlsxstream.cpp \
+           ziparchive.cpp
 
 RESOURCES += resource.qrc
 
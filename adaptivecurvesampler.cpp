@@ -0,0 +1,129 @@
+/*
+ * adaptivecurvesampler.cpp
+ * 文件作用: 显示用理论曲线的自适应布点实现文件
+ * 功能描述:
+ * 1. 偏离量：节点 i 的 ln y_i 与相邻节点 (i-1, i+1) 在 ln t 上线性插值之差，非正值处不参与判断。
+ * 2. 加密区间宽度不小于 Bourdet 步长的一半 (更密的点不再改变导数)，避免在数值反演噪声上无限加密；
+ *    距两端不足一个 Bourdet 步长的节点导数为单侧差分，不参与导数偏离量判断。
+ * 3. 新节点按时间顺序与已有节点归并，压力序列逐条合并，导数每轮按合并后的时间点重算。
+ */
+
+#include "adaptivecurvesampler.h"
+#include "pressurederivativecalculator.h"
+
+#include <QSettings>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 节点偏离相邻连线的距离 (双对数坐标)，三点中有非正值时返回 0
+double logLogDeviation(const QVector<double>& logT, const QVector<double>& y, int i)
+{
+    if (!(y[i - 1] > 0.0) || !(y[i] > 0.0) || !(y[i + 1] > 0.0)) return 0.0;
+    const double w = (logT[i] - logT[i - 1]) / (logT[i + 1] - logT[i - 1]);
+    const double line = (1.0 - w) * std::log(y[i - 1]) + w * std::log(y[i + 1]);
+    return std::abs(std::log(y[i]) - line);
+}
+
+} // namespace
+
+bool AdaptiveCurveSampler::isEnabledInSettings()
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    return settings.value("display/adaptiveSampling", true).toBool();
+}
+
+int AdaptiveCurveSampler::previewPointBudget()
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    static const int budgets[] = { 150, 300, 600 };
+    return budgets[qBound(0, settings.value("display/previewQuality", 1).toInt(), 2)];
+}
+
+QVector<ModelCurveData> AdaptiveCurveSampler::sample(const BatchEvaluator& evaluator, double tMin, double tMax,
+                                                     const AdaptiveSamplingOptions& options)
+{
+    if (!(tMin > 0.0) || !(tMax > tMin)) return QVector<ModelCurveData>();
+    const double decades = std::log10(tMax) - std::log10(tMin);
+    const int initialCount = std::max(3, int(std::ceil(decades * std::max(1, options.initialPointsPerDecade))) + 1);
+    QVector<double> t = ModelSolver01_06::generateLogTimeSteps(std::min(initialCount, std::max(3, options.maxPoints)),
+                                                               std::log10(tMin), std::log10(tMax));
+    const double minLogWidth = 0.5 * options.derivativeSpan;
+    QVector<ModelCurveData> initial = evaluator(t);
+    const int curveCount = initial.size();
+    if (curveCount == 0) return initial;
+
+    QVector<QVector<double>> pressure(curveCount), derivative(curveCount);
+    for (int c = 0; c < curveCount; ++c) pressure[c] = std::get<1>(initial[c]);
+
+    auto updateDerivatives = [&]() {
+        for (int c = 0; c < curveCount; ++c) {
+            derivative[c] = PressureDerivativeCalculator::calculateBourdetDerivative(t, pressure[c], options.derivativeSpan);
+        }
+    };
+    updateDerivatives();
+
+    for (int round = 0; round < options.maxRounds && t.size() < options.maxPoints; ++round) {
+        const int n = t.size();
+        QVector<double> logT(n);
+        for (int i = 0; i < n; ++i) logT[i] = std::log(t[i]);
+
+        // 各区间的加密优先级：两端节点偏离量的较大者 (全部曲线的压力与导数取最大)
+        QVector<double> priority(n - 1, 0.0);
+        for (int i = 1; i + 1 < n; ++i) {
+            const bool interior = logT[i - 1] - logT.first() >= options.derivativeSpan
+                                  && logT.last() - logT[i + 1] >= options.derivativeSpan;
+            double dev = 0.0;
+            for (int c = 0; c < curveCount; ++c) {
+                dev = std::max(dev, logLogDeviation(logT, pressure[c], i));
+                if (interior) dev = std::max(dev, logLogDeviation(logT, derivative[c], i));
+            }
+            if (dev <= options.tolerance) continue;
+            priority[i - 1] = std::max(priority[i - 1], dev);
+            priority[i] = std::max(priority[i], dev);
+        }
+
+        QVector<int> intervals;
+        for (int k = 0; k + 1 < n; ++k) {
+            if (priority[k] > 0.0 && logT[k + 1] - logT[k] > minLogWidth) intervals.append(k);
+        }
+        if (intervals.isEmpty()) break;
+        const int budget = options.maxPoints - n;
+        if (intervals.size() > budget) {
+            std::partial_sort(intervals.begin(), intervals.begin() + budget, intervals.end(),
+                              [&](int a, int b) { return priority[a] > priority[b]; });
+            intervals.resize(budget);
+            std::sort(intervals.begin(), intervals.end());
+        }
+
+        QVector<double> newT;
+        newT.reserve(intervals.size());
+        for (int k : intervals) newT.append(std::sqrt(t[k] * t[k + 1]));
+        QVector<ModelCurveData> added = evaluator(newT);
+        if (added.size() != curveCount) break;
+
+        // 按时间顺序归并 (新节点 j 位于区间 intervals[j] 内)
+        QVector<double> mergedT;
+        mergedT.reserve(n + newT.size());
+        QVector<QVector<double>> mergedP(curveCount);
+        for (int c = 0; c < curveCount; ++c) mergedP[c].reserve(n + newT.size());
+        int j = 0;
+        for (int i = 0; i < n; ++i) {
+            mergedT.append(t[i]);
+            for (int c = 0; c < curveCount; ++c) mergedP[c].append(pressure[c][i]);
+            if (j < intervals.size() && intervals[j] == i) {
+                mergedT.append(newT[j]);
+                for (int c = 0; c < curveCount; ++c) mergedP[c].append(std::get<1>(added[c]).value(j, 0.0));
+                ++j;
+            }
+        }
+        t = mergedT;
+        pressure = mergedP;
+        updateDerivatives();
+    }
+
+    QVector<ModelCurveData> results(curveCount);
+    for (int c = 0; c < curveCount; ++c) results[c] = std::make_tuple(t, pressure[c], derivative[c]);
+    return results;
+}
@@ -0,0 +1,47 @@
+/*
+ * adaptivecurvesampler.h
+ * 文件作用: 显示用理论曲线的自适应布点头文件
+ * 功能描述:
+ * 1. 从每个对数周期若干点的粗网格出发，逐轮在双对数曲率超限的区间对数中点加密：
+ *    节点偏离两侧相邻节点连线 (ln t - ln p 与 ln t - ln p') 的距离超过容差时，加密其两侧区间。
+ * 2. 每轮新增节点一次批量求值 (多参数组共享同一组时间点，敏感性分析的多条曲线统一加密)，
+ *    总点数不超过预算，预算不足时优先加密偏离最大的节点。
+ * 3. 导数在最终 (非均匀) 时间点上统一按 Bourdet 方法重算，与求解器一次性在这些时间点上计算的结果一致。
+ * 4. 设置项 display/adaptiveSampling (默认开启) 控制模型页与拟合双对数图是否使用自适应布点；
+ *    设置项 display/previewQuality (0 低 / 1 标准 / 2 高) 给出拟合页理论曲线的点数预算 (150 / 300 / 600)。
+ */
+
+#ifndef ADAPTIVECURVESAMPLER_H
+#define ADAPTIVECURVESAMPLER_H
+
+#include <QVector>
+#include <functional>
+#include "modelsolver01-06.h"
+
+// 自适应布点选项
+struct AdaptiveSamplingOptions {
+    int initialPointsPerDecade = 4; // 初始粗网格每个对数周期的点数
+    int maxPoints = 300;            // 总点数预算 (含初始网格)
+    double tolerance = 0.005;       // 双对数坐标下节点偏离相邻连线的容差 (约为相对误差)
+    int maxRounds = 10;             // 最大加密轮数
+    double derivativeSpan = 0.1;    // Bourdet 导数的计算步长 (与求解器一致)
+};
+
+class AdaptiveCurveSampler
+{
+public:
+    // 批量求值函数：给定时间点返回各参数组的理论曲线 (只使用压力序列，导数由采样器重算)
+    using BatchEvaluator = std::function<QVector<ModelCurveData>(const QVector<double>& t)>;
+
+    // 在 [tMin, tMax] 上为全部曲线选取共同的自适应时间点，返回各曲线 (顺序与求值函数的返回一致)
+    static QVector<ModelCurveData> sample(const BatchEvaluator& evaluator, double tMin, double tMax,
+                                          const AdaptiveSamplingOptions& options = AdaptiveSamplingOptions());
+
+    // 读取设置项 display/adaptiveSampling
+    static bool isEnabledInSettings();
+
+    // 读取设置项 display/previewQuality，返回显示曲线的点数预算
+    static int previewPointBudget();
+};
+
+#endif // ADAPTIVECURVESAMPLER_H
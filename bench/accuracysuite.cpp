@@ -0,0 +1,249 @@
+/*
+ * 文件名: accuracysuite.cpp
+ * 文件作用: 对照 MATLAB 参考曲线的精度回归用例实现文件
+ * 功能描述:
+ * 1. 基准配置 "reference" 为 Stehfest + 高精度且关闭全部快速路径 (渐近解、网格求值、类型曲线库)，与 MATLAB 原型的算法一致；
+ *    其余配置各自只改变一项，误差变化可直接归因。
+ * 2. Bessel 批量求值 (besselbatch.h) 是所有配置的共同路径，没有单独的开关，其精度由每个配置的误差共同覆盖。
+ * 3. 计时期间关闭 Laplace 缓存，每次都是完整计算；像函数求值次数按完整积分 / 早期渐近 / 晚期级数三种路径分别记录。
+ */
+
+#include "accuracysuite.h"
+#include "benchmarkrunner.h"
+#include "benchmarksuites.h"
+#include "laplacecache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cmath>
+
+namespace {
+
+QVector<double> toVector(const QJsonValue& value)
+{
+    QVector<double> out;
+    const QJsonArray array = value.toArray();
+    out.reserve(array.size());
+    for (const QJsonValue& v : array) out.append(v.isDouble() ? v.toDouble() : std::nan(""));
+    return out;
+}
+
+// 关闭渐近快速路径的 Stehfest 高精度设置
+SolverSettings referenceSettings()
+{
+    SolverSettings s = BenchmarkSuites::fixedSolverSettings();
+    s.asymptoticEarlyArgument = 0.0;
+    s.asymptoticLateArgument = 0.0;
+    return s;
+}
+
+QString formatError(double value)
+{
+    return QString::number(value, 'g', 3);
+}
+
+} // namespace
+
+// ---------------------- ReferenceCurve ----------------------
+
+bool ReferenceCurve::load(const QString& filePath, ReferenceCurve& curve, QString* errorMessage)
+{
+    auto fail = [&](const QString& message) {
+        if (errorMessage) *errorMessage = QString("%1: %2").arg(QFileInfo(filePath).fileName(), message);
+        return false;
+    };
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return fail("无法打开文件");
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) return fail(parseError.errorString());
+    const QJsonObject root = doc.object();
+
+    // 模型编号：1~6 或 "Model_1" ~ "Model_6"
+    int model = 0;
+    const QJsonValue modelValue = root.value("model");
+    if (modelValue.isDouble()) model = modelValue.toInt();
+    else model = modelValue.toString().section('_', -1).toInt();
+    if (model < 1 || model > 6) return fail("model 应为 1~6");
+
+    curve = ReferenceCurve();
+    curve.name = root.value("name").toString(QFileInfo(filePath).completeBaseName());
+    curve.modelType = ModelEngine::ModelType(model - 1);
+    const QJsonObject params = root.value("parameters").toObject();
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) curve.parameters.insert(it.key(), it.value().toDouble());
+    curve.t = toVector(root.value("t"));
+    curve.p = toVector(root.value("p"));
+    curve.d = toVector(root.value("dp"));
+    if (curve.t.isEmpty() || curve.p.size() != curve.t.size()) return fail("t 与 p 长度不一致或为空");
+    if (!curve.d.isEmpty() && curve.d.size() != curve.t.size()) return fail("dp 与 t 长度不一致");
+
+    const QJsonObject tolerance = root.value("tolerance").toObject();
+    curve.toleranceP = tolerance.value("p").toDouble(-1.0);
+    curve.toleranceD = tolerance.value("dp").toDouble(-1.0);
+    return true;
+}
+
+QList<ReferenceCurve> ReferenceCurve::loadDirectory(const QString& dirPath, QStringList* errors)
+{
+    QList<ReferenceCurve> curves;
+    const QDir dir(dirPath);
+    for (const QString& fileName : dir.entryList(QStringList() << "*.json", QDir::Files, QDir::Name)) {
+        ReferenceCurve curve;
+        QString error;
+        if (load(dir.filePath(fileName), curve, &error)) curves.append(curve);
+        else if (errors) errors->append(error);
+    }
+    return curves;
+}
+
+// ---------------------- AccuracySuite ----------------------
+
+QVector<AccuracyConfiguration> AccuracySuite::configurations(bool includeTypeCurveLibrary)
+{
+    QVector<AccuracyConfiguration> configs;
+    auto add = [&](const QString& name, const SolverSettings& settings, double tolP, double tolD) {
+        AccuracyConfiguration c;
+        c.name = name;
+        c.settings = settings;
+        c.maxLogErrorP = tolP;
+        c.maxLogErrorD = tolD;
+        configs.append(c);
+    };
+
+    const SolverSettings reference = referenceSettings();
+    add("reference", reference, 0.005, 0.02);
+
+    SolverSettings s = reference;
+    s.highPrecision = false;
+    add("stehfest_fast", s, 0.01, 0.03);
+
+    const LaplaceInversion::Method complexMethods[] = { LaplaceInversion::Talbot, LaplaceInversion::DeHoog, LaplaceInversion::Euler };
+    for (LaplaceInversion::Method method : complexMethods) {
+        s = reference;
+        s.inversionMethod = method;
+        add(LaplaceInversion::methodName(method).toLower().replace(' ', '_'), s, 0.005, 0.02);
+    }
+
+    s = reference;
+    s.accuracyControl = true;
+    add("accuracy_control", s, 0.005, 0.02);
+
+    s = reference;
+    s.mixedPrecision = true;
+    add("mixed_precision", s, 0.005, 0.02);
+
+    s = reference;
+    s.asymptoticEarlyArgument = SolverSettings().asymptoticEarlyArgument;
+    s.asymptoticLateArgument = SolverSettings().asymptoticLateArgument;
+    add("asymptotic", s, 0.005, 0.02);
+
+    s = reference;
+    s.gridPointsPerDecade = 20;
+    add("grid20", s, 0.01, 0.03);
+
+    s = reference;
+    s.sharedLaplaceNodes = true;
+    add("shared_nodes", s, 0.01, 0.03);
+
+    s = reference;
+    s.laplaceInterpolation = true;
+    add("laplace_interp", s, 0.01, 0.03);
+
+    if (includeTypeCurveLibrary) {
+        s = reference;
+        s.useTypeCurveLibrary = true;
+        add("type_curve_library", s, 0.01, 0.03);
+    }
+    return configs;
+}
+
+LogErrorStats AccuracySuite::logError(const QVector<double>& reference, const QVector<double>& computed)
+{
+    LogErrorStats stats;
+    double sumSq = 0.0;
+    const int n = qMin(reference.size(), computed.size());
+    for (int i = 0; i < n; ++i) {
+        if (!(reference[i] > 0.0) || !std::isfinite(reference[i])) continue;
+        if (!std::isfinite(computed[i])) {
+            stats.finite = false;
+            continue;
+        }
+        // 计算值非正而参考值为正：按下限 1e-300 计，误差必然超限
+        const double e = std::abs(std::log10(qMax(computed[i], 1e-300) / reference[i]));
+        stats.maxError = qMax(stats.maxError, e);
+        sumSq += e * e;
+        ++stats.points;
+    }
+    if (stats.points > 0) stats.rmsError = std::sqrt(sumSq / stats.points);
+    return stats;
+}
+
+int AccuracySuite::run(BenchmarkRunner& runner, const QList<ReferenceCurve>& references, bool includeTypeCurveLibrary,
+                       QStringList* failures)
+{
+    if (!runner.acceptsSuite("accuracy")) return 0;
+
+    LaplaceEvaluationCache& cache = LaplaceEvaluationCache::instance();
+    const bool cacheWasEnabled = cache.isEnabled();
+    cache.setEnabled(false);
+
+    int failed = 0;
+    const QVector<AccuracyConfiguration> configs = configurations(includeTypeCurveLibrary);
+    for (const ReferenceCurve& ref : references) {
+        for (const AccuracyConfiguration& config : configs) {
+            ModelSolver01_06 solver(ref.modelType);
+            BenchmarkSuites::configureSolver(solver, config.settings);
+
+            const double tolP = ref.toleranceP > 0.0 ? ref.toleranceP : config.maxLogErrorP;
+            const double tolD = ref.toleranceD > 0.0 ? ref.toleranceD : config.maxLogErrorD;
+            QJsonObject parameters;
+            parameters["reference"] = ref.name;
+            parameters["model"] = QString("Model_%1").arg(int(ref.modelType) + 1);
+            parameters["configuration"] = config.name;
+            parameters["points"] = ref.t.size();
+            parameters["toleranceP"] = tolP;
+            parameters["toleranceD"] = tolD;
+
+            bool ran = false;
+            LogErrorStats errP, errD;
+            runner.run("accuracy", QString("%1/%2").arg(ref.name, config.name), parameters, runner.options().quick ? 1 : 3, [&]() {
+                ModelSolver01_06::resetKernelRegimeStatistics();
+                const ModelCurveData curve = solver.calculateTheoreticalCurve(ref.parameters, ref.t);
+                const KernelRegimeStatistics stats = ModelSolver01_06::kernelRegimeStatistics();
+                errP = logError(ref.p, std::get<1>(curve));
+                errD = ref.d.isEmpty() ? LogErrorStats() : logError(ref.d, std::get<2>(curve));
+                ran = true;
+
+                QJsonObject metrics;
+                metrics["maxLogErrorP"] = errP.maxError;
+                metrics["rmsLogErrorP"] = errP.rmsError;
+                metrics["maxLogErrorD"] = errD.maxError;
+                metrics["rmsLogErrorD"] = errD.rmsError;
+                metrics["comparedPoints"] = errP.points;
+                metrics["kernelFull"] = double(stats.full);
+                metrics["kernelEarly"] = double(stats.early);
+                metrics["kernelLate"] = double(stats.late);
+                return metrics;
+            });
+            if (!ran) continue;
+
+            QStringList reasons;
+            if (!errP.finite || !errD.finite) reasons << "非有限值";
+            if (errP.points == 0) reasons << "无可比较的压差点";
+            if (errP.maxError > tolP) reasons << QString("压差 %1 > %2").arg(formatError(errP.maxError), formatError(tolP));
+            if (errD.maxError > tolD) reasons << QString("导数 %1 > %2").arg(formatError(errD.maxError), formatError(tolD));
+            if (!reasons.isEmpty()) {
+                ++failed;
+                if (failures) failures->append(QString("%1/%2: %3").arg(ref.name, config.name, reasons.join(", ")));
+            }
+        }
+    }
+
+    cache.setEnabled(cacheWasEnabled);
+    return failed;
+}
@@ -0,0 +1,71 @@
+/*
+ * 文件名: accuracysuite.h
+ * 文件作用: 对照 MATLAB 参考曲线的精度回归用例头文件
+ * 功能描述:
+ * 1. 参考曲线 (ReferenceCurve) 由 MATLAB 原型 (modelwidget1A ~ 6A) 计算后以 jsonencode 导出，每个文件一条曲线：
+ *    {"model": 1~6 或 "Model_1", "name": "...", "parameters": {"kf": ..., ...}, "t": [...], "p": [...], "dp": [...],
+ *     "tolerance": {"p": ..., "dp": ...}}；tolerance 可省略，省略时使用各求解器配置的默认阈值。
+ * 2. 对每条参考曲线，按若干求解器配置 (AccuracyConfiguration：反演方法、精度、逐点精度控制、混合精度、渐近快速路径、
+ *    网格求值、二进网格节点共享、类型曲线库插值) 计算理论曲线，记录压差与导数的最大 / 均方根对数误差 (|log10(计算值 / 参考值)|)、
+ *    像函数求值次数及耗时。
+ * 3. 任一用例的误差超过阈值 (或出现非有限值) 即判为精度回退，命令行以退出码 4 结束，保证性能优化不改变解释结果。
+ */
+
+#ifndef ACCURACYSUITE_H
+#define ACCURACYSUITE_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "modelengine.h"
+
+class BenchmarkRunner;
+
+// MATLAB 参考曲线
+struct ReferenceCurve {
+    QString name;                    // 曲线名称 (未给出时为文件名)
+    ModelEngine::ModelType modelType = ModelEngine::Model_1;
+    QMap<QString, double> parameters;
+    QVector<double> t, p, d;         // 时间、压差与压差导数 (d 可为空，此时只比较压差)
+    double toleranceP = -1.0;        // 压差最大对数误差阈值 (负值表示使用配置默认值)
+    double toleranceD = -1.0;        // 导数最大对数误差阈值
+
+    static bool load(const QString& filePath, ReferenceCurve& curve, QString* errorMessage = nullptr);
+
+    // 加载目录下全部 *.json 参考曲线 (按文件名排序)，无法解析的文件记入 errors
+    static QList<ReferenceCurve> loadDirectory(const QString& dirPath, QStringList* errors = nullptr);
+};
+
+// 参与比较的求解器配置
+struct AccuracyConfiguration {
+    QString name;
+    SolverSettings settings;
+    double maxLogErrorP = 0.005;     // 默认阈值 (log10 单位，0.005 约为 1.2%)
+    double maxLogErrorD = 0.02;
+};
+
+// 对数误差统计
+struct LogErrorStats {
+    double maxError = 0.0;
+    double rmsError = 0.0;
+    int points = 0;                  // 参与比较的点数 (参考值与计算值均为正)
+    bool finite = true;              // 计算值中是否全部为有限值
+};
+
+class AccuracySuite
+{
+public:
+    // 全部配置；includeTypeCurveLibrary 为 true 时加入类型曲线库插值 (需已加载覆盖参考参数的库文件)
+    static QVector<AccuracyConfiguration> configurations(bool includeTypeCurveLibrary);
+
+    // 运行精度用例，返回超过阈值的用例数；failures 收集各失败用例的说明
+    static int run(BenchmarkRunner& runner, const QList<ReferenceCurve>& references, bool includeTypeCurveLibrary,
+                   QStringList* failures = nullptr);
+
+    // 按参考时间点比较 (两者长度相同)；参考值非正的点不参与比较
+    static LogErrorStats logError(const QVector<double>& reference, const QVector<double>& computed);
+};
+
+#endif // ACCURACYSUITE_H
@@ -0,0 +1,190 @@
+/*
+ * 文件名: benchmarkrunner.cpp
+ * 文件作用: 性能基准的计时与结果输出实现文件
+ * 功能描述:
+ * 1. 计时使用 QElapsedTimer 的纳秒读数 (单调时钟)，只包含用例函数本身。
+ * 2. JSON 与 CSV 均以 QSaveFile 原子写出；CSV 的参数列按 "键=值" 以分号连接，便于表格软件筛选。
+ */
+
+#include "benchmarkrunner.h"
+#include "memoryaccounting.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <numeric>
+
+// ---------------------- BenchmarkResult ----------------------
+
+double BenchmarkResult::minMs() const
+{
+    return samplesMs.isEmpty() ? 0.0 : *std::min_element(samplesMs.constBegin(), samplesMs.constEnd());
+}
+
+double BenchmarkResult::medianMs() const
+{
+    if (samplesMs.isEmpty()) return 0.0;
+    QVector<double> sorted = samplesMs;
+    std::sort(sorted.begin(), sorted.end());
+    const int n = sorted.size();
+    return (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+double BenchmarkResult::meanMs() const
+{
+    if (samplesMs.isEmpty()) return 0.0;
+    return std::accumulate(samplesMs.constBegin(), samplesMs.constEnd(), 0.0) / samplesMs.size();
+}
+
+// ---------------------- BenchmarkRunner ----------------------
+
+BenchmarkRunner::BenchmarkRunner(const Options& options)
+    : m_options(options)
+    , m_environment(environment())
+{
+}
+
+bool BenchmarkRunner::acceptsSuite(const QString& suite) const
+{
+    return m_options.suites.isEmpty() || m_options.suites.contains(suite);
+}
+
+void BenchmarkRunner::run(const QString& suite, const QString& name, const QJsonObject& parameters, int defaultRepeats,
+                          const std::function<QJsonObject()>& body)
+{
+    if (!acceptsSuite(suite)) return;
+    if (!m_options.filter.isEmpty() && !name.contains(m_options.filter)) return;
+
+    BenchmarkResult result;
+    result.suite = suite;
+    result.name = name;
+    result.parameters = parameters;
+
+    for (int i = 0; i < m_options.warmup; ++i) body();
+
+    if (MemoryAccounting::isEnabled()) MemoryAccounting::resetPeaks();
+    const int repeats = qMax(1, m_options.repeats > 0 ? m_options.repeats : defaultRepeats);
+    result.samplesMs.reserve(repeats);
+    QElapsedTimer timer;
+    for (int i = 0; i < repeats; ++i) {
+        timer.start();
+        result.metrics = body();
+        result.samplesMs.append(timer.nsecsElapsed() / 1.0e6);
+    }
+    result.memory = MemoryAccounting::toJson();
+
+    m_results.append(result);
+    if (m_progress) m_progress(result);
+}
+
+bool BenchmarkRunner::writeJson(const QString& path, QString* errorMessage) const
+{
+    QJsonArray cases;
+    for (const BenchmarkResult& r : m_results) {
+        QJsonArray samples;
+        for (double ms : r.samplesMs) samples.append(ms);
+        QJsonObject item;
+        item["suite"] = r.suite;
+        item["name"] = r.name;
+        item["parameters"] = r.parameters;
+        item["samplesMs"] = samples;
+        item["minMs"] = r.minMs();
+        item["medianMs"] = r.medianMs();
+        item["meanMs"] = r.meanMs();
+        item["metrics"] = r.metrics;
+        item["memory"] = r.memory;
+        cases.append(item);
+    }
+    QJsonObject root;
+    root["format"] = "welltestbench/1";
+    root["environment"] = m_environment;
+    root["quick"] = m_options.quick;
+    root["cases"] = cases;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorMessage) *errorMessage = QString("无法写入文件: %1").arg(path);
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        if (errorMessage) *errorMessage = QString("写入失败: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool BenchmarkRunner::writeCsv(const QString& path, QString* errorMessage) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (errorMessage) *errorMessage = QString("无法写入文件: %1").arg(path);
+        return false;
+    }
+    QTextStream out(&file);
+    out << "suite,name,parameters,repeats,min_ms,median_ms,mean_ms,metrics,process_peak_bytes,allocations,counted_peak_bytes\n";
+    auto joined = [](const QJsonObject& object) {
+        QStringList parts;
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it)
+            parts.append(QString("%1=%2").arg(it.key(), it.value().isString() ? it.value().toString()
+                                                                             : QString::number(it.value().toDouble(), 'g', 10)));
+        return parts.join(';');
+    };
+    for (const BenchmarkResult& r : m_results) {
+        out << r.suite << ',' << r.name << ',' << joined(r.parameters) << ',' << r.samplesMs.size() << ','
+            << QString::number(r.minMs(), 'f', 4) << ',' << QString::number(r.medianMs(), 'f', 4) << ','
+            << QString::number(r.meanMs(), 'f', 4) << ',' << joined(r.metrics) << ','
+            << QString::number(r.memory.value("processPeakBytes").toDouble(), 'f', 0);
+        // 分配计数关闭时后两列为空
+        const QJsonObject subsystems = r.memory.value("subsystems").toObject();
+        if (subsystems.isEmpty()) {
+            out << ",,\n";
+            continue;
+        }
+        double allocations = 0.0, peak = 0.0;
+        for (auto it = subsystems.constBegin(); it != subsystems.constEnd(); ++it) {
+            allocations += it.value().toObject().value("allocations").toDouble();
+            peak += it.value().toObject().value("peakBytes").toDouble();
+        }
+        out << ',' << QString::number(allocations, 'f', 0) << ',' << QString::number(peak, 'f', 0) << '\n';
+    }
+    out.flush();
+    if (!file.commit()) {
+        if (errorMessage) *errorMessage = QString("写入失败: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+QJsonObject BenchmarkRunner::environment()
+{
+    QJsonObject env;
+    env["startedAt"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    env["qtVersion"] = QString(qVersion());
+    env["os"] = QSysInfo::prettyProductName();
+    env["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    env["buildAbi"] = QSysInfo::buildAbi();
+    env["idealThreadCount"] = QThread::idealThreadCount();
+    env["poolThreads"] = QThreadPool::globalInstance()->maxThreadCount();
+    env["allocationAccounting"] = MemoryAccounting::isEnabled();
+#if defined(_MSC_VER)
+    env["compiler"] = QString("MSVC %1").arg(_MSC_VER);
+#elif defined(__clang__)
+    env["compiler"] = QString("clang %1").arg(__clang_version__);
+#elif defined(__GNUC__)
+    env["compiler"] = QString("gcc %1").arg(__VERSION__);
+#endif
+#ifdef QT_DEBUG
+    env["buildType"] = "debug";
+#else
+    env["buildType"] = "release";
+#endif
+    return env;
+}
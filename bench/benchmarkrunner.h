@@ -0,0 +1,79 @@
+/*
+ * 文件名: benchmarkrunner.h
+ * 文件作用: 性能基准的计时与结果输出头文件
+ * 功能描述:
+ * 1. BenchmarkRunner::run 对一个用例先做若干次预热 (不计时)，再重复计时若干次，记录每次的耗时 (毫秒)，
+ *    汇总最小值、中位数与平均值；用例可返回附加指标 (求值次数、输出点数、拟合误差等，取最后一次运行的值)。
+ * 2. 用例以 (分组, 名称) 标识，名称在分组内唯一且不含时间戳等可变内容，作为跨版本比较的键。
+ * 3. 结果写出为 JSON (运行环境 + 各用例的参数、全部计时与指标) 与 CSV 汇总表 (每个用例一行)。
+ * 4. 只在调用线程中运行，用例内部可自行使用线程池。
+ * 5. 每个用例附带内存统计 (MemoryAccounting::toJson)：进程当前与峰值内存；开启分配计数 (--memory) 时另有
+ *    计时阶段内各子系统的分配次数、累计分配量与峰值占用 (预热后清零)。
+ */
+
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+// 单个用例的结果
+struct BenchmarkResult {
+    QString suite;             // 分组 (solver / derivative / sampling / fitting)
+    QString name;              // 用例名称
+    QJsonObject parameters;    // 用例参数 (模型、nf、N、点数等)
+    QVector<double> samplesMs; // 各次计时 (毫秒)
+    QJsonObject metrics;       // 附加指标
+    QJsonObject memory;        // 内存统计 (见 memoryaccounting.h)
+
+    double minMs() const;
+    double medianMs() const;
+    double meanMs() const;
+};
+
+class BenchmarkRunner
+{
+public:
+    struct Options {
+        int repeats = 0;       // 每个用例的计时次数 (0 表示使用各分组的默认值)
+        int warmup = 1;        // 预热次数
+        QStringList suites;    // 只运行这些分组 (为空时运行全部)
+        QString filter;        // 只运行名称包含该子串的用例 (为空时不过滤)
+        bool quick = false;    // 缩小参数范围 (冒烟测试与持续集成使用)
+    };
+
+    explicit BenchmarkRunner(const Options& options);
+
+    const Options& options() const { return m_options; }
+
+    // 分组是否需要运行
+    bool acceptsSuite(const QString& suite) const;
+
+    // 运行并记录一个用例 (被过滤掉时不运行)；defaultRepeats 为未指定 --repeats 时的计时次数
+    void run(const QString& suite, const QString& name, const QJsonObject& parameters, int defaultRepeats,
+             const std::function<QJsonObject()>& body);
+
+    // 每个用例结束时的回调 (命令行输出进度)
+    void setProgressCallback(const std::function<void(const BenchmarkResult&)>& callback) { m_progress = callback; }
+
+    const QList<BenchmarkResult>& results() const { return m_results; }
+
+    // 写出结果
+    bool writeJson(const QString& path, QString* errorMessage = nullptr) const;
+    bool writeCsv(const QString& path, QString* errorMessage = nullptr) const;
+
+    // 运行环境 (Qt 版本、编译器、处理器架构与线程数、开始时间)
+    static QJsonObject environment();
+
+private:
+    Options m_options;
+    QList<BenchmarkResult> m_results;
+    QJsonObject m_environment;
+    std::function<void(const BenchmarkResult&)> m_progress;
+};
+
+#endif // BENCHMARKRUNNER_H
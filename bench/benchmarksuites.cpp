@@ -0,0 +1,294 @@
+/*
+ * 文件名: benchmarksuites.cpp
+ * 文件作用: 求解器与拟合性能基准用例实现文件
+ * 功能描述:
+ * 1. 求解器用例的参数取 FitParameterCatalog::defaultParameters 的默认值，只改变 nf 与 N；时间点在 10⁻³ ~ 10³ h 对数均匀。
+ *    附加指标为一次计算的像函数求值次数 (按完整积分 / 早期渐近 / 晚期级数三种路径分别统计)。
+ * 2. 导数与抽样用例的合成记录：对数均匀时间点上的径向流压差叠加 0.5% 乘性噪声，各点数的记录只生成一次。
+ * 3. 拟合用例每次计时前清空 Laplace 缓存 (缓存开启，与实际使用一致)，附加指标为最终 MSE、像函数求值次数、
+ *    缓存命中次数及拟合参数相对真值的最大偏差 (用于发现 "更快但拟合结果变了" 的回退)。
+ */
+
+#include "benchmarksuites.h"
+#include "benchmarkrunner.h"
+#include "fitparameter.h"
+#include "fittingcore.h"
+#include "laplacecache.h"
+#include "pressurederivativecalculator.h"
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <cmath>
+#include <random>
+
+namespace {
+
+QMap<QString, double> defaultParameterMap(ModelEngine::ModelType type)
+{
+    QMap<QString, double> params;
+    for (const FitParameter& p : FitParameterCatalog::defaultParameters(type)) params.insert(p.name, p.value);
+    return params;
+}
+
+QString modelKey(ModelEngine::ModelType type)
+{
+    return QString("Model_%1").arg(int(type) + 1);
+}
+
+// 作用域内设置 Laplace 缓存的开关，结束时恢复
+class ScopedLaplaceCache
+{
+public:
+    explicit ScopedLaplaceCache(bool enabled)
+        : m_previous(LaplaceEvaluationCache::instance().isEnabled())
+    {
+        LaplaceEvaluationCache::instance().setEnabled(enabled);
+        LaplaceEvaluationCache::instance().clear();
+    }
+    ~ScopedLaplaceCache() { LaplaceEvaluationCache::instance().setEnabled(m_previous); }
+
+private:
+    bool m_previous;
+};
+
+// 合成压力记录：n 个对数均匀时间点 (10⁻³ ~ 10⁴ h) 上的径向流压差，叠加 0.5% 乘性噪声
+void syntheticRecord(int n, QVector<double>& t, QVector<double>& p)
+{
+    std::mt19937 rng(BenchmarkSuites::Seed + quint32(n));
+    std::normal_distribution<double> noise(0.0, 0.005);
+    t = ModelSolver01_06::generateLogTimeSteps(n, -3.0, 4.0);
+    p.resize(n);
+    for (int i = 0; i < n; ++i) p[i] = 5.0 * std::log10(1.0 + 100.0 * t[i]) * (1.0 + noise(rng));
+}
+
+QVector<int> recordSizes(bool quick)
+{
+    return quick ? QVector<int>{ 1000, 10000, 100000 } : QVector<int>{ 1000, 10000, 100000, 1000000, 10000000 };
+}
+
+// 大记录计时次数少一些 (单次已有足够的分辨率)
+int recordRepeats(int n)
+{
+    return n >= 1000000 ? 3 : 10;
+}
+
+} // namespace
+
+SolverSettings BenchmarkSuites::fixedSolverSettings()
+{
+    // 默认构造即为固定设置：Stehfest、高精度、时间点并行，类型曲线库、网格求值与精度控制均关闭，渐近阈值取默认值
+    return SolverSettings();
+}
+
+void BenchmarkSuites::configureSolver(ModelSolver01_06& solver, const SolverSettings& settings)
+{
+    solver.setHighPrecision(settings.highPrecision);
+    solver.setInversionMethod(settings.inversionMethod, settings.inversionOrder);
+    solver.setParallelEvaluation(settings.parallelEvaluation);
+    solver.setTypeCurveLibraryEnabled(settings.useTypeCurveLibrary);
+    solver.setGridEvaluation(settings.gridPointsPerDecade);
+    solver.setAsymptoticRegimes(settings.asymptoticEarlyArgument, settings.asymptoticLateArgument);
+    solver.setAccuracyControl(settings.accuracyControl);
+    solver.setMixedPrecision(settings.mixedPrecision);
+    solver.setSharedLaplaceNodes(settings.sharedLaplaceNodes);
+    solver.setLaplaceInterpolation(settings.laplaceInterpolation);
+}
+
+void BenchmarkSuites::solverCurves(BenchmarkRunner& runner)
+{
+    if (!runner.acceptsSuite("solver")) return;
+    const bool quick = runner.options().quick;
+    const QVector<int> nfValues = quick ? QVector<int>{ 4, 10 } : QVector<int>{ 4, 10, 20 };
+    const QVector<int> nValues = quick ? QVector<int>{ 10 } : QVector<int>{ 8, 10, 14, 18 };
+    const QVector<int> pointCounts = quick ? QVector<int>{ 50 } : QVector<int>{ 50, 200, 1000 };
+    const SolverSettings settings = fixedSolverSettings();
+
+    ScopedLaplaceCache cache(false);
+    for (int m = ModelEngine::Model_1; m <= ModelEngine::Model_6; ++m) {
+        const ModelEngine::ModelType type = ModelEngine::ModelType(m);
+        ModelSolver01_06 solver(type);
+        configureSolver(solver, settings);
+        for (int points : pointCounts) {
+            const QVector<double> t = ModelSolver01_06::generateLogTimeSteps(points, -3.0, 3.0);
+            for (int nf : nfValues) {
+                for (int N : nValues) {
+                    QMap<QString, double> params = defaultParameterMap(type);
+                    params["nf"] = nf;
+                    params["N"] = N;
+
+                    QJsonObject parameters;
+                    parameters["model"] = modelKey(type);
+                    parameters["nf"] = nf;
+                    parameters["N"] = N;
+                    parameters["points"] = points;
+                    const QString name = QString("%1/nf%2/N%3/t%4").arg(modelKey(type)).arg(nf).arg(N).arg(points);
+                    runner.run("solver", name, parameters, 3, [&]() {
+                        ModelSolver01_06::resetKernelRegimeStatistics();
+                        ModelCurveData curve = solver.calculateTheoreticalCurve(params, t);
+                        const KernelRegimeStatistics stats = ModelSolver01_06::kernelRegimeStatistics();
+                        QJsonObject metrics;
+                        metrics["kernelFull"] = double(stats.full);
+                        metrics["kernelEarly"] = double(stats.early);
+                        metrics["kernelLate"] = double(stats.late);
+                        metrics["points"] = std::get<0>(curve).size();
+                        return metrics;
+                    });
+                }
+            }
+        }
+    }
+}
+
+void BenchmarkSuites::derivative(BenchmarkRunner& runner)
+{
+    if (!runner.acceptsSuite("derivative")) return;
+    for (int n : recordSizes(runner.options().quick)) {
+        QVector<double> t, p;
+        syntheticRecord(n, t, p);
+        QJsonObject parameters;
+        parameters["points"] = n;
+        parameters["lSpacing"] = 0.1;
+        runner.run("derivative", QString("bourdet/n%1").arg(n), parameters, recordRepeats(n), [&]() {
+            QVector<double> d = PressureDerivativeCalculator::calculateBourdetDerivative(t, p, 0.1);
+            QJsonObject metrics;
+            metrics["points"] = d.size();
+            return metrics;
+        });
+    }
+}
+
+void BenchmarkSuites::sampling(BenchmarkRunner& runner)
+{
+    if (!runner.acceptsSuite("sampling")) return;
+    const struct { SamplingMode mode; const char* key; } modes[] = {
+        { Sampling_NearestPoint, "nearest" },
+        { Sampling_BinMean, "binMean" },
+        { Sampling_BinMedian, "binMedian" }
+    };
+    for (int n : recordSizes(runner.options().quick)) {
+        QVector<double> t, p;
+        syntheticRecord(n, t, p);
+        const QVector<double> d = PressureDerivativeCalculator::calculateBourdetDerivative(t, p, 0.1);
+        for (const auto& m : modes) {
+            FittingCore core;
+            core.setSamplingMode(m.mode);
+            QJsonObject parameters;
+            parameters["points"] = n;
+            parameters["mode"] = QString(m.key);
+            runner.run("sampling", QString("%1/n%2").arg(m.key).arg(n), parameters, recordRepeats(n), [&]() {
+                QVector<double> outT, outP, outD;
+                core.getLogSampledData(t, p, d, outT, outP, outD);
+                QJsonObject metrics;
+                metrics["sampledPoints"] = outT.size();
+                return metrics;
+            });
+        }
+    }
+}
+
+QVector<SyntheticDataset> BenchmarkSuites::syntheticDatasets()
+{
+    struct Spec { const char* name; ModelEngine::ModelType type; };
+    const Spec specs[] = {
+        { "infinite_storage", ModelEngine::Model_1 },
+        { "closed", ModelEngine::Model_4 },
+        { "constant_pressure", ModelEngine::Model_6 }
+    };
+
+    QVector<SyntheticDataset> datasets;
+    std::mt19937 rng(Seed);
+    std::normal_distribution<double> noise(0.0, 0.01);
+    for (const Spec& spec : specs) {
+        SyntheticDataset ds;
+        ds.name = spec.name;
+        ds.modelType = spec.type;
+        ds.truth = defaultParameterMap(spec.type);
+        ds.truth["N"] = 10;
+        if (ds.truth.contains("S")) ds.truth["S"] = 0.5;
+
+        // 偏离真值的固定初值
+        ds.start["kf"] = ds.truth["kf"] * 2.5;
+        ds.start["M12"] = ds.truth["M12"] * 0.4;
+        ds.start["omega1"] = ds.truth["omega1"] * 0.6;
+        ds.start["lambda1"] = ds.truth["lambda1"] * 5.0;
+        if (ds.truth.contains("cD")) {
+            ds.start["cD"] = ds.truth["cD"] * 3.0;
+            ds.start["S"] = ds.truth["S"] + 1.0;
+        }
+
+        ModelSolver01_06 solver(spec.type);
+        configureSolver(solver, fixedSolverSettings());
+        ds.t = ModelSolver01_06::generateLogTimeSteps(120, -2.0, 3.0);
+        ds.p = std::get<1>(solver.calculateTheoreticalCurve(ds.truth, ds.t));
+        for (double& v : ds.p) v *= 1.0 + noise(rng);
+        ds.d = PressureDerivativeCalculator::calculateBourdetDerivative(ds.t, ds.p, 0.1);
+        datasets.append(ds);
+    }
+    return datasets;
+}
+
+void BenchmarkSuites::fitting(BenchmarkRunner& runner)
+{
+    if (!runner.acceptsSuite("fitting")) return;
+    ScopedLaplaceCache cache(true);
+    ModelEngine engine(fixedSolverSettings());
+
+    for (const SyntheticDataset& ds : syntheticDatasets()) {
+        QList<FitParameter> params = FitParameterCatalog::defaultParameters(ds.modelType);
+        for (FitParameter& p : params) {
+            if (ds.truth.contains(p.name)) p.value = ds.truth.value(p.name);
+            p.isFit = ds.start.contains(p.name);
+            if (p.isFit) p.value = ds.start.value(p.name);
+        }
+
+        FittingCore core;
+        core.setModelEngine(&engine);
+        core.setObservedData(ds.t, ds.p, ds.d);
+        core.setJacobianMethod(FittingCore::Jacobian_Analytic);
+        core.setOptimizerMethod(FittingCore::Optimizer_GeodesicLM);
+        core.setGlobalSearchEnabled(false);
+        core.setMultiFidelityEnabled(false);
+        core.setMiniBatch(false, 100);
+        core.setAutoInitialGuessEnabled(false);
+        core.setUncertaintyProfileEnabled(false);
+        core.setTimeBudget(0);
+        // 每个接受步都在抽样时间点上通知 (不按墙钟限频，保证每次运行的计算量相同)
+        core.setPreviewPolicy(0, true);
+
+        // 拟合线程中直接记录最后一次通知 (最终刷新总是最后发出)
+        QMutex mutex;
+        double finalError = -1.0;
+        QMap<QString, double> finalParams;
+        QObject::connect(&core, &FittingCore::sigIterationUpdated, &core,
+                         [&](double error, QMap<QString, double> p, QVector<double>, QVector<double>, QVector<double>) {
+                             QMutexLocker locker(&mutex);
+                             finalError = error;
+                             finalParams = p;
+                         }, Qt::DirectConnection);
+
+        QJsonObject parameters;
+        parameters["model"] = modelKey(ds.modelType);
+        parameters["points"] = ds.t.size();
+        parameters["fitParameters"] = ds.start.size();
+        runner.run("fitting", QString("%1/%2").arg(ds.name, modelKey(ds.modelType)), parameters, runner.options().quick ? 1 : 3, [&]() {
+            LaplaceEvaluationCache::instance().clear();
+            if (core.startFit(ds.modelType, params, 0.5)) core.waitForFinished();
+
+            QMutexLocker locker(&mutex);
+            double maxDeviation = 0.0;
+            for (auto it = ds.start.constBegin(); it != ds.start.constEnd(); ++it) {
+                const double truth = ds.truth.value(it.key());
+                const double fitted = finalParams.value(it.key(), it.value());
+                const double scale = std::abs(truth) > 1e-12 ? std::abs(truth) : 1.0;
+                maxDeviation = std::max(maxDeviation, std::abs(fitted - truth) / scale);
+            }
+            QJsonObject metrics;
+            metrics["mse"] = finalError;
+            metrics["laplaceEvaluations"] = double(LaplaceEvaluationCache::instance().misses());
+            metrics["laplaceCacheHits"] = double(LaplaceEvaluationCache::instance().hits());
+            metrics["maxRelativeParameterError"] = maxDeviation;
+            return metrics;
+        });
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * 文件名: benchmarksuites.h
+ * 文件作用: 求解器与拟合性能基准用例头文件
+ * 功能描述:
+ * 1. solver：ModelSolver01_06::calculateTheoreticalCurve，六个模型 × nf ∈ {4, 10, 20} × N ∈ {8, 10, 14, 18} × 时间点数；
+ *    求解器设置固定 (Stehfest、高精度、并行、不使用类型曲线库与网格求值)，不读取界面的设置项，Laplace 缓存关闭，
+ *    每次计时都是完整的反演计算。
+ * 2. derivative / sampling：PressureDerivativeCalculator::calculateBourdetDerivative 与 FittingCore::getLogSampledData
+ *    (最近点、分箱平均、分箱中值) 在 10³ ~ 10⁷ 点的合成记录上计时。
+ * 3. fitting：FittingCore 在合成数据集 (模型曲线 + 固定种子的 1% 乘性噪声) 上从固定的偏离初值完整拟合，
+ *    拟合设置全部显式给出 (解析雅可比 + 测地线 LM，不做全局搜索、多保真度、小批量与自动初值)。
+ * 4. 全部随机数使用固定种子 (Seed)，相同版本在同一台机器上的输入逐位相同。
+ */
+
+#ifndef BENCHMARKSUITES_H
+#define BENCHMARKSUITES_H
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include "modelengine.h"
+
+class BenchmarkRunner;
+
+// 合成拟合数据集
+struct SyntheticDataset {
+    QString name;
+    ModelEngine::ModelType modelType = ModelEngine::Model_1;
+    QMap<QString, double> truth;     // 生成数据的参数
+    QMap<QString, double> start;     // 拟合初值 (只含参与拟合的参数)
+    QVector<double> t, p, d;         // 观测数据 (导数由加噪后的压差按 Bourdet 方法计算)
+};
+
+class BenchmarkSuites
+{
+public:
+    // 全部合成数据与噪声的随机种子
+    static const quint32 Seed = 20260130u;
+
+    static void solverCurves(BenchmarkRunner& runner);
+    static void derivative(BenchmarkRunner& runner);
+    static void sampling(BenchmarkRunner& runner);
+    static void fitting(BenchmarkRunner& runner);
+
+    // 内置的合成数据集 (无限大 / 封闭 / 定压边界各一个)
+    static QVector<SyntheticDataset> syntheticDatasets();
+
+    // 基准统一使用的求解器设置 (不读取全局设置项)
+    static SolverSettings fixedSolverSettings();
+
+    // 按设置配置求解器实例 (与 SolverPool::acquire 新建实例时相同)
+    static void configureSolver(ModelSolver01_06& solver, const SolverSettings& settings);
+};
+
+#endif // BENCHMARKSUITES_H
@@ -0,0 +1,170 @@
+/*
+ * main.cpp (bench)
+ * 文件作用: 求解器与拟合性能基准命令行入口
+ * 功能描述:
+ * 1. 用法: welltestbench [-o <输出前缀>] [--suite solver,derivative,sampling,fitting] [--filter <子串>]
+ *    [--repeats <次数>] [--warmup <次数>] [--threads <线程数>] [--quick] [--verbose] [--references <目录>] [--type-curve-dir <目录>] [--memory]
+ * 2. 输出 <前缀>.json (运行环境 + 每个用例的逐次耗时与指标) 与 <前缀>.csv (每个用例一行)；
+ *    未指定前缀时为 "welltestbench_<开始时间>"。
+ * 3. 不读取图形界面的设置项：线程数只由 --threads 决定，求解器设置固定 (见 benchmarksuites.h)，不同机器与版本的结果可直接比较。
+ * 4. 退出码: 0 完成，1 参数错误，3 结果写出失败，4 精度回退 (见 5)。
+ * 5. --references <目录> 加入 accuracy 分组：逐条对照 MATLAB 参考曲线，按各求解器配置记录对数误差、求值次数与耗时，
+ *    误差超过阈值时列出失败用例并以退出码 4 结束 (结果文件照常写出)；--type-curve-dir 加载类型曲线库后同时检查库插值路径。
+ * 6. --memory 开启按子系统的分配计数 (需以 WT_ALLOCATION_ACCOUNTING 编译)，每个用例附带计时阶段的分配次数与峰值占用；
+ *    未开启时只记录进程峰值内存。
+ */
+
+#include "accuracysuite.h"
+#include "benchmarkrunner.h"
+#include "benchmarksuites.h"
+#include "memoryaccounting.h"
+#include "typecurvelibrary.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QTextStream>
+#include <QThreadPool>
+
+namespace {
+
+// 默认不输出求解器与拟合过程中的调试信息 (大量输出会影响计时)
+void quietMessageHandler(QtMsgType type, const QMessageLogContext&, const QString& message)
+{
+    if (type == QtDebugMsg || type == QtInfoMsg) return;
+    QTextStream(stderr) << message << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("welltestbench");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("试井求解器与拟合性能基准: 输出 JSON/CSV 计时结果");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "输出文件前缀 (生成 .json 与 .csv)", "prefix");
+    QCommandLineOption suiteOption("suite", "只运行指定分组 (逗号分隔: solver, derivative, sampling, fitting, accuracy)", "names");
+    QCommandLineOption filterOption("filter", "只运行名称包含该子串的用例", "text");
+    QCommandLineOption repeatsOption("repeats", "每个用例的计时次数 (默认按分组)", "count");
+    QCommandLineOption warmupOption("warmup", "每个用例的预热次数 (默认 1)", "count");
+    QCommandLineOption threadsOption("threads", "全局线程池线程数 (默认 CPU 核数)", "count");
+    QCommandLineOption quickOption("quick", "缩小参数范围，快速运行");
+    QCommandLineOption verboseOption("verbose", "输出求解器与拟合的调试信息");
+    QCommandLineOption referencesOption("references", "MATLAB 参考曲线目录 (*.json)，加入 accuracy 分组", "dir");
+    QCommandLineOption memoryOption("memory", "按子系统统计内存分配 (需以 WT_ALLOCATION_ACCOUNTING 编译)");
+    QCommandLineOption typeCurveDirOption("type-curve-dir", "类型曲线库目录 (accuracy 分组同时检查库插值路径)", "dir");
+    parser.addOption(outputOption);
+    parser.addOption(suiteOption);
+    parser.addOption(filterOption);
+    parser.addOption(repeatsOption);
+    parser.addOption(warmupOption);
+    parser.addOption(threadsOption);
+    parser.addOption(quickOption);
+    parser.addOption(verboseOption);
+    parser.addOption(referencesOption);
+    parser.addOption(typeCurveDirOption);
+    parser.addOption(memoryOption);
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const QStringList knownSuites = { "solver", "derivative", "sampling", "fitting", "accuracy" };
+
+    BenchmarkRunner::Options options;
+    options.quick = parser.isSet(quickOption);
+    options.filter = parser.value(filterOption);
+    if (parser.isSet(suiteOption)) {
+        for (const QString& s : parser.value(suiteOption).split(',', Qt::SkipEmptyParts)) {
+            const QString suite = s.trimmed();
+            if (!knownSuites.contains(suite)) {
+                err << "未知的分组: " << suite << "\n";
+                return 1;
+            }
+            options.suites.append(suite);
+        }
+    }
+    bool ok = true;
+    if (parser.isSet(repeatsOption)) {
+        options.repeats = parser.value(repeatsOption).toInt(&ok);
+        if (!ok || options.repeats < 1) {
+            err << "--repeats 需要正整数\n";
+            return 1;
+        }
+    }
+    if (parser.isSet(warmupOption)) {
+        options.warmup = parser.value(warmupOption).toInt(&ok);
+        if (!ok || options.warmup < 0) {
+            err << "--warmup 需要非负整数\n";
+            return 1;
+        }
+    }
+    if (parser.isSet(threadsOption)) {
+        const int threads = parser.value(threadsOption).toInt(&ok);
+        if (!ok || threads < 1) {
+            err << "--threads 需要正整数\n";
+            return 1;
+        }
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    }
+    if (!parser.isSet(verboseOption)) qInstallMessageHandler(quietMessageHandler);
+    if (parser.isSet(memoryOption)) {
+        if (!MemoryAccounting::isCompiledIn()) {
+            err << "--memory 需要以 WT_ALLOCATION_ACCOUNTING 编译 (见 computecore.pri)\n";
+            return 1;
+        }
+        MemoryAccounting::setEnabled(true);
+    }
+
+    QList<ReferenceCurve> references;
+    if (parser.isSet(referencesOption)) {
+        QStringList loadErrors;
+        references = ReferenceCurve::loadDirectory(parser.value(referencesOption), &loadErrors);
+        for (const QString& e : loadErrors) err << e << "\n";
+        if (references.isEmpty() || !loadErrors.isEmpty()) {
+            err << "参考曲线目录无效: " << parser.value(referencesOption) << "\n";
+            return 1;
+        }
+    } else if (options.suites.contains("accuracy")) {
+        err << "accuracy 分组需要 --references\n";
+        return 1;
+    }
+    const bool checkLibrary = parser.isSet(typeCurveDirOption);
+    if (checkLibrary) TypeCurveLibrary::setLibraryDirectory(parser.value(typeCurveDirOption));
+
+    QString prefix = parser.value(outputOption);
+    if (prefix.isEmpty()) prefix = "welltestbench_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+
+    BenchmarkRunner runner(options);
+    runner.setProgressCallback([&err](const BenchmarkResult& r) {
+        err << QString("[%1] %2  min %3 ms  median %4 ms  (%5 次)\n")
+                   .arg(r.suite, r.name)
+                   .arg(r.minMs(), 0, 'f', 3)
+                   .arg(r.medianMs(), 0, 'f', 3)
+                   .arg(r.samplesMs.size());
+        err.flush();
+    });
+
+    BenchmarkSuites::solverCurves(runner);
+    BenchmarkSuites::derivative(runner);
+    BenchmarkSuites::sampling(runner);
+    BenchmarkSuites::fitting(runner);
+    QStringList accuracyFailures;
+    const int failed = AccuracySuite::run(runner, references, checkLibrary, &accuracyFailures);
+
+    QString error;
+    if (!runner.writeJson(prefix + ".json", &error) || !runner.writeCsv(prefix + ".csv", &error)) {
+        err << error << "\n";
+        return 3;
+    }
+    err << QString("%1 个用例，结果已写入 %2.json / %2.csv\n").arg(runner.results().size()).arg(prefix);
+    if (failed > 0) {
+        err << QString("精度回退 %1 项:\n").arg(failed);
+        for (const QString& f : accuracyFailures) err << "  " << f << "\n";
+        return 4;
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+# ----------------------------------------------------
+# Project: welltestbench
+# Description: 求解器与拟合性能基准及 MATLAB 参考曲线精度回归 (与主程序共用计算核心 computecore.pri，结果输出为 JSON/CSV 便于跨版本比较)
+# ----------------------------------------------------
+
+QT = core gui concurrent
+
+TEMPLATE = app
+TARGET = welltestbench
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+# 编译优化选项 (与主工程一致，基准结果才有可比性)
+QMAKE_CXXFLAGS += -O3
+QMAKE_CXXFLAGS_RELEASE -= -O2
+QMAKE_CXXFLAGS_RELEASE += -O3
+
+# 数学库链接
+unix: LIBS += -lm
+win32: LIBS += -lm
+
+# 计算核心 (求解器、导数、抽样与拟合)
+include(../computecore.pri)
+
+HEADERS += \
+           accuracysuite.h \
+           benchmarkrunner.h \
+           benchmarksuites.h
+
+SOURCES += \
+           accuracysuite.cpp \
+           benchmarkrunner.cpp \
+           benchmarksuites.cpp \
+           main.cpp
+
+# 警告设置
+QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter
@@ -0,0 +1,242 @@
+/*
+ * bourdetderivative.cpp
+ * 文件作用: Bourdet 导数计算引擎实现文件
+ * 功能描述:
+ * 1. 正时间点非降序时，满足 ln ti - ln tj ≥ L 的左侧候选是正时间点的前缀、满足 ln tk - ln ti ≥ L 的右侧候选
+ *    是后缀，且随 i 增大只会扩展 (左) 或收缩 (右)；浮点减法对被减数、减数均单调，判断与逐点搜索完全相同。
+ * 2. 非正时间点在两种选点方式中都被跳过，时间点本身非正时两侧均无选点 (与原实现相同)。
+ * 3. 对数统一由 std::log 逐点求一次，各公式的运算顺序与原实现保持一致，结果逐位相同。
+ * 4. [局部更新] 修改范围左侧最近的正时间点 P 以左、第一个满足 ln tP - ln tj ≥ L 的点 j 的右选点不超过 P，
+ *    更左的点同样如此 (右选点随下标单调)，右侧对称；受影响范围之外的导数不依赖被修改的压降。
+ *    求值时以范围首个正时间点的左选点、末个正时间点的右选点为界截取子序列，子序列上选点与整体相同。
+ */
+
+#include "bourdetderivative.h"
+#include "tracing.h"
+
+#include <QtGlobal>
+#include <cmath>
+
+BourdetDerivativeEngine::BourdetDerivativeEngine()
+    : m_lSpacing(0.0), m_monotone(true)
+{
+}
+
+BourdetDerivativeEngine::BourdetDerivativeEngine(const QVector<double>& timeData, double lSpacing)
+    : m_lSpacing(0.0), m_monotone(true)
+{
+    setTime(timeData, lSpacing);
+}
+
+void BourdetDerivativeEngine::setTime(const QVector<double>& timeData, double lSpacing)
+{
+    const int n = timeData.size();
+    m_time = timeData;
+    m_lSpacing = lSpacing;
+    m_logTime.resize(n);
+    m_left.fill(-1, n);
+    m_right.fill(-1, n);
+
+    // ln t 与单调性检查 (NaN、无穷或正时间点逆序时按逐点搜索选点)
+    m_monotone = true;
+    double previous = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const double t = timeData[i];
+        if (t <= 0) {
+            m_logTime[i] = 0.0;
+            continue;
+        }
+        m_logTime[i] = std::log(t);
+        if (!std::isfinite(t) || t < previous) m_monotone = false;
+        previous = t;
+    }
+
+    if (m_monotone) buildMonotoneStencil();
+    else buildScanStencil();
+}
+
+void BourdetDerivativeEngine::buildMonotoneStencil()
+{
+    const int n = m_time.size();
+    const double* t = m_time.constData();
+    const double* lnT = m_logTime.constData();
+    const double L = m_lSpacing;
+
+    int q = 0;         // 左指针：[0, q) 中的正时间点均满足左侧条件
+    int candidate = -1; // 其中下标最大者
+    int r = 0;         // 右指针：上一个点的右侧选点 (或 n)
+    for (int i = 0; i < n; ++i) {
+        if (t[i] <= 0) continue;
+        const double lnTi = lnT[i];
+
+        while (q < i && (t[q] <= 0 || (lnTi - lnT[q]) >= L)) {
+            if (t[q] > 0) candidate = q;
+            ++q;
+        }
+        m_left[i] = candidate;
+
+        if (r < i + 1) r = i + 1;
+        while (r < n && (t[r] <= 0 || !((lnT[r] - lnTi) >= L))) ++r;
+        m_right[i] = (r < n) ? r : -1;
+    }
+}
+
+void BourdetDerivativeEngine::buildScanStencil()
+{
+    const int n = m_time.size();
+    const double* t = m_time.constData();
+    const double* lnT = m_logTime.constData();
+    const double L = m_lSpacing;
+
+    for (int i = 0; i < n; ++i) {
+        if (t[i] <= 0) continue;
+        const double lnTi = lnT[i];
+        for (int j = i - 1; j >= 0; --j) {
+            if (t[j] <= 0) continue;
+            if ((lnTi - lnT[j]) >= L) { m_left[i] = j; break; }
+        }
+        for (int k = i + 1; k < n; ++k) {
+            if (t[k] <= 0) continue;
+            if ((lnT[k] - lnTi) >= L) { m_right[i] = k; break; }
+        }
+    }
+}
+
+double BourdetDerivativeEngine::slope(int a, int b, const QVector<double>& p) const
+{
+    if (m_time[a] <= 0 || m_time[b] <= 0) return 0.0;
+    const double deltaLnT = m_logTime[a] - m_logTime[b];
+    if (std::abs(deltaLnT) < 1e-10) return 0.0;
+    return (p[a] - p[b]) / deltaLnT;
+}
+
+double BourdetDerivativeEngine::signedDerivative(const QVector<double>& pressureDropData, int i) const
+{
+    const int n = m_time.size();
+    const int leftIndex = m_left[i];
+    const int rightIndex = m_right[i];
+
+    // 两侧均有选点：按对数间距加权平均
+    if (leftIndex >= 0 && rightIndex >= 0) {
+        const double deltaXL = m_logTime[i] - m_logTime[leftIndex];
+        const double deltaXR = m_logTime[rightIndex] - m_logTime[i];
+        const double mL = slope(i, leftIndex, pressureDropData);
+        const double mR = slope(rightIndex, i, pressureDropData);
+        if (deltaXL + deltaXR > 1e-12) return (mL * deltaXR + mR * deltaXL) / (deltaXL + deltaXR);
+        return 0.0;
+    }
+    // 只有左侧 (曲线末端) 或只有右侧 (曲线开端)
+    if (leftIndex >= 0) return slope(i, leftIndex, pressureDropData);
+    if (rightIndex >= 0) return slope(rightIndex, i, pressureDropData);
+
+    // L-Spacing 范围内点不足：相邻点差商
+    if (i > 0) return slope(i, i - 1, pressureDropData);
+    if (i < n - 1) return slope(i + 1, i, pressureDropData);
+    return 0.0;
+}
+
+QVector<double> BourdetDerivativeEngine::derivative(const QVector<double>& pressureDropData) const
+{
+    WT_TRACE_SCOPE("Bourdet::derivative");
+    const int n = m_time.size();
+    QVector<double> result(n);
+    for (int i = 0; i < n; ++i) result[i] = std::abs(signedDerivative(pressureDropData, i));
+    return result;
+}
+
+QVector<double> BourdetDerivativeEngine::tangent(const QVector<double>& pressureDropData,
+                                                 const QVector<double>& tangentData) const
+{
+    // 取绝对值前的导数对压降是线性的 (选点只依赖时间)，方向导数只需按原导数的符号翻转
+    const int n = m_time.size();
+    QVector<double> result(n);
+    for (int i = 0; i < n; ++i) {
+        const double base = signedDerivative(pressureDropData, i);
+        const double dir = signedDerivative(tangentData, i);
+        result[i] = base >= 0.0 ? dir : -dir;
+    }
+    return result;
+}
+
+bool BourdetDerivativeEngine::hasMonotoneTime(const QVector<double>& timeData)
+{
+    double previous = 0.0;
+    for (double t : timeData) {
+        if (t <= 0) continue;
+        if (!std::isfinite(t) || t < previous) return false;
+        previous = t;
+    }
+    return true;
+}
+
+void BourdetDerivativeEngine::affectedRange(const QVector<double>& timeData, double lSpacing, int first, int last,
+                                            int& from, int& to)
+{
+    const int n = timeData.size();
+    const double* t = timeData.constData();
+    first = qMax(0, first);
+    last = qMin(n - 1, last);
+    if (first > last) { from = 0; to = -1; return; }
+
+    // 左侧：P 为修改范围左侧最近的正时间点
+    from = qMax(0, first - 1);
+    int P = first - 1;
+    while (P >= 0 && t[P] <= 0) --P;
+    if (P >= 0) {
+        const double lnP = std::log(t[P]);
+        int j = P - 1;
+        while (j >= 0 && (t[j] <= 0 || !((lnP - std::log(t[j])) >= lSpacing))) --j;
+        from = qMin(from, j + 1);
+    }
+
+    // 右侧：Q 为修改范围右侧最近的正时间点
+    to = qMin(n - 1, last + 1);
+    int Q = last + 1;
+    while (Q < n && t[Q] <= 0) ++Q;
+    if (Q < n) {
+        const double lnQ = std::log(t[Q]);
+        int k = Q + 1;
+        while (k < n && (t[k] <= 0 || !((std::log(t[k]) - lnQ) >= lSpacing))) ++k;
+        to = qMax(to, k - 1);
+    }
+}
+
+QVector<double> BourdetDerivativeEngine::derivativeRange(const QVector<double>& timeData,
+                                                         const QVector<double>& pressureDropData,
+                                                         double lSpacing, int from, int to)
+{
+    WT_TRACE_SCOPE("Bourdet::derivativeRange");
+    const int n = timeData.size();
+    const double* t = timeData.constData();
+    from = qMax(0, from);
+    to = qMin(n - 1, to);
+    if (from > to) return QVector<double>();
+
+    // 子序列左界：范围内首个正时间点 R 的左选点 (无左选点时从头开始)
+    int lo = qMax(0, from - 1);
+    int R = from;
+    while (R <= to && t[R] <= 0) ++R;
+    if (R <= to) {
+        const double lnR = std::log(t[R]);
+        int j = from - 1;
+        while (j >= 0 && (t[j] <= 0 || !((lnR - std::log(t[j])) >= lSpacing))) --j;
+        lo = qMax(0, j);
+    }
+
+    // 子序列右界：范围内末个正时间点 S 的右选点 (无右选点时到末尾)
+    int hi = qMin(n - 1, to + 1);
+    int S = to;
+    while (S >= from && t[S] <= 0) --S;
+    if (S >= from) {
+        const double lnS = std::log(t[S]);
+        int k = to + 1;
+        while (k < n && (t[k] <= 0 || !((std::log(t[k]) - lnS) >= lSpacing))) ++k;
+        hi = (k < n) ? k : n - 1;
+    }
+
+    const BourdetDerivativeEngine engine(timeData.mid(lo, hi - lo + 1), lSpacing);
+    const QVector<double> p = pressureDropData.mid(lo, hi - lo + 1);
+    QVector<double> result(to - from + 1);
+    for (int i = from; i <= to; ++i) result[i - from] = std::abs(engine.signedDerivative(p, i - lo));
+    return result;
+}
@@ -0,0 +1,74 @@
+/*
+ * bourdetderivative.h
+ * 文件作用: Bourdet 导数计算引擎头文件
+ * 功能描述:
+ * 1. 对给定时间序列一次性计算 ln t (连续数组) 与每个点的 L-Spacing 左右选点 (模板)，
+ *    之后对任意压降序列求导数只做一次线性扫描，不再逐点向外搜索、重复求对数。
+ * 2. 时间序列中正时间点非降序 (非正时间点可夹在其中，均为有限值) 时，左右选点由两个单调推进的指针求得，
+ *    总代价 O(n)；否则按逐点向外搜索的原规则选点 (仍使用预先计算的 ln t)。
+ * 3. 选点规则与导数公式与原实现逐位一致：左侧点为向前第一个满足 ln ti - ln tj ≥ L 的正时间点，
+ *    右侧点为向后第一个满足 ln tk - ln ti ≥ L 的正时间点，两侧均有时按对数间距加权平均，
+ *    只有一侧时取单侧差商，两侧均无时取相邻点差商。
+ * 4. 同一时间序列上的多组压降 (如解析雅可比的敏感度方向) 可复用同一个引擎。
+ * 5. [局部更新] 时间不变、只有 [first, last] 内的压降被修改时，只有 L-Spacing 选点或相邻点落在该范围内的点受影响；
+ *    affectedRange 给出受影响的下标范围，derivativeRange 只在该范围两侧各约 L 个对数周期的数据上重新选点求值。
+ */
+
+#ifndef BOURDETDERIVATIVE_H
+#define BOURDETDERIVATIVE_H
+
+#include <QVector>
+
+class BourdetDerivativeEngine
+{
+public:
+    BourdetDerivativeEngine();
+    BourdetDerivativeEngine(const QVector<double>& timeData, double lSpacing);
+
+    // 设置时间序列与 L-Spacing，计算 ln t 与左右选点
+    void setTime(const QVector<double>& timeData, double lSpacing);
+
+    int size() const { return m_time.size(); }
+    double lSpacing() const { return m_lSpacing; }
+    // 正时间点是否非降序 (即选点由双指针求得)
+    bool isMonotone() const { return m_monotone; }
+
+    // 第 i 个点的左、右选点下标 (-1 表示该侧无满足 L-Spacing 的点)
+    int leftPoint(int i) const { return m_left[i]; }
+    int rightPoint(int i) const { return m_right[i]; }
+
+    // Bourdet 导数 (取绝对值)，pressureDropData 与时间序列等长
+    QVector<double> derivative(const QVector<double>& pressureDropData) const;
+
+    // 导数沿压降扰动方向的方向导数：sign(原导数) × (同一选点规则作用于扰动方向)
+    QVector<double> tangent(const QVector<double>& pressureDropData, const QVector<double>& tangentData) const;
+
+    // 第 i 个点取绝对值前的导数
+    double signedDerivative(const QVector<double>& pressureDropData, int i) const;
+
+    // 正时间点是否非降序且均为有限值 (局部更新的前提)
+    static bool hasMonotoneTime(const QVector<double>& timeData);
+
+    // 压降在 [first, last] 内被修改时导数可能变化的下标范围 [from, to] (要求 hasMonotoneTime)
+    static void affectedRange(const QVector<double>& timeData, double lSpacing, int first, int last, int& from, int& to);
+
+    // 下标 [from, to] 处的 Bourdet 导数 (取绝对值)，与整体计算的对应值逐位相同 (要求 hasMonotoneTime)
+    static QVector<double> derivativeRange(const QVector<double>& timeData, const QVector<double>& pressureDropData,
+                                           double lSpacing, int from, int to);
+
+private:
+    // 两点差商 (p1 - p2) / (ln t1 - ln t2)，任一时间非正或对数差过小时为 0
+    double slope(int a, int b, const QVector<double>& p) const;
+
+    void buildMonotoneStencil();
+    void buildScanStencil();
+
+    QVector<double> m_time;
+    QVector<double> m_logTime; // ln t (非正时间点处不使用)
+    QVector<int> m_left;
+    QVector<int> m_right;
+    double m_lSpacing;
+    bool m_monotone;
+};
+
+#endif // BOURDETDERIVATIVE_H
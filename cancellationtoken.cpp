@@ -0,0 +1,62 @@
+/*
+ * cancellationtoken.cpp
+ * 文件作用: 协作式取消令牌实现文件
+ * 功能描述:
+ * 1. 截止时间以 QDeadlineTimer 的单调时钟毫秒数保存，检查时与当前时刻比较，不受系统时间调整影响。
+ * 2. 当前线程的令牌保存在 thread_local 指针中，Scope 守卫按嵌套顺序保存与恢复。
+ */
+
+#include "cancellationtoken.h"
+
+#include <QDeadlineTimer>
+
+// 当前线程登记的取消令牌 (由 CancellationToken::Scope 维护)
+static thread_local const CancellationToken* t_currentToken = nullptr;
+
+CancellationToken::CancellationToken()
+    : m_cancelled(0), m_deadline(-1)
+{
+}
+
+void CancellationToken::cancel()
+{
+    m_cancelled.storeRelease(1);
+}
+
+void CancellationToken::reset()
+{
+    m_cancelled.storeRelease(0);
+    m_deadline.storeRelease(-1);
+}
+
+void CancellationToken::setDeadline(qint64 msecs)
+{
+    m_deadline.storeRelease(msecs > 0 ? QDeadlineTimer(msecs).deadline() : -1);
+}
+
+bool CancellationToken::isCancelRequested() const
+{
+    return m_cancelled.loadAcquire() != 0;
+}
+
+bool CancellationToken::isDeadlineExpired() const
+{
+    const qint64 deadline = m_deadline.loadAcquire();
+    return deadline >= 0 && QDeadlineTimer::current().deadline() >= deadline;
+}
+
+const CancellationToken* CancellationToken::current()
+{
+    return t_currentToken;
+}
+
+CancellationToken::Scope::Scope(const CancellationToken* token)
+    : m_previous(t_currentToken)
+{
+    t_currentToken = token;
+}
+
+CancellationToken::Scope::~Scope()
+{
+    t_currentToken = m_previous;
+}
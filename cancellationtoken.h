@@ -0,0 +1,56 @@
+/*
+ * cancellationtoken.h
+ * 文件作用: 协作式取消令牌头文件
+ * 功能描述:
+ * 1. CancellationToken：取消标志与墙钟截止时间 (均为原子量)，任意线程可请求取消，计算线程只读检查。
+ * 2. Scope 守卫把令牌登记为当前线程的取消令牌 (与 ModelSolver01_06::ScopedSerialEvaluation 相同的线程局部方式)，
+ *    作用域内的曲线计算无需修改调用链上的接口即可感知取消；派发到线程池的子任务需在任务内重新登记。
+ * 3. 求解器在计算入口读取当前令牌，逐个 Laplace 节点检查，已取消时立即结束并跳过缓存写入，
+ *    此时的计算结果无效，调用方应以 isCancelled() 判断后丢弃。
+ */
+
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QAtomicInteger>
+
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    // 请求取消 (可在任意线程调用)
+    void cancel();
+
+    // 清除取消标志与截止时间
+    void reset();
+
+    // 设置截止时间：从现在起 msecs 毫秒后视为超时 (msecs <= 0 表示不限时)
+    void setDeadline(qint64 msecs);
+
+    // 是否已显式请求取消 / 是否已超过截止时间 / 两者之一
+    bool isCancelRequested() const;
+    bool isDeadlineExpired() const;
+    bool isCancelled() const { return isCancelRequested() || isDeadlineExpired(); }
+
+    // 当前线程登记的取消令牌 (未登记时为 nullptr)
+    static const CancellationToken* current();
+
+    // 登记守卫：作用域内 current() 返回 token (可为 nullptr，用于临时屏蔽取消)，析构时恢复
+    class Scope {
+    public:
+        explicit Scope(const CancellationToken* token);
+        ~Scope();
+    private:
+        const CancellationToken* m_previous;
+    };
+
+private:
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    QAtomicInteger<int> m_cancelled;
+    QAtomicInteger<qint64> m_deadline; // 截止时刻 (QDeadlineTimer 单调时钟的毫秒数)，-1 表示不限时
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -9,6 +9,7 @@
  * 5. [新增] 支持开/关井事件线（红/绿虚线），在双坐标模式下贯穿显示（从底至顶）。
  * 6. 实现鼠标交互：缩放、拖拽、移动数据、编辑标注、右键菜单等。
  * 7. [修复] 修正 QCPItemLine 坐标轴设置方式，解决编译错误。
+ * 8. [多级抽稀] 拖动曲线时经 GraphLod::translate 平移完整数据 (抽稀显示的曲线按可见范围重新取点)。
  */
 
 #include "chartwidget.h"
@@ -16,6 +17,7 @@
 #include "chartsetting1.h"
 #include "modelparameter.h"
 #include "styleselectordialog.h"
+#include "graphlod.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -671,11 +673,8 @@ void ChartWidget::onPlotMouseMove(QMouseEvent* event) {
                 dy = yAxis->pixelToCoord(event->pos().y()) - yAxis->pixelToCoord(m_lastMoveDataPos.y());
             }
 
-            QSharedPointer<QCPGraphDataContainer> data = m_movingGraph->data();
-            for (auto it = data->begin(); it != data->end(); ++it) {
-                if (m_interMode == Mode_Moving_Data_X) it->key += dx;
-                else it->value += dy;
-            }
+            // 抽稀显示的曲线平移完整数据后按可见范围重新取点
+            GraphLod::translate(m_movingGraph, dx, dy);
 
             // [同步移动开/关井线]
             // 如果是在堆叠模式下移动产量曲线(bottomRect)，则同步移动事件线
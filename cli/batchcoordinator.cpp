@@ -0,0 +1,310 @@
+/*
+ * 文件名: batchcoordinator.cpp
+ * 文件作用: 分布式批量解释的协调进程实现文件
+ * 功能描述:
+ * 1. 任务状态只在协调进程的事件循环中修改：工作进程只回报结果，重新排队与重试计数均由协调进程决定。
+ * 2. 只接受分配给该工作进程的任务结果，已被判定丢失后又迟到的结果 (连接已断开) 不会覆盖重新分配后的任务。
+ * 3. 进度由心跳携带，任务结束时的最终误差与参数由 result 消息给出 (与本地队列取最后一次迭代结果的规则相同)。
+ * 4. 完成 hello 之前的连接只接受 hello 消息且缓冲不超过 MaxHandshakeBytes，令牌或协议版本不符时回复 rejected 后正常关闭，
+ *    未认证的连接不计入工作进程，也不会收到观测数据与任务。
+ */
+
+#include "batchcoordinator.h"
+#include "batchprotocol.h"
+
+#include <QDateTime>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+BatchCoordinator::BatchCoordinator(QObject* parent)
+    : QObject(parent), m_server(new QTcpServer(this)), m_token(BatchProtocol::generateToken()),
+      m_heartbeatTimeoutMs(BatchProtocol::DefaultHeartbeatTimeoutMs)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &BatchCoordinator::onNewConnection);
+    connect(&m_heartbeatTimer, &QTimer::timeout, this, &BatchCoordinator::checkHeartbeats);
+}
+
+BatchCoordinator::~BatchCoordinator()
+{
+    for (QTcpSocket* socket : m_workers.keys()) socket->disconnect(this);
+}
+
+bool BatchCoordinator::listen(quint16 port, const QHostAddress& address, QString* errorMessage)
+{
+    if (!m_server->listen(address, port)) {
+        if (errorMessage) *errorMessage = QString("无法监听 %1:%2: %3").arg(address.toString()).arg(port).arg(m_server->errorString());
+        return false;
+    }
+    m_heartbeatTimer.start(BatchProtocol::HeartbeatIntervalMs);
+    return true;
+}
+
+quint16 BatchCoordinator::serverPort() const
+{
+    return m_server->serverPort();
+}
+
+void BatchCoordinator::setToken(const QString& token)
+{
+    if (!token.isEmpty()) m_token = token;
+}
+
+void BatchCoordinator::setHeartbeatTimeout(int ms)
+{
+    m_heartbeatTimeoutMs = qMax(2 * int(BatchProtocol::HeartbeatIntervalMs), ms);
+}
+
+void BatchCoordinator::setMaxAttempts(int attempts)
+{
+    m_maxAttempts = qMax(1, attempts);
+}
+
+int BatchCoordinator::addJob(const FittingJob& job)
+{
+    FittingJob entry = job;
+    entry.id = m_nextId++;
+    entry.state = FittingJob::Pending;
+    entry.progress = 0;
+    entry.mse = -1.0;
+    entry.result.clear();
+    m_jobs.append(entry);
+    emit sigJobUpdated(entry.id);
+    dispatch();
+    return entry.id;
+}
+
+QList<FittingJob> BatchCoordinator::jobs() const
+{
+    return m_jobs;
+}
+
+FittingJob BatchCoordinator::job(int id) const
+{
+    for (const FittingJob& job : m_jobs) {
+        if (job.id == id) return job;
+    }
+    return FittingJob();
+}
+
+QList<FittingJob> BatchCoordinator::rankedResults() const
+{
+    return FittingJobQueue::rankJobs(m_jobs);
+}
+
+bool BatchCoordinator::isIdle() const
+{
+    for (const FittingJob& job : m_jobs) {
+        if (job.state == FittingJob::Pending || job.state == FittingJob::Running) return false;
+    }
+    return true;
+}
+
+void BatchCoordinator::shutdownWorkers()
+{
+    QJsonObject message;
+    message["type"] = "shutdown";
+    for (QTcpSocket* socket : m_workers.keys()) {
+        send(socket, message);
+        // 调用方随后通常退出事件循环，这里同步写出最后一条消息
+        socket->waitForBytesWritten(1000);
+        socket->disconnect(this);
+        socket->disconnectFromHost();
+        socket->deleteLater();
+    }
+    m_workers.clear();
+}
+
+FittingJob* BatchCoordinator::findJob(int id)
+{
+    for (FittingJob& job : m_jobs) {
+        if (job.id == id) return &job;
+    }
+    return nullptr;
+}
+
+void BatchCoordinator::send(QTcpSocket* socket, const QJsonObject& message)
+{
+    socket->write(BatchProtocol::encode(message));
+}
+
+void BatchCoordinator::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        Worker worker;
+        worker.name = QString("%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort());
+        worker.lastSeen = QDateTime::currentMSecsSinceEpoch();
+        m_workers.insert(socket, worker);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { dropWorker(socket, "连接已断开"); });
+    }
+}
+
+void BatchCoordinator::onReadyRead(QTcpSocket* socket)
+{
+    if (!m_workers.contains(socket)) return;
+    QList<QJsonObject> messages;
+    QString error;
+    const int limit = m_workers.value(socket).slots > 0 ? int(BatchProtocol::MaxMessageBytes)
+                                                        : int(BatchProtocol::MaxHandshakeBytes);
+    const bool ok = BatchProtocol::readMessages(socket, messages, &error, limit);
+    for (const QJsonObject& message : messages) {
+        if (!m_workers.contains(socket)) return;
+        handleMessage(socket, message);
+    }
+    if (!ok) dropWorker(socket, error);
+}
+
+void BatchCoordinator::handleMessage(QTcpSocket* socket, const QJsonObject& message)
+{
+    Worker& worker = m_workers[socket];
+    worker.lastSeen = QDateTime::currentMSecsSinceEpoch();
+    const QString type = message["type"].toString();
+
+    // 握手之前只接受 hello
+    if (worker.slots == 0 && type != "hello") {
+        rejectWorker(socket, "未完成握手");
+        return;
+    }
+
+    if (type == "hello") {
+        if (worker.slots > 0) return;
+        if (message["version"].toInt() != BatchProtocol::Version) {
+            rejectWorker(socket, QString("协议版本不一致 (%1，协调进程为 %2)").arg(message["version"].toInt()).arg(int(BatchProtocol::Version)));
+            return;
+        }
+        if (!BatchProtocol::tokensEqual(message["token"].toString(), m_token)) {
+            rejectWorker(socket, "令牌不符");
+            return;
+        }
+        const QString name = message["name"].toString();
+        if (!name.isEmpty()) worker.name = name;
+        worker.slots = qMax(1, message["slots"].toInt());
+        QJsonObject welcome;
+        welcome["type"] = "welcome";
+        welcome["heartbeatMs"] = int(BatchProtocol::HeartbeatIntervalMs);
+        send(socket, welcome);
+        emit workerConnected(worker.name, worker.slots);
+        dispatch();
+    } else if (type == "heartbeat") {
+        const QJsonObject progress = message["progress"].toObject();
+        for (auto it = progress.begin(); it != progress.end(); ++it) {
+            const int id = it.key().toInt();
+            FittingJob* job = findJob(id);
+            if (!job || !worker.running.contains(id) || job->progress == it.value().toInt()) continue;
+            job->progress = it.value().toInt();
+            emit sigJobUpdated(id);
+        }
+        QJsonObject reply;
+        reply["type"] = "heartbeat";
+        send(socket, reply);
+    } else if (type == "result") {
+        const int id = message["id"].toInt();
+        FittingJob* job = findJob(id);
+        if (!job || !worker.running.remove(id)) return;
+        job->state = message["state"].toString() == "finished" ? FittingJob::Finished : FittingJob::Cancelled;
+        job->mse = message["mse"].toDouble(-1.0);
+        job->result.clear();
+        const QJsonObject params = message["parameters"].toObject();
+        for (auto it = params.begin(); it != params.end(); ++it) job->result.insert(it.key(), it.value().toDouble());
+        if (job->state == FittingJob::Finished) job->progress = 100;
+        emit sigJobUpdated(id);
+        dispatch();
+        if (isIdle()) emit sigAllFinished();
+    }
+}
+
+void BatchCoordinator::dropWorker(QTcpSocket* socket, const QString& reason)
+{
+    if (!m_workers.contains(socket)) return;
+    const Worker worker = m_workers.take(socket);
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+
+    // 运行中的任务重新排队；尝试次数用尽的任务记为已取消
+    int requeued = 0;
+    for (int id : worker.running) {
+        FittingJob* job = findJob(id);
+        if (!job) continue;
+        job->progress = 0;
+        if (m_attempts.value(id) < m_maxAttempts) {
+            job->state = FittingJob::Pending;
+            ++requeued;
+        } else {
+            job->state = FittingJob::Cancelled;
+        }
+        emit sigJobUpdated(id);
+    }
+    if (worker.slots > 0) emit workerLost(worker.name, reason, requeued);
+    dispatch();
+    if (!worker.running.isEmpty() && isIdle()) emit sigAllFinished();
+}
+
+void BatchCoordinator::rejectWorker(QTcpSocket* socket, const QString& reason)
+{
+    QJsonObject message;
+    message["type"] = "rejected";
+    message["reason"] = reason;
+    send(socket, message);
+
+    // 未完成握手的连接没有运行中的任务，直接移出；正常关闭使拒绝原因写完后再断开 (abort 会丢弃未写出的数据)
+    const Worker worker = m_workers.take(socket);
+    socket->disconnect(this);
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    socket->disconnectFromHost();
+    if (socket->state() == QAbstractSocket::UnconnectedState) socket->deleteLater();
+    emit workerRejected(worker.name, reason);
+}
+
+void BatchCoordinator::checkHeartbeats()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<QTcpSocket*> silent;
+    for (auto it = m_workers.constBegin(); it != m_workers.constEnd(); ++it) {
+        if (now - it.value().lastSeen > m_heartbeatTimeoutMs) silent.append(it.key());
+    }
+    for (QTcpSocket* socket : silent) {
+        dropWorker(socket, QString("%1 秒内没有心跳").arg(m_heartbeatTimeoutMs / 1000));
+    }
+}
+
+void BatchCoordinator::dispatch()
+{
+    for (auto it = m_workers.begin(); it != m_workers.end(); ++it) {
+        QTcpSocket* socket = it.key();
+        Worker& worker = it.value();
+        while (worker.slots > 0 && worker.running.size() < worker.slots) {
+            // 优先级最高、加入最早的排队任务
+            FittingJob* next = nullptr;
+            for (FittingJob& job : m_jobs) {
+                if (job.state != FittingJob::Pending) continue;
+                if (!next || job.priority > next->priority) next = &job;
+            }
+            if (!next) return;
+
+            const QString datasetId = next->observed ? next->observed->idString() : QString();
+            if (!datasetId.isEmpty() && !worker.datasets.contains(datasetId)) {
+                QJsonObject dataset;
+                dataset["type"] = "dataset";
+                dataset["id"] = datasetId;
+                dataset["data"] = next->observed->toJson();
+                send(socket, dataset);
+                worker.datasets.insert(datasetId);
+            }
+            QJsonObject message;
+            message["type"] = "job";
+            message["id"] = next->id;
+            message["datasetId"] = datasetId;
+            message["job"] = BatchProtocol::jobToJson(*next);
+            send(socket, message);
+
+            next->state = FittingJob::Running;
+            next->progress = 0;
+            m_attempts[next->id] += 1;
+            worker.running.insert(next->id);
+            emit sigJobUpdated(next->id);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * 文件名: batchcoordinator.h
+ * 文件作用: 分布式批量解释的协调进程头文件
+ * 功能描述:
+ * 1. 监听 TCP 端口，接受工作进程 (welltestcli --worker) 连接，把 BatchInterpretation 生成的拟合任务分发到各工作进程；
+ *    接口与 FittingJobQueue 相同 (addJob / jobs / rankedResults / sigJobUpdated)，结果汇总与写出沿用本地模式的代码。
+ * 2. 调度：工作进程在 hello 中报告同时运行的任务数，协调进程按优先级 (相同时按加入顺序) 填满其空闲名额。
+ * 3. 心跳：超过心跳超时未收到工作进程的任何消息，或连接断开时，视为该工作进程丢失，其运行中的任务重新排队；
+ *    同一任务丢失 maxAttempts 次后记为已取消 (无结果)，不再重试。
+ * 4. 工作进程使用各自机器上的求解器与拟合设置 (QSettings)，需与协调进程保持一致，结果才与单机运行相同。
+ * 5. 默认只监听本机回环地址；接受远程工作进程需显式指定监听地址。hello 中的令牌与 token() 一致的连接才会分配任务，
+ *    令牌缺省为构造时随机生成的值 (见 setToken)。
+ */
+
+#ifndef BATCHCOORDINATOR_H
+#define BATCHCOORDINATOR_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include "fittingjobqueue.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+class BatchCoordinator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BatchCoordinator(QObject* parent = nullptr);
+    ~BatchCoordinator();
+
+    // 开始监听 (port 为 0 时由系统分配，见 serverPort)
+    bool listen(quint16 port, const QHostAddress& address = QHostAddress::LocalHost, QString* errorMessage = nullptr);
+    quint16 serverPort() const;
+
+    // 工作进程须在 hello 中给出的令牌 (不能为空)
+    void setToken(const QString& token);
+    QString token() const { return m_token; }
+
+    // 心跳超时与单个任务的最大尝试次数
+    void setHeartbeatTimeout(int ms);
+    void setMaxAttempts(int attempts);
+
+    // 加入任务，返回分配的任务编号
+    int addJob(const FittingJob& job);
+
+    // 任务快照 (按加入顺序)；id 不存在时返回 id 为 -1 的空任务
+    QList<FittingJob> jobs() const;
+    FittingJob job(int id) const;
+    // 已完成的任务按 MSE 升序排列
+    QList<FittingJob> rankedResults() const;
+
+    int workerCount() const { return m_workers.size(); }
+    bool isIdle() const;
+
+    // 通知全部工作进程退出并断开连接
+    void shutdownWorkers();
+
+signals:
+    void sigJobUpdated(int id);
+    void sigAllFinished();
+    // 工作进程连接与丢失 (用于命令行输出)
+    void workerConnected(const QString& name, int slots);
+    void workerLost(const QString& name, const QString& reason, int requeuedJobs);
+    void workerRejected(const QString& name, const QString& reason);
+
+private:
+    struct Worker {
+        QString name;
+        int slots = 0;                 // 0 表示尚未完成 hello
+        QSet<int> running;             // 分配给该工作进程的任务
+        QSet<QString> datasets;        // 已发送的观测数据
+        qint64 lastSeen = 0;           // 最近一次收到消息的时刻 (ms)
+    };
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+    void handleMessage(QTcpSocket* socket, const QJsonObject& message);
+    void dropWorker(QTcpSocket* socket, const QString& reason);
+    void rejectWorker(QTcpSocket* socket, const QString& reason);
+    void checkHeartbeats();
+    void dispatch();
+    FittingJob* findJob(int id);
+    void send(QTcpSocket* socket, const QJsonObject& message);
+
+    QTcpServer* m_server;
+    QTimer m_heartbeatTimer;
+    QMap<QTcpSocket*, Worker> m_workers;
+    QList<FittingJob> m_jobs;
+    QMap<int, int> m_attempts;         // 各任务已分配的次数
+    QString m_token;
+    int m_nextId = 1;
+    int m_heartbeatTimeoutMs;
+    int m_maxAttempts = 3;
+};
+
+#endif // BATCHCOORDINATOR_H
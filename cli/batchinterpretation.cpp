@@ -0,0 +1,520 @@
+/*
+ * 文件名: batchinterpretation.cpp
+ * 文件作用: 无界面批量试井解释实现文件
+ * 功能描述:
+ * 1. 项目文件的拟合分析格式与 FittingPage::collectFittingStates 一致 (analyses + datasets，观测数据按编号引用)，
+ *    参数、权重 (fitWeightVal / 100) 与抽样设置的字段与 FittingWidget 保存的页签状态相同。
+ * 2. 候选模型与分析当前模型不同时，参数经 FitParameterCatalog::adaptParameters 继承共有参数后再应用覆盖。
+ * 3. 拟合在 FittingJobQueue 中运行 (每个任务一个 FittingCore，雅可比各列共用全局线程池)，
+ *    求解器设置与拟合设置项取自与界面相同的 QSettings。
+ * 4. 排名：已完成的任务按 MSE 升序，分别给出井内排名与全部任务的总排名。
+ * 5. 分布式模式下任务快照与排名取自 BatchCoordinator，本地队列保持空闲。
+ * 6. 写回项目时分析的名称规则与 loadProject 相同；参数表按结果模型的参数排列，原分析中已有的参数只替换数值
+ *    (范围、是否拟合与显示设置保留)，新增的参数取自任务。文件按 ModelParameter::writeProjectFile 的格式以 QSaveFile 原子写出。
+ */
+
+#include "batchinterpretation.h"
+#include "batchcoordinator.h"
+#include "bourdetderivative.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QThread>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+bool fail(QString* errorMessage, const QString& message)
+{
+    if (errorMessage) *errorMessage = message;
+    return false;
+}
+
+bool readJsonObject(const QString& path, QJsonObject& object, QString* errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return fail(errorMessage, QString("无法打开文件: %1").arg(path));
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (doc.isNull() || !doc.isObject())
+        return fail(errorMessage, QString("JSON 格式错误: %1 (%2)").arg(path, error.errorString()));
+    object = doc.object();
+    return true;
+}
+
+// "Model_3"、"3" 或数字 3 均表示模型 3
+bool parseModel(const QJsonValue& value, ModelEngine::ModelType& type)
+{
+    int index = 0;
+    if (value.isDouble()) {
+        index = value.toInt();
+    } else {
+        QString text = value.toString().trimmed();
+        text.remove(QRegularExpression("^[Mm]odel_?"));
+        bool ok = false;
+        index = text.toInt(&ok);
+        if (!ok) return false;
+    }
+    if (index < 1 || index > 6) return false;
+    type = (ModelEngine::ModelType)(index - 1);
+    return true;
+}
+
+SamplingMode parseSamplingMode(const QJsonValue& value)
+{
+    if (value.isDouble()) return (SamplingMode)qBound(0, value.toInt(), 2);
+    const QString text = value.toString().toLower();
+    if (text == "mean") return Sampling_BinMean;
+    if (text == "median") return Sampling_BinMedian;
+    return Sampling_NearestPoint;
+}
+
+QList<SamplingInterval> parseIntervals(const QJsonArray& array)
+{
+    QList<SamplingInterval> intervals;
+    for (const QJsonValue& value : array) {
+        QJsonObject obj = value.toObject();
+        SamplingInterval item;
+        item.tStart = obj["start"].toDouble();
+        item.tEnd = obj["end"].toDouble();
+        item.count = obj["count"].toInt();
+        intervals.append(item);
+    }
+    return intervals;
+}
+
+// 分析名称：页签名，旧项目没有时按序号命名
+QString analysisName(const QJsonObject& state, int index)
+{
+    return state.contains("_tabName") ? state["_tabName"].toString() : QString("Analysis %1").arg(index + 1);
+}
+
+// 把任务结果写入分析状态 (字段与 FittingWidget::getJsonState 相同)
+QJsonObject applyJobResult(QJsonObject state, const FittingJob& job)
+{
+    QMap<QString, QJsonObject> saved;
+    for (const QJsonValue& value : state["parameters"].toArray()) {
+        QJsonObject obj = value.toObject();
+        saved.insert(obj["name"].toString(), obj);
+    }
+    QJsonArray params;
+    for (const FitParameter& p : job.params) {
+        QJsonObject obj = saved.value(p.name);
+        if (obj.isEmpty()) {
+            obj["name"] = p.name;
+            obj["isFit"] = p.isFit;
+            obj["min"] = p.min;
+            obj["max"] = p.max;
+            obj["isVisible"] = p.isVisible;
+            obj["step"] = p.step;
+        }
+        obj["value"] = job.result.value(p.name, p.value);
+        params.append(obj);
+    }
+    state["modelType"] = (int)job.modelType;
+    state["modelName"] = ModelEngine::getModelTypeName(job.modelType);
+    state["parameters"] = params;
+    return state;
+}
+
+QString csvField(QString text)
+{
+    if (text.contains(',') || text.contains('"') || text.contains('\n')) {
+        text.replace("\"", "\"\"");
+        return "\"" + text + "\"";
+    }
+    return text;
+}
+
+} // namespace
+
+BatchInterpretation::BatchInterpretation(QObject* parent)
+    : QObject(parent)
+{
+    m_queue = new FittingJobQueue(&m_engine, this);
+    connect(m_queue, &FittingJobQueue::sigJobUpdated, this, &BatchInterpretation::onJobUpdated);
+}
+
+BatchInterpretation::~BatchInterpretation()
+{
+    // 队列析构时停止并等待拟合线程，须在计算引擎释放之前完成
+    delete m_queue;
+}
+
+bool BatchInterpretation::listen(quint16 port, const QHostAddress& address, QString* errorMessage)
+{
+    if (!m_coordinator) {
+        m_coordinator = new BatchCoordinator(this);
+        connect(m_coordinator, &BatchCoordinator::sigJobUpdated, this, &BatchInterpretation::onJobUpdated);
+    }
+    return m_coordinator->listen(port, address, errorMessage);
+}
+
+void BatchInterpretation::onJobUpdated(int id)
+{
+    FittingJob job = m_coordinator ? m_coordinator->job(id) : m_queue->job(id);
+    if (job.state != FittingJob::Finished && job.state != FittingJob::Cancelled) return;
+    if (m_reported.contains(id)) return;
+    m_reported.insert(id);
+    emit jobFinished(job.analysisName, ModelEngine::getModelTypeName(job.modelType), job.mse, m_reported.size(), m_total);
+    // 以任务计数判断结束：加入任务过程中队列可能短暂空闲
+    if (m_reported.size() == m_total) emit finished();
+}
+
+QList<FittingJob> BatchInterpretation::allJobs() const
+{
+    return m_coordinator ? m_coordinator->jobs() : m_queue->jobs();
+}
+
+QList<FittingJob> BatchInterpretation::rankedJobs() const
+{
+    return m_coordinator ? m_coordinator->rankedResults() : m_queue->rankedResults();
+}
+
+bool BatchInterpretation::loadJobSpec(const QString& path, BatchJobSpec& spec, QString* errorMessage)
+{
+    QJsonObject root;
+    if (!readJsonObject(path, root, errorMessage)) return false;
+
+    spec = BatchJobSpec();
+    for (const QJsonValue& value : root["models"].toArray()) {
+        ModelEngine::ModelType type;
+        if (!parseModel(value, type)) return fail(errorMessage, QString("无法识别的模型: %1").arg(value.toVariant().toString()));
+        if (!spec.models.contains(type)) spec.models.append(type);
+    }
+    if (root.contains("weight")) spec.weight = qBound(0.0, root["weight"].toDouble(), 1.0);
+    for (const QJsonValue& value : root["analyses"].toArray()) spec.analyses.append(value.toString());
+    spec.concurrency = qMax(0, root["concurrency"].toInt());
+    if (root.contains("lSpacing")) spec.lSpacing = root["lSpacing"].toDouble(0.1);
+
+    // "parameters": { "kf": {"value": 0.01, "min": 1e-4, "max": 1, "fit": true}, "S": 0.5, ... }
+    const QJsonObject params = root["parameters"].toObject();
+    for (auto it = params.begin(); it != params.end(); ++it) {
+        ParameterOverride o;
+        if (it.value().isDouble()) {
+            o.hasValue = true;
+            o.value = it.value().toDouble();
+        } else {
+            const QJsonObject obj = it.value().toObject();
+            if (obj.contains("value")) { o.hasValue = true; o.value = obj["value"].toDouble(); }
+            if (obj.contains("min")) { o.hasMin = true; o.min = obj["min"].toDouble(); }
+            if (obj.contains("max")) { o.hasMax = true; o.max = obj["max"].toDouble(); }
+            if (obj.contains("fit")) o.fit = obj["fit"].toBool() ? 1 : 0;
+        }
+        spec.parameters.insert(it.key(), o);
+    }
+    // 简写："fit": [...] 与 "fixed": [...] 只改变是否拟合
+    for (const QJsonValue& value : root["fit"].toArray()) spec.parameters[value.toString()].fit = 1;
+    for (const QJsonValue& value : root["fixed"].toArray()) spec.parameters[value.toString()].fit = 0;
+
+    if (root.contains("sampling")) {
+        const QJsonObject sampling = root["sampling"].toObject();
+        spec.hasSampling = true;
+        spec.samplingMode = parseSamplingMode(sampling["mode"]);
+        spec.samplingIntervals = parseIntervals(sampling["intervals"].toArray());
+        spec.customSampling = !spec.samplingIntervals.isEmpty();
+    }
+    return true;
+}
+
+bool BatchInterpretation::loadProject(const QString& path, QList<BatchWellInput>& wells, QString* errorMessage)
+{
+    QJsonObject project;
+    if (!readJsonObject(path, project, errorMessage)) return false;
+
+    const QJsonObject fitting = project["fitting"].toObject();
+    const QJsonObject datasets = fitting["datasets"].toObject();
+    QJsonArray analyses = fitting["analyses"].toArray();
+    if (analyses.isEmpty() && fitting.contains("observedData")) analyses.append(fitting);
+
+    wells.clear();
+    for (int i = 0; i < analyses.size(); ++i) {
+        QJsonObject state = analyses[i].toObject();
+        if (state.value("type").toString() == "multiple") continue;
+
+        // 观测数据按编号引用项目级数据集 (与 FittingPage 的 resolveObservedData 相同)
+        const QString id = state.value("observedDataId").toString();
+        if (!state.contains("observedData") && datasets.contains(id)) state.insert("observedData", datasets.value(id));
+
+        BatchWellInput well;
+        well.name = analysisName(state, i);
+        well.observed = ObservedDataset::fromJson(state["observedData"].toObject());
+        if (!well.observed || well.observed->isEmpty()) continue;
+
+        if (state.contains("modelType")) {
+            well.hasModel = true;
+            well.modelType = (ModelEngine::ModelType)qBound(0, state["modelType"].toInt(), 5);
+            well.params = FitParameterCatalog::defaultParameters(well.modelType);
+            QMap<QString, QJsonObject> saved;
+            for (const QJsonValue& value : state["parameters"].toArray()) {
+                QJsonObject obj = value.toObject();
+                saved.insert(obj["name"].toString(), obj);
+            }
+            for (FitParameter& p : well.params) {
+                if (!saved.contains(p.name)) continue;
+                const QJsonObject obj = saved.value(p.name);
+                p.value = obj["value"].toDouble(p.value);
+                p.isFit = obj["isFit"].toBool(p.isFit);
+                p.min = obj["min"].toDouble(p.min);
+                p.max = obj["max"].toDouble(p.max);
+            }
+        }
+        if (state.contains("fitWeightVal")) well.weight = state["fitWeightVal"].toInt() / 100.0;
+        well.customSampling = state["useCustomSampling"].toBool();
+        well.samplingIntervals = parseIntervals(state["customIntervals"].toArray());
+        well.samplingMode = parseSamplingMode(state["samplingMode"]);
+        if (state.contains("reproducibility"))
+            well.reproducibility = FitReproducibility::fromJson(state["reproducibility"].toObject());
+        wells.append(well);
+    }
+    if (wells.isEmpty()) return fail(errorMessage, QString("项目中没有包含观测数据的拟合分析: %1").arg(path));
+    return true;
+}
+
+bool BatchInterpretation::loadCsv(const QString& path, double lSpacing, BatchWellInput& well, QString* errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return fail(errorMessage, QString("无法打开文件: %1").arg(path));
+
+    static const QRegularExpression separator("[,;\\t ]+");
+    QVector<double> t, p, d;
+    bool hasDerivative = true;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        const QStringList fields = line.split(separator, Qt::SkipEmptyParts);
+        if (fields.size() < 2) continue;
+        bool okT = false, okP = false, okD = false;
+        double tv = fields[0].toDouble(&okT);
+        double pv = fields[1].toDouble(&okP);
+        if (!okT || !okP) {
+            if (t.isEmpty()) continue; // 表头行
+            return fail(errorMessage, QString("%1: 无法解析的数据行 \"%2\"").arg(path, line));
+        }
+        double dv = fields.size() > 2 ? fields[2].toDouble(&okD) : 0.0;
+        if (!okD) hasDerivative = false;
+        if (tv <= 0.0) continue; // 对数坐标下无意义的时间点
+        t.append(tv);
+        p.append(pv);
+        d.append(dv);
+    }
+    if (t.size() < 3) return fail(errorMessage, QString("%1: 有效数据点不足").arg(path));
+    if (!hasDerivative) d = BourdetDerivativeEngine(t, lSpacing).derivative(p);
+
+    well = BatchWellInput();
+    well.name = QFileInfo(path).completeBaseName();
+    well.observed = ObservedDataset::create(t, p, d);
+    return true;
+}
+
+FitParameter BatchInterpretation::applyOverride(FitParameter p, const ParameterOverride& o)
+{
+    if (o.hasValue) p.value = o.value;
+    if (o.hasMin) p.min = o.min;
+    if (o.hasMax) p.max = o.max;
+    if (o.fit >= 0) p.isFit = (o.fit == 1);
+    return p;
+}
+
+bool BatchInterpretation::start(const QList<BatchWellInput>& wells, const BatchJobSpec& spec, QString* errorMessage)
+{
+    if (!m_coordinator) m_queue->setMaxConcurrent(spec.concurrency > 0 ? spec.concurrency : QThread::idealThreadCount());
+
+    QList<FittingJob> jobs;
+    for (const BatchWellInput& well : wells) {
+        if (!spec.analyses.isEmpty() && !spec.analyses.contains(well.name)) continue;
+
+        QList<ModelEngine::ModelType> models = spec.models;
+        if (models.isEmpty()) models << well.modelType;
+        for (ModelEngine::ModelType type : models) {
+            FittingJob job;
+            job.analysisName = well.name;
+            job.modelType = type;
+            QList<FitParameter> params = well.hasModel
+                ? (type == well.modelType ? well.params : FitParameterCatalog::adaptParameters(well.params, type))
+                : FitParameterCatalog::defaultParameters(type);
+            for (FitParameter& p : params) {
+                if (spec.parameters.contains(p.name)) p = applyOverride(p, spec.parameters.value(p.name));
+            }
+            // LfD 随 Lf/L 联动 (与参数表一致)
+            double L = 0.0, Lf = 0.0;
+            for (const FitParameter& p : params) {
+                if (p.name == "L") L = p.value;
+                if (p.name == "Lf") Lf = p.value;
+            }
+            for (FitParameter& p : params) {
+                if (p.name == "LfD" && L > 1e-9) p.value = Lf / L;
+            }
+            job.params = params;
+            job.weight = spec.weight >= 0.0 ? spec.weight : well.weight;
+            job.observed = well.observed;
+            job.customSampling = spec.hasSampling ? spec.customSampling : well.customSampling;
+            job.samplingIntervals = spec.hasSampling ? spec.samplingIntervals : well.samplingIntervals;
+            job.samplingMode = spec.hasSampling ? spec.samplingMode : well.samplingMode;
+            job.reproducibility = well.reproducibility;
+            jobs.append(job);
+        }
+    }
+    if (jobs.isEmpty()) return fail(errorMessage, "没有可运行的拟合任务 (检查 analyses 与 models)");
+
+    // 先确定任务总数再加入队列，避免第一个任务结束时总数尚不完整
+    m_reported.clear();
+    m_total = jobs.size();
+    for (const FittingJob& job : jobs) {
+        if (m_coordinator) m_coordinator->addJob(job);
+        else m_queue->addJob(job);
+    }
+    return true;
+}
+
+int BatchInterpretation::failedCount() const
+{
+    int count = 0;
+    for (const FittingJob& job : allJobs()) {
+        if (job.state != FittingJob::Finished || job.mse < 0.0) ++count;
+    }
+    return count;
+}
+
+QMap<int, int> BatchInterpretation::ranksWithinWell() const
+{
+    QMap<QString, QList<FittingJob>> byWell;
+    for (const FittingJob& job : rankedJobs()) byWell[job.analysisName].append(job);
+    QMap<int, int> ranks;
+    for (auto it = byWell.begin(); it != byWell.end(); ++it) {
+        for (int i = 0; i < it.value().size(); ++i) ranks.insert(it.value()[i].id, i + 1);
+    }
+    return ranks;
+}
+
+QMap<int, int> BatchInterpretation::ranksOverall() const
+{
+    QMap<int, int> ranks;
+    const QList<FittingJob> ranked = rankedJobs();
+    for (int i = 0; i < ranked.size(); ++i) ranks.insert(ranked[i].id, i + 1);
+    return ranks;
+}
+
+bool BatchInterpretation::writeResults(const QString& jsonPath, const QString& csvPath, QString* errorMessage) const
+{
+    const QMap<int, int> wellRanks = ranksWithinWell();
+    const QMap<int, int> totalRanks = ranksOverall();
+    const QList<FittingJob> jobs = allJobs();
+
+    // 参数列：全部任务结果中出现过的参数名 (按名称排序)
+    QStringList paramNames;
+    for (const FittingJob& job : jobs) {
+        for (auto it = job.result.begin(); it != job.result.end(); ++it) {
+            if (!paramNames.contains(it.key())) paramNames.append(it.key());
+        }
+    }
+    std::sort(paramNames.begin(), paramNames.end());
+
+    QJsonArray array;
+    QString csv;
+    QTextStream out(&csv);
+    out << "well,model,modelName,state,mse,wellRank,totalRank";
+    for (const QString& name : paramNames) out << "," << csvField(name);
+    out << "\n";
+
+    for (const FittingJob& job : jobs) {
+        const QString& well = job.analysisName;
+        const bool finished = job.state == FittingJob::Finished;
+        const QString state = finished ? "finished" : (job.state == FittingJob::Cancelled ? "cancelled" : "failed");
+
+        QJsonObject obj;
+        obj["well"] = well;
+        obj["model"] = (int)job.modelType + 1;
+        obj["modelName"] = ModelEngine::getModelTypeName(job.modelType);
+        obj["state"] = state;
+        obj["mse"] = job.mse;
+        obj["weight"] = job.weight;
+        if (wellRanks.contains(job.id)) obj["wellRank"] = wellRanks.value(job.id);
+        if (totalRanks.contains(job.id)) obj["totalRank"] = totalRanks.value(job.id);
+        QJsonObject params;
+        for (auto it = job.result.begin(); it != job.result.end(); ++it) params[it.key()] = it.value();
+        obj["parameters"] = params;
+        QJsonArray fitted;
+        for (const FitParameter& p : job.params) {
+            if (p.isFit && p.name != "LfD") fitted.append(p.name);
+        }
+        obj["fitted"] = fitted;
+        array.append(obj);
+
+        out << csvField(well) << "," << (int)job.modelType + 1 << "," << csvField(ModelEngine::getModelTypeName(job.modelType))
+            << "," << state << "," << QString::number(job.mse, 'g', 10)
+            << "," << (wellRanks.contains(job.id) ? QString::number(wellRanks.value(job.id)) : QString())
+            << "," << (totalRanks.contains(job.id) ? QString::number(totalRanks.value(job.id)) : QString());
+        for (const QString& name : paramNames) {
+            out << "," << (job.result.contains(name) ? QString::number(job.result.value(name), 'g', 10) : QString());
+        }
+        out << "\n";
+    }
+    out.flush();
+
+    QJsonObject root;
+    root["version"] = "1.0";
+    root["jobs"] = array;
+
+    QSaveFile jsonFile(jsonPath);
+    if (!jsonFile.open(QIODevice::WriteOnly)) return fail(errorMessage, QString("无法写入文件: %1").arg(jsonPath));
+    jsonFile.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!jsonFile.commit()) return fail(errorMessage, QString("写入失败: %1").arg(jsonPath));
+
+    // CSV 带 BOM，便于 Excel 按 UTF-8 打开中文列
+    QSaveFile csvFile(csvPath);
+    if (!csvFile.open(QIODevice::WriteOnly)) return fail(errorMessage, QString("无法写入文件: %1").arg(csvPath));
+    csvFile.write("\xEF\xBB\xBF");
+    csvFile.write(csv.toUtf8());
+    if (!csvFile.commit()) return fail(errorMessage, QString("写入失败: %1").arg(csvPath));
+    return true;
+}
+
+bool BatchInterpretation::writeProject(const QString& projectPath, int* updated, QString* errorMessage) const
+{
+    if (updated) *updated = 0;
+    QJsonObject project;
+    if (!readJsonObject(projectPath, project, errorMessage)) return false;
+
+    // 各分析井内排名第一的结果
+    QMap<QString, FittingJob> best;
+    for (const FittingJob& job : rankedJobs()) {
+        if (!best.contains(job.analysisName) && !job.result.isEmpty()) best.insert(job.analysisName, job);
+    }
+
+    QJsonObject fitting = project["fitting"].toObject();
+    QJsonArray analyses = fitting["analyses"].toArray();
+    const bool single = analyses.isEmpty() && fitting.contains("observedData");
+    if (single) analyses.append(fitting);
+
+    int count = 0;
+    for (int i = 0; i < analyses.size(); ++i) {
+        const QJsonObject state = analyses[i].toObject();
+        if (state.value("type").toString() == "multiple") continue;
+        const QString name = analysisName(state, i);
+        if (!best.contains(name)) continue;
+        analyses[i] = applyJobResult(state, best.value(name));
+        ++count;
+    }
+    if (count == 0) return true;
+
+    if (single) fitting = analyses.first().toObject();
+    else fitting["analyses"] = analyses;
+    project["fitting"] = fitting;
+
+    QSaveFile file(projectPath);
+    if (!file.open(QIODevice::WriteOnly)) return fail(errorMessage, QString("无法写入文件: %1").arg(projectPath));
+    file.write(QJsonDocument(project).toJson());
+    if (!file.commit()) return fail(errorMessage, QString("写入失败: %1").arg(projectPath));
+    if (updated) *updated = count;
+    return true;
+}
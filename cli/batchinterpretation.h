@@ -0,0 +1,127 @@
+/*
+ * 文件名: batchinterpretation.h
+ * 文件作用: 无界面批量试井解释头文件
+ * 功能描述:
+ * 1. 输入：项目文件 (.pwt，读取其中各拟合分析的观测数据、参数、权重与抽样设置) 或 CSV 数据文件
+ *    (列依次为 t、Δp，可选第三列导数；无导数列时按 Bourdet 方法计算)。
+ * 2. 任务描述 (JSON)：候选模型列表、压差权重、参数取值/上下限/是否拟合、抽样方式与区间、并发数；
+ *    未给出的项沿用项目中分析页签的设置 (CSV 输入时为默认参数表)。
+ * 3. 每个 (井/分析, 模型) 组合作为一个任务加入 FittingJobQueue，默认同时运行的任务数为 CPU 核数。
+ * 4. 输出：结果 JSON (各任务的状态、MSE、井内与总排名及拟合参数) 与 CSV 汇总表，以 QSaveFile 原子写出。
+ * 5. [分布式] listen 之后任务不在本机运行，而是交给 BatchCoordinator 分发到远程工作进程；
+ *    结果汇总、排名与输出格式与本地模式相同。
+ * 6. [写回项目] writeProject 把各分析井内排名第一的结果 (模型与参数) 写回项目文件中对应的拟合分析，
+ *    与界面中应用批量拟合结果相同；其余分析与项目的其他内容保持不变。
+ */
+
+#ifndef BATCHINTERPRETATION_H
+#define BATCHINTERPRETATION_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include "modelengine.h"
+#include "fitparameter.h"
+#include "fittingsampling.h"
+#include "fittingjobqueue.h"
+#include "observeddataset.h"
+
+class QHostAddress;
+class QJsonObject;
+class BatchCoordinator;
+
+// 任务描述中对单个参数的覆盖 (未给出的项保持原值)
+struct ParameterOverride {
+    bool hasValue = false;
+    double value = 0.0;
+    bool hasMin = false;
+    double min = 0.0;
+    bool hasMax = false;
+    double max = 0.0;
+    int fit = -1; // -1 不改变，0 固定，1 参与拟合
+};
+
+// 任务描述
+struct BatchJobSpec {
+    QList<ModelEngine::ModelType> models;        // 为空时使用各分析当前的模型
+    double weight = -1.0;                        // 压差权重，负值表示沿用分析的设置 (CSV 输入为 0.5)
+    QMap<QString, ParameterOverride> parameters;
+    QStringList analyses;                        // 只处理这些分析 (为空时处理全部)
+    bool hasSampling = false;                    // 为假时沿用分析的抽样设置
+    bool customSampling = false;
+    QList<SamplingInterval> samplingIntervals;
+    SamplingMode samplingMode = Sampling_NearestPoint;
+    int concurrency = 0;                         // 0 表示 CPU 核数
+    double lSpacing = 0.1;                       // CSV 输入计算导数的 L-Spacing
+};
+
+// 一口井 (或一个拟合分析) 的输入
+struct BatchWellInput {
+    QString name;
+    ObservedDataset::Handle observed;
+    bool hasModel = false;                       // 项目分析中记录了模型与参数
+    ModelEngine::ModelType modelType = ModelEngine::Model_1;
+    QList<FitParameter> params;
+    double weight = 0.5;
+    bool customSampling = false;
+    QList<SamplingInterval> samplingIntervals;
+    SamplingMode samplingMode = Sampling_NearestPoint;
+    FitReproducibility reproducibility = FitReproducibility::fromGlobalSettings(); // 分析状态中保存的设置优先
+};
+
+class BatchInterpretation : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BatchInterpretation(QObject* parent = nullptr);
+    ~BatchInterpretation();
+
+    // 读取任务描述
+    static bool loadJobSpec(const QString& path, BatchJobSpec& spec, QString* errorMessage = nullptr);
+    // 读取项目文件中的全部单分析页签 (多分析对比页签跳过)
+    static bool loadProject(const QString& path, QList<BatchWellInput>& wells, QString* errorMessage = nullptr);
+    // 读取 CSV 数据文件 (首个非数值行视为表头)
+    static bool loadCsv(const QString& path, double lSpacing, BatchWellInput& well, QString* errorMessage = nullptr);
+
+    // 分布式模式：在 address:port 上监听工作进程连接 (须在 start 之前调用)
+    bool listen(quint16 port, const QHostAddress& address, QString* errorMessage = nullptr);
+    BatchCoordinator* coordinator() const { return m_coordinator; }
+
+    // 按任务描述生成任务并启动；没有可运行的任务时返回 false
+    bool start(const QList<BatchWellInput>& wells, const BatchJobSpec& spec, QString* errorMessage = nullptr);
+
+    // 写出结果 (JSON 与 CSV 汇总)
+    bool writeResults(const QString& jsonPath, const QString& csvPath, QString* errorMessage = nullptr) const;
+    // 把各分析的最佳结果写回项目文件 (loadProject 读取的 .pwt)；updated 返回写回的分析数
+    bool writeProject(const QString& projectPath, int* updated = nullptr, QString* errorMessage = nullptr) const;
+
+    int jobCount() const { return m_total; }
+    // 本机计算的网格求值插值误差估计最大值 (分布式模式下为 0)
+    double gridInterpolationError() const { return m_engine.gridInterpolationError(); }
+    int failedCount() const;
+
+signals:
+    // 全部任务结束 (任务在 start 中即失败时可能在 start 返回前发出，接收方宜用排队连接)
+    void finished();
+    // 单个任务结束 (用于命令行进度输出)
+    void jobFinished(const QString& well, const QString& model, double mse, int done, int total);
+
+private:
+    static FitParameter applyOverride(FitParameter p, const ParameterOverride& o);
+    void onJobUpdated(int id);
+    QList<FittingJob> allJobs() const;
+    QList<FittingJob> rankedJobs() const;
+    QMap<int, int> ranksWithinWell() const;
+    QMap<int, int> ranksOverall() const;
+
+    ModelEngine m_engine;
+    FittingJobQueue* m_queue;        // 析构时先于 m_engine 释放 (等待拟合线程结束)
+    BatchCoordinator* m_coordinator = nullptr; // 分布式模式的协调进程 (本地模式为空)
+    QSet<int> m_reported;            // 已结束并通知过的任务
+    int m_total = 0;
+};
+
+#endif // BATCHINTERPRETATION_H
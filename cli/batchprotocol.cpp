@@ -0,0 +1,174 @@
+/*
+ * 文件名: batchprotocol.cpp
+ * 文件作用: 分布式批量解释通信协议实现文件
+ * 功能描述:
+ * 1. 行分帧：QJsonDocument::Compact 输出不含换行，消息内容中的换行均已转义，按行切分即可还原消息边界。
+ * 2. 参数列表保存 FitParameter 的全部字段 (含显示名与步长)，工作进程无需按模型重新查表。
+ * 3. 令牌取自系统随机源；比较时遍历全部字节，不因首个不同字节提前返回。
+ */
+
+#include "batchprotocol.h"
+
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+
+namespace BatchProtocol {
+
+namespace {
+
+QJsonArray doubleArray(const QVector<double>& values)
+{
+    QJsonArray array;
+    for (double v : values) array.append(v);
+    return array;
+}
+
+QVector<double> toDoubleVector(const QJsonArray& array)
+{
+    QVector<double> values;
+    values.reserve(array.size());
+    for (const QJsonValue& v : array) values.append(v.toDouble());
+    return values;
+}
+
+} // namespace
+
+QByteArray encode(const QJsonObject& message)
+{
+    QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    return line;
+}
+
+bool readMessages(QIODevice* device, QList<QJsonObject>& messages, QString* errorMessage, int maxBytes)
+{
+    while (device->canReadLine()) {
+        const QByteArray line = device->readLine().trimmed();
+        if (line.isEmpty()) continue;
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+        if (doc.isNull() || !doc.isObject()) {
+            if (errorMessage) *errorMessage = QString("消息格式错误: %1").arg(error.errorString());
+            return false;
+        }
+        messages.append(doc.object());
+    }
+    if (device->bytesAvailable() > maxBytes) {
+        if (errorMessage) *errorMessage = QString("消息超过 %1 字节上限").arg(maxBytes);
+        return false;
+    }
+    return true;
+}
+
+QString generateToken()
+{
+    quint32 words[4];
+    QRandomGenerator::system()->fillRange(words);
+    QByteArray bytes(reinterpret_cast<const char*>(words), sizeof(words));
+    return QString::fromLatin1(bytes.toHex());
+}
+
+bool tokensEqual(const QString& a, const QString& b)
+{
+    const QByteArray x = a.toUtf8();
+    const QByteArray y = b.toUtf8();
+    int diff = x.size() ^ y.size();
+    for (int i = 0; i < x.size(); ++i) diff |= x[i] ^ (i < y.size() ? y[i] : 0);
+    return diff == 0 && !x.isEmpty();
+}
+
+QJsonObject jobToJson(const FittingJob& job)
+{
+    QJsonObject json;
+    json["analysisName"] = job.analysisName;
+    json["modelType"] = (int)job.modelType;
+    json["weight"] = job.weight;
+    json["priority"] = job.priority;
+
+    QJsonArray params;
+    for (const FitParameter& p : job.params) {
+        QJsonObject obj;
+        obj["name"] = p.name;
+        obj["displayName"] = p.displayName;
+        obj["value"] = p.value;
+        obj["isFit"] = p.isFit;
+        obj["min"] = p.min;
+        obj["max"] = p.max;
+        obj["isVisible"] = p.isVisible;
+        obj["step"] = p.step;
+        obj["transform"] = (int)p.transform;
+        if (!p.orderedAbove.isEmpty()) obj["orderedAbove"] = p.orderedAbove;
+        params.append(obj);
+    }
+    json["parameters"] = params;
+
+    if (!job.rateHistory.isEmpty()) {
+        QJsonObject rate;
+        rate["startTime"] = doubleArray(job.rateHistory.startTime);
+        rate["rate"] = doubleArray(job.rateHistory.rate);
+        rate["buildup"] = job.rateHistoryBuildup;
+        json["rateHistory"] = rate;
+    }
+
+    QJsonArray intervals;
+    for (const SamplingInterval& item : job.samplingIntervals) {
+        QJsonObject obj;
+        obj["start"] = item.tStart;
+        obj["end"] = item.tEnd;
+        obj["count"] = item.count;
+        intervals.append(obj);
+    }
+    json["customSampling"] = job.customSampling;
+    json["samplingIntervals"] = intervals;
+    json["samplingMode"] = (int)job.samplingMode;
+    json["reproducibility"] = job.reproducibility.toJson();
+    return json;
+}
+
+FittingJob jobFromJson(const QJsonObject& json, const ObservedDataset::Handle& observed)
+{
+    FittingJob job;
+    job.analysisName = json["analysisName"].toString();
+    job.modelType = (ModelEngine::ModelType)qBound(0, json["modelType"].toInt(), 5);
+    job.weight = json["weight"].toDouble(0.5);
+    job.priority = json["priority"].toInt();
+
+    for (const QJsonValue& value : json["parameters"].toArray()) {
+        const QJsonObject obj = value.toObject();
+        FitParameter p;
+        p.name = obj["name"].toString();
+        p.displayName = obj["displayName"].toString();
+        p.value = obj["value"].toDouble();
+        p.isFit = obj["isFit"].toBool();
+        p.min = obj["min"].toDouble();
+        p.max = obj["max"].toDouble(100.0);
+        p.isVisible = obj["isVisible"].toBool(true);
+        p.step = obj["step"].toDouble(0.1);
+        p.transform = (FitParameter::Transform)qBound(0, obj["transform"].toInt(), (int)FitParameter::Transform_Logit);
+        p.orderedAbove = obj["orderedAbove"].toString();
+        job.params.append(p);
+    }
+
+    const QJsonObject rate = json["rateHistory"].toObject();
+    job.rateHistory.startTime = toDoubleVector(rate["startTime"].toArray());
+    job.rateHistory.rate = toDoubleVector(rate["rate"].toArray());
+    job.rateHistoryBuildup = rate["buildup"].toBool();
+
+    for (const QJsonValue& value : json["samplingIntervals"].toArray()) {
+        const QJsonObject obj = value.toObject();
+        SamplingInterval item;
+        item.tStart = obj["start"].toDouble();
+        item.tEnd = obj["end"].toDouble();
+        item.count = obj["count"].toInt();
+        job.samplingIntervals.append(item);
+    }
+    job.customSampling = json["customSampling"].toBool();
+    job.samplingMode = (SamplingMode)qBound(0, json["samplingMode"].toInt(), 2);
+    job.reproducibility = FitReproducibility::fromJson(json["reproducibility"].toObject());
+    job.observed = observed;
+    return job;
+}
+
+} // namespace BatchProtocol
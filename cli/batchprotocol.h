@@ -0,0 +1,53 @@
+/*
+ * 文件名: batchprotocol.h
+ * 文件作用: 分布式批量解释的协调进程/工作进程通信协议头文件
+ * 功能描述:
+ * 1. 消息为紧凑 JSON 对象，每条一行 (以 '\n' 结尾)，字段 type 为消息类型：
+ *    工作进程 → 协调进程: hello (协议版本、令牌、名称、同时运行的任务数)、heartbeat (运行中任务的进度)、result (任务结果)；
+ *    协调进程 → 工作进程: welcome (心跳间隔)、rejected (拒绝原因)、dataset (观测数据)、job (拟合任务)、heartbeat (心跳应答)、shutdown。
+ * 2. 观测数据按 ObservedDataset::idString 引用，每个工作进程只接收一次 (同一口井的多个候选模型共用)。
+ * 3. 任务的 JSON 字段覆盖 FittingJob 的全部输入 (参数、权重、产量历史、抽样设置与可复现种子)，
+ *    双精度数值按最短往返格式写出，工作进程上的拟合输入与协调进程逐位相同。
+ * 4. 握手：连接后的第一条消息须为 hello，其中的令牌与协调进程一致才发送 welcome 并分配任务，否则回复 rejected 后断开。
+ *    令牌以明文传输，只防止误连与未经许可的工作进程领取任务；跨不可信网络时应经 SSH 隧道等加密通道连接。
+ */
+
+#ifndef BATCHPROTOCOL_H
+#define BATCHPROTOCOL_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include "fittingjobqueue.h"
+
+class QIODevice;
+
+namespace BatchProtocol {
+
+enum {
+    Version = 2,                         // 2: hello 携带令牌
+    HeartbeatIntervalMs = 5000,          // 双方发送心跳的间隔
+    DefaultHeartbeatTimeoutMs = 30000,   // 超过该时长未收到对方消息即视为连接丢失
+    MaxMessageBytes = 256 * 1024 * 1024, // 单条消息上限 (超出视为协议错误)
+    MaxHandshakeBytes = 64 * 1024        // 完成握手之前的消息上限
+};
+
+// 编码为一行消息
+QByteArray encode(const QJsonObject& message);
+
+// 读出设备中全部完整的消息行；消息格式错误或超过 maxBytes 时返回 false
+bool readMessages(QIODevice* device, QList<QJsonObject>& messages, QString* errorMessage = nullptr,
+                  int maxBytes = MaxMessageBytes);
+
+// 随机生成连接令牌 (32 位十六进制)；比较令牌的耗时与内容无关
+QString generateToken();
+bool tokensEqual(const QString& a, const QString& b);
+
+// 任务输入 (不含观测数据，观测数据单独以 dataset 消息发送)
+QJsonObject jobToJson(const FittingJob& job);
+FittingJob jobFromJson(const QJsonObject& json, const ObservedDataset::Handle& observed);
+
+} // namespace BatchProtocol
+
+#endif // BATCHPROTOCOL_H
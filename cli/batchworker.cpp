@@ -0,0 +1,186 @@
+/*
+ * 文件名: batchworker.cpp
+ * 文件作用: 分布式批量解释的工作进程实现文件
+ * 功能描述:
+ * 1. 工作进程名称为 "主机名/进程号"，便于协调进程输出中区分同一台机器上的多个工作进程。
+ * 2. 连接丢失时先清空任务编号映射再停止本地任务，停止产生的结束通知不会再回报给 (新的) 协调进程连接。
+ * 3. 观测数据在断开后同样清空：重连后协调进程按新连接重新发送。
+ */
+
+#include "batchworker.h"
+#include "batchprotocol.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QHostInfo>
+#include <QJsonArray>
+#include <QTcpSocket>
+
+BatchWorker::BatchWorker(QObject* parent)
+    : QObject(parent), m_socket(new QTcpSocket(this)), m_heartbeatTimeoutMs(BatchProtocol::DefaultHeartbeatTimeoutMs)
+{
+    m_queue = new FittingJobQueue(&m_engine, this);
+    connect(m_queue, &FittingJobQueue::sigJobUpdated, this, &BatchWorker::onJobUpdated);
+    connect(m_socket, &QTcpSocket::connected, this, &BatchWorker::onConnected);
+    connect(m_socket, &QTcpSocket::disconnected, this, &BatchWorker::onDisconnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &BatchWorker::onReadyRead);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, [this]() {
+        if (m_socket->state() != QAbstractSocket::ConnectedState) onDisconnected();
+    });
+    connect(&m_heartbeatTimer, &QTimer::timeout, this, &BatchWorker::sendHeartbeat);
+    m_reconnectTimer.setSingleShot(true);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &BatchWorker::connectToCoordinator);
+}
+
+BatchWorker::~BatchWorker()
+{
+    m_socket->disconnect(this);
+    // 队列析构时停止并等待拟合线程，须在计算引擎释放之前完成
+    delete m_queue;
+}
+
+void BatchWorker::start(const QString& host, quint16 port, int slots)
+{
+    m_host = host;
+    m_port = port;
+    m_slots = qMax(1, slots);
+    m_queue->setMaxConcurrent(m_slots);
+    m_slots = m_queue->maxConcurrent();
+    connectToCoordinator();
+}
+
+void BatchWorker::setHeartbeatTimeout(int ms)
+{
+    m_heartbeatTimeoutMs = qMax(2 * int(BatchProtocol::HeartbeatIntervalMs), ms);
+}
+
+void BatchWorker::send(const QJsonObject& message)
+{
+    m_socket->write(BatchProtocol::encode(message));
+}
+
+void BatchWorker::connectToCoordinator()
+{
+    if (m_shuttingDown) return;
+    m_socket->abort();
+    m_socket->connectToHost(m_host, m_port);
+}
+
+void BatchWorker::onConnected()
+{
+    m_failedAttempts = 0;
+    m_lastSeen = QDateTime::currentMSecsSinceEpoch();
+    QJsonObject hello;
+    hello["type"] = "hello";
+    hello["version"] = int(BatchProtocol::Version);
+    hello["token"] = m_token;
+    hello["name"] = QString("%1/%2").arg(QHostInfo::localHostName()).arg(QCoreApplication::applicationPid());
+    hello["slots"] = m_slots;
+    send(hello);
+    m_heartbeatTimer.start(BatchProtocol::HeartbeatIntervalMs);
+    emit statusMessage(QString("已连接协调进程 %1:%2 (同时运行 %3 个任务)").arg(m_host).arg(m_port).arg(m_slots));
+}
+
+void BatchWorker::onDisconnected()
+{
+    m_heartbeatTimer.stop();
+    abandonJobs();
+    if (m_shuttingDown || m_reconnectTimer.isActive()) return;
+    if (++m_failedAttempts > ReconnectAttempts) {
+        emit statusMessage(QString("无法连接协调进程 %1:%2: %3").arg(m_host).arg(m_port).arg(m_socket->errorString()));
+        m_shuttingDown = true;
+        emit finished(false);
+        return;
+    }
+    emit statusMessage(QString("与协调进程的连接中断，%1 秒后重连 (%2/%3)")
+                           .arg(ReconnectIntervalMs / 1000).arg(m_failedAttempts).arg(int(ReconnectAttempts)));
+    m_reconnectTimer.start(ReconnectIntervalMs);
+}
+
+void BatchWorker::abandonJobs()
+{
+    m_remoteIds.clear();
+    m_datasets.clear();
+    m_queue->cancelAll();
+}
+
+void BatchWorker::onReadyRead()
+{
+    m_lastSeen = QDateTime::currentMSecsSinceEpoch();
+    QList<QJsonObject> messages;
+    QString error;
+    const bool ok = BatchProtocol::readMessages(m_socket, messages, &error);
+    for (const QJsonObject& message : messages) {
+        handleMessage(message);
+        if (m_shuttingDown) return;
+    }
+    if (!ok) {
+        emit statusMessage(error);
+        m_socket->abort();
+    }
+}
+
+void BatchWorker::handleMessage(const QJsonObject& message)
+{
+    const QString type = message["type"].toString();
+    if (type == "dataset") {
+        m_datasets.insert(message["id"].toString(), ObservedDataset::fromJson(message["data"].toObject()));
+    } else if (type == "job") {
+        const int remoteId = message["id"].toInt();
+        FittingJob job = BatchProtocol::jobFromJson(message["job"].toObject(),
+                                                    m_datasets.value(message["datasetId"].toString(), ObservedDataset::empty()));
+        // 先登记映射再加入队列：没有拟合参数等情况下任务在 addJob 返回前即已结束
+        m_remoteIds.insert(m_queue->nextJobId(), remoteId);
+        m_queue->addJob(job);
+    } else if (type == "rejected") {
+        m_shuttingDown = true;
+        m_heartbeatTimer.stop();
+        abandonJobs();
+        m_socket->abort();
+        emit statusMessage(QString("协调进程拒绝连接: %1").arg(message["reason"].toString()));
+        emit finished(false);
+    } else if (type == "shutdown") {
+        m_shuttingDown = true;
+        m_heartbeatTimer.stop();
+        abandonJobs();
+        m_socket->disconnectFromHost();
+        emit statusMessage("协调进程已结束全部任务");
+        emit finished(true);
+    }
+}
+
+void BatchWorker::onJobUpdated(int localId)
+{
+    if (!m_remoteIds.contains(localId)) return;
+    const FittingJob job = m_queue->job(localId);
+    if (job.state != FittingJob::Finished && job.state != FittingJob::Cancelled) return;
+
+    QJsonObject result;
+    result["type"] = "result";
+    result["id"] = m_remoteIds.take(localId);
+    result["state"] = job.state == FittingJob::Finished ? "finished" : "cancelled";
+    result["mse"] = job.mse;
+    QJsonObject params;
+    for (auto it = job.result.begin(); it != job.result.end(); ++it) params[it.key()] = it.value();
+    result["parameters"] = params;
+    send(result);
+    emit statusMessage(QString("任务 %1 %2 %3 MSE = %4").arg(result["id"].toInt()).arg(job.analysisName,
+                           ModelEngine::getModelTypeName(job.modelType)).arg(job.mse, 0, 'g', 6));
+}
+
+void BatchWorker::sendHeartbeat()
+{
+    if (QDateTime::currentMSecsSinceEpoch() - m_lastSeen > m_heartbeatTimeoutMs) {
+        emit statusMessage(QString("%1 秒内没有收到协调进程的消息").arg(m_heartbeatTimeoutMs / 1000));
+        m_socket->abort();
+        return;
+    }
+    QJsonObject progress;
+    for (auto it = m_remoteIds.constBegin(); it != m_remoteIds.constEnd(); ++it) {
+        progress[QString::number(it.value())] = m_queue->job(it.key()).progress;
+    }
+    QJsonObject heartbeat;
+    heartbeat["type"] = "heartbeat";
+    heartbeat["progress"] = progress;
+    send(heartbeat);
+}
@@ -0,0 +1,79 @@
+/*
+ * 文件名: batchworker.h
+ * 文件作用: 分布式批量解释的工作进程头文件
+ * 功能描述:
+ * 1. 连接协调进程 (welltestcli --listen)，在 hello 中报告同时运行的任务数，收到的任务在本地 FittingJobQueue 中拟合，
+ *    结束后回报最终误差与参数；运行中每个心跳间隔回报一次各任务的进度。
+ * 2. 超过心跳超时未收到协调进程的消息或连接断开时，停止本地全部任务 (协调进程会重新分配)，
+ *    按重连间隔尝试重新连接，连续失败 ReconnectAttempts 次后结束。
+ * 3. 收到 shutdown 后停止本地任务并发出 finished。
+ * 4. hello 携带协调进程的令牌 (setToken)；协调进程回复 rejected (令牌或协议版本不符) 时不再重连，直接以失败结束。
+ */
+
+#ifndef BATCHWORKER_H
+#define BATCHWORKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QTimer>
+#include "modelengine.h"
+#include "fittingjobqueue.h"
+
+class QTcpSocket;
+
+class BatchWorker : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        ReconnectIntervalMs = 5000,
+        ReconnectAttempts = 12
+    };
+
+    explicit BatchWorker(QObject* parent = nullptr);
+    ~BatchWorker();
+
+    // 连接协调进程；slots 为同时运行的任务数
+    void start(const QString& host, quint16 port, int slots);
+
+    void setHeartbeatTimeout(int ms);
+    void setToken(const QString& token) { m_token = token; }
+
+signals:
+    // 协调进程要求退出 (normal 为 true)，或拒绝连接、重连失败 (normal 为 false)
+    void finished(bool normal);
+    // 连接状态与任务进度 (用于命令行输出)
+    void statusMessage(const QString& text);
+
+private:
+    void connectToCoordinator();
+    void onConnected();
+    void onDisconnected();
+    void onReadyRead();
+    void handleMessage(const QJsonObject& message);
+    void onJobUpdated(int localId);
+    void sendHeartbeat();
+    void abandonJobs();
+    void send(const QJsonObject& message);
+
+    ModelEngine m_engine;
+    FittingJobQueue* m_queue;             // 析构时先于 m_engine 释放 (等待拟合线程结束)
+    QTcpSocket* m_socket;
+    QTimer m_heartbeatTimer;
+    QTimer m_reconnectTimer;
+    QString m_host;
+    QString m_token;
+    quint16 m_port = 0;
+    int m_slots = 1;
+    int m_failedAttempts = 0;
+    int m_heartbeatTimeoutMs;
+    qint64 m_lastSeen = 0;
+    bool m_shuttingDown = false;
+    QHash<QString, ObservedDataset::Handle> m_datasets; // 协调进程已发送的观测数据
+    QMap<int, int> m_remoteIds;                          // 本地任务编号 → 协调进程任务编号
+};
+
+#endif // BATCHWORKER_H
@@ -0,0 +1,242 @@
+/*
+ * main.cpp (cli)
+ * 文件作用: 无界面批量试井解释命令行入口
+ * 功能描述:
+ * 1. 用法: welltestcli <项目.pwt | 数据.csv> -j <任务.json> [-o <输出前缀>] [-n <并发数>]
+ * 2. 输出 <前缀>.json (完整结果) 与 <前缀>.csv (汇总表)；未指定前缀时为输入文件名加 "_fit"。
+ * 3. 运行在 QCoreApplication 上，不需要显示环境；每个任务结束时在标准错误输出一行进度。
+ * 4. 退出码: 0 全部任务完成，1 参数或输入错误，2 部分任务失败，3 结果写出失败。
+ * 5. --trace <文件> 在本次运行中开启性能跟踪，结束时导出 Chrome trace 文件 (不受图形界面设置项影响)。
+ * 6. 启动时应用与图形界面相同的性能设置 (线程数、缺省 nf、Laplace 缓存、类型曲线库目录)，保证两者计算结果一致。
+ * 7. --backend <cpu|opencl> 覆盖设置项 performance/laplaceBackend；设备后端不可用时在标准错误输出原因并按 CPU 继续。
+ * 8. 分布式模式: welltestcli <输入> -j <任务.json> --listen <端口> 作为协调进程，任务由远程工作进程运行，结果照常写出；
+ *    welltestcli --worker <主机:端口> [-n <并发数>] 作为工作进程 (不需要输入文件)，协调进程结束全部任务后退出 (退出码 0)，
+ *    重连失败时退出码为 4。--heartbeat-timeout <秒> 与 --max-attempts <次数> 调整丢失判定与重试次数。
+ *    协调进程默认只监听 127.0.0.1，--bind <地址> 指定其他地址 (如 0.0.0.0)；双方以 --token <令牌> 共用连接令牌，
+ *    协调进程未指定时随机生成并输出到标准错误，工作进程必须给出。令牌不符时工作进程不再重连，退出码为 4。
+ * 9. --update-project 把各分析排名第一的结果 (模型与参数) 写回输入的项目文件，只适用于 .pwt 输入；写回失败时退出码为 3。
+ * 10. 网格求值模式的插值误差估计超过 1e-3 时，结束时在标准错误输出一次提示。
+ */
+
+#include "batchinterpretation.h"
+#include "batchcoordinator.h"
+#include "batchprotocol.h"
+#include "batchworker.h"
+#include "laplacebatchbackend.h"
+#include "performancesettings.h"
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QDir>
+#include <QHostAddress>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("welltestcli");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("试井批量解释: 按任务描述对项目或 CSV 数据拟合候选模型，输出 JSON/CSV 结果");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("input", "项目文件 (.pwt) 或 CSV 数据文件 (t, Δp[, 导数])");
+    QCommandLineOption jobOption(QStringList() << "j" << "job", "任务描述 JSON 文件", "file");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "输出文件前缀 (生成 .json 与 .csv)", "prefix");
+    QCommandLineOption threadsOption(QStringList() << "n" << "threads", "同时运行的拟合任务数 (默认 CPU 核数)", "count");
+    parser.addOption(jobOption);
+    parser.addOption(outputOption);
+    QCommandLineOption traceOption("trace", "开启性能跟踪并在结束时导出 Chrome trace 文件", "file");
+    QCommandLineOption backendOption("backend", "批量储层响应求值后端: " + LaplaceBatchBackend::availableBackends().join(" / "), "name");
+    parser.addOption(threadsOption);
+    parser.addOption(traceOption);
+    QCommandLineOption listenOption("listen", "作为协调进程监听端口，任务分发给远程工作进程", "port");
+    QCommandLineOption workerOption("worker", "作为工作进程连接协调进程", "host:port");
+    QCommandLineOption heartbeatOption("heartbeat-timeout", "超过该时长没有心跳即视为连接丢失 (默认 30)", "seconds");
+    QCommandLineOption attemptsOption("max-attempts", "单个任务在工作进程丢失后最多尝试的次数 (默认 3)", "count");
+    QCommandLineOption bindOption("bind", "协调进程监听的地址 (默认 127.0.0.1，接受远程工作进程时指定本机网卡地址或 0.0.0.0)", "address");
+    QCommandLineOption tokenOption("token", "协调进程与工作进程共用的连接令牌 (协调进程未指定时随机生成)", "token");
+    QCommandLineOption updateProjectOption("update-project", "把各分析排名第一的结果写回项目文件 (仅 .pwt 输入)");
+    parser.addOption(backendOption);
+    parser.addOption(listenOption);
+    parser.addOption(workerOption);
+    parser.addOption(heartbeatOption);
+    parser.addOption(attemptsOption);
+    parser.addOption(bindOption);
+    parser.addOption(tokenOption);
+    parser.addOption(updateProjectOption);
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const int heartbeatTimeoutMs = parser.isSet(heartbeatOption) ? parser.value(heartbeatOption).toInt() * 1000
+                                                                  : int(BatchProtocol::DefaultHeartbeatTimeoutMs);
+
+    // 工作进程模式：不读取输入，任务全部来自协调进程
+    if (parser.isSet(workerOption)) {
+        const QString address = parser.value(workerOption);
+        const int colon = address.lastIndexOf(':');
+        bool portOk = false;
+        const quint16 port = colon > 0 ? quint16(address.mid(colon + 1).toUInt(&portOk)) : 0;
+        if (!portOk || port == 0) {
+            err << "工作进程地址应为 主机:端口 (" << address << ")\n";
+            return 1;
+        }
+        if (parser.value(tokenOption).isEmpty()) {
+            err << "工作进程需要用 --token 给出协调进程的连接令牌\n";
+            return 1;
+        }
+        PerformanceSettings performance = PerformanceSettings::fromGlobalSettings();
+        if (parser.isSet(backendOption)) performance.laplaceBackend = parser.value(backendOption);
+        performance.apply();
+
+        BatchWorker worker;
+        worker.setHeartbeatTimeout(heartbeatTimeoutMs);
+        worker.setToken(parser.value(tokenOption));
+        QObject::connect(&worker, &BatchWorker::statusMessage, &app, [&err](const QString& text) {
+            err << text << "\n";
+            err.flush();
+        });
+        int exitCode = 0;
+        QObject::connect(&worker, &BatchWorker::finished, &app, [&](bool normal) {
+            exitCode = normal ? 0 : 4;
+            app.quit();
+        }, Qt::QueuedConnection);
+        const int slots = parser.isSet(threadsOption) ? qMax(1, parser.value(threadsOption).toInt())
+                                                      : FittingJobQueue::defaultConcurrency();
+        worker.start(address.left(colon), port, slots);
+        app.exec();
+        return exitCode;
+    }
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 1 || !parser.isSet(jobOption)) {
+        err << parser.helpText();
+        return 1;
+    }
+
+    const QString input = args.first();
+    const bool isProject = QFileInfo(input).suffix().compare("pwt", Qt::CaseInsensitive) == 0;
+    if (parser.isSet(updateProjectOption) && !isProject) {
+        err << "--update-project 只适用于项目文件 (.pwt) 输入\n";
+        return 1;
+    }
+    QString error;
+    BatchJobSpec spec;
+    if (!BatchInterpretation::loadJobSpec(parser.value(jobOption), spec, &error)) {
+        err << error << "\n";
+        return 1;
+    }
+    if (parser.isSet(threadsOption)) spec.concurrency = qMax(1, parser.value(threadsOption).toInt());
+
+    QList<BatchWellInput> wells;
+    bool loaded = false;
+    if (isProject) {
+        loaded = BatchInterpretation::loadProject(input, wells, &error);
+    } else {
+        BatchWellInput well;
+        loaded = BatchInterpretation::loadCsv(input, spec.lSpacing, well, &error);
+        if (loaded) wells.append(well);
+    }
+    if (!loaded) {
+        err << error << "\n";
+        return 1;
+    }
+
+    QString prefix = parser.value(outputOption);
+    if (prefix.isEmpty()) {
+        QFileInfo info(input);
+        prefix = info.dir().filePath(info.completeBaseName() + "_fit");
+    }
+
+    const QString tracePath = parser.value(traceOption);
+    Trace::setEnabled(!tracePath.isEmpty());
+    PerformanceSettings performance = PerformanceSettings::fromGlobalSettings();
+    if (parser.isSet(backendOption)) performance.laplaceBackend = parser.value(backendOption);
+    performance.apply();
+    if (LaplaceBatchBackend::activeBackend() != performance.laplaceBackend && performance.laplaceBackend != "cpu") {
+        err << "后端 " << performance.laplaceBackend << " 不可用，按 CPU 计算: " << LaplaceBatchBackend::lastFallbackReason() << "\n";
+        err.flush();
+    }
+
+    BatchInterpretation batch;
+    if (parser.isSet(listenOption)) {
+        QHostAddress bindAddress(QHostAddress::LocalHost);
+        if (parser.isSet(bindOption)) {
+            const QString text = parser.value(bindOption);
+            if (text.compare("localhost", Qt::CaseInsensitive) != 0 && !bindAddress.setAddress(text)) {
+                err << "无法识别的监听地址: " << text << "\n";
+                return 1;
+            }
+        }
+        if (!batch.listen(quint16(parser.value(listenOption).toUInt()), bindAddress, &error)) {
+            err << error << "\n";
+            return 1;
+        }
+        BatchCoordinator* coordinator = batch.coordinator();
+        coordinator->setToken(parser.value(tokenOption));
+        coordinator->setHeartbeatTimeout(heartbeatTimeoutMs);
+        if (parser.isSet(attemptsOption)) coordinator->setMaxAttempts(parser.value(attemptsOption).toInt());
+        QObject::connect(coordinator, &BatchCoordinator::workerConnected, &app, [&err](const QString& name, int slots) {
+            err << "工作进程已连接: " << name << " (" << slots << " 个任务)\n";
+            err.flush();
+        });
+        QObject::connect(coordinator, &BatchCoordinator::workerLost, &app,
+                         [&err](const QString& name, const QString& reason, int requeued) {
+                             err << "工作进程丢失: " << name << " (" << reason << ")，" << requeued << " 个任务重新排队\n";
+                             err.flush();
+                         });
+        QObject::connect(coordinator, &BatchCoordinator::workerRejected, &app, [&err](const QString& name, const QString& reason) {
+            err << "拒绝连接: " << name << " (" << reason << ")\n";
+            err.flush();
+        });
+        err << "协调进程监听 " << bindAddress.toString() << ":" << coordinator->serverPort() << "，等待工作进程连接\n";
+        if (!parser.isSet(tokenOption)) err << "连接令牌: " << coordinator->token() << " (工作进程以 --token 传入)\n";
+        err.flush();
+    }
+    QObject::connect(&batch, &BatchInterpretation::jobFinished, &app,
+                     [&err](const QString& well, const QString& model, double mse, int done, int total) {
+                         err << QString("[%1/%2] %3 %4 MSE = %5").arg(done).arg(total).arg(well, model).arg(mse, 0, 'g', 6) << "\n";
+                         err.flush();
+                     });
+    int exitCode = 0;
+    QObject::connect(&batch, &BatchInterpretation::finished, &app, [&]() {
+        if (batch.coordinator()) batch.coordinator()->shutdownWorkers();
+        if (batch.gridInterpolationError() > 1e-3) {
+            err << "网格求值插值误差估计最大为 " << batch.gridInterpolationError() << "，可增大 solver/gridPointsPerDecade\n";
+        }
+        QString writeError;
+        if (!batch.writeResults(prefix + ".json", prefix + ".csv", &writeError)) {
+            err << writeError << "\n";
+            exitCode = 3;
+        } else {
+            err << "结果已写出: " << prefix << ".json, " << prefix << ".csv\n";
+            exitCode = batch.failedCount() > 0 ? 2 : 0;
+        }
+        if (parser.isSet(updateProjectOption)) {
+            int updated = 0;
+            if (!batch.writeProject(input, &updated, &writeError)) {
+                err << writeError << "\n";
+                exitCode = 3;
+            } else {
+                err << "已写回项目: " << input << " (" << updated << " 个分析)\n";
+            }
+        }
+        app.quit();
+    }, Qt::QueuedConnection);
+
+    if (!batch.start(wells, spec, &error)) {
+        err << error << "\n";
+        return 1;
+    }
+    app.exec();
+
+    if (!tracePath.isEmpty()) {
+        QString traceError;
+        if (Trace::exportChromeTrace(tracePath, &traceError)) err << "性能跟踪已导出: " << tracePath << "\n";
+        else err << traceError << "\n";
+    }
+    return exitCode;
+}
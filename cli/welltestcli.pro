@@ -0,0 +1,39 @@
+# ----------------------------------------------------
+# Project: welltestcli
+# Description: 无界面批量试井解释命令行工具 (与主程序共用计算核心 computecore.pri)
+# ----------------------------------------------------
+
+QT = core gui concurrent network
+
+TEMPLATE = app
+TARGET = welltestcli
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+# 编译优化选项
+QMAKE_CXXFLAGS += -O3
+QMAKE_CXXFLAGS_RELEASE -= -O2
+QMAKE_CXXFLAGS_RELEASE += -O3
+
+# 数学库链接
+unix: LIBS += -lm
+win32: LIBS += -lm
+
+# 计算核心 (求解器、导数、抽样与拟合)
+include(../computecore.pri)
+
+HEADERS += \
+           batchcoordinator.h \
+           batchinterpretation.h \
+           batchprotocol.h \
+           batchworker.h
+
+SOURCES += \
+           batchcoordinator.cpp \
+           batchinterpretation.cpp \
+           batchprotocol.cpp \
+           batchworker.cpp \
+           main.cpp
+
+# 警告设置
+QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter
@@ -0,0 +1,787 @@
+/*
+ * columnartablemodel.cpp
+ * 文件作用: 按列存储的数据表模型实现文件
+ * 功能描述:
+ * 1. 单元格文本按 QString::toDouble 解析 (与原先各处逐格 toDouble 的规则相同)，有限数值按数值保存，
+ *    并记录原文的小数位，显示时按相同小数位格式化 ("12.3400" 仍显示为 12.3400)；带指数的数值按 15 位有效数字显示。
+ * 2. setText / setValue 写入超出范围的单元格时自动增加行列 (与 QStandardItemModel::setItem 相同)。
+ * 3. 行列插入删除时背景色随单元格移动。
+ * 4. appendBlock 按列整段拼接数值数组，只对文本单元格逐个编号。
+ * 5. 撤销切片：行区间按各列 mid 复制；整列切片直接共享列数组，放回时不复制 (长度不符时才补齐)。
+ * 6. 压缩驻留：数组与撤销切片、快照或下游曲线共享的列压缩后并不释放内存，compress 跳过这些列；
+ *    各列的压缩与整表解压经 TaskScheduler 并行。整表导出 (toBlock、snapshot、copyColumns) 解压到副本，不改变驻留状态。
+ */
+
+#include "columnartablemodel.h"
+#include "columncodec.h"
+#include "memoryaccounting.h"
+#include "taskscheduler.h"
+
+#include <QBrush>
+#include <QDateTime>
+#include <QDebug>
+#include <QStringView>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const double kEmpty = std::numeric_limits<double>::quiet_NaN();
+const int kMaxDecimals = 17;
+}
+
+ColumnarTableModel::ColumnarTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int ColumnarTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int ColumnarTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_columns.size();
+}
+
+QVariant ColumnarTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rowCount || index.column() >= m_columns.size()) return QVariant();
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return text(index.row(), index.column());
+    case Qt::BackgroundRole: {
+        if (m_backgrounds.isEmpty()) return QVariant();
+        auto it = m_backgrounds.constFind(cellKey(index.row(), index.column()));
+        if (it == m_backgrounds.constEnd()) return QVariant();
+        return QBrush(it.value());
+    }
+    case Qt::ForegroundRole: {
+        const QColor& color = m_columns[index.column()].foreground;
+        return color.isValid() ? QVariant(QBrush(color)) : QVariant();
+    }
+    default:
+        return QVariant();
+    }
+}
+
+bool ColumnarTableModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!index.isValid()) return false;
+    if (role == Qt::BackgroundRole) {
+        setBackground(index.row(), index.column(), value.value<QColor>());
+        return true;
+    }
+    if (role != Qt::EditRole && role != Qt::DisplayRole) return false;
+    setText(index.row(), index.column(), value.toString());
+    return true;
+}
+
+QVariant ColumnarTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole && role != Qt::EditRole) return QVariant();
+    if (orientation == Qt::Horizontal && section >= 0 && section < m_headers.size() && !m_headers[section].isNull())
+        return m_headers[section];
+    return section + 1;
+}
+
+bool ColumnarTableModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role)
+{
+    if (orientation != Qt::Horizontal || (role != Qt::EditRole && role != Qt::DisplayRole)) return false;
+    if (section < 0 || section >= m_headers.size()) return false;
+    m_headers[section] = value.toString();
+    if (!m_loading) emit headerDataChanged(Qt::Horizontal, section, section);
+    return true;
+}
+
+Qt::ItemFlags ColumnarTableModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) return Qt::NoItemFlags;
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsEditable;
+}
+
+bool ColumnarTableModel::insertRows(int row, int count, const QModelIndex& parent)
+{
+    if (parent.isValid() || row < 0 || row > m_rowCount || count <= 0) return false;
+    ensureResident();
+    if (!m_loading) beginInsertRows(QModelIndex(), row, row + count - 1);
+    for (Column& c : m_columns) {
+        c.values.insert(row, count, kEmpty);
+        c.decimals.insert(row, count, qint8(-1));
+        if (!c.textIds.isEmpty()) c.textIds.insert(row, count, -1);
+    }
+    m_rowCount += count;
+    moveBackgrounds(Qt::Vertical, row, count);
+    if (!m_loading) endInsertRows();
+    return true;
+}
+
+bool ColumnarTableModel::removeRows(int row, int count, const QModelIndex& parent)
+{
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > m_rowCount) return false;
+    ensureResident();
+    if (!m_loading) beginRemoveRows(QModelIndex(), row, row + count - 1);
+    for (Column& c : m_columns) {
+        c.values.remove(row, count);
+        c.decimals.remove(row, count);
+        if (!c.textIds.isEmpty()) c.textIds.remove(row, count);
+    }
+    m_rowCount -= count;
+    moveBackgrounds(Qt::Vertical, row, -count);
+    if (!m_loading) endRemoveRows();
+    return true;
+}
+
+bool ColumnarTableModel::insertColumns(int column, int count, const QModelIndex& parent)
+{
+    if (parent.isValid() || column < 0 || column > m_columns.size() || count <= 0) return false;
+    if (!m_loading) beginInsertColumns(QModelIndex(), column, column + count - 1);
+    Column empty;
+    resizeColumn(empty, m_rowCount);
+    if (m_loading && m_loadReserve > m_rowCount) {
+        empty.values.reserve(m_loadReserve);
+        empty.decimals.reserve(m_loadReserve);
+    }
+    m_columns.insert(column, count, empty);
+    for (int i = 0; i < count; ++i) m_headers.insert(column, QString());
+    moveBackgrounds(Qt::Horizontal, column, count);
+    if (!m_loading) endInsertColumns();
+    return true;
+}
+
+bool ColumnarTableModel::removeColumns(int column, int count, const QModelIndex& parent)
+{
+    if (parent.isValid() || column < 0 || count <= 0 || column + count > m_columns.size()) return false;
+    if (!m_loading) beginRemoveColumns(QModelIndex(), column, column + count - 1);
+    m_columns.remove(column, count);
+    for (int i = 0; i < count; ++i) m_headers.removeAt(column);
+    moveBackgrounds(Qt::Horizontal, column, -count);
+    if (!m_loading) endRemoveColumns();
+    return true;
+}
+
+void ColumnarTableModel::clear()
+{
+    if (!m_loading) beginResetModel();
+    m_columns.clear();
+    m_headers.clear();
+    m_rowCount = 0;
+    m_strings.clear();
+    m_stringIds.clear();
+    m_backgrounds.clear();
+    if (!m_loading) endResetModel();
+}
+
+void ColumnarTableModel::setHorizontalHeaderLabels(const QStringList& labels)
+{
+    if (labels.size() > m_columns.size()) insertColumns(m_columns.size(), labels.size() - m_columns.size());
+    for (int i = 0; i < labels.size(); ++i) m_headers[i] = labels[i];
+    if (!m_loading && !labels.isEmpty()) emit headerDataChanged(Qt::Horizontal, 0, labels.size() - 1);
+}
+
+QString ColumnarTableModel::headerText(int column) const
+{
+    if (column < 0 || column >= m_headers.size()) return QString();
+    return m_headers[column];
+}
+
+void ColumnarTableModel::beginLoad(int expectedRows)
+{
+    if (m_loading) return;
+    ensureResident();
+    beginResetModel();
+    m_loading = true;
+    m_loadReserve = qMax(0, expectedRows);
+    if (expectedRows > 0) {
+        for (Column& c : m_columns) {
+            c.values.reserve(expectedRows);
+            c.decimals.reserve(expectedRows);
+        }
+    }
+}
+
+void ColumnarTableModel::endLoad()
+{
+    if (!m_loading) return;
+    m_loading = false;
+    m_loadReserve = 0;
+    for (Column& c : m_columns) {
+        c.values.squeeze();
+        c.decimals.squeeze();
+        c.textIds.squeeze();
+    }
+    endResetModel();
+}
+
+void ColumnarTableModel::appendRow(const QStringList& fields)
+{
+    if (fields.size() > m_columns.size()) insertColumns(m_columns.size(), fields.size() - m_columns.size());
+    ensureResident();
+
+    const int row = m_rowCount;
+    if (!m_loading) beginInsertRows(QModelIndex(), row, row);
+    for (Column& c : m_columns) {
+        c.values.append(kEmpty);
+        c.decimals.append(qint8(-1));
+        if (!c.textIds.isEmpty()) c.textIds.append(-1);
+    }
+    ++m_rowCount;
+    for (int i = 0; i < fields.size(); ++i) storeText(m_columns[i], row, fields[i]);
+    if (!m_loading) endInsertRows();
+}
+
+void ColumnarTableModel::RowBlock::appendRow(const QStringList& fields)
+{
+    if (fields.size() > values.size()) {
+        const int oldColumns = values.size();
+        values.resize(fields.size());
+        decimals.resize(fields.size());
+        texts.resize(fields.size());
+        for (int c = oldColumns; c < fields.size(); ++c) {
+            values[c].fill(kEmpty, rows);
+            decimals[c].fill(qint8(-1), rows);
+        }
+    }
+    for (int c = 0; c < values.size(); ++c) {
+        double v = kEmpty;
+        qint8 d = -1;
+        if (c < fields.size() && !parseNumber(fields[c], v, d)) {
+            v = kEmpty;
+            d = -1;
+            if (!fields[c].isEmpty()) texts[c].append(qMakePair(rows, fields[c]));
+        }
+        values[c].append(v);
+        decimals[c].append(d);
+    }
+    ++rows;
+}
+
+void ColumnarTableModel::appendBlock(const RowBlock& block)
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::DataModel);
+    if (block.rows <= 0) return;
+    if (block.values.size() > m_columns.size()) insertColumns(m_columns.size(), block.values.size() - m_columns.size());
+    ensureResident();
+
+    const int first = m_rowCount;
+    const int total = first + block.rows;
+    if (!m_loading) beginInsertRows(QModelIndex(), first, total - 1);
+    for (int i = 0; i < m_columns.size(); ++i) {
+        Column& c = m_columns[i];
+        if (i < block.values.size()) {
+            c.values += block.values[i];
+            c.decimals += block.decimals[i];
+        } else {
+            c.values.resize(total, kEmpty);
+            c.decimals.resize(total, qint8(-1));
+        }
+        const bool hasText = i < block.texts.size() && !block.texts[i].isEmpty();
+        if (!c.textIds.isEmpty() || hasText) c.textIds.resize(total, -1);
+        if (hasText) {
+            for (const QPair<int, QString>& t : block.texts[i]) c.textIds[first + t.first] = internString(t.second);
+        }
+    }
+    m_rowCount = total;
+    if (!m_loading) endInsertRows();
+}
+
+void ColumnarTableModel::reserveRows(int rows)
+{
+    ensureResident();
+    for (Column& c : m_columns) {
+        c.values.reserve(rows);
+        c.decimals.reserve(rows);
+    }
+    if (m_loading) m_loadReserve = qMax(m_loadReserve, rows);
+}
+
+ColumnarTableModel::RowBlock ColumnarTableModel::toBlock() const
+{
+    RowBlock block;
+    block.rows = m_rowCount;
+    block.values.reserve(m_columns.size());
+    block.decimals.reserve(m_columns.size());
+    block.texts.resize(m_columns.size());
+    for (int i = 0; i < m_columns.size(); ++i) {
+        const Column c = unpackedColumn(i);
+        block.values.append(c.values);
+        block.decimals.append(c.decimals);
+        for (int r = 0; r < c.textIds.size(); ++r) {
+            if (c.textIds[r] >= 0) block.texts[i].append(qMakePair(r, m_strings[c.textIds[r]]));
+        }
+    }
+    return block;
+}
+
+ColumnarTableModel::RowBlock ColumnarTableModel::copyRows(int row, int count) const
+{
+    RowBlock block;
+    if (row < 0 || count <= 0 || row + count > m_rowCount) return block;
+    block.rows = count;
+    block.values.reserve(m_columns.size());
+    block.decimals.reserve(m_columns.size());
+    block.texts.resize(m_columns.size());
+    for (int i = 0; i < m_columns.size(); ++i) {
+        const Column& c = residentColumn(i);
+        block.values.append(c.values.mid(row, count));
+        block.decimals.append(c.decimals.mid(row, count));
+        if (c.textIds.isEmpty()) continue;
+        for (int r = 0; r < count; ++r) {
+            const qint32 id = c.textIds[row + r];
+            if (id >= 0) block.texts[i].append(qMakePair(r, m_strings[id]));
+        }
+    }
+    return block;
+}
+
+void ColumnarTableModel::insertBlock(int row, const RowBlock& block)
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::DataModel);
+    if (block.rows <= 0 || row < 0 || row > m_rowCount) return;
+    if (block.values.size() > m_columns.size()) insertColumns(m_columns.size(), block.values.size() - m_columns.size());
+
+    const int count = block.rows;
+    ensureResident();
+    if (!m_loading) beginInsertRows(QModelIndex(), row, row + count - 1);
+    for (int i = 0; i < m_columns.size(); ++i) {
+        Column& c = m_columns[i];
+        c.values.insert(row, count, kEmpty);
+        c.decimals.insert(row, count, qint8(-1));
+        if (i < block.values.size()) {
+            const int n = qMin(count, int(block.values[i].size()));
+            std::copy(block.values[i].constBegin(), block.values[i].constBegin() + n, c.values.begin() + row);
+            std::copy(block.decimals[i].constBegin(), block.decimals[i].constBegin() + n, c.decimals.begin() + row);
+        }
+        const bool hasText = i < block.texts.size() && !block.texts[i].isEmpty();
+        if (!c.textIds.isEmpty()) c.textIds.insert(row, count, -1);
+        else if (hasText) c.textIds.fill(-1, m_rowCount + count);
+        if (hasText) {
+            for (const QPair<int, QString>& t : block.texts[i]) c.textIds[row + t.first] = internString(t.second);
+        }
+    }
+    m_rowCount += count;
+    moveBackgrounds(Qt::Vertical, row, count);
+    if (!m_loading) endInsertRows();
+}
+
+ColumnarTableModel::RowBlock ColumnarTableModel::copyColumns(int column, int count) const
+{
+    RowBlock block;
+    if (column < 0 || count <= 0 || column + count > m_columns.size()) return block;
+    block.rows = m_rowCount;
+    block.texts.resize(count);
+    for (int i = 0; i < count; ++i) {
+        const Column c = unpackedColumn(column + i);
+        block.values.append(c.values);
+        block.decimals.append(c.decimals);
+        for (int r = 0; r < c.textIds.size(); ++r) {
+            if (c.textIds[r] >= 0) block.texts[i].append(qMakePair(r, m_strings[c.textIds[r]]));
+        }
+    }
+    return block;
+}
+
+ColumnarTableModel::Column ColumnarTableModel::columnFromBlock(const RowBlock& block, int index, int rows)
+{
+    Column c;
+    c.values = block.values[index]; // 隐式共享
+    c.decimals = block.decimals[index];
+    if (c.values.size() != rows) c.values.resize(rows);
+    for (int r = block.rows; r < rows; ++r) c.values[r] = kEmpty;
+    if (c.decimals.size() != rows) c.decimals.resize(rows);
+    for (int r = block.rows; r < rows; ++r) c.decimals[r] = qint8(-1);
+    if (index < block.texts.size() && !block.texts[index].isEmpty()) {
+        c.textIds.fill(-1, rows);
+        for (const QPair<int, QString>& t : block.texts[index]) {
+            if (t.first < rows) c.textIds[t.first] = internString(t.second);
+        }
+    }
+    return c;
+}
+
+void ColumnarTableModel::insertColumnBlock(int column, const RowBlock& block)
+{
+    const int count = block.values.size();
+    if (column < 0 || column > m_columns.size() || count <= 0) return;
+    if (!m_loading) beginInsertColumns(QModelIndex(), column, column + count - 1);
+    for (int i = 0; i < count; ++i) {
+        m_columns.insert(column + i, columnFromBlock(block, i, m_rowCount));
+        m_headers.insert(column + i, QString());
+    }
+    moveBackgrounds(Qt::Horizontal, column, count);
+    if (!m_loading) endInsertColumns();
+}
+
+void ColumnarTableModel::replaceColumns(int column, const RowBlock& block)
+{
+    const int count = qMin(int(block.values.size()), int(m_columns.size()) - column);
+    if (column < 0 || count <= 0) return;
+    for (int i = 0; i < count; ++i) {
+        const QColor foreground = m_columns[column + i].foreground;
+        m_columns[column + i] = columnFromBlock(block, i, m_rowCount);
+        m_columns[column + i].foreground = foreground;
+    }
+    if (m_rowCount == 0) return;
+    beginUpdate();
+    cellChanged(0, column);
+    cellChanged(m_rowCount - 1, column + count - 1);
+    endUpdate();
+}
+
+void ColumnarTableModel::beginUpdate()
+{
+    ++m_updateDepth;
+}
+
+void ColumnarTableModel::endUpdate()
+{
+    if (m_updateDepth <= 0 || --m_updateDepth > 0) return;
+    if (m_dirtyTop < 0) return;
+    // 批量写入期间可能删除了行列，范围截到当前表格内
+    const int bottom = qMin(m_dirtyBottom, m_rowCount - 1);
+    const int right = qMin(m_dirtyRight, int(m_columns.size()) - 1);
+    const int top = m_dirtyTop, left = m_dirtyLeft;
+    m_dirtyTop = m_dirtyBottom = m_dirtyLeft = m_dirtyRight = -1;
+    if (m_loading || top > bottom || left > right) return;
+    emit dataChanged(index(top, left), index(bottom, right), {Qt::DisplayRole, Qt::EditRole});
+}
+
+// 数值单元格的显示文本 (decimals < 0 时按有效数字)
+static QString formatValue(double v, int decimals)
+{
+    if (std::isnan(v)) return QString();
+    return decimals >= 0 ? QString::number(v, 'f', decimals) : QString::number(v, 'g', 15);
+}
+
+QString ColumnarTableModel::text(int row, int column) const
+{
+    if (row < 0 || row >= m_rowCount || column < 0 || column >= m_columns.size()) return QString();
+    const Column& c = residentColumn(column);
+    if (!c.textIds.isEmpty() && c.textIds[row] >= 0) return m_strings[c.textIds[row]];
+    return formatValue(c.values[row], c.decimals[row]);
+}
+
+ColumnarTableModel::Snapshot ColumnarTableModel::snapshot() const
+{
+    Snapshot s;
+    s.rows = m_rowCount;
+    s.values.reserve(m_columns.size());
+    s.decimals.reserve(m_columns.size());
+    s.textIds.reserve(m_columns.size());
+    for (int i = 0; i < m_columns.size(); ++i) {
+        const Column c = unpackedColumn(i);
+        s.values.append(c.values);
+        s.decimals.append(c.decimals);
+        s.textIds.append(c.textIds);
+    }
+    s.strings = m_strings;
+    return s;
+}
+
+QString ColumnarTableModel::Snapshot::text(int row, int column) const
+{
+    if (row < 0 || row >= rows || column < 0 || column >= values.size()) return QString();
+    if (isText(row, column)) return strings[textIds[column][row]];
+    return formatValue(values[column][row], decimals[column][row]);
+}
+
+double ColumnarTableModel::value(int row, int column, bool* ok) const
+{
+    double v = kEmpty;
+    if (row >= 0 && row < m_rowCount && column >= 0 && column < m_columns.size()) v = residentColumn(column).values[row];
+    if (ok) *ok = !std::isnan(v);
+    return v;
+}
+
+bool ColumnarTableModel::isNumeric(int row, int column) const
+{
+    bool ok = false;
+    value(row, column, &ok);
+    return ok;
+}
+
+void ColumnarTableModel::setText(int row, int column, const QString& text)
+{
+    if (row < 0 || column < 0) return;
+    if (column >= m_columns.size()) insertColumns(m_columns.size(), column + 1 - m_columns.size());
+    if (row >= m_rowCount) insertRows(m_rowCount, row + 1 - m_rowCount);
+    residentColumn(column);
+    storeText(m_columns[column], row, text);
+    cellChanged(row, column);
+}
+
+void ColumnarTableModel::setValue(int row, int column, double value, int decimals)
+{
+    if (row < 0 || column < 0) return;
+    if (column >= m_columns.size()) insertColumns(m_columns.size(), column + 1 - m_columns.size());
+    if (row >= m_rowCount) insertRows(m_rowCount, row + 1 - m_rowCount);
+    residentColumn(column);
+    Column& c = m_columns[column];
+    c.values[row] = std::isfinite(value) ? value : kEmpty;
+    c.decimals[row] = qint8(qBound(-1, decimals, kMaxDecimals));
+    if (!c.textIds.isEmpty()) c.textIds[row] = -1;
+    cellChanged(row, column);
+}
+
+void ColumnarTableModel::setColumnValues(int column, const QVector<double>& values, int decimals)
+{
+    if (column < 0 || m_rowCount == 0) return;
+    if (column >= m_columns.size()) insertColumns(m_columns.size(), column + 1 - m_columns.size());
+    Column& c = m_columns[column];
+    c.packed.clear();
+
+    c.values = values; // 隐式共享，只在需要补齐或替换无穷值时复制
+    if (c.values.size() != m_rowCount) {
+        const int old = c.values.size();
+        c.values.resize(m_rowCount);
+        for (int i = old; i < m_rowCount; ++i) c.values[i] = kEmpty;
+    }
+    const double* v = c.values.constData();
+    bool finite = true;
+    for (int i = 0; i < m_rowCount && finite; ++i) finite = std::isfinite(v[i]) || std::isnan(v[i]);
+    if (!finite) {
+        for (double& x : c.values) if (!std::isfinite(x)) x = kEmpty;
+    }
+    c.decimals = QVector<qint8>(m_rowCount, qint8(qBound(-1, decimals, kMaxDecimals)));
+    c.textIds.clear();
+
+    beginUpdate();
+    cellChanged(0, column);
+    cellChanged(m_rowCount - 1, column);
+    endUpdate();
+}
+
+void ColumnarTableModel::setBackground(int row, int column, const QColor& color)
+{
+    if (row < 0 || row >= m_rowCount || column < 0 || column >= m_columns.size()) return;
+    if (color.isValid()) m_backgrounds.insert(cellKey(row, column), color);
+    else m_backgrounds.remove(cellKey(row, column));
+    if (!m_loading) {
+        const QModelIndex idx = index(row, column);
+        emit dataChanged(idx, idx, {Qt::BackgroundRole});
+    }
+}
+
+void ColumnarTableModel::clearBackgrounds()
+{
+    if (m_backgrounds.isEmpty()) return;
+    m_backgrounds.clear();
+    if (!m_loading && m_rowCount > 0 && !m_columns.isEmpty())
+        emit dataChanged(index(0, 0), index(m_rowCount - 1, m_columns.size() - 1), {Qt::BackgroundRole});
+}
+
+void ColumnarTableModel::setColumnForeground(int column, const QColor& color)
+{
+    if (column < 0 || column >= m_columns.size()) return;
+    m_columns[column].foreground = color;
+    if (!m_loading && m_rowCount > 0)
+        emit dataChanged(index(0, column), index(m_rowCount - 1, column), {Qt::ForegroundRole});
+}
+
+QColor ColumnarTableModel::columnForeground(int column) const
+{
+    if (column < 0 || column >= m_columns.size()) return QColor();
+    return m_columns[column].foreground;
+}
+
+ColumnarTableModel::ColumnSpan ColumnarTableModel::columnSpan(int column) const
+{
+    ColumnSpan span;
+    if (column < 0 || column >= m_columns.size()) return span;
+    touch();
+    span.data = residentColumn(column).values.constData();
+    span.size = m_rowCount;
+    return span;
+}
+
+QVector<double> ColumnarTableModel::columnValues(int column) const
+{
+    if (column < 0 || column >= m_columns.size()) return QVector<double>();
+    touch();
+    return residentColumn(column).values;
+}
+
+bool ColumnarTableModel::compress()
+{
+    if (m_loading || m_updateDepth > 0 || m_rowCount == 0) return false;
+    QVector<int> targets;
+    for (int i = 0; i < m_columns.size(); ++i) {
+        const Column& c = m_columns[i];
+        if (c.packed.isEmpty() && !c.values.isEmpty() && c.values.isDetached() && c.decimals.isDetached())
+            targets.append(i);
+    }
+    if (targets.isEmpty()) return false;
+
+    Column* columns = m_columns.data();
+    TaskScheduler::parallelFor(targets.size(), [&](int k) {
+        WT_MEMORY_SCOPE(MemoryAccounting::DataModel);
+        Column& c = columns[targets[k]];
+        c.packed = ColumnCodec::encode(c.values, c.decimals);
+        c.values = QVector<double>();
+        c.decimals = QVector<qint8>();
+    });
+    return true;
+}
+
+void ColumnarTableModel::ensureResident() const
+{
+    QVector<int> targets;
+    for (int i = 0; i < m_columns.size(); ++i) {
+        if (!m_columns[i].packed.isEmpty()) targets.append(i);
+    }
+    if (targets.isEmpty()) return;
+
+    // 解压只改变存储形式，不改变模型内容
+    Column* columns = const_cast<Column*>(m_columns.constData());
+    const int rows = m_rowCount;
+    TaskScheduler::parallelFor(targets.size(), [&](int k) { unpack(columns[targets[k]], rows); });
+    touch();
+}
+
+bool ColumnarTableModel::isCompressed() const
+{
+    for (const Column& c : m_columns) {
+        if (!c.packed.isEmpty()) return true;
+    }
+    return false;
+}
+
+qint64 ColumnarTableModel::residentBytes() const
+{
+    qint64 bytes = 0;
+    for (const Column& c : m_columns) {
+        bytes += qint64(c.values.capacity()) * qint64(sizeof(double)) + c.decimals.capacity()
+                 + qint64(c.textIds.capacity()) * qint64(sizeof(qint32));
+    }
+    return bytes;
+}
+
+qint64 ColumnarTableModel::compressedBytes() const
+{
+    qint64 bytes = 0;
+    for (const Column& c : m_columns) bytes += c.packed.size();
+    return bytes;
+}
+
+void ColumnarTableModel::touch() const
+{
+    m_lastUse = QDateTime::currentMSecsSinceEpoch();
+}
+
+const ColumnarTableModel::Column& ColumnarTableModel::residentColumn(int index) const
+{
+    const Column& c = m_columns[index];
+    if (!c.packed.isEmpty()) unpack(const_cast<Column&>(c), m_rowCount);
+    return c;
+}
+
+ColumnarTableModel::Column ColumnarTableModel::unpackedColumn(int index) const
+{
+    Column c = m_columns[index];
+    if (!c.packed.isEmpty()) unpack(c, m_rowCount);
+    return c;
+}
+
+void ColumnarTableModel::unpack(Column& column, int rows)
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::DataModel);
+    if (!ColumnCodec::decode(column.packed, column.values, column.decimals) || column.values.size() != rows) {
+        // 压缩数据只在本进程内存中生成，解码失败只可能是内存损坏；按空列恢复，避免越界
+        qDebug() << "ColumnarTableModel: failed to unpack column of" << rows << "rows";
+        column.values.fill(kEmpty, rows);
+        column.decimals.fill(qint8(-1), rows);
+    }
+    column.packed.clear();
+}
+
+bool ColumnarTableModel::parseNumber(const QString& text, double& value, qint8& decimals)
+{
+    bool ok = false;
+    value = text.toDouble(&ok);
+    if (!ok || !std::isfinite(value)) return false;
+
+    const QStringView s = QStringView(text).trimmed();
+    int dot = -1;
+    for (int i = 0; i < s.size(); ++i) {
+        const QChar ch = s[i];
+        if (ch == QLatin1Char('e') || ch == QLatin1Char('E')) { decimals = -1; return true; }
+        if (ch == QLatin1Char('.')) dot = i;
+    }
+    const int count = (dot < 0) ? 0 : int(s.size()) - dot - 1;
+    decimals = qint8(count <= kMaxDecimals ? count : -1);
+    return true;
+}
+
+void ColumnarTableModel::resizeColumn(Column& column, int rows) const
+{
+    column.values.fill(kEmpty, rows);
+    column.decimals.fill(qint8(-1), rows);
+    column.textIds.clear();
+}
+
+void ColumnarTableModel::storeText(Column& column, int row, const QString& text)
+{
+    double v = 0.0;
+    qint8 decimals = -1;
+    if (parseNumber(text, v, decimals)) {
+        column.values[row] = v;
+        column.decimals[row] = decimals;
+        if (!column.textIds.isEmpty()) column.textIds[row] = -1;
+        return;
+    }
+
+    column.values[row] = kEmpty;
+    column.decimals[row] = -1;
+    if (text.isEmpty()) {
+        if (!column.textIds.isEmpty()) column.textIds[row] = -1;
+        return;
+    }
+    if (column.textIds.isEmpty()) column.textIds.fill(-1, column.values.size());
+    column.textIds[row] = internString(text);
+}
+
+void ColumnarTableModel::cellChanged(int row, int column)
+{
+    if (m_loading) return;
+    if (m_updateDepth > 0) {
+        if (m_dirtyTop < 0) {
+            m_dirtyTop = m_dirtyBottom = row;
+            m_dirtyLeft = m_dirtyRight = column;
+        } else {
+            m_dirtyTop = qMin(m_dirtyTop, row);
+            m_dirtyBottom = qMax(m_dirtyBottom, row);
+            m_dirtyLeft = qMin(m_dirtyLeft, column);
+            m_dirtyRight = qMax(m_dirtyRight, column);
+        }
+        return;
+    }
+    const QModelIndex idx = index(row, column);
+    emit dataChanged(idx, idx, {Qt::DisplayRole, Qt::EditRole});
+}
+
+qint32 ColumnarTableModel::internString(const QString& text)
+{
+    auto it = m_stringIds.constFind(text);
+    if (it != m_stringIds.constEnd()) return it.value();
+    const qint32 id = m_strings.size();
+    m_strings.append(text);
+    m_stringIds.insert(text, id);
+    return id;
+}
+
+void ColumnarTableModel::moveBackgrounds(Qt::Orientation orientation, int first, int delta)
+{
+    if (m_backgrounds.isEmpty() || delta == 0) return;
+    QHash<quint64, QColor> moved;
+    for (auto it = m_backgrounds.constBegin(); it != m_backgrounds.constEnd(); ++it) {
+        int row = int(it.key() >> 32);
+        int column = int(it.key() & 0xffffffffu);
+        int& k = (orientation == Qt::Vertical) ? row : column;
+        if (delta < 0 && k >= first && k < first - delta) continue;
+        if (k >= first) k += delta;
+        moved.insert(cellKey(row, column), it.value());
+    }
+    m_backgrounds.swap(moved);
+}
@@ -0,0 +1,207 @@
+/*
+ * columnartablemodel.h
+ * 文件作用: 按列存储的数据表模型头文件
+ * 功能描述:
+ * 1. 替代以 QStandardItem 保存文本的 QStandardItemModel：每列为连续的 double 数组，
+ *    可解析为数值的单元格只保存数值与显示小数位 (每格 9 字节)，显示文本在 data() 中按需格式化。
+ * 2. 不能解析为数值的单元格 (日期、备注等) 以编号引用模型内的字符串池，相同文本只保存一份；
+ *    没有文本单元格的列不分配编号数组。文本单元格与空单元格在数值数组中为 NaN。
+ * 3. columnSpan 给出数值列的连续数组视图，columnValues 返回隐式共享的 QVector，
+ *    压降、导数与曲线读取等数值流程直接使用，不再逐格 toDouble。
+ * 4. 批量导入时以 beginLoad / endLoad 包围 appendRow，整体只发出一次模型重置信号；
+ *    批量写入已有表格 (计算新列等) 时以 beginUpdate / endUpdate 包围，结束时对修改范围只发出一次 dataChanged。
+ * 5. 单元格背景色 (错误高亮) 按稀疏表保存，文字颜色按列设置 (计算生成的列)。
+ * 6. [分块追加] 文本导入在各线程中把一段行解析为 RowBlock (按列的数值、小数位与文本)，appendBlock 按顺序整块追加。
+ * 7. [二进制保存] toBlock 把整表导出为 RowBlock，项目保存 (ProjectTableStore) 直接写出列数组，恢复时整块追加。
+ * 8. [整列写入] setColumnValues 以隐式共享的数组整体替换一列 (表达式列、时间转换等)，不逐格写入。
+ * 9. [只读快照] snapshot 给出全部列数组与字符串池的隐式共享副本 (不复制数据)，可交给后台线程读取单元格文本与数值，
+ *    之后对模型的修改不影响快照。
+ * 10. [撤销切片] copyRows / copyColumns 把行区间或整列导出为 RowBlock (整列隐式共享，不复制)，
+ *    insertBlock / insertColumnBlock / replaceColumns 把切片放回原处，供撤销命令只保存被删除或被覆盖的部分。
+ * 11. [压缩驻留] compress 把各列的数值与小数位以 ColumnCodec 压缩后释放原数组 (文本编号、表头与背景色不变)；
+ *    之后读取某列 (columnSpan、单元格文本等) 时只解压该列，行列结构修改与整表导出前解压全部列。
+ *    由 SheetResidencyManager 对不活动的页签调用，模型的接口与信号不受影响。
+ */
+
+#ifndef COLUMNARTABLEMODEL_H
+#define COLUMNARTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QByteArray>
+#include <QColor>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+class ColumnarTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    // 数值列的连续数组视图 (不复制数据；模型被修改或压缩后失效)
+    struct ColumnSpan {
+        const double* data = nullptr;
+        int size = 0;
+
+        const double* begin() const { return data; }
+        const double* end() const { return data + size; }
+        double operator[](int i) const { return data[i]; }
+        bool isEmpty() const { return size == 0; }
+    };
+
+    // 预先解析好的一段行 (各列数组长度均为 rows)
+    struct RowBlock {
+        int rows = 0;
+        QVector<QVector<double>> values;              // 每列的数值 (文本与空单元格为 NaN)
+        QVector<QVector<qint8>> decimals;             // 每列的显示小数位
+        QVector<QVector<QPair<int, QString>>> texts;  // 每列的文本单元格 (块内行号, 文本)
+
+        // 按文本追加一行 (与 ColumnarTableModel::appendRow 的解析规则相同，可在后台线程调用)
+        void appendRow(const QStringList& fields);
+    };
+
+    // 整表的只读快照 (各数组隐式共享)，可在任意线程读取
+    struct Snapshot {
+        int rows = 0;
+        QVector<QVector<double>> values;
+        QVector<QVector<qint8>> decimals;
+        QVector<QVector<qint32>> textIds;  // 无文本单元格的列为空数组
+        QVector<QString> strings;
+
+        int columnCount() const { return values.size(); }
+        // 与 ColumnarTableModel::text 相同的显示文本
+        QString text(int row, int column) const;
+        // 文本单元格 (非数值、非空)
+        bool isText(int row, int column) const
+        {
+            const QVector<qint32>& ids = textIds[column];
+            return !ids.isEmpty() && ids[row] >= 0;
+        }
+    };
+
+    explicit ColumnarTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    bool insertRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
+    bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
+    bool insertColumns(int column, int count, const QModelIndex& parent = QModelIndex()) override;
+    bool removeColumns(int column, int count, const QModelIndex& parent = QModelIndex()) override;
+
+    // 清空数据与表头
+    void clear();
+    void setHorizontalHeaderLabels(const QStringList& labels);
+    // 表头文本 (未设置时为空字符串；headerData 此时返回列号)
+    QString headerText(int column) const;
+
+    // 批量导入：beginLoad 与 endLoad 之间的 appendRow 不逐行发出信号
+    void beginLoad(int expectedRows = 0);
+    void endLoad();
+    // 追加一行 (字段多于列数时自动增加列，少于列数时其余为空)
+    void appendRow(const QStringList& fields);
+    // 追加一段预先解析好的行 (列数多于当前列数时自动增加列)
+    void appendBlock(const RowBlock& block);
+    // 为后续追加的行预留空间
+    void reserveRows(int rows);
+    // 整表导出为 RowBlock (数值与小数位数组隐式共享，不复制)，用于项目保存
+    RowBlock toBlock() const;
+    Snapshot snapshot() const;
+
+    // 行区间 [row, row + count) 导出为 RowBlock (复制该区间)
+    RowBlock copyRows(int row, int count) const;
+    // 在 row 处插入一段行 (块的列数多于当前列数时自动增加列)
+    void insertBlock(int row, const RowBlock& block);
+    // 列 [column, column + count) 整列导出为 RowBlock (数值与小数位数组隐式共享)
+    RowBlock copyColumns(int column, int count) const;
+    // 在 column 处插入块中的各列 (块的行数与表格不同时截断或补空)；表头为空
+    void insertColumnBlock(int column, const RowBlock& block);
+    // 以块中的各列覆盖 column 起的已有列 (文字颜色保留)；发出一次 dataChanged
+    void replaceColumns(int column, const RowBlock& block);
+
+    // 批量写入：beginUpdate 与 endUpdate 之间的 setText / setValue 合并为一次 dataChanged (可嵌套)
+    void beginUpdate();
+    void endUpdate();
+
+    // 单元格文本 (越界返回空字符串)
+    QString text(int row, int column) const;
+    // 单元格数值 (文本或空单元格返回 NaN，ok 为 false)
+    double value(int row, int column, bool* ok = nullptr) const;
+    bool isNumeric(int row, int column) const;
+
+    // 写入单元格：setText 按文本解析；setValue 直接写入数值，decimals < 0 时按有效数字显示
+    void setText(int row, int column, const QString& text);
+    void setValue(int row, int column, double value, int decimals = -1);
+    // 整列写入数值 (长度不足行数的部分为空，非有限值为空)，所有单元格使用同一小数位；发出一次 dataChanged
+    void setColumnValues(int column, const QVector<double>& values, int decimals = -1);
+
+    void setBackground(int row, int column, const QColor& color);
+    void clearBackgrounds();
+    void setColumnForeground(int column, const QColor& color);
+    QColor columnForeground(int column) const;
+
+    // 数值列 (文本与空单元格处为 NaN)
+    ColumnSpan columnSpan(int column) const;
+    QVector<double> columnValues(int column) const;
+
+    // 压缩驻留：压缩数组未被共享的列，返回是否压缩了任何列 (批量导入或批量写入期间不压缩)
+    bool compress();
+    // 解压全部列
+    void ensureResident() const;
+    bool isCompressed() const;
+    // 未压缩的数值、小数位与文本编号数组占用的字节数 / 压缩数据的字节数
+    qint64 residentBytes() const;
+    qint64 compressedBytes() const;
+    // 最近一次被读取数值列或被激活的时刻 (ms，QDateTime::currentMSecsSinceEpoch)
+    qint64 lastUse() const { return m_lastUse; }
+    void touch() const;
+
+private:
+    struct Column {
+        QVector<double> values;   // 数值 (文本与空单元格为 NaN)
+        QVector<qint8> decimals;  // 显示小数位 (-1 表示按有效数字显示)
+        QVector<qint32> textIds;  // 文本单元格在字符串池中的编号 (-1 表示数值或空)；无文本时为空数组
+        QColor foreground;        // 文字颜色 (无效表示默认)
+        QByteArray packed;        // 压缩后的数值与小数位 (非空时 values / decimals 已释放)
+    };
+
+    // 解析单元格文本：有限数值返回 true，并给出原文的小数位 (带指数时为 -1)
+    static bool parseNumber(const QString& text, double& value, qint8& decimals);
+
+    // 第 index 列 (已压缩时先解压并保留)
+    const Column& residentColumn(int index) const;
+    // 第 index 列的内容 (已压缩时解压到副本，模型保持压缩)
+    Column unpackedColumn(int index) const;
+    static void unpack(Column& column, int rows);
+
+    void resizeColumn(Column& column, int rows) const;
+    // 由块中第 index 列建立列数据 (长度为 rows)
+    Column columnFromBlock(const RowBlock& block, int index, int rows);
+    void storeText(Column& column, int row, const QString& text);
+    // 单元格被写入后发出 dataChanged (批量写入时只记录范围)
+    void cellChanged(int row, int column);
+    qint32 internString(const QString& text);
+    // 在 first 处插入 (delta > 0) 或删除 (delta < 0) 行列后移动背景色
+    void moveBackgrounds(Qt::Orientation orientation, int first, int delta);
+    static quint64 cellKey(int row, int column) { return (quint64(quint32(row)) << 32) | quint32(column); }
+
+    QVector<Column> m_columns;
+    QStringList m_headers;
+    int m_rowCount = 0;
+    bool m_loading = false;
+    int m_loadReserve = 0; // 批量导入时为每列预留的行数
+    int m_updateDepth = 0;
+    int m_dirtyTop = -1, m_dirtyBottom = -1, m_dirtyLeft = -1, m_dirtyRight = -1;
+
+    QVector<QString> m_strings;         // 字符串池
+    QHash<QString, qint32> m_stringIds; // 文本 -> 编号
+    QHash<quint64, QColor> m_backgrounds;
+    mutable qint64 m_lastUse = 0;
+};
+
+#endif // COLUMNARTABLEMODEL_H
@@ -0,0 +1,265 @@
+/*
+ * 文件名: columncodec.cpp
+ * 文件作用: 数据表数值列的内存压缩编码实现文件
+ * 功能描述:
+ * 1. 编码格式：行数 (4 字节)、数值编码方式 (1 字节)、数值块长度 (4 字节)、数值块、小数位编码方式 (1 字节)、小数位块。
+ * 2. 位流按 64 位字从高位向低位写入，读取时越界即判为损坏。
+ */
+
+#include "columncodec.h"
+
+#include <QtAlgorithms>
+#include <cstring>
+
+namespace {
+
+enum ValueMethod : quint8 { ValueGorilla = 0, ValueShuffled = 1 };
+enum DecimalMethod : quint8 { DecimalConstant = 0, DecimalCompressed = 1 };
+
+const int kCompressLevel = 1;          // 速度优先
+const double kShuffleThreshold = 0.45; // Gorilla 结果超过原始大小的该比例时再尝试字节重排
+
+inline quint64 bitsOf(double v)
+{
+    quint64 b;
+    std::memcpy(&b, &v, sizeof(b));
+    return b;
+}
+
+class BitWriter
+{
+public:
+    void write(quint64 value, int bits)
+    {
+        while (bits > 0) {
+            const int take = qMin(bits, 64 - m_used);
+            const quint64 part = (bits == 64 && take == 64) ? value : (value >> (bits - take)) & ((quint64(1) << take) - 1);
+            m_current = (take == 64) ? part : (m_current << take) | part;
+            m_used += take;
+            bits -= take;
+            if (m_used == 64) flushWord();
+        }
+    }
+
+    QByteArray finish()
+    {
+        if (m_used > 0) {
+            m_current <<= (64 - m_used);
+            flushWord();
+        }
+        return m_out;
+    }
+
+private:
+    void flushWord()
+    {
+        uchar bytes[8];
+        for (int b = 0; b < 8; ++b) bytes[b] = uchar(m_current >> (56 - 8 * b));
+        m_out.append(reinterpret_cast<const char*>(bytes), 8);
+        m_current = 0;
+        m_used = 0;
+    }
+
+    QByteArray m_out;
+    quint64 m_current = 0;
+    int m_used = 0;
+};
+
+class BitReader
+{
+public:
+    BitReader(const char* data, int size) : m_data(reinterpret_cast<const uchar*>(data)), m_bits(qint64(size) * 8) {}
+
+    bool read(int bits, quint64& value)
+    {
+        if (m_pos + bits > m_bits) return false;
+        value = 0;
+        // 按字节读取：每次取当前字节中剩余的位
+        while (bits > 0) {
+            const int offset = int(m_pos & 7);
+            const int take = qMin(8 - offset, bits);
+            const quint64 chunk = (m_data[m_pos >> 3] >> (8 - offset - take)) & ((1u << take) - 1);
+            value = (value << take) | chunk;
+            m_pos += take;
+            bits -= take;
+        }
+        return true;
+    }
+
+private:
+    const uchar* m_data;
+    qint64 m_bits;
+    qint64 m_pos = 0;
+};
+
+template <typename T>
+void appendRaw(QByteArray& out, T value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readRaw(const QByteArray& in, int& pos, T& value)
+{
+    if (pos + int(sizeof(T)) > in.size()) return false;
+    std::memcpy(&value, in.constData() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+} // namespace
+
+QByteArray ColumnCodec::encodeGorilla(const double* values, int count)
+{
+    BitWriter out;
+    if (count <= 0) return out.finish();
+    quint64 previous = bitsOf(values[0]);
+    out.write(previous, 64);
+    int windowLead = -1, windowTrail = 0;
+    for (int i = 1; i < count; ++i) {
+        const quint64 bits = bitsOf(values[i]);
+        const quint64 x = bits ^ previous;
+        previous = bits;
+        if (x == 0) {
+            out.write(0, 1);
+            continue;
+        }
+        const int lead = qMin(int(qCountLeadingZeroBits(x)), 31);
+        const int trail = int(qCountTrailingZeroBits(x));
+        if (windowLead >= 0 && lead >= windowLead && trail >= windowTrail) {
+            out.write(2, 2); // 10：沿用上一个窗口
+            out.write(x >> windowTrail, 64 - windowLead - windowTrail);
+        } else {
+            const int length = 64 - lead - trail;
+            out.write(3, 2); // 11：新窗口
+            out.write(quint64(lead), 5);
+            out.write(quint64(length - 1), 6);
+            out.write(x >> trail, length);
+            windowLead = lead;
+            windowTrail = trail;
+        }
+    }
+    return out.finish();
+}
+
+bool ColumnCodec::decodeGorilla(const char* data, int size, double* values, int count)
+{
+    if (count <= 0) return true;
+    BitReader in(data, size);
+    quint64 previous = 0;
+    if (!in.read(64, previous)) return false;
+    std::memcpy(&values[0], &previous, sizeof(previous));
+    int windowLead = 0, windowTrail = 0;
+    for (int i = 1; i < count; ++i) {
+        quint64 control = 0, x = 0;
+        if (!in.read(1, control)) return false;
+        if (control) {
+            if (!in.read(1, control)) return false;
+            if (control) {
+                quint64 lead = 0, length = 0;
+                if (!in.read(5, lead) || !in.read(6, length)) return false;
+                windowLead = int(lead);
+                windowTrail = 64 - windowLead - int(length + 1);
+                if (windowTrail < 0) return false;
+            }
+            const int meaningful = 64 - windowLead - windowTrail;
+            if (!in.read(meaningful, x)) return false;
+            previous ^= (x << windowTrail);
+        }
+        std::memcpy(&values[i], &previous, sizeof(previous));
+    }
+    return true;
+}
+
+QByteArray ColumnCodec::encodeShuffled(const double* values, int count)
+{
+    const qint64 n = qMax(0, count);
+    QByteArray raw(n * 8, Qt::Uninitialized);
+    uchar* out = reinterpret_cast<uchar*>(raw.data());
+    quint64 previous = 0;
+    for (qint64 i = 0; i < n; ++i) {
+        const quint64 bits = bitsOf(values[i]);
+        const quint64 x = bits ^ previous;
+        previous = bits;
+        for (int b = 0; b < 8; ++b) out[b * n + i] = uchar(x >> (8 * b));
+    }
+    return qCompress(raw, kCompressLevel);
+}
+
+bool ColumnCodec::decodeShuffled(const char* data, int size, double* values, int count)
+{
+    const QByteArray raw = qUncompress(reinterpret_cast<const uchar*>(data), size);
+    const qint64 n = qMax(0, count);
+    if (raw.size() != n * 8) return false;
+    const uchar* in = reinterpret_cast<const uchar*>(raw.constData());
+    quint64 previous = 0;
+    for (qint64 i = 0; i < n; ++i) {
+        quint64 x = 0;
+        for (int b = 0; b < 8; ++b) x |= quint64(in[b * n + i]) << (8 * b);
+        previous ^= x;
+        std::memcpy(&values[i], &previous, sizeof(previous));
+    }
+    return true;
+}
+
+QByteArray ColumnCodec::encode(const QVector<double>& values, const QVector<qint8>& decimals)
+{
+    const int rows = qMin(values.size(), decimals.size());
+    QByteArray valueBlock = encodeGorilla(values.constData(), rows);
+    quint8 valueMethod = ValueGorilla;
+    if (valueBlock.size() > kShuffleThreshold * rows * 8) {
+        QByteArray shuffled = encodeShuffled(values.constData(), rows);
+        if (shuffled.size() < valueBlock.size()) {
+            valueBlock = shuffled;
+            valueMethod = ValueShuffled;
+        }
+    }
+
+    bool constant = true;
+    for (int i = 1; i < rows && constant; ++i) constant = (decimals[i] == decimals[0]);
+
+    QByteArray out;
+    appendRaw<qint32>(out, rows);
+    appendRaw<quint8>(out, valueMethod);
+    appendRaw<qint32>(out, valueBlock.size());
+    out += valueBlock;
+    if (constant) {
+        appendRaw<quint8>(out, DecimalConstant);
+        appendRaw<qint8>(out, rows > 0 ? decimals[0] : qint8(-1));
+    } else {
+        appendRaw<quint8>(out, DecimalCompressed);
+        out += qCompress(reinterpret_cast<const uchar*>(decimals.constData()), rows, kCompressLevel);
+    }
+    return out;
+}
+
+bool ColumnCodec::decode(const QByteArray& packed, QVector<double>& values, QVector<qint8>& decimals)
+{
+    int pos = 0;
+    qint32 rows = 0, valueSize = 0;
+    quint8 valueMethod = 0, decimalMethod = 0;
+    if (!readRaw(packed, pos, rows) || !readRaw(packed, pos, valueMethod) || !readRaw(packed, pos, valueSize)) return false;
+    if (rows < 0 || valueSize < 0 || pos + valueSize > packed.size()) return false;
+
+    values.resize(rows);
+    const char* valueData = packed.constData() + pos;
+    const bool valuesOk = (valueMethod == ValueGorilla) ? decodeGorilla(valueData, valueSize, values.data(), rows)
+                          : (valueMethod == ValueShuffled) ? decodeShuffled(valueData, valueSize, values.data(), rows)
+                                                           : false;
+    if (!valuesOk) return false;
+    pos += valueSize;
+
+    if (!readRaw(packed, pos, decimalMethod)) return false;
+    if (decimalMethod == DecimalConstant) {
+        qint8 d = -1;
+        if (!readRaw(packed, pos, d)) return false;
+        decimals.fill(d, rows);
+        return true;
+    }
+    if (decimalMethod != DecimalCompressed) return false;
+    const QByteArray raw = qUncompress(reinterpret_cast<const uchar*>(packed.constData() + pos), packed.size() - pos);
+    if (raw.size() != rows) return false;
+    decimals.resize(rows);
+    std::memcpy(decimals.data(), raw.constData(), size_t(rows));
+    return true;
+}
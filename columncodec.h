@@ -0,0 +1,35 @@
+/*
+ * 文件名: columncodec.h
+ * 文件作用: 数据表数值列的内存压缩编码头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 数值按 Gorilla 方式编码：与上一个值的位模式异或，相同时只写 1 位；否则沿用上一个有效位窗口 (2 位控制 + 窗口内的位)，
+ *    或写出新窗口 (前导零 5 位、有效位长度 6 位)。空单元格 (NaN) 连续出现时每格 1 位。
+ * 2. Gorilla 结果超过原始大小的 45% 时 (末位噪声多的实测数据)，另以 "异或差分 + 按字节重排 + qCompress 1 级" 编码
+ *    (与 ProjectTableStore 的数值块相同)，取两者中较小的。
+ * 3. 小数位全列相同时只保存一个字节，否则整列 qCompress 1 级压缩。
+ * 4. 解码结果与编码前逐位相同；用于不活动页签的内存驻留管理 (sheetresidency.h)，不写入文件，格式不保证跨版本兼容。
+ */
+
+#ifndef COLUMNCODEC_H
+#define COLUMNCODEC_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+class ColumnCodec
+{
+public:
+    // 编码一列 (两个数组长度须相同)
+    static QByteArray encode(const QVector<double>& values, const QVector<qint8>& decimals);
+    // 解码，数据损坏时返回 false
+    static bool decode(const QByteArray& packed, QVector<double>& values, QVector<qint8>& decimals);
+
+    // 数值部分的两种编码 (公开以便比较压缩率)
+    static QByteArray encodeGorilla(const double* values, int count);
+    static bool decodeGorilla(const char* data, int size, double* values, int count);
+    static QByteArray encodeShuffled(const double* values, int count);
+    static bool decodeShuffled(const char* data, int size, double* values, int count);
+};
+
+#endif // COLUMNCODEC_H
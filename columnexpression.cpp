@@ -0,0 +1,523 @@
+/*
+ * columnexpression.cpp
+ * 文件作用: 数据表列表达式求值引擎实现文件
+ * 功能描述:
+ * 1. 递归下降解析为语法树 (全部为常量的子表达式在编译时折叠)，再按后序输出为栈式指令，同时求出所需栈深。
+ * 2. 求值时每段行分配 栈深 × 段长 的缓冲区，栈槽为标量或数组视图：列引用直接指向列数组，
+ *    运算结果写入本层缓冲区；逐元素循环不含分支判断，便于编译器向量化。
+ */
+
+#include "columnexpression.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const int kChunkRows = 4096;
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+typedef ColumnExpression::OpCode OpCode;
+
+int operandCount(OpCode op)
+{
+    switch (op) {
+    case ColumnExpression::PushConstant:
+    case ColumnExpression::PushColumn:
+    case ColumnExpression::PushFirst:
+        return 0;
+    case ColumnExpression::Negate:
+    case ColumnExpression::Abs:
+    case ColumnExpression::Sqrt:
+    case ColumnExpression::Exp:
+    case ColumnExpression::Ln:
+    case ColumnExpression::Log10:
+        return 1;
+    case ColumnExpression::Select:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+inline double compare(bool result, double a, double b)
+{
+    return (std::isnan(a) || std::isnan(b)) ? kNaN : (result ? 1.0 : 0.0);
+}
+
+// 单个元素的运算 (常量折叠与逐元素循环共用)
+inline double applyOp(OpCode op, double a, double b, double c)
+{
+    switch (op) {
+    case ColumnExpression::Negate:       return -a;
+    case ColumnExpression::Abs:          return std::fabs(a);
+    case ColumnExpression::Sqrt:         return std::sqrt(a);
+    case ColumnExpression::Exp:          return std::exp(a);
+    case ColumnExpression::Ln:           return std::log(a);
+    case ColumnExpression::Log10:        return std::log10(a);
+    case ColumnExpression::Add:          return a + b;
+    case ColumnExpression::Subtract:     return a - b;
+    case ColumnExpression::Multiply:     return a * b;
+    case ColumnExpression::Divide:       return a / b;
+    case ColumnExpression::Power:        return std::pow(a, b);
+    case ColumnExpression::Min:          return (std::isnan(a) || std::isnan(b)) ? kNaN : std::min(a, b);
+    case ColumnExpression::Max:          return (std::isnan(a) || std::isnan(b)) ? kNaN : std::max(a, b);
+    case ColumnExpression::Less:         return compare(a < b, a, b);
+    case ColumnExpression::LessEqual:    return compare(a <= b, a, b);
+    case ColumnExpression::Greater:      return compare(a > b, a, b);
+    case ColumnExpression::GreaterEqual: return compare(a >= b, a, b);
+    case ColumnExpression::Equal:        return compare(a == b, a, b);
+    case ColumnExpression::NotEqual:     return compare(a != b, a, b);
+    case ColumnExpression::Select:       return std::isnan(a) ? kNaN : (a != 0.0 ? b : c);
+    default:                             return kNaN;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 解析
+// ---------------------------------------------------------------------------
+
+struct Node {
+    OpCode op = ColumnExpression::PushConstant;
+    double value = 0.0;
+    int column = -1;
+    int args[3] = {-1, -1, -1};
+};
+
+class Parser
+{
+public:
+    Parser(const QString& text, const QStringList& columns, const QMap<QString, double>& variables)
+        : m_text(text), m_columns(columns), m_variables(variables) {}
+
+    // 返回根节点下标，失败时为 -1 (错误信息见 error)
+    int parse()
+    {
+        const int root = parseComparison();
+        if (root < 0) return -1;
+        skipSpace();
+        if (m_pos < m_text.size()) return fail(QString("第 %1 个字符处有多余内容").arg(m_pos + 1));
+        return root;
+    }
+
+    QVector<Node> nodes;
+    QString error;
+
+private:
+    int fail(const QString& message)
+    {
+        if (error.isEmpty()) error = message;
+        return -1;
+    }
+
+    void skipSpace()
+    {
+        while (m_pos < m_text.size() && m_text[m_pos].isSpace()) ++m_pos;
+    }
+
+    bool accept(const char* token)
+    {
+        skipSpace();
+        const QLatin1String t(token);
+        if (m_text.mid(m_pos, t.size()) != t) return false;
+        m_pos += t.size();
+        return true;
+    }
+
+    int constant(double value)
+    {
+        Node n;
+        n.value = value;
+        nodes.append(n);
+        return nodes.size() - 1;
+    }
+
+    int columnNode(OpCode op, int column)
+    {
+        Node n;
+        n.op = op;
+        n.column = column;
+        nodes.append(n);
+        return nodes.size() - 1;
+    }
+
+    // 构造运算节点；操作数均为常量时直接折叠
+    int operation(OpCode op, int a, int b = -1, int c = -1)
+    {
+        if (a < 0 || (operandCount(op) > 1 && b < 0) || (operandCount(op) > 2 && c < 0)) return -1;
+        const int args[3] = {a, b, c};
+        bool folded = true;
+        double v[3] = {0.0, 0.0, 0.0};
+        for (int i = 0; i < operandCount(op); ++i) {
+            const Node& arg = nodes[args[i]];
+            if (arg.op != ColumnExpression::PushConstant) folded = false;
+            else v[i] = arg.value;
+        }
+        if (folded) return constant(applyOp(op, v[0], v[1], v[2]));
+
+        Node n;
+        n.op = op;
+        for (int i = 0; i < 3; ++i) n.args[i] = args[i];
+        nodes.append(n);
+        return nodes.size() - 1;
+    }
+
+    int parseComparison()
+    {
+        int left = parseAdditive();
+        while (left >= 0) {
+            OpCode op;
+            if (accept("<=")) op = ColumnExpression::LessEqual;
+            else if (accept(">=")) op = ColumnExpression::GreaterEqual;
+            else if (accept("==")) op = ColumnExpression::Equal;
+            else if (accept("!=")) op = ColumnExpression::NotEqual;
+            else if (accept("<")) op = ColumnExpression::Less;
+            else if (accept(">")) op = ColumnExpression::Greater;
+            else break;
+            left = operation(op, left, parseAdditive());
+        }
+        return left;
+    }
+
+    int parseAdditive()
+    {
+        int left = parseTerm();
+        while (left >= 0) {
+            if (accept("+")) left = operation(ColumnExpression::Add, left, parseTerm());
+            else if (accept("-")) left = operation(ColumnExpression::Subtract, left, parseTerm());
+            else break;
+        }
+        return left;
+    }
+
+    int parseTerm()
+    {
+        int left = parseUnary();
+        while (left >= 0) {
+            if (accept("*")) left = operation(ColumnExpression::Multiply, left, parseUnary());
+            else if (accept("/")) left = operation(ColumnExpression::Divide, left, parseUnary());
+            else break;
+        }
+        return left;
+    }
+
+    int parseUnary()
+    {
+        if (accept("-")) return operation(ColumnExpression::Negate, parseUnary());
+        if (accept("+")) return parseUnary();
+        return parsePower();
+    }
+
+    // 乘方右结合，且优先于一元负号 (-2^2 = -4)
+    int parsePower()
+    {
+        const int base = parsePrimary();
+        if (base >= 0 && accept("^")) return operation(ColumnExpression::Power, base, parseUnary());
+        return base;
+    }
+
+    int parsePrimary()
+    {
+        skipSpace();
+        if (m_pos >= m_text.size()) return fail("表达式不完整");
+        const QChar ch = m_text[m_pos];
+
+        if (ch.isDigit() || ch == QLatin1Char('.')) return parseNumber();
+
+        if (accept("(")) {
+            const int inner = parseComparison();
+            if (inner < 0) return -1;
+            if (!accept(")")) return fail("缺少右括号");
+            return inner;
+        }
+
+        if (accept("[")) {
+            const int close = m_text.indexOf(QLatin1Char(']'), m_pos);
+            if (close < 0) return fail("列名缺少右方括号");
+            const QString name = m_text.mid(m_pos, close - m_pos).trimmed();
+            m_pos = close + 1;
+            const int column = m_columns.indexOf(name);
+            if (column < 0) return fail(QString("找不到列 [%1]").arg(name));
+            return columnNode(ColumnExpression::PushColumn, column);
+        }
+
+        if (accept("$")) {
+            const int start = m_pos;
+            while (m_pos < m_text.size() && m_text[m_pos].isDigit()) ++m_pos;
+            const int column = m_text.mid(start, m_pos - start).toInt() - 1;
+            if (column < 0 || column >= m_columns.size()) return fail(QString("列号 $%1 超出范围").arg(column + 1));
+            return columnNode(ColumnExpression::PushColumn, column);
+        }
+
+        if (ch.isLetter() || ch == QLatin1Char('_')) {
+            const int start = m_pos;
+            while (m_pos < m_text.size() && (m_text[m_pos].isLetterOrNumber() || m_text[m_pos] == QLatin1Char('_'))) ++m_pos;
+            const QString name = m_text.mid(start, m_pos - start);
+            if (accept("(")) return parseCall(name);
+            return resolveName(name);
+        }
+
+        return fail(QString("第 %1 个字符 '%2' 无法识别").arg(m_pos + 1).arg(ch));
+    }
+
+    int parseNumber()
+    {
+        const int start = m_pos;
+        while (m_pos < m_text.size() && (m_text[m_pos].isDigit() || m_text[m_pos] == QLatin1Char('.'))) ++m_pos;
+        if (m_pos < m_text.size() && (m_text[m_pos] == QLatin1Char('e') || m_text[m_pos] == QLatin1Char('E'))) {
+            int p = m_pos + 1;
+            if (p < m_text.size() && (m_text[p] == QLatin1Char('+') || m_text[p] == QLatin1Char('-'))) ++p;
+            if (p < m_text.size() && m_text[p].isDigit()) {
+                m_pos = p;
+                while (m_pos < m_text.size() && m_text[m_pos].isDigit()) ++m_pos;
+            }
+        }
+        bool ok = false;
+        const double value = m_text.mid(start, m_pos - start).toDouble(&ok);
+        if (!ok) return fail(QString("无效的数值 %1").arg(m_text.mid(start, m_pos - start)));
+        return constant(value);
+    }
+
+    int resolveName(const QString& name)
+    {
+        if (m_variables.contains(name)) return constant(m_variables.value(name));
+        if (name.compare("pi", Qt::CaseInsensitive) == 0) return constant(3.14159265358979323846);
+        if (name.compare("nan", Qt::CaseInsensitive) == 0) return constant(kNaN);
+
+        int column = m_columns.indexOf(name);
+        if (column < 0) {
+            for (int i = 0; i < m_columns.size(); ++i) {
+                if (m_columns[i].section(QLatin1Char('\\'), 0, 0).trimmed() == name) { column = i; break; }
+            }
+        }
+        if (column < 0) return fail(QString("未知的名称 %1").arg(name));
+        return columnNode(ColumnExpression::PushColumn, column);
+    }
+
+    int parseCall(const QString& name)
+    {
+        QVector<int> args;
+        if (!accept(")")) {
+            do {
+                const int arg = parseComparison();
+                if (arg < 0) return -1;
+                args.append(arg);
+            } while (accept(","));
+            if (!accept(")")) return fail(QString("函数 %1 缺少右括号").arg(name));
+        }
+
+        const QString f = name.toLower();
+        auto expect = [&](int count) {
+            if (args.size() == count) return true;
+            fail(QString("函数 %1 需要 %2 个参数").arg(name).arg(count));
+            return false;
+        };
+
+        if (f == "first") {
+            if (!expect(1)) return -1;
+            const Node& arg = nodes[args[0]];
+            if (arg.op != ColumnExpression::PushColumn) return fail("first 的参数必须是列");
+            return columnNode(ColumnExpression::PushFirst, arg.column);
+        }
+
+        static const QMap<QString, OpCode> unary = {
+            {"abs", ColumnExpression::Abs}, {"sqrt", ColumnExpression::Sqrt}, {"exp", ColumnExpression::Exp},
+            {"ln", ColumnExpression::Ln}, {"log", ColumnExpression::Ln}, {"log10", ColumnExpression::Log10}};
+        static const QMap<QString, OpCode> binary = {
+            {"pow", ColumnExpression::Power}, {"min", ColumnExpression::Min}, {"max", ColumnExpression::Max}};
+
+        if (unary.contains(f)) return expect(1) ? operation(unary.value(f), args[0]) : -1;
+        if (binary.contains(f)) return expect(2) ? operation(binary.value(f), args[0], args[1]) : -1;
+        if (f == "if") return expect(3) ? operation(ColumnExpression::Select, args[0], args[1], args[2]) : -1;
+        return fail(QString("未知的函数 %1").arg(name));
+    }
+
+    const QString& m_text;
+    const QStringList& m_columns;
+    const QMap<QString, double>& m_variables;
+    int m_pos = 0;
+};
+
+// 后序输出指令，depth 为当前栈深
+void emitProgram(const QVector<Node>& nodes, int index, QVector<ColumnExpression::Instruction>& program,
+          int& depth, int& maxDepth)
+{
+    const Node& n = nodes[index];
+    const int count = operandCount(n.op);
+    for (int i = 0; i < count; ++i) emitProgram(nodes, n.args[i], program, depth, maxDepth);
+
+    ColumnExpression::Instruction ins;
+    ins.op = n.op;
+    ins.value = n.value;
+    ins.column = n.column;
+    program.append(ins);
+
+    depth += 1 - count;
+    maxDepth = qMax(maxDepth, depth);
+}
+
+// ---------------------------------------------------------------------------
+// 求值
+// ---------------------------------------------------------------------------
+
+// 栈槽：标量或长度为段长的数组 (指向列数据或本层缓冲区)
+struct Slot {
+    bool scalar = true;
+    double value = 0.0;
+    const double* data = nullptr;
+};
+
+inline double at(const Slot& s, int i) { return s.scalar ? s.value : s.data[i]; }
+
+template <typename F>
+void unaryLoop(double* out, const double* a, int n, F f)
+{
+    for (int i = 0; i < n; ++i) out[i] = f(a[i]);
+}
+
+template <typename F>
+void binaryLoop(double* out, const Slot& a, const Slot& b, int n, F f)
+{
+    if (a.scalar) {
+        const double x = a.value;
+        for (int i = 0; i < n; ++i) out[i] = f(x, b.data[i]);
+    } else if (b.scalar) {
+        const double y = b.value;
+        for (int i = 0; i < n; ++i) out[i] = f(a.data[i], y);
+    } else {
+        for (int i = 0; i < n; ++i) out[i] = f(a.data[i], b.data[i]);
+    }
+}
+
+void binaryOp(OpCode op, double* out, const Slot& a, const Slot& b, int n)
+{
+    switch (op) {
+    case ColumnExpression::Add:      binaryLoop(out, a, b, n, [](double x, double y) { return x + y; }); break;
+    case ColumnExpression::Subtract: binaryLoop(out, a, b, n, [](double x, double y) { return x - y; }); break;
+    case ColumnExpression::Multiply: binaryLoop(out, a, b, n, [](double x, double y) { return x * y; }); break;
+    case ColumnExpression::Divide:   binaryLoop(out, a, b, n, [](double x, double y) { return x / y; }); break;
+    default: binaryLoop(out, a, b, n, [op](double x, double y) { return applyOp(op, x, y, 0.0); }); break;
+    }
+}
+
+} // namespace
+
+ColumnExpression::ColumnExpression() = default;
+
+bool ColumnExpression::compile(const QString& text, const QStringList& columnNames,
+                               const QMap<QString, double>& variables, QString* errorMessage)
+{
+    m_text = text;
+    m_program.clear();
+    m_stackDepth = 0;
+
+    Parser parser(text, columnNames, variables);
+    const int root = parser.parse();
+    if (root < 0) {
+        if (errorMessage) *errorMessage = parser.error.isEmpty() ? QString("表达式为空") : parser.error;
+        return false;
+    }
+
+    int depth = 0;
+    emitProgram(parser.nodes, root, m_program, depth, m_stackDepth);
+    return true;
+}
+
+QVector<int> ColumnExpression::referencedColumns() const
+{
+    QVector<int> columns;
+    for (const Instruction& ins : m_program) {
+        if ((ins.op == PushColumn || ins.op == PushFirst) && !columns.contains(ins.column)) columns.append(ins.column);
+    }
+    std::sort(columns.begin(), columns.end());
+    return columns;
+}
+
+QVector<double> ColumnExpression::evaluate(const ColumnarTableModel* model) const
+{
+    if (!model || m_program.isEmpty()) return QVector<double>();
+    const int rows = model->rowCount();
+
+    // 各引用列的数组 (长度不足行数时补 NaN) 与 first() 基准值
+    QMap<int, QVector<double>> padded;
+    QMap<int, const double*> columnData;
+    QMap<int, double> firstValues;
+    for (int column : referencedColumns()) {
+        if (column >= model->columnCount()) return QVector<double>();
+        const ColumnarTableModel::ColumnSpan span = model->columnSpan(column);
+        if (span.size >= rows) {
+            columnData.insert(column, span.data);
+        } else {
+            QVector<double> values(rows, kNaN);
+            std::copy(span.begin(), span.end(), values.begin());
+            padded.insert(column, values);
+            columnData.insert(column, padded[column].constData());
+        }
+        const double* data = columnData.value(column);
+        double first = kNaN;
+        for (int i = 0; i < rows; ++i) {
+            if (std::isfinite(data[i])) { first = data[i]; break; }
+        }
+        firstValues.insert(column, first);
+    }
+
+    // 指令中的列直接换成数组指针，求值循环中不再查表
+    QVector<const double*> pointers(m_program.size(), nullptr);
+    QVector<double> constants(m_program.size(), 0.0);
+    for (int k = 0; k < m_program.size(); ++k) {
+        const Instruction& ins = m_program[k];
+        if (ins.op == PushColumn) pointers[k] = columnData.value(ins.column);
+        else if (ins.op == PushFirst) constants[k] = firstValues.value(ins.column);
+        else constants[k] = ins.value;
+    }
+
+    QVector<double> result(rows, kNaN);
+    double* out = result.data();
+
+    QVector<int> chunks;
+    for (int first = 0; first < rows; first += kChunkRows) chunks.append(first);
+
+    QtConcurrent::blockingMap(chunks, [&](int first) {
+        const int n = qMin(kChunkRows, rows - first);
+        QVector<double> buffers(qMax(1, m_stackDepth) * kChunkRows);
+        QVector<Slot> stack(qMax(1, m_stackDepth));
+        int top = -1;
+
+        for (int k = 0; k < m_program.size(); ++k) {
+            const OpCode op = m_program[k].op;
+            const int count = operandCount(op);
+            if (count == 0) {
+                Slot& s = stack[++top];
+                s.scalar = (op != PushColumn);
+                s.value = constants[k];
+                s.data = s.scalar ? nullptr : pointers[k] + first;
+                continue;
+            }
+
+            top -= count - 1; // 结果放在第一个操作数的位置
+            Slot& a = stack[top];
+            double* buffer = buffers.data() + top * kChunkRows;
+            if (count == 1) {
+                if (a.scalar) { a.value = applyOp(op, a.value, 0.0, 0.0); continue; }
+                unaryLoop(buffer, a.data, n, [op](double x) { return applyOp(op, x, 0.0, 0.0); });
+            } else if (count == 2) {
+                const Slot& b = stack[top + 1];
+                if (a.scalar && b.scalar) { a.value = applyOp(op, a.value, b.value, 0.0); continue; }
+                binaryOp(op, buffer, a, b, n);
+            } else {
+                const Slot& b = stack[top + 1];
+                const Slot& c = stack[top + 2];
+                for (int i = 0; i < n; ++i) buffer[i] = applyOp(op, at(a, i), at(b, i), at(c, i));
+            }
+            a.scalar = false;
+            a.data = buffer;
+        }
+
+        const Slot& r = stack[0];
+        for (int i = 0; i < n; ++i) out[first + i] = at(r, i);
+    });
+
+    return result;
+}
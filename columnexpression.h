@@ -0,0 +1,63 @@
+/*
+ * columnexpression.h
+ * 文件作用: 数据表列表达式 (派生列) 求值引擎头文件
+ * 功能描述:
+ * 1. 把 "Pc + (Hres - Lwf) * rho * g / 1e6" 这类表达式编译一次为后缀指令序列，按列批量求值得到新列，
+ *    替代为每种派生量手写的逐行循环 (压降、井底流压、单位换算等均可表达为预设表达式)。
+ * 2. 列引用: [表头全文]、$N (第 N 列，从 1 起) 或标识符 (与表头全文或表头中 '\' 之前的名称相同)；
+ *    标识符优先匹配命名常量 (variables)，其次为 pi、nan。
+ * 3. 运算: + - * / ^、一元负号、比较 (< <= > >= == !=，结果为 1 或 0)；函数 abs sqrt exp ln log10 pow min max，
+ *    if(条件, 是, 否)，first(列) 为该列第一个有效数值 (用于以首个记录为基准的压降等)。
+ * 4. 求值按 4096 行一段在线程池中并行：每条指令对整段数组执行一次紧凑循环 (常量不展开为数组)，
+ *    列数据直接读取 ColumnarTableModel::columnSpan，不复制、不经文本。空单元格与文本单元格为 NaN，结果随之为 NaN。
+ * 5. 编译错误通过 errorMessage 返回，不抛出异常。
+ */
+
+#ifndef COLUMNEXPRESSION_H
+#define COLUMNEXPRESSION_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "columnartablemodel.h"
+
+class ColumnExpression
+{
+public:
+    ColumnExpression();
+
+    // 编译表达式；columnNames 为各列表头 (列引用按此解析)
+    bool compile(const QString& text, const QStringList& columnNames,
+                 const QMap<QString, double>& variables = QMap<QString, double>(),
+                 QString* errorMessage = nullptr);
+
+    bool isValid() const { return !m_program.isEmpty(); }
+    QString text() const { return m_text; }
+    // 表达式引用的列 (升序，不重复)
+    QVector<int> referencedColumns() const;
+
+    // 对模型每一行求值 (结果长度为行数)；引用的列超出模型列数时返回空数组
+    QVector<double> evaluate(const ColumnarTableModel* model) const;
+
+    // 指令 (公开供实现文件中的编译与求值辅助函数使用)
+    enum OpCode {
+        PushConstant, PushColumn, PushFirst,
+        Negate, Abs, Sqrt, Exp, Ln, Log10,
+        Add, Subtract, Multiply, Divide, Power, Min, Max,
+        Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual,
+        Select
+    };
+    struct Instruction {
+        OpCode op = PushConstant;
+        double value = 0.0; // PushConstant
+        int column = -1;    // PushColumn / PushFirst
+    };
+
+private:
+    QString m_text;
+    QVector<Instruction> m_program;
+    int m_stackDepth = 0;
+};
+
+#endif // COLUMNEXPRESSION_H
@@ -0,0 +1,99 @@
+/*
+ * 文件名: compactseries.cpp
+ * 文件作用: 显示用紧凑数据序列实现文件
+ * 功能描述:
+ * 1. 等间隔判断：各点与 start + i·step 的偏差都不超过步长的 1e-6 时采用隐式时间轴 (遇到第一个超差点即放弃)。
+ * 2. 块内增量按 double 相减后舍入为 float，舍入保序，块内解码结果仍然有序。
+ */
+
+#include "compactseries.h"
+#include <algorithm>
+#include <cmath>
+
+CompactSeries CompactSeries::encode(const QVector<double>& keys, const QVector<double>& values)
+{
+    CompactSeries s;
+    const int n = qMin(keys.size(), values.size());
+    s.m_values.resize(n);
+    for (int i = 0; i < n; ++i) s.m_values[i] = float(values[i]);
+    if (n == 0) return s;
+
+    s.m_start = keys[0];
+    s.m_step = n > 1 ? (keys[n - 1] - keys[0]) / (n - 1) : 0.0;
+    s.m_implicit = n == 1 || s.m_step > 0.0;
+    const double tolerance = 1e-6 * s.m_step;
+    for (int i = 1; s.m_implicit && i < n - 1; ++i)
+        if (std::abs(keys[i] - (s.m_start + i * s.m_step)) > tolerance) s.m_implicit = false;
+    if (s.m_implicit) return s;
+
+    s.m_step = 0.0;
+    s.m_anchors.resize((n + BlockSize - 1) / BlockSize);
+    s.m_offsets.resize(n);
+    for (int i = 0; i < n; ++i) {
+        if (i % BlockSize == 0) s.m_anchors[i / BlockSize] = keys[i];
+        s.m_offsets[i] = float(keys[i] - s.m_anchors[i / BlockSize]);
+    }
+    return s;
+}
+
+int CompactSeries::lowerBound(double k) const
+{
+    return bound(k, false);
+}
+
+int CompactSeries::upperBound(double k) const
+{
+    return bound(k, true);
+}
+
+int CompactSeries::bound(double k, bool strict) const
+{
+    const int n = size();
+    // 下标 i 处的点是否已越过 k
+    auto past = [&](int i) { return strict ? key(i) > k : key(i) >= k; };
+    if (n == 0) return 0;
+
+    int lo = 0, hi = n;
+    if (m_implicit) {
+        if (m_step > 0.0) {
+            const double guess = std::ceil((k - m_start) / m_step);
+            lo = int(qBound(0.0, guess, double(n)));
+        }
+        // 计算的下标至多差一两个点，向两侧修正
+        while (lo > 0 && past(lo - 1)) --lo;
+        while (lo < n && !past(lo)) ++lo;
+        return lo;
+    }
+
+    // 锚点上二分：最后一个尚未越过 k 的块
+    auto anchor = strict ? std::upper_bound(m_anchors.constBegin(), m_anchors.constEnd(), k)
+                         : std::lower_bound(m_anchors.constBegin(), m_anchors.constEnd(), k);
+    const int block = int(anchor - m_anchors.constBegin()) - 1;
+    if (block < 0) return 0;
+    lo = block * BlockSize;
+    hi = qMin(n, lo + BlockSize);
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (past(mid)) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+void CompactSeries::decode(int first, int count, QVector<double>& keys, QVector<double>& values) const
+{
+    first = qBound(0, first, size());
+    count = qBound(0, count, size() - first);
+    keys.resize(count);
+    values.resize(count);
+    for (int i = 0; i < count; ++i) {
+        keys[i] = key(first + i);
+        values[i] = m_values[first + i];
+    }
+}
+
+qint64 CompactSeries::bytes() const
+{
+    return qint64(m_values.capacity()) * sizeof(float) + qint64(m_offsets.capacity()) * sizeof(float)
+           + qint64(m_anchors.capacity()) * sizeof(double);
+}
@@ -0,0 +1,59 @@
+/*
+ * 文件名: compactseries.h
+ * 文件作用: 显示用紧凑数据序列头文件
+ * 功能描述:
+ * 1. 纵坐标以 float 保存 (NaN 照常保留，用于断线)，每点 4 字节。
+ * 2. 横坐标 (须有序) 为等间隔序列时只保存起点与步长 (隐式时间轴，不占每点存储)；否则每 64 点保存一个 double 锚点，
+ *    块内保存相对锚点的 float 增量，误差只与块内跨度有关，不随序列长度累积。
+ * 3. lowerBound / upperBound 先在锚点上二分再在块内二分 (隐式时间轴直接计算下标)；decode 只解码所需的下标段。
+ * 4. 仅用于屏幕显示：编码误差在像素以下，拟合、导数与导出等计算仍使用原始的 double 数组。
+ */
+
+#ifndef COMPACTSERIES_H
+#define COMPACTSERIES_H
+
+#include <QVector>
+#include <QtGlobal>
+
+class CompactSeries
+{
+public:
+    CompactSeries() = default;
+
+    // 编码有序数据 (长度取两个数组的较小者)
+    static CompactSeries encode(const QVector<double>& keys, const QVector<double>& values);
+
+    int size() const { return m_values.size(); }
+    bool isEmpty() const { return m_values.isEmpty(); }
+    bool hasImplicitKeys() const { return m_implicit; }
+
+    double key(int i) const
+    {
+        return m_implicit ? m_start + i * m_step : m_anchors[i / BlockSize] + m_offsets[i];
+    }
+    double value(int i) const { return m_values[i]; }
+
+    // 第一个横坐标不小于 / 大于 k 的下标 (都不满足时为 size())
+    int lowerBound(double k) const;
+    int upperBound(double k) const;
+
+    // 解码 [first, first + count) 段，覆盖输出数组
+    void decode(int first, int count, QVector<double>& keys, QVector<double>& values) const;
+
+    // 占用的字节数
+    qint64 bytes() const;
+
+private:
+    static const int BlockSize = 64;
+
+    int bound(double k, bool strict) const;
+
+    QVector<float> m_values;
+    bool m_implicit = false;
+    double m_start = 0.0;
+    double m_step = 0.0;
+    QVector<double> m_anchors;  // 每块第一个点的横坐标
+    QVector<float> m_offsets;   // 相对所在块锚点的增量
+};
+
+#endif // COMPACTSERIES_H
@@ -0,0 +1,112 @@
+# ----------------------------------------------------
+# 计算核心 (不依赖界面): 模型求解器、Laplace 反演、导数计算、抽样与拟合
+# 由主工程 WellTest.pro 与命令行批处理 cli/welltestcli.pro 共同包含
+# 只需 QtCore、QtGui (ColumnarTableModel 使用 QColor，不需要显示环境) 与 QtConcurrent
+# ----------------------------------------------------
+
+QT *= core gui concurrent
+CONFIG *= c++17
+
+# 性能跟踪埋点 (tracing.h) 默认编译进来并在运行期开关；发布版如需完全去除可打开下面一行
+# DEFINES += WT_DISABLE_TRACING
+
+# 按子系统的分配计数 (memoryaccounting.h) 会替换全局 operator new，默认不编译；内存诊断时打开下面一行
+# DEFINES += WT_ALLOCATION_ACCOUNTING
+
+# Laplace 储层响应的 OpenCL 设备后端 (opencllaplacebackend.h) 默认不编译；需要 OpenCL SDK 与支持双精度的 GPU，
+# 以 qmake CONFIG+=wt_opencl 构建后在设置项 performance/laplaceBackend 中选择 opencl
+wt_opencl {
+    DEFINES += WT_ENABLE_OPENCL
+    LIBS += -lOpenCL
+    HEADERS += $$PWD/opencllaplacebackend.h
+    SOURCES += $$PWD/opencllaplacebackend.cpp
+}
+
+# 进程内存查询 (GetProcessMemoryInfo)
+win32: LIBS += -lpsapi
+
+INCLUDEPATH += $$PWD
+
+# Eigen 矩阵库
+INCLUDEPATH += D:/08YYYXXX/eigen-3.3.8
+
+# Boost 库
+INCLUDEPATH += D:/08YYYXXX/boost_1_89_0
+
+HEADERS += \
+           $$PWD/adaptivecurvesampler.h \
+           $$PWD/besselbatch.h \
+           $$PWD/bourdetderivative.h \
+           $$PWD/cancellationtoken.h \
+           $$PWD/columnartablemodel.h \
+           $$PWD/columncodec.h \
+           $$PWD/curveinterpolation.h \
+           $$PWD/derivativesmoother.h \
+           $$PWD/fitevaluationcache.h \
+           $$PWD/fitparameter.h \
+           $$PWD/flowregime.h \
+           $$PWD/fittingcore.h \
+           $$PWD/fittingjobqueue.h \
+           $$PWD/fittingsampling.h \
+           $$PWD/fituncertainty.h \
+           $$PWD/gaugeseries.h \
+           $$PWD/jointfitter.h \
+           $$PWD/laplacebatchbackend.h \
+           $$PWD/laplacecache.h \
+           $$PWD/laplaceinterpolant.h \
+           $$PWD/laplaceinversion.h \
+           $$PWD/logbinsampler.h \
+           $$PWD/memoryaccounting.h \
+           $$PWD/modelengine.h \
+           $$PWD/modelsolver01-06.h \
+           $$PWD/normalequations.h \
+           $$PWD/observeddataset.h \
+           $$PWD/parametertransform.h \
+           $$PWD/performancesettings.h \
+           $$PWD/pressurederivativecalculator.h \
+           $$PWD/sensitivityjet.h \
+           $$PWD/sheetresidency.h \
+           $$PWD/solverpool.h \
+           $$PWD/superposition.h \
+           $$PWD/taskscheduler.h \
+           $$PWD/tracing.h \
+           $$PWD/typecurveindex.h \
+           $$PWD/typecurvelibrary.h
+
+SOURCES += \
+           $$PWD/adaptivecurvesampler.cpp \
+           $$PWD/besselbatch.cpp \
+           $$PWD/bourdetderivative.cpp \
+           $$PWD/cancellationtoken.cpp \
+           $$PWD/columnartablemodel.cpp \
+           $$PWD/columncodec.cpp \
+           $$PWD/curveinterpolation.cpp \
+           $$PWD/derivativesmoother.cpp \
+           $$PWD/fitevaluationcache.cpp \
+           $$PWD/fitparameter.cpp \
+           $$PWD/flowregime.cpp \
+           $$PWD/fittingcore.cpp \
+           $$PWD/fittingjobqueue.cpp \
+           $$PWD/fituncertainty.cpp \
+           $$PWD/gaugeseries.cpp \
+           $$PWD/jointfitter.cpp \
+           $$PWD/laplacebatchbackend.cpp \
+           $$PWD/laplacecache.cpp \
+           $$PWD/laplaceinterpolant.cpp \
+           $$PWD/laplaceinversion.cpp \
+           $$PWD/logbinsampler.cpp \
+           $$PWD/memoryaccounting.cpp \
+           $$PWD/modelengine.cpp \
+           $$PWD/modelsolver01-06.cpp \
+           $$PWD/normalequations.cpp \
+           $$PWD/observeddataset.cpp \
+           $$PWD/parametertransform.cpp \
+           $$PWD/performancesettings.cpp \
+           $$PWD/pressurederivativecalculator.cpp \
+           $$PWD/sheetresidency.cpp \
+           $$PWD/solverpool.cpp \
+           $$PWD/superposition.cpp \
+           $$PWD/taskscheduler.cpp \
+           $$PWD/tracing.cpp \
+           $$PWD/typecurveindex.cpp \
+           $$PWD/typecurvelibrary.cpp
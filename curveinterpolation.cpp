@@ -0,0 +1,164 @@
+/*
+ * curveinterpolation.cpp
+ * 文件作用: 理论曲线网格插值工具实现文件
+ * 功能描述:
+ * 1. 对数网格生成与 ModelSolver01_06::generateLogTimeSteps 相同的 10 的幂次求值方式。
+ * 2. Hermite 斜率：内部节点两侧差商异号或为零时取 0，否则取加权调和平均 (保单调、无过冲)；
+ *    端点取三点单侧公式，并按 pchip 规则限幅。
+ * 3. 二进网格以 ldexp(2^(r/q), e) 生成 (j = e·q + r)：只有 q 个尾数由 exp2 求出，其余节点为其精确的 2 的幂次倍。
+ */
+
+#include "curveinterpolation.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 插值坐标：x 取 ln t，y 在全部为正时取对数
+struct Coordinates {
+    QVector<double> x, y;
+    bool logY = true;
+};
+
+Coordinates toCoordinates(const QVector<double>& x, const QVector<double>& y)
+{
+    Coordinates c;
+    const int n = std::min(x.size(), y.size());
+    for (int i = 0; i < n; ++i) {
+        if (!(y[i] > 0.0)) { c.logY = false; break; }
+    }
+    c.x.resize(n);
+    c.y.resize(n);
+    for (int i = 0; i < n; ++i) {
+        c.x[i] = std::log(x[i]);
+        c.y[i] = c.logY ? std::log(y[i]) : y[i];
+    }
+    return c;
+}
+
+// pchip 端点斜率
+double endSlope(double h0, double h1, double del0, double del1)
+{
+    double d = ((2.0 * h0 + h1) * del0 - h0 * del1) / (h0 + h1);
+    if (d * del0 <= 0.0) return 0.0;
+    if (del0 * del1 <= 0.0 && std::abs(d) > std::abs(3.0 * del0)) return 3.0 * del0;
+    return d;
+}
+
+// 单调三次 Hermite 斜率
+QVector<double> hermiteSlopes(const QVector<double>& x, const QVector<double>& y)
+{
+    const int n = x.size();
+    QVector<double> d(n, 0.0);
+    if (n < 2) return d;
+    QVector<double> h(n - 1), del(n - 1);
+    for (int i = 0; i + 1 < n; ++i) {
+        h[i] = x[i + 1] - x[i];
+        del[i] = (y[i + 1] - y[i]) / h[i];
+    }
+    if (n == 2) {
+        d[0] = d[1] = del[0];
+        return d;
+    }
+    for (int i = 1; i + 1 < n; ++i) {
+        if (del[i - 1] * del[i] <= 0.0) continue;
+        const double w1 = 2.0 * h[i] + h[i - 1];
+        const double w2 = h[i] + 2.0 * h[i - 1];
+        d[i] = (w1 + w2) / (w1 / del[i - 1] + w2 / del[i]);
+    }
+    d[0] = endSlope(h[0], h[1], del[0], del[1]);
+    d[n - 1] = endSlope(h[n - 2], h[n - 3], del[n - 2], del[n - 3]);
+    return d;
+}
+
+// 在坐标 (x, y, 斜率 d) 上求 xq 处的值
+double evaluateHermite(const QVector<double>& x, const QVector<double>& y, const QVector<double>& d, double xq)
+{
+    const int n = x.size();
+    if (xq <= x.first()) return y.first() + (xq - x.first()) * (y[1] - y[0]) / (x[1] - x[0]);
+    if (xq >= x.last()) return y.last() + (xq - x.last()) * (y[n - 1] - y[n - 2]) / (x[n - 1] - x[n - 2]);
+    const int i = int(std::upper_bound(x.constBegin(), x.constEnd(), xq) - x.constBegin()) - 1;
+    const double h = x[i + 1] - x[i];
+    const double s = (xq - x[i]) / h;
+    const double s2 = s * s, s3 = s2 * s;
+    const double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    const double h10 = s3 - 2.0 * s2 + s;
+    const double h01 = -2.0 * s3 + 3.0 * s2;
+    const double h11 = s3 - s2;
+    return h00 * y[i] + h10 * h * d[i] + h01 * y[i + 1] + h11 * h * d[i + 1];
+}
+
+} // namespace
+
+QVector<double> CurveInterpolation::logUniformGrid(double tMin, double tMax, int pointsPerDecade, int padding)
+{
+    QVector<double> grid;
+    if (!(tMin > 0.0) || !(tMax >= tMin) || pointsPerDecade <= 0) return grid;
+    const double step = 1.0 / pointsPerDecade;
+    const double startExp = std::log10(tMin) - padding * step;
+    const int intervals = std::max(1, int(std::ceil((std::log10(tMax) - std::log10(tMin)) * pointsPerDecade - 1e-9)))
+                          + 2 * padding;
+    grid.reserve(intervals + 1);
+    for (int i = 0; i <= intervals; ++i) grid.append(std::pow(10.0, startExp + i * step));
+    return grid;
+}
+
+QVector<double> CurveInterpolation::dyadicGrid(double tMin, double tMax, int pointsPerDecade, int padding)
+{
+    QVector<double> grid;
+    if (!(tMin > 0.0) || !(tMax >= tMin) || pointsPerDecade <= 0) return grid;
+    const int q = std::max(1, int(std::ceil(pointsPerDecade * std::log10(2.0) - 1e-9)));
+    QVector<double> mantissa(q);
+    for (int r = 0; r < q; ++r) mantissa[r] = std::exp2(double(r) / q);
+
+    const int first = int(std::floor(std::log2(tMin) * q + 1e-9)) - padding;
+    const int last = std::max(first + 1 + padding, int(std::ceil(std::log2(tMax) * q - 1e-9)) + padding);
+    grid.reserve(last - first + 1);
+    for (int j = first; j <= last; ++j) {
+        const int e = (j >= 0) ? j / q : -((-j + q - 1) / q); // 向下取整的商
+        grid.append(std::ldexp(mantissa[j - e * q], e));
+    }
+    return grid;
+}
+
+QVector<double> CurveInterpolation::interpolateLogLog(const QVector<double>& x, const QVector<double>& y,
+                                                      const QVector<double>& xq)
+{
+    QVector<double> out(xq.size(), 0.0);
+    if (x.size() < 2 || y.size() != x.size()) return out;
+
+    const Coordinates c = toCoordinates(x, y);
+    const QVector<double> d = hermiteSlopes(c.x, c.y);
+    for (int k = 0; k < xq.size(); ++k) {
+        if (!(xq[k] > 0.0)) continue;
+        const double v = evaluateHermite(c.x, c.y, d, std::log(xq[k]));
+        out[k] = c.logY ? std::exp(v) : v;
+    }
+    return out;
+}
+
+double CurveInterpolation::estimateRelativeError(const QVector<double>& x, const QVector<double>& y)
+{
+    const int n = std::min(x.size(), y.size());
+    if (n < 5) return 0.0;
+
+    // 隔点子网格 (保留偶数下标节点) 插值回奇数下标节点
+    const Coordinates c = toCoordinates(x, y);
+    QVector<double> xs, ys;
+    for (int i = 0; i < n; i += 2) { xs.append(c.x[i]); ys.append(c.y[i]); }
+    const QVector<double> d = hermiteSlopes(xs, ys);
+
+    double scale = 0.0;
+    if (!c.logY) {
+        for (int i = 0; i < n; ++i) scale = std::max(scale, std::abs(y[i]));
+    }
+    double worst = 0.0;
+    for (int i = 1; i + 1 < n; i += 2) {
+        const double v = evaluateHermite(xs, ys, d, c.x[i]);
+        const double err = c.logY ? std::abs(std::expm1(v - c.y[i]))
+                                  : std::abs(v - c.y[i]) / std::max(scale, 1e-300);
+        worst = std::max(worst, err);
+    }
+    return worst / 8.0;
+}
@@ -0,0 +1,36 @@
+/*
+ * curveinterpolation.h
+ * 文件作用: 理论曲线网格插值工具头文件
+ * 功能描述:
+ * 1. 生成每个对数周期点数固定的对数等距时间网格 (两端可外延若干步，保证 Bourdet 导数端点稳定)。
+ * 2. 双对数坐标下的单调三次 Hermite 插值 (Fritsch-Butland 斜率，MATLAB pchip 端点公式)：
+ *    数据全部为正时在 (ln t, ln y) 上插值，否则在 (ln t, y) 上插值；网格外按端点段线性外推。
+ * 3. 插值误差估计：以隔点子网格插值回被剔除节点，三阶误差按步长减半缩小 8 倍折算到完整网格。
+ * 4. 二进网格：节点取自绝对格点 2^(j/q)，相隔 q 步的节点恰为 2 倍 (逐位精确)，
+ *    Stehfest 节点 m·ln2/t 在不同时间点之间逐位重合，供求解器共享 Laplace 节点。
+ */
+
+#ifndef CURVEINTERPOLATION_H
+#define CURVEINTERPOLATION_H
+
+#include <QVector>
+
+class CurveInterpolation
+{
+public:
+    // [tMin, tMax] 上每个对数周期 pointsPerDecade 个点的对数等距网格，两端各外延 padding 步
+    static QVector<double> logUniformGrid(double tMin, double tMax, int pointsPerDecade, int padding = 0);
+
+    // 覆盖 [tMin, tMax] 的二进网格 t_j = 2^(j/q)，q 为每个倍程的点数 (取使每个对数周期不少于 pointsPerDecade 点的最小值)，
+    // 两端各外延 padding 步；节点与区间无关，相同 q 的网格彼此重合
+    static QVector<double> dyadicGrid(double tMin, double tMax, int pointsPerDecade, int padding = 0);
+
+    // 双对数单调三次插值：x 严格递增且为正，返回 xq 各点的插值结果 (xq 中非正的点结果为 0)
+    static QVector<double> interpolateLogLog(const QVector<double>& x, const QVector<double>& y,
+                                             const QVector<double>& xq);
+
+    // 网格 (x, y) 上插值的最大相对误差估计 (节点数少于 5 时返回 0)
+    static double estimateRelativeError(const QVector<double>& x, const QVector<double>& y);
+};
+
+#endif // CURVEINTERPOLATION_H
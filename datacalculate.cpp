@@ -6,6 +6,10 @@
  * 2. 实现核心的时间数据解析和转换算法。
  * 3. 实现基于压力列的压降计算算法。
  * 4. 实现井底流压计算弹窗及核心算法 (基于 MATLAB 逻辑)。
+ * 5. [快速时间转换] 时间转换先由样本识别一次日期/时刻格式 (TimestampParser)，各段行在线程池中并行解析为秒数，
+ *    再一次性写入新列；与识别格式不符的单元格仍按原有格式逐个尝试。
+ * 6. [表达式列] 实现表达式列对话框与 calculateExpressionColumn；压降 (first(P) - P) 与井底流压
+ *    (if(Lwf >= Hres, nan, Pc + (Hres - Lwf) * gamma_mix / 100)) 均以预设表达式经 ColumnExpression 并行计算后整列写入。
  */
 
 #include "datacalculate.h"
@@ -16,7 +20,11 @@
 #include <QPushButton>
 #include <QDebug>
 #include <QDateTime>
+#include <QtConcurrent>
 #include <cmath>
+#include <limits>
+#include "timestampparser.h"
+#include "columnexpression.h"
 
 // ============================================================================
 // TimeConversionDialog 实现
@@ -274,13 +282,129 @@ PwfCalculationConfig PwfCalculationDialog::getConfig() const
     return c;
 }
 
+// ============================================================================
+// ExpressionColumnDialog 实现
+// ============================================================================
+
+ExpressionColumnDialog::ExpressionColumnDialog(const QStringList& columnNames, QWidget* parent)
+    : QDialog(parent), m_columnNames(columnNames)
+{
+    setWindowTitle("表达式列");
+    resize(480, 420);
+    setStyleSheet("QDialog { background-color: white; color: black; font-family: \"Microsoft YaHei\", Arial; } "
+                  "QLabel { color: black; background: transparent; font-weight: normal;} "
+                  "QGroupBox { color: black; border: 1px solid #ccc; margin-top: 10px; font-weight: bold; } "
+                  "QLineEdit { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QSpinBox { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QComboBox { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QPushButton { color: white; background-color: #4a90e2; border: none; border-radius: 4px; padding: 6px 12px; } "
+                  "QPushButton:hover { background-color: #357abd; }");
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // 表达式组
+    QGroupBox* exprGroup = new QGroupBox("表达式");
+    QFormLayout* formExpr = new QFormLayout(exprGroup);
+
+    m_comboPreset = new QComboBox;
+    m_comboPreset->addItem("自定义", "");
+    m_comboPreset->addItem("压降 (首个有效值 - 当前值)", "first($1) - $1");
+    m_comboPreset->addItem("井底流压 (套压 + 液柱压力)", "$1 + (1822 - $2) * 0.85 / 100");
+    m_comboPreset->addItem("MPa → psi", "$1 * 145.0377");
+    m_comboPreset->addItem("psi → MPa", "$1 / 145.0377");
+    m_comboPreset->addItem("小时 → 分钟", "$1 * 60");
+    m_comboPreset->addItem("对数 (log10)", "log10($1)");
+
+    m_editExpression = new QLineEdit;
+    m_editExpression->setPlaceholderText("例如: [套压\\MPa] + (1822 - $3) * 0.85 / 100");
+
+    formExpr->addRow("预设:", m_comboPreset);
+    formExpr->addRow("表达式:", m_editExpression);
+
+    // 可引用的列
+    QStringList refs;
+    for (int i = 0; i < m_columnNames.size(); ++i) refs << QString("$%1 = %2").arg(i + 1).arg(m_columnNames[i]);
+    QLabel* labelColumns = new QLabel("可用列: " + refs.join("，") +
+                                      "\n列可写作 $N、[表头] 或表头名称；支持 + - * / ^、比较、"
+                                      "abs sqrt exp ln log10 pow min max if first。");
+    labelColumns->setWordWrap(true);
+    formExpr->addRow(labelColumns);
+    mainLayout->addWidget(exprGroup);
+
+    // 结果设置组
+    QGroupBox* resGroup = new QGroupBox("结果设置");
+    QFormLayout* formRes = new QFormLayout(resGroup);
+    m_editName = new QLineEdit("计算列");
+    m_editUnit = new QLineEdit;
+    m_spinDecimal = new QSpinBox;
+    m_spinDecimal->setRange(0, 10);
+    m_spinDecimal->setValue(3);
+    m_spinDecimal->setSuffix(" 位");
+    formRes->addRow("新列名称:", m_editName);
+    formRes->addRow("单位:", m_editUnit);
+    formRes->addRow("保留小数位数:", m_spinDecimal);
+    mainLayout->addWidget(resGroup);
+
+    m_labelError = new QLabel;
+    m_labelError->setStyleSheet("color: #c0392b;");
+    m_labelError->setWordWrap(true);
+    mainLayout->addWidget(m_labelError);
+
+    // 底部按钮
+    QHBoxLayout* btnLayout = new QHBoxLayout;
+    btnLayout->addStretch();
+    QPushButton* btnOk = new QPushButton("计算");
+    QPushButton* btnCancel = new QPushButton("取消");
+    btnOk->setStyleSheet("background-color: #28a745; color: white;");
+    btnCancel->setStyleSheet("background-color: #6c757d; color: white;");
+    connect(btnOk, &QPushButton::clicked, this, &QDialog::accept);
+    connect(btnCancel, &QPushButton::clicked, this, &QDialog::reject);
+    btnLayout->addWidget(btnOk);
+    btnLayout->addWidget(btnCancel);
+    mainLayout->addLayout(btnLayout);
+
+    connect(m_comboPreset, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ExpressionColumnDialog::onPresetChanged);
+}
+
+void ExpressionColumnDialog::onPresetChanged(int index)
+{
+    const QString expression = m_comboPreset->itemData(index).toString();
+    if (!expression.isEmpty()) m_editExpression->setText(expression);
+    m_labelError->clear();
+}
+
+void ExpressionColumnDialog::accept()
+{
+    ColumnExpression expression;
+    QString error;
+    if (!expression.compile(m_editExpression->text(), m_columnNames, QMap<QString, double>(), &error)) {
+        m_labelError->setText("表达式错误: " + error);
+        return;
+    }
+    if (m_editName->text().trimmed().isEmpty()) {
+        m_labelError->setText("请输入新列名称。");
+        return;
+    }
+    QDialog::accept();
+}
+
+ExpressionColumnConfig ExpressionColumnDialog::getConfig() const
+{
+    ExpressionColumnConfig c;
+    c.expression = m_editExpression->text();
+    c.columnName = m_editName->text().trimmed();
+    c.unit = m_editUnit->text().trimmed();
+    c.decimalPlaces = m_spinDecimal->value();
+    return c;
+}
+
 // ============================================================================
 // DataCalculate 实现
 // ============================================================================
 
 DataCalculate::DataCalculate(QObject* parent) : QObject(parent) {}
 
-TimeConversionResult DataCalculate::convertTimeColumn(QStandardItemModel* model,
+TimeConversionResult DataCalculate::convertTimeColumn(ColumnarTableModel* model,
                                                       QList<ColumnDefinition>& definitions,
                                                       const TimeConversionConfig& config)
 {
@@ -299,6 +423,14 @@ TimeConversionResult DataCalculate::convertTimeColumn(QStandardItemModel* model,
         return result;
     }
 
+    // 先在线程池中把各行解析为秒数 (源列只读)，再整体写入新列
+    QVector<double> seconds;
+    if (config.useDateAndTime) {
+        seconds = parseTimestamps(model, config.dateColumnIndex, config.timeColumnIndex);
+    } else {
+        seconds = parseTimestamps(model, -1, config.sourceTimeColumnIndex);
+    }
+
     // 在末尾插入新列
     int newColIdx = model->columnCount();
     model->insertColumn(newColIdx);
@@ -312,56 +444,22 @@ TimeConversionResult DataCalculate::convertTimeColumn(QStandardItemModel* model,
     definitions.append(newDef);
 
     // 设置表头
-    model->setHorizontalHeaderItem(newColIdx, new QStandardItem(newDef.name));
+    model->setHeaderData(newColIdx, Qt::Horizontal, newDef.name);
 
-    // 计算逻辑
-    QDateTime baseTime;
+    // 以第一条有效记录为基准
+    double base = 0.0;
     bool baseSet = false;
-
     for (int i = 0; i < rowCount; ++i) {
-        double val = 0.0;
-        bool valid = false;
-
-        if (config.useDateAndTime) {
-            // 日期+时刻模式
-            QString dStr = model->item(i, config.dateColumnIndex)->text();
-            QString tStr = model->item(i, config.timeColumnIndex)->text();
-            QDate d = parseDateString(dStr);
-            QTime t = parseTimeString(tStr);
-            if (d.isValid() && t.isValid()) {
-                QDateTime dt = combineDateAndTime(d, t);
-                if (!baseSet) { baseTime = dt; baseSet = true; }
-                double seconds = baseTime.secsTo(dt);
-                val = convertTimeToUnit(seconds, config.outputUnit);
-                valid = true;
-            }
-        } else {
-            // 仅时间模式
-            QString tStr = model->item(i, config.sourceTimeColumnIndex)->text();
-            QTime t = parseTimeString(tStr);
-            if (t.isValid()) {
-                // 如果没有日期，取当前日期与该时间组合
-                if (!baseSet) {
-                    baseTime = QDateTime(QDate::currentDate(), t);
-                    baseSet = true;
-                }
-                QDateTime dt(QDate::currentDate(), t);
-                // 处理跨天情况(简单处理: 如果时间比基准小很多，假设是第二天)
-                if (dt < baseTime) dt = dt.addDays(1);
-
-                double seconds = baseTime.secsTo(dt);
-                val = convertTimeToUnit(seconds, config.outputUnit);
-                valid = true;
-            }
-        }
-
-        if (valid) {
-            model->setItem(i, newColIdx, new QStandardItem(QString::number(val, 'f', 3)));
-            result.processedRows++;
-        } else {
-            model->setItem(i, newColIdx, new QStandardItem(""));
-        }
+        double t = seconds[i];
+        if (std::isnan(t)) continue;
+        if (!baseSet) { base = t; baseSet = true; }
+        double elapsed = t - base;
+        // 仅时间模式下处理跨天情况 (简单处理: 时间比基准小时，假设是第二天)
+        if (!config.useDateAndTime && elapsed < 0) elapsed += 86400.0;
+        seconds[i] = convertTimeToUnit(elapsed, config.outputUnit);
+        result.processedRows++;
     }
+    model->setColumnValues(newColIdx, seconds, 3);
 
     result.success = true;
     result.addedColumnIndex = newColIdx;
@@ -369,7 +467,7 @@ TimeConversionResult DataCalculate::convertTimeColumn(QStandardItemModel* model,
     return result;
 }
 
-PressureDropResult DataCalculate::calculatePressureDrop(QStandardItemModel* model,
+PressureDropResult DataCalculate::calculatePressureDrop(ColumnarTableModel* model,
                                                         QList<ColumnDefinition>& definitions)
 {
     PressureDropResult result;
@@ -381,45 +479,25 @@ PressureDropResult DataCalculate::calculatePressureDrop(QStandardItemModel* mode
         return result;
     }
 
-    QString unit = definitions[pIdx].unit;
-    int newColIdx = model->columnCount();
-    model->insertColumn(newColIdx);
-
-    ColumnDefinition newDef;
-    newDef.name = "压降\\" + unit;
-    newDef.type = WellTestColumnType::PressureDrop;
-    newDef.unit = unit;
-    newDef.decimalPlaces = 3;
-    definitions.append(newDef);
-
-    model->setHorizontalHeaderItem(newColIdx, new QStandardItem(newDef.name));
-
-    double initialPressure = 0.0;
-    bool initSet = false;
-
-    for (int i = 0; i < model->rowCount(); ++i) {
-        QString pText = model->item(i, pIdx)->text();
-        bool ok;
-        double p = pText.toDouble(&ok);
-
-        if (ok) {
-            if (!initSet) { initialPressure = p; initSet = true; }
-            double drop = initialPressure - p;
-            model->setItem(i, newColIdx, new QStandardItem(QString::number(drop, 'f', 3)));
-            result.processedRows++;
-        } else {
-            model->setItem(i, newColIdx, new QStandardItem(""));
-        }
-    }
-
-    result.success = true;
-    result.addedColumnIndex = newColIdx;
-    result.columnName = newDef.name;
+    // 预设表达式：以第一个有效压力为基准
+    ExpressionColumnConfig expr;
+    expr.expression = QString("first($%1) - $%1").arg(pIdx + 1);
+    expr.columnName = "压降";
+    expr.unit = definitions[pIdx].unit;
+    expr.type = WellTestColumnType::PressureDrop;
+    expr.decimalPlaces = 3;
+
+    const ExpressionColumnResult r = calculateExpressionColumn(model, definitions, expr);
+    result.success = r.success;
+    result.errorMessage = r.errorMessage;
+    result.addedColumnIndex = r.addedColumnIndex;
+    result.columnName = r.columnName;
+    result.processedRows = r.processedRows;
     return result;
 }
 
 // 井底流压计算逻辑实现
-PwfCalculationResult DataCalculate::calculateBottomHolePressure(QStandardItemModel* model,
+PwfCalculationResult DataCalculate::calculateBottomHolePressure(ColumnarTableModel* model,
                                                                 QList<ColumnDefinition>& definitions,
                                                                 const PwfCalculationConfig& config)
 {
@@ -454,52 +532,46 @@ PwfCalculationResult DataCalculate::calculateBottomHolePressure(QStandardItemMod
     // 公式：gamma_mix = 1 / [(1 - f_w)/gamma_o + f_w/gamma_w]
     double gamma_mix = 1.0 / ((1.0 - f_w_decimal) / config.gamma_o + f_w_decimal / config.gamma_w);
 
-    // 3. 准备新列
-    int newColIdx = model->columnCount();
-    model->insertColumn(newColIdx);
-
     // 获取套压的单位作为流压单位，默认为 MPa
     QString unit = "MPa";
     if (config.pcColumnIndex < definitions.size() && !definitions[config.pcColumnIndex].unit.isEmpty()) {
         unit = definitions[config.pcColumnIndex].unit;
     }
 
-    ColumnDefinition newDef;
-    newDef.name = "井底流压\\" + unit;
-    newDef.type = WellTestColumnType::BottomHolePressure;
-    newDef.unit = unit;
-    newDef.decimalPlaces = config.decimalPlaces; // 使用用户选择的小数位数
-    definitions.append(newDef);
-
-    model->setHorizontalHeaderItem(newColIdx, new QStandardItem(newDef.name));
+    // 3. 预设表达式：Pwf = Pc + (Hres - Lwf) * gamma_mix / 100
+    // 注：除以100是将 g/cm³ * m 转换为 MPa (近似工程单位换算)；动液面深度不小于油层深度时物理上不合理，结果留空
+    ExpressionColumnConfig expr;
+    expr.expression = QString("if($%2 >= Hres, nan, $%1 + (Hres - $%2) * gamma_mix / 100)")
+                          .arg(config.pcColumnIndex + 1).arg(config.lwfColumnIndex + 1);
+    expr.columnName = "井底流压";
+    expr.unit = unit;
+    expr.type = WellTestColumnType::BottomHolePressure;
+    expr.decimalPlaces = config.decimalPlaces; // 使用用户选择的小数位数
+    expr.variables.insert("Hres", config.Hres);
+    expr.variables.insert("gamma_mix", gamma_mix);
+
+    const ExpressionColumnResult r = calculateExpressionColumn(model, definitions, expr);
+    if (!r.success) {
+        result.errorMessage = r.errorMessage;
+        return result;
+    }
+    const int newColIdx = r.addedColumnIndex;
 
-    // 4. 逐行计算
+    // 4. 套压与动液面均有效而结果为空的行即为不合理数据，标记错误文本
     int errorCount = 0;
-    for (int i = 0; i < model->rowCount(); ++i) {
-        QString pcStr = model->item(i, config.pcColumnIndex)->text();
-        QString lwfStr = model->item(i, config.lwfColumnIndex)->text();
-
-        bool pcOk, lwfOk;
-        double Pc = pcStr.toDouble(&pcOk);
-        double Lwf = lwfStr.toDouble(&lwfOk);
-
-        if (pcOk && lwfOk) {
-            // 物理约束检查
-            if (Lwf >= config.Hres) {
-                // 动液面深度大于等于油层深度，物理上不合理，无法计算有效液柱
-                model->setItem(i, newColIdx, new QStandardItem("Error: Lwf >= Hres"));
-                errorCount++;
-            } else {
-                // 公式：Pwf = Pc + (Hres - Lwf) * gamma_mix / 100
-                // 注：除以100是将 g/cm³ * m 转换为 MPa (近似工程单位换算)
-                double Pwf = Pc + (config.Hres - Lwf) * gamma_mix / 100.0;
-                // 使用用户指定的小数位数进行格式化
-                model->setItem(i, newColIdx, new QStandardItem(QString::number(Pwf, 'f', config.decimalPlaces)));
-            }
-        } else {
-            model->setItem(i, newColIdx, new QStandardItem(""));
-        }
+    const ColumnarTableModel::ColumnSpan pc = model->columnSpan(config.pcColumnIndex);
+    const ColumnarTableModel::ColumnSpan lwf = model->columnSpan(config.lwfColumnIndex);
+    const ColumnarTableModel::ColumnSpan pwf = model->columnSpan(newColIdx);
+    QVector<int> errorRows;
+    for (int i = 0; i < pwf.size && i < pc.size && i < lwf.size; ++i) {
+        if (std::isnan(pwf[i]) && !std::isnan(pc[i]) && !std::isnan(lwf[i])) errorRows.append(i);
     }
+    model->beginUpdate();
+    for (int row : errorRows) {
+        model->setText(row, newColIdx, "Error: Lwf >= Hres");
+        errorCount++;
+    }
+    model->endUpdate();
 
     if (errorCount > 0) {
         result.errorMessage = QString("计算完成，但有 %1 行数据因动液面深度大于油层深度而无法计算。").arg(errorCount);
@@ -510,6 +582,116 @@ PwfCalculationResult DataCalculate::calculateBottomHolePressure(QStandardItemMod
     return result;
 }
 
+// 表达式列：先编译 (只引用已有列)，并行求值后整列写入新列
+ExpressionColumnResult DataCalculate::calculateExpressionColumn(ColumnarTableModel* model,
+                                                                QList<ColumnDefinition>& definitions,
+                                                                const ExpressionColumnConfig& config)
+{
+    ExpressionColumnResult result;
+    if (!model || model->rowCount() == 0) {
+        result.errorMessage = "数据表为空。";
+        return result;
+    }
+
+    QStringList headers;
+    for (int i = 0; i < model->columnCount(); ++i) headers << model->headerData(i, Qt::Horizontal).toString();
+
+    ColumnExpression expression;
+    QString error;
+    if (!expression.compile(config.expression, headers, config.variables, &error)) {
+        result.errorMessage = "表达式错误: " + error;
+        return result;
+    }
+    QVector<double> values = expression.evaluate(model);
+
+    int newColIdx = model->columnCount();
+    model->insertColumn(newColIdx);
+
+    ColumnDefinition newDef;
+    newDef.name = config.unit.isEmpty() ? config.columnName : config.columnName + "\\" + config.unit;
+    newDef.type = config.type;
+    newDef.unit = config.unit;
+    newDef.decimalPlaces = config.decimalPlaces;
+    definitions.append(newDef);
+    model->setHeaderData(newColIdx, Qt::Horizontal, newDef.name);
+
+    for (double v : values) {
+        if (std::isfinite(v)) result.processedRows++;
+    }
+    model->setColumnValues(newColIdx, values, config.decimalPlaces);
+
+    result.success = true;
+    result.addedColumnIndex = newColIdx;
+    result.columnName = newDef.name;
+    return result;
+}
+
+// 各行的时间戳 (秒，无法解析为 NaN)。dateColumn < 0 时只解析时刻列 (当天秒数)；
+// 日期列与时刻列相同时按 "日期 时刻" 解析同一单元格。格式由前若干个非空单元格识别一次，
+// 各段行并行解析；与识别格式不符的单元格回退到逐格式尝试的 parseDateString / parseTimeString
+QVector<double> DataCalculate::parseTimestamps(const ColumnarTableModel* model, int dateColumn, int timeColumn) const
+{
+    const int rowCount = model->rowCount();
+    const bool combined = dateColumn >= 0 && dateColumn == timeColumn;
+
+    auto sampleColumn = [&](int column) {
+        QStringList samples;
+        for (int i = 0; i < rowCount && samples.size() < 64; ++i) {
+            const QString text = model->text(i, column);
+            if (!text.isEmpty()) samples.append(text);
+        }
+        return samples;
+    };
+    TimestampParser dateParser;
+    TimestampParser timeParser;
+    if (combined) {
+        dateParser = TimestampParser::detect(sampleColumn(dateColumn), TimestampParser::DateTime);
+    } else {
+        if (dateColumn >= 0) dateParser = TimestampParser::detect(sampleColumn(dateColumn), TimestampParser::Date);
+        timeParser = TimestampParser::detect(sampleColumn(timeColumn), TimestampParser::Time);
+    }
+
+    auto parseTime = [&](const QString& text, double* sec) {
+        if (timeParser.parse(text, sec)) return true;
+        const QTime t = parseTimeString(text);
+        if (!t.isValid()) return false;
+        *sec = t.msecsSinceStartOfDay() / 1000.0;
+        return true;
+    };
+    auto parseDate = [&](const QString& text, double* sec) {
+        if (dateParser.parse(text, sec)) return true;
+        const QDate d = parseDateString(text);
+        if (!d.isValid()) return false;
+        *sec = TimestampParser::daysFromCivil(d.year(), d.month(), d.day()) * 86400.0;
+        return true;
+    };
+
+    QVector<double> seconds(rowCount, std::numeric_limits<double>::quiet_NaN());
+    double* out = seconds.data();
+    const int chunkRows = 16384;
+    QVector<int> chunks;
+    for (int first = 0; first < rowCount; first += chunkRows) chunks.append(first);
+
+    QtConcurrent::blockingMap(chunks, [&](int first) {
+        const int last = qMin(rowCount, first + chunkRows);
+        for (int i = first; i < last; ++i) {
+            double sec = 0.0;
+            if (combined) {
+                if (!dateParser.parse(model->text(i, dateColumn), &sec)) continue;
+            } else {
+                if (!parseTime(model->text(i, timeColumn), &sec)) continue;
+                if (dateColumn >= 0) {
+                    double day = 0.0;
+                    if (!parseDate(model->text(i, dateColumn), &day)) continue;
+                    sec += day;
+                }
+            }
+            out[i] = sec;
+        }
+    });
+    return seconds;
+}
+
 // 辅助函数实现
 QTime DataCalculate::parseTimeString(const QString& timeStr) const {
     QStringList fmts = {"hh:mm:ss", "h:mm:ss", "hh:mm"};
@@ -539,7 +721,7 @@ double DataCalculate::convertTimeToUnit(double seconds, const QString& unit) con
     return seconds;
 }
 
-int DataCalculate::findPressureColumn(QStandardItemModel* model, const QList<ColumnDefinition>& definitions) const {
+int DataCalculate::findPressureColumn(ColumnarTableModel* model, const QList<ColumnDefinition>& definitions) const {
     for(int i=0; i<definitions.size(); ++i) {
         if(definitions[i].type == WellTestColumnType::Pressure) return i;
     }
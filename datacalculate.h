@@ -5,7 +5,10 @@
  * 1. 包含时间转换的配置对话框类 TimeConversionDialog。
  * 2. 包含井底流压计算配置对话框类 PwfCalculationDialog (新增)。
  * 3. 提供 DataCalculate 类，用于执行时间格式转换、压降计算和井底流压计算逻辑。
- * 4. 所有的计算操作都直接修改传入的 QStandardItemModel。
+ * 4. 所有的计算操作都直接修改传入的数据模型 (ColumnarTableModel)，新列按数值写入，整体只通知一次视图刷新。
+ * 5. [快速时间转换] 时间列按一次识别的格式并行解析，详见 TimestampParser。
+ * 6. [表达式列] ExpressionColumnDialog 与 calculateExpressionColumn 按列表达式 (ColumnExpression) 生成派生列；
+ *    压降与井底流压计算改为该引擎的预设表达式。
  */
 
 #ifndef DATACALCULATE_H
@@ -13,14 +16,15 @@
 
 #include <QObject>
 #include <QDialog>
-#include <QStandardItemModel>
 #include <QRadioButton>
 #include <QComboBox>
 #include <QLineEdit>
 #include <QLabel>
 #include <QDoubleSpinBox>
 #include <QSpinBox>
+#include <QMap>
 #include "wt_datawidget.h" // 获取相关结构体定义
+#include "columnartablemodel.h"
 
 // 时间转换配置结构体
 struct TimeConversionConfig {
@@ -68,6 +72,25 @@ struct PwfCalculationResult {
     int addedColumnIndex;
 };
 
+// 表达式列配置结构体
+struct ExpressionColumnConfig {
+    QString expression;                 // 列表达式，语法见 ColumnExpression
+    QString columnName;                 // 新列名称 (不含单位)
+    QString unit;                       // 新列单位 (可为空)
+    WellTestColumnType type = WellTestColumnType::Custom;
+    int decimalPlaces = 3;
+    QMap<QString, double> variables;    // 表达式中可用的命名常量
+};
+
+// 表达式列结果结构体
+struct ExpressionColumnResult {
+    bool success = false;
+    QString errorMessage;
+    int addedColumnIndex = -1;
+    QString columnName;
+    int processedRows = 0;
+};
+
 // ============================================================================
 // 时间转换设置对话框类
 // ============================================================================
@@ -120,6 +143,33 @@ private:
     QSpinBox* m_spinDecimal;       // 小数位数选择 (新增)
 };
 
+// ============================================================================
+// 表达式列设置对话框类
+// ============================================================================
+class ExpressionColumnDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit ExpressionColumnDialog(const QStringList& columnNames, QWidget* parent = nullptr);
+    ExpressionColumnConfig getConfig() const;
+
+protected:
+    // 确定前编译一次表达式，有错误时提示且不关闭
+    void accept() override;
+
+private slots:
+    void onPresetChanged(int index);
+
+private:
+    QStringList m_columnNames;
+    QComboBox* m_comboPreset;
+    QLineEdit* m_editExpression;
+    QLineEdit* m_editName;
+    QLineEdit* m_editUnit;
+    QSpinBox* m_spinDecimal;
+    QLabel* m_labelError;
+};
+
 // ============================================================================
 // 数据计算逻辑处理类
 // ============================================================================
@@ -130,28 +180,35 @@ public:
     explicit DataCalculate(QObject* parent = nullptr);
 
     // 执行时间转换逻辑
-    TimeConversionResult convertTimeColumn(QStandardItemModel* model,
+    TimeConversionResult convertTimeColumn(ColumnarTableModel* model,
                                            QList<ColumnDefinition>& definitions,
                                            const TimeConversionConfig& config);
 
     // 执行压降计算逻辑
-    PressureDropResult calculatePressureDrop(QStandardItemModel* model,
+    PressureDropResult calculatePressureDrop(ColumnarTableModel* model,
                                              QList<ColumnDefinition>& definitions);
 
     // 执行井底流压计算逻辑
-    PwfCalculationResult calculateBottomHolePressure(QStandardItemModel* model,
+    PwfCalculationResult calculateBottomHolePressure(ColumnarTableModel* model,
                                                      QList<ColumnDefinition>& definitions,
                                                      const PwfCalculationConfig& config);
 
+    // 按列表达式在末尾生成新列 (表达式在插入新列前编译，列引用只针对已有列)
+    ExpressionColumnResult calculateExpressionColumn(ColumnarTableModel* model,
+                                                     QList<ColumnDefinition>& definitions,
+                                                     const ExpressionColumnConfig& config);
+
 private:
     // 辅助函数：时间解析
     QTime parseTimeString(const QString& timeStr) const;
     QDate parseDateString(const QString& dateStr) const;
     QDateTime combineDateAndTime(const QDate& date, const QTime& time) const;
+    // 并行解析各行时间戳为秒数 (无法解析为 NaN)
+    QVector<double> parseTimestamps(const ColumnarTableModel* model, int dateColumn, int timeColumn) const;
     double convertTimeToUnit(double seconds, const QString& unit) const;
 
     // 辅助函数：查找压力列
-    int findPressureColumn(QStandardItemModel* model, const QList<ColumnDefinition>& definitions) const;
+    int findPressureColumn(ColumnarTableModel* model, const QList<ColumnDefinition>& definitions) const;
 };
 
 #endif // DATACALCULATE_H
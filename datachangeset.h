@@ -0,0 +1,43 @@
+/*
+ * datachangeset.h
+ * 文件作用: 数据表变更集定义
+ * 功能描述:
+ * 1. DataChangeSet 汇总一个事件循环周期内数据表的全部修改：内容修改的行范围与列集合，以及是否有结构变化
+ *    (行列插入删除、整表复位、表头或列定义修改)。
+ * 2. DataSingleSheet 每个周期只发出一次变更集，粘贴、分列、时间转换等批量操作不再逐格通知下游；
+ *    下游据 touchesColumn 只刷新依赖于变化列的内容。
+ */
+
+#ifndef DATACHANGESET_H
+#define DATACHANGESET_H
+
+#include <QVector>
+#include <algorithm>
+
+struct DataChangeSet {
+    quint64 version = 0;     // 本表的变更序号 (每次通知递增)
+    int firstRow = -1;       // 内容修改的行范围 (含两端)，无内容修改时为 -1
+    int lastRow = -1;
+    QVector<int> columns;    // 内容修改的列 (升序，不重复)
+    bool structural = false; // 结构变化：下游应视为所有列都已改变
+
+    bool isEmpty() const { return !structural && columns.isEmpty(); }
+
+    bool touchesColumn(int column) const
+    {
+        return structural || std::binary_search(columns.constBegin(), columns.constEnd(), column);
+    }
+
+    void addCells(int top, int left, int bottom, int right)
+    {
+        if (top < 0 || left < 0 || bottom < top || right < left) return;
+        firstRow = firstRow < 0 ? top : qMin(firstRow, top);
+        lastRow = qMax(lastRow, bottom);
+        for (int column = left; column <= right; ++column) {
+            auto it = std::lower_bound(columns.begin(), columns.end(), column);
+            if (it == columns.end() || *it != column) columns.insert(it, column);
+        }
+    }
+};
+
+#endif // DATACHANGESET_H
@@ -0,0 +1,244 @@
+/*
+ * 文件名: dataexportservice.cpp
+ * 文件作用: 表格数据导出服务实现文件
+ * 功能描述:
+ * 1. 文本格式逐行把字段追加到同一个字节缓冲区，累计约 64 KB 写入一次；文本字段含分隔符、引号或换行时按 CSV 规则加引号。
+ * 2. 每行检查一次取消令牌；取消后文本格式放弃 QSaveFile 的临时文件，XLSX 删除已写出的部分。
+ */
+
+#include "dataexportservice.h"
+#include "xlsxstream.h"
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtConcurrent>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+const int kFlushBytes = 64 * 1024;
+
+// 文本字段 (CSV 含逗号、引号或换行时加引号；TXT 中的制表符与换行替换为空格)
+void appendTextField(QByteArray& out, const QString& text, char separator)
+{
+    QByteArray bytes = text.toUtf8();
+    if (separator == '\t') {
+        bytes.replace('\t', ' ').replace('\n', ' ').replace('\r', ' ');
+        out += bytes;
+    } else if (bytes.contains(',') || bytes.contains('"') || bytes.contains('\n') || bytes.contains('\r')) {
+        out += '"';
+        out += bytes.replace("\"", "\"\"");
+        out += '"';
+    } else {
+        out += bytes;
+    }
+}
+
+bool writeXlsx(const QString& path, const ExportTable& table, const CancellationToken* token,
+               QAtomicInteger<int>* progress, QString* errorMessage)
+{
+    XlsxStreamWriter writer(path);
+    if (!writer.open()) {
+        if (errorMessage) *errorMessage = "无法创建文件，请检查文件是否被占用。";
+        return false;
+    }
+    if (table.writeHeader) {
+        writer.beginRow();
+        for (const ExportColumn& column : table.columns) writer.addHeader(column.header);
+        writer.endRow();
+    }
+
+    const int rows = table.size();
+    for (int i = 0; i < rows; ++i) {
+        if (token && token->isCancelled()) break;
+        const int r = table.rowAt(i);
+        writer.beginRow();
+        for (const ExportColumn& column : table.columns) {
+            if (!column.texts.isEmpty()) {
+                if (r < column.texts.size()) writer.addText(column.texts[r]);
+                else writer.addBlank();
+            } else if (r < column.values.size()) {
+                writer.addNumber(column.values[r] - column.offset);
+            } else {
+                writer.addBlank();
+            }
+        }
+        writer.endRow();
+        if (progress) progress->storeRelaxed(i + 1);
+    }
+
+    const bool ok = writer.close();
+    if (token && token->isCancelled()) {
+        QFile::remove(path);
+        return false;
+    }
+    if (!ok) {
+        QFile::remove(path);
+        if (errorMessage) *errorMessage = "写入 xlsx 文件失败，请检查文件是否被占用。";
+    }
+    return ok;
+}
+
+bool writeText(const QString& path, const ExportTable& table, char separator, const CancellationToken* token,
+               QAtomicInteger<int>* progress, QString* errorMessage)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (errorMessage) *errorMessage = "无法打开文件进行写入：" + file.errorString();
+        return false;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(kFlushBytes + 4096);
+    buffer += "\xEF\xBB\xBF"; // UTF-8 BOM (Excel 打开 CSV 时中文表头不乱码)
+    if (table.writeHeader) {
+        for (int c = 0; c < table.columns.size(); ++c) {
+            if (c > 0) buffer += separator;
+            appendTextField(buffer, table.columns[c].header, separator);
+        }
+        buffer += '\n';
+    }
+
+    bool ok = true;
+    const int rows = table.size();
+    for (int i = 0; i < rows && ok; ++i) {
+        if (token && token->isCancelled()) break;
+        const int r = table.rowAt(i);
+        for (int c = 0; c < table.columns.size(); ++c) {
+            if (c > 0) buffer += separator;
+            const ExportColumn& column = table.columns[c];
+            if (!column.texts.isEmpty()) {
+                if (r < column.texts.size()) appendTextField(buffer, column.texts[r], separator);
+            } else if (r < column.values.size()) {
+                DataExportService::appendNumber(buffer, column.values[r] - column.offset, column.precision);
+            }
+        }
+        buffer += '\n';
+        if (buffer.size() >= kFlushBytes) {
+            ok = file.write(buffer) == buffer.size();
+            buffer.resize(0);
+        }
+        if (progress) progress->storeRelaxed(i + 1);
+    }
+    if (ok && !buffer.isEmpty()) ok = file.write(buffer) == buffer.size();
+
+    if (token && token->isCancelled()) {
+        file.cancelWriting();
+        return false;
+    }
+    if (!ok || !file.commit()) {
+        if (errorMessage) *errorMessage = "写入文件失败：" + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ExportColumn ExportColumn::numbers(const QString& header, const QVector<double>& values, int precision, double offset)
+{
+    ExportColumn column;
+    column.header = header;
+    column.values = values;
+    column.precision = precision;
+    column.offset = offset;
+    return column;
+}
+
+ExportColumn ExportColumn::text(const QString& header, const QStringList& texts)
+{
+    ExportColumn column;
+    column.header = header;
+    column.texts = texts;
+    return column;
+}
+
+int ExportTable::size() const
+{
+    if (!rows.isEmpty()) return rows.size();
+    if (rowCount >= 0) return rowCount;
+    int longest = 0;
+    for (const ExportColumn& column : columns)
+        longest = qMax(longest, column.texts.isEmpty() ? int(column.values.size()) : int(column.texts.size()));
+    return qMax(0, longest - firstRow);
+}
+
+DataExportService::Format DataExportService::formatOf(const QString& path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "xlsx") return Xlsx;
+    if (suffix == "txt") return Txt;
+    return Csv;
+}
+
+void DataExportService::appendNumber(QByteArray& out, double value, int precision)
+{
+    if (!std::isfinite(value)) return;
+    char digits[32];
+    const std::to_chars_result result = precision > 0
+        ? std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, qMin(precision, 17))
+        : std::to_chars(digits, digits + sizeof(digits), value);
+    if (result.ec == std::errc()) out.append(digits, int(result.ptr - digits));
+}
+
+bool DataExportService::write(const QString& path, const ExportTable& table, const CancellationToken* token,
+                              QAtomicInteger<int>* progress, QString* errorMessage)
+{
+    switch (formatOf(path)) {
+    case Xlsx: return writeXlsx(path, table, token, progress, errorMessage);
+    case Txt: return writeText(path, table, '\t', token, progress, errorMessage);
+    case Csv: break;
+    }
+    return writeText(path, table, ',', token, progress, errorMessage);
+}
+
+void DataExportService::applyProgressStyle(QWidget* dialog)
+{
+    dialog->setStyleSheet("QWidget { color: black; background-color: white; font-family: 'Microsoft YaHei'; }"
+                          "QPushButton { background-color: #f0f0f0; color: black; border: 1px solid #bfbfbf; "
+                          "border-radius: 3px; padding: 5px 15px; min-width: 70px; }"
+                          "QPushButton:hover { background-color: #e0e0e0; }"
+                          "QPushButton:pressed { background-color: #d0d0d0; }"
+                          "QLabel { color: black; }");
+}
+
+DataExportService::Result DataExportService::exportWithProgress(QWidget* parent, const QString& path,
+                                                                const ExportTable& table, QString* errorMessage)
+{
+    QAtomicInteger<int> rowsWritten(0);
+    CancellationToken cancel;
+    QString error;
+    // table 与 path 在事件循环结束前一直有效，按引用交给后台线程
+    QFuture<bool> future = QtConcurrent::run([&]() {
+        return write(path, table, &cancel, &rowsWritten, &error);
+    });
+
+    const int rows = table.size();
+    QProgressDialog progress("正在导出数据...", "取消", 0, qMax(rows, 1), parent);
+    progress.setWindowTitle("导出");
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    applyProgressStyle(&progress);
+    QObject::connect(&progress, &QProgressDialog::canceled, &progress, [&cancel]() { cancel.cancel(); });
+
+    QEventLoop loop;
+    QFutureWatcher<bool> watcher;
+    QObject::connect(&watcher, &QFutureWatcher<bool>::finished, &loop, &QEventLoop::quit);
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, &progress, [&]() { progress.setValue(rowsWritten.loadRelaxed()); });
+    timer.start(100);
+    watcher.setFuture(future);
+    if (!future.isFinished()) loop.exec();
+    timer.stop();
+    progress.reset();
+
+    if (future.result()) return Succeeded;
+    if (cancel.isCancelled()) return Cancelled;
+    if (errorMessage) *errorMessage = error;
+    return Failed;
+}
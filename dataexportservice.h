@@ -0,0 +1,83 @@
+/*
+ * 文件名: dataexportservice.h
+ * 文件作用: 表格数据导出服务头文件
+ * 功能描述:
+ * 1. 图表数据、拟合曲线、拟合参数与报告数据表共用的导出：ExportTable 以列的形式引用 (隐式共享) 原始数组，
+ *    不在内存中组装字符串表；按行号范围或行号列表逐行取数写出。
+ * 2. CSV (逗号分隔) / TXT (制表符分隔) 带 UTF-8 BOM，数值经 std::to_chars 直接格式化到字节缓冲区
+ *    (约 64 KB 写一次，经 QSaveFile 写完后才替换目标文件)；XLSX 经 XlsxStreamWriter 流式写出。
+ * 3. exportWithProgress 在后台线程写出，期间显示可取消的进度框 (窗口模态，界面继续刷新)；
+ *    取消或失败时不留下不完整的文件。
+ * 4. applyProgressStyle 供其他后台任务 (如报告生成) 的进度框使用相同样式。
+ */
+
+#ifndef DATAEXPORTSERVICE_H
+#define DATAEXPORTSERVICE_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "cancellationtoken.h"
+
+class QWidget;
+
+// 导出表的一列：数值列或文本列 (texts 非空时为文本列)
+struct ExportColumn {
+    QString header;
+    QVector<double> values;
+    QStringList texts;
+    double offset = 0.0;   // 写出 values[i] - offset (部分导出的相对时间与原始时间共用同一数组)
+    int precision = 0;     // 有效数字位数；0 为可精确还原的最短表示
+
+    static ExportColumn numbers(const QString& header, const QVector<double>& values, int precision = 0, double offset = 0.0);
+    static ExportColumn text(const QString& header, const QStringList& texts);
+};
+
+// 导出表：rows 非空时只写出其中的行号，否则写出 [firstRow, firstRow + rowCount) (rowCount < 0 为到最长列末尾)；
+// 超出某列长度的单元格与非有限数值留空
+struct ExportTable {
+    QList<ExportColumn> columns;
+    int firstRow = 0;
+    int rowCount = -1;
+    QVector<int> rows;
+    bool writeHeader = true;
+
+    // 数据行数 (不含表头)
+    int size() const;
+    // 第 i 个数据行对应的行号
+    int rowAt(int i) const { return rows.isEmpty() ? firstRow + i : rows[i]; }
+};
+
+class DataExportService
+{
+public:
+    enum Format { Csv, Txt, Xlsx };
+    enum Result { Succeeded, Cancelled, Failed };
+
+    // 按扩展名判断格式 (.xlsx / .txt，其余为 CSV)
+    static Format formatOf(const QString& path);
+
+    /**
+     * @brief 写出表格 (可在任意线程调用)
+     * @param token 取消令牌 (可为空)；取消时返回 false 且不留下文件
+     * @param progress 输出：已写出的数据行数 (可为空)
+     * @param errorMessage 输出：失败原因
+     */
+    static bool write(const QString& path, const ExportTable& table, const CancellationToken* token = nullptr,
+                      QAtomicInteger<int>* progress = nullptr, QString* errorMessage = nullptr);
+
+    // 在后台线程写出并显示进度框 (数据量小时进度框不出现)
+    static Result exportWithProgress(QWidget* parent, const QString& path, const ExportTable& table,
+                                     QString* errorMessage = nullptr);
+
+    // 把数值的文本追加到 out (precision 含义同 ExportColumn::precision；非有限值不追加)
+    static void appendNumber(QByteArray& out, double value, int precision = 0);
+
+    // 进度框样式 (与数据表界面的对话框一致)
+    static void applyProgressStyle(QWidget* dialog);
+};
+
+#endif // DATAEXPORTSERVICE_H
@@ -2,13 +2,17 @@
  * 文件名: dataimportdialog.cpp
  * 文件作用: 数据导入配置对话框实现文件
  * 功能描述:
- * 1. 实现了基于 QTextCodec 的文本文件预览。
- * 2. 实现了基于 QXlsx 的 .xlsx 文件预览。
- * 3. 实现了基于 QAxObject 的 .xls 文件预览。
+ * 1. 文本文件预览由 TextTableReader 解析文件开头的样本，与实际导入的解析规则相同。
+ * 2. .xlsx 文件 (以及实为 OOXML 的 .xls) 预览由 XlsxStreamReader 只读取前若干行。
+ * 3. 实现了基于 QAxObject 的 .xls 文件预览 (一次读取 UsedRange 的前若干行，不再逐格调用)。
+ * 4. [有界预览] 样本 (文本 256 KB、表格 2000 行) 在后台线程读取并识别编码与分隔符，界面只显示前 50 行；
+ *    样本即整个文件时，确认导入时若配置与最近一次预览相同，则把预览的解析结果交给导入。
  */
 
 #include "dataimportdialog.h"
 #include "ui_dataimportdialog.h"
+#include "texttablereader.h"
+#include "xlsxstream.h"
 #include <QFile>
 #include <QDebug>
 #include <QMessageBox>
@@ -16,17 +20,30 @@
 #include <QAxObject>
 #include <QDir>
 #include <QDateTime>
+#include <QtConcurrent>
+#include <cmath>
 
-// 引入 QXlsx 头文件
-#include "xlsxdocument.h"
-#include "xlsxcellrange.h"
+namespace {
+
+const qint64 kSampleBytes = 256 * 1024; // 文本样本上限
+const int kSampleRows = 2000;           // 表格样本行数上限
+const int kPreviewRows = 50;            // 预览表格显示的行数
+
+bool sameFormat(const DataImportSettings& a, const DataImportSettings& b)
+{
+    return a.encoding == b.encoding && a.separator == b.separator && a.startRow == b.startRow &&
+           a.useHeader == b.useHeader && a.headerRow == b.headerRow;
+}
+
+} // namespace
 
 DataImportDialog::DataImportDialog(const QString& filePath, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::DataImportDialog),
     m_filePath(filePath),
     m_isInitializing(true),
-    m_isExcelFile(false)
+    m_isExcelFile(false),
+    m_formatChosen(false)
 {
     ui->setupUi(this);
     this->setWindowTitle("数据导入配置");
@@ -37,14 +54,18 @@ DataImportDialog::DataImportDialog(const QString& filePath, QWidget *parent) :
     m_previewTimer->setInterval(200);
     connect(m_previewTimer, &QTimer::timeout, this, &DataImportDialog::doUpdatePreview);
 
+    m_sampleWatcher = new QFutureWatcher<Sample>(this);
+    connect(m_sampleWatcher, &QFutureWatcher<Sample>::finished, this, &DataImportDialog::onSampleLoaded);
+
     initUI();
     loadDataForPreview();
 
     m_isInitializing = false;
-    doUpdatePreview();
 
     connect(ui->comboEncoding, SIGNAL(currentIndexChanged(int)), this, SLOT(onSettingChanged()));
     connect(ui->comboSeparator, SIGNAL(currentIndexChanged(int)), this, SLOT(onSettingChanged()));
+    connect(ui->comboEncoding, &QComboBox::activated, this, [this]() { m_formatChosen = true; });
+    connect(ui->comboSeparator, &QComboBox::activated, this, [this]() { m_formatChosen = true; });
     connect(ui->spinStartRow, SIGNAL(valueChanged(int)), this, SLOT(onSettingChanged()));
     connect(ui->spinHeaderRow, SIGNAL(valueChanged(int)), this, SLOT(onSettingChanged()));
     connect(ui->checkUseHeader, &QCheckBox::toggled, [=](bool checked){
@@ -82,75 +103,70 @@ void DataImportDialog::initUI()
 
 void DataImportDialog::loadDataForPreview()
 {
-    if (m_filePath.endsWith(".xls", Qt::CaseInsensitive) ||
-        m_filePath.endsWith(".xlsx", Qt::CaseInsensitive)) {
-        m_isExcelFile = true;
-        readExcelForPreview();
+    m_isExcelFile = m_filePath.endsWith(".xls", Qt::CaseInsensitive) ||
+                    m_filePath.endsWith(".xlsx", Qt::CaseInsensitive);
+    if (m_isExcelFile) {
         ui->comboEncoding->setEnabled(false);
         ui->comboSeparator->setEnabled(false);
-        return;
-    }
 
-    QFile file(m_filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        QMessageBox::warning(this, "错误", "无法打开文件进行预览。");
-        return;
+        // 真正的 .xls (BIFF) 只能经 COM 自动化读取，须在界面线程完成
+        if (!m_filePath.endsWith(".xlsx", Qt::CaseInsensitive) && !XlsxStreamReader::isWorkbookFile(m_filePath)) {
+            readExcelForPreview();
+            doUpdatePreview();
+            return;
+        }
     }
 
-    m_previewLines.clear();
-    int count = 0;
-    while (!file.atEnd() && count < 50) {
-        m_previewLines.append(file.readLine());
-        count++;
-    }
-    file.close();
+    m_sampleWatcher->setFuture(QtConcurrent::run(&DataImportDialog::loadSample, m_filePath, m_isExcelFile));
 }
 
-void DataImportDialog::readExcelForPreview()
+DataImportDialog::Sample DataImportDialog::loadSample(const QString& filePath, bool excel)
 {
-    m_excelPreviewData.clear();
-
-    // 分支 1: 使用 QXlsx 读取 .xlsx 文件
-    if (m_filePath.endsWith(".xlsx", Qt::CaseInsensitive)) {
-        QXlsx::Document xlsx(m_filePath);
-        if (!xlsx.load()) {
-            QMessageBox::warning(this, "警告", "无法加载 .xlsx 文件。");
-            return;
+    Sample sample;
+    if (excel) {
+        if (!XlsxStreamReader::readRows(filePath, kSampleRows, sample.rows, &sample.complete, &sample.error)) {
+            sample.rows.clear();
+            sample.complete = false;
         }
+        return sample;
+    }
 
-        if (xlsx.currentWorksheet() == nullptr) {
-            QStringList sheets = xlsx.sheetNames();
-            if (!sheets.isEmpty()) xlsx.selectSheet(sheets.first());
-        }
+    if (!TextTableReader::readHead(filePath, kSampleBytes, sample.bytes, &sample.complete)) {
+        sample.error = "无法打开文件进行预览。";
+        return sample;
+    }
+    sample.encoding = TextTableReader::detectEncoding(sample.bytes);
+    sample.separator = TextTableReader::detectSeparator(sample.bytes);
+    return sample;
+}
 
-        QXlsx::CellRange dim = xlsx.dimension();
-        int maxRow = dim.lastRow();
-        int maxCol = dim.lastColumn();
-
-        int readRowCount = (maxRow > 50) ? 50 : maxRow;
-        int readColCount = (maxCol > 20) ? 20 : maxCol;
-
-        for (int r = 1; r <= readRowCount; ++r) {
-            QStringList rowData;
-            for (int c = 1; c <= readColCount; ++c) {
-                std::shared_ptr<QXlsx::Cell> cell = xlsx.cellAt(r, c);
-                if (cell) {
-                    // [修复] 先 readValue 再 toDateTime
-                    if (cell->isDateTime()) {
-                        rowData.append(cell->readValue().toDateTime().toString("yyyy-MM-dd hh:mm:ss"));
-                    } else {
-                        rowData.append(cell->value().toString());
-                    }
-                } else {
-                    rowData.append("");
-                }
-            }
-            m_excelPreviewData.append(rowData);
+void DataImportDialog::onSampleLoaded()
+{
+    m_sample = m_sampleWatcher->result();
+    if (!m_sample.error.isEmpty()) QMessageBox::warning(this, "警告", m_sample.error);
+
+    if (!m_isExcelFile && !m_formatChosen) {
+        m_isInitializing = true;
+        const int encodingIndex = ui->comboEncoding->findText(m_sample.encoding);
+        if (encodingIndex >= 0) ui->comboEncoding->setCurrentIndex(encodingIndex);
+        switch (m_sample.separator) {
+        case ',': ui->comboSeparator->setCurrentIndex(1); break;
+        case '\t': ui->comboSeparator->setCurrentIndex(2); break;
+        case ' ': ui->comboSeparator->setCurrentIndex(3); break;
+        case ';': ui->comboSeparator->setCurrentIndex(4); break;
+        default: break; // 未识别时保持自动识别
         }
-        return;
+        m_isInitializing = false;
     }
 
-    // 分支 2: 使用 QAxObject 读取 .xls 文件
+    m_previewTimer->stop();
+    doUpdatePreview();
+}
+
+void DataImportDialog::readExcelForPreview()
+{
+    m_sample = Sample();
+
     QAxObject excel("Excel.Application");
     if (excel.isNull()) {
         QMessageBox::warning(this, "警告", "未检测到 Excel 程序，无法预览 .xls 文件。");
@@ -172,27 +188,28 @@ void DataImportDialog::readExcelForPreview()
         QAxObject *usedRange = sheet->querySubObject("UsedRange");
         if (usedRange) {
             QAxObject *rows = usedRange->querySubObject("Rows");
-            int rowCount = rows->property("Count").toInt();
-            int readCount = (rowCount > 50) ? 50 : rowCount;
-
             QAxObject *columns = usedRange->querySubObject("Columns");
-            int colCount = columns->property("Count").toInt();
-            if (colCount > 20) colCount = 20;
-
-            for (int r = 1; r <= readCount; ++r) {
-                QStringList rowData;
-                for (int c = 1; c <= colCount; ++c) {
-                    QAxObject *cell = sheet->querySubObject("Cells(int,int)", r, c);
-                    if (cell) {
-                        rowData.append(cell->property("Value").toString());
-                        delete cell;
-                    } else {
-                        rowData.append("");
+            const int rowCount = rows->property("Count").toInt();
+            const int colCount = columns->property("Count").toInt();
+            const int readCount = qMin(rowCount, kSampleRows);
+
+            // 一次读取 UsedRange 的前若干行 (与导入时读取 UsedRange 的取值规则相同)
+            QAxObject *head = usedRange->querySubObject("Resize(int,int)", readCount, colCount);
+            const QVariant value = head ? head->dynamicCall("Value()") : QVariant();
+            if (value.typeId() == QMetaType::QVariantList) {
+                for (const QVariant& r : value.toList()) {
+                    if (r.typeId() != QMetaType::QVariantList) continue;
+                    QStringList rowData;
+                    for (const QVariant& c : r.toList()) {
+                        if (c.typeId() == QMetaType::QDateTime) rowData.append(c.toDateTime().toString("yyyy-MM-dd hh:mm:ss"));
+                        else if (c.typeId() == QMetaType::QDate) rowData.append(c.toDate().toString("yyyy-MM-dd"));
+                        else rowData.append(c.toString());
                     }
+                    m_sample.rows.append(rowData);
                 }
-                m_excelPreviewData.append(rowData);
             }
-            delete columns; delete rows; delete usedRange;
+            m_sample.complete = (readCount == rowCount && m_sample.rows.size() == rowCount);
+            delete head; delete columns; delete rows; delete usedRange;
         }
         delete sheet;
     }
@@ -207,101 +224,71 @@ void DataImportDialog::onSettingChanged()
 
 void DataImportDialog::doUpdatePreview()
 {
-    ui->tablePreview->clear();
+    const DataImportSettings settings = currentSettings();
+    auto preview = QSharedPointer<DataImportPreview>::create();
 
     if (m_isExcelFile) {
-        if (m_excelPreviewData.isEmpty()) {
-            ui->tablePreview->setRowCount(0); ui->tablePreview->setColumnCount(0); return;
+        // 与 XlsxStreamReader::read 相同的归类：表头行、起始行之后的数据行
+        ColumnarTableModel::RowBlock block;
+        for (int i = 0; i < m_sample.rows.size(); ++i) {
+            const int row = i + 1;
+            if (settings.useHeader && row == settings.headerRow) preview->header = m_sample.rows[i];
+            else if (row >= settings.startRow) block.appendRow(m_sample.rows[i]);
         }
-        int startRow = ui->spinStartRow->value() - 1;
-        int headerRow = ui->spinHeaderRow->value() - 1;
-        bool useHeader = ui->checkUseHeader->isChecked();
-
-        QStringList headers;
-        QList<QStringList> dataRows;
-
-        for (int i = 0; i < m_excelPreviewData.size(); ++i) {
-            if (i < startRow && !(useHeader && i == headerRow)) continue;
-            if (useHeader && i == headerRow) headers = m_excelPreviewData[i];
-            else if (i >= startRow) dataRows.append(m_excelPreviewData[i]);
-        }
-
-        int colCount = 0;
-        if (!headers.isEmpty()) colCount = headers.size();
-        else if (!dataRows.isEmpty()) colCount = dataRows.first().size();
-
-        ui->tablePreview->setColumnCount(colCount);
-        if (!headers.isEmpty()) ui->tablePreview->setHorizontalHeaderLabels(headers);
-        else {
-            QStringList defHeaders; for(int i=0; i<colCount; i++) defHeaders << QString("Col %1").arg(i+1);
-            ui->tablePreview->setHorizontalHeaderLabels(defHeaders);
-        }
-
-        ui->tablePreview->setRowCount(dataRows.size());
-        for(int r=0; r<dataRows.size(); ++r) {
-            for(int c=0; c<dataRows[r].size() && c < colCount; ++c) {
-                ui->tablePreview->setItem(r, c, new QTableWidgetItem(dataRows[r][c]));
-            }
-        }
-        return;
+        preview->blocks.append(block);
+    } else if (!m_sample.bytes.isEmpty()) {
+        TextTableReader::parse(m_sample.bytes, settings,
+                               [&preview](const ColumnarTableModel::RowBlock& block, const QStringList& header, qint64, qint64) {
+                                   if (!header.isEmpty()) preview->header = header;
+                                   preview->blocks.append(block);
+                               });
     }
 
-    // 文本预览逻辑 (保持不变)
-    QTextCodec* codec = nullptr;
-    QString encName = ui->comboEncoding->currentText();
-    if (encName.startsWith("GBK")) codec = QTextCodec::codecForName("GBK");
-    else if (encName.startsWith("UTF-8")) codec = QTextCodec::codecForName("UTF-8");
-    else if (encName.startsWith("ISO")) codec = QTextCodec::codecForName("ISO-8859-1");
-    else codec = QTextCodec::codecForLocale();
-    if (!codec) codec = QTextCodec::codecForName("UTF-8");
-
-    int startRow = ui->spinStartRow->value() - 1;
-    int headerRow = ui->spinHeaderRow->value() - 1;
-    bool useHeader = ui->checkUseHeader->isChecked();
-
-    QStringList headers;
-    QList<QStringList> dataRows;
-
-    QChar separator = ',';
-    if (!m_previewLines.isEmpty()) {
-        QString firstLine = codec->toUnicode(m_previewLines.first());
-        separator = getSeparatorChar(ui->comboSeparator->currentText(), firstLine);
-    }
-
-    for (int i = 0; i < m_previewLines.size(); ++i) {
-        if (i < startRow && !(useHeader && i == headerRow)) continue;
-        QString line = codec->toUnicode(m_previewLines[i]).trimmed();
-        if (line.isEmpty()) continue;
-        QStringList fields = line.split(separator);
-        for (int k=0; k<fields.size(); ++k) {
-            QString f = fields[k].trimmed();
-            if (f.startsWith('"') && f.endsWith('"')) f = f.mid(1, f.length()-2);
-            fields[k] = f;
-        }
-        if (useHeader && i == headerRow) headers = fields;
-        else if (i >= startRow) dataRows.append(fields);
-    }
+    m_preview = preview;
+    m_previewSettings = settings;
+    showPreview(*preview);
+}
 
-    int colCount = 0;
-    if (!headers.isEmpty()) colCount = headers.size();
-    else if (!dataRows.isEmpty()) colCount = dataRows.first().size();
+void DataImportDialog::showPreview(const DataImportPreview& preview)
+{
+    ui->tablePreview->clear();
 
-    ui->tablePreview->setColumnCount(colCount);
-    if (!headers.isEmpty()) ui->tablePreview->setHorizontalHeaderLabels(headers);
-    else {
-        QStringList defHeaders; for(int i=0; i<colCount; i++) defHeaders << QString("Col %1").arg(i+1);
-        ui->tablePreview->setHorizontalHeaderLabels(defHeaders);
+    int colCount = preview.header.size();
+    int rowCount = 0;
+    for (const ColumnarTableModel::RowBlock& block : preview.blocks) {
+        colCount = qMax(colCount, int(block.values.size()));
+        rowCount += block.rows;
     }
+    rowCount = qMin(rowCount, kPreviewRows);
 
-    ui->tablePreview->setRowCount(dataRows.size());
-    for(int r=0; r<dataRows.size(); ++r) {
-        for(int c=0; c<dataRows[r].size() && c < colCount; ++c) {
-            ui->tablePreview->setItem(r, c, new QTableWidgetItem(dataRows[r][c]));
+    QStringList headers = preview.header;
+    for (int i = headers.size(); i < colCount; i++) headers << QString("Col %1").arg(i+1);
+    ui->tablePreview->setColumnCount(colCount);
+    ui->tablePreview->setHorizontalHeaderLabels(headers);
+
+    // 单元格文本与数据表显示一致 (数值按原文小数位)
+    ui->tablePreview->setRowCount(rowCount);
+    int offset = 0;
+    for (const ColumnarTableModel::RowBlock& block : preview.blocks) {
+        const int rows = qMin(block.rows, rowCount - offset);
+        if (rows <= 0) break;
+        for (int c = 0; c < block.values.size(); ++c) {
+            for (int r = 0; r < rows; ++r) {
+                const double v = block.values[c][r];
+                if (std::isnan(v)) continue;
+                const int decimals = block.decimals[c][r];
+                const QString text = decimals >= 0 ? QString::number(v, 'f', decimals) : QString::number(v, 'g', 15);
+                ui->tablePreview->setItem(offset + r, c, new QTableWidgetItem(text));
+            }
+            for (const QPair<int, QString>& t : block.texts[c]) {
+                if (t.first < rows) ui->tablePreview->setItem(offset + t.first, c, new QTableWidgetItem(t.second));
+            }
         }
+        offset += rows;
     }
 }
 
-DataImportSettings DataImportDialog::getSettings() const
+DataImportSettings DataImportDialog::currentSettings() const
 {
     DataImportSettings s;
     s.filePath = m_filePath;
@@ -314,17 +301,12 @@ DataImportSettings DataImportDialog::getSettings() const
     return s;
 }
 
-QChar DataImportDialog::getSeparatorChar(const QString& sepStr, const QString& lineData)
+DataImportSettings DataImportDialog::getSettings() const
 {
-    if (sepStr.contains("Comma")) return ',';
-    if (sepStr.contains("Tab")) return '\t';
-    if (sepStr.contains("Space")) return ' ';
-    if (sepStr.contains("Semicolon")) return ';';
-    if (sepStr.contains("Auto")) {
-        if (lineData.count('\t') > lineData.count(',')) return '\t';
-        return ',';
-    }
-    return ',';
+    DataImportSettings s = currentSettings();
+    // 样本即整个文件且预览之后配置未变：预览的解析结果就是导入结果
+    if (m_sample.complete && m_preview && sameFormat(s, m_previewSettings)) s.parsed = m_preview;
+    return s;
 }
 
 QString DataImportDialog::getStyleSheet() const
@@ -3,8 +3,10 @@
  * 文件作用: 数据导入配置对话框头文件
  * 功能描述:
  * 1. 定义数据导入弹窗类，用于预览文件并配置导入参数。
- * 2. 声明 Excel 预览读取功能（同时支持 QXlsx 和 QAxObject）。
+ * 2. 声明 Excel 预览读取功能（.xlsx 流式读取前若干行，.xls 经 QAxObject 一次读取有界区域）。
  * 3. 声明防止 UI 卡顿的定时器机制。
+ * 4. [有界预览] 文件样本在后台线程读取并识别编码与分隔符；样本即整个文件且配置与最近一次预览相同时，
+ *    预览的解析结果随 DataImportSettings 交给导入，不再重新读取文件。
  */
 
 #ifndef DATAIMPORTDIALOG_H
@@ -12,14 +14,23 @@
 
 #include <QDialog>
 #include <QFile>
+#include <QFutureWatcher>
+#include <QSharedPointer>
 #include <QTextCodec>
 #include <QTimer>
 #include <QAxObject> // 保留：用于处理 .xls 文件
+#include "columnartablemodel.h"
 
 namespace Ui {
 class DataImportDialog;
 }
 
+// 预览阶段得到的解析结果 (与按相同配置读取整个文件的结果相同)
+struct DataImportPreview {
+    QVector<ColumnarTableModel::RowBlock> blocks;
+    QStringList header;
+};
+
 // 导入配置参数结构体
 struct DataImportSettings {
     QString filePath;
@@ -29,6 +40,8 @@ struct DataImportSettings {
     int headerRow;
     bool useHeader;
     bool isExcel; // 标记是否为 Excel 文件
+    // 预览已按上述配置解析了整个文件时非空：导入直接使用，不再读取文件
+    QSharedPointer<const DataImportPreview> parsed;
 };
 
 class DataImportDialog : public QDialog
@@ -47,31 +60,47 @@ private slots:
     void onSettingChanged();
     // 实际执行预览更新的槽函数（由定时器触发）
     void doUpdatePreview();
+    // 后台读取样本完成：采用识别出的编码与分隔符 (用户未手动选择时) 并刷新预览
+    void onSampleLoaded();
 
 private:
+    // 文件样本：文本文件为开头若干完整行的原始字节，Excel 文件为前若干行的字段
+    struct Sample {
+        QByteArray bytes;
+        QList<QStringList> rows;
+        bool complete = false; // 样本是否为整个文件
+        QString encoding;      // 识别出的编码 (文本文件)
+        char separator = 0;    // 识别出的分隔符 (文本文件，0 表示未识别)
+        QString error;
+    };
+
     Ui::DataImportDialog *ui;
     QString m_filePath;
 
-    QList<QByteArray> m_previewLines;      // 文本文件预览缓存
-    QList<QStringList> m_excelPreviewData; // Excel 文件预览缓存
+    Sample m_sample;
+    QFutureWatcher<Sample>* m_sampleWatcher;
+    QSharedPointer<const DataImportPreview> m_preview; // 最近一次预览的解析结果
+    DataImportSettings m_previewSettings;               // 上述结果对应的配置
 
     bool m_isInitializing;
     QTimer* m_previewTimer; // 防抖定时器
     bool m_isExcelFile;     // 是否检测为 Excel 文件
+    bool m_formatChosen;    // 用户是否手动选择过编码或分隔符
 
     // 初始化界面
     void initUI();
 
-    // 加载文件数据（文本或 Excel）
+    // 开始读取文件样本（文本与 .xlsx 在后台线程，.xls 经 COM 在界面线程）
     void loadDataForPreview();
-    // 专门读取 Excel 数据的辅助函数
+    // 读取样本并识别格式 (在后台线程运行)
+    static Sample loadSample(const QString& filePath, bool excel);
+    // 经 QAxObject 读取 .xls 工作表的前若干行
     void readExcelForPreview();
 
-    // 刷新预览表格 UI
-    void updatePreviewTable();
-
-    // 获取分隔符
-    QChar getSeparatorChar(const QString& sepStr, const QString& lineData);
+    // 当前界面上的配置 (不含预览结果)
+    DataImportSettings currentSettings() const;
+    // 把预览结果的前若干行显示到预览表格
+    void showPreview(const DataImportPreview& preview);
     // 获取样式表（移除 QSpinBox border 以修复点击问题）
     QString getStyleSheet() const;
 };
@@ -4,7 +4,7 @@
  * 功能描述:
  * 1. 管理数据表格的核心逻辑，包括界面初始化、模型(Model)设置。
  * 2. 实现多种格式数据的加载功能：
- * - loadExcelFile: 支持 .xlsx (基于 QXlsx) 和 .xls (基于 QAxObject) 格式。
+ * - loadExcelFile: 支持 .xlsx (流式解析) 和 .xls (基于 QAxObject) 格式。
  * - loadTextFile: 支持 .csv、.txt 等文本格式，支持自定义编码、分隔符、起始行和表头行。
  * 3. 实现表格的交互功能：
  * - 右键菜单 (插入/删除/隐藏行列、排序、分列、合并单元格)。
@@ -14,9 +14,32 @@
  * - 时间转换 (onTimeConvert)。
  * - 压降计算 (onPressureDropCalc)。
  * - 井底流压计算 (onCalcPwf)。
+ * - 表达式列 (onExpressionColumn)，压降与井底流压为其预设。
  * - 错误高亮检查 (onHighlightErrors)。
  * 5. 实现数据的导出 (Excel) 和 序列化保存 (JSON)。
  * 6. 强制应用统一的 UI 样式，确保弹窗按钮清晰可见。
+ * 7. [列存储] 数据保存在 ColumnarTableModel (数值列为连续 double 数组)，导入时整体只发出一次模型重置信号。
+ * 8. [快速导入] 文本文件由 TextTableReader 内存映射后分段并行解析，正确处理引号内的分隔符与换行。
+ * 9. [后台加载] loadDataAsync 在线程池中读取 .csv/.txt/.xlsx，按批投递回界面线程追加 (表格逐批显示)，
+ *    页签顶部显示进度条与取消按钮；追加行只发出 rowsInserted，不触发 dataChanged，结束时发出一次 loadFinished。
+ * 10. [流式 Excel] .xlsx 的读取与导出改用 XlsxStreamReader / XlsxStreamWriter 逐行处理，不再经 QXlsx 建立整表单元格对象；
+ *    导出在后台线程进行，显示进度并可取消 (取消时删除未完成的文件)。
+ * 11. [二进制表格] 项目保存为按列压缩的 _date.bin (ProjectTableStore)，打开项目时各页签在首次显示时才解压数据；
+ *    loadFromJson 保留用于旧项目。
+ * 12. [增量保存] 与表格文件中的副本一致 (打开或保存后未修改) 的数据表保存时原样复制压缩块；模型的任何修改信号都使副本过期。
+ * 13. [自动备份] 模型的修改信号同时更新内容修订号 (全局递增)，供后台自动备份跳过未修改的表。
+ * 14. [后台过滤] 过滤与排序由 SheetFilterProxy 在线程池中对列数据快照进行，支持 "列 between a and b" 等数值范围条件，
+ *    列的有序索引按需建立并缓存；行号列显示原始行号。
+ * 15. [变更合并] 模型的修改信号先记入 DataChangeSet，每个事件循环周期只发出一次 changesCommitted 与 dataChanged，
+ *    批量操作 (粘贴、分列、计算列) 不再逐格通知下游；后台加载期间不通知 (由 loadFinished 代替)。
+ * 16. [撤销] 单元格编辑、插入删除行列、数据分列与各计算列经 SheetUndoStack 可撤销 (Ctrl+Z / Ctrl+Y 或右键菜单)，
+ *    命令只保存差量 (删除的行列切片、被改写的列、新增列以删除为逆操作)，总内存超出预算时丢弃最旧的命令；
+ *    模型被整体重置 (加载、恢复) 时清空撤销栈。
+ * 17. [数据检查] 错误高亮改为规则检查：先在对话框中确认规则 (默认按列类型生成：时间单调/重复/间隔、压力非负与尖峰等)，
+ *    DataValidator 在线程池中分段扫描数值列，结果保存为每格 1 位的位图，由委托绘制底色与提示，不再逐格写入背景色；
+ *    行列插入、删除或整表重置后结果清除，需重新检查。
+ * 18. [预览复用] 导入配置带有预览的解析结果 (小文件) 时直接追加，不再读取文件 (.xls 不再二次启动 Excel)；
+ *    扩展名为 .xls 的 OOXML 工作簿按 .xlsx 流式读取。
  */
 
 #include "datasinglesheet.h"
@@ -24,12 +47,11 @@
 #include "datacolumndialog.h"
 #include "datacalculate.h"
 #include "dataimportdialog.h"
+#include "texttablereader.h"
 
-// 引入 QXlsx 头文件
-#include "xlsxdocument.h"
-#include "xlsxchartsheet.h"
-#include "xlsxcellrange.h"
-#include "xlsxformat.h"
+#include "xlsxstream.h"
+#include "sheetundostack.h"
+#include "datavalidator.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -42,8 +64,13 @@
 #include <QTextCodec>
 #include <QLineEdit>
 #include <QEvent>
+#include <QHelpEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <QShowEvent>
 #include <QAxObject>
 #include <QDir>
+#include <QFile>
 #include <QDateTime>
 #include <QRadioButton>
 #include <QButtonGroup>
@@ -52,6 +79,14 @@
 #include <QGroupBox>
 #include <QPushButton>
 #include <QWheelEvent>
+#include <QProgressBar>
+#include <QLabel>
+#include <QtConcurrent>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QEventLoop>
+#include <QAtomicInteger>
+#include <QShortcut>
 
 // ============================================================================
 // [辅助函数] 强制应用“灰底黑字”的按钮样式
@@ -180,25 +215,68 @@ QWidget *NoContextMenuDelegate::createEditor(QWidget *parent, const QStyleOption
     return editor;
 }
 
+// 编辑结果经数据表的撤销栈写入
+void NoContextMenuDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+{
+    DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(parent());
+    QLineEdit* lineEdit = qobject_cast<QLineEdit*>(editor);
+    if (!sheet || !lineEdit) {
+        QStyledItemDelegate::setModelData(editor, model, index);
+        return;
+    }
+    sheet->editCell(index, lineEdit->text());
+}
+
+void NoContextMenuDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(parent());
+    if (sheet && sheet->validationMask(index) != 0) painter->fillRect(option.rect, QColor(255, 200, 200));
+    QStyledItemDelegate::paint(painter, option, index);
+}
+
+bool NoContextMenuDelegate::helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option,
+                                      const QModelIndex &index)
+{
+    DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(parent());
+    const quint32 mask = sheet ? sheet->validationMask(index) : 0;
+    if (event && event->type() == QEvent::ToolTip && mask != 0) {
+        QStringList names;
+        for (int k = 0; k < ValidationRule::KindCount; ++k)
+            if (mask & (1u << k)) names << ValidationRule::kindName(ValidationRule::Kind(k));
+        QToolTip::showText(event->globalPos(), "数据检查: " + names.join("、"), view);
+        return true;
+    }
+    return QStyledItemDelegate::helpEvent(event, view, option, index);
+}
+
 // ============================================================================
 // [类实现] DataSingleSheet
 // ============================================================================
 
+// 内容修订号来源 (仅在界面线程递增)
+static quint64 s_lastRevision = 0;
+
 DataSingleSheet::DataSingleSheet(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::DataSingleSheet),
-    m_dataModel(new QStandardItemModel(this)),
-    m_proxyModel(new QSortFilterProxyModel(this)),
-    m_undoStack(new QUndoStack(this))
+    m_dataModel(new ColumnarTableModel(this)),
+    m_proxyModel(new SheetFilterProxy(this)),
+    m_undoStack(new SheetUndoStack(this))
 {
+    m_revision = ++s_lastRevision;
     ui->setupUi(this);
     initUI();
     setupModel();
 
     // 连接右键菜单信号
     connect(ui->dataTableView, &QTableView::customContextMenuRequested, this, &DataSingleSheet::onCustomContextMenu);
-    // 连接模型数据变更信号
-    connect(m_dataModel, &QStandardItemModel::itemChanged, this, &DataSingleSheet::onModelDataChanged);
+    // 撤销与重做
+    QShortcut* undoShortcut = new QShortcut(QKeySequence::Undo, ui->dataTableView);
+    undoShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(undoShortcut, &QShortcut::activated, m_undoStack, &SheetUndoStack::undo);
+    QShortcut* redoShortcut = new QShortcut(QKeySequence::Redo, ui->dataTableView);
+    redoShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(redoShortcut, &QShortcut::activated, m_undoStack, &SheetUndoStack::redo);
 
     // 安装事件过滤器以捕获表格视图的滚轮事件（用于缩放）
     ui->dataTableView->viewport()->installEventFilter(this);
@@ -206,6 +284,9 @@ DataSingleSheet::DataSingleSheet(QWidget *parent) :
 
 DataSingleSheet::~DataSingleSheet()
 {
+    // 后台读取只访问取消令牌并向本对象投递调用，等其结束后再析构
+    m_loadCancel.cancel();
+    m_loadFuture.waitForFinished();
     delete ui;
 }
 
@@ -215,13 +296,75 @@ void DataSingleSheet::initUI()
     ui->dataTableView->setContextMenuPolicy(Qt::CustomContextMenu);
     // 设置自定义代理以处理编辑器事件
     ui->dataTableView->setItemDelegate(new NoContextMenuDelegate(this));
+
+    // 后台加载进度条 (加载期间显示在表格上方)
+    m_loadBar = new QWidget(this);
+    QHBoxLayout* loadLayout = new QHBoxLayout(m_loadBar);
+    loadLayout->setContentsMargins(6, 4, 6, 4);
+    m_loadLabel = new QLabel("正在加载...", m_loadBar);
+    m_loadProgress = new QProgressBar(m_loadBar);
+    m_loadProgress->setRange(0, 100);
+    QPushButton* btnCancelLoad = new QPushButton("取消加载", m_loadBar);
+    loadLayout->addWidget(m_loadLabel);
+    loadLayout->addWidget(m_loadProgress, 1);
+    loadLayout->addWidget(btnCancelLoad);
+    connect(btnCancelLoad, &QPushButton::clicked, this, &DataSingleSheet::cancelLoad);
+    ui->verticalLayout->insertWidget(0, m_loadBar);
+    m_loadBar->hide();
 }
 
 // 初始化数据模型与代理模型
 void DataSingleSheet::setupModel()
 {
     m_proxyModel->setSourceModel(m_dataModel);
-    m_proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive); // 过滤不区分大小写
+
+    // 任何修改都使表格文件中的副本过期 (下次保存重新压缩本表)，并更新修订号
+    auto markDirty = [this]() {
+        m_revision = ++s_lastRevision;
+        if (!m_restoringStore) m_store.reset();
+    };
+    connect(m_dataModel, &QAbstractItemModel::dataChanged, this, markDirty);
+    connect(m_dataModel, &QAbstractItemModel::headerDataChanged, this, markDirty);
+    connect(m_dataModel, &QAbstractItemModel::rowsInserted, this, markDirty);
+    connect(m_dataModel, &QAbstractItemModel::rowsRemoved, this, markDirty);
+    connect(m_dataModel, &QAbstractItemModel::rowsMoved, this, markDirty);
+    connect(m_dataModel, &QAbstractItemModel::columnsInserted, this, markDirty);
+    connect(m_dataModel, &QAbstractItemModel::columnsRemoved, this, markDirty);
+    connect(m_dataModel, &QAbstractItemModel::columnsMoved, this, markDirty);
+    connect(m_dataModel, &QAbstractItemModel::modelReset, this, markDirty);
+
+    // 修改先记入变更集，本周期结束时合并通知一次
+    connect(m_dataModel, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex& topLeft, const QModelIndex& bottomRight, const QList<int>& roles) {
+        if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole)) return; // 背景色等
+        m_pendingChanges.addCells(topLeft.row(), topLeft.column(), bottomRight.row(), bottomRight.column());
+        scheduleChangeNotification();
+    });
+    auto markStructural = [this]() {
+        m_pendingChanges.structural = true;
+        scheduleChangeNotification();
+    };
+    connect(m_dataModel, &QAbstractItemModel::headerDataChanged, this, markStructural);
+    connect(m_dataModel, &QAbstractItemModel::rowsInserted, this, markStructural);
+    connect(m_dataModel, &QAbstractItemModel::rowsRemoved, this, markStructural);
+    connect(m_dataModel, &QAbstractItemModel::rowsMoved, this, markStructural);
+    connect(m_dataModel, &QAbstractItemModel::columnsInserted, this, markStructural);
+    connect(m_dataModel, &QAbstractItemModel::columnsRemoved, this, markStructural);
+    connect(m_dataModel, &QAbstractItemModel::columnsMoved, this, markStructural);
+    connect(m_dataModel, &QAbstractItemModel::modelReset, this, markStructural);
+
+    // 检查结果按原始行列号保存，结构变化后不再对应
+    auto clearValidation = [this]() { m_validation.clear(); };
+    connect(m_dataModel, &QAbstractItemModel::rowsInserted, this, clearValidation);
+    connect(m_dataModel, &QAbstractItemModel::rowsRemoved, this, clearValidation);
+    connect(m_dataModel, &QAbstractItemModel::rowsMoved, this, clearValidation);
+    connect(m_dataModel, &QAbstractItemModel::columnsInserted, this, clearValidation);
+    connect(m_dataModel, &QAbstractItemModel::columnsRemoved, this, clearValidation);
+    connect(m_dataModel, &QAbstractItemModel::columnsMoved, this, clearValidation);
+    connect(m_dataModel, &QAbstractItemModel::modelReset, this, clearValidation);
+
+    // 整体重置 (加载、恢复) 后旧的撤销命令不再适用
+    connect(m_dataModel, &QAbstractItemModel::modelReset, m_undoStack, &SheetUndoStack::clear);
     ui->dataTableView->setModel(m_proxyModel);
     ui->dataTableView->setSelectionBehavior(QAbstractItemView::SelectItems);
     ui->dataTableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
@@ -264,7 +407,7 @@ bool DataSingleSheet::eventFilter(QObject *obj, QEvent *event)
 // 设置表格过滤文本
 void DataSingleSheet::setFilterText(const QString& text)
 {
-    m_proxyModel->setFilterWildcard(text);
+    m_proxyModel->setFilterText(text);
 }
 
 // 加载数据总入口
@@ -274,66 +417,118 @@ bool DataSingleSheet::loadData(const QString& filePath, const DataImportSettings
     m_dataModel->clear();
     m_columnDefinitions.clear();
 
-    if (settings.isExcel) {
-        return loadExcelFile(filePath, settings);
-    } else {
-        return loadTextFile(filePath, settings);
+    m_dataModel->beginLoad();
+    const bool ok = settings.isExcel ? loadExcelFile(filePath, settings) : loadTextFile(filePath, settings);
+    m_dataModel->endLoad();
+    return ok;
+}
+
+// 后台加载：读取在线程池中进行，结果按批投递回界面线程
+void DataSingleSheet::loadDataAsync(const QString& filePath, const DataImportSettings& settings)
+{
+    cancelLoad();
+    m_loadFuture.waitForFinished();
+
+    // 导入对话框已按相同配置解析了整个文件：直接追加，结束通知同样异步发出
+    if (settings.parsed) {
+        m_filePath = filePath;
+        m_dataModel->clear();
+        m_columnDefinitions.clear();
+        m_loadCancel.reset();
+        m_loading = true;
+        if (!settings.parsed->header.isEmpty()) setHeaderLabels(settings.parsed->header);
+        for (const ColumnarTableModel::RowBlock& block : settings.parsed->blocks) m_dataModel->appendBlock(block);
+        QTimer::singleShot(0, this, [this]() { finishLoad(true, QString()); });
+        return;
+    }
+
+    // .xls 经 COM 自动化读取，只能在界面线程同步完成；结束通知同样异步发出
+    if (settings.isExcel && !filePath.endsWith(".xlsx", Qt::CaseInsensitive) && !XlsxStreamReader::isWorkbookFile(filePath)) {
+        const bool ok = loadData(filePath, settings);
+        QTimer::singleShot(0, this, [this, ok]() { emit loadFinished(ok); });
+        return;
     }
+
+    m_filePath = filePath;
+    m_dataModel->clear();
+    m_columnDefinitions.clear();
+
+    m_loadCancel.reset();
+    m_loading = true;
+    m_loadProgress->setValue(0);
+    m_loadLabel->setText("正在加载...");
+    m_loadBar->show();
+
+    const CancellationToken* token = &m_loadCancel;
+    m_loadFuture = QtConcurrent::run([this, filePath, settings, token]() {
+        // 投递给本对象的调用在界面线程执行 (数据块隐式共享，复制代价很小)
+        auto sink = [this](const ColumnarTableModel::RowBlock& block, const QStringList& header,
+                           qint64 bytesRead, qint64 bytesTotal) {
+            QMetaObject::invokeMethod(this, [this, block, header, bytesRead, bytesTotal]() {
+                appendLoadedBlock(block, header, bytesRead, bytesTotal);
+            }, Qt::QueuedConnection);
+        };
+
+        QString error;
+        const bool ok = settings.isExcel ? XlsxStreamReader::read(filePath, settings, sink, token, &error)
+                                         : TextTableReader::read(filePath, settings, sink, token);
+        QMetaObject::invokeMethod(this, [this, ok, error]() { finishLoad(ok, error); }, Qt::QueuedConnection);
+    });
 }
 
-// 加载 Excel 文件 (.xlsx 或 .xls)
-bool DataSingleSheet::loadExcelFile(const QString& path, const DataImportSettings& settings)
+void DataSingleSheet::cancelLoad()
 {
-    // 分支1：处理 .xlsx 文件 (使用 QXlsx 库)
-    if(path.endsWith(".xlsx", Qt::CaseInsensitive)) {
-        QXlsx::Document xlsx(path);
-        if(!xlsx.load()) {
-            showStyledMessage(this, QMessageBox::Critical, "错误", "无法加载 .xlsx 文件");
-            return false;
-        }
+    if (!m_loading) return;
+    m_loadCancel.cancel();
+    m_loadLabel->setText("正在取消...");
+}
 
-        // 确保选中第一个工作表
-        if(xlsx.currentWorksheet()==nullptr && !xlsx.sheetNames().isEmpty())
-            xlsx.selectSheet(xlsx.sheetNames().first());
-
-        int maxRow = xlsx.dimension().lastRow();
-        int maxCol = xlsx.dimension().lastColumn();
-        if(maxRow < 1 || maxCol < 1) return true; // 空表
-
-        for(int r = 1; r <= maxRow; ++r) {
-            // 跳过不需要的行：既不是表头行，也不在数据起始行之后
-            if(r < settings.startRow && !(settings.useHeader && r == settings.headerRow)) continue;
-
-            QStringList fields;
-            for(int c = 1; c <= maxCol; ++c) {
-                auto cell = xlsx.cellAt(r, c);
-                if(cell) {
-                    if(cell->isDateTime())
-                        fields.append(cell->readValue().toDateTime().toString("yyyy-MM-dd hh:mm:ss"));
-                    else
-                        fields.append(cell->value().toString());
-                } else {
-                    fields.append("");
-                }
-            }
+void DataSingleSheet::appendLoadedBlock(const ColumnarTableModel::RowBlock& block, const QStringList& header,
+                                        qint64 bytesRead, qint64 bytesTotal)
+{
+    if (m_loadCancel.isCancelRequested()) return; // 已取消：丢弃仍在队列中的数据块
+    if (!header.isEmpty()) setHeaderLabels(header);
+    m_dataModel->appendBlock(block);
 
-            // 设置表头
-            if(settings.useHeader && r == settings.headerRow) {
-                m_dataModel->setHorizontalHeaderLabels(fields);
-                for(auto h : fields) {
-                    ColumnDefinition d;
-                    d.name = h;
-                    m_columnDefinitions.append(d);
-                }
-            }
-            // 添加数据行
-            else if(r >= settings.startRow) {
-                QList<QStandardItem*> items;
-                for(auto f : fields) items.append(new QStandardItem(f));
-                m_dataModel->appendRow(items);
-            }
-        }
-        return true;
+    if (bytesTotal > 0) m_loadProgress->setValue(int(bytesRead * 100 / bytesTotal));
+    m_loadLabel->setText(QString("正在加载... 已读取 %1 行").arg(m_dataModel->rowCount()));
+}
+
+void DataSingleSheet::finishLoad(bool success, const QString& errorMessage)
+{
+    m_loading = false;
+    m_pendingChanges = DataChangeSet(); // 加载结果由 loadFinished 通知
+    m_loadBar->hide();
+    const bool cancelled = m_loadCancel.isCancelRequested();
+    if (!success && !errorMessage.isEmpty()) showStyledMessage(this, QMessageBox::Critical, "错误", errorMessage);
+    emit loadFinished(success && !cancelled);
+}
+
+// 设置表头并重建列定义结构
+void DataSingleSheet::setHeaderLabels(const QStringList& labels)
+{
+    m_dataModel->setHorizontalHeaderLabels(labels);
+    m_columnDefinitions.clear();
+    for (const QString& h : labels) {
+        ColumnDefinition d;
+        d.name = h;
+        m_columnDefinitions.append(d);
+    }
+}
+
+// 加载 Excel 文件 (.xlsx 或 .xls)
+bool DataSingleSheet::loadExcelFile(const QString& path, const DataImportSettings& settings)
+{
+    // 分支1：处理 .xlsx 文件 (流式解析，见 XlsxStreamReader)
+    if(path.endsWith(".xlsx", Qt::CaseInsensitive) || XlsxStreamReader::isWorkbookFile(path)) {
+        QString error;
+        const bool ok = XlsxStreamReader::read(path, settings,
+                                     [this](const ColumnarTableModel::RowBlock& block, const QStringList& header, qint64, qint64) {
+                                         if (!header.isEmpty()) setHeaderLabels(header);
+                                         m_dataModel->appendBlock(block);
+                                     }, nullptr, &error);
+        if (!ok) showStyledMessage(this, QMessageBox::Critical, "错误", error);
+        return ok;
     }
     // 分支2：处理 .xls 文件 (使用 QAxObject / OLE 自动化)
     else {
@@ -391,9 +586,7 @@ bool DataSingleSheet::loadExcelFile(const QString& path, const DataImportSetting
                         }
                     }
                     else if(currentRow >= settings.startRow) {
-                        QList<QStandardItem*> items;
-                        for(auto f : fields) items.append(new QStandardItem(f));
-                        m_dataModel->appendRow(items);
+                        m_dataModel->appendRow(fields);
                     }
                 }
                 delete ur;
@@ -405,153 +598,87 @@ bool DataSingleSheet::loadExcelFile(const QString& path, const DataImportSetting
     }
 }
 
-// 加载文本文件 (.csv, .txt) - 已修正逻辑以支持配置参数
+// 加载文本文件 (.csv, .txt)：内存映射后分段并行解析，直接写入列存储模型 (见 TextTableReader)
 bool DataSingleSheet::loadTextFile(const QString& path, const DataImportSettings& settings)
 {
-    QFile f(path);
-    if(!f.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
-
-    QTextStream in(&f);
-
-    // 1. 设置编码
-    if(settings.encoding.startsWith("GBK")) {
-        in.setEncoding(QStringConverter::System); // 兼容中文系统编码
-    } else if (settings.encoding.startsWith("ISO")) {
-        in.setEncoding(QStringConverter::Latin1);
-    } else {
-        in.setEncoding(QStringConverter::Utf8);
-    }
-
-    // 2. 确定分隔符
-    QChar separator = ','; // 默认逗号
-    if (settings.separator.contains("Tab")) separator = '\t';
-    else if (settings.separator.contains("Space")) separator = ' ';
-    else if (settings.separator.contains("Semicolon")) separator = ';';
-    else if (settings.separator.contains("Comma")) separator = ',';
-    else if (settings.separator.contains("Auto")) {
-        // 自动识别：读取首行判断逗号和制表符的数量
-        qint64 originalPos = in.pos();
-        QString firstLine = in.readLine();
-        if (firstLine.count('\t') > firstLine.count(',')) {
-            separator = '\t';
-        }
-        in.seek(originalPos); // 恢复流位置
-    }
-
-    // 3. 逐行读取并解析
-    int lineIdx = 0; // 当前处理的行号（逻辑行号，从1开始计数）
-
-    while(!in.atEnd()) {
-        QString line = in.readLine();
-
-        // 如果是空行，且不是表头行，通常可以选择跳过，或者作为空数据行
-        // 这里为了稳健，暂不强制跳过空行，取决于数据本身的质量
-
-        lineIdx++; // 行号增加
-
-        // 检查是否在需要处理的范围内
-        // 规则：必须 >= 起始行，或者 == 表头行（如果启用了表头）
-        bool isHeader = (settings.useHeader && lineIdx == settings.headerRow);
-        bool isData = (lineIdx >= settings.startRow);
-
-        if (!isHeader && !isData) {
-            continue; // 跳过无关行
-        }
-
-        // 分割字符串
-        QStringList parts = line.split(separator);
-
-        // 处理 CSV 引号 (例如 "text, with, comma")
-        // 与预览界面逻辑保持一致：去除首尾的双引号
-        for (int i = 0; i < parts.size(); ++i) {
-            QString p = parts[i].trimmed();
-            if (p.startsWith('"') && p.endsWith('"') && p.length() >= 2) {
-                p = p.mid(1, p.length() - 2);
-            }
-            parts[i] = p;
-        }
-
-        // 分支处理：表头 vs 数据
-        if (isHeader) {
-            // 设置表头
-            m_dataModel->setHorizontalHeaderLabels(parts);
-
-            // 更新列定义结构
-            m_columnDefinitions.clear();
-            for (const QString& h : parts) {
-                ColumnDefinition d;
-                d.name = h;
-                m_columnDefinitions.append(d);
-            }
-        } else if (isData) {
-            // 添加数据行
-            QList<QStandardItem*> items;
-            for(const QString& p : parts) {
-                items.append(new QStandardItem(p.trimmed()));
-            }
-            m_dataModel->appendRow(items);
-        }
-    }
-
-    f.close();
-    return true;
+    return TextTableReader::read(path, settings,
+                                 [this](const ColumnarTableModel::RowBlock& block, const QStringList& header, qint64, qint64) {
+                                     if (!header.isEmpty()) setHeaderLabels(header);
+                                     m_dataModel->appendBlock(block);
+                                 });
 }
 
-// 导出为 Excel 文件
+// 导出为 Excel 文件：后台线程逐行流式写出 (见 XlsxStreamWriter)，期间显示进度并可取消
 void DataSingleSheet::onExportExcel()
 {
     QString path = QFileDialog::getSaveFileName(this, "导出 Excel", "", "Excel 文件 (*.xlsx)");
     if (path.isEmpty()) return;
 
-    QXlsx::Document xlsx;
-    // 设置表头样式
-    QXlsx::Format headerFormat;
-    headerFormat.setFontBold(true);
-    headerFormat.setFillPattern(QXlsx::Format::PatternSolid);
-    headerFormat.setPatternBackgroundColor(QColor(240, 240, 240));
-    headerFormat.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
-    headerFormat.setBorderStyle(QXlsx::Format::BorderThin);
+    const int colCount = m_dataModel->columnCount();
+    const int rowCount = m_dataModel->rowCount();
 
-    int colCount = m_dataModel->columnCount();
-    int rowCount = m_dataModel->rowCount();
-
-    // 写入表头
+    // 隐藏状态属于视图，在界面线程中先取出
+    QStringList headers;
+    QVector<bool> hiddenRows(rowCount, false);
+    XlsxStreamWriter writer(path);
     for (int col = 0; col < colCount; ++col) {
-        QString header = m_dataModel->headerData(col, Qt::Horizontal).toString();
-        xlsx.write(1, col + 1, header, headerFormat);
+        headers.append(m_dataModel->headerData(col, Qt::Horizontal).toString());
         // 如果列被隐藏，Excel中也隐藏
-        if (ui->dataTableView->isColumnHidden(col)) xlsx.setColumnHidden(col + 1, true);
+        if (ui->dataTableView->isColumnHidden(col)) writer.setColumnHidden(col, true);
     }
-
-    // 写入数据
-    for (int row = 0; row < rowCount; ++row) {
-        // 如果行被隐藏，Excel中也隐藏
-        if (ui->dataTableView->isRowHidden(row)) xlsx.setRowHidden(row + 2, true);
-
-        for (int col = 0; col < colCount; ++col) {
-            QStandardItem* item = m_dataModel->item(row, col);
-            if (!item) continue;
-
-            QVariant value = item->data(Qt::DisplayRole);
-            QString strVal = value.toString();
-            QXlsx::Format cellFormat;
-
-            // 尝试写入数值以保持 Excel 计算功能
-            if (strVal.startsWith("=")) {
-                xlsx.write(row + 2, col + 1, strVal, cellFormat); // 公式
-            } else {
-                bool ok;
-                double dVal = value.toDouble(&ok);
-                if (ok && !strVal.isEmpty()) {
-                    xlsx.write(row + 2, col + 1, dVal, cellFormat); // 数值
-                } else {
-                    xlsx.write(row + 2, col + 1, strVal, cellFormat); // 文本
-                }
+    for (int row = 0; row < rowCount; ++row) hiddenRows[row] = ui->dataTableView->isRowHidden(row);
+
+    QAtomicInteger<int> rowsWritten(0);
+    CancellationToken cancel;
+    const ColumnarTableModel* model = m_dataModel;
+    QFuture<bool> future = QtConcurrent::run([&]() {
+        if (!writer.open()) return false;
+
+        // 写入表头
+        writer.beginRow();
+        for (const QString& header : headers) writer.addHeader(header);
+        writer.endRow();
+
+        // 写入数据 (模态进度框期间表格不可编辑，模型只读)
+        for (int row = 0; row < rowCount; ++row) {
+            if (cancel.isCancelled()) break;
+            writer.beginRow(hiddenRows[row]);
+            for (int col = 0; col < colCount; ++col) {
+                // 数值单元格直接写入数值以保持 Excel 计算功能
+                bool ok = false;
+                const double dVal = model->value(row, col, &ok);
+                if (ok) writer.addNumber(dVal);
+                else writer.addText(model->text(row, col)); // 公式或文本
             }
+            writer.endRow();
+            rowsWritten.storeRelaxed(row + 1);
         }
+        return writer.close();
+    });
+
+    QProgressDialog progress("正在导出 Excel...", "取消", 0, qMax(rowCount, 1), this);
+    progress.setWindowTitle("导出");
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    applySheetDialogStyle(&progress);
+    connect(&progress, &QProgressDialog::canceled, &progress, [&cancel]() { cancel.cancel(); });
+
+    QEventLoop loop;
+    QFutureWatcher<bool> watcher;
+    connect(&watcher, &QFutureWatcher<bool>::finished, &loop, &QEventLoop::quit);
+    QTimer timer;
+    connect(&timer, &QTimer::timeout, &progress, [&]() { progress.setValue(rowsWritten.loadRelaxed()); });
+    timer.start(100);
+    watcher.setFuture(future);
+    if (!future.isFinished()) loop.exec();
+    timer.stop();
+    progress.reset();
+
+    if (cancel.isCancelled()) {
+        QFile::remove(path); // 取消：不留下不完整的文件
+        return;
     }
-
-    if (xlsx.saveAs(path))
+    if (future.result())
         showStyledMessage(this, QMessageBox::Information, "成功", "数据已成功导出！");
     else
         showStyledMessage(this, QMessageBox::Warning, "失败", "导出失败，请检查文件是否被占用。");
@@ -565,6 +692,13 @@ void DataSingleSheet::onCustomContextMenu(const QPoint& pos) {
                        "QMenu::item { padding: 6px 24px; color: #333333; } "
                        "QMenu::item:selected { background-color: #E6F7FF; color: #000000; }");
 
+    // 撤销与重做
+    QAction* undoAction = menu.addAction("撤销 " + m_undoStack->undoText(), m_undoStack, &SheetUndoStack::undo);
+    undoAction->setEnabled(m_undoStack->canUndo());
+    QAction* redoAction = menu.addAction("重做 " + m_undoStack->redoText(), m_undoStack, &SheetUndoStack::redo);
+    redoAction->setEnabled(m_undoStack->canRedo());
+    menu.addSeparator();
+
     // 行操作子菜单
     QMenu* rowMenu = menu.addMenu("行操作");
     rowMenu->addAction("在上方插入行", [=](){ onAddRow(1); });
@@ -658,26 +792,21 @@ void DataSingleSheet::onAddRow(int m) {
         int sr = m_proxyModel->mapToSource(i).row();
         r = (m == 1) ? sr : sr + 1;
     }
-    QList<QStandardItem*> l;
-    for(int k=0; k<m_dataModel->columnCount(); ++k) l << new QStandardItem("");
-    m_dataModel->insertRow(r, l);
+    m_undoStack->push(new InsertRowsCommand(m_dataModel, r, 1));
 }
 
 // 删除行
 void DataSingleSheet::onDeleteRow() {
     auto s = ui->dataTableView->selectionModel()->selectedRows();
+    QList<int> rs;
     if(s.isEmpty()){
         auto i = ui->dataTableView->currentIndex();
-        if(i.isValid()) m_dataModel->removeRow(m_proxyModel->mapToSource(i).row());
+        if(i.isValid()) rs << m_proxyModel->mapToSource(i).row();
     } else {
-        QList<int> rs;
         for(auto i : s) rs << m_proxyModel->mapToSource(i).row();
-        // 从大到小排序，防止删除时索引偏移
-        std::sort(rs.begin(), rs.end(), std::greater<int>());
-        auto l = std::unique(rs.begin(), rs.end());
-        rs.erase(l, rs.end());
-        for(int r : rs) m_dataModel->removeRow(r);
     }
+    // 删除的各段连续行按列切片保存，可撤销
+    if(!rs.isEmpty()) m_undoStack->push(new RemoveRowsCommand(m_dataModel, rs));
 }
 
 // 插入列
@@ -695,29 +824,21 @@ void DataSingleSheet::onAddCol(int m) {
     if(c < m_columnDefinitions.size()) m_columnDefinitions.insert(c, d);
     else m_columnDefinitions.append(d);
     m_dataModel->setHeaderData(c, Qt::Horizontal, "新列");
+    m_undoStack->push(new AddColumnsCommand(m_dataModel, &m_columnDefinitions, c, 1, "插入列"));
 }
 
 // 删除列
 void DataSingleSheet::onDeleteCol() {
     auto s = ui->dataTableView->selectionModel()->selectedColumns();
+    QList<int> cs;
     if(s.isEmpty()){
         auto i = ui->dataTableView->currentIndex();
-        if(i.isValid()){
-            int c = m_proxyModel->mapToSource(i).column();
-            m_dataModel->removeColumn(c);
-            if(c < m_columnDefinitions.size()) m_columnDefinitions.removeAt(c);
-        }
+        if(i.isValid()) cs << m_proxyModel->mapToSource(i).column();
     } else {
-        QList<int> cs;
         for(auto i : s) cs << m_proxyModel->mapToSource(i).column();
-        std::sort(cs.begin(), cs.end(), std::greater<int>());
-        auto l = std::unique(cs.begin(), cs.end());
-        cs.erase(l, cs.end());
-        for(int c : cs){
-            m_dataModel->removeColumn(c);
-            if(c < m_columnDefinitions.size()) m_columnDefinitions.removeAt(c);
-        }
     }
+    // 删除的列连同表头与列定义整列保存 (不复制列数组)，可撤销
+    if(!cs.isEmpty()) m_undoStack->push(new RemoveColumnsCommand(m_dataModel, &m_columnDefinitions, cs));
 }
 
 // 数据分列操作
@@ -733,6 +854,8 @@ void DataSingleSheet::onSplitColumn() {
     if (separator.isEmpty()) return;
 
     int rows = m_dataModel->rowCount();
+    // 源列改写前的整列 (与模型共享，改写时才复制)，用于撤销
+    const ColumnarTableModel::RowBlock before = m_dataModel->copyColumns(col, 1);
     // 在当前列后插入新列存放结果
     m_dataModel->insertColumn(col + 1);
 
@@ -742,19 +865,21 @@ void DataSingleSheet::onSplitColumn() {
     m_dataModel->setHeaderData(col + 1, Qt::Horizontal, "拆分数据");
 
     for (int i = 0; i < rows; ++i) {
-        QStandardItem* item = m_dataModel->item(i, col);
-        if (!item) continue;
-        QString text = item->text();
+        QString text = m_dataModel->text(i, col);
         int sepIdx = text.indexOf(separator);
         if (sepIdx != -1) {
             // 原列保留前半部分
-            item->setText(text.left(sepIdx).trimmed());
+            m_dataModel->setText(i, col, text.left(sepIdx).trimmed());
             // 新列存放后半部分
-            m_dataModel->setItem(i, col + 1, new QStandardItem(text.mid(sepIdx + separator.length()).trimmed()));
-        } else {
-            m_dataModel->setItem(i, col + 1, new QStandardItem(""));
+            m_dataModel->setText(i, col + 1, text.mid(sepIdx + separator.length()).trimmed());
         }
     }
+
+    SheetUndoCommand* command = new SheetUndoCommand("数据分列");
+    command->setApplied(true);
+    new ReplaceColumnsCommand(m_dataModel, col, before, QString(), command);
+    new AddColumnsCommand(m_dataModel, &m_columnDefinitions, col + 1, 1, QString(), command);
+    m_undoStack->push(command);
 }
 
 // ============================================================================
@@ -776,7 +901,8 @@ void DataSingleSheet::onDefineColumns() {
         for(int i=0; i<m_columnDefinitions.size(); ++i)
             if(i < m_dataModel->columnCount())
                 m_dataModel->setHeaderData(i, Qt::Horizontal, m_columnDefinitions[i].name);
-        emit dataChanged();
+        m_pendingChanges.structural = true; // 列类型可能改变而表头不变
+        scheduleChangeNotification();
     }
 }
 
@@ -792,20 +918,22 @@ void DataSingleSheet::onTimeConvert() {
 
     if(d.exec() == QDialog::Accepted){
         auto cfg = d.getConversionConfig();
+        const int columnsBefore = m_dataModel->columnCount();
         auto res = calc.convertTimeColumn(m_dataModel, m_columnDefinitions, cfg);
+        recordAppendedColumns("时间转换", columnsBefore);
         if(res.success) showStyledMessage(this, QMessageBox::Information, "成功", "时间列转换完成");
         else showStyledMessage(this, QMessageBox::Warning, "失败", res.errorMessage);
-        emit dataChanged();
     }
 }
 
 // 压降计算（直接执行，无弹窗，但结果弹窗需应用样式）
 void DataSingleSheet::onPressureDropCalc() {
     DataCalculate calc;
+    const int columnsBefore = m_dataModel->columnCount();
     auto res = calc.calculatePressureDrop(m_dataModel, m_columnDefinitions);
+    recordAppendedColumns("压降计算", columnsBefore);
     if(res.success) showStyledMessage(this, QMessageBox::Information, "成功", "压降计算完成");
     else showStyledMessage(this, QMessageBox::Warning, "失败", res.errorMessage);
-    emit dataChanged();
 }
 
 // 井底流压计算弹窗
@@ -820,40 +948,99 @@ void DataSingleSheet::onCalcPwf() {
 
     if(d.exec() == QDialog::Accepted){
         auto cfg = d.getConfig();
+        const int columnsBefore = m_dataModel->columnCount();
         auto res = calc.calculateBottomHolePressure(m_dataModel, m_columnDefinitions, cfg);
+        recordAppendedColumns("井底流压计算", columnsBefore);
         if(res.success) showStyledMessage(this, QMessageBox::Information, "成功", "井底流压计算完成");
         else showStyledMessage(this, QMessageBox::Warning, "失败", res.errorMessage);
-        emit dataChanged();
     }
 }
 
-// 错误高亮检查
+// 表达式列弹窗
+void DataSingleSheet::onExpressionColumn() {
+    DataCalculate calc;
+    ExpressionColumnDialog d(getHeaderLabels(), this);
+    applySheetDialogStyle(&d); // 应用样式
+
+    if(d.exec() == QDialog::Accepted){
+        const int columnsBefore = m_dataModel->columnCount();
+        auto res = calc.calculateExpressionColumn(m_dataModel, m_columnDefinitions, d.getConfig());
+        recordAppendedColumns("表达式列", columnsBefore);
+        if(res.success) showStyledMessage(this, QMessageBox::Information, "成功",
+                                          QString("已生成 %1，有效数据 %2 行").arg(res.columnName).arg(res.processedRows));
+        else showStyledMessage(this, QMessageBox::Warning, "失败", res.errorMessage);
+    }
+}
+
+// 错误高亮检查：确认规则后并行检查，结果由委托绘制
 void DataSingleSheet::onHighlightErrors() {
-    // 清除原有背景色
-    for(int r=0; r<m_dataModel->rowCount(); ++r)
-        for(int c=0; c<m_dataModel->columnCount(); ++c)
-            if(auto it = m_dataModel->item(r,c)) it->setBackground(Qt::NoBrush);
-
-    // 查找压力列
-    int pIdx = -1;
-    for(int i=0; i<m_columnDefinitions.size(); ++i)
-        if(m_columnDefinitions[i].type == WellTestColumnType::Pressure) pIdx = i;
-
-    int err = 0;
-    if(pIdx != -1) {
-        for(int r=0; r<m_dataModel->rowCount(); ++r) {
-            auto item = m_dataModel->item(r, pIdx);
-            // 简单的逻辑检查：压力不能为负
-            if(item && item->text().toDouble() < 0) {
-                item->setBackground(QColor(255, 200, 200));
-                err++;
-            }
-        }
+    const QVector<ValidationRule> defaults = DataValidator::defaultRules(m_columnDefinitions);
+    ValidationRulesDialog d(getHeaderLabels(), m_validationRules.isEmpty() ? defaults : m_validationRules, defaults, this);
+    applySheetDialogStyle(&d); // 应用样式
+    if (d.exec() != QDialog::Accepted) return;
+    m_validationRules = d.rules();
+
+    // 清除旧版本写入的背景色
+    m_dataModel->clearBackgrounds();
+
+    QVector<int> counts;
+    m_validation = DataValidator::run(m_dataModel, m_validationRules, &counts);
+    ui->dataTableView->viewport()->update();
+
+    const QStringList headers = getHeaderLabels();
+    QStringList lines;
+    for (int i = 0; i < m_validationRules.size(); ++i) {
+        const ValidationRule& rule = m_validationRules[i];
+        if (!rule.enabled || counts[i] == 0) continue;
+        lines << QString("%1 — %2: %3 个").arg(headers.value(rule.column), ValidationRule::kindName(rule.kind)).arg(counts[i]);
     }
-    showStyledMessage(this, QMessageBox::Information, "检查完成", QString("发现 %1 个错误。").arg(err));
+    const int flagged = m_validation.flaggedCells();
+    QString text = QString("发现 %1 个异常单元格。").arg(flagged);
+    if (!lines.isEmpty()) text += "\n\n" + lines.join("\n");
+    showStyledMessage(this, QMessageBox::Information, "检查完成", text);
+}
+
+quint32 DataSingleSheet::validationMask(const QModelIndex& index) const
+{
+    if (m_validation.isEmpty() || !index.isValid()) return 0;
+    const QModelIndex source = m_proxyModel->mapToSource(index);
+    return source.isValid() ? m_validation.ruleMask(source.row(), source.column()) : 0;
 }
 
-void DataSingleSheet::onModelDataChanged() { emit dataChanged(); }
+// 单元格编辑 (index 为表格视图的索引)
+void DataSingleSheet::editCell(const QModelIndex& index, const QString& text)
+{
+    const QModelIndex source = m_proxyModel->mapToSource(index);
+    if (!source.isValid()) return;
+    const QString oldText = m_dataModel->text(source.row(), source.column());
+    if (oldText == text) return;
+    m_undoStack->push(new SetCellsCommand(m_dataModel, source.row(), source.column(), oldText, text));
+}
+
+// 计算流程在末尾新增的列记为一条可撤销命令 (逆操作为删除这些列)
+void DataSingleSheet::recordAppendedColumns(const QString& text, int columnsBefore)
+{
+    const int added = m_dataModel->columnCount() - columnsBefore;
+    if (added > 0) m_undoStack->push(new AddColumnsCommand(m_dataModel, &m_columnDefinitions, columnsBefore, added, text));
+}
+
+void DataSingleSheet::scheduleChangeNotification()
+{
+    if (m_loading || m_changeQueued) return;
+    m_changeQueued = true;
+    QTimer::singleShot(0, this, &DataSingleSheet::flushChanges);
+}
+
+void DataSingleSheet::flushChanges()
+{
+    m_changeQueued = false;
+    if (m_loading || m_pendingChanges.isEmpty()) return;
+    DataChangeSet changes = m_pendingChanges;
+    m_pendingChanges = DataChangeSet();
+    changes.version = ++m_changeVersion;
+    emit changesCommitted(changes);
+    emit dataChanged();
+}
 
 // 序列化保存数据到 JSON 对象
 QJsonObject DataSingleSheet::saveToJson() const {
@@ -890,18 +1077,76 @@ void DataSingleSheet::loadFromJson(const QJsonObject& jsonSheet) {
     deserializeRows(rows);
 }
 
+// 记录延迟加载的数据来源 (数据在首次显示时解压)
+void DataSingleSheet::loadFromStore(const QSharedPointer<ProjectTableStore>& store, int sheetIndex) {
+    m_restoringStore = true;
+    m_dataModel->clear();
+    m_columnDefinitions.clear();
+    const ProjectTableStore::SheetInfo info = store->sheetInfo(sheetIndex);
+    m_filePath = info.filePath;
+    setHeaderLabels(info.headers);
+    m_restoringStore = false;
+    attachStore(store, sheetIndex);
+    m_dataDeferred = true;
+}
+
+void DataSingleSheet::ensureDataLoaded() {
+    if (!m_dataDeferred) return;
+    m_dataDeferred = false;
+    if (m_store.isNull()) return;
+
+    ColumnarTableModel::RowBlock block;
+    if (!m_store->readSheet(m_storeIndex, &block)) { // 原因已输出到调试信息，表格保留表头
+        m_store.reset();
+        return;
+    }
+    m_restoringStore = true;
+    m_dataModel->beginLoad(block.rows);
+    m_dataModel->appendBlock(block);
+    m_dataModel->endLoad();
+    m_restoringStore = false;
+}
+
+// 导出整表供项目保存：自上次保存 (或打开) 以来未修改时直接取表格文件中的压缩块，不解压也不重新压缩
+ProjectTableStore::SheetData DataSingleSheet::saveToStore() {
+    ProjectTableStore::SheetData sheet;
+    sheet.filePath = m_filePath;
+    sheet.headers = getHeaderLabels();
+    if (!m_store.isNull() && m_store->readEncodedSheet(m_storeIndex, &sheet)) return sheet;
+
+    ensureDataLoaded();
+    sheet.block = m_dataModel->toBlock();
+    return sheet;
+}
+
+QStringList DataSingleSheet::getHeaderLabels() const {
+    QStringList headers;
+    for(int i=0; i<m_dataModel->columnCount(); ++i)
+        headers.append(m_dataModel->headerData(i, Qt::Horizontal).toString());
+    return headers;
+}
+
+void DataSingleSheet::attachStore(const QSharedPointer<ProjectTableStore>& store, int sheetIndex) {
+    m_store = store;
+    m_storeIndex = sheetIndex;
+}
+
+void DataSingleSheet::releaseStore() {
+    m_store.reset();
+}
+
+void DataSingleSheet::showEvent(QShowEvent *event) {
+    ensureDataLoaded();
+    QWidget::showEvent(event);
+}
+
 // 辅助：序列化所有行数据
 QJsonArray DataSingleSheet::serializeRows() const {
     QJsonArray a;
     for(int i=0; i<m_dataModel->rowCount(); ++i) {
         QJsonArray r;
         for(int j=0; j<m_dataModel->columnCount(); ++j) {
-            QStandardItem* item = m_dataModel->item(i, j);
-            if (item) {
-                r.append(item->text());
-            } else {
-                r.append(""); // 单元格为空时，存入空字符串
-            }
+            r.append(m_dataModel->text(i, j)); // 单元格为空时为空字符串
         }
         a.append(r);
     }
@@ -910,10 +1155,12 @@ QJsonArray DataSingleSheet::serializeRows() const {
 
 // 辅助：反序列化数据到行
 void DataSingleSheet::deserializeRows(const QJsonArray& array) {
+    m_dataModel->beginLoad(array.size());
     for(auto val : array) {
         QJsonArray r = val.toArray();
-        QList<QStandardItem*> l;
-        for(auto v : r) l.append(new QStandardItem(v.toString()));
+        QStringList l;
+        for(auto v : r) l.append(v.toString());
         m_dataModel->appendRow(l);
     }
+    m_dataModel->endLoad();
 }
@@ -2,24 +2,43 @@
  * 文件名: datasinglesheet.h
  * 文件作用: 单个数据表页签类头文件
  * 功能描述:
- * 1. 管理单个数据文件的显示(QTableView)和数据模型(QStandardItemModel)。
+ * 1. 管理单个数据文件的显示(QTableView)和数据模型(按列存储的 ColumnarTableModel)。
  * 2. 处理该页签内的数据加载、计算、列属性定义、右键菜单操作。
  * 3. [新增] 支持 Ctrl+滚轮 缩放表格。
  * 4. 提供数据的序列化(JSON)和反序列化接口。
+ * 5. [后台加载] loadDataAsync 在后台线程读取文件，数据分批追加到表格，页签内显示进度条与取消按钮，结束时发出一次 loadFinished。
+ * 6. [二进制表格] saveToStore / loadFromStore 对应项目的 _date.bin；loadFromStore 只设置表头，
+ *    数据在页签首次显示或 ensureDataLoaded 时才从文件解压。
+ * 7. [增量保存] 记录本表是否与表格文件一致，未修改的表 (包括从未显示过的表) 保存时不解压、不重新压缩。
+ * 8. [自动备份] revision 标识表格内容的版本，ProjectAutoSaver 据此只为修改过的表取快照。
+ * 9. [后台过滤] 表格经 SheetFilterProxy 显示，过滤 (文本与数值范围条件) 与排序在后台线程进行。
+ * 10. [变更合并] changesCommitted 每个事件循环周期最多发出一次，携带合并后的 DataChangeSet。
+ * 11. [撤销] 编辑与行列操作经 SheetUndoStack (按内存预算淘汰最旧命令) 可撤销；单元格编辑由 editCell 入栈。
+ * 12. [数据检查] onHighlightErrors 按可配置的规则 (DataValidator) 并行检查，结果以位图 (ValidationOverlay) 保存，
+ *    由 NoContextMenuDelegate 绘制底色与提示。
  */
 
 #ifndef DATASINGLESHEET_H
 #define DATASINGLESHEET_H
 
 #include <QWidget>
-#include <QStandardItemModel>
-#include <QSortFilterProxyModel>
-#include <QUndoStack>
 #include <QStyledItemDelegate>
 #include <QMenu>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QFuture>
+#include <QSharedPointer>
 #include "dataimportdialog.h"
+#include "columnartablemodel.h"
+#include "cancellationtoken.h"
+#include "projecttablestore.h"
+#include "sheetfilterproxy.h"
+#include "datachangeset.h"
+#include "datavalidator.h"
+
+class QProgressBar;
+class QLabel;
+class SheetUndoStack;
 
 enum class WellTestColumnType {
     SerialNumber, Date, Time, TimeOfDay, Pressure, CasingPressure, BottomHolePressure,
@@ -48,6 +67,11 @@ public:
     explicit NoContextMenuDelegate(QObject *parent = nullptr) : QStyledItemDelegate(parent) {}
     QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
                           const QModelIndex &index) const override;
+    void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const override;
+    // 数据检查命中的单元格绘制底色，悬停提示命中的规则
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option,
+                   const QModelIndex &index) override;
 };
 
 class DataSingleSheet : public QWidget
@@ -59,17 +83,46 @@ public:
     ~DataSingleSheet();
 
     bool loadData(const QString& filePath, const DataImportSettings& settings);
+    // 后台加载：立即返回，读取的数据分批追加到表格，完成、失败或取消时发出 loadFinished
+    // (.xls 经 COM 自动化读取，仍在界面线程同步完成)
+    void loadDataAsync(const QString& filePath, const DataImportSettings& settings);
+    void cancelLoad();
+    bool isLoading() const { return m_loading; }
     void loadFromJson(const QJsonObject& jsonSheet);
     QJsonObject saveToJson() const;
+    // 延迟加载：记录数据所在的表格文件与序号，只设置文件路径与表头
+    void loadFromStore(const QSharedPointer<ProjectTableStore>& store, int sheetIndex);
+    // 解压尚未加载的数据
+    void ensureDataLoaded();
+    bool hasDeferredData() const { return m_dataDeferred; }
+    // 项目保存：未修改时给出表格文件中的压缩块，否则给出整表数据
+    ProjectTableStore::SheetData saveToStore();
+    // 保存前释放对旧表格文件的引用，保存后关联新文件中的序号 (本表此时与文件一致)
+    void releaseStore();
+    void attachStore(const QSharedPointer<ProjectTableStore>& store, int sheetIndex);
+    // 与表格文件一致时为其序号，否则为 -1
+    int storeIndex() const { return m_store.isNull() ? -1 : m_storeIndex; }
+    // 内容修订号：每次修改取新的全局唯一值，供自动备份判断本表自上次备份以来是否改变
+    quint64 revision() const { return m_revision; }
+    QStringList getHeaderLabels() const;
 
     QString getFilePath() const { return m_filePath; }
     void setFilePath(const QString& path) { m_filePath = path; }
-    QStandardItemModel* getDataModel() const { return m_dataModel; }
+    ColumnarTableModel* getDataModel() const { return m_dataModel; }
+    // 过滤条件 (见 SheetFilterProxy)，输入停止 250 ms 后在后台生效
     void setFilterText(const QString& text);
+    // 可撤销地写入单元格 (index 为表格视图的索引)
+    void editCell(const QModelIndex& index, const QString& text);
+    SheetUndoStack* undoStack() const { return m_undoStack; }
+    QString filterText() const { return m_proxyModel->filterText(); }
+    // 数据检查命中的规则类别 (第 k 位对应 ValidationRule::Kind k；index 为表格视图的索引)
+    quint32 validationMask(const QModelIndex& index) const;
 
 protected:
     // 事件过滤器，用于处理 Ctrl+滚轮 缩放
     bool eventFilter(QObject *obj, QEvent *event) override;
+    // 首次显示时加载延迟的数据
+    void showEvent(QShowEvent *event) override;
 
 public slots:
     void onExportExcel();
@@ -77,6 +130,7 @@ public slots:
     void onTimeConvert();
     void onPressureDropCalc();
     void onCalcPwf();
+    void onExpressionColumn();
     void onHighlightErrors();
 
     void onCustomContextMenu(const QPoint& pos);
@@ -96,26 +150,60 @@ public slots:
     void onShowAllCols();
 
 signals:
+    // 合并后的修改通知 (每个事件循环周期最多一次)；dataChanged 随之发出
+    void changesCommitted(const DataChangeSet& changes);
     void dataChanged();
+    void loadFinished(bool success);
 
 private slots:
-    void onModelDataChanged();
+    void flushChanges();
 
 private:
     Ui::DataSingleSheet *ui;
 
-    QStandardItemModel* m_dataModel;
-    QSortFilterProxyModel* m_proxyModel;
-    QUndoStack* m_undoStack;
+    ColumnarTableModel* m_dataModel;
+    SheetFilterProxy* m_proxyModel;
+    SheetUndoStack* m_undoStack;
 
     QString m_filePath;
     QList<ColumnDefinition> m_columnDefinitions;
 
+    // 后台加载状态
+    QFuture<void> m_loadFuture;
+    CancellationToken m_loadCancel;
+    bool m_loading = false;
+    QWidget* m_loadBar = nullptr;
+    QProgressBar* m_loadProgress = nullptr;
+    QLabel* m_loadLabel = nullptr;
+
+    // 与本表内容一致的表格文件 (修改后清空)；m_dataDeferred 表示数据尚未从中解压
+    QSharedPointer<ProjectTableStore> m_store;
+    int m_storeIndex = -1;
+    bool m_dataDeferred = false;
+    bool m_restoringStore = false;
+    quint64 m_revision = 0;
+
+    // 本周期内尚未通知的修改
+    DataChangeSet m_pendingChanges;
+    quint64 m_changeVersion = 0;
+    bool m_changeQueued = false;
+
+    // 数据检查规则 (首次检查时按列定义生成) 与结果位图 (按原始行号；行列结构变化时清除)
+    QVector<ValidationRule> m_validationRules;
+    ValidationOverlay m_validation;
+
     void initUI();
     void setupModel();
+    void scheduleChangeNotification();
+    void recordAppendedColumns(const QString& text, int columnsBefore);
 
     bool loadExcelFile(const QString& path, const DataImportSettings& settings);
     bool loadTextFile(const QString& path, const DataImportSettings& settings);
+    void setHeaderLabels(const QStringList& labels);
+    // 后台加载回调 (界面线程)
+    void appendLoadedBlock(const ColumnarTableModel::RowBlock& block, const QStringList& header,
+                           qint64 bytesRead, qint64 bytesTotal);
+    void finishLoad(bool success, const QString& errorMessage);
 
     QJsonArray serializeRows() const;
     void deserializeRows(const QJsonArray& array);
@@ -0,0 +1,499 @@
+/*
+ * datavalidator.cpp
+ * 文件作用: 数据表质量检查 (规则校验) 实现文件
+ * 功能描述:
+ * 1. 默认规则：时间列检查单调、重复与间隔；压力类列检查非负与尖峰；温度检查范围与尖峰；其余物性列检查非负。
+ * 2. 并行执行：每条规则的行按 65536 行 (64 的整数倍) 分段，在线程池中执行，各段写入的位图字互不重叠，无需加锁；
+ *    依赖前一行的规则 (单调、重复、间隔) 在段首向前查找最近的有效值。
+ * 3. 尖峰检查以窗口内的中位数与中位绝对偏差 (MAD) 估计局部离散程度，并以整列相邻差值的中位数为下限，
+ *    避免平稳段或量化读数 (MAD 为 0) 把微小波动判为尖峰。
+ * 4. 实现检查规则设置对话框。
+ */
+
+#include "datavalidator.h"
+#include "datasinglesheet.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QComboBox>
+#include <QTableWidget>
+#include <QtConcurrent>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace {
+
+const int ChunkRows = 65536; // 64 的整数倍：各段的位图字互不重叠
+
+struct ValidationTask {
+    int rule;
+    int begin;
+    int end;
+};
+
+struct RuleContext {
+    ValidationRule rule;
+    ColumnarTableModel::ColumnSpan span;
+    double step = 0.0; // Gap: 中位间隔；Spike: 离散程度下限
+    QVector<quint64>* bits = nullptr;
+};
+
+inline void setBit(QVector<quint64>& bits, int row)
+{
+    bits[row >> 6] |= quint64(1) << (row & 63);
+}
+
+// 相邻有效值之差的中位数 (absolute 为 false 时只统计正差值，为 true 时统计非零差值的绝对值)
+double medianStep(const ColumnarTableModel::ColumnSpan& span, bool absolute)
+{
+    std::vector<double> steps;
+    steps.reserve(span.size);
+    double previous = std::numeric_limits<double>::quiet_NaN();
+    for (int r = 0; r < span.size; ++r) {
+        const double v = span[r];
+        if (std::isnan(v)) continue;
+        if (!std::isnan(previous)) {
+            const double d = absolute ? std::fabs(v - previous) : v - previous;
+            if (d > 0) steps.push_back(d);
+        }
+        previous = v;
+    }
+    if (steps.empty()) return 0.0;
+    auto mid = steps.begin() + steps.size() / 2;
+    std::nth_element(steps.begin(), mid, steps.end());
+    return *mid;
+}
+
+// 段首之前最近的有效值
+double previousValid(const ColumnarTableModel::ColumnSpan& span, int row)
+{
+    for (int r = row - 1; r >= 0; --r)
+        if (!std::isnan(span[r])) return span[r];
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+void runTask(const RuleContext& ctx, int begin, int end)
+{
+    const ValidationRule& rule = ctx.rule;
+    const ColumnarTableModel::ColumnSpan& span = ctx.span;
+    QVector<quint64>& bits = *ctx.bits;
+
+    switch (rule.kind) {
+    case ValidationRule::Range:
+        for (int r = begin; r < end; ++r) {
+            const double v = span[r];
+            if (!std::isnan(v) && (v < rule.minimum || v > rule.maximum)) setBit(bits, r);
+        }
+        break;
+    case ValidationRule::Monotonic:
+    case ValidationRule::Duplicate:
+    case ValidationRule::Gap: {
+        if (rule.kind == ValidationRule::Gap && !(ctx.step > 0)) break;
+        const double maxStep = rule.gapFactor * ctx.step;
+        double previous = previousValid(span, begin);
+        for (int r = begin; r < end; ++r) {
+            const double v = span[r];
+            if (std::isnan(v)) continue;
+            if (!std::isnan(previous)) {
+                const bool flagged = rule.kind == ValidationRule::Monotonic ? v < previous
+                                   : rule.kind == ValidationRule::Duplicate ? v == previous
+                                   : v - previous > maxStep;
+                if (flagged) setBit(bits, r);
+            }
+            previous = v;
+        }
+        break;
+    }
+    case ValidationRule::Spike: {
+        const int half = qMax(1, rule.window / 2);
+        std::vector<double> window;
+        std::vector<double> deviations;
+        window.reserve(2 * half + 1);
+        deviations.reserve(2 * half + 1);
+        for (int r = begin; r < end; ++r) {
+            const double v = span[r];
+            if (std::isnan(v)) continue;
+            window.clear();
+            const int lo = qMax(0, r - half);
+            const int hi = qMin(span.size - 1, r + half);
+            for (int i = lo; i <= hi; ++i)
+                if (!std::isnan(span[i])) window.push_back(span[i]);
+            if (window.size() < 3) continue;
+
+            auto mid = window.begin() + window.size() / 2;
+            std::nth_element(window.begin(), mid, window.end());
+            const double median = *mid;
+            deviations.clear();
+            for (double w : window) deviations.push_back(std::fabs(w - median));
+            auto madMid = deviations.begin() + deviations.size() / 2;
+            std::nth_element(deviations.begin(), madMid, deviations.end());
+            const double sigma = qMax(1.4826 * *madMid, ctx.step);
+            if (sigma > 0 && std::fabs(v - median) > rule.threshold * sigma) setBit(bits, r);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+int popCount(const QVector<quint64>& bits)
+{
+    int count = 0;
+    for (quint64 word : bits) count += qPopulationCount(word);
+    return count;
+}
+
+QString formatParameter(double value)
+{
+    return std::isfinite(value) ? QString::number(value, 'g', 10) : QString();
+}
+
+double parseParameter(const QString& text, double fallback)
+{
+    bool ok = false;
+    const double value = text.trimmed().toDouble(&ok);
+    return ok ? value : fallback;
+}
+
+} // namespace
+
+QString ValidationRule::kindName(Kind kind)
+{
+    switch (kind) {
+    case Range: return "数值范围";
+    case Monotonic: return "时间倒退";
+    case Spike: return "尖峰";
+    case Gap: return "间隔过大";
+    case Duplicate: return "重复值";
+    default: return QString();
+    }
+}
+
+// ============================================================================
+// ValidationOverlay
+// ============================================================================
+
+quint32 ValidationOverlay::ruleMask(int row, int column) const
+{
+    auto it = m_columns.constFind(column);
+    if (it == m_columns.constEnd() || row < 0) return 0;
+    const int word = row >> 6;
+    const quint64 bit = quint64(1) << (row & 63);
+    quint32 mask = 0;
+    for (int k = 0; k < it->size(); ++k) {
+        const Bits& bits = it->at(k);
+        if (word < bits.size() && (bits[word] & bit)) mask |= 1u << k;
+    }
+    return mask;
+}
+
+int ValidationOverlay::flaggedCells() const
+{
+    int count = 0;
+    for (auto it = m_columns.constBegin(); it != m_columns.constEnd(); ++it) {
+        int words = 0;
+        for (const Bits& bits : *it) words = qMax(words, bits.size());
+        for (int w = 0; w < words; ++w) {
+            quint64 merged = 0;
+            for (const Bits& bits : *it)
+                if (w < bits.size()) merged |= bits[w];
+            count += qPopulationCount(merged);
+        }
+    }
+    return count;
+}
+
+// ============================================================================
+// DataValidator
+// ============================================================================
+
+QVector<ValidationRule> DataValidator::defaultRules(const QList<ColumnDefinition>& definitions)
+{
+    QVector<ValidationRule> rules;
+    auto add = [&rules](int column, ValidationRule::Kind kind) -> ValidationRule& {
+        ValidationRule rule;
+        rule.kind = kind;
+        rule.column = column;
+        rules.append(rule);
+        return rules.last();
+    };
+
+    for (int i = 0; i < definitions.size(); ++i) {
+        switch (definitions[i].type) {
+        case WellTestColumnType::Time:
+            add(i, ValidationRule::Monotonic);
+            add(i, ValidationRule::Duplicate);
+            add(i, ValidationRule::Gap);
+            break;
+        case WellTestColumnType::Pressure:
+        case WellTestColumnType::CasingPressure:
+        case WellTestColumnType::BottomHolePressure:
+            add(i, ValidationRule::Range).minimum = 0.0;
+            add(i, ValidationRule::Spike);
+            break;
+        case WellTestColumnType::PressureDrop:
+            add(i, ValidationRule::Spike);
+            break;
+        case WellTestColumnType::Temperature: {
+            ValidationRule& range = add(i, ValidationRule::Range);
+            range.minimum = -50.0;
+            range.maximum = 350.0;
+            add(i, ValidationRule::Spike);
+            break;
+        }
+        case WellTestColumnType::FlowRate:
+        case WellTestColumnType::Depth:
+        case WellTestColumnType::Distance:
+        case WellTestColumnType::Viscosity:
+        case WellTestColumnType::Density:
+        case WellTestColumnType::Permeability:
+        case WellTestColumnType::WellRadius:
+        case WellTestColumnType::Volume:
+            add(i, ValidationRule::Range).minimum = 0.0;
+            break;
+        case WellTestColumnType::Porosity: {
+            ValidationRule& range = add(i, ValidationRule::Range);
+            range.minimum = 0.0;
+            range.maximum = 100.0;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return rules;
+}
+
+ValidationOverlay DataValidator::run(const ColumnarTableModel* model, const QVector<ValidationRule>& rules,
+                                     QVector<int>* counts)
+{
+    ValidationOverlay overlay;
+    if (counts) counts->fill(0, rules.size());
+    if (!model) return overlay;
+
+    const int rows = model->rowCount();
+    const int columns = model->columnCount();
+    const int words = (rows + 63) / 64;
+
+    // 每条规则一份位图；间隔与尖峰所需的整列统计量先串行求出
+    QVector<QVector<quint64>> ruleBits(rules.size());
+    QVector<RuleContext> contexts(rules.size());
+    QVector<ValidationTask> tasks;
+    for (int i = 0; i < rules.size(); ++i) {
+        const ValidationRule& rule = rules[i];
+        if (!rule.enabled || rule.column < 0 || rule.column >= columns || rows == 0) continue;
+        if (rule.kind < 0 || rule.kind >= ValidationRule::KindCount) continue;
+
+        RuleContext& ctx = contexts[i];
+        ctx.rule = rule;
+        ctx.span = model->columnSpan(rule.column);
+        ruleBits[i].fill(0, words);
+        ctx.bits = &ruleBits[i];
+        if (rule.kind == ValidationRule::Gap) ctx.step = medianStep(ctx.span, false);
+        else if (rule.kind == ValidationRule::Spike) ctx.step = medianStep(ctx.span, true);
+
+        for (int begin = 0; begin < ctx.span.size; begin += ChunkRows)
+            tasks.append({i, begin, qMin(ctx.span.size, begin + ChunkRows)});
+    }
+
+    QtConcurrent::blockingMap(tasks, [&contexts](const ValidationTask& task) {
+        runTask(contexts[task.rule], task.begin, task.end);
+    });
+
+    // 合并为每列、每类规则的位图
+    for (int i = 0; i < rules.size(); ++i) {
+        if (!contexts[i].bits) continue;
+        const QVector<quint64>& bits = ruleBits[i];
+        if (counts) (*counts)[i] = popCount(bits);
+
+        QVector<ValidationOverlay::Bits>& kinds = overlay.m_columns[rules[i].column];
+        if (kinds.isEmpty()) kinds.resize(ValidationRule::KindCount);
+        ValidationOverlay::Bits& target = kinds[rules[i].kind];
+        if (target.isEmpty()) {
+            target = bits;
+        } else {
+            for (int w = 0; w < words; ++w) target[w] |= bits[w];
+        }
+    }
+    return overlay;
+}
+
+// ============================================================================
+// ValidationRulesDialog 实现
+// ============================================================================
+
+ValidationRulesDialog::ValidationRulesDialog(const QStringList& columnNames, const QVector<ValidationRule>& rules,
+                                             const QVector<ValidationRule>& defaults, QWidget* parent)
+    : QDialog(parent), m_columnNames(columnNames), m_defaults(defaults)
+{
+    setWindowTitle("数据检查规则");
+    resize(640, 420);
+    setStyleSheet("QDialog { background-color: white; color: black; font-family: \"Microsoft YaHei\", Arial; } "
+                  "QLabel { color: black; background: transparent; font-weight: normal;} "
+                  "QTableWidget { background-color: white; color: black; border: 1px solid #ccc; gridline-color: #e0e0e0; } "
+                  "QHeaderView::section { background-color: #f2f2f2; color: black; border: 1px solid #ddd; padding: 3px; } "
+                  "QComboBox { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QPushButton { color: white; background-color: #4a90e2; border: none; border-radius: 4px; padding: 6px 12px; } "
+                  "QPushButton:hover { background-color: #357abd; }");
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QLabel* labelHelp = new QLabel("参数说明: 数值范围 — 参数1 为下限、参数2 为上限 (留空表示不限)；"
+                                   "尖峰 — 参数1 为窗口行数、参数2 为稳健标准差的倍数；"
+                                   "间隔过大 — 参数1 为中位间隔的倍数；时间倒退与重复值无参数。");
+    labelHelp->setWordWrap(true);
+    mainLayout->addWidget(labelHelp);
+
+    m_table = new QTableWidget(0, 5);
+    m_table->setHorizontalHeaderLabels({"启用", "列", "规则", "参数1", "参数2"});
+    m_table->verticalHeader()->setVisible(false);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    m_table->setColumnWidth(0, 50);
+    m_table->setColumnWidth(2, 100);
+    mainLayout->addWidget(m_table);
+
+    // 底部按钮
+    QHBoxLayout* btnLayout = new QHBoxLayout;
+    QPushButton* btnAdd = new QPushButton("添加规则");
+    QPushButton* btnRemove = new QPushButton("删除规则");
+    QPushButton* btnDefaults = new QPushButton("恢复默认");
+    QPushButton* btnOk = new QPushButton("开始检查");
+    QPushButton* btnCancel = new QPushButton("取消");
+    btnOk->setStyleSheet("background-color: #28a745; color: white;");
+    btnCancel->setStyleSheet("background-color: #6c757d; color: white;");
+    btnLayout->addWidget(btnAdd);
+    btnLayout->addWidget(btnRemove);
+    btnLayout->addWidget(btnDefaults);
+    btnLayout->addStretch();
+    btnLayout->addWidget(btnOk);
+    btnLayout->addWidget(btnCancel);
+    mainLayout->addLayout(btnLayout);
+
+    connect(btnAdd, &QPushButton::clicked, this, &ValidationRulesDialog::onAddRule);
+    connect(btnRemove, &QPushButton::clicked, this, &ValidationRulesDialog::onRemoveRule);
+    connect(btnDefaults, &QPushButton::clicked, this, &ValidationRulesDialog::onRestoreDefaults);
+    connect(btnOk, &QPushButton::clicked, this, &QDialog::accept);
+    connect(btnCancel, &QPushButton::clicked, this, &QDialog::reject);
+
+    setRules(rules);
+}
+
+void ValidationRulesDialog::setRules(const QVector<ValidationRule>& rules)
+{
+    m_table->setRowCount(0);
+    for (const ValidationRule& rule : rules)
+        if (rule.column >= 0 && rule.column < m_columnNames.size()) addRow(rule);
+}
+
+void ValidationRulesDialog::addRow(const ValidationRule& rule)
+{
+    const int row = m_table->rowCount();
+    m_table->insertRow(row);
+
+    QTableWidgetItem* enabledItem = new QTableWidgetItem;
+    enabledItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable | Qt::ItemIsSelectable);
+    enabledItem->setCheckState(rule.enabled ? Qt::Checked : Qt::Unchecked);
+    m_table->setItem(row, 0, enabledItem);
+
+    QComboBox* comboColumn = new QComboBox;
+    for (int i = 0; i < m_columnNames.size(); ++i) comboColumn->addItem(m_columnNames[i], i);
+    comboColumn->setCurrentIndex(qBound(0, rule.column, m_columnNames.size() - 1));
+    m_table->setCellWidget(row, 1, comboColumn);
+
+    QComboBox* comboKind = new QComboBox;
+    for (int k = 0; k < ValidationRule::KindCount; ++k)
+        comboKind->addItem(ValidationRule::kindName(ValidationRule::Kind(k)), k);
+    comboKind->setCurrentIndex(rule.kind);
+    m_table->setCellWidget(row, 2, comboKind);
+
+    QTableWidgetItem* param1 = new QTableWidgetItem;
+    QTableWidgetItem* param2 = new QTableWidgetItem;
+    m_table->setItem(row, 3, param1);
+    m_table->setItem(row, 4, param2);
+
+    // 按规则类别填入参数 (切换类别时填入该类别的默认参数)
+    auto fillParameters = [param1, param2](const ValidationRule& r) {
+        QString p1, p2;
+        switch (r.kind) {
+        case ValidationRule::Range: p1 = formatParameter(r.minimum); p2 = formatParameter(r.maximum); break;
+        case ValidationRule::Spike: p1 = QString::number(r.window); p2 = formatParameter(r.threshold); break;
+        case ValidationRule::Gap: p1 = formatParameter(r.gapFactor); break;
+        default: break;
+        }
+        const bool hasSecond = r.kind == ValidationRule::Range || r.kind == ValidationRule::Spike;
+        const bool hasFirst = hasSecond || r.kind == ValidationRule::Gap;
+        param1->setText(p1);
+        param2->setText(p2);
+        param1->setFlags(hasFirst ? (Qt::ItemIsEnabled | Qt::ItemIsEditable | Qt::ItemIsSelectable) : Qt::ItemIsSelectable);
+        param2->setFlags(hasSecond ? (Qt::ItemIsEnabled | Qt::ItemIsEditable | Qt::ItemIsSelectable) : Qt::ItemIsSelectable);
+    };
+    fillParameters(rule);
+    connect(comboKind, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [fillParameters](int index) {
+        ValidationRule r;
+        r.kind = ValidationRule::Kind(index);
+        fillParameters(r);
+    });
+}
+
+QVector<ValidationRule> ValidationRulesDialog::rules() const
+{
+    QVector<ValidationRule> result;
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        auto* comboColumn = qobject_cast<QComboBox*>(m_table->cellWidget(row, 1));
+        auto* comboKind = qobject_cast<QComboBox*>(m_table->cellWidget(row, 2));
+        if (!comboColumn || !comboKind) continue;
+
+        ValidationRule rule;
+        rule.enabled = m_table->item(row, 0)->checkState() == Qt::Checked;
+        rule.column = comboColumn->currentData().toInt();
+        rule.kind = ValidationRule::Kind(comboKind->currentData().toInt());
+        const QString p1 = m_table->item(row, 3)->text();
+        const QString p2 = m_table->item(row, 4)->text();
+        switch (rule.kind) {
+        case ValidationRule::Range:
+            rule.minimum = parseParameter(p1, rule.minimum);
+            rule.maximum = parseParameter(p2, rule.maximum);
+            break;
+        case ValidationRule::Spike:
+            rule.window = qBound(3, int(parseParameter(p1, rule.window)), 1001) | 1;
+            rule.threshold = qMax(0.1, parseParameter(p2, rule.threshold));
+            break;
+        case ValidationRule::Gap:
+            rule.gapFactor = qMax(1.0, parseParameter(p1, rule.gapFactor));
+            break;
+        default:
+            break;
+        }
+        result.append(rule);
+    }
+    return result;
+}
+
+void ValidationRulesDialog::onAddRule()
+{
+    if (m_columnNames.isEmpty()) return;
+    ValidationRule rule;
+    rule.column = 0;
+    addRow(rule);
+}
+
+void ValidationRulesDialog::onRemoveRule()
+{
+    QList<int> rows;
+    for (const QModelIndex& index : m_table->selectionModel()->selectedRows()) rows.append(index.row());
+    if (rows.isEmpty() && m_table->currentRow() >= 0) rows.append(m_table->currentRow());
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    for (int row : rows) m_table->removeRow(row);
+}
+
+void ValidationRulesDialog::onRestoreDefaults()
+{
+    setRules(m_defaults);
+}
@@ -0,0 +1,102 @@
+/*
+ * datavalidator.h
+ * 文件作用: 数据表质量检查 (规则校验) 头文件
+ * 功能描述:
+ * 1. ValidationRule 描述一条检查规则：数值范围、时间单调、相对滚动中位数的尖峰、时间间隔过大、时间重复。
+ *    defaultRules 按列定义的类型 (WellTestColumnType) 给出默认规则，ValidationRulesDialog 中可增删与修改参数。
+ * 2. DataValidator::run 把每条规则按 64 的整数倍行数分段，在线程池中并行扫描数值列 (columnSpan，不经文本)，
+ *    每段只写自己的位图字，结果合并为 ValidationOverlay。
+ * 3. ValidationOverlay 为每列、每类规则一份位图 (每格 1 位)，由表格的委托绘制底色与提示，不再对每个异常单元格写背景色。
+ */
+
+#ifndef DATAVALIDATOR_H
+#define DATAVALIDATOR_H
+
+#include <QDialog>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include <limits>
+#include "columnartablemodel.h"
+
+class QTableWidget;
+struct ColumnDefinition;
+
+struct ValidationRule {
+    enum Kind {
+        Range = 0,     // 数值超出 [minimum, maximum]
+        Monotonic = 1, // 小于前一个有效值 (时间倒退)
+        Spike = 2,     // 与滚动中位数之差超过 threshold 倍的稳健标准差 (1.4826 × MAD)
+        Gap = 3,       // 与前一个有效值之差超过 gapFactor 倍的中位间隔
+        Duplicate = 4, // 与前一个有效值相同
+        KindCount = 5
+    };
+
+    Kind kind = Range;
+    int column = -1;
+    bool enabled = true;
+    double minimum = -std::numeric_limits<double>::infinity();
+    double maximum = std::numeric_limits<double>::infinity();
+    int window = 11;        // Spike: 窗口行数 (奇数)
+    double threshold = 5.0; // Spike: 稳健标准差的倍数
+    double gapFactor = 10.0; // Gap: 中位间隔的倍数
+
+    static QString kindName(Kind kind);
+};
+
+// 检查结果位图
+class ValidationOverlay
+{
+public:
+    bool isEmpty() const { return m_columns.isEmpty(); }
+    void clear() { m_columns.clear(); }
+
+    // 单元格命中的规则类别 (第 k 位对应 ValidationRule::Kind k)
+    quint32 ruleMask(int row, int column) const;
+    bool isFlagged(int row, int column) const { return ruleMask(row, column) != 0; }
+    // 命中任一规则的单元格数
+    int flaggedCells() const;
+
+private:
+    friend class DataValidator;
+    typedef QVector<quint64> Bits;
+    QHash<int, QVector<Bits>> m_columns; // 列 -> 各类规则的位图 (未使用的类别为空)
+};
+
+class DataValidator
+{
+public:
+    // 按列类型的默认规则
+    static QVector<ValidationRule> defaultRules(const QList<ColumnDefinition>& definitions);
+
+    // 并行执行全部启用的规则；counts 为每条规则命中的单元格数 (与 rules 对应)
+    static ValidationOverlay run(const ColumnarTableModel* model, const QVector<ValidationRule>& rules,
+                                 QVector<int>* counts = nullptr);
+};
+
+// ============================================================================
+// 检查规则设置对话框
+// ============================================================================
+class ValidationRulesDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    ValidationRulesDialog(const QStringList& columnNames, const QVector<ValidationRule>& rules,
+                          const QVector<ValidationRule>& defaults, QWidget* parent = nullptr);
+    QVector<ValidationRule> rules() const;
+
+private slots:
+    void onAddRule();
+    void onRemoveRule();
+    void onRestoreDefaults();
+
+private:
+    void addRow(const ValidationRule& rule);
+    void setRules(const QVector<ValidationRule>& rules);
+
+    QStringList m_columnNames;
+    QVector<ValidationRule> m_defaults;
+    QTableWidget* m_table;
+};
+
+#endif // DATAVALIDATOR_H
@@ -0,0 +1,401 @@
+/*
+ * deconvolution.cpp
+ * 文件作用: 压力-产量反褶积实现文件
+ * 功能描述:
+ * 1. 观测数据分箱压缩：按时间顺序单遍扫描，(产量阶段, 对数时间差) 相同的相邻点合并为平均值；
+ *    点数超限时依次降低每个对数周期的分箱数，再增大箱的最小时间跨度，直至不超过上限。
+ * 2. 单位响应参数化：g(σ_0) = e^{z_0}，第 k 段积分 I_k = h·e^{z_k}·φ(z_{k+1} - z_k)，
+ *    φ(x) = (e^x - 1)/x，φ'(x) = (e^x(x - 1) + 1)/x² (小 x 时取级数)。
+ * 3. 每个观测点的叠加项在迭代前一次性换算为 (节点段, 段内位置, 产量增量)，迭代中只做 O(1) 查表；
+ *    各项对累计积分 C_i 的依赖按后缀和归并，雅可比行的计算量与节点数成正比。
+ * 4. 法方程 (节点数 + 1 维) 由 Eigen LDLT 求解，Levenberg-Marquardt 阻尼保证目标函数单调下降。
+ */
+
+#include "deconvolution.h"
+
+#include <Eigen/Dense>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 最短时间差相对最长时间差的下限 (6 个对数周期)
+const double kMinLagRatio = 1e-6;
+
+// 分箱压缩时每个对数周期的箱数 (依次尝试)
+const double kBinsPerDecade[] = { 10.0, 5.0, 2.0, 1.0 };
+
+// φ(x) = (e^x - 1)/x 及其导数 ψ(x) = φ'(x)
+inline double phi(double x)
+{
+    if (std::abs(x) < 1e-3) return 1.0 + x * (0.5 + x * (1.0 / 6.0 + x / 24.0));
+    return std::expm1(x) / x;
+}
+
+inline double psi(double x)
+{
+    if (std::abs(x) < 1e-3) return 0.5 + x * (1.0 / 3.0 + x * (0.125 + x / 30.0));
+    return (std::exp(x) * (x - 1.0) + 1.0) / (x * x);
+}
+
+// 按 (产量阶段, 对数时间差) 分箱压缩；箱数超过 limit 时返回 false (结果不完整)
+bool compressObservations(const QVector<double>& t, const QVector<double>& p, const QVector<int>& order,
+                          const QVector<double>& start, double binsPerDecade, double minWidth, int limit,
+                          QVector<double>& outT, QVector<double>& outP)
+{
+    outT.clear();
+    outP.clear();
+    const double scale = binsPerDecade / std::log(10.0);
+    const int steps = start.size();
+
+    int j = -1;
+    int binPeriod = -2;
+    long long binLog = 0;
+    double binStart = 0.0, sumT = 0.0, sumP = 0.0;
+    int count = 0;
+    for (int idx : order) {
+        const double tk = t[idx];
+        while (j + 1 < steps && start[j + 1] < tk) ++j;
+        const long long logIndex = j < 0 ? 0 : (long long)std::floor(std::log(tk - start[j]) * scale);
+
+        const bool sameBin = (count > 0) && j == binPeriod
+                             && (logIndex == binLog || tk - binStart < minWidth);
+        if (!sameBin) {
+            if (count > 0) {
+                if (outT.size() >= limit) return false;
+                outT.append(sumT / count);
+                outP.append(sumP / count);
+            }
+            binPeriod = j;
+            binLog = logIndex;
+            binStart = tk;
+            sumT = sumP = 0.0;
+            count = 0;
+        }
+        sumT += tk;
+        sumP += p[idx];
+        ++count;
+    }
+    if (count > 0) {
+        if (outT.size() >= limit) return false;
+        outT.append(sumT / count);
+        outP.append(sumP / count);
+    }
+    return true;
+}
+
+// 单个叠加项：segment = -1 表示首节点之前 (value 为 e^{σ-σ_0})，segment = M-1 表示末节点之后
+// (value 为 σ - σ_{M-1})，其余为节点段序号 (value 为段内相对位置 u ∈ [0, 1))
+struct Term {
+    int segment;
+    double value;
+    double deltaRate;
+};
+
+// 当前 z 下的节点量
+struct NodeState {
+    QVector<double> ez;              // e^{z_i}
+    QVector<double> segIntegral;     // I_k
+    QVector<double> dIa, dIb;        // ∂I_k/∂z_k, ∂I_k/∂z_{k+1}
+    QVector<double> cumulative;      // C_i = g(σ_i)
+
+    void update(const Eigen::VectorXd& z, double h)
+    {
+        const int m = int(z.size());
+        ez.resize(m);
+        for (int i = 0; i < m; ++i) ez[i] = std::exp(z[i]);
+        segIntegral.resize(m - 1);
+        dIa.resize(m - 1);
+        dIb.resize(m - 1);
+        cumulative.resize(m);
+        cumulative[0] = ez[0];
+        for (int k = 0; k + 1 < m; ++k) {
+            const double delta = z[k + 1] - z[k];
+            const double base = h * ez[k];
+            segIntegral[k] = base * phi(delta);
+            dIb[k] = base * psi(delta);
+            dIa[k] = segIntegral[k] - dIb[k];
+            cumulative[k + 1] = cumulative[k] + segIntegral[k];
+        }
+    }
+};
+
+// 观测点的模型压降 Σ Δq·g 及其对 z 的梯度 (grad 与 weight 由调用方分配，长度为节点数)
+double evaluateDrop(const Term* terms, int count, const Eigen::VectorXd& z, const NodeState& s, double h,
+                    double* grad, double* weight)
+{
+    const int m = int(z.size());
+    std::fill(grad, grad + m, 0.0);
+    std::fill(weight, weight + m, 0.0);
+
+    double value = 0.0;
+    for (int n = 0; n < count; ++n) {
+        const Term& term = terms[n];
+        const double dq = term.deltaRate;
+        if (term.segment < 0) {
+            const double g = s.ez[0] * term.value;
+            value += dq * g;
+            grad[0] += dq * g;
+        } else if (term.segment >= m - 1) {
+            const double part = s.ez[m - 1] * term.value;
+            weight[m - 1] += dq;
+            value += dq * part;
+            grad[m - 1] += dq * part;
+        } else {
+            const int k = term.segment;
+            const double u = term.value;
+            const double delta = z[k + 1] - z[k];
+            const double base = u * h * s.ez[k];
+            const double part = base * phi(u * delta);
+            const double slope = base * u * psi(u * delta);
+            weight[k] += dq;
+            value += dq * part;
+            grad[k] += dq * (part - slope);
+            grad[k + 1] += dq * slope;
+        }
+    }
+
+    // Σ w_i·C_i，C_i = e^{z_0} + Σ_{k<i} I_k：按后缀和归并各段积分的导数
+    double suffix = 0.0;
+    for (int k = m - 2; k >= 0; --k) {
+        suffix += weight[k + 1];
+        value += weight[k + 1] * s.cumulative[k + 1];
+        grad[k] += suffix * s.dIa[k];
+        grad[k + 1] += suffix * s.dIb[k];
+    }
+    const double total = suffix + weight[0];
+    value += weight[0] * s.cumulative[0];
+    grad[0] += total * s.ez[0];
+    return value;
+}
+
+} // namespace
+
+DeconvolutionResult PressureRateDeconvolution::run(const QVector<double>& t, const QVector<double>& p,
+                                                   const RateHistory& history,
+                                                   const DeconvolutionSettings& settings)
+{
+    DeconvolutionResult result;
+    const int m = std::max(4, settings.nodeCount);
+    const int limit = std::max(2 * m, settings.maxObservations);
+
+    if (history.isEmpty()) {
+        result.errorMessage = "缺少产量历史，无法反褶积。";
+        return result;
+    }
+    double rateScale = 0.0;
+    for (double q : history.rate) rateScale = std::max(rateScale, std::abs(q));
+    if (rateScale <= 0.0) {
+        result.errorMessage = "产量历史全部为零，无法反褶积。";
+        return result;
+    }
+
+    // 1. 有效观测点按时间排序 (一般已有序，只做 O(N) 的有序检查)
+    const int total = std::min(t.size(), p.size());
+    QVector<int> order;
+    order.reserve(total);
+    for (int i = 0; i < total; ++i) {
+        if (std::isfinite(t[i]) && std::isfinite(p[i]) && t[i] >= 0.0) order.append(i);
+    }
+    if (!std::is_sorted(order.begin(), order.end(), [&](int a, int b) { return t[a] < t[b]; })) {
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return t[a] < t[b]; });
+    }
+    if (order.size() < m) {
+        result.errorMessage = QString("有效观测点不足 (%1 个)。").arg(order.size());
+        return result;
+    }
+
+    // 2. 分箱压缩
+    const QVector<double>& start = history.startTime;
+    const double span = t[order.last()] - t[order.first()];
+    QVector<double> obsT, obsP;
+    bool compressed = false;
+    for (double density : kBinsPerDecade) {
+        if ((compressed = compressObservations(t, p, order, start, density, 0.0, limit, obsT, obsP))) break;
+    }
+    for (double width = span / limit; !compressed; width *= 2.0) {
+        compressed = compressObservations(t, p, order, start, 1.0, width, limit, obsT, obsP);
+    }
+    const int obsCount = obsT.size();
+
+    // 3. 时间差范围与节点
+    const double lagMax = obsT.last() - start.first();
+    double lagMin = std::numeric_limits<double>::infinity();
+    {
+        int j = -1;
+        for (double tk : obsT) {
+            while (j + 1 < start.size() && start[j + 1] < tk) ++j;
+            if (j >= 0) lagMin = std::min(lagMin, tk - start[j]);
+        }
+    }
+    if (!(lagMax > 0.0) || !std::isfinite(lagMin)) {
+        result.errorMessage = "观测时间未覆盖产量历史，无法反褶积。";
+        return result;
+    }
+    lagMin = std::max(lagMin, lagMax * kMinLagRatio);
+    if (lagMin >= lagMax) lagMin = lagMax * 0.1;
+    const double sigma0 = std::log(lagMin);
+    const double h = (std::log(lagMax) - sigma0) / (m - 1);
+
+    // 4. 叠加项换算为节点段查表
+    QVector<Term> terms;
+    QVector<int> termOffset(obsCount + 1, 0);
+    {
+        SuperpositionTerms generator(history, true);
+        QVector<double> lag, deltaRate;
+        terms.reserve(obsCount * std::min(history.size(), 2 * SuperpositionEngine::ExactRecentSteps));
+        for (int k = 0; k < obsCount; ++k) {
+            const int n = generator.collect(obsT[k], lag, deltaRate);
+            for (int g = 0; g < n; ++g) {
+                if (deltaRate[g] == 0.0) continue;
+                const double x = (std::log(lag[g]) - sigma0) / h;
+                Term term;
+                term.deltaRate = deltaRate[g];
+                if (x < 0.0) {
+                    term.segment = -1;
+                    term.value = std::exp(x * h);
+                } else if (x >= m - 1) {
+                    term.segment = m - 1;
+                    term.value = (x - (m - 1)) * h;
+                } else {
+                    term.segment = int(x);
+                    term.value = x - term.segment;
+                }
+                terms.append(term);
+            }
+            termOffset[k + 1] = terms.size();
+        }
+    }
+
+    // 5. 初值：p0 取给定值或观测压力最大值，z 取常数 (使最长时间差处的压降与观测压降量级一致)
+    const bool fitP0 = settings.estimateInitialPressure;
+    const int unknowns = fitP0 ? m + 1 : m;
+    double p0 = settings.initialPressure;
+    if (!(p0 > 0.0)) p0 = *std::max_element(obsP.constBegin(), obsP.constEnd());
+    const double dropScale = p0 - *std::min_element(obsP.constBegin(), obsP.constEnd());
+    if (!(dropScale > 0.0)) {
+        result.errorMessage = "观测压力无下降，无法反褶积。";
+        return result;
+    }
+    Eigen::VectorXd z = Eigen::VectorXd::Constant(m, std::log(dropScale / rateScale / (1.0 + (m - 1) * h)));
+
+    // 二阶差分正则矩阵 R = DᵀD (五对角)
+    Eigen::MatrixXd reg = Eigen::MatrixXd::Zero(m, m);
+    for (int i = 1; i + 1 < m; ++i) {
+        const int idx[3] = { i - 1, i, i + 1 };
+        const double c[3] = { 1.0, -2.0, 1.0 };
+        for (int a = 0; a < 3; ++a)
+            for (int b = 0; b < 3; ++b) reg(idx[a], idx[b]) += c[a] * c[b];
+    }
+
+    NodeState state;
+    QVector<double> grad(m), weight(m);
+    Eigen::VectorXd row(unknowns);
+
+    // 法方程累加：返回残差平方和
+    auto accumulate = [&](const Eigen::VectorXd& zz, double pp0, Eigen::MatrixXd* normal, Eigen::VectorXd* rhs) {
+        state.update(zz, h);
+        if (normal) { normal->setZero(unknowns, unknowns); rhs->setZero(unknowns); }
+        double sse = 0.0;
+        for (int k = 0; k < obsCount; ++k) {
+            const int begin = termOffset[k];
+            const double drop = evaluateDrop(terms.constData() + begin, termOffset[k + 1] - begin, zz, state, h,
+                                             grad.data(), weight.data());
+            const double r = pp0 - drop - obsP[k];
+            sse += r * r;
+            if (!normal) continue;
+            for (int i = 0; i < m; ++i) row[i] = -grad[i];
+            if (fitP0) row[m] = 1.0;
+            normal->selfadjointView<Eigen::Lower>().rankUpdate(row);
+            *rhs += r * row;
+        }
+        if (normal) *normal = normal->selfadjointView<Eigen::Lower>();
+        return sse;
+    };
+
+    Eigen::MatrixXd normal;
+    Eigen::VectorXd rhs;
+    double sse = accumulate(z, p0, &normal, &rhs);
+    if (!std::isfinite(sse)) {
+        result.errorMessage = "初值计算失败。";
+        return result;
+    }
+    const double regTrace = reg.trace();
+    const double lambda = settings.regularization * normal.topLeftCorner(m, m).trace() / regTrace;
+    double objective = sse + lambda * z.dot(reg * z);
+
+    // 6. Levenberg-Marquardt 迭代
+    double mu = 1e-3;
+    int iter = 0;
+    for (; iter < settings.maxIterations; ++iter) {
+        Eigen::MatrixXd a = normal;
+        a.topLeftCorner(m, m) += lambda * reg;
+        Eigen::VectorXd g = rhs;
+        g.head(m) += lambda * (reg * z);
+
+        bool accepted = false;
+        double newObjective = objective;
+        Eigen::VectorXd newZ;
+        double newP0 = p0;
+        for (int attempt = 0; attempt < 10 && !accepted; ++attempt) {
+            Eigen::MatrixXd damped = a;
+            damped.diagonal() += mu * a.diagonal().cwiseMax(1e-12);
+            Eigen::VectorXd step = damped.ldlt().solve(-g);
+            if (!step.allFinite()) { mu *= 10.0; continue; }
+            newZ = z + step.head(m);
+            newP0 = fitP0 ? p0 + step[m] : p0;
+            const double trialSse = accumulate(newZ, newP0, nullptr, nullptr);
+            const double trial = trialSse + lambda * newZ.dot(reg * newZ);
+            if (std::isfinite(trial) && trial < objective) {
+                accepted = true;
+                newObjective = trial;
+            } else {
+                mu *= 10.0;
+            }
+        }
+        if (!accepted) break;
+
+        const double decrease = (objective - newObjective) / std::max(objective, 1e-300);
+        z = newZ;
+        p0 = newP0;
+        objective = newObjective;
+        mu = std::max(mu * 0.3, 1e-9);
+        sse = accumulate(z, p0, &normal, &rhs);
+        if (decrease < 1e-10) { ++iter; break; }
+    }
+
+    // 7. 输出：节点间 3 倍加密的曲线，参考产量下的压差与导数
+    double qRef = settings.referenceRate;
+    if (!(qRef > 0.0)) {
+        for (int i = history.size() - 1; i >= 0; --i) {
+            if (history.rate[i] != 0.0) { qRef = history.rate[i]; break; }
+        }
+    }
+    state.update(z, h);
+    const int sub = 3;
+    const int points = (m - 1) * sub + 1;
+    result.tau.resize(points);
+    result.deltaP.resize(points);
+    result.derivative.resize(points);
+    for (int n = 0; n < points; ++n) {
+        const int k = std::min(n / sub, m - 2);
+        const double u = double(n - k * sub) / sub;
+        const double delta = z[k + 1] - z[k];
+        const double g = state.cumulative[k] + u * h * state.ez[k] * phi(u * delta);
+        result.tau[n] = std::exp(sigma0 + (k + u) * h);
+        result.deltaP[n] = qRef * g;
+        result.derivative[n] = qRef * std::exp(z[k] + u * delta);
+    }
+
+    result.success = true;
+    result.initialPressure = p0;
+    result.referenceRate = qRef;
+    result.rmsResidual = std::sqrt(sse / obsCount);
+    result.iterations = iter;
+    result.observationsUsed = obsCount;
+    qDebug() << "[Deconvolution]" << order.size() << "points ->" << obsCount << "bins, iterations" << iter
+             << "rms" << result.rmsResidual << "p0" << p0;
+    return result;
+}
@@ -0,0 +1,60 @@
+/*
+ * deconvolution.h
+ * 文件作用: 压力-产量反褶积头文件
+ * 功能描述:
+ * 1. 由长期变产量压力记录 (如永久压力计数据) 反求单位产量定产量响应 g(τ)，
+ *    采用 von Schroeter / Levitan 的正则化最小二乘方法：
+ *    p(t) = p0 - Σ (q_i - q_{i-1}) · g(t - t_i)，未知量为 z(σ) = ln(dg/dlnτ) (σ = lnτ) 与初始压力 p0。
+ * 2. z 在均匀 σ 节点上分段线性，g 由 e^z 的分段积分解析给出 (恒正且单调)；首节点之前按单位斜率
+ *    (井筒储集) 延伸，末节点之后按 z 不变延伸。目标函数附加 z 的二阶差分 (带状) 正则项。
+ * 3. 观测数据先按 (产量阶段, 距该阶段起点的对数时间差) 分箱求平均，O(N) 压缩为不超过
+ *    maxObservations 个点；每个点的叠加项由 SuperpositionTerms 给出 (阶段过多时自动分组)。
+ * 4. Gauss-Newton / Levenberg-Marquardt 迭代：雅可比矩阵逐行生成并直接累加到法方程 (不存储)，
+ *    每行 O(叠加项数 + 节点数)，法方程维数只与节点数有关。
+ * 5. 输出为等效定产量 (参考产量 q_ref) 下的压差与导数曲线，可直接作为拟合的观测数据。
+ */
+
+#ifndef DECONVOLUTION_H
+#define DECONVOLUTION_H
+
+#include <QString>
+#include <QVector>
+#include "superposition.h"
+
+// 反褶积设置
+struct DeconvolutionSettings {
+    int nodeCount = 40;               // z(σ) 的节点数 (均匀分布在最短与最长时间差之间)
+    double regularization = 1e-2;     // 相对正则化系数 ν：λ = ν · tr(JᵀJ) / tr(DᵀD) (按初值计算)
+    int maxIterations = 30;           // 最大迭代次数
+    int maxObservations = 10000;      // 分箱压缩后的最大观测点数
+    double initialPressure = 0.0;     // 初始压力初值 (<= 0 时取观测压力最大值)
+    bool estimateInitialPressure = true; // 是否同时估计初始压力 (否则固定为 initialPressure)
+    double referenceRate = 0.0;       // 输出曲线的参考产量 (<= 0 时取最后一个非零产量)
+};
+
+// 反褶积结果
+struct DeconvolutionResult {
+    bool success = false;
+    QString errorMessage;
+
+    QVector<double> tau;        // 时间差网格 (h)
+    QVector<double> deltaP;     // 参考产量下的压差 q_ref · g(τ)
+    QVector<double> derivative; // 参考产量下的压力导数 q_ref · dg/dlnτ
+
+    double initialPressure = 0.0; // 估计 (或固定) 的初始压力
+    double referenceRate = 0.0;   // 参考产量
+    double rmsResidual = 0.0;     // 压力残差均方根
+    int iterations = 0;           // 实际迭代次数
+    int observationsUsed = 0;     // 分箱压缩后的观测点数
+};
+
+class PressureRateDeconvolution
+{
+public:
+    // t 为观测时间 (与产量历史共用时间原点)，p 为实测压力；history 至少包含一个非零产量阶段
+    static DeconvolutionResult run(const QVector<double>& t, const QVector<double>& p,
+                                   const RateHistory& history,
+                                   const DeconvolutionSettings& settings = DeconvolutionSettings());
+};
+
+#endif // DECONVOLUTION_H
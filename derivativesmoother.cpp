@@ -0,0 +1,339 @@
+/*
+ * derivativesmoother.cpp
+ * 文件作用: 导数平滑算法实现文件
+ * 功能描述:
+ * 1. 滑动求和采用 Neumaier 补偿求和，长记录上窗口滑动数十万次后的累积舍入误差仍在 1e-15 量级；
+ *    窗口内含非有限值时该点按原方式直接求和 (结果同样为非有限值)，不污染后续窗口。
+ * 2. Savitzky-Golay 系数由 Vandermonde 矩阵的法方程求得 (横坐标按窗口半宽归一化以改善条件数)，
+ *    中间点共用一组系数，两端各 h 个点各用一组，共 2h+1 组、只计算一次。
+ * 3. 对数时间窗先在正时间点上计算 log10 t，之后左右指针只前进不后退。
+ */
+
+#include "derivativesmoother.h"
+
+#include <Eigen/Dense>
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Neumaier 补偿求和
+struct CompensatedSum {
+    double sum = 0.0;
+    double compensation = 0.0;
+    void add(double x)
+    {
+        const double t = sum + x;
+        if (std::abs(sum) >= std::abs(x)) compensation += (sum - t) + x;
+        else compensation += (x - t) + sum;
+        sum = t;
+    }
+    double value() const { return sum + compensation; }
+};
+
+// 窗口 [begin, end] 的直接平均 (窗口内含非有限值时使用)
+double directMean(const double* data, int begin, int end)
+{
+    double sum = 0.0;
+    for (int j = begin; j <= end; ++j) sum += data[j];
+    return sum / (end - begin + 1);
+}
+
+int halfSpanOf(int span)
+{
+    if (span <= 1) return 0;
+    if (span % 2 == 0) span++;
+    return (span - 1) / 2;
+}
+
+} // namespace
+
+DerivativeSmoother::Options DerivativeSmoother::options(int method, int span)
+{
+    Options o;
+    o.method = (method == SavitzkyGolay || method == LogTimeWindow) ? Method(method) : MovingAverage;
+    o.span = span;
+    return o;
+}
+
+DerivativeSmoother::Options DerivativeSmoother::resolved(const QVector<double>& timeData, const Options& options)
+{
+    Options o = options;
+    if (o.method != LogTimeWindow) return o;
+    if (!isLogWindowUsable(timeData)) {
+        o.method = MovingAverage;
+        return o;
+    }
+    if (o.logHalfWidth <= 0.0) o.logHalfWidth = resolveLogHalfWidth(timeData, o.span);
+    if (o.logHalfWidth <= 0.0) o.method = MovingAverage;
+    return o;
+}
+
+QVector<double> DerivativeSmoother::smooth(const QVector<double>& timeData, const QVector<double>& data,
+                                           const Options& options)
+{
+    const int h = halfSpanOf(options.span);
+    if (h == 0 || data.size() < 2) return data;
+
+    switch (options.method) {
+    case SavitzkyGolay:
+        return savitzkyGolay(data, h);
+    case LogTimeWindow: {
+        if (timeData.size() != data.size()) return movingAverage(data, h);
+        const Options o = resolved(timeData, options);
+        if (o.method != LogTimeWindow) return movingAverage(data, h);
+        return logTimeWindow(timeData, data, o.logHalfWidth);
+    }
+    case MovingAverage:
+    default:
+        return movingAverage(data, h);
+    }
+}
+
+void DerivativeSmoother::dependencyRange(const QVector<double>& timeData, const Options& options, int from, int to,
+                                         int& inFrom, int& inTo)
+{
+    expandRange(timeData, options, from, to, false, inFrom, inTo);
+}
+
+void DerivativeSmoother::affectedRange(const QVector<double>& timeData, const Options& options, int from, int to,
+                                       int& outFrom, int& outTo)
+{
+    expandRange(timeData, options, from, to, true, outFrom, outTo);
+}
+
+void DerivativeSmoother::expandRange(const QVector<double>& timeData, const Options& options, int from, int to,
+                                     bool inputsToOutputs, int& outFrom, int& outTo)
+{
+    const int n = timeData.size();
+    from = qMax(0, from);
+    to = qMin(n - 1, to);
+    outFrom = from;
+    outTo = to;
+    const int h = halfSpanOf(options.span);
+    if (h == 0 || from > to) return;
+
+    const Options o = resolved(timeData, options);
+    if (o.method == LogTimeWindow) {
+        // 对数距离不超过半宽的正时间点互为窗口成员 (关系对称)
+        const double* t = timeData.constData();
+        int R = from;
+        while (R <= to && t[R] <= 0) ++R;
+        if (R > to) return;
+        int S = to;
+        while (S >= from && t[S] <= 0) --S;
+        const double lgR = std::log10(t[R]);
+        const double lgS = std::log10(t[S]);
+        int j = from - 1;
+        while (j >= 0 && (t[j] <= 0 || lgR - std::log10(t[j]) <= o.logHalfWidth)) --j;
+        int k = to + 1;
+        while (k < n && (t[k] <= 0 || std::log10(t[k]) - lgS <= o.logHalfWidth)) ++k;
+        outFrom = j + 1;
+        outTo = k - 1;
+        return;
+    }
+
+    int hEff = h;
+    if (o.method == SavitzkyGolay) {
+        hEff = qMin(h, (n - 1) / 2);
+        if (hEff < 1) return;
+    }
+    outFrom = qMax(0, from - hEff);
+    outTo = qMin(n - 1, to + hEff);
+    if (o.method != SavitzkyGolay) return;
+
+    // Savitzky-Golay 两端各 hEff 个点共用端部窗口 [0, 2h] 与 [n-1-2h, n-1]
+    const int W = 2 * hEff + 1;
+    if (inputsToOutputs) {
+        if (from < W) outFrom = 0;
+        if (to > n - 1 - W) outTo = n - 1;
+    } else {
+        if (from < hEff) outTo = qMax(outTo, qMin(n - 1, W - 1));
+        if (to > n - 1 - hEff) outFrom = qMin(outFrom, qMax(0, n - W));
+    }
+}
+
+QVector<double> DerivativeSmoother::smoothRange(const QVector<double>& timeData, const QVector<double>& data,
+                                                const Options& options, int from, int to)
+{
+    const int n = data.size();
+    from = qMax(0, from);
+    to = qMin(n - 1, to);
+    if (from > to) return QVector<double>();
+
+    // 对数时间窗半宽按完整时间序列确定，子序列上的结果才与整体一致
+    const Options o = (timeData.size() == n) ? resolved(timeData, options) : options;
+    int a = from, b = to;
+    if (timeData.size() == n) dependencyRange(timeData, o, from, to, a, b);
+    else { a = 0; b = n - 1; }
+
+    const QVector<double> sub = smooth(timeData.size() == n ? timeData.mid(a, b - a + 1) : QVector<double>(),
+                                       data.mid(a, b - a + 1), o);
+    return sub.mid(from - a, to - from + 1);
+}
+
+QVector<double> DerivativeSmoother::movingAverage(const QVector<double>& data, int halfSpan)
+{
+    const int n = data.size();
+    const double* x = data.constData();
+    QVector<double> result(n);
+
+    CompensatedSum sum;
+    int nonFinite = 0;
+    int lo = 0, hi = -1; // 当前窗口 [lo, hi]
+    for (int i = 0; i < n; ++i) {
+        const int newHi = qMin(n - 1, i + halfSpan);
+        const int newLo = qMax(0, i - halfSpan);
+        while (hi < newHi) {
+            ++hi;
+            if (std::isfinite(x[hi])) sum.add(x[hi]);
+            else ++nonFinite;
+        }
+        while (lo < newLo) {
+            if (std::isfinite(x[lo])) sum.add(-x[lo]);
+            else --nonFinite;
+            ++lo;
+        }
+        result[i] = nonFinite > 0 ? directMean(x, lo, hi) : sum.value() / (hi - lo + 1);
+    }
+    return result;
+}
+
+QVector<double> DerivativeSmoother::savitzkyGolayCoefficients(int halfSpan, int order, int position)
+{
+    const int W = 2 * halfSpan + 1;
+    const int m = order + 1;
+    const double scale = halfSpan > 0 ? 1.0 / halfSpan : 1.0;
+
+    Eigen::MatrixXd V(W, m);
+    for (int j = 0; j < W; ++j) {
+        const double x = (j - halfSpan) * scale;
+        double v = 1.0;
+        for (int k = 0; k < m; ++k) { V(j, k) = v; v *= x; }
+    }
+    Eigen::VectorXd e(m);
+    const double x0 = (position - halfSpan) * scale;
+    double v = 1.0;
+    for (int k = 0; k < m; ++k) { e(k) = v; v *= x0; }
+
+    // 在 x0 处的拟合值 = e^T (V^T V)^{-1} V^T y
+    const Eigen::VectorXd z = (V.transpose() * V).ldlt().solve(e);
+    const Eigen::VectorXd c = V * z;
+    QVector<double> coefficients(W);
+    for (int j = 0; j < W; ++j) coefficients[j] = c(j);
+    return coefficients;
+}
+
+QVector<double> DerivativeSmoother::savitzkyGolay(const QVector<double>& data, int halfSpan)
+{
+    const int n = data.size();
+    const int h = qMin(halfSpan, (n - 1) / 2);
+    if (h < 1) return data;
+    const int W = 2 * h + 1;
+    const int order = (h >= 2) ? 2 : 1;
+    const double* x = data.constData();
+    QVector<double> result(n);
+
+    const QVector<double> center = savitzkyGolayCoefficients(h, order, h);
+    const double* c = center.constData();
+    for (int i = h; i < n - h; ++i) {
+        const double* window = x + i - h;
+        double sum = 0.0;
+        for (int j = 0; j < W; ++j) sum += c[j] * window[j];
+        result[i] = sum;
+    }
+
+    // 两端：在端部完整窗口内的对应位置求值
+    for (int position = 0; position < h; ++position) {
+        const QVector<double> left = savitzkyGolayCoefficients(h, order, position);
+        const QVector<double> right = savitzkyGolayCoefficients(h, order, W - 1 - position);
+        double sumLeft = 0.0, sumRight = 0.0;
+        for (int j = 0; j < W; ++j) {
+            sumLeft += left[j] * x[j];
+            sumRight += right[j] * x[n - W + j];
+        }
+        result[position] = sumLeft;
+        result[n - 1 - position] = sumRight;
+    }
+    return result;
+}
+
+QVector<double> DerivativeSmoother::logTimeWindow(const QVector<double>& timeData, const QVector<double>& data,
+                                                  double halfWidth)
+{
+    const int n = data.size();
+    QVector<double> result = data; // 非正时间点保持原值
+
+    QVector<int> index;
+    QVector<double> lg;
+    index.reserve(n);
+    lg.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        if (timeData[i] <= 0) continue;
+        index.append(i);
+        lg.append(std::log10(timeData[i]));
+    }
+    const int m = index.size();
+
+    CompensatedSum sum;
+    int nonFinite = 0;
+    int lo = 0, hi = -1;
+    for (int k = 0; k < m; ++k) {
+        while (hi + 1 < m && lg[hi + 1] - lg[k] <= halfWidth) {
+            ++hi;
+            const double v = data[index[hi]];
+            if (std::isfinite(v)) sum.add(v);
+            else ++nonFinite;
+        }
+        while (lg[k] - lg[lo] > halfWidth) {
+            const double v = data[index[lo]];
+            if (std::isfinite(v)) sum.add(-v);
+            else --nonFinite;
+            ++lo;
+        }
+        if (nonFinite > 0) {
+            double direct = 0.0;
+            for (int j = lo; j <= hi; ++j) direct += data[index[j]];
+            result[index[k]] = direct / (hi - lo + 1);
+        } else {
+            result[index[k]] = sum.value() / (hi - lo + 1);
+        }
+    }
+    return result;
+}
+
+bool DerivativeSmoother::isLogWindowUsable(const QVector<double>& timeData)
+{
+    double previous = 0.0;
+    for (double t : timeData) {
+        if (t <= 0) continue;
+        if (!std::isfinite(t) || t < previous) return false;
+        previous = t;
+    }
+    return true;
+}
+
+double DerivativeSmoother::resolveLogHalfWidth(const QVector<double>& timeData, int span)
+{
+    const int h = halfSpanOf(span);
+    if (h == 0) return 0.0;
+
+    QVector<double> gaps;
+    gaps.reserve(timeData.size());
+    double previous = 0.0;
+    bool hasPrevious = false;
+    for (double t : timeData) {
+        if (t <= 0) continue;
+        const double lg = std::log10(t);
+        if (hasPrevious && lg > previous) gaps.append(lg - previous);
+        previous = lg;
+        hasPrevious = true;
+    }
+    if (gaps.isEmpty()) return 0.0;
+
+    auto mid = gaps.begin() + gaps.size() / 2;
+    std::nth_element(gaps.begin(), mid, gaps.end());
+    // 略放宽，使对数等间距数据的窗口恰好包含 2h+1 个点
+    return h * (*mid) * (1.0 + 1e-9);
+}
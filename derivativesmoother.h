@@ -0,0 +1,76 @@
+/*
+ * derivativesmoother.h
+ * 文件作用: 导数平滑算法头文件
+ * 功能描述:
+ * 1. 移动平均：窗口为 span 个点 (偶数自动 +1)，边缘处窗口自动缩小 (与原 smoothData 相同)，
+ *    以滑动的补偿求和实现，代价 O(n) 与窗口大小无关。
+ * 2. Savitzky-Golay：窗口内二次多项式最小二乘拟合 (窗口为 3 点时为一次)，中间点与边缘点的卷积系数
+ *    预先计算一次，逐点只做一次点积；边缘处取端部的完整窗口，在对应位置求值。
+ * 3. 对数时间窗：对 |log10 tj - log10 ti| ≤ w 的点取平均，窗口在对数时间上等宽，
+ *    对数间距不均匀的数据 (如线性采样的长记录) 平滑程度一致；两个单调指针维护窗口，代价 O(n)。
+ *    w 未指定时取 (span - 1)/2 倍的相邻点对数间距中值 (即数据密度典型处窗口约 span 个点)。
+ *    时间非正的点不参与平均、输出保持原值；时间乱序时退化为移动平均。
+ * 4. 局部更新：dependencyRange 给出输出 [from, to] 所依赖的输入范围，affectedRange 给出输入 [from, to] 被修改后
+ *    受影响的输出范围；smoothRange 只在依赖范围上计算，结果与整体计算一致 (至舍入误差)。
+ */
+
+#ifndef DERIVATIVESMOOTHER_H
+#define DERIVATIVESMOOTHER_H
+
+#include <QVector>
+
+class DerivativeSmoother
+{
+public:
+    // 平滑方法 (数值保存在项目与拟合设置中，勿改顺序)
+    enum Method {
+        MovingAverage = 0, // 移动平均
+        SavitzkyGolay = 1, // Savitzky-Golay 多项式平滑
+        LogTimeWindow = 2  // 对数时间窗平均
+    };
+
+    struct Options {
+        Method method = MovingAverage;
+        int span = 1;              // 窗口点数 (≤ 1 表示不平滑)
+        double logHalfWidth = 0.0; // 对数时间窗的半宽 (log10 单位，≤ 0 表示由 span 与数据间距确定)
+    };
+
+    static Options options(int method, int span);
+
+    // 按时间序列确定对数时间窗半宽；对数时间窗不可用 (时间乱序、无法确定间距) 时改为移动平均
+    static Options resolved(const QVector<double>& timeData, const Options& options);
+
+    // 平滑 data (与 timeData 等长；移动平均与 Savitzky-Golay 不使用时间)
+    static QVector<double> smooth(const QVector<double>& timeData, const QVector<double>& data, const Options& options);
+
+    // 输出 [from, to] 所依赖的输入下标范围 [inFrom, inTo]
+    static void dependencyRange(const QVector<double>& timeData, const Options& options, int from, int to,
+                                int& inFrom, int& inTo);
+
+    // 输入 [from, to] 被修改后受影响的输出下标范围 [outFrom, outTo]
+    static void affectedRange(const QVector<double>& timeData, const Options& options, int from, int to,
+                              int& outFrom, int& outTo);
+
+    // 只计算输出 [from, to] (返回 to - from + 1 个值)
+    static QVector<double> smoothRange(const QVector<double>& timeData, const QVector<double>& data,
+                                       const Options& options, int from, int to);
+
+    // Savitzky-Golay 卷积系数：窗口 2h+1 点、在窗口第 position 个点 (0..2h) 处求值
+    static QVector<double> savitzkyGolayCoefficients(int halfSpan, int order, int position);
+
+private:
+    // dependencyRange / affectedRange 的共同实现 (仅 Savitzky-Golay 的边缘窗口使两者不同)
+    static void expandRange(const QVector<double>& timeData, const Options& options, int from, int to,
+                            bool inputsToOutputs, int& outFrom, int& outTo);
+
+    static QVector<double> movingAverage(const QVector<double>& data, int halfSpan);
+    static QVector<double> savitzkyGolay(const QVector<double>& data, int halfSpan);
+    static QVector<double> logTimeWindow(const QVector<double>& timeData, const QVector<double>& data, double halfWidth);
+
+    // 时间序列的正时间点是否严格可用于对数时间窗 (非降序、有限)
+    static bool isLogWindowUsable(const QVector<double>& timeData);
+    // 由 span 与相邻点 log10 间距中值确定对数时间窗半宽 (无法确定时返回 0)
+    static double resolveLogHalfWidth(const QVector<double>& timeData, int span);
+};
+
+#endif // DERIVATIVESMOOTHER_H
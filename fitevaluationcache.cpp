@@ -0,0 +1,409 @@
+/*
+ * fitevaluationcache.cpp
+ * 文件作用: 拟合求值的项目级持久缓存与拟合断点实现文件
+ * 功能描述:
+ * 1. 文件格式：16 字节文件头 (魔数 + 格式版本 + 求解器数值版本) 之后为若干记录，每条记录为定长记录头 (魔数、键长、点数、校验和)
+ *    + 键 + 时间/压差/导数三段 double；校验和为键与数据的 FNV-1a 散列。
+ * 2. 追加时先复制待写条目再释放锁，文件读写由单独的互斥锁保护，拟合期间的查询不被磁盘 I/O 阻塞。
+ * 3. 断点文件为 JSON：{"checkpoints": {"<模型>|<数据散列>": {...}}}，整体读出、合并后经 QSaveFile 替换。
+ */
+
+#include "fitevaluationcache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSettings>
+#include <QWeakPointer>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+
+const char kMagic[8] = { 'W', 'T', 'F', 'C', 'A', 'C', 'H', 'E' };
+const qint32 kVersion = 1;
+const quint32 kRecordMagic = 0x43455246u; // "FREC"
+
+struct FileHeader {
+    char magic[8];
+    qint32 version;
+    qint32 solverVersion; // SolverSettings::NumericsVersion，不一致时整个文件作废
+};
+
+struct RecordHeader {
+    quint32 magic;
+    quint32 keySize;
+    quint32 pointCount;
+    quint32 reserved;
+    quint64 checksum;
+};
+
+// 键长与点数的合理上限 (超出视为文件损坏)
+const quint32 kMaxKeySize = 1 << 16;
+const quint32 kMaxPoints = 1 << 22;
+
+quint64 recordChecksum(const QByteArray& key, const ModelCurveData& curve)
+{
+    quint64 h = FitEvaluationCache::hashBytes(key.constData(), key.size());
+    h = FitEvaluationCache::hashValues(std::get<0>(curve), h);
+    h = FitEvaluationCache::hashValues(std::get<1>(curve), h);
+    return FitEvaluationCache::hashValues(std::get<2>(curve), h);
+}
+
+template <typename T>
+void appendRaw(QByteArray& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+QMutex& checkpointMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+} // namespace
+
+FitEvaluationCache::FitEvaluationCache(const QString& filePath)
+    : m_filePath(filePath), m_validSize(0), m_fileRecords(0), m_hits(0), m_misses(0)
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    m_capacity = qMax(100, settings.value("fitting/evaluationCacheEntries", 4000).toInt());
+}
+
+FitEvaluationCache::~FitEvaluationCache()
+{
+    flush();
+}
+
+QSharedPointer<FitEvaluationCache> FitEvaluationCache::shared(const QString& filePath)
+{
+    if (filePath.isEmpty()) return QSharedPointer<FitEvaluationCache>();
+    static QMutex registryMutex;
+    static QHash<QString, QWeakPointer<FitEvaluationCache>> registry;
+
+    const QString path = QFileInfo(filePath).absoluteFilePath();
+    QMutexLocker locker(&registryMutex);
+    QSharedPointer<FitEvaluationCache> cache = registry.value(path).toStrongRef();
+    if (!cache) {
+        cache = QSharedPointer<FitEvaluationCache>(new FitEvaluationCache(path));
+        cache->load();
+        registry.insert(path, cache);
+    }
+    return cache;
+}
+
+quint64 FitEvaluationCache::hashBytes(const void* data, qint64 size, quint64 seed)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    quint64 h = seed;
+    for (qint64 i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+quint64 FitEvaluationCache::hashValues(const QVector<double>& values, quint64 seed)
+{
+    return hashBytes(values.constData(), qint64(values.size()) * sizeof(double), seed);
+}
+
+QByteArray FitEvaluationCache::makeKey(int modelType, const SolverSettings& settings, const QMap<QString, double>& params,
+                                       const QVector<double>& t, quint64 contextHash)
+{
+    // 时间点并行开关不影响结果，不参与键
+    QByteArray key;
+    key.reserve(64 + params.size() * 16);
+    appendRaw(key, qint32(modelType));
+    appendRaw(key, qint32(settings.highPrecision));
+    appendRaw(key, qint32(settings.inversionMethod));
+    appendRaw(key, qint32(settings.inversionOrder));
+    appendRaw(key, qint32(settings.useTypeCurveLibrary));
+    appendRaw(key, qint32(settings.gridPointsPerDecade));
+    appendRaw(key, settings.asymptoticEarlyArgument);
+    appendRaw(key, settings.asymptoticLateArgument);
+    appendRaw(key, qint32(settings.accuracyControl));
+    appendRaw(key, qint32(settings.mixedPrecision));
+    appendRaw(key, qint32(settings.sharedLaplaceNodes));
+    appendRaw(key, qint32(settings.laplaceInterpolation));
+    appendRaw(key, contextHash);
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+        const QByteArray name = it.key().toUtf8();
+        appendRaw(key, qint32(name.size()));
+        key.append(name);
+        appendRaw(key, it.value());
+    }
+    appendRaw(key, qint32(t.size()));
+    appendRaw(key, hashValues(t));
+    return key;
+}
+
+bool FitEvaluationCache::lookup(const QByteArray& key, ModelCurveData& curve)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_current.constFind(key);
+    if (it != m_current.constEnd()) {
+        curve = it.value();
+        ++m_hits;
+        return true;
+    }
+    auto old = m_previous.find(key);
+    if (old != m_previous.end()) {
+        curve = old.value();
+        m_current.insert(key, old.value());
+        m_previous.erase(old);
+        if (m_current.size() >= m_capacity / 2) {
+            m_previous = m_current;
+            m_current.clear();
+        }
+        ++m_hits;
+        return true;
+    }
+    ++m_misses;
+    return false;
+}
+
+void FitEvaluationCache::insert(const QByteArray& key, const ModelCurveData& curve)
+{
+    const int n = std::get<0>(curve).size();
+    if (n == 0 || std::get<1>(curve).size() != n || std::get<2>(curve).size() != n) return;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_current.contains(key) || m_previous.contains(key)) return;
+    m_current.insert(key, curve);
+    m_pending.append(key);
+    if (m_current.size() >= m_capacity / 2) {
+        m_previous = m_current;
+        m_current.clear();
+    }
+}
+
+bool FitEvaluationCache::appendRecord(QIODevice& file, const QByteArray& key, const ModelCurveData& curve)
+{
+    RecordHeader header;
+    header.magic = kRecordMagic;
+    header.keySize = key.size();
+    header.pointCount = std::get<0>(curve).size();
+    header.reserved = 0;
+    header.checksum = recordChecksum(key, curve);
+    const qint64 bytes = qint64(header.pointCount) * sizeof(double);
+    return file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header)
+           && file.write(key) == key.size()
+           && file.write(reinterpret_cast<const char*>(std::get<0>(curve).constData()), bytes) == bytes
+           && file.write(reinterpret_cast<const char*>(std::get<1>(curve).constData()), bytes) == bytes
+           && file.write(reinterpret_cast<const char*>(std::get<2>(curve).constData()), bytes) == bytes;
+}
+
+void FitEvaluationCache::load()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    FileHeader header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+        || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || header.solverVersion != SolverSettings::NumericsVersion) {
+        qDebug() << "拟合缓存: 文件头无效或求解器版本已变化，将重建" << m_filePath;
+        return;
+    }
+    m_validSize = sizeof(header);
+
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        RecordHeader record;
+        if (file.read(reinterpret_cast<char*>(&record), sizeof(record)) != sizeof(record)) break;
+        if (record.magic != kRecordMagic || record.keySize > kMaxKeySize || record.pointCount > kMaxPoints) break;
+        const QByteArray key = file.read(record.keySize);
+        if (key.size() != int(record.keySize)) break;
+        QVector<double> t(record.pointCount), p(record.pointCount), d(record.pointCount);
+        const qint64 bytes = qint64(record.pointCount) * sizeof(double);
+        if (file.read(reinterpret_cast<char*>(t.data()), bytes) != bytes
+            || file.read(reinterpret_cast<char*>(p.data()), bytes) != bytes
+            || file.read(reinterpret_cast<char*>(d.data()), bytes) != bytes) break;
+        const ModelCurveData curve(t, p, d);
+        if (recordChecksum(key, curve) != record.checksum) break;
+
+        m_current.insert(key, curve);
+        if (m_current.size() >= m_capacity / 2) {
+            m_previous = m_current;
+            m_current.clear();
+        }
+        m_validSize = file.pos();
+        ++m_fileRecords;
+    }
+    if (m_validSize < file.size()) {
+        qDebug() << "拟合缓存: 文件末尾有不完整的记录，已忽略" << (file.size() - m_validSize) << "字节";
+    }
+    qDebug() << "拟合缓存: 读取" << m_fileRecords << "条记录，内存条目" << (m_current.size() + m_previous.size());
+}
+
+bool FitEvaluationCache::flush()
+{
+    // 复制待写条目后释放锁，磁盘写入期间查询不受影响
+    QVector<QPair<QByteArray, ModelCurveData>> records;
+    bool compact = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pending.isEmpty()) return true;
+        for (const QByteArray& key : m_pending) {
+            auto it = m_current.constFind(key);
+            if (it != m_current.constEnd()) { records.append(qMakePair(key, it.value())); continue; }
+            auto old = m_previous.constFind(key);
+            if (old != m_previous.constEnd()) records.append(qMakePair(key, old.value()));
+        }
+        m_pending.clear();
+        compact = (m_fileRecords + records.size() > 2 * m_capacity);
+    }
+
+    static QMutex fileMutex;
+    QMutexLocker fileLocker(&fileMutex);
+    if (compact) return rewrite();
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qDebug() << "拟合缓存: 无法写入" << m_filePath;
+        return false;
+    }
+    if (m_validSize < (qint64)sizeof(FileHeader)) {
+        // 新文件或文件头无效：从头写入
+        file.resize(0);
+        FileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.solverVersion = SolverSettings::NumericsVersion;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_validSize = sizeof(header);
+        m_fileRecords = 0;
+    } else if (file.size() != m_validSize) {
+        file.resize(m_validSize); // 截掉上次异常退出留下的不完整记录
+    }
+    file.seek(m_validSize);
+    for (const auto& record : records) {
+        if (!appendRecord(file, record.first, record.second)) {
+            qDebug() << "拟合缓存: 追加记录失败" << m_filePath;
+            return false;
+        }
+        m_validSize = file.pos();
+        ++m_fileRecords;
+    }
+    return file.flush();
+}
+
+bool FitEvaluationCache::rewrite()
+{
+    QHash<QByteArray, ModelCurveData> entries;
+    {
+        QMutexLocker locker(&m_mutex);
+        entries = m_previous;
+        for (auto it = m_current.constBegin(); it != m_current.constEnd(); ++it) entries.insert(it.key(), it.value());
+    }
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.solverVersion = SolverSettings::NumericsVersion;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        if (!appendRecord(file, it.key(), it.value())) {
+            file.cancelWriting();
+            break;
+        }
+    }
+    const qint64 size = file.size();
+    if (!file.commit()) {
+        qDebug() << "拟合缓存: 重写失败" << m_filePath;
+        return false;
+    }
+    m_validSize = size;
+    m_fileRecords = entries.size();
+    qDebug() << "拟合缓存: 压缩为" << m_fileRecords << "条记录";
+    return true;
+}
+
+int FitEvaluationCache::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_current.size() + m_previous.size();
+}
+
+qint64 FitEvaluationCache::hits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+qint64 FitEvaluationCache::misses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+// ---------------------- 拟合断点 ----------------------
+
+QString FitCheckpoint::key() const
+{
+    return QString("%1|%2").arg(modelType).arg(dataHash, 16, 16, QChar('0'));
+}
+
+bool FitCheckpoint::save(const QString& filePath, const FitCheckpoint& checkpoint)
+{
+    if (filePath.isEmpty()) return false;
+    QMutexLocker locker(&checkpointMutex());
+
+    QJsonObject root;
+    QFile in(filePath);
+    if (in.open(QIODevice::ReadOnly)) root = QJsonDocument::fromJson(in.readAll()).object();
+    in.close();
+
+    QJsonObject obj;
+    obj["finished"] = checkpoint.finished;
+    obj["modelType"] = checkpoint.modelType;
+    obj["weight"] = checkpoint.weight;
+    obj["fitNames"] = QJsonArray::fromStringList(checkpoint.fitNames);
+    QJsonObject params;
+    for (auto it = checkpoint.params.constBegin(); it != checkpoint.params.constEnd(); ++it) params[it.key()] = it.value();
+    obj["params"] = params;
+    obj["error"] = checkpoint.error;
+    obj["time"] = checkpoint.time.toString(Qt::ISODate);
+
+    QJsonObject all = root.value("checkpoints").toObject();
+    all[checkpoint.key()] = obj;
+    root["checkpoints"] = all;
+
+    QSaveFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly)) return false;
+    out.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return out.commit();
+}
+
+FitCheckpoint FitCheckpoint::load(const QString& filePath, int modelType, quint64 dataHash)
+{
+    FitCheckpoint checkpoint;
+    checkpoint.modelType = modelType;
+    checkpoint.dataHash = dataHash;
+    if (filePath.isEmpty()) return checkpoint;
+
+    QMutexLocker locker(&checkpointMutex());
+    QFile in(filePath);
+    if (!in.open(QIODevice::ReadOnly)) return checkpoint;
+    const QJsonObject all = QJsonDocument::fromJson(in.readAll()).object().value("checkpoints").toObject();
+    if (!all.contains(checkpoint.key())) return checkpoint;
+
+    const QJsonObject obj = all[checkpoint.key()].toObject();
+    checkpoint.finished = obj["finished"].toBool();
+    checkpoint.weight = obj["weight"].toDouble();
+    for (const QJsonValue& v : obj["fitNames"].toArray()) checkpoint.fitNames.append(v.toString());
+    const QJsonObject params = obj["params"].toObject();
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) checkpoint.params.insert(it.key(), it.value().toDouble());
+    checkpoint.error = obj["error"].toDouble();
+    checkpoint.time = QDateTime::fromString(obj["time"].toString(), Qt::ISODate);
+    checkpoint.valid = !checkpoint.params.isEmpty();
+    return checkpoint;
+}
@@ -0,0 +1,101 @@
+/*
+ * fitevaluationcache.h
+ * 文件作用: 拟合求值的项目级持久缓存与拟合断点头文件
+ * 功能描述:
+ * 1. FitEvaluationCache：以 (模型类型, 求解器设置, 参数字典, 时间网格散列, 产量历史等上下文散列) 为键，
+ *    缓存 FittingCore 计算的理论曲线 (时间、压差、导数)，保存在项目目录的 <项目名>_fitcache.bin 中，
+ *    重新打开项目后再次拟合时，相同参数点的曲线直接从缓存读取。
+ * 2. 文件为追加式二进制记录 (定长记录头 + 键 + double 数组，带校验和)：拟合过程中新增的条目定期追加，
+ *    程序异常退出时最多丢失最后一次追加之后的条目；读取时遇到不完整或校验失败的记录即停止，并在下次追加前截断。
+ *    文件头记录求解器数值版本 (SolverSettings::NumericsVersion)，求解器算法更新后旧文件整体作废重建。
+ * 3. 内存中采用双代淘汰 (与 LaplaceEvaluationCache 相同)，条目数有上限 (设置项 fitting/evaluationCacheEntries)，
+ *    文件中的记录数超过上限 2 倍时按内存中的条目重写压缩。同一文件在进程内共享一个实例 (shared)。
+ * 4. FitCheckpoint：拟合断点 (模型、权重、拟合参数名、数据散列与当前最优参数)，保存在 <项目名>_fitstate.json，
+ *    按"模型类型|数据散列"区分同一项目中的不同分析；未正常结束的断点可用于从上次的最优参数继续拟合。
+ */
+
+#ifndef FITEVALUATIONCACHE_H
+#define FITEVALUATIONCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QIODevice>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "solverpool.h"
+
+class FitEvaluationCache
+{
+public:
+    ~FitEvaluationCache();
+
+    // 进程内共享的缓存实例 (首次访问时读取文件)；路径为空时返回空指针
+    static QSharedPointer<FitEvaluationCache> shared(const QString& filePath);
+
+    // 缓存键 (contextHash 包含产量历史等影响曲线的拟合核心状态)
+    static QByteArray makeKey(int modelType, const SolverSettings& settings, const QMap<QString, double>& params,
+                              const QVector<double>& t, quint64 contextHash);
+
+    // 64 位 FNV-1a 散列 (按位，可逐段累积)
+    static quint64 hashBytes(const void* data, qint64 size, quint64 seed = 1469598103934665603ULL);
+    static quint64 hashValues(const QVector<double>& values, quint64 seed = 1469598103934665603ULL);
+
+    // 查询与写入 (线程安全)
+    bool lookup(const QByteArray& key, ModelCurveData& curve);
+    void insert(const QByteArray& key, const ModelCurveData& curve);
+
+    // 把新增条目追加到文件 (必要时压缩重写)，返回是否成功
+    bool flush();
+
+    QString filePath() const { return m_filePath; }
+    int size() const;
+    qint64 hits() const;
+    qint64 misses() const;
+
+private:
+    explicit FitEvaluationCache(const QString& filePath);
+    FitEvaluationCache(const FitEvaluationCache&) = delete;
+    FitEvaluationCache& operator=(const FitEvaluationCache&) = delete;
+
+    void load();
+    bool rewrite();
+    bool appendRecord(QIODevice& file, const QByteArray& key, const ModelCurveData& curve);
+
+    QString m_filePath;
+    int m_capacity;          // 内存条目总数上限 (两代合计)
+    mutable QMutex m_mutex;
+    QHash<QByteArray, ModelCurveData> m_current;  // 当前代
+    QHash<QByteArray, ModelCurveData> m_previous; // 旧代 (命中时提升回当前代)
+    QVector<QByteArray> m_pending;                // 尚未写入文件的键
+    qint64 m_validSize;      // 文件中完整记录的总长度 (追加前截断到该长度)
+    int m_fileRecords;       // 文件中的记录数
+    qint64 m_hits;
+    qint64 m_misses;
+};
+
+// 拟合断点
+struct FitCheckpoint {
+    bool valid = false;
+    bool finished = false;            // 拟合是否已正常结束 (未结束的断点才可继续)
+    int modelType = 0;
+    double weight = 0.5;
+    QStringList fitNames;             // 参与拟合的参数名
+    quint64 dataHash = 0;             // 观测数据、抽样设置与产量历史的散列
+    QMap<QString, double> params;     // 当前最优参数
+    double error = 0.0;               // 对应的误差 (MSE)
+    QDateTime time;                   // 保存时刻
+
+    // 断点文件中区分不同分析的键
+    QString key() const;
+
+    // 读写断点文件 (同一文件内按 key() 合并，写入使用 QSaveFile 整体替换)
+    static bool save(const QString& filePath, const FitCheckpoint& checkpoint);
+    static FitCheckpoint load(const QString& filePath, int modelType, quint64 dataHash);
+};
+
+#endif // FITEVALUATIONCACHE_H
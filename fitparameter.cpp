@@ -0,0 +1,183 @@
+/*
+ * 文件名: fitparameter.cpp
+ * 文件作用: 拟合参数定义与默认参数表实现文件
+ * 功能描述:
+ * 1. 默认参数表、换模型时的参数继承与参数显示信息由 FittingParameterChart 的静态函数迁入，行为不变。
+ * 2. rm (复合半径) 默认值 = L，范围 [L, 10L]；LfD 随 Lf/L 联动。
+ * 3. omega1 声明为 omega2 的有序上端参数 (拟合坐标的下端随 omega2 移动)，其余参数使用自动选择的变换。
+ */
+
+#include "fitparameter.h"
+#include <QMap>
+#include <cmath>
+
+QList<FitParameter> FitParameterCatalog::defaultParameters(ModelEngine::ModelType type)
+{
+    QList<FitParameter> params;
+
+    // 辅助 Lambda: 添加参数
+    auto addParam = [&](QString name, double val, bool isFitDefault) {
+        FitParameter p;
+        p.name = name;
+        p.value = val;
+        p.isFit = isFitDefault;
+        p.isVisible = true;
+
+        // 设置范围
+        if (val > 0) {
+            p.min = val * 0.001; p.max = val * 1000.0;
+        } else {
+            p.min = 0.0; p.max = 100.0;
+        }
+
+        // 特殊范围和步长覆盖
+        if (name == "phi" || name == "mu" || name.startsWith("omega") || name.startsWith("lambda") || name == "eta12") {
+            p.step = 0.001;
+        } else if (name == "L" || name == "re" || name == "h" || name == "rm") {
+            p.step = 10.0;
+        } else if (name == "nf") {
+            p.step = 1.0; p.min = 1.0; p.max = 100.0;
+        } else if (name == "Lf") {
+            p.step = 1.0;
+        } else if (name == "S") {
+            p.step = 0.1; p.min = -5.0; p.max = 20.0;
+        } else if (name == "rw") {
+            p.step = 0.01; p.min = 0.01; p.max = 2.0;
+        } else {
+            p.step = val != 0 ? std::abs(val * 0.1) : 0.1;
+        }
+
+        QString symbol, uniSym, unit;
+        getParamDisplayInfo(p.name, p.displayName, symbol, uniSym, unit);
+        params.append(p);
+    };
+
+    // 1. 基础参数 (默认不拟合 isFit=false)
+    addParam("phi", 0.05, false);
+    addParam("h", 20.0, false);
+    addParam("rw", 0.1, false); // [新增] 井筒半径
+    addParam("mu", 0.5, false);
+    addParam("B", 1.05, false);
+    addParam("Ct", 5e-4, false);
+    addParam("q", 5.0, false);
+
+    // 2. 模型核心参数 (默认拟合 isFit=true)
+    addParam("kf", 1e-2, true);
+    addParam("M12", 10.0, true);
+    addParam("eta12", 0.2, true);
+
+    double valL = 1000.0;
+    addParam("L", valL, true);
+    addParam("Lf", 20.0, true);
+    addParam("nf", 4.0, true);
+
+    // rm: 默认值等于 L, 范围 1-10倍 L
+    {
+        FitParameter p;
+        p.name = "rm";
+        p.value = valL; // 默认值 = L
+        p.min = valL;   // 下限 = L
+        p.max = 10.0 * valL; // 上限 = 10L
+        p.step = 10.0;
+        p.isFit = true;
+        p.isVisible = true;
+        QString s, u, us;
+        getParamDisplayInfo(p.name, p.displayName, s, u, us);
+        params.append(p);
+    }
+
+    bool hasBoundary = (type == ModelEngine::Model_3 || type == ModelEngine::Model_4 ||
+                        type == ModelEngine::Model_5 || type == ModelEngine::Model_6);
+    if(hasBoundary) {
+        addParam("re", 20000.0, true);
+    }
+
+    addParam("omega1", 0.4, true);
+    params.last().orderedAbove = "omega2"; // omega1 > omega2
+    addParam("omega2", 0.08, true);
+    addParam("lambda1", 1e-3, true);
+    addParam("lambda2", 1e-4, true);
+
+    bool hasStorage = (type == ModelEngine::Model_1 || type == ModelEngine::Model_3 || type == ModelEngine::Model_5);
+    if(hasStorage) {
+        addParam("cD", 1e-7, true);
+        addParam("S", 0.01, true);
+    }
+
+    addParam("gamaD", 0.02, false);
+
+    // 3. 辅助参数 (只读)
+    {
+        FitParameter p;
+        p.name = "LfD";
+        p.displayName = "无因次缝长";
+        p.value = 0.02;
+        p.isFit = false;
+        p.isVisible = true;
+        p.step = 0.0;
+        params.append(p);
+    }
+
+    return params;
+}
+
+QList<FitParameter> FitParameterCatalog::adaptParameters(const QList<FitParameter>& current, ModelEngine::ModelType newType)
+{
+    QMap<QString, double> oldValues;
+    for(const auto& p : current) oldValues.insert(p.name, p.value);
+
+    QList<FitParameter> params = defaultParameters(newType);
+
+    // 恢复值
+    for(auto& p : params) {
+        if(oldValues.contains(p.name)) p.value = oldValues[p.name];
+    }
+
+    // 强制刷新依赖关系 (rm 范围, LfD)
+    double currentL = 1000.0;
+    for(const auto& p : params) if(p.name == "L") currentL = p.value;
+
+    for(auto& p : params) {
+        if(p.name == "rm") {
+            p.min = currentL;
+            p.max = 10.0 * currentL;
+            if(p.value < p.min) p.value = p.min;
+        }
+        if(p.name == "LfD") {
+            double currentLf = 20.0;
+            for(const auto& pp : params) if(pp.name == "Lf") currentLf = pp.value;
+            if(currentL > 1e-9) p.value = currentLf / currentL;
+        }
+    }
+    return params;
+}
+
+void FitParameterCatalog::getParamDisplayInfo(const QString &name, QString &chName, QString &symbol, QString &uniSym, QString &unit)
+{
+    if(name == "kf")          { chName = "内区渗透率";     unit = "D"; }
+    else if(name == "M12")    { chName = "流度比";         unit = "无因次"; }
+    else if(name == "L")      { chName = "水平井长";       unit = "m"; }
+    else if(name == "Lf")     { chName = "裂缝半长";       unit = "m"; }
+    else if(name == "rm")     { chName = "复合半径";       unit = "m"; }
+    else if(name == "omega1") { chName = "内区储容比";     unit = "无因次"; }
+    else if(name == "omega2") { chName = "外区储容比";     unit = "无因次"; }
+    else if(name == "lambda1"){ chName = "内区窜流系数";   unit = "无因次"; }
+    else if(name == "lambda2"){ chName = "外区窜流系数";   unit = "无因次"; }
+    else if(name == "re")     { chName = "外区半径";       unit = "m"; }
+    else if(name == "eta12")  { chName = "导压系数比";     unit = "无因次"; }
+    else if(name == "nf")     { chName = "裂缝条数";       unit = "条"; }
+    else if(name == "h")      { chName = "有效厚度";       unit = "m"; }
+    else if(name == "rw")     { chName = "井筒半径";       unit = "m"; } // [新增]
+    else if(name == "phi")    { chName = "孔隙度";         unit = "小数"; }
+    else if(name == "mu")     { chName = "流体粘度";       unit = "mPa·s"; }
+    else if(name == "B")      { chName = "体积系数";       unit = "无因次"; }
+    else if(name == "Ct")     { chName = "综合压缩系数";   unit = "MPa⁻¹"; }
+    else if(name == "q")      { chName = "测试产量";       unit = "m³/d"; }
+    else if(name == "C")      { chName = "井筒储存系数";   unit = "m³/MPa"; }
+    else if(name == "cD")     { chName = "无因次井储";     unit = "无因次"; }
+    else if(name == "S")      { chName = "表皮系数";       unit = "无因次"; }
+    else if(name == "gamaD")  { chName = "压敏系数";       unit = "无因次"; }
+    else if(name == "LfD")    { chName = "无因次缝长";     unit = "无因次"; }
+    else { chName = name; unit = ""; }
+    symbol = name; uniSym = name;
+}
@@ -0,0 +1,54 @@
+/*
+ * 文件名: fitparameter.h
+ * 文件作用: 拟合参数定义与默认参数表头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 定义拟合参数结构体 FitParameter (由 fittingparameterchart.h 中分离)。
+ * 2. FitParameterCatalog：按模型类型给出默认参数列表 (默认值、范围、步长及默认拟合勾选)、
+ *    换模型时的参数继承与参数显示信息，供参数表格、拟合核心与命令行批处理共用。
+ * 3. [参数变换] 每个参数声明拟合时的坐标变换 (log10、有界 logit) 与有序参数对 (本参数须大于另一参数)，
+ *    LM 在变换后的无约束坐标中迭代 (ParameterTransform)，不再在边界上截断。
+ */
+
+#ifndef FITPARAMETER_H
+#define FITPARAMETER_H
+
+#include <QList>
+#include <QString>
+#include "modelengine.h"
+
+// 定义拟合参数结构体
+struct FitParameter {
+    QString name;           // 参数内部标识 (如 "kf")
+    QString displayName;    // 参数显示名称 (如 "内区渗透率")
+    double value = 0.0;     // 当前值
+    bool isFit = false;     // 是否参与拟合
+    double min = 0.0;       // 最小值限制
+    double max = 100.0;     // 最大值限制
+    bool isVisible = true;  // 是否在表格中显示
+    double step = 0.1;      // 滚轮调节步长
+
+    // 拟合时的坐标变换 (见 ParameterTransform)
+    enum Transform {
+        Transform_Auto = 0,  // nf 取原值，有取值范围的参数取 logit，其余按当前值取 log10 或原值
+        Transform_Linear,    // 原值 (超出范围时截断)
+        Transform_Log,       // log10 (超出范围时截断)
+        Transform_Logit      // [min, max] 上的 logit (min > 0 时在 log10 空间)
+    };
+    Transform transform = Transform_Auto;
+    QString orderedAbove;   // 有序参数对：本参数须大于该参数 (为空时沿用 kf > km、omega1 > omega2)
+};
+
+class FitParameterCatalog
+{
+public:
+    // 指定模型的默认参数列表
+    static QList<FitParameter> defaultParameters(ModelEngine::ModelType type);
+
+    // 换为 newType 模型后的参数列表 (共有参数保留 current 中的值)
+    static QList<FitParameter> adaptParameters(const QList<FitParameter>& current, ModelEngine::ModelType newType);
+
+    // 参数显示信息 (名称, 符号, 单位等)
+    static void getParamDisplayInfo(const QString& name, QString& chName, QString& symbol, QString& uniSymbol, QString& unit);
+};
+
+#endif // FITPARAMETER_H
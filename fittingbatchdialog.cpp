@@ -0,0 +1,283 @@
+/*
+ * 文件名: fittingbatchdialog.cpp
+ * 文件作用: 批量拟合对话框实现文件
+ * 功能描述:
+ * 1. 界面由代码构建：上部为分析与候选模型的勾选列表、优先级与并发上限，中部为任务表，下部为操作按钮。
+ * 2. 任务表列：分析、模型、优先级、状态、进度、MSE、分析内排名、总排名；排名在任一任务完成时整体刷新。
+ * 3. 关闭对话框时如仍有任务运行，确认后停止全部任务 (队列析构时等待拟合线程结束)。
+ */
+
+#include "fittingbatchdialog.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QProgressBar>
+#include <QMessageBox>
+#include <QThread>
+#include <QBrush>
+#include <QColor>
+
+namespace {
+enum Column {
+    ColAnalysis = 0,
+    ColModel,
+    ColPriority,
+    ColState,
+    ColProgress,
+    ColMse,
+    ColRankInAnalysis,
+    ColRankOverall,
+    ColumnCount
+};
+}
+
+FittingBatchDialog::FittingBatchDialog(ModelManager* modelManager, const QStringList& analyses, const QString& currentAnalysis,
+                                       ModelManager::ModelType currentModel, JobFactory factory, ResultApplier applier,
+                                       QWidget* parent)
+    : QDialog(parent), m_factory(factory), m_applier(applier)
+{
+    setWindowTitle("批量拟合");
+    resize(820, 560);
+
+    m_queue = new FittingJobQueue(modelManager ? modelManager->engine() : nullptr, this);
+    connect(m_queue, &FittingJobQueue::sigJobUpdated, this, &FittingBatchDialog::onJobUpdated);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // 1. 任务选择
+    QGridLayout* selectLayout = new QGridLayout();
+    selectLayout->addWidget(new QLabel("分析页签:", this), 0, 0);
+    selectLayout->addWidget(new QLabel("候选模型:", this), 0, 1);
+
+    m_listAnalyses = new QListWidget(this);
+    for (const QString& name : analyses) {
+        QListWidgetItem* item = new QListWidgetItem(name, m_listAnalyses);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(name == currentAnalysis ? Qt::Checked : Qt::Unchecked);
+    }
+    m_listModels = new QListWidget(this);
+    const ModelManager::ModelType models[] = {ModelManager::Model_1, ModelManager::Model_2, ModelManager::Model_3,
+                                              ModelManager::Model_4, ModelManager::Model_5, ModelManager::Model_6};
+    for (ModelManager::ModelType type : models) {
+        QListWidgetItem* item = new QListWidgetItem(ModelManager::getModelTypeName(type), m_listModels);
+        item->setData(Qt::UserRole, (int)type);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(type == currentModel ? Qt::Checked : Qt::Unchecked);
+    }
+    m_listAnalyses->setMaximumHeight(140);
+    m_listModels->setMaximumHeight(140);
+    selectLayout->addWidget(m_listAnalyses, 1, 0);
+    selectLayout->addWidget(m_listModels, 1, 1);
+    mainLayout->addLayout(selectLayout);
+
+    QHBoxLayout* optionLayout = new QHBoxLayout();
+    optionLayout->addWidget(new QLabel("优先级:", this));
+    m_spinPriority = new QSpinBox(this);
+    m_spinPriority->setRange(-10, 10);
+    m_spinPriority->setToolTip("数值大的任务先运行，相同优先级按加入顺序");
+    optionLayout->addWidget(m_spinPriority);
+    optionLayout->addSpacing(20);
+    optionLayout->addWidget(new QLabel("同时运行:", this));
+    m_spinConcurrency = new QSpinBox(this);
+    m_spinConcurrency->setRange(1, qMax(1, QThread::idealThreadCount()));
+    m_spinConcurrency->setValue(m_queue->maxConcurrent());
+    optionLayout->addWidget(m_spinConcurrency);
+    optionLayout->addStretch();
+    QPushButton* btnAdd = new QPushButton("加入队列", this);
+    optionLayout->addWidget(btnAdd);
+    mainLayout->addLayout(optionLayout);
+
+    // 2. 任务表
+    m_table = new QTableWidget(this);
+    m_table->setColumnCount(ColumnCount);
+    m_table->setHorizontalHeaderLabels(QStringList() << "分析" << "模型" << "优先级" << "状态" << "进度"
+                                                     << "误差(MSE)" << "分析内排名" << "总排名");
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    mainLayout->addWidget(m_table);
+
+    m_lblStatus = new QLabel(this);
+    mainLayout->addWidget(m_lblStatus);
+
+    // 3. 操作按钮
+    QHBoxLayout* btnLayout = new QHBoxLayout();
+    QPushButton* btnStop = new QPushButton("停止选中", this);
+    QPushButton* btnStopAll = new QPushButton("全部停止", this);
+    QPushButton* btnApply = new QPushButton("应用结果", this);
+    QPushButton* btnClose = new QPushButton("关闭", this);
+    btnLayout->addWidget(btnStop);
+    btnLayout->addWidget(btnStopAll);
+    btnLayout->addStretch();
+    btnLayout->addWidget(btnApply);
+    btnLayout->addWidget(btnClose);
+    mainLayout->addLayout(btnLayout);
+
+    connect(btnAdd, &QPushButton::clicked, this, &FittingBatchDialog::onAddJobs);
+    connect(btnStop, &QPushButton::clicked, this, &FittingBatchDialog::onStopSelected);
+    connect(btnStopAll, &QPushButton::clicked, this, &FittingBatchDialog::onStopAll);
+    connect(btnApply, &QPushButton::clicked, this, &FittingBatchDialog::onApplySelected);
+    connect(btnClose, &QPushButton::clicked, this, &FittingBatchDialog::reject);
+    connect(m_table, &QTableWidget::cellDoubleClicked, this, [this](int, int) { onApplySelected(); });
+    connect(m_spinConcurrency, QOverload<int>::of(&QSpinBox::valueChanged), m_queue, &FittingJobQueue::setMaxConcurrent);
+
+    refreshStatus();
+}
+
+void FittingBatchDialog::reject()
+{
+    if (!m_queue->isIdle()) {
+        if (QMessageBox::question(this, "确认", "仍有拟合任务在运行或排队，关闭将停止全部任务。\n是否继续？")
+            != QMessageBox::Yes) return;
+        m_queue->cancelAll();
+    }
+    QDialog::reject();
+}
+
+void FittingBatchDialog::onAddJobs()
+{
+    QStringList analyses;
+    for (int i = 0; i < m_listAnalyses->count(); ++i) {
+        if (m_listAnalyses->item(i)->checkState() == Qt::Checked) analyses << m_listAnalyses->item(i)->text();
+    }
+    QList<ModelManager::ModelType> models;
+    for (int i = 0; i < m_listModels->count(); ++i) {
+        QListWidgetItem* item = m_listModels->item(i);
+        if (item->checkState() == Qt::Checked) models << (ModelManager::ModelType)item->data(Qt::UserRole).toInt();
+    }
+    if (analyses.isEmpty() || models.isEmpty()) {
+        QMessageBox::warning(this, "提示", "请至少勾选一个分析页签和一个候选模型。");
+        return;
+    }
+
+    QStringList skipped;
+    for (const QString& analysis : analyses) {
+        for (ModelManager::ModelType type : models) {
+            FittingJob job;
+            if (!m_factory || !m_factory(analysis, type, job)) {
+                if (!skipped.contains(analysis)) skipped << analysis;
+                continue;
+            }
+            job.analysisName = analysis;
+            job.modelType = type;
+            job.priority = m_spinPriority->value();
+            m_queue->addJob(job); // 表格行在首次状态通知时创建
+        }
+    }
+    if (!skipped.isEmpty()) {
+        QMessageBox::warning(this, "提示", "以下分析没有观测数据，已跳过：\n" + skipped.join("\n"));
+    }
+}
+
+void FittingBatchDialog::onStopSelected()
+{
+    const int id = selectedJobId();
+    if (id >= 0) m_queue->cancelJob(id);
+}
+
+void FittingBatchDialog::onStopAll()
+{
+    m_queue->cancelAll();
+}
+
+void FittingBatchDialog::onApplySelected()
+{
+    const int id = selectedJobId();
+    if (id < 0) return;
+    const FittingJob job = m_queue->job(id);
+    if (job.result.isEmpty()) {
+        QMessageBox::warning(this, "提示", "所选任务尚无拟合结果。");
+        return;
+    }
+    if (job.state == FittingJob::Running) {
+        QMessageBox::warning(this, "提示", "所选任务仍在运行，请等待完成或先停止。");
+        return;
+    }
+    if (m_applier) m_applier(job);
+    QMessageBox::information(this, "完成", QString("已将 %1 的拟合结果应用到分析 \"%2\"。")
+                                             .arg(ModelManager::getModelTypeName(job.modelType)).arg(job.analysisName));
+}
+
+void FittingBatchDialog::onJobUpdated(int id)
+{
+    const FittingJob job = m_queue->job(id);
+    if (job.id < 0) return;
+    if (!m_rowOfJob.contains(id)) {
+        const int newRow = m_table->rowCount();
+        m_table->insertRow(newRow);
+        for (int c = 0; c < ColumnCount; ++c) m_table->setItem(newRow, c, new QTableWidgetItem());
+        m_table->item(newRow, ColAnalysis)->setData(Qt::UserRole, id);
+        QProgressBar* bar = new QProgressBar(m_table);
+        bar->setRange(0, 100);
+        m_table->setCellWidget(newRow, ColProgress, bar);
+        m_rowOfJob.insert(id, newRow);
+    }
+    const int row = m_rowOfJob.value(id);
+
+    m_table->item(row, ColAnalysis)->setText(job.analysisName);
+    m_table->item(row, ColModel)->setText(ModelManager::getModelTypeName(job.modelType));
+    m_table->item(row, ColPriority)->setText(QString::number(job.priority));
+    m_table->item(row, ColState)->setText(stateText(job.state));
+    m_table->item(row, ColMse)->setText(job.mse >= 0.0 ? QString::number(job.mse, 'e', 3) : QString("-"));
+    if (auto bar = qobject_cast<QProgressBar*>(m_table->cellWidget(row, ColProgress))) bar->setValue(job.progress);
+
+    if (job.state == FittingJob::Finished || job.state == FittingJob::Cancelled) refreshRanking();
+    refreshStatus();
+}
+
+void FittingBatchDialog::refreshRanking()
+{
+    const QList<FittingJob> ranked = m_queue->rankedResults();
+    QMap<QString, int> countInAnalysis;
+    QMap<int, QPair<int, int>> ranks; // 任务编号 -> (分析内排名, 总排名)
+    for (int i = 0; i < ranked.size(); ++i) {
+        const int inAnalysis = ++countInAnalysis[ranked[i].analysisName];
+        ranks.insert(ranked[i].id, qMakePair(inAnalysis, i + 1));
+    }
+    for (auto it = m_rowOfJob.constBegin(); it != m_rowOfJob.constEnd(); ++it) {
+        if (it.value() >= m_table->rowCount()) continue;
+        const bool hasRank = ranks.contains(it.key());
+        m_table->item(it.value(), ColRankInAnalysis)->setText(hasRank ? QString::number(ranks[it.key()].first) : QString());
+        m_table->item(it.value(), ColRankOverall)->setText(hasRank ? QString::number(ranks[it.key()].second) : QString());
+        // 各分析内误差最小的任务高亮
+        const QBrush brush = (hasRank && ranks[it.key()].first == 1) ? QBrush(QColor(220, 240, 255)) : QBrush();
+        for (int c = 0; c < ColumnCount; ++c) m_table->item(it.value(), c)->setBackground(brush);
+    }
+}
+
+void FittingBatchDialog::refreshStatus()
+{
+    int pending = 0, finished = 0;
+    const QList<FittingJob> jobs = m_queue->jobs();
+    for (const FittingJob& job : jobs) {
+        if (job.state == FittingJob::Pending) ++pending;
+        else if (job.state == FittingJob::Finished) ++finished;
+    }
+    m_lblStatus->setText(QString("共 %1 个任务：运行中 %2，排队 %3，已完成 %4")
+                             .arg(jobs.size()).arg(m_queue->runningCount()).arg(pending).arg(finished));
+}
+
+int FittingBatchDialog::selectedJobId() const
+{
+    const int row = m_table->currentRow();
+    if (row < 0 || !m_table->item(row, ColAnalysis)) return -1;
+    bool ok = false;
+    const int id = m_table->item(row, ColAnalysis)->data(Qt::UserRole).toInt(&ok);
+    return ok ? id : -1;
+}
+
+QString FittingBatchDialog::stateText(FittingJob::State state)
+{
+    switch (state) {
+    case FittingJob::Pending: return "排队中";
+    case FittingJob::Running: return "运行中";
+    case FittingJob::Finished: return "已完成";
+    case FittingJob::Cancelled: return "已停止";
+    }
+    return QString();
+}
@@ -0,0 +1,65 @@
+/*
+ * 文件名: fittingbatchdialog.h
+ * 文件作用: 批量拟合对话框头文件
+ * 功能描述:
+ * 1. 勾选若干分析页签与候选模型 (Model_1…Model_6)，按所选优先级把每个 (分析, 模型) 组合加入批量拟合队列。
+ * 2. 任务表显示各任务的状态、进度与最终误差，已完成的任务按 MSE 升序给出排名 (同一分析内与全部任务两种排名)。
+ * 3. 可调整并发上限、停止选中或全部任务；双击或点击"应用结果"把选中任务的模型与参数写回对应的分析页签。
+ * 4. 任务所需数据由 JobFactory 在加入队列时生成，运行期间不访问分析页签，对话框为模态。
+ */
+
+#ifndef FITTINGBATCHDIALOG_H
+#define FITTINGBATCHDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include <QTableWidget>
+#include <QSpinBox>
+#include <QLabel>
+#include <functional>
+#include "modelmanager.h"
+#include "fittingjobqueue.h"
+
+class FittingBatchDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    // 由分析名称与模型生成任务 (失败时返回 false，如该分析没有观测数据)
+    using JobFactory = std::function<bool(const QString& analysis, ModelManager::ModelType type, FittingJob& job)>;
+    // 把任务结果写回分析页签
+    using ResultApplier = std::function<void(const FittingJob& job)>;
+
+    FittingBatchDialog(ModelManager* modelManager, const QStringList& analyses, const QString& currentAnalysis,
+                       ModelManager::ModelType currentModel, JobFactory factory, ResultApplier applier,
+                       QWidget* parent = nullptr);
+
+protected:
+    void reject() override;
+
+private slots:
+    void onAddJobs();
+    void onStopSelected();
+    void onStopAll();
+    void onApplySelected();
+    void onJobUpdated(int id);
+
+private:
+    FittingJobQueue* m_queue;
+    JobFactory m_factory;
+    ResultApplier m_applier;
+
+    QListWidget* m_listAnalyses;
+    QListWidget* m_listModels;
+    QSpinBox* m_spinPriority;
+    QSpinBox* m_spinConcurrency;
+    QTableWidget* m_table;
+    QLabel* m_lblStatus;
+    QMap<int, int> m_rowOfJob; // 任务编号 -> 表格行
+
+    void refreshRanking();
+    void refreshStatus();
+    int selectedJobId() const;
+    static QString stateText(FittingJob::State state);
+};
+
+#endif // FITTINGBATCHDIALOG_H
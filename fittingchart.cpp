@@ -4,16 +4,39 @@
  * 修改记录:
  * 1. [修复] 强制使用 QCPAxisTickerLog 和 setNumberFormat("eb")，解决科学计数法不生效及切换标签页重置的问题。
  * 2. [健壮性] 在 plotLogLog 和 plotSemiLog 中显式设置 Ticker，确保坐标轴行为一致。
+ * 3. [共享数据集] 观测数据以 ObservedDataset 句柄保存；双对数图的有效点取自数据集缓存的 logPositive 视图。
+ * 4. [分层重绘] 实测数据、抽样点与标注只在观测数据或试井设置变化 (或曲线被外部清除) 时重建；
+ *    理论曲线只更新数据，坐标轴范围保持不变，重绘合并到下一帧并只重绘模型层。
+ * 5. [性能跟踪] plotAll 记录跟踪区间 (tracing.h)。
+ * 6. [显示缓冲] 实测曲线经 GraphLod 写入：与数据集共用数组 (不再为每张图建立完整的 QCPGraphData 副本)，
+ *    点数很多时只显示抽稀的可见点；半对数与直角坐标图的实测曲线仅供显示，数组释放后改为紧凑存储。
+ *    双对数图的实测曲线由导出功能读回，保持 double。
+ * 7. [派生序列] Horner 时间比与降落模式的有效点经 ObservedDataset::derived 缓存 (键为 "semiLog:horner:<tp>" / "semiLog:drawdown")，
+ *    重建静态层与 Horner 回归共用同一份序列；每次刷新只换算理论曲线。
  */
 
 #include "fittingchart.h"
+#include "graphlod.h"
+#include "memoryaccounting.h"
+#include "tracing.h"
 #include <cmath>
 #include <algorithm>
 #include <QDebug>
 
+namespace {
+
+const char* kObservedLayer = "observed";
+const char* kModelLayer = "model";
+const int kFrameInterval = 16; // 重绘合并间隔 (ms)，约 60 帧/秒
+
+} // namespace
+
 FittingChart::FittingChart(QObject *parent)
-    : QObject(parent), m_plotLogLog(nullptr), m_plotSemiLog(nullptr), m_plotCartesian(nullptr), m_calculatedPi(0.0)
+    : QObject(parent), m_plotLogLog(nullptr), m_plotSemiLog(nullptr), m_plotCartesian(nullptr),
+      m_observed(ObservedDataset::empty()), m_calculatedPi(0.0), m_staticValid(false)
 {
+    m_replotTimer.setSingleShot(true);
+    connect(&m_replotTimer, &QTimer::timeout, this, &FittingChart::flushReplots);
 }
 
 void FittingChart::initializeCharts(MouseZoom* logLog, MouseZoom* semiLog, MouseZoom* cartesian)
@@ -21,86 +44,182 @@ void FittingChart::initializeCharts(MouseZoom* logLog, MouseZoom* semiLog, Mouse
     m_plotLogLog = logLog;
     m_plotSemiLog = semiLog;
     m_plotCartesian = cartesian;
+    m_charts[Chart_LogLog].plot = logLog;
+    m_charts[Chart_SemiLog].plot = semiLog;
+    m_charts[Chart_Cartesian].plot = cartesian;
+    m_staticValid = false;
 }
 
 void FittingChart::setObservedData(const QVector<double>& t, const QVector<double>& deltaP,
                                    const QVector<double>& deriv, const QVector<double>& rawP)
 {
-    m_obsT = t;
-    m_obsDeltaP = deltaP;
-    m_obsDeriv = deriv;
-    m_obsRawP = rawP;
+    setObservedDataset(ObservedDataset::create(t, deltaP, deriv, rawP));
+}
+
+void FittingChart::setObservedDataset(const ObservedDataset::Handle& dataset)
+{
+    const ObservedDataset::Handle next = dataset ? dataset : ObservedDataset::empty();
+    if (next != m_observed) m_staticValid = false;
+    m_observed = next;
 }
 
 void FittingChart::setSettings(const FittingDataSettings& settings)
 {
+    if (settings.testType != m_settings.testType || settings.producingTime != m_settings.producingTime)
+        m_staticValid = false;
     m_settings = settings;
 }
 
 void FittingChart::plotAll(const QVector<double>& t_model, const QVector<double>& p_model, const QVector<double>& d_model, bool isModelValid)
 {
+    WT_TRACE_SCOPE("FittingChart::plotAll");
+    WT_MEMORY_SCOPE(MemoryAccounting::Plotting);
     if (!m_plotLogLog || !m_plotSemiLog || !m_plotCartesian) return;
 
-    plotLogLog(t_model, p_model, d_model, isModelValid);
-    plotSemiLog(t_model, p_model, d_model, isModelValid);
-    plotCartesian(t_model, p_model, d_model, isModelValid);
+    const bool rebuild = needsRebuild();
+    if (rebuild) {
+        buildSemiLog(); // 先算出 Horner 推算的 Pi，双对数图上的标注要用到
+        buildLogLog();
+        buildCartesian();
+        m_staticValid = true;
+    }
 
-    m_plotLogLog->replot();
-    m_plotSemiLog->replot();
-    m_plotCartesian->replot();
+    updateModelGraphs(t_model, p_model, d_model, isModelValid);
+
+    // 静态层不变时保持坐标轴范围，否则缓存的实测数据层会失效；没有实测数据时按理论曲线确定范围
+    if (rebuild || m_observed->isEmpty()) {
+        rescaleCharts();
+        for (ChartState& chart : m_charts) markDirty(chart, true);
+    }
+    requestReplot();
 }
 
-void FittingChart::plotLogLog(const QVector<double>& tm, const QVector<double>& pm, const QVector<double>& dm, bool hasModel)
+bool FittingChart::needsRebuild() const
 {
-    MouseZoom* plot = m_plotLogLog;
-    plot->clearGraphs();
-    plot->clearItems(); // 清除旧的文本框
+    if (!m_staticValid) return true;
+    // 其他代码调用过 clearGraphs 等会删除曲线
+    for (const ChartState& chart : m_charts) {
+        for (const QPointer<QCPGraph>& g : chart.staticGraphs) if (!g) return true;
+        for (const QPointer<QCPGraph>& g : chart.modelGraphs) if (!g) return true;
+    }
+    return !m_sampledP || !m_sampledD;
+}
 
-    // 1. 实测数据
-    QVector<double> vt, vp, vd;
-    for(int i=0; i<m_obsT.size(); ++i) {
-        if (m_obsT[i] > 1e-10 && m_obsDeltaP[i] > 1e-10) {
-            vt << m_obsT[i];
-            vp << m_obsDeltaP[i];
-            if (i < m_obsDeriv.size() && m_obsDeriv[i] > 1e-10) vd << m_obsDeriv[i];
-            else vd << 1e-10; // log scale placeholder
-        }
+void FittingChart::resetChart(ChartState& chart)
+{
+    MouseZoom* plot = chart.plot;
+    plot->clearGraphs();
+    chart.staticGraphs.clear();
+    chart.modelGraphs.clear();
+    chart.extraGraphs.clear();
+
+    // 静态层与模型层各自拥有缓冲：只有模型层变化时只需重绘模型层
+    if (!plot->layer(kObservedLayer)) {
+        plot->addLayer(kObservedLayer, plot->layer("main"), QCustomPlot::limAbove);
+        plot->layer(kObservedLayer)->setMode(QCPLayer::lmBuffered);
+    }
+    if (!plot->layer(kModelLayer)) {
+        plot->addLayer(kModelLayer, plot->layer(kObservedLayer), QCustomPlot::limAbove);
+        plot->layer(kModelLayer)->setMode(QCPLayer::lmBuffered);
     }
+    markDirty(chart, true);
+}
 
-    plot->addGraph(); // 0: 实测压差
-    plot->graph(0)->setData(vt, vp);
-    plot->graph(0)->setPen(Qt::NoPen);
-    plot->graph(0)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 100, 0), 6));
-    plot->graph(0)->setName("实测压差");
+QCPGraph* FittingChart::addStaticGraph(ChartState& chart)
+{
+    QCPGraph* graph = chart.plot->addGraph();
+    graph->setLayer(kObservedLayer);
+    chart.staticGraphs.append(graph);
+    return graph;
+}
 
-    plot->addGraph(); // 1: 实测导数
-    plot->graph(1)->setData(vt, vd);
-    plot->graph(1)->setPen(Qt::NoPen);
-    plot->graph(1)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, Qt::magenta, 6));
-    plot->graph(1)->setName("实测导数");
+QCPGraph* FittingChart::addModelGraph(ChartState& chart)
+{
+    QCPGraph* graph = chart.plot->addGraph();
+    graph->setLayer(kModelLayer);
+    chart.modelGraphs.append(graph);
+    return graph;
+}
 
-    // 2. 理论曲线
-    if (hasModel) {
-        QVector<double> vtm, vpm, vdm;
-        for(int i=0; i<tm.size(); ++i) {
-            if(tm[i] > 1e-10) {
-                vtm << tm[i];
-                vpm << (pm[i] > 1e-10 ? pm[i] : 1e-10);
-                vdm << (dm[i] > 1e-10 ? dm[i] : 1e-10);
-            }
-        }
-        plot->addGraph(); // 2: 理论压差
-        plot->graph(2)->setData(vtm, vpm);
-        plot->graph(2)->setPen(QPen(Qt::red, 2));
-        plot->graph(2)->setName("理论压差");
-
-        plot->addGraph(); // 3: 理论导数
-        plot->graph(3)->setData(vtm, vdm);
-        plot->graph(3)->setPen(QPen(Qt::blue, 2));
-        plot->graph(3)->setName("理论导数");
+void FittingChart::markDirty(ChartState& chart, bool full)
+{
+    chart.dirty = true;
+    chart.fullReplot = chart.fullReplot || full;
+}
+
+void FittingChart::requestReplot()
+{
+    for (ChartState& chart : m_charts) {
+        if (chart.plot && !chart.dirty) markDirty(chart, false);
     }
+    if (m_replotTimer.isActive()) return;
+    const qint64 elapsed = m_lastFlush.isValid() ? m_lastFlush.elapsed() : kFrameInterval;
+    m_replotTimer.start(int(qMax<qint64>(0, kFrameInterval - elapsed)));
+}
 
-    // 3. 设置坐标轴范围与格式 [核心修改]
+void FittingChart::flushReplots()
+{
+    m_lastFlush.start();
+    for (ChartState& chart : m_charts) {
+        if (!chart.plot || !chart.dirty) continue;
+        QCPLayer* model = chart.plot->layer(kModelLayer);
+        if (chart.fullReplot || !model) chart.plot->replot();
+        else model->replot(); // 缓冲失效时 QCPLayer 自行改为整图重绘
+        chart.dirty = false;
+        chart.fullReplot = false;
+    }
+}
+
+void FittingChart::buildLogLog()
+{
+    ChartState& chart = m_charts[Chart_LogLog];
+    MouseZoom* plot = m_plotLogLog;
+    plot->clearItems(); // 清除旧的文本框
+    resetChart(chart);
+
+    // 1. 实测数据
+    // 有效点的筛选结果缓存在数据集上，迭代刷新时不再逐点筛选
+    const ObservedDataset::Series positive = m_observed->logPositive();
+    const QVector<double>& vt = positive.t;
+    const QVector<double>& vp = positive.p;
+    const QVector<double>& vd = positive.d;
+
+    QCPGraph* obsP = addStaticGraph(chart); // 0: 实测压差
+    GraphLod::setGraphData(obsP, vt, vp);
+    obsP->setPen(Qt::NoPen);
+    obsP->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 100, 0), 6));
+    obsP->setName("实测压差");
+
+    QCPGraph* obsD = addStaticGraph(chart); // 1: 实测导数
+    GraphLod::setGraphData(obsD, vt, vd);
+    obsD->setPen(Qt::NoPen);
+    obsD->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, Qt::magenta, 6));
+    obsD->setName("实测导数");
+
+    // 2. 理论曲线 (数据由 updateModelGraphs 写入)
+    QCPGraph* modelP = addModelGraph(chart); // 2: 理论压差
+    modelP->setPen(QPen(Qt::red, 2));
+    modelP->setName("理论压差");
+
+    QCPGraph* modelD = addModelGraph(chart); // 3: 理论导数
+    modelD->setPen(QPen(Qt::blue, 2));
+    modelD->setName("理论导数");
+
+    // 3. 抽样点 (位于实测数据层，由 plotSampledPoints 写入)
+    m_sampledP = addStaticGraph(chart);
+    m_sampledP->setPen(Qt::NoPen);
+    m_sampledP->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QPen(QColor(0, 100, 0)), QBrush(QColor(0, 100, 0)), 6));
+    m_sampledP->setName("抽样压差");
+
+    m_sampledD = addStaticGraph(chart);
+    m_sampledD->setPen(Qt::NoPen);
+    m_sampledD->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, QPen(Qt::magenta), QBrush(Qt::magenta), 6));
+    m_sampledD->setName("抽样导数");
+    m_sampledT.clear();
+    m_sampledPValues.clear();
+    m_sampledDValues.clear();
+
+    // 4. 设置坐标轴格式 [核心修改]
     plot->xAxis->setLabel("时间 Time (h)");
     plot->yAxis->setLabel("压差 & 导数 (MPa)");
 
@@ -119,45 +238,71 @@ void FittingChart::plotLogLog(const QVector<double>& tm, const QVector<double>&
     plot->yAxis->setNumberFormat("eb");
     plot->yAxis->setNumberPrecision(1);
 
-    plot->rescaleAxes();
-    // 稍微扩展范围
-    plot->xAxis->scaleRange(1.1, plot->xAxis->range().center());
-    plot->yAxis->scaleRange(1.1, plot->yAxis->range().center());
-
-    // 4. 显示计算结果
+    // 5. 显示计算结果
     if (m_settings.testType == Test_Buildup && m_calculatedPi > 1e-6) {
         showResultOnLogPlot();
     }
 }
 
-void FittingChart::plotSemiLog(const QVector<double>& tm, const QVector<double>& pm, const QVector<double>& dm, bool hasModel)
+bool FittingChart::isHornerMode() const
 {
-    MouseZoom* plot = m_plotSemiLog;
-    plot->clearGraphs();
-    Q_UNUSED(dm);
+    return m_settings.testType == Test_Buildup && m_settings.producingTime > 0;
+}
 
-    // 判断模式：压力降落(Drawdown) vs 压力恢复(Buildup)
-    if (m_settings.testType == Test_Buildup && m_settings.producingTime > 0) {
-        // === 压力恢复 Horner Plot 模式 ===
-        QVector<double> hornerX, hornerY;
-        double tp = m_settings.producingTime;
-
-        for(int i=0; i<m_obsT.size(); ++i) {
-            double dt = m_obsT[i];
-            if (dt > 1e-6 && i < m_obsRawP.size()) {
-                double val = (tp + dt) / dt;
-                if (val > 0) {
-                    hornerX << log10(val); // 绘制的是 log 值
-                    hornerY << m_obsRawP[i];
+ObservedDataset::Series FittingChart::semiLogSeries() const
+{
+    if (isHornerMode()) {
+        const double tp = m_settings.producingTime;
+        return m_observed->derived("semiLog:horner:" + QString::number(tp, 'g', 17), [tp](const ObservedDataset& data) {
+            ObservedDataset::Series s;
+            const QVector<double>& obsT = data.time();
+            const QVector<double>& obsRawP = data.rawPressure();
+            for(int i=0; i<obsT.size(); ++i) {
+                double dt = obsT[i];
+                if (dt > 1e-6 && i < obsRawP.size()) {
+                    double val = (tp + dt) / dt;
+                    if (val > 0) {
+                        s.t << dt;
+                        s.p << obsRawP[i];
+                        s.d << log10(val); // 绘制的是 log 值
+                    }
                 }
             }
+            return s;
+        });
+    }
+    return m_observed->derived("semiLog:drawdown", [](const ObservedDataset& data) {
+        ObservedDataset::Series s;
+        const QVector<double>& obsT = data.time();
+        const QVector<double>& obsP = data.deltaP();
+        for(int i=0; i<obsT.size(); ++i) {
+            if(obsT[i] > 1e-10) {
+                s.t << obsT[i];
+                s.p << obsP[i];
+            }
         }
+        return s;
+    });
+}
 
-        plot->addGraph();
-        plot->graph(0)->setData(hornerX, hornerY);
-        plot->graph(0)->setPen(Qt::NoPen);
-        plot->graph(0)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 0, 180), 5));
-        plot->graph(0)->setName("实测压力");
+void FittingChart::buildSemiLog()
+{
+    ChartState& chart = m_charts[Chart_SemiLog];
+    MouseZoom* plot = m_plotSemiLog;
+    resetChart(chart);
+    const ObservedDataset::Series series = semiLogSeries();
+
+    // 判断模式：压力降落(Drawdown) vs 压力恢复(Buildup)
+    if (isHornerMode()) {
+        // === 压力恢复 Horner Plot 模式 ===
+        const QVector<double>& hornerX = series.d;
+        const QVector<double>& hornerY = series.p;
+
+        QCPGraph* obs = addStaticGraph(chart);
+        GraphLod::setDisplayData(obs, hornerX, hornerY);
+        obs->setPen(Qt::NoPen);
+        obs->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 0, 180), 5));
+        obs->setName("实测压力");
 
         // 计算并绘制拟合直线
         m_calculatedPi = calculateHornerPressure();
@@ -170,10 +315,10 @@ void FittingChart::plotSemiLog(const QVector<double>& tm, const QVector<double>&
             double yAnchor = (nPoints > 0) ? hornerY.first() : m_calculatedPi;
             lineY << yAnchor << m_calculatedPi;
 
-            plot->addGraph();
-            plot->graph(1)->setData(lineX, lineY);
-            plot->graph(1)->setPen(QPen(Qt::red, 2, Qt::DashLine));
-            plot->graph(1)->setName("Horner 拟合线");
+            QCPGraph* line = addStaticGraph(chart);
+            line->setData(lineX, lineY);
+            line->setPen(QPen(Qt::red, 2, Qt::DashLine));
+            line->setName("Horner 拟合线");
         }
 
         plot->xAxis->setLabel("Horner 时间比 lg((tp+dt)/dt)");
@@ -191,39 +336,18 @@ void FittingChart::plotSemiLog(const QVector<double>& tm, const QVector<double>&
         plot->yAxis->setNumberFormat("gb");
 
         plot->xAxis->setRangeReversed(true); // Horner 图习惯 X 轴从大到小
-        plot->rescaleAxes();
-        double upperX = plot->xAxis->range().upper;
-        plot->xAxis->setRange(upperX, 0.0);
 
     } else {
         // === 压力降落 (Drawdown) ===
-        QVector<double> vt, vp;
-        for(int i=0; i<m_obsT.size(); ++i) {
-            if(m_obsT[i] > 1e-10) {
-                vt << m_obsT[i];
-                vp << m_obsDeltaP[i];
-            }
-        }
+        QCPGraph* obs = addStaticGraph(chart);
+        GraphLod::setDisplayData(obs, series.t, series.p);
+        obs->setPen(Qt::NoPen);
+        obs->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 100, 0), 6));
+        obs->setName("实测压差");
 
-        plot->addGraph();
-        plot->graph(0)->setData(vt, vp);
-        plot->graph(0)->setPen(Qt::NoPen);
-        plot->graph(0)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 100, 0), 6));
-        plot->graph(0)->setName("实测压差");
-
-        if (hasModel) {
-            QVector<double> vtm, vpm;
-            for(int i=0; i<tm.size(); ++i) {
-                if(tm[i] > 1e-10) {
-                    vtm << tm[i];
-                    vpm << (pm[i] > 1e-10 ? pm[i] : 1e-10);
-                }
-            }
-            plot->addGraph();
-            plot->graph(1)->setData(vtm, vpm);
-            plot->graph(1)->setPen(QPen(Qt::red, 2));
-            plot->graph(1)->setName("理论压差");
-        }
+        QCPGraph* model = addModelGraph(chart);
+        model->setPen(QPen(Qt::red, 2));
+        model->setName("理论压差");
 
         plot->xAxis->setLabel("时间 Time (h)");
         plot->yAxis->setLabel("压差 Delta P (MPa)");
@@ -242,39 +366,25 @@ void FittingChart::plotSemiLog(const QVector<double>& tm, const QVector<double>&
         plot->yAxis->setNumberFormat("gb");
 
         plot->xAxis->setRangeReversed(false);
-        plot->rescaleAxes();
     }
 }
 
-void FittingChart::plotCartesian(const QVector<double>& tm, const QVector<double>& pm, const QVector<double>& dm, bool hasModel)
+void FittingChart::buildCartesian()
 {
+    ChartState& chart = m_charts[Chart_Cartesian];
     MouseZoom* plot = m_plotCartesian;
-    plot->clearGraphs();
-    Q_UNUSED(dm);
+    resetChart(chart);
 
-    QVector<double> vt, vp;
-    for(int i=0; i<m_obsT.size(); ++i) {
-        vt << m_obsT[i];
-        vp << m_obsDeltaP[i];
-    }
+    // 数组与数据集隐式共享，不再逐点复制
+    QCPGraph* obs = addStaticGraph(chart);
+    GraphLod::setDisplayData(obs, m_observed->time(), m_observed->deltaP());
+    obs->setPen(Qt::NoPen);
+    obs->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 100, 0), 6));
+    obs->setName("实测压差");
 
-    plot->addGraph();
-    plot->graph(0)->setData(vt, vp);
-    plot->graph(0)->setPen(Qt::NoPen);
-    plot->graph(0)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 100, 0), 6));
-    plot->graph(0)->setName("实测压差");
-
-    if (hasModel) {
-        QVector<double> vtm, vpm;
-        for(int i=0; i<tm.size(); ++i) {
-            vtm << tm[i];
-            vpm << pm[i];
-        }
-        plot->addGraph();
-        plot->graph(1)->setData(vtm, vpm);
-        plot->graph(1)->setPen(QPen(Qt::red, 2));
-        plot->graph(1)->setName("理论压差");
-    }
+    QCPGraph* model = addModelGraph(chart);
+    model->setPen(QPen(Qt::red, 2));
+    model->setName("理论压差");
 
     plot->xAxis->setLabel("时间 Time (h)");
     plot->yAxis->setLabel("压差 Delta P (MPa)");
@@ -288,41 +398,115 @@ void FittingChart::plotCartesian(const QVector<double>& tm, const QVector<double
     plot->yAxis->setTicker(linearTicker);
     plot->yAxis->setScaleType(QCPAxis::stLinear);
     plot->yAxis->setNumberFormat("gb");
+}
 
-    plot->rescaleAxes();
+void FittingChart::updateModelGraphs(const QVector<double>& tm, const QVector<double>& pm, const QVector<double>& dm, bool hasModel)
+{
+    // 上一次的敏感性曲线：图例随之变化，需要整图重绘
+    for (ChartState& chart : m_charts) {
+        if (chart.extraGraphs.isEmpty()) continue;
+        for (const QPointer<QCPGraph>& g : chart.extraGraphs) if (g) chart.plot->removeGraph(g);
+        chart.extraGraphs.clear();
+        markDirty(chart, true);
+    }
+
+    // 双对数图：t > 0 的点，压差与导数以 1e-10 作为下限
+    QVector<double> vtm, vpm, vdm;
+    if (hasModel) {
+        vtm.reserve(tm.size());
+        vpm.reserve(tm.size());
+        vdm.reserve(tm.size());
+        for(int i=0; i<tm.size(); ++i) {
+            if(tm[i] > 1e-10) {
+                vtm << tm[i];
+                vpm << (pm[i] > 1e-10 ? pm[i] : 1e-10);
+                vdm << (i < dm.size() && dm[i] > 1e-10 ? dm[i] : 1e-10);
+            }
+        }
+    }
+    const QList<QPointer<QCPGraph>>& logModels = m_charts[Chart_LogLog].modelGraphs;
+    logModels[0]->setData(vtm, vpm);
+    logModels[1]->setData(vtm, vdm);
+
+    // 半对数图 (降落模式；Horner 模式不画理论曲线)
+    const QList<QPointer<QCPGraph>>& semiModels = m_charts[Chart_SemiLog].modelGraphs;
+    if (!semiModels.isEmpty()) semiModels[0]->setData(vtm, vpm);
+
+    // 笛卡尔图
+    const QList<QPointer<QCPGraph>>& cartModels = m_charts[Chart_Cartesian].modelGraphs;
+    if (hasModel) cartModels[0]->setData(tm, pm);
+    else cartModels[0]->data()->clear();
+}
+
+void FittingChart::rescaleCharts()
+{
+    m_plotLogLog->rescaleAxes();
+    // 稍微扩展范围
+    m_plotLogLog->xAxis->scaleRange(1.1, m_plotLogLog->xAxis->range().center());
+    m_plotLogLog->yAxis->scaleRange(1.1, m_plotLogLog->yAxis->range().center());
+
+    m_plotSemiLog->rescaleAxes();
+    if (m_settings.testType == Test_Buildup && m_settings.producingTime > 0) {
+        double upperX = m_plotSemiLog->xAxis->range().upper;
+        m_plotSemiLog->xAxis->setRange(upperX, 0.0);
+    }
+
+    m_plotCartesian->rescaleAxes();
 }
 
 void FittingChart::plotSampledPoints(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
 {
     if (!m_plotLogLog) return;
+    if (!m_sampledP || !m_sampledD) {
+        // 静态层尚未建立 (plotAll 之前调用)：先建立，坐标轴范围在下一次 plotAll 时确定
+        if (!m_plotSemiLog || !m_plotCartesian) return;
+        buildSemiLog();
+        buildLogLog();
+        buildCartesian();
+        m_staticValid = true;
+    }
+    // 抽样结果缓存在数据集上，与上次相同时 (通常共享同一数组) 不重绘静态层
+    if (m_sampledT == t && m_sampledPValues == p && m_sampledDValues == d) return;
+    m_sampledT = t;
+    m_sampledPValues = p;
+    m_sampledDValues = d;
+    m_sampledP->setData(t, p);
+    m_sampledD->setData(t, d);
+    markDirty(m_charts[Chart_LogLog], true);
+    requestReplot();
+}
+
+void FittingChart::clearSampledPoints()
+{
+    if (m_sampledT.isEmpty() && m_sampledPValues.isEmpty() && m_sampledDValues.isEmpty()) return;
+    plotSampledPoints(QVector<double>(), QVector<double>(), QVector<double>());
+}
 
-    QCPGraph* gP = m_plotLogLog->addGraph();
-    gP->setData(t, p);
-    gP->setPen(Qt::NoPen);
-    gP->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QPen(QColor(0, 100, 0)), QBrush(QColor(0, 100, 0)), 6));
-    gP->setName("抽样压差");
-
-    QCPGraph* gD = m_plotLogLog->addGraph();
-    gD->setData(t, d);
-    gD->setPen(Qt::NoPen);
-    gD->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, QPen(Qt::magenta), QBrush(Qt::magenta), 6));
-    gD->setName("抽样导数");
+QCPGraph* FittingChart::addSensitivityGraph()
+{
+    if (!m_plotLogLog) return nullptr;
+    ChartState& chart = m_charts[Chart_LogLog];
+    QCPGraph* graph = chart.plot->addGraph();
+    graph->setLayer(kModelLayer);
+    chart.extraGraphs.append(graph);
+    markDirty(chart, true);
+    return graph;
 }
 
 double FittingChart::calculateHornerPressure()
 {
     // 简单的线性回归，基于最后一部分数据 (径向流阶段)
-    if (m_obsT.isEmpty() || m_obsRawP.isEmpty() || m_settings.producingTime <= 0) return 0.0;
+    if (m_observed->isEmpty() || m_observed->rawPressure().isEmpty() || !isHornerMode()) return 0.0;
 
+    // 取自半对数图的 Horner 序列 (Δt > 1e-6)，回归只用 Δt > 1e-5 的点
+    const ObservedDataset::Series series = semiLogSeries();
     QVector<double> X, Y;
-    for(int i=0; i<m_obsT.size(); ++i) {
-        double dt = m_obsT[i];
-        if(dt > 1e-5 && i < m_obsRawP.size()) {
-            double val = (m_settings.producingTime + dt) / dt;
-            if(val > 0) {
-                X << log10(val);
-                Y << m_obsRawP[i];
-            }
+    X.reserve(series.t.size());
+    Y.reserve(series.t.size());
+    for(int i=0; i<series.t.size(); ++i) {
+        if(series.t[i] > 1e-5) {
+            X << series.d[i];
+            Y << series.p[i];
         }
     }
 
@@ -361,6 +545,7 @@ void FittingChart::showResultOnLogPlot()
     if(!m_plotLogLog) return;
 
     QCPItemText *textLabel = new QCPItemText(m_plotLogLog);
+    textLabel->setLayer(kObservedLayer);
     textLabel->setPositionAlignment(Qt::AlignTop|Qt::AlignRight);
     textLabel->position->setType(QCPItemPosition::ptAxisRectRatio);
     textLabel->position->setCoords(0.95, 0.05); // 右上角
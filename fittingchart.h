@@ -5,6 +5,11 @@
  * 1. 统一管理 LogLog(双对数), SemiLog(半对数), Cartesian(笛卡尔) 三个图表的绘制。
  * 2. 实现不同试井类型（降落/恢复）的差异化绘图逻辑。
  * 3. 针对恢复试井，在半对数图上绘制 Horner Plot 并计算初始地层压力。
+ * 4. 观测数据以共享的 ObservedDataset 句柄保存。
+ * 5. [分层重绘] 实测数据、抽样点与标注放在独立缓冲的静态层 ("observed")，理论曲线放在其上的模型层 ("model")：
+ *    观测数据与试井设置不变时 plotAll 只更新理论曲线的数据并只重绘模型层；重绘请求在同一帧内合并，最多约 60 次/秒。
+ * 6. [派生序列] 半对数图的实测序列 (Horner 时间比或 t > 0 的压差) 登记为数据集的派生视图，键含生产时间：
+ *    静态层重建 (曲线被外部清除、切换回已用过的数据集或设置) 与 Horner 回归直接复用，不再逐点换算。
  */
 
 #ifndef FITTINGCHART_H
@@ -12,8 +17,13 @@
 
 #include <QObject>
 #include <QVector>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "mousezoom.h"
 #include "fittingdatadialog.h" // 引入 FittingDataSettings
+#include "observeddataset.h"
 
 class FittingChart : public QObject
 {
@@ -28,6 +38,8 @@ public:
     // rawP: 原始实测压力（非压差）
     void setObservedData(const QVector<double>& t, const QVector<double>& deltaP,
                          const QVector<double>& deriv, const QVector<double>& rawP);
+    // 共享数据集句柄 (不复制数组)
+    void setObservedDataset(const ObservedDataset::Handle& dataset);
 
     // 更新设置（主要用于获取试井类型和tp）
     void setSettings(const FittingDataSettings& settings);
@@ -36,30 +48,74 @@ public:
     // t_model, p_model, d_model: 理论曲线数据
     void plotAll(const QVector<double>& t_model, const QVector<double>& p_model, const QVector<double>& d_model, bool isModelValid);
 
-    // 绘制抽样点（调试用）
+    // 绘制抽样点（调试用）：保留到下一次调用或 clearSampledPoints
     void plotSampledPoints(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
+    void clearSampledPoints();
+
+    // 敏感性分析：在双对数图的模型层追加一条曲线 (下一次 plotAll 时移除)
+    QCPGraph* addSensitivityGraph();
+
+    // 请求重绘：合并到下一帧执行，只有模型层变化的图表只重绘模型层
+    void requestReplot();
 
     // 获取计算出的初始压力（仅恢复试井有效）
     double getCalculatedInitialPressure() const;
 
+private slots:
+    void flushReplots();
+
 private:
+    enum ChartIndex { Chart_LogLog = 0, Chart_SemiLog, Chart_Cartesian, Chart_Count };
+
+    // 单个图表的分层状态
+    struct ChartState {
+        MouseZoom* plot = nullptr;
+        QList<QPointer<QCPGraph>> staticGraphs; // 静态层上的曲线 (实测数据、Horner 拟合线、抽样点)
+        QList<QPointer<QCPGraph>> modelGraphs;  // 模型层上的固定理论曲线
+        QList<QPointer<QCPGraph>> extraGraphs;  // 模型层上的敏感性曲线
+        bool dirty = false;       // 有待执行的重绘
+        bool fullReplot = false;  // 需要整图重绘 (静态层、坐标轴或图例发生变化)
+    };
+
     MouseZoom* m_plotLogLog;
     MouseZoom* m_plotSemiLog;
     MouseZoom* m_plotCartesian;
 
-    // 观测数据
-    QVector<double> m_obsT;
-    QVector<double> m_obsDeltaP;
-    QVector<double> m_obsDeriv;
-    QVector<double> m_obsRawP; // 原始压力
+    ChartState m_charts[Chart_Count];
+    bool m_staticValid;        // 静态层与当前观测数据、设置一致
+    QPointer<QCPGraph> m_sampledP;
+    QPointer<QCPGraph> m_sampledD;
+    QVector<double> m_sampledT, m_sampledPValues, m_sampledDValues; // 当前显示的抽样点
+    QTimer m_replotTimer;
+    QElapsedTimer m_lastFlush;
+
+    // 观测数据 (含原始压力)
+    ObservedDataset::Handle m_observed;
 
     FittingDataSettings m_settings;
     double m_calculatedPi; // 计算出的初始地层压力
 
-    // 内部绘图函数
-    void plotLogLog(const QVector<double>& tm, const QVector<double>& pm, const QVector<double>& dm, bool hasModel);
-    void plotSemiLog(const QVector<double>& tm, const QVector<double>& pm, const QVector<double>& dm, bool hasModel);
-    void plotCartesian(const QVector<double>& tm, const QVector<double>& pm, const QVector<double>& dm, bool hasModel);
+    // 内部绘图函数：重建静态层 (实测数据、坐标轴格式、空的理论曲线)
+    void buildLogLog();
+    void buildSemiLog();
+    void buildCartesian();
+    // 更新模型层的理论曲线数据
+    void updateModelGraphs(const QVector<double>& tm, const QVector<double>& pm, const QVector<double>& dm, bool hasModel);
+    // 按当前数据重新确定坐标轴范围
+    void rescaleCharts();
+
+    // 静态层是否需要重建 (观测数据或设置变化，或曲线被外部清除)
+    bool needsRebuild() const;
+    // 清空图表并建立静态层与模型层
+    void resetChart(ChartState& chart);
+    QCPGraph* addStaticGraph(ChartState& chart);
+    QCPGraph* addModelGraph(ChartState& chart);
+    void markDirty(ChartState& chart, bool full);
+
+    // 半对数图的实测序列：Horner 模式 t 为关井时间 Δt、p 为原始压力、d 为 lg((tp+Δt)/Δt) (单一产量的叠加时间函数)；
+    // 降落模式 t、p 为 t > 0 的时间与压差
+    ObservedDataset::Series semiLogSeries() const;
+    bool isHornerMode() const;
 
     // 辅助：Horner Plot 计算与拟合
     // 返回计算出的 Pi
@@ -5,49 +5,527 @@
  * 1. 实现了基于多线程加速的 Levenberg-Marquardt 非线性最小二乘拟合算法。
  * 2. 实现了雅可比矩阵的并行计算。
  * 3. 实现了数据抽样与清洗逻辑。
+ * 4. 拟合结束时输出 Laplace 像函数缓存的命中统计 (雅可比扰动列与重复试算点共享缓存)。
+ * 5. 雅可比矩阵默认由解析敏感度一次求得，离散参数 (nf 等) 与选择差分模式时按列中心差分。
+ * 6. 拟合过程使用显式的求解器设置 (迭代期低精度、最终刷新高精度)，不再切换 ModelManager 的全局精度，
+ *    与界面预览等其他计算互不干扰。
+ * 7. [自动初值] LM 迭代前由类型曲线索引检索相似曲线，换算为有因次初值后与当前初值一次批量试算，
+ *    仅当误差更小时替换迭代起点；未加载类型曲线库时不产生额外计算。
+ * 8. [变产量叠加] 设置产量历史后所有理论曲线经 calculateModelCurve(s) 叠加计算，
+ *    叠加改变了参数与曲线形状的对应关系，此时雅可比矩阵按差分计算、且不做类型曲线初值推荐。
+ * 9. [测地线 LM] 每次试探先在 x + h·v (h = 0.1) 处计算一次残差，由差商得到沿 v 的方向二阶导数 r_vv，
+ *    加速度 a 与速度 v 共用同一阻尼法方程的 LDLT 分解；2‖a‖/‖v‖ 超过 0.75 时舍弃加速度只走 v。
+ *    探测点与试探点 (无论接受与否) 的残差都用于 Broyden 秩一更新雅可比矩阵，
+ *    连续 4 次接受或雅可比已被更新过的情况下出现拒绝时重新计算完整雅可比矩阵。
+ *    阻尼按增益比 ρ 更新：接受时 λ·max(1/3, 1-(2ρ-1)³)，拒绝时 λ·ν 且 ν 加倍。
+ *    两种方式结束时均输出残差计算与完整雅可比计算的次数，便于比较收敛代价。
+ * 10. [全局搜索] 起点为当前初值与各拟合参数 [min, max] 内的拉丁超立方样本 (min > 0 的参数在 log10 空间分层，
+ *    nf 取整，随机种子固定以便复现)。粗搜索在隔点抽样的数据上限 8 次迭代，各起点在线程池中并行、
+ *    起点内部串行 (ScopedSerialEvaluation，雅可比矩阵各列同样串行)；误差最小的若干个在完整抽样数据上
+ *    以常规迭代精修 (同样并行)，每个候选结束时都经 sigIterationUpdated 通知，最后取误差最小者。
+ * 11. [多保真度] 每一级把未参与拟合的 nf、N (或 inversionOrder) 写入参数字典并截取抽样点后迭代，
+ *    每级至多 10 次迭代，接受步的相对下降低于 1% 且步长低于 0.01 (对数参数即 log10 单位) 时提前转入下一级；
+ *    各级的误差在不同数据与精度下计算，互不比较，进入完整保真度前按原参数重算残差。
+ * 12. [协作取消] 拟合线程在 runOptimizationTask 中安装取消令牌，全局搜索候选在线程池中重新安装 (雅可比各列由任务调度器继承)；
+ *    令牌取消后求解器提前返回的残差 (为空) 与曲线不参与接受判断、也不发出通知，两种迭代均在下一次检查时退出。
+ *    最后一次刷新在令牌作用域之外进行：用户停止时沿用迭代精度，期限到达或正常结束时按高精度刷新。
+ * 13. [迭代预览] 初始状态、各 LM 接受步与保真度各级的界面通知经 publishIterationPreview 限频：
+ *    间隔未到或上一次预览仍在计算时直接丢弃 (最后一次刷新总会发送)，预览任务在线程池中以交互优先级求值
+ *    并继承拟合线程的取消令牌；最后一次刷新前等待其完成，保证最终曲线不被覆盖。
+ * 14. [批量拟合] startFit 返回是否启动；isRunning/waitForFinished 供批量拟合队列管理多个拟合核心的生命周期。
+ * 15. [参数不确定性] 两种 LM 迭代把最后使用的雅可比矩阵 (测地线 LM 可能为 Broyden 更新值) 交给
+ *    estimateUncertainty，不再额外求解；全局搜索或未发生迭代时没有可用的矩阵，补算一次完整雅可比。
+ *    剖面似然的 6n 个固定点互相独立，在线程池中并行 (每个任务内部串行)，各自以最优点为起点至多迭代 15 次。
+ *    用户停止时不做分析；拟合时限已到时只使用已有的雅可比矩阵。
+ * 16. [分箱抽样] 抽样方式为分箱平均或中值时由 LogBinSampler 在源数组上分箱 (不排序、不复制源数据)，
+ *    默认策略为 200 个对数箱，自定义区间按各自的点数分箱；仅对输出的少量箱点排序去重。
+ * 17. [小批量] 每批按对数周期分层无放回抽取约 B 个抽样点 (层内名额与该层点数成正比，至少 1 个)，
+ *    在子集上计算当前残差后做一次 LM 迭代 (雅可比只计算子集的行)；批间的误差不互相比较，
+ *    连续两批的相对下降不超过子集噪声水平 max(1%, 2n/m) 时转入完整数据的 LM，至多 30 批。
+ * 18. [持久缓存] 只有显式给出时间点的曲线 (残差、差分雅可比列) 经求值缓存，显示网格上的刷新曲线与解析敏感度不缓存；
+ *    被取消的计算不写入缓存。迭代预览时至多每 5 秒保存一次断点并追加缓存文件，拟合结束时再保存一次
+ *    (用户停止或期限到达时断点标记为未结束)。数据散列包含观测数组、抽样区间与方式及产量历史。
+ * 19. [性能跟踪] 拟合、残差与雅可比计算记录跟踪区间 (tracing.h)，迭代预览记录误差计数 fit.mse。
+ * 20. [参数变换] 迭代坐标由 ParameterTransform 按各参数声明的变换给出 (有界参数为 logit，有序参数对的下端随下端参数移动)，
+ *    试探点不再截断到边界，贴边参数不会产生零梯度方向与被拒绝的步；差分列在迭代坐标中扰动，
+ *    解析敏感度 ∂r/∂x 经 ∂x/∂u 换算，不确定性分析前把雅可比矩阵换回 log10 / 原值坐标。
+ * 21. [流动段抽样] 未启用自定义区间时按流动段划分生成的区间抽样 (源数据不超过 200 点时仍全部使用)，
+ *    抽样签名仅在启用时追加标记，原有缓存键不变。流动段在拟合开始时由完整观测数据计算一次，
+ *    导数残差与解析雅可比的导数行乘以同一权重，差分列由残差自然继承。
+ * 22. [任务调度] 差分雅可比各列经 TaskScheduler::mapped 并行，列内的曲线计算不再强制串行 (时间点在同一调度器中嵌套并行，
+ *    等待的线程继续执行其他列的任务)；全局搜索与剖面似然的任务内部仍为串行。拟合线程按 m_taskPriority 提交任务。
  */
 
 #include "fittingcore.h"
+#include "laplacecache.h"
+#include "typecurveindex.h"
+#include "logbinsampler.h"
+#include "normalequations.h"
+#include "parametertransform.h"
+#include "memoryaccounting.h"
+#include "tracing.h"
 #include <QtConcurrent>
+#include <QDebug>
+#include <QSettings>
 #include <cmath>
+#include <climits>
+#include <iterator>
 #include <numeric>
 #include <algorithm>
+#include <random>
+#include <QAtomicInteger>
 #include <Eigen/Dense>
 
 FittingCore::FittingCore(QObject *parent)
-    : QObject(parent), m_modelManager(nullptr), m_isCustomSamplingEnabled(false), m_stopRequested(false)
+    : QObject(parent), m_engine(nullptr), m_observed(ObservedDataset::empty()), m_rateHistoryBuildup(false), m_isCustomSamplingEnabled(false),
+      m_samplingMode(Sampling_NearestPoint), m_previewBusy(0), m_contextHash(0), m_fitDataHash(0),
+      m_observedArraysHash(0), m_observedHash(0)
 {
+    // 雅可比矩阵计算方式 (默认解析敏感度)
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    int method = settings.value("fitting/jacobianMethod", (int)Jacobian_Analytic).toInt();
+    m_jacobianMethod = (method == (int)Jacobian_FiniteDifference) ? Jacobian_FiniteDifference : Jacobian_Analytic;
+    int optimizer = settings.value("fitting/optimizerMethod", (int)Optimizer_GeodesicLM).toInt();
+    m_optimizerMethod = (optimizer == (int)Optimizer_Classic) ? Optimizer_Classic : Optimizer_GeodesicLM;
+    m_globalSearch = settings.value("fitting/globalSearch", false).toBool();
+    m_globalStarts = qMax(1, settings.value("fitting/globalSearchStarts", 16).toInt());
+    m_globalPolished = qMax(1, settings.value("fitting/globalSearchPolished", 3).toInt());
+    m_multiFidelity = settings.value("fitting/multiFidelity", false).toBool();
+    m_miniBatch = settings.value("fitting/miniBatch", false).toBool();
+    m_miniBatchSize = qMax(10, settings.value("fitting/miniBatchSize", 100).toInt());
+    m_fidelityLadder = settings.contains("fitting/fidelityLadder")
+                           ? parseFidelityLadder(settings.value("fitting/fidelityLadder").toString())
+                           : defaultFidelityLadder();
+    m_autoInitialGuess = settings.value("fitting/autoInitialGuess", true).toBool();
+    m_timeBudget = qMax(0, settings.value("fitting/timeBudgetSeconds", 0).toInt());
+    m_previewInterval = qMax(0, settings.value("fitting/previewIntervalMs", 200).toInt());
+    m_previewOnDataGrid = settings.value("fitting/previewOnDataGrid", false).toBool();
+    m_uncertaintyProfile = settings.value("fitting/uncertaintyProfile", false).toBool();
+    m_regimeSampling = settings.value("fitting/regimeSampling", false).toBool();
+    m_taskPriority = TaskScheduler::Foreground;
+    m_reproducibility = FitReproducibility::fromGlobalSettings();
+    setObservedDataset(m_observed);
+
     // 监听异步任务完成
     connect(&m_watcher, &QFutureWatcher<void>::finished, this, &FittingCore::sigFitFinished);
 }
 
-void FittingCore::setModelManager(ModelManager *m) {
-    m_modelManager = m;
+void FittingCore::setJacobianMethod(JacobianMethod method) {
+    m_jacobianMethod = method;
+}
+
+FittingCore::JacobianMethod FittingCore::jacobianMethod() const {
+    return m_jacobianMethod;
+}
+
+void FittingCore::setOptimizerMethod(OptimizerMethod method) {
+    m_optimizerMethod = method;
+}
+
+FittingCore::OptimizerMethod FittingCore::optimizerMethod() const {
+    return m_optimizerMethod;
+}
+
+void FittingCore::setGlobalSearchEnabled(bool enabled) {
+    m_globalSearch = enabled;
+}
+
+bool FittingCore::isGlobalSearchEnabled() const {
+    return m_globalSearch;
+}
+
+void FittingCore::setGlobalSearchStarts(int starts, int polished) {
+    m_globalStarts = qMax(1, starts);
+    m_globalPolished = qMax(1, polished);
+}
+
+int FittingCore::globalSearchStarts() const {
+    return m_globalStarts;
+}
+
+int FittingCore::globalSearchPolished() const {
+    return m_globalPolished;
+}
+
+void FittingCore::setMultiFidelityEnabled(bool enabled) {
+    m_multiFidelity = enabled;
+}
+
+bool FittingCore::isMultiFidelityEnabled() const {
+    return m_multiFidelity;
+}
+
+void FittingCore::setMiniBatch(bool enabled, int batchSize) {
+    m_miniBatch = enabled;
+    m_miniBatchSize = qMax(10, batchSize);
+}
+
+bool FittingCore::isMiniBatchEnabled() const {
+    return m_miniBatch;
+}
+
+int FittingCore::miniBatchSize() const {
+    return m_miniBatchSize;
+}
+
+void FittingCore::setFidelityLadder(const QVector<FidelityLevel>& ladder) {
+    m_fidelityLadder = ladder;
+}
+
+QVector<FidelityLevel> FittingCore::fidelityLadder() const {
+    return m_fidelityLadder;
+}
+
+void FittingCore::setTimeBudget(int seconds) {
+    m_timeBudget = qMax(0, seconds);
+}
+
+int FittingCore::timeBudget() const {
+    return m_timeBudget;
+}
+
+void FittingCore::setPreviewPolicy(int intervalMs, bool reuseDataGrid) {
+    m_previewInterval = qMax(0, intervalMs);
+    m_previewOnDataGrid = reuseDataGrid;
+}
+
+int FittingCore::previewInterval() const {
+    return m_previewInterval;
+}
+
+bool FittingCore::isPreviewOnDataGrid() const {
+    return m_previewOnDataGrid;
+}
+
+void FittingCore::setUncertaintyProfileEnabled(bool enabled) {
+    m_uncertaintyProfile = enabled;
+}
+
+bool FittingCore::isUncertaintyProfileEnabled() const {
+    return m_uncertaintyProfile;
+}
+
+FitReproducibility FitReproducibility::fromGlobalSettings() {
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    FitReproducibility r;
+    r.reproducible = settings.value("fitting/reproducible", false).toBool();
+    return r;
+}
+
+QJsonObject FitReproducibility::toJson() const {
+    QJsonObject obj;
+    obj["reproducible"] = reproducible;
+    obj["multiStartSeed"] = double(multiStartSeed);
+    obj["miniBatchSeed"] = double(miniBatchSeed);
+    return obj;
+}
+
+FitReproducibility FitReproducibility::fromJson(const QJsonObject& object) {
+    FitReproducibility r;
+    r.reproducible = object.value("reproducible").toBool(r.reproducible);
+    r.multiStartSeed = quint32(object.value("multiStartSeed").toDouble(r.multiStartSeed));
+    r.miniBatchSeed = quint32(object.value("miniBatchSeed").toDouble(r.miniBatchSeed));
+    return r;
+}
+
+void FittingCore::setReproducibility(const FitReproducibility& reproducibility) {
+    m_reproducibility = reproducibility;
+}
+
+FitReproducibility FittingCore::reproducibility() const {
+    return m_reproducibility;
+}
+
+FitUncertainty FittingCore::lastUncertainty() const {
+    return m_lastUncertainty;
+}
+
+QVector<FidelityLevel> FittingCore::defaultFidelityLadder() {
+    FidelityLevel coarse;
+    FidelityLevel medium;
+    medium.inversionOrder = 8;
+    medium.samplePoints = 100;
+    return QVector<FidelityLevel>() << coarse << medium;
+}
+
+QVector<FidelityLevel> FittingCore::parseFidelityLadder(const QString& text) {
+    QVector<FidelityLevel> ladder;
+    const QStringList levels = text.split(';', Qt::SkipEmptyParts);
+    for (const QString& item : levels) {
+        const QStringList fields = item.split(',');
+        if (fields.size() != 3) continue;
+        FidelityLevel level;
+        level.fractureSegments = fields[0].trimmed().toInt();
+        level.inversionOrder = fields[1].trimmed().toInt();
+        level.samplePoints = fields[2].trimmed().toInt();
+        if (level.fractureSegments >= 0 && level.inversionOrder > 0 && level.samplePoints > 0) ladder.append(level);
+    }
+    return ladder;
+}
+
+void FittingCore::setAutoInitialGuessEnabled(bool enabled) {
+    m_autoInitialGuess = enabled;
+}
+
+bool FittingCore::isAutoInitialGuessEnabled() const {
+    return m_autoInitialGuess;
+}
+
+void FittingCore::setPersistence(const QString &cacheFilePath, const QString &checkpointFilePath) {
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    const bool useCache = settings.value("fitting/evaluationCache", true).toBool();
+    m_evaluationCache = useCache ? FitEvaluationCache::shared(cacheFilePath) : QSharedPointer<FitEvaluationCache>();
+    m_checkpointPath = checkpointFilePath;
+}
+
+FitCheckpoint FittingCore::resumableCheckpoint(ModelEngine::ModelType modelType, const QList<FitParameter> &params,
+                                               double weight) const {
+    FitCheckpoint checkpoint = FitCheckpoint::load(m_checkpointPath, (int)modelType, observedDataHash());
+    QStringList fitNames;
+    for (const FitParameter& p : params) {
+        if (p.isFit && p.name != "LfD") fitNames.append(p.name);
+    }
+    if (!checkpoint.valid || checkpoint.finished || std::abs(checkpoint.weight - weight) > 1e-9
+        || checkpoint.fitNames != fitNames) {
+        checkpoint.valid = false;
+    }
+    return checkpoint;
+}
+
+quint64 FittingCore::observedDataHash() const {
+    return m_observedHash;
+}
+
+void FittingCore::updateObservedHash() {
+    // 观测数组的散列只在更换数据集时计算 (百万点量级时耗时数十毫秒)，抽样设置与产量历史改变时只重新合并
+    quint64 h = FitEvaluationCache::hashValues(samplingSignature(), m_observedArraysHash);
+    m_observedHash = FitEvaluationCache::hashBytes(&m_contextHash, sizeof(m_contextHash), h);
+}
+
+QVector<double> FittingCore::samplingSignature() const {
+    QVector<double> sampling;
+    sampling << (m_isCustomSamplingEnabled ? 1.0 : 0.0) << double(m_samplingMode);
+    if (m_isCustomSamplingEnabled) {
+        for (const SamplingInterval& interval : m_customIntervals)
+            sampling << interval.tStart << interval.tEnd << double(interval.count);
+    }
+    if (m_regimeSampling) sampling << -1.0;
+    return sampling;
+}
+
+void FittingCore::saveCheckpoint(const QMap<QString, double> &params, double error, bool finished) {
+    m_checkpointClock.restart();
+    if (m_evaluationCache) m_evaluationCache->flush();
+    if (m_checkpointPath.isEmpty()) return;
+    m_checkpoint.valid = true;
+    m_checkpoint.finished = finished;
+    m_checkpoint.params = params;
+    m_checkpoint.error = error;
+    m_checkpoint.time = QDateTime::currentDateTime();
+    FitCheckpoint::save(m_checkpointPath, m_checkpoint);
+}
+
+void FittingCore::setModelEngine(ModelEngine *engine) {
+    m_engine = engine;
+}
+
+void FittingCore::setObservedDataset(const ObservedDataset::Handle &dataset) {
+    m_observed = dataset ? dataset : ObservedDataset::empty();
+    m_regimeSegments.clear();
+    quint64 h = FitEvaluationCache::hashValues(m_observed->time());
+    h = FitEvaluationCache::hashValues(m_observed->deltaP(), h);
+    m_observedArraysHash = FitEvaluationCache::hashValues(m_observed->derivative(), h);
+    updateObservedHash();
 }
 
 void FittingCore::setObservedData(const QVector<double> &t, const QVector<double> &p, const QVector<double> &d) {
-    m_obsTime = t;
-    m_obsDeltaP = p;
-    m_obsDerivative = d;
+    setObservedDataset(ObservedDataset::create(t, p, d));
+}
+
+void FittingCore::getSampledObservedData(QVector<double> &outT, QVector<double> &outP, QVector<double> &outD) {
+    const QString key = "sampled:" + QString::number(FitEvaluationCache::hashValues(samplingSignature()), 16);
+    const ObservedDataset::Series sampled = m_observed->derived(key, [this](const ObservedDataset& data) {
+        ObservedDataset::Series s;
+        getLogSampledData(data.time(), data.deltaP(), data.derivative(), s.t, s.p, s.d);
+        return s;
+    });
+    outT = sampled.t;
+    outP = sampled.p;
+    outD = sampled.d;
+}
+
+void FittingCore::setRateHistory(const RateHistory &history, bool buildup) {
+    // 分组在设置时完成一次，迭代中的每次曲线计算直接使用
+    m_rateHistory = SuperpositionEngine::prepare(history);
+    m_rateHistoryBuildup = buildup;
+    m_contextHash = FitEvaluationCache::hashValues(m_rateHistory.rate,
+                                                   FitEvaluationCache::hashValues(m_rateHistory.startTime));
+    m_contextHash = FitEvaluationCache::hashBytes(&m_rateHistoryBuildup, sizeof(m_rateHistoryBuildup), m_contextHash);
+    updateObservedHash();
+}
+
+void FittingCore::clearRateHistory() {
+    m_rateHistory = RateHistory();
+    m_rateHistoryBuildup = false;
+    m_contextHash = 0;
+    updateObservedHash();
+}
+
+bool FittingCore::hasRateHistory() const {
+    return !m_rateHistory.isEmpty();
+}
+
+const RateHistory& FittingCore::rateHistory() const {
+    return m_rateHistory;
+}
+
+bool FittingCore::isRateHistoryBuildup() const {
+    return m_rateHistoryBuildup;
+}
+
+ModelCurveData FittingCore::calculateModelCurve(ModelEngine::ModelType modelType, const QMap<QString, double> &params,
+                                                const QVector<double> &t) {
+    if (!m_engine) return ModelCurveData();
+    return calculateModelCurve(modelType, m_engine->solverSettings(), params, t);
+}
+
+ModelCurveData FittingCore::calculateModelCurve(ModelEngine::ModelType modelType, const SolverSettings &settings,
+                                                const QMap<QString, double> &params, const QVector<double> &t) {
+    if (!m_engine) return ModelCurveData();
+
+    // 显式时间点上的曲线经项目级缓存 (默认网格随观测数据变化，不缓存)
+    QByteArray cacheKey;
+    if (m_evaluationCache && !t.isEmpty()) {
+        cacheKey = FitEvaluationCache::makeKey((int)modelType, settings, params, t, m_contextHash);
+        ModelCurveData cached;
+        if (m_evaluationCache->lookup(cacheKey, cached)) return cached;
+    }
+
+    ModelCurveData curve;
+    if (m_rateHistory.isEmpty()) {
+        curve = m_engine->calculateTheoreticalCurve(modelType, settings, params, t);
+    } else {
+        QVector<ModelCurveData> curves = calculateModelCurves(modelType, settings, QVector<QMap<QString, double>>() << params, t);
+        if (!curves.isEmpty()) curve = curves.first();
+    }
+
+    const CancellationToken* token = CancellationToken::current();
+    if (!cacheKey.isEmpty() && !(token && token->isCancelled())) m_evaluationCache->insert(cacheKey, curve);
+    return curve;
+}
+
+QVector<ModelCurveData> FittingCore::calculateModelCurves(ModelEngine::ModelType modelType, const SolverSettings &settings,
+                                                          const QVector<QMap<QString, double>> &paramSets, const QVector<double> &t) {
+    if (!m_engine) return QVector<ModelCurveData>(paramSets.size());
+    if (m_rateHistory.isEmpty()) return m_engine->calculateTheoreticalCurvesBatch(modelType, settings, paramSets, t);
+
+    // 未指定时间时在观测时间范围内取对数网格
+    QVector<double> times = t;
+    if (times.isEmpty()) {
+        double tMin = 0.0, tMax = 0.0;
+        for (double v : m_observed->time()) {
+            if (v <= 0.0) continue;
+            if (tMin <= 0.0 || v < tMin) tMin = v;
+            tMax = qMax(tMax, v);
+        }
+        if (tMin <= 0.0 || tMax <= tMin) { tMin = 1e-3; tMax = 1e3; }
+        times = ModelEngine::generateLogTimeSteps(200, log10(tMin), log10(tMax));
+    }
+
+    if (!m_rateHistoryBuildup) {
+        return m_engine->calculateSuperposedCurvesBatch(modelType, settings, paramSets, m_rateHistory, times);
+    }
+
+    // 恢复试井：Δp_obs(Δt) = Δp(t_s) - Δp(t_s + Δt)，导数 Δt·dΔp_obs/dΔt = -(Δt / t)·[t·dΔp/dt]
+    const double tShut = m_rateHistory.lastChangeTime();
+    QVector<double> absolute;
+    absolute.reserve(times.size() + 1);
+    absolute.append(tShut);
+    for (double dt : times) absolute.append(tShut + dt);
+
+    QVector<ModelCurveData> superposed = m_engine->calculateSuperposedCurvesBatch(modelType, settings, paramSets,
+                                                                                        m_rateHistory, absolute);
+    QVector<ModelCurveData> results;
+    results.reserve(superposed.size());
+    for (const ModelCurveData& curve : superposed) {
+        const QVector<double>& p = std::get<1>(curve);
+        const QVector<double>& d = std::get<2>(curve);
+        QVector<double> outP(times.size(), 0.0), outD(times.size(), 0.0);
+        if (p.size() == absolute.size() && d.size() == absolute.size()) {
+            for (int i = 0; i < times.size(); ++i) {
+                outP[i] = p[0] - p[i + 1];
+                outD[i] = -(times[i] / absolute[i + 1]) * d[i + 1];
+            }
+        }
+        results.append(std::make_tuple(times, outP, outD));
+    }
+    return results;
 }
 
 void FittingCore::setSamplingSettings(const QList<SamplingInterval> &intervals, bool enabled) {
     m_customIntervals = intervals;
     m_isCustomSamplingEnabled = enabled;
+    updateObservedHash();
+}
+
+QList<SamplingInterval> FittingCore::samplingIntervals() const {
+    return m_customIntervals;
+}
+
+void FittingCore::setSamplingMode(SamplingMode mode) {
+    m_samplingMode = mode;
+    updateObservedHash();
+}
+
+SamplingMode FittingCore::samplingMode() const {
+    return m_samplingMode;
 }
 
-void FittingCore::startFit(ModelManager::ModelType modelType, const QList<FitParameter> &params, double weight) {
-    if (m_watcher.isRunning()) return;
+void FittingCore::setRegimeSamplingEnabled(bool enabled) {
+    m_regimeSampling = enabled;
+    updateObservedHash();
+}
+
+bool FittingCore::isRegimeSamplingEnabled() const {
+    return m_regimeSampling;
+}
 
-    m_stopRequested = false;
+void FittingCore::setTaskPriority(TaskScheduler::Priority priority) {
+    m_taskPriority = priority;
+}
+
+TaskScheduler::Priority FittingCore::taskPriority() const {
+    return m_taskPriority;
+}
+
+bool FittingCore::isCustomSamplingEnabled() const {
+    return m_isCustomSamplingEnabled;
+}
+
+bool FittingCore::startFit(ModelEngine::ModelType modelType, const QList<FitParameter> &params, double weight) {
+    if (m_watcher.isRunning()) return false;
+
+    // 复位取消令牌；设置了时限时从此刻开始计时 (可复现模式不限时，迭代次数不能取决于墙钟)
+    m_cancellation.reset();
+    if (m_timeBudget > 0 && !m_reproducibility.reproducible) m_cancellation.setDeadline(qint64(m_timeBudget) * 1000);
+    m_fitDataHash = observedDataHash();
     // 启动异步线程执行拟合
     m_watcher.setFuture(QtConcurrent::run([this, modelType, params, weight](){
         runOptimizationTask(modelType, params, weight);
     }));
+    return true;
 }
 
 void FittingCore::stopFit() {
-    m_stopRequested = true;
+    m_cancellation.cancel();
+}
+
+bool FittingCore::isRunning() const {
+    return m_watcher.isRunning();
+}
+
+void FittingCore::waitForFinished() {
+    m_watcher.waitForFinished();
 }
 
 void FittingCore::getLogSampledData(const QVector<double>& srcT, const QVector<double>& srcP, const QVector<double>& srcD,
@@ -64,8 +542,47 @@ void FittingCore::getLogSampledData(const QVector<double>& srcT, const QVector<d
     };
     QVector<DataPoint> points;
 
+    // 流动段抽样：未启用自定义区间时由观测导数的流动段划分生成区间 (划分失败时沿用默认策略)
+    bool useIntervals = m_isCustomSamplingEnabled;
+    QList<SamplingInterval> intervals = m_customIntervals;
+    if (!useIntervals && m_regimeSampling && srcT.size() > 200) {
+        intervals = FlowRegimeSegmenter::samplingIntervals(FlowRegimeSegmenter::segment(srcT, srcD), 200);
+        useIntervals = !intervals.isEmpty();
+    }
+
+    // 对数分箱：各箱内取平均或中值，直接读取源数组
+    if (m_samplingMode != Sampling_NearestPoint) {
+        const LogBinSampler::Statistic statistic =
+            (m_samplingMode == Sampling_BinMedian) ? LogBinSampler::Median : LogBinSampler::Mean;
+        if (!useIntervals) {
+            if (srcT.size() <= 200) {
+                outT = srcT; outP = srcP; outD = srcD;
+                return;
+            }
+            LogBinSampler::sample(srcT, srcP, srcD, 0.0, HUGE_VAL, 200, statistic, outT, outP, outD);
+            return;
+        }
+        if (intervals.isEmpty()) {
+            outT = srcT; outP = srcP; outD = srcD;
+            return;
+        }
+        // 有序数据按二分查找限定各区间的下标范围，无序时每个区间扫描全部样本
+        const bool sorted = std::is_sorted(srcT.begin(), srcT.end());
+        QVector<double> binT, binP, binD;
+        for (const auto& interval : intervals) {
+            if (interval.count <= 0) continue;
+            int first = 0, last = srcT.size();
+            if (sorted) {
+                first = std::lower_bound(srcT.begin(), srcT.end(), interval.tStart) - srcT.begin();
+                last = std::upper_bound(srcT.begin(), srcT.end(), interval.tEnd) - srcT.begin();
+            }
+            LogBinSampler::sample(srcT, srcP, srcD, interval.tStart, interval.tEnd, interval.count, statistic,
+                                  binT, binP, binD, first, last);
+        }
+        for (int i = 0; i < binT.size(); ++i) points.append({binT[i], binP[i], binD[i]});
+    }
     // 模式1：默认策略
-    if (!m_isCustomSamplingEnabled) {
+    else if (!useIntervals) {
         int targetCount = 200;
         if (srcT.size() <= targetCount) {
             outT = srcT; outP = srcP; outD = srcD;
@@ -97,11 +614,11 @@ void FittingCore::getLogSampledData(const QVector<double>& srcT, const QVector<d
     }
     // 模式2：自定义区间策略
     else {
-        if (m_customIntervals.isEmpty()) {
+        if (intervals.isEmpty()) {
             outT = srcT; outP = srcP; outD = srcD;
             return;
         }
-        for (const auto& interval : m_customIntervals) {
+        for (const auto& interval : intervals) {
             double tStart = interval.tStart;
             double tEnd = interval.tEnd;
             int count = interval.count;
@@ -154,12 +671,58 @@ void FittingCore::getLogSampledData(const QVector<double>& srcT, const QVector<d
     }
 }
 
-void FittingCore::runOptimizationTask(ModelManager::ModelType modelType, QList<FitParameter> fitParams, double weight) {
+void FittingCore::runOptimizationTask(ModelEngine::ModelType modelType, QList<FitParameter> fitParams, double weight) {
+    CancellationToken::Scope cancellationScope(&m_cancellation);
+    TaskScheduler::PriorityScope priorityScope(m_taskPriority);
     runLevenbergMarquardtOptimization(modelType, fitParams, weight);
 }
 
-void FittingCore::runLevenbergMarquardtOptimization(ModelManager::ModelType modelType, QList<FitParameter> params, double weight) {
-    if(m_modelManager) m_modelManager->setHighPrecision(false);
+void FittingCore::publishIterationPreview(ModelEngine::ModelType modelType, double error, const QMap<QString, double>& params,
+                                          const ModelCurveData* dataCurve) {
+    WT_TRACE_COUNTER("fit.mse", error);
+    // 断点与缓存文件至多每 5 秒保存一次 (不受预览限频影响)
+    if (!m_checkpointClock.isValid() || m_checkpointClock.elapsed() >= 5000) saveCheckpoint(params, error, false);
+
+    if (m_previewClock.isValid() && m_previewClock.elapsed() < m_previewInterval) return;
+
+    // 残差曲线即抽样时间点上的理论曲线，无需再次求解
+    if (m_previewOnDataGrid && dataCurve && !std::get<0>(*dataCurve).isEmpty()) {
+        m_previewClock.restart();
+        emit sigIterationUpdated(error, params, std::get<0>(*dataCurve), std::get<1>(*dataCurve), std::get<2>(*dataCurve));
+        return;
+    }
+
+    // 显示网格上的曲线交给线程池；上一次预览未完成时丢弃本次，拟合线程不等待
+    if (!m_previewBusy.testAndSetAcquire(0, 1)) return;
+    m_previewClock.restart();
+    const CancellationToken* token = CancellationToken::current();
+    const SolverSettings settings = m_iterationSettings;
+    m_previewFuture = QtConcurrent::run([this, modelType, error, params, settings, token]() {
+        TaskScheduler::PriorityScope priorityScope(TaskScheduler::Interactive);
+        CancellationToken::Scope cancellationScope(token);
+        ModelCurveData curve = calculateModelCurve(modelType, settings, params);
+        if (!m_cancellation.isCancelled())
+            emit sigIterationUpdated(error, params, std::get<0>(curve), std::get<1>(curve), std::get<2>(curve));
+        m_previewBusy.storeRelease(0);
+    });
+}
+
+void FittingCore::waitForIterationPreview() {
+    m_previewFuture.waitForFinished();
+}
+
+void FittingCore::runLevenbergMarquardtOptimization(ModelEngine::ModelType modelType, QList<FitParameter> params, double weight) {
+    WT_TRACE_SCOPE("FittingCore::fit");
+    WT_MEMORY_SCOPE(MemoryAccounting::Fitter);
+    if(!m_engine) return;
+    // 迭代期使用低精度设置；全局设置不变，界面预览等并发计算不受影响
+    // 类型曲线库插值为分段多线性，与解析雅可比矩阵不一致，拟合过程始终数值反演
+    SolverSettings finalSettings = m_engine->solverSettings().withHighPrecision(true);
+    finalSettings.useTypeCurveLibrary = false;
+    m_iterationSettings = finalSettings.withHighPrecision(false);
+    m_previewClock.invalidate();
+    m_checkpointClock.invalidate();
+    m_lastUncertainty = FitUncertainty();
 
     QVector<int> fitIndices;
     for(int i=0; i<params.size(); ++i) {
@@ -167,6 +730,12 @@ void FittingCore::runLevenbergMarquardtOptimization(ModelManager::ModelType mode
     }
     int nParams = fitIndices.size();
 
+    m_checkpoint = FitCheckpoint();
+    m_checkpoint.modelType = (int)modelType;
+    m_checkpoint.weight = weight;
+    m_checkpoint.dataHash = m_fitDataHash;
+    for (int idx : fitIndices) m_checkpoint.fitNames.append(params[idx].name);
+
     if(nParams == 0) {
         // 无需拟合，直接结束
         emit sigFitFinished();
@@ -174,10 +743,20 @@ void FittingCore::runLevenbergMarquardtOptimization(ModelManager::ModelType mode
     }
 
     QVector<double> fitT, fitP, fitD;
-    getLogSampledData(m_obsTime, m_obsDeltaP, m_obsDerivative, fitT, fitP, fitD);
+    getSampledObservedData(fitT, fitP, fitD);
+
+    // 流动段权重由完整观测数据划分，迭代期间只读
+    m_regimeSegments.clear();
+    if (m_regimeSampling) {
+        m_regimeSegments = FlowRegimeSegmenter::segment(m_observed->time(), m_observed->derivative());
+        for (const FlowRegimeSegment& s : m_regimeSegments)
+            qDebug() << "流动段:" << FlowRegimeSegmenter::regimeName(s.regime) << s.tStart << "-" << s.tEnd
+                     << "斜率" << s.slope << "噪声" << s.noise << "权重" << s.weight;
+    }
+
+    const qint64 cacheHits0 = LaplaceEvaluationCache::instance().hits();
+    const qint64 cacheMisses0 = LaplaceEvaluationCache::instance().misses();
 
-    double lambda = 0.01;
-    int maxIter = 50;
     double currentSSE = 1e15;
 
     QMap<QString, double> currentParamMap;
@@ -193,38 +772,279 @@ void FittingCore::runLevenbergMarquardtOptimization(ModelManager::ModelType mode
     if(currentParamMap.contains("L") && currentParamMap.contains("Lf") && currentParamMap["L"] > 1e-9)
         currentParamMap["LfD"] = currentParamMap["Lf"] / currentParamMap["L"];
 
-    QVector<double> residuals = calculateResiduals(currentParamMap, modelType, weight, fitT, fitP, fitD);
+    ModelCurveData initialCurve;
+    QVector<double> residuals = calculateResiduals(m_iterationSettings, currentParamMap, modelType, weight, fitT, fitP, fitD,
+                                                   &initialCurve);
     currentSSE = calculateSumSquaredError(residuals);
 
+    // 类型曲线库推荐的初值与当前初值比较，一次批量试算
+    if (m_autoInitialGuess && m_rateHistory.isEmpty()) {
+        QVector<QMap<QString, double>> candidates = suggestInitialGuesses(modelType, params, 4);
+        if (!candidates.isEmpty()) {
+            QVector<ModelCurveData> curves = calculateModelCurves(modelType, m_iterationSettings, candidates, fitT);
+            if (m_cancellation.isCancelled()) curves.clear();
+            int best = -1;
+            for (int c = 0; c < curves.size(); ++c) {
+                QVector<double> r = residualsFromCurve(curves[c], weight, fitP, fitD);
+                double sse = calculateSumSquaredError(r);
+                if (!r.isEmpty() && sse < currentSSE) { currentSSE = sse; residuals = r; best = c; }
+            }
+            if (best >= 0) {
+                currentParamMap = candidates[best];
+                initialCurve = curves[best];
+                qDebug() << "类型曲线初值: 采用第" << (best + 1) << "个推荐 (共" << candidates.size() << "个)，SSE =" << currentSSE;
+            }
+        }
+    }
+
     // 初始状态通知
-    ModelCurveData curve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-    emit sigIterationUpdated(currentSSE/residuals.size(), currentParamMap, std::get<0>(curve), std::get<1>(curve), std::get<2>(curve));
+    if (!m_cancellation.isCancelled())
+        publishIterationPreview(modelType, currentSSE/qMax(1, residuals.size()), currentParamMap, &initialCurve);
+
+    // 多保真度：先在粗的各级上迭代；粗级或小批量之后在完整数据与保真度下重算起点误差
+    bool restarted = false;
+    if (m_multiFidelity && !m_globalSearch && !m_fidelityLadder.isEmpty()) {
+        runFidelityLadder(modelType, params, weight, fitIndices, fitT, fitP, fitD, currentParamMap);
+        restarted = true;
+    }
+    // 小批量：抽样点很多时前期迭代只用分层随机子集
+    if (m_miniBatch && !m_globalSearch && fitT.size() >= 2 * m_miniBatchSize) {
+        runMiniBatchPhase(modelType, params, weight, fitIndices, fitT, fitP, fitD, currentParamMap);
+        restarted = true;
+    }
+    if (restarted) {
+        residuals = calculateResiduals(m_iterationSettings, currentParamMap, modelType, weight, fitT, fitP, fitD);
+        currentSSE = calculateSumSquaredError(residuals);
+    }
+
+    Eigen::MatrixXd finalJacobian;
+    if (m_globalSearch) {
+        runGlobalSearch(modelType, params, weight, fitIndices, fitT, fitP, fitD, currentParamMap, residuals, currentSSE);
+    } else {
+        runLocalSearch(modelType, params, weight, fitIndices, fitT, fitP, fitD, currentParamMap, residuals, currentSSE,
+                       LocalSearchOptions(), &finalJacobian);
+    }
+
+    // 缓存统计：q/B/h 等缩放类参数的扰动列应全部命中
+    LaplaceEvaluationCache& cache = LaplaceEvaluationCache::instance();
+    qint64 lookups = cache.hits() - cacheHits0 + cache.misses() - cacheMisses0;
+    if (lookups > 0) {
+        qDebug() << "Laplace 缓存: 命中" << (cache.hits() - cacheHits0) << "/ 查询" << lookups
+                 << "，当前条目" << cache.size();
+    }
 
+    // 最后一次刷新 (高精度)：在令牌作用域之外计算；用户停止时按迭代精度尽快结束，期限到达时仍按高精度刷新
+    CancellationToken::Scope refreshScope(nullptr);
+    waitForIterationPreview();
+    if (m_cancellation.isCancelRequested()) finalSettings = m_iterationSettings;
+    if (residuals.isEmpty()) {
+        residuals = calculateResiduals(m_iterationSettings, currentParamMap, modelType, weight, fitT, fitP, fitD);
+        currentSSE = calculateSumSquaredError(residuals);
+    }
+    ModelCurveData finalCurve = calculateModelCurve(modelType, finalSettings, currentParamMap);
+    emit sigIterationUpdated(currentSSE/qMax(1, residuals.size()), currentParamMap, std::get<0>(finalCurve), std::get<1>(finalCurve), std::get<2>(finalCurve));
+    saveCheckpoint(currentParamMap, currentSSE/qMax(1, residuals.size()), !m_cancellation.isCancelled());
+    if (m_evaluationCache) {
+        qDebug() << "拟合求值缓存: 累计命中" << m_evaluationCache->hits() << "/ 未命中" << m_evaluationCache->misses()
+                 << "，当前条目" << m_evaluationCache->size();
+    }
+
+    // 参数不确定性 (用户停止时跳过)
+    if (!m_cancellation.isCancelRequested()) {
+        estimateUncertainty(modelType, params, weight, fitIndices, fitT, fitP, fitD, currentParamMap, residuals,
+                            finalJacobian);
+    }
+}
+
+void FittingCore::estimateUncertainty(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                      const QVector<int>& fitIndices, const QVector<double>& t,
+                                      const QVector<double>& obsP, const QVector<double>& obsD,
+                                      const QMap<QString, double>& currentParamMap, const QVector<double>& residuals,
+                                      Eigen::MatrixXd J) {
+    CancellationToken::Scope cancellationScope(&m_cancellation);
+    const int nParams = fitIndices.size();
+    const int nRes = residuals.size();
+
+    QStringList names;
+    QVector<bool> logScale;
+    QVector<double> values;
+    for (int i : fitIndices) {
+        const QString& pName = params[i].name;
+        const double v = currentParamMap.value(pName);
+        names.append(pName);
+        logScale.append(v > 1e-12 && pName != "S" && pName != "nf");
+        values.append(v);
+    }
+
+    // 没有与当前残差对应的雅可比矩阵时补算一次
+    if (J.rows() != nRes || J.cols() != nParams) {
+        if (m_cancellation.isCancelled()) {
+            m_lastUncertainty.message = "拟合时限已到，未计算参数不确定性";
+            return;
+        }
+        QVector<QVector<double>> rows = computeJacobian(currentParamMap, residuals, fitIndices, modelType, params,
+                                                        weight, t, obsP, obsD);
+        if (m_cancellation.isCancelled() || rows.size() != nRes) {
+            m_lastUncertainty.message = "雅可比矩阵计算被中止，未计算参数不确定性";
+            return;
+        }
+        J.resize(nRes, nParams);
+        for (int i = 0; i < nRes; ++i)
+            for (int j = 0; j < nParams; ++j) J(i, j) = rows[i][j];
+    }
+    // 迭代坐标 (logit 等) 换回 logScale 对应的 log10 / 原值坐标
+    J = ParameterTransform(params, fitIndices).reexpress(J, currentParamMap, logScale);
+
+    FitUncertainty u = FitUncertaintyAnalysis::fromJacobian(names, logScale, values, J, residuals,
+                                                            m_reproducibility.reproducible);
+    if (u.valid && m_uncertaintyProfile && !m_cancellation.isCancelled()) {
+        runProfileLikelihood(modelType, params, weight, fitIndices, t, obsP, obsD, currentParamMap,
+                             calculateSumSquaredError(residuals), u);
+    }
+    if (u.valid) {
+        for (int i = 0; i < u.names.size(); ++i) {
+            qDebug() << "参数不确定性:" << u.names[i] << "=" << u.values[i] << "，95% 区间 ["
+                     << u.lower[i] << "," << u.upper[i] << "]";
+        }
+        qDebug() << "参数不确定性: 自由度" << u.dof << "，s² =" << u.sigma2 << "，条件数" << u.conditionNumber
+                 << (u.hasProfile() ? "，含剖面似然区间" : "");
+    } else {
+        qDebug() << "参数不确定性:" << u.message;
+    }
+    m_lastUncertainty = u;
+}
+
+void FittingCore::runProfileLikelihood(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                       const QVector<int>& fitIndices, const QVector<double>& t,
+                                       const QVector<double>& obsP, const QVector<double>& obsD,
+                                       const QMap<QString, double>& optimum, double optimumSSE, FitUncertainty& u) {
+    const int nParams = fitIndices.size();
+    static const double offsets[] = {-1.0, -2.0, -3.0, 1.0, 2.0, 3.0};
+
+    // 固定点：offset 为迭代坐标下到最优点的实际距离 (截断到 [min, max] 之后)
+    struct ProfilePoint { int param; double offset; double value; double sse; };
+    QVector<ProfilePoint> points;
+    for (int i = 0; i < nParams; ++i) {
+        if (!std::isfinite(u.stdError[i]) || !(u.stdError[i] > 0.0)) continue;
+        const FitParameter& p = params[fitIndices[i]];
+        for (double k : offsets) {
+            double v = FitUncertaintyAnalysis::toPhysical(u.values[i], u.logScale[i], k * u.stdError[i]);
+            v = qMax(p.min, qMin(v, p.max));
+            const double offset = u.logScale[i] ? (v > 0.0 ? log10(v / u.values[i]) : -INFINITY) : v - u.values[i];
+            if (!std::isfinite(offset) || offset == 0.0) continue;
+            points.append({i, offset, v, -1.0});
+        }
+    }
+    if (points.isEmpty()) return;
+
+    const CancellationToken* token = CancellationToken::current();
+    auto profileFit = [&, token](const ProfilePoint& point) {
+        ModelSolver01_06::ScopedSerialEvaluation serialScope;
+        CancellationToken::Scope cancellationScope(token);
+        ProfilePoint out = point;
+        QList<FitParameter> fixedParams = params;
+        fixedParams[fitIndices[point.param]].isFit = false;
+        QVector<int> freeIndices = fitIndices;
+        freeIndices.removeAt(point.param);
+
+        QMap<QString, double> map = optimum;
+        map[u.names[point.param]] = point.value;
+        map = applyParameterStep(map, QVector<double>(), freeIndices, fixedParams); // 只修正参数间约束
+        QVector<double> res = calculateResiduals(m_iterationSettings, map, modelType, weight, t, obsP, obsD);
+        if (res.isEmpty()) return out;
+        double sse = calculateSumSquaredError(res);
+        if (!freeIndices.isEmpty()) {
+            LocalSearchOptions options;
+            options.maxIterations = 15;
+            options.reportSteps = false;
+            options.targetError = 0.0; // 剖面点需收敛到条件最优，不能因误差已较小而提前结束
+            runLocalSearch(modelType, fixedParams, weight, freeIndices, t, obsP, obsD, map, res, sse, options);
+        }
+        if (!res.isEmpty() && std::isfinite(sse) && !(token && token->isCancelled())) out.sse = sse;
+        return out;
+    };
+    const QList<ProfilePoint> results = QtConcurrent::blockingMapped(points, profileFit);
+    if (m_cancellation.isCancelled()) return;
+
+    // 每侧按 |offset| 递增查找 ΔSSE 首次超过阈值的位置，与前一点线性插值
+    const double threshold = u.sigma2 * FitUncertaintyAnalysis::chiSquare95();
+    u.profileLower = u.lower;
+    u.profileUpper = u.upper;
+    u.profileLowerOpen = QVector<bool>(nParams, true);
+    u.profileUpperOpen = QVector<bool>(nParams, true);
+    for (int i = 0; i < nParams; ++i) {
+        for (int side = -1; side <= 1; side += 2) {
+            double prevOffset = 0.0, prevDelta = 0.0;
+            double bound = u.values[i];
+            bool closed = false;
+            bool any = false;
+            for (const ProfilePoint& point : results) {
+                if (point.param != i || point.sse < 0.0 || point.offset * side <= 0.0) continue;
+                if (std::abs(point.offset) <= std::abs(prevOffset)) continue; // 截断后与前一点重合
+                any = true;
+                const double delta = qMax(0.0, point.sse - optimumSSE);
+                if (delta >= threshold) {
+                    const double f = (delta > prevDelta) ? (threshold - prevDelta) / (delta - prevDelta) : 1.0;
+                    const double offset = prevOffset + f * (point.offset - prevOffset);
+                    bound = FitUncertaintyAnalysis::toPhysical(u.values[i], u.logScale[i], offset);
+                    closed = true;
+                    break;
+                }
+                prevOffset = point.offset;
+                prevDelta = delta;
+                bound = point.value;
+            }
+            if (!any) continue; // 该侧没有可用的固定点，沿用线性化区间
+            if (side < 0) { u.profileLower[i] = bound; u.profileLowerOpen[i] = !closed; }
+            else { u.profileUpper[i] = bound; u.profileUpperOpen[i] = !closed; }
+        }
+    }
+    qDebug() << "剖面似然: 固定点" << points.size() << "个，阈值 ΔSSE =" << threshold;
+}
+
+void FittingCore::runClassicLevenbergMarquardt(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                               const QVector<int>& fitIndices, const QVector<double>& fitT,
+                                               const QVector<double>& fitP, const QVector<double>& fitD,
+                                               QMap<QString, double>& currentParamMap, QVector<double>& residuals, double& currentSSE,
+                                               const LocalSearchOptions& options, Eigen::MatrixXd* finalJacobian) {
+    const int nParams = fitIndices.size();
+    double lambda = 0.01;
+    int maxIter = options.maxIterations;
+
+    int residualEvaluations = 0, jacobianEvaluations = 0;
     for(int iter = 0; iter < maxIter; ++iter) {
-        if(m_stopRequested) break;
-        if (!residuals.isEmpty() && (currentSSE / residuals.size()) < 3e-3) break;
+        if(m_cancellation.isCancelled()) break;
+        if (!residuals.isEmpty() && (currentSSE / residuals.size()) < options.targetError) break;
 
-        emit sigProgress(iter * 100 / maxIter);
+        if (options.reportSteps) emit sigProgress(iter * 100 / maxIter);
 
         QVector<QVector<double>> J = computeJacobian(currentParamMap, residuals, fitIndices, modelType, params, weight, fitT, fitP, fitD);
+        ++jacobianEvaluations;
+        if (m_cancellation.isCancelled()) break;
         int nRes = residuals.size();
+        if (finalJacobian) {
+            finalJacobian->resize(nRes, nParams);
+            for (int k = 0; k < nRes; ++k)
+                for (int i = 0; i < nParams; ++i) (*finalJacobian)(k, i) = J[k][i];
+        }
 
+        // 法方程 H = JᵀJ，g = Jᵀr (可复现模式按固定分块顺序归约)
+        Eigen::MatrixXd Je(nRes, nParams);
+        for (int k = 0; k < nRes; ++k)
+            for (int i = 0; i < nParams; ++i) Je(k, i) = J[k][i];
+        Eigen::MatrixXd Ae;
+        Eigen::VectorXd ge;
+        NormalEquations::build(Je, Eigen::Map<const Eigen::VectorXd>(residuals.constData(), nRes), Ae, ge,
+                               m_reproducibility.reproducible);
         QVector<QVector<double>> H(nParams, QVector<double>(nParams, 0.0));
         QVector<double> g(nParams, 0.0);
-
-        for(int k=0; k<nRes; ++k) {
-            for(int i=0; i<nParams; ++i) {
-                g[i] += J[k][i] * residuals[k];
-                for(int j=0; j<=i; ++j) {
-                    H[i][j] += J[k][i] * J[k][j];
-                }
-            }
-        }
-        for(int i=0; i<nParams; ++i) {
-            for(int j=i+1; j<nParams; ++j) H[i][j] = H[j][i];
+        for (int i = 0; i < nParams; ++i) {
+            g[i] = ge(i);
+            for (int j = 0; j < nParams; ++j) H[i][j] = Ae(i, j);
         }
 
         bool stepAccepted = false;
+        bool stalled = false;
         for(int tryIter=0; tryIter<5; ++tryIter) {
             QVector<QVector<double>> H_lm = H;
             for(int i=0; i<nParams; ++i) H_lm[i][i] += lambda * (1.0 + std::abs(H[i][i]));
@@ -233,61 +1053,499 @@ void FittingCore::runLevenbergMarquardtOptimization(ModelManager::ModelType mode
             for(int i=0;i<nParams;++i) negG[i] = -g[i];
 
             QVector<double> delta = solveLinearSystem(H_lm, negG);
-            QMap<QString, double> trialMap = currentParamMap;
-
-            for(int i=0; i<nParams; ++i) {
-                int pIdx = fitIndices[i];
-                QString pName = params[pIdx].name;
-                double oldVal = currentParamMap[pName];
-                bool isLog = (oldVal > 1e-12 && pName != "S" && pName != "nf");
-                double newVal;
-                if(isLog) newVal = pow(10.0, log10(oldVal) + delta[i]);
-                else newVal = oldVal + delta[i];
-                newVal = qMax(params[pIdx].min, qMin(newVal, params[pIdx].max));
-                trialMap[pName] = newVal;
-            }
-
-            if(trialMap.contains("L") && trialMap.contains("Lf") && trialMap["L"] > 1e-9)
-                trialMap["LfD"] = trialMap["Lf"] / trialMap["L"];
-            if(trialMap.contains("kf") && trialMap.contains("km")) {
-                if(trialMap["kf"] <= trialMap["km"]) trialMap["kf"] = trialMap["km"] * 1.01;
-            }
-            if(trialMap.contains("omega1") && trialMap.contains("omega2")) {
-                if(trialMap["omega1"] <= trialMap["omega2"]) trialMap["omega1"] = trialMap["omega2"] * 1.01;
-            }
+            QMap<QString, double> trialMap = applyParameterStep(currentParamMap, delta, fitIndices, params);
 
-            QVector<double> newRes = calculateResiduals(trialMap, modelType, weight, fitT, fitP, fitD);
+            ModelCurveData trialCurve;
+            QVector<double> newRes = calculateResiduals(m_iterationSettings, trialMap, modelType, weight, fitT, fitP, fitD,
+                                                        &trialCurve);
+            ++residualEvaluations;
+            if (m_cancellation.isCancelled()) break;
             double newSSE = calculateSumSquaredError(newRes);
 
-            if(newSSE < currentSSE) {
+            if(!newRes.isEmpty() && newSSE < currentSSE) {
+                stalled = options.stallStep > 0.0
+                          && (currentSSE - newSSE) < options.stallReduction * currentSSE
+                          && parameterStep(currentParamMap, trialMap, fitIndices, params).lpNorm<Eigen::Infinity>() < options.stallStep;
                 currentSSE = newSSE;
                 currentParamMap = trialMap;
                 residuals = newRes;
                 lambda /= 10.0;
                 stepAccepted = true;
-                ModelCurveData iterCurve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-                emit sigIterationUpdated(currentSSE/nRes, currentParamMap, std::get<0>(iterCurve), std::get<1>(iterCurve), std::get<2>(iterCurve));
+                if (options.reportSteps) publishIterationPreview(modelType, currentSSE/nRes, currentParamMap, &trialCurve);
                 break;
             } else {
                 lambda *= 10.0;
             }
         }
         if(!stepAccepted && lambda > 1e10) break;
+        if(stalled) break;
     }
+    if (options.reportSteps && jacobianEvaluations > 0) {
+        qDebug() << "LM 迭代: 残差计算" << residualEvaluations << "次，完整雅可比" << jacobianEvaluations
+                 << "次，SSE =" << currentSSE;
+    }
+}
+
+void FittingCore::runGeodesicLevenbergMarquardt(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                                const QVector<int>& fitIndices, const QVector<double>& t,
+                                                const QVector<double>& obsP, const QVector<double>& obsD,
+                                                QMap<QString, double>& currentParamMap, QVector<double>& residuals, double& currentSSE,
+                                                const LocalSearchOptions& options, Eigen::MatrixXd* finalJacobian) {
+    const int nParams = fitIndices.size();
+    const int nRes = residuals.size();
+    if (nParams == 0 || nRes == 0) return;
+
+    const int maxTrials = 3 * options.maxIterations; // 试探步上限 (每步 1~2 次残差计算)
+    const double probeStep = 0.1;       // 方向二阶导数的差分步长 h
+    const double accelerationRatio = 0.75;
+    const int refreshInterval = 4;      // 连续接受该次数后重新计算完整雅可比矩阵
+    const double linearGain = 0.75;     // 上一步增益比高于该值时线性化已足够准确，不计算加速度
+    const double relativeTolerance = 1e-6; // 完整雅可比下单步相对下降低于该值视为收敛
+
+    auto toVector = [](const QVector<double>& v) {
+        return Eigen::VectorXd(Eigen::Map<const Eigen::VectorXd>(v.constData(), v.size()));
+    };
+    auto toQVector = [](const Eigen::VectorXd& v) {
+        QVector<double> out(v.size());
+        for (int i = 0; i < v.size(); ++i) out[i] = v(i);
+        return out;
+    };
+    int residualEvaluations = 0, jacobianEvaluations = 0, broydenUpdates = 0;
+    auto fullJacobian = [&]() {
+        QVector<QVector<double>> rows = computeJacobian(currentParamMap, residuals, fitIndices, modelType, params,
+                                                        weight, t, obsP, obsD);
+        ++jacobianEvaluations;
+        Eigen::MatrixXd J(nRes, nParams);
+        for (int i = 0; i < nRes; ++i)
+            for (int j = 0; j < nParams; ++j) J(i, j) = rows[i][j];
+        return J;
+    };
+    // Broyden 秩一更新：J += (Δr - J·s) sᵀ / (sᵀs)
+    auto broydenUpdate = [&](Eigen::MatrixXd& J, const Eigen::VectorXd& s, const Eigen::VectorXd& dr) {
+        double ss = s.squaredNorm();
+        if (!(ss > 1e-20) || !dr.allFinite()) return;
+        J.noalias() += ((dr - J * s) / ss) * s.transpose();
+        ++broydenUpdates;
+    };
+    auto evaluate = [&](const QMap<QString, double>& map, ModelCurveData* curve) {
+        ++residualEvaluations;
+        return calculateResiduals(m_iterationSettings, map, modelType, weight, t, obsP, obsD, curve);
+    };
+
+    Eigen::VectorXd r = toVector(residuals);
+    Eigen::MatrixXd J = fullJacobian();
+    bool jacobianFresh = true;
+    int acceptedSinceRefresh = 0;
+    double lambda = 0.01;
+    double nu = 2.0;
+    double lastRho = 0.0;
+
+    for (int trial = 0; trial < maxTrials; ++trial) {
+        if (m_cancellation.isCancelled()) break;
+        if (currentSSE / nRes < options.targetError) break;
+        if (lambda > 1e10) break;
+
+        if (options.reportSteps) emit sigProgress(trial * 100 / maxTrials);
+
+        // 阻尼法方程 (Jᵀ J + λ·diag(1 + |JᵀJ|_ii)) v = -Jᵀ r
+        Eigen::MatrixXd A;
+        Eigen::VectorXd g;
+        NormalEquations::build(J, r, A, g, m_reproducibility.reproducible);
+        Eigen::MatrixXd M = A;
+        for (int i = 0; i < nParams; ++i) M(i, i) += lambda * (1.0 + std::abs(A(i, i)));
+        const Eigen::LDLT<Eigen::MatrixXd> ldlt(M);
+        const Eigen::VectorXd v = ldlt.solve(-g);
+        if (!v.allFinite()) { lambda *= nu; nu *= 2.0; continue; }
+
+        // 步长已可忽略：雅可比为更新值时先重算一次再判断收敛
+        if (v.lpNorm<Eigen::Infinity>() < 1e-8) {
+            if (jacobianFresh) break;
+            J = fullJacobian();
+            jacobianFresh = true;
+            acceptedSinceRefresh = 0;
+            continue;
+        }
+
+        const Eigen::MatrixXd modelJ = J;
+        const bool modelFresh = jacobianFresh;
+        Eigen::VectorXd step = v;
+
+        // 测地线加速度：r_vv ≈ (2/h)·((r(x + h·v) - r(x))/h - J·v)
+        QVector<double> probeRes;
+        QMap<QString, double> probeMap;
+        if (lastRho < linearGain) {
+            probeMap = applyParameterStep(currentParamMap, toQVector(probeStep * v), fitIndices, params);
+            probeRes = evaluate(probeMap, nullptr);
+        }
+        if (probeRes.size() == nRes) {
+            const Eigen::VectorXd rp = toVector(probeRes);
+            const Eigen::VectorXd sp = parameterStep(currentParamMap, probeMap, fitIndices, params);
+            // 探测步被截断或约束修正时差商不再对应方向 v，只用于秩一更新
+            if ((sp - probeStep * v).norm() <= 1e-9 * (1.0 + probeStep * v.norm()) && rp.allFinite()) {
+                const Eigen::VectorXd rvv = (2.0 / probeStep) * ((rp - r) / probeStep - modelJ * v);
+                const Eigen::VectorXd a = ldlt.solve(-NormalEquations::transposeTimes(modelJ, rvv, m_reproducibility.reproducible));
+                if (a.allFinite() && 2.0 * a.norm() <= accelerationRatio * v.norm()) step = v + 0.5 * a;
+            }
+            broydenUpdate(J, sp, rp - r);
+            jacobianFresh = false;
+        }
 
-    if(m_modelManager) m_modelManager->setHighPrecision(true);
-    // 最后一次刷新
-    ModelCurveData finalCurve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-    emit sigIterationUpdated(currentSSE/residuals.size(), currentParamMap, std::get<0>(finalCurve), std::get<1>(finalCurve), std::get<2>(finalCurve));
+        QMap<QString, double> trialMap = applyParameterStep(currentParamMap, toQVector(step), fitIndices, params);
+        ModelCurveData trialCurve;
+        QVector<double> newRes = evaluate(trialMap, &trialCurve);
+        if (m_cancellation.isCancelled()) break;
+        bool accepted = false;
+        bool converged = false;
+        bool stalled = false;
+        if (newRes.size() == nRes) {
+            const Eigen::VectorXd rn = toVector(newRes);
+            const Eigen::VectorXd s = parameterStep(currentParamMap, trialMap, fitIndices, params);
+            const double newSSE = rn.squaredNorm();
+            // 增益比：实际下降 / 线性化模型预测的下降
+            const double predicted = currentSSE - (r + modelJ * s).squaredNorm();
+            const double rho = (predicted > 0.0) ? (currentSSE - newSSE) / predicted : -1.0;
+            broydenUpdate(J, s, rn - r);
+            jacobianFresh = false;
+
+            if (std::isfinite(newSSE) && newSSE < currentSSE && rho > 0.0) {
+                accepted = true;
+                converged = (currentSSE - newSSE) <= relativeTolerance * currentSSE;
+                stalled = options.stallStep > 0.0 && (currentSSE - newSSE) < options.stallReduction * currentSSE
+                          && s.lpNorm<Eigen::Infinity>() < options.stallStep;
+                currentParamMap = trialMap;
+                residuals = newRes;
+                r = rn;
+                currentSSE = newSSE;
+                lambda *= std::max(1.0 / 3.0, 1.0 - std::pow(2.0 * rho - 1.0, 3));
+                nu = 2.0;
+                lastRho = rho;
+                ++acceptedSinceRefresh;
+                if (options.reportSteps) publishIterationPreview(modelType, currentSSE / nRes, currentParamMap, &trialCurve);
+            }
+        }
+        if (!accepted) {
+            lambda *= nu;
+            nu *= 2.0;
+            lastRho = 0.0;
+        }
+        if ((converged && modelFresh) || stalled) break;
+
+        // 以更新后的雅可比矩阵求得的步被拒绝或下降停滞、或已连续接受多步时重算完整雅可比矩阵
+        if ((!modelFresh && (!accepted || converged)) || acceptedSinceRefresh >= refreshInterval) {
+            J = fullJacobian();
+            jacobianFresh = true;
+            acceptedSinceRefresh = 0;
+        }
+    }
+
+    if (finalJacobian && !m_cancellation.isCancelled()) *finalJacobian = J;
+    if (options.reportSteps) {
+        qDebug() << "测地线 LM 迭代: 残差计算" << residualEvaluations << "次，完整雅可比" << jacobianEvaluations
+                 << "次，Broyden 更新" << broydenUpdates << "次，SSE =" << currentSSE;
+    }
+}
+
+void FittingCore::runLocalSearch(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                 const QVector<int>& fitIndices, const QVector<double>& t,
+                                 const QVector<double>& obsP, const QVector<double>& obsD,
+                                 QMap<QString, double>& currentParamMap, QVector<double>& residuals, double& currentSSE,
+                                 const LocalSearchOptions& options, Eigen::MatrixXd* finalJacobian) {
+    if (m_optimizerMethod == Optimizer_GeodesicLM) {
+        runGeodesicLevenbergMarquardt(modelType, params, weight, fitIndices, t, obsP, obsD,
+                                      currentParamMap, residuals, currentSSE, options, finalJacobian);
+    } else {
+        runClassicLevenbergMarquardt(modelType, params, weight, fitIndices, t, obsP, obsD,
+                                     currentParamMap, residuals, currentSSE, options, finalJacobian);
+    }
 }
 
-QVector<double> FittingCore::calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType, double weight,
+void FittingCore::runMiniBatchPhase(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                    const QVector<int>& fitIndices, const QVector<double>& t,
+                                    const QVector<double>& obsP, const QVector<double>& obsD,
+                                    QMap<QString, double>& currentParamMap) {
+    const int batchSize = m_miniBatchSize;
+    if (t.size() < 2 * batchSize) return;
+
+    // 按对数周期分层 (非正时间单独一层)
+    QMap<int, QVector<int>> strata;
+    for (int i = 0; i < t.size(); ++i) {
+        const int decade = (t[i] > 0.0) ? (int)std::floor(log10(t[i])) : INT_MIN;
+        strata[decade].append(i);
+    }
+
+    // 每批在同一子集上计算当前点与试探点的残差，误差可比；随机种子随分析状态保存以便复现
+    std::mt19937 rng(m_reproducibility.miniBatchSeed);
+    LocalSearchOptions options;
+    options.maxIterations = 1;
+    options.reportSteps = false;
+    const int maxBatches = 30;
+    int stalls = 0, batches = 0;
+    double sse = 0.0;
+    for (; batches < maxBatches; ++batches) {
+        if (m_cancellation.isCancelled()) break;
+
+        // 各层按样本数比例分配名额 (至少 1 个)，层内无放回抽取并保持时间顺序
+        QVector<int> picked;
+        for (auto it = strata.constBegin(); it != strata.constEnd(); ++it) {
+            const QVector<int>& members = it.value();
+            const int quota = qMax(1, (int)std::lround(double(batchSize) * members.size() / t.size()));
+            if (quota >= members.size()) picked += members;
+            else std::sample(members.begin(), members.end(), std::back_inserter(picked), quota, rng);
+        }
+        std::sort(picked.begin(), picked.end());
+        QVector<double> bt, bp, bd;
+        for (int i : picked) {
+            bt.append(t[i]);
+            if (i < obsP.size()) bp.append(obsP[i]);
+            if (i < obsD.size()) bd.append(obsD[i]);
+        }
+
+        QVector<double> residuals = calculateResiduals(m_iterationSettings, currentParamMap, modelType, weight, bt, bp, bd);
+        if (residuals.isEmpty()) break;
+        sse = calculateSumSquaredError(residuals);
+        const double before = sse;
+        runLocalSearch(modelType, params, weight, fitIndices, bt, bp, bd, currentParamMap, residuals, sse, options);
+        if (m_cancellation.isCancelled()) break;
+        publishIterationPreview(modelType, sse / residuals.size(), currentParamMap);
+
+        // 在新子集上 LM 一步总能拟合掉约 n/m 的相对误差 (子集噪声)，连续两批的下降都不超过
+        // max(1%, 2n/m) 时已接近收敛，转入完整数据
+        const double noiseFloor = qMax(0.01, 2.0 * fitIndices.size() / residuals.size());
+        stalls = ((before - sse) < noiseFloor * before) ? stalls + 1 : 0;
+        if (stalls >= 2) { ++batches; break; }
+    }
+    qDebug() << "小批量迭代:" << batches << "批，每批约" << batchSize << "点 (共" << t.size() << "点)，批内 SSE =" << sse;
+}
+
+void FittingCore::runFidelityLadder(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                    const QVector<int>& fitIndices, const QVector<double>& t,
+                                    const QVector<double>& obsP, const QVector<double>& obsD,
+                                    QMap<QString, double>& currentParamMap) {
+    bool fitNf = false, fitN = false;
+    for (int i : fitIndices) {
+        if (params[i].name == "nf") fitNf = true;
+        if (params[i].name == "N") fitN = true;
+    }
+
+    // 完整保真度下的 nf 与反演阶数 (与 ModelSolver01_06::resolveParams 的默认值一致)
+    const QMap<QString, double> original = currentParamMap;
+    const int fullNf = (!original.contains("nf") || original.value("nf") < 4) ? ModelSolver01_06::defaultFractureSegments()
+                                                                               : (int)original.value("nf");
+    const LaplaceInversion::Method method = original.contains("inversion")
+                                                ? LaplaceInversion::methodFromValue(original.value("inversion"))
+                                                : m_iterationSettings.inversionMethod;
+    const bool stehfest = (method == LaplaceInversion::Stehfest);
+    const QString orderKey = stehfest ? QString("N") : QString("inversionOrder");
+    int fullOrder = 0;
+    if (stehfest) {
+        const int n = (int)original.value("N", 10.0);
+        fullOrder = (n < 4) ? 10 : LaplaceInversion::normalizeOrder(method, n);
+    } else {
+        int order = (int)original.value("inversionOrder", 0.0);
+        fullOrder = LaplaceInversion::normalizeOrder(method, order > 0 ? order : m_iterationSettings.inversionOrder);
+    }
+
+    // 粗级的参数字典含临时的 nf/N，不逐步通知界面
+    LocalSearchOptions options;
+    options.maxIterations = 10;
+    options.reportSteps = false;
+    options.stallReduction = 0.01;
+    options.stallStep = 0.01;
+
+    for (int level = 0; level < m_fidelityLadder.size(); ++level) {
+        if (m_cancellation.isCancelled()) break;
+        const FidelityLevel& f = m_fidelityLadder[level];
+
+        // 等间隔选取抽样点 (保留首末点)
+        QVector<double> lt, lp, ld;
+        const int stride = qMax(1, (int)std::ceil(double(t.size()) / qMax(2, f.samplePoints)));
+        for (int i = 0; i < t.size(); ++i) {
+            if (i % stride != 0 && i != t.size() - 1) continue;
+            lt.append(t[i]);
+            if (i < obsP.size()) lp.append(obsP[i]);
+            if (i < obsD.size()) ld.append(obsD[i]);
+        }
+
+        QMap<QString, double> levelMap = currentParamMap;
+        if (!fitNf && f.fractureSegments > 0) levelMap["nf"] = qMin(fullNf, qMax(4, f.fractureSegments));
+        const int order = qMin(fullOrder, LaplaceInversion::normalizeOrder(method, f.inversionOrder));
+        if (!(stehfest && fitN)) levelMap[orderKey] = order;
+
+        QVector<double> residuals = calculateResiduals(m_iterationSettings, levelMap, modelType, weight, lt, lp, ld);
+        if (residuals.isEmpty()) continue;
+        double sse = calculateSumSquaredError(residuals);
+        runLocalSearch(modelType, params, weight, fitIndices, lt, lp, ld, levelMap, residuals, sse, options);
+
+        // 只取回拟合参数 (及其约束关联量)，nf/N 等保持原值
+        for (auto it = levelMap.constBegin(); it != levelMap.constEnd(); ++it) {
+            if (it.key() == "nf" || it.key() == "N" || it.key() == "inversionOrder") continue;
+            currentParamMap[it.key()] = it.value();
+        }
+        if (m_cancellation.isCancelled()) break;
+        publishIterationPreview(modelType, sse / residuals.size(), currentParamMap);
+        qDebug() << "多保真度: 第" << (level + 1) << "级 (nf" << levelMap.value("nf") << "，阶数" << order
+                 << "，" << lt.size() << "点) SSE =" << sse;
+    }
+}
+
+void FittingCore::runGlobalSearch(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                  const QVector<int>& fitIndices, const QVector<double>& t,
+                                  const QVector<double>& obsP, const QVector<double>& obsD,
+                                  QMap<QString, double>& currentParamMap, QVector<double>& residuals, double& currentSSE) {
+    struct Candidate {
+        QMap<QString, double> params;
+        QVector<double> residuals;
+        double sse = 1e300;
+    };
+
+    // 低保真数据：隔点抽样
+    QVector<double> coarseT, coarseP, coarseD;
+    for (int i = 0; i < t.size(); i += 2) {
+        coarseT.append(t[i]);
+        if (i < obsP.size()) coarseP.append(obsP[i]);
+        if (i < obsD.size()) coarseD.append(obsD[i]);
+    }
+
+    QVector<QMap<QString, double>> starts;
+    starts.append(currentParamMap);
+    starts += latinHypercubeStarts(currentParamMap, fitIndices, params, m_globalStarts);
+    const int polishCount = qMin(m_globalPolished, starts.size());
+    const int totalRuns = starts.size() + polishCount;
+    QAtomicInteger<int> finishedRuns(0);
+    const CancellationToken* token = CancellationToken::current();
+
+    auto runCandidate = [&](const QMap<QString, double>& start, const QVector<double>& ct, const QVector<double>& cp,
+                            const QVector<double>& cd, const LocalSearchOptions& options) -> Candidate {
+        ModelSolver01_06::ScopedSerialEvaluation serialScope;
+        CancellationToken::Scope cancellationScope(token); // 线程池线程上重新安装拟合线程的令牌
+        Candidate c;
+        c.params = start;
+        c.residuals = calculateResiduals(m_iterationSettings, start, modelType, weight, ct, cp, cd);
+        c.sse = c.residuals.isEmpty() ? 1e300 : calculateSumSquaredError(c.residuals);
+        if (!m_cancellation.isCancelled() && !c.residuals.isEmpty()) {
+            runLocalSearch(modelType, params, weight, fitIndices, ct, cp, cd, c.params, c.residuals, c.sse, options);
+        }
+        if (!c.residuals.isEmpty()) {
+            ModelCurveData curve = calculateModelCurve(modelType, m_iterationSettings, c.params);
+            if (!m_cancellation.isCancelled())
+                emit sigIterationUpdated(c.sse / c.residuals.size(), c.params, std::get<0>(curve), std::get<1>(curve), std::get<2>(curve));
+        }
+        emit sigProgress((finishedRuns.fetchAndAddOrdered(1) + 1) * 100 / totalRuns);
+        return c;
+    };
+
+    // 粗搜索：全部起点并行，低保真数据上有限次迭代
+    LocalSearchOptions coarseOptions;
+    coarseOptions.maxIterations = 8;
+    coarseOptions.reportSteps = false;
+    QList<Candidate> coarse = QtConcurrent::blockingMapped(starts, [&](const QMap<QString, double>& start) {
+        return runCandidate(start, coarseT, coarseP, coarseD, coarseOptions);
+    });
+    std::stable_sort(coarse.begin(), coarse.end(), [](const Candidate& a, const Candidate& b) { return a.sse < b.sse; });
+
+    // 精修：误差最小的若干个候选在完整抽样数据上常规迭代
+    QVector<QMap<QString, double>> promoted;
+    for (int i = 0; i < polishCount && i < coarse.size(); ++i) promoted.append(coarse[i].params);
+    LocalSearchOptions polishOptions;
+    polishOptions.reportSteps = false;
+    QList<Candidate> polished = QtConcurrent::blockingMapped(promoted, [&](const QMap<QString, double>& start) {
+        return runCandidate(start, t, obsP, obsD, polishOptions);
+    });
+
+    int best = -1;
+    for (int i = 0; i < polished.size(); ++i) {
+        if (polished[i].residuals.size() == residuals.size() && polished[i].sse < currentSSE
+            && (best < 0 || polished[i].sse < polished[best].sse)) best = i;
+    }
+    if (best >= 0) {
+        currentParamMap = polished[best].params;
+        residuals = polished[best].residuals;
+        currentSSE = polished[best].sse;
+    }
+    qDebug() << "全局搜索: 起点" << starts.size() << "个，精修" << polished.size() << "个，采用第"
+             << (best + 1) << "个精修结果，SSE =" << currentSSE;
+}
+
+QVector<QMap<QString, double>> FittingCore::latinHypercubeStarts(const QMap<QString, double>& base, const QVector<int>& fitIndices,
+                                                                 const QList<FitParameter>& params, int count) const {
+    QVector<QMap<QString, double>> starts(count, base);
+    if (count <= 0) return QVector<QMap<QString, double>>();
+
+    std::mt19937 rng(m_reproducibility.multiStartSeed);
+    std::uniform_real_distribution<double> jitter(0.0, 1.0);
+    QVector<int> strata(count);
+    for (int i : fitIndices) {
+        const FitParameter& fp = params[i];
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), rng);
+        const bool isLog = (fp.min > 1e-12 && fp.max > fp.min && fp.name != "S" && fp.name != "nf");
+        for (int k = 0; k < count; ++k) {
+            double u = (strata[k] + jitter(rng)) / count;
+            double v = isLog ? pow(10.0, log10(fp.min) + u * (log10(fp.max) - log10(fp.min)))
+                             : fp.min + u * (fp.max - fp.min);
+            if (fp.name == "nf") v = qMax(fp.min, qMin(std::round(v), fp.max));
+            starts[k][fp.name] = v;
+        }
+    }
+    // 零步长施加约束修正 (kf > km、omega1 > omega2、LfD)
+    for (auto& start : starts) start = applyParameterStep(start, QVector<double>(), fitIndices, params);
+    return starts;
+}
+
+QMap<QString, double> FittingCore::applyParameterStep(const QMap<QString, double>& base, const QVector<double>& delta,
+                                                      const QVector<int>& fitIndices, const QList<FitParameter>& params) const {
+    QMap<QString, double> trialMap = base;
+    if (!delta.isEmpty()) {
+        const ParameterTransform transform(params, fitIndices);
+        Eigen::VectorXd u = transform.toUnconstrained(base);
+        for (int i = 0; i < u.size() && i < delta.size(); ++i) u(i) += delta[i];
+        trialMap = transform.toParameters(base, u);
+    }
+
+    // 依赖参数；未声明为有序参数对 (或不在 log10 空间) 的约束仍按原规则修正
+    if(trialMap.contains("L") && trialMap.contains("Lf") && trialMap["L"] > 1e-9)
+        trialMap["LfD"] = trialMap["Lf"] / trialMap["L"];
+    if(trialMap.contains("kf") && trialMap.contains("km")) {
+        if(trialMap["kf"] <= trialMap["km"]) trialMap["kf"] = trialMap["km"] * 1.01;
+    }
+    if(trialMap.contains("omega1") && trialMap.contains("omega2")) {
+        if(trialMap["omega1"] <= trialMap["omega2"]) trialMap["omega1"] = trialMap["omega2"] * 1.01;
+    }
+    return trialMap;
+}
+
+Eigen::VectorXd FittingCore::parameterStep(const QMap<QString, double>& from, const QMap<QString, double>& to,
+                                           const QVector<int>& fitIndices, const QList<FitParameter>& params) const {
+    const ParameterTransform transform(params, fitIndices);
+    return transform.toUnconstrained(to) - transform.toUnconstrained(from);
+}
+
+QVector<double> FittingCore::calculateResiduals(const QMap<QString, double>& params, ModelEngine::ModelType modelType, double weight,
                                                 const QVector<double>& t, const QVector<double>& obsP, const QVector<double>& obsD) {
-    if(!m_modelManager || t.isEmpty()) return QVector<double>();
+    if(!m_engine) return QVector<double>();
+    return calculateResiduals(m_engine->solverSettings(), params, modelType, weight, t, obsP, obsD);
+}
+
+QVector<double> FittingCore::calculateResiduals(const SolverSettings& settings, const QMap<QString, double>& params,
+                                                ModelEngine::ModelType modelType, double weight,
+                                                const QVector<double>& t, const QVector<double>& obsP, const QVector<double>& obsD,
+                                                ModelCurveData* curve) {
+    WT_TRACE_SCOPE("FittingCore::calculateResiduals");
+    if(!m_engine || t.isEmpty()) return QVector<double>();
 
-    ModelCurveData res = m_modelManager->calculateTheoreticalCurve(modelType, params, t);
-    const QVector<double>& pCal = std::get<1>(res);
-    const QVector<double>& dpCal = std::get<2>(res);
+    ModelCurveData res = calculateModelCurve(modelType, settings, params, t);
+    // 计算中途被取消时曲线不完整，返回空残差 (调用方据此放弃该次试算)
+    const CancellationToken* token = CancellationToken::current();
+    if (token && token->isCancelled()) return QVector<double>();
+    if (curve) *curve = res;
+    return residualsFromCurve(res, weight, obsP, obsD);
+}
+
+QVector<double> FittingCore::residualsFromCurve(const ModelCurveData& curve, double weight,
+                                                const QVector<double>& obsP, const QVector<double>& obsD) const {
+    const QVector<double>& tCal = std::get<0>(curve);
+    const QVector<double>& pCal = std::get<1>(curve);
+    const QVector<double>& dpCal = std::get<2>(curve);
 
     QVector<double> r;
     double wp = weight;
@@ -303,55 +1561,158 @@ QVector<double> FittingCore::calculateResiduals(const QMap<QString, double>& par
     int dCount = qMin((int)obsD.size(), (int)dpCal.size());
     dCount = qMin(dCount, count);
     for(int i=0; i<dCount; ++i) {
+        const double wi = (m_regimeSegments.isEmpty() || i >= tCal.size())
+                              ? wd : wd * FlowRegimeSegmenter::weightAt(m_regimeSegments, tCal[i]);
         if(obsD[i] > 1e-10 && dpCal[i] > 1e-10)
-            r.append( (log(obsD[i]) - log(dpCal[i])) * wd );
+            r.append( (log(obsD[i]) - log(dpCal[i])) * wi );
         else
             r.append(0.0);
     }
     return r;
 }
 
+QVector<QMap<QString, double>> FittingCore::suggestInitialGuesses(ModelEngine::ModelType modelType,
+                                                                  const QList<FitParameter>& params, int k) {
+    QVector<QMap<QString, double>> guesses;
+    if (k <= 0 || m_observed->isEmpty()) return guesses;
+
+    QMap<QString, double> base;
+    QMap<QString, const FitParameter*> fitParams;
+    for (const FitParameter& p : params) {
+        base.insert(p.name, p.value);
+        if (p.isFit) fitParams.insert(p.name, &p);
+    }
+    if (fitParams.isEmpty()) return guesses;
+
+    QVector<double> t, p, d;
+    getSampledObservedData(t, p, d);
+    // 裂缝条数的取值规则与 ModelSolver01_06::resolveParams 一致
+    const int nf = (!base.contains("nf") || base.value("nf") < 4) ? ModelSolver01_06::defaultFractureSegments() : (int)base.value("nf");
+    QVector<TypeCurveIndex::Match> matches = TypeCurveIndex::search((int)modelType, nf, t, p, d, k);
+
+    // 与 ModelSolver01_06 中的无因次换算默认值一致
+    const double phi = base.value("phi", 0.05);
+    const double mu = base.value("mu", 0.5);
+    const double B = base.value("B", 1.05);
+    const double Ct = base.value("Ct", 5e-4);
+    const double q = base.value("q", 5.0);
+    const double h = base.value("h", 20.0);
+
+    for (const TypeCurveIndex::Match& m : matches) {
+        if (!(m.pCoeff > 0.0) || !(m.tdCoeff > 0.0)) continue;
+        QMap<QString, double> guess = base;
+
+        // 压力系数 p/pD 决定 kf，时间系数 tD/t 决定参考长度 L
+        double kf = base.value("kf", 1e-3);
+        if (fitParams.contains("kf")) kf = 1.842e-3 * q * mu * B / (m.pCoeff * h);
+        guess["kf"] = kf;
+        double L = base.value("L", 1000.0);
+        if (fitParams.contains("L")) L = std::sqrt(14.4 * kf / (phi * mu * Ct * m.tdCoeff));
+        guess["L"] = L;
+
+        // 无因次形状参数换算为有因次参数
+        const double* v = m.kernel;
+        guess["Lf"] = v[ModelParams::Kernel_LfD] * L;
+        guess["rm"] = v[ModelParams::Kernel_rmD] * L;
+        guess["re"] = v[ModelParams::Kernel_reD] * L;
+        if (guess.contains("LfD")) guess["LfD"] = v[ModelParams::Kernel_LfD];
+        if (guess.contains("rmD")) guess["rmD"] = v[ModelParams::Kernel_rmD];
+        if (guess.contains("reD")) guess["reD"] = v[ModelParams::Kernel_reD];
+        if (guess.contains("M12")) guess["M12"] = v[ModelParams::Kernel_M12];
+        else guess["km"] = kf / v[ModelParams::Kernel_M12];
+        guess["omega1"] = v[ModelParams::Kernel_omega1];
+        guess["omega2"] = v[ModelParams::Kernel_omega2];
+        if (guess.contains("remda1")) guess["remda1"] = v[ModelParams::Kernel_lambda1];
+        else guess["lambda1"] = v[ModelParams::Kernel_lambda1];
+        if (guess.contains("remda2")) guess["remda2"] = v[ModelParams::Kernel_lambda2];
+        else guess["lambda2"] = v[ModelParams::Kernel_lambda2];
+        if (guess.contains("eta12")) guess["eta12"] = v[ModelParams::Kernel_eta12];
+        else guess["eta"] = v[ModelParams::Kernel_eta12];
+        guess["cD"] = v[ModelParams::Kernel_cD];
+        guess["S"] = v[ModelParams::Kernel_S];
+
+        // 非拟合参数保持原值，拟合参数截断到取值范围
+        QMap<QString, double> result = base;
+        for (auto it = fitParams.constBegin(); it != fitParams.constEnd(); ++it) {
+            if (!guess.contains(it.key()) || it.key() == "nf") continue;
+            const FitParameter* fp = it.value();
+            result[it.key()] = qMax(fp->min, qMin(guess.value(it.key()), fp->max));
+        }
+        if (result.contains("L") && result.contains("Lf") && result["L"] > 1e-9)
+            result["LfD"] = result["Lf"] / result["L"];
+        if (result.contains("kf") && result.contains("km") && result["kf"] <= result["km"])
+            result["kf"] = result["km"] * 1.01;
+        if (result.contains("omega1") && result.contains("omega2") && result["omega1"] <= result["omega2"])
+            result["omega1"] = result["omega2"] * 1.01;
+        if (result != base && !guesses.contains(result)) guesses.append(result);
+    }
+    return guesses;
+}
+
 QVector<QVector<double>> FittingCore::computeJacobian(const QMap<QString, double>& params, const QVector<double>& baseResiduals,
-                                                      const QVector<int>& fitIndices, ModelManager::ModelType modelType,
+                                                      const QVector<int>& fitIndices, ModelEngine::ModelType modelType,
                                                       const QList<FitParameter>& currentFitParams, double weight,
                                                       const QVector<double>& t, const QVector<double>& obsP, const QVector<double>& obsD) {
+    WT_TRACE_SCOPE("FittingCore::computeJacobian");
+    WT_MEMORY_SCOPE(MemoryAccounting::Fitter);
     int nRes = baseResiduals.size();
     int nParams = fitIndices.size();
     QVector<QVector<double>> J(nRes, QVector<double>(nParams));
 
-    QVector<int> indices(nParams);
-    std::iota(indices.begin(), indices.end(), 0);
+    const ParameterTransform transform(currentFitParams, fitIndices);
 
-    // 并行计算每一列导数
-    auto computeColumn = [&](int j) -> QVector<double> {
-        int idx = fitIndices[j];
-        QString pName = currentFitParams[idx].name;
-        double val = params.value(pName);
-        bool isLog = (val > 1e-12 && pName != "S" && pName != "nf");
-
-        double h;
-        QMap<QString, double> pPlus = params;
-        QMap<QString, double> pMinus = params;
-
-        if(isLog) {
-            h = 0.01;
-            double valLog = log10(val);
-            pPlus[pName] = pow(10.0, valLog + h);
-            pMinus[pName] = pow(10.0, valLog - h);
-        } else {
-            h = 1e-4;
-            pPlus[pName] = val + h;
-            pMinus[pName] = val - h;
+    // 解析敏感度：一次计算得到所有可解析求导的列
+    QVector<bool> solved(nParams, false);
+    // 解析敏感度对应定产量曲线，变产量叠加时全部按差分计算
+    if (m_jacobianMethod == Jacobian_Analytic && m_rateHistory.isEmpty()) {
+        fillAnalyticJacobian(J, solved, params, fitIndices, modelType, currentFitParams, weight, t, obsP, obsD);
+
+        // ∂r/∂u_j = Σ_i ∂r/∂x_i · ∂x_i/∂u_j；涉及未解析列的 (有序参数对) 改为差分
+        const Eigen::MatrixXd T = transform.jacobian(params);
+        const QVector<QVector<double>> Jx = J;
+        const QVector<bool> solvedX = solved;
+        for (int j = 0; j < nParams; ++j) {
+            bool analytic = true;
+            for (int i = 0; i < nParams; ++i) {
+                if (T(i, j) != 0.0 && !solvedX[i]) analytic = false;
+            }
+            solved[j] = analytic;
+            if (!analytic) continue;
+            for (int r = 0; r < nRes; ++r) {
+                double sum = 0.0;
+                for (int i = 0; i < nParams; ++i) {
+                    if (T(i, j) != 0.0) sum += Jx[r][i] * T(i, j);
+                }
+                J[r][j] = sum;
+            }
         }
+    }
+
+    // 其余列 (离散参数或差分模式) 使用中心差分
+    QVector<int> indices;
+    for (int j = 0; j < nParams; ++j) {
+        if (!solved[j]) indices.append(j);
+    }
+    if (indices.isEmpty()) return J;
+
+    // 并行计算每一列导数 (任务调度器把取消令牌与优先级带入各列，列内的时间点继续嵌套并行)
+    auto computeColumn = [&](int j) -> QVector<double> {
+        // 在迭代坐标中扰动 (有序参数对的下端参数同时移动上端参数)
+        const double h = transform.isLogScale(j) ? 0.01 : 1e-4;
+        Eigen::VectorXd u = transform.toUnconstrained(params);
+        u(j) += h;
+        QMap<QString, double> pPlus = transform.toParameters(params, u);
+        u(j) -= 2.0 * h;
+        QMap<QString, double> pMinus = transform.toParameters(params, u);
 
         auto updateDeps = [](QMap<QString,double>& map) {
             if(map.contains("L") && map.contains("Lf") && map["L"] > 1e-9)
                 map["LfD"] = map["Lf"] / map["L"];
         };
-        if(pName == "L" || pName == "Lf") { updateDeps(pPlus); updateDeps(pMinus); }
+        updateDeps(pPlus); updateDeps(pMinus);
 
-        QVector<double> rPlus = this->calculateResiduals(pPlus, modelType, weight, t, obsP, obsD);
-        QVector<double> rMinus = this->calculateResiduals(pMinus, modelType, weight, t, obsP, obsD);
+        QVector<double> rPlus = this->calculateResiduals(m_iterationSettings, pPlus, modelType, weight, t, obsP, obsD);
+        QVector<double> rMinus = this->calculateResiduals(m_iterationSettings, pMinus, modelType, weight, t, obsP, obsD);
 
         QVector<double> col(nRes, 0.0);
         if(rPlus.size() == nRes && rMinus.size() == nRes) {
@@ -360,9 +1721,16 @@ QVector<QVector<double>> FittingCore::computeJacobian(const QMap<QString, double
         return col;
     };
 
-    QList<QVector<double>> results = QtConcurrent::blockingMapped(indices, computeColumn);
-    for(int j=0; j<nParams; ++j) {
-        const QVector<double>& col = results[j];
+    // 全局搜索的各起点已在线程池中并行，此时各列串行计算
+    QVector<QVector<double>> results;
+    if (ModelSolver01_06::ScopedSerialEvaluation::isActive()) {
+        for (int j : indices) results.append(computeColumn(j));
+    } else {
+        results = TaskScheduler::mapped<QVector<double>>(indices.size(), [&](int c) { return computeColumn(indices.at(c)); });
+    }
+    for(int c=0; c<indices.size(); ++c) {
+        int j = indices[c];
+        const QVector<double>& col = results[c];
         for(int i=0; i<nRes; ++i) {
             if (i < col.size()) J[i][j] = col[i];
         }
@@ -370,6 +1738,50 @@ QVector<QVector<double>> FittingCore::computeJacobian(const QMap<QString, double
     return J;
 }
 
+void FittingCore::fillAnalyticJacobian(QVector<QVector<double>>& J, QVector<bool>& solved, const QMap<QString, double>& params,
+                                       const QVector<int>& fitIndices, ModelEngine::ModelType modelType,
+                                       const QList<FitParameter>& currentFitParams, double weight,
+                                       const QVector<double>& t, const QVector<double>& obsP, const QVector<double>& obsD) {
+    if(!m_engine || t.isEmpty()) return;
+
+    QStringList names;
+    for (int j = 0; j < fitIndices.size(); ++j) names.append(currentFitParams[fitIndices[j]].name);
+
+    ModelSensitivity sens = m_engine->calculateCurveSensitivity(modelType, m_iterationSettings, params, names, t);
+    if (sens.dP.size() != names.size() || sens.dD.size() != names.size()) return;
+
+    // 残差排列与 calculateResiduals 保持一致：先压力段，后导数段
+    int count = qMin((int)obsP.size(), (int)sens.p.size());
+    int dCount = qMin((int)obsD.size(), (int)sens.d.size());
+    dCount = qMin(dCount, count);
+    if (count + dCount != J.size()) return;
+
+    double wp = weight;
+    double wd = 1.0 - weight;
+
+    for (int j = 0; j < names.size(); ++j) {
+        if (!sens.analytic[j]) continue;
+
+        // 残差 r = w·(ln obs - ln cal)，此处为 ∂r/∂x，换算到迭代坐标由 computeJacobian 完成
+        const QVector<double>& dP = sens.dP[j];
+        const QVector<double>& dD = sens.dD[j];
+        for (int i = 0; i < count; ++i) {
+            if (obsP[i] > 1e-10 && sens.p[i] > 1e-10)
+                J[i][j] = -wp * dP[i] / sens.p[i];
+            else
+                J[i][j] = 0.0;
+        }
+        for (int i = 0; i < dCount; ++i) {
+            const double wi = m_regimeSegments.isEmpty() ? wd : wd * FlowRegimeSegmenter::weightAt(m_regimeSegments, t[i]);
+            if (obsD[i] > 1e-10 && sens.d[i] > 1e-10)
+                J[count + i][j] = -wi * dD[i] / sens.d[i];
+            else
+                J[count + i][j] = 0.0;
+        }
+        solved[j] = true;
+    }
+}
+
 QVector<double> FittingCore::solveLinearSystem(const QVector<QVector<double>>& A, const QVector<double>& b) {
     int n = b.size();
     if (n == 0) return QVector<double>();
@@ -6,6 +6,48 @@
  * 2. 处理数据的抽样逻辑 (getLogSampledData)。
  * 3. 管理拟合过程中的数学计算（残差、雅可比矩阵、线性方程组求解）。
  * 4. 提供异步拟合控制接口。
+ * 5. 雅可比矩阵支持解析敏感度 (默认) 与中心差分两种计算方式。
+ * 6. 拟合计算使用独立的求解器设置 (SolverSettings)，不修改 ModelManager 的全局精度。
+ * 7. [自动初值] 已加载类型曲线库时，LM 迭代前按类型曲线索引 (typecurveindex.h) 推荐若干组初值，
+ *    与当前初值一起批量试算，误差更小者作为迭代起点 (设置项 fitting/autoInitialGuess)。
+ * 8. [变产量叠加] 设置产量历史后，残差与刷新曲线均使用叠加后的理论曲线 (见 superposition.h)，
+ *    恢复试井换算为关井后的压差；雅可比矩阵此时按中心差分计算。
+ * 9. [测地线 LM] 可选信赖域 LM 迭代 (设置项 fitting/optimizerMethod)：Nielsen 阻尼更新、测地线加速度修正，
+ *    两次完整雅可比计算之间以 Broyden 秩一更新 (被拒绝的试探步同样参与更新)，法方程由 Eigen 构造。
+ * 10. [全局搜索] 可选多起点全局搜索 (设置项 fitting/globalSearch)：在各拟合参数 [min, max] 内按拉丁超立方
+ *    布置 K 个起点 (fitting/globalSearchStarts)，在线程池中并行做低保真的短 LM，误差最小的若干个
+ *    (fitting/globalSearchPolished) 再以常规精度精修，全部候选均通过 sigIterationUpdated 通知界面。
+ * 11. [多保真度] 可选的保真度阶梯 (设置项 fitting/multiFidelity、fitting/fidelityLadder)：早期迭代使用较少的
+ *    裂缝离散段数 nf、较低的反演阶数与约 50 个抽样点，步长与误差下降停滞后逐级加密，最后以完整保真度迭代。
+ * 12. [协作取消] 停止拟合与限时拟合 (设置项 fitting/timeBudgetSeconds) 共用一个取消令牌 (cancellationtoken.h)，
+ *    拟合线程与线程池任务在作用域内安装令牌，求解器在每个 Laplace 反演节点检查；期限到达时返回已接受的最佳结果。
+ * 13. [迭代预览] 迭代过程中的界面刷新按预览策略限频 (设置项 fitting/previewIntervalMs，默认 200 ms 即 5 Hz)，
+ *    显示网格上的曲线在线程池中计算，拟合线程不等待；设置项 fitting/previewOnDataGrid 开启时直接复用
+ *    残差计算所得的抽样时间点曲线，不再额外求解。
+ * 14. [批量拟合] startFit 在已有拟合运行时返回 false；提供运行状态查询与等待接口，
+ *    以及产量历史与抽样设置的读取接口，供批量拟合队列 (fittingjobqueue.h) 复制拟合配置。
+ * 15. [参数不确定性] 拟合结束后由最后一次迭代的雅可比矩阵给出线性化标准误差、95% 区间与相关系数矩阵
+ *    (fituncertainty.h)；可选剖面似然区间 (设置项 fitting/uncertaintyProfile) 在线程池中并行重拟合。
+ * 16. [分箱抽样] 抽样方式 (SamplingMode) 可选对数分箱平均或中值 (logbinsampler.h)，
+ *    适用于高频采集的密集压力计数据：箱内平均抑制噪声，且只需线性扫描一次源数据。
+ * 17. [小批量] 可选的小批量前期迭代 (设置项 fitting/miniBatch、fitting/miniBatchSize)：抽样点数不少于
+ *    批大小 2 倍时，每次迭代只在按对数周期分层的随机子集上计算残差与雅可比矩阵，接近收敛后转入完整数据。
+ * 18. [持久缓存] 设置持久化文件后 (setPersistence)，显式时间点上的理论曲线经项目级求值缓存 (fitevaluationcache.h)
+ *    读写，并定期保存拟合断点；重新打开项目后可从未完成拟合的最优参数继续 (resumableCheckpoint)。
+ * 19. [共享数据集] 观测数据以 ObservedDataset 句柄保存；按当前抽样设置的抽样结果作为派生视图缓存在数据集上，
+ *    同一数据与抽样设置只抽样一次 (拟合、初值推荐、界面绘制抽样点与批量任务共用)。
+ * 20. [敏感性研究] 公开产量历史上下文散列 (contextHash)，敏感性研究的曲线缓存以其区分不同的产量历史。
+ * 21. [计算核心] 只依赖不含界面的 ModelEngine、FitParameter 与抽样设置 (modelengine.h、fitparameter.h、fittingsampling.h)，
+ *    可在命令行批处理中使用；界面经 ModelManager::engine() 设置引擎。
+ * 22. [可复现拟合] 可复现模式 (设置项 fitting/reproducible，或分析状态中保存的 FitReproducibility) 下，
+ *    法方程 JᵀJ / Jᵀr 与不确定性分析按固定分块顺序归约 (normalequations.h)，结果与线程数无关；
+ *    拟合时限不生效 (迭代次数不受墙钟影响)。多起点与小批量的随机种子随分析状态保存，旧拟合可逐位重现。
+ *    快速模式使用 Eigen 矩阵乘法，求和顺序可能随机器而变。
+ * 23. [联合拟合] 联合拟合 (jointfitter.h) 为每个数据集持有一个拟合核心，直接使用其残差、雅可比与参数步长计算。
+ * 24. [流动段抽样] 可选按观测导数的流动段划分 (flowregime.h，设置项 fitting/regimeSampling) 生成抽样区间：
+ *    流动段交界处加密、径向流平台稀疏；拟合时导数残差再乘以所在段的噪声权重。
+ * 25. [任务调度] 雅可比各列与求解器内部的时间点经 TaskScheduler 嵌套并行；拟合任务的优先级由 setTaskPriority 给出
+ *    (界面拟合为前台，批量拟合队列为批量)，迭代预览按交互优先级计算。
  */
 
 #ifndef FITTINGCORE_H
@@ -15,39 +57,198 @@
 #include <QVector>
 #include <QMap>
 #include <QFutureWatcher>
-#include "modelmanager.h"
-#include "fittingsamplingdialog.h"
-#include "fittingparameterchart.h" // [修复] 引入 FitParameter 定义
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <QJsonObject>
+#include <Eigen/Dense>
+#include "modelengine.h"
+#include "fittingsampling.h"
+#include "fitparameter.h"
+#include "cancellationtoken.h"
+#include "fituncertainty.h"
+#include "fitevaluationcache.h"
+#include "observeddataset.h"
+#include "flowregime.h"
+#include "taskscheduler.h"
+
+// 保真度阶梯的一级 (最后一级之后总是以完整保真度迭代)
+struct FidelityLevel {
+    int fractureSegments = 0; // 裂缝离散段数 nf 上限 (0 表示不修改；nf 参与拟合时同样不修改)
+    int inversionOrder = 6;   // 反演阶数上限：Stehfest 为 N，其他方法为阶数 M (不超过完整保真度的阶数)
+    int samplePoints = 50;    // 抽样点数上限 (在对数抽样结果中等间隔选取)
+};
+
+// 可复现拟合的设置 (随分析状态保存，见 FittingWidget::getJsonState)
+struct FitReproducibility {
+    bool reproducible = false;          // 固定顺序归约，忽略拟合时限
+    quint32 multiStartSeed = 20260130u; // 多起点全局搜索 (拉丁超立方起点) 的随机种子
+    quint32 miniBatchSeed = 20240521u;  // 小批量分层抽样的随机种子
+
+    // 设置项 fitting/reproducible 决定模式，种子取默认值
+    static FitReproducibility fromGlobalSettings();
+    QJsonObject toJson() const;
+    // 缺少的字段取默认值 (旧项目没有种子记录，默认值即当时固定使用的种子)
+    static FitReproducibility fromJson(const QJsonObject& object);
+};
 
 class FittingCore : public QObject
 {
     Q_OBJECT
 public:
+    // 雅可比矩阵计算方式 (对应设置项 fitting/jacobianMethod)
+    enum JacobianMethod {
+        Jacobian_Analytic = 0,        // 解析敏感度 (前向自动微分)，离散参数自动回退为差分
+        Jacobian_FiniteDifference = 1 // 中心差分：每个参数两次完整曲线计算
+    };
+
+    // 优化迭代方式 (对应设置项 fitting/optimizerMethod)
+    enum OptimizerMethod {
+        Optimizer_Classic = 0,     // 经典 LM：每次迭代计算完整雅可比矩阵，至多 5 次阻尼试探
+        Optimizer_GeodesicLM = 1   // 信赖域 LM：Nielsen 阻尼 + 测地线加速度 + Broyden 雅可比更新
+    };
+
     explicit FittingCore(QObject *parent = nullptr);
 
-    // 设置模型管理器
-    void setModelManager(ModelManager* m);
+    // 设置雅可比矩阵计算方式
+    void setJacobianMethod(JacobianMethod method);
+    JacobianMethod jacobianMethod() const;
+
+    // 设置优化迭代方式
+    void setOptimizerMethod(OptimizerMethod method);
+    OptimizerMethod optimizerMethod() const;
+
+    // 设置是否启用多起点全局搜索，以及起点数 (不含当前初值) 与精修的候选数
+    void setGlobalSearchEnabled(bool enabled);
+    bool isGlobalSearchEnabled() const;
+    void setGlobalSearchStarts(int starts, int polished);
+    int globalSearchStarts() const;
+    int globalSearchPolished() const;
+
+    // 设置是否启用多保真度迭代及保真度阶梯 (由粗到细，为空时不启用)
+    void setMultiFidelityEnabled(bool enabled);
+    bool isMultiFidelityEnabled() const;
+    void setFidelityLadder(const QVector<FidelityLevel>& ladder);
+    QVector<FidelityLevel> fidelityLadder() const;
+
+    // 设置是否启用小批量前期迭代及每批抽样点数 (不少于 10)
+    void setMiniBatch(bool enabled, int batchSize);
+    bool isMiniBatchEnabled() const;
+    int miniBatchSize() const;
+
+    // 默认阶梯 (阶数 6 / 50 点，阶数 8 / 100 点，nf 不变)；设置项格式 "nf,阶数,点数;..." (nf 为 0 表示不变)
+    static QVector<FidelityLevel> defaultFidelityLadder();
+    static QVector<FidelityLevel> parseFidelityLadder(const QString& text);
 
-    // 设置观测数据
+    // 设置拟合时限 (秒)：到期后停止迭代并返回已接受的最佳结果，0 表示不限时 (对应设置项 fitting/timeBudgetSeconds)
+    void setTimeBudget(int seconds);
+    int timeBudget() const;
+
+    // 设置迭代预览的最小间隔 (毫秒，0 表示每个接受步都刷新) 及是否复用抽样时间点上的残差曲线
+    void setPreviewPolicy(int intervalMs, bool reuseDataGrid);
+    int previewInterval() const;
+    bool isPreviewOnDataGrid() const;
+
+    // 设置是否在线性化不确定性之外计算剖面似然区间 (对应设置项 fitting/uncertaintyProfile)
+    void setUncertaintyProfileEnabled(bool enabled);
+    bool isUncertaintyProfileEnabled() const;
+
+    // 设置可复现模式与随机种子 (默认取自设置项 fitting/reproducible)
+    void setReproducibility(const FitReproducibility& reproducibility);
+    FitReproducibility reproducibility() const;
+
+    // 最近一次拟合结束时的参数不确定性 (拟合被用户停止时无效)
+    FitUncertainty lastUncertainty() const;
+
+    // 设置是否在 LM 迭代前按类型曲线库自动推荐初值 (对应设置项 fitting/autoInitialGuess)
+    void setAutoInitialGuessEnabled(bool enabled);
+    bool isAutoInitialGuessEnabled() const;
+
+    // 按当前观测数据 (抽样后) 检索最相似的 k 条类型曲线，换算为有因次参数组；
+    // 仅修改 isFit 为真的参数并截断到 [min, max]，无可用类型曲线库时返回空列表
+    QVector<QMap<QString, double>> suggestInitialGuesses(ModelEngine::ModelType modelType,
+                                                         const QList<FitParameter>& params, int k);
+
+    // 设置项目级求值缓存与拟合断点文件 (路径为空表示不持久化；设置项 fitting/evaluationCache 关闭时不使用缓存)
+    void setPersistence(const QString& cacheFilePath, const QString& checkpointFilePath);
+
+    // 与当前观测数据、抽样设置及拟合参数对应且未正常结束的拟合断点 (无可继续的断点时 valid 为假)
+    FitCheckpoint resumableCheckpoint(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight) const;
+
+    // 设置计算引擎 (ModelManager::engine() 或命令行自行持有的引擎)
+    void setModelEngine(ModelEngine* engine);
+
+    // 设置观测数据 (共享数据集句柄；数组版本创建新的数据集)
+    void setObservedDataset(const ObservedDataset::Handle& dataset);
+    ObservedDataset::Handle observedDataset() const { return m_observed; }
     void setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
 
+    // 设置产量历史 (启用变产量叠加)：降落试井的观测时间与产量历史共用时间原点；
+    // 恢复试井的观测时间为关井时间 Δt，关井时刻取产量历史最后一次变化的时刻
+    void setRateHistory(const RateHistory& history, bool buildup);
+    void clearRateHistory();
+    bool hasRateHistory() const;
+    // 产量历史与试井类型的散列 (未设置产量历史时为 0)，供外部的曲线缓存作为键的一部分
+    quint64 contextHash() const { return m_contextHash; }
+    // 观测数据、抽样设置与产量历史的散列 (区分同一项目中的不同分析；含误差的预览结果以此作为键的一部分)；
+    // 在相应设置改变时计算并保存，读取不再遍历观测数组
+    quint64 observedDataHash() const;
+    const RateHistory& rateHistory() const;
+    bool isRateHistoryBuildup() const;
+
+    // 与观测数据对应的理论曲线：已设置产量历史时为叠加曲线，否则即 ModelEngine 的定产量曲线
+    // t 为空时使用观测时间范围内的对数网格 (未设置产量历史时为求解器默认网格)
+    ModelCurveData calculateModelCurve(ModelEngine::ModelType modelType, const QMap<QString, double>& params,
+                                       const QVector<double>& t = QVector<double>());
+    ModelCurveData calculateModelCurve(ModelEngine::ModelType modelType, const SolverSettings& settings,
+                                       const QMap<QString, double>& params, const QVector<double>& t = QVector<double>());
+    QVector<ModelCurveData> calculateModelCurves(ModelEngine::ModelType modelType, const SolverSettings& settings,
+                                                 const QVector<QMap<QString, double>>& paramSets, const QVector<double>& t);
+
     // 设置抽样策略
     void setSamplingSettings(const QList<SamplingInterval>& intervals, bool enabled);
+    QList<SamplingInterval> samplingIntervals() const;
+    bool isCustomSamplingEnabled() const;
 
-    // 开始拟合
-    void startFit(ModelManager::ModelType modelType, const QList<FitParameter>& params, double weight);
+    // 设置抽样方式 (最近点或对数分箱平均/中值)，对默认策略与自定义区间均生效
+    void setSamplingMode(SamplingMode mode);
+    SamplingMode samplingMode() const;
+
+    // 设置是否按观测导数的流动段划分抽样与导数残差权重 (对应设置项 fitting/regimeSampling)；
+    // 启用自定义区间时抽样仍按自定义区间，权重照常生效
+    void setRegimeSamplingEnabled(bool enabled);
+    bool isRegimeSamplingEnabled() const;
+
+    // 设置拟合任务在任务调度器中的优先级 (缺省为前台；批量拟合队列设为批量，不与界面拟合争抢工作线程)
+    void setTaskPriority(TaskScheduler::Priority priority);
+    TaskScheduler::Priority taskPriority() const;
+
+    // 开始拟合 (已有拟合在运行时不启动并返回 false)
+    bool startFit(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight);
 
     // 停止拟合
     void stopFit();
 
+    // 是否有拟合正在运行；等待当前拟合线程结束 (不处理事件循环)
+    bool isRunning() const;
+    void waitForFinished();
+
+    // 当前观测数据按当前抽样策略的抽样结果 (缓存在数据集上，可在任意线程调用)
+    void getSampledObservedData(QVector<double>& outT, QVector<double>& outP, QVector<double>& outD);
+
     // 辅助函数：根据当前策略获取抽样数据（可供界面绘图使用）
     void getLogSampledData(const QVector<double>& srcT, const QVector<double>& srcP, const QVector<double>& srcD,
                            QVector<double>& outT, QVector<double>& outP, QVector<double>& outD);
 
-    // 计算残差 (公开以便计算最终误差)
-    QVector<double> calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType, double weight,
+    // 计算残差 (公开以便计算最终误差，使用 ModelEngine 当前的默认求解器设置)
+    QVector<double> calculateResiduals(const QMap<QString, double>& params, ModelEngine::ModelType modelType, double weight,
                                        const QVector<double>& t, const QVector<double>& obsP, const QVector<double>& obsD);
 
+    // 计算残差 (使用指定的求解器设置)；curve 非空时同时返回 t 上的理论曲线
+    QVector<double> calculateResiduals(const SolverSettings& settings, const QMap<QString, double>& params,
+                                       ModelEngine::ModelType modelType, double weight,
+                                       const QVector<double>& t, const QVector<double>& obsP, const QVector<double>& obsD,
+                                       ModelCurveData* curve = nullptr);
+
     // 计算误差平方和
     double calculateSumSquaredError(const QVector<double>& residuals);
 
@@ -60,29 +261,164 @@ signals:
     void sigFitFinished();
 
 private:
-    ModelManager* m_modelManager;
-    QVector<double> m_obsTime;
-    QVector<double> m_obsDeltaP;
-    QVector<double> m_obsDerivative;
+    friend class JointFitter; // 按数据集计算残差块与雅可比块
+
+    ModelEngine* m_engine;
+    ObservedDataset::Handle m_observed;
+
+    RateHistory m_rateHistory;   // 产量历史 (为空时按定产量计算)
+    bool m_rateHistoryBuildup;   // 产量历史对应恢复试井
 
     bool m_isCustomSamplingEnabled;
     QList<SamplingInterval> m_customIntervals;
+    SamplingMode m_samplingMode;
+    bool m_regimeSampling;                         // 流动段抽样与权重
+    QVector<FlowRegimeSegment> m_regimeSegments;   // 当前拟合的流动段 (拟合开始时计算，迭代中只读)
+    TaskScheduler::Priority m_taskPriority;        // 拟合线程提交并行任务的优先级
 
-    bool m_stopRequested;
+    CancellationToken m_cancellation; // 停止拟合与拟合时限共用的取消令牌
+    int m_timeBudget;                 // 拟合时限 (秒)，0 表示不限时
+    JacobianMethod m_jacobianMethod;
+    OptimizerMethod m_optimizerMethod;
+    bool m_globalSearch;
+    int m_globalStarts;
+    int m_globalPolished;
+    bool m_multiFidelity;
+    QVector<FidelityLevel> m_fidelityLadder;
+    bool m_miniBatch;
+    int m_miniBatchSize;
+    bool m_autoInitialGuess;
+    SolverSettings m_iterationSettings; // 拟合迭代期的求解器设置 (仅拟合线程读写)
+    int m_previewInterval;              // 迭代预览的最小间隔 (毫秒)
+    bool m_previewOnDataGrid;           // 迭代预览直接使用抽样时间点上的残差曲线
+    QElapsedTimer m_previewClock;       // 上一次迭代预览的时刻 (仅拟合线程读写)
+    QAtomicInteger<int> m_previewBusy;  // 线程池中有未完成的预览计算
+    QFuture<void> m_previewFuture;
+    bool m_uncertaintyProfile;          // 计算剖面似然区间
+    FitReproducibility m_reproducibility; // 可复现模式与随机种子
+    FitUncertainty m_lastUncertainty;   // 拟合线程写入，拟合结束后读取
+    QSharedPointer<FitEvaluationCache> m_evaluationCache; // 项目级求值缓存 (为空时不缓存)
+    QString m_checkpointPath;           // 拟合断点文件 (为空时不保存)
+    FitCheckpoint m_checkpoint;         // 当前拟合的断点 (仅拟合线程读写)
+    QElapsedTimer m_checkpointClock;    // 上一次保存断点的时刻
+    quint64 m_contextHash;              // 产量历史与试井类型的散列 (参与缓存键)
+    quint64 m_fitDataHash;              // 当前拟合的数据散列 (startFit 时计算)
+    quint64 m_observedArraysHash;       // 观测时间、压差与导数数组的散列 (更换数据集时计算)
+    quint64 m_observedHash;             // observedDataHash 的保存值
     QFutureWatcher<void> m_watcher;
 
     // 内部运行的优化任务
-    void runOptimizationTask(ModelManager::ModelType modelType, QList<FitParameter> fitParams, double weight);
+    void runOptimizationTask(ModelEngine::ModelType modelType, QList<FitParameter> fitParams, double weight);
 
     // LM算法实现
-    void runLevenbergMarquardtOptimization(ModelManager::ModelType modelType, QList<FitParameter> params, double weight);
+    void runLevenbergMarquardtOptimization(ModelEngine::ModelType modelType, QList<FitParameter> params, double weight);
+
+    // 单次局部迭代的选项
+    struct LocalSearchOptions {
+        int maxIterations = 50;  // 最大迭代次数 (测地线 LM 的试探步上限为其 3 倍)
+        bool reportSteps = true; // 是否逐步发送进度与迭代曲线 (并行的多个起点各自迭代时关闭)
+        double targetError = 3e-3; // 平均误差 (SSE / 残差数) 低于该值时结束
+        double stallReduction = 0.0; // 接受步的相对下降低于该值且
+        double stallStep = 0.0;      // 步长 (迭代坐标无穷范数) 低于该值时视为停滞并结束 (0 表示不检查)
+    };
+
+    // 迭代预览：限频后发送 sigIterationUpdated；dataCurve 为抽样时间点上的残差曲线 (可为空)，
+    // 不复用时在线程池中按迭代精度计算显示网格上的曲线，上一次预览尚未完成时丢弃本次
+    void publishIterationPreview(ModelEngine::ModelType modelType, double error, const QMap<QString, double>& params,
+                                 const ModelCurveData* dataCurve = nullptr);
+    // 等待线程池中的迭代预览完成 (最后一次刷新前调用，避免过期的预览覆盖最终曲线)
+    void waitForIterationPreview();
+
+    // 抽样设置的数值签名 (参与数据散列与抽样视图的缓存键)
+    QVector<double> samplingSignature() const;
+    // 重新合并 observedDataHash (抽样设置或产量历史改变后调用)
+    void updateObservedHash();
+    // 保存拟合断点并把新增的缓存条目写入文件
+    void saveCheckpoint(const QMap<QString, double>& params, double error, bool finished);
+
+    // 按保真度阶梯由粗到细迭代 (不含完整保真度一级)，结束时 currentParamMap 的 nf/N 等恢复为原值
+    void runFidelityLadder(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                           const QVector<int>& fitIndices, const QVector<double>& t,
+                           const QVector<double>& obsP, const QVector<double>& obsD,
+                           QMap<QString, double>& currentParamMap);
+
+    // 小批量前期迭代：每批在分层随机子集上做一次 LM 迭代，结束时 currentParamMap 为最后一批的结果
+    void runMiniBatchPhase(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                           const QVector<int>& fitIndices, const QVector<double>& t,
+                           const QVector<double>& obsP, const QVector<double>& obsD,
+                           QMap<QString, double>& currentParamMap);
+
+    // 按优化迭代方式调用经典或测地线 LM；finalJacobian 非空时写回最后一次迭代使用的雅可比矩阵 (迭代坐标)
+    void runLocalSearch(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                        const QVector<int>& fitIndices, const QVector<double>& t,
+                        const QVector<double>& obsP, const QVector<double>& obsD,
+                        QMap<QString, double>& currentParamMap, QVector<double>& residuals, double& currentSSE,
+                        const LocalSearchOptions& options,
+                        Eigen::MatrixXd* finalJacobian = nullptr);
+
+    // 多起点全局搜索：粗搜索与精修均并行，最优候选误差更小时写回参数、残差与误差平方和
+    void runGlobalSearch(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                         const QVector<int>& fitIndices, const QVector<double>& t,
+                         const QVector<double>& obsP, const QVector<double>& obsD,
+                         QMap<QString, double>& currentParamMap, QVector<double>& residuals, double& currentSSE);
+
+    // 拟合结束后的不确定性分析：J 与残差不一致时补算一次雅可比矩阵，按设置计算剖面似然区间
+    void estimateUncertainty(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                             const QVector<int>& fitIndices, const QVector<double>& t,
+                             const QVector<double>& obsP, const QVector<double>& obsD,
+                             const QMap<QString, double>& currentParamMap, const QVector<double>& residuals,
+                             Eigen::MatrixXd J);
+
+    // 剖面似然：各参数固定于 ±1σ、±2σ、±3σ 处并行重拟合其余参数 (以最优点热启动)
+    void runProfileLikelihood(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                              const QVector<int>& fitIndices, const QVector<double>& t,
+                              const QVector<double>& obsP, const QVector<double>& obsD,
+                              const QMap<QString, double>& optimum, double optimumSSE, FitUncertainty& u);
+
+    // 在拟合参数的 [min, max] 范围内生成 count 个拉丁超立方起点 (未拟合的参数取 base 中的值)
+    QVector<QMap<QString, double>> latinHypercubeStarts(const QMap<QString, double>& base, const QVector<int>& fitIndices,
+                                                        const QList<FitParameter>& params, int count) const;
+
+    // 经典 LM 迭代：从 currentParamMap/residuals 出发，结束时写回最优参数、残差与误差平方和
+    void runClassicLevenbergMarquardt(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                      const QVector<int>& fitIndices, const QVector<double>& fitT,
+                                      const QVector<double>& fitP, const QVector<double>& fitD,
+                                      QMap<QString, double>& currentParamMap, QVector<double>& residuals, double& currentSSE,
+                                      const LocalSearchOptions& options,
+                                      Eigen::MatrixXd* finalJacobian = nullptr);
+
+    // 信赖域 (测地线加速) LM 迭代：从 currentParamMap/residuals 出发，结束时写回最优参数、残差与误差平方和
+    void runGeodesicLevenbergMarquardt(ModelEngine::ModelType modelType, const QList<FitParameter>& params, double weight,
+                                       const QVector<int>& fitIndices, const QVector<double>& t,
+                                       const QVector<double>& obsP, const QVector<double>& obsD,
+                                       QMap<QString, double>& currentParamMap, QVector<double>& residuals, double& currentSSE,
+                                       const LocalSearchOptions& options,
+                                       Eigen::MatrixXd* finalJacobian = nullptr);
+
+    // 按迭代坐标 (ParameterTransform：有界参数为 logit) 施加步长，更新 LfD 并修正未变换的参数间约束 (kf > km、omega1 > omega2)
+    QMap<QString, double> applyParameterStep(const QMap<QString, double>& base, const QVector<double>& delta,
+                                             const QVector<int>& fitIndices, const QList<FitParameter>& params) const;
+
+    // 两组参数在迭代坐标下的实际步长 (约束修正后可能与请求的步长不同)
+    Eigen::VectorXd parameterStep(const QMap<QString, double>& from, const QMap<QString, double>& to,
+                                  const QVector<int>& fitIndices, const QList<FitParameter>& params) const;
+
+    // 由理论曲线计算残差 (排列：先压力段，后导数段)
+    QVector<double> residualsFromCurve(const ModelCurveData& curve, double weight,
+                                       const QVector<double>& obsP, const QVector<double>& obsD) const;
 
     // 计算雅可比矩阵
     QVector<QVector<double>> computeJacobian(const QMap<QString, double>& params, const QVector<double>& baseResiduals,
-                                             const QVector<int>& fitIndices, ModelManager::ModelType modelType,
+                                             const QVector<int>& fitIndices, ModelEngine::ModelType modelType,
                                              const QList<FitParameter>& currentFitParams, double weight,
                                              const QVector<double>& t, const QVector<double>& obsP, const QVector<double>& obsD);
 
+    // 由解析敏感度构造 ∂r/∂x 的各列：成功的列写入 J 并标记 solved[j]，离散参数等列留给差分计算
+    void fillAnalyticJacobian(QVector<QVector<double>>& J, QVector<bool>& solved,
+                              const QMap<QString, double>& params, const QVector<int>& fitIndices,
+                              ModelEngine::ModelType modelType, const QList<FitParameter>& currentFitParams, double weight,
+                              const QVector<double>& t, const QVector<double>& obsP, const QVector<double>& obsD);
+
     // 求解线性方程组
     QVector<double> solveLinearSystem(const QVector<QVector<double>>& A, const QVector<double>& b);
 };
@@ -6,6 +6,10 @@
  * 2. 实现智能列名识别，自动匹配 Time, Pressure 等列。
  * 3. 实现试井类型切换逻辑：控制初始压力(Pi)和生产时间(tp)的输入。
  * 4. 适配多文件数据源，实现项目文件切换与预览联动。
+ * 5. 产量列映射 (可选)：识别 rate / 产量 列名，默认不使用。
+ * 6. 反褶积选项：仅在选择产量列且为压力降落时可用。
+ * 7. 导数平滑可选择平滑方法 (移动平均 / Savitzky-Golay / 对数时间窗)。
+ * 8. 外部文件读入按列存储的 ColumnarTableModel，与项目数据使用同一种模型。
  */
 
 #include "fittingdatadialog.h"
@@ -20,11 +24,11 @@
 #include <QDir>
 #include <QFileInfo>
 
-FittingDataDialog::FittingDataDialog(const QMap<QString, QStandardItemModel*>& projectModels, QWidget *parent) :
+FittingDataDialog::FittingDataDialog(const QMap<QString, ColumnarTableModel*>& projectModels, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::FittingDataDialog),
     m_projectDataMap(projectModels),
-    m_fileModel(new QStandardItemModel(this))
+    m_fileModel(new ColumnarTableModel(this))
 {
     ui->setupUi(this);
 
@@ -41,6 +45,7 @@ FittingDataDialog::FittingDataDialog(const QMap<QString, QStandardItemModel*>& p
     connect(ui->comboProjectFile, SIGNAL(currentIndexChanged(int)), this, SLOT(onProjectFileSelectionChanged(int)));
     connect(ui->btnBrowse, &QPushButton::clicked, this, &FittingDataDialog::onBrowseFile);
     connect(ui->comboDerivative, SIGNAL(currentIndexChanged(int)), this, SLOT(onDerivColumnChanged(int)));
+    connect(ui->comboRate, SIGNAL(currentIndexChanged(int)), this, SLOT(updateDeconvolutionState()));
 
     // 试井类型切换
     connect(ui->radioDrawdown, &QRadioButton::toggled, this, &FittingDataDialog::onTestTypeChanged);
@@ -95,7 +100,7 @@ void FittingDataDialog::onAccepted()
     accept();
 }
 
-QStandardItemModel* FittingDataDialog::getCurrentProjectModel() const
+ColumnarTableModel* FittingDataDialog::getCurrentProjectModel() const
 {
     QString key = ui->comboProjectFile->currentData().toString();
     if (m_projectDataMap.contains(key)) return m_projectDataMap.value(key);
@@ -108,7 +113,7 @@ void FittingDataDialog::onSourceChanged()
     ui->widgetFileSelect->setVisible(!isProject);
     ui->comboProjectFile->setEnabled(isProject);
 
-    QStandardItemModel* targetModel = isProject ? getCurrentProjectModel() : m_fileModel;
+    ColumnarTableModel* targetModel = isProject ? getCurrentProjectModel() : m_fileModel;
     ui->tablePreview->clear();
 
     if (targetModel) {
@@ -123,8 +128,8 @@ void FittingDataDialog::onSourceChanged()
         ui->tablePreview->setRowCount(rows);
         for (int i = 0; i < rows; ++i) {
             for (int j = 0; j < targetModel->columnCount(); ++j) {
-                QStandardItem* item = targetModel->item(i, j);
-                if (item) ui->tablePreview->setItem(i, j, new QTableWidgetItem(item->text()));
+                const QString text = targetModel->text(i, j);
+                if (!text.isEmpty()) ui->tablePreview->setItem(i, j, new QTableWidgetItem(text));
             }
         }
         updateColumnComboBoxes(headers);
@@ -146,18 +151,22 @@ void FittingDataDialog::updateColumnComboBoxes(const QStringList& headers)
     ui->comboTime->clear();
     ui->comboPressure->clear();
     ui->comboDerivative->clear();
+    ui->comboRate->clear();
 
     ui->comboTime->addItems(headers);
     ui->comboPressure->addItems(headers);
 
     ui->comboDerivative->addItem("自动计算 (Bourdet)", -1);
     for(int i=0; i<headers.size(); ++i) ui->comboDerivative->addItem(headers[i], i);
+    ui->comboRate->addItem("不使用 (定产量)", -1);
+    for(int i=0; i<headers.size(); ++i) ui->comboRate->addItem(headers[i], i);
 
     for (int i = 0; i < headers.size(); ++i) {
         QString h = headers[i].toLower();
         if (h.contains("time") || h.contains("时间") || h.contains("date")) ui->comboTime->setCurrentIndex(i);
         if (h.contains("pressure") || h.contains("压力")) ui->comboPressure->setCurrentIndex(i);
         if (h.contains("deriv") || h.contains("导数")) ui->comboDerivative->setCurrentIndex(i + 1);
+        if (h.contains("rate") || h.contains("产量")) ui->comboRate->setCurrentIndex(i + 1);
     }
 }
 
@@ -174,6 +183,15 @@ void FittingDataDialog::onTestTypeChanged()
     ui->spinTp->setEnabled(!isDrawdown);
     ui->labelTp->setEnabled(!isDrawdown);
     ui->labelUnitTp->setEnabled(!isDrawdown);
+
+    updateDeconvolutionState();
+}
+
+void FittingDataDialog::updateDeconvolutionState()
+{
+    // 反褶积需要产量列，且产量历史与压力共用时间原点 (压力降落)
+    bool hasRate = ui->comboRate->count() > 0 && ui->comboRate->currentData().toInt() >= 0;
+    ui->checkDeconvolution->setEnabled(hasRate && ui->radioDrawdown->isChecked());
 }
 
 void FittingDataDialog::onBrowseFile()
@@ -211,7 +229,8 @@ bool FittingDataDialog::parseTextFile(const QString& filePath)
     QString content = codec->toUnicode(data);
     QTextStream in(&content);
     bool headerSet = false;
-    int colCount = 0;
+
+    m_fileModel->beginLoad();
 
     while (!in.atEnd()) {
         QString line = in.readLine().trimmed();
@@ -231,15 +250,12 @@ bool FittingDataDialog::parseTextFile(const QString& filePath)
 
         if (!headerSet) {
             m_fileModel->setHorizontalHeaderLabels(parts);
-            colCount = parts.size();
             headerSet = true;
         } else {
-            QList<QStandardItem*> items;
-            for (const QString& p : parts) items.append(new QStandardItem(p));
-            while(items.size() < colCount) items.append(new QStandardItem(""));
-            m_fileModel->appendRow(items);
+            m_fileModel->appendRow(parts); // 字段不足时其余列为空
         }
     }
+    m_fileModel->endLoad();
     return true;
 }
 
@@ -272,12 +288,14 @@ bool FittingDataDialog::parseExcelFile(const QString& filePath)
             if (!rowsData.isEmpty()) {
                 QStringList headers;
                 for(const QVariant& v : rowsData.first()) headers << v.toString();
+                m_fileModel->beginLoad(rowsData.size() - 1);
                 m_fileModel->setHorizontalHeaderLabels(headers);
                 for(int i=1; i<rowsData.size(); ++i) {
-                    QList<QStandardItem*> items;
-                    for(const QVariant& v : rowsData[i]) items.append(new QStandardItem(v.toString()));
-                    m_fileModel->appendRow(items);
+                    QStringList fields;
+                    for(const QVariant& v : rowsData[i]) fields.append(v.toString());
+                    m_fileModel->appendRow(fields);
                 }
+                m_fileModel->endLoad();
             }
             delete usedRange;
         }
@@ -289,7 +307,11 @@ bool FittingDataDialog::parseExcelFile(const QString& filePath)
 }
 
 void FittingDataDialog::onDerivColumnChanged(int index) { Q_UNUSED(index); }
-void FittingDataDialog::onSmoothingToggled(bool checked) { ui->spinSmoothSpan->setEnabled(checked); }
+void FittingDataDialog::onSmoothingToggled(bool checked)
+{
+    ui->spinSmoothSpan->setEnabled(checked);
+    ui->comboSmoothMethod->setEnabled(checked);
+}
 
 FittingDataSettings FittingDataDialog::getSettings() const
 {
@@ -300,6 +322,8 @@ FittingDataSettings FittingDataDialog::getSettings() const
     s.timeColIndex = ui->comboTime->currentIndex();
     s.pressureColIndex = ui->comboPressure->currentIndex();
     s.derivColIndex = ui->comboDerivative->currentData().toInt();
+    s.rateColIndex = ui->comboRate->count() > 0 ? ui->comboRate->currentData().toInt() : -1;
+    s.enableDeconvolution = ui->checkDeconvolution->isEnabled() && ui->checkDeconvolution->isChecked();
     s.skipRows = ui->spinSkipRows->value();
 
     if (ui->radioDrawdown->isChecked()) {
@@ -315,10 +339,11 @@ FittingDataSettings FittingDataDialog::getSettings() const
     s.lSpacing = ui->spinLSpacing->value();
     s.enableSmoothing = ui->checkSmoothing->isChecked();
     s.smoothingSpan = ui->spinSmoothSpan->value();
+    s.smoothingMethod = ui->comboSmoothMethod->currentIndex();
     return s;
 }
 
-QStandardItemModel* FittingDataDialog::getPreviewModel() const
+ColumnarTableModel* FittingDataDialog::getPreviewModel() const
 {
     return ui->radioProjectData->isChecked() ? getCurrentProjectModel() : m_fileModel;
 }
@@ -4,6 +4,8 @@
  * 功能描述:
  * 1. 定义数据加载设置结构体 FittingDataSettings。
  * 2. 声明数据加载对话框类，支持文件选择、列映射及试井参数设置。
+ * 3. [变产量叠加] 可选的产量列，选中时拟合按产量历史叠加计算理论曲线。
+ * 4. [反褶积] 可选将变产量记录反褶积为等效定产量响应 (enableDeconvolution)。
  */
 
 #ifndef FITTINGDATADIALOG_H
@@ -11,7 +13,7 @@
 
 #include <QDialog>
 #include <QMap>
-#include <QStandardItemModel>
+#include "columnartablemodel.h"
 
 namespace Ui {
 class FittingDataDialog;
@@ -32,6 +34,8 @@ struct FittingDataSettings {
     int timeColIndex;           // 时间列索引
     int pressureColIndex;       // 压力列索引
     int derivColIndex;          // 导数列索引 (-1表示自动计算)
+    int rateColIndex;           // 产量列索引 (-1表示定产量，不做叠加)
+    bool enableDeconvolution;   // 是否由变产量记录反褶积为等效定产量响应 (需产量列，仅降落试井)
     int skipRows;               // 跳过表头行数
 
     WellTestType testType;      // 试井类型
@@ -41,6 +45,7 @@ struct FittingDataSettings {
     double lSpacing;            // 导数计算步长
     bool enableSmoothing;       // 是否启用平滑
     int smoothingSpan;          // 平滑窗口
+    int smoothingMethod;        // 平滑方法 (DerivativeSmoother::Method)
 };
 
 class FittingDataDialog : public QDialog
@@ -48,14 +53,14 @@ class FittingDataDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit FittingDataDialog(const QMap<QString, QStandardItemModel*>& projectModels, QWidget *parent = nullptr);
+    explicit FittingDataDialog(const QMap<QString, ColumnarTableModel*>& projectModels, QWidget *parent = nullptr);
     ~FittingDataDialog();
 
     // 获取设置结果
     FittingDataSettings getSettings() const;
 
     // 获取预览用的数据模型
-    QStandardItemModel* getPreviewModel() const;
+    ColumnarTableModel* getPreviewModel() const;
 
 private slots:
     void onSourceChanged();
@@ -63,18 +68,19 @@ private slots:
     void onBrowseFile();
     void onAccepted();
     void onDerivColumnChanged(int index);
+    void updateDeconvolutionState();
     void onTestTypeChanged();
     void onSmoothingToggled(bool checked);
 
 private:
     Ui::FittingDataDialog *ui;
-    QMap<QString, QStandardItemModel*> m_projectDataMap;
-    QStandardItemModel* m_fileModel;
+    QMap<QString, ColumnarTableModel*> m_projectDataMap;
+    ColumnarTableModel* m_fileModel;
 
     // 解析辅助函数
     bool parseTextFile(const QString& filePath);
     bool parseExcelFile(const QString& filePath);
-    QStandardItemModel* getCurrentProjectModel() const;
+    ColumnarTableModel* getCurrentProjectModel() const;
     void updateColumnComboBoxes(const QStringList& headers);
 };
 
@@ -0,0 +1,220 @@
+/*
+ * 文件名: fittingjobqueue.cpp
+ * 文件作用: 批量拟合任务队列实现文件
+ * 功能描述:
+ * 1. 每个任务在启动时创建 FittingCore 并复制观测数据、产量历史与抽样设置，结束后释放；
+ *    迭代预览改为直接复用抽样时间点上的残差曲线 (setPreviewPolicy)，批量运行时不为显示额外求解。
+ * 2. 任务的最终误差与参数取自拟合结束前最后一次 sigIterationUpdated (即高精度刷新的结果)。
+ * 3. 各任务的拟合线程占用全局线程池，并发上限限制同时运行的拟合数，避免线程池被占满；
+ *    雅可比列与时间点以批量优先级交给 TaskScheduler，界面上的预览与拟合优先取得工作线程。
+ * 4. 析构时停止全部运行中的任务并等待其线程结束。
+ */
+
+#include "fittingjobqueue.h"
+#include "fittingcore.h"
+
+#include <QSettings>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+
+FittingJobQueue::FittingJobQueue(ModelEngine* engine, QObject* parent)
+    : QObject(parent), m_engine(engine), m_nextId(1)
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    m_maxConcurrent = qBound(1, settings.value("fitting/batchConcurrency", defaultConcurrency()).toInt(),
+                             qMax(1, QThread::idealThreadCount()));
+}
+
+FittingJobQueue::~FittingJobQueue()
+{
+    for (FittingCore* core : m_cores) {
+        core->stopFit();
+        core->waitForFinished();
+    }
+}
+
+int FittingJobQueue::defaultConcurrency()
+{
+    // 单个拟合的雅可比各列已并行，同时运行的拟合数取核数的一半
+    return qMax(1, QThread::idealThreadCount() / 2);
+}
+
+void FittingJobQueue::setMaxConcurrent(int count)
+{
+    m_maxConcurrent = qBound(1, count, qMax(1, QThread::idealThreadCount()));
+    schedule();
+}
+
+int FittingJobQueue::maxConcurrent() const
+{
+    return m_maxConcurrent;
+}
+
+int FittingJobQueue::addJob(const FittingJob& job)
+{
+    FittingJob entry = job;
+    entry.id = m_nextId++;
+    entry.state = FittingJob::Pending;
+    entry.progress = 0;
+    entry.mse = -1.0;
+    entry.result.clear();
+    m_jobs.append(entry);
+    emit sigJobUpdated(entry.id);
+    schedule();
+    return entry.id;
+}
+
+void FittingJobQueue::cancelJob(int id)
+{
+    FittingJob* job = findJob(id);
+    if (!job) return;
+    if (job->state == FittingJob::Pending) {
+        job->state = FittingJob::Cancelled;
+        emit sigJobUpdated(id);
+        if (isIdle()) emit sigAllFinished();
+    } else if (job->state == FittingJob::Running && m_cores.contains(id)) {
+        m_stopRequested[id] = true;
+        m_cores[id]->stopFit();
+    }
+}
+
+void FittingJobQueue::cancelAll()
+{
+    // 先取消排队中的任务，避免停止运行中的任务后又被调度启动
+    for (FittingJob& job : m_jobs) {
+        if (job.state == FittingJob::Pending) {
+            job.state = FittingJob::Cancelled;
+            emit sigJobUpdated(job.id);
+        }
+    }
+    for (auto it = m_cores.constBegin(); it != m_cores.constEnd(); ++it) {
+        m_stopRequested[it.key()] = true;
+        it.value()->stopFit();
+    }
+    if (isIdle()) emit sigAllFinished();
+}
+
+QList<FittingJob> FittingJobQueue::jobs() const
+{
+    return m_jobs;
+}
+
+FittingJob FittingJobQueue::job(int id) const
+{
+    for (const FittingJob& job : m_jobs) {
+        if (job.id == id) return job;
+    }
+    return FittingJob();
+}
+
+QList<FittingJob> FittingJobQueue::rankedResults() const
+{
+    return rankJobs(m_jobs);
+}
+
+QList<FittingJob> FittingJobQueue::rankJobs(const QList<FittingJob>& jobs)
+{
+    QList<FittingJob> ranked;
+    for (const FittingJob& job : jobs) {
+        if (job.state == FittingJob::Finished && job.mse >= 0.0) ranked.append(job);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const FittingJob& a, const FittingJob& b) { return a.mse < b.mse; });
+    return ranked;
+}
+
+int FittingJobQueue::runningCount() const
+{
+    return m_cores.size();
+}
+
+bool FittingJobQueue::isIdle() const
+{
+    for (const FittingJob& job : m_jobs) {
+        if (job.state == FittingJob::Pending || job.state == FittingJob::Running) return false;
+    }
+    return true;
+}
+
+FittingJob* FittingJobQueue::findJob(int id)
+{
+    for (FittingJob& job : m_jobs) {
+        if (job.id == id) return &job;
+    }
+    return nullptr;
+}
+
+void FittingJobQueue::schedule()
+{
+    while (m_cores.size() < m_maxConcurrent) {
+        // 优先级最高、加入最早的排队任务
+        FittingJob* next = nullptr;
+        for (FittingJob& job : m_jobs) {
+            if (job.state != FittingJob::Pending) continue;
+            if (!next || job.priority > next->priority) next = &job;
+        }
+        if (!next) break;
+        startJob(*next);
+    }
+}
+
+void FittingJobQueue::startJob(FittingJob& job)
+{
+    const int id = job.id;
+    job.state = FittingJob::Running;
+    job.progress = 0;
+
+    FittingCore* core = new FittingCore(this);
+    core->setModelEngine(m_engine);
+    core->setObservedDataset(job.observed);
+    if (!job.rateHistory.isEmpty()) core->setRateHistory(job.rateHistory, job.rateHistoryBuildup);
+    core->setSamplingSettings(job.samplingIntervals, job.customSampling);
+    core->setSamplingMode(job.samplingMode);
+    core->setReproducibility(job.reproducibility);
+    core->setPreviewPolicy(core->previewInterval(), true);
+    core->setTaskPriority(TaskScheduler::Batch);
+
+    connect(core, &FittingCore::sigIterationUpdated, this,
+            [this, id](double err, QMap<QString, double> params, QVector<double>, QVector<double>, QVector<double>) {
+                FittingJob* job = findJob(id);
+                if (!job || job->state != FittingJob::Running) return;
+                job->mse = err;
+                job->result = params;
+                emit sigJobUpdated(id);
+            }, Qt::QueuedConnection);
+    connect(core, &FittingCore::sigProgress, this, [this, id](int percent) {
+        FittingJob* job = findJob(id);
+        if (!job || job->state != FittingJob::Running) return;
+        job->progress = percent;
+        emit sigJobUpdated(id);
+    }, Qt::QueuedConnection);
+    connect(core, &FittingCore::sigFitFinished, this, [this, id]() { onJobFinished(id); }, Qt::QueuedConnection);
+
+    m_cores.insert(id, core);
+    emit sigJobUpdated(id);
+    if (!core->startFit(job.modelType, job.params, job.weight)) onJobFinished(id);
+}
+
+void FittingJobQueue::onJobFinished(int id)
+{
+    // 无拟合参数时 FittingCore 会额外发出一次结束信号，重复的通知直接忽略
+    FittingJob* job = findJob(id);
+    if (!job || job->state != FittingJob::Running) return;
+    FittingCore* core = m_cores.take(id);
+    if (core && core->isRunning()) {
+        m_cores.insert(id, core);
+        return;
+    }
+
+    const bool stopped = m_stopRequested.take(id);
+    job->state = stopped ? FittingJob::Cancelled : FittingJob::Finished;
+    if (job->state == FittingJob::Finished) job->progress = 100;
+    qDebug() << "批量拟合: 任务" << id << job->analysisName << ModelEngine::getModelTypeName(job->modelType)
+             << (stopped ? "已停止" : "完成") << "，MSE =" << job->mse;
+    if (core) core->deleteLater();
+    emit sigJobUpdated(id);
+
+    schedule();
+    if (isIdle()) emit sigAllFinished();
+}
@@ -0,0 +1,114 @@
+/*
+ * 文件名: fittingjobqueue.h
+ * 文件作用: 批量拟合任务队列头文件
+ * 功能描述:
+ * 1. 定义批量拟合任务 FittingJob：一次拟合所需的全部输入 (模型、参数、权重、观测数据、产量历史与抽样设置)
+ *    在加入队列时复制 (观测数据为共享的只读数据集句柄)，运行期间不再读取界面；同时记录任务状态、进度与最终误差 (MSE) 及参数。
+ * 2. FittingJobQueue 为每个运行中的任务创建独立的 FittingCore，按优先级 (数值大者先运行，相同时按加入顺序)
+ *    调度，同时运行的任务数不超过并发上限 (设置项 fitting/batchConcurrency，默认为 CPU 核数的一半，且不超过核数)。
+ * 3. 可取消单个任务或全部任务：排队中的任务直接取消，运行中的任务经 FittingCore::stopFit 协作停止。
+ * 4. 已完成的任务按最终 MSE 升序排名，用于同一口井多个候选模型 (Model_1…Model_6) 的筛选比较。
+ * 5. [计算核心] 只依赖不含界面的 ModelEngine，界面与命令行批处理 (cli/) 共用同一队列。
+ */
+
+#ifndef FITTINGJOBQUEUE_H
+#define FITTINGJOBQUEUE_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QVector>
+#include <QString>
+#include "modelengine.h"
+#include "fitparameter.h"
+#include "fittingsampling.h"
+#include "superposition.h"
+#include "observeddataset.h"
+#include "fittingcore.h"
+
+class FittingCore;
+
+// 批量拟合任务
+struct FittingJob {
+    enum State {
+        Pending = 0,  // 排队中
+        Running = 1,  // 运行中
+        Finished = 2, // 已完成
+        Cancelled = 3 // 已取消 (运行中被停止时保留停止前的最优结果)
+    };
+
+    int id = -1;                       // 任务编号 (由队列分配)
+    QString analysisName;              // 来源分析页签名称
+    ModelEngine::ModelType modelType = ModelEngine::Model_1;
+    QList<FitParameter> params;        // 初值与拟合勾选
+    double weight = 0.5;               // 压差权重 (导数权重为 1 - weight)
+    int priority = 0;                  // 优先级，数值大者先运行
+
+    ObservedDataset::Handle observed;  // 与来源页签共享，抽样结果同样缓存在数据集上
+    RateHistory rateHistory;           // 为空时按定产量计算
+    bool rateHistoryBuildup = false;
+    QList<SamplingInterval> samplingIntervals;
+    bool customSampling = false;
+    SamplingMode samplingMode = Sampling_NearestPoint;
+    FitReproducibility reproducibility; // 来源分析的可复现模式与随机种子
+
+    State state = Pending;
+    int progress = 0;                  // 进度百分比
+    double mse = -1.0;                 // 最终误差 (MSE)，尚无结果时为负
+    QMap<QString, double> result;      // 最终参数
+};
+
+class FittingJobQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FittingJobQueue(ModelEngine* engine, QObject* parent = nullptr);
+    ~FittingJobQueue();
+
+    // 加入任务并立即尝试调度，返回分配的任务编号
+    int addJob(const FittingJob& job);
+    // 下一次 addJob 将分配的编号 (调用方需在 addJob 发出首个通知之前登记任务时使用)
+    int nextJobId() const { return m_nextId; }
+
+    // 取消任务 (排队中的直接取消，运行中的请求停止)
+    void cancelJob(int id);
+    void cancelAll();
+
+    // 并发上限 (1 ~ CPU 核数)；调高时立即启动排队中的任务
+    void setMaxConcurrent(int count);
+    int maxConcurrent() const;
+    static int defaultConcurrency();
+
+    // 任务快照 (按加入顺序)；id 不存在时返回 id 为 -1 的空任务
+    QList<FittingJob> jobs() const;
+    FittingJob job(int id) const;
+
+    // 已完成的任务按 MSE 升序排列
+    QList<FittingJob> rankedResults() const;
+    // 任意任务列表中已完成的任务按 MSE 升序排列 (分布式协调进程共用同一排名规则)
+    static QList<FittingJob> rankJobs(const QList<FittingJob>& jobs);
+
+    int runningCount() const;
+    bool isIdle() const;
+
+signals:
+    // 任务状态、进度或结果变化
+    void sigJobUpdated(int id);
+    // 队列中已没有排队或运行中的任务
+    void sigAllFinished();
+
+private:
+    ModelEngine* m_engine;
+    QList<FittingJob> m_jobs;
+    QMap<int, FittingCore*> m_cores;  // 运行中任务的拟合核心
+    QMap<int, bool> m_stopRequested;  // 运行中被请求停止的任务
+    int m_nextId;
+    int m_maxConcurrent;
+
+    FittingJob* findJob(int id);
+    void schedule();
+    void startJob(FittingJob& job);
+    void onJobFinished(int id);
+};
+
+#endif // FITTINGJOBQUEUE_H
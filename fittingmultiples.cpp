@@ -9,16 +9,22 @@
  * - 根据 m_selections 中的配置，按需绘制实测压差、实测导数、理论压差、理论导数。
  * - 修复 rescaleAxes 逻辑，确保包含实测数据的显示范围。
  * 4. 绘制多条曲线，使用颜色区分不同分析。
+ * 5. [性能优化] 模型类型与时间序列相同的分析合并为一次批量计算理论曲线 (calculateTheoreticalCurvesBatch)。
+ * 6. [共享数据集] 实测数据经 ObservedDataset::fromJson 读取，与来源分析共享数组。
+ * 7. [曲线缓存] 理论曲线按 (模型类型, 求解器设置, 参数, 时间网格) 在 TheoryCurveCache 中查找：参数未变的分析立即重绘，
+ *    未命中的分析仍按模型类型与时间序列合并批量计算，但放到后台线程，完成并写入缓存后再整体重绘一次。
  */
 
 #include "fittingmultiples.h"
 #include "ui_fittingmultiples.h"
 #include "fittingparameterchart.h"
+#include "observeddataset.h"
 #include <QVBoxLayout>
 #include <QHeaderView>
 #include <QDebug>
 #include <cmath>
 #include <QJsonArray> // 需要引入数组解析
+#include <QtConcurrent>
 
 FittingMultiplesWidget::FittingMultiplesWidget(QWidget *parent) :
     QWidget(parent),
@@ -30,7 +36,8 @@ FittingMultiplesWidget::FittingMultiplesWidget(QWidget *parent) :
     m_infoTabWidget(nullptr),
     m_tableModelInfo(nullptr),
     m_tableParams(nullptr),
-    m_tableWeights(nullptr)
+    m_tableWeights(nullptr),
+    m_curveCache(QSharedPointer<TheoryCurveCache>::create())
 {
     ui->setupUi(this);
 
@@ -54,6 +61,8 @@ FittingMultiplesWidget::FittingMultiplesWidget(QWidget *parent) :
 
 FittingMultiplesWidget::~FittingMultiplesWidget()
 {
+    // 后台任务结束后投递的重绘随对象一起丢弃
+    for (QFuture<void>& future : m_futures) future.waitForFinished();
     if(m_infoDialog) delete m_infoDialog;
     delete ui;
 }
@@ -63,6 +72,11 @@ void FittingMultiplesWidget::setModelManager(ModelManager *m)
     m_modelManager = m;
 }
 
+void FittingMultiplesWidget::setCurveCache(const QSharedPointer<TheoryCurveCache>& cache)
+{
+    if (cache) m_curveCache = cache;
+}
+
 void FittingMultiplesWidget::setupPlot()
 {
     if (!m_plot) return;
@@ -164,45 +178,127 @@ void FittingMultiplesWidget::updateCharts()
 
     m_plot->clearGraphs();
 
-    int idx = 0;
+    // 单个分析的绘图数据：先统一解析，理论曲线按 (模型类型, 时间序列) 分批计算后再依次绘制
+    struct AnalysisPlot {
+        QString name;
+        CurveSelection sel;
+        QVector<double> obsT, obsP, obsD;
+        bool needTheory = false;
+        ModelManager::ModelType type = ModelManager::Model_1;
+        QMap<QString, double> paramMap;
+        QVector<double> tCalc;
+        QByteArray key;
+        bool hasTheory = false;
+        ModelCurveData curves;
+    };
+    QVector<AnalysisPlot> plots;
+
     for(auto it = m_states.begin(); it != m_states.end(); ++it) {
-        QString name = it.key();
+        AnalysisPlot item;
+        item.name = it.key();
         QJsonObject state = it.value();
-        QColor color = getColor(idx);
 
         // 获取该分析的显示选项，默认为全显示
-        CurveSelection sel;
-        if (m_selections.contains(name)) {
-            sel = m_selections[name];
+        if (m_selections.contains(item.name)) {
+            item.sel = m_selections[item.name];
         }
 
-        // ==========================================
-        // 1. 绘制实测数据 (如果勾选)
-        // ==========================================
-        QVector<double> obsT, obsP, obsD;
+        // 解析实测数据
         if (state.contains("observedData")) {
-            QJsonObject obsObj = state["observedData"].toObject();
-            QJsonArray tArr = obsObj["time"].toArray();
-            QJsonArray pArr = obsObj["pressure"].toArray();
-            QJsonArray dArr = obsObj["derivative"].toArray();
-
-            for(auto v : tArr) obsT.append(v.toDouble());
-            for(auto v : pArr) obsP.append(v.toDouble());
-            for(auto v : dArr) obsD.append(v.toDouble());
+            // 与来源分析页签共享同一数据集 (内容相同时不再另建数组)
+            const ObservedDataset::Handle observed = ObservedDataset::fromJson(state["observedData"].toObject());
+            item.obsT = observed->time();
+            item.obsP = observed->deltaP();
+            item.obsD = observed->derivative();
+        }
+
+        // 解析模型参数
+        item.needTheory = item.sel.showTheoP || item.sel.showTheoD;
+        if (item.needTheory) {
+            int typeInt = state["modelType"].toInt();
+            item.type = (ModelManager::ModelType)typeInt;
+            QJsonArray pArr = state["parameters"].toArray();
+            for(auto v : pArr) {
+                QJsonObject pObj = v.toObject();
+                item.paramMap.insert(pObj["name"].toString(), pObj["value"].toDouble());
+            }
+            if(item.paramMap.contains("L") && item.paramMap.contains("Lf") && item.paramMap["L"] > 1e-9)
+                item.paramMap["LfD"] = item.paramMap["Lf"] / item.paramMap["L"];
+            else
+                item.paramMap["LfD"] = 0.0;
+
+            // 确定计算时间序列 (优先用实测时间，否则生成默认)
+            item.tCalc = item.obsT;
+            if (item.tCalc.isEmpty()) {
+                for(double e = -4; e <= 4; e += 0.1) item.tCalc.append(pow(10, e));
+            }
         }
+        plots.append(item);
+    }
+
+    // 理论曲线：先查缓存；未命中的分析按 (模型类型, 时间序列) 合并为批量计算，在后台进行，完成后重绘
+    const SolverSettings settings = m_modelManager->solverSettings();
+    struct Batch {
+        ModelManager::ModelType type;
+        QVector<double> t;
+        QVector<QMap<QString, double>> paramSets;
+        QVector<QByteArray> keys;
+    };
+    QVector<Batch> batches;
+    for(int i = 0; i < plots.size(); ++i) {
+        AnalysisPlot& item = plots[i];
+        if (!item.needTheory) continue;
+        item.key = TheoryCurveCache::makeKey(item.type, settings, item.paramMap, item.tCalc);
+        item.hasTheory = m_curveCache->lookup(item.key, item.curves);
+        if (item.hasTheory || m_pendingKeys.contains(item.key)) continue;
+
+        m_pendingKeys.insert(item.key);
+        int b = 0;
+        while (b < batches.size() && (batches[b].type != item.type || batches[b].t != item.tCalc)) ++b;
+        if (b == batches.size()) batches.append(Batch{item.type, item.tCalc, {}, {}});
+        batches[b].paramSets.append(item.paramMap);
+        batches[b].keys.append(item.key);
+    }
+    if (!batches.isEmpty()) {
+        ModelManager* manager = m_modelManager;
+        QSharedPointer<TheoryCurveCache> cache = m_curveCache;
+        for (int i = m_futures.size() - 1; i >= 0; --i)
+            if (m_futures[i].isFinished()) m_futures.removeAt(i);
+        m_futures.append(QtConcurrent::run([this, manager, cache, settings, batches]() {
+            for (const Batch& batch : batches) {
+                const QVector<ModelCurveData> curves = manager->calculateTheoreticalCurvesBatch(batch.type, settings, batch.paramSets, batch.t);
+                for (int k = 0; k < batch.keys.size() && k < curves.size(); ++k) cache->insert(batch.keys[k], curves[k]);
+            }
+            QVector<QByteArray> keys;
+            for (const Batch& batch : batches) keys += batch.keys;
+            QMetaObject::invokeMethod(this, [this, keys]() {
+                for (const QByteArray& key : keys) m_pendingKeys.remove(key);
+                updateCharts();
+            }, Qt::QueuedConnection);
+        }));
+    }
+
+    for(int idx = 0; idx < plots.size(); ++idx) {
+        const AnalysisPlot& item = plots[idx];
+        const QString& name = item.name;
+        const CurveSelection& sel = item.sel;
+        QColor color = getColor(idx);
 
-        if (sel.showObsP && !obsT.isEmpty() && !obsP.isEmpty()) {
+        // ==========================================
+        // 1. 绘制实测数据 (如果勾选)
+        // ==========================================
+        if (sel.showObsP && !item.obsT.isEmpty() && !item.obsP.isEmpty()) {
             QCPGraph* gObsP = m_plot->addGraph();
-            gObsP->setData(obsT, obsP);
+            gObsP->setData(item.obsT, item.obsP);
             // 实测压差：空心圆，无连线
             gObsP->setLineStyle(QCPGraph::lsNone);
             gObsP->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, color, Qt::white, 6));
             gObsP->setName(name + " (实测 P)");
         }
 
-        if (sel.showObsD && !obsT.isEmpty() && !obsD.isEmpty()) {
+        if (sel.showObsD && !item.obsT.isEmpty() && !item.obsD.isEmpty()) {
             QCPGraph* gObsD = m_plot->addGraph();
-            gObsD->setData(obsT, obsD);
+            gObsD->setData(item.obsT, item.obsD);
             // 实测导数：空心三角形，无连线
             gObsD->setLineStyle(QCPGraph::lsNone);
             gObsD->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, color, Qt::white, 6));
@@ -212,31 +308,10 @@ void FittingMultiplesWidget::updateCharts()
         // ==========================================
         // 2. 绘制理论曲线 (如果勾选)
         // ==========================================
-        if (sel.showTheoP || sel.showTheoD) {
-            // 解析模型参数
-            int typeInt = state["modelType"].toInt();
-            ModelManager::ModelType type = (ModelManager::ModelType)typeInt;
-            QMap<QString, double> paramMap;
-            QJsonArray pArr = state["parameters"].toArray();
-            for(auto v : pArr) {
-                QJsonObject pObj = v.toObject();
-                paramMap.insert(pObj["name"].toString(), pObj["value"].toDouble());
-            }
-            if(paramMap.contains("L") && paramMap.contains("Lf") && paramMap["L"] > 1e-9)
-                paramMap["LfD"] = paramMap["Lf"] / paramMap["L"];
-            else
-                paramMap["LfD"] = 0.0;
-
-            // 确定计算时间序列 (优先用实测时间，否则生成默认)
-            QVector<double> tCalc = obsT;
-            if (tCalc.isEmpty()) {
-                for(double e = -4; e <= 4; e += 0.1) tCalc.append(pow(10, e));
-            }
-
-            ModelCurveData curves = m_modelManager->calculateTheoreticalCurve(type, paramMap, tCalc);
-            QVector<double> vt = std::get<0>(curves);
-            QVector<double> vp = std::get<1>(curves);
-            QVector<double> vd = std::get<2>(curves);
+        if (item.hasTheory) {
+            const QVector<double>& vt = std::get<0>(item.curves);
+            const QVector<double>& vp = std::get<1>(item.curves);
+            const QVector<double>& vd = std::get<2>(item.curves);
 
             if (sel.showTheoP) {
                 QCPGraph* gP = m_plot->addGraph();
@@ -252,8 +327,6 @@ void FittingMultiplesWidget::updateCharts()
                 gD->setName(name + " (理论 P')");
             }
         }
-
-        idx++;
     }
 
     // [修改] 自动缩放：考虑所有可见图表
@@ -6,6 +6,7 @@
  * 2. 包含一个全屏的 ChartWidget 用于绘制多条曲线。
  * 3. 声明管理统一的悬浮信息窗口 (包含模型、参数、权重三个标签页) 的逻辑。
  * 4. 声明初始化函数，接收多个分析的 JSON 状态数据及曲线选择配置。
+ * 5. [曲线缓存] 理论曲线经 TheoryCurveCache 取得 (由拟合页面共用)，未命中的分析在后台计算，完成后重绘。
  */
 
 #ifndef FITTINGMULTIPLES_H
@@ -18,10 +19,14 @@
 #include <QDialog>
 #include <QTableWidget>
 #include <QTabWidget>
+#include <QFuture>
+#include <QSet>
+#include <QSharedPointer>
 #include "chartwidget.h"
 #include "modelmanager.h"
 #include "mousezoom.h"
 #include "fittingnewdialog.h" // 引入 CurveSelection 结构体定义
+#include "theorycurvecache.h"
 
 namespace Ui {
 class FittingMultiplesWidget;
@@ -37,6 +42,8 @@ public:
 
     // 设置模型管理器 (用于计算理论曲线)
     void setModelManager(ModelManager* m);
+    // 设置理论曲线缓存 (拟合页面的各对比页签共用同一个缓存)
+    void setCurveCache(const QSharedPointer<TheoryCurveCache>& cache);
 
     // 初始化：传入多个分析的状态数据 (Name -> JsonObject) 以及 曲线选择配置 (Name -> Selection)
     // 如果 selections 为空，则默认显示所有曲线
@@ -74,6 +81,11 @@ private:
     QTableWidget* m_tableParams;
     QTableWidget* m_tableWeights;
 
+    // 理论曲线缓存与后台计算 (m_pendingKeys 为已派发、尚未完成的缓存键，只在界面线程访问)
+    QSharedPointer<TheoryCurveCache> m_curveCache;
+    QSet<QByteArray> m_pendingKeys;
+    QList<QFuture<void>> m_futures;
+
     // 初始化绘图组件
     void setupPlot();
 
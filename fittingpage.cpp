@@ -6,6 +6,16 @@
  * 2. 支持创建 FittingWidget (单分析) 和 FittingMultiplesWidget (多分析对比) 两种类型的页签。
  * 3. [修改] 构造函数中设置背景色为白色。
  * 4. [修改] 新建多分析页签时，传递从 Dialog 获取的曲线选择信息。
+ * 5. [批量拟合] 批量拟合对话框为模态：任务在加入队列时复制页签数据，运行期间页签不会被删除。
+ * 6. [共享数据集] 保存时各分析 (含多分析页签的子分析) 的观测数据按数据集 id 提到顶层 datasets 中，
+ *    相同的数据只写一份，分析中只保留 observedDataId；读取时先把引用还原为 observedData (兼容 2.1 及以前的内嵌格式)。
+ * 7. [后台导出] 单分析页签导出的曲线数据文件经 viewExportedFile 转发给主窗口，在数据界面打开。
+ * 8. [曲线缓存] 新建的多分析对比页签共用同一个理论曲线缓存。
+ * 9. [后台报告] 批量报告：界面线程依次取各单分析页签的报告数据与离屏图表图像，
+ *    之后的图像编码与报告写出全部交给 FittingReportGenerator 在后台线程池并行完成。
+ * 10. [性能设置] 理论曲线缓存上限随性能设置即时调整；缓存键不含 "缺省 nf" 等全局默认值，默认值改变时清空缓存。
+ * 11. [联合拟合] 联合拟合对话框同为模态：各页签按当前模型生成数据集 (与批量拟合的任务相同)，结果逐个写回页签。
+ * 12. [实时监测] 监测对话框为非模态 (监测期间仍可操作各页签)，只以 QPointer 引用目标页签，页签被删除后停止滚动拟合。
  */
 
 #include "fittingpage.h"
@@ -13,16 +23,44 @@
 #include "wt_fittingwidget.h"
 #include "fittingnewdialog.h"
 #include "modelparameter.h"
+#include "fittingbatchdialog.h"
+#include "jointfitdialog.h"
+#include "gaugemonitordialog.h"
 #include <QInputDialog>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QDir>
+#include <QRegularExpression>
 #include <QMessageBox>
 #include <QJsonArray>
 #include <QDebug>
+#include "observeddataset.h"
 
 // 构造函数
+// 把单个分析状态中的观测数据移到 datasets (按 observedDataId)
+static QJsonObject hoistObservedData(QJsonObject state, QJsonObject& datasets)
+{
+    const QString id = state.value("observedDataId").toString();
+    if (id.isEmpty() || !state.contains("observedData")) return state;
+    if (!datasets.contains(id)) datasets.insert(id, state.value("observedData"));
+    state.remove("observedData");
+    return state;
+}
+
+// hoistObservedData 的逆操作
+static QJsonObject resolveObservedData(QJsonObject state, const QJsonObject& datasets)
+{
+    const QString id = state.value("observedDataId").toString();
+    if (!id.isEmpty() && !state.contains("observedData") && datasets.contains(id))
+        state.insert("observedData", datasets.value(id));
+    return state;
+}
+
 FittingPage::FittingPage(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::FittingPage),
-    m_modelManager(nullptr)
+    m_modelManager(nullptr),
+    m_curveCache(QSharedPointer<TheoryCurveCache>::create())
 {
     ui->setupUi(this);
 
@@ -49,7 +87,7 @@ void FittingPage::setModelManager(ModelManager *m)
     }
 }
 
-void FittingPage::setProjectDataModels(const QMap<QString, QStandardItemModel*> &models)
+void FittingPage::setProjectDataModels(const QMap<QString, ColumnarTableModel*> &models)
 {
     m_dataMap = models;
     for(int i = 0; i < ui->tabWidget->count(); ++i) {
@@ -65,14 +103,11 @@ void FittingPage::setObservedDataToCurrent(const QVector<double> &t, const QVect
     QWidget* current = ui->tabWidget->currentWidget();
     FittingWidget* fw = qobject_cast<FittingWidget*>(current);
 
-    if (fw) {
-        fw->setObservedData(t, p, d);
-    } else {
-        if(!fw) {
-            fw = createNewTab(generateUniqueName("Analysis"));
-            fw->setObservedData(t, p, d);
-        }
-    }
+    // 页签与模型管理器共享同一个数据集
+    const ObservedDataset::Handle dataset = ObservedDataset::create(t, p, d);
+    if (m_modelManager) m_modelManager->setObservedDataset(dataset);
+    if (!fw) fw = createNewTab(generateUniqueName("Analysis"));
+    fw->setObservedDataset(dataset);
 }
 
 void FittingPage::updateBasicParameters()
@@ -88,8 +123,10 @@ FittingWidget* FittingPage::createNewTab(const QString &name, const QJsonObject
 {
     FittingWidget* w = new FittingWidget(this);
     if(m_modelManager) w->setModelManager(m_modelManager);
+    w->setCurveCache(m_curveCache);
     w->setProjectDataModels(m_dataMap);
     connect(w, &FittingWidget::sigRequestSave, this, &FittingPage::onChildRequestSave);
+    connect(w, &FittingWidget::viewExportedFile, this, &FittingPage::viewExportedFile);
 
     int index = ui->tabWidget->addTab(w, name);
     ui->tabWidget->setCurrentIndex(index);
@@ -232,20 +269,171 @@ void FittingPage::on_btnDeleteAnalysis_clicked()
     }
 }
 
+FittingWidget* FittingPage::findFittingWidget(const QString& name) const
+{
+    for(int i = 0; i < ui->tabWidget->count(); ++i) {
+        if(ui->tabWidget->tabText(i) == name) return qobject_cast<FittingWidget*>(ui->tabWidget->widget(i));
+    }
+    return nullptr;
+}
+
+void FittingPage::on_btnBatchFit_clicked()
+{
+    if(!m_modelManager) return;
+
+    // 仅单分析页签可参与批量拟合
+    QStringList analyses;
+    for(int i = 0; i < ui->tabWidget->count(); ++i) {
+        if(qobject_cast<FittingWidget*>(ui->tabWidget->widget(i))) analyses << ui->tabWidget->tabText(i);
+    }
+    if(analyses.isEmpty()) {
+        QMessageBox::warning(this, "提示", "没有可用于批量拟合的单分析页签。");
+        return;
+    }
+
+    QString currentName;
+    ModelManager::ModelType currentModel = ModelManager::Model_1;
+    if(auto fw = qobject_cast<FittingWidget*>(ui->tabWidget->currentWidget())) {
+        currentName = ui->tabWidget->tabText(ui->tabWidget->currentIndex());
+        currentModel = fw->currentModelType();
+    }
+
+    FittingBatchDialog dlg(m_modelManager, analyses, currentName, currentModel,
+        [this](const QString& analysis, ModelManager::ModelType type, FittingJob& job) {
+            FittingWidget* fw = findFittingWidget(analysis);
+            return fw && fw->createFittingJob(type, job);
+        },
+        [this](const FittingJob& job) {
+            if(FittingWidget* fw = findFittingWidget(job.analysisName)) fw->applyFittingResult(job);
+        }, this);
+    dlg.exec();
+}
+
+void FittingPage::on_btnJointFit_clicked()
+{
+    if(!m_modelManager) return;
+
+    QStringList analyses;
+    for(int i = 0; i < ui->tabWidget->count(); ++i) {
+        if(qobject_cast<FittingWidget*>(ui->tabWidget->widget(i))) analyses << ui->tabWidget->tabText(i);
+    }
+    if(analyses.size() < 2) {
+        QMessageBox::warning(this, "提示", "联合拟合至少需要两个单分析页签。");
+        return;
+    }
+
+    QString currentName;
+    if(qobject_cast<FittingWidget*>(ui->tabWidget->currentWidget()))
+        currentName = ui->tabWidget->tabText(ui->tabWidget->currentIndex());
+
+    JointFitDialog dlg(m_modelManager, analyses, currentName,
+        [this](const QString& analysis, FittingJob& job) {
+            FittingWidget* fw = findFittingWidget(analysis);
+            return fw && fw->createFittingJob(fw->currentModelType(), job);
+        },
+        [this](const FittingJob& job) {
+            if(FittingWidget* fw = findFittingWidget(job.analysisName)) fw->applyFittingResult(job);
+        }, this);
+    dlg.exec();
+}
+
+void FittingPage::on_btnMonitor_clicked()
+{
+    FittingWidget* fw = qobject_cast<FittingWidget*>(ui->tabWidget->currentWidget());
+    if(!fw) {
+        QMessageBox::warning(this, "提示", "请先切换到要滚动拟合的单分析页签。");
+        return;
+    }
+
+    GaugeMonitorDialog* dlg = new GaugeMonitorDialog(m_modelManager, fw, ui->tabWidget->tabText(ui->tabWidget->currentIndex()), this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    dlg->show();
+}
+
+void FittingPage::on_btnBatchReport_clicked()
+{
+    QList<int> tabs;
+    for(int i = 0; i < ui->tabWidget->count(); ++i) {
+        if(qobject_cast<FittingWidget*>(ui->tabWidget->widget(i))) tabs << i;
+    }
+    if(tabs.isEmpty()) {
+        QMessageBox::warning(this, "提示", "没有可生成报告的单分析页签。");
+        return;
+    }
+
+    QString defaultDir = QFileInfo(ModelParameter::instance()->getProjectFilePath()).absolutePath();
+    if(defaultDir.isEmpty() || defaultDir == ".") defaultDir = ModelParameter::instance()->getProjectPath();
+    QString dir = QFileDialog::getExistingDirectory(this, "选择报告保存目录", defaultDir);
+    if(dir.isEmpty()) return;
+
+    // 报告文件名：井名_页签名试井解释报告.doc (页签名中不能用于文件名的字符替换为下划线)
+    const QString wellName = FittingWidget::reportWellName();
+    QVector<FittingReportJob> jobs;
+    QStringList existing;
+    for(int i : tabs) {
+        QString tabName = ui->tabWidget->tabText(i);
+        tabName.replace(QRegularExpression("[\\\\/:*?\"<>|]"), "_");
+        FittingReportJob job;
+        job.filePath = QDir(dir).filePath(QString("%1_%2试井解释报告.doc").arg(wellName, tabName));
+        if(QFileInfo::exists(job.filePath)) existing << QFileInfo(job.filePath).fileName();
+        jobs.append(job);
+    }
+    if(!existing.isEmpty()) {
+        const QString list = existing.mid(0, 5).join("\n") + (existing.size() > 5 ? "\n..." : "");
+        if(QMessageBox::question(this, "批量报告", QString("以下 %1 个文件已存在，是否覆盖？\n\n%2").arg(existing.size()).arg(list))
+                != QMessageBox::Yes) return;
+    }
+
+    // 只有取数与离屏绘制在界面线程进行
+    for(int k = 0; k < tabs.size(); ++k) {
+        jobs[k].data = qobject_cast<FittingWidget*>(ui->tabWidget->widget(tabs[k]))->createReportData();
+    }
+
+    QStringList errors;
+    const DataExportService::Result result = FittingReportGenerator::generateWithProgress(this, jobs, &errors);
+    if(result == DataExportService::Cancelled) return;
+    if(result == DataExportService::Succeeded) {
+        QMessageBox::information(this, "成功", QString("已生成 %1 份报告。\n\n保存目录: %2").arg(jobs.size()).arg(dir));
+    } else {
+        QMessageBox::critical(this, "错误", QString("%1 份报告生成失败:\n").arg(errors.size()) + errors.join("\n"));
+    }
+}
+
 void FittingPage::saveAllFittingStates()
+{
+    ModelParameter::instance()->saveFittingResult(collectFittingStates());
+}
+
+void FittingPage::applyPerformanceSettings(bool solverDefaultsChanged)
+{
+    m_curveCache->setCapacity(TheoryCurveCache::capacityFromSettings());
+    if (solverDefaultsChanged) m_curveCache->clear();
+}
+
+QJsonObject FittingPage::collectFittingStates()
 {
     QJsonArray analysesArray;
+    QJsonObject datasets;
     for(int i=0; i<ui->tabWidget->count(); ++i) {
         QJsonObject pageObj = getTabState(i);
         if(!pageObj.isEmpty()) {
             pageObj["_tabName"] = ui->tabWidget->tabText(i);
+            if(pageObj.value("type").toString() == "multiple") {
+                QJsonObject subStates = pageObj["subStates"].toObject();
+                for(auto it = subStates.begin(); it != subStates.end(); ++it)
+                    it.value() = hoistObservedData(it.value().toObject(), datasets);
+                pageObj["subStates"] = subStates;
+            } else {
+                pageObj = hoistObservedData(pageObj, datasets);
+            }
             analysesArray.append(pageObj);
         }
     }
     QJsonObject root;
-    root["version"] = "2.1";
+    root["version"] = "2.2";
     root["analyses"] = analysesArray;
-    ModelParameter::instance()->saveFittingResult(root);
+    root["datasets"] = datasets;
+    return root;
 }
 
 void FittingPage::loadAllFittingStates()
@@ -263,15 +451,16 @@ void FittingPage::loadAllFittingStates()
 
     if(root.contains("analyses") && root["analyses"].isArray()) {
         QJsonArray arr = root["analyses"].toArray();
+        const QJsonObject datasets = root["datasets"].toObject();
         for(int i=0; i<arr.size(); ++i) {
-            QJsonObject pageObj = arr[i].toObject();
+            QJsonObject pageObj = resolveObservedData(arr[i].toObject(), datasets);
             QString name = pageObj.contains("_tabName") ? pageObj["_tabName"].toString() : QString("Analysis %1").arg(i+1);
 
             if(pageObj.contains("type") && pageObj["type"].toString() == "multiple") {
                 QJsonObject subStates = pageObj["subStates"].toObject();
                 QMap<QString, QJsonObject> map;
                 for(auto it = subStates.begin(); it != subStates.end(); ++it) {
-                    map.insert(it.key(), it.value().toObject());
+                    map.insert(it.key(), resolveObservedData(it.value().toObject(), datasets));
                 }
                 // 加载时暂无 selections 信息，默认全选，传空 map 即可
                 createNewMultiTab(name, map, QMap<QString, CurveSelection>());
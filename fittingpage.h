@@ -6,6 +6,14 @@
  * 2. 负责将项目级数据（如模型管理器、观测数据模型集合）传递给各个子页签。
  * 3. 实现多页签的创建、重命名、删除及保存恢复功能。
  * 4. 集成 FittingNewDialog 进行新建分析的交互。
+ * 5. [批量拟合] 工具栏"批量拟合"打开 FittingBatchDialog，对多个单分析页签与候选模型排队并发拟合。
+ * 6. [自动备份] collectFittingStates 给出与保存时相同的拟合状态对象，但不写入项目。
+ * 7. [后台导出] 转发单分析页签的 viewExportedFile 信号。
+ * 8. [曲线缓存] 持有各多分析对比页签共用的理论曲线缓存。
+ * 9. [后台报告] 工具栏"批量报告"为全部单分析页签各生成一份报告 (后台并行生成)。
+ * 10. [性能设置] applyPerformanceSettings 按设置调整共用理论曲线缓存的上限。
+ * 11. [联合拟合] 工具栏"联合拟合"打开 JointFitDialog，多个单分析页签共用储层参数、各自保留井储与表皮一起拟合。
+ * 12. [实时监测] 工具栏"实时监测"为当前单分析页签打开 GaugeMonitorDialog，接收压力计数据流并定时滚动拟合。
  */
 
 #ifndef FITTINGPAGE_H
@@ -14,7 +22,7 @@
 #include <QWidget>
 #include <QJsonObject>
 #include <QTabWidget>
-#include <QStandardItemModel>
+#include "columnartablemodel.h"
 #include <QMap>
 #include "modelmanager.h"
 #include "fittingmultiples.h" // 包含多分析对比类
@@ -39,7 +47,7 @@ public:
     void setModelManager(ModelManager* m);
 
     // 设置项目数据模型集合
-    void setProjectDataModels(const QMap<QString, QStandardItemModel*>& models);
+    void setProjectDataModels(const QMap<QString, ColumnarTableModel*>& models);
 
     // 接收来自外部的数据并设置到当前激活页签 (仅限单分析页签)
     void setObservedDataToCurrent(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
@@ -55,12 +63,25 @@ public:
 
     // 保存所有拟合分析的状态到项目文件
     void saveAllFittingStates();
+    // 汇总所有页签的拟合状态 (saveAllFittingStates 写入项目的内容)
+    QJsonObject collectFittingStates();
+
+    // 性能设置变更：重新读取理论曲线缓存上限；求解器默认设置改变时清空缓存中的旧曲线
+    void applyPerformanceSettings(bool solverDefaultsChanged);
+
+signals:
+    // 转发单分析页签导出的文件 (在数据界面打开)
+    void viewExportedFile(const QString& filePath);
 
 private slots:
     // 页签管理槽函数
     void on_btnNewAnalysis_clicked();
     void on_btnRenameAnalysis_clicked();
     void on_btnDeleteAnalysis_clicked();
+    void on_btnBatchFit_clicked();
+    void on_btnJointFit_clicked();
+    void on_btnMonitor_clicked();
+    void on_btnBatchReport_clicked();
 
     // 响应子页面的保存请求
     void onChildRequestSave();
@@ -68,9 +89,11 @@ private slots:
 private:
     Ui::FittingPage *ui;
     ModelManager* m_modelManager;
+    // 多分析对比页签共用的理论曲线缓存 (同一分析出现在多个对比页中时只计算一次)
+    QSharedPointer<TheoryCurveCache> m_curveCache;
 
     // 存储所有已打开文件的数据模型映射表
-    QMap<QString, QStandardItemModel*> m_dataMap;
+    QMap<QString, ColumnarTableModel*> m_dataMap;
 
     // 内部函数：创建新页签 (单分析)
     FittingWidget* createNewTab(const QString& name, const QJsonObject& initData = QJsonObject());
@@ -81,6 +104,9 @@ private:
                                               const QMap<QString, QJsonObject>& states,
                                               const QMap<QString, CurveSelection>& selections = QMap<QString, CurveSelection>());
 
+    // 按页签名称查找单分析页签 (不存在或为多分析对比页时返回 nullptr)
+    FittingWidget* findFittingWidget(const QString& name) const;
+
     // 生成唯一的页签名称
     QString generateUniqueName(const QString& baseName);
 
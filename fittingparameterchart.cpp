@@ -5,6 +5,10 @@
  * 1. [更新] resetParams: 包含模型界面的所有参数（基础+模型）。
  * 2. [更新] 增加 rw 参数到基础参数列表。
  * 3. [更新] rm (复合半径) 默认值=L，范围 [L, 10L]。
+ * 4. [批量拟合] resetParams/switchModel 改为调用静态的 defaultParameters/adaptParameters 后刷新表格。
+ * 5. [异步预览] 滚轮防抖间隔缩短为 30 ms：界面收到 parameterChangedByWheel 后异步计算预览，不再阻塞滚动。
+ * 6. [计算核心] defaultParameters/adaptParameters/getParamDisplayInfo 的实现移入 FitParameterCatalog (fitparameter.cpp)，此处转发。
+ * 7. [投机预计算] 滚轮写回的参数值与表格文本一致 (6 位有效数字)，预计算的参数组与滚轮实际产生的参数组逐位相同。
  */
 
 #include "fittingparameterchart.h"
@@ -22,7 +26,7 @@ FittingParameterChart::FittingParameterChart(QTableWidget *parentTable, QObject
 {
     m_wheelTimer = new QTimer(this);
     m_wheelTimer->setSingleShot(true);
-    m_wheelTimer->setInterval(200);
+    m_wheelTimer->setInterval(30); // 预览为异步计算，只合并同一次滚动中的连续事件
     connect(m_wheelTimer, &QTimer::timeout, this, &FittingParameterChart::onWheelDebounceTimeout);
 
     if(m_table) {
@@ -48,6 +52,7 @@ FittingParameterChart::FittingParameterChart(QTableWidget *parentTable, QObject
 
         m_table->viewport()->installEventFilter(this);
         connect(m_table, &QTableWidget::itemChanged, this, &FittingParameterChart::onTableItemChanged);
+        connect(m_table, &QTableWidget::currentCellChanged, this, &FittingParameterChart::onCurrentCellChanged);
     }
 }
 
@@ -82,14 +87,10 @@ bool FittingParameterChart::eventFilter(QObject *watched, QEvent *event)
                 double currentVal = currentText.toDouble(&ok);
                 if (ok) {
                     int steps = wheelEvent->angleDelta().y() / 120;
-                    double newVal = currentVal + steps * targetParam->step;
-
-                    if (targetParam->max > targetParam->min) {
-                        if (newVal < targetParam->min) newVal = targetParam->min;
-                        if (newVal > targetParam->max) newVal = targetParam->max;
-                    }
+                    double newVal = steppedValue(*targetParam, currentVal, steps);
                     item->setText(QString::number(newVal, 'g', 6));
                     targetParam->value = newVal;
+                    setActiveParameter(paramName);
                     m_wheelTimer->start();
                     return true;
                 }
@@ -104,6 +105,31 @@ void FittingParameterChart::onWheelDebounceTimeout()
     emit parameterChangedByWheel();
 }
 
+double FittingParameterChart::steppedValue(const FitParameter& p, double current, int steps)
+{
+    double newVal = current + steps * p.step;
+    if (p.max > p.min) {
+        if (newVal < p.min) newVal = p.min;
+        if (newVal > p.max) newVal = p.max;
+    }
+    // 与表格文本一致：界面读取参数时以文本为准
+    return QString::number(newVal, 'g', 6).toDouble();
+}
+
+void FittingParameterChart::onCurrentCellChanged(int row, int column, int previousRow, int previousColumn)
+{
+    Q_UNUSED(column); Q_UNUSED(previousRow); Q_UNUSED(previousColumn);
+    QTableWidgetItem* keyItem = (row >= 0) ? m_table->item(row, 1) : nullptr;
+    setActiveParameter(keyItem ? keyItem->data(Qt::UserRole).toString() : QString());
+}
+
+void FittingParameterChart::setActiveParameter(const QString& name)
+{
+    if (name == m_activeParam) return;
+    m_activeParam = name;
+    emit activeParameterChanged(name);
+}
+
 void FittingParameterChart::onTableItemChanged(QTableWidgetItem *item)
 {
     if (!item || item->column() != 2) return;
@@ -183,148 +209,29 @@ QStringList FittingParameterChart::getDefaultFitKeys(ModelManager::ModelType typ
 // [核心修改] 重置参数列表：包含基础参数和模型参数
 void FittingParameterChart::resetParams(ModelManager::ModelType type)
 {
-    m_params.clear();
-
-    // 辅助 Lambda: 添加参数
-    auto addParam = [&](QString name, double val, bool isFitDefault) {
-        FitParameter p;
-        p.name = name;
-        p.value = val;
-        p.isFit = isFitDefault;
-        p.isVisible = true;
-
-        // 设置范围
-        if (val > 0) {
-            p.min = val * 0.001; p.max = val * 1000.0;
-        } else {
-            p.min = 0.0; p.max = 100.0;
-        }
-
-        // 特殊范围和步长覆盖
-        if (name == "phi" || name == "mu" || name.startsWith("omega") || name.startsWith("lambda") || name == "eta12") {
-            p.step = 0.001;
-        } else if (name == "L" || name == "re" || name == "h" || name == "rm") {
-            p.step = 10.0;
-        } else if (name == "nf") {
-            p.step = 1.0; p.min = 1.0; p.max = 100.0;
-        } else if (name == "Lf") {
-            p.step = 1.0;
-        } else if (name == "S") {
-            p.step = 0.1; p.min = -5.0; p.max = 20.0;
-        } else if (name == "rw") {
-            p.step = 0.01; p.min = 0.01; p.max = 2.0;
-        } else {
-            p.step = val != 0 ? std::abs(val * 0.1) : 0.1;
-        }
-
-        QString symbol, uniSym, unit;
-        getParamDisplayInfo(p.name, p.displayName, symbol, uniSym, unit);
-        m_params.append(p);
-    };
-
-    // 1. 基础参数 (默认不拟合 isFit=false)
-    addParam("phi", 0.05, false);
-    addParam("h", 20.0, false);
-    addParam("rw", 0.1, false); // [新增] 井筒半径
-    addParam("mu", 0.5, false);
-    addParam("B", 1.05, false);
-    addParam("Ct", 5e-4, false);
-    addParam("q", 5.0, false);
-
-    // 2. 模型核心参数 (默认拟合 isFit=true)
-    addParam("kf", 1e-2, true);
-    addParam("M12", 10.0, true);
-    addParam("eta12", 0.2, true);
-
-    double valL = 1000.0;
-    addParam("L", valL, true);
-    addParam("Lf", 20.0, true);
-    addParam("nf", 4.0, true);
-
-    // rm: 默认值等于 L, 范围 1-10倍 L
-    {
-        FitParameter p;
-        p.name = "rm";
-        p.value = valL; // 默认值 = L
-        p.min = valL;   // 下限 = L
-        p.max = 10.0 * valL; // 上限 = 10L
-        p.step = 10.0;
-        p.isFit = true;
-        p.isVisible = true;
-        QString s, u, us;
-        getParamDisplayInfo(p.name, p.displayName, s, u, us);
-        m_params.append(p);
-    }
-
-    bool hasBoundary = (type == ModelManager::Model_3 || type == ModelManager::Model_4 ||
-                        type == ModelManager::Model_5 || type == ModelManager::Model_6);
-    if(hasBoundary) {
-        addParam("re", 20000.0, true);
-    }
-
-    addParam("omega1", 0.4, true);
-    addParam("omega2", 0.08, true);
-    addParam("lambda1", 1e-3, true);
-    addParam("lambda2", 1e-4, true);
-
-    bool hasStorage = (type == ModelManager::Model_1 || type == ModelManager::Model_3 || type == ModelManager::Model_5);
-    if(hasStorage) {
-        addParam("cD", 1e-7, true);
-        addParam("S", 0.01, true);
-    }
-
-    addParam("gamaD", 0.02, false);
-
-    // 3. 辅助参数 (只读)
-    {
-        FitParameter p;
-        p.name = "LfD";
-        p.displayName = "无因次缝长";
-        p.value = 0.02;
-        p.isFit = false;
-        p.isVisible = true;
-        p.step = 0.0;
-        m_params.append(p);
-    }
-
+    m_params = defaultParameters(type);
     refreshParamTable();
 }
 
+QList<FitParameter> FittingParameterChart::defaultParameters(ModelManager::ModelType type)
+{
+    return FitParameterCatalog::defaultParameters(type);
+}
+
 QList<FitParameter> FittingParameterChart::getParameters() const { return m_params; }
 void FittingParameterChart::setParameters(const QList<FitParameter> &params) { m_params = params; refreshParamTable(); }
 
 void FittingParameterChart::switchModel(ModelManager::ModelType newType)
 {
-    QMap<QString, double> oldValues;
-    for(const auto& p : m_params) oldValues.insert(p.name, p.value);
-
-    resetParams(newType);
-
-    // 恢复值
-    for(auto& p : m_params) {
-        if(oldValues.contains(p.name)) p.value = oldValues[p.name];
-    }
-
-    // 强制刷新依赖关系 (rm 范围, LfD)
-    double currentL = 1000.0;
-    for(const auto& p : m_params) if(p.name == "L") currentL = p.value;
-
-    for(auto& p : m_params) {
-        if(p.name == "rm") {
-            p.min = currentL;
-            p.max = 10.0 * currentL;
-            if(p.value < p.min) p.value = p.min;
-        }
-        if(p.name == "LfD") {
-            double currentLf = 20.0;
-            for(const auto& pp : m_params) if(pp.name == "Lf") currentLf = pp.value;
-            if(currentL > 1e-9) p.value = currentLf / currentL;
-        }
-    }
-
+    m_params = adaptParameters(m_params, newType);
     refreshParamTable();
 }
 
+QList<FitParameter> FittingParameterChart::adaptParameters(const QList<FitParameter>& current, ModelManager::ModelType newType)
+{
+    return FitParameterCatalog::adaptParameters(current, newType);
+}
+
 void FittingParameterChart::updateParamsFromTable()
 {
     if(!m_table) return;
@@ -422,30 +329,5 @@ void FittingParameterChart::addRowToTable(const FitParameter& p, int& serialNo,
 
 void FittingParameterChart::getParamDisplayInfo(const QString &name, QString &chName, QString &symbol, QString &uniSym, QString &unit)
 {
-    if(name == "kf")          { chName = "内区渗透率";     unit = "D"; }
-    else if(name == "M12")    { chName = "流度比";         unit = "无因次"; }
-    else if(name == "L")      { chName = "水平井长";       unit = "m"; }
-    else if(name == "Lf")     { chName = "裂缝半长";       unit = "m"; }
-    else if(name == "rm")     { chName = "复合半径";       unit = "m"; }
-    else if(name == "omega1") { chName = "内区储容比";     unit = "无因次"; }
-    else if(name == "omega2") { chName = "外区储容比";     unit = "无因次"; }
-    else if(name == "lambda1"){ chName = "内区窜流系数";   unit = "无因次"; }
-    else if(name == "lambda2"){ chName = "外区窜流系数";   unit = "无因次"; }
-    else if(name == "re")     { chName = "外区半径";       unit = "m"; }
-    else if(name == "eta12")  { chName = "导压系数比";     unit = "无因次"; }
-    else if(name == "nf")     { chName = "裂缝条数";       unit = "条"; }
-    else if(name == "h")      { chName = "有效厚度";       unit = "m"; }
-    else if(name == "rw")     { chName = "井筒半径";       unit = "m"; } // [新增]
-    else if(name == "phi")    { chName = "孔隙度";         unit = "小数"; }
-    else if(name == "mu")     { chName = "流体粘度";       unit = "mPa·s"; }
-    else if(name == "B")      { chName = "体积系数";       unit = "无因次"; }
-    else if(name == "Ct")     { chName = "综合压缩系数";   unit = "MPa⁻¹"; }
-    else if(name == "q")      { chName = "测试产量";       unit = "m³/d"; }
-    else if(name == "C")      { chName = "井筒储存系数";   unit = "m³/MPa"; }
-    else if(name == "cD")     { chName = "无因次井储";     unit = "无因次"; }
-    else if(name == "S")      { chName = "表皮系数";       unit = "无因次"; }
-    else if(name == "gamaD")  { chName = "压敏系数";       unit = "无因次"; }
-    else if(name == "LfD")    { chName = "无因次缝长";     unit = "无因次"; }
-    else { chName = name; unit = ""; }
-    symbol = name; uniSym = name;
+    FitParameterCatalog::getParamDisplayInfo(name, chName, symbol, uniSym, unit);
 }
@@ -6,6 +6,10 @@
  * 2. 管理拟合界面参数表格的显示、交互与逻辑。
  * 3. 实现参数的默认选择逻辑：根据试井模型类型，自动勾选需要拟合的核心参数。
  * 4. 实现鼠标滚轮调节参数功能，并增加防抖动和边界限制保护。
+ * 5. [批量拟合] 默认参数表与换模型时的参数继承提取为静态函数，不依赖表格即可为任一模型生成参数列表。
+ * 6. [计算核心] FitParameter 移至不依赖界面的 fitparameter.h，静态函数转发给 FitParameterCatalog。
+ * 7. [投机预计算] 记录正在调节的参数 (选中行或最近一次滚轮所在行)，变化时发出 activeParameterChanged；
+ *    滚轮步进的取值规则提取为 steppedValue，供预计算按相同规则生成后续几步的参数值。
  */
 
 #ifndef FITTINGPARAMETERCHART_H
@@ -18,18 +22,7 @@
 #include <QEvent>
 #include <QTimer>
 #include "modelmanager.h"
-
-// 定义拟合参数结构体
-struct FitParameter {
-    QString name;           // 参数内部标识 (如 "kf")
-    QString displayName;    // 参数显示名称 (如 "内区渗透率")
-    double value = 0.0;     // 当前值
-    bool isFit = false;     // 是否参与拟合
-    double min = 0.0;       // 最小值限制
-    double max = 100.0;     // 最大值限制
-    bool isVisible = true;  // 是否在表格中显示
-    double step = 0.1;      // 滚轮调节步长
-};
+#include "fitparameter.h"
 
 class FittingParameterChart : public QObject
 {
@@ -59,13 +52,28 @@ public:
     // 刷新表格显示
     void refreshParamTable();
 
+    // 静态辅助：指定模型的默认参数列表 (默认值、范围、步长及默认拟合勾选，与 resetParams 一致)
+    static QList<FitParameter> defaultParameters(ModelManager::ModelType type);
+
+    // 静态辅助：换为 newType 模型后的参数列表 (共有参数保留 current 中的值，与 switchModel 一致)
+    static QList<FitParameter> adaptParameters(const QList<FitParameter>& current, ModelManager::ModelType newType);
+
     // 静态辅助：获取参数显示信息 (名称, 符号, 单位等)
     static void getParamDisplayInfo(const QString& name, QString& chName, QString& symbol, QString& uniSymbol, QString& unit);
 
+    // 静态辅助：从 current 滚动 steps 格后的取值 (按 step 步进，截断到 [min, max]，并按表格显示的 6 位有效数字取整)
+    static double steppedValue(const FitParameter& p, double current, int steps);
+
+    // 正在调节的参数 (选中行或最近一次滚轮所在行，未选择时为空)
+    QString activeParameter() const { return m_activeParam; }
+
 signals:
     // 当参数通过滚轮改变且稳定后（防抖）发出此信号
     void parameterChangedByWheel();
 
+    // 正在调节的参数改变 (选中其他行或在其他行上滚动滚轮)
+    void activeParameterChanged(const QString& name);
+
 protected:
     // 事件过滤器，用于拦截滚轮事件
     bool eventFilter(QObject *watched, QEvent *event) override;
@@ -77,6 +85,9 @@ private slots:
     // 滚轮操作防抖定时器超时槽
     void onWheelDebounceTimeout();
 
+    // 当前单元格变化槽 (记录正在调节的参数)
+    void onCurrentCellChanged(int row, int column, int previousRow, int previousColumn);
+
 private:
     QTableWidget* m_table;
     ModelManager* m_modelManager;
@@ -85,6 +96,10 @@ private:
     // 滚轮防抖定时器
     QTimer* m_wheelTimer;
 
+    // 正在调节的参数
+    QString m_activeParam;
+    void setActiveParameter(const QString& name);
+
     // 辅助：向表格添加一行
     void addRowToTable(const FitParameter& p, int& serialNo, bool highlight);
 
@@ -5,14 +5,29 @@
  * 1. 实现了基于 HTML 模板的报告生成逻辑。
  * 2. 自动在报告同级目录下生成数据 CSV 文件。
  * 3. 封装了文件 I/O 操作和编码处理。
+ * 4. 参数不确定性一节：标准误差以迭代坐标给出 (对数参数为 log10 单位)，区间换算为物理量；
+ *    不可辨识的参数区间记为"无界"，剖面似然在 3σ 内未达到阈值的一侧以 "≤"/"≥" 标出。
+ * 5. [后台导出] 关联数据表经 DataExportService 写出 (数值按最短表示，写完后才替换目标文件)。
+ * 6. [后台报告] 报告文件经 QSaveFile 写出；generateAll 先把所有报告的图像编码拆成独立任务并行执行，
+ *    再每份报告一个任务生成 HTML 并写出，图像编码不再占用界面线程。
  */
 
 #include "fittingreport.h"
+#include "dataexportservice.h"
+#include "qcustomplot.h"
+#include <QBuffer>
+#include <QEventLoop>
 #include <QFile>
-#include <QTextStream>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QDateTime>
 #include <QDir>
+#include <QMutex>
+#include <QProgressDialog>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtConcurrent>
+#include <cmath>
 
 bool FittingReportGenerator::generate(const QString& filePath, const FittingReportData& data, QString* errorMsg)
 {
@@ -34,47 +49,152 @@ bool FittingReportGenerator::generate(const QString& filePath, const FittingRepo
         return false;
     }
 
-    // 2. 生成 HTML 内容
-    QString htmlContent = buildHtmlContent(data, dataFileName);
+    // 2. 生成 HTML 内容 (尚未编码的图像在此编码)
+    QString htmlContent = buildHtmlContent(encodedData(data), dataFileName);
 
-    // 3. 写入报告文件
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    // 3. 写入报告文件 (写完后才替换目标文件)
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
         if (errorMsg) *errorMsg = "无法打开报告文件进行写入: " + file.errorString();
         return false;
     }
-
-    QTextStream out(&file);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    out.setEncoding(QStringConverter::Utf8);
-#else
-    out.setCodec("UTF-8");
-#endif
     // 写入 BOM 以防止中文乱码 (主要针对 Windows)
     file.write("\xEF\xBB\xBF");
-    out << htmlContent;
-    file.close();
+    file.write(htmlContent.toUtf8());
+    if (!file.commit()) {
+        if (errorMsg) *errorMsg = "报告文件写入失败: " + file.errorString();
+        return false;
+    }
 
     return true;
 }
 
-bool FittingReportGenerator::generateDataCSV(const QString& csvPath, const FittingReportData& data)
+QImage FittingReportGenerator::renderPlot(QCustomPlot* plot, int width, int height)
 {
-    QFile dataFile(csvPath);
-    if (!dataFile.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    if (!plot || width <= 0 || height <= 0) return QImage();
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QCPPainter painter(&image);
+    plot->toPainter(&painter, width, height);
+    painter.end();
+    return image;
+}
 
-    QTextStream outData(&dataFile);
-    dataFile.write("\xEF\xBB\xBF"); // BOM
-    outData << QString("序号,时间(h),压差(MPa),压力导数(MPa)\n");
-    for(int i = 0; i < data.t.size(); ++i) {
-        double dVal = (i < data.d.size()) ? data.d[i] : 0.0;
-        outData << QString("%1,%2,%3,%4\n").arg(i+1)
-                       .arg(data.t[i])
-                       .arg(data.p[i])
-                       .arg(dVal);
+QString FittingReportGenerator::encodeImage(const QImage& image)
+{
+    if (image.isNull()) return QString();
+    QByteArray byteArray;
+    QBuffer buffer(&byteArray);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    return QString::fromLatin1(byteArray.toBase64());
+}
+
+FittingReportData FittingReportGenerator::encodedData(const FittingReportData& data)
+{
+    FittingReportData result = data;
+    if (result.imgLogLog.isEmpty()) result.imgLogLog = encodeImage(result.imageLogLog);
+    if (result.imgSemiLog.isEmpty()) result.imgSemiLog = encodeImage(result.imageSemiLog);
+    if (result.imgCartesian.isEmpty()) result.imgCartesian = encodeImage(result.imageCartesian);
+    return result;
+}
+
+int FittingReportGenerator::stepCount(const QVector<FittingReportJob>& jobs)
+{
+    return jobs.size() * 4; // 三张图像与报告本身
+}
+
+bool FittingReportGenerator::generateAll(const QVector<FittingReportJob>& jobs, const CancellationToken* token,
+                                         QAtomicInteger<int>* progress, QStringList* errors)
+{
+    QVector<FittingReportJob> work = jobs;
+    FittingReportJob* items = work.data();
+
+    // 1. 所有报告的图像编码拆成独立任务 (各任务只写自己的字段)
+    struct ImageTask { QString* target; const QImage* image; };
+    QVector<ImageTask> images;
+    for (FittingReportJob& job : work) {
+        FittingReportData& d = job.data;
+        images.append({&d.imgLogLog, &d.imageLogLog});
+        images.append({&d.imgSemiLog, &d.imageSemiLog});
+        images.append({&d.imgCartesian, &d.imageCartesian});
     }
-    dataFile.close();
-    return true;
+    QtConcurrent::blockingMap(images, [token, progress](const ImageTask& task) {
+        if (!(token && token->isCancelled()) && task.target->isEmpty()) *task.target = encodeImage(*task.image);
+        if (progress) progress->fetchAndAddRelaxed(1);
+    });
+
+    // 2. 每份报告一个任务：生成 HTML 并写出
+    QMutex errorMutex;
+    QStringList failed;
+    QVector<int> indices(work.size());
+    for (int i = 0; i < indices.size(); ++i) indices[i] = i;
+    QtConcurrent::blockingMap(indices, [&](int i) {
+        if (!(token && token->isCancelled())) {
+            FittingReportData& d = items[i].data;
+            d.imageLogLog = d.imageSemiLog = d.imageCartesian = QImage(); // 已编码，提前释放
+            QString error;
+            if (!generate(items[i].filePath, d, &error)) {
+                QMutexLocker locker(&errorMutex);
+                failed.append(QFileInfo(items[i].filePath).fileName() + ": " + error);
+            }
+        }
+        if (progress) progress->fetchAndAddRelaxed(1);
+    });
+
+    if (errors) *errors = failed;
+    return failed.isEmpty() && !(token && token->isCancelled());
+}
+
+DataExportService::Result FittingReportGenerator::generateWithProgress(QWidget* parent, const QVector<FittingReportJob>& jobs,
+                                                                       QStringList* errors)
+{
+    QAtomicInteger<int> steps(0);
+    CancellationToken cancel;
+    QStringList failed;
+    // jobs 在事件循环结束前一直有效，按引用交给后台线程
+    QFuture<bool> future = QtConcurrent::run([&]() {
+        return generateAll(jobs, &cancel, &steps, &failed);
+    });
+
+    QProgressDialog progress(jobs.size() > 1 ? QString("正在生成 %1 份报告...").arg(jobs.size()) : QString("正在生成报告..."),
+                             "取消", 0, qMax(stepCount(jobs), 1), parent);
+    progress.setWindowTitle("导出报告");
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    DataExportService::applyProgressStyle(&progress);
+    QObject::connect(&progress, &QProgressDialog::canceled, &progress, [&cancel]() { cancel.cancel(); });
+
+    QEventLoop loop;
+    QFutureWatcher<bool> watcher;
+    QObject::connect(&watcher, &QFutureWatcher<bool>::finished, &loop, &QEventLoop::quit);
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, &progress, [&]() { progress.setValue(steps.loadRelaxed()); });
+    timer.start(100);
+    watcher.setFuture(future);
+    if (!future.isFinished()) loop.exec();
+    timer.stop();
+    progress.reset();
+
+    if (errors) *errors = failed;
+    if (future.result()) return DataExportService::Succeeded;
+    if (cancel.isCancelled() && failed.isEmpty()) return DataExportService::Cancelled;
+    return DataExportService::Failed;
+}
+
+bool FittingReportGenerator::generateDataCSV(const QString& csvPath, const FittingReportData& data)
+{
+    const int n = data.t.size();
+    QVector<double> index(n);
+    for (int i = 0; i < n; ++i) index[i] = i + 1;
+    QVector<double> d = data.d;
+    if (d.size() < n) d.resize(n); // 缺少的导数记为 0
+
+    ExportTable table;
+    table.rowCount = n;
+    table.columns << ExportColumn::numbers("序号", index) << ExportColumn::numbers("时间(h)", data.t)
+                  << ExportColumn::numbers("压差(MPa)", data.p) << ExportColumn::numbers("压力导数(MPa)", d);
+    return DataExportService::write(csvPath, table);
 }
 
 QString FittingReportGenerator::buildHtmlContent(const FittingReportData& data, const QString& csvFileName)
@@ -169,6 +289,65 @@ QString FittingReportGenerator::buildHtmlContent(const FittingReportData& data,
         html += "<p>无默认参数。</p>";
     }
 
+    if (data.uncertainty.valid) html += buildUncertaintySection(data.uncertainty);
+
     html += "<br/><hr/><p style='text-align:center; font-size:9pt; color:#888;'>报告来自PWT压力试井分析系统</p></body></html>";
     return html;
 }
+
+QString FittingReportGenerator::buildUncertaintySection(const FitUncertainty& u)
+{
+    auto number = [](double v) {
+        if (std::isnan(v)) return QString("-");
+        if (std::isinf(v)) return QString("无界");
+        return QString::number(v, 'g', 4);
+    };
+    QStringList symbols;
+    for (const QString& name : u.names) {
+        QString chName, symbol, uniSym, unit;
+        FittingParameterChart::getParamDisplayInfo(name, chName, symbol, uniSym, unit);
+        symbols.append(uniSym.isEmpty() ? name : uniSym);
+    }
+
+    QString html = "<h2>五、参数不确定性</h2>";
+    html += "<table><tr><th>符号</th><th>拟合值</th><th>标准误差</th><th>95%区间下限</th><th>95%区间上限</th>";
+    if (u.hasProfile()) html += "<th>剖面似然下限</th><th>剖面似然上限</th>";
+    html += "</tr>";
+    for (int i = 0; i < u.names.size(); ++i) {
+        QString se = number(u.stdError[i]);
+        if (u.logScale[i] && std::isfinite(u.stdError[i])) se += " (log10)";
+        html += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td>")
+                    .arg(symbols[i], QString::number(u.values[i], 'g', 6), se, number(u.lower[i]), number(u.upper[i]));
+        if (u.hasProfile()) {
+            html += QString("<td>%1%2</td><td>%3%4</td>")
+                        .arg(u.profileLowerOpen[i] ? "≤ " : "", number(u.profileLower[i]),
+                             u.profileUpperOpen[i] ? "≥ " : "", number(u.profileUpper[i]));
+        }
+        html += "</tr>";
+    }
+    html += "</table>";
+
+    if (u.names.size() > 1) {
+        html += "<p><b>参数相关系数矩阵：</b></p><table><tr><th></th>";
+        for (const QString& s : symbols) html += QString("<th>%1</th>").arg(s);
+        html += "</tr>";
+        for (int i = 0; i < u.names.size(); ++i) {
+            html += QString("<tr><th>%1</th>").arg(symbols[i]);
+            for (int j = 0; j < u.names.size(); ++j) {
+                const double c = u.correlation[i][j];
+                // 强相关 (|ρ| > 0.95) 的参数对难以单独确定，加粗显示
+                const bool strong = (i != j && std::isfinite(c) && std::abs(c) > 0.95);
+                const QString text = std::isfinite(c) ? QString::number(c, 'f', 3) : QString("-");
+                html += strong ? QString("<td><b>%1</b></td>").arg(text) : QString("<td>%1</td>").arg(text);
+            }
+            html += "</tr>";
+        }
+        html += "</table>";
+    }
+
+    html += QString("<p style='font-size:9pt; color:blue;'>* 注：由拟合结束点的雅可比矩阵线性化估计，自由度 %1，残差方差 s² = %2，"
+                    "JᵀJ 条件数 %3；对数参数的标准误差以 log10 为单位，区间为乘性区间。%4</p>")
+                .arg(u.dof).arg(u.sigma2, 0, 'e', 3).arg(u.conditionNumber, 0, 'e', 2)
+                .arg(u.hasProfile() ? "剖面似然区间按 ΔSSE = s²·χ²(0.95, 1) 确定。" : "");
+    return html;
+}
@@ -4,16 +4,26 @@
  * 功能描述:
  * 1. 定义报告生成所需的数据结构 FittingReportData。
  * 2. 声明 FittingReportGenerator 类，负责生成 HTML/Word 报告及关联的 CSV 数据表。
+ * 3. 报告数据可附带拟合参数的不确定性 (FitUncertainty)，有效时报告增加"参数不确定性"一节。
+ * 4. [后台报告] 图表在界面线程用 renderPlot 离屏绘制到 QImage (不经 QPixmap，可交给工作线程)；
+ *    generateAll 在线程池中并行完成各图像的 PNG / Base64 编码，再并行生成并写出各报告，
+ *    generateWithProgress 在后台执行并显示可取消的进度框，供单个报告与整个拟合页面的批量报告使用。
  */
 
 #ifndef FITTINGREPORT_H
 #define FITTINGREPORT_H
 
+#include <QAtomicInteger>
+#include <QImage>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include <QList>
+#include "cancellationtoken.h"
+#include "dataexportservice.h"
 #include "fittingparameterchart.h"
 #include "modelmanager.h"
+#include "fituncertainty.h"
 
 // 报告所需的数据包
 struct FittingReportData {
@@ -29,12 +39,29 @@ struct FittingReportData {
     // 参数列表
     QList<FitParameter> params;
 
+    // 参数不确定性 (无效时报告中不输出该节)
+    FitUncertainty uncertainty;
+
     // 图表截图 (Base64编码)
     QString imgLogLog;
     QString imgSemiLog;
     QString imgCartesian;
+
+    // 尚未编码的图表图像 (对应的 Base64 为空时由 generate / generateAll 编码)
+    QImage imageLogLog;
+    QImage imageSemiLog;
+    QImage imageCartesian;
+};
+
+// 一份待生成的报告
+struct FittingReportJob {
+    QString filePath;
+    FittingReportData data;
 };
 
+class QCustomPlot;
+class QWidget;
+
 class FittingReportGenerator
 {
 public:
@@ -47,12 +74,38 @@ public:
      */
     static bool generate(const QString& filePath, const FittingReportData& data, QString* errorMsg = nullptr);
 
+    // 离屏绘制图表 (只能在界面线程调用；图表未显示过也可绘制)
+    static QImage renderPlot(QCustomPlot* plot, int width = 800, int height = 600);
+    // PNG 编码后转为 Base64 (可在任意线程调用)
+    static QString encodeImage(const QImage& image);
+
+    /**
+     * @brief 并行生成多份报告 (可在任意线程调用)
+     * @param token 取消令牌 (可为空)；取消后未开始的报告不再生成
+     * @param progress 输出：已完成的步骤数 (每张图像、每份报告各计一步，总数见 stepCount)
+     * @param errors 输出：失败报告的路径与原因
+     * @return 全部报告生成成功返回 true
+     */
+    static bool generateAll(const QVector<FittingReportJob>& jobs, const CancellationToken* token = nullptr,
+                            QAtomicInteger<int>* progress = nullptr, QStringList* errors = nullptr);
+    static int stepCount(const QVector<FittingReportJob>& jobs);
+
+    // 在后台线程生成并显示进度框 (窗口模态，界面继续刷新)
+    static DataExportService::Result generateWithProgress(QWidget* parent, const QVector<FittingReportJob>& jobs,
+                                                          QStringList* errors = nullptr);
+
 private:
+    // 编码 data 中 Base64 为空的图像 (返回编码后的副本)
+    static FittingReportData encodedData(const FittingReportData& data);
+
     // 内部辅助：生成 CSV 数据表
     static bool generateDataCSV(const QString& csvPath, const FittingReportData& data);
 
     // 内部辅助：生成 HTML 内容
     static QString buildHtmlContent(const FittingReportData& data, const QString& csvFileName);
+
+    // 内部辅助：生成参数不确定性一节 (标准误差、置信区间与相关系数矩阵)
+    static QString buildUncertaintySection(const FitUncertainty& u);
 };
 
 #endif // FITTINGREPORT_H
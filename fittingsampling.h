@@ -0,0 +1,27 @@
+/*
+ * 文件名: fittingsampling.h
+ * 文件作用: 拟合数据抽样设置的数据结构 (不依赖界面)
+ * 功能描述:
+ * 1. SamplingInterval：自定义抽样区间 (起止时间与区间内的抽样点数)。
+ * 2. SamplingMode：取最近点，或在对数分箱内取平均值/中值 (适用于高频密集数据)。
+ * 3. 由 fittingsamplingdialog.h 中分离出来，供拟合核心、批量队列与命令行批处理使用。
+ */
+
+#ifndef FITTINGSAMPLING_H
+#define FITTINGSAMPLING_H
+
+// 抽样区间结构体
+struct SamplingInterval {
+    double tStart; // 起始时间
+    double tEnd;   // 结束时间
+    int count;     // 该区间内的抽样点数
+};
+
+// 抽样方式
+enum SamplingMode {
+    Sampling_NearestPoint = 0, // 取最接近各对数目标时刻的单个数据点
+    Sampling_BinMean = 1,      // 对数分箱，箱内取平均值
+    Sampling_BinMedian = 2     // 对数分箱，箱内取中值 (抗野值)
+};
+
+#endif // FITTINGSAMPLING_H
@@ -4,6 +4,7 @@
  * 功能描述:
  * 1. 实现表格的增删改查逻辑。
  * 2. 提供默认的对数空间抽样策略生成算法。
+ * 3. 抽样方式下拉框：最近点 / 分箱平均 / 分箱中值，对默认策略与自定义区间均生效。
  */
 
 #include "fittingsamplingdialog.h"
@@ -35,6 +36,16 @@ SamplingSettingsDialog::SamplingSettingsDialog(const QList<SamplingInterval>& in
     m_chkEnable->setChecked(enabled);
     mainLayout->addWidget(m_chkEnable);
 
+    QHBoxLayout* modeLayout = new QHBoxLayout();
+    modeLayout->addWidget(new QLabel("抽样方式:", this));
+    m_comboMode = new QComboBox(this);
+    m_comboMode->addItem("最近点 (取最接近目标时刻的数据点)", (int)Sampling_NearestPoint);
+    m_comboMode->addItem("分箱平均 (对数箱内取平均，抑制噪声)", (int)Sampling_BinMean);
+    m_comboMode->addItem("分箱中值 (对数箱内取中值，抑制野值)", (int)Sampling_BinMedian);
+    modeLayout->addWidget(m_comboMode);
+    modeLayout->addStretch();
+    mainLayout->addLayout(modeLayout);
+
     m_table = new QTableWidget(this);
     m_table->setColumnCount(3);
     m_table->setHorizontalHeaderLabels(QStringList() << "起始时间(h)" << "结束时间(h)" << "抽样点数");
@@ -98,6 +109,15 @@ bool SamplingSettingsDialog::isCustomSamplingEnabled() const {
     return m_chkEnable->isChecked();
 }
 
+void SamplingSettingsDialog::setSamplingMode(SamplingMode mode) {
+    int index = m_comboMode->findData((int)mode);
+    m_comboMode->setCurrentIndex(index >= 0 ? index : 0);
+}
+
+SamplingMode SamplingSettingsDialog::samplingMode() const {
+    return (SamplingMode)m_comboMode->currentData().toInt();
+}
+
 void SamplingSettingsDialog::addRow(double start, double end, int count) {
     int row = m_table->rowCount();
     m_table->insertRow(row);
@@ -4,6 +4,8 @@
  * 功能描述:
  * 1. 定义 SamplingInterval 结构体，用于存储抽样区间信息。
  * 2. 定义 SamplingSettingsDialog 类，提供用户交互界面以设置自定义抽样策略。
+ * 3. 定义抽样方式 SamplingMode：取最近点，或在对数分箱内取平均值/中值 (适用于高频密集数据)。
+ * 4. [计算核心] SamplingInterval 与 SamplingMode 移至不依赖界面的 fittingsampling.h，本文件包含之。
  */
 
 #ifndef FITTINGSAMPLINGDIALOG_H
@@ -12,14 +14,9 @@
 #include <QDialog>
 #include <QTableWidget>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QList>
-
-// 抽样区间结构体
-struct SamplingInterval {
-    double tStart; // 起始时间
-    double tEnd;   // 结束时间
-    int count;     // 该区间内的抽样点数
-};
+#include "fittingsampling.h"
 
 class SamplingSettingsDialog : public QDialog
 {
@@ -31,6 +28,10 @@ public:
     QList<SamplingInterval> getIntervals() const;
     bool isCustomSamplingEnabled() const;
 
+    // 抽样方式 (对话框打开时为最近点)
+    void setSamplingMode(SamplingMode mode);
+    SamplingMode samplingMode() const;
+
 private slots:
     void onAddRow();      // 添加一行
     void onRemoveRow();   // 删除选中行
@@ -39,6 +40,7 @@ private slots:
 private:
     QTableWidget* m_table; // 表格控件
     QCheckBox* m_chkEnable;// 启用开关
+    QComboBox* m_comboMode;// 抽样方式
     double m_dataMinT;     // 数据最小时间
     double m_dataMaxT;     // 数据最大时间
 
@@ -0,0 +1,128 @@
+/*
+ * 文件名: fituncertainty.cpp
+ * 文件作用: 拟合参数不确定性分析实现文件
+ * 功能描述:
+ * 1. 线性化协方差只使用已有的雅可比矩阵与残差，不做任何模型计算。
+ * 2. t 分位数：自由度 30 以内查表，更大时用 Cornish-Fisher 展开 (误差低于 1e-4)。
+ */
+
+#include "fituncertainty.h"
+#include "normalequations.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+bool FitUncertainty::matches(const QMap<QString, double>& params, double relativeTolerance) const
+{
+    if (!valid) return false;
+    for (int i = 0; i < names.size(); ++i) {
+        if (!params.contains(names[i])) return false;
+        const double v = params.value(names[i]);
+        if (std::abs(v - values[i]) > relativeTolerance * std::max(std::abs(v), std::abs(values[i])) + 1e-300) return false;
+    }
+    return true;
+}
+
+double FitUncertaintyAnalysis::studentT975(int dof)
+{
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (dof < 1) return std::numeric_limits<double>::infinity();
+    if (dof <= 30) return table[dof - 1];
+    const double z = 1.959963984540054;
+    const double n = dof;
+    return z + (z * z * z + z) / (4.0 * n) + (5.0 * std::pow(z, 5) + 16.0 * z * z * z + 3.0 * z) / (96.0 * n * n);
+}
+
+double FitUncertaintyAnalysis::toPhysical(double value, bool logScale, double offset)
+{
+    return logScale ? value * std::pow(10.0, offset) : value + offset;
+}
+
+FitUncertainty FitUncertaintyAnalysis::fromJacobian(const QStringList& names, const QVector<bool>& logScale,
+                                                    const QVector<double>& values, const Eigen::MatrixXd& J,
+                                                    const QVector<double>& residuals, bool reproducible)
+{
+    FitUncertainty u;
+    u.names = names;
+    u.logScale = logScale;
+    u.values = values;
+    const int n = names.size();
+    const int m = residuals.size();
+    if (n == 0 || J.cols() != n || J.rows() != m) {
+        u.message = "雅可比矩阵与拟合参数不一致";
+        return u;
+    }
+    if (m <= n) {
+        u.message = "数据点数不多于拟合参数个数，无法估计残差方差";
+        return u;
+    }
+    if (!J.allFinite()) {
+        u.message = "雅可比矩阵含非有限值";
+        return u;
+    }
+
+    double sse = 0.0;
+    for (double r : residuals) sse += r * r;
+    u.dof = m - n;
+    u.sigma2 = sse / u.dof;
+
+    // (JᵀJ)⁺：特征值过小的方向不可辨识
+    const Eigen::MatrixXd A = NormalEquations::gram(J, reproducible);
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(A);
+    const Eigen::VectorXd lambda = eig.eigenvalues();
+    const double lambdaMax = lambda.maxCoeff();
+    if (!(lambdaMax > 0.0)) {
+        u.message = "雅可比矩阵为零，参数对曲线无影响";
+        return u;
+    }
+    const double cutoff = 1e-12 * lambdaMax;
+    Eigen::VectorXd inv(n);
+    QVector<bool> identifiable(n, true);
+    double lambdaMin = lambdaMax;
+    for (int k = 0; k < n; ++k) {
+        if (lambda(k) > cutoff) {
+            inv(k) = 1.0 / lambda(k);
+            lambdaMin = std::min(lambdaMin, lambda(k));
+        } else {
+            inv(k) = 0.0;
+            // 零空间方向上分量显著的参数不可辨识
+            for (int i = 0; i < n; ++i) {
+                if (std::abs(eig.eigenvectors()(i, k)) > 1e-3) identifiable[i] = false;
+            }
+        }
+    }
+    u.conditionNumber = lambdaMax / lambdaMin;
+    const Eigen::MatrixXd cov = u.sigma2 * eig.eigenvectors() * inv.asDiagonal() * eig.eigenvectors().transpose();
+
+    const double t = studentT975(u.dof);
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    u.stdError.resize(n);
+    u.lower.resize(n);
+    u.upper.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const double sigma = identifiable[i] ? std::sqrt(std::max(0.0, cov(i, i))) : inf;
+        u.stdError[i] = sigma;
+        if (std::isfinite(sigma)) {
+            u.lower[i] = toPhysical(values[i], logScale[i], -t * sigma);
+            u.upper[i] = toPhysical(values[i], logScale[i], t * sigma);
+        } else {
+            u.lower[i] = logScale[i] ? 0.0 : -inf;
+            u.upper[i] = inf;
+        }
+    }
+    u.correlation = QVector<QVector<double>>(n, QVector<double>(n, nan));
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            if (!identifiable[i] || !identifiable[j]) continue;
+            const double d = std::sqrt(cov(i, i) * cov(j, j));
+            u.correlation[i][j] = (d > 0.0) ? cov(i, j) / d : (i == j ? 1.0 : 0.0);
+        }
+    }
+    u.valid = true;
+    return u;
+}
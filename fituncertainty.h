@@ -0,0 +1,69 @@
+/*
+ * 文件名: fituncertainty.h
+ * 文件作用: 拟合参数不确定性分析头文件
+ * 功能描述:
+ * 1. 定义拟合结果的不确定性 FitUncertainty：各拟合参数的标准误差、95% 置信区间与相关系数矩阵。
+ * 2. 线性化估计：由结束点的雅可比矩阵 J (与迭代坐标一致，正值参数为 log10 坐标，S/nf 为线性坐标)
+ *    得到协方差 C = s² (JᵀJ)⁺，s² = SSE / (m - n)；(JᵀJ) 按特征分解求伪逆，
+ *    特征值低于最大特征值 1e-12 倍的方向视为不可辨识，涉及的参数区间记为无界。
+ * 3. 95% 区间：迭代坐标下 x ± t(0.975, m - n)·σ，log10 坐标的区间换算回物理量后为乘性区间。
+ * 4. 剖面似然区间 (可选)：固定单个参数于 ±1σ、±2σ、±3σ 处重新拟合其余参数，
+ *    ΔSSE 首次超过 s²·χ²(0.95, 1) 一侧的两点间线性插值求区间端点，3σ 内未超过时该侧记为开区间。
+ */
+
+#ifndef FITUNCERTAINTY_H
+#define FITUNCERTAINTY_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <Eigen/Dense>
+
+struct FitUncertainty {
+    bool valid = false;          // 是否已得到结果
+    QString message;             // 无法计算时的原因
+
+    QStringList names;           // 拟合参数名 (与迭代坐标顺序一致)
+    QVector<bool> logScale;      // 是否为 log10 坐标
+    QVector<double> values;      // 拟合值 (物理量)
+    QVector<double> stdError;    // 迭代坐标下的标准误差 (log10 坐标即 log10 单位)，不可辨识时为无穷大
+    QVector<double> lower;       // 线性化 95% 置信区间 (物理量)
+    QVector<double> upper;
+    QVector<QVector<double>> correlation; // 相关系数矩阵 (不可辨识的参数所在行列为 NaN)
+
+    int dof = 0;                 // 自由度 m - n
+    double sigma2 = 0.0;         // 残差方差估计 s²
+    double conditionNumber = 0.0;// JᵀJ 的条件数
+
+    // 剖面似然区间 (未计算时为空)
+    QVector<double> profileLower;
+    QVector<double> profileUpper;
+    QVector<bool> profileLowerOpen; // 该侧在 3σ 内未达到阈值 (区间至少延伸到记录的端点)
+    QVector<bool> profileUpperOpen;
+
+    bool hasProfile() const { return profileLower.size() == names.size() && !names.isEmpty(); }
+
+    // 参数值与 params 一致 (相对差在 relativeTolerance 以内) 时结果仍对应当前参数；
+    // 默认容差覆盖参数表按 5 位有效数字显示造成的舍入
+    bool matches(const QMap<QString, double>& params, double relativeTolerance = 1e-4) const;
+};
+
+class FitUncertaintyAnalysis
+{
+public:
+    // 由结束点的雅可比矩阵与残差计算线性化不确定性；reproducible 时 JᵀJ 按固定分块顺序归约 (normalequations.h)
+    static FitUncertainty fromJacobian(const QStringList& names, const QVector<bool>& logScale, const QVector<double>& values,
+                                       const Eigen::MatrixXd& J, const QVector<double>& residuals, bool reproducible = false);
+
+    // Student t 分布 0.975 分位数 (自由度 dof ≥ 1)
+    static double studentT975(int dof);
+
+    // 剖面似然阈值 χ²(0.95, 1)
+    static double chiSquare95() { return 3.841458820694124; }
+
+    // 迭代坐标 x (log10 或线性) 与物理量之间的换算
+    static double toPhysical(double value, bool logScale, double offset);
+};
+
+#endif // FITUNCERTAINTY_H
@@ -0,0 +1,254 @@
+/*
+ * 文件名: flowregime.cpp
+ * 文件作用: 观测导数的流动段自动划分实现文件
+ * 功能描述:
+ * 1. 导数先按每个对数周期 10 个箱取中值 (LogBinSampler，抑制野值)，箱点在 (log t, log D) 中顺序扫描：
+ *    当前段以累加量 (Σx, Σy, Σx², Σxy, Σy²) 做最小二乘直线，新点偏离直线超过 max(0.05, 2.5·段内均方根) 时断开，
+ *    新段从上一个箱点开始 (相邻段首尾相接)；每个点只累加一次，划分代价 O(n)。
+ * 2. 斜率相近 (差值小于 0.15) 且类别相同的相邻段合并 (累加量直接相加)，再按上下文定类：
+ *    单位斜率出现在其他流动段之前为井筒储集，之后为封闭边界；径向流之前的陡降 (驼峰后段) 不记为定压边界。
+ * 3. 各段噪声用原始导数 (非分箱值) 相对该段直线的均方根偏差估计，原始数据按段的结束时间二分定位。
+ */
+
+#include "flowregime.h"
+#include "logbinsampler.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kBinsPerDecade = 10;         // 划分前每个对数周期的箱数
+const double kBreakTolerance = 0.05;   // 断开阈值下限 (log10 单位，约 12%)
+const double kMergeSlope = 0.15;       // 合并相邻段的斜率差上限
+const double kMinRegimeDecades = 0.25; // 短于该宽度的中间段记为过渡段
+const double kBoundaryWindow = 0.15;   // 流动段交界两侧的加密宽度 (对数周期)
+const double kBoundaryDensity = 3.0;   // 交界窗口的密度系数
+
+// 最小二乘直线的累加量
+struct LineSums {
+    double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0, syy = 0.0;
+
+    void add(double x, double y) {
+        n += 1.0; sx += x; sy += y; sxx += x * x; sxy += x * y; syy += y * y;
+    }
+    void merge(const LineSums& o) {
+        n += o.n; sx += o.sx; sy += o.sy; sxx += o.sxx; sxy += o.sxy; syy += o.syy;
+    }
+    double slope() const {
+        const double den = n * sxx - sx * sx;
+        return den > 1e-12 ? (n * sxy - sx * sy) / den : 0.0;
+    }
+    double intercept() const {
+        return n > 0.0 ? (sy - slope() * sx) / n : 0.0;
+    }
+    // 残差均方根 (自由度 n - 2)
+    double rms() const {
+        if (n < 3.0) return 0.0;
+        const double sse = syy - intercept() * sy - slope() * sxy;
+        return std::sqrt(qMax(0.0, sse) / (n - 2.0));
+    }
+};
+
+struct RawSegment {
+    int first;
+    int last;
+    LineSums sums;
+    FlowRegimeSegment::Regime regime;
+};
+
+FlowRegimeSegment::Regime classifySlope(double s, bool afterFlow, bool afterRadial)
+{
+    if (s >= 0.75) return afterFlow ? FlowRegimeSegment::ClosedBoundary : FlowRegimeSegment::WellboreStorage;
+    if (s >= 0.375) return FlowRegimeSegment::Linear;
+    if (s >= 0.125) return FlowRegimeSegment::Bilinear;
+    if (s > -0.2) return FlowRegimeSegment::Radial;
+    if (s > -0.75) return FlowRegimeSegment::Spherical;
+    return afterRadial ? FlowRegimeSegment::ConstantPressure : FlowRegimeSegment::Transition;
+}
+
+// 按上下文为各段定类
+void classify(QVector<RawSegment>& segments, const QVector<double>& x)
+{
+    bool afterFlow = false;
+    bool afterRadial = false;
+    for (int i = 0; i < segments.size(); ++i) {
+        RawSegment& s = segments[i];
+        s.regime = classifySlope(s.sums.slope(), afterFlow, afterRadial);
+        const bool inner = i > 0 && i + 1 < segments.size();
+        if (inner && x[s.last] - x[s.first] < kMinRegimeDecades) s.regime = FlowRegimeSegment::Transition;
+        if (s.regime != FlowRegimeSegment::WellboreStorage && s.regime != FlowRegimeSegment::Transition) afterFlow = true;
+        if (s.regime == FlowRegimeSegment::Radial) afterRadial = true;
+    }
+}
+
+// 合并相邻段：requireSlope 为真时还要求斜率相近
+QVector<RawSegment> mergeAdjacent(const QVector<RawSegment>& segments, bool requireSlope)
+{
+    QVector<RawSegment> merged;
+    for (const RawSegment& s : segments) {
+        if (!merged.isEmpty()) {
+            RawSegment& prev = merged.last();
+            const bool sameRegime = prev.regime == s.regime;
+            const bool closeSlope = std::abs(prev.sums.slope() - s.sums.slope()) < kMergeSlope;
+            if (sameRegime && (!requireSlope || closeSlope)) {
+                prev.last = s.last;
+                prev.sums.merge(s.sums);
+                continue;
+            }
+        }
+        merged.append(s);
+    }
+    return merged;
+}
+
+double densityOf(FlowRegimeSegment::Regime regime)
+{
+    switch (regime) {
+    case FlowRegimeSegment::Radial: return 0.5;
+    case FlowRegimeSegment::WellboreStorage: return 0.75;
+    case FlowRegimeSegment::Transition: return 2.5;
+    default: return 1.0;
+    }
+}
+
+} // namespace
+
+QVector<FlowRegimeSegment> FlowRegimeSegmenter::segment(const QVector<double>& t, const QVector<double>& d)
+{
+    QVector<FlowRegimeSegment> result;
+    const int n = qMin(t.size(), d.size());
+    double tMin = HUGE_VAL, tMax = 0.0;
+    for (int i = 0; i < n; ++i) {
+        if (!(t[i] > 0.0) || !(d[i] > 0.0) || !std::isfinite(t[i]) || !std::isfinite(d[i])) continue;
+        tMin = qMin(tMin, t[i]);
+        tMax = qMax(tMax, t[i]);
+    }
+    if (!(tMax > tMin)) return result;
+
+    const double decades = std::log10(tMax / tMin);
+    const int bins = qBound(8, int(std::ceil(decades * kBinsPerDecade)), 400);
+    QVector<double> binT, binD, unused;
+    LogBinSampler::sample(t, d, d, 0.0, HUGE_VAL, bins, LogBinSampler::Median, binT, unused, binD, 0, n);
+
+    QVector<double> x, y;
+    for (int i = 0; i < binT.size(); ++i) {
+        if (binD[i] <= 0.0) continue;
+        x.append(std::log10(binT[i]));
+        y.append(std::log10(binD[i]));
+    }
+    if (x.size() < 5) return result;
+
+    // 顺序扫描：新点偏离当前段直线过多时断开
+    QVector<RawSegment> segments;
+    RawSegment current{0, 0, LineSums(), FlowRegimeSegment::Transition};
+    current.sums.add(x[0], y[0]);
+    for (int k = 1; k < x.size(); ++k) {
+        if (current.sums.n >= 3.0) {
+            const double predicted = current.sums.intercept() + current.sums.slope() * x[k];
+            const double tolerance = qMax(kBreakTolerance, 2.5 * current.sums.rms());
+            if (std::abs(y[k] - predicted) > tolerance) {
+                segments.append(current);
+                current = RawSegment{k - 1, k - 1, LineSums(), FlowRegimeSegment::Transition};
+                current.sums.add(x[k - 1], y[k - 1]);
+            }
+        }
+        current.sums.add(x[k], y[k]);
+        current.last = k;
+    }
+    segments.append(current);
+
+    classify(segments, x);
+    segments = mergeAdjacent(segments, true);
+    classify(segments, x);
+    segments = mergeAdjacent(segments, false);
+
+    result.resize(segments.size());
+    for (int i = 0; i < segments.size(); ++i) {
+        FlowRegimeSegment& out = result[i];
+        out.tStart = (i == 0) ? tMin : std::pow(10.0, x[segments[i].first]);
+        out.tEnd = (i + 1 == segments.size()) ? tMax : std::pow(10.0, x[segments[i].last]);
+        out.slope = segments[i].sums.slope();
+        out.regime = segments[i].regime;
+    }
+
+    // 原始导数相对各段直线的偏差
+    QVector<double> ss(result.size(), 0.0);
+    QVector<int> counts(result.size(), 0);
+    for (int i = 0; i < n; ++i) {
+        if (!(t[i] > 0.0) || !(d[i] > 0.0) || !std::isfinite(t[i]) || !std::isfinite(d[i])) continue;
+        auto it = std::lower_bound(result.begin(), result.end(), t[i],
+                                   [](const FlowRegimeSegment& s, double v) { return s.tEnd < v; });
+        if (it == result.end()) continue;
+        const int j = int(it - result.begin());
+        const double xi = std::log10(t[i]);
+        const double r = std::log10(d[i]) - (segments[j].sums.intercept() + segments[j].sums.slope() * xi);
+        ss[j] += r * r;
+        ++counts[j];
+    }
+    QVector<double> noises;
+    for (int j = 0; j < result.size(); ++j) {
+        result[j].noise = counts[j] > 0 ? std::sqrt(ss[j] / counts[j]) : 0.0;
+        if (result[j].noise > 0.0) noises.append(result[j].noise);
+    }
+
+    // 参考噪声取各段中值，噪声大的段降权、安静的段升权
+    if (!noises.isEmpty()) {
+        std::nth_element(noises.begin(), noises.begin() + noises.size() / 2, noises.end());
+        const double reference = noises[noises.size() / 2];
+        for (FlowRegimeSegment& s : result)
+            s.weight = qBound(0.25, reference / qMax(s.noise, 1e-3), 2.0);
+    }
+    return result;
+}
+
+QList<SamplingInterval> FlowRegimeSegmenter::samplingIntervals(const QVector<FlowRegimeSegment>& segments, int totalPoints)
+{
+    struct Piece { double a, b, density; };
+    QVector<Piece> pieces;
+    for (int i = 0; i < segments.size(); ++i) {
+        const double la = std::log10(segments[i].tStart);
+        const double lb = std::log10(segments[i].tEnd);
+        const double span = lb - la;
+        if (!(span > 0.0)) continue;
+        const double hl = (i > 0) ? qMin(kBoundaryWindow, span / 2) : 0.0;
+        const double hr = (i + 1 < segments.size()) ? qMin(kBoundaryWindow, span / 2) : 0.0;
+        if (hl > 0.0) pieces.append({la, la + hl, kBoundaryDensity});
+        if (la + hl < lb - hr) pieces.append({la + hl, lb - hr, densityOf(segments[i].regime)});
+        if (hr > 0.0) pieces.append({lb - hr, lb, kBoundaryDensity});
+    }
+
+    QList<SamplingInterval> intervals;
+    double total = 0.0;
+    for (const Piece& p : pieces) total += p.density * (p.b - p.a);
+    if (!(total > 0.0)) return intervals;
+
+    for (const Piece& p : pieces) {
+        const int count = qMax(2, qRound(totalPoints * p.density * (p.b - p.a) / total));
+        intervals.append({std::pow(10.0, p.a), std::pow(10.0, p.b), count});
+    }
+    return intervals;
+}
+
+double FlowRegimeSegmenter::weightAt(const QVector<FlowRegimeSegment>& segments, double t)
+{
+    if (segments.isEmpty() || t < segments.first().tStart) return 1.0;
+    auto it = std::lower_bound(segments.begin(), segments.end(), t,
+                               [](const FlowRegimeSegment& s, double v) { return s.tEnd < v; });
+    return it == segments.end() ? 1.0 : it->weight;
+}
+
+QString FlowRegimeSegmenter::regimeName(FlowRegimeSegment::Regime regime)
+{
+    switch (regime) {
+    case FlowRegimeSegment::WellboreStorage: return QStringLiteral("井筒储集");
+    case FlowRegimeSegment::Bilinear: return QStringLiteral("双线性流");
+    case FlowRegimeSegment::Linear: return QStringLiteral("线性流");
+    case FlowRegimeSegment::Radial: return QStringLiteral("径向流");
+    case FlowRegimeSegment::Spherical: return QStringLiteral("球形流");
+    case FlowRegimeSegment::ClosedBoundary: return QStringLiteral("封闭边界");
+    case FlowRegimeSegment::ConstantPressure: return QStringLiteral("定压边界");
+    case FlowRegimeSegment::Transition: return QStringLiteral("过渡段");
+    }
+    return QString();
+}
@@ -0,0 +1,59 @@
+/*
+ * 文件名: flowregime.h
+ * 文件作用: 观测导数的流动段自动划分头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 在双对数坐标下把观测 Bourdet 导数划分为若干直线段 (O(n))，按斜率识别流动段：
+ *    井筒储集 / 拟稳态边界 (斜率 1)、线性流 (1/2)、双线性流 (1/4)、径向流 (0)、球形流 (-1/2)、定压边界 (明显为负)，
+ *    持续不足 0.25 个对数周期且夹在两个不同流动段之间的短段记为过渡段。
+ * 2. samplingIntervals 由划分结果生成抽样区间：流动段交界两侧 ±0.15 个对数周期内加密，
+ *    过渡段次之，径向流等平台段稀疏，总点数按各区间的对数宽度与密度系数分配。
+ * 3. 各段权重为参考噪声 (各段噪声的中值) 与该段噪声之比，截断到 [0.25, 2]：噪声大的段 (通常是晚期) 降权，
+ *    只作用于导数残差；weightAt 按时间查找所在段的权重，不在任何段内时为 1。
+ */
+
+#ifndef FLOWREGIME_H
+#define FLOWREGIME_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "fittingsampling.h"
+
+// 流动段
+struct FlowRegimeSegment {
+    enum Regime {
+        WellboreStorage = 0,  // 井筒储集 (早期单位斜率)
+        Bilinear,             // 双线性流 (斜率 1/4)
+        Linear,               // 线性流 (斜率 1/2)
+        Radial,               // 径向流 (导数平台)
+        Spherical,            // 球形流 (斜率 -1/2)
+        ClosedBoundary,       // 拟稳态 / 封闭边界 (晚期单位斜率)
+        ConstantPressure,     // 定压边界 (导数快速下降)
+        Transition            // 过渡段
+    };
+
+    double tStart = 0.0;      // 起始时间
+    double tEnd = 0.0;        // 结束时间
+    double slope = 0.0;       // 双对数斜率 d(log D)/d(log t)
+    double noise = 0.0;       // 原始导数相对该段直线的均方根偏差 (log10 单位)
+    Regime regime = Transition;
+    double weight = 1.0;      // 导数残差权重
+};
+
+class FlowRegimeSegmenter
+{
+public:
+    // 划分观测导数 (时间非正、导数非正或非有限的样本不参与)；有效数据不足时返回空列表
+    static QVector<FlowRegimeSegment> segment(const QVector<double>& t, const QVector<double>& d);
+
+    // 由划分结果生成抽样区间，总点数约为 totalPoints (每个区间至少 2 点)；划分为空时返回空列表
+    static QList<SamplingInterval> samplingIntervals(const QVector<FlowRegimeSegment>& segments, int totalPoints);
+
+    // t 所在段的导数残差权重
+    static double weightAt(const QVector<FlowRegimeSegment>& segments, double t);
+
+    // 流动段名称 (用于日志与界面显示)
+    static QString regimeName(FlowRegimeSegment::Regime regime);
+};
+
+#endif // FLOWREGIME_H
@@ -0,0 +1,428 @@
+/*
+ * 文件名: gaugemonitordialog.cpp
+ * 文件作用: 实时压力计监测对话框实现文件
+ * 功能描述:
+ * 1. 界面由代码构建：上部为数据源与分析设置，中部为双对数图 (压差与导数) 和原始记录表，下部为状态与操作按钮。
+ * 2. 每批数据只把受影响的末尾交给曲线 (压差从新点开始，导数从 GaugeSeries::append 返回的下标开始)，
+ *    坐标范围按新增部分扩展，不遍历全部数据。
+ * 3. 滚动拟合的任务由目标页签的 createFittingJob 生成 (当前模型、参数、权重与抽样设置)，
+ *    拟合核心的配置与批量拟合队列相同；迭代与结束信号以队列连接回到界面线程。
+ */
+
+#include "gaugemonitordialog.h"
+#include "wt_fittingwidget.h"
+#include "fittingcore.h"
+#include "modelmanager.h"
+#include "columnartablemodel.h"
+#include "graphlod.h"
+#include "qcustomplot.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QGroupBox>
+#include <QTabWidget>
+#include <QTableView>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QCloseEvent>
+#include <QDateTime>
+#include <QSettings>
+#include <cmath>
+
+GaugeMonitorDialog::GaugeMonitorDialog(ModelManager* modelManager, FittingWidget* target, const QString& analysisName,
+                                       QWidget* parent)
+    : QDialog(parent), m_modelManager(modelManager), m_target(target), m_analysisName(analysisName)
+{
+    setWindowTitle(QString("实时监测 - %1").arg(analysisName));
+    resize(900, 680);
+
+    m_store = new ColumnarTableModel(this);
+    m_reader = new GaugeStreamReader(this);
+    m_reader->setStore(m_store);
+    connect(m_reader, &GaugeStreamReader::batchAppended, this, &GaugeMonitorDialog::onBatch);
+    connect(m_reader, &GaugeStreamReader::sourceReset, this, &GaugeMonitorDialog::onSourceReset);
+    connect(m_reader, &GaugeStreamReader::sourceError, this, &GaugeMonitorDialog::onSourceError);
+    connect(&m_refitTimer, &QTimer::timeout, this, &GaugeMonitorDialog::onRefitTimer);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // 1. 数据源
+    QGroupBox* grpSource = new QGroupBox("数据源", this);
+    QGridLayout* sourceLayout = new QGridLayout(grpSource);
+    m_comboSource = new QComboBox(grpSource);
+    m_comboSource->addItem("数据文件 (持续追加)", GaugeStreamReader::SourceFile);
+    m_comboSource->addItem("TCP 数据流", GaugeStreamReader::SourceTcp);
+    m_editPath = new QLineEdit(grpSource);
+    m_btnBrowse = new QPushButton("浏览...", grpSource);
+    m_editHost = new QLineEdit(grpSource);
+    m_spinPort = new QSpinBox(grpSource);
+    m_spinPort->setRange(1, 65535);
+    m_spinTimeColumn = new QSpinBox(grpSource);
+    m_spinTimeColumn->setRange(1, 64);
+    m_spinPressureColumn = new QSpinBox(grpSource);
+    m_spinPressureColumn->setRange(1, 64);
+    m_spinSkipRows = new QSpinBox(grpSource);
+    m_spinSkipRows->setRange(0, 1000);
+    m_spinPollMs = new QSpinBox(grpSource);
+    m_spinPollMs->setRange(100, 60000);
+    m_spinPollMs->setSingleStep(100);
+    m_spinPollMs->setSuffix(" ms");
+    sourceLayout->addWidget(new QLabel("类型:", grpSource), 0, 0);
+    sourceLayout->addWidget(m_comboSource, 0, 1);
+    sourceLayout->addWidget(new QLabel("文件:", grpSource), 0, 2);
+    sourceLayout->addWidget(m_editPath, 0, 3, 1, 3);
+    sourceLayout->addWidget(m_btnBrowse, 0, 6);
+    sourceLayout->addWidget(new QLabel("主机:", grpSource), 1, 0);
+    sourceLayout->addWidget(m_editHost, 1, 1);
+    sourceLayout->addWidget(new QLabel("端口:", grpSource), 1, 2);
+    sourceLayout->addWidget(m_spinPort, 1, 3);
+    sourceLayout->addWidget(new QLabel("轮询间隔:", grpSource), 1, 4);
+    sourceLayout->addWidget(m_spinPollMs, 1, 5);
+    sourceLayout->addWidget(new QLabel("时间列:", grpSource), 2, 0);
+    sourceLayout->addWidget(m_spinTimeColumn, 2, 1);
+    sourceLayout->addWidget(new QLabel("压力列:", grpSource), 2, 2);
+    sourceLayout->addWidget(m_spinPressureColumn, 2, 3);
+    sourceLayout->addWidget(new QLabel("跳过表头行:", grpSource), 2, 4);
+    sourceLayout->addWidget(m_spinSkipRows, 2, 5);
+    mainLayout->addWidget(grpSource);
+
+    // 2. 分析与滚动拟合
+    QGroupBox* grpAnalysis = new QGroupBox("分析与滚动拟合", this);
+    QGridLayout* analysisLayout = new QGridLayout(grpAnalysis);
+    m_comboTestType = new QComboBox(grpAnalysis);
+    m_comboTestType->addItem("压力降落", GaugeSeries::Drawdown);
+    m_comboTestType->addItem("压力恢复", GaugeSeries::Buildup);
+    m_spinInitialPressure = new QDoubleSpinBox(grpAnalysis);
+    m_spinInitialPressure->setRange(0.0, 1000.0);
+    m_spinInitialPressure->setDecimals(4);
+    m_spinInitialPressure->setSuffix(" MPa");
+    m_spinLSpacing = new QDoubleSpinBox(grpAnalysis);
+    m_spinLSpacing->setRange(0.0, 1.0);
+    m_spinLSpacing->setDecimals(3);
+    m_spinLSpacing->setSingleStep(0.05);
+    m_spinRefitMinutes = new QSpinBox(grpAnalysis);
+    m_spinRefitMinutes->setRange(1, 1440);
+    m_spinRefitMinutes->setSuffix(" 分钟");
+    m_chkAutoRefit = new QCheckBox("自动滚动拟合", grpAnalysis);
+    analysisLayout->addWidget(new QLabel("试井类型:", grpAnalysis), 0, 0);
+    analysisLayout->addWidget(m_comboTestType, 0, 1);
+    analysisLayout->addWidget(new QLabel("初始压力:", grpAnalysis), 0, 2);
+    analysisLayout->addWidget(m_spinInitialPressure, 0, 3);
+    analysisLayout->addWidget(new QLabel("L-Spacing:", grpAnalysis), 0, 4);
+    analysisLayout->addWidget(m_spinLSpacing, 0, 5);
+    analysisLayout->addWidget(m_chkAutoRefit, 1, 0, 1, 2);
+    analysisLayout->addWidget(new QLabel("拟合间隔:", grpAnalysis), 1, 2);
+    analysisLayout->addWidget(m_spinRefitMinutes, 1, 3);
+    mainLayout->addWidget(grpAnalysis);
+
+    // 3. 曲线与原始记录
+    QTabWidget* tabs = new QTabWidget(this);
+    m_plot = new QCustomPlot(tabs);
+    m_plot->xAxis->setLabel("时间 Time (h)");
+    m_plot->yAxis->setLabel("压差 & 导数 (MPa)");
+    for (QCPAxis* axis : { m_plot->xAxis, m_plot->yAxis }) {
+        QSharedPointer<QCPAxisTickerLog> logTicker(new QCPAxisTickerLog);
+        logTicker->setLogBase(10.0);
+        axis->setTicker(logTicker);
+        axis->setScaleType(QCPAxis::stLogarithmic);
+        axis->setNumberFormat("eb");
+        axis->setNumberPrecision(1);
+    }
+    m_plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    m_plot->legend->setVisible(true);
+    m_graphDeltaP = m_plot->addGraph();
+    m_graphDeltaP->setName("压差");
+    m_graphDeltaP->setLineStyle(QCPGraph::lsNone);
+    m_graphDeltaP->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(0, 100, 255), 4));
+    m_graphDerivative = m_plot->addGraph();
+    m_graphDerivative->setName("导数");
+    m_graphDerivative->setLineStyle(QCPGraph::lsNone);
+    m_graphDerivative->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, QColor(255, 100, 0), 4));
+    tabs->addTab(m_plot, "双对数曲线");
+
+    QTableView* tableView = new QTableView(tabs);
+    tableView->setModel(m_store);
+    tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    tabs->addTab(tableView, "原始记录");
+    mainLayout->addWidget(tabs, 1);
+
+    // 4. 状态与操作按钮
+    m_lblStatus = new QLabel(this);
+    m_lblFit = new QLabel(this);
+    mainLayout->addWidget(m_lblStatus);
+    mainLayout->addWidget(m_lblFit);
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    m_btnStartStop = new QPushButton("开始监测", this);
+    m_btnRefitNow = new QPushButton("立即拟合", this);
+    QPushButton* btnClose = new QPushButton("关闭", this);
+    buttonLayout->addWidget(m_btnStartStop);
+    buttonLayout->addWidget(m_btnRefitNow);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(btnClose);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(m_comboSource, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &GaugeMonitorDialog::onSourceTypeChanged);
+    connect(m_btnBrowse, &QPushButton::clicked, this, &GaugeMonitorDialog::onBrowse);
+    connect(m_btnStartStop, &QPushButton::clicked, this, &GaugeMonitorDialog::onStartStop);
+    connect(m_btnRefitNow, &QPushButton::clicked, this, &GaugeMonitorDialog::onRefitNow);
+    connect(btnClose, &QPushButton::clicked, this, &QDialog::close);
+    connect(m_chkAutoRefit, &QCheckBox::toggled, this, [this](bool on) {
+        if (on && m_reader->isRunning()) m_refitTimer.start(m_spinRefitMinutes->value() * 60000);
+        else m_refitTimer.stop();
+    });
+    connect(m_spinRefitMinutes, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int minutes) {
+        if (m_refitTimer.isActive()) m_refitTimer.start(minutes * 60000);
+    });
+
+    loadSettings();
+    onSourceTypeChanged();
+    setMonitoring(false);
+    updateStatus();
+    m_lblFit->setText(m_target ? QString("滚动拟合目标: %1").arg(m_analysisName) : "没有目标分析页签，只显示数据");
+}
+
+GaugeMonitorDialog::~GaugeMonitorDialog()
+{
+    m_reader->stop();
+    if (m_core) {
+        m_core->stopFit();
+        m_core->waitForFinished();
+    }
+}
+
+void GaugeMonitorDialog::closeEvent(QCloseEvent* event)
+{
+    saveSettings();
+    m_reader->stop();
+    m_refitTimer.stop();
+    if (m_core) m_core->stopFit();
+    QDialog::closeEvent(event);
+}
+
+void GaugeMonitorDialog::loadSettings()
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    m_comboSource->setCurrentIndex(m_comboSource->findData(settings.value("monitor/sourceType", 0).toInt()));
+    m_editPath->setText(settings.value("monitor/filePath").toString());
+    m_editHost->setText(settings.value("monitor/host", "127.0.0.1").toString());
+    m_spinPort->setValue(settings.value("monitor/port", 5020).toInt());
+    m_spinTimeColumn->setValue(settings.value("monitor/timeColumn", 1).toInt());
+    m_spinPressureColumn->setValue(settings.value("monitor/pressureColumn", 2).toInt());
+    m_spinSkipRows->setValue(settings.value("monitor/skipRows", 1).toInt());
+    m_spinPollMs->setValue(settings.value("monitor/pollIntervalMs", 1000).toInt());
+    m_comboTestType->setCurrentIndex(m_comboTestType->findData(settings.value("monitor/testType", 0).toInt()));
+    m_spinInitialPressure->setValue(settings.value("monitor/initialPressure", 20.0).toDouble());
+    m_spinLSpacing->setValue(settings.value("monitor/lSpacing", 0.1).toDouble());
+    m_spinRefitMinutes->setValue(settings.value("monitor/refitMinutes", 5).toInt());
+    m_chkAutoRefit->setChecked(settings.value("monitor/autoRefit", true).toBool());
+}
+
+void GaugeMonitorDialog::saveSettings() const
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    settings.setValue("monitor/sourceType", m_comboSource->currentData().toInt());
+    settings.setValue("monitor/filePath", m_editPath->text());
+    settings.setValue("monitor/host", m_editHost->text());
+    settings.setValue("monitor/port", m_spinPort->value());
+    settings.setValue("monitor/timeColumn", m_spinTimeColumn->value());
+    settings.setValue("monitor/pressureColumn", m_spinPressureColumn->value());
+    settings.setValue("monitor/skipRows", m_spinSkipRows->value());
+    settings.setValue("monitor/pollIntervalMs", m_spinPollMs->value());
+    settings.setValue("monitor/testType", m_comboTestType->currentData().toInt());
+    settings.setValue("monitor/initialPressure", m_spinInitialPressure->value());
+    settings.setValue("monitor/lSpacing", m_spinLSpacing->value());
+    settings.setValue("monitor/refitMinutes", m_spinRefitMinutes->value());
+    settings.setValue("monitor/autoRefit", m_chkAutoRefit->isChecked());
+}
+
+void GaugeMonitorDialog::onSourceTypeChanged()
+{
+    const bool file = m_comboSource->currentData().toInt() == GaugeStreamReader::SourceFile;
+    m_editPath->setEnabled(file && !m_reader->isRunning());
+    m_btnBrowse->setEnabled(file && !m_reader->isRunning());
+    m_spinSkipRows->setEnabled(file && !m_reader->isRunning());
+    m_editHost->setEnabled(!file && !m_reader->isRunning());
+    m_spinPort->setEnabled(!file && !m_reader->isRunning());
+}
+
+void GaugeMonitorDialog::onBrowse()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "选择压力计数据文件", m_editPath->text(),
+                                                      "数据文件 (*.csv *.txt *.dat);;所有文件 (*.*)");
+    if (!path.isEmpty()) m_editPath->setText(path);
+}
+
+void GaugeMonitorDialog::setMonitoring(bool monitoring)
+{
+    m_btnStartStop->setText(monitoring ? "停止监测" : "开始监测");
+    for (QWidget* w : std::initializer_list<QWidget*>{ m_comboSource, m_spinTimeColumn, m_spinPressureColumn, m_spinPollMs,
+                                                       m_comboTestType, m_spinInitialPressure, m_spinLSpacing })
+        w->setEnabled(!monitoring);
+    onSourceTypeChanged();
+    if (monitoring && m_chkAutoRefit->isChecked()) m_refitTimer.start(m_spinRefitMinutes->value() * 60000);
+    else m_refitTimer.stop();
+}
+
+void GaugeMonitorDialog::onStartStop()
+{
+    if (m_reader->isRunning()) {
+        m_reader->stop();
+        setMonitoring(false);
+        updateStatus();
+        return;
+    }
+
+    saveSettings();
+    onSourceReset();
+
+    GaugeStreamReader::Settings settings;
+    settings.type = GaugeStreamReader::SourceType(m_comboSource->currentData().toInt());
+    settings.filePath = m_editPath->text();
+    settings.host = m_editHost->text();
+    settings.port = m_spinPort->value();
+    settings.timeColumn = m_spinTimeColumn->value() - 1;
+    settings.pressureColumn = m_spinPressureColumn->value() - 1;
+    settings.skipRows = m_spinSkipRows->value();
+    settings.pollIntervalMs = m_spinPollMs->value();
+    // start 中的首次轮询可能已发出数据，界面状态先切换
+    setMonitoring(true);
+    if (!m_reader->start(settings)) {
+        setMonitoring(false); // 错误信息已由 onSourceError 显示
+        return;
+    }
+    updateStatus();
+}
+
+void GaugeMonitorDialog::onSourceReset()
+{
+    m_series.reset(GaugeSeries::TestType(m_comboTestType->currentData().toInt()), m_spinInitialPressure->value(),
+                   m_spinLSpacing->value());
+    m_fittedSize = 0;
+    m_yMin = m_yMax = 0.0;
+    m_store->clear();
+    GraphLod::setGraphData(m_graphDeltaP, QVector<double>(), QVector<double>());
+    GraphLod::setGraphData(m_graphDerivative, QVector<double>(), QVector<double>());
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void GaugeMonitorDialog::onSourceError(QString message)
+{
+    m_lblStatus->setText(message);
+    if (!m_reader->isRunning()) setMonitoring(false);
+}
+
+void GaugeMonitorDialog::onBatch(QVector<double> time, QVector<double> pressure)
+{
+    const int n0 = m_series.size();
+    const int from = m_series.append(time, pressure);
+    if (from >= 0) updatePlot(n0, from);
+    updateStatus();
+}
+
+void GaugeMonitorDialog::updatePlot(int firstDeltaP, int firstDerivative)
+{
+    const QVector<double>& t = m_series.time();
+    if (!GraphLod::updateTail(m_graphDeltaP, firstDeltaP, t, m_series.deltaP()))
+        GraphLod::setGraphData(m_graphDeltaP, t, m_series.deltaP());
+    if (!GraphLod::updateTail(m_graphDerivative, firstDerivative, t, m_series.derivative()))
+        GraphLod::setGraphData(m_graphDerivative, t, m_series.derivative());
+
+    // 坐标范围：横轴到最新时间，纵轴按改变部分的正值扩展
+    auto extend = [this](const QVector<double>& values, int from) {
+        for (int i = from; i < values.size(); ++i) {
+            const double v = values[i];
+            if (!(v > 0.0) || !std::isfinite(v)) continue;
+            if (m_yMin <= 0.0 || v < m_yMin) m_yMin = v;
+            if (v > m_yMax) m_yMax = v;
+        }
+    };
+    extend(m_series.deltaP(), firstDeltaP);
+    extend(m_series.derivative(), firstDerivative);
+    if (!t.isEmpty()) m_plot->xAxis->setRange(t.first() / 2.0, t.last() * 2.0);
+    if (m_yMin > 0.0) m_plot->yAxis->setRange(m_yMin / 2.0, m_yMax * 2.0);
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void GaugeMonitorDialog::updateStatus()
+{
+    QString text = QString("%1  已接收 %2 行，有效数据点 %3 个")
+                       .arg(m_reader->isRunning() ? "监测中" : "已停止")
+                       .arg(m_reader->rowsReceived())
+                       .arg(m_series.size());
+    if (!m_series.isEmpty()) text += QString("，最新时间 %1 h").arg(m_series.time().last(), 0, 'g', 6);
+    m_lblStatus->setText(text);
+    m_btnRefitNow->setEnabled(m_target && !m_core && m_series.size() >= 3);
+}
+
+void GaugeMonitorDialog::onRefitTimer()
+{
+    startRefit(false);
+}
+
+void GaugeMonitorDialog::onRefitNow()
+{
+    startRefit(true);
+}
+
+void GaugeMonitorDialog::startRefit(bool manual)
+{
+    if (m_core || !m_modelManager) return;
+    if (!m_target) {
+        m_lblFit->setText("目标分析页签已关闭，滚动拟合停止");
+        m_refitTimer.stop();
+        return;
+    }
+    if (m_series.size() < 3 || (!manual && m_series.size() == m_fittedSize)) return;
+    if (m_target->isFitting()) {
+        m_lblFit->setText(QString("%1 页签正在拟合，本次滚动拟合跳过").arg(m_analysisName));
+        return;
+    }
+
+    // 页签的当前参数即上次滚动拟合的结果，作为本次的初值
+    m_target->setObservedDataset(m_series.dataset());
+    FittingJob job;
+    if (!m_target->createFittingJob(m_target->currentModelType(), job)) return;
+    job.analysisName = m_analysisName;
+    m_job = job;
+    m_fittedSize = m_series.size();
+
+    m_core = new FittingCore(this);
+    m_core->setModelEngine(m_modelManager->engine());
+    m_core->setObservedDataset(job.observed);
+    if (!job.rateHistory.isEmpty()) m_core->setRateHistory(job.rateHistory, job.rateHistoryBuildup);
+    m_core->setSamplingSettings(job.samplingIntervals, job.customSampling);
+    m_core->setSamplingMode(job.samplingMode);
+    m_core->setReproducibility(job.reproducibility);
+    m_core->setPreviewPolicy(m_core->previewInterval(), true);
+    connect(m_core, &FittingCore::sigIterationUpdated, this,
+            [this](double err, QMap<QString, double> params, QVector<double>, QVector<double>, QVector<double>) {
+                m_job.mse = err;
+                m_job.result = params;
+            }, Qt::QueuedConnection);
+    connect(m_core, &FittingCore::sigFitFinished, this, &GaugeMonitorDialog::onRefitFinished, Qt::QueuedConnection);
+
+    m_lblFit->setText(QString("%1 开始滚动拟合 (%2 个数据点)...")
+                          .arg(QDateTime::currentDateTime().toString("hh:mm:ss")).arg(m_fittedSize));
+    updateStatus();
+    if (!m_core->startFit(job.modelType, job.params, job.weight)) onRefitFinished();
+}
+
+void GaugeMonitorDialog::onRefitFinished()
+{
+    // 无拟合参数时 FittingCore 会额外发出一次结束信号，重复的通知直接忽略
+    if (!m_core || m_core->isRunning()) return;
+    m_core->deleteLater();
+    m_core = nullptr;
+
+    if (m_target && !m_job.result.isEmpty()) {
+        m_target->applyFittingResult(m_job);
+        m_lblFit->setText(QString("%1 滚动拟合完成：%2 个数据点，MSE = %3")
+                              .arg(QDateTime::currentDateTime().toString("hh:mm:ss"))
+                              .arg(m_fittedSize).arg(m_job.mse, 0, 'g', 6));
+    } else {
+        m_lblFit->setText("滚动拟合没有结果 (目标页签已关闭或没有拟合参数)");
+    }
+    updateStatus();
+}
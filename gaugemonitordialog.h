@@ -0,0 +1,107 @@
+/*
+ * 文件名: gaugemonitordialog.h
+ * 文件作用: 实时压力计监测对话框头文件
+ * 功能描述:
+ * 1. 从持续增长的数据文件或 TCP 数据流接收压力计读数 (GaugeStreamReader)，原始记录追加到按列存储的记录表。
+ * 2. 每批数据追加到 GaugeSeries：压差与 Bourdet 导数只在末尾受影响的范围内重算，
+ *    双对数图经 GraphLod::updateTail 增量更新 (点数很多时抽稀金字塔同样只重算末尾)。
+ * 3. [滚动拟合] 按设定的间隔 (默认 5 分钟) 把当前序列设为目标分析页签的观测数据，并以页签的当前参数为初值在后台重新拟合；
+ *    结果写回页签，成为下一次拟合的初值 (热启动)。页签正在手动拟合、上次拟合未结束或没有新数据时跳过本次。
+ * 4. 对话框为非模态，关闭时停止数据接收并等待后台拟合结束；目标页签被删除后只继续接收与显示数据。
+ * 5. 数据源、列号、试井类型与拟合间隔保存在设置项 monitor/* 中。
+ */
+
+#ifndef GAUGEMONITORDIALOG_H
+#define GAUGEMONITORDIALOG_H
+
+#include <QDialog>
+#include <QPointer>
+#include <QTimer>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include "gaugeseries.h"
+#include "gaugestreamreader.h"
+#include "fittingjobqueue.h"
+
+class QCustomPlot;
+class QCPGraph;
+class FittingCore;
+class FittingWidget;
+class ModelManager;
+class ColumnarTableModel;
+
+class GaugeMonitorDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    GaugeMonitorDialog(ModelManager* modelManager, FittingWidget* target, const QString& analysisName,
+                       QWidget* parent = nullptr);
+    ~GaugeMonitorDialog();
+
+protected:
+    void closeEvent(QCloseEvent* event) override;
+
+private slots:
+    void onStartStop();
+    void onBrowse();
+    void onSourceTypeChanged();
+    void onBatch(QVector<double> time, QVector<double> pressure);
+    void onSourceReset();
+    void onSourceError(QString message);
+    void onRefitTimer();
+    void onRefitNow();
+    void onRefitFinished();
+
+private:
+    ModelManager* m_modelManager;
+    QPointer<FittingWidget> m_target;
+    QString m_analysisName;
+
+    GaugeStreamReader* m_reader;
+    ColumnarTableModel* m_store;
+    GaugeSeries m_series;
+    QTimer m_refitTimer;
+
+    FittingCore* m_core = nullptr; // 正在进行的滚动拟合
+    FittingJob m_job;
+    int m_fittedSize = 0;          // 上次拟合时的数据点数
+    double m_yMin = 0.0;           // 图中纵坐标范围 (只增不减)
+    double m_yMax = 0.0;
+
+    QComboBox* m_comboSource;
+    QLineEdit* m_editPath;
+    QPushButton* m_btnBrowse;
+    QLineEdit* m_editHost;
+    QSpinBox* m_spinPort;
+    QSpinBox* m_spinTimeColumn;
+    QSpinBox* m_spinPressureColumn;
+    QSpinBox* m_spinSkipRows;
+    QSpinBox* m_spinPollMs;
+    QComboBox* m_comboTestType;
+    QDoubleSpinBox* m_spinInitialPressure;
+    QDoubleSpinBox* m_spinLSpacing;
+    QSpinBox* m_spinRefitMinutes;
+    QCheckBox* m_chkAutoRefit;
+    QPushButton* m_btnStartStop;
+    QPushButton* m_btnRefitNow;
+    QLabel* m_lblStatus;
+    QLabel* m_lblFit;
+    QCustomPlot* m_plot;
+    QCPGraph* m_graphDeltaP;
+    QCPGraph* m_graphDerivative;
+
+    void loadSettings();
+    void saveSettings() const;
+    void setMonitoring(bool monitoring);
+    void updatePlot(int firstDeltaP, int firstDerivative);
+    void updateStatus();
+    // 开始一次滚动拟合 (manual 为真时即使没有新数据也拟合)
+    void startRefit(bool manual);
+};
+
+#endif // GAUGEMONITORDIALOG_H
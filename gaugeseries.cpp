@@ -0,0 +1,60 @@
+/*
+ * 文件名: gaugeseries.cpp
+ * 文件作用: 实时压力计数据序列实现文件
+ * 功能描述:
+ * 1. 追加的新点相当于 "修改了 [n0, n-1] 的压降"：affectedRange 给出受影响的下标范围
+ *    (末尾 L 个对数周期内原来没有右选点、或单侧差商用到末点的旧点，以及全部新点)，derivativeRange 只在该范围附近求值。
+ * 2. 恢复试井的参考压力为序列首点，首批到达前无法计算压差。
+ */
+
+#include "gaugeseries.h"
+#include "bourdetderivative.h"
+#include "tracing.h"
+
+#include <cmath>
+
+GaugeSeries::GaugeSeries()
+    : m_type(Drawdown), m_initialPressure(0.0), m_lSpacing(0.1)
+{
+}
+
+void GaugeSeries::reset(TestType type, double initialPressure, double lSpacing)
+{
+    m_type = type;
+    m_initialPressure = initialPressure;
+    m_lSpacing = lSpacing;
+    m_time.clear();
+    m_pressure.clear();
+    m_deltaP.clear();
+    m_derivative.clear();
+}
+
+int GaugeSeries::append(const QVector<double>& t, const QVector<double>& p)
+{
+    WT_TRACE_SCOPE("GaugeSeries::append");
+    const int n0 = m_time.size();
+    const int count = qMin(t.size(), p.size());
+    for (int i = 0; i < count; ++i) {
+        if (!std::isfinite(t[i]) || !std::isfinite(p[i]) || t[i] <= 0.0) continue;
+        if (!m_time.isEmpty() && t[i] <= m_time.last()) continue;
+        m_time.append(t[i]);
+        m_pressure.append(p[i]);
+        const double reference = (m_type == Drawdown) ? m_initialPressure : m_pressure.first();
+        m_deltaP.append(std::abs(reference - p[i]));
+    }
+    const int n = m_time.size();
+    if (n == n0) return -1;
+
+    // 导数：只重算选点可能落到新点上的范围
+    m_derivative.resize(n);
+    int from = 0, to = n - 1;
+    BourdetDerivativeEngine::affectedRange(m_time, m_lSpacing, n0, n - 1, from, to);
+    const QVector<double> d = BourdetDerivativeEngine::derivativeRange(m_time, m_deltaP, m_lSpacing, from, n - 1);
+    for (int i = 0; i < d.size(); ++i) m_derivative[from + i] = d[i];
+    return from;
+}
+
+ObservedDataset::Handle GaugeSeries::dataset() const
+{
+    return ObservedDataset::create(m_time, m_deltaP, m_derivative, m_pressure);
+}
@@ -0,0 +1,58 @@
+/*
+ * 文件名: gaugeseries.h
+ * 文件作用: 实时压力计数据序列头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 保存实时监测中持续增长的 (t, p) 序列及其压差 Δp 与 Bourdet 导数，按批追加。
+ * 2. 压差按试井类型计算：降落试井 |p_i - p|，恢复试井 |p - p(首点)| (与加载观测数据的规则相同)。
+ * 3. 追加时只计算新点的压差；导数只在 L-Spacing 选点可能落到新点上的范围内重新计算
+ *    (BourdetDerivativeEngine::affectedRange / derivativeRange)，结果与整体计算逐位相同，代价与批大小及末尾 L 个对数周期内的点数成正比。
+ * 4. 时间须严格递增：非正时间、非有限值与不晚于末点的时间被丢弃 (压力计重发的重复记录等)。
+ * 5. dataset() 给出当前序列的观测数据集快照，供拟合核心与分析页签使用。
+ */
+
+#ifndef GAUGESERIES_H
+#define GAUGESERIES_H
+
+#include <QVector>
+#include "observeddataset.h"
+
+class GaugeSeries
+{
+public:
+    enum TestType {
+        Drawdown = 0, // 压降：Δp = |p_i - p|
+        Buildup = 1   // 恢复：Δp = |p - p(首点)|
+    };
+
+    GaugeSeries();
+
+    // 清空序列并设置试井类型、初始压力 (降落试井使用) 与 L-Spacing
+    void reset(TestType type, double initialPressure, double lSpacing);
+
+    // 追加一批数据，返回导数开始改变的下标 (之前的点不变)；没有有效新点时返回 -1
+    int append(const QVector<double>& t, const QVector<double>& p);
+
+    int size() const { return m_time.size(); }
+    bool isEmpty() const { return m_time.isEmpty(); }
+    TestType testType() const { return m_type; }
+    double lSpacing() const { return m_lSpacing; }
+
+    const QVector<double>& time() const { return m_time; }
+    const QVector<double>& rawPressure() const { return m_pressure; }
+    const QVector<double>& deltaP() const { return m_deltaP; }
+    const QVector<double>& derivative() const { return m_derivative; }
+
+    // 当前序列的观测数据集 (内容相同的数据集共享实例)
+    ObservedDataset::Handle dataset() const;
+
+private:
+    TestType m_type;
+    double m_initialPressure;
+    double m_lSpacing;
+    QVector<double> m_time;
+    QVector<double> m_pressure;
+    QVector<double> m_deltaP;
+    QVector<double> m_derivative;
+};
+
+#endif // GAUGESERIES_H
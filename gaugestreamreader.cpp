@@ -0,0 +1,149 @@
+/*
+ * 文件名: gaugestreamreader.cpp
+ * 文件作用: 实时压力计数据流读取器实现文件
+ * 功能描述:
+ * 1. 文件源每次只从上次的位置读取新增字节，轮询代价与新增数据量成正比，与文件总长无关。
+ * 2. TCP 源在 readyRead 中只把字节放入缓冲区，解析与提交按轮询间隔成批进行，高频推送时界面每秒只刷新一次。
+ * 3. 行解析使用 RowBlock::appendRow (与文本导入相同的数值解析规则)，时间与压力直接取块内对应列的数组。
+ */
+
+#include "gaugestreamreader.h"
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QTcpSocket>
+#include <limits>
+
+GaugeStreamReader::GaugeStreamReader(QObject* parent)
+    : QObject(parent)
+{
+    connect(&m_timer, &QTimer::timeout, this, &GaugeStreamReader::poll);
+}
+
+GaugeStreamReader::~GaugeStreamReader()
+{
+    stop();
+}
+
+bool GaugeStreamReader::start(const Settings& settings)
+{
+    stop();
+    m_settings = settings;
+    m_fileOffset = 0;
+    m_skipRemaining = settings.type == SourceFile ? qMax(0, settings.skipRows) : 0;
+    m_pending.clear();
+    m_rows = 0;
+    m_lastError.clear();
+
+    if (settings.type == SourceFile) {
+        if (!QFile::exists(settings.filePath)) {
+            emit sourceError(QString("文件不存在: %1").arg(settings.filePath));
+            return false;
+        }
+    } else {
+        m_socket = new QTcpSocket(this);
+        connect(m_socket, &QTcpSocket::readyRead, this, &GaugeStreamReader::onReadyRead);
+        connect(m_socket, &QTcpSocket::errorOccurred, this, [this]() {
+            const QString message = QString("连接 %1:%2 失败: %3").arg(m_settings.host).arg(m_settings.port).arg(m_socket->errorString());
+            if (message != m_lastError) emit sourceError(message);
+            m_lastError = message;
+        });
+        ensureConnected();
+    }
+
+    m_timer.start(qMax(100, settings.pollIntervalMs));
+    poll();
+    return true;
+}
+
+void GaugeStreamReader::stop()
+{
+    m_timer.stop();
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->abort();
+        m_socket->deleteLater();
+        m_socket = nullptr;
+    }
+}
+
+void GaugeStreamReader::poll()
+{
+    if (m_settings.type == SourceFile) {
+        readFile();
+    } else {
+        ensureConnected();
+        flushLines();
+    }
+}
+
+void GaugeStreamReader::onReadyRead()
+{
+    if (m_socket) m_pending.append(m_socket->readAll());
+}
+
+void GaugeStreamReader::ensureConnected()
+{
+    if (m_socket && m_socket->state() == QAbstractSocket::UnconnectedState)
+        m_socket->connectToHost(m_settings.host, quint16(m_settings.port));
+}
+
+void GaugeStreamReader::readFile()
+{
+    QFile file(m_settings.filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        const QString message = QString("无法打开文件: %1").arg(m_settings.filePath);
+        if (message != m_lastError) emit sourceError(message);
+        m_lastError = message;
+        return;
+    }
+    m_lastError.clear();
+
+    if (file.size() < m_fileOffset) {
+        // 文件被截断或替换：从头读取
+        m_fileOffset = 0;
+        m_skipRemaining = qMax(0, m_settings.skipRows);
+        m_pending.clear();
+        m_rows = 0;
+        emit sourceReset();
+    }
+    if (file.size() == m_fileOffset) return;
+
+    file.seek(m_fileOffset);
+    const QByteArray bytes = file.readAll();
+    m_fileOffset += bytes.size();
+    m_pending.append(bytes);
+    flushLines();
+}
+
+void GaugeStreamReader::flushLines()
+{
+    const int end = m_pending.lastIndexOf('\n');
+    if (end < 0) return;
+    const QList<QByteArray> lines = m_pending.left(end).split('\n');
+    m_pending.remove(0, end + 1);
+
+    static const QRegularExpression separator("[,;\\t ]+");
+    ColumnarTableModel::RowBlock block;
+    for (const QByteArray& raw : lines) {
+        const QString line = QString::fromUtf8(raw).trimmed();
+        if (line.isEmpty()) continue;
+        if (m_skipRemaining > 0) {
+            --m_skipRemaining;
+            continue;
+        }
+        block.appendRow(line.split(separator, Qt::SkipEmptyParts));
+    }
+    if (block.rows == 0) return;
+
+    auto column = [&block](int index) {
+        if (index >= 0 && index < block.values.size()) return block.values[index];
+        return QVector<double>(block.rows, std::numeric_limits<double>::quiet_NaN());
+    };
+    const QVector<double> time = column(m_settings.timeColumn);
+    const QVector<double> pressure = column(m_settings.pressureColumn);
+
+    if (m_store) m_store->appendBlock(block);
+    m_rows += block.rows;
+    emit batchAppended(time, pressure);
+}
@@ -0,0 +1,87 @@
+/*
+ * 文件名: gaugestreamreader.h
+ * 文件作用: 实时压力计数据流读取器头文件
+ * 功能描述:
+ * 1. 两种数据源：持续增长的文本文件 (按轮询间隔读取新增部分，相当于 tail -f) 与 TCP 连接 (压力计或采集服务器逐行推送)。
+ * 2. 每行按逗号、分号、制表符或空格分列，只接受完整的行 (未以换行结束的末行留到下一次)；
+ *    文件开头的 skipRows 行 (表头) 跳过，其余不能解析为数值的行在时间或压力列得到 NaN，由 GaugeSeries 丢弃。
+ * 3. 每次轮询把新行解析为一个 RowBlock，整块追加到 store (按列存储的原始记录表，可选)，
+ *    并以 batchAppended 给出该批的时间与压力列。
+ * 4. 文件被截断或替换 (长度小于已读位置) 时从头重新读取并发出 sourceReset；TCP 断开后按轮询间隔自动重连。
+ */
+
+#ifndef GAUGESTREAMREADER_H
+#define GAUGESTREAMREADER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include "columnartablemodel.h"
+
+class QTcpSocket;
+
+class GaugeStreamReader : public QObject
+{
+    Q_OBJECT
+public:
+    enum SourceType {
+        SourceFile = 0, // 持续增长的文本文件
+        SourceTcp = 1   // TCP 行数据流
+    };
+
+    struct Settings {
+        SourceType type = SourceFile;
+        QString filePath;
+        QString host = "127.0.0.1";
+        int port = 5020;
+        int timeColumn = 0;        // 时间列 (从 0 开始)
+        int pressureColumn = 1;    // 压力列
+        int skipRows = 1;          // 文件开头跳过的行数 (表头)
+        int pollIntervalMs = 1000; // 轮询 / 批量提交间隔
+    };
+
+    explicit GaugeStreamReader(QObject* parent = nullptr);
+    ~GaugeStreamReader();
+
+    // 原始记录表 (为空时不保存原始记录)
+    void setStore(ColumnarTableModel* store) { m_store = store; }
+
+    bool start(const Settings& settings);
+    void stop();
+    bool isRunning() const { return m_timer.isActive(); }
+    const Settings& settings() const { return m_settings; }
+
+    // 已接收的数据行数
+    qint64 rowsReceived() const { return m_rows; }
+
+signals:
+    // 一批新数据 (与原始记录中的行顺序相同)
+    void batchAppended(QVector<double> time, QVector<double> pressure);
+    // 数据源被截断或替换，之前的数据作废
+    void sourceReset();
+    void sourceError(QString message);
+
+private slots:
+    void poll();
+    void onReadyRead();
+
+private:
+    void readFile();
+    void ensureConnected();
+    // 把 m_pending 中的完整行解析为一批
+    void flushLines();
+
+    Settings m_settings;
+    QTimer m_timer;
+    QPointer<ColumnarTableModel> m_store;
+    QTcpSocket* m_socket = nullptr;
+
+    qint64 m_fileOffset = 0; // 文件已读位置
+    int m_skipRemaining = 0; // 还需跳过的表头行数
+    QByteArray m_pending;    // 未处理的字节 (可能以不完整的行结束)
+    qint64 m_rows = 0;
+    QString m_lastError;     // 同一错误只报告一次
+};
+
+#endif // GAUGESTREAMREADER_H
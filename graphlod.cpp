@@ -0,0 +1,620 @@
+/*
+ * 文件名: graphlod.cpp
+ * 文件作用: 曲线的多级抽稀数据源实现文件
+ * 功能描述:
+ * 1. 金字塔只保存原始数据的下标：最小/最大值的下标不随整体平移改变，拖动曲线时只需平移原始数组。
+ * 2. 折线金字塔在首次以折线显示时建立，散点金字塔在首次以散点显示时建立，切换线型时按需补建。
+ * 3. 写入曲线时总是包含可见范围两端的原始点，自动缩放坐标轴 (rescaleAxes) 与连线到边界均不受抽稀影响。
+ * 4. 数据源登记表按两个数组的数据块地址保存弱引用：数据源持有数组的隐式共享副本，数组未被修改时地址不变；
+ *    数据源自身被修改后即从登记表移除，之后以原数组设置数据的曲线得到新的数据源。
+ * 5. 不抽稀的曲线直接共用数据源的 QCPGraphDataContainer；抽稀的曲线各自持有只含可见点的数据容器
+ *    (可见范围因窗口而异)，共用的只有完整数据与金字塔。
+ * 6. 末尾追加时折线金字塔的第 L 级只有从 from / (8·2^L) 桶开始的部分需要重算，每批的代价与新增点数成正比 (加上每级一个桶)；
+ *    有序性只检查 from 之后的部分。
+ * 7. 紧凑存储只在数组的引用计数表明调用方已释放时进行 (QVector::isDetached)，此时不会与调用方的数组重复占用；
+ *    平移与改写纵坐标先还原为 double 数组，之后再次满足条件时重新压缩。金字塔保存的是下标，压缩前后不需重建。
+ * 8. 抽稀的曲线第一次写入时按完整数据范围取点 (而非坐标轴当前范围)，随后的 rescaleAxes 得到全部数据的范围。
+ */
+
+#include "graphlod.h"
+#include <QHash>
+#include <QPair>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kBaseBucket = 8;       // 第 0 级的桶大小
+const int kMinBuckets = 512;     // 最粗一级的桶数下限
+const int kMinLttbPoints = 500;  // 最粗一级 LTTB 的点数下限
+
+// NaN 视为不参与比较
+inline bool lessValue(double a, double b) { return !std::isnan(a) && (std::isnan(b) || a < b); }
+inline bool greaterValue(double a, double b) { return !std::isnan(a) && (std::isnan(b) || a > b); }
+
+using SourceKey = QPair<const double*, const double*>;
+
+QHash<SourceKey, QWeakPointer<GraphDataSource>>& registry()
+{
+    static QHash<SourceKey, QWeakPointer<GraphDataSource>> sources;
+    return sources;
+}
+
+} // namespace
+
+// ============================================================================
+// GraphDataSource
+// ============================================================================
+
+GraphDataSource::GraphDataSource(const QVector<double>& keys, const QVector<double>& values)
+{
+    assign(keys, values);
+}
+
+GraphDataSource::~GraphDataSource()
+{
+    unregister();
+}
+
+QSharedPointer<GraphDataSource> GraphDataSource::get(const QVector<double>& keys, const QVector<double>& values)
+{
+    // 空数组可能共用同一个静态数据块，不参与共享
+    const bool shareable = !keys.isEmpty() && !values.isEmpty();
+    const SourceKey key(keys.constData(), values.constData());
+    if (shareable) {
+        QSharedPointer<GraphDataSource> existing = registry().value(key).toStrongRef();
+        if (existing && existing->m_keys.constData() == keys.constData() && existing->m_values.constData() == values.constData()
+            && existing->m_keys.size() == keys.size() && existing->m_values.size() == values.size())
+            return existing;
+    }
+
+    QSharedPointer<GraphDataSource> source(new GraphDataSource(keys, values));
+    // 长度不一致时数据源截断后已是独立副本，不再与原数组对应
+    if (shareable && source->m_keys.constData() == keys.constData() && source->m_values.constData() == values.constData()) {
+        registry().insert(key, source.toWeakRef());
+        source->m_registered = true;
+        source->m_registryKeys = key.first;
+        source->m_registryValues = key.second;
+    }
+    return source;
+}
+
+void GraphDataSource::assign(const QVector<double>& keys, const QVector<double>& values)
+{
+    m_keys = keys;
+    m_values = values;
+    const int n = qMin(m_keys.size(), m_values.size());
+    if (m_keys.size() != n) m_keys.resize(n);
+    if (m_values.size() != n) m_values.resize(n);
+    m_useLod = n >= GraphLod::MinPoints && std::is_sorted(m_keys.constBegin(), m_keys.constEnd());
+}
+
+void GraphDataSource::unregister()
+{
+    if (!m_registered) return;
+    m_registered = false;
+    auto& sources = registry();
+    const SourceKey key(m_registryKeys, m_registryValues);
+    // 析构时弱引用已失效；同一地址已登记了别的数据源时保留
+    auto it = sources.find(key);
+    if (it != sources.end() && (it.value().isNull() || it.value().toStrongRef().data() == this)) sources.erase(it);
+}
+
+QSharedPointer<QCPGraphDataContainer> GraphDataSource::container()
+{
+    if (!m_container) {
+        m_container = QSharedPointer<QCPGraphDataContainer>::create();
+        QVector<QCPGraphData> data(size());
+        for (int i = 0; i < data.size(); ++i) data[i] = QCPGraphData(keyAt(i), valueAt(i));
+        m_container->set(data, m_useLod); // 抽稀的数据已确认有序
+    }
+    return m_container;
+}
+
+void GraphDataSource::syncContainer()
+{
+    if (!m_container) return;
+    if (m_useLod) {
+        // 共用旧容器的曲线在刷新时改用各自的可见点容器
+        m_container.clear();
+        return;
+    }
+    // 共用容器的曲线保持同一个容器对象，只替换内容
+    QVector<QCPGraphData> data(m_keys.size());
+    for (int i = 0; i < m_keys.size(); ++i) data[i] = QCPGraphData(m_keys[i], m_values[i]);
+    m_container->set(data, false);
+}
+
+QVector<double> GraphDataSource::keys() const
+{
+    if (!m_compacted) return m_keys;
+    QVector<double> keys, values;
+    m_compact.decode(0, m_compact.size(), keys, values);
+    return keys;
+}
+
+QVector<double> GraphDataSource::values() const
+{
+    if (!m_compacted) return m_values;
+    QVector<double> keys, values;
+    m_compact.decode(0, m_compact.size(), keys, values);
+    return values;
+}
+
+int GraphDataSource::lowerBound(double key) const
+{
+    if (m_compacted) return m_compact.lowerBound(key);
+    return int(std::lower_bound(m_keys.constBegin(), m_keys.constEnd(), key) - m_keys.constBegin());
+}
+
+int GraphDataSource::upperBound(double key) const
+{
+    if (m_compacted) return m_compact.upperBound(key);
+    return int(std::upper_bound(m_keys.constBegin(), m_keys.constEnd(), key) - m_keys.constBegin());
+}
+
+void GraphDataSource::decode(int first, int count, QVector<double>& keys, QVector<double>& values) const
+{
+    if (m_compacted) {
+        m_compact.decode(first, count, keys, values);
+        return;
+    }
+    keys = m_keys.mid(first, count);
+    values = m_values.mid(first, count);
+}
+
+void GraphDataSource::addUser(bool displayOnly)
+{
+    m_displayOnly = (m_users == 0) ? displayOnly : (m_displayOnly && displayOnly);
+    ++m_users;
+}
+
+void GraphDataSource::compactIfUnshared()
+{
+    if (m_compacted || !m_displayOnly || !m_useLod) return;
+    // 数组仍与调用方共用时不占额外内存，保持共用
+    if (!m_keys.isDetached() || !m_values.isDetached()) return;
+    unregister();
+    m_compact = CompactSeries::encode(m_keys, m_values);
+    m_compacted = true;
+    m_keys = QVector<double>();
+    m_values = QVector<double>();
+}
+
+void GraphDataSource::expand()
+{
+    if (!m_compacted) return;
+    m_compact.decode(0, m_compact.size(), m_keys, m_values);
+    m_compact = CompactSeries();
+    m_compacted = false;
+}
+
+const QVector<QVector<int>>& GraphDataSource::minMaxLevels()
+{
+    if (m_minMax.isEmpty()) buildMinMax();
+    return m_minMax;
+}
+
+const QVector<QVector<int>>& GraphDataSource::lttbLevels()
+{
+    if (m_lttb.isEmpty()) buildLttb();
+    return m_lttb;
+}
+
+void GraphDataSource::commit(bool keysChanged)
+{
+    unregister();
+    ++m_version;
+    m_minMax.clear();
+    m_lttb.clear();
+    if (keysChanged) m_useLod = m_keys.size() >= GraphLod::MinPoints && std::is_sorted(m_keys.constBegin(), m_keys.constEnd());
+    emit changed();
+}
+
+void GraphDataSource::setData(const QVector<double>& keys, const QVector<double>& values)
+{
+    unregister();
+    m_compact = CompactSeries();
+    m_compacted = false;
+    assign(keys, values);
+    syncContainer();
+    commit(false);
+}
+
+void GraphDataSource::translate(double dx, double dy)
+{
+    if (dx == 0.0 && dy == 0.0) return;
+    expand();
+    if (dx != 0.0) for (double& k : m_keys) k += dx;
+    if (dy != 0.0) for (double& v : m_values) v += dy;
+    if (m_container) {
+        // 整体平移不改变顺序，就地改写
+        for (auto it = m_container->begin(); it != m_container->end(); ++it) {
+            it->key += dx;
+            it->value += dy;
+        }
+    }
+    commit(false);
+}
+
+bool GraphDataSource::setValues(int from, int to, const QVector<double>& values)
+{
+    if (values.size() != size() || from < 0 || to >= size() || from > to) return false;
+    expand();
+    for (int i = from; i <= to; ++i) m_values[i] = values[i];
+    if (m_container) {
+        // 有序数据的容器与数组一一对应，就地改写；否则按新数据重建
+        const bool inPlace = m_container->size() == m_keys.size() && std::is_sorted(m_keys.constBegin(), m_keys.constEnd());
+        if (inPlace) {
+            for (int i = from; i <= to; ++i) (m_container->begin() + i)->value = m_values[i];
+        } else {
+            QVector<QCPGraphData> data(m_keys.size());
+            for (int i = 0; i < m_keys.size(); ++i) data[i] = QCPGraphData(m_keys[i], m_values[i]);
+            m_container->set(data, false);
+        }
+    }
+    commit(false);
+    return true;
+}
+
+bool GraphDataSource::replaceTail(int from, const QVector<double>& keys, const QVector<double>& values)
+{
+    const int oldSize = size();
+    const int n = qMin(keys.size(), values.size());
+    if (from < 0 || from > oldSize || n < oldSize) return false;
+
+    unregister();
+    m_compact = CompactSeries();
+    m_compacted = false;
+    const bool wasLod = m_useLod;
+    m_keys = keys;
+    m_values = values;
+    if (m_keys.size() != n) m_keys.resize(n);
+    if (m_values.size() != n) m_values.resize(n);
+    // 原来有序时只需检查 from 之后的部分 (含与前一点的衔接)
+    const int checkFrom = wasLod ? qMax(0, from - 1) : 0;
+    m_useLod = n >= GraphLod::MinPoints && std::is_sorted(m_keys.constBegin() + checkFrom, m_keys.constEnd());
+    syncContainer();
+
+    ++m_version;
+    m_lttb.clear();
+    if (wasLod && m_useLod && !m_minMax.isEmpty()) extendMinMax(from);
+    else m_minMax.clear();
+    emit changed();
+    return true;
+}
+
+void GraphDataSource::fillBaseLevel(QVector<int>& level, int firstBucket) const
+{
+    const int n = size();
+    level.resize(2 * firstBucket);
+    level.reserve(2 * ((n + kBaseBucket - 1) / kBaseBucket));
+    for (int start = firstBucket * kBaseBucket; start < n; start += kBaseBucket) {
+        const int end = qMin(n, start + kBaseBucket);
+        int lo = start, hi = start;
+        for (int i = start + 1; i < end; ++i) {
+            if (lessValue(valueAt(i), valueAt(lo))) lo = i;
+            if (greaterValue(valueAt(i), valueAt(hi))) hi = i;
+        }
+        level << qMin(lo, hi) << qMax(lo, hi);
+    }
+}
+
+void GraphDataSource::fillCoarseLevel(const QVector<int>& fine, QVector<int>& coarse, int firstBucket) const
+{
+    // 上一级相邻两桶合并为一桶
+    coarse.resize(2 * firstBucket);
+    coarse.reserve(fine.size() / 2 + 2);
+    for (int k = 4 * firstBucket; k < fine.size(); k += 4) {
+        const int end = qMin(fine.size(), k + 4);
+        int lo = fine[k], hi = fine[k];
+        for (int j = k + 1; j < end; ++j) {
+            if (lessValue(valueAt(fine[j]), valueAt(lo))) lo = fine[j];
+            if (greaterValue(valueAt(fine[j]), valueAt(hi))) hi = fine[j];
+        }
+        coarse << qMin(lo, hi) << qMax(lo, hi);
+    }
+}
+
+void GraphDataSource::buildMinMax()
+{
+    QVector<int> level;
+    fillBaseLevel(level, 0);
+    m_minMax.append(level);
+
+    while (m_minMax.last().size() / 2 > kMinBuckets) {
+        QVector<int> coarse;
+        fillCoarseLevel(m_minMax.last(), coarse, 0);
+        m_minMax.append(coarse);
+    }
+}
+
+void GraphDataSource::extendMinMax(int from)
+{
+    int bucket = from / kBaseBucket;
+    fillBaseLevel(m_minMax[0], bucket);
+    for (int level = 1; level < m_minMax.size(); ++level) {
+        bucket /= 2;
+        fillCoarseLevel(m_minMax[level - 1], m_minMax[level], bucket);
+    }
+
+    while (m_minMax.last().size() / 2 > kMinBuckets) {
+        QVector<int> coarse;
+        fillCoarseLevel(m_minMax.last(), coarse, 0);
+        m_minMax.append(coarse);
+    }
+}
+
+void GraphDataSource::buildLttb()
+{
+    QVector<int> current;
+    current.reserve(size());
+    for (int i = 0; i < size(); ++i)
+        if (std::isfinite(valueAt(i))) current.append(i);
+
+    for (int threshold = current.size() / 8; threshold >= kMinLttbPoints; threshold /= 2) {
+        current = lttb(current, threshold);
+        m_lttb.append(current);
+    }
+}
+
+QVector<int> GraphDataSource::lttb(const QVector<int>& source, int threshold) const
+{
+    const int n = source.size();
+    if (threshold >= n || threshold < 3) return source;
+
+    QVector<int> out;
+    out.reserve(threshold);
+    const double every = double(n - 2) / (threshold - 2);
+    int a = 0;
+    out << source[0];
+    for (int i = 0; i < threshold - 2; ++i) {
+        // 下一个桶的平均点
+        const int avgStart = int(std::floor((i + 1) * every)) + 1;
+        const int avgEnd = qMin(int(std::floor((i + 2) * every)) + 1, n);
+        double avgX = 0.0, avgY = 0.0;
+        for (int j = avgStart; j < avgEnd; ++j) {
+            avgX += keyAt(source[j]);
+            avgY += valueAt(source[j]);
+        }
+        const int avgCount = qMax(1, avgEnd - avgStart);
+        avgX /= avgCount;
+        avgY /= avgCount;
+
+        // 当前桶中与上一个选中点、下一桶平均点构成最大三角形的点
+        const int rangeStart = int(std::floor(i * every)) + 1;
+        const int rangeEnd = qMin(int(std::floor((i + 1) * every)) + 1, n - 1);
+        const double ax = keyAt(source[a]);
+        const double ay = valueAt(source[a]);
+        double maxArea = -1.0;
+        int next = rangeStart;
+        for (int j = rangeStart; j < rangeEnd; ++j) {
+            const double area = std::fabs((ax - avgX) * (valueAt(source[j]) - ay) - (ax - keyAt(source[j])) * (avgY - ay));
+            if (area > maxArea) {
+                maxArea = area;
+                next = j;
+            }
+        }
+        out << source[next];
+        a = next;
+    }
+    out << source[n - 1];
+    return out;
+}
+
+// ============================================================================
+// GraphLod
+// ============================================================================
+
+GraphLod::GraphLod(QCPGraph* graph, const QSharedPointer<GraphDataSource>& source)
+    : QObject(graph), m_graph(graph), m_source(source)
+{
+    connect(m_source.data(), &GraphDataSource::changed, this, &GraphLod::onSourceChanged);
+    if (graph->parentPlot())
+        connect(graph->parentPlot(), &QCustomPlot::beforeReplot, this, &GraphLod::onBeforeReplot);
+}
+
+void GraphLod::setGraphData(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values)
+{
+    attach(graph, keys, values, false);
+}
+
+void GraphLod::setDisplayData(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values)
+{
+    attach(graph, keys, values, true);
+}
+
+void GraphLod::attach(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values, bool displayOnly)
+{
+    if (!graph) return;
+    QSharedPointer<GraphDataSource> source = GraphDataSource::get(keys, values);
+    source->addUser(displayOnly);
+    GraphLod* lod = find(graph);
+    if (lod && lod->m_source == source) return;
+    delete lod;
+    lod = new GraphLod(graph, source);
+    lod->refresh(true);
+}
+
+GraphLod* GraphLod::find(const QCPGraph* graph)
+{
+    return graph ? graph->findChild<GraphLod*>(QString(), Qt::FindDirectChildrenOnly) : nullptr;
+}
+
+void GraphLod::graphData(const QCPGraph* graph, QVector<double>& keys, QVector<double>& values)
+{
+    keys.clear();
+    values.clear();
+    if (!graph) return;
+    const GraphLod* lod = find(graph);
+    if (lod && lod->m_source->useLod()) {
+        keys = lod->keys();
+        values = lod->values();
+        return;
+    }
+    // 不抽稀的曲线按数据容器 (按横坐标排序) 读取
+    QSharedPointer<QCPGraphDataContainer> data = graph->data();
+    keys.reserve(data->size());
+    values.reserve(data->size());
+    for (auto it = data->constBegin(); it != data->constEnd(); ++it) {
+        keys.append(it->key);
+        values.append(it->value);
+    }
+}
+
+void GraphLod::translate(QCPGraph* graph, double dx, double dy)
+{
+    if (!graph) return;
+    if (GraphLod* lod = find(graph)) {
+        lod->m_source->translate(dx, dy);
+        lod->refresh(true);
+        return;
+    }
+    QSharedPointer<QCPGraphDataContainer> data = graph->data();
+    for (auto it = data->begin(); it != data->end(); ++it) {
+        it->key += dx;
+        it->value += dy;
+    }
+}
+
+void GraphLod::updateData(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values)
+{
+    if (!graph) return;
+    if (GraphLod* lod = find(graph)) {
+        lod->m_source->setData(keys, values);
+        lod->refresh(true);
+        return;
+    }
+    setGraphData(graph, keys, values);
+}
+
+bool GraphLod::updateValues(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values, int from, int to)
+{
+    GraphLod* lod = find(graph);
+    if (!lod || lod->keys() != keys) return false;
+    if (!lod->m_source->setValues(from, to, values)) return false;
+    lod->refresh(true);
+    return true;
+}
+
+bool GraphLod::updateTail(QCPGraph* graph, int from, const QVector<double>& keys, const QVector<double>& values)
+{
+    GraphLod* lod = find(graph);
+    if (!lod || !lod->m_source->replaceTail(from, keys, values)) return false;
+    lod->refresh(true);
+    return true;
+}
+
+void GraphLod::onSourceChanged()
+{
+    // 其他窗口中共用数据源的曲线：下次重绘时按新版本取数
+    if (m_graph->parentPlot()) m_graph->parentPlot()->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void GraphLod::refresh(bool force)
+{
+    // 不抽稀：直接共用数据源的容器
+    if (!m_source->useLod()) {
+        const QSharedPointer<QCPGraphDataContainer> container = m_source->container();
+        if (m_graph->data() != container) m_graph->setData(container);
+        m_visible.clear();
+        m_version = m_source->version();
+        return;
+    }
+
+    QCPAxis* keyAxis = m_graph->keyAxis();
+    const int n = m_source->size();
+    if (!keyAxis || !keyAxis->axisRect() || n == 0) return;
+
+    // 抽稀的曲线只写入可见点，使用自己的容器 (不能写进共用的容器)
+    if (!m_visible || m_graph->data() != m_visible) {
+        m_visible = QSharedPointer<QCPGraphDataContainer>::create();
+        m_graph->setData(m_visible);
+        force = true;
+    }
+    m_source->compactIfUnshared();
+
+    // 第一次写入时取完整数据范围
+    const bool initial = m_width < 0;
+    const QCPRange range = initial ? QCPRange(m_source->keyAt(0), m_source->keyAt(n - 1)) : keyAxis->range();
+    const QRect rect = keyAxis->axisRect()->rect();
+    const int width = qMax(1, keyAxis->orientation() == Qt::Horizontal ? rect.width() : rect.height());
+    const bool scatter = m_graph->lineStyle() == QCPGraph::lsNone;
+    if (!force && m_version == m_source->version() && range.lower == m_lower && range.upper == m_upper
+        && width == m_width && scatter == m_scatter) return;
+    m_version = m_source->version();
+    m_lower = range.lower;
+    m_upper = range.upper;
+    m_width = width;
+    m_scatter = scatter;
+
+    // 可见范围 (两端各多取一个点，连线画到边界)
+    const int first = qMax(0, m_source->lowerBound(range.lower) - 1);
+    const int last = qMin(n - 1, m_source->upperBound(range.upper));
+    if (last < first) {
+        m_visible->clear();
+        return;
+    }
+    const int count = last - first + 1;
+
+    if (count <= 4 * width) {
+        writeRange(first, count);
+        return;
+    }
+
+    QVector<int> indices;
+    if (!scatter) {
+        const QVector<QVector<int>>& minMax = m_source->minMaxLevels();
+        // 每桶两个点：桶大小不小于 count / (2·width) 时不超过每像素 4 点
+        const int needed = count / (2 * width);
+        int level = 0;
+        while (level + 1 < minMax.size() && (kBaseBucket << level) < needed) ++level;
+        const QVector<int>& buckets = minMax[level];
+        const int size = kBaseBucket << level;
+        const int b0 = first / size;
+        const int b1 = qMin(last / size, buckets.size() / 2 - 1);
+        indices.reserve(2 * (b1 - b0 + 1) + 2);
+        for (int b = b0; b <= b1; ++b) indices << buckets[2 * b] << buckets[2 * b + 1];
+    } else {
+        const QVector<QVector<int>>& lttbLevels = m_source->lttbLevels();
+        if (lttbLevels.isEmpty()) {
+            writeRange(first, count);
+            return;
+        }
+        // 可见点数不超过每像素 2 点的最细一级
+        int level = 0;
+        auto visible = [&](int l, QVector<int>::const_iterator* begin, QVector<int>::const_iterator* end) {
+            const QVector<int>& points = lttbLevels[l];
+            *begin = std::lower_bound(points.constBegin(), points.constEnd(), first);
+            *end = std::upper_bound(points.constBegin(), points.constEnd(), last);
+            return int(*end - *begin);
+        };
+        QVector<int>::const_iterator begin, end;
+        while (visible(level, &begin, &end) > 2 * width && level + 1 < lttbLevels.size()) ++level;
+        indices = QVector<int>(begin, end);
+    }
+    indices << first << last;
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    writeIndices(indices, first, last);
+}
+
+void GraphLod::writeRange(int first, int count)
+{
+    QVector<double> keys, values;
+    m_source->decode(first, count, keys, values);
+    m_graph->setData(keys, values, true);
+}
+
+void GraphLod::writeIndices(const QVector<int>& indices, int first, int last)
+{
+    QVector<double> keys, values;
+    keys.reserve(indices.size());
+    values.reserve(indices.size());
+    for (int i : indices) {
+        if (i < first || i > last) continue;
+        keys.append(m_source->keyAt(i));
+        values.append(m_source->valueAt(i));
+    }
+    m_graph->setData(keys, values, true);
+}
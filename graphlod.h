@@ -0,0 +1,171 @@
+/*
+ * 文件名: graphlod.h
+ * 文件作用: 曲线的多级抽稀数据源 (Level of Detail) 头文件
+ * 功能描述:
+ * 1. 点数很多 (超过 MinPoints) 且横坐标有序的曲线，设置数据时一次性建立抽稀金字塔：
+ *    - 折线：各级按 8·2^L 个点分桶，保存桶内最小值与最大值的下标 (由上一级两两合并得到，尖峰不会被抽掉)；
+ *    - 散点 (无连线)：各级为上一级的 LTTB (Largest-Triangle-Three-Buckets) 抽稀结果，点数逐级减半。
+ * 2. 每次重绘前按可见的横坐标范围与坐标区像素宽度选取一级：可见范围内的原始点数不超过像素数的 4 倍时显示原始数据，
+ *    否则取满足 "每像素约 2 点" 的最粗一级，只把可见的桶写入 QCPGraph；范围与宽度未变时不重新取数。
+ * 3. GraphLod 作为 QCPGraph 的子对象随曲线一起删除；graphData 读取完整分辨率的数据 (没有抽稀时读取曲线本身)，
+ *    translate 平移全部数据 (拖动曲线)，供编辑与导出使用。
+ * 4. [共享数据] 完整数据、金字塔与 (不抽稀时的) QCPGraphDataContainer 放在 GraphDataSource 中：
+ *    以同一组数组设置数据的曲线 (主界面与各独立图表窗口显示同一条曲线) 共用一个数据源，不再各自复制；
+ *    任一曲线上的修改 (translate / updateData / updateValues) 写入数据源并递增版本号，共用的曲线随之刷新并重绘。
+ * 5. [增量追加] updateTail 用于持续增长的曲线 (实时监测)：from 之前的点保持不变，折线金字塔只重算从 from 所在桶开始的各级桶
+ *    并按需增加更粗的一级，散点金字塔在下次以散点显示时重建。
+ * 6. [紧凑存储] setDisplayData 设置仅供显示的数据 (计算用的数组另有保存，如观测数据集)：数组仍与调用方共用时直接共用，
+ *    调用方释放后 (数据源成为唯一持有者) 在下一次重绘前改为 CompactSeries (单精度纵坐标、隐式或分块增量横坐标)，
+ *    每次重绘只解码可见范围内写入曲线的点。setGraphData 设置的数据可能被编辑或导出，始终保持 double。
+ */
+
+#ifndef GRAPHLOD_H
+#define GRAPHLOD_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+#include "qcustomplot.h"
+#include "compactseries.h"
+
+// 多条曲线共用的数据源 (只在界面线程使用)
+class GraphDataSource : public QObject
+{
+    Q_OBJECT
+public:
+    // 同一组数组 (数据块地址与长度相同) 返回同一个数据源；数据源被修改后不再与原数组对应
+    static QSharedPointer<GraphDataSource> get(const QVector<double>& keys, const QVector<double>& values);
+    ~GraphDataSource();
+
+    int size() const { return m_compacted ? m_compact.size() : m_keys.size(); }
+    double keyAt(int i) const { return m_compacted ? m_compact.key(i) : m_keys[i]; }
+    double valueAt(int i) const { return m_compacted ? m_compact.value(i) : m_values[i]; }
+    // 完整数据 (紧凑存储时为解码结果)
+    QVector<double> keys() const;
+    QVector<double> values() const;
+    // 有序横坐标上第一个不小于 / 大于 key 的下标
+    int lowerBound(double key) const;
+    int upperBound(double key) const;
+    // 解码 [first, first + count) 段
+    void decode(int first, int count, QVector<double>& keys, QVector<double>& values) const;
+    bool isCompact() const { return m_compacted; }
+    quint64 version() const { return m_version; }
+    // 横坐标有序且点数不少于 GraphLod::MinPoints 时抽稀显示
+    bool useLod() const { return m_useLod; }
+
+    // 不抽稀时各曲线直接共用的数据容器
+    QSharedPointer<QCPGraphDataContainer> container();
+    // 抽稀金字塔 (首次使用时建立)
+    const QVector<QVector<int>>& minMaxLevels();
+    const QVector<QVector<int>>& lttbLevels();
+
+    // 登记一条使用该数据源的曲线：所有曲线都只用于显示时才允许紧凑存储
+    void addUser(bool displayOnly);
+    // 仅供显示且数组不再与调用方共用时改为紧凑存储 (抽稀显示的曲线在重绘前调用)
+    void compactIfUnshared();
+
+    void setData(const QVector<double>& keys, const QVector<double>& values);
+    void translate(double dx, double dy);
+    // 改写 [from, to] 段的纵坐标 (values 为完整长度的新数组)；长度不符时返回 false
+    bool setValues(int from, int to, const QVector<double>& values);
+    // 以新数组替换数据，下标 from 之前的点与原数据相同 (只追加或只改写末尾)；新数组比原数据短或 from 越界时返回 false
+    bool replaceTail(int from, const QVector<double>& keys, const QVector<double>& values);
+
+signals:
+    // 数据被修改 (版本号已递增)
+    void changed();
+
+private:
+    GraphDataSource(const QVector<double>& keys, const QVector<double>& values);
+    void assign(const QVector<double>& keys, const QVector<double>& values);
+    // 数据修改后：递增版本号，丢弃金字塔，同步数据容器并发出 changed
+    void commit(bool keysChanged);
+    void unregister();
+    // 修改数据前把紧凑存储还原为 double 数组
+    void expand();
+    // 不抽稀时同步数据容器，抽稀时释放 (抽稀的曲线各自持有可见点)
+    void syncContainer();
+
+    void buildMinMax();
+    // 从第 firstBucket 桶起重算第 0 级 / 由上一级合并得到的一级 (之后的桶截断后重新追加)
+    void fillBaseLevel(QVector<int>& level, int firstBucket) const;
+    void fillCoarseLevel(const QVector<int>& fine, QVector<int>& coarse, int firstBucket) const;
+    // 数据从 from 起改变后更新折线金字塔，并在桶数增多时追加更粗的级别
+    void extendMinMax(int from);
+    void buildLttb();
+    // 在 source (原始数据的下标，升序) 上做 LTTB，保留 threshold 个点
+    QVector<int> lttb(const QVector<int>& source, int threshold) const;
+
+    QVector<double> m_keys;
+    QVector<double> m_values;
+    bool m_useLod = false;
+    quint64 m_version = 0;
+    bool m_registered = false;
+    const double* m_registryKeys = nullptr;   // 登记时两个数组的数据块地址
+    const double* m_registryValues = nullptr;
+
+    CompactSeries m_compact;        // 紧凑存储 (m_compacted 为真时代替 m_keys / m_values)
+    bool m_compacted = false;
+    bool m_displayOnly = false;
+    int m_users = 0;
+
+    QSharedPointer<QCPGraphDataContainer> m_container;
+    QVector<QVector<int>> m_minMax; // 第 L 级：每桶 (8·2^L 个点) 两个下标，按顺序排列
+    QVector<QVector<int>> m_lttb;   // 第 L 级：约 N / 2^(L+3) 个下标 (升序)
+};
+
+class GraphLod : public QObject
+{
+    Q_OBJECT
+public:
+    // 低于该点数时直接显示原始数据
+    static const int MinPoints = 20000;
+
+    // 设置曲线数据：与其他曲线共用同一组数组时共用其数据源
+    static void setGraphData(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values);
+    // 设置仅供显示的数据 (不经 graphData 读回做计算)：数据源成为唯一持有者后改为紧凑存储
+    static void setDisplayData(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values);
+    // 曲线上的数据视图 (没有时为 nullptr)
+    static GraphLod* find(const QCPGraph* graph);
+    // 完整分辨率的数据
+    static void graphData(const QCPGraph* graph, QVector<double>& keys, QVector<double>& values);
+    // 平移全部数据 (dx 加到横坐标，dy 加到纵坐标)；共用数据源的曲线一起移动
+    static void translate(QCPGraph* graph, double dx, double dy);
+    // 替换数据源的全部数据 (共用数据源的曲线一起更新)
+    static void updateData(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values);
+    // 只改写 [from, to] 段的纵坐标；横坐标或长度不符时返回 false (调用方改用 updateData)
+    static bool updateValues(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values, int from, int to);
+    // 追加数据或改写末尾 (from 之前的点不变)；曲线没有数据视图或数据变短时返回 false (调用方改用 setGraphData)
+    static bool updateTail(QCPGraph* graph, int from, const QVector<double>& keys, const QVector<double>& values);
+
+    QVector<double> keys() const { return m_source->keys(); }
+    QVector<double> values() const { return m_source->values(); }
+    GraphDataSource* source() const { return m_source.data(); }
+
+    // 按当前可见范围写入曲线 (force 为真时忽略 "范围未变" 的判断)
+    void refresh(bool force = false);
+
+private slots:
+    void onBeforeReplot() { refresh(false); }
+    void onSourceChanged();
+
+private:
+    GraphLod(QCPGraph* graph, const QSharedPointer<GraphDataSource>& source);
+
+    static void attach(QCPGraph* graph, const QVector<double>& keys, const QVector<double>& values, bool displayOnly);
+    void writeRange(int first, int count);
+    void writeIndices(const QVector<int>& indices, int first, int last);
+
+    QCPGraph* m_graph;
+    QSharedPointer<GraphDataSource> m_source;
+    QSharedPointer<QCPGraphDataContainer> m_visible; // 抽稀显示时本曲线的可见点
+
+    // 上一次写入曲线时的状态
+    quint64 m_version = 0;
+    double m_lower = 0.0;
+    double m_upper = 0.0;
+    int m_width = -1;
+    bool m_scatter = false;
+};
+
+#endif // GRAPHLOD_H
@@ -0,0 +1,254 @@
+/*
+ * 文件名: jointfitdialog.cpp
+ * 文件作用: 联合拟合对话框实现文件
+ * 功能描述:
+ * 1. 界面由代码构建：上部为分析页签与共用参数的勾选列表，中部为结果表与进度，下部为操作按钮。
+ * 2. 勾选的分析变化时重新生成数据集并刷新共用参数列表 (保留仍存在的参数的勾选状态)。
+ * 3. 迭代中结果表显示各分析的当前参数 (共用参数加 * 标记)，结束后补充各分析的误差 (MSE)。
+ * 4. 关闭对话框时如仍在拟合，确认后停止 (JointFitter 析构时等待拟合线程结束)。
+ */
+
+#include "jointfitdialog.h"
+#include "jointfitter.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+
+namespace {
+enum Column {
+    ColAnalysis = 0,
+    ColModel,
+    ColMse,
+    ColParams,
+    ColumnCount
+};
+}
+
+JointFitDialog::JointFitDialog(ModelManager* modelManager, const QStringList& analyses, const QString& currentAnalysis,
+                               JobFactory factory, ResultApplier applier, QWidget* parent)
+    : QDialog(parent), m_factory(factory), m_applier(applier)
+{
+    setWindowTitle("联合拟合");
+    resize(820, 560);
+
+    m_fitter = new JointFitter(modelManager ? modelManager->engine() : nullptr, this);
+    connect(m_fitter, &JointFitter::sigIterationUpdated, this, &JointFitDialog::onIterationUpdated, Qt::QueuedConnection);
+    connect(m_fitter, &JointFitter::sigProgress, this, [this](int percent) { m_progress->setValue(percent); },
+            Qt::QueuedConnection);
+    connect(m_fitter, &JointFitter::sigFitFinished, this, &JointFitDialog::onFinished, Qt::QueuedConnection);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // 1. 数据集与共用参数
+    QGridLayout* selectLayout = new QGridLayout();
+    selectLayout->addWidget(new QLabel("分析页签 (至少两个):", this), 0, 0);
+    selectLayout->addWidget(new QLabel("共用参数 (其余拟合参数各分析独立):", this), 0, 1);
+    m_listAnalyses = new QListWidget(this);
+    for (const QString& name : analyses) {
+        QListWidgetItem* item = new QListWidgetItem(name, m_listAnalyses);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(name == currentAnalysis ? Qt::Checked : Qt::Unchecked);
+    }
+    m_listShared = new QListWidget(this);
+    m_listAnalyses->setMaximumHeight(160);
+    m_listShared->setMaximumHeight(160);
+    selectLayout->addWidget(m_listAnalyses, 1, 0);
+    selectLayout->addWidget(m_listShared, 1, 1);
+    mainLayout->addLayout(selectLayout);
+
+    // 2. 结果表
+    m_table = new QTableWidget(this);
+    m_table->setColumnCount(ColumnCount);
+    m_table->setHorizontalHeaderLabels(QStringList() << "分析" << "模型" << "误差(MSE)" << "拟合参数 (* 为共用)");
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    mainLayout->addWidget(m_table);
+
+    m_progress = new QProgressBar(this);
+    m_progress->setRange(0, 100);
+    m_progress->setValue(0);
+    mainLayout->addWidget(m_progress);
+    m_lblStatus = new QLabel(this);
+    mainLayout->addWidget(m_lblStatus);
+
+    // 3. 操作按钮
+    QHBoxLayout* btnLayout = new QHBoxLayout();
+    m_btnStart = new QPushButton("开始联合拟合", this);
+    m_btnStop = new QPushButton("停止", this);
+    m_btnApply = new QPushButton("应用结果", this);
+    QPushButton* btnClose = new QPushButton("关闭", this);
+    btnLayout->addWidget(m_btnStart);
+    btnLayout->addWidget(m_btnStop);
+    btnLayout->addStretch();
+    btnLayout->addWidget(m_btnApply);
+    btnLayout->addWidget(btnClose);
+    mainLayout->addLayout(btnLayout);
+
+    connect(m_listAnalyses, &QListWidget::itemChanged, this, &JointFitDialog::onAnalysesChanged);
+    connect(m_btnStart, &QPushButton::clicked, this, &JointFitDialog::onStart);
+    connect(m_btnStop, &QPushButton::clicked, this, &JointFitDialog::onStop);
+    connect(m_btnApply, &QPushButton::clicked, this, &JointFitDialog::onApply);
+    connect(btnClose, &QPushButton::clicked, this, &JointFitDialog::reject);
+
+    setRunning(false);
+    onAnalysesChanged();
+}
+
+void JointFitDialog::reject()
+{
+    if (m_fitter->isRunning()) {
+        if (QMessageBox::question(this, "确认", "联合拟合仍在运行，关闭将停止拟合。\n是否继续？") != QMessageBox::Yes) return;
+        m_fitter->stop();
+    }
+    QDialog::reject();
+}
+
+void JointFitDialog::onAnalysesChanged()
+{
+    if (m_fitter->isRunning()) return;
+
+    // 已列出的参数保留勾选状态，新出现的参数按默认规则勾选
+    QMap<QString, bool> previous;
+    for (int i = 0; i < m_listShared->count(); ++i)
+        previous.insert(m_listShared->item(i)->text(), m_listShared->item(i)->checkState() == Qt::Checked);
+
+    m_members.clear();
+    QStringList skipped;
+    for (int i = 0; i < m_listAnalyses->count(); ++i) {
+        QListWidgetItem* item = m_listAnalyses->item(i);
+        if (item->checkState() != Qt::Checked) continue;
+        FittingJob job;
+        if (!m_factory || !m_factory(item->text(), job)) { skipped << item->text(); continue; }
+        job.analysisName = item->text();
+        m_members.append(job);
+    }
+
+    // 共用参数候选：各数据集参与拟合的参数并集
+    QStringList candidates;
+    for (const FittingJob& job : m_members) {
+        for (const FitParameter& p : job.params) {
+            if (p.isFit && p.name != "LfD" && !candidates.contains(p.name)) candidates << p.name;
+        }
+    }
+    const QStringList defaults = JointFitter::defaultSharedParameters(m_members);
+    m_listShared->clear();
+    for (const QString& name : candidates) {
+        QString chName, symbol, uniSymbol, unit;
+        FitParameterCatalog::getParamDisplayInfo(name, chName, symbol, uniSymbol, unit);
+        QListWidgetItem* item = new QListWidgetItem(name, m_listShared);
+        item->setToolTip(chName);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(previous.value(name, defaults.contains(name)) ? Qt::Checked : Qt::Unchecked);
+    }
+
+    refreshTable(QList<QMap<QString, double>>(), QVector<double>());
+    m_lblStatus->setText(skipped.isEmpty() ? QString("已选 %1 个分析").arg(m_members.size())
+                                           : QString("已选 %1 个分析；以下分析没有观测数据，已跳过：%2")
+                                                 .arg(m_members.size()).arg(skipped.join("、")));
+}
+
+void JointFitDialog::onStart()
+{
+    if (m_members.size() < 2) {
+        QMessageBox::warning(this, "提示", "请至少勾选两个有观测数据的分析页签。");
+        return;
+    }
+    QStringList shared;
+    for (int i = 0; i < m_listShared->count(); ++i) {
+        if (m_listShared->item(i)->checkState() == Qt::Checked) shared << m_listShared->item(i)->text();
+    }
+    m_fitter->setMembers(m_members);
+    m_fitter->setSharedParameters(shared);
+    if (!m_fitter->start()) return;
+    m_progress->setValue(0);
+    m_lblStatus->setText("联合拟合中...");
+    setRunning(true);
+}
+
+void JointFitDialog::onStop()
+{
+    m_fitter->stop();
+}
+
+void JointFitDialog::onApply()
+{
+    const QList<FittingJob> results = m_fitter->results();
+    bool any = false;
+    for (const FittingJob& job : results) {
+        if (job.result.isEmpty()) continue;
+        if (m_applier) m_applier(job);
+        any = true;
+    }
+    if (!any) {
+        QMessageBox::warning(this, "提示", "尚无联合拟合结果。");
+        return;
+    }
+    QMessageBox::information(this, "完成", QString("已将联合拟合结果应用到 %1 个分析。").arg(results.size()));
+}
+
+void JointFitDialog::onIterationUpdated(double error, QList<QMap<QString, double>> params)
+{
+    refreshTable(params, QVector<double>());
+    m_lblStatus->setText(QString("联合拟合中... 合计误差 %1").arg(error, 0, 'e', 3));
+}
+
+void JointFitDialog::onFinished()
+{
+    setRunning(false);
+    m_progress->setValue(100);
+    const QList<FittingJob> results = m_fitter->results();
+    QList<QMap<QString, double>> params;
+    QVector<double> mse;
+    bool stopped = false;
+    for (const FittingJob& job : results) {
+        params.append(job.result);
+        mse.append(job.mse);
+        stopped = stopped || job.state == FittingJob::Cancelled;
+    }
+    refreshTable(params, mse);
+    if (m_fitter->totalMse() < 0.0) {
+        m_lblStatus->setText("联合拟合未得到结果 (没有可拟合的参数或计算被中止)");
+        return;
+    }
+    m_lblStatus->setText(QString("联合拟合%1：合计误差 %2").arg(stopped ? "已停止" : "完成")
+                             .arg(m_fitter->totalMse(), 0, 'e', 3));
+}
+
+void JointFitDialog::refreshTable(const QList<QMap<QString, double>>& params, const QVector<double>& mse)
+{
+    const QStringList shared = m_fitter->isRunning() || !params.isEmpty() ? m_fitter->sharedParameters() : QStringList();
+    m_table->setRowCount(m_members.size());
+    for (int row = 0; row < m_members.size(); ++row) {
+        const FittingJob& job = m_members[row];
+        QStringList parts;
+        for (const FitParameter& p : job.params) {
+            const bool isShared = shared.contains(p.name);
+            if ((!p.isFit && !isShared) || p.name == "LfD") continue;
+            const double value = row < params.size() && params[row].contains(p.name) ? params[row].value(p.name) : p.value;
+            parts << QString("%1%2=%3").arg(p.name).arg(isShared ? "*" : "").arg(value, 0, 'g', 4);
+        }
+        const QStringList texts = QStringList() << job.analysisName << ModelManager::getModelTypeName(job.modelType)
+                                                << (row < mse.size() && mse[row] >= 0.0 ? QString::number(mse[row], 'e', 3)
+                                                                                          : QString("-"))
+                                                << parts.join(", ");
+        for (int c = 0; c < ColumnCount; ++c) {
+            if (!m_table->item(row, c)) m_table->setItem(row, c, new QTableWidgetItem());
+            m_table->item(row, c)->setText(texts[c]);
+        }
+    }
+}
+
+void JointFitDialog::setRunning(bool running)
+{
+    m_btnStart->setEnabled(!running);
+    m_btnStop->setEnabled(running);
+    m_btnApply->setEnabled(!running);
+    m_listAnalyses->setEnabled(!running);
+    m_listShared->setEnabled(!running);
+}
@@ -0,0 +1,69 @@
+/*
+ * 文件名: jointfitdialog.h
+ * 文件作用: 联合拟合对话框头文件
+ * 功能描述:
+ * 1. 勾选至少两个分析页签 (各自使用当前模型、参数与抽样设置)，勾选共用参数，合为一个 LM 问题联合拟合 (jointfitter.h)。
+ * 2. 共用参数列表为所选分析中参与拟合的参数并集，默认勾选各分析都参与拟合的储层参数 (井储与表皮除外)。
+ * 3. 结果表显示各分析的模型、误差与拟合参数；"应用结果"把全部分析的联合拟合参数写回对应页签。
+ * 4. 任务所需数据由 JobFactory 在开始时生成，运行期间不访问分析页签，对话框为模态。
+ */
+
+#ifndef JOINTFITDIALOG_H
+#define JOINTFITDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include <QTableWidget>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QLabel>
+#include <functional>
+#include "modelmanager.h"
+#include "fittingjobqueue.h"
+
+class JointFitter;
+
+class JointFitDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    // 由分析名称生成数据集 (使用该分析的当前模型；失败时返回 false，如该分析没有观测数据)
+    using JobFactory = std::function<bool(const QString& analysis, FittingJob& job)>;
+    // 把联合拟合结果写回分析页签
+    using ResultApplier = std::function<void(const FittingJob& job)>;
+
+    JointFitDialog(ModelManager* modelManager, const QStringList& analyses, const QString& currentAnalysis,
+                   JobFactory factory, ResultApplier applier, QWidget* parent = nullptr);
+
+protected:
+    void reject() override;
+
+private slots:
+    void onAnalysesChanged();
+    void onStart();
+    void onStop();
+    void onApply();
+    void onIterationUpdated(double error, QList<QMap<QString, double>> params);
+    void onFinished();
+
+private:
+    JointFitter* m_fitter;
+    JobFactory m_factory;
+    ResultApplier m_applier;
+    QList<FittingJob> m_members; // 当前勾选的分析生成的数据集
+
+    QListWidget* m_listAnalyses;
+    QListWidget* m_listShared;
+    QTableWidget* m_table;
+    QProgressBar* m_progress;
+    QLabel* m_lblStatus;
+    QPushButton* m_btnStart;
+    QPushButton* m_btnStop;
+    QPushButton* m_btnApply;
+
+    // 按数据集与当前参数刷新结果表
+    void refreshTable(const QList<QMap<QString, double>>& params, const QVector<double>& mse);
+    void setRunning(bool running);
+};
+
+#endif // JOINTFITDIALOG_H
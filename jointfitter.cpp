@@ -0,0 +1,400 @@
+/*
+ * 文件名: jointfitter.cpp
+ * 文件作用: 多井 / 多次测试联合拟合实现文件
+ * 功能描述:
+ * 1. 每个数据集创建一个 FittingCore (复制观测数据、产量历史与抽样设置，同 FittingJobQueue::startJob)，
+ *    残差与雅可比块由其 calculateResiduals / computeJacobian 计算，雅可比方式 (解析或差分) 与单独拟合一致。
+ * 2. 各数据集的计算作为线程池任务并行，任务内部串行 (ScopedSerialEvaluation，雅可比各列同样串行)，避免线程池嵌套；
+ *    拟合线程的取消令牌在各任务中重新安装。
+ * 3. 经典 LM 迭代：每次迭代各数据集按自身列构造 JᵀJ、Jᵀr (NormalEquations，任一数据集要求可复现时按固定顺序归约)，
+ *    合并为箭头结构后阻尼 λ·(1 + |Hᵢᵢ|)，先解共用参数的 Schur 补 S = A_ss - Σ A_sk A_kk⁻¹ A_ks，再逐块回代，
+ *    至多 5 次阻尼试探；合计误差下降时接受。
+ * 4. 共用参数的初值取第一个含有该参数的数据集，范围取各数据集的交集；步长施加后以第一个数据集的值为准
+ *    (kf > km 等约束修正在各数据集中分别进行，可能只在一侧生效)。
+ * 5. 最后一次刷新在令牌作用域之外按高精度计算各数据集的误差；用户停止时沿用迭代精度。
+ */
+
+#include "jointfitter.h"
+#include "fittingcore.h"
+#include "normalequations.h"
+#include "memoryaccounting.h"
+#include "tracing.h"
+
+#include <QtConcurrent>
+#include <QDebug>
+#include <cmath>
+
+JointFitter::JointFitter(ModelEngine* engine, QObject* parent)
+    : QObject(parent), m_engine(engine), m_totalMse(-1.0)
+{
+    qRegisterMetaType<QList<QMap<QString, double>>>("QList<QMap<QString,double>>");
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &JointFitter::sigFitFinished);
+}
+
+JointFitter::~JointFitter()
+{
+    stop();
+    waitForFinished();
+}
+
+void JointFitter::setMembers(const QList<FittingJob>& members)
+{
+    if (isRunning()) return;
+    m_members = members;
+    qDeleteAll(m_cores);
+    m_cores.clear();
+    for (const FittingJob& job : m_members) {
+        FittingCore* core = new FittingCore(this);
+        core->setModelEngine(m_engine);
+        core->setObservedDataset(job.observed);
+        if (!job.rateHistory.isEmpty()) core->setRateHistory(job.rateHistory, job.rateHistoryBuildup);
+        core->setSamplingSettings(job.samplingIntervals, job.customSampling);
+        core->setSamplingMode(job.samplingMode);
+        core->setReproducibility(job.reproducibility);
+        m_cores.append(core);
+    }
+}
+
+QList<FittingJob> JointFitter::members() const
+{
+    return m_members;
+}
+
+void JointFitter::setSharedParameters(const QStringList& names)
+{
+    if (!isRunning()) m_sharedNames = names;
+}
+
+QStringList JointFitter::sharedParameters() const
+{
+    return m_sharedNames;
+}
+
+QStringList JointFitter::defaultSharedParameters(const QList<FittingJob>& members)
+{
+    static const QStringList wellbore = QStringList() << "cD" << "C" << "S" << "LfD";
+    QStringList names;
+    if (members.isEmpty()) return names;
+    for (const FitParameter& p : members.first().params) {
+        if (!p.isFit || wellbore.contains(p.name)) continue;
+        bool everywhere = true;
+        for (int k = 1; k < members.size() && everywhere; ++k) {
+            bool found = false;
+            for (const FitParameter& q : members[k].params) {
+                if (q.name == p.name && q.isFit) { found = true; break; }
+            }
+            everywhere = found;
+        }
+        if (everywhere) names.append(p.name);
+    }
+    return names;
+}
+
+bool JointFitter::start()
+{
+    if (m_watcher.isRunning() || m_members.size() < 2 || !m_engine) return false;
+    m_cancellation.reset();
+    m_results.clear();
+    m_totalMse = -1.0;
+    m_watcher.setFuture(QtConcurrent::run([this]() { run(); }));
+    return true;
+}
+
+void JointFitter::stop()
+{
+    m_cancellation.cancel();
+}
+
+bool JointFitter::isRunning() const
+{
+    return m_watcher.isRunning();
+}
+
+void JointFitter::waitForFinished()
+{
+    m_watcher.waitForFinished();
+}
+
+QList<FittingJob> JointFitter::results() const
+{
+    return m_results;
+}
+
+double JointFitter::totalMse() const
+{
+    return m_totalMse;
+}
+
+int JointFitter::setupBlocks(QVector<Block>& blocks, QStringList& shared)
+{
+    // 共用参数：在任一数据集中参与拟合；初值取第一个数据集，范围取交集
+    shared.clear();
+    QMap<QString, FitParameter> sharedDef;
+    for (const QString& name : m_sharedNames) {
+        if (name == "LfD" || shared.contains(name)) continue;
+        bool fitted = false;
+        for (const FittingJob& job : m_members) {
+            for (const FitParameter& p : job.params) {
+                if (p.name != name) continue;
+                fitted = fitted || p.isFit;
+                if (!sharedDef.contains(name)) {
+                    sharedDef.insert(name, p);
+                } else {
+                    FitParameter& d = sharedDef[name];
+                    const double lo = qMax(d.min, p.min), hi = qMin(d.max, p.max);
+                    if (lo <= hi) { d.min = lo; d.max = hi; }
+                }
+            }
+        }
+        if (fitted) shared.append(name);
+    }
+
+    int next = shared.size();
+    blocks.resize(m_members.size());
+    for (int k = 0; k < m_members.size(); ++k) {
+        const FittingJob& job = m_members[k];
+        Block& b = blocks[k];
+        b.core = m_cores[k];
+        b.modelType = job.modelType;
+        b.weight = job.weight;
+        b.params = job.params;
+        b.localOffset = next;
+        for (int i = 0; i < b.params.size(); ++i) {
+            FitParameter& p = b.params[i];
+            const int s = shared.indexOf(p.name);
+            if (s >= 0) {
+                const FitParameter& d = sharedDef[p.name];
+                p.value = qBound(d.min, d.value, d.max);
+                p.min = d.min;
+                p.max = d.max;
+                p.isFit = true;
+            }
+            if (p.isFit && p.name != "LfD") {
+                b.fitIndices.append(i);
+                b.globalIndex.append(s >= 0 ? s : next++);
+            }
+            b.values.insert(p.name, p.value);
+        }
+        b.localCount = next - b.localOffset;
+        // 零步长：截断到范围并修正参数间约束 (kf > km、omega1 > omega2、LfD)
+        b.values = b.core->applyParameterStep(b.values, QVector<double>(b.fitIndices.size(), 0.0), b.fitIndices, b.params);
+        b.core->getSampledObservedData(b.t, b.obsP, b.obsD);
+    }
+    return next;
+}
+
+bool JointFitter::evaluateBlocks(QVector<Block>& blocks, const SolverSettings& settings, QVector<Eigen::MatrixXd>* jacobians)
+{
+    Block* data = blocks.data();
+    if (jacobians) jacobians->resize(blocks.size());
+    Eigen::MatrixXd* jacobianData = jacobians ? jacobians->data() : nullptr;
+    const CancellationToken* token = CancellationToken::current();
+
+    QVector<int> indices(blocks.size());
+    for (int k = 0; k < indices.size(); ++k) indices[k] = k;
+    const QList<bool> ok = QtConcurrent::blockingMapped(indices, [&](int k) -> bool {
+        ModelSolver01_06::ScopedSerialEvaluation serialScope;
+        CancellationToken::Scope cancellationScope(token);
+        Block& b = data[k];
+        b.core->m_iterationSettings = settings;
+        if (!jacobianData) {
+            b.residuals = b.core->calculateResiduals(settings, b.values, b.modelType, b.weight, b.t, b.obsP, b.obsD);
+            b.sse = b.core->calculateSumSquaredError(b.residuals);
+            return !b.residuals.isEmpty() && !(token && token->isCancelled());
+        }
+        const QVector<QVector<double>> rows = b.core->computeJacobian(b.values, b.residuals, b.fitIndices, b.modelType,
+                                                                      b.params, b.weight, b.t, b.obsP, b.obsD);
+        if ((token && token->isCancelled()) || rows.size() != b.residuals.size()) return false;
+        Eigen::MatrixXd& J = jacobianData[k];
+        J.resize(rows.size(), b.fitIndices.size());
+        for (int i = 0; i < rows.size(); ++i)
+            for (int j = 0; j < b.fitIndices.size(); ++j) J(i, j) = rows[i][j];
+        return true;
+    });
+    return !ok.contains(false);
+}
+
+Eigen::VectorXd JointFitter::solveDamped(const QVector<Eigen::MatrixXd>& A, const QVector<Eigen::VectorXd>& g,
+                                         const QVector<Block>& blocks, int nShared, int nTotal, double lambda) const
+{
+    // 箭头结构：A_ss 为各数据集共用列的合计，A_sk / A_kk 只与第 k 个数据集有关
+    const int nb = blocks.size();
+    Eigen::MatrixXd Ass = Eigen::MatrixXd::Zero(nShared, nShared);
+    Eigen::VectorXd gs = Eigen::VectorXd::Zero(nShared);
+    QVector<Eigen::MatrixXd> Ask(nb), Akk(nb);
+    QVector<Eigen::VectorXd> gk(nb);
+    for (int k = 0; k < nb; ++k) {
+        const Block& b = blocks[k];
+        Ask[k] = Eigen::MatrixXd::Zero(nShared, b.localCount);
+        Akk[k] = Eigen::MatrixXd::Zero(b.localCount, b.localCount);
+        gk[k] = Eigen::VectorXd::Zero(b.localCount);
+        for (int i = 0; i < b.globalIndex.size(); ++i) {
+            const int gi = b.globalIndex[i];
+            const bool si = gi < nShared;
+            const int li = gi - b.localOffset;
+            if (si) gs(gi) += g[k](i);
+            else gk[k](li) = g[k](i);
+            for (int j = 0; j < b.globalIndex.size(); ++j) {
+                const int gj = b.globalIndex[j];
+                const bool sj = gj < nShared;
+                const int lj = gj - b.localOffset;
+                if (si && sj) Ass(gi, gj) += A[k](i, j);
+                else if (si) Ask[k](gi, lj) = A[k](i, j);
+                else if (!sj) Akk[k](li, lj) = A[k](i, j);
+            }
+        }
+    }
+    for (int i = 0; i < nShared; ++i) Ass(i, i) += lambda * (1.0 + std::abs(Ass(i, i)));
+
+    // 逐块消去独立参数：A_kk⁻¹ A_ks 与 A_kk⁻¹ g_k
+    Eigen::MatrixXd S = Ass;
+    Eigen::VectorXd rhs = -gs;
+    QVector<Eigen::MatrixXd> X(nb);
+    QVector<Eigen::VectorXd> y(nb);
+    for (int k = 0; k < nb; ++k) {
+        if (blocks[k].localCount == 0) continue;
+        for (int i = 0; i < Akk[k].rows(); ++i) Akk[k](i, i) += lambda * (1.0 + std::abs(Akk[k](i, i)));
+        const Eigen::LDLT<Eigen::MatrixXd> ldlt(Akk[k]);
+        X[k] = ldlt.solve(Ask[k].transpose());
+        y[k] = ldlt.solve(gk[k]);
+        S -= Ask[k] * X[k];
+        rhs += Ask[k] * y[k];
+    }
+
+    Eigen::VectorXd delta = Eigen::VectorXd::Zero(nTotal);
+    Eigen::VectorXd ds = Eigen::VectorXd::Zero(nShared);
+    if (nShared > 0) ds = S.ldlt().solve(rhs);
+    delta.head(nShared) = ds;
+    for (int k = 0; k < nb; ++k) {
+        if (blocks[k].localCount == 0) continue;
+        delta.segment(blocks[k].localOffset, blocks[k].localCount) = -y[k] - X[k] * ds;
+    }
+    return delta;
+}
+
+QVector<QMap<QString, double>> JointFitter::applyStep(const QVector<Block>& blocks, const Eigen::VectorXd& delta,
+                                                      const QStringList& shared) const
+{
+    QVector<QMap<QString, double>> trial(blocks.size());
+    for (int k = 0; k < blocks.size(); ++k) {
+        const Block& b = blocks[k];
+        QVector<double> d(b.globalIndex.size());
+        for (int j = 0; j < d.size(); ++j) d[j] = delta(b.globalIndex[j]);
+        trial[k] = b.core->applyParameterStep(b.values, d, b.fitIndices, b.params);
+    }
+    // 共用参数以第一个含有该参数的数据集为准
+    for (const QString& name : shared) {
+        int owner = -1;
+        for (int k = 0; k < trial.size(); ++k) {
+            if (!trial[k].contains(name)) continue;
+            if (owner < 0) owner = k;
+            else trial[k][name] = trial[owner].value(name);
+        }
+    }
+    return trial;
+}
+
+void JointFitter::run()
+{
+    WT_TRACE_SCOPE("JointFitter::fit");
+    WT_MEMORY_SCOPE(MemoryAccounting::Fitter);
+    CancellationToken::Scope cancellationScope(&m_cancellation);
+
+    QVector<Block> blocks;
+    QStringList shared;
+    const int nTotal = setupBlocks(blocks, shared);
+    const int nShared = shared.size();
+    bool reproducible = false;
+    for (const FittingJob& job : m_members) reproducible = reproducible || job.reproducibility.reproducible;
+
+    // 迭代期低精度、最终刷新高精度 (与单独拟合相同)
+    SolverSettings finalSettings = m_engine->solverSettings().withHighPrecision(true);
+    finalSettings.useTypeCurveLibrary = false;
+    const SolverSettings iterationSettings = finalSettings.withHighPrecision(false);
+
+    auto totals = [](const QVector<Block>& bs, double& sse, int& count) {
+        sse = 0.0;
+        count = 0;
+        for (const Block& b : bs) { sse += b.sse; count += b.residuals.size(); }
+    };
+    auto currentValues = [](const QVector<Block>& bs) {
+        QList<QMap<QString, double>> values;
+        for (const Block& b : bs) values.append(b.values);
+        return values;
+    };
+
+    double sse = 0.0;
+    int nRes = 0;
+    bool valid = nTotal > 0 && evaluateBlocks(blocks, iterationSettings, nullptr);
+    if (valid) {
+        totals(blocks, sse, nRes);
+        emit sigIterationUpdated(sse / qMax(1, nRes), currentValues(blocks));
+    }
+
+    const int maxIter = 50;
+    double lambda = 0.01;
+    int iterations = 0;
+    for (int iter = 0; valid && iter < maxIter; ++iter) {
+        if (m_cancellation.isCancelled()) break;
+        if (sse / qMax(1, nRes) < 3e-3) break;
+        emit sigProgress(iter * 100 / maxIter);
+
+        QVector<Eigen::MatrixXd> J;
+        if (!evaluateBlocks(blocks, iterationSettings, &J)) break;
+        ++iterations;
+        QVector<Eigen::MatrixXd> A(blocks.size());
+        QVector<Eigen::VectorXd> g(blocks.size());
+        for (int k = 0; k < blocks.size(); ++k) {
+            NormalEquations::build(J[k], Eigen::Map<const Eigen::VectorXd>(blocks[k].residuals.constData(),
+                                                                           blocks[k].residuals.size()),
+                                   A[k], g[k], reproducible);
+        }
+
+        bool stepAccepted = false;
+        for (int tryIter = 0; tryIter < 5; ++tryIter) {
+            const Eigen::VectorXd delta = solveDamped(A, g, blocks, nShared, nTotal, lambda);
+            const QVector<QMap<QString, double>> values = applyStep(blocks, delta, shared);
+            QVector<Block> trial = blocks;
+            for (int k = 0; k < trial.size(); ++k) trial[k].values = values[k];
+            const bool evaluated = evaluateBlocks(trial, iterationSettings, nullptr);
+            if (m_cancellation.isCancelled()) break;
+            double trialSse = 0.0;
+            int trialCount = 0;
+            totals(trial, trialSse, trialCount);
+            if (evaluated && trialCount == nRes && trialSse < sse) {
+                blocks = trial;
+                sse = trialSse;
+                lambda /= 10.0;
+                stepAccepted = true;
+                emit sigIterationUpdated(sse / qMax(1, nRes), currentValues(blocks));
+                break;
+            }
+            lambda *= 10.0;
+        }
+        if (!stepAccepted && lambda > 1e10) break;
+    }
+
+    // 最后一次刷新：令牌作用域之外按高精度计算各数据集的误差 (用户停止时沿用迭代精度)
+    CancellationToken::Scope refreshScope(nullptr);
+    const bool stopped = m_cancellation.isCancelRequested();
+    if (valid) valid = evaluateBlocks(blocks, stopped ? iterationSettings : finalSettings, nullptr);
+
+    QList<FittingJob> results = m_members;
+    for (int k = 0; k < results.size() && k < blocks.size(); ++k) {
+        FittingJob& job = results[k];
+        job.state = stopped ? FittingJob::Cancelled : FittingJob::Finished;
+        job.progress = 100;
+        if (!valid) continue;
+        job.result = blocks[k].values;
+        job.mse = blocks[k].sse / qMax(1, blocks[k].residuals.size());
+        qDebug() << "联合拟合:" << job.analysisName << "MSE =" << job.mse;
+    }
+    if (valid) {
+        totals(blocks, sse, nRes);
+        m_totalMse = sse / qMax(1, nRes);
+        emit sigIterationUpdated(m_totalMse, currentValues(blocks));
+        qDebug() << "联合拟合: 数据集" << blocks.size() << "个，共用参数" << shared << "，未知量" << nTotal
+                 << "个，迭代" << iterations << "次，合计 MSE =" << m_totalMse;
+    }
+    m_results = results;
+}
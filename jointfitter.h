@@ -0,0 +1,107 @@
+/*
+ * 文件名: jointfitter.h
+ * 文件作用: 多井 / 多次测试联合拟合头文件
+ * 功能描述:
+ * 1. 把若干数据集 (同一口井的压降与恢复、或同一连通区块的相邻井) 合为一个 LM 问题：
+ *    共用参数 (默认为各数据集都参与拟合的储层参数，如 kf、omega、lambda、re) 在所有数据集中取同一值，
+ *    其余拟合参数 (默认井储 cD / C 与表皮 S) 各数据集独立。
+ * 2. 每个数据集沿用 FittingJob 的描述 (模型、参数、权重、观测数据、产量历史与抽样设置)，各自持有一个 FittingCore
+ *    计算残差块与雅可比块；各数据集的残差与雅可比块在全局线程池中并行计算。
+ * 3. 雅可比矩阵按块稀疏保存 (每个数据集只有共用列与自身的独立列)，法方程为箭头结构，
+ *    阻尼后经 Schur 补先解共用参数、再逐块回代独立参数，不构造完整的稠密雅可比矩阵。
+ * 4. 异步运行，可协作停止；结束后 results() 给出每个数据集的最终参数与误差 (MSE)，可按 FittingJob 写回分析页签。
+ * 5. [计算核心] 只依赖不含界面的 ModelEngine 与 FittingCore，可在命令行批处理中使用。
+ */
+
+#ifndef JOINTFITTER_H
+#define JOINTFITTER_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QVector>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <Eigen/Dense>
+#include "modelengine.h"
+#include "fittingjobqueue.h"
+#include "cancellationtoken.h"
+
+class FittingCore;
+
+class JointFitter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JointFitter(ModelEngine* engine, QObject* parent = nullptr);
+    ~JointFitter();
+
+    // 参与联合拟合的数据集 (至少两个；运行期间不可修改)
+    void setMembers(const QList<FittingJob>& members);
+    QList<FittingJob> members() const;
+
+    // 共用参数名：在任一数据集中参与拟合的同名参数在全部含有该参数的数据集中共用一个值 (取第一个数据集的初值，范围取交集)
+    void setSharedParameters(const QStringList& names);
+    QStringList sharedParameters() const;
+
+    // 默认共用参数：各数据集都参与拟合的参数，井储 (cD、C) 与表皮 (S) 除外
+    static QStringList defaultSharedParameters(const QList<FittingJob>& members);
+
+    // 开始联合拟合 (已在运行或数据集不足两个时返回 false)
+    bool start();
+    void stop();
+    bool isRunning() const;
+    void waitForFinished();
+
+    // 最近一次联合拟合的结果：各数据集的最终参数 (result)、误差 (mse) 与状态 (用户停止时为 Cancelled)
+    QList<FittingJob> results() const;
+    // 全部残差合计的误差 (SSE / 残差总数)，尚无结果时为负
+    double totalMse() const;
+
+signals:
+    // 接受步后的合计误差与各数据集的当前参数 (顺序与 members 一致)
+    void sigIterationUpdated(double error, QList<QMap<QString, double>> params);
+    void sigProgress(int percent);
+    void sigFitFinished();
+
+private:
+    // 一个数据集在联合问题中的状态 (仅拟合线程读写)
+    struct Block {
+        FittingCore* core = nullptr;
+        QList<FitParameter> params;     // 共用参数的范围已取交集
+        QVector<int> fitIndices;        // 参与拟合的参数 (params 下标)
+        QVector<int> globalIndex;       // fitIndices 各列在联合未知量中的位置 (共用参数在前，各数据集的独立参数依次在后)
+        int localOffset = 0;            // 本数据集独立参数在联合未知量中的起始位置
+        int localCount = 0;             // 本数据集独立参数的个数
+        ModelEngine::ModelType modelType = ModelEngine::Model_1;
+        double weight = 0.5;
+        QVector<double> t, obsP, obsD;  // 抽样后的观测数据
+        QMap<QString, double> values;   // 当前参数
+        QVector<double> residuals;
+        double sse = 0.0;
+    };
+
+    ModelEngine* m_engine;
+    QList<FittingJob> m_members;
+    QStringList m_sharedNames;
+    QList<FittingJob> m_results;      // 拟合线程结束时写入
+    double m_totalMse;
+    CancellationToken m_cancellation;
+    QFutureWatcher<void> m_watcher;
+    QList<FittingCore*> m_cores;      // 与 m_members 一一对应
+
+    void run();
+    // 按共用参数建立联合未知量，返回未知量总数 (shared 返回共用参数名)
+    int setupBlocks(QVector<Block>& blocks, QStringList& shared);
+    // 各数据集并行计算：jacobians 为空时计算残差与误差平方和，否则在当前残差处计算雅可比块；
+    // 任一数据集被取消或失败时返回 false
+    bool evaluateBlocks(QVector<Block>& blocks, const SolverSettings& settings, QVector<Eigen::MatrixXd>* jacobians);
+    // 阻尼箭头法方程 (A、g 为各数据集按自身列的 JᵀJ、Jᵀr)：共用参数的 Schur 补求解后逐块回代
+    Eigen::VectorXd solveDamped(const QVector<Eigen::MatrixXd>& A, const QVector<Eigen::VectorXd>& g,
+                                const QVector<Block>& blocks, int nShared, int nTotal, double lambda) const;
+    // 联合步长施加到各数据集 (共用参数写入全部含有该参数的数据集)
+    QVector<QMap<QString, double>> applyStep(const QVector<Block>& blocks, const Eigen::VectorXd& delta,
+                                             const QStringList& shared) const;
+};
+
+#endif // JOINTFITTER_H
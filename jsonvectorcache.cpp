@@ -0,0 +1,86 @@
+/*
+ * jsonvectorcache.cpp
+ * 文件作用: 数值数组的 JSON 编码缓存实现文件
+ * 功能描述:
+ * 1. 空数组不入缓存 (不同的空数组可能共用同一个静态数据块，直接编码的代价也可以忽略)。
+ */
+
+#include "jsonvectorcache.h"
+#include <QByteArray>
+#include <QtEndian>
+#include <cstring>
+
+JsonVectorCache::Entry& JsonVectorCache::entryFor(const QVector<double>& values)
+{
+    auto it = m_entries.find(values.constData());
+    if (it == m_entries.end() || it->source.size() != values.size()) {
+        Entry entry;
+        entry.source = values;
+        it = m_entries.insert(values.constData(), entry);
+    }
+    it->used = true;
+    return *it;
+}
+
+QJsonArray JsonVectorCache::encode(const QVector<double>& values)
+{
+    if (values.isEmpty()) return QJsonArray();
+
+    Entry& entry = entryFor(values);
+    if (!entry.hasJson) {
+        for (double v : values) entry.json.append(v);
+        entry.hasJson = true;
+    }
+    return entry.json;
+}
+
+QString JsonVectorCache::encodeBinary(const QVector<double>& values)
+{
+    if (values.isEmpty()) return QString();
+
+    Entry& entry = entryFor(values);
+    if (!entry.hasBinary) {
+        entry.binary = toBinary(values);
+        entry.hasBinary = true;
+    }
+    return entry.binary;
+}
+
+QString JsonVectorCache::toBinary(const QVector<double>& values)
+{
+    QByteArray bytes(values.size() * int(sizeof(double)), Qt::Uninitialized);
+    char* out = bytes.data();
+    for (double v : values) {
+        quint64 bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        qToLittleEndian(bits, out);
+        out += sizeof(bits);
+    }
+    return QString::fromLatin1(bytes.toBase64());
+}
+
+QVector<double> JsonVectorCache::fromBinary(const QString& text)
+{
+    const QByteArray bytes = QByteArray::fromBase64(text.toLatin1());
+    const int n = bytes.size() / int(sizeof(double));
+    QVector<double> values(n);
+    const char* in = bytes.constData();
+    for (int i = 0; i < n; ++i) {
+        const quint64 bits = qFromLittleEndian<quint64>(in);
+        std::memcpy(&values[i], &bits, sizeof(bits));
+        in += sizeof(bits);
+    }
+    return values;
+}
+
+void JsonVectorCache::prune()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (!it->used) {
+            it = m_entries.erase(it);
+        } else {
+            it->used = false;
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ * jsonvectorcache.h
+ * 文件作用: 数值数组的 JSON 编码缓存头文件
+ * 功能描述:
+ * 1. 项目保存时曲线数据、观测数据等大数组需逐元素转换为 QJsonArray，多数数组在两次保存之间并未改变。
+ * 2. 缓存以数组的共享数据块识别同一数组：缓存持有数组的一份隐式共享副本，原数组被修改时必然先分离出新的数据块，
+ *    因此数据块地址相同即内容未变，直接返回上次的 QJsonArray (同样隐式共享，不复制)。
+ * 3. prune 丢弃自上次 prune 以来未使用的项，避免为已删除的数组保留内存；每次完整保存后调用一次。
+ * 4. encodeBinary 把数组编码为一个 Base64 字符串 (小端 double 的原始字节)，用于需要内嵌、但不必逐元素可读的数据：
+ *    编码与解码只需一次内存复制，文件比逐元素的数字文本小，读取时也不再逐个解析数字。
+ */
+
+#ifndef JSONVECTORCACHE_H
+#define JSONVECTORCACHE_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QString>
+#include <QVector>
+
+class JsonVectorCache
+{
+public:
+    // 返回 values 的 JSON 数组 (与原先逐元素 append 的结果相同)
+    QJsonArray encode(const QVector<double>& values);
+    // 返回 values 的 Base64 二进制编码 (与 toBinary 相同)
+    QString encodeBinary(const QVector<double>& values);
+    // 丢弃自上次 prune 以来未被 encode 使用的项
+    void prune();
+    void clear() { m_entries.clear(); }
+
+    static QString toBinary(const QVector<double>& values);
+    // 解码 toBinary 的结果 (长度不是 8 的整数倍时忽略末尾不完整的字节)
+    static QVector<double> fromBinary(const QString& text);
+
+private:
+    struct Entry {
+        QVector<double> source; // 持有数据块，保证其地址在缓存期间不被复用
+        QJsonArray json;
+        QString binary;
+        bool hasJson = false;
+        bool hasBinary = false;
+        bool used = false;
+    };
+    // 查找 (或登记) values 对应的项并标记为已使用
+    Entry& entryFor(const QVector<double>& values);
+
+    QHash<const double*, Entry> m_entries;
+};
+
+#endif // JSONVECTORCACHE_H
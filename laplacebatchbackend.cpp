@@ -0,0 +1,174 @@
+/*
+ * laplacebatchbackend.cpp
+ * 文件作用: Laplace 储层响应批量求值后端实现文件
+ * 功能描述:
+ * 1. 进程级后端状态由一把互斥锁保护：设备命令队列串行使用，切换后端与停用设备时不会与正在进行的卸载交错。
+ * 2. 精度比对在持锁期间完成 (抽样项很少)，未通过时当前批次直接返回 false，调用方按 CPU 路径重新计算。
+ * 3. 抽样起点逐批轮换，长期运行时比对覆盖批次中的不同位置 (不同参数块与时间段)。
+ */
+
+#include "laplacebatchbackend.h"
+#include "tracing.h"
+#ifdef WT_ENABLE_OPENCL
+#include "opencllaplacebackend.h"
+#endif
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace {
+
+// 精度比对的抽样项数：启用后的首次卸载 / 之后每批
+const int FIRST_CHECK_SAMPLES = 16;
+const int CHECK_SAMPLES = 2;
+// 相对偏差容差：不小于 1e-5，裂缝积分容差较宽时按其 10 倍放宽
+const double CHECK_TOLERANCE_FLOOR = 1e-5;
+const double CHECK_TOLERANCE_SCALE = 10.0;
+// 抽样起点的逐批增量 (与常见批量规模互素)
+const quint64 SAMPLE_CURSOR_STEP = 7919;
+
+struct BackendState {
+    QMutex mutex;
+    std::unique_ptr<LaplaceBatchBackend> device; // 当前设备后端 (为空表示 CPU)
+    QString fallbackReason;
+    bool verified = false;    // 是否已完成启用后的首次比对
+    quint64 sampleCursor = 0;
+};
+
+BackendState& state()
+{
+    static BackendState s;
+    return s;
+}
+
+std::unique_ptr<LaplaceBatchBackend> createBackend(const QString& name, QString* error)
+{
+#ifdef WT_ENABLE_OPENCL
+    if (name == QLatin1String(OpenClLaplaceBackend::Name)) {
+        std::unique_ptr<OpenClLaplaceBackend> backend(new OpenClLaplaceBackend);
+        if (!backend->initialize(error)) return nullptr;
+        return std::unique_ptr<LaplaceBatchBackend>(backend.release());
+    }
+#endif
+    if (error) *error = QString("后端 %1 未编译进本程序").arg(name);
+    return nullptr;
+}
+
+// 停用设备后端 (调用方持锁)
+void disableDevice(BackendState& s, const QString& reason)
+{
+    s.device.reset();
+    s.fallbackReason = reason;
+    s.verified = false;
+}
+
+} // namespace
+
+QStringList LaplaceBatchBackend::availableBackends()
+{
+    QStringList names;
+    names << "cpu";
+#ifdef WT_ENABLE_OPENCL
+    names << QLatin1String(OpenClLaplaceBackend::Name);
+#endif
+    return names;
+}
+
+bool LaplaceBatchBackend::setPreferredBackend(const QString& name)
+{
+    BackendState& s = state();
+    QMutexLocker locker(&s.mutex);
+    if (name.isEmpty() || name == "cpu") {
+        s.device.reset();
+        s.fallbackReason.clear();
+        s.verified = false;
+        return true;
+    }
+    if (s.device && s.device->name() == name) return true;
+
+    QString error;
+    std::unique_ptr<LaplaceBatchBackend> backend = createBackend(name, &error);
+    if (!backend) {
+        disableDevice(s, error);
+        return false;
+    }
+    s.device = std::move(backend);
+    s.fallbackReason.clear();
+    s.verified = false;
+    return true;
+}
+
+QString LaplaceBatchBackend::activeBackend()
+{
+    BackendState& s = state();
+    QMutexLocker locker(&s.mutex);
+    return s.device ? s.device->name() : QString("cpu");
+}
+
+QString LaplaceBatchBackend::activeDescription()
+{
+    BackendState& s = state();
+    QMutexLocker locker(&s.mutex);
+    return s.device ? s.device->description() : QString("CPU (线程池)");
+}
+
+QString LaplaceBatchBackend::lastFallbackReason()
+{
+    BackendState& s = state();
+    QMutexLocker locker(&s.mutex);
+    return s.fallbackReason;
+}
+
+bool LaplaceBatchBackend::offloadReservoir(const LaplaceBatchRequest& request, QVector<double>& out)
+{
+    const int n = request.size();
+    if (n < MinimumOffloadItems || request.paramIndex.size() != n) return false;
+
+    BackendState& s = state();
+    QMutexLocker locker(&s.mutex);
+    if (!s.device) return false;
+    for (const ModelParams& p : request.params) {
+        if (!s.device->supports(p)) return false;
+    }
+
+    WT_TRACE_SCOPE("LaplaceBatchBackend::offloadReservoir");
+    QString error;
+    if (!s.device->evaluate(request, out, &error) || out.size() != n) {
+        disableDevice(s, QString("设备计算失败，已回退到 CPU: %1").arg(error));
+        return false;
+    }
+
+    // 跨后端精度比对：抽样项在 CPU 上重算 (设备标记为 NaN 的项随后补算，不参与比对)
+    const int samples = std::min(n, s.verified ? CHECK_SAMPLES : FIRST_CHECK_SAMPLES);
+    const quint64 stride = quint64(n / samples);
+    for (int i = 0; i < samples; ++i) {
+        const int k = int((s.sampleCursor + quint64(i) * stride) % quint64(n));
+        if (!std::isfinite(out[k])) continue;
+        const ModelParams& p = request.params[request.paramIndex[k]];
+        double reference = 0.0;
+        ModelSolver01_06::evaluateReservoirBatch(request.type, p, &request.z[k], &reference, 1);
+        if (!std::isfinite(reference)) continue;
+        const double tolerance = std::max(CHECK_TOLERANCE_FLOOR, CHECK_TOLERANCE_SCALE * p.quadratureTolerance);
+        const double deviation = std::abs(out[k] - reference) / std::max(std::abs(reference), 1e-300);
+        if (deviation > tolerance) {
+            disableDevice(s, QString("设备结果与 CPU 偏差 %1 超过容差 %2 (z = %3)，已回退到 CPU")
+                                 .arg(deviation, 0, 'g', 3).arg(tolerance, 0, 'g', 3).arg(request.z[k], 0, 'g', 6));
+            return false;
+        }
+    }
+    s.sampleCursor += SAMPLE_CURSOR_STEP;
+    s.verified = true;
+    locker.unlock();
+
+    // 设备无法可靠求值的项 (Levinson 递推中断、残差超限等) 在 CPU 上补算
+    for (int k = 0; k < n; ++k) {
+        if (std::isfinite(out[k])) continue;
+        ModelSolver01_06::evaluateReservoirBatch(request.type, request.params[request.paramIndex[k]],
+                                                 &request.z[k], &out[k], 1);
+    }
+    return true;
+}
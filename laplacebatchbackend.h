@@ -0,0 +1,68 @@
+/*
+ * laplacebatchbackend.h
+ * 文件作用: Laplace 储层响应批量求值后端头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 敏感度网格、多起点搜索、类型曲线库生成与批量重解释最终都归结为大量互相独立的 (参数组, z) 储层响应求值，
+ *    LaplaceBatchBackend 把这类批量求值交给可选的设备后端 (OpenCL，qmake CONFIG+=wt_opencl 时编译)。
+ * 2. 后端为进程级选择 (设置项 performance/laplaceBackend：cpu / opencl，默认 cpu)；设备不可用、初始化失败
+ *    或参数块不受支持 (非等间距裂缝、段数超限) 时自动回退到 CPU 路径；复数节点的反演方法始终在 CPU 上计算。
+ * 3. 跨后端精度比对：每次卸载抽取若干求值项在 CPU 上重算 (启用后的首次卸载抽样更多)，
+ *    相对偏差超过容差时停用设备后端并记录原因，本批与之后的计算全部回到 CPU。
+ * 4. 设备结果与 CPU 的差异在裂缝积分容差量级 (设备端为固定分级的 Gauss-Kronrod 面板，CPU 为自适应积分)，
+ *    因此卸载结果不写入 Laplace 像函数缓存，缓存中始终是 CPU 计算的参考值。
+ */
+
+#ifndef LAPLACEBATCHBACKEND_H
+#define LAPLACEBATCHBACKEND_H
+
+#include "modelsolver01-06.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 一批储层响应求值：items 个 (参数块下标, 实数节点 z)
+struct LaplaceBatchRequest {
+    ModelSolver01_06::ModelType type = ModelSolver01_06::Model_1;
+    QVector<ModelParams> params;  // 参与本批的参数块
+    QVector<int> paramIndex;      // 各求值项对应的参数块下标
+    QVector<double> z;            // 各求值项的 Laplace 节点
+
+    int size() const { return z.size(); }
+};
+
+class LaplaceBatchBackend
+{
+public:
+    virtual ~LaplaceBatchBackend() = default;
+
+    // 后端名称 (设置项取值)
+    virtual QString name() const = 0;
+    // 设备与说明 (设置页与命令行显示)
+    virtual QString description() const = 0;
+    // 后端能否处理该参数块
+    virtual bool supports(const ModelParams& p) const = 0;
+    // 计算全部求值项的储层响应 (不含井储表皮)；单项无法可靠求值时写入 NaN，由调用方改在 CPU 上计算；
+    // 返回 false 表示设备错误 (error 给出原因)
+    virtual bool evaluate(const LaplaceBatchRequest& request, QVector<double>& out, QString* error) = 0;
+
+    // ---------------------- 进程级选择 ----------------------
+    // 本次编译可用的后端名称 (始终包含 "cpu")
+    static QStringList availableBackends();
+    // 选择后端：设备后端初始化失败时保持 CPU 并返回 false (原因见 lastFallbackReason)
+    static bool setPreferredBackend(const QString& name);
+    // 当前生效的后端名称 ("cpu" 或设备后端名)
+    static QString activeBackend();
+    static QString activeDescription();
+    // 最近一次回退到 CPU 的原因 (初始化失败、设备错误或精度比对未通过)
+    static QString lastFallbackReason();
+
+    // 求值项不少于该数目时才值得卸载 (主机与设备之间的传输与启动开销)
+    enum { MinimumOffloadItems = 2048 };
+
+    // 批量储层响应入口：设备后端生效、规模足够且全部参数块受支持时交给设备，并抽样与 CPU 结果比对，
+    // 设备标记为 NaN 的项在 CPU 上补算；返回 false 表示未卸载 (调用方按原 CPU 路径计算)
+    static bool offloadReservoir(const LaplaceBatchRequest& request, QVector<double>& out);
+};
+
+#endif // LAPLACEBATCHBACKEND_H
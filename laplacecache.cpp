@@ -0,0 +1,200 @@
+/*
+ * laplacecache.cpp
+ * 文件作用: Laplace 空间像函数求值缓存实现文件
+ * 功能描述:
+ * 1. 实现按位比较的缓存键及其哈希函数。
+ * 2. 实现分片加锁的查询/写入：不同分片的访问互不阻塞，适配时间点并行与雅可比矩阵并行。
+ * 3. 实现双代淘汰：当前代写满后降为旧代，原旧代整体释放，总条目数不超过 2 × 容量。
+ * 4. 实现命中/未命中原子计数与全局开关、容量设置。
+ */
+
+#include "laplacecache.h"
+
+#include <QMutexLocker>
+#include <QSettings>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+// 取浮点数的位模式 (+0 与 -0 统一，避免等值键哈希不同)
+inline quint64 doubleBits(double v)
+{
+    if (v == 0.0) v = 0.0;
+    quint64 bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+// 64 位混合函数 (splitmix64 终结步骤)
+inline quint64 mixBits(quint64 h, quint64 v)
+{
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+} // namespace
+
+// ---------------------- 缓存键 ----------------------
+
+bool LaplaceEvaluationCache::Key::operator==(const Key& o) const
+{
+    // 与 KeyHash 使用同一位模式，相等的键必定哈希相同
+    auto same = [](double a, double b) { return doubleBits(a) == doubleBits(b); };
+    return modelType == o.modelType && nf == o.nf && complexNode == o.complexNode
+           && same(zr, o.zr) && same(zi, o.zi)
+           && same(M12, o.M12) && same(LfD, o.LfD) && same(rmD, o.rmD) && same(reD, o.reD)
+           && same(omega1, o.omega1) && same(omega2, o.omega2)
+           && same(lambda1, o.lambda1) && same(lambda2, o.lambda2)
+           && same(eta12, o.eta12) && same(cD, o.cD) && same(S, o.S)
+           && same(earlyArgument, o.earlyArgument) && same(lateArgument, o.lateArgument)
+           && same(quadratureTolerance, o.quadratureTolerance) && quadratureDepth == o.quadratureDepth;
+}
+
+size_t LaplaceEvaluationCache::KeyHash::operator()(const Key& k) const
+{
+    quint64 h = (quint64(quint32(k.modelType)) << 33) ^ (quint64(quint32(k.nf)) << 1) ^ (k.complexNode ? 1ULL : 0ULL);
+    h = mixBits(h, doubleBits(k.zr));
+    h = mixBits(h, doubleBits(k.zi));
+    h = mixBits(h, doubleBits(k.M12));
+    h = mixBits(h, doubleBits(k.LfD));
+    h = mixBits(h, doubleBits(k.rmD));
+    h = mixBits(h, doubleBits(k.reD));
+    h = mixBits(h, doubleBits(k.omega1));
+    h = mixBits(h, doubleBits(k.omega2));
+    h = mixBits(h, doubleBits(k.lambda1));
+    h = mixBits(h, doubleBits(k.lambda2));
+    h = mixBits(h, doubleBits(k.eta12));
+    h = mixBits(h, doubleBits(k.cD));
+    h = mixBits(h, doubleBits(k.S));
+    h = mixBits(h, doubleBits(k.earlyArgument));
+    h = mixBits(h, doubleBits(k.lateArgument));
+    h = mixBits(h, doubleBits(k.quadratureTolerance) ^ quint64(quint32(k.quadratureDepth)));
+    return (size_t)h;
+}
+
+// ---------------------- 缓存实例 ----------------------
+
+LaplaceEvaluationCache& LaplaceEvaluationCache::instance()
+{
+    static LaplaceEvaluationCache s_instance;
+    return s_instance;
+}
+
+LaplaceEvaluationCache::LaplaceEvaluationCache()
+    : m_enabled(1)
+    , m_shardCapacity(1)
+    , m_hits(0)
+    , m_misses(0)
+{
+    // 默认开启，容量 65536 条 (约 10~25 MB)，可在设置中调整
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    m_enabled.storeRelaxed(settings.value("solver/laplaceCacheEnabled", true).toBool() ? 1 : 0);
+    setCapacity(settings.value("solver/laplaceCacheCapacity", 65536).toInt());
+}
+
+bool LaplaceEvaluationCache::lookup(const Key& key, std::complex<double>& value)
+{
+    if (!m_enabled.loadRelaxed()) return false;
+
+    size_t h = KeyHash()(key);
+    Shard& shard = m_shards[(h >> 7) % ShardCount];
+
+    QMutexLocker locker(&shard.mutex);
+    auto it = shard.current.find(key);
+    if (it != shard.current.end()) {
+        value = it->second;
+        m_hits.fetchAndAddRelaxed(1);
+        return true;
+    }
+
+    // 旧代命中：提升回当前代，使频繁使用的条目在下次淘汰时得以保留
+    auto old = shard.previous.find(key);
+    if (old != shard.previous.end()) {
+        value = old->second;
+        if ((int)shard.current.size() >= m_shardCapacity.loadRelaxed()) {
+            shard.previous.swap(shard.current);
+            shard.current.clear();
+        } else {
+            shard.previous.erase(old);
+        }
+        shard.current.emplace(key, value);
+        m_hits.fetchAndAddRelaxed(1);
+        return true;
+    }
+
+    m_misses.fetchAndAddRelaxed(1);
+    return false;
+}
+
+void LaplaceEvaluationCache::insert(const Key& key, const std::complex<double>& value)
+{
+    if (!m_enabled.loadRelaxed()) return;
+
+    size_t h = KeyHash()(key);
+    Shard& shard = m_shards[(h >> 7) % ShardCount];
+
+    QMutexLocker locker(&shard.mutex);
+    if ((int)shard.current.size() >= m_shardCapacity.loadRelaxed()) {
+        // 当前代写满：降为旧代，原旧代整体丢弃
+        shard.previous.swap(shard.current);
+        shard.current.clear();
+    }
+    shard.current[key] = value;
+}
+
+void LaplaceEvaluationCache::setEnabled(bool enabled)
+{
+    m_enabled.storeRelaxed(enabled ? 1 : 0);
+    if (!enabled) clear();
+}
+
+bool LaplaceEvaluationCache::isEnabled() const
+{
+    return m_enabled.loadRelaxed() != 0;
+}
+
+void LaplaceEvaluationCache::setCapacity(int capacity)
+{
+    capacity = std::max(capacity, ShardCount);
+    m_shardCapacity.storeRelaxed(capacity / ShardCount);
+}
+
+int LaplaceEvaluationCache::capacity() const
+{
+    return m_shardCapacity.loadRelaxed() * ShardCount;
+}
+
+void LaplaceEvaluationCache::clear()
+{
+    for (int i = 0; i < ShardCount; ++i) {
+        QMutexLocker locker(&m_shards[i].mutex);
+        Table().swap(m_shards[i].current);
+        Table().swap(m_shards[i].previous);
+    }
+    m_hits.storeRelaxed(0);
+    m_misses.storeRelaxed(0);
+}
+
+qint64 LaplaceEvaluationCache::hits() const
+{
+    return m_hits.loadRelaxed();
+}
+
+qint64 LaplaceEvaluationCache::misses() const
+{
+    return m_misses.loadRelaxed();
+}
+
+int LaplaceEvaluationCache::size() const
+{
+    int total = 0;
+    for (int i = 0; i < ShardCount; ++i) {
+        QMutexLocker locker(&m_shards[i].mutex);
+        total += (int)(m_shards[i].current.size() + m_shards[i].previous.size());
+    }
+    return total;
+}
@@ -0,0 +1,91 @@
+/*
+ * laplacecache.h
+ * 文件作用: Laplace 空间像函数求值缓存头文件
+ * 功能描述:
+ * 1. 以无因次 Laplace 输入 (z, M12, LfD, rmD, reD, omega1/2, lambda1/2, eta12, cD, S, nf, 模型类型) 为键，
+ *    缓存 flaplace_composite 的计算结果，供 LM 迭代与雅可比矩阵各列之间共享。
+ * 2. 只改变有因次缩放系数的参数 (q, B, h) 以及重复的试算点可直接命中缓存，跳过 Bessel/积分/LU 计算。
+ * 3. 采用分片加锁 + 双代淘汰策略，内存占用有上限，多线程并发访问安全。
+ * 4. 提供命中/未命中计数，便于评估缓存效果。
+ */
+
+#ifndef LAPLACECACHE_H
+#define LAPLACECACHE_H
+
+#include <QMutex>
+#include <QAtomicInteger>
+#include <complex>
+#include <unordered_map>
+
+class LaplaceEvaluationCache
+{
+public:
+    // 缓存键：像函数只依赖于以下无因次量，与 q/B/h 等有因次缩放系数无关
+    // 浮点数按位比较 (与哈希相同，仅 +0 与 -0 视为同一值；NaN 与自身相等)，保证命中时结果与重新计算逐位一致
+    struct Key {
+        int modelType = 0;        // 模型类型 (ModelSolver01_06::ModelType)
+        int nf = 0;               // 裂缝离散段数 (决定 xwD 节点)
+        bool complexNode = false; // 是否为复数节点 (实数/复数内核的舍入不同，需分开缓存)
+        double zr = 0.0;          // Laplace 变量实部
+        double zi = 0.0;          // Laplace 变量虚部
+        double M12 = 0.0, LfD = 0.0, rmD = 0.0, reD = 0.0;
+        double omega1 = 0.0, omega2 = 0.0, lambda1 = 0.0, lambda2 = 0.0;
+        double eta12 = 0.0, cD = 0.0, S = 0.0;
+        double earlyArgument = 0.0, lateArgument = 0.0; // 渐近快速路径阈值 (不同阈值下结果的舍入不同)
+        double quadratureTolerance = 0.0; // 裂缝积分容差与最大二分深度
+        int quadratureDepth = 0;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    // 全局共享实例 (首次访问时读取设置项 solver/laplaceCacheEnabled 与 solver/laplaceCacheCapacity)
+    static LaplaceEvaluationCache& instance();
+
+    // 查询缓存：命中时写入 value 并返回 true
+    bool lookup(const Key& key, std::complex<double>& value);
+
+    // 写入缓存 (当前代写满时整体降为旧代，旧代被丢弃)
+    void insert(const Key& key, const std::complex<double>& value);
+
+    // 开关与容量 (容量为缓存条目总数上限，实际内存约为 容量 × 2 × 200 字节)
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void setCapacity(int capacity);
+    int capacity() const;
+
+    // 清空缓存 (计数器同时归零)
+    void clear();
+
+    // 统计信息
+    qint64 hits() const;
+    qint64 misses() const;
+    int size() const;
+
+private:
+    LaplaceEvaluationCache();
+    LaplaceEvaluationCache(const LaplaceEvaluationCache&) = delete;
+    LaplaceEvaluationCache& operator=(const LaplaceEvaluationCache&) = delete;
+
+    typedef std::unordered_map<Key, std::complex<double>, KeyHash> Table;
+
+    // 单个分片：当前代 + 旧代，旧代中命中的条目会被提升回当前代 (近似 LRU)
+    struct Shard {
+        mutable QMutex mutex;
+        Table current;
+        Table previous;
+    };
+
+    static const int ShardCount = 16;
+
+    Shard m_shards[ShardCount];
+    QAtomicInteger<int> m_enabled;
+    QAtomicInteger<int> m_shardCapacity; // 每个分片当前代的条目上限
+    QAtomicInteger<qint64> m_hits;
+    QAtomicInteger<qint64> m_misses;
+};
+
+#endif // LAPLACECACHE_H
@@ -0,0 +1,127 @@
+/*
+ * laplaceinterpolant.cpp
+ * 文件作用: Laplace 像函数分段 Chebyshev 插值表实现文件
+ * 功能描述:
+ * 1. 初始段宽为一个对数周期，逐轮处理待定段：同一轮各段互相独立，可并行调用像函数。
+ * 2. 系数由 Lobatto 点上的离散余弦变换 (DCT-I) 求得，求值使用 Clenshaw 递推。
+ * 3. 插值对象取 ln F：储层响应的像函数在 z 的对数坐标下近似幂律，对数后各流动段都接近低次多项式。
+ */
+
+#include "laplaceinterpolant.h"
+#include "taskscheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+const double InitialPanelWidth = 2.302585092994046; // ln 10
+const double MinimumPanelWidth = InitialPanelWidth / 64.0;
+const int MaximumPanels = 256;
+
+} // namespace
+
+bool LaplaceInterpolant::build(double zMin, double zMax, const Kernel& kernel, double tolerance, bool parallel)
+{
+    m_panels.clear();
+    m_kernelEvaluations = 0;
+    if (!(zMin > 0.0) || !(zMax >= zMin) || !std::isfinite(zMax)) return false;
+
+    const double uMin = std::log(zMin);
+    const double uMax = std::max(std::log(zMax), uMin + 1e-12);
+    const int initialCount = std::max(1, int(std::ceil((uMax - uMin) / InitialPanelWidth)));
+
+    QVector<Panel> pending(initialCount);
+    for (int i = 0; i < initialCount; ++i) {
+        pending[i].a = uMin + (uMax - uMin) * i / initialCount;
+        pending[i].b = (i + 1 == initialCount) ? uMax : uMin + (uMax - uMin) * (i + 1) / initialCount;
+    }
+
+    // 各段的 Lobatto 点上的余弦值 cos(πj/n)
+    double cosTable[2 * Degree];
+    for (int j = 0; j < 2 * Degree; ++j) cosTable[j] = std::cos(M_PI * j / Degree);
+
+    QVector<Panel> accepted;
+    while (!pending.isEmpty()) {
+        if (accepted.size() + pending.size() > MaximumPanels) return false;
+        const int count = pending.size();
+        QVector<char> ok(count, 0);
+        QVector<double> tails(count, 0.0);
+        Panel* panels = pending.data();
+
+        auto fitPanel = [&](int i) {
+            Panel& panel = panels[i];
+            const double mid = 0.5 * (panel.a + panel.b);
+            const double half = 0.5 * (panel.b - panel.a);
+            double z[Degree + 1], g[Degree + 1];
+            for (int j = 0; j <= Degree; ++j) z[j] = std::exp(mid + half * cosTable[j]);
+            if (!kernel(z, g, Degree + 1)) return;
+            for (int j = 0; j <= Degree; ++j) {
+                if (!(g[j] > 0.0) || !std::isfinite(g[j])) return;
+                g[j] = std::log(g[j]);
+            }
+            // DCT-I：c_k = (2/n) Σ'' g_j cos(πjk/n)，首末两项减半
+            for (int k = 0; k <= Degree; ++k) {
+                double sum = 0.5 * (g[0] + ((k % 2) ? -g[Degree] : g[Degree]));
+                for (int j = 1; j < Degree; ++j) sum += g[j] * cosTable[(j * k) % (2 * Degree)];
+                panel.coefficients[k] = sum * 2.0 / Degree;
+            }
+            panel.coefficients[0] *= 0.5;
+            panel.coefficients[Degree] *= 0.5;
+            tails[i] = std::abs(panel.coefficients[Degree - 2]) + std::abs(panel.coefficients[Degree - 1])
+                       + std::abs(panel.coefficients[Degree]);
+            ok[i] = 1;
+        };
+
+        if (parallel && count > 1) {
+            TaskScheduler::parallelFor(count, fitPanel);
+        } else {
+            for (int i = 0; i < count; ++i) fitPanel(i);
+        }
+        m_kernelEvaluations += count * (Degree + 1);
+
+        QVector<Panel> next;
+        for (int i = 0; i < count; ++i) {
+            if (!ok[i]) { m_panels.clear(); return false; }
+            const Panel& panel = pending[i];
+            if (tails[i] <= tolerance) { accepted.append(panel); continue; }
+            const double width = panel.b - panel.a;
+            if (0.5 * width < MinimumPanelWidth) { m_panels.clear(); return false; }
+            Panel left, right;
+            left.a = panel.a;
+            left.b = right.a = panel.a + 0.5 * width;
+            right.b = panel.b;
+            next.append(left);
+            next.append(right);
+        }
+        pending = next;
+    }
+
+    std::sort(accepted.begin(), accepted.end(), [](const Panel& x, const Panel& y) { return x.a < y.a; });
+    m_panels = accepted;
+    return true;
+}
+
+double LaplaceInterpolant::evaluate(double z) const
+{
+    if (m_panels.isEmpty() || !(z > 0.0)) return 0.0;
+    const double u = std::log(z);
+    // 最后一个左端不大于 u 的段 (区间外按最近端段)
+    auto it = std::upper_bound(m_panels.constBegin(), m_panels.constEnd(), u,
+                               [](double v, const Panel& p) { return v < p.a; });
+    const Panel& panel = (it == m_panels.constBegin()) ? m_panels.first() : *(it - 1);
+
+    const double x = std::max(-1.0, std::min(1.0, (2.0 * u - panel.a - panel.b) / (panel.b - panel.a)));
+    // Clenshaw 递推
+    double b1 = 0.0, b2 = 0.0;
+    for (int k = Degree; k >= 1; --k) {
+        const double b0 = 2.0 * x * b1 - b2 + panel.coefficients[k];
+        b2 = b1;
+        b1 = b0;
+    }
+    return std::exp(x * b1 - b2 + panel.coefficients[0]);
+}
@@ -0,0 +1,52 @@
+/*
+ * laplaceinterpolant.h
+ * 文件作用: Laplace 像函数分段 Chebyshev 插值表头文件
+ * 功能描述:
+ * 1. 对一组已解析的模型参数，在 u = ln z 上把 g(u) = ln F(e^u) 分段表示为 Chebyshev 级数：
+ *    每段在 17 个 Chebyshev-Lobatto 点上调用精确像函数，由末三项系数之和估计插值误差 (即 F 的相对误差)，
+ *    超出容差的段对分后重新求值，直到全部段达到容差。
+ * 2. 建表后各时间点的实数 Laplace 节点 (Stehfest) 直接由插值给出：单条曲线的像函数调用次数只取决于
+ *    节点覆盖的对数区间与像函数的光滑程度，不再随时间点数增长。
+ * 3. 任一采样值非正或非有限、段宽低于下限、段数超过上限或调用方取消时建表失败，由调用方改用精确求值。
+ */
+
+#ifndef LAPLACEINTERPOLANT_H
+#define LAPLACEINTERPOLANT_H
+
+#include <QVector>
+
+#include <functional>
+
+class LaplaceInterpolant
+{
+public:
+    // 精确像函数：在 z[0..n) 上求值写入 out，取消时返回 false
+    using Kernel = std::function<bool(const double* z, double* out, int n)>;
+
+    // 在 [zMin, zMax] 上建表，tolerance 为 F 的相对误差上限；parallel 为 true 时同一轮的各段经 TaskScheduler 并行求值
+    bool build(double zMin, double zMax, const Kernel& kernel, double tolerance, bool parallel = true);
+
+    bool isValid() const { return !m_panels.isEmpty(); }
+
+    // 插值结果 (z 须在建表区间内，端点处的舍入偏差按最近端点处理)
+    double evaluate(double z) const;
+
+    // 最近一次建表的精确像函数调用次数与最终段数
+    int kernelEvaluations() const { return m_kernelEvaluations; }
+    int panelCount() const { return m_panels.size(); }
+
+    // 每段的 Chebyshev 阶数 (采样点数为 Degree + 1)
+    static const int Degree = 16;
+
+private:
+    struct Panel {
+        double a = 0.0; // 段左端 ln z
+        double b = 0.0; // 段右端 ln z
+        double coefficients[Degree + 1];
+    };
+
+    QVector<Panel> m_panels; // 按 a 递增排列
+    int m_kernelEvaluations = 0;
+};
+
+#endif // LAPLACEINTERPOLANT_H
@@ -0,0 +1,113 @@
+/*
+ * logbinsampler.cpp
+ * 文件作用: 对数分箱抽样工具实现文件
+ * 功能描述:
+ * 1. 第一次扫描确定区间内数据的实际时间范围，第二次扫描计算每个样本的箱号并完成平均值累加
+ *    (中值模式下同时统计各箱样本数)；中值模式再做一次分派扫描。
+ * 2. 箱号由 log10 t 直接计算，不依赖样本顺序；偶数个样本的中值取中间两值的平均。
+ */
+
+#include "logbinsampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 缓冲区 [begin, end) 的中值 (会重排元素)
+double medianOf(double* begin, double* end)
+{
+    const int n = int(end - begin);
+    double* mid = begin + n / 2;
+    std::nth_element(begin, mid, end);
+    if (n % 2 == 1) return *mid;
+    return 0.5 * (*mid + *std::max_element(begin, mid));
+}
+
+} // namespace
+
+void LogBinSampler::sample(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                           double tStart, double tEnd, int bins, Statistic statistic,
+                           QVector<double>& outT, QVector<double>& outP, QVector<double>& outD,
+                           int first, int last)
+{
+    if (last < 0 || last > t.size()) last = t.size();
+    first = std::max(0, first);
+    if (bins <= 0 || first >= last || !(tEnd >= tStart)) return;
+
+    auto valueAt = [](const QVector<double>& v, int i) { return i < v.size() ? v[i] : 0.0; };
+    auto accepted = [&](int i) {
+        const double ti = t[i];
+        return ti > 0.0 && ti >= tStart && ti <= tEnd
+               && std::isfinite(ti) && std::isfinite(valueAt(p, i)) && std::isfinite(valueAt(d, i));
+    };
+
+    // 区间内数据的实际时间范围
+    double dataMin = HUGE_VAL, dataMax = -HUGE_VAL;
+    int count = 0;
+    for (int i = first; i < last; ++i) {
+        if (!accepted(i)) continue;
+        dataMin = std::min(dataMin, t[i]);
+        dataMax = std::max(dataMax, t[i]);
+        ++count;
+    }
+    if (count == 0) return;
+
+    const double logMin = std::log10(dataMin);
+    const double width = (std::log10(dataMax) - logMin) / bins;
+    auto binOf = [&](double ti) {
+        if (!(width > 0.0)) return 0;
+        return std::min(bins - 1, std::max(0, int((std::log10(ti) - logMin) / width)));
+    };
+
+    QVector<double> sumT(bins, 0.0), sumP(bins, 0.0), sumD(bins, 0.0);
+    QVector<int> binCount(bins, 0);
+    QVector<int> binIndex; // 中值模式：各样本的箱号 (-1 表示不参与)
+    if (statistic == Median) binIndex.resize(last - first);
+    for (int i = first; i < last; ++i) {
+        if (!accepted(i)) {
+            if (statistic == Median) binIndex[i - first] = -1;
+            continue;
+        }
+        const int k = binOf(t[i]);
+        ++binCount[k];
+        if (statistic == Median) {
+            binIndex[i - first] = k;
+        } else {
+            sumT[k] += t[i];
+            sumP[k] += valueAt(p, i);
+            sumD[k] += valueAt(d, i);
+        }
+    }
+
+    if (statistic == Mean) {
+        for (int k = 0; k < bins; ++k) {
+            if (binCount[k] == 0) continue;
+            const double inv = 1.0 / binCount[k];
+            outT.append(sumT[k] * inv);
+            outP.append(sumP[k] * inv);
+            outD.append(sumD[k] * inv);
+        }
+        return;
+    }
+
+    // 各箱样本数的前缀和即该箱在缓冲区中的起点
+    QVector<int> offset(bins + 1, 0);
+    for (int k = 0; k < bins; ++k) offset[k + 1] = offset[k] + binCount[k];
+    QVector<double> bufT(count), bufP(count), bufD(count);
+    QVector<int> cursor = offset;
+    for (int i = first; i < last; ++i) {
+        const int k = binIndex[i - first];
+        if (k < 0) continue;
+        const int slot = cursor[k]++;
+        bufT[slot] = t[i];
+        bufP[slot] = valueAt(p, i);
+        bufD[slot] = valueAt(d, i);
+    }
+    for (int k = 0; k < bins; ++k) {
+        if (binCount[k] == 0) continue;
+        outT.append(medianOf(bufT.data() + offset[k], bufT.data() + offset[k + 1]));
+        outP.append(medianOf(bufP.data() + offset[k], bufP.data() + offset[k + 1]));
+        outD.append(medianOf(bufD.data() + offset[k], bufD.data() + offset[k + 1]));
+    }
+}
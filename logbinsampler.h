@@ -0,0 +1,35 @@
+/*
+ * logbinsampler.h
+ * 文件作用: 对数分箱抽样工具头文件
+ * 功能描述:
+ * 1. 把 [tStart, tEnd] 内 (实际取其中数据的最小、最大正时间) 按 log10 等宽划分为 bins 个箱，
+ *    每个非空箱输出一个点：时间、压差与导数分别取箱内平均值或中值，空箱不输出。
+ * 2. 直接读取源数组，不要求时间有序、不做排序；时间非正或任一通道非有限值的样本不参与统计。
+ * 3. 平均值：一次线性扫描按箱累加；中值：先统计各箱样本数，前缀和得到各箱在缓冲区中的起点，
+ *    再扫描一次分派样本，各箱用 nth_element 求中值，总代价 O(n) (不计箱内选择的常数)。
+ * 4. 源数据有序时调用方可用 [first, last) 限定下标范围，避免对区间外的样本重复扫描。
+ */
+
+#ifndef LOGBINSAMPLER_H
+#define LOGBINSAMPLER_H
+
+#include <QVector>
+
+class LogBinSampler
+{
+public:
+    // 箱内统计量
+    enum Statistic {
+        Mean = 0,  // 平均值 (抑制高频采样噪声)
+        Median = 1 // 中值 (同时抑制野值)
+    };
+
+    // 在源数据 [first, last) 下标范围内分箱，结果按时间递增追加到 outT/outP/outD；last < 0 表示到末尾。
+    // p、d 短于 t 时缺少的值按 0 处理
+    static void sample(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                       double tStart, double tEnd, int bins, Statistic statistic,
+                       QVector<double>& outT, QVector<double>& outP, QVector<double>& outD,
+                       int first = 0, int last = -1);
+};
+
+#endif // LOGBINSAMPLER_H
@@ -11,9 +11,11 @@
  * - [优化] 全新设计的 QComboBox：6px圆角、36px高度、现代化下拉效果。
  * 5. 设置全局调色板以适配不同系统主题。
  * 6. 启动主窗口。
+ * 7. [启动计时] 经 StartupProfile 记录样式表设置、主窗口构造与首帧的时间 (主窗口只构造项目页，其余页面延迟构造)。
  */
 
 #include "mainwindow.h"
+#include "startupprofile.h"
 #include <QApplication>
 #include <QStyleFactory>
 #include <QMessageBox>
@@ -65,12 +67,15 @@ public:
 
 int main(int argc, char *argv[])
 {
+    StartupProfile::start();
+
 // 解决 HighDpiScaling 在 Qt6 中已废弃的警告
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 #endif
 
     QApplication app(argc, argv);
+    StartupProfile::mark("QApplication");
 
     // [新增] 加载自定义翻译器，解决标准按钮(QDialogButtonBox)中文显示问题
     ChineseTranslator translator;
@@ -494,9 +499,12 @@ int main(int argc, char *argv[])
     palette.setColor(QPalette::HighlightedText, Qt::black);
 
     QApplication::setPalette(palette);
+    StartupProfile::mark("样式表");
 
     MainWindow w;
+    StartupProfile::mark("主窗口构造");
     w.show();
+    StartupProfile::mark("显示");
 
     return app.exec();
 }
@@ -6,6 +6,23 @@
  * 2. 实现了左侧导航栏的逻辑控制和页面切换。
  * 3. 协调数据在不同模块之间的流转。
  * 4. [新增] 实现了 onViewExportedFile 槽函数，在导出后自动切换到数据页并弹出配置对话框。
+ * 5. [自动备份] 项目打开后启动 ProjectAutoSaver，关闭前停止；系统设置变更时重新读取备份设置，备份结果显示在状态栏。
+ * 6. [变更合并] 数据表的内容修改以变更集直接交给图表界面，只有依赖变化列的曲线重新取数；
+ *    数据模型集合只在页签集合变化时重新交接。
+ * 7. [硬件加速] 系统设置变更时把 OpenGL 绘图开关交给所有图表 (MouseZoom::setOpenGlEnabled)。
+ * 8. [后台导出] 拟合页导出的曲线数据同样经 onViewExportedFile 在数据界面打开。
+ * 9. [延迟构造] 启动时只构造项目页与 (不含界面的) 模型管理器；其余页面在首次切换到时构造，
+ *    数据、图表与拟合页保存项目状态，在项目打开时构造；系统设置页在首次读取备份设置时构造。
+ *    各页面的构造耗时与首帧时间经 StartupProfile 汇总为启动报告。
+ * 10. [分段加载] 项目打开后立即恢复基础参数与拟合状态 (均在 .pwt 中)，导航随即可用；
+ *    表格与图表数据由 ModelParameter 在后台解析，哪一部分先就绪就先恢复对应页面 (二进制表格的页签仍在首次显示时解压)；
+ *    全部恢复后才启动自动备份，避免备份到不完整的项目。
+ * 11. [性能跟踪] 启动时按设置项打开跟踪开关；窗口动作 "导出性能跟踪" (Ctrl+Shift+T，主窗口无菜单栏) 与设置页的
+ *    导出按钮都经 onExportTrace 写出 Chrome trace 文件，可在 chrome://tracing 或 Perfetto 中查看。
+ * 12. [性能设置] 启动时与设置页保存后经 applyPerformanceSettings 应用：进程级设置 (线程池、缺省 nf、Laplace 缓存、
+ *    类型曲线库目录) 由 PerformanceSettings 完成，求解器池的空闲上限与默认求解器设置 (保留当前精度) 交给模型管理器，
+ *    理论曲线缓存上限交给拟合页；均即时生效，正在进行的计算不受影响。
+ * 13. [内存诊断] 启动时按设置项打开分配计数；窗口动作 "内存诊断" (Ctrl+Shift+M) 与设置页按钮打开同一个非模态面板。
  */
 
 #include "mainwindow.h"
@@ -19,11 +36,20 @@
 #include "fittingpage.h"
 #include "settingswidget.h"
 #include "pressurederivativecalculator.h"
+#include "projectautosaver.h"
+#include "mousezoom.h"
+#include "startupprofile.h"
+#include "tracing.h"
+#include "performancesettings.h"
+#include "memoryaccounting.h"
+#include "memorydiagnosticsdialog.h"
 
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QAction>
 #include <QMessageBox>
 #include <QDebug>
-#include <QStandardItemModel>
 #include <QTimer>
 #include <QSpacerItem>
 #include <QStackedWidget>
@@ -51,6 +77,13 @@ static QString getGlobalMessageBoxStyle()
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , m_ProjectWidget(nullptr)
+    , m_DataEditorWidget(nullptr)
+    , m_ModelManager(nullptr)
+    , m_PlottingWidget(nullptr)
+    , m_FittingPage(nullptr)
+    , m_SettingsWidget(nullptr)
+    , m_autoSaver(nullptr)
     , m_isProjectLoaded(false)
 {
     ui->setupUi(this);
@@ -63,6 +96,7 @@ MainWindow::MainWindow(QWidget *parent)
 // 析构函数
 MainWindow::~MainWindow()
 {
+    m_autoSaver->stop();
     delete ui;
 }
 
@@ -117,7 +151,8 @@ void MainWindow::init()
                         item++;
                     }
 
-                    // 切换堆叠窗口页面
+                    // 切换堆叠窗口页面 (页面在首次切换到时构造)
+                    ensurePage(targetIndex);
                     ui->stackedWidget->setCurrentIndex(targetIndex);
 
                     if (name == tr("图表")) {
@@ -137,39 +172,38 @@ void MainWindow::init()
     });
     m_timer.start(1000);
 
-    // --- 初始化子页面 ---
-    m_ProjectWidget = new WT_ProjectWidget(ui->pageMonitor);
-    ui->verticalLayoutMonitor->addWidget(m_ProjectWidget);
-    connect(m_ProjectWidget, &WT_ProjectWidget::projectOpened, this, &MainWindow::onProjectOpened);
-    connect(m_ProjectWidget, &WT_ProjectWidget::projectClosed, this, &MainWindow::onProjectClosed);
-    connect(m_ProjectWidget, &WT_ProjectWidget::fileLoaded, this, &MainWindow::onFileLoaded);
-
-    m_DataEditorWidget = new WT_DataWidget(ui->pageHand);
-    ui->verticalLayoutHandle->addWidget(m_DataEditorWidget);
-    connect(m_DataEditorWidget, &WT_DataWidget::fileChanged, this, &MainWindow::onFileLoaded);
-    connect(m_DataEditorWidget, &WT_DataWidget::dataChanged, this, &MainWindow::onDataEditorDataChanged);
-
-    m_PlottingWidget = new WT_PlottingWidget(ui->pageData);
-    ui->verticalLayout_2->addWidget(m_PlottingWidget);
-    // [新增] 连接导出的文件查看信号
-    connect(m_PlottingWidget, &WT_PlottingWidget::viewExportedFile, this, &MainWindow::onViewExportedFile);
+    // --- 初始化子页面 (启动时只构造项目页，其余页面见 ensurePage) ---
+    ensurePage(0);
 
+    // 模型管理器不含界面的部分供计算与拟合使用；模型界面在首次切换到模型页时构造
     m_ModelManager = new ModelManager(this);
-    m_ModelManager->initializeModels(ui->pageParamter);
     connect(m_ModelManager, &ModelManager::calculationCompleted, this, &MainWindow::onModelCalculationCompleted);
 
-    if (ui->pageFitting && ui->verticalLayoutFitting) {
-        m_FittingPage = new FittingPage(ui->pageFitting);
-        ui->verticalLayoutFitting->addWidget(m_FittingPage);
-        m_FittingPage->setModelManager(m_ModelManager);
-    } else {
-        qWarning() << "MainWindow: 拟合界面容器初始化失败";
-        m_FittingPage = nullptr;
-    }
+    connect(ModelParameter::instance(), &ModelParameter::sectionLoaded, this, &MainWindow::onProjectSectionLoaded);
+
+    m_autoSaver = new ProjectAutoSaver(this);
+    connect(m_autoSaver, &ProjectAutoSaver::backupWritten, this, [this](const QString&) {
+        if (this->statusBar()) this->statusBar()->showMessage("项目已自动备份", 5000);
+    });
+    connect(m_autoSaver, &ProjectAutoSaver::backupFailed, this, [this](const QString& message) {
+        if (this->statusBar()) this->statusBar()->showMessage("自动备份失败: " + message, 10000);
+    });
 
-    m_SettingsWidget = new SettingsWidget(ui->pageAlarm);
-    ui->verticalLayout_3->addWidget(m_SettingsWidget);
-    connect(m_SettingsWidget, &SettingsWidget::settingsChanged, this, &MainWindow::onSystemSettingsChanged);
+    // 性能跟踪：开关取自设置项，导出动作挂在主窗口上
+    Trace::applyGlobalSettings();
+    applyPerformanceSettings();
+    QAction* exportTraceAction = new QAction(tr("导出性能跟踪..."), this);
+    exportTraceAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_T));
+    exportTraceAction->setShortcutContext(Qt::ApplicationShortcut);
+    connect(exportTraceAction, &QAction::triggered, this, &MainWindow::onExportTrace);
+    addAction(exportTraceAction);
+
+    MemoryAccounting::applyGlobalSettings();
+    QAction* memoryAction = new QAction(tr("内存诊断..."), this);
+    memoryAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_M));
+    memoryAction->setShortcutContext(Qt::ApplicationShortcut);
+    connect(memoryAction, &QAction::triggered, this, &MainWindow::onShowMemoryDiagnostics);
+    addAction(memoryAction);
 
     initProjectForm();
     initDataEditorForm();
@@ -179,6 +213,85 @@ void MainWindow::init()
     initPredictionForm();
 }
 
+void MainWindow::ensurePage(int index)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QString name;
+
+    switch (index) {
+    case 0:
+        if (m_ProjectWidget) return;
+        name = tr("项目");
+        m_ProjectWidget = new WT_ProjectWidget(ui->pageMonitor);
+        ui->verticalLayoutMonitor->addWidget(m_ProjectWidget);
+        connect(m_ProjectWidget, &WT_ProjectWidget::projectOpened, this, &MainWindow::onProjectOpened);
+        connect(m_ProjectWidget, &WT_ProjectWidget::projectClosed, this, &MainWindow::onProjectClosed);
+        connect(m_ProjectWidget, &WT_ProjectWidget::fileLoaded, this, &MainWindow::onFileLoaded);
+        break;
+    case 1:
+        if (m_DataEditorWidget) return;
+        name = tr("数据");
+        m_DataEditorWidget = new WT_DataWidget(ui->pageHand);
+        ui->verticalLayoutHandle->addWidget(m_DataEditorWidget);
+        connect(m_DataEditorWidget, &WT_DataWidget::fileChanged, this, &MainWindow::onFileLoaded);
+        connect(m_DataEditorWidget, &WT_DataWidget::dataChanged, this, &MainWindow::onDataEditorDataChanged);
+        if (m_PlottingWidget)
+            connect(m_DataEditorWidget, &WT_DataWidget::sheetDataChanged, m_PlottingWidget, &WT_PlottingWidget::onSourceDataChanged);
+        break;
+    case 2:
+        if (m_PlottingWidget) return;
+        name = tr("图表");
+        m_PlottingWidget = new WT_PlottingWidget(ui->pageData);
+        ui->verticalLayout_2->addWidget(m_PlottingWidget);
+        // [新增] 连接导出的文件查看信号
+        connect(m_PlottingWidget, &WT_PlottingWidget::viewExportedFile, this, &MainWindow::onViewExportedFile);
+        if (m_DataEditorWidget)
+            connect(m_DataEditorWidget, &WT_DataWidget::sheetDataChanged, m_PlottingWidget, &WT_PlottingWidget::onSourceDataChanged);
+        break;
+    case 3:
+        if (m_modelPageBuilt) return;
+        name = tr("模型");
+        m_ModelManager->initializeModels(ui->pageParamter);
+        m_modelPageBuilt = true;
+        break;
+    case 4:
+        if (m_FittingPage) return;
+        if (!ui->pageFitting || !ui->verticalLayoutFitting) {
+            qWarning() << "MainWindow: 拟合界面容器初始化失败";
+            return;
+        }
+        name = tr("拟合");
+        m_FittingPage = new FittingPage(ui->pageFitting);
+        ui->verticalLayoutFitting->addWidget(m_FittingPage);
+        m_FittingPage->setModelManager(m_ModelManager);
+        connect(m_FittingPage, &FittingPage::viewExportedFile, this, &MainWindow::onViewExportedFile);
+        break;
+    case 6:
+        if (m_SettingsWidget) return;
+        name = tr("设置");
+        m_SettingsWidget = new SettingsWidget(ui->pageAlarm);
+        ui->verticalLayout_3->addWidget(m_SettingsWidget);
+        connect(m_SettingsWidget, &SettingsWidget::settingsChanged, this, &MainWindow::onSystemSettingsChanged);
+        connect(m_SettingsWidget, &SettingsWidget::traceExportRequested, this, &MainWindow::onExportTrace);
+        connect(m_SettingsWidget, &SettingsWidget::memoryDiagnosticsRequested, this, &MainWindow::onShowMemoryDiagnostics);
+        connect(m_SettingsWidget, &SettingsWidget::performanceSettingsChanged, this, &MainWindow::onPerformanceSettingsChanged);
+        break;
+    default:
+        return;
+    }
+
+    if (m_autoSaver) m_autoSaver->setSources(m_DataEditorWidget, m_PlottingWidget, m_FittingPage);
+    StartupProfile::recordPage(name, timer.elapsed());
+}
+
+void MainWindow::paintEvent(QPaintEvent* event)
+{
+    QMainWindow::paintEvent(event);
+    // 首次绘制完成后 (回到事件循环时) 输出启动报告
+    if (!StartupProfile::firstFrameShown()) QTimer::singleShot(0, this, [] { StartupProfile::firstFrame(); });
+}
+
 void MainWindow::initProjectForm() { qDebug() << "初始化项目界面"; }
 void MainWindow::initDataEditorForm() { qDebug() << "初始化数据编辑器界面"; }
 void MainWindow::initModelForm() { if (m_ModelManager) qDebug() << "模型界面初始化完成"; }
@@ -189,22 +302,31 @@ void MainWindow::initPredictionForm() { qDebug() << "初始化预测界面（预
 void MainWindow::onProjectOpened(bool isNew)
 {
     qDebug() << "项目已加载，模式:" << (isNew ? "新建" : "打开");
+    // 保存项目状态的页面在读入项目前构造
+    ensurePage(1);
+    ensurePage(2);
+    ensurePage(4);
     m_isProjectLoaded = true;
+    m_projectOpenTimer.start();
 
     if (m_ModelManager) m_ModelManager->updateAllModelsBasicParameters();
 
-    if (m_DataEditorWidget) {
-        if (!isNew) m_DataEditorWidget->loadFromProjectData();
-        if (m_FittingPage) m_FittingPage->setProjectDataModels(m_DataEditorWidget->getAllDataModels());
-    }
-
+    // 拟合状态随 .pwt 读入，立即恢复
     if (m_FittingPage) {
         m_FittingPage->updateBasicParameters();
         m_FittingPage->loadAllFittingStates();
     }
 
-    if (m_PlottingWidget) m_PlottingWidget->loadProjectData();
-
+    // 表格与图表数据：已就绪的部分立即恢复，其余在 onProjectSectionLoaded 中恢复
+    if (isNew) {
+        if (m_DataEditorWidget && m_FittingPage) m_FittingPage->setProjectDataModels(m_DataEditorWidget->getAllDataModels());
+        if (m_PlottingWidget) m_PlottingWidget->loadProjectData();
+    } else {
+        for (ModelParameter::ProjectSection section : {ModelParameter::TableSection, ModelParameter::PlottingSection}) {
+            if (ModelParameter::instance()->isSectionLoaded(section)) applyProjectSection(section);
+        }
+    }
+    if (ModelParameter::instance()->allSectionsLoaded()) finishProjectOpen();
     updateNavigationState();
 
     QString title = isNew ? "新建项目成功" : "加载项目成功";
@@ -219,11 +341,38 @@ void MainWindow::onProjectOpened(bool isNew)
     msgBox.exec();
 }
 
+void MainWindow::onProjectSectionLoaded(ModelParameter::ProjectSection section)
+{
+    if (!m_isProjectLoaded) return;
+    applyProjectSection(section);
+    if (ModelParameter::instance()->allSectionsLoaded()) finishProjectOpen();
+}
+
+void MainWindow::applyProjectSection(ModelParameter::ProjectSection section)
+{
+    if (section == ModelParameter::TableSection) {
+        if (!m_DataEditorWidget) return;
+        m_DataEditorWidget->loadFromProjectData();
+        if (m_FittingPage) m_FittingPage->setProjectDataModels(m_DataEditorWidget->getAllDataModels());
+    } else if (section == ModelParameter::PlottingSection) {
+        if (m_PlottingWidget) m_PlottingWidget->loadProjectData();
+    }
+}
+
+void MainWindow::finishProjectOpen()
+{
+    applyAutoSaveSettings();
+    m_autoSaver->start();
+    qInfo().noquote() << QString("项目数据已全部恢复，用时 %1 ms").arg(m_projectOpenTimer.elapsed());
+    if (this->statusBar()) this->statusBar()->showMessage(QString("项目数据已全部恢复 (%1 ms)").arg(m_projectOpenTimer.elapsed()), 5000);
+}
+
 void MainWindow::onProjectClosed()
 {
     qDebug() << "项目已关闭，重置界面状态...";
     m_isProjectLoaded = false;
     m_hasValidData = false;
+    m_autoSaver->stop();
 
     if (m_DataEditorWidget) m_DataEditorWidget->clearAllData();
     if (m_PlottingWidget) m_PlottingWidget->clearAllPlots();
@@ -255,6 +404,7 @@ void MainWindow::onFileLoaded(const QString& filePath, const QString& fileType)
         return;
     }
 
+    ensurePage(1);
     ui->stackedWidget->setCurrentIndex(1); // 自动跳转到数据页
 
     QMap<QString,NavBtn*>::Iterator item = m_NavBtnMap.begin();
@@ -280,6 +430,7 @@ void MainWindow::onFileLoaded(const QString& filePath, const QString& fileType)
 void MainWindow::onViewExportedFile(const QString& filePath)
 {
     // 1. 切换到数据界面
+    ensurePage(1);
     ui->stackedWidget->setCurrentIndex(1);
 
     // 2. 更新导航栏样式
@@ -322,20 +473,25 @@ void MainWindow::transferDataToFitting()
 {
     if (!m_FittingPage || !m_DataEditorWidget) return;
 
-    QStandardItemModel* model = m_DataEditorWidget->getDataModel();
-    if (!model || model->rowCount() == 0) return;
+    ColumnarTableModel* model = m_DataEditorWidget->getDataModel();
+    if (!model || model->rowCount() == 0 || model->columnCount() < 2) return;
 
     QVector<double> tVec, pVec, dVec;
     double p_initial = 0.0;
 
-    for(int r=0; r<model->rowCount(); ++r) {
-        double p = model->index(r, 1).data().toDouble();
+    // 文本与空单元格 (NaN) 按 0 处理
+    const ColumnarTableModel::ColumnSpan tColumn = model->columnSpan(0);
+    const ColumnarTableModel::ColumnSpan pColumn = model->columnSpan(1);
+    auto cell = [](double v) { return std::isnan(v) ? 0.0 : v; };
+
+    for(int r=0; r<pColumn.size; ++r) {
+        double p = cell(pColumn[r]);
         if (std::abs(p) > 1e-6) { p_initial = p; break; }
     }
 
-    for(int r=0; r<model->rowCount(); ++r) {
-        double t = model->index(r, 0).data().toDouble();
-        double p_raw = model->index(r, 1).data().toDouble();
+    for(int r=0; r<tColumn.size; ++r) {
+        double t = cell(tColumn[r]);
+        double p_raw = cell(pColumn[r]);
         if (t > 0) {
             tVec.append(t);
             pVec.append(std::abs(p_raw - p_initial));
@@ -360,10 +516,78 @@ void MainWindow::onFittingProgressChanged(int progress)
     }
 }
 
-void MainWindow::onSystemSettingsChanged() { qDebug() << "系统设置已变更"; }
-void MainWindow::onPerformanceSettingsChanged() {}
+void MainWindow::onSystemSettingsChanged()
+{
+    qDebug() << "系统设置已变更";
+    applyAutoSaveSettings();
+    MouseZoom::setOpenGlEnabled(m_SettingsWidget->isOpenGlEnabled());
+}
+
+void MainWindow::applyAutoSaveSettings()
+{
+    ensurePage(6);
+    m_autoSaver->configure(m_SettingsWidget->isBackupEnabled(), m_SettingsWidget->getBackupPath(),
+                           m_SettingsWidget->getAutoSaveInterval(), m_SettingsWidget->getMaxBackups());
+}
+void MainWindow::onPerformanceSettingsChanged()
+{
+    qDebug() << "性能设置已变更";
+    applyPerformanceSettings();
+}
+
+void MainWindow::applyPerformanceSettings()
+{
+    const PerformanceSettings performance = PerformanceSettings::fromGlobalSettings();
+    const bool curvesChanged = performance.apply();
+
+    if (m_ModelManager) {
+        m_ModelManager->solverPool().setMaxIdlePerEntry(2 * performance.effectiveWorkerThreads());
+        // 反演方法与阶数等取自设置项；精度与并行开关沿用当前值
+        const SolverSettings current = m_ModelManager->solverSettings();
+        SolverSettings settings = SolverSettings::fromGlobalSettings();
+        settings.highPrecision = current.highPrecision;
+        settings.parallelEvaluation = current.parallelEvaluation;
+        m_ModelManager->setSolverSettings(settings);
+    }
+    if (m_FittingPage) m_FittingPage->applyPerformanceSettings(curvesChanged);
+}
+
+void MainWindow::onExportTrace()
+{
+    QMessageBox msgBox;
+    msgBox.setWindowTitle("性能跟踪");
+    msgBox.setStyleSheet(getMessageBoxStyle());
+
+    if (Trace::eventCount() == 0) {
+        msgBox.setIcon(QMessageBox::Information);
+        msgBox.setText(Trace::isEnabled() ? "尚未记录到跟踪事件，请先执行一次计算或拟合。"
+                                          : "性能跟踪未开启，请在 设置 - 系统与日志 中勾选后重新执行计算。");
+        msgBox.exec();
+        return;
+    }
+
+    QString path = QFileDialog::getSaveFileName(this, "导出性能跟踪", "welltest_trace.json", "Chrome Trace (*.json)");
+    if (path.isEmpty()) return;
+
+    QString error;
+    if (!Trace::exportChromeTrace(path, &error)) {
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setText("导出失败: " + error);
+        msgBox.exec();
+        return;
+    }
+    if (this->statusBar()) this->statusBar()->showMessage("性能跟踪已导出: " + path, 5000);
+}
+
+void MainWindow::onShowMemoryDiagnostics()
+{
+    if (!m_memoryDialog) m_memoryDialog = new MemoryDiagnosticsDialog(this);
+    m_memoryDialog->show();
+    m_memoryDialog->raise();
+    m_memoryDialog->activateWindow();
+}
 
-QStandardItemModel* MainWindow::getDataEditorModel() const
+ColumnarTableModel* MainWindow::getDataEditorModel() const
 {
     if (!m_DataEditorWidget) return nullptr;
     return m_DataEditorWidget->getDataModel();
@@ -384,7 +608,7 @@ bool MainWindow::hasDataLoaded()
 void MainWindow::transferDataFromEditorToPlotting()
 {
     if (!m_DataEditorWidget || !m_PlottingWidget) return;
-    QMap<QString, QStandardItemModel*> models = m_DataEditorWidget->getAllDataModels();
+    QMap<QString, ColumnarTableModel*> models = m_DataEditorWidget->getAllDataModels();
     m_PlottingWidget->setDataModels(models);
     if (!models.isEmpty()) m_hasValidData = true;
 }
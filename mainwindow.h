@@ -6,6 +6,11 @@
  * 2. 引入 ModelManager 头文件以访问模型系统。
  * 3. 定义主窗口与各个子模块（项目、数据、绘图、拟合）之间的交互接口。
  * 4. [新增] 增加了 onViewExportedFile 槽函数，处理从图表导出的文件跳转。
+ * 5. [自动备份] 持有 ProjectAutoSaver，按系统设置在后台定时备份已打开的项目。
+ * 6. [延迟构造] 除项目页外的功能页面在首次用到时由 ensurePage 构造；首帧绘制后输出启动耗时报告 (StartupProfile)。
+ * 7. [分段加载] 打开项目后先恢复基础参数与拟合状态，表格与图表数据在后台解析完成时 (onProjectSectionLoaded) 分别恢复。
+ * 8. [性能跟踪] onExportTrace 把已记录的跟踪事件导出为 Chrome trace 文件。
+ * 9. [内存诊断] onShowMemoryDiagnostics 打开非模态的内存诊断面板 (按子系统的分配统计与进程峰值内存)。
  */
 
 #ifndef MAINWINDOW_H
@@ -14,8 +19,10 @@
 #include <QMainWindow>
 #include <QMap>
 #include <QTimer>
-#include <QStandardItemModel>
+#include <QElapsedTimer>
 #include "modelmanager.h"
+#include "modelparameter.h"
+#include "columnartablemodel.h"
 
 // 前置声明各个功能页面的类
 class NavBtn;
@@ -24,6 +31,8 @@ class WT_DataWidget;
 class WT_PlottingWidget;
 class FittingPage;
 class SettingsWidget;
+class ProjectAutoSaver;
+class MemoryDiagnosticsDialog;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -48,11 +57,15 @@ public:
     void initFittingForm();     // 初始化拟合分析界面
     void initPredictionForm();  // 初始化产能预测界面 (预留)
 
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
 private slots:
     // --- 项目管理相关槽函数 ---
     void onProjectOpened(bool isNew);  // 项目打开或新建成功后触发
     void onProjectClosed();            // 项目关闭后触发
     void onFileLoaded(const QString& filePath, const QString& fileType); // 外部文件加载后触发
+    void onProjectSectionLoaded(ModelParameter::ProjectSection section); // 项目的表格或图表数据已在后台读入
 
     // --- 数据交互与分析相关槽函数 ---
     void onPlotAnalysisCompleted(const QString &analysisType, const QMap<QString, double> &results); // 绘图分析完成
@@ -66,6 +79,8 @@ private slots:
     // --- 设置与计算相关槽函数 ---
     void onSystemSettingsChanged();        // 系统设置变更
     void onPerformanceSettingsChanged();   // 性能设置变更
+    void onExportTrace();                  // 导出性能跟踪文件 (Ctrl+Shift+T 或设置页按钮)
+    void onShowMemoryDiagnostics();        // 打开内存诊断面板 (Ctrl+Shift+M 或设置页按钮)
     void onModelCalculationCompleted(const QString &analysisType, const QMap<QString, double> &results); // 模型计算完成
     void onFittingProgressChanged(int progress); // 拟合进度更新
 
@@ -79,17 +94,34 @@ private:
     WT_PlottingWidget* m_PlottingWidget;    // 图表分析页
     FittingPage* m_FittingPage;             // 拟合分析页
     SettingsWidget* m_SettingsWidget;       // 系统设置页
+    ProjectAutoSaver* m_autoSaver;          // 后台自动备份
+    MemoryDiagnosticsDialog* m_memoryDialog = nullptr; // 内存诊断面板 (首次打开时构造)
 
     QMap<QString, NavBtn*> m_NavBtnMap;     // 左侧导航按钮映射表
     QTimer m_timer;                         // 系统时间显示定时器
     bool m_hasValidData = false;            // 标记当前是否有有效数据
     bool m_isProjectLoaded = false;         // 标记项目是否已加载
+    bool m_modelPageBuilt = false;          // 模型页界面已构造
+    QElapsedTimer m_projectOpenTimer;       // 打开项目到全部数据恢复的用时
 
     // --- 内部辅助函数 ---
 
+    // 确保导航页 index 已构造 (首次调用时构造并记录耗时)；项目已打开时新构造的页面随即取得项目数据
+    void ensurePage(int index);
+
+    // 把已读入的项目部分交给对应页面；全部部分恢复后启动自动备份
+    void applyProjectSection(ModelParameter::ProjectSection section);
+    void finishProjectOpen();
+
     // 将数据编辑器中的所有数据传输给绘图模块 (Plotting)
     void transferDataFromEditorToPlotting();
 
+    // 按系统设置 (备份目录、间隔、份数) 配置自动备份
+    void applyAutoSaveSettings();
+
+    // 按性能设置配置线程池、缓存与求解器默认值 (启动时与设置保存后调用)
+    void applyPerformanceSettings();
+
     // 更新左侧导航栏的选中状态
     void updateNavigationState();
 
@@ -97,7 +129,7 @@ private:
     void transferDataToFitting();
 
     // 获取当前活动的数据模型 (单个)
-    QStandardItemModel* getDataEditorModel() const;
+    ColumnarTableModel* getDataEditorModel() const;
 
     // 获取当前活动文件的名称
     QString getCurrentFileName() const;
@@ -0,0 +1,248 @@
+/*
+ * 文件名: memoryaccounting.cpp
+ * 文件作用: 按子系统的内存分配计数与峰值统计实现文件
+ * 功能描述:
+ * 1. 替换的 operator new 在用户块前放 16 字节块头 (大小、子系统、是否计数)，保持默认的 16 字节对齐；
+ *    释放时只扣减分配时计入的块，运行期开关的切换不会使当前占用出现负值。
+ * 2. 对齐分配 (operator new(size_t, align_val_t)) 不替换，由标准库成对处理，不计入统计。
+ * 3. 计数器为静态存储期的原子量 (常量初始化)，程序启动阶段 (main 之前) 的分配也能安全进入。
+ */
+
+#include "memoryaccounting.h"
+
+#include <QFile>
+#include <QSettings>
+#include <cstdlib>
+#include <new>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#endif
+
+std::atomic<bool> MemoryAccounting::s_enabled(false);
+
+namespace {
+
+struct SubsystemCounters {
+    std::atomic<qint64> allocations{0};
+    std::atomic<qint64> frees{0};
+    std::atomic<qint64> totalBytes{0};
+    std::atomic<qint64> liveBytes{0};
+    std::atomic<qint64> peakBytes{0};
+};
+
+SubsystemCounters g_counters[MemoryAccounting::SubsystemCount];
+thread_local int t_subsystem = MemoryAccounting::Other;
+
+#ifdef WT_ALLOCATION_ACCOUNTING
+
+struct alignas(16) BlockHeader {
+    quint64 size;
+    quint32 subsystem;
+    quint32 counted;
+};
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader must keep the default new alignment");
+
+void recordAllocation(int subsystem, qint64 size)
+{
+    SubsystemCounters& c = g_counters[subsystem];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.totalBytes.fetch_add(size, std::memory_order_relaxed);
+    const qint64 live = c.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    qint64 peak = c.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void* accountedAllocate(std::size_t size) noexcept
+{
+    BlockHeader* header = static_cast<BlockHeader*>(std::malloc(size + sizeof(BlockHeader)));
+    if (!header) return nullptr;
+    header->size = size;
+    header->subsystem = (quint32)t_subsystem;
+    header->counted = MemoryAccounting::isEnabled() ? 1u : 0u;
+    if (header->counted) recordAllocation(header->subsystem, (qint64)size);
+    return header + 1;
+}
+
+void accountedFree(void* ptr) noexcept
+{
+    if (!ptr) return;
+    BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+    if (header->counted) {
+        SubsystemCounters& c = g_counters[header->subsystem];
+        c.frees.fetch_add(1, std::memory_order_relaxed);
+        c.liveBytes.fetch_sub((qint64)header->size, std::memory_order_relaxed);
+    }
+    std::free(header);
+}
+
+void* accountedAllocateOrThrow(std::size_t size)
+{
+    for (;;) {
+        if (void* p = accountedAllocate(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+#endif // WT_ALLOCATION_ACCOUNTING
+
+#ifdef Q_OS_LINUX
+// Linux /proc/self/status 中 "Key:   1234 kB" 形式的行
+qint64 procStatusBytes(const QByteArray& status, const char* key)
+{
+    const int pos = status.indexOf(key);
+    if (pos < 0) return -1;
+    const int end = status.indexOf('\n', pos);
+    const QByteArray line = status.mid(pos + (int)qstrlen(key), end < 0 ? -1 : end - pos - (int)qstrlen(key));
+    bool ok = false;
+    const qint64 kb = line.trimmed().split(' ').value(0).toLongLong(&ok);
+    return ok ? kb * 1024 : -1;
+}
+#endif
+
+} // namespace
+
+#ifdef WT_ALLOCATION_ACCOUNTING
+
+void* operator new(std::size_t size) { return accountedAllocateOrThrow(size); }
+void* operator new[](std::size_t size) { return accountedAllocateOrThrow(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return accountedAllocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return accountedAllocate(size); }
+void operator delete(void* ptr) noexcept { accountedFree(ptr); }
+void operator delete[](void* ptr) noexcept { accountedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { accountedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { accountedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { accountedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { accountedFree(ptr); }
+
+#endif // WT_ALLOCATION_ACCOUNTING
+
+bool MemoryAccounting::isCompiledIn()
+{
+#ifdef WT_ALLOCATION_ACCOUNTING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MemoryAccounting::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled && isCompiledIn(), std::memory_order_relaxed);
+}
+
+void MemoryAccounting::applyGlobalSettings()
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    setEnabled(settings.value("diagnostics/memoryAccountingEnabled", false).toBool());
+}
+
+QString MemoryAccounting::subsystemName(Subsystem subsystem)
+{
+    switch (subsystem) {
+    case DataModel: return "数据模型";
+    case Solver:    return "求解器";
+    case Fitter:    return "拟合";
+    case Plotting:  return "绘图";
+    case ProjectIO: return "项目读写";
+    default:        return "其他";
+    }
+}
+
+QVector<MemorySubsystemStats> MemoryAccounting::snapshot()
+{
+    QVector<MemorySubsystemStats> stats(SubsystemCount);
+    for (int i = 0; i < SubsystemCount; ++i) {
+        const SubsystemCounters& c = g_counters[i];
+        MemorySubsystemStats& s = stats[i];
+        s.name = subsystemName(Subsystem(i));
+        s.allocations = c.allocations.load(std::memory_order_relaxed);
+        s.frees = c.frees.load(std::memory_order_relaxed);
+        s.totalBytes = c.totalBytes.load(std::memory_order_relaxed);
+        s.liveBytes = c.liveBytes.load(std::memory_order_relaxed);
+        s.peakBytes = qMax(s.liveBytes, c.peakBytes.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
+
+void MemoryAccounting::resetPeaks()
+{
+    for (SubsystemCounters& c : g_counters) {
+        c.allocations.store(0, std::memory_order_relaxed);
+        c.frees.store(0, std::memory_order_relaxed);
+        c.totalBytes.store(0, std::memory_order_relaxed);
+        c.peakBytes.store(c.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+ProcessMemoryInfo MemoryAccounting::processMemory()
+{
+    ProcessMemoryInfo info;
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        info.currentBytes = (qint64)counters.WorkingSetSize;
+        info.peakBytes = (qint64)counters.PeakWorkingSetSize;
+    }
+#elif defined(Q_OS_LINUX)
+    QFile file("/proc/self/status");
+    if (file.open(QIODevice::ReadOnly)) {
+        const QByteArray status = file.readAll();
+        info.currentBytes = procStatusBytes(status, "VmRSS:");
+        info.peakBytes = procStatusBytes(status, "VmHWM:");
+    }
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info_data_t taskInfo;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&taskInfo, &count) == KERN_SUCCESS)
+        info.currentBytes = (qint64)taskInfo.resident_size;
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) info.peakBytes = (qint64)usage.ru_maxrss; // macOS 以字节为单位
+#endif
+    return info;
+}
+
+QJsonObject MemoryAccounting::toJson(bool onlyActive)
+{
+    QJsonObject root;
+    const ProcessMemoryInfo process = processMemory();
+    root["processCurrentBytes"] = double(process.currentBytes);
+    root["processPeakBytes"] = double(process.peakBytes);
+    root["allocationAccounting"] = isEnabled();
+    if (!isEnabled()) return root;
+
+    QJsonObject subsystems;
+    const char* keys[SubsystemCount] = { "other", "dataModel", "solver", "fitter", "plotting", "projectIO" };
+    const QVector<MemorySubsystemStats> stats = snapshot();
+    for (int i = 0; i < SubsystemCount; ++i) {
+        const MemorySubsystemStats& s = stats[i];
+        if (onlyActive && s.allocations == 0 && s.liveBytes == 0) continue;
+        QJsonObject item;
+        item["allocations"] = double(s.allocations);
+        item["frees"] = double(s.frees);
+        item["totalBytes"] = double(s.totalBytes);
+        item["liveBytes"] = double(s.liveBytes);
+        item["peakBytes"] = double(s.peakBytes);
+        subsystems[keys[i]] = item;
+    }
+    root["subsystems"] = subsystems;
+    return root;
+}
+
+int MemoryAccounting::enterScope(Subsystem subsystem)
+{
+    const int previous = t_subsystem;
+    t_subsystem = subsystem;
+    return previous;
+}
+
+void MemoryAccounting::leaveScope(int previous)
+{
+    t_subsystem = previous;
+}
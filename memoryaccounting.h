@@ -0,0 +1,107 @@
+/*
+ * 文件名: memoryaccounting.h
+ * 文件作用: 按子系统的内存分配计数与峰值统计头文件
+ * 功能描述:
+ * 1. 子系统 (Subsystem)：数据模型、求解器、拟合、绘图、项目读写，其余归入 "其他"。
+ *    WT_MEMORY_SCOPE(MemoryAccounting::Solver) 把所在作用域内本线程的分配记到该子系统 (嵌套时以最内层为准)，
+ *    线程池中的任务不继承调用方的子系统，需在任务函数内另行标注。
+ * 2. 分配计数通过替换全局 operator new / delete 实现，只统计经 C++ new 的分配 (QStandardItem、QMap 节点、
+ *    std::vector、QObject 等)；Qt 容器 (QVector/QString/QByteArray) 与 Eigen 直接使用 malloc，不在计数之内，
+ *    这部分由进程内存 (processMemory) 反映。
+ * 3. 编译期开关 WT_ALLOCATION_ACCOUNTING (默认关闭，见 computecore.pri)：关闭时不替换 operator new，
+ *    WT_MEMORY_SCOPE 展开为空；打开后仍需运行期开关 (设置项 diagnostics/memoryAccountingEnabled，默认关闭)，
+ *    关闭时每次分配只多一次原子读取与 16 字节块头。
+ * 4. 每个子系统统计分配 / 释放次数、累计分配字节数、当前占用与峰值占用；resetPeaks 把计数清零、峰值回落到当前占用，
+ *    用于逐段测量 (基准用例、一次拟合)。
+ * 5. processMemory 读取操作系统给出的进程当前与峰值内存 (Windows 工作集，Linux VmRSS / VmHWM)，与编译开关无关。
+ */
+
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+
+// 单个子系统的统计
+struct MemorySubsystemStats {
+    QString name;
+    qint64 allocations = 0;   // 分配次数
+    qint64 frees = 0;         // 释放次数
+    qint64 totalBytes = 0;    // 累计分配字节数
+    qint64 liveBytes = 0;     // 当前占用
+    qint64 peakBytes = 0;     // 峰值占用 (自上次 resetPeaks)
+};
+
+// 进程内存 (字节，无法获取时为 -1)
+struct ProcessMemoryInfo {
+    qint64 currentBytes = -1;
+    qint64 peakBytes = -1;
+};
+
+class MemoryAccounting
+{
+public:
+    enum Subsystem {
+        Other = 0,
+        DataModel,
+        Solver,
+        Fitter,
+        Plotting,
+        ProjectIO,
+        SubsystemCount
+    };
+
+    // 是否编译了分配计数 (WT_ALLOCATION_ACCOUNTING)
+    static bool isCompiledIn();
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // 未编译分配计数时设置无效
+    static void setEnabled(bool enabled);
+    // 按设置项 diagnostics/memoryAccountingEnabled 设置开关
+    static void applyGlobalSettings();
+
+    static QString subsystemName(Subsystem subsystem);
+
+    // 全部子系统的当前统计 (下标即 Subsystem)
+    static QVector<MemorySubsystemStats> snapshot();
+    // 计数清零，峰值回落到当前占用 (当前占用保持不变，保证之后的释放仍能正确扣减)
+    static void resetPeaks();
+
+    static ProcessMemoryInfo processMemory();
+
+    // 子系统统计与进程内存的 JSON 形式 (基准与批处理输出使用)；onlyActive 为 true 时省略没有分配的子系统
+    static QJsonObject toJson(bool onlyActive = true);
+
+    // 作用域标注 (WT_MEMORY_SCOPE 使用)：进入时返回之前的子系统，离开时恢复
+    static int enterScope(Subsystem subsystem);
+    static void leaveScope(int previous);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class MemoryScope
+{
+public:
+    explicit MemoryScope(MemoryAccounting::Subsystem subsystem) : m_previous(MemoryAccounting::enterScope(subsystem)) {}
+    ~MemoryScope() { MemoryAccounting::leaveScope(m_previous); }
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+    int m_previous;
+};
+
+#ifdef WT_ALLOCATION_ACCOUNTING
+#define WT_MEMORY_CONCAT_INNER(a, b) a##b
+#define WT_MEMORY_CONCAT(a, b) WT_MEMORY_CONCAT_INNER(a, b)
+#define WT_MEMORY_SCOPE(subsystem) MemoryScope WT_MEMORY_CONCAT(wtMemoryScope_, __LINE__)(subsystem)
+#else
+#define WT_MEMORY_SCOPE(subsystem) do {} while (0)
+#endif
+
+#endif // MEMORYACCOUNTING_H
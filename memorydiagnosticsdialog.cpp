@@ -0,0 +1,137 @@
+/*
+ * 文件名: memorydiagnosticsdialog.cpp
+ * 文件作用: 内存诊断面板实现文件
+ * 功能描述:
+ * 1. 界面由代码构建：进程内存标签、状态提示、子系统统计表、底部按钮。
+ * 2. 字节数按 KB / MB / GB 自动换算显示；末行为各子系统合计。
+ */
+
+#include "memorydiagnosticsdialog.h"
+#include "memoryaccounting.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+enum StatsColumn {
+    ColName = 0,
+    ColAllocations,
+    ColFrees,
+    ColTotal,
+    ColLive,
+    ColPeak,
+    StatsColumnCount
+};
+
+QString formatBytes(qint64 bytes)
+{
+    if (bytes < 0) return "-";
+    const double b = double(bytes);
+    if (b >= 1024.0 * 1024.0 * 1024.0) return QString::number(b / (1024.0 * 1024.0 * 1024.0), 'f', 2) + " GB";
+    if (b >= 1024.0 * 1024.0) return QString::number(b / (1024.0 * 1024.0), 'f', 1) + " MB";
+    if (b >= 1024.0) return QString::number(b / 1024.0, 'f', 1) + " KB";
+    return QString::number(bytes) + " B";
+}
+
+QTableWidgetItem* numberItem(const QString& text)
+{
+    QTableWidgetItem* item = new QTableWidgetItem(text);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+} // namespace
+
+MemoryDiagnosticsDialog::MemoryDiagnosticsDialog(QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle("内存诊断");
+    resize(760, 360);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    m_processLabel = new QLabel(this);
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+    m_statusLabel->setStyleSheet("color: #a05a00;");
+    mainLayout->addWidget(m_processLabel);
+    mainLayout->addWidget(m_statusLabel);
+
+    m_table = new QTableWidget(MemoryAccounting::SubsystemCount + 1, StatsColumnCount, this);
+    m_table->setHorizontalHeaderLabels({ "子系统", "分配次数", "释放次数", "累计分配", "当前占用", "峰值占用" });
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    mainLayout->addWidget(m_table);
+
+    QHBoxLayout* buttons = new QHBoxLayout();
+    QPushButton* btnReset = new QPushButton("重置峰值", this);
+    QPushButton* btnClose = new QPushButton("关闭", this);
+    buttons->addStretch();
+    buttons->addWidget(btnReset);
+    buttons->addWidget(btnClose);
+    mainLayout->addLayout(buttons);
+
+    connect(btnReset, &QPushButton::clicked, this, &MemoryDiagnosticsDialog::onResetPeaks);
+    connect(btnClose, &QPushButton::clicked, this, &QDialog::close);
+
+    m_timer.setInterval(1000);
+    connect(&m_timer, &QTimer::timeout, this, &MemoryDiagnosticsDialog::refresh);
+}
+
+void MemoryDiagnosticsDialog::showEvent(QShowEvent* event)
+{
+    QDialog::showEvent(event);
+    refresh();
+    m_timer.start();
+}
+
+void MemoryDiagnosticsDialog::hideEvent(QHideEvent* event)
+{
+    m_timer.stop();
+    QDialog::hideEvent(event);
+}
+
+void MemoryDiagnosticsDialog::refresh()
+{
+    const ProcessMemoryInfo process = MemoryAccounting::processMemory();
+    m_processLabel->setText(QString("进程内存: 当前 %1，峰值 %2").arg(formatBytes(process.currentBytes), formatBytes(process.peakBytes)));
+
+    if (!MemoryAccounting::isCompiledIn())
+        m_statusLabel->setText("分配计数未编译：在 computecore.pri 中打开 DEFINES += WT_ALLOCATION_ACCOUNTING 后重新编译。");
+    else if (!MemoryAccounting::isEnabled())
+        m_statusLabel->setText("分配计数未开启：在 设置 - 系统与日志 中勾选 \"统计各模块内存分配\"。");
+    else
+        m_statusLabel->setText("只统计经 C++ new 的分配；Qt 容器与 Eigen 的缓冲区计入进程内存。");
+
+    const QVector<MemorySubsystemStats> stats = MemoryAccounting::snapshot();
+    MemorySubsystemStats total;
+    total.name = "合计";
+    for (int i = 0; i <= stats.size(); ++i) {
+        const MemorySubsystemStats& s = (i < stats.size()) ? stats[i] : total;
+        m_table->setItem(i, ColName, new QTableWidgetItem(s.name));
+        m_table->setItem(i, ColAllocations, numberItem(QString::number(s.allocations)));
+        m_table->setItem(i, ColFrees, numberItem(QString::number(s.frees)));
+        m_table->setItem(i, ColTotal, numberItem(formatBytes(s.totalBytes)));
+        m_table->setItem(i, ColLive, numberItem(formatBytes(s.liveBytes)));
+        m_table->setItem(i, ColPeak, numberItem(formatBytes(s.peakBytes)));
+        if (i < stats.size()) {
+            total.allocations += s.allocations;
+            total.frees += s.frees;
+            total.totalBytes += s.totalBytes;
+            total.liveBytes += s.liveBytes;
+            total.peakBytes += s.peakBytes; // 各子系统峰值之和 (不同时出现时高于实际峰值)
+        }
+    }
+}
+
+void MemoryDiagnosticsDialog::onResetPeaks()
+{
+    MemoryAccounting::resetPeaks();
+    refresh();
+}
@@ -0,0 +1,41 @@
+/*
+ * 文件名: memorydiagnosticsdialog.h
+ * 文件作用: 内存诊断面板头文件
+ * 功能描述:
+ * 1. 非模态对话框，表格列出各子系统 (数据模型、求解器、拟合、绘图、项目读写、其他) 的分配 / 释放次数、
+ *    累计分配量、当前占用与峰值占用 (见 memoryaccounting.h)，上方显示进程当前与峰值内存。
+ * 2. 显示期间每秒刷新一次；"重置峰值" 把计数清零、峰值回落到当前占用，便于单独测量一次导入、计算或拟合。
+ * 3. 未编译分配计数或运行期开关关闭时只显示进程内存，并提示开启方法。
+ */
+
+#ifndef MEMORYDIAGNOSTICSDIALOG_H
+#define MEMORYDIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+class QLabel;
+class QTableWidget;
+
+class MemoryDiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit MemoryDiagnosticsDialog(QWidget* parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    void refresh();
+    void onResetPeaks();
+
+private:
+    QLabel* m_processLabel;
+    QLabel* m_statusLabel;
+    QTableWidget* m_table;
+    QTimer m_timer;
+};
+
+#endif // MEMORYDIAGNOSTICSDIALOG_H
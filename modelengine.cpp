@@ -0,0 +1,156 @@
+/*
+ * 文件名: modelengine.cpp
+ * 文件作用: 模型计算引擎实现文件
+ * 功能描述:
+ * 1. 计算接口由 ModelManager 迁入，行为不变：每次计算从 SolverPool 借出独占实例，结束时自动归还。
+ * 2. 变产量叠加：产量阶段过多时先自动分组，各参数组的单位响应在同一对数网格上批量计算后逐阶段叠加。
+ * 3. 求解器使用网格求值模式时，各次计算的插值误差估计只计入统计 (gridInterpolationError)，计算路径中不输出日志，
+ *    是否提示由界面或命令行决定。
+ */
+
+#include "modelengine.h"
+
+#include <QMutexLocker>
+#include <tuple>
+
+ModelEngine::ModelEngine()
+    : m_solverSettings(SolverSettings::fromGlobalSettings())
+{
+}
+
+ModelEngine::ModelEngine(const SolverSettings& settings)
+    : m_solverSettings(settings)
+{
+}
+
+bool ModelEngine::isValidType(ModelType type)
+{
+    return (int)type >= 0 && (int)type <= (int)Model_6;
+}
+
+QString ModelEngine::getModelTypeName(ModelType type)
+{
+    return ModelSolver01_06::getModelName(type);
+}
+
+QVector<double> ModelEngine::generateLogTimeSteps(int count, double startExp, double endExp)
+{
+    return ModelSolver01_06::generateLogTimeSteps(count, startExp, endExp);
+}
+
+SolverSettings ModelEngine::solverSettings() const
+{
+    QMutexLocker locker(&m_settingsMutex);
+    return m_solverSettings;
+}
+
+void ModelEngine::setSolverSettings(const SolverSettings& settings)
+{
+    QMutexLocker locker(&m_settingsMutex);
+    m_solverSettings = settings;
+}
+
+double ModelEngine::gridInterpolationError() const
+{
+    QMutexLocker locker(&m_statisticsMutex);
+    return m_maxGridError;
+}
+
+void ModelEngine::resetGridInterpolationError()
+{
+    QMutexLocker locker(&m_statisticsMutex);
+    m_maxGridError = 0.0;
+}
+
+void ModelEngine::recordGridError(double error)
+{
+    if (!(error > 0.0)) return;
+    QMutexLocker locker(&m_statisticsMutex);
+    if (error > m_maxGridError) m_maxGridError = error;
+}
+
+void ModelEngine::setHighPrecision(bool high)
+{
+    QMutexLocker locker(&m_settingsMutex);
+    m_solverSettings.highPrecision = high;
+}
+
+ModelCurveData ModelEngine::calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime)
+{
+    return calculateTheoreticalCurve(type, solverSettings(), params, providedTime);
+}
+
+ModelCurveData ModelEngine::calculateTheoreticalCurve(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                                      const QVector<double>& providedTime)
+{
+    if (!isValidType(type)) return ModelCurveData();
+    // 借出独占实例：并发调用各自持有不同实例，计算结束时自动归还
+    SolverPool::Lease solver = m_solverPool.acquire(type, settings);
+    ModelCurveData curve = solver->calculateTheoreticalCurve(params, providedTime);
+    recordGridError(solver->lastGridInterpolationError());
+    return curve;
+}
+
+QVector<ModelCurveData> ModelEngine::calculateTheoreticalCurvesBatch(ModelType type, const QVector<QMap<QString, double>>& paramSets,
+                                                                    const QVector<double>& providedTime)
+{
+    return calculateTheoreticalCurvesBatch(type, solverSettings(), paramSets, providedTime);
+}
+
+QVector<ModelCurveData> ModelEngine::calculateTheoreticalCurvesBatch(ModelType type, const SolverSettings& settings,
+                                                                    const QVector<QMap<QString, double>>& paramSets,
+                                                                    const QVector<double>& providedTime)
+{
+    if (!isValidType(type)) return QVector<ModelCurveData>(paramSets.size());
+    // 一个实例完成整批计算：各参数组的像函数求值在实例内部统一并行调度
+    SolverPool::Lease solver = m_solverPool.acquire(type, settings);
+    QVector<ModelCurveData> curves = solver->calculateTheoreticalCurvesBatch(paramSets, providedTime);
+    recordGridError(solver->lastGridInterpolationError());
+    return curves;
+}
+
+ModelCurveData ModelEngine::calculateSuperposedCurve(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                                     const RateHistory& history, const QVector<double>& t)
+{
+    QVector<ModelCurveData> curves = calculateSuperposedCurvesBatch(type, settings, QVector<QMap<QString, double>>() << params, history, t);
+    return curves.isEmpty() ? ModelCurveData() : curves.first();
+}
+
+QVector<ModelCurveData> ModelEngine::calculateSuperposedCurvesBatch(ModelType type, const SolverSettings& settings,
+                                                                   const QVector<QMap<QString, double>>& paramSets,
+                                                                   const RateHistory& history, const QVector<double>& t)
+{
+    QVector<ModelCurveData> results;
+    results.reserve(paramSets.size());
+
+    RateHistory steps = SuperpositionEngine::prepare(history);
+    QVector<double> grid = SuperpositionEngine::responseGrid(steps, t);
+    if (grid.isEmpty()) {
+        for (int i = 0; i < paramSets.size(); ++i) {
+            results.append(std::make_tuple(t, QVector<double>(t.size(), 0.0), QVector<double>(t.size(), 0.0)));
+        }
+        return results;
+    }
+
+    // 单位响应：全部参数组共用网格，一次批量计算
+    QVector<ModelCurveData> unitResponses = calculateTheoreticalCurvesBatch(type, settings, paramSets, grid);
+    for (int i = 0; i < paramSets.size(); ++i) {
+        double referenceRate = paramSets[i].value("q", 5.0); // 与求解器中压力换算的默认值一致
+        results.append(SuperpositionEngine::superpose(unitResponses.value(i), referenceRate, steps, t));
+    }
+    return results;
+}
+
+ModelSensitivity ModelEngine::calculateCurveSensitivity(ModelType type, const QMap<QString, double>& params, const QStringList& names,
+                                                        const QVector<double>& providedTime)
+{
+    return calculateCurveSensitivity(type, solverSettings(), params, names, providedTime);
+}
+
+ModelSensitivity ModelEngine::calculateCurveSensitivity(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                                        const QStringList& names, const QVector<double>& providedTime)
+{
+    if (!isValidType(type)) return ModelSensitivity();
+    SolverPool::Lease solver = m_solverPool.acquire(type, settings);
+    return solver->calculateCurveSensitivity(params, names, providedTime);
+}
@@ -0,0 +1,95 @@
+/*
+ * 文件名: modelengine.h
+ * 文件作用: 模型计算引擎头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 从 ModelManager 中分离出的计算部分：求解器池、全局默认求解器设置与各类理论曲线计算接口
+ *    (定产量、批量、变产量叠加、敏感度)，只依赖 QtCore，可在命令行批处理等无界面环境中使用。
+ * 2. ModelManager 持有一个引擎实例并转发同名接口；FittingCore 与批量拟合队列只依赖本类。
+ * 3. 计算接口可在任意线程并发调用：每次计算从 SolverPool 借出独占实例，默认设置由互斥锁保护并按值读取。
+ */
+
+#ifndef MODELENGINE_H
+#define MODELENGINE_H
+
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "modelsolver01-06.h"
+#include "solverpool.h"
+#include "superposition.h"
+
+class ModelEngine
+{
+public:
+    // 使用 Solver 中定义的枚举类型，与 ModelManager 的对外接口一致
+    using ModelType = ModelSolver01_06::ModelType;
+    static const ModelType Model_1 = ModelSolver01_06::Model_1;
+    static const ModelType Model_2 = ModelSolver01_06::Model_2;
+    static const ModelType Model_3 = ModelSolver01_06::Model_3;
+    static const ModelType Model_4 = ModelSolver01_06::Model_4;
+    static const ModelType Model_5 = ModelSolver01_06::Model_5;
+    static const ModelType Model_6 = ModelSolver01_06::Model_6;
+
+    // 默认设置取自全局设置项 (SolverSettings::fromGlobalSettings)
+    ModelEngine();
+    explicit ModelEngine(const SolverSettings& settings);
+
+    // 获取模型名称描述
+    static QString getModelTypeName(ModelType type);
+
+    // 生成对数时间步长 (静态工具)
+    static QVector<double> generateLogTimeSteps(int count, double startExp, double endExp);
+
+    // 定产量理论曲线 (不指定设置时使用当前默认设置)
+    ModelCurveData calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params,
+                                             const QVector<double>& providedTime = QVector<double>());
+    ModelCurveData calculateTheoreticalCurve(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                             const QVector<double>& providedTime = QVector<double>());
+
+    // 批量接口：同一模型、同一时间序列下的多组参数，结果顺序与 paramSets 一致
+    QVector<ModelCurveData> calculateTheoreticalCurvesBatch(ModelType type, const QVector<QMap<QString, double>>& paramSets,
+                                                            const QVector<double>& providedTime = QVector<double>());
+    QVector<ModelCurveData> calculateTheoreticalCurvesBatch(ModelType type, const SolverSettings& settings,
+                                                            const QVector<QMap<QString, double>>& paramSets,
+                                                            const QVector<double>& providedTime = QVector<double>());
+
+    // 变产量叠加接口 (见 superposition.h)：t 与 history 使用同一时间原点，参考产量取 params 中的 q
+    ModelCurveData calculateSuperposedCurve(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                            const RateHistory& history, const QVector<double>& t);
+    QVector<ModelCurveData> calculateSuperposedCurvesBatch(ModelType type, const SolverSettings& settings,
+                                                           const QVector<QMap<QString, double>>& paramSets,
+                                                           const RateHistory& history, const QVector<double>& t);
+
+    // 敏感度接口：一次给出理论曲线及其对 names 中各参数的偏导数
+    ModelSensitivity calculateCurveSensitivity(ModelType type, const QMap<QString, double>& params, const QStringList& names,
+                                               const QVector<double>& providedTime = QVector<double>());
+    ModelSensitivity calculateCurveSensitivity(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                               const QStringList& names, const QVector<double>& providedTime = QVector<double>());
+
+    // 当前默认求解器设置 (线程安全的值拷贝)
+    SolverSettings solverSettings() const;
+    void setSolverSettings(const SolverSettings& settings);
+    // 只切换默认设置的精度 (已借出的求解器不受影响)
+    void setHighPrecision(bool high);
+
+    // 网格求值模式的插值误差统计：上次重置以来各次计算误差估计的最大值 (未使用网格求值时为 0)
+    double gridInterpolationError() const;
+    void resetGridInterpolationError();
+
+    // 后台求解器池 (供需要自行持有求解器实例的调用方使用)
+    SolverPool& solverPool() { return m_solverPool; }
+
+private:
+    static bool isValidType(ModelType type);
+    void recordGridError(double error);
+
+    SolverPool m_solverPool;
+    mutable QMutex m_settingsMutex;
+    SolverSettings m_solverSettings;
+    mutable QMutex m_statisticsMutex;
+    double m_maxGridError = 0.0;
+};
+
+#endif // MODELENGINE_H
@@ -4,13 +4,20 @@
  * 修改记录:
  * 1. [性能优化] initializeModels 不再循环创建所有界面，改为调整容器大小。
  * 2. [逻辑修改] switchToModel 和 calculateTheoreticalCurve 中增加 ensureWidget/ensureSolver 检查，实现按需创建。
+ * 3. [线程安全] 去掉按模型类型共享的 m_solvers/ensureSolver，计算接口改为从 SolverPool 借出独占实例，
+ *    setHighPrecision 只更新受互斥锁保护的默认设置，进行中的计算保持各自借出时的设置。
+ * 4. [批量计算] 新增 calculateTheoreticalCurvesBatch，多组参数借出同一实例一次完成，
+ *    供敏感性分析与多分析对比替代逐条调用。
+ * 5. [变产量叠加] 新增 calculateSuperposedCurve(s)：产量阶段过多时先自动分组，
+ *    各参数组的单位响应在同一对数网格上批量计算后逐阶段叠加。
+ * 6. [网格求值] 求解器使用网格求值模式时，插值误差估计超过 1e-3 的计算输出调试信息。
+ * 7. [计算核心] 计算接口的实现移入 ModelEngine (modelengine.cpp)，此处只做转发。
  */
 
 #include "modelmanager.h"
 #include "modelselect.h"
 #include "modelparameter.h"
 #include "wt_modelwidget.h"
-#include "modelsolver01-06.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -27,12 +34,7 @@ ModelManager::ModelManager(QWidget* parent)
 
 ModelManager::~ModelManager()
 {
-    // 清理求解器内存 (Widget 由 Qt 父子对象机制自动清理)
-    // 但为了安全，清理非空指针
-    for(auto* s : m_solvers) {
-        if(s) delete s;
-    }
-    m_solvers.clear();
+    // 求解器实例由 m_engine 的求解器池析构时释放 (Widget 由 Qt 父子对象机制自动清理)
 }
 
 void ModelManager::initializeModels(QWidget* parentWidget)
@@ -47,10 +49,6 @@ void ModelManager::initializeModels(QWidget* parentWidget)
     m_modelWidgets.resize(6);
     m_modelWidgets.fill(nullptr);
 
-    m_solvers.clear();
-    m_solvers.resize(6);
-    m_solvers.fill(nullptr);
-
     m_mainWidget->layout()->addWidget(m_modelStack);
 
     // 默认加载第一个模型，此时才会创建 Model_1 的界面，其他 5 个不会创建
@@ -98,21 +96,6 @@ WT_ModelWidget* ModelManager::ensureWidget(ModelType type)
     return m_modelWidgets[index];
 }
 
-// [新增] 确保 Solver 存在的辅助函数
-ModelSolver01_06* ModelManager::ensureSolver(ModelType type)
-{
-    int index = (int)type;
-    if (index < 0 || index >= m_solvers.size()) return nullptr;
-
-    if (m_solvers[index] == nullptr) {
-        // 创建求解器对象
-        // qDebug() << "惰性加载求解器: Model" << index + 1;
-        ModelSolver01_06* solver = new ModelSolver01_06(type);
-        m_solvers[index] = solver;
-    }
-    return m_solvers[index];
-}
-
 void ModelManager::switchToModel(ModelType modelType)
 {
     if (!m_modelStack) return;
@@ -150,7 +133,7 @@ void ModelManager::onSelectModelClicked()
 
 QString ModelManager::getModelTypeName(ModelType type)
 {
-    return ModelSolver01_06::getModelName(type);
+    return ModelEngine::getModelTypeName(type);
 }
 
 void ModelManager::onWidgetCalculationCompleted(const QString &t, const QMap<QString, double> &r) {
@@ -162,10 +145,23 @@ void ModelManager::setHighPrecision(bool high) {
     for(WT_ModelWidget* w : m_modelWidgets) {
         if(w) w->setHighPrecision(high);
     }
-    // 设置后台求解器精度（仅对已创建的设置）
-    for(ModelSolver01_06* s : m_solvers) {
-        if(s) s->setHighPrecision(high);
-    }
+    // 更新后台计算的默认设置 (已借出的求解器不受影响)
+    m_engine.setHighPrecision(high);
+}
+
+SolverSettings ModelManager::solverSettings() const
+{
+    return m_engine.solverSettings();
+}
+
+void ModelManager::setSolverSettings(const SolverSettings& settings)
+{
+    m_engine.setSolverSettings(settings);
+}
+
+SolverPool& ModelManager::solverPool()
+{
+    return m_engine.solverPool();
 }
 
 void ModelManager::updateAllModelsBasicParameters()
@@ -217,40 +213,80 @@ QMap<QString, double> ModelManager::getDefaultParameters(ModelType type)
 
 ModelCurveData ModelManager::calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime)
 {
-    // [修改] 使用 ensureSolver 确保对象存在
-    ModelSolver01_06* solver = ensureSolver(type);
-    if (solver) {
-        return solver->calculateTheoreticalCurve(params, providedTime);
-    }
-    return ModelCurveData();
+    return m_engine.calculateTheoreticalCurve(type, params, providedTime);
+}
+
+ModelCurveData ModelManager::calculateTheoreticalCurve(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                                       const QVector<double>& providedTime)
+{
+    return m_engine.calculateTheoreticalCurve(type, settings, params, providedTime);
+}
+
+QVector<ModelCurveData> ModelManager::calculateTheoreticalCurvesBatch(ModelType type, const QVector<QMap<QString, double>>& paramSets,
+                                                                     const QVector<double>& providedTime)
+{
+    return m_engine.calculateTheoreticalCurvesBatch(type, paramSets, providedTime);
+}
+
+QVector<ModelCurveData> ModelManager::calculateTheoreticalCurvesBatch(ModelType type, const SolverSettings& settings,
+                                                                     const QVector<QMap<QString, double>>& paramSets,
+                                                                     const QVector<double>& providedTime)
+{
+    return m_engine.calculateTheoreticalCurvesBatch(type, settings, paramSets, providedTime);
+}
+
+ModelCurveData ModelManager::calculateSuperposedCurve(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                                      const RateHistory& history, const QVector<double>& t)
+{
+    return m_engine.calculateSuperposedCurve(type, settings, params, history, t);
+}
+
+QVector<ModelCurveData> ModelManager::calculateSuperposedCurvesBatch(ModelType type, const SolverSettings& settings,
+                                                                    const QVector<QMap<QString, double>>& paramSets,
+                                                                    const RateHistory& history, const QVector<double>& t)
+{
+    return m_engine.calculateSuperposedCurvesBatch(type, settings, paramSets, history, t);
+}
+
+ModelSensitivity ModelManager::calculateCurveSensitivity(ModelType type, const QMap<QString, double>& params, const QStringList& names,
+                                                         const QVector<double>& providedTime)
+{
+    return m_engine.calculateCurveSensitivity(type, params, names, providedTime);
+}
+
+ModelSensitivity ModelManager::calculateCurveSensitivity(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                                         const QStringList& names, const QVector<double>& providedTime)
+{
+    return m_engine.calculateCurveSensitivity(type, settings, params, names, providedTime);
 }
 
 QVector<double> ModelManager::generateLogTimeSteps(int count, double startExp, double endExp) {
-    return ModelSolver01_06::generateLogTimeSteps(count, startExp, endExp);
+    return ModelEngine::generateLogTimeSteps(count, startExp, endExp);
+}
+
+void ModelManager::setObservedDataset(const ObservedDataset::Handle& dataset)
+{
+    m_observed = dataset ? dataset : ObservedDataset::empty();
 }
 
 void ModelManager::setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
 {
-    m_cachedObsTime = t;
-    m_cachedObsPressure = p;
-    m_cachedObsDerivative = d;
+    setObservedDataset(ObservedDataset::create(t, p, d));
 }
 
 void ModelManager::getObservedData(QVector<double>& t, QVector<double>& p, QVector<double>& d) const
 {
-    t = m_cachedObsTime;
-    p = m_cachedObsPressure;
-    d = m_cachedObsDerivative;
+    t = m_observed->time();
+    p = m_observed->deltaP();
+    d = m_observed->derivative();
 }
 
 void ModelManager::clearCache()
 {
-    m_cachedObsTime.clear();
-    m_cachedObsPressure.clear();
-    m_cachedObsDerivative.clear();
+    m_observed = ObservedDataset::empty();
 }
 
 bool ModelManager::hasObservedData() const
 {
-    return !m_cachedObsTime.isEmpty();
+    return !m_observed->isEmpty();
 }
@@ -4,6 +4,13 @@
  * 修改记录:
  * 1. [优化] 引入惰性初始化机制，解决启动和新建项目时的卡顿问题。
  * 2. [重构] 修改 m_modelWidgets 和 m_solvers 的管理方式，支持按需创建。
+ * 3. [线程安全] 后台求解器改由 SolverPool 按 (模型类型, SolverSettings) 借出独占实例，
+ *    计算接口可在任意线程并发调用；精度等设置以不可变值对象传递，不再修改共享实例的状态。
+ * 4. [批量计算] 增加多参数组批量计算接口 calculateTheoreticalCurvesBatch。
+ * 5. [变产量叠加] 增加按产量历史叠加的计算接口 calculateSuperposedCurve(s) (见 superposition.h)。
+ * 6. [共享数据集] 观测数据缓存改为持有 ObservedDataset 句柄，不再复制数组。
+ * 7. [计算核心] 求解器池、默认求解器设置与各计算接口移入不依赖界面的 ModelEngine (modelengine.h)，
+ *    本类持有一个引擎并转发同名接口；无界面的调用方 (拟合核心、批量队列、命令行) 经 engine() 直接使用引擎。
  */
 
 #ifndef MODELMANAGER_H
@@ -17,7 +24,8 @@
 
 // 引入新的界面类和求解器类头文件
 #include "wt_modelwidget.h"
-#include "modelsolver01-06.h"
+#include "modelengine.h"
+#include "observeddataset.h"
 
 class ModelManager : public QObject
 {
@@ -25,13 +33,13 @@ class ModelManager : public QObject
 
 public:
     // 使用 Solver 中定义的枚举类型，保持对外接口一致
-    using ModelType = ModelSolver01_06::ModelType;
-    static const ModelType Model_1 = ModelSolver01_06::Model_1;
-    static const ModelType Model_2 = ModelSolver01_06::Model_2;
-    static const ModelType Model_3 = ModelSolver01_06::Model_3;
-    static const ModelType Model_4 = ModelSolver01_06::Model_4;
-    static const ModelType Model_5 = ModelSolver01_06::Model_5;
-    static const ModelType Model_6 = ModelSolver01_06::Model_6;
+    using ModelType = ModelEngine::ModelType;
+    static const ModelType Model_1 = ModelEngine::Model_1;
+    static const ModelType Model_2 = ModelEngine::Model_2;
+    static const ModelType Model_3 = ModelEngine::Model_3;
+    static const ModelType Model_4 = ModelEngine::Model_4;
+    static const ModelType Model_5 = ModelEngine::Model_5;
+    static const ModelType Model_6 = ModelEngine::Model_6;
 
     explicit ModelManager(QWidget* parent = nullptr);
     ~ModelManager();
@@ -45,13 +53,48 @@ public:
     // 获取模型名称描述
     static QString getModelTypeName(ModelType type);
 
-    // 核心计算接口：代理给对应的 Solver 进行计算
+    // 计算引擎 (不依赖界面，下列计算接口均转发给它)
+    ModelEngine* engine() { return &m_engine; }
+
+    // 核心计算接口：从求解器池借出实例进行计算 (使用当前全局设置，可在任意线程并发调用)
     ModelCurveData calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>());
 
+    // 核心计算接口：使用调用方指定的求解器设置 (拟合、多起点等后台任务使用，不受全局精度切换影响)
+    ModelCurveData calculateTheoreticalCurve(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                             const QVector<double>& providedTime = QVector<double>());
+
+    // 批量接口：同一模型、同一时间序列下的多组参数 (敏感性分析、多分析对比)，结果顺序与 paramSets 一致
+    QVector<ModelCurveData> calculateTheoreticalCurvesBatch(ModelType type, const QVector<QMap<QString, double>>& paramSets,
+                                                            const QVector<double>& providedTime = QVector<double>());
+    QVector<ModelCurveData> calculateTheoreticalCurvesBatch(ModelType type, const SolverSettings& settings,
+                                                            const QVector<QMap<QString, double>>& paramSets,
+                                                            const QVector<double>& providedTime = QVector<double>());
+
+    // 变产量叠加接口：定产量单位响应在共享对数网格上只计算一次，再按产量历史叠加
+    // t 与 history 使用同一时间原点，返回 <t, Δp, t·dΔp/dt>；参考产量取 params 中的 q
+    ModelCurveData calculateSuperposedCurve(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                            const RateHistory& history, const QVector<double>& t);
+    QVector<ModelCurveData> calculateSuperposedCurvesBatch(ModelType type, const SolverSettings& settings,
+                                                           const QVector<QMap<QString, double>>& paramSets,
+                                                           const RateHistory& history, const QVector<double>& t);
+
+    // 敏感度接口：一次给出理论曲线及其对 names 中各参数的偏导数
+    ModelSensitivity calculateCurveSensitivity(ModelType type, const QMap<QString, double>& params, const QStringList& names,
+                                               const QVector<double>& providedTime = QVector<double>());
+    ModelSensitivity calculateCurveSensitivity(ModelType type, const SolverSettings& settings, const QMap<QString, double>& params,
+                                               const QStringList& names, const QVector<double>& providedTime = QVector<double>());
+
+    // 当前全局求解器设置 (线程安全的值拷贝)
+    SolverSettings solverSettings() const;
+    void setSolverSettings(const SolverSettings& settings);
+
+    // 后台求解器池 (供需要自行持有求解器实例的调用方使用)
+    SolverPool& solverPool();
+
     // 获取默认参数
     QMap<QString, double> getDefaultParameters(ModelType type);
 
-    // 设置全局计算精度
+    // 设置全局计算精度 (同步到已创建的界面，并作为之后后台计算的默认设置)
     void setHighPrecision(bool high);
 
     // 刷新所有界面模型的参数显示
@@ -60,7 +103,9 @@ public:
     // 生成对数时间步长 (静态工具)
     static QVector<double> generateLogTimeSteps(int count, double startExp, double endExp);
 
-    // 观测数据缓存管理
+    // 观测数据缓存管理 (getObservedData 返回的数组与数据集隐式共享)
+    void setObservedDataset(const ObservedDataset::Handle& dataset);
+    ObservedDataset::Handle observedDataset() const { return m_observed; }
     void setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
     void getObservedData(QVector<double>& t, QVector<double>& p, QVector<double>& d) const;
     bool hasObservedData() const;
@@ -79,9 +124,8 @@ private:
     void createMainWidget();
     void connectModelSignals();
 
-    // [新增] 内部辅助函数：确保指定类型的界面和求解器已创建
+    // [新增] 内部辅助函数：确保指定类型的界面已创建
     WT_ModelWidget* ensureWidget(ModelType type);
-    ModelSolver01_06* ensureSolver(ModelType type);
 
 private:
     QWidget* m_mainWidget;
@@ -90,14 +134,12 @@ private:
     // [修改] 界面列表，使用指针数组，初始为 nullptr
     QVector<WT_ModelWidget*> m_modelWidgets;
 
-    // [修改] 求解器列表，使用指针数组，初始为 nullptr
-    QVector<ModelSolver01_06*> m_solvers;
+    // 计算引擎：后台求解器池与全局默认设置
+    ModelEngine m_engine;
 
     ModelType m_currentModelType;
 
-    QVector<double> m_cachedObsTime;
-    QVector<double> m_cachedObsPressure;
-    QVector<double> m_cachedObsDerivative;
+    ObservedDataset::Handle m_observed = ObservedDataset::empty();
 };
 
 #endif // MODELMANAGER_H
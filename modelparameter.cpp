@@ -4,16 +4,42 @@
  * 功能描述:
  * 1. 实现项目数据的加载与保存。
  * 2. [关键] loadProject 时强制读取 _date.json 到 m_fullProjectData["table_data"]，解决数据丢失问题。
+ * 3. [二进制表格] 存在 _date.bin 时不再解析 _date.json (表格由 WT_DataWidget 经 ProjectTableStore 按需读取)。
+ * 4. [增量保存] 各文件经 QSaveFile 先写临时文件再替换；.pwt 编码结果与上次写入相同、绘图数据与上次写入相同、
+ *    拟合状态未变时均不重写。项目路径改变 (打开、另存、关闭) 时清除这些记录。
+ * 5. [自动备份] projectSnapshot 在副本上填入当前参数，供后台备份写出，不影响上述增量保存记录。
+ * 6. [分段加载] loadProject 与 openProject 共用 .pwt 读取与附属文件解析；openProject 的附属文件解析在线程池中进行，
+ *    结果回到界面线程后写入项目数据。打开或关闭项目时递增加载代数，过期的结果直接丢弃。
  */
 
 #include "modelparameter.h"
+#include "memoryaccounting.h"
 #include <QFile>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <QDebug>
 
 ModelParameter* ModelParameter::m_instance = nullptr;
 
+// 先写入同目录的临时文件，完整写出后再替换目标文件 (中途失败时原文件不变)
+static bool writeFileAtomically(const QString& path, const QByteArray& data)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "无法写入文件:" << path;
+        return false;
+    }
+    file.write(data);
+    if (!file.commit()) {
+        qDebug() << "写入文件失败:" << path;
+        return false;
+    }
+    return true;
+}
+
 ModelParameter::ModelParameter(QObject* parent) : QObject(parent), m_hasLoaded(false)
 {
     m_phi = 0.05; m_h = 20.0; m_mu = 0.5; m_B = 1.05; m_Ct = 5e-4; m_q = 50.0; m_rw = 0.1;
@@ -29,6 +55,9 @@ void ModelParameter::setParameters(double phi, double h, double mu, double B, do
 {
     m_phi = phi; m_h = h; m_mu = mu; m_B = B; m_Ct = Ct; m_q = q; m_rw = rw;
     m_projectFilePath = path;
+    resetSaveState();
+    ++m_loadGeneration;
+    m_pendingSections = 0;
 
     QFileInfo fi(path);
     m_projectPath = fi.isFile() ? fi.absolutePath() : path;
@@ -67,8 +96,67 @@ QString ModelParameter::getTableDataFilePath() const
     return fi.absolutePath() + "/" + baseName + "_date.json";
 }
 
+// 构造拟合求值缓存路径: 原文件名 + "_fitcache.bin"
+QString ModelParameter::getFitCacheFilePath() const
+{
+    if (m_projectFilePath.isEmpty()) return QString();
+    QFileInfo fi(m_projectFilePath);
+    QString baseName = fi.completeBaseName();
+    return fi.absolutePath() + "/" + baseName + "_fitcache.bin";
+}
+
+// 构造表格列存储路径: 原文件名 + "_date.bin"
+QString ModelParameter::getTableStoreFilePath() const
+{
+    if (m_projectFilePath.isEmpty()) return QString();
+    QFileInfo fi(m_projectFilePath);
+    QString baseName = fi.completeBaseName();
+    return fi.absolutePath() + "/" + baseName + "_date.bin";
+}
+
+// 构造拟合断点路径: 原文件名 + "_fitstate.json"
+QString ModelParameter::getFitStateFilePath() const
+{
+    if (m_projectFilePath.isEmpty()) return QString();
+    QFileInfo fi(m_projectFilePath);
+    QString baseName = fi.completeBaseName();
+    return fi.absolutePath() + "/" + baseName + "_fitstate.json";
+}
+
 bool ModelParameter::loadProject(const QString& filePath)
 {
+    if (!readProjectFile(filePath)) return false;
+
+    // 2. 加载图表数据 (_chart.json)
+    applyPlottingSection(readSection(getPlottingDataFilePath(), "plotting_data"));
+
+    // 3. [关键修复] 加载表格数据 (_date.json)
+    // 已有二进制表格文件时旧格式不再解析 (可能是升级前遗留的过期内容)
+    if (QFile::exists(getTableStoreFilePath())) {
+        m_fullProjectData.remove("table_data");
+    } else {
+        applyTableSection(readSection(getTableDataFilePath(), "table_data"), getTableDataFilePath());
+    }
+    return true;
+}
+
+bool ModelParameter::openProject(const QString& filePath)
+{
+    if (!readProjectFile(filePath)) return false;
+
+    loadSectionAsync(PlottingSection, getPlottingDataFilePath(), "plotting_data");
+    if (QFile::exists(getTableStoreFilePath())) {
+        // 二进制表格由 WT_DataWidget 按页签延迟读取，无需预读
+        m_fullProjectData.remove("table_data");
+    } else {
+        loadSectionAsync(TableSection, getTableDataFilePath(), "table_data");
+    }
+    return true;
+}
+
+bool ModelParameter::readProjectFile(const QString& filePath)
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::ProjectIO);
     // 1. 加载主项目文件 (.pwt)
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -83,6 +171,9 @@ bool ModelParameter::loadProject(const QString& filePath)
     if (doc.isNull()) return false;
 
     m_fullProjectData = doc.object();
+    // 项目已更换：仍在解析的旧项目附属文件作废
+    ++m_loadGeneration;
+    m_pendingSections = 0;
 
     // 解析基础物理参数
     if (m_fullProjectData.contains("reservoir")) {
@@ -100,47 +191,63 @@ bool ModelParameter::loadProject(const QString& filePath)
     }
 
     m_projectFilePath = filePath;
+    resetSaveState();
     m_projectPath = QFileInfo(filePath).absolutePath();
     m_hasLoaded = true;
+    return true;
+}
 
-    // 2. 加载图表数据 (_chart.json)
-    QString chartPath = getPlottingDataFilePath();
-    QFile chartFile(chartPath);
-    if (chartFile.exists() && chartFile.open(QIODevice::ReadOnly)) {
-        QJsonDocument d = QJsonDocument::fromJson(chartFile.readAll());
-        if (!d.isNull() && d.isObject()) {
-            QJsonObject obj = d.object();
-            if (obj.contains("plotting_data")) {
-                m_fullProjectData["plotting_data"] = obj["plotting_data"];
-            }
-        }
-        chartFile.close();
+ModelParameter::SectionData ModelParameter::readSection(const QString& path, const QString& key)
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::ProjectIO);
+    SectionData section;
+    QFile file(path);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) return section;
+    QJsonDocument d = QJsonDocument::fromJson(file.readAll());
+    if (d.isObject() && d.object().contains(key)) {
+        section.found = true;
+        section.data = d.object().value(key).toArray();
     }
+    return section;
+}
 
-    // 3. [关键修复] 加载表格数据 (_date.json)
-    // 必须确保这里的逻辑与 DataEditorWidget::onSave 对应
-    QString datePath = getTableDataFilePath();
-    QFile dateFile(datePath);
-    if (dateFile.exists() && dateFile.open(QIODevice::ReadOnly)) {
-        QJsonDocument d = QJsonDocument::fromJson(dateFile.readAll());
-        if (!d.isNull() && d.isObject()) {
-            QJsonObject obj = d.object();
-            if (obj.contains("table_data")) {
-                // 将读取到的数组存入内存，供 DataEditorWidget::loadFromProjectData 获取
-                m_fullProjectData["table_data"] = obj["table_data"];
-                qDebug() << "成功加载表格数据文件:" << datePath << "数据量:" << obj["table_data"].toArray().size();
-            }
-        } else {
-            qDebug() << "表格数据文件解析失败:" << datePath;
-        }
-        dateFile.close();
+void ModelParameter::applyPlottingSection(const SectionData& section)
+{
+    if (!section.found) return;
+    m_fullProjectData["plotting_data"] = section.data;
+    m_savedPlotting = section.data;
+    m_plottingSaved = true;
+}
+
+void ModelParameter::applyTableSection(const SectionData& section, const QString& path)
+{
+    if (section.found) {
+        // 将读取到的数组存入内存，供 DataEditorWidget::loadFromProjectData 获取
+        m_fullProjectData["table_data"] = section.data;
+        qDebug() << "成功加载表格数据文件:" << path << "数据量:" << section.data.size();
     } else {
-        qDebug() << "未找到表格数据文件:" << datePath;
+        qDebug() << "未找到或无法解析表格数据文件:" << path;
         // 如果文件不存在，务必清除内存中的旧数据，防止显示错误
         m_fullProjectData.remove("table_data");
     }
+}
 
-    return true;
+void ModelParameter::loadSectionAsync(ProjectSection section, const QString& path, const QString& key)
+{
+    m_pendingSections |= section;
+    const quint64 generation = m_loadGeneration;
+
+    auto* watcher = new QFutureWatcher<SectionData>(this);
+    connect(watcher, &QFutureWatcher<SectionData>::finished, this, [this, watcher, section, path, generation]() {
+        watcher->deleteLater();
+        if (generation != m_loadGeneration) return; // 期间已打开或关闭了其他项目
+        const SectionData data = watcher->result();
+        if (section == PlottingSection) applyPlottingSection(data);
+        else applyTableSection(data, path);
+        m_pendingSections &= ~section;
+        emit sectionLoaded(section);
+    });
+    watcher->setFuture(QtConcurrent::run(&ModelParameter::readSection, path, key));
 }
 
 bool ModelParameter::saveProject()
@@ -148,39 +255,67 @@ bool ModelParameter::saveProject()
     if (!m_hasLoaded || m_projectFilePath.isEmpty()) return false;
 
     // 更新参数到内存对象
+    storeParameters(m_fullProjectData);
+    return writeProjectFile();
+}
+
+void ModelParameter::storeParameters(QJsonObject& project) const
+{
     QJsonObject reservoir;
-    if(m_fullProjectData.contains("reservoir")) reservoir = m_fullProjectData["reservoir"].toObject();
+    if(project.contains("reservoir")) reservoir = project["reservoir"].toObject();
     reservoir["porosity"] = m_phi;
     reservoir["thickness"] = m_h;
     reservoir["wellRadius"] = m_rw;
     reservoir["productionRate"] = m_q;
-    m_fullProjectData["reservoir"] = reservoir;
+    project["reservoir"] = reservoir;
 
     QJsonObject pvt;
-    if(m_fullProjectData.contains("pvt")) pvt = m_fullProjectData["pvt"].toObject();
+    if(project.contains("pvt")) pvt = project["pvt"].toObject();
     pvt["viscosity"] = m_mu;
     pvt["volumeFactor"] = m_B;
     pvt["compressibility"] = m_Ct;
-    m_fullProjectData["pvt"] = pvt;
+    project["pvt"] = pvt;
+}
+
+QJsonObject ModelParameter::projectSnapshot() const
+{
+    QJsonObject project = m_fullProjectData;
+    project.remove("plotting_data");
+    project.remove("table_data");
+    storeParameters(project);
+    return project;
+}
+
+void ModelParameter::resetSaveState()
+{
+    m_writtenProject.clear();
+    m_savedPlotting = QJsonArray();
+    m_plottingSaved = false;
+}
 
-    // 保存 .pwt 主文件时，剔除大数据块，只保留配置
+// 保存 .pwt 主文件时，剔除大数据块，只保留配置；内容与上次写入相同时不重写
+bool ModelParameter::writeProjectFile()
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::ProjectIO);
     QJsonObject dataToWrite = m_fullProjectData;
     dataToWrite.remove("plotting_data");
     dataToWrite.remove("table_data");
 
-    QFile file(m_projectFilePath);
-    if (!file.open(QIODevice::WriteOnly)) return false;
-    file.write(QJsonDocument(dataToWrite).toJson());
-    file.close();
-
+    const QByteArray bytes = QJsonDocument(dataToWrite).toJson();
+    if (bytes == m_writtenProject) return true;
+    if (!writeFileAtomically(m_projectFilePath, bytes)) return false;
+    m_writtenProject = bytes;
     return true;
 }
 
 void ModelParameter::closeProject()
 {
+    ++m_loadGeneration;
+    m_pendingSections = 0;
     m_hasLoaded = false;
     m_projectPath.clear();
     m_projectFilePath.clear();
+    resetSaveState();
     m_fullProjectData = QJsonObject();
     m_phi=0.05; m_h=20.0; m_mu=0.5; m_B=1.05; m_Ct=5e-4; m_q=50.0; m_rw=0.1;
 }
@@ -188,16 +323,10 @@ void ModelParameter::closeProject()
 void ModelParameter::saveFittingResult(const QJsonObject& fittingData)
 {
     if (m_projectFilePath.isEmpty()) return;
+    // 拟合状态未变且主文件已按当前内容写过时无需重新编码
+    if (!m_writtenProject.isEmpty() && m_fullProjectData.value("fitting") == QJsonValue(fittingData)) return;
     m_fullProjectData["fitting"] = fittingData;
-
-    QFile file(m_projectFilePath);
-    if (file.open(QIODevice::WriteOnly)) {
-        QJsonObject dataToWrite = m_fullProjectData;
-        dataToWrite.remove("plotting_data");
-        dataToWrite.remove("table_data");
-        file.write(QJsonDocument(dataToWrite).toJson());
-        file.close();
-    }
+    writeProjectFile();
 }
 
 QJsonObject ModelParameter::getFittingResult() const
@@ -208,17 +337,22 @@ QJsonObject ModelParameter::getFittingResult() const
 void ModelParameter::savePlottingData(const QJsonArray& plots)
 {
     if (m_projectFilePath.isEmpty()) return;
+    if (!isSectionLoaded(PlottingSection)) {
+        qDebug() << "绘图数据仍在加载，忽略保存";
+        return;
+    }
 
     m_fullProjectData["plotting_data"] = plots;
+    // 与上次写入 (或加载) 的内容相同时不重写 (数据数组隐式共享时比较很快)
+    if (m_plottingSaved && m_savedPlotting == plots) return;
 
     QString dataFilePath = getPlottingDataFilePath();
     QJsonObject dataObj;
     dataObj["plotting_data"] = plots;
 
-    QFile file(dataFilePath);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(dataObj).toJson());
-        file.close();
+    if (writeFileAtomically(dataFilePath, QJsonDocument(dataObj).toJson(QJsonDocument::Compact))) {
+        m_savedPlotting = plots;
+        m_plottingSaved = true;
     }
 }
 
@@ -231,6 +365,10 @@ QJsonArray ModelParameter::getPlottingData() const
 void ModelParameter::saveTableData(const QJsonArray& tableData)
 {
     if (m_projectFilePath.isEmpty()) return;
+    if (!isSectionLoaded(TableSection)) {
+        qDebug() << "表格数据仍在加载，忽略保存";
+        return;
+    }
 
     // 1. 更新内存缓存
     m_fullProjectData["table_data"] = tableData;
@@ -240,10 +378,7 @@ void ModelParameter::saveTableData(const QJsonArray& tableData)
     QJsonObject dataObj;
     dataObj["table_data"] = tableData;
 
-    QFile file(dataFilePath);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(dataObj).toJson());
-        file.close();
+    if (writeFileAtomically(dataFilePath, QJsonDocument(dataObj).toJson())) {
         qDebug() << "表格数据已保存至:" << dataFilePath << "条目数:" << tableData.size();
     } else {
         qDebug() << "表格数据保存失败:" << dataFilePath;
@@ -263,10 +398,13 @@ void ModelParameter::resetAllData()
     m_q = 50.0;
     m_rw = 0.1;
 
-    // 2. 清空项目路径信息
+    // 2. 清空项目路径信息 (仍在后台解析的附属文件作废)
+    ++m_loadGeneration;
+    m_pendingSections = 0;
     m_hasLoaded = false;
     m_projectPath.clear();
     m_projectFilePath.clear();
+    resetSaveState();
 
     // 3. [关键] 清空核心数据存储对象
     // 你的代码中，表格数据、绘图数据、拟合数据全都在这个对象里
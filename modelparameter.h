@@ -5,6 +5,12 @@
  * 1. 管理项目核心数据（孔隙度、粘度等）和文件路径。
  * 2. 负责 _chart.json (图表) 和 _date.json (表格) 的路径生成和存取。
  * 3. 确保项目保存和加载时，数据表格的内容能被正确持久化。
+ * 4. 提供拟合求值缓存 (_fitcache.bin) 与拟合断点 (_fitstate.json) 的路径，供 FittingCore 持久化使用。
+ * 5. [二进制表格] 提供表格列存储文件 (_date.bin) 的路径；该文件存在时优先于 _date.json，后者只用于打开旧项目。
+ * 6. [增量保存] 项目文件以临时文件 + 替换的方式写入，内容未变的部分不重写。
+ * 7. [自动备份] projectSnapshot 给出按当前参数写 .pwt 的内容 (不修改内存中的项目数据)，供后台自动备份使用。
+ * 8. [分段加载] openProject 只同步读取 .pwt (基础参数与拟合状态)，_chart.json 与旧格式的 _date.json 在后台线程解析，
+ *    各部分就绪时发出 sectionLoaded；未就绪的部分不接受保存，避免以空内容覆盖磁盘上的数据。
  */
 
 #ifndef MODELPARAMETER_H
@@ -24,6 +30,13 @@ class ModelParameter : public QObject
 public:
     static ModelParameter* instance();
 
+    // 打开项目时在后台读取的部分
+    enum ProjectSection {
+        TableSection = 0x1,     // 表格数据 (旧格式 _date.json；二进制表格无需预读，立即就绪)
+        PlottingSection = 0x2   // 绘图数据 (_chart.json)
+    };
+    Q_ENUM(ProjectSection)
+
     // ========================================================================
     // 项目文件管理
     // ========================================================================
@@ -32,9 +45,18 @@ public:
     // 作用：读取主文件配置，并自动寻找同目录下的 _date.json 加载表格数据
     bool loadProject(const QString& filePath);
 
+    // 分段打开项目：同步读取 .pwt 后立即返回，附属文件在后台解析，就绪后发出 sectionLoaded
+    bool openProject(const QString& filePath);
+    // 该部分已就绪 (未打开项目时视为就绪)
+    bool isSectionLoaded(ProjectSection section) const { return !(m_pendingSections & section); }
+    bool allSectionsLoaded() const { return m_pendingSections == 0; }
+
     // 保存基础参数到 .pwt 文件
     bool saveProject();
 
+    // 当前 .pwt 的内容 (含当前基础参数，不含绘图与表格数据)
+    QJsonObject projectSnapshot() const;
+
     // 关闭项目，清空内存数据
     void closeProject();
 
@@ -81,6 +103,16 @@ public:
     // DataEditorWidget 加载项目时调用此函数恢复界面
     QJsonArray getTableData() const;
 
+    // 拟合求值缓存与拟合断点文件路径 (未打开项目时为空)
+    QString getFitCacheFilePath() const;
+    QString getFitStateFilePath() const;
+    // 表格列存储文件路径 (未打开项目时为空)，读写见 ProjectTableStore
+    QString getTableStoreFilePath() const;
+
+signals:
+    // 分段打开时某一部分已读入 (在界面线程发出)
+    void sectionLoaded(ModelParameter::ProjectSection section);
+
 private:
     explicit ModelParameter(QObject* parent = nullptr);
     static ModelParameter* m_instance;
@@ -101,9 +133,32 @@ private:
     double m_q;
     double m_rw;
 
+    // 增量保存：最近一次写入 .pwt 的内容，以及最近一次写入 (或加载) 的绘图数据
+    QByteArray m_writtenProject;
+    QJsonArray m_savedPlotting;
+    bool m_plottingSaved = false;
+    void resetSaveState();
+    bool writeProjectFile();
+    void storeParameters(QJsonObject& project) const;
+
     // 辅助：获取附属文件的绝对路径
     QString getPlottingDataFilePath() const;
     QString getTableDataFilePath() const;
+
+    // 分段加载：读取 .pwt 并设置项目路径；附属文件的解析结果 (可在任意线程读取与解析)
+    struct SectionData {
+        bool found = false;     // 文件存在且可解析
+        QJsonArray data;
+    };
+    bool readProjectFile(const QString& filePath);
+    static SectionData readSection(const QString& path, const QString& key);
+    void applyPlottingSection(const SectionData& section);
+    void applyTableSection(const SectionData& section, const QString& path);
+    // 后台解析 path 中的 key 数组，完成后 (项目未变时) 交给 apply 并发出 sectionLoaded
+    void loadSectionAsync(ProjectSection section, const QString& path, const QString& key);
+
+    int m_pendingSections = 0;
+    quint64 m_loadGeneration = 0;   // 每次打开或关闭项目时递增，过期的后台结果被丢弃
 };
 
 #endif // MODELPARAMETER_H
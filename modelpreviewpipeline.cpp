@@ -0,0 +1,236 @@
+/*
+ * 文件名: modelpreviewpipeline.cpp
+ * 文件作用: 参数调节时的异步理论曲线预览实现文件
+ * 功能描述:
+ * 1. 粗略曲线在计算线程内串行求值 (点数少，避免与精细曲线争抢线程池)；精细曲线允许按时间点并行。
+ * 2. 每一步结束后检查取消令牌：已取消的请求不再交付结果，也不再继续下一步。
+ * 3. 精细曲线自适应布点的点数预算取自预览质量设置 (AdaptiveCurveSampler::previewPointBudget)。
+ * 4. 计算线程以交互优先级向 TaskScheduler 提交时间点任务，工作线程先于拟合与批量任务处理预览。
+ * 5. 投机计算在一个后台任务中按候选顺序 (+1、-1、+2、-2 ...) 逐个计算，以批量优先级提交时间点任务，不与预览争抢工作线程；
+ *    未命中的 submit 会取消进行中的投机计算 (已暂存的结果保留)，由界面在下一次空闲时重新发起。
+ */
+
+#include "modelpreviewpipeline.h"
+#include "adaptivecurvesampler.h"
+#include "fitevaluationcache.h"
+#include "modelsolver01-06.h"
+#include "taskscheduler.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 从 t 中按下标等间隔选取至多 count 个点 (保留两端)
+QVector<double> thinTimes(const QVector<double>& t, int count)
+{
+    if (t.size() <= count || count < 2) return t;
+    QVector<double> out;
+    out.reserve(count);
+    const double step = double(t.size() - 1) / (count - 1);
+    for (int i = 0; i < count; ++i) out.append(t[qMin(t.size() - 1, int(std::round(i * step)))]);
+    return out;
+}
+
+} // namespace
+
+ModelPreviewPipeline::ModelPreviewPipeline(FittingCore* core, QObject* parent)
+    : QObject(parent), m_core(core), m_generation(0), m_speculationEpoch(0), m_speculativeHits(0)
+{
+}
+
+ModelPreviewPipeline::~ModelPreviewPipeline()
+{
+    cancel();
+    clearSpeculation();
+    for (QFuture<void>& future : m_futures) future.waitForFinished();
+}
+
+quint64 ModelPreviewPipeline::submit(const ModelPreviewRequest& request)
+{
+    cancel();
+    pruneFinished();
+    const quint64 generation = m_generation;
+
+    // 投机计算已算出该请求：直接交付精细结果
+    if (m_core && !request.targetT.isEmpty()) {
+        const QByteArray key = speculationKey(request);
+        QMutexLocker locker(&m_speculationMutex);
+        auto it = m_speculative.constFind(key);
+        if (it != m_speculative.constEnd()) {
+            ModelPreviewResult result = it.value();
+            locker.unlock();
+            result.generation = generation;
+            ++m_speculativeHits;
+            deliver(result);
+            return generation;
+        }
+    }
+    // 未命中：让出线程给本次预览
+    if (m_speculationToken) m_speculationToken->cancel();
+    m_token = QSharedPointer<CancellationToken>::create();
+    QSharedPointer<CancellationToken> token = m_token;
+    m_futures.append(QtConcurrent::run([this, generation, request, token]() {
+        run(generation, request, token);
+    }));
+    return generation;
+}
+
+void ModelPreviewPipeline::cancel()
+{
+    ++m_generation;
+    if (m_token) m_token->cancel();
+    m_token.clear();
+}
+
+void ModelPreviewPipeline::pruneFinished()
+{
+    for (int i = m_futures.size() - 1; i >= 0; --i) {
+        if (m_futures[i].isFinished()) m_futures.removeAt(i);
+    }
+}
+
+void ModelPreviewPipeline::run(quint64 generation, const ModelPreviewRequest& request, QSharedPointer<CancellationToken> token)
+{
+    if (!m_core || request.targetT.isEmpty()) return;
+    CancellationToken::Scope cancellationScope(token.data());
+    TaskScheduler::PriorityScope priorityScope(TaskScheduler::Interactive);
+
+    ModelPreviewResult result;
+    result.generation = generation;
+    result.params = request.params;
+
+    // 1. 粗略曲线：稀疏时间点 + 低精度
+    const QVector<double> quickT = thinTimes(request.targetT, QuickPoints);
+    const SolverSettings quickSettings = request.settings.withHighPrecision(false);
+    const bool needQuick = quickT.size() < request.targetT.size() || quickSettings != request.settings || request.adaptive;
+    if (needQuick) {
+        {
+            ModelSolver01_06::ScopedSerialEvaluation serialScope;
+            result.curve = m_core->calculateModelCurve(request.modelType, quickSettings, request.params, quickT);
+        }
+        if (token->isCancelled()) return;
+        deliver(result);
+    }
+
+    if (!computeRefined(request, *token, result)) return;
+    deliver(result);
+}
+
+bool ModelPreviewPipeline::computeRefined(const ModelPreviewRequest& request, const CancellationToken& token,
+                                          ModelPreviewResult& result)
+{
+    // 2. 精细曲线
+    auto evaluate = [&](const QVector<double>& times) {
+        return m_core->calculateModelCurves(request.modelType, request.settings,
+                                            QVector<QMap<QString, double>>() << request.params, times);
+    };
+    QVector<ModelCurveData> curves;
+    if (request.adaptive && request.targetT.size() > 1) {
+        AdaptiveSamplingOptions sampling;
+        sampling.maxPoints = AdaptiveCurveSampler::previewPointBudget();
+        curves = AdaptiveCurveSampler::sample(evaluate, *std::min_element(request.targetT.constBegin(), request.targetT.constEnd()),
+                                              *std::max_element(request.targetT.constBegin(), request.targetT.constEnd()), sampling);
+    }
+    if (token.isCancelled()) return false;
+    if (curves.isEmpty()) curves = evaluate(request.targetT);
+    if (token.isCancelled() || curves.isEmpty()) return false;
+    result.refined = true;
+    result.curve = curves.first();
+
+    // 3. 抽样点上的误差
+    if (request.computeError) {
+        QVector<double> sampleT, sampleP, sampleD;
+        m_core->getSampledObservedData(sampleT, sampleP, sampleD);
+        const QVector<double> residuals = m_core->calculateResiduals(request.settings, request.params, request.modelType,
+                                                                     request.weight, sampleT, sampleP, sampleD);
+        if (token.isCancelled()) return false;
+        if (!residuals.isEmpty()) result.mse = m_core->calculateSumSquaredError(residuals) / residuals.size();
+    }
+    return true;
+}
+
+QByteArray ModelPreviewPipeline::speculationKey(const ModelPreviewRequest& request) const
+{
+    QByteArray key = FitEvaluationCache::makeKey(int(request.modelType), request.settings, request.params,
+                                                 request.targetT, m_core->observedDataHash());
+    key.append(char(request.adaptive));
+    key.append(char(request.computeError));
+    key.append(reinterpret_cast<const char*>(&request.weight), sizeof(request.weight));
+    return key;
+}
+
+void ModelPreviewPipeline::speculate(const QVector<ModelPreviewRequest>& candidates)
+{
+    if (!m_core) return;
+    if (m_speculationToken) m_speculationToken->cancel();
+    m_speculationToken.clear();
+    pruneFinished();
+
+    QVector<QByteArray> keys;
+    keys.reserve(candidates.size());
+    for (const ModelPreviewRequest& request : candidates) keys.append(request.targetT.isEmpty() ? QByteArray() : speculationKey(request));
+
+    QVector<ModelPreviewRequest> pending;
+    QVector<QByteArray> pendingKeys;
+    quint64 epoch;
+    {
+        QMutexLocker locker(&m_speculationMutex);
+        epoch = ++m_speculationEpoch;
+        for (auto it = m_speculative.begin(); it != m_speculative.end();) {
+            if (keys.contains(it.key())) ++it;
+            else it = m_speculative.erase(it);
+        }
+        for (int i = 0; i < candidates.size(); ++i) {
+            if (keys[i].isEmpty() || m_speculative.contains(keys[i]) || pendingKeys.contains(keys[i])) continue;
+            pending.append(candidates[i]);
+            pendingKeys.append(keys[i]);
+        }
+    }
+    if (pending.isEmpty()) return;
+
+    m_speculationToken = QSharedPointer<CancellationToken>::create();
+    QSharedPointer<CancellationToken> token = m_speculationToken;
+    m_futures.append(QtConcurrent::run([this, epoch, pending, pendingKeys, token]() {
+        runSpeculation(epoch, pending, pendingKeys, token);
+    }));
+}
+
+void ModelPreviewPipeline::clearSpeculation()
+{
+    if (m_speculationToken) m_speculationToken->cancel();
+    m_speculationToken.clear();
+    QMutexLocker locker(&m_speculationMutex);
+    ++m_speculationEpoch;
+    m_speculative.clear();
+}
+
+int ModelPreviewPipeline::speculativeCount() const
+{
+    QMutexLocker locker(&m_speculationMutex);
+    return m_speculative.size();
+}
+
+void ModelPreviewPipeline::runSpeculation(quint64 epoch, const QVector<ModelPreviewRequest>& candidates,
+                                          const QVector<QByteArray>& keys, QSharedPointer<CancellationToken> token)
+{
+    CancellationToken::Scope cancellationScope(token.data());
+    TaskScheduler::PriorityScope priorityScope(TaskScheduler::Batch);
+    for (int i = 0; i < candidates.size(); ++i) {
+        if (token->isCancelled()) return;
+        ModelPreviewResult result;
+        result.params = candidates[i].params;
+        if (!computeRefined(candidates[i], *token, result)) return;
+        QMutexLocker locker(&m_speculationMutex);
+        if (epoch != m_speculationEpoch) return;
+        m_speculative.insert(keys[i], result);
+    }
+}
+
+void ModelPreviewPipeline::deliver(const ModelPreviewResult& result)
+{
+    // 在界面线程按代号过滤：等待排队期间又有新请求提交时丢弃
+    QMetaObject::invokeMethod(this, [this, result]() {
+        if (result.generation == m_generation) emit previewReady(result);
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,104 @@
+/*
+ * 文件名: modelpreviewpipeline.h
+ * 文件作用: 参数调节时的异步理论曲线预览头文件
+ * 功能描述:
+ * 1. 每次参数变化提交一个预览请求并分配递增的代号 (generation)，计算放到线程池中进行，界面线程不等待。
+ * 2. 新请求提交时取消仍在计算的旧请求 (每个请求持有独立的 CancellationToken，求解器逐节点检查后提前结束)；
+ *    结果回到界面线程后再按代号过滤，只有最新请求的结果会发出 previewReady (后到者为准)。
+ * 3. 每个请求分两步：先在稀疏时间点上以低精度设置快速计算一条粗略曲线，随后以完整设置计算精细曲线
+ *    (可按曲率自适应布点) 与抽样点上的误差，精细结果到达后替换粗略曲线。
+ * 4. [投机预计算] speculate 在界面空闲时以批量优先级依次计算候选请求 (正在调节的参数向两侧各滚动几格) 的精细结果并暂存；
+ *    之后 submit 的请求与某个暂存结果的键相同时直接交付，不再计算。新的候选集合只保留仍在其中的暂存结果，
+ *    clearSpeculation 丢弃全部暂存结果 (换选参数、基准参数改变或开始拟合时调用)。
+ */
+
+#ifndef MODELPREVIEWPIPELINE_H
+#define MODELPREVIEWPIPELINE_H
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include "fittingcore.h"
+#include "cancellationtoken.h"
+
+// 预览请求：精细曲线的求解器设置与时间点
+struct ModelPreviewRequest {
+    ModelEngine::ModelType modelType = ModelEngine::Model_1;
+    QMap<QString, double> params;
+    SolverSettings settings;
+    QVector<double> targetT;
+    bool adaptive = false;     // 精细曲线按曲率自适应布点 (点数预算 300)
+    bool computeError = false; // 精细曲线之后计算抽样点上的误差 (MSE)
+    double weight = 0.5;       // 误差的压差/导数权重
+};
+
+// 预览结果
+struct ModelPreviewResult {
+    quint64 generation = 0;
+    bool refined = false;      // 假为粗略曲线，真为精细曲线
+    QMap<QString, double> params;
+    ModelCurveData curve;
+    double mse = -1.0;         // 未计算时为负
+};
+
+class ModelPreviewPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ModelPreviewPipeline(FittingCore* core, QObject* parent = nullptr);
+    ~ModelPreviewPipeline();
+
+    // 提交请求 (取消之前的请求)，返回请求代号
+    quint64 submit(const ModelPreviewRequest& request);
+
+    // 取消全部请求：之后到达的结果一律丢弃 (同步刷新曲线或开始拟合前调用)
+    void cancel();
+
+    quint64 latestGeneration() const { return m_generation; }
+
+    // 投机预计算：取消上一批未完成的候选，丢弃不在 candidates 中的暂存结果，其余候选按顺序在后台计算
+    void speculate(const QVector<ModelPreviewRequest>& candidates);
+    // 取消投机计算并丢弃全部暂存结果
+    void clearSpeculation();
+    // 暂存结果数与 submit 命中次数
+    int speculativeCount() const;
+    int speculativeHits() const { return m_speculativeHits; }
+
+    // 粗略曲线的点数上限
+    static const int QuickPoints = 60;
+    // 投机预计算向每个方向预计算的滚轮格数
+    static const int SpeculativeSteps = 3;
+
+signals:
+    // 最新请求的结果 (在界面线程发出；每个请求先后发出粗略与精细两次，粗略与精细相同时只发出一次)
+    void previewReady(const ModelPreviewResult& result);
+
+private:
+    void run(quint64 generation, const ModelPreviewRequest& request, QSharedPointer<CancellationToken> token);
+    // 精细曲线与误差 (run 的第 2、3 步)，取消时返回 false
+    bool computeRefined(const ModelPreviewRequest& request, const CancellationToken& token, ModelPreviewResult& result);
+    void runSpeculation(quint64 epoch, const QVector<ModelPreviewRequest>& candidates,
+                        const QVector<QByteArray>& keys, QSharedPointer<CancellationToken> token);
+    // 暂存结果的键：曲线键 (FitEvaluationCache::makeKey，含观测数据与抽样散列) 加上布点与误差选项
+    QByteArray speculationKey(const ModelPreviewRequest& request) const;
+    // 把结果交回界面线程
+    void deliver(const ModelPreviewResult& result);
+    void pruneFinished();
+
+    FittingCore* m_core;
+    quint64 m_generation;
+    QSharedPointer<CancellationToken> m_token; // 最新请求的取消令牌
+    QList<QFuture<void>> m_futures;           // 尚未结束的计算 (析构时等待)
+
+    mutable QMutex m_speculationMutex;
+    QHash<QByteArray, ModelPreviewResult> m_speculative; // 投机计算的精细结果
+    quint64 m_speculationEpoch;                          // 候选集合每次更新加一，过期的后台计算不再写入
+    QSharedPointer<CancellationToken> m_speculationToken;
+    int m_speculativeHits;
+};
+
+#endif // MODELPREVIEWPIPELINE_H
@@ -6,16 +6,96 @@
  * 2. [参数扩充] 增加了对 remda2 (lambda2), eta (eta12), M12 等关键参数的读取。
  * 3. [模型修正] 修正了 Model 2/4/6 (恒定井储/无井储) 的处理逻辑，与 MATLAB 注释代码一致。
  * 4. [精度控制] 保持了 Stehfest N=10 的默认设置以确保平滑度，同时兼容传入参数控制。
+ * 5. [性能优化] PWD_composite 对等间距裂缝节点采用 Toeplitz 装配，每个偏移量的积分只计算一次，
+ *    非均匀布局自动回退为逐元素完整装配。
+ * 6. [性能优化] 参数字典在 calculateTheoreticalCurve 中一次性解析为 ModelParams，
+ *    Laplace 核函数与 PWD_composite 直接读取结构体成员，消除热路径中的字符串查找与 xwD 重建。
+ * 7. [性能优化] calculatePDandDeriv 支持各时间点并行反演 (QtConcurrent)，输出顺序确定；
+ *    已处于并行任务中的调用方可通过 ScopedSerialEvaluation 回退为串行。
+ * 8. [反演引擎] 数值反演改为可插拔引擎 (Stehfest/Talbot/de Hoog/Euler)，节点与权重按阶数预计算；
+ *    Laplace 内核模板化以支持复数节点，并补充复数参数的 K0/K1/I0/I1 计算。
+ * 9. [性能优化] 像函数值经 LaplaceEvaluationCache 按无因次输入缓存，雅可比矩阵中 q/B/h 等
+ *    仅影响缩放系数的扰动列及重复试算点不再重复执行 Bessel/积分/LU 计算。
+ * 10. [解析敏感度] 新增 calculateCurveSensitivity：核函数以 SensitivityJet 前向自动微分求值，
+ *    加边方程组只分解一次、各方向复用；时间换算、压力缩放与压敏摄动按链式法则解析求导。
+ * 11. [性能优化] 实数参数 K0/K1/I0/I1 改用 BesselBatch 有理逼近 (无异常/策略开销)；
+ *    高斯积分按面板批量求值被积函数，15 个节点的 K0 与缩放 I0 一次调用完成，边界项同样合并求值。
+ * 12. [积分精度] 裂缝积分改用完整精度的 G7-K15 节点/权重 (原 6 位截断节点)，以内嵌 7 点结果估计误差，
+ *    每个面板只求值一次；积分器为模板函数并使用显式工作区，无 std::function 与堆分配；
+ *    自感应项扣除 K0 的对数奇异性后积分，最大二分深度由 8 降为 5。
+ * 13. [性能优化] 加边方程组的矩阵、右端项与 LU 分解对象改为线程局部工作区复用；默认部分选主元 LU，
+ *    倒条件数估计低于 1e-12 或解非有限时升级为全选主元，Jet 版本各求导方向复用同一分解。
+ * 14. [批量计算] 新增 calculateTheoreticalCurvesBatch：多组参数的全部像函数求值合并为一次并行调度；
+ *    flaplace_composite 拆分为储层响应与井储表皮两部分，仅 cD/S/gamaD/q/B/h 不同的参数组共享节点与储层响应。
+ * 15. [类型曲线库] 开启快速路径时，查询点位于已加载类型曲线库的制表范围内则直接插值无因次曲线，
+ *    跳过数值反演；新增 calculateDimensionlessCurve 供库离线生成。
+ * 16. [模型策略] 外边界 (无限大/封闭/定压) 与井储 (有/无) 改为编译期策略，六种模型各自实例化内核，
+ *    构造时按模型类型选定函数表；无限大边界模型不再准备外边界 Bessel 项，无井储模型直接返回储层响应。
+ * 17. [网格求值] 开启 solver/gridPointsPerDecade 后，稠密或不规则的请求时间点改为在对数等距网格上反演，
+ *    Bourdet 导数在规则网格上计算，再按双对数单调三次插值到请求时间点。
+ * 18. [渐近路径] PWD_composite 增加早期与晚期快速路径：Re(γ1)·d_min 超过阈值时 Bessel 耦合项指数级可忽略，
+ *    直接返回裂缝线性流渐近解；|γ1|·d_max 低于阈值时 K0/I0 按小参数级数逐项解析积分。
+ *    阈值由设置项 solver/asymptoticEarlyArgument / solver/asymptoticLateArgument 给出，调用次数按区间原子计数。
+ * 19. [精度控制] 可选的逐点精度控制：相邻两级反演阶数之差作为误差估计，未达到目标误差的时间点逐级提高阶数，
+ *    阶数不再奏效时收紧裂缝积分容差；setHighPrecision 对应目标相对误差 1e-5 / 1e-3。
+ * 20. [协作取消] 曲线、批量与敏感度计算在入口读取调用线程登记的 CancellationToken (cancellationtoken.h)，
+ *    逐个 Laplace 节点检查取消标志与截止时间，已取消时立即结束且不写入缓存，调用方据令牌丢弃结果。
+ * 21. [性能跟踪] 曲线/批量/敏感度入口、calculatePDandDeriv、PWD_composite 与自适应 Gauss-Kronrod 积分记录跟踪区间
+ *    (tracing.h；默认关闭时每处只有一次原子读取)。
+ * 22. [性能设置] resolveParams 中未指定 nf 时的默认离散段数改为可设置的全局值 (原固定为 10)。
+ * 23. [多段裂缝] 等间距布局且 nf 不少于 TOEPLITZ_SOLVE_MIN_SEGMENTS 时，加边方程组化为对称 Toeplitz 方程组 A·y = 1，
+ *    以 Levinson 递推 O(nf²) 求解 (pwd = 1 / (z·Σy))，不再装配 nf×nf 矩阵与 O(nf³) 的 LU 分解；
+ *    递推中断或残差超限时回退为稠密 LU。段数较少时仍走稠密 LU，结果与原实现逐位相同。
+ * 24. [混合精度] Stehfest 反演在双精度下的误差主要是像函数误差被交错系数放大 (N=10 时 Σ|V_i| ≈ 1.3e6)：
+ *    开启 solver/mixedPrecision 后逐点以放大系数估计误差，只对超出目标误差的时间点收紧裂缝积分 (容差 ×1e-4、深度 +4)
+ *    并以双双精度求和 (StehfestInversion::invertExtended)，其余时间点的结果与关闭时逐位相同。
+ * 25. [节点共享] 开启 solver/sharedLaplaceNodes 后，网格求值改用 CurveInterpolation::dyadicGrid (t 加倍逐位精确)，
+ *    calculatePDandDeriv 先汇总各时间点的 Stehfest 节点并按位去重，并行求出不同节点的像函数后再逐点反演。
+ *    二进网格上每个时间点只有奇数阶节点是新的，N=10 时像函数求值次数约减半；各点反演结果与逐点求值逐位相同。
+ * 26. [批量像函数] 实数节点 (Stehfest) 的缓存未命中节点整组交给 flaplaceCompositeBatch：fs1/fs2、γ1/γ2、
+ *    界面与外边界的 Bessel 值 (BesselBatch 批量接口)、mAB 与 Ac 前因子按结构数组逐趟计算，
+ *    随后逐节点调用 fractureSystemResponse (由 PWD_composite 拆出的裂缝方程组部分) 装配求解；结果与逐点求值逐位相同。
+ *    取消检查由逐节点改为每组节点一次。
+ * 27. [设备卸载] calculateCurvesBatchDirect 在启用设备后端 (performance/laplaceBackend) 时，把各组实数节点的储层响应
+ *    合并为一个 LaplaceBatchRequest 交给 LaplaceBatchBackend::offloadReservoir，成功后工作项只叠加井储表皮；
+ *    卸载结果不写入 Laplace 缓存 (缓存命中仍优先)，复数节点、规模不足或设备回退时按原 CPU 路径计算。
+ * 28. [任务调度] 时间点、节点分块与批量工作项的并行改经 TaskScheduler::parallelFor (taskscheduler.h) 派发：
+ *    在雅可比列等并行任务中调用时不再需要 ScopedSerialEvaluation 回退为串行，等待期间调用线程继续执行其他任务。
+ * 29. [像函数插值] 开启 solver/laplaceInterpolation 后，实数节点 (Stehfest) 的曲线先在全部节点覆盖的 ln z 区间上
+ *    以精确像函数建立分段 Chebyshev 插值表 (LaplaceInterpolant，相对误差上限为目标误差 ×1e-6，不低于 1e-11)，
+ *    各时间点的节点值再由插值给出，每条曲线的像函数调用次数 (典型为一两百次) 不再随时间点数增长；
+ *    插值值不写入 Laplace 缓存，混合精度的扩展精度重算仍使用精确像函数，建表失败时按原路径逐节点求值。
+ * 30. [模式一致] 批量接口在开启精度控制、混合精度、节点共享或像函数插值模式时逐条改走 calculateCurveDirect，
+ *    不再静默忽略这些模式；分组复用储层响应与设备卸载只在四者均关闭时使用。
  */
 
 #include "modelsolver01-06.h"
 #include "pressurederivativecalculator.h"
+#include "laplaceinversion.h"
+#include "laplacecache.h"
+#include "laplacebatchbackend.h"
+#include "laplaceinterpolant.h"
+#include "sensitivityjet.h"
+#include "besselbatch.h"
+#include "typecurvelibrary.h"
+#include "curveinterpolation.h"
+#include "cancellationtoken.h"
+#include "memoryaccounting.h"
+#include "taskscheduler.h"
+#include "tracing.h"
 
 #include <Eigen/Dense>
 #include <boost/math/special_functions/bessel.hpp>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <numeric>
+#include <complex>
+#include <cstring>
+#include <QAtomicInteger>
+#include <QHash>
 #include <QDebug>
+#include <QSettings>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -25,9 +105,12 @@
 
 // 安全的 Bessel K 调用
 // 作用：计算第二类修正贝塞尔函数 K_v(x)，增加对极小参数的保护
+// 0/1 阶使用 BesselBatch 有理逼近，其余阶数仍调用 boost
 static double safe_bessel_k(int v, double x) {
     // 严格限制 x 的下限，防止 0 导致溢出 (MATLAB 中 besselk(0) 为 Inf)
     if (x < 1e-15) x = 1e-15;
+    if (v == 0) return BesselBatch::k0(x);
+    if (v == 1) return BesselBatch::k1(x);
     return boost::math::cyl_bessel_k(v, x);
 }
 
@@ -36,6 +119,9 @@ static double safe_bessel_k(int v, double x) {
 // 用于处理大参数时的数值溢出问题，与 MATLAB 中 scaling 技巧对应
 static double safe_bessel_i_scaled(int v, double x) {
     if (x < 0) x = -x;
+    // 0/1 阶直接计算缩放形式 (大参数时同样精确，无需渐近近似)
+    if (v == 0) return BesselBatch::i0Scaled(x);
+    if (v == 1) return BesselBatch::i1Scaled(x);
     // 大参数渐近近似 I_v(x) * exp(-x) ~ 1/sqrt(2*pi*x)
     if (x > 600.0) return 1.0 / std::sqrt(2.0 * M_PI * x);
     try {
@@ -45,56 +131,1894 @@ static double safe_bessel_i_scaled(int v, double x) {
     }
 }
 
+// ---------------------- 复数参数 Bessel 函数 ----------------------
+// 复数节点反演 (Talbot / de Hoog / Euler) 需要在复平面上计算 K0/K1/I0/I1。
+// 调用处参数均为主值平方根 sqrt(z*fs) 与非负实数的乘积，即 Re(z) >= 0。
+// 算法: |z| <= 2 用幂级数; |z| > 2 时 K 用 Steed 连分式 (CF2)，I 由连分式 (CF1) 求 I1/I0 后经 Wronskian 得到。
+
+typedef std::complex<double> cplx;
+
+static const double EULER_GAMMA = 0.57721566490153286061;
+
+// 复数倒数 (Smith 算法，避免通用复数除法中的 inf/nan 特殊处理开销，且对极小/极大模长不溢出)
+static inline cplx complexInverse(cplx z) {
+    double a = z.real(), b = z.imag();
+    if (std::abs(a) >= std::abs(b)) {
+        double r = b / a;
+        double den = a + b * r;
+        return cplx(1.0 / den, -r / den);
+    }
+    double r = a / b;
+    double den = a * r + b;
+    return cplx(r / den, -1.0 / den);
+}
+
+// 幂级数：给出 I0, I1 (未缩放)；needK 为 true 时同时给出 K0, K1
+// 级数在 |z| 较小或 Re(z) 较小时无明显相消，调用方据此选择适用范围
+static void complexBesselSeries(cplx z, bool needK, cplx& i0, cplx& i1, cplx& k0, cplx& k1) {
+    cplx t = 0.25 * z * z;          // (z/2)^2
+    cplx term0(1.0, 0.0);           // t^k / (k!)^2
+    cplx termK1(1.0, 0.0);          // t^k / (k!(k+1)!)
+    cplx sumI0 = term0, sumI1 = termK1;
+    cplx sumK0(0.0, 0.0);           // Σ H_k * t^k/(k!)^2
+    cplx sumK1 = -2.0 * EULER_GAMMA + 1.0; // k=0: (ψ(1)+ψ(2)) = H_0 + H_1 - 2γ
+    double Hk = 0.0;                // 调和数 H_k
+    for (int k = 1; k < 80; ++k) {
+        term0 *= t * (1.0 / (double(k) * k));
+        termK1 *= t * (1.0 / (double(k) * (k + 1)));
+        sumI0 += term0;
+        sumI1 += termK1;
+        if (needK) {
+            Hk += 1.0 / k;
+            double Hk1 = Hk + 1.0 / (k + 1);
+            sumK0 += Hk * term0;
+            sumK1 += (Hk + Hk1 - 2.0 * EULER_GAMMA) * termK1;
+        }
+        if (std::norm(term0) < 1e-34 * std::norm(sumI0) && std::norm(termK1) < 1e-34 * std::norm(sumI1)) break;
+    }
+    i0 = sumI0;
+    i1 = 0.5 * z * sumI1;
+    if (needK) {
+        cplx logHalf = std::log(0.5 * z);
+        k0 = -(logHalf + EULER_GAMMA) * sumI0 + sumK0;
+        k1 = complexInverse(z) + logHalf * i1 - 0.25 * z * sumK1;
+    }
+}
+
+// Steed 连分式 CF2：计算缩放的 K0(z)*e^z 与 K1(z)*e^z (Numerical Recipes bessik, mu=0)
+static void complexBesselKScaledCF2(cplx z, cplx& k0s, cplx& k1s) {
+    cplx b = 2.0 * (1.0 + z);
+    cplx d = complexInverse(b);
+    cplx h = d, delh = d;
+    cplx q1(0.0, 0.0), q2(1.0, 0.0);
+    double a1 = 0.25;
+    cplx q(a1, 0.0), c(a1, 0.0);
+    double a = -a1;
+    cplx sum = 1.0 + q * delh;
+    for (int i = 1; i < 20000; ++i) {
+        a -= 2 * i;
+        c = -a * c / (i + 1.0);
+        cplx qnew = (q1 - b * q2) / a;
+        q1 = q2;
+        q2 = qnew;
+        q += c * qnew;
+        b += 2.0;
+        d = complexInverse(b + a * d);
+        delh = (b * d - 1.0) * delh;
+        h += delh;
+        cplx dels = q * delh;
+        sum += dels;
+        if (std::norm(dels) < 1e-32 * std::norm(sum)) break;
+    }
+    h = a1 * h;
+    k0s = std::sqrt(M_PI / (2.0 * z)) * complexInverse(sum);
+    k1s = k0s * (z + 0.5 - h) * complexInverse(z);
+}
+
+// 连分式 CF1 (修正 Lentz 算法)：计算 I1(z)/I0(z)
+static cplx complexBesselIRatioCF1(cplx z) {
+    const double tiny = 1e-300;
+    cplx xi2 = 2.0 * complexInverse(z);
+    cplx h(tiny, 0.0);
+    cplx b(0.0, 0.0), d(0.0, 0.0), c = h;
+    for (int i = 1; i < 20000; ++i) {
+        b += xi2;
+        d = complexInverse(b + d);
+        c = b + complexInverse(c);
+        cplx del = c * d;
+        h = del * h;
+        if (std::norm(del - 1.0) < 1e-32) break;
+    }
+    return h;
+}
+
+// 大参数渐近展开：isK 为 true 时返回 K_v(z)*e^z，否则返回 I_v(z)*e^{-z} (仅主导项)
+// 系数 a_k(v) = Π_{j=1..k} (4v^2 - (2j-1)^2) / (k! 8^k)，在 |z| > 17 时截断误差低于 1e-15
+static cplx complexBesselAsymptotic(int v, cplx z, bool isK) {
+    double mu = 4.0 * v * v;
+    cplx inv = complexInverse(z);
+    cplx term(1.0, 0.0), sum(1.0, 0.0);
+    for (int k = 1; k < 40; ++k) {
+        double odd = 2.0 * k - 1.0;
+        term *= (mu - odd * odd) / (8.0 * k) * inv;
+        sum += (isK || k % 2 == 0) ? term : -term; // I 的展开为交错级数
+        if (std::norm(term) < 1e-34 * std::norm(sum)) break;
+    }
+    if (isK) return std::sqrt(M_PI / (2.0 * z)) * sum;
+    return sum / std::sqrt(2.0 * M_PI * z);
+}
+
+// 复数参数 Bessel K (未缩放)，与实数版本 safe_bessel_k 同名重载，供模板内核使用
+static cplx safe_bessel_k(int v, cplx z) {
+    if (std::abs(z) < 1e-15) z = cplx(1e-15, 0.0);
+    double az = std::abs(z);
+    // 小参数或实部较小 (K 与 I 量级相近，级数相消可控) 时使用幂级数
+    if (az <= 2.0 || (az <= 12.0 && z.real() <= 2.0)) {
+        cplx i0, i1, k0, k1;
+        complexBesselSeries(z, true, i0, i1, k0, k1);
+        return (v == 0) ? k0 : k1;
+    }
+    if (z.real() > 700.0) return cplx(0.0, 0.0); // e^{-z} 下溢
+    cplx ks;
+    if (az > 17.0) {
+        ks = complexBesselAsymptotic(v, z, true);
+    } else {
+        cplx k0s, k1s;
+        complexBesselKScaledCF2(z, k0s, k1s);
+        ks = (v == 0) ? k0s : k1s;
+    }
+    return ks * std::exp(-z);
+}
+
+// 复数参数缩放 Bessel I：I_v(z) * exp(-z)，与实数版本 safe_bessel_i_scaled 同名重载
+static cplx safe_bessel_i_scaled(int v, cplx z) {
+    if (z.real() < 0) z = -z;
+    double az = std::abs(z);
+    if (az <= 12.0) {
+        cplx i0, i1, k0, k1;
+        complexBesselSeries(z, false, i0, i1, k0, k1);
+        return ((v == 0) ? i0 : i1) * std::exp(-z);
+    }
+    // 大参数且实部足够大时 e^{-2z} 量级的次要项可忽略，直接使用渐近展开
+    if (az > 17.0 && z.real() > 17.0) {
+        return complexBesselAsymptotic(v, z, false);
+    }
+    cplx k0s, k1s;
+    complexBesselKScaledCF2(z, k0s, k1s);
+    cplx ratio = complexBesselIRatioCF1(z);
+    cplx i0s = complexInverse(z * (k1s + ratio * k0s)); // Wronskian: I0*K1 + I1*K0 = 1/z
+    return (v == 0) ? i0s : ratio * i0s;
+}
+
+// 模板内核辅助：分母保护 (实数保持原符号逻辑，复数按模长判断)
+static double guardDenominator(double v) {
+    if (std::abs(v) < 1e-100) return (v >= 0 ? 1e-100 : -1e-100);
+    return v;
+}
+static cplx guardDenominator(cplx v) {
+    if (std::abs(v) < 1e-100) return cplx(1e-100, 0.0);
+    return v;
+}
+
+// 模板内核辅助：开方前的负值保护 (复数节点使用主值平方根，无需处理)
+static double clampNonNegativeSpeed(double z, double fs) {
+    return (z * fs < 0) ? 0.0 : fs;
+}
+static cplx clampNonNegativeSpeed(cplx, cplx fs) {
+    return fs;
+}
+
+// 模板内核辅助：数值有效性判断
+static bool isFiniteValue(double v) { return !(std::isnan(v) || std::isinf(v)); }
+static bool isFiniteValue(cplx v) { return isFiniteValue(v.real()) && isFiniteValue(v.imag()); }
+
+// 当前线程是否处于串行作用域内 (由 ScopedSerialEvaluation 维护)
+static thread_local bool t_forceSerialEvaluation = false;
+
+// 未指定 nf 时的裂缝离散段数 (见 setDefaultFractureSegments)
+static QAtomicInteger<int> s_defaultFractureSegments(10);
+
+// ---------------------- 前向自动微分 (敏感度) 支持 ----------------------
+// 核函数以 SensitivityJet 实例化时，无因次参数本身也是带导数分量的 Jet；
+// 以 double / cplx 实例化时参数保持为 double，运算过程与原实现逐位一致。
+
+template <typename T>
+struct KernelScalar {
+    typedef double Param;
+    static double seed(const ModelParams&, double value, int) { return value; }
+    static bool hasTangent(double) { return false; }
+};
+
+template <typename S>
+struct KernelScalar<SensitivityJet<S>> {
+    typedef SensitivityJet<S> Param;
+    // 按 ModelParams::sensitivitySlot 把对应参数设为求导自变量，未参与求导的参数为常数
+    static Param seed(const ModelParams& p, double value, int which) {
+        int slot = p.sensitivitySlot[which];
+        if (slot < 0) return Param(S(value));
+        return Param::variable(S(value), slot, p.sensitivityCount);
+    }
+    static bool hasTangent(const Param& x) { return x.n > 0; }
+};
+
+// Bessel K 的 Jet 版本：K0' = -K1，K1' = -K0 - K1/x
+template <typename S>
+static SensitivityJet<S> safe_bessel_k(int v, const SensitivityJet<S>& x) {
+    if (x.n == 0) return SensitivityJet<S>(safe_bessel_k(v, x.v));
+    S k0 = safe_bessel_k(0, x.v);
+    S k1 = safe_bessel_k(1, x.v);
+    SensitivityJet<S> r(v == 0 ? k0 : k1);
+    S slope = (v == 0) ? S(-k1) : S(-(k0 + k1 / x.v));
+    SensitivityJet<S>::scale(r, slope, x);
+    return r;
+}
+
+// 缩放 Bessel I 的 Jet 版本 (Is_v = I_v * e^{-x})：Is0' = Is1 - Is0，Is1' = Is0 - Is1/x - Is1
+template <typename S>
+static SensitivityJet<S> safe_bessel_i_scaled(int v, const SensitivityJet<S>& x) {
+    if (x.n == 0) return SensitivityJet<S>(safe_bessel_i_scaled(v, x.v));
+    S i0s = safe_bessel_i_scaled(0, x.v);
+    S i1s = safe_bessel_i_scaled(1, x.v);
+    SensitivityJet<S> r(v == 0 ? i0s : i1s);
+    S slope;
+    if (v == 0) {
+        slope = i1s - i0s;
+    } else {
+        S i1OverX = (x.v == S(0.0)) ? S(0.5) : S(i1s / x.v); // x -> 0 时 I1(x)/x -> 1/2
+        slope = i0s - i1OverX - i1s;
+    }
+    SensitivityJet<S>::scale(r, slope, x);
+    return r;
+}
+
+template <typename S>
+static SensitivityJet<S> guardDenominator(const SensitivityJet<S>& v) {
+    if (abs(v) < 1e-100) return SensitivityJet<S>(guardDenominator(v.v));
+    return v;
+}
+
+template <typename S>
+static SensitivityJet<S> clampNonNegativeSpeed(const SensitivityJet<S>& z, const SensitivityJet<S>& fs) {
+    S clamped = clampNonNegativeSpeed(z.v, fs.v);
+    if (clamped == fs.v) return fs;
+    return SensitivityJet<S>(clamped);
+}
+
+template <typename S>
+static bool isFiniteValue(const SensitivityJet<S>& x) {
+    if (!isFiniteValue(x.v)) return false;
+    for (int k = 0; k < x.n; ++k) {
+        if (!isFiniteValue(x.d[k])) return false;
+    }
+    return true;
+}
+
+// Leibniz 公式：积分限随参数变化时补充 boundary * d(limit) 项 (仅 Jet 类型有效)
+template <typename T>
+static void addLimitDerivative(T&, const T&, double) {
+}
+
+template <typename S>
+static void addLimitDerivative(SensitivityJet<S>& integral, const SensitivityJet<S>& boundary, const SensitivityJet<S>& limit) {
+    SensitivityJet<S> delta(S(0.0));
+    SensitivityJet<S>::scale(delta, boundary.v, limit);
+    integral += delta;
+}
+
+// ---------------------- 线程局部求解工作区 ----------------------
+// 加边方程组的系数矩阵、右端项、解向量与 LU 分解对象按线程复用：规模 (nf+1) 不变时不再重新分配，
+// 各时间点并行与雅可比矩阵列并行时每个工作线程各持一份，互不加锁
+
+// 部分选主元 LU 的倒条件数估计低于该值时升级为全选主元 LU
+static const double BORDERED_RCOND_LIMIT = 1e-12;
+
+template <typename S>
+struct BorderedSystemWorkspace {
+    typedef Eigen::Matrix<S, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+    typedef Eigen::Matrix<S, Eigen::Dynamic, 1> Vector;
+
+    Matrix A;                         // 加边系数矩阵
+    Vector b;                         // 右端项 (0, ..., 0, 1)
+    Vector x;                         // 解向量
+    Vector rhs;                       // 求导方向右端项 (Jet 版本使用)
+    Vector dx;                        // 求导方向的解 (Jet 版本使用)
+    Eigen::PartialPivLU<Matrix> partialLu;
+    Eigen::FullPivLU<Matrix> fullLu;
+    bool fullPivot = false;           // 当前分解是否为全选主元
+    int size = 0;
+
+    static BorderedSystemWorkspace& local() {
+        static thread_local BorderedSystemWorkspace workspace;
+        return workspace;
+    }
+
+    // 按规模准备存储 (规模不变时保持已分配的缓冲区)
+    void prepare(int n) {
+        if (size == n) return;
+        A.resize(n, n);
+        b.resize(n);
+        x.resize(n);
+        rhs.resize(n);
+        dx.resize(n);
+        size = n;
+    }
+
+    // 分解 A：默认部分选主元，条件数估计过小 (或为 NaN) 时改用全选主元
+    void factorize() {
+        partialLu.compute(A);
+        fullPivot = !(partialLu.rcond() > BORDERED_RCOND_LIMIT);
+        if (fullPivot) fullLu.compute(A);
+    }
+
+    // 部分选主元得到非有限解时升级为全选主元重新分解
+    void escalate() {
+        if (fullPivot) return;
+        fullLu.compute(A);
+        fullPivot = true;
+    }
+
+    void solve(const Vector& in, Vector& out) const {
+        if (fullPivot) out = fullLu.solve(in);
+        else out = partialLu.solve(in);
+    }
+};
+
+// 影响矩阵等核函数级缓冲区 (按值类型区分)，同样按线程复用
+template <typename T>
+struct KernelWorkspace {
+    QVector<T> influence;   // nf×nf 影响矩阵 (按行存储)
+    QVector<T> diagonal;    // Toeplitz 装配时各偏移量的积分值
+    QVector<T> levinsonX;   // Levinson 递推：当前阶的解
+    QVector<T> levinsonY;   // Levinson 递推：当前阶的 Yule-Walker 解
+
+    static KernelWorkspace& local() {
+        static thread_local KernelWorkspace workspace;
+        return workspace;
+    }
+};
+
+// 求解加边的裂缝流量方程组：
+// [ A  -1 ] [ q   ]   [ 0 ]
+// [ z   0 ] [ pwd ] = [ 1 ]
+// 其中 A 为 nf×nf 影响矩阵 (按行存储)，最后一行为流量守恒 sum(qi) = 1
+// (Laplace空间为 1/s，此处求解的是 s*P，故右端为1)，返回 pwd
+template <typename T>
+static T solveBorderedSystem(const QVector<T>& influence, int nf, const T& z) {
+    BorderedSystemWorkspace<T>& ws = BorderedSystemWorkspace<T>::local();
+    ws.prepare(nf + 1);
+    ws.b.setZero();
+    ws.b(nf) = 1.0;
+    for (int i = 0; i < nf; ++i) {
+        for (int j = 0; j < nf; ++j) ws.A(i, j) = influence[i * nf + j];
+        ws.A(i, nf) = -1.0;
+        ws.A(nf, i) = z; // 流量守恒方程系数
+    }
+    ws.A(nf, nf) = 0.0;
+
+    ws.factorize();
+    ws.solve(ws.b, ws.x);
+    if (!isFiniteValue(ws.x(nf)) && !ws.fullPivot) {
+        ws.escalate();
+        ws.solve(ws.b, ws.x);
+    }
+    return ws.x(nf);
+}
+
+// Jet 版本：只对函数值矩阵做一次 LU 分解，各求导方向复用同一分解，
+// 由 A·dx = -dA·x (右端项与 -1 列不含参数，z 行仅在对 z 求导时非零) 得到解的方向导数
+template <typename S>
+static SensitivityJet<S> solveBorderedSystem(const QVector<SensitivityJet<S>>& influence, int nf, const SensitivityJet<S>& z) {
+    BorderedSystemWorkspace<S>& ws = BorderedSystemWorkspace<S>::local();
+    ws.prepare(nf + 1);
+    ws.b.setZero();
+    ws.b(nf) = 1.0;
+    int directions = z.n; // 对 z 求导时加边行本身也含导数
+    for (int i = 0; i < nf; ++i) {
+        for (int j = 0; j < nf; ++j) {
+            ws.A(i, j) = influence[i * nf + j].v;
+            directions = std::max(directions, influence[i * nf + j].n);
+        }
+        ws.A(i, nf) = -1.0;
+        ws.A(nf, i) = z.v;
+    }
+    ws.A(nf, nf) = 0.0;
+
+    ws.factorize();
+    ws.solve(ws.b, ws.x);
+    if (!isFiniteValue(ws.x(nf)) && !ws.fullPivot) {
+        ws.escalate();
+        ws.solve(ws.b, ws.x);
+    }
+
+    SensitivityJet<S> result(ws.x(nf));
+    result.n = directions;
+    for (int k = 0; k < directions; ++k) {
+        for (int i = 0; i < nf; ++i) {
+            S acc = 0.0;
+            for (int j = 0; j < nf; ++j) acc += influence[i * nf + j].derivative(k) * ws.x(j);
+            ws.rhs(i) = -acc;
+        }
+        S dz = z.derivative(k);
+        S borderAcc = 0.0;
+        for (int i = 0; i < nf; ++i) borderAcc += dz * ws.x(i);
+        ws.rhs(nf) = -borderAcc;
+        ws.solve(ws.rhs, ws.dx);
+        result.d[k] = ws.dx(nf);
+    }
+    return result;
+}
+
+// ---------------------- 等间距裂缝的 Toeplitz 快速求解 ----------------------
+// 等间距布局的影响矩阵为对称 Toeplitz 阵 A(i,j) = t(|i-j|)。加边方程组 A·q = pwd·1、z·Σq = 1
+// 等价于先解 A·y = 1，再取 q = pwd·y、pwd = 1 / (z·Σy)。对称 (复) Toeplitz 阵按 Levinson 递推求解，
+// 不取共轭；Jet 类型的导数随递推一同传播，与对稠密解求导相同。
+
+// 不少于该段数时改用 Levinson 递推 (较少时稠密 LU 更快，且保持原有结果)
+static const int TOEPLITZ_SOLVE_MIN_SEGMENTS = 24;
+// 递推中 |β| 相对 |t(0)| 低于该值视为主子式奇异
+static const double LEVINSON_BREAKDOWN_LIMIT = 1e-12;
+// 回代残差 max|1 - A·y| 超过该值时回退为稠密 LU
+static const double LEVINSON_RESIDUAL_LIMIT = 1e-8;
+
+// 解对称 Toeplitz 方程组 A·x = 1 (A 的首行为 column[0..n-1])，递推中断时返回 false
+template <typename T>
+static bool levinsonSolveOnes(const QVector<T>& column, int n, QVector<T>& x, QVector<T>& y) {
+    using std::abs;
+    const T t0 = column[0];
+    if (!(abs(t0) > 0.0)) return false;
+    x.resize(n);
+    y.resize(n);
+
+    // 按 t0 归一化：r(k) = t(k) / t0，右端项 1 / t0
+    const T b = T(1.0) / t0;
+    x[0] = b;
+    if (n == 1) return true;
+    T alpha = -column[1] / t0;
+    y[0] = alpha;
+    T beta = T(1.0);
+    for (int k = 1; k < n; ++k) {
+        beta = (T(1.0) - alpha * alpha) * beta;
+        if (!(abs(beta) > LEVINSON_BREAKDOWN_LIMIT)) return false;
+
+        T acc = T(0.0);
+        for (int j = 0; j < k; ++j) acc += column[j + 1] * x[k - 1 - j];
+        const T mu = (b - acc / t0) / beta;
+        for (int j = 0; j < k; ++j) x[j] += mu * y[k - 1 - j];
+        x[k] = mu;
+
+        if (k < n - 1) {
+            acc = column[k + 1];
+            for (int j = 0; j < k; ++j) acc += column[j + 1] * y[k - 1 - j];
+            alpha = -(acc / t0) / beta;
+            // y(1:k) += alpha·reverse(y(1:k))，两端成对更新以免覆盖
+            for (int j = 0, m = k - 1; j <= m; ++j, --m) {
+                const T yj = y[j];
+                const T ym = y[m];
+                y[j] = yj + alpha * ym;
+                if (m != j) y[m] = ym + alpha * yj;
+            }
+            y[k] = alpha;
+        }
+    }
+    return true;
+}
+
+// 等间距裂缝的加边方程组 (column 为影响矩阵首行)：段数较多时走 Levinson 递推，否则 (或递推不可靠时) 装配稠密矩阵
+template <typename T>
+static T solveUniformFractureSystem(const QVector<T>& column, int nf, const T& z) {
+    using std::abs;
+    KernelWorkspace<T>& ws = KernelWorkspace<T>::local();
+    if (nf >= TOEPLITZ_SOLVE_MIN_SEGMENTS && levinsonSolveOnes(column, nf, ws.levinsonX, ws.levinsonY)) {
+        const QVector<T>& y = ws.levinsonX;
+        // 回代残差 (Toeplitz 乘法 O(nf²))，同时累加 Σy
+        double residual = 0.0;
+        T sum = T(0.0);
+        for (int i = 0; i < nf; ++i) {
+            T row = T(0.0);
+            for (int j = 0; j < nf; ++j) row += column[std::abs(i - j)] * y[j];
+            residual = std::max(residual, double(abs(T(1.0) - row)));
+            sum += y[i];
+        }
+        if (residual <= LEVINSON_RESIDUAL_LIMIT) {
+            const T pwd = T(1.0) / guardDenominator(z * sum);
+            if (isFiniteValue(pwd)) return pwd;
+        }
+    }
+
+    QVector<T>& influence = ws.influence;
+    influence.resize(nf * nf);
+    for (int i = 0; i < nf; ++i)
+        for (int j = 0; j < nf; ++j) influence[i * nf + j] = column[std::abs(i - j)];
+    return solveBorderedSystem(influence, nf, z);
+}
+
+// ---------------------- 批量 Bessel 求值 ----------------------
+// 实数节点 (T = double) 时走 BesselBatch 批量接口，复数节点与 Jet 类型逐点调用同名重载
+
+// 边界项：一次求出若干参数处的 K0/K1 及缩放 I0/I1 (参数下限保护与 safe_bessel_k 一致)
+template <typename T>
+static void evaluateBesselSet(const T* x, T* k0, T* k1, T* i0s, T* i1s, int n) {
+    for (int i = 0; i < n; ++i) {
+        k0[i] = safe_bessel_k(0, x[i]);
+        k1[i] = safe_bessel_k(1, x[i]);
+        i0s[i] = safe_bessel_i_scaled(0, x[i]);
+        i1s[i] = safe_bessel_i_scaled(1, x[i]);
+    }
+}
+static void evaluateBesselSet(const double* x, double* k0, double* k1, double* i0s, double* i1s, int n) {
+    double clamped[BesselBatch::PanelSize];
+    for (int i = 0; i < n; ++i) clamped[i] = std::max(x[i], 1e-15);
+    BesselBatch::evaluate(clamped, k0, k1, i0s, i1s, n);
+}
+
+// 裂缝积分被积函数 y11(a) = K0(γ1·|offset-a|) + Ac·I0(γ1·|offset-a|)，对一个积分面板的全部节点求值
+// 第二项以缩放 I0 与指数偏移 exp(γ1·dist - γ1·rmD) 组合，避免大参数溢出
+template <typename T>
+static void fractureIntegrandPanel(double offset, const double* a, int n,
+                                   const T& gama1, const T& arg_g1_rm, const T& Ac_prefactor, T* out) {
+    using std::exp;
+    using std::real;
+    for (int i = 0; i < n; ++i) {
+        double dist_val = std::abs(offset - a[i]);
+        T arg_dist = gama1 * dist_val;
+        T k0_val = safe_bessel_k(0, arg_dist);
+        T term2_val = 0.0;
+        T exponent = arg_dist - arg_g1_rm;
+        if (real(exponent) > -700.0) {
+            term2_val = Ac_prefactor * safe_bessel_i_scaled(0, arg_dist) * exp(exponent);
+        }
+        out[i] = k0_val + term2_val;
+    }
+}
+static void fractureIntegrandPanel(double offset, const double* a, int n,
+                                   double gama1, double arg_g1_rm, double Ac_prefactor, double* out) {
+    double arg[BesselBatch::PanelSize];
+    double k0[BesselBatch::PanelSize];
+    double i0s[BesselBatch::PanelSize];
+    for (int i = 0; i < n; ++i) arg[i] = std::max(gama1 * std::abs(offset - a[i]), 1e-15);
+    BesselBatch::k0AndI0Scaled(arg, k0, i0s, n);
+    for (int i = 0; i < n; ++i) {
+        double exponent = arg[i] - arg_g1_rm;
+        double term2_val = (exponent > -700.0) ? Ac_prefactor * i0s[i] * std::exp(exponent) : 0.0;
+        out[i] = k0[i] + term2_val;
+    }
+}
+
+// ---------------------- 渐近快速路径 ----------------------
+
+// 渐近路径的几何尺度 (均以 L 无因次化)：
+// dMin: 早期路径要求 Bessel 耦合项衰减的最小距离，取裂缝半长 (自感应积分在端部外的尾项)、
+//       节点到相邻裂缝端部的距离与复合界面余量 2·rmD - dMax (Ac·I0 项按 exp(-γ1·(2·rmD - dist)) 衰减) 的较小者，
+//       非正时早期路径不适用 (裂缝延伸到内区以外，界面项随 γ1 增大而增长)
+// dMax: 节点到各裂缝的最大距离，晚期级数的收敛与舍入误差由 |γ1|·dMax 控制
+struct AsymptoticGeometry {
+    double dMin = 0.0;
+    double dMax = 0.0;
+};
+
+static AsymptoticGeometry asymptoticGeometry(const ModelParams& p)
+{
+    AsymptoticGeometry g;
+    const QVector<double>& xwD = p.xwD;
+    if (xwD.isEmpty()) return g;
+    double spacing = std::numeric_limits<double>::infinity();
+    for (int i = 1; i < xwD.size(); ++i) spacing = std::min(spacing, std::abs(xwD[i] - xwD[i - 1]));
+    const auto range = std::minmax_element(xwD.constBegin(), xwD.constEnd());
+    g.dMax = (*range.second - *range.first) + p.LfD;
+    g.dMin = std::min(p.LfD, std::min(spacing - p.LfD, 2.0 * p.rmD - g.dMax));
+    return g;
+}
+
+// u^{2k+1}·(ln|u| - 1/(2k+1))，u = 0 处取极限 0
+template <typename P>
+static P oddLogMoment(const P& power, const P& u, double inv)
+{
+    using std::log;
+    using std::real;
+    if (real(u) == 0.0) return P(0.0);
+    return power * ((real(u) < 0.0 ? log(-u) : log(u)) - inv);
+}
+
+// 晚期小参数级数：以 x = γ1·|u| 展开
+//   I0(x) = Σ c_k·|u|^{2k}，K0(x) = Σ c_k·|u|^{2k}·(H_k - ln(γ1/2) - γE - ln|u|)，c_k = (γ1²/4)^k / (k!)²，H_k 为调和数
+// 对 u = offset - a 在 [offset - LfD, offset + LfD] 上逐项解析积分 (∫u^{2k}du 与 ∫u^{2k}ln|u|du 的原函数均为奇函数，
+// 区间跨过 u = 0 时同样成立)，返回 ∫K0 + Ac·∫I0；LfD 为 Jet 时积分限的导数由原函数自动给出
+template <typename T, typename P>
+static T seriesInfluenceIntegral(double offset, const P& LfD, const T& gama1, const T& Ac)
+{
+    using std::abs;
+    using std::log;
+    const double eulerGamma = 0.57721566490153286061;
+    const int maxTerms = 60;
+
+    const P hi = offset + LfD;
+    const P lo = offset - LfD;
+    const P hi2 = hi * hi;
+    const P lo2 = lo * lo;
+    const double uMax2 = std::max(abs(hi2), abs(lo2));
+    const T y = 0.25 * gama1 * gama1;
+    const T logTerm = log(0.5 * gama1) + eulerGamma;
+
+    P powHi = hi, powLo = lo; // u^{2k+1}
+    T coef = 1.0;             // c_k
+    double harmonic = 0.0;    // H_k
+    T sumK0 = 0.0, sumI0 = 0.0;
+    for (int k = 0; k < maxTerms; ++k) {
+        const double inv = 1.0 / (2 * k + 1);
+        const P moment = (powHi - powLo) * inv;
+        const P logMoment = (oddLogMoment(powHi, hi, inv) - oddLogMoment(powLo, lo, inv)) * inv;
+        const T termK0 = coef * ((harmonic - logTerm) * moment - logMoment);
+        const T termI0 = coef * moment;
+        sumK0 = sumK0 + termK0;
+        sumI0 = sumI0 + termI0;
+        // 通项在 k² 超过 |y|·u² 后单调减小，此后低于累加值的舍入量级即可截断
+        if (double(k) * k >= abs(y) * uMax2
+            && abs(termK0) + abs(Ac * termI0) <= 1e-17 * (abs(sumK0) + abs(Ac * sumI0))) break;
+        powHi = powHi * hi2;
+        powLo = powLo * lo2;
+        coef = coef * y / double((k + 1) * (k + 1));
+        harmonic += 1.0 / (k + 1);
+    }
+    return sumK0 + Ac * sumI0;
+}
+
+// 单条曲线的有因次换算系数：tD = tdCoeff * t，p = pCoeff * PD
+// 物理参数非法 (phi/mu/Ct/kf 过小) 时 valid 为 false，调用方输出全零曲线
+struct CurveScaling {
+    bool valid = false;
+    double tdCoeff = 0.0;
+    double pCoeff = 0.0;
+};
+
+static CurveScaling resolveCurveScaling(const QMap<QString, double>& params)
+{
+    CurveScaling scaling;
+    double phi = params.value("phi", 0.05);
+    double mu = params.value("mu", 0.5);
+    double B = params.value("B", 1.05);
+    double Ct = params.value("Ct", 5e-4);
+    double q = params.value("q", 5.0);
+    double h = params.value("h", 20.0);
+    double kf = params.value("kf", 1e-3);
+
+    // [逻辑对齐]: 长度参数 L 和 Lf
+    // MATLAB 常用 Lf 作为参考长度，但此处保留 L 作为参考长度的逻辑
+    // 如果 L 未设置或异常小，默认使用 1000 (MATLAB代码中的默认值)
+    double L = params.value("L", 1000.0);
+    if (L < 1e-9) L = 1000.0;
+
+    // 防止物理参数除零
+    if (phi < 1e-12 || mu < 1e-12 || Ct < 1e-12 || kf < 1e-12) return scaling;
+
+    // 无因次时间系数 (tD conversion)
+    // 公式: tD = 14.4 * kf * t / (phi * mu * Ct * L^2)
+    // 对应 MATLAB: tD = 14.4*kf*t/(phi*mu*Ct*L^2);
+    scaling.tdCoeff = 14.4 * kf / (phi * mu * Ct * pow(L, 2));
+
+    // 压力换算系数
+    // 公式: dp = 1.842e-3 * q * mu * B / (kf * h) * pD
+    // 对应 MATLAB: Dp = 1.842e-3*q*mu*B*PD/(kf*h);
+    scaling.pCoeff = 1.842e-3 * q * mu * B / (kf * h);
+    scaling.valid = true;
+    return scaling;
+}
+
+// 像函数缓存键模板：参数部分按参数块填写，逐节点仅更新 zr / zi
+static LaplaceEvaluationCache::Key laplaceCacheKey(int modelType, const ModelParams& params, bool complexNode)
+{
+    LaplaceEvaluationCache::Key key;
+    key.modelType = modelType;
+    key.nf = params.xwD.size();
+    key.complexNode = complexNode;
+    key.M12 = params.M12; key.LfD = params.LfD;
+    key.rmD = params.rmD; key.reD = params.reD;
+    key.omega1 = params.omega1; key.omega2 = params.omega2;
+    key.lambda1 = params.lambda1; key.lambda2 = params.lambda2;
+    key.eta12 = params.eta12; key.cD = params.cD; key.S = params.S;
+    key.earlyArgument = params.earlyArgument; key.lateArgument = params.lateArgument;
+    key.quadratureTolerance = params.quadratureTolerance; key.quadratureDepth = params.quadratureDepth;
+    return key;
+}
+
+// 两个参数块的储层响应是否相同 (仅 cD/S/gamaD 不同)，相同时同一 z 的 reservoirKernel 结果可共享
+static bool sharesReservoirResponse(const ModelParams& a, const ModelParams& b)
+{
+    return a.M12 == b.M12 && a.LfD == b.LfD && a.rmD == b.rmD && a.reD == b.reD
+           && a.omega1 == b.omega1 && a.omega2 == b.omega2
+           && a.lambda1 == b.lambda1 && a.lambda2 == b.lambda2
+           && a.eta12 == b.eta12 && a.xwD == b.xwD
+           && a.earlyArgument == b.earlyArgument && a.lateArgument == b.lateArgument
+           && a.quadratureTolerance == b.quadratureTolerance && a.quadratureDepth == b.quadratureDepth;
+}
+
+// [算法对齐] 摄动法考虑压敏 (MATLAB逻辑)
+// PD(i) = -1/gamaD*log(1-gamaD*PD(i));
+static double applyStressSensitivity(double pd, double gamaD)
+{
+    if (std::abs(gamaD) > 1e-9) {
+        double arg = 1.0 - gamaD * pd;
+        if (arg > 1e-12) {
+            return -1.0 / gamaD * std::log(arg);
+        }
+        // 如果参数过大导致 arg <= 0，此处做数值保护
+        // 实际物理上意味着压力下降过大导致闭合
+    }
+    return pd;
+}
+
 // ---------------------- 类实现 ----------------------
 
-ModelSolver01_06::ModelSolver01_06(ModelType type)
-    : m_type(type)
-    , m_highPrecision(true)
+ModelSolver01_06::ModelSolver01_06(ModelType type)
+    : m_type(type)
+    , m_kernels(&kernelTable(type))
+    , m_highPrecision(true)
+    , m_parallelEvaluation(true)
+    , m_useTypeCurveLibrary(false)
+    , m_lastGridError(0.0)
+    , m_lastExtendedPoints(0)
+    , m_lastInterpolationEvaluations(0)
+    , m_lastInterpolationFallback(false)
+{
+    // 从全局设置读取默认的数值反演方法 (未设置时为 Stehfest，与原有行为一致)
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    m_inversionMethod = LaplaceInversion::methodFromValue(settings.value("solver/inversionMethod", 0).toInt());
+    m_inversionOrder = settings.value("solver/inversionOrder", 0).toInt();
+    m_gridPointsPerDecade = std::max(0, settings.value("solver/gridPointsPerDecade", 0).toInt());
+    const ModelParams defaults;
+    m_asymptoticEarly = std::max(0.0, settings.value("solver/asymptoticEarlyArgument", defaults.earlyArgument).toDouble());
+    m_asymptoticLate = std::max(0.0, settings.value("solver/asymptoticLateArgument", defaults.lateArgument).toDouble());
+    m_accuracyControl = settings.value("solver/accuracyControl", false).toBool();
+    m_mixedPrecision = settings.value("solver/mixedPrecision", false).toBool();
+    m_sharedLaplaceNodes = settings.value("solver/sharedLaplaceNodes", false).toBool();
+    m_laplaceInterpolation = settings.value("solver/laplaceInterpolation", false).toBool();
+}
+
+ModelSolver01_06::~ModelSolver01_06()
+{
+}
+
+void ModelSolver01_06::setHighPrecision(bool high)
+{
+    m_highPrecision = high;
+}
+
+void ModelSolver01_06::setInversionMethod(LaplaceInversion::Method method, int order)
+{
+    m_inversionMethod = method;
+    m_inversionOrder = order;
+}
+
+LaplaceInversion::Method ModelSolver01_06::inversionMethod() const
+{
+    return m_inversionMethod;
+}
+
+void ModelSolver01_06::setParallelEvaluation(bool enabled)
+{
+    m_parallelEvaluation = enabled;
+}
+
+bool ModelSolver01_06::isParallelEvaluation() const
+{
+    return m_parallelEvaluation;
+}
+
+void ModelSolver01_06::setTypeCurveLibraryEnabled(bool enabled)
+{
+    m_useTypeCurveLibrary = enabled;
+}
+
+bool ModelSolver01_06::isTypeCurveLibraryEnabled() const
+{
+    return m_useTypeCurveLibrary;
+}
+
+void ModelSolver01_06::setGridEvaluation(int pointsPerDecade)
+{
+    m_gridPointsPerDecade = std::max(0, pointsPerDecade);
+}
+
+int ModelSolver01_06::gridPointsPerDecade() const
+{
+    return m_gridPointsPerDecade;
+}
+
+double ModelSolver01_06::lastGridInterpolationError() const
+{
+    return m_lastGridError;
+}
+
+void ModelSolver01_06::setAsymptoticRegimes(double earlyArgument, double lateArgument)
+{
+    m_asymptoticEarly = std::max(0.0, earlyArgument);
+    m_asymptoticLate = std::max(0.0, lateArgument);
+}
+
+double ModelSolver01_06::asymptoticEarlyArgument() const
+{
+    return m_asymptoticEarly;
+}
+
+double ModelSolver01_06::asymptoticLateArgument() const
+{
+    return m_asymptoticLate;
+}
+
+void ModelSolver01_06::setAccuracyControl(bool enabled)
+{
+    m_accuracyControl = enabled;
+}
+
+bool ModelSolver01_06::isAccuracyControl() const
+{
+    return m_accuracyControl;
+}
+
+double ModelSolver01_06::targetTolerance() const
+{
+    return m_highPrecision ? 1e-5 : 1e-3;
+}
+
+QVector<double> ModelSolver01_06::lastErrorEstimates() const
+{
+    return m_lastErrorEstimates;
+}
+
+void ModelSolver01_06::setMixedPrecision(bool enabled)
+{
+    m_mixedPrecision = enabled;
+}
+
+bool ModelSolver01_06::isMixedPrecision() const
+{
+    return m_mixedPrecision;
+}
+
+int ModelSolver01_06::lastExtendedPrecisionPoints() const
+{
+    return m_lastExtendedPoints;
+}
+
+void ModelSolver01_06::setSharedLaplaceNodes(bool enabled)
+{
+    m_sharedLaplaceNodes = enabled;
+}
+
+bool ModelSolver01_06::isSharedLaplaceNodes() const
+{
+    return m_sharedLaplaceNodes;
+}
+
+void ModelSolver01_06::setLaplaceInterpolation(bool enabled)
+{
+    m_laplaceInterpolation = enabled;
+}
+
+bool ModelSolver01_06::isLaplaceInterpolation() const
+{
+    return m_laplaceInterpolation;
+}
+
+int ModelSolver01_06::lastInterpolationKernelEvaluations() const
+{
+    return m_lastInterpolationEvaluations;
+}
+
+bool ModelSolver01_06::lastInterpolationFellBack() const
+{
+    return m_lastInterpolationFallback;
+}
+
+void ModelSolver01_06::applyAsymptoticRegimes(ModelParams& params) const
+{
+    params.earlyArgument = m_asymptoticEarly;
+    params.lateArgument = m_asymptoticLate;
+}
+
+// 各求值区间的累计调用次数 (全部求解器实例共享，热路径中按 relaxed 原子加一)
+static QAtomicInteger<qint64> s_regimeFull(0);
+static QAtomicInteger<qint64> s_regimeEarly(0);
+static QAtomicInteger<qint64> s_regimeLate(0);
+
+KernelRegimeStatistics ModelSolver01_06::kernelRegimeStatistics()
+{
+    KernelRegimeStatistics stats;
+    stats.full = s_regimeFull.loadRelaxed();
+    stats.early = s_regimeEarly.loadRelaxed();
+    stats.late = s_regimeLate.loadRelaxed();
+    return stats;
+}
+
+void ModelSolver01_06::resetKernelRegimeStatistics()
+{
+    s_regimeFull.storeRelaxed(0);
+    s_regimeEarly.storeRelaxed(0);
+    s_regimeLate.storeRelaxed(0);
+}
+
+// 节点共享模式在未设置网格密度时使用的每个对数周期点数 (二进网格取每倍程 7 点，约合每个对数周期 23 点)
+static const int SHARED_NODES_POINTS_PER_DECADE = 20;
+
+bool ModelSolver01_06::gridEvaluationApplies(const QVector<double>& tPoints, QVector<double>& grid) const
+{
+    // 节点共享模式未设置网格密度时按 SHARED_NODES_POINTS_PER_DECADE 生成网格
+    const int pointsPerDecade = (m_gridPointsPerDecade <= 0 && m_sharedLaplaceNodes)
+                                    ? SHARED_NODES_POINTS_PER_DECADE : m_gridPointsPerDecade;
+    if (pointsPerDecade <= 0) return false;
+    double tMin = std::numeric_limits<double>::infinity(), tMax = 0.0;
+    int positive = 0;
+    for (double t : tPoints) {
+        if (!(t > 0.0)) continue;
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+        ++positive;
+    }
+    if (positive == 0) return false;
+    // 两端各外延两步，网格端点的 Bourdet 导数不落在请求范围内；
+    // 节点共享模式取二进网格，相隔一个倍程的网格点的 Stehfest 节点逐位重合
+    grid = m_sharedLaplaceNodes ? CurveInterpolation::dyadicGrid(tMin, tMax, pointsPerDecade, 2)
+                                : CurveInterpolation::logUniformGrid(tMin, tMax, pointsPerDecade, 2);
+    return grid.size() >= 5 && grid.size() < positive;
+}
+
+ModelCurveData ModelSolver01_06::resampleFromGrid(const ModelCurveData& gridCurve, const QVector<double>& tPoints)
+{
+    const QVector<double>& grid = std::get<0>(gridCurve);
+    const QVector<double>& gridP = std::get<1>(gridCurve);
+    const QVector<double>& gridD = std::get<2>(gridCurve);
+
+    double error = std::max(CurveInterpolation::estimateRelativeError(grid, gridP),
+                            CurveInterpolation::estimateRelativeError(grid, gridD));
+    m_lastGridError = std::max(m_lastGridError, error);
+    return std::make_tuple(tPoints, CurveInterpolation::interpolateLogLog(grid, gridP, tPoints),
+                           CurveInterpolation::interpolateLogLog(grid, gridD, tPoints));
+}
+
+ModelSolver01_06::ScopedSerialEvaluation::ScopedSerialEvaluation()
+    : m_previous(t_forceSerialEvaluation)
+{
+    t_forceSerialEvaluation = true;
+}
+
+ModelSolver01_06::ScopedSerialEvaluation::~ScopedSerialEvaluation()
+{
+    t_forceSerialEvaluation = m_previous;
+}
+
+bool ModelSolver01_06::ScopedSerialEvaluation::isActive()
+{
+    return t_forceSerialEvaluation;
+}
+
+QString ModelSolver01_06::getModelName(ModelType type)
+{
+    switch(type) {
+    case Model_1: return "模型1: 变井储+无限大边界";
+    case Model_2: return "模型2: 恒定井储+无限大边界";
+    case Model_3: return "模型3: 变井储+封闭边界";
+    case Model_4: return "模型4: 恒定井储+封闭边界";
+    case Model_5: return "模型5: 变井储+定压边界";
+    case Model_6: return "模型6: 恒定井储+定压边界";
+    default: return "未知模型";
+    }
+}
+
+QVector<double> ModelSolver01_06::generateLogTimeSteps(int count, double startExp, double endExp)
+{
+    QVector<double> t;
+    if (count <= 0) return t;
+    t.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        double exponent = startExp + (endExp - startExp) * i / (count - 1);
+        t.append(pow(10.0, exponent));
+    }
+    return t;
+}
+
+ModelCurveData ModelSolver01_06::calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime)
+{
+    WT_TRACE_SCOPE("ModelSolver::calculateTheoreticalCurve");
+    WT_MEMORY_SCOPE(MemoryAccounting::Solver);
+    QVector<double> tPoints = providedTime;
+    if (tPoints.isEmpty()) {
+        tPoints = generateLogTimeSteps(100, -3.0, 3.0); // 默认生成 1e-3 到 1e3
+    }
+
+    QVector<double> grid;
+    m_lastGridError = 0.0;
+    if (!gridEvaluationApplies(tPoints, grid)) return calculateCurveDirect(params, tPoints);
+    return resampleFromGrid(calculateCurveDirect(params, grid), tPoints);
+}
+
+ModelCurveData ModelSolver01_06::calculateCurveDirect(const QMap<QString, double>& params, const QVector<double>& tPoints)
+{
+    // --- 1. 参数提取与有因次换算系数 ---
+    CurveScaling scaling = resolveCurveScaling(params);
+    if (!scaling.valid) {
+        return std::make_tuple(tPoints, QVector<double>(tPoints.size(), 0.0), QVector<double>(tPoints.size(), 0.0));
+    }
+
+    // --- 2. 计算无因次时间 ---
+    QVector<double> tD_vec;
+    tD_vec.reserve(tPoints.size());
+    for(double t : tPoints) {
+        tD_vec.append(scaling.tdCoeff * t);
+    }
+
+    // --- 3. 计算无因次压力和导数 ---
+    // 一次性将参数字典解析为强类型参数块，热路径中不再进行字符串查找
+    ModelParams modelParams = resolveParams(params);
+    applyAsymptoticRegimes(modelParams);
+
+    // 类型曲线库覆盖查询点时直接插值，否则数值反演
+    QVector<double> PD_vec, Deriv_vec;
+    if (!m_useTypeCurveLibrary || !interpolateFromLibrary(tD_vec, modelParams, PD_vec, Deriv_vec)) {
+        calculatePDandDeriv(tD_vec, modelParams, PD_vec, Deriv_vec);
+    }
+
+    // --- 4. 转换为有因次物理量 ---
+    double p_coeff = scaling.pCoeff;
+
+    QVector<double> finalP(tPoints.size()), finalDP(tPoints.size());
+    for(int i=0; i<tPoints.size(); ++i) {
+        finalP[i] = p_coeff * PD_vec[i];
+        finalDP[i] = p_coeff * Deriv_vec[i];
+    }
+
+    return std::make_tuple(tPoints, finalP, finalDP);
+}
+
+void ModelSolver01_06::setDefaultFractureSegments(int nf)
+{
+    s_defaultFractureSegments.storeRelaxed(qBound(4, nf, 256));
+}
+
+int ModelSolver01_06::defaultFractureSegments()
+{
+    return s_defaultFractureSegments.loadRelaxed();
+}
+
+ModelParams ModelSolver01_06::resolveParams(const QMap<QString, double>& p)
+{
+    // 1. 参数读取 (需与 MATLAB x 向量对齐)
+    // MATLAB x = [kf, M12, L, Lf, rm, omga1, omga2, remda1, remda2, re]
+    ModelParams mp;
+
+    // M12: 流度比 (MATLAB直接输入 M12)。如果 params 中有 M12，优先使用；否则用 kf/km
+    if (p.contains("M12")) {
+        mp.M12 = p.value("M12");
+    } else {
+        double kf = p.value("kf", 1.0);
+        double km = p.value("km", 0.01);
+        if(km < 1e-12) km = 1e-12;
+        mp.M12 = kf / km;
+    }
+
+    double L = p.value("L", 1000.0);
+    double Lf = p.value("Lf", 100.0);
+    double rm = p.value("rm", 500.0);
+    double re = p.value("re", 20000.0);
+
+    // 无因次几何参数
+    // LfD = Lf/L; rmD = rm/L; reD = re/L;
+    mp.LfD = (L > 1e-9) ? Lf / L : 0.1;
+    mp.rmD = (L > 1e-9) ? rm / L : 0.5;
+    mp.reD = (L > 1e-9) ? re / L : 20.0;
+
+    // 双重介质参数
+    mp.omega1 = p.value("omega1", 0.4);   // 内区储容比
+    mp.omega2 = p.value("omega2", 0.08);  // 外区储容比
+
+    // 窜流系数 (注意参数名兼容性)
+    // MATLAB: remda1, remda2
+    mp.lambda1 = p.contains("lambda1") ? p.value("lambda1") : p.value("remda1", 1e-3);
+    mp.lambda2 = p.contains("lambda2") ? p.value("lambda2") : p.value("remda2", 1e-4);
+
+    // 导压系数比 eta12 (MATLAB 代码中硬编码为 0.2，此处支持参数输入)
+    mp.eta12 = p.value("eta", 0.2);
+    if (p.contains("eta12")) mp.eta12 = p.value("eta12");
+
+    // 井储与表皮 (仅 Model 1/3/5 使用)，注意：这里直接用 cD，如果是 C 需在调用前转换
+    mp.cD = p.value("cD", 0.0);
+    mp.S = p.value("S", 0.0);
+
+    // 压敏参数 gamaD (MATLAB 代码中为 0.02)
+    mp.gamaD = p.value("gamaD", 0.0);
+
+    // [修正] Stehfest N 值控制
+    // MATLAB代码中 N=4，但为了保证曲线光滑度，QT中默认推荐 10
+    // 如果参数中未指定 N，则设为 10；上限 18 防止溢出，且必须为偶数
+    int N = (!p.contains("N") || p.value("N") < 4) ? 10 : (int)p.value("N");
+    if (N > 18) N = 18;
+    if (N % 2 != 0) N = 10;
+    mp.N = N;
+
+    // 数值反演方法 (可选)："inversion" = 0 Stehfest / 1 Talbot / 2 de Hoog / 3 Euler
+    // 未指定时使用求解器默认方法；"inversionOrder" 为非 Stehfest 方法的阶数 M
+    mp.inversion = p.contains("inversion") ? (int)LaplaceInversion::methodFromValue(p.value("inversion")) : -1;
+    mp.inversionOrder = (int)p.value("inversionOrder", 0.0);
+
+    // [修正] 裂缝离散段数 nf
+    // MATLAB代码中 nf=4，此处默认设为 10 提高积分精度 (可由性能设置调整)
+    int nf = (!p.contains("nf") || p.value("nf") < 4) ? defaultFractureSegments() : (int)p.value("nf");
+    mp.nf = nf;
+
+    // 2. 构造裂缝节点 xwD
+    // MATLAB: xwD = linspace(-0.9, 0.9, nf);
+    mp.xwD.reserve(nf);
+    if (nf == 1) {
+        mp.xwD.append(0.0);
+    } else {
+        double start = -0.9; // 与 MATLAB 保持一致 (-0.9 到 0.9)
+        double end = 0.9;
+        double step = (end - start) / (nf - 1);
+        for(int i=0; i<nf; ++i) mp.xwD.append(start + i * step);
+    }
+
+    return mp;
+}
+
+// 精度控制模式的求值阶段：在给定方法与裂缝积分级别下，阶数从 first 起按 step 递增至 last，
+// 相邻两级结果之差为误差估计 (Stehfest 相邻阶数的节点 i·ln2/t 互相嵌套，提高一级只需补算两个节点)。
+// 某一阶段提高阶数不再减小差值时进入下一阶段：Stehfest 之后改用条件数更好的 Talbot，再逐级收紧积分容差
+struct AccuracyStage {
+    LaplaceInversion::Method method;
+    int quadratureLevel; // 积分级别 q：容差为基准值的 1e-2^q 倍，最大二分深度加 2q
+    int first;
+    int step;
+    int last;
+};
+
+static const int QuadratureLevels = 3;
+
+// 混合精度模式：基准积分容差下像函数的典型相对精度 (误差估计 = 舍入放大系数 × 该值)，
+// 以及扩展精度时间点的积分容差缩放与附加二分深度
+static const double MIXED_PRECISION_KERNEL_EPSILON = 1e-11;
+static const double MIXED_PRECISION_TOLERANCE_SCALE = 1e-4;
+static const int MIXED_PRECISION_EXTRA_DEPTH = 4;
+
+// 像函数插值模式：插值相对误差上限 = 目标误差 × 缩放 (抵消 Stehfest 系数的放大)，且不低于像函数本身的典型精度
+static const double LAPLACE_INTERPOLATION_TOLERANCE_SCALE = 1e-6;
+static const double LAPLACE_INTERPOLATION_MIN_TOLERANCE = MIXED_PRECISION_KERNEL_EPSILON;
+
+static QVector<AccuracyStage> accuracyStages(LaplaceInversion::Method method)
+{
+    QVector<AccuracyStage> stages;
+    auto appendLevels = [&](LaplaceInversion::Method m, int first, int step, int last) {
+        for (int q = 0; q < QuadratureLevels; ++q) stages.append({ m, q, first, step, last });
+    };
+    switch (method) {
+    case LaplaceInversion::DeHoog: appendLevels(method, 4, 2, 16); break;
+    case LaplaceInversion::Euler:  appendLevels(method, 6, 2, 20); break;
+    case LaplaceInversion::Talbot: appendLevels(method, 8, 4, 32); break;
+    case LaplaceInversion::Stehfest:
+    default:
+        // N > 16 时双精度下系数相消，误差反而增大，因此只在基准积分级别上尝试
+        stages.append({ LaplaceInversion::Stehfest, 0, 6, 2, 16 });
+        appendLevels(LaplaceInversion::Talbot, 8, 4, 32);
+        break;
+    }
+    return stages;
+}
+
+void ModelSolver01_06::calculatePDandDeriv(const QVector<double>& tD, const ModelParams& params,
+                                           QVector<double>& outPD, QVector<double>& outDeriv)
+{
+    WT_TRACE_SCOPE("ModelSolver::calculatePDandDeriv");
+    WT_MEMORY_SCOPE(MemoryAccounting::Solver);
+    int numPoints = tD.size();
+    outPD.resize(numPoints);
+    outDeriv.resize(numPoints);
+
+    const LaplaceInversion* engine = inversionEngine(params);
+    const int nodeCount = engine->nodeCount();
+    const bool complexNodes = engine->requiresComplexNodes();
+
+    // 压敏参数 gamaD (MATLAB 代码中为 0.02)
+    double gamaD = params.gamaD;
+
+    // 调用线程登记的取消令牌：各时间点 (含线程池中的) 逐节点检查，取消后的结果无效且不写入缓存
+    const CancellationToken* token = CancellationToken::current();
+    if (token && token->isCancelled()) {
+        outPD.fill(0.0);
+        outDeriv.fill(0.0);
+        return;
+    }
+
+    // 像函数缓存键模板：参数部分每次调用只填写一次，逐节点仅更新 z
+    LaplaceEvaluationCache& cache = LaplaceEvaluationCache::instance();
+    const bool useCache = cache.isEnabled();
+    const LaplaceEvaluationCache::Key baseKey = laplaceCacheKey((int)m_type, params, complexNodes);
+
+    // 单个时间点的反演计算：各时间点互相独立，只写入自身下标，可安全并行
+    // 预先取得裸指针，避免多线程下 QVector 的隐式共享检查
+    double* pd = outPD.data();
+
+    // 精度控制模式：逐级提高阶数，必要时更换为复数节点方法并收紧积分容差，直到相邻两级之差低于目标误差
+    m_lastErrorEstimates.clear();
+    m_lastExtendedPoints = 0;
+    m_lastInterpolationEvaluations = 0;
+    m_lastInterpolationFallback = false;
+    if (m_accuracyControl) {
+        const QVector<AccuracyStage> stages = accuracyStages(engine->method());
+        const double tolerance = targetTolerance();
+        // 低精度 (拟合迭代) 只使用前两个阶段，保证单点代价有界
+        const int stageCount = m_highPrecision ? stages.size() : std::min(2, int(stages.size()));
+        QVector<ModelParams> levelParams(QuadratureLevels, params);
+        QVector<LaplaceEvaluationCache::Key> levelKeys[2]; // [实数节点 / 复数节点][积分级别]
+        for (int c = 0; c < 2; ++c) levelKeys[c].resize(QuadratureLevels);
+        for (int q = 0; q < QuadratureLevels; ++q) {
+            for (int r = 0; r < q; ++r) levelParams[q].quadratureTolerance *= 1e-2;
+            levelParams[q].quadratureDepth += 2 * q;
+            for (int c = 0; c < 2; ++c) levelKeys[c][q] = laplaceCacheKey((int)m_type, levelParams[q], c == 1);
+        }
+        m_lastErrorEstimates.fill(0.0, numPoints);
+        double* errors = m_lastErrorEstimates.data();
+
+        auto evaluateAdaptive = [&](int k) {
+            double t = tD[k];
+            if (t <= 1e-10) { pd[k] = 0.0; return; }
+
+            // 同一时间点、同一阶段内已求过的节点 (Stehfest 嵌套节点直接复用)
+            QVector<cplx> knownNodes, knownValues;
+            QVector<cplx> nodes, values;
+            auto invertAt = [&](const AccuracyStage& stage, int order) -> double {
+                const LaplaceInversion* e = LaplaceInversion::engine(stage.method, order);
+                const bool complexStage = e->requiresComplexNodes();
+                const ModelParams& mp = levelParams[stage.quadratureLevel];
+                const int n = e->nodeCount();
+                nodes.resize(n);
+                values.resize(n);
+                e->laplaceNodes(t, nodes.data());
+                LaplaceEvaluationCache::Key key = levelKeys[complexStage ? 1 : 0][stage.quadratureLevel];
+                for (int m = 0; m < n; ++m) {
+                    if (token && token->isCancelled()) return 0.0;
+                    const int known = knownNodes.indexOf(nodes[m]);
+                    if (known >= 0) { values[m] = knownValues[known]; continue; }
+                    bool cached = false;
+                    if (useCache) {
+                        key.zr = nodes[m].real();
+                        key.zi = nodes[m].imag();
+                        cached = cache.lookup(key, values[m]);
+                    }
+                    if (!cached) {
+                        values[m] = complexStage ? flaplace_composite<cplx>(nodes[m], mp)
+                                                 : cplx(flaplace_composite<double>(nodes[m].real(), mp));
+                        if (!isFiniteValue(values[m])) values[m] = 0.0;
+                        if (useCache) cache.insert(key, values[m]);
+                    }
+                    knownNodes.append(nodes[m]);
+                    knownValues.append(values[m]);
+                }
+                double f = e->invert(t, values.constData());
+                return isFiniteValue(f) ? f : 0.0;
+            };
+
+            double bestValue = 0.0;
+            double bestError = std::numeric_limits<double>::infinity();
+            for (int st = 0; st < stageCount; ++st) {
+                if (token && token->isCancelled()) break;
+                const AccuracyStage& stage = stages[st];
+                const double stageStartError = bestError;
+                knownNodes.clear();
+                knownValues.clear();
+                double previous = invertAt(stage, stage.first);
+                double previousDiff = std::numeric_limits<double>::infinity();
+                bool converged = false;
+                for (int order = stage.first + stage.step; order <= stage.last; order += stage.step) {
+                    const double current = invertAt(stage, order);
+                    const double diff = std::abs(current - previous);
+                    const double relError = diff / std::max(std::abs(current), 1e-300);
+                    if (relError < bestError) { bestError = relError; bestValue = current; }
+                    if (relError <= tolerance) { converged = true; break; }
+                    if (diff >= previousDiff) break; // 提高阶数不再改善：像函数精度成为瓶颈
+                    previousDiff = diff;
+                    previous = current;
+                }
+                if (converged) break;
+                // 整个阶段未能把误差估计降低一个数量级：该点受像函数本身的病态限制，不再继续升级
+                if (st > 0 && bestError > 0.1 * stageStartError) break;
+            }
+            pd[k] = applyStressSensitivity(bestValue, gamaD);
+            errors[k] = bestError;
+        };
+
+        if (m_parallelEvaluation && !t_forceSerialEvaluation && numPoints > 1) {
+            TaskScheduler::parallelFor(numPoints, evaluateAdaptive);
+        } else {
+            for (int k = 0; k < numPoints; ++k) evaluateAdaptive(k);
+        }
+        if (numPoints > 2) {
+            outDeriv = PressureDerivativeCalculator::calculateBourdetDerivative(tD, outPD, 0.1);
+        } else {
+            outDeriv.fill(0.0);
+        }
+        return;
+    }
+
+    // 混合精度模式：只对 Stehfest 生效，舍入放大后的误差估计超过目标误差的时间点以收紧的积分容差与双双精度求和重算
+    const StehfestInversion* stehfest = (m_mixedPrecision && engine->method() == LaplaceInversion::Stehfest)
+                                            ? static_cast<const StehfestInversion*>(engine) : nullptr;
+    const double mixedTolerance = targetTolerance();
+    ModelParams refinedParams = params;
+    refinedParams.quadratureTolerance *= MIXED_PRECISION_TOLERANCE_SCALE;
+    refinedParams.quadratureDepth += MIXED_PRECISION_EXTRA_DEPTH;
+    const LaplaceEvaluationCache::Key refinedKey = laplaceCacheKey((int)m_type, refinedParams, false);
+    QAtomicInt extendedPoints(0);
+
+    // 实数节点：逐个查缓存，未命中的节点一次交给批量像函数 (flaplaceCompositeBatch，与逐点调用逐位一致) 后写回缓存；
+    // 已取消时返回 false 且不写入缓存
+    auto evaluateRealNodes = [&](const double* z, cplx* values, int n, const ModelParams& mp,
+                                 LaplaceEvaluationCache::Key key) -> bool {
+        QVector<double> missZ, missValues;
+        QVector<int> missIndex;
+        for (int m = 0; m < n; ++m) {
+            if (useCache) {
+                key.zr = z[m];
+                key.zi = 0.0;
+                if (cache.lookup(key, values[m])) continue;
+            }
+            missZ.append(z[m]);
+            missIndex.append(m);
+        }
+        if (missZ.isEmpty()) return true;
+        if (token && token->isCancelled()) return false;
+        missValues.resize(missZ.size());
+        flaplaceCompositeBatch(missZ.constData(), missValues.data(), missZ.size(), mp);
+        for (int i = 0; i < missZ.size(); ++i) {
+            double pf = missValues[i];
+            if (!isFiniteValue(pf)) pf = 0.0;
+            values[missIndex[i]] = pf;
+            if (useCache) {
+                key.zr = missZ[i];
+                key.zi = 0.0;
+                cache.insert(key, values[missIndex[i]]);
+            }
+        }
+        return true;
+    };
+
+    // 像函数插值模式：在全部时间点节点覆盖的区间上建表，成功后基准参数下的实数节点值均由插值给出
+    const bool parallel = m_parallelEvaluation && !t_forceSerialEvaluation;
+    LaplaceInterpolant interpolant;
+    if (m_laplaceInterpolation && !complexNodes) {
+        double zMin = std::numeric_limits<double>::infinity();
+        double zMax = 0.0;
+        QVector<cplx> nodes(nodeCount);
+        for (int k = 0; k < numPoints; ++k) {
+            if (tD[k] <= 1e-10) continue;
+            engine->laplaceNodes(tD[k], nodes.data());
+            for (int m = 0; m < nodeCount; ++m) {
+                zMin = std::min(zMin, nodes[m].real());
+                zMax = std::max(zMax, nodes[m].real());
+            }
+        }
+        const double tolerance = std::max(LAPLACE_INTERPOLATION_MIN_TOLERANCE,
+                                          targetTolerance() * LAPLACE_INTERPOLATION_TOLERANCE_SCALE);
+        auto kernel = [&](const double* z, double* out, int n) -> bool {
+            if (token && token->isCancelled()) return false;
+            flaplaceCompositeBatch(z, out, n, params);
+            return true;
+        };
+        if (zMax > 0.0 && !interpolant.build(zMin, zMax, kernel, tolerance, parallel)) {
+            if (token && token->isCancelled()) {
+                outPD.fill(0.0);
+                outDeriv.fill(0.0);
+                return;
+            }
+            m_lastInterpolationFallback = true;
+        }
+        m_lastInterpolationEvaluations = interpolant.kernelEvaluations();
+    }
+    auto fillRealNodes = [&](const double* z, cplx* values, int n) -> bool {
+        if (!interpolant.isValid()) return evaluateRealNodes(z, values, n, params, baseKey);
+        for (int m = 0; m < n; ++m) values[m] = interpolant.evaluate(z[m]);
+        return true;
+    };
+
+    // 混合精度：舍入放大后的误差估计超限时，在同一组节点上以收紧的积分容差重算像函数
+    // (结果按收紧后的参数单独缓存)，再以双双精度求和
+    auto refineExtended = [&](int k, double t, const cplx* nodes, cplx* values) {
+        if (!stehfest || stehfest->amplification(values) * MIXED_PRECISION_KERNEL_EPSILON <= mixedTolerance) return;
+        QVector<double> z(nodeCount);
+        for (int m = 0; m < nodeCount; ++m) z[m] = nodes[m].real();
+        if (!evaluateRealNodes(z.constData(), values, nodeCount, refinedParams, refinedKey)) { pd[k] = 0.0; return; }
+        pd[k] = stehfest->invertExtended(t, values);
+        extendedPoints.fetchAndAddRelaxed(1);
+    };
+
+    auto evaluatePoint = [&](int k) {
+        double t = tD[k];
+        if (t <= 1e-10) { pd[k] = 0.0; return; }
+
+        // 生成 Laplace 节点并求像函数值：实数节点整组批量求值，复数节点逐个求值
+        QVector<cplx> nodes(nodeCount), values(nodeCount);
+        engine->laplaceNodes(t, nodes.data());
+        if (!complexNodes) {
+            QVector<double> z(nodeCount);
+            for (int m = 0; m < nodeCount; ++m) z[m] = nodes[m].real();
+            if (!fillRealNodes(z.constData(), values.data(), nodeCount)) { pd[k] = 0.0; return; }
+        } else {
+            LaplaceEvaluationCache::Key key = baseKey;
+            for (int m = 0; m < nodeCount; ++m) {
+                if (token && token->isCancelled()) { pd[k] = 0.0; return; }
+                if (useCache) {
+                    key.zr = nodes[m].real();
+                    key.zi = nodes[m].imag();
+                    if (cache.lookup(key, values[m])) continue;
+                }
+                cplx pf = flaplace_composite<cplx>(nodes[m], params); // 复数节点
+                if (!isFiniteValue(pf)) pf = 0.0;
+                values[m] = pf;
+                if (useCache) cache.insert(key, values[m]);
+            }
+        }
+        pd[k] = engine->invert(t, values.constData());
+        refineExtended(k, t, nodes.constData(), values.data());
+        if (!isFiniteValue(pd[k])) pd[k] = 0.0;
+        pd[k] = applyStressSensitivity(pd[k], gamaD);
+    };
+
+    // 并行模式：时间点经任务调度器并行，输出按下标写回，结果与串行完全一致
+    // 串行模式：调用方已处于并行任务中 (ScopedSerialEvaluation) 或主动关闭并行时使用
+    if (m_sharedLaplaceNodes && engine->method() == LaplaceInversion::Stehfest) {
+        // 节点共享模式：汇总全部时间点的 Stehfest 节点 m·ln2/t 并按位去重 (二进网格上 t 加倍时偶数 m 的节点与前一倍程重合)，
+        // 每个不同的 z 只求一次像函数，再按下标取回各时间点的节点值逐点反演；反演结果与逐点求值逐位相同
+        QVector<int> nodeIndex(numPoints * nodeCount, -1);
+        QVector<double> uniqueNodes;
+        QHash<quint64, int> nodeLookup;
+        QVector<cplx> nodes(nodeCount);
+        for (int k = 0; k < numPoints; ++k) {
+            if (tD[k] <= 1e-10) continue;
+            engine->laplaceNodes(tD[k], nodes.data());
+            for (int m = 0; m < nodeCount; ++m) {
+                const double z = nodes[m].real();
+                quint64 bits;
+                std::memcpy(&bits, &z, sizeof(bits));
+                auto it = nodeLookup.constFind(bits);
+                if (it == nodeLookup.constEnd()) {
+                    it = nodeLookup.insert(bits, uniqueNodes.size());
+                    uniqueNodes.append(z);
+                }
+                nodeIndex[k * nodeCount + m] = it.value();
+            }
+        }
+
+        const int uniqueCount = uniqueNodes.size();
+        const double* z = uniqueNodes.constData();
+        const int* index = nodeIndex.constData();
+        QVector<cplx> uniqueValues(uniqueCount);
+        cplx* shared = uniqueValues.data();
+        // 不同节点按每组 nodeCount 个分块批量求值 (与逐点模式的任务粒度相同)
+        const int chunkCount = (uniqueCount + nodeCount - 1) / nodeCount;
+        auto evaluateChunk = [&](int c) {
+            const int begin = c * nodeCount;
+            fillRealNodes(z + begin, shared + begin, std::min(nodeCount, uniqueCount - begin));
+        };
+        auto invertPoint = [&](int k) {
+            double t = tD[k];
+            if (t <= 1e-10 || (token && token->isCancelled())) { pd[k] = 0.0; return; }
+            QVector<cplx> pointNodes(nodeCount), values(nodeCount);
+            for (int m = 0; m < nodeCount; ++m) {
+                const int i = index[k * nodeCount + m];
+                pointNodes[m] = z[i];
+                values[m] = shared[i];
+            }
+            pd[k] = engine->invert(t, values.constData());
+            refineExtended(k, t, pointNodes.constData(), values.data());
+            if (!isFiniteValue(pd[k])) pd[k] = 0.0;
+            pd[k] = applyStressSensitivity(pd[k], gamaD);
+        };
+
+        if (parallel && chunkCount > 1) {
+            TaskScheduler::parallelFor(chunkCount, evaluateChunk);
+        } else {
+            for (int c = 0; c < chunkCount; ++c) evaluateChunk(c);
+        }
+        if (parallel && numPoints > 1) {
+            TaskScheduler::parallelFor(numPoints, invertPoint);
+        } else {
+            for (int k = 0; k < numPoints; ++k) invertPoint(k);
+        }
+    } else if (parallel && numPoints > 1) {
+        TaskScheduler::parallelFor(numPoints, evaluatePoint);
+    } else {
+        for (int k = 0; k < numPoints; ++k) evaluatePoint(k);
+    }
+    m_lastExtendedPoints = extendedPoints.loadRelaxed();
+
+    // 计算导数 (Bourdet导数)
+    if (numPoints > 2) {
+        outDeriv = PressureDerivativeCalculator::calculateBourdetDerivative(tD, outPD, 0.1);
+    } else {
+        outDeriv.fill(0.0);
+    }
+}
+
+QVector<ModelCurveData> ModelSolver01_06::calculateTheoreticalCurvesBatch(const QVector<QMap<QString, double>>& paramSets,
+                                                                          const QVector<double>& providedTime)
 {
+    WT_TRACE_SCOPE("ModelSolver::calculateTheoreticalCurvesBatch");
+    WT_MEMORY_SCOPE(MemoryAccounting::Solver);
+    QVector<double> tPoints = providedTime;
+    if (tPoints.isEmpty()) {
+        tPoints = generateLogTimeSteps(100, -3.0, 3.0); // 与 calculateTheoreticalCurve 的默认时间序列一致
+    }
+
+    QVector<double> grid;
+    m_lastGridError = 0.0;
+    if (!gridEvaluationApplies(tPoints, grid)) return calculateCurvesBatchDirect(paramSets, tPoints);
+    QVector<ModelCurveData> results = calculateCurvesBatchDirect(paramSets, grid);
+    for (ModelCurveData& curve : results) curve = resampleFromGrid(curve, tPoints);
+    return results;
 }
 
-ModelSolver01_06::~ModelSolver01_06()
+QVector<ModelCurveData> ModelSolver01_06::calculateCurvesBatchDirect(const QVector<QMap<QString, double>>& paramSets,
+                                                                    const QVector<double>& tPoints)
 {
+    const int numSets = paramSets.size();
+    const int numPoints = tPoints.size();
+    QVector<ModelCurveData> results(numSets);
+    if (numSets == 0) return results;
+
+    // 精度控制、混合精度、节点共享与像函数插值只在单曲线路径 (calculatePDandDeriv) 中实现：开启任一模式时逐条计算，
+    // 保证敏感性曲线、初值候选与变产量叠加的结果与单曲线结果可比 (拟合中候选误差与当前误差直接比较)
+    if (m_accuracyControl || m_mixedPrecision || m_sharedLaplaceNodes || m_laplaceInterpolation) {
+        for (int s = 0; s < numSets; ++s) results[s] = calculateCurveDirect(paramSets[s], tPoints);
+        return results;
+    }
+
+    // --- 1. 逐组解析参数，并按储层响应分组 ---
+    // 同组成员的无因次时间、反演引擎及 cD/S 以外的核函数参数完全相同，
+    // 因而 Laplace 节点与储层响应 (Bessel/积分/加边方程组) 只需计算一次
+    struct BatchCurve {
+        CurveScaling scaling;
+        ModelParams params;
+        int group = -1;              // -1 且 scaling 有效时表示已由类型曲线库插值得到
+        QVector<double> PD, deriv;   // 类型曲线库插值结果
+    };
+    struct BatchGroup {
+        int leader = -1;                     // 提供储层参数与无因次时间的成员
+        const LaplaceInversion* engine = nullptr;
+        QVector<double> tD;                  // 无因次时间
+        QVector<cplx> nodes;                 // 各时间点的 Laplace 节点 (numPoints × nodeCount)
+        QVector<int> members;                // 共享储层响应的参数组下标
+    };
+
+    QVector<BatchCurve> curves(numSets);
+    QVector<BatchGroup> groups;
+    for (int s = 0; s < numSets; ++s) {
+        BatchCurve& c = curves[s];
+        c.scaling = resolveCurveScaling(paramSets[s]);
+        if (!c.scaling.valid) continue;
+        c.params = resolveParams(paramSets[s]);
+        applyAsymptoticRegimes(c.params);
+        if (m_useTypeCurveLibrary) {
+            QVector<double> tD;
+            tD.reserve(numPoints);
+            for (double t : tPoints) tD.append(c.scaling.tdCoeff * t);
+            if (interpolateFromLibrary(tD, c.params, c.PD, c.deriv)) continue;
+        }
+        const LaplaceInversion* engine = inversionEngine(c.params);
+
+        for (int g = 0; g < groups.size(); ++g) {
+            const BatchCurve& leader = curves[groups[g].leader];
+            if (groups[g].engine == engine && leader.scaling.tdCoeff == c.scaling.tdCoeff
+                && sharesReservoirResponse(leader.params, c.params)) {
+                c.group = g;
+                break;
+            }
+        }
+        if (c.group < 0) {
+            BatchGroup group;
+            group.leader = s;
+            group.engine = engine;
+            group.tD.reserve(numPoints);
+            for (double t : tPoints) group.tD.append(c.scaling.tdCoeff * t);
+            group.nodes.resize(numPoints * engine->nodeCount());
+            for (int k = 0; k < numPoints; ++k) {
+                if (group.tD[k] > 1e-10) engine->laplaceNodes(group.tD[k], group.nodes.data() + k * engine->nodeCount());
+            }
+            groups.append(group);
+            c.group = groups.size() - 1;
+        }
+        groups[c.group].members.append(s);
+    }
+
+    // --- 2. 像函数求值：全部 (分组, 时间点, 反演节点) 合并为一次并行调度 ---
+    // 每个工作项只写入各成员自身的像函数槽位，输出与调度顺序无关
+    struct BatchItem {
+        int group;
+        int slot;         // 时间点 k 与节点 m 的合并下标 k * nodeCount + m
+        int offload = -1; // 设备批次中的下标 (-1 表示不参与卸载)
+    };
+    QVector<BatchItem> items;
+    QVector<QVector<cplx>> values(numSets);
+    for (int g = 0; g < groups.size(); ++g) {
+        const int nodeCount = groups[g].engine->nodeCount();
+        for (int s : groups[g].members) values[s].resize(numPoints * nodeCount);
+        for (int k = 0; k < numPoints; ++k) {
+            if (groups[g].tD[k] <= 1e-10) continue;
+            for (int m = 0; m < nodeCount; ++m) items.append({ g, k * nodeCount + m });
+        }
+    }
+
+    // 实数节点的储层响应整批交给设备后端 (未启用或回退时 offloaded 为空，按 CPU 路径逐项计算)
+    QVector<double> offloaded;
+    if (LaplaceBatchBackend::activeBackend() != "cpu" && items.size() >= LaplaceBatchBackend::MinimumOffloadItems) {
+        LaplaceBatchRequest request;
+        request.type = m_type;
+        QVector<int> groupParams(groups.size(), -1);
+        for (BatchItem& item : items) {
+            const BatchGroup& group = groups[item.group];
+            if (group.engine->requiresComplexNodes()) continue;
+            int& index = groupParams[item.group];
+            if (index < 0) {
+                index = request.params.size();
+                request.params.append(curves[group.leader].params);
+            }
+            item.offload = request.size();
+            request.paramIndex.append(index);
+            request.z.append(group.nodes[item.slot].real());
+        }
+        if (!LaplaceBatchBackend::offloadReservoir(request, offloaded)) offloaded.clear();
+    }
+    const double* offloadedPtr = offloaded.isEmpty() ? nullptr : offloaded.constData();
+
+    // 预先取得裸指针，避免多线程下 QVector 的隐式共享检查
+    QVector<cplx*> valuePtr(numSets, nullptr);
+    for (int s = 0; s < numSets; ++s) {
+        if (!values[s].isEmpty()) valuePtr[s] = values[s].data();
+    }
+
+    LaplaceEvaluationCache& cache = LaplaceEvaluationCache::instance();
+    const bool useCache = cache.isEnabled();
+    const CancellationToken* token = CancellationToken::current();
+    auto evaluateItem = [&](const BatchItem& item) {
+        if (token && token->isCancelled()) return;
+        const BatchGroup& group = groups[item.group];
+        const bool complexNodes = group.engine->requiresComplexNodes();
+        const cplx z = group.nodes[item.slot];
+        const ModelParams& reservoirParams = curves[group.leader].params;
+
+        // 设备已算出储层响应时不写缓存，缓存中保持 CPU 参考值
+        const bool precomputed = offloadedPtr && item.offload >= 0;
+        bool reservoirReady = precomputed;
+        cplx reservoir = precomputed ? cplx(offloadedPtr[item.offload]) : cplx(0.0);
+        for (int s : group.members) {
+            cplx& out = valuePtr[s][item.slot];
+            LaplaceEvaluationCache::Key key;
+            if (useCache) {
+                key = laplaceCacheKey((int)m_type, curves[s].params, complexNodes);
+                key.zr = z.real();
+                key.zi = z.imag();
+                if (cache.lookup(key, out)) continue;
+            }
+            // 储层响应在成员之间复用，仅井储表皮按各自的 cD/S 叠加
+            if (!reservoirReady) {
+                if (complexNodes) reservoir = reservoirKernel<cplx>(z, reservoirParams);
+                else reservoir = reservoirKernel<double>(z.real(), reservoirParams);
+                reservoirReady = true;
+            }
+            if (complexNodes) {
+                cplx pf = applyWellboreStorage<cplx>(z, reservoir, curves[s].params);
+                if (!isFiniteValue(pf)) pf = 0.0;
+                out = pf;
+            } else {
+                double pf = applyWellboreStorage<double>(z.real(), reservoir.real(), curves[s].params);
+                if (!isFiniteValue(pf)) pf = 0.0;
+                out = pf;
+            }
+            if (useCache && !precomputed) cache.insert(key, out);
+        }
+    };
+
+    if (m_parallelEvaluation && !t_forceSerialEvaluation && items.size() > 1) {
+        TaskScheduler::parallelFor(items.size(), [&](int i) { evaluateItem(items.at(i)); });
+    } else {
+        for (const BatchItem& item : items) evaluateItem(item);
+    }
+
+    // --- 3. 逐组反演、压敏摄动、Bourdet 导数与有因次换算 ---
+    for (int s = 0; s < numSets; ++s) {
+        const BatchCurve& c = curves[s];
+        if (!c.scaling.valid) {
+            results[s] = std::make_tuple(tPoints, QVector<double>(numPoints, 0.0), QVector<double>(numPoints, 0.0));
+            continue;
+        }
+        if (c.group < 0) {
+            QVector<double> finalP(numPoints), finalDP(numPoints);
+            for (int i = 0; i < numPoints; ++i) {
+                finalP[i] = c.scaling.pCoeff * c.PD[i];
+                finalDP[i] = c.scaling.pCoeff * c.deriv[i];
+            }
+            results[s] = std::make_tuple(tPoints, finalP, finalDP);
+            continue;
+        }
+        const BatchGroup& group = groups[c.group];
+        const int nodeCount = group.engine->nodeCount();
+
+        QVector<double> PD(numPoints, 0.0);
+        for (int k = 0; k < numPoints; ++k) {
+            double t = group.tD[k];
+            if (t <= 1e-10) continue;
+            double pd = group.engine->invert(t, values[s].constData() + k * nodeCount);
+            if (!isFiniteValue(pd)) pd = 0.0;
+            PD[k] = applyStressSensitivity(pd, c.params.gamaD);
+        }
+
+        QVector<double> deriv(numPoints, 0.0);
+        if (numPoints > 2) {
+            deriv = PressureDerivativeCalculator::calculateBourdetDerivative(group.tD, PD, 0.1);
+        }
+
+        QVector<double> finalP(numPoints), finalDP(numPoints);
+        for (int i = 0; i < numPoints; ++i) {
+            finalP[i] = c.scaling.pCoeff * PD[i];
+            finalDP[i] = c.scaling.pCoeff * deriv[i];
+        }
+        results[s] = std::make_tuple(tPoints, finalP, finalDP);
+    }
+
+    return results;
 }
 
-void ModelSolver01_06::setHighPrecision(bool high)
+void ModelSolver01_06::calculateDimensionlessCurve(const QVector<double>& tD, const ModelParams& params,
+                                                   QVector<double>& outPD, QVector<double>& outDeriv)
 {
-    m_highPrecision = high;
+    calculatePDandDeriv(tD, params, outPD, outDeriv);
 }
 
-QString ModelSolver01_06::getModelName(ModelType type)
+bool ModelSolver01_06::interpolateFromLibrary(const QVector<double>& tD, const ModelParams& params,
+                                              QVector<double>& outPD, QVector<double>& outDeriv) const
 {
-    switch(type) {
-    case Model_1: return "模型1: 变井储+无限大边界";
-    case Model_2: return "模型2: 恒定井储+无限大边界";
-    case Model_3: return "模型3: 变井储+封闭边界";
-    case Model_4: return "模型4: 恒定井储+封闭边界";
-    case Model_5: return "模型5: 变井储+定压边界";
-    case Model_6: return "模型6: 恒定井储+定压边界";
-    default: return "未知模型";
+    double tDMin = 0.0, tDMax = 0.0;
+    for (double t : tD) {
+        if (t <= 1e-10) continue;
+        if (tDMin <= 0.0 || t < tDMin) tDMin = t;
+        tDMax = std::max(tDMax, t);
+    }
+    if (tDMin <= 0.0) return false;
+
+    QSharedPointer<TypeCurveLibrary> library = TypeCurveLibrary::find((int)m_type, params, tDMin, tDMax);
+    if (!library || !library->interpolate(params, tD, outPD, outDeriv)) return false;
+
+    // 压敏摄动：库中为 gamaD = 0 的曲线，PD' = -ln(1 - gamaD·PD)/gamaD，导数按链式法则 dPD' = dPD / (1 - gamaD·PD)
+    const double gamaD = params.gamaD;
+    if (std::abs(gamaD) > 1e-9) {
+        for (int k = 0; k < tD.size(); ++k) {
+            double arg = 1.0 - gamaD * outPD[k];
+            if (arg > 1e-12) {
+                outPD[k] = applyStressSensitivity(outPD[k], gamaD);
+                outDeriv[k] /= arg;
+            }
+        }
     }
+    return true;
 }
 
-QVector<double> ModelSolver01_06::generateLogTimeSteps(int count, double startExp, double endExp)
+const LaplaceInversion* ModelSolver01_06::inversionEngine(const ModelParams& params) const
 {
-    QVector<double> t;
-    if (count <= 0) return t;
-    t.reserve(count);
-    for (int i = 0; i < count; ++i) {
-        double exponent = startExp + (endExp - startExp) * i / (count - 1);
-        t.append(pow(10.0, exponent));
+    // 选择数值反演引擎：参数字典优先，其次为求解器默认设置
+    // Stehfest 的阶数即 N (已在 resolveParams 中完成范围与奇偶校验)
+    LaplaceInversion::Method method = (params.inversion >= 0) ? (LaplaceInversion::Method)params.inversion : m_inversionMethod;
+    int order = params.N;
+    if (method != LaplaceInversion::Stehfest) {
+        order = (params.inversionOrder > 0) ? params.inversionOrder : m_inversionOrder;
     }
-    return t;
+    return LaplaceInversion::engine(method, order);
 }
 
-ModelCurveData ModelSolver01_06::calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime)
+// ---------------------- 参数敏感度 ----------------------
+
+namespace {
+
+// 单个物理参数的求导方向：理论曲线 p(t) = p_coeff * PD(td_coeff * t; 无因次参数, gamaD)
+struct ParamDirection {
+    bool analytic = true;   // false: 离散参数，需调用方差分
+    double dLnTd = 0.0;     // d ln(td_coeff) / dθ
+    double dLnP = 0.0;      // d ln(p_coeff) / dθ
+    double dGamaD = 0.0;    // d gamaD / dθ
+    double kernel[ModelParams::KernelParamCount] = { 0.0 }; // d(无因次核函数参数) / dθ
+};
+
+// 按 calculateTheoreticalCurve / resolveParams 的参数读取规则 (含默认值与别名优先级) 求导
+ParamDirection resolveParamDirection(const QMap<QString, double>& p, const QString& name)
 {
-    QVector<double> tPoints = providedTime;
-    if (tPoints.isEmpty()) {
-        tPoints = generateLogTimeSteps(100, -3.0, 3.0); // 默认生成 1e-3 到 1e3
+    ParamDirection dir;
+    if (!p.contains(name) || name == "nf" || name == "N" || name == "inversion" || name == "inversionOrder") {
+        dir.analytic = false;
+        return dir;
+    }
+
+    const double value = p.value(name);
+    const double L = p.value("L", 1000.0);
+    const bool lengthValid = (L > 1e-9); // L 异常时无因次几何参数取固定默认值
+
+    if (name == "kf") {
+        dir.dLnTd = 1.0 / value;
+        dir.dLnP = -1.0 / value;
+        if (!p.contains("M12")) {
+            double km = p.value("km", 0.01);
+            if (km < 1e-12) km = 1e-12;
+            dir.kernel[ModelParams::Kernel_M12] = 1.0 / km;
+        }
+    } else if (name == "km") {
+        if (!p.contains("M12") && value >= 1e-12) {
+            double kf = p.value("kf", 1.0);
+            dir.kernel[ModelParams::Kernel_M12] = -kf / (value * value);
+        }
+    } else if (name == "M12") {
+        dir.kernel[ModelParams::Kernel_M12] = 1.0;
+    } else if (name == "L") {
+        if (lengthValid) {
+            dir.dLnTd = -2.0 / L;
+            dir.kernel[ModelParams::Kernel_LfD] = -p.value("Lf", 100.0) / (L * L);
+            dir.kernel[ModelParams::Kernel_rmD] = -p.value("rm", 500.0) / (L * L);
+            dir.kernel[ModelParams::Kernel_reD] = -p.value("re", 20000.0) / (L * L);
+        }
+    } else if (name == "Lf") {
+        if (lengthValid) dir.kernel[ModelParams::Kernel_LfD] = 1.0 / L;
+    } else if (name == "rm") {
+        if (lengthValid) dir.kernel[ModelParams::Kernel_rmD] = 1.0 / L;
+    } else if (name == "re") {
+        if (lengthValid) dir.kernel[ModelParams::Kernel_reD] = 1.0 / L;
+    } else if (name == "omega1") {
+        dir.kernel[ModelParams::Kernel_omega1] = 1.0;
+    } else if (name == "omega2") {
+        dir.kernel[ModelParams::Kernel_omega2] = 1.0;
+    } else if (name == "lambda1" || (name == "remda1" && !p.contains("lambda1"))) {
+        dir.kernel[ModelParams::Kernel_lambda1] = 1.0;
+    } else if (name == "lambda2" || (name == "remda2" && !p.contains("lambda2"))) {
+        dir.kernel[ModelParams::Kernel_lambda2] = 1.0;
+    } else if (name == "eta12" || (name == "eta" && !p.contains("eta12"))) {
+        dir.kernel[ModelParams::Kernel_eta12] = 1.0;
+    } else if (name == "cD") {
+        dir.kernel[ModelParams::Kernel_cD] = 1.0;
+    } else if (name == "S") {
+        dir.kernel[ModelParams::Kernel_S] = 1.0;
+    } else if (name == "gamaD") {
+        dir.dGamaD = 1.0;
+    } else if (name == "phi" || name == "Ct") {
+        dir.dLnTd = -1.0 / value;
+    } else if (name == "mu") {
+        dir.dLnTd = -1.0 / value;
+        dir.dLnP = 1.0 / value;
+    } else if (name == "q" || name == "B") {
+        dir.dLnP = 1.0 / value;
+    } else if (name == "h") {
+        dir.dLnP = -1.0 / value;
+    }
+    // 其余参数不参与理论曲线计算，偏导数为 0
+    return dir;
+}
+
+} // namespace
+
+ModelSensitivity ModelSolver01_06::calculateCurveSensitivity(const QMap<QString, double>& params, const QStringList& names,
+                                                             const QVector<double>& providedTime)
+{
+    WT_TRACE_SCOPE("ModelSolver::calculateCurveSensitivity");
+    WT_MEMORY_SCOPE(MemoryAccounting::Solver);
+    ModelSensitivity result;
+    result.t = providedTime;
+    if (result.t.isEmpty()) {
+        result.t = generateLogTimeSteps(100, -3.0, 3.0);
     }
+    result.names = names;
+
+    const int numPoints = result.t.size();
+    const int numParams = names.size();
+    result.p.fill(0.0, numPoints);
+    result.d.fill(0.0, numPoints);
+    result.dP = QVector<QVector<double>>(numParams, QVector<double>(numPoints, 0.0));
+    result.dD = QVector<QVector<double>>(numParams, QVector<double>(numPoints, 0.0));
+
+    QVector<ParamDirection> directions;
+    for (const QString& name : names) directions.append(resolveParamDirection(params, name));
+    for (const ParamDirection& dir : directions) result.analytic.append(dir.analytic);
 
-    // --- 1. 参数提取 ---
+    // --- 1. 有因次换算系数 (与 calculateTheoreticalCurve 一致) ---
     double phi = params.value("phi", 0.05);
     double mu = params.value("mu", 0.5);
     double B = params.value("B", 1.05);
@@ -102,230 +2026,477 @@ ModelCurveData ModelSolver01_06::calculateTheoreticalCurve(const QMap<QString, d
     double q = params.value("q", 5.0);
     double h = params.value("h", 20.0);
     double kf = params.value("kf", 1e-3);
-
-    // [逻辑对齐]: 长度参数 L 和 Lf
-    // MATLAB 常用 Lf 作为参考长度，但此处保留 L 作为参考长度的逻辑
-    // 如果 L 未设置或异常小，默认使用 1000 (MATLAB代码中的默认值)
     double L = params.value("L", 1000.0);
     if (L < 1e-9) L = 1000.0;
+    if (phi < 1e-12 || mu < 1e-12 || Ct < 1e-12 || kf < 1e-12) return result;
 
-    // 防止物理参数除零
-    if (phi < 1e-12 || mu < 1e-12 || Ct < 1e-12 || kf < 1e-12) {
-        return std::make_tuple(tPoints, QVector<double>(tPoints.size(), 0.0), QVector<double>(tPoints.size(), 0.0));
-    }
-
-    // --- 2. 计算无因次时间系数 (tD conversion) ---
-    // 公式: tD = 14.4 * kf * t / (phi * mu * Ct * L^2)
-    // 对应 MATLAB: tD = 14.4*kf*t/(phi*mu*Ct*L^2);
     double td_coeff = 14.4 * kf / (phi * mu * Ct * pow(L, 2));
+    double p_coeff = 1.842e-3 * q * mu * B / (kf * h);
 
-    QVector<double> tD_vec;
-    tD_vec.reserve(tPoints.size());
-    for(double t : tPoints) {
-        tD_vec.append(td_coeff * t);
+    QVector<double> tD(numPoints);
+    for (int i = 0; i < numPoints; ++i) tD[i] = td_coeff * result.t[i];
+
+    // --- 2. 为需要求导的核函数参数分配导数分量 ---
+    ModelParams mp = resolveParams(params);
+    applyAsymptoticRegimes(mp);
+    for (int k = 0; k < ModelParams::KernelParamCount; ++k) {
+        for (const ParamDirection& dir : directions) {
+            if (dir.analytic && dir.kernel[k] != 0.0) {
+                mp.sensitivitySlot[k] = mp.sensitivityCount++;
+                break;
+            }
+        }
     }
+    // 时间换算系数 (kf/phi/mu/Ct/L) 需要 dPD/dtD：把 Laplace 变量 z 作为最后一个求导方向，
+    // 得到 F'(z) 后对离散反演公式按 t 精确求导
+    int zSlot = -1;
+    for (const ParamDirection& dir : directions) {
+        if (dir.analytic && dir.dLnTd != 0.0) { zSlot = mp.sensitivityCount++; break; }
+    }
+    const int directionCount = mp.sensitivityCount;
+
+    const LaplaceInversion* engine = inversionEngine(mp);
+    const int nodeCount = engine->nodeCount();
+    const bool complexNodes = engine->requiresComplexNodes();
+
+    // --- 3. 各时间点：Jet 求值像函数，反演得到 PD 及其对核函数参数、对 tD 的导数 ---
+    QVector<double> pdRaw(numPoints, 0.0), pdRate(numPoints, 0.0), pdGrad(numPoints * directionCount, 0.0);
+    double* rawOut = pdRaw.data();
+    double* rateOut = pdRate.data();
+    double* gradOut = pdGrad.data();
+    const CancellationToken* token = CancellationToken::current();
+    auto evaluatePoint = [&](int k) {
+        double t = tD[k];
+        if (t <= 1e-10) return;
+
+        // grads 按方向分块存放：grads[s*nodeCount + m] 为第 m 个节点处 F 对第 s 个方向的导数
+        QVector<cplx> nodes(nodeCount), values(nodeCount), grads(nodeCount * directionCount);
+        engine->laplaceNodes(t, nodes.data());
+        for (int m = 0; m < nodeCount; ++m) {
+            if (token && token->isCancelled()) return;
+            cplx value = 0.0;
+            cplx d[SensitivityJet<double>::MaxDirections];
+            if (complexNodes) {
+                SensitivityJet<cplx> z = (zSlot >= 0) ? SensitivityJet<cplx>::variable(nodes[m], zSlot, directionCount)
+                                                      : SensitivityJet<cplx>(nodes[m]);
+                SensitivityJet<cplx> pf = flaplace_composite<SensitivityJet<cplx>>(z, mp);
+                value = pf.v;
+                for (int s = 0; s < directionCount; ++s) d[s] = pf.derivative(s);
+            } else {
+                SensitivityJet<double> z = (zSlot >= 0) ? SensitivityJet<double>::variable(nodes[m].real(), zSlot, directionCount)
+                                                        : SensitivityJet<double>(nodes[m].real());
+                SensitivityJet<double> pf = flaplace_composite<SensitivityJet<double>>(z, mp);
+                value = pf.v;
+                for (int s = 0; s < directionCount; ++s) d[s] = pf.derivative(s);
+            }
+            // 与 calculatePDandDeriv 一致：无效的像函数值按 0 处理
+            bool finite = isFiniteValue(value);
+            values[m] = finite ? value : cplx(0.0, 0.0);
+            for (int s = 0; s < directionCount; ++s) {
+                grads[s * nodeCount + m] = (finite && isFiniteValue(d[s])) ? d[s] : cplx(0.0, 0.0);
+            }
+        }
 
-    // --- 3. 计算无因次压力和导数 ---
-    QVector<double> PD_vec, Deriv_vec;
-    // 绑定核心 Laplace 变换函数
-    auto func = std::bind(&ModelSolver01_06::flaplace_composite, this, std::placeholders::_1, std::placeholders::_2);
+        rawOut[k] = engine->invert(t, values.constData());
+        if (!isFiniteValue(rawOut[k])) rawOut[k] = 0.0;
+        for (int s = 0; s < directionCount; ++s) {
+            double g = (s == zSlot) ? engine->invertTimeDerivative(t, values.constData(), grads.constData() + s * nodeCount)
+                                    : engine->invert(t, grads.constData() + s * nodeCount);
+            if (!isFiniteValue(g)) g = 0.0;
+            if (s == zSlot) rateOut[k] = g;
+            else gradOut[k * directionCount + s] = g;
+        }
+    };
 
-    // 准备计算参数副本
-    QMap<QString, double> calcParams = params;
+    if (m_parallelEvaluation && !t_forceSerialEvaluation && numPoints > 1) {
+        TaskScheduler::parallelFor(numPoints, evaluatePoint);
+    } else {
+        for (int k = 0; k < numPoints; ++k) evaluatePoint(k);
+    }
 
-    // [修正] Stehfest N 值控制
-    // MATLAB代码中 N=4，但为了保证曲线光滑度，QT中默认推荐 10
-    // 如果参数中未指定 N，则设为 10
-    if (!calcParams.contains("N") || calcParams["N"] < 4) {
-        calcParams["N"] = 10;
+    // --- 4. 压敏摄动 PD = -ln(1 - gamaD*PD0)/gamaD 的链式求导 ---
+    const double gamaD = mp.gamaD;
+    QVector<double> PD(numPoints), chain(numPoints, 1.0), dPDdGama(numPoints, 0.0);
+    for (int k = 0; k < numPoints; ++k) {
+        double raw = pdRaw[k];
+        PD[k] = raw;
+        if (std::abs(gamaD) > 1e-9) {
+            double arg = 1.0 - gamaD * raw;
+            if (arg > 1e-12) {
+                PD[k] = -1.0 / gamaD * std::log(arg);
+                chain[k] = 1.0 / arg;
+                dPDdGama[k] = std::log(arg) / (gamaD * gamaD) + raw / (gamaD * arg);
+            }
+        } else {
+            dPDdGama[k] = 0.5 * raw * raw; // gamaD -> 0 的极限
+        }
     }
-    // [修正] 裂缝离散段数 nf
-    // MATLAB代码中 nf=4，此处默认设为 10 提高积分精度
-    if (!calcParams.contains("nf") || calcParams["nf"] < 4) {
-        calcParams["nf"] = 10;
+
+    QVector<double> derivPD(numPoints, 0.0);
+    if (numPoints > 2) derivPD = PressureDerivativeCalculator::calculateBourdetDerivative(tD, PD, 0.1);
+    for (int k = 0; k < numPoints; ++k) {
+        result.p[k] = p_coeff * PD[k];
+        result.d[k] = p_coeff * derivPD[k];
     }
 
-    calculatePDandDeriv(tD_vec, calcParams, func, PD_vec, Deriv_vec);
+    // --- 5. 组合各物理参数的偏导数 ---
+    for (int j = 0; j < numParams; ++j) {
+        const ParamDirection& dir = directions[j];
+        if (!dir.analytic) continue;
+
+        QVector<double> dPD(numPoints, 0.0);
+        for (int k = 0; k < numPoints; ++k) {
+            double dRaw = dir.dLnTd * tD[k] * pdRate[k];
+            for (int c = 0; c < ModelParams::KernelParamCount; ++c) {
+                int slot = mp.sensitivitySlot[c];
+                if (slot >= 0 && dir.kernel[c] != 0.0) dRaw += dir.kernel[c] * pdGrad[k * directionCount + slot];
+            }
+            dPD[k] = chain[k] * dRaw + dir.dGamaD * dPDdGama[k];
+        }
 
-    // --- 4. 转换为有因次物理量 ---
-    // 公式: dp = 1.842e-3 * q * mu * B / (kf * h) * pD
-    // 对应 MATLAB: Dp = 1.842e-3*q*mu*B*PD/(kf*h);
-    double p_coeff = 1.842e-3 * q * mu * B / (kf * h);
+        QVector<double> dDerivPD(numPoints, 0.0);
+        if (numPoints > 2) dDerivPD = PressureDerivativeCalculator::calculateBourdetDerivativeTangent(tD, PD, dPD, 0.1);
 
-    QVector<double> finalP(tPoints.size()), finalDP(tPoints.size());
-    for(int i=0; i<tPoints.size(); ++i) {
-        finalP[i] = p_coeff * PD_vec[i];
-        finalDP[i] = p_coeff * Deriv_vec[i];
+        for (int k = 0; k < numPoints; ++k) {
+            result.dP[j][k] = p_coeff * (dir.dLnP * PD[k] + dPD[k]);
+            result.dD[j][k] = p_coeff * (dir.dLnP * derivPD[k] + dDerivPD[k]);
+        }
     }
 
-    return std::make_tuple(tPoints, finalP, finalDP);
+    return result;
 }
 
-void ModelSolver01_06::calculatePDandDeriv(const QVector<double>& tD, const QMap<QString, double>& params,
-                                           std::function<double(double, const QMap<QString, double>&)> laplaceFunc,
-                                           QVector<double>& outPD, QVector<double>& outDeriv)
-{
-    int numPoints = tD.size();
-    outPD.resize(numPoints);
-    outDeriv.resize(numPoints);
-
-    // Stehfest 参数 N
-    int N = (int)params.value("N", 10);
-    if (N > 18) N = 18; // 限制上限防止溢出
-    if (N % 2 != 0) N = 10; // 必须为偶数
-    double ln2 = log(2.0);
-
-    // 压敏参数 gamaD (MATLAB 代码中为 0.02)
-    double gamaD = params.value("gamaD", 0.0);
-
-    for (int k = 0; k < numPoints; ++k) {
-        double t = tD[k];
-        if (t <= 1e-10) { outPD[k] = 0.0; continue; }
-
-        double pd_val = 0.0;
-        // Stehfest 反演循环
-        for (int m = 1; m <= N; ++m) {
-            double z = m * ln2 / t;
-            double pf = laplaceFunc(z, params); // 调用 Laplace 空间函数
-
-            if (std::isnan(pf) || std::isinf(pf)) pf = 0.0;
-            pd_val += stefestCoefficient(m, N) * pf;
-        }
-        outPD[k] = pd_val * ln2 / t;
+// ---------------------- 模型策略 ----------------------
+// 六种模型 = 外边界策略 × 井储策略。策略在编译期选定，内核中的边界与井储分支随模板实例化消除。
+// 新增模型时增加 (或复用) 策略类型，并在 kernelTable() 中登记对应组合。
+
+// 外边界策略：HasOuterBoundary 为假时不计算 g2*reD 处的 Bessel 值；
+// outerCoefficient 由外边界处的 K0/K1 与缩放 I0/I1 给出 mAB 的缩放系数 (与 exp(g2*rmD - g2*reD) 相乘后使用)
+struct InfiniteBoundary {
+    enum { HasOuterBoundary = 0 };
+    // mAB = 0
+    template <typename T>
+    static T outerCoefficient(const T&, const T&, const T&, const T&) { return T(0.0); }
+};
+
+struct ClosedBoundary {
+    enum { HasOuterBoundary = 1 };
+    // mAB = K1(g2*reD) / I1(g2*reD)
+    template <typename T>
+    static T outerCoefficient(const T& k0_re, const T& k1_re, const T& i0_re_s, const T& i1_re_s) {
+        using std::abs;
+        Q_UNUSED(k0_re); Q_UNUSED(i0_re_s);
+        return (abs(i1_re_s) > 1e-100) ? T(k1_re / i1_re_s) : T(0.0);
+    }
+};
+
+struct ConstantPressureBoundary {
+    enum { HasOuterBoundary = 1 };
+    // mAB = -K0(g2*reD) / I0(g2*reD)
+    template <typename T>
+    static T outerCoefficient(const T& k0_re, const T& k1_re, const T& i0_re_s, const T& i1_re_s) {
+        using std::abs;
+        Q_UNUSED(k1_re); Q_UNUSED(i1_re_s);
+        return (abs(i0_re_s) > 1e-100) ? T(-(k0_re / i0_re_s)) : T(0.0);
+    }
+};
+
+// 井储策略：在储层响应 pf 上叠加 cD / S
+// Model 1, 3, 5: 考虑井储 (MATLAB modelwidget1A 中代码未注释)
+// Model 2, 4, 6: 不考虑井储 (MATLAB modelwidget2A 中代码已注释，或 CD=0)
+struct WithWellboreStorage {
+    template <typename T>
+    static T apply(T z, T pf, const ModelParams& p) {
+        using std::abs;
+        typedef typename KernelScalar<T>::Param Param;
+        Param CD = KernelScalar<T>::seed(p, p.cD, ModelParams::Kernel_cD);
+        Param S = KernelScalar<T>::seed(p, p.S, ModelParams::Kernel_S);
 
-        // [算法对齐] 摄动法考虑压敏 (MATLAB逻辑)
-        // PD(i) = -1/gamaD*log(1-gamaD*PD(i));
-        if (std::abs(gamaD) > 1e-9) {
-            double arg = 1.0 - gamaD * outPD[k];
-            if (arg > 1e-12) {
-                outPD[k] = -1.0 / gamaD * std::log(arg);
-            } else {
-                // 如果参数过大导致 arg <= 0，此处做数值保护
-                // 实际物理上意味着压力下降过大导致闭合
+        // MATLAB 公式: pf = (z*pf + S) / (z + CD*z^2*(z*pf + S))
+        // 对 cD/S 求导时即使其取值为 0 也进入该分支，保证导数连续
+        if (p.cD > 1e-12 || std::abs(p.S) > 1e-12
+            || KernelScalar<T>::hasTangent(CD) || KernelScalar<T>::hasTangent(S)) {
+            T num = z * pf + S;
+            T den = z + CD * z * z * num;
+            if (abs(den) > 1e-100) {
+                pf = num / den;
             }
         }
+        return pf;
+    }
+};
+
+struct WithoutWellboreStorage {
+    template <typename T>
+    static T apply(T, T pf, const ModelParams&) { return pf; }
+};
+
+// 内核函数表：每种数值类型一组函数指针，按模型类型在构造时选定一次
+struct ModelSolver01_06::KernelTable {
+    template <typename T>
+    struct Functions {
+        T (*laplace)(T, const ModelParams&);        // 完整像函数 (储层响应 + 井储表皮)
+        T (*reservoir)(T, const ModelParams&);      // 储层响应
+        T (*storage)(T, T, const ModelParams&);     // 井储表皮叠加
+    };
+    Functions<double> real;
+    Functions<cplx> complex;
+    Functions<SensitivityJet<double>> realJet;
+    Functions<SensitivityJet<cplx>> complexJet;
+
+    const Functions<double>& select(const double*) const { return real; }
+    const Functions<cplx>& select(const cplx*) const { return complex; }
+    const Functions<SensitivityJet<double>>& select(const SensitivityJet<double>*) const { return realJet; }
+    const Functions<SensitivityJet<cplx>>& select(const SensitivityJet<cplx>*) const { return complexJet; }
+
+    template <typename T, typename Boundary, typename Storage>
+    static Functions<T> functions() {
+        Functions<T> f;
+        f.laplace = &ModelSolver01_06::compositeLaplace<T, Boundary, Storage>;
+        f.reservoir = &ModelSolver01_06::compositeReservoir<T, Boundary>;
+        f.storage = &Storage::template apply<T>;
+        return f;
     }
 
-    // 计算导数 (Bourdet导数)
-    if (numPoints > 2) {
-        outDeriv = PressureDerivativeCalculator::calculateBourdetDerivative(tD, outPD, 0.1);
-    } else {
-        outDeriv.fill(0.0);
+    void (*laplaceBatch)(const double*, double*, int, const ModelParams&); // 实数节点批量像函数
+
+    template <typename Boundary, typename Storage>
+    static KernelTable make() {
+        KernelTable table;
+        table.laplaceBatch = &ModelSolver01_06::compositeLaplaceBatch<Boundary, Storage>;
+        table.real = functions<double, Boundary, Storage>();
+        table.complex = functions<cplx, Boundary, Storage>();
+        table.realJet = functions<SensitivityJet<double>, Boundary, Storage>();
+        table.complexJet = functions<SensitivityJet<cplx>, Boundary, Storage>();
+        return table;
     }
+};
+
+const ModelSolver01_06::KernelTable& ModelSolver01_06::kernelTable(ModelType type)
+{
+    // 顺序与 ModelType 枚举一致
+    static const KernelTable s_tables[] = {
+        KernelTable::make<InfiniteBoundary, WithWellboreStorage>(),         // Model_1
+        KernelTable::make<InfiniteBoundary, WithoutWellboreStorage>(),      // Model_2
+        KernelTable::make<ClosedBoundary, WithWellboreStorage>(),           // Model_3
+        KernelTable::make<ClosedBoundary, WithoutWellboreStorage>(),        // Model_4
+        KernelTable::make<ConstantPressureBoundary, WithWellboreStorage>(), // Model_5
+        KernelTable::make<ConstantPressureBoundary, WithoutWellboreStorage>() // Model_6
+    };
+    const int count = int(sizeof(s_tables) / sizeof(s_tables[0]));
+    int index = int(type);
+    if (index < 0 || index >= count) index = 0;
+    return s_tables[index];
 }
 
 // 核心 Laplace 函数：对应 MATLAB 中的 PWD_inf 封装逻辑及 fs1/fs2 计算
-double ModelSolver01_06::flaplace_composite(double z, const QMap<QString, double>& p) {
-    // 1. 参数读取 (需与 MATLAB x 向量对齐)
-    // MATLAB x = [kf, M12, L, Lf, rm, omga1, omga2, remda1, remda2, re]
-
-    // M12: 流度比 (MATLAB直接输入 M12)。如果 params 中有 M12，优先使用；否则用 kf/km
-    double M12 = 1.0;
-    if (p.contains("M12")) {
-        M12 = p.value("M12");
-    } else {
-        double kf = p.value("kf", 1.0);
-        double km = p.value("km", 0.01);
-        if(km < 1e-12) km = 1e-12;
-        M12 = kf / km;
-    }
-
-    double L = p.value("L", 1000.0);
-    double Lf = p.value("Lf", 100.0);
-    double rm = p.value("rm", 500.0);
-    double re = p.value("re", 20000.0);
+// 模板参数 T 为 double (实数节点) 或 std::complex<double> (复数节点反演)
+template <typename T>
+T ModelSolver01_06::flaplace_composite(T z, const ModelParams& p) const {
+    return m_kernels->select((const T*)nullptr).laplace(z, p);
+}
 
-    // 无因次几何参数
-    // LfD = Lf/L; rmD = rm/L; reD = re/L;
-    double LfD = (L > 1e-9) ? Lf / L : 0.1;
-    double rmD = (L > 1e-9) ? rm / L : 0.5;
-    double reD = (L > 1e-9) ? re / L : 20.0;
+// 实数节点储层响应：与 reservoirKernel<double> 逐位一致
+void ModelSolver01_06::evaluateReservoirBatch(ModelType type, const ModelParams& p, const double* z, double* out, int n) {
+    const KernelTable::Functions<double>& f = kernelTable(type).real;
+    for (int i = 0; i < n; ++i) out[i] = f.reservoir(z[i], p);
+}
 
-    // 双重介质参数
-    double omga1 = p.value("omega1", 0.4);   // 内区储容比
-    double omga2 = p.value("omega2", 0.08);  // 外区储容比
+// 实数节点批量像函数：与逐个调用 flaplace_composite<double> 的结果逐位一致
+void ModelSolver01_06::flaplaceCompositeBatch(const double* z, double* out, int n, const ModelParams& p) const {
+    if (n > 0) m_kernels->laplaceBatch(z, out, n, p);
+}
 
-    // 窜流系数 (注意参数名兼容性)
-    // MATLAB: remda1, remda2
-    double remda1 = p.contains("lambda1") ? p.value("lambda1") : p.value("remda1", 1e-3);
-    double remda2 = p.contains("lambda2") ? p.value("lambda2") : p.value("remda2", 1e-4);
+// 储层部分：fs1/fs2 与点源解，只依赖 cD/S 以外的无因次参数
+template <typename T>
+T ModelSolver01_06::reservoirKernel(T z, const ModelParams& p) const {
+    return m_kernels->select((const T*)nullptr).reservoir(z, p);
+}
 
-    // 导压系数比 eta12 (MATLAB 代码中硬编码为 0.2，此处支持参数输入)
-    double eta12 = p.value("eta", 0.2);
-    if (p.contains("eta12")) eta12 = p.value("eta12");
+// 井储和表皮效应：在储层响应 pf 上叠加 cD / S (批量计算中同一储层响应供多个 cD/S 组合复用)
+template <typename T>
+T ModelSolver01_06::applyWellboreStorage(T z, T pf, const ModelParams& p) const {
+    return m_kernels->select((const T*)nullptr).storage(z, pf, p);
+}
 
-    // 裂缝离散段数
-    int nf = (int)p.value("nf", 10);
-    if(nf < 1) nf = 1;
+template <typename T, typename Boundary, typename Storage>
+T ModelSolver01_06::compositeLaplace(T z, const ModelParams& p) {
+    return Storage::apply(z, compositeReservoir<T, Boundary>(z, p), p);
+}
 
-    // 2. 构造裂缝节点 xwD
-    // MATLAB: xwD = linspace(-0.9, 0.9, nf);
-    QVector<double> xwD;
-    xwD.reserve(nf);
-    if (nf == 1) {
-        xwD.append(0.0);
-    } else {
-        double start = -0.9; // 与 MATLAB 保持一致 (-0.9 到 0.9)
-        double end = 0.9;
-        double step = (end - start) / (nf - 1);
-        for(int i=0; i<nf; ++i) xwD.append(start + i * step);
-    }
+template <typename T, typename Boundary>
+T ModelSolver01_06::compositeReservoir(T z, const ModelParams& p) {
+    using std::abs;
+    // 参数已由 resolveParams 预先解析 (MATLAB x = [kf, M12, L, Lf, rm, omga1, omga2, remda1, remda2, re])
+    // Param 对 double/复数节点即为 double；敏感度计算 (SensitivityJet) 时为带导数的 Jet
+    typedef typename KernelScalar<T>::Param Param;
+    Param omga1 = KernelScalar<T>::seed(p, p.omega1, ModelParams::Kernel_omega1);
+    Param omga2 = KernelScalar<T>::seed(p, p.omega2, ModelParams::Kernel_omega2);
+    Param remda1 = KernelScalar<T>::seed(p, p.lambda1, ModelParams::Kernel_lambda1);
+    Param remda2 = KernelScalar<T>::seed(p, p.lambda2, ModelParams::Kernel_lambda2);
+    Param eta12 = KernelScalar<T>::seed(p, p.eta12, ModelParams::Kernel_eta12);
 
     // 3. 计算 fs1 和 fs2 (修正为 MATLAB 逻辑)
     // MATLAB:
     // fs1 = (omga1*(1-omga1)*z + remda1)/((1-omga1)*z + remda1);
     // fs2 = eta12*(omga2*(1-omga2)*eta12*z + remda2)/((1-omga2)*eta12*z + remda2);
 
-    double one_minus_omega1 = 1.0 - omga1;
-    double den_fs1 = one_minus_omega1 * z + remda1;
-    double fs1 = 1.0;
-    if (std::abs(den_fs1) > 1e-20) {
+    Param one_minus_omega1 = 1.0 - omga1;
+    T den_fs1 = one_minus_omega1 * z + remda1;
+    T fs1 = 1.0;
+    if (abs(den_fs1) > 1e-20) {
         fs1 = (omga1 * one_minus_omega1 * z + remda1) / den_fs1;
     }
 
-    double one_minus_omega2 = 1.0 - omga2;
-    double den_fs2 = one_minus_omega2 * eta12 * z + remda2;
-    double fs2 = 0.0;
-    if (std::abs(den_fs2) > 1e-20) {
+    Param one_minus_omega2 = 1.0 - omga2;
+    T den_fs2 = one_minus_omega2 * eta12 * z + remda2;
+    T fs2 = 0.0;
+    if (abs(den_fs2) > 1e-20) {
         fs2 = eta12 * (omga2 * one_minus_omega2 * eta12 * z + remda2) / den_fs2;
     }
 
     // 数值保护：防止开方负数
-    if (z * fs1 < 0) fs1 = 0;
-    if (z * fs2 < 0) fs2 = 0;
+    fs1 = clampNonNegativeSpeed(z, fs1);
+    fs2 = clampNonNegativeSpeed(z, fs2);
 
     // 4. 调用点源解 PWD_composite
-    double pf = PWD_composite(z, fs1, fs2, M12, LfD, rmD, reD, nf, xwD, m_type);
+    return PWD_composite<T, Boundary>(z, fs1, fs2, p);
+}
 
-    // 5. 井储和表皮效应 (Wellbore Storage and Skin)
-    // Model 1, 3, 5: 考虑井储 (MATLAB modelwidget1A 中代码未注释)
-    // Model 2, 4, 6: 不考虑井储 (MATLAB modelwidget2A 中代码已注释，或 CD=0)
-    bool hasStorage = (m_type == Model_1 || m_type == Model_3 || m_type == Model_5);
+// 批量像函数每趟结构数组循环处理的节点数 (栈上数组容量)
+static const int LAPLACE_BATCH_SIZE = 32;
+
+// 实数节点批量像函数：同一参数块的一组 z 按结构数组分趟计算——fs1/fs2 与 γ1/γ2、界面与外边界的 Bessel 值
+// (BesselBatch 批量求值)、mAB 与 Ac 前因子各为一趟独立循环，之后逐个 z 依次装配并求解裂缝方程组 (线程工作区与裂缝几何复用)。
+// 各步运算与 compositeLaplace<double> 相同，结果逐位一致；早期渐近路径的节点不参与 Bessel 求值
+template <typename Boundary, typename Storage>
+void ModelSolver01_06::compositeLaplaceBatch(const double* z, double* out, int n, const ModelParams& p) {
+    WT_TRACE_SCOPE("ModelSolver::compositeLaplaceBatch");
+    WT_MEMORY_SCOPE(MemoryAccounting::Solver);
+    const double omga1 = p.omega1, omga2 = p.omega2;
+    const double remda1 = p.lambda1, remda2 = p.lambda2;
+    const double eta12 = p.eta12;
+    const double one_minus_omega1 = 1.0 - omga1;
+    const double one_minus_omega2 = 1.0 - omga2;
+    const double M12 = p.M12, LfD = p.LfD, rmD = p.rmD, reD = p.reD;
+    const int nf = p.nf;
+    const bool hasOuterBoundary = Boundary::HasOuterBoundary && p.reD > 1e-5;
+    const AsymptoticGeometry geometry = asymptoticGeometry(p);
+    const bool earlyEnabled = p.earlyArgument > 0.0 && geometry.dMin > 0.0;
+
+    double gama1[LAPLACE_BATCH_SIZE], gama2[LAPLACE_BATCH_SIZE];
+    double argG1[LAPLACE_BATCH_SIZE], argG2[LAPLACE_BATCH_SIZE], argRe[LAPLACE_BATCH_SIZE];
+    double besselArg[LAPLACE_BATCH_SIZE];
+    double k0G1[LAPLACE_BATCH_SIZE], k1G1[LAPLACE_BATCH_SIZE], i0G1s[LAPLACE_BATCH_SIZE], i1G1s[LAPLACE_BATCH_SIZE];
+    double k0G2[LAPLACE_BATCH_SIZE], k1G2[LAPLACE_BATCH_SIZE], i0G2s[LAPLACE_BATCH_SIZE], i1G2s[LAPLACE_BATCH_SIZE];
+    double k0Re[LAPLACE_BATCH_SIZE], k1Re[LAPLACE_BATCH_SIZE], i0ReS[LAPLACE_BATCH_SIZE], i1ReS[LAPLACE_BATCH_SIZE];
+    double acPrefactor[LAPLACE_BATCH_SIZE];
+    int active[LAPLACE_BATCH_SIZE];
+
+    for (int begin = 0; begin < n; begin += LAPLACE_BATCH_SIZE) {
+        const int count = std::min(int(LAPLACE_BATCH_SIZE), n - begin);
+        const double* zb = z + begin;
+        double* ob = out + begin;
+
+        // 1. fs1/fs2 与 γ1/γ2 (分母保护与非负限幅同 compositeReservoir)；早期渐近路径的节点直接给出结果，
+        //    其余节点压紧到 active 中进入后续各趟
+        int m = 0;
+        for (int i = 0; i < count; ++i) {
+            const double den_fs1 = one_minus_omega1 * zb[i] + remda1;
+            double fs1 = 1.0;
+            if (std::abs(den_fs1) > 1e-20) fs1 = (omga1 * one_minus_omega1 * zb[i] + remda1) / den_fs1;
+            const double den_fs2 = one_minus_omega2 * eta12 * zb[i] + remda2;
+            double fs2 = 0.0;
+            if (std::abs(den_fs2) > 1e-20) fs2 = eta12 * (omga2 * one_minus_omega2 * eta12 * zb[i] + remda2) / den_fs2;
+            fs1 = clampNonNegativeSpeed(zb[i], fs1);
+            fs2 = clampNonNegativeSpeed(zb[i], fs2);
+
+            const double g1 = std::sqrt(zb[i] * fs1);
+            if (earlyEnabled && g1 * geometry.dMin >= p.earlyArgument) {
+                s_regimeEarly.fetchAndAddRelaxed(1);
+                ob[i] = Storage::apply(zb[i], double(M_PI) / (2.0 * M12 * LfD * double(nf) * zb[i] * g1), p);
+                continue;
+            }
+            active[m] = i;
+            gama1[m] = g1;
+            gama2[m] = std::sqrt(zb[i] * fs2);
+            ++m;
+        }
+        if (m == 0) continue;
 
-    if (hasStorage) {
-        double CD = p.value("cD", 0.0); // 注意：这里直接用 cD，如果是 C 需转换
-        double S = p.value("S", 0.0);
+        // 2. 界面 (γ1·rmD, γ2·rmD) 与外边界 (γ2·reD) 处的 Bessel 值，各为一次批量求值 (参数下限保护同 evaluateBesselSet)
+        for (int i = 0; i < m; ++i) {
+            argG1[i] = gama1[i] * rmD;
+            argG2[i] = gama2[i] * rmD;
+            argRe[i] = hasOuterBoundary ? gama2[i] * reD : 0.0;
+        }
+        for (int i = 0; i < m; ++i) besselArg[i] = std::max(argG1[i], 1e-15);
+        BesselBatch::evaluate(besselArg, k0G1, k1G1, i0G1s, i1G1s, m);
+        for (int i = 0; i < m; ++i) besselArg[i] = std::max(argG2[i], 1e-15);
+        BesselBatch::evaluate(besselArg, k0G2, k1G2, i0G2s, i1G2s, m);
+        if (hasOuterBoundary) {
+            for (int i = 0; i < m; ++i) besselArg[i] = std::max(argRe[i], 1e-15);
+            BesselBatch::evaluate(besselArg, k0Re, k1Re, i0ReS, i1ReS, m);
+        }
 
-        // MATLAB 公式: pf = (z*pf + S) / (z + CD*z^2*(z*pf + S))
-        if (CD > 1e-12 || std::abs(S) > 1e-12) {
-            double num = z * pf + S;
-            double den = z + CD * z * z * num;
-            if (std::abs(den) > 1e-100) {
-                pf = num / den;
+        // 3. mAB 项与 Ac 前因子 (表达式同 PWD_composite)
+        for (int i = 0; i < m; ++i) {
+            double term_mAB_i0 = 0.0;
+            double term_mAB_i1 = 0.0;
+            if (hasOuterBoundary) {
+                double exp_factor = 0.0;
+                if (argG2[i] - argRe[i] > -700.0) exp_factor = std::exp(argG2[i] - argRe[i]);
+                const double mAB = Boundary::template outerCoefficient<double>(k0Re[i], k1Re[i], i0ReS[i], i1ReS[i]);
+                term_mAB_i0 = mAB * i0G2s[i] * exp_factor;
+                term_mAB_i1 = mAB * i1G2s[i] * exp_factor;
             }
+            const double term1 = term_mAB_i0 + k0G2[i];
+            const double term2 = term_mAB_i1 - k1G2[i];
+            const double Acup = M12 * gama1[i] * k1G1[i] * term1 + gama2[i] * k0G1[i] * term2;
+            double Acdown_scaled = M12 * gama1[i] * i1G1s[i] * term1 - gama2[i] * i0G1s[i] * term2;
+            Acdown_scaled = guardDenominator(Acdown_scaled);
+            acPrefactor[i] = Acup / Acdown_scaled;
         }
-    }
 
-    return pf;
+        // 4. 逐个节点装配并求解裂缝方程组，叠加井储表皮
+        for (int i = 0; i < m; ++i) {
+            const int k = active[i];
+            const double pf = fractureSystemResponse<double>(zb[k], gama1[i], argG1[i], acPrefactor[i], geometry.dMax, p);
+            ob[k] = Storage::apply(zb[k], pf, p);
+        }
+    }
 }
 
-double ModelSolver01_06::PWD_composite(double z, double fs1, double fs2, double M12, double LfD, double rmD, double reD, int nf, const QVector<double>& xwD, ModelType type) {
+template <typename T, typename Boundary>
+T ModelSolver01_06::PWD_composite(T z, T fs1, T fs2, const ModelParams& p) {
+    WT_TRACE_SCOPE("ModelSolver::PWD_composite");
+    WT_MEMORY_SCOPE(MemoryAccounting::Solver);
+    using std::abs;
+    using std::sqrt;
+    using std::exp;
+    using std::real;
+
     // 对应 MATLAB PWD_inf 函数逻辑
-    double gama1 = sqrt(z * fs1);
-    double gama2 = sqrt(z * fs2);
+    typedef typename KernelScalar<T>::Param Param;
+    const Param M12 = KernelScalar<T>::seed(p, p.M12, ModelParams::Kernel_M12);
+    const Param LfD = KernelScalar<T>::seed(p, p.LfD, ModelParams::Kernel_LfD);
+    const Param rmD = KernelScalar<T>::seed(p, p.rmD, ModelParams::Kernel_rmD);
+    const Param reD = KernelScalar<T>::seed(p, p.reD, ModelParams::Kernel_reD);
+    const int nf = p.nf;
+
+    T gama1 = sqrt(z * fs1);
+    T gama2 = sqrt(z * fs2);
+
+    // [早期渐近] 裂缝之间、自感应积分的端部尾项以及复合界面 Ac·I0 项均按 exp(-Re(γ1)·d) 衰减，
+    // Re(γ1)·d_min 超过阈值时影响矩阵为对角阵 π/(2·M12·LfD·γ1)，加边方程组给出各裂缝等流量的线性流解
+    const AsymptoticGeometry geometry = asymptoticGeometry(p);
+    if (p.earlyArgument > 0.0 && geometry.dMin > 0.0 && real(gama1) * geometry.dMin >= p.earlyArgument) {
+        s_regimeEarly.fetchAndAddRelaxed(1);
+        return T(M_PI) / (2.0 * M12 * LfD * double(nf) * z * gama1);
+    }
 
-    double arg_g1_rm = gama1 * rmD;
-    double arg_g2_rm = gama2 * rmD;
+    T arg_g1_rm = gama1 * rmD;
+    T arg_g2_rm = gama2 * rmD;
 
     // 边界条件处理 mAB
     // mAB=0 (无穷大)
@@ -333,44 +2504,42 @@ double ModelSolver01_06::PWD_composite(double z, double fs1, double fs2, double
     // mAB=-K0(g2*reD)/I0(g2*reD) (定压)
     // 此处使用 scaled Bessel 函数处理大参数
 
-    double term_mAB_i0 = 0.0; // 对应 mAB * I0(g2*rm)
-    double term_mAB_i1 = 0.0; // 对应 mAB * I1(g2*rm)
+    T term_mAB_i0 = 0.0; // 对应 mAB * I0(g2*rm)
+    T term_mAB_i1 = 0.0; // 对应 mAB * I1(g2*rm)
 
-    // 基础 Bessel 值
-    double k0_g2_rm = safe_bessel_k(0, arg_g2_rm);
-    double k1_g2_rm = safe_bessel_k(1, arg_g2_rm);
-    double k0_g1_rm = safe_bessel_k(0, arg_g1_rm);
-    double k1_g1_rm = safe_bessel_k(1, arg_g1_rm);
+    // 无限大边界在编译期排除外边界项
+    const bool hasOuterBoundary = Boundary::HasOuterBoundary && p.reD > 1e-5;
 
-    bool isInfinite = (type == Model_1 || type == Model_2);
-    bool isClosed = (type == Model_3 || type == Model_4);
-    bool isConstP = (type == Model_5 || type == Model_6);
+    // 基础 Bessel 值：界面 (g1*rmD, g2*rmD) 与外边界 (g2*reD) 处一次批量求出
+    T besselArg[3] = { arg_g1_rm, arg_g2_rm, hasOuterBoundary ? T(gama2 * reD) : T(0.0) };
+    T besselK0[3], besselK1[3], besselI0s[3], besselI1s[3];
+    evaluateBesselSet(besselArg, besselK0, besselK1, besselI0s, besselI1s, hasOuterBoundary ? 3 : 2);
 
-    if (!isInfinite && reD > 1e-5) {
-        double arg_re = gama2 * reD;
-        double i0_re_s = safe_bessel_i_scaled(0, arg_re);
-        double i1_re_s = safe_bessel_i_scaled(1, arg_re);
-        double k0_re = safe_bessel_k(0, arg_re);
-        double k1_re = safe_bessel_k(1, arg_re);
+    T k0_g1_rm = besselK0[0];
+    T k1_g1_rm = besselK1[0];
+    T k0_g2_rm = besselK0[1];
+    T k1_g2_rm = besselK1[1];
 
-        double i0_g2_rm_s = safe_bessel_i_scaled(0, arg_g2_rm);
-        double i1_g2_rm_s = safe_bessel_i_scaled(1, arg_g2_rm);
+    if (hasOuterBoundary) {
+        T arg_re = besselArg[2];
+        T i0_re_s = besselI0s[2];
+        T i1_re_s = besselI1s[2];
+        T k0_re = besselK0[2];
+        T k1_re = besselK1[2];
+
+        T i0_g2_rm_s = besselI0s[1];
+        T i1_g2_rm_s = besselI1s[1];
 
         // 缩放因子：exp(arg_g2_rm - arg_re)
-        double exp_factor = 0.0;
-        if ((arg_g2_rm - arg_re) > -700.0) {
-            exp_factor = std::exp(arg_g2_rm - arg_re);
+        T exp_factor = 0.0;
+        if (real(arg_g2_rm - arg_re) > -700.0) {
+            exp_factor = exp(arg_g2_rm - arg_re);
         }
 
-        if (isClosed && i1_re_s > 1e-100) {
-            // mAB = k1_re / i1_re_s (scaled cancellation)
-            // term = (k1_re / i1_re_s) * i0_g2_rm_s * exp_factor
-            term_mAB_i0 = (k1_re / i1_re_s) * i0_g2_rm_s * exp_factor;
-            term_mAB_i1 = (k1_re / i1_re_s) * i1_g2_rm_s * exp_factor;
-        } else if (isConstP && i0_re_s > 1e-100) {
-            term_mAB_i0 = -(k0_re / i0_re_s) * i0_g2_rm_s * exp_factor;
-            term_mAB_i1 = -(k0_re / i0_re_s) * i1_g2_rm_s * exp_factor;
-        }
+        // term = mAB_scaled * i0_g2_rm_s * exp_factor (scaled cancellation)
+        T mAB = Boundary::template outerCoefficient<T>(k0_re, k1_re, i0_re_s, i1_re_s);
+        term_mAB_i0 = mAB * i0_g2_rm_s * exp_factor;
+        term_mAB_i1 = mAB * i1_g2_rm_s * exp_factor;
     }
 
     // 计算 Acup 和 Acdown (Ac 分子分母)
@@ -379,118 +2548,229 @@ double ModelSolver01_06::PWD_composite(double z, double fs1, double fs2, double
     // Acdown = M12*gama1*I1(1)*(mAB*I0(2)+K0(2)) - gama2*I0(1)*(mAB*I1(2)-K1(2))
 
     // term1 对应 (mAB*I0(2)+K0(2))
-    double term1 = term_mAB_i0 + k0_g2_rm;
+    T term1 = term_mAB_i0 + k0_g2_rm;
     // term2 对应 (mAB*I1(2)-K1(2))
-    double term2 = term_mAB_i1 - k1_g2_rm;
+    T term2 = term_mAB_i1 - k1_g2_rm;
 
-    double Acup = M12 * gama1 * k1_g1_rm * term1 + gama2 * k0_g1_rm * term2;
+    T Acup = M12 * gama1 * k1_g1_rm * term1 + gama2 * k0_g1_rm * term2;
 
     // 计算分母，使用 scaled I 防止溢出
-    double i1_g1_rm_s = safe_bessel_i_scaled(1, arg_g1_rm);
-    double i0_g1_rm_s = safe_bessel_i_scaled(0, arg_g1_rm);
+    T i1_g1_rm_s = besselI1s[0];
+    T i0_g1_rm_s = besselI0s[0];
 
     // Acdown_scaled = Acdown * exp(-arg_g1_rm)
-    double Acdown_scaled = M12 * gama1 * i1_g1_rm_s * term1 - gama2 * i0_g1_rm_s * term2;
+    T Acdown_scaled = M12 * gama1 * i1_g1_rm_s * term1 - gama2 * i0_g1_rm_s * term2;
 
-    if (std::abs(Acdown_scaled) < 1e-100) Acdown_scaled = (Acdown_scaled >= 0 ? 1e-100 : -1e-100);
+    Acdown_scaled = guardDenominator(Acdown_scaled);
 
     // Ac_prefactor = Acup / Acdown_scaled
     // 实际 Ac = Ac_prefactor * exp(-arg_g1_rm)  (因为分母被除了 exp(arg))
     // 但之后计算 I0(arg_dist) 时，我们会用 scaled I0: I0_s(arg_dist) = I0(arg_dist) * exp(-arg_dist)
     // 组合项：Ac * I0(dist) = Ac_prefactor * exp(-arg_g1_rm) * I0_s(dist) * exp(arg_dist)
     //                     = Ac_prefactor * I0_s(dist) * exp(arg_dist - arg_g1_rm)
-    double Ac_prefactor = Acup / Acdown_scaled;
-
-    // 建立积分方程矩阵 A * q = b
-    int size = nf + 1;
-    Eigen::MatrixXd A_mat(size, size);
-    Eigen::VectorXd b_vec(size);
-    b_vec.setZero();
-    b_vec(nf) = 1.0;
-
-    for (int i = 0; i < nf; ++i) {
-        for (int j = 0; j < nf; ++j) {
-            // 定义被积函数 y11
-            auto integrand = [&](double a) -> double {
-                double dist_val = std::sqrt(std::pow(xwD[i] - xwD[j] - a, 2)); // ywD 假设全为0
-                double arg_dist = gama1 * dist_val;
+    T Ac_prefactor = Acup / Acdown_scaled;
 
-                // 第一项 K0(gama1 * dist)
-                double k0_val = safe_bessel_k(0, arg_dist);
-
-                // 第二项 Ac * I0(gama1 * dist)
-                // 使用 scaled I0 和指数偏移处理数值稳定性
-                double term2_val = 0.0;
-                double exponent = arg_dist - arg_g1_rm; // 对应上述推导的 exp(arg_dist - arg_g1_rm)
+    return fractureSystemResponse<T>(z, gama1, arg_g1_rm, Ac_prefactor, geometry.dMax, p);
+}
 
-                if (exponent > -700.0) {
-                    term2_val = Ac_prefactor * safe_bessel_i_scaled(0, arg_dist) * std::exp(exponent);
+template <typename T>
+T ModelSolver01_06::fractureSystemResponse(T z, T gama1, T arg_g1_rm, T Ac_prefactor, double dMax, const ModelParams& p) {
+    using std::abs;
+    using std::exp;
+    using std::real;
+
+    typedef typename KernelScalar<T>::Param Param;
+    const Param M12 = KernelScalar<T>::seed(p, p.M12, ModelParams::Kernel_M12);
+    const Param LfD = KernelScalar<T>::seed(p, p.LfD, ModelParams::Kernel_LfD);
+    const double LfDValue = p.LfD; // 积分上下限 (对 LfD 的导数经 Leibniz 公式单独补充)
+    const int nf = p.nf;
+    const QVector<double>& xwD = p.xwD;
+
+    // 裂缝影响矩阵 (nf×nf，按行存储)，加边后在 solveBorderedSystem 中求解 A * q = b
+    // 存储取自线程局部工作区，nf 不变时反复调用不再分配；等间距布局只保存首行
+    KernelWorkspace<T>& kernelWorkspace = KernelWorkspace<T>::local();
+    QVector<T>& influence = kernelWorkspace.influence;
+
+    // MATLAB: A(i,j) = z * (Integral / (M12*z*2*LfD)) = Integral / (M12*2*LfD)
+    Param scale = 1.0 / (M12 * 2.0 * LfD);
+
+    // [晚期级数] |γ1|·d_max 不超过阈值时被积函数按小参数级数逐项解析积分，跳过自适应积分中的 Bessel 求值
+    if (p.lateArgument > 0.0 && abs(gama1) * dMax <= p.lateArgument) {
+        s_regimeLate.fetchAndAddRelaxed(1);
+        const T Ac = (real(arg_g1_rm) < 700.0) ? T(Ac_prefactor * exp(-arg_g1_rm)) : T(0.0);
+        // 积分值只依赖 |offset|，矩阵对称；等间距布局下与完整路径相同只计算首行 (Toeplitz 结构)
+        if (isUniformFractureLayout(xwD)) {
+            QVector<T>& column = kernelWorkspace.diagonal;
+            column.resize(nf);
+            for (int j = 0; j < nf; ++j) column[j] = seriesInfluenceIntegral(xwD[0] - xwD[j], LfD, gama1, Ac) * scale;
+            return solveUniformFractureSystem(column, nf, z);
+        }
+        influence.resize(nf * nf);
+        for (int i = 0; i < nf; ++i) {
+            for (int j = 0; j < nf; ++j) {
+                if (j < i) {
+                    influence[i * nf + j] = influence[j * nf + i];
+                } else {
+                    influence[i * nf + j] = seriesInfluenceIntegral(xwD[i] - xwD[j], LfD, gama1, Ac) * scale;
                 }
-                return k0_val + term2_val;
-            };
-
-            double val = 0.0;
-            // 自感应项 (i==j): 奇异点积分，必须保持高深度
-            if (i == j) {
-                // 分两段积分避开奇异性 (虽然 K0 是对数奇异，Gauss 积分在端点不取值即可)
-                val = 2.0 * adaptiveGauss(integrand, 0.0, LfD, 1e-6, 0, 8);
-            } else {
-                // 互感应项
-                val = adaptiveGauss(integrand, -LfD, LfD, 1e-6, 0, 5);
             }
-
-            // 填充矩阵元素 A(i,j)
-            // MATLAB: A(i,j) = z * (Integral / (M12*z*2*LfD)) = Integral / (M12*2*LfD)
-            A_mat(i, j) = val / (M12 * 2.0 * LfD);
         }
+        return solveBorderedSystem(influence, nf, z);
     }
-
-    // 边界条件：sum(qi) = 1 (Laplace空间为 1/s，此处求解的是 s*P，故右端为1)
-    // 最后一列 (-1) 和最后一行 (z)
-    for (int i = 0; i < nf; ++i) {
-        A_mat(i, nf) = -1.0;
-        A_mat(nf, i) = z; // 流量守恒方程系数
+    s_regimeFull.fetchAndAddRelaxed(1);
+
+    // 定义被积函数 y11 的生成器：被积函数只依赖于两节点间的坐标差 offset = xwD[i] - xwD[j]
+    // (ywD 假设全为0)，因此把 offset 作为参数捕获，供 Toeplitz 装配与完整装配共用
+    // 被积函数按面板批量求值：一次传入同一 Gauss 面板的全部节点 (见 fractureIntegrandPanel)
+    auto makeIntegrand = [&](double offset) {
+        return [=](const double* a, T* out, int n) {
+            fractureIntegrandPanel(offset, a, n, gama1, arg_g1_rm, Ac_prefactor, out);
+        };
+    };
+
+    // 积分工作区 (栈上分配，各矩阵元素的积分依次复用)；二分深度受工作区栈容量限制
+    QuadratureWorkspace workspace;
+    const double quadTol = p.quadratureTolerance;
+    const int quadDepth = std::max(1, std::min(p.quadratureDepth, int(QuadratureWorkspace::Capacity) - 2));
+
+    // 计算单个矩阵元素对应的积分值
+    auto influenceIntegral = [&](double offset, bool isSelf) -> T {
+        auto integrand = makeIntegrand(offset);
+        // 积分限处的被积函数值 (仅 Leibniz 补充项使用)
+        auto boundaryValue = [&](double a) -> T {
+            T value;
+            integrand(&a, &value, 1);
+            return value;
+        };
+        // 自感应项 (i==j): 被积函数在 a=0 处含 K0 的对数奇异性，按对称性只积 [0, LfD] 再乘 2
+        if (isSelf) {
+            // 奇异性扣除：a -> 0 时 K0(γ1·a) = -ln(a) + 常数 + O(a²ln a)，在 [0, a0] 上积分 y11(a) + ln(a)
+            // (有界且足够光滑)，再解析补回 ∫ln(a)da = a0·ln(a0) - a0；a0 = min(LfD, 1/|γ1|) 内 K0 处于小参数区，
+            // 其余部分被积函数光滑，无需再依靠深层二分逼近奇点
+            double a0 = std::min(LfDValue, 1.0 / std::max((double)abs(gama1), 1e-300));
+            auto regular = [&](const double* a, T* out, int n) {
+                integrand(a, out, n);
+                for (int k = 0; k < n; ++k) out[k] += std::log(a[k]);
+            };
+            T half = adaptiveGaussKronrod<T>(regular, 0.0, a0, quadTol, quadDepth, workspace) - (a0 * std::log(a0) - a0);
+            if (a0 < LfDValue) half += adaptiveGaussKronrod<T>(integrand, a0, LfDValue, quadTol, quadDepth, workspace);
+            T value = 2.0 * half;
+            if (KernelScalar<T>::hasTangent(LfD)) addLimitDerivative(value, 2.0 * boundaryValue(LfDValue), LfD);
+            return value;
+        }
+        // 互感应项
+        T value = adaptiveGaussKronrod<T>(integrand, -LfDValue, LfDValue, quadTol, quadDepth, workspace);
+        if (KernelScalar<T>::hasTangent(LfD)) addLimitDerivative(value, boundaryValue(LfDValue) + boundaryValue(-LfDValue), LfD);
+        return value;
+    };
+
+    if (isUniformFractureLayout(xwD)) {
+        // [Toeplitz 装配] 节点等间距分布时 A(i,j) 只与 |i-j| 有关：
+        // 积分区间 [-LfD, LfD] 关于 a 对称，offset 与 -offset 的积分值相同。
+        // 因此只需计算 nf 个不同的偏移积分，积分量由 nf^2 降为 nf；段数较多时方程组同样按 Toeplitz 结构求解。
+        QVector<T>& diagValues = kernelWorkspace.diagonal;
+        diagValues.resize(nf);
+        for (int k = 0; k < nf; ++k) {
+            double offset = xwD[k] - xwD[0];
+            diagValues[k] = influenceIntegral(offset, k == 0) * scale;
+        }
+        return solveUniformFractureSystem(diagValues, nf, z);
+    } else {
+        // [完整装配] 非均匀裂缝布局：逐个元素积分
+        influence.resize(nf * nf);
+        for (int i = 0; i < nf; ++i) {
+            for (int j = 0; j < nf; ++j) {
+                influence[i * nf + j] = influenceIntegral(xwD[i] - xwD[j], i == j) * scale;
+            }
+        }
     }
-    A_mat(nf, nf) = 0.0;
 
-    // 求解线性方程组
-    // 返回 pf = A矩阵解的最后一个元素 (即井底压力 pwd)
-    // 使用 FullPivLu 提高病态矩阵的求解稳定性
-    Eigen::VectorXd x_sol = A_mat.fullPivLu().solve(b_vec);
-    return x_sol(nf);
+    // 加边求解：返回 pf = 解向量的最后一个元素 (即井底压力 pwd)
+    return solveBorderedSystem(influence, nf, z);
 }
 
-double ModelSolver01_06::scaled_besseli(int v, double x) {
-    return safe_bessel_i_scaled(v, x);
-}
+bool ModelSolver01_06::isUniformFractureLayout(const QVector<double>& xwD) {
+    int nf = xwD.size();
+    if (nf < 3) return true; // 1~2 个节点时矩阵天然为 Toeplitz 结构
 
-double ModelSolver01_06::gauss15(std::function<double(double)> f, double a, double b) {
-    static const double X[] = { 0.0, 0.201194, 0.394151, 0.570972, 0.724418, 0.848207, 0.937299, 0.987993 };
-    static const double W[] = { 0.202578, 0.198431, 0.186161, 0.166269, 0.139571, 0.107159, 0.070366, 0.030753 };
-    double h = 0.5 * (b - a); double c = 0.5 * (a + b); double s = W[0] * f(c);
-    for (int i = 1; i < 8; ++i) { double dx = h * X[i]; s += W[i] * (f(c - dx) + f(c + dx)); }
-    return s * h;
+    // 判断相邻节点间距是否一致 (允许浮点舍入误差)
+    double step = xwD[1] - xwD[0];
+    double tol = 1e-9 * std::max(1.0, std::abs(step));
+    for (int i = 2; i < nf; ++i) {
+        if (std::abs((xwD[i] - xwD[i - 1]) - step) > tol) return false;
+    }
+    return true;
 }
 
-double ModelSolver01_06::adaptiveGauss(std::function<double(double)> f, double a, double b, double eps, int depth, int maxDepth) {
-    double c = (a + b) / 2.0; double v1 = gauss15(f, a, b); double v2 = gauss15(f, a, c) + gauss15(f, c, b);
-    if (depth >= maxDepth || std::abs(v1 - v2) < eps * (std::abs(v2) + 1.0)) return v2;
-    return adaptiveGauss(f, a, c, eps/2, depth+1, maxDepth) + adaptiveGauss(f, c, b, eps/2, depth+1, maxDepth);
+double ModelSolver01_06::scaled_besseli(int v, double x) {
+    return safe_bessel_i_scaled(v, x);
 }
 
-double ModelSolver01_06::stefestCoefficient(int i, int N) {
-    double s = 0.0; int k1 = (i + 1) / 2; int k2 = std::min(i, N / 2);
-    for (int k = k1; k <= k2; ++k) {
-        double num = pow(k, N / 2.0) * factorial(2 * k);
-        double den = factorial(N / 2 - k) * factorial(k) * factorial(k - 1) * factorial(i - k) * factorial(2 * k - i);
-        if(den!=0) s += num/den;
+template <typename T, typename F>
+T ModelSolver01_06::gaussKronrod15(const F& f, double a, double b, T& gauss7) {
+    // Kronrod 节点 (降序，最后一个为中点) 与权重，奇数下标节点同时为 7 点 Gauss 节点
+    static const double XGK[] = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.0
+    };
+    static const double WGK[] = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+    };
+    static const double WG[] = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+    };
+
+    double h = 0.5 * (b - a); double c = 0.5 * (a + b);
+    // 15 个节点按 (c, c-dx1, c+dx1, ...) 排列后一次求值
+    double nodes[15];
+    T values[15];
+    nodes[0] = c;
+    for (int i = 0; i < 7; ++i) { double dx = h * XGK[i]; nodes[2 * i + 1] = c - dx; nodes[2 * i + 2] = c + dx; }
+    f(nodes, values, 15);
+
+    T kronrod = WGK[7] * values[0];
+    T gauss = WG[3] * values[0];
+    for (int i = 0; i < 7; ++i) {
+        T pair = values[2 * i + 1] + values[2 * i + 2];
+        kronrod += WGK[i] * pair;
+        if (i % 2 == 1) gauss += WG[i / 2] * pair;
     }
-    return ((i + N / 2) % 2 == 0 ? 1.0 : -1.0) * s;
+    gauss7 = gauss * h;
+    return kronrod * h;
 }
 
-double ModelSolver01_06::factorial(int n) {
-    if(n<=1)return 1;
-    double r=1;
-    for(int i=2;i<=n;++i) r*=i;
-    return r;
+template <typename T, typename F>
+T ModelSolver01_06::adaptiveGaussKronrod(const F& f, double a, double b, double eps, int maxDepth, QuadratureWorkspace& ws) {
+    WT_TRACE_SCOPE("ModelSolver::adaptiveGaussKronrod");
+    using std::abs;
+    // 深度优先处理待细分区间：K15 与内嵌 G7 之差满足容差即接受该面板，否则二分后入栈
+    // 子区间容差减半 (与原递归实现的 eps/2 一致)，达到最大深度或工作区将满时直接接受
+    maxDepth = std::min(maxDepth, (int)QuadratureWorkspace::Capacity - 2);
+    T total = 0.0;
+    int top = 0;
+    ws.lower[0] = a; ws.upper[0] = b; ws.tolerance[0] = eps; ws.depth[0] = 0;
+    top = 1;
+    while (top > 0) {
+        --top;
+        double lo = ws.lower[top], hi = ws.upper[top], tol = ws.tolerance[top];
+        int depth = ws.depth[top];
+
+        T gauss7;
+        T kronrod = gaussKronrod15<T>(f, lo, hi, gauss7);
+        if (depth >= maxDepth || abs(kronrod - gauss7) < tol * (abs(kronrod) + 1.0)) {
+            total += kronrod;
+            continue;
+        }
+        double mid = 0.5 * (lo + hi);
+        // 右半区间先入栈，左半区间先处理
+        ws.lower[top] = mid; ws.upper[top] = hi; ws.tolerance[top] = tol / 2; ws.depth[top] = depth + 1; ++top;
+        ws.lower[top] = lo; ws.upper[top] = mid; ws.tolerance[top] = tol / 2; ws.depth[top] = depth + 1; ++top;
+    }
+    return total;
 }
@@ -6,6 +6,31 @@
  * 2. 声明纯数学计算逻辑，包括拉普拉斯变换、贝塞尔函数计算、Stehfest 数值反演等。
  * 3. 实现了计算结果的容器定义，不依赖任何 UI 控件，仅负责数据输入与结果输出。
  * 4. 提供6种理论模型的解算接口，算法逻辑已根据MATLAB原型（modelwidget1A-6A）进行严格对齐。
+ * 5. 定义预解析参数块 ModelParams，计算内核不再直接访问 QMap 参数字典。
+ * 6. 支持时间点并行反演，并提供串行作用域守卫供已处于并行任务中的调用方使用。
+ * 7. 数值反演方法可在 Stehfest / Talbot / de Hoog / Euler 之间切换 (见 laplaceinversion.h)。
+ * 8. 像函数值按无因次输入全局缓存 (见 laplacecache.h)，跨曲线计算、迭代及雅可比矩阵列复用。
+ * 9. 提供理论曲线对各物理参数的解析敏感度 (前向自动微分，见 sensitivityjet.h)，供拟合雅可比矩阵使用。
+ * 10. 裂缝积分按 Gauss 面板批量求值被积函数，实数 Bessel 函数由 BesselBatch 批量计算 (见 besselbatch.h)。
+ * 11. 自适应积分改为模板化 G7-K15 公式 + 显式工作区 (QuadratureWorkspace)，无类型擦除与堆分配。
+ * 12. 提供多参数组批量计算接口 calculateTheoreticalCurvesBatch，供敏感性分析与多分析对比使用。
+ * 13. 可选的类型曲线库快速路径：制表范围内的查询直接插值无因次曲线 (见 typecurvelibrary.h)。
+ * 14. 六种模型按 外边界策略 × 井储策略 的模板组合实例化，构造时按模型类型选定一次内核函数表，
+ *    热路径中不再按 m_type 分支；新增模型只需增加策略组合与函数表条目。
+ * 15. 可选的网格求值模式：请求时间点多于内部对数等距网格时，只在网格上反演 (Bourdet 导数也在网格上计算)，
+ *    再以双对数单调三次插值给出请求时间点的压力与导数，并记录插值误差估计 (见 curveinterpolation.h)。
+ * 16. Laplace 内核的早期 (裂缝线性流) 渐近解与晚期 (Bessel 小参数级数) 解析积分快速路径，
+ *    按 Bessel 参数与几何尺度自动选用，各路径调用次数计入 KernelRegimeStatistics。
+ * 17. 可选的精度控制模式：逐时间点比较相邻反演阶数 (及裂缝积分容差) 的结果估计误差，
+ *    只在未达到目标误差 (由 setHighPrecision 决定) 的时间点提高分辨率。
+ * 18. 支持协作式取消：调用线程登记 CancellationToken::Scope 后，计算在 Laplace 节点粒度上响应取消与截止时间。
+ * 19. 参数中未给出 nf 时的裂缝离散段数为全局默认值 (setDefaultFractureSegments，默认 10，上限 256)。
+ * 20. 等间距裂缝节点且段数较多 (nf ≥ 24) 时，加边方程组按对称 Toeplitz 结构以 Levinson 递推求解 (O(nf²))，
+ *    多段长水平井的单个 Laplace 节点代价由 O(nf³) 降为 O(nf²)。
+ * 21. 可选的混合精度模式：Stehfest 反演的舍入放大系数表明双精度不足的时间点，改用收紧的裂缝积分与双双精度加权求和。
+ * 22. 可选的节点共享模式：内部网格取二进网格，各时间点的 Stehfest 节点按位去重，每个不同的 Laplace 节点只求一次像函数。
+ * 23. 实数节点的像函数按组批量求值 (flaplaceCompositeBatch)：边界项以结构数组分趟计算，再逐节点求解裂缝方程组。
+ * 24. 多参数组批量计算可把实数节点的储层响应卸载到设备后端 (LaplaceBatchBackend，可选 OpenCL)，并自动回退到 CPU。
  */
 
 #ifndef MODELSOLVER01_06_H
@@ -14,12 +39,82 @@
 #include <QMap>
 #include <QVector>
 #include <QString>
+#include <QStringList>
 #include <tuple>
 #include <functional>
+#include "laplaceinversion.h"
+
+// 自适应积分工作区：待处理子区间栈 (固定容量，深度优先处理时栈深不超过 maxDepth + 1)
+struct QuadratureWorkspace {
+    enum { Capacity = 48 };
+    double lower[Capacity];
+    double upper[Capacity];
+    double tolerance[Capacity];
+    int depth[Capacity];
+};
 
 // 类型定义: <时间序列, 压力序列, 导数序列>
 using ModelCurveData = std::tuple<QVector<double>, QVector<double>, QVector<double>>;
 
+// 预解析的模型参数块：由 QMap 参数字典一次性解析得到，供 Laplace 核函数热路径直接读取
+// 所有长度量均已无因次化 (以 L 为参考长度)，裂缝节点坐标 xwD 也已预先生成
+struct ModelParams {
+    double M12 = 1.0;       // 内外区流度比
+    double LfD = 0.1;       // 无因次裂缝半长
+    double rmD = 0.5;       // 无因次内区半径
+    double reD = 20.0;      // 无因次外边界半径
+    double omega1 = 0.4;    // 内区储容比
+    double omega2 = 0.08;   // 外区储容比
+    double lambda1 = 1e-3;  // 内区窜流系数
+    double lambda2 = 1e-4;  // 外区窜流系数
+    double eta12 = 0.2;     // 导压系数比
+    double cD = 0.0;        // 无因次井储系数
+    double S = 0.0;         // 表皮系数
+    double gamaD = 0.0;     // 压敏系数
+    int N = 10;             // Stehfest 反演项数 (偶数, 4~18)
+    int inversion = -1;     // 数值反演方法 (LaplaceInversion::Method)，-1 表示使用求解器默认方法
+    int inversionOrder = 0; // 非 Stehfest 方法的阶数 M，0 表示使用默认阶数
+    int nf = 10;            // 裂缝离散段数
+    QVector<double> xwD;    // 裂缝节点无因次坐标 (linspace(-0.9, 0.9, nf))
+
+    // 渐近快速路径阈值 (见 ModelSolver01_06::setAsymptoticRegimes)，0 表示关闭对应路径
+    double earlyArgument = 30.0; // 早期：Re(γ1)·d_min 不小于该值时按裂缝线性流渐近解计算
+    double lateArgument = 4.0;   // 晚期：|γ1|·d_max 不大于该值时影响矩阵按 Bessel 小参数级数解析积分
+
+    // 裂缝影响积分的自适应 Gauss-Kronrod 容差与最大二分深度 (精度控制模式下逐级收紧)
+    double quadratureTolerance = 1e-6;
+    int quadratureDepth = 5;
+
+    // 敏感度计算：参与前向自动微分的无因次核函数参数
+    enum KernelParam {
+        Kernel_M12 = 0, Kernel_LfD, Kernel_rmD, Kernel_reD,
+        Kernel_omega1, Kernel_omega2, Kernel_lambda1, Kernel_lambda2,
+        Kernel_eta12, Kernel_cD, Kernel_S,
+        KernelParamCount
+    };
+    // sensitivitySlot[k] 为第 k 个核函数参数对应的导数分量下标，-1 表示该参数不求导
+    int sensitivitySlot[KernelParamCount] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+    int sensitivityCount = 0; // 导数分量总数
+};
+
+// 理论曲线的参数敏感度：dP[j][i] / dD[j][i] 为第 i 个时间点的压力 / 导数对参数 names[j] 的偏导数
+struct ModelSensitivity {
+    QVector<double> t;               // 时间序列
+    QVector<double> p;               // 理论压力 (与 calculateTheoreticalCurve 一致)
+    QVector<double> d;               // 理论导数
+    QStringList names;               // 参数名
+    QVector<QVector<double>> dP;     // 压力敏感度
+    QVector<QVector<double>> dD;     // 导数敏感度
+    QVector<bool> analytic;          // false 表示该参数为离散量 (如 nf、N)，调用方需回退为差分
+};
+
+// 像函数求值区间统计：各路径 (完整积分 / 早期渐近 / 晚期级数) 的 PWD_composite 调用次数
+struct KernelRegimeStatistics {
+    qint64 full = 0;  // 完整 Bessel 积分 + 加边方程组求解
+    qint64 early = 0; // 早期裂缝线性流渐近解 (无 Bessel 积分与 LU 分解)
+    qint64 late = 0;  // 晚期小参数级数积分 (无 Bessel 积分)
+};
+
 class ModelSolver01_06
 {
 public:
@@ -41,53 +136,236 @@ public:
     explicit ModelSolver01_06(ModelType type);
     virtual ~ModelSolver01_06();
 
-    // 设置计算精度（高精度模式下Stehfest项数N取值更大）
+    // 设置计算精度：高精度 / 低精度分别对应精度控制模式的目标相对误差 1e-5 / 1e-3
+    // (拟合迭代期使用低精度，最终曲线使用高精度；未开启精度控制模式时反演阶数仍由参数 N 决定)
     void setHighPrecision(bool high);
 
+    // 精度控制模式 (默认读取设置项 solver/accuracyControl，未设置时关闭)：
+    // 每个时间点从低阶反演开始，以相邻两级阶数的结果之差估计误差，未达到目标误差时逐级提高反演阶数；
+    // 提高阶数不再减小差值 (截断误差已让位于像函数舍入误差) 时，收紧裂缝积分容差后重新逐级比较。
+    // 参数中的 N / inversionOrder 在该模式下不再使用 (敏感度接口仍按固定阶数计算；批量接口逐条改走单曲线路径)
+    void setAccuracyControl(bool enabled);
+    bool isAccuracyControl() const;
+    double targetTolerance() const;
+
+    // 精度控制模式下最近一次计算各时间点 (网格求值时为网格点) 的相对误差估计，未开启时为空
+    QVector<double> lastErrorEstimates() const;
+
+    // 混合精度模式 (默认读取设置项 solver/mixedPrecision，未设置时关闭)，只作用于 Stehfest 反演：
+    // 每个时间点先按双精度反演，以舍入放大系数 Σ|V_i·F_i| / |f| 乘像函数的典型相对精度估计误差，
+    // 超过目标误差 (由 setHighPrecision 决定) 的点 (多为晚期边界控制段) 以收紧的裂缝积分容差重算像函数，
+    // 再以双双精度系数与累加求和；其余时间点保持原有的双精度计算。精度控制模式开启时不再另行处理
+    void setMixedPrecision(bool enabled);
+    bool isMixedPrecision() const;
+    // 最近一次 calculatePDandDeriv 中改用扩展精度的时间点数
+    int lastExtendedPrecisionPoints() const;
+
+    // 节点共享模式 (默认读取设置项 solver/sharedLaplaceNodes，未设置时关闭)，只作用于 Stehfest 反演：
+    // calculatePDandDeriv 汇总全部时间点的节点 m·ln2/t，相同的 z 只求一次像函数；网格求值时改用二进网格
+    // (未设置网格密度时按每个对数周期 20 点)，相隔一个倍程的网格点的偶数阶节点逐位重合。精度控制模式开启时不生效
+    void setSharedLaplaceNodes(bool enabled);
+    bool isSharedLaplaceNodes() const;
+
+    // 像函数插值模式 (默认读取设置项 solver/laplaceInterpolation，未设置时关闭)，只作用于实数节点方法：
+    // calculatePDandDeriv 先以精确像函数在 ln z 上建立带误差控制的分段 Chebyshev 插值表 (LaplaceInterpolant)，
+    // 各时间点的节点值由插值给出；复数节点方法与精度控制模式下不生效，建表失败时按原路径逐节点求值
+    void setLaplaceInterpolation(bool enabled);
+    bool isLaplaceInterpolation() const;
+    // 最近一次 calculatePDandDeriv 建表调用精确像函数的次数 (未使用插值时为 0)，以及建表是否未收敛而改为逐节点求值
+    int lastInterpolationKernelEvaluations() const;
+    bool lastInterpolationFellBack() const;
+
+    // 设置数值反演方法 (默认读取设置项 solver/inversionMethod，未设置时为 Stehfest)
+    // order 对 Stehfest 无效 (由参数 N 控制)，对其他方法为阶数 M，0 表示默认阶数
+    void setInversionMethod(LaplaceInversion::Method method, int order = 0);
+    LaplaceInversion::Method inversionMethod() const;
+
+    // 设置是否并行计算各时间点的 Stehfest 反演 (默认开启，结果顺序与串行一致)
+    void setParallelEvaluation(bool enabled);
+    bool isParallelEvaluation() const;
+
+    // 设置是否启用类型曲线库快速路径 (默认关闭)：查询点位于已加载库的制表范围内时，
+    // calculateTheoreticalCurve / 批量接口直接插值无因次曲线，不再进行数值反演 (见 typecurvelibrary.h)
+    void setTypeCurveLibraryEnabled(bool enabled);
+    bool isTypeCurveLibraryEnabled() const;
+
+    // 设置网格求值模式 (默认读取设置项 solver/gridPointsPerDecade，0 表示关闭)：
+    // calculateTheoreticalCurve / 批量接口的请求时间点多于每个对数周期 pointsPerDecade 点的内部网格时，
+    // 只在网格上反演并插值到请求时间点 (敏感度接口始终在请求时间点上精确计算)
+    void setGridEvaluation(int pointsPerDecade);
+    int gridPointsPerDecade() const;
+
+    // 最近一次网格求值的插值最大相对误差估计 (压力与导数取大者；未使用网格时为 0)
+    double lastGridInterpolationError() const;
+
+    // 设置 Laplace 内核的渐近快速路径阈值 (默认读取设置项 solver/asymptoticEarlyArgument 与
+    // solver/asymptoticLateArgument，取值 30 与 4)，阈值为 0 时关闭对应路径：
+    // 早期 (大 z)：Re(γ1)·d_min >= earlyArgument 时裂缝间、裂缝端部外及复合界面处的 Bessel 项均低于 exp(-earlyArgument)，
+    //   各裂缝为互不干扰的线性流，pf = π / (2·M12·LfD·nf·z·γ1)，不再计算 Bessel 积分与加边方程组；
+    // 晚期 (小 z)：|γ1|·d_max <= lateArgument 时 K0/I0 按小参数级数逐项解析积分，代替自适应 Gauss-Kronrod 积分。
+    // γ1 = sqrt(z·fs1)，d_min / d_max 为裂缝几何决定的最小 / 最大作用距离；Stehfest 节点的 z·tD 为固定常数，
+    // 因此按 Bessel 参数 (扩散长度与几何尺度之比) 而不是 z·tD 判断区间
+    void setAsymptoticRegimes(double earlyArgument, double lateArgument);
+    double asymptoticEarlyArgument() const;
+    double asymptoticLateArgument() const;
+
+    // 全部求解器实例累计的求值区间统计 (原子计数) 及清零
+    static KernelRegimeStatistics kernelRegimeStatistics();
+    static void resetKernelRegimeStatistics();
+
+    // 串行作用域守卫：调用方自身已处于并行任务中 (如雅可比矩阵各列并行) 时，
+    // 在当前线程内构造该对象，作用域内的曲线计算强制串行执行，避免线程池嵌套过度订阅
+    class ScopedSerialEvaluation {
+    public:
+        ScopedSerialEvaluation();
+        ~ScopedSerialEvaluation();
+        // 当前线程是否处于串行作用域内 (供其他模块的并行计算同样回退为串行)
+        static bool isActive();
+    private:
+        bool m_previous;
+    };
+
     // 核心计算接口：根据输入的物理参数和时间序列计算理论压力和导数曲线
     // 参数 params: 包含 kf, M12, phi, mu, L, Lf, omega1/2, lambda1/2, eta 等物理参数的字典
     // 参数 providedTime: 如果为空，则自动生成对数时间步长
     ModelCurveData calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>());
 
+    // 批量接口：多组参数共用同一时间序列，结果顺序与 paramSets 一致，逐条与 calculateTheoreticalCurve 相同
+    // 全部 (参数组, 时间点, 反演节点) 像函数求值合并为一次并行调度；仅 cD/S/gamaD 及 q/B/h 不同的参数组
+    // 共享同一组无因次节点与储层响应 (Bessel/积分/加边方程组)，只分别叠加井储表皮并反演；
+    // 开启精度控制、混合精度、节点共享或像函数插值模式时不分组，逐条按 calculateTheoreticalCurve 的单曲线路径计算
+    QVector<ModelCurveData> calculateTheoreticalCurvesBatch(const QVector<QMap<QString, double>>& paramSets,
+                                                            const QVector<double>& providedTime = QVector<double>());
+
+    // 敏感度接口：一次计算同时给出理论曲线及其对 names 中各参数的偏导数
+    // Laplace 核函数以前向自动微分求值，每个 Laplace 节点只做一次 LU 分解；
+    // q/B/h、kf/phi/mu/Ct/L 的缩放与时间换算部分及 gamaD 摄动按解析公式链式求导
+    ModelSensitivity calculateCurveSensitivity(const QMap<QString, double>& params, const QStringList& names,
+                                               const QVector<double>& providedTime = QVector<double>());
+
+    // 无因次接口：直接按参数块计算 pD 与 Bourdet 导数 (始终数值反演，供类型曲线库离线生成使用)
+    void calculateDimensionlessCurve(const QVector<double>& tD, const ModelParams& params,
+                                     QVector<double>& outPD, QVector<double>& outDeriv);
+
     // 静态辅助函数：获取模型对应的中文名称，用于UI显示
     static QString getModelName(ModelType type);
 
     // 静态辅助函数：生成对数分布的时间步长序列（用于生成平滑的对数坐标曲线）
     static QVector<double> generateLogTimeSteps(int count, double startExp, double endExp);
 
+    // 静态辅助函数：将 UI 层的参数字典解析为强类型参数块 (含默认值、N/nf 校验及 xwD 节点生成)
+    static ModelParams resolveParams(const QMap<QString, double>& params);
+
+    // 参数中未给出 nf (或 nf < 4) 时使用的裂缝离散段数 (全局，默认 10，设置项 solver/defaultFractureSegments)
+    static void setDefaultFractureSegments(int nf);
+    static int defaultFractureSegments();
+
+    // 实数节点上的储层响应 (不含井储表皮) 逐点计算，参数块须已由 resolveParams 解析；
+    // 供 LaplaceBatchBackend 的 CPU 补算与跨后端精度比对使用
+    static void evaluateReservoirBatch(ModelType type, const ModelParams& p, const double* z, double* out, int n);
+
 private:
-    // 内部函数：通过Stehfest数值反演算法，计算无因次压力(PD)和无因次导数(Deriv)
+    // 内部函数：calculateTheoreticalCurve / calculateTheoreticalCurvesBatch 在给定时间点上的直接计算
+    ModelCurveData calculateCurveDirect(const QMap<QString, double>& params, const QVector<double>& tPoints);
+    QVector<ModelCurveData> calculateCurvesBatchDirect(const QVector<QMap<QString, double>>& paramSets,
+                                                       const QVector<double>& tPoints);
+
+    // 内部函数：网格求值模式适用时 (已开启且网格点数少于请求点数) 生成内部网格并返回 true
+    bool gridEvaluationApplies(const QVector<double>& tPoints, QVector<double>& grid) const;
+
+    // 内部函数：将求解器的渐近路径阈值写入参数块 (resolveParams 之后调用)
+    void applyAsymptoticRegimes(ModelParams& params) const;
+
+    // 内部函数：将网格上的曲线插值到请求时间点，并更新插值误差估计
+    ModelCurveData resampleFromGrid(const ModelCurveData& gridCurve, const QVector<double>& tPoints);
+
+    // 内部函数：通过数值反演算法 (默认 Stehfest)，计算无因次压力(PD)和无因次导数(Deriv)
     // 根据 MATLAB 逻辑，默认 N=10 (MATLAB文件示例中为4，但为了稳定性建议保持较高精度，参数可控)
-    void calculatePDandDeriv(const QVector<double>& tD, const QMap<QString, double>& params,
-                             std::function<double(double, const QMap<QString, double>&)> laplaceFunc,
+    void calculatePDandDeriv(const QVector<double>& tD, const ModelParams& params,
                              QVector<double>& outPD, QVector<double>& outDeriv);
 
+    // 内部函数：类型曲线库快速路径 (含压敏摄动)，查询点不在任何已加载库的范围内时返回 false
+    bool interpolateFromLibrary(const QVector<double>& tD, const ModelParams& params,
+                                QVector<double>& outPD, QVector<double>& outDeriv) const;
+
+    // 内部函数：按参数块与求解器默认设置选择数值反演引擎
+    const LaplaceInversion* inversionEngine(const ModelParams& params) const;
+
     // 内部函数：拉普拉斯空间下的复合模型总函数 (包含双重介质、井储和表皮效应)
     // 修正：此处逻辑已更新为匹配 Composite_shale_oil_reservoir_fitfun 中的 fs1/fs2 算法
-    double flaplace_composite(double z, const QMap<QString, double>& p);
+    // 模板参数 T 为 double (实数节点) 或 std::complex<double> (复数节点反演)
+    // 经构造时选定的内核函数表调用当前模型的策略实例
+    template <typename T>
+    T flaplace_composite(T z, const ModelParams& p) const;
+
+    // 内部函数：同一参数块下一组实数节点的批量像函数 (结构数组分趟计算边界项，再逐节点求解裂缝方程组)，
+    // out[i] 与 flaplace_composite<double>(z[i], p) 逐位一致
+    void flaplaceCompositeBatch(const double* z, double* out, int n, const ModelParams& p) const;
+
+    // 内部函数：flaplace_composite 的两部分——储层响应 (fs1/fs2 + 点源解) 与井储表皮叠加
+    // 二者组合与 flaplace_composite 逐位一致，批量计算据此在 cD/S 不同的参数组之间复用储层响应
+    template <typename T>
+    T reservoirKernel(T z, const ModelParams& p) const;
+    template <typename T>
+    T applyWellboreStorage(T z, T pf, const ModelParams& p) const;
+
+    // 内核函数表：各数值类型下当前模型的 Laplace 函数、储层响应与井储叠加 (定义见 .cpp)
+    struct KernelTable;
+    static const KernelTable& kernelTable(ModelType type);
+
+    // 策略实例：Boundary 为外边界策略 (无限大 / 封闭 / 定压)，Storage 为井储策略 (有 / 无井储)
+    template <typename T, typename Boundary, typename Storage>
+    static T compositeLaplace(T z, const ModelParams& p);
+    template <typename T, typename Boundary>
+    static T compositeReservoir(T z, const ModelParams& p);
+    template <typename Boundary, typename Storage>
+    static void compositeLaplaceBatch(const double* z, double* out, int n, const ModelParams& p);
 
     // 内部函数：计算点源解的拉普拉斯变换值 (求解裂缝流量分布矩阵)
-    // 实现了 PWD_inf / PWD_composite 的核心积分方程求解
-    double PWD_composite(double z, double fs1, double fs2, double M12, double LfD, double rmD, double reD, int nf, const QVector<double>& xwD, ModelType type);
+    // 实现了 PWD_inf / PWD_composite 的核心积分方程求解，外边界项由 Boundary 策略在编译期确定
+    template <typename T, typename Boundary>
+    static T PWD_composite(T z, T fs1, T fs2, const ModelParams& p);
 
-    // 数学辅助函数：计算缩放的第一类修正贝塞尔函数 I_v(x) * exp(-|x|)
-    double scaled_besseli(int v, double x);
+    // 内部函数：PWD_composite 的后半部分——由 γ1 与 Ac 前因子装配裂缝影响矩阵并求解加边方程组 (含晚期级数路径)
+    template <typename T>
+    static T fractureSystemResponse(T z, T gama1, T arg_g1_rm, T Ac_prefactor, double dMax, const ModelParams& p);
 
-    // 数学辅助函数：15点高斯积分公式
-    double gauss15(std::function<double(double)> f, double a, double b);
+    // 内部函数：判断裂缝节点是否等间距分布 (等间距时影响矩阵为 Toeplitz 结构)
+    static bool isUniformFractureLayout(const QVector<double>& xwD);
 
-    // 数学辅助函数：自适应高斯积分，用于处理裂缝沿线的积分计算
-    double adaptiveGauss(std::function<double(double)> f, double a, double b, double eps, int depth, int maxDepth);
+    // 数学辅助函数：计算缩放的第一类修正贝塞尔函数 I_v(x) * exp(-|x|)
+    double scaled_besseli(int v, double x);
 
-    // 数学辅助函数：计算Stehfest反演系数
-    double stefestCoefficient(int i, int N);
+    // 数学辅助函数：15 点 Gauss-Kronrod 积分公式，同时返回内嵌 7 点 Gauss 结果作为误差估计
+    // 被积函数为批量形式 f(nodes, values, n)：一次求出一个面板全部节点的函数值 (直接接受任意可调用对象)
+    template <typename T, typename F>
+    static T gaussKronrod15(const F& f, double a, double b, T& gauss7);
 
-    // 数学辅助函数：计算阶乘
-    double factorial(int n);
+    // 数学辅助函数：自适应 Gauss-Kronrod 积分，用于处理裂缝沿线的积分计算
+    // 每个面板只求值一次，待细分区间保存在调用方提供的工作区中，不做递归与堆分配
+    template <typename T, typename F>
+    static T adaptiveGaussKronrod(const F& f, double a, double b, double eps, int maxDepth, QuadratureWorkspace& ws);
 
 private:
     ModelType m_type;       // 当前选择的模型类型
+    const KernelTable* m_kernels; // 当前模型的内核函数表 (构造时选定)
     bool m_highPrecision;   // 高精度计算标志
+    bool m_parallelEvaluation; // 时间点并行计算标志
+    LaplaceInversion::Method m_inversionMethod; // 默认数值反演方法
+    int m_inversionOrder;   // 默认反演阶数 (非 Stehfest 方法)
+    bool m_useTypeCurveLibrary; // 类型曲线库快速路径开关
+    int m_gridPointsPerDecade;  // 网格求值模式每个对数周期的点数 (0 表示关闭)
+    double m_lastGridError;     // 最近一次网格求值的插值误差估计
+    double m_asymptoticEarly;   // 早期渐近路径阈值 (0 表示关闭)
+    double m_asymptoticLate;    // 晚期级数路径阈值 (0 表示关闭)
+    bool m_accuracyControl;     // 精度控制模式开关
+    bool m_mixedPrecision;      // 混合精度模式开关
+    int m_lastExtendedPoints;   // 最近一次改用扩展精度的时间点数
+    bool m_sharedLaplaceNodes;  // 节点共享模式开关
+    bool m_laplaceInterpolation; // 像函数插值模式开关
+    int m_lastInterpolationEvaluations; // 最近一次插值建表的像函数调用次数
+    bool m_lastInterpolationFallback;   // 最近一次插值建表未收敛 (已改为逐节点求值)
+    QVector<double> m_lastErrorEstimates; // 最近一次精度控制计算的逐点误差估计
 };
 
 #endif // MODELSOLVER01_06_H
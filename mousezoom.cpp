@@ -3,12 +3,25 @@
 #include <QMenu>
 #include <QAction>
 #include <QKeyEvent>
+#include <QSettings>
+#include <QDebug>
 #include <cmath>
 
+namespace {
+
+const int kDefaultOpenGlSamples = 8;
+
+int s_openGlEnabled = -1;      // -1: 尚未读取设置
+bool s_openGlFailed = false;   // 本进程内 OpenGL 初始化失败过，不再尝试 (重新打开开关时清除)
+QList<MouseZoom*> s_instances;
+
+} // namespace
+
 MouseZoom::MouseZoom(QWidget *parent)
     : QCustomPlot(parent)
     , m_isUpPressed(false)
     , m_isDownPressed(false)
+    , m_openGlSamples(kDefaultOpenGlSamples)
 {
     setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectItems);
     setContextMenuPolicy(Qt::CustomContextMenu);
@@ -16,10 +29,86 @@ MouseZoom::MouseZoom(QWidget *parent)
 
     // 确保组件能接收键盘事件
     setFocusPolicy(Qt::StrongFocus);
+
+    // 重绘结束后检查上下文是否丢失 (排队执行：afterReplot 发出时仍处于重绘过程中)
+    connect(this, &QCustomPlot::afterReplot, this, &MouseZoom::onAfterReplot, Qt::QueuedConnection);
+    s_instances.append(this);
 }
 
 MouseZoom::~MouseZoom()
 {
+    s_instances.removeOne(this);
+}
+
+void MouseZoom::setOpenGlEnabled(bool enabled)
+{
+    if (enabled) s_openGlFailed = false; // 用户重新打开时允许再试一次
+    if (s_openGlEnabled == int(enabled)) return;
+    s_openGlEnabled = enabled;
+    for (MouseZoom* plot : s_instances) plot->applyRenderMode(plot->isVisible());
+}
+
+bool MouseZoom::isOpenGlEnabled()
+{
+    if (s_openGlEnabled < 0) {
+        QSettings settings("WellTestPro", "WellTestAnalysis");
+        s_openGlEnabled = settings.value("plot/openGl", false).toBool();
+    }
+    return s_openGlEnabled;
+}
+
+void MouseZoom::setOpenGlSamples(int samples)
+{
+    samples = qMax(0, samples);
+    if (samples == m_openGlSamples) return;
+    m_openGlSamples = samples;
+    if (openGl()) {
+        // 采样数只在建立上下文时生效
+        setOpenGl(false);
+        applyRenderMode(isVisible());
+    }
+}
+
+void MouseZoom::applyRenderMode(bool visible)
+{
+#ifdef QCP_OPENGL_FBO
+    // 不可见的图表 (被遮挡的页签、最小化的子窗口) 不占用显存
+    const bool wanted = visible && isOpenGlEnabled() && !s_openGlFailed;
+    if (wanted == openGl()) return;
+    setOpenGl(wanted, m_openGlSamples);
+    if (wanted && !openGl()) {
+        s_openGlFailed = true;
+        qDebug() << "MouseZoom: OpenGL 初始化失败，改用软件绘图";
+    }
+    if (visible) replot(rpQueuedReplot);
+#else
+    Q_UNUSED(visible)
+#endif
+}
+
+void MouseZoom::showEvent(QShowEvent *event)
+{
+    QCustomPlot::showEvent(event);
+    applyRenderMode(true);
+}
+
+void MouseZoom::hideEvent(QHideEvent *event)
+{
+    QCustomPlot::hideEvent(event);
+    applyRenderMode(false);
+}
+
+void MouseZoom::onAfterReplot()
+{
+#ifdef QCP_OPENGL_FBO
+    // 显卡驱动重置等导致上下文失效时回退为软件绘图，避免之后的重绘一直是空白
+    if (openGl() && (!mGlContext || !mGlContext->isValid())) {
+        s_openGlFailed = true;
+        qDebug() << "MouseZoom: OpenGL 上下文已失效，改用软件绘图";
+        setOpenGl(false);
+        replot(rpQueuedReplot);
+    }
+#endif
 }
 
 // 记录键盘按下状态
@@ -11,6 +11,12 @@ public:
     explicit MouseZoom(QWidget *parent = nullptr);
     ~MouseZoom();
 
+    // [硬件加速] 全局开关 (系统设置 plot/openGl)：立即作用于所有已创建的图表，之后创建的图表同样生效
+    static void setOpenGlEnabled(bool enabled);
+    static bool isOpenGlEnabled();
+    // 本图的 OpenGL 多重采样数 (同屏多图时调低以节省显存)
+    void setOpenGlSamples(int samples);
+
 signals:
     // 现有信号保持不变
     void saveImageRequested();
@@ -32,15 +38,25 @@ protected:
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
 
+    // [硬件加速] 隐藏时释放 OpenGL 缓冲，显示时重新建立
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
 private slots:
     void onCustomContextMenuRequested(const QPoint &pos);
+    void onAfterReplot();
 
 private:
     double distToSegment(const QPointF& p, const QPointF& s, const QPointF& e);
 
+    // 按全局开关与可见性切换 OpenGL / 软件绘图
+    void applyRenderMode(bool visible);
+
     // [新增] 记录键盘状态
     bool m_isUpPressed;
     bool m_isDownPressed;
+
+    int m_openGlSamples;
 };
 
 #endif // MOUSEZOOM_H
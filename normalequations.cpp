@@ -0,0 +1,96 @@
+/*
+ * 文件名: normalequations.cpp
+ * 文件作用: LM 法方程 (JᵀJ、Jᵀr) 的归约计算实现文件
+ * 功能描述:
+ * 1. 可复现模式的分块划分只由行数决定；块数不少于 4 时并行计算 (QtConcurrent::blockingMapped 按输入顺序返回结果)，
+ *    否则在调用线程中依次计算，两种执行方式的舍入完全相同。
+ */
+
+#include "normalequations.h"
+
+#include <QVector>
+#include <QtConcurrent>
+#include <numeric>
+
+namespace {
+
+struct Partial {
+    Eigen::MatrixXd A; // 下三角
+    Eigen::VectorXd g;
+};
+
+// 第 chunk 块 (ChunkRows 行) 的部分和；v 为空指针时不计算 g，needA 为假时不计算 A
+Partial chunkPartial(const Eigen::MatrixXd& J, const Eigen::VectorXd* v, bool needA, int chunk)
+{
+    const int n = int(J.cols());
+    const int begin = chunk * NormalEquations::ChunkRows;
+    const int end = qMin(int(J.rows()), begin + NormalEquations::ChunkRows);
+    Partial p;
+    if (needA) p.A = Eigen::MatrixXd::Zero(n, n);
+    if (v) p.g = Eigen::VectorXd::Zero(n);
+    for (int k = begin; k < end; ++k) {
+        for (int i = 0; i < n; ++i) {
+            const double jki = J(k, i);
+            if (v) p.g(i) += jki * (*v)(k);
+            if (needA) {
+                for (int j = 0; j <= i; ++j) p.A(i, j) += jki * J(k, j);
+            }
+        }
+    }
+    return p;
+}
+
+void reduceChunks(const Eigen::MatrixXd& J, const Eigen::VectorXd* v, bool needA, Eigen::MatrixXd* A, Eigen::VectorXd* g)
+{
+    const int n = int(J.cols());
+    const int chunks = int((J.rows() + NormalEquations::ChunkRows - 1) / NormalEquations::ChunkRows);
+
+    QVector<Partial> partials;
+    if (chunks >= 4) {
+        QVector<int> indices(chunks);
+        std::iota(indices.begin(), indices.end(), 0);
+        partials = QtConcurrent::blockingMapped(indices, [&](int chunk) { return chunkPartial(J, v, needA, chunk); });
+    } else {
+        for (int c = 0; c < chunks; ++c) partials.append(chunkPartial(J, v, needA, c));
+    }
+
+    if (needA) *A = Eigen::MatrixXd::Zero(n, n);
+    if (v) *g = Eigen::VectorXd::Zero(n);
+    for (const Partial& p : partials) {
+        if (needA) *A += p.A;
+        if (v) *g += p.g;
+    }
+    if (needA) {
+        for (int i = 0; i < n; ++i)
+            for (int j = i + 1; j < n; ++j) (*A)(i, j) = (*A)(j, i);
+    }
+}
+
+} // namespace
+
+void NormalEquations::build(const Eigen::MatrixXd& J, const Eigen::VectorXd& r, Eigen::MatrixXd& A, Eigen::VectorXd& g,
+                            bool reproducible)
+{
+    if (!reproducible) {
+        A.noalias() = J.transpose() * J;
+        g.noalias() = J.transpose() * r;
+        return;
+    }
+    reduceChunks(J, &r, true, &A, &g);
+}
+
+Eigen::MatrixXd NormalEquations::gram(const Eigen::MatrixXd& J, bool reproducible)
+{
+    Eigen::MatrixXd A;
+    if (!reproducible) A.noalias() = J.transpose() * J;
+    else reduceChunks(J, nullptr, true, &A, nullptr);
+    return A;
+}
+
+Eigen::VectorXd NormalEquations::transposeTimes(const Eigen::MatrixXd& J, const Eigen::VectorXd& v, bool reproducible)
+{
+    Eigen::VectorXd g;
+    if (!reproducible) g.noalias() = J.transpose() * v;
+    else reduceChunks(J, &v, false, nullptr, &g);
+    return g;
+}
@@ -0,0 +1,34 @@
+/*
+ * 文件名: normalequations.h
+ * 文件作用: LM 法方程 (JᵀJ、Jᵀr) 的归约计算头文件
+ * 功能描述:
+ * 1. 快速模式：直接使用 Eigen 的矩阵乘法 (分块大小按运行机器的缓存容量确定，向量化宽度取决于编译选项)，
+ *    求和顺序可能随机器不同而变化。
+ * 2. 可复现模式：残差行按固定的 ChunkRows 行分块 (与线程数、机器无关)，块内按行号顺序标量累加，
+ *    各块在全局线程池中并行计算后按块号顺序合并；同一程序在任意线程数下得到逐位相同的结果。
+ * 3. 只计算下三角后镜像，保证 JᵀJ 严格对称。
+ */
+
+#ifndef NORMALEQUATIONS_H
+#define NORMALEQUATIONS_H
+
+#include <Eigen/Dense>
+
+class NormalEquations
+{
+public:
+    // 可复现模式的分块行数 (改变会改变舍入，属于结果格式的一部分，不应随意调整)
+    enum { ChunkRows = 256 };
+
+    // A = JᵀJ，g = Jᵀr (r 与 J 行数相同)
+    static void build(const Eigen::MatrixXd& J, const Eigen::VectorXd& r, Eigen::MatrixXd& A, Eigen::VectorXd& g,
+                      bool reproducible);
+
+    // JᵀJ
+    static Eigen::MatrixXd gram(const Eigen::MatrixXd& J, bool reproducible);
+
+    // Jᵀv
+    static Eigen::VectorXd transposeTimes(const Eigen::MatrixXd& J, const Eigen::VectorXd& v, bool reproducible);
+};
+
+#endif // NORMALEQUATIONS_H
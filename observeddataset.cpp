@@ -0,0 +1,151 @@
+/*
+ * 文件名: observeddataset.cpp
+ * 文件作用: 不可变的观测数据集实现文件
+ * 功能描述:
+ * 1. 登记表按内容散列保存弱引用；散列相同时再逐元素比较，避免散列碰撞把不同数据当成同一份。
+ * 2. 派生视图的缓存最多保留 16 个键 (抽样设置反复修改时不无限增长)，超出时清空后重新登记。
+ */
+
+#include "observeddataset.h"
+#include "fitevaluationcache.h"
+#include <QAtomicInteger>
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+namespace {
+
+const int kMaxViews = 16;
+
+QAtomicInteger<quint64> s_lastVersion(0);
+
+QMutex& registryMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QHash<quint64, QWeakPointer<const ObservedDataset>>& registry()
+{
+    static QHash<quint64, QWeakPointer<const ObservedDataset>> datasets;
+    return datasets;
+}
+
+QJsonArray encodeValues(const QVector<double>& values)
+{
+    QJsonArray array;
+    for (double v : values) array.append(v);
+    return array;
+}
+
+QVector<double> decodeValues(const QJsonArray& array)
+{
+    QVector<double> values;
+    values.reserve(array.size());
+    for (const QJsonValue& v : array) values.append(v.toDouble());
+    return values;
+}
+
+} // namespace
+
+ObservedDataset::Handle ObservedDataset::create(const QVector<double>& time, const QVector<double>& deltaP,
+                                                const QVector<double>& derivative, const QVector<double>& rawPressure)
+{
+    ObservedDataset* dataset = new ObservedDataset;
+    dataset->m_time = time;
+    dataset->m_deltaP = deltaP;
+    dataset->m_derivative = derivative;
+    dataset->m_rawPressure = rawPressure;
+    return intern(dataset);
+}
+
+ObservedDataset::Handle ObservedDataset::empty()
+{
+    static const Handle instance = create(QVector<double>(), QVector<double>(), QVector<double>());
+    return instance;
+}
+
+ObservedDataset::Handle ObservedDataset::fromJson(const QJsonObject& json)
+{
+    return create(decodeValues(json["time"].toArray()), decodeValues(json["pressure"].toArray()),
+                  decodeValues(json["derivative"].toArray()), decodeValues(json["rawPressure"].toArray()));
+}
+
+ObservedDataset::Handle ObservedDataset::intern(ObservedDataset* dataset)
+{
+    quint64 h = FitEvaluationCache::hashValues(dataset->m_time);
+    h = FitEvaluationCache::hashValues(dataset->m_deltaP, h);
+    h = FitEvaluationCache::hashValues(dataset->m_derivative, h);
+    h = FitEvaluationCache::hashValues(dataset->m_rawPressure, h);
+    dataset->m_id = h;
+
+    QMutexLocker locker(&registryMutex());
+    auto& datasets = registry();
+    auto it = datasets.find(h);
+    if (it != datasets.end()) {
+        Handle existing = it->toStrongRef();
+        if (existing && existing->m_time == dataset->m_time && existing->m_deltaP == dataset->m_deltaP &&
+            existing->m_derivative == dataset->m_derivative && existing->m_rawPressure == dataset->m_rawPressure) {
+            delete dataset;
+            return existing;
+        }
+    }
+
+    dataset->m_version = ++s_lastVersion;
+    Handle handle(dataset);
+    if (it == datasets.end() || !it->toStrongRef()) datasets.insert(h, handle.toWeakRef());
+
+    // 顺便清理已释放的登记项
+    for (auto e = datasets.begin(); e != datasets.end();) {
+        if (e->isNull()) e = datasets.erase(e);
+        else ++e;
+    }
+    return handle;
+}
+
+QString ObservedDataset::idString() const
+{
+    return QString::number(m_id, 16).rightJustified(16, '0');
+}
+
+QJsonObject ObservedDataset::toJson() const
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_json.isEmpty()) {
+        m_json["time"] = encodeValues(m_time);
+        m_json["pressure"] = encodeValues(m_deltaP);
+        m_json["derivative"] = encodeValues(m_derivative);
+        m_json["rawPressure"] = encodeValues(m_rawPressure);
+    }
+    return m_json;
+}
+
+ObservedDataset::Series ObservedDataset::derived(const QString& key,
+                                                 const std::function<Series(const ObservedDataset&)>& compute) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_views.constFind(key);
+    if (it != m_views.constEnd()) return *it;
+    if (m_views.size() >= kMaxViews) m_views.clear();
+    const Series series = compute(*this);
+    m_views.insert(key, series);
+    return series;
+}
+
+ObservedDataset::Series ObservedDataset::logPositive() const
+{
+    return derived("logPositive", [](const ObservedDataset& data) {
+        Series s;
+        const QVector<double>& t = data.time();
+        const QVector<double>& p = data.deltaP();
+        const QVector<double>& d = data.derivative();
+        for (int i = 0; i < t.size() && i < p.size(); ++i) {
+            if (t[i] > 1e-10 && p[i] > 1e-10) {
+                s.t << t[i];
+                s.p << p[i];
+                s.d << ((i < d.size() && d[i] > 1e-10) ? d[i] : 1e-10); // log scale placeholder
+            }
+        }
+        return s;
+    });
+}
@@ -0,0 +1,80 @@
+/*
+ * 文件名: observeddataset.h
+ * 文件作用: 不可变的观测数据集 (拟合用实测数据) 头文件
+ * 功能描述:
+ * 1. ObservedDataset 保存一次加载得到的时间、压差、导数与原始压力，创建后不再修改；
+ *    FittingWidget、FittingCore、FittingChart、ModelManager 与批量拟合任务只持有同一个引用计数句柄 (Handle)，不再各自保存一份数组。
+ * 2. 内容相同的数据集共享同一个实例 (按内容散列登记，最后一个句柄释放后登记失效)：
+ *    复制分析、从项目文件读取多个分析时得到的是同一份数据。
+ * 3. 派生视图 (抽样、平滑、对数坐标下的有效点等) 以键登记在数据集上，每个键只计算一次，之后各处直接复用。
+ * 4. version 为创建序号 (全局递增)，id 为内容散列；项目保存时按 id 把各分析引用的数据集只写一份 (见 FittingPage)。
+ */
+
+#ifndef OBSERVEDDATASET_H
+#define OBSERVEDDATASET_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class ObservedDataset
+{
+public:
+    typedef QSharedPointer<const ObservedDataset> Handle;
+
+    // 派生视图 (与原数组等长或更短的 t/p/d 三列)
+    struct Series {
+        QVector<double> t;
+        QVector<double> p;
+        QVector<double> d;
+    };
+
+    // 创建数据集；已有内容相同的数据集时返回该实例
+    static Handle create(const QVector<double>& time, const QVector<double>& deltaP,
+                         const QVector<double>& derivative, const QVector<double>& rawPressure = QVector<double>());
+    // 空数据集 (全局共享，句柄从不为空)
+    static Handle empty();
+    // 读取 toJson 的结果 (同样按内容共享实例)
+    static Handle fromJson(const QJsonObject& json);
+
+    const QVector<double>& time() const { return m_time; }
+    const QVector<double>& deltaP() const { return m_deltaP; }
+    const QVector<double>& derivative() const { return m_derivative; }
+    const QVector<double>& rawPressure() const { return m_rawPressure; }
+    int size() const { return m_time.size(); }
+    bool isEmpty() const { return m_time.isEmpty(); }
+
+    quint64 id() const { return m_id; }
+    quint64 version() const { return m_version; }
+    // id 的十六进制文本 (项目文件中的引用键)
+    QString idString() const;
+
+    // 项目文件中的 observedData 对象 (首次调用时编码，之后返回同一个隐式共享的对象)
+    QJsonObject toJson() const;
+
+    // 键为 key 的派生视图：首次请求时调用 compute 计算并登记，之后直接返回；compute 在持锁期间执行，不得再请求本数据集的视图
+    Series derived(const QString& key, const std::function<Series(const ObservedDataset&)>& compute) const;
+    // 双对数图上可绘制的点 (t > 0 且压差 > 0，导数不为正时取 1e-10 作为占位)
+    Series logPositive() const;
+
+private:
+    ObservedDataset() = default;
+    static Handle intern(ObservedDataset* dataset);
+
+    QVector<double> m_time;
+    QVector<double> m_deltaP;
+    QVector<double> m_derivative;
+    QVector<double> m_rawPressure;
+    quint64 m_id = 0;
+    quint64 m_version = 0;
+
+    mutable QMutex m_mutex; // 保护以下缓存
+    mutable QHash<QString, Series> m_views;
+    mutable QJsonObject m_json;
+};
+
+#endif // OBSERVEDDATASET_H
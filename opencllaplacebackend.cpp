@@ -0,0 +1,468 @@
+/*
+ * opencllaplacebackend.cpp
+ * 文件作用: OpenCL 储层响应批量求值后端实现文件
+ * 功能描述:
+ * 1. 参数块按固定步长 (PARAM_STRIDE 个 double) 打包上传，求值项只上传参数块下标与 z；
+ *    大批量按 MAX_ITEMS_PER_LAUNCH 分段启动，避免单次内核运行过长触发显示驱动超时。
+ * 2. 裂缝影响积分：按距离 d = |offset - a| 积分，奇点 (d = 0) 落在区间内时在奇点处拆分，
+ *    面板按 GRADING_RATIO 向区间近端几何加密，最内层面板扣除 K0 的对数奇异性后解析补回 (同 CPU 自感应项)；
+ *    加密层数由裂缝积分最大二分深度换算 (2·depth + 2)。
+ * 3. 加边方程组按对称 Toeplitz 结构以 Levinson 递推求解 (O(nf) 私有存储)，回代残差超过 1e-8 时写入 NaN。
+ */
+
+#include "opencllaplacebackend.h"
+#include "besselbatch.h"
+
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+const char* const OpenClLaplaceBackend::Name = "opencl";
+
+namespace {
+
+// 参数块打包步长与各字段位置 (与内核源码中的下标一致)
+const int PARAM_STRIDE = 16;
+// 单次内核启动的求值项上限
+const int MAX_ITEMS_PER_LAUNCH = 65536;
+// 工作组大小
+const size_t WORK_GROUP_SIZE = 64;
+
+const char* const KERNEL_SOURCE = R"CLC(
+#define PARAM_STRIDE 16
+#define MAX_SEGMENTS 64
+#define GRADING_RATIO 0.15
+#define LEVINSON_BREAKDOWN_LIMIT 1e-12
+#define LEVINSON_RESIDUAL_LIMIT 1e-8
+
+// 15 点 Kronrod 节点 (降序，最后一个为中点) 与权重
+constant double XGK[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.0 };
+constant double WGK[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714 };
+
+// 裂缝积分被积函数 y11 = K0(γ1·d) + Ac·I0(γ1·d)，第二项以缩放 I0 与 exp(γ1·d - γ1·rmD) 组合
+double integrand(double d, double g1, double argG1, double ac)
+{
+    double arg = fmax(g1 * d, 1e-15);
+    double e = arg - argG1;
+    double second = (e > -700.0) ? ac * bb_i0s(arg) * exp(e) : 0.0;
+    return bb_k0(arg) + second;
+}
+
+// [d0, d1] 上的 15 点 Kronrod 求积；subtractLog 非零时被积函数加 ln d
+double panel(double d0, double d1, int subtractLog, double g1, double argG1, double ac)
+{
+    double h = 0.5 * (d1 - d0);
+    double c = 0.5 * (d0 + d1);
+    double fc = integrand(c, g1, argG1, ac);
+    if (subtractLog) fc += log(c);
+    double sum = WGK[7] * fc;
+    for (int j = 0; j < 7; ++j) {
+        double dx = h * XGK[j];
+        double fl = integrand(c - dx, g1, argG1, ac);
+        double fr = integrand(c + dx, g1, argG1, ac);
+        if (subtractLog) {
+            fl += log(c - dx);
+            fr += log(c + dx);
+        }
+        sum += WGK[j] * (fl + fr);
+    }
+    return sum * h;
+}
+
+// ∫_{d0}^{d1} y11(d) dd：面板向 d0 几何加密；d0 = 0 时最内层 [0, w] 积 y11 + ln d，再补回 ∫ln d = w·ln w - w
+double gradedIntegral(double d0, double d1, int levels, double g1, double argG1, double ac)
+{
+    double len = d1 - d0;
+    if (!(len > 0.0)) return 0.0;
+    double sum = 0.0;
+    double outer = len;
+    for (int l = 0; l < levels; ++l) {
+        double inner = outer * GRADING_RATIO;
+        sum += panel(d0 + inner, d0 + outer, 0, g1, argG1, ac);
+        outer = inner;
+    }
+    if (d0 == 0.0) sum += panel(0.0, outer, 1, g1, argG1, ac) - (outer * log(outer) - outer);
+    else sum += panel(d0, d0 + outer, 0, g1, argG1, ac);
+    return sum;
+}
+
+// 偏移 offset 处的影响积分 ∫_{-LfD}^{LfD} y11(|offset - a|) da
+double influenceIntegral(double offset, double LfD, int levels, double g1, double argG1, double ac)
+{
+    offset = fabs(offset);
+    if (offset < LfD) {
+        return gradedIntegral(0.0, LfD - offset, levels, g1, argG1, ac)
+             + gradedIntegral(0.0, LfD + offset, levels, g1, argG1, ac);
+    }
+    return gradedIntegral(offset - LfD, offset + LfD, levels, g1, argG1, ac);
+}
+
+// 参数块字段：0 M12, 1 LfD, 2 rmD, 3 reD, 4 omega1, 5 omega2, 6 lambda1, 7 lambda2, 8 eta12,
+//             9 earlyArgument, 10 dMin, 11 裂缝间距, 12 nf, 13 加密层数
+// boundary: 0 无限大, 1 封闭, 2 定压
+kernel void reservoir_response(global const double* params, global const int* paramIndex,
+                               global const double* zs, global double* out, int boundary, int n)
+{
+    int gid = get_global_id(0);
+    if (gid >= n) return;
+    global const double* p = params + PARAM_STRIDE * paramIndex[gid];
+    double z = zs[gid];
+    double M12 = p[0], LfD = p[1], rmD = p[2], reD = p[3];
+    double omga1 = p[4], omga2 = p[5], remda1 = p[6], remda2 = p[7], eta12 = p[8];
+    double earlyArgument = p[9], dMin = p[10], spacing = p[11];
+    int nf = (int)p[12];
+    int levels = (int)p[13];
+
+    // fs1 / fs2 (分母保护与非负限幅同主机内核)
+    double one_minus_omega1 = 1.0 - omga1;
+    double den_fs1 = one_minus_omega1 * z + remda1;
+    double fs1 = 1.0;
+    if (fabs(den_fs1) > 1e-20) fs1 = (omga1 * one_minus_omega1 * z + remda1) / den_fs1;
+    double one_minus_omega2 = 1.0 - omga2;
+    double den_fs2 = one_minus_omega2 * eta12 * z + remda2;
+    double fs2 = 0.0;
+    if (fabs(den_fs2) > 1e-20) fs2 = eta12 * (omga2 * one_minus_omega2 * eta12 * z + remda2) / den_fs2;
+    if (z * fs1 < 0) fs1 = 0.0;
+    if (z * fs2 < 0) fs2 = 0.0;
+
+    double g1 = sqrt(z * fs1);
+    double g2 = sqrt(z * fs2);
+    if (earlyArgument > 0.0 && dMin > 0.0 && g1 * dMin >= earlyArgument) {
+        out[gid] = M_PI / (2.0 * M12 * LfD * (double)nf * z * g1);
+        return;
+    }
+
+    // 界面与外边界 Bessel 项、mAB 与 Ac 前因子
+    double argG1 = g1 * rmD;
+    double argG2 = g2 * rmD;
+    double a1 = fmax(argG1, 1e-15);
+    double a2 = fmax(argG2, 1e-15);
+    double k0g1 = bb_k0(a1), k1g1 = bb_k1(a1), i0g1s = bb_i0s(a1), i1g1s = bb_i1s(a1);
+    double k0g2 = bb_k0(a2), k1g2 = bb_k1(a2), i0g2s = bb_i0s(a2), i1g2s = bb_i1s(a2);
+    double term_mAB_i0 = 0.0;
+    double term_mAB_i1 = 0.0;
+    if (boundary != 0 && reD > 1e-5) {
+        double argRe = g2 * reD;
+        double ar = fmax(argRe, 1e-15);
+        double exp_factor = (argG2 - argRe > -700.0) ? exp(argG2 - argRe) : 0.0;
+        double mAB = 0.0;
+        if (boundary == 1) {
+            double i1re = bb_i1s(ar);
+            if (fabs(i1re) > 1e-100) mAB = bb_k1(ar) / i1re;
+        } else {
+            double i0re = bb_i0s(ar);
+            if (fabs(i0re) > 1e-100) mAB = -(bb_k0(ar) / i0re);
+        }
+        term_mAB_i0 = mAB * i0g2s * exp_factor;
+        term_mAB_i1 = mAB * i1g2s * exp_factor;
+    }
+    double term1 = term_mAB_i0 + k0g2;
+    double term2 = term_mAB_i1 - k1g2;
+    double Acup = M12 * g1 * k1g1 * term1 + g2 * k0g1 * term2;
+    double Acdown = M12 * g1 * i1g1s * term1 - g2 * i0g1s * term2;
+    if (fabs(Acdown) < 1e-100) Acdown = (Acdown >= 0 ? 1e-100 : -1e-100);
+    double ac = Acup / Acdown;
+
+    // 影响矩阵首行 (等间距布局为对称 Toeplitz 阵)
+    double scale = 1.0 / (M12 * 2.0 * LfD);
+    double column[MAX_SEGMENTS];
+    for (int k = 0; k < nf; ++k) column[k] = influenceIntegral(k * spacing, LfD, levels, g1, argG1, ac) * scale;
+
+    // Levinson 递推解 A·x = 1，pwd = 1 / (z·Σx)
+    double x[MAX_SEGMENTS];
+    double y[MAX_SEGMENTS];
+    double t0 = column[0];
+    if (!(fabs(t0) > 0.0)) { out[gid] = NAN; return; }
+    double b = 1.0 / t0;
+    x[0] = b;
+    if (nf > 1) {
+        double alpha = -column[1] / t0;
+        y[0] = alpha;
+        double beta = 1.0;
+        for (int k = 1; k < nf; ++k) {
+            beta = (1.0 - alpha * alpha) * beta;
+            if (!(fabs(beta) > LEVINSON_BREAKDOWN_LIMIT)) { out[gid] = NAN; return; }
+            double acc = 0.0;
+            for (int j = 0; j < k; ++j) acc += column[j + 1] * x[k - 1 - j];
+            double mu = (b - acc / t0) / beta;
+            for (int j = 0; j < k; ++j) x[j] += mu * y[k - 1 - j];
+            x[k] = mu;
+            if (k < nf - 1) {
+                acc = column[k + 1];
+                for (int j = 0; j < k; ++j) acc += column[j + 1] * y[k - 1 - j];
+                alpha = -(acc / t0) / beta;
+                for (int j = 0, m = k - 1; j <= m; ++j, --m) {
+                    double yj = y[j];
+                    double ym = y[m];
+                    y[j] = yj + alpha * ym;
+                    if (m != j) y[m] = ym + alpha * yj;
+                }
+                y[k] = alpha;
+            }
+        }
+    }
+    double residual = 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < nf; ++i) {
+        double row = 0.0;
+        for (int j = 0; j < nf; ++j) row += column[abs(i - j)] * x[j];
+        residual = fmax(residual, fabs(1.0 - row));
+        sum += x[i];
+    }
+    if (!(residual <= LEVINSON_RESIDUAL_LIMIT)) { out[gid] = NAN; return; }
+    double den = z * sum;
+    if (fabs(den) < 1e-100) den = (den >= 0 ? 1e-100 : -1e-100);
+    out[gid] = 1.0 / den;
+}
+)CLC";
+
+// 外边界类别 (与内核参数 boundary 一致)
+int boundaryKind(ModelSolver01_06::ModelType type)
+{
+    switch (type) {
+    case ModelSolver01_06::Model_3:
+    case ModelSolver01_06::Model_4: return 1;
+    case ModelSolver01_06::Model_5:
+    case ModelSolver01_06::Model_6: return 2;
+    default: return 0;
+    }
+}
+
+// 等间距判断 (同 ModelSolver01_06::isUniformFractureLayout)
+bool isUniformLayout(const QVector<double>& xwD)
+{
+    const int nf = xwD.size();
+    if (nf < 3) return true;
+    const double step = xwD[1] - xwD[0];
+    const double tol = 1e-9 * std::max(1.0, std::abs(step));
+    for (int i = 2; i < nf; ++i) {
+        if (std::abs((xwD[i] - xwD[i - 1]) - step) > tol) return false;
+    }
+    return true;
+}
+
+// 设备缓冲区 (离开作用域时释放)
+struct DeviceBuffer {
+    cl_mem handle = nullptr;
+    ~DeviceBuffer() { if (handle) clReleaseMemObject(handle); }
+};
+
+QString clError(const char* call, cl_int code)
+{
+    return QString("%1 返回错误码 %2").arg(call).arg(code);
+}
+
+QString deviceString(cl_device_id device, cl_device_info info)
+{
+    size_t size = 0;
+    if (clGetDeviceInfo(device, info, 0, nullptr, &size) != CL_SUCCESS || size == 0) return QString();
+    std::string value(size, '\0');
+    clGetDeviceInfo(device, info, size, &value[0], nullptr);
+    return QString::fromLocal8Bit(value.c_str());
+}
+
+} // namespace
+
+struct OpenClLaplaceBackend::Private {
+    cl_device_id device = nullptr;
+    cl_context context = nullptr;
+    cl_command_queue queue = nullptr;
+    cl_program program = nullptr;
+    cl_kernel kernel = nullptr;
+    QString description;
+
+    ~Private() {
+        if (kernel) clReleaseKernel(kernel);
+        if (program) clReleaseProgram(program);
+        if (queue) clReleaseCommandQueue(queue);
+        if (context) clReleaseContext(context);
+    }
+};
+
+OpenClLaplaceBackend::OpenClLaplaceBackend()
+    : d(new Private)
+{
+}
+
+OpenClLaplaceBackend::~OpenClLaplaceBackend() = default;
+
+bool OpenClLaplaceBackend::initialize(QString* error)
+{
+    // 1. 第一块支持双精度的 GPU
+    cl_uint platformCount = 0;
+    if (clGetPlatformIDs(0, nullptr, &platformCount) != CL_SUCCESS || platformCount == 0) {
+        if (error) *error = "未找到 OpenCL 平台";
+        return false;
+    }
+    QVector<cl_platform_id> platforms(int(platformCount));
+    clGetPlatformIDs(platformCount, platforms.data(), nullptr);
+    for (cl_platform_id platform : platforms) {
+        cl_uint deviceCount = 0;
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 0, nullptr, &deviceCount) != CL_SUCCESS || deviceCount == 0) continue;
+        QVector<cl_device_id> devices(int(deviceCount));
+        clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, deviceCount, devices.data(), nullptr);
+        for (cl_device_id device : devices) {
+            cl_device_fp_config fp64 = 0;
+            if (clGetDeviceInfo(device, CL_DEVICE_DOUBLE_FP_CONFIG, sizeof(fp64), &fp64, nullptr) == CL_SUCCESS && fp64 != 0) {
+                d->device = device;
+                break;
+            }
+        }
+        if (d->device) break;
+    }
+    if (!d->device) {
+        if (error) *error = "未找到支持双精度 (cl_khr_fp64) 的 GPU 设备";
+        return false;
+    }
+    d->description = QString("OpenCL: %1 (%2)").arg(deviceString(d->device, CL_DEVICE_NAME).trimmed(),
+                                                    deviceString(d->device, CL_DEVICE_VERSION).trimmed());
+
+    // 2. 上下文、命令队列与内核
+    cl_int status = CL_SUCCESS;
+    d->context = clCreateContext(nullptr, 1, &d->device, nullptr, nullptr, &status);
+    if (status != CL_SUCCESS) {
+        if (error) *error = clError("clCreateContext", status);
+        return false;
+    }
+    d->queue = clCreateCommandQueue(d->context, d->device, 0, &status);
+    if (status != CL_SUCCESS) {
+        if (error) *error = clError("clCreateCommandQueue", status);
+        return false;
+    }
+
+    const std::string source = "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n" + BesselBatch::openclSource() + KERNEL_SOURCE;
+    const char* text = source.c_str();
+    const size_t length = source.size();
+    d->program = clCreateProgramWithSource(d->context, 1, &text, &length, &status);
+    if (status != CL_SUCCESS) {
+        if (error) *error = clError("clCreateProgramWithSource", status);
+        return false;
+    }
+    // 不使用 -cl-fast-relaxed-math：Bessel 逼近与对数奇异性扣除依赖严格的 IEEE 双精度
+    status = clBuildProgram(d->program, 1, &d->device, "-cl-std=CL1.2", nullptr, nullptr);
+    if (status != CL_SUCCESS) {
+        size_t logSize = 0;
+        clGetProgramBuildInfo(d->program, d->device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logSize);
+        std::string log(logSize, '\0');
+        if (logSize > 0) clGetProgramBuildInfo(d->program, d->device, CL_PROGRAM_BUILD_LOG, logSize, &log[0], nullptr);
+        if (error) *error = clError("clBuildProgram", status) + "\n" + QString::fromLocal8Bit(log.c_str());
+        return false;
+    }
+    d->kernel = clCreateKernel(d->program, "reservoir_response", &status);
+    if (status != CL_SUCCESS) {
+        if (error) *error = clError("clCreateKernel", status);
+        return false;
+    }
+    return true;
+}
+
+QString OpenClLaplaceBackend::name() const
+{
+    return QLatin1String(Name);
+}
+
+QString OpenClLaplaceBackend::description() const
+{
+    return d->description;
+}
+
+bool OpenClLaplaceBackend::supports(const ModelParams& p) const
+{
+    return p.nf >= 1 && p.nf <= MaxSegments && p.xwD.size() == p.nf && isUniformLayout(p.xwD);
+}
+
+bool OpenClLaplaceBackend::evaluate(const LaplaceBatchRequest& request, QVector<double>& out, QString* error)
+{
+    const int n = request.size();
+    out.resize(n);
+    if (n == 0) return true;
+
+    // 参数块打包 (dMin 与 CPU 的早期路径几何一致，见 asymptoticGeometry)
+    QVector<double> packed(request.params.size() * PARAM_STRIDE, 0.0);
+    for (int i = 0; i < request.params.size(); ++i) {
+        const ModelParams& p = request.params[i];
+        double* slot = packed.data() + i * PARAM_STRIDE;
+        const double spacing = (p.nf > 1) ? (p.xwD[1] - p.xwD[0]) : std::numeric_limits<double>::infinity();
+        const double dMax = (p.nf > 1 ? (p.xwD[p.nf - 1] - p.xwD[0]) : 0.0) + p.LfD;
+        slot[0] = p.M12;
+        slot[1] = p.LfD;
+        slot[2] = p.rmD;
+        slot[3] = p.reD;
+        slot[4] = p.omega1;
+        slot[5] = p.omega2;
+        slot[6] = p.lambda1;
+        slot[7] = p.lambda2;
+        slot[8] = p.eta12;
+        slot[9] = p.earlyArgument;
+        slot[10] = std::min(p.LfD, std::min(spacing - p.LfD, 2.0 * p.rmD - dMax));
+        slot[11] = (p.nf > 1) ? spacing : 0.0;
+        slot[12] = p.nf;
+        slot[13] = std::max(4, std::min(2 * p.quadratureDepth + 2, 24));
+    }
+
+    cl_int status = CL_SUCCESS;
+    DeviceBuffer params;
+    params.handle = clCreateBuffer(d->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                                   sizeof(double) * size_t(packed.size()), packed.data(), &status);
+    if (status != CL_SUCCESS) {
+        if (error) *error = clError("clCreateBuffer", status);
+        return false;
+    }
+    const cl_int boundary = boundaryKind(request.type);
+
+    for (int begin = 0; begin < n; begin += MAX_ITEMS_PER_LAUNCH) {
+        const cl_int count = std::min(MAX_ITEMS_PER_LAUNCH, n - begin);
+        DeviceBuffer index, zs, values;
+        index.handle = clCreateBuffer(d->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_int) * size_t(count),
+                                      const_cast<int*>(request.paramIndex.constData() + begin), &status);
+        if (status == CL_SUCCESS) {
+            zs.handle = clCreateBuffer(d->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(double) * size_t(count),
+                                       const_cast<double*>(request.z.constData() + begin), &status);
+        }
+        if (status == CL_SUCCESS) {
+            values.handle = clCreateBuffer(d->context, CL_MEM_WRITE_ONLY, sizeof(double) * size_t(count), nullptr, &status);
+        }
+        if (status != CL_SUCCESS) {
+            if (error) *error = clError("clCreateBuffer", status);
+            return false;
+        }
+
+        status = clSetKernelArg(d->kernel, 0, sizeof(cl_mem), &params.handle);
+        status |= clSetKernelArg(d->kernel, 1, sizeof(cl_mem), &index.handle);
+        status |= clSetKernelArg(d->kernel, 2, sizeof(cl_mem), &zs.handle);
+        status |= clSetKernelArg(d->kernel, 3, sizeof(cl_mem), &values.handle);
+        status |= clSetKernelArg(d->kernel, 4, sizeof(cl_int), &boundary);
+        status |= clSetKernelArg(d->kernel, 5, sizeof(cl_int), &count);
+        if (status != CL_SUCCESS) {
+            if (error) *error = clError("clSetKernelArg", status);
+            return false;
+        }
+
+        const size_t global = (size_t(count) + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE * WORK_GROUP_SIZE;
+        const size_t local = WORK_GROUP_SIZE;
+        status = clEnqueueNDRangeKernel(d->queue, d->kernel, 1, nullptr, &global, &local, 0, nullptr, nullptr);
+        if (status != CL_SUCCESS) {
+            if (error) *error = clError("clEnqueueNDRangeKernel", status);
+            return false;
+        }
+        status = clEnqueueReadBuffer(d->queue, values.handle, CL_TRUE, 0, sizeof(double) * size_t(count),
+                                     out.data() + begin, 0, nullptr, nullptr);
+        if (status != CL_SUCCESS) {
+            if (error) *error = clError("clEnqueueReadBuffer", status);
+            return false;
+        }
+    }
+    return true;
+}
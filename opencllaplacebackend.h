@@ -0,0 +1,41 @@
+/*
+ * opencllaplacebackend.h
+ * 文件作用: OpenCL 储层响应批量求值后端头文件 (仅在 qmake CONFIG+=wt_opencl 时编译)
+ * 功能描述:
+ * 1. 选取第一块支持双精度 (cl_khr_fp64) 的 GPU 设备，编译储层响应内核；不使用 OpenCL 的 CPU 设备
+ *    (主机上的线程池路径更快且与其他计算逐位一致)。
+ * 2. 每个工作项计算一个 (参数块, z)：fs1/fs2、γ、界面与外边界 Bessel 项 (与 BesselBatch 同一组系数)、
+ *    早期渐近路径，以及等间距裂缝影响矩阵首行的分级 Gauss-Kronrod 积分与 Levinson 递推求解。
+ * 3. 只处理等间距裂缝且段数不超过 MaxSegments 的参数块；递推中断或残差超限的项写入 NaN，由主机补算。
+ */
+
+#ifndef OPENCLLAPLACEBACKEND_H
+#define OPENCLLAPLACEBACKEND_H
+
+#include "laplacebatchbackend.h"
+
+#include <memory>
+
+class OpenClLaplaceBackend : public LaplaceBatchBackend
+{
+public:
+    static const char* const Name; // "opencl"
+    enum { MaxSegments = 64 };     // 设备端工作项私有数组容量 (裂缝段数上限)
+
+    OpenClLaplaceBackend();
+    ~OpenClLaplaceBackend() override;
+
+    // 选取设备、建立上下文并编译内核；失败时 error 给出原因 (含编译日志)
+    bool initialize(QString* error);
+
+    QString name() const override;
+    QString description() const override;
+    bool supports(const ModelParams& p) const override;
+    bool evaluate(const LaplaceBatchRequest& request, QVector<double>& out, QString* error) override;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+#endif // OPENCLLAPLACEBACKEND_H
@@ -0,0 +1,170 @@
+/*
+ * 文件名: parametertransform.cpp
+ * 文件作用: 拟合参数到 LM 迭代坐标的变换实现文件
+ * 功能描述:
+ * 1. logit 坐标 u = w·ln(s / (1 - s))，s 为参数在 [lo, hi] 内的相对位置 (log10 空间或原值)，w 为区间宽度 / 4；
+ *    有序参数的 lo = max(min, 1.01 × 下端参数)，下端参数改变时上端参数保持相对位置随之移动。
+ * 2. 原值与 log10 坐标没有边界，映射回参数时仍截断到 [min, max] (与原先的行为相同)。
+ * 3. ∂x/∂u 按中心差分计算：有序参数对使该矩阵不再是对角阵 (上端参数依赖下端参数的坐标)。
+ */
+
+#include "parametertransform.h"
+#include <QtGlobal>
+#include <cmath>
+
+namespace {
+
+const double kEdge = 1e-3;          // 初值距边界至少为区间宽度的该比例
+const double kOrderMargin = 1.01;   // 有序参数对：上端参数至少为下端参数的 1.01 倍 (与原约束修正一致)
+const double kJacobianStep = 1e-6;  // ∂x/∂u 的差分步长 (相对 max(1, |u|))
+
+inline double logistic(double z)
+{
+    return 1.0 / (1.0 + std::exp(-z));
+}
+
+} // namespace
+
+FitParameter::Transform ParameterTransform::resolve(const FitParameter& p)
+{
+    if (p.transform != FitParameter::Transform_Auto) return p.transform;
+    if (p.name == "nf") return FitParameter::Transform_Linear; // 离散参数，按列差分
+    if (std::isfinite(p.min) && std::isfinite(p.max) && p.max > p.min) return FitParameter::Transform_Logit;
+    return (p.value > 1e-12 && p.name != "S") ? FitParameter::Transform_Log : FitParameter::Transform_Linear;
+}
+
+QString ParameterTransform::orderedPartner(const FitParameter& p)
+{
+    if (!p.orderedAbove.isEmpty()) return p.orderedAbove;
+    if (p.name == "kf") return "km";
+    if (p.name == "omega1") return "omega2";
+    return QString();
+}
+
+ParameterTransform::ParameterTransform(const QList<FitParameter>& params, const QVector<int>& fitIndices)
+{
+    for (int idx : fitIndices) {
+        const FitParameter& p = params[idx];
+        Coordinate c;
+        c.name = p.name;
+        c.kind = resolve(p);
+        c.min = p.min;
+        c.max = p.max;
+        if (c.kind == FitParameter::Transform_Log) {
+            c.logSpace = true;
+        } else if (c.kind == FitParameter::Transform_Logit) {
+            if (!(c.max > c.min)) {
+                c.kind = FitParameter::Transform_Linear; // 没有取值区间时无法做 logit
+            } else {
+                c.logSpace = c.min > 0.0;
+                c.scale = (c.logSpace ? std::log10(c.max) - std::log10(c.min) : c.max - c.min) / 4.0;
+                // 有序参数对只在 log10 空间定义 (比例下限)
+                if (c.logSpace) c.partner = orderedPartner(p);
+            }
+        }
+        m_coordinates.append(c);
+    }
+    for (int i = 0; i < m_coordinates.size(); ++i)
+        if (m_coordinates[i].partner.isEmpty()) m_order.append(i);
+    for (int i = 0; i < m_coordinates.size(); ++i)
+        if (!m_coordinates[i].partner.isEmpty()) m_order.append(i);
+}
+
+double ParameterTransform::lowerBound(const Coordinate& c, const QMap<QString, double>& params) const
+{
+    double lo = c.min;
+    if (!c.partner.isEmpty() && params.contains(c.partner)) {
+        const double partner = params.value(c.partner);
+        if (partner > 0.0) lo = qMax(lo, partner * kOrderMargin);
+    }
+    return lo;
+}
+
+Eigen::VectorXd ParameterTransform::toUnconstrained(const QMap<QString, double>& params) const
+{
+    Eigen::VectorXd u(m_coordinates.size());
+    for (int i = 0; i < m_coordinates.size(); ++i) {
+        const Coordinate& c = m_coordinates[i];
+        const double x = params.value(c.name);
+        switch (c.kind) {
+        case FitParameter::Transform_Log:
+            u(i) = std::log10(qMax(x, c.min > 0.0 ? c.min : 1e-300));
+            break;
+        case FitParameter::Transform_Logit: {
+            const double lo = lowerBound(c, params);
+            if (!(c.max > lo)) { u(i) = 0.0; break; }
+            const double gLo = c.logSpace ? std::log10(lo) : lo;
+            const double gHi = c.logSpace ? std::log10(c.max) : c.max;
+            const double gx = c.logSpace ? std::log10(qMax(x, lo)) : x;
+            const double s = qBound(kEdge, (gx - gLo) / (gHi - gLo), 1.0 - kEdge);
+            u(i) = c.scale * std::log(s / (1.0 - s));
+            break;
+        }
+        default:
+            u(i) = x;
+            break;
+        }
+    }
+    return u;
+}
+
+QMap<QString, double> ParameterTransform::toParameters(const QMap<QString, double>& base, const Eigen::VectorXd& u) const
+{
+    QMap<QString, double> params = base;
+    for (int i : m_order) {
+        if (i >= u.size()) continue;
+        const Coordinate& c = m_coordinates[i];
+        double x;
+        switch (c.kind) {
+        case FitParameter::Transform_Log:
+            x = qMax(c.min, qMin(std::pow(10.0, u(i)), c.max));
+            break;
+        case FitParameter::Transform_Logit: {
+            // 有序参数的下端取自已更新的下端参数
+            const double lo = lowerBound(c, params);
+            if (!(c.max > lo)) { x = lo; break; }
+            const double gLo = c.logSpace ? std::log10(lo) : lo;
+            const double gHi = c.logSpace ? std::log10(c.max) : c.max;
+            const double gx = gLo + logistic(u(i) / c.scale) * (gHi - gLo);
+            x = c.logSpace ? std::pow(10.0, gx) : gx;
+            break;
+        }
+        default:
+            x = qMax(c.min, qMin(u(i), c.max));
+            break;
+        }
+        params[c.name] = x;
+    }
+    return params;
+}
+
+Eigen::MatrixXd ParameterTransform::jacobian(const QMap<QString, double>& params) const
+{
+    const int n = m_coordinates.size();
+    const Eigen::VectorXd u0 = toUnconstrained(params);
+    Eigen::MatrixXd T = Eigen::MatrixXd::Zero(n, n);
+    for (int j = 0; j < n; ++j) {
+        const double h = kJacobianStep * qMax(1.0, std::abs(u0(j)));
+        Eigen::VectorXd up = u0, um = u0;
+        up(j) += h;
+        um(j) -= h;
+        const QMap<QString, double> xp = toParameters(params, up);
+        const QMap<QString, double> xm = toParameters(params, um);
+        for (int i = 0; i < n; ++i) {
+            const QString& name = m_coordinates[i].name;
+            T(i, j) = (xp.value(name) - xm.value(name)) / (2.0 * h);
+        }
+    }
+    return T;
+}
+
+Eigen::MatrixXd ParameterTransform::reexpress(const Eigen::MatrixXd& J, const QMap<QString, double>& params,
+                                              const QVector<bool>& logScale) const
+{
+    // ∂z/∂u = diag(∂z/∂x)·∂x/∂u，∂r/∂z = ∂r/∂u·(∂z/∂u)⁻¹ (贴近边界时 ∂x/∂u 很小，用伪逆)
+    Eigen::MatrixXd M = jacobian(params);
+    for (int i = 0; i < M.rows() && i < logScale.size(); ++i) {
+        if (logScale[i]) M.row(i) /= params.value(m_coordinates[i].name) * std::log(10.0);
+    }
+    return J * M.completeOrthogonalDecomposition().pseudoInverse();
+}
@@ -0,0 +1,71 @@
+/*
+ * 文件名: parametertransform.h
+ * 文件作用: 拟合参数到 LM 迭代坐标的变换头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 每个拟合参数按 FitParameter::transform 取一种坐标：原值、log10、[min, max] 上的 logit
+ *    (min > 0 时在 log10 空间)，有序参数对的上端参数 (如 kf > km) 取下端随下端参数移动的 logit。
+ * 2. logit 坐标乘以区间宽度的 1/4，区间中部一个坐标单位约等于一个原值 (或 log10) 单位，
+ *    差分步长与收敛判据的尺度与原先相同；迭代在无约束坐标中进行，不再在边界上截断。
+ * 3. 恰好位于边界的初值先移入区间内 (距边界 0.1% 区间宽度)，避免梯度为零。
+ * 4. jacobian 给出 ∂x/∂u (数值差分，映射本身很便宜)，用于解析敏感度的链式法则与不确定性分析的坐标换算。
+ */
+
+#ifndef PARAMETERTRANSFORM_H
+#define PARAMETERTRANSFORM_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <Eigen/Dense>
+#include "fitparameter.h"
+
+class ParameterTransform
+{
+public:
+    // 按拟合参数 (fitIndices 指向 params) 建立变换
+    ParameterTransform(const QList<FitParameter>& params, const QVector<int>& fitIndices);
+
+    int size() const { return m_coordinates.size(); }
+
+    // 第 i 个迭代坐标是否以 log10 为单位 (决定差分步长)
+    bool isLogScale(int i) const { return m_coordinates[i].logSpace; }
+
+    // 参数字典 -> 迭代坐标
+    Eigen::VectorXd toUnconstrained(const QMap<QString, double>& params) const;
+
+    // 迭代坐标 -> 参数字典 (以 base 为底，只改写拟合参数；有序参数对先确定下端参数)
+    QMap<QString, double> toParameters(const QMap<QString, double>& base, const Eigen::VectorXd& u) const;
+
+    // ∂x_i/∂u_j (在 params 处)
+    Eigen::MatrixXd jacobian(const QMap<QString, double>& params) const;
+
+    // 把迭代坐标下的雅可比矩阵 ∂r/∂u 换算到 log10 (logScale[i] 为真) 或原值坐标
+    Eigen::MatrixXd reexpress(const Eigen::MatrixXd& J, const QMap<QString, double>& params,
+                              const QVector<bool>& logScale) const;
+
+    // FitParameter::transform 为 Transform_Auto 时实际采用的变换
+    static FitParameter::Transform resolve(const FitParameter& p);
+
+    // 有序参数对的下端参数名 (未声明时沿用原约束 kf > km、omega1 > omega2)
+    static QString orderedPartner(const FitParameter& p);
+
+private:
+    struct Coordinate {
+        QString name;
+        FitParameter::Transform kind = FitParameter::Transform_Linear;
+        bool logSpace = false;  // 在 log10 空间变换
+        double min = 0.0;
+        double max = 0.0;
+        double scale = 1.0;     // logit 坐标的缩放 (区间宽度 / 4)
+        QString partner;        // 有序参数对的下端参数 (为空时不是有序参数)
+    };
+
+    // 有序参数的 logit 区间下端 (随下端参数移动)
+    double lowerBound(const Coordinate& c, const QMap<QString, double>& params) const;
+
+    QVector<Coordinate> m_coordinates;
+    QVector<int> m_order; // toParameters 的计算顺序 (有序参数排在最后)
+};
+
+#endif // PARAMETERTRANSFORM_H
@@ -0,0 +1,71 @@
+/*
+ * performancesettings.cpp
+ * 文件作用: 进程级性能设置实现文件
+ * 功能描述:
+ * 1. 线程数同时写入 QThreadPool::globalInstance() 与 TaskScheduler：前者承载拟合线程、预览与导入等外层任务，
+ *    后者承载时间点、雅可比列、敏感性工况与导入分段的嵌套并行；调小后正在运行的任务照常完成，多余的调度器线程挂起。
+ * 2. Laplace 缓存调小容量后，各分片在下一次换代时回落到新上限；关闭时保留已有条目但不再查询与写入。
+ * 3. 设备后端初始化失败时保持 CPU 路径，原因由 LaplaceBatchBackend::lastFallbackReason 给出 (设置页与命令行显示)。
+ * 4. 页签驻留预算调小后不立即压缩，数据编辑器下一次 enforce 时生效 (切换页签、加载完成或定时检查)。
+ */
+
+#include "performancesettings.h"
+#include "laplacebatchbackend.h"
+#include "laplacecache.h"
+#include "modelsolver01-06.h"
+#include "sheetresidency.h"
+#include "taskscheduler.h"
+#include "typecurvelibrary.h"
+
+#include <QSettings>
+#include <QThread>
+#include <QThreadPool>
+
+PerformanceSettings PerformanceSettings::fromGlobalSettings()
+{
+    PerformanceSettings s;
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    s.workerThreads = qMax(0, settings.value("performance/workerThreads", 0).toInt());
+    s.defaultFractureSegments = settings.value("solver/defaultFractureSegments", 10).toInt();
+    s.laplaceCacheEnabled = settings.value("solver/laplaceCacheEnabled", true).toBool();
+    s.laplaceCacheCapacity = settings.value("solver/laplaceCacheCapacity", 65536).toInt();
+    s.typeCurveLibraryDir = settings.value("solver/typeCurveLibraryDir").toString();
+    s.laplaceBackend = settings.value("performance/laplaceBackend", "cpu").toString();
+    s.sheetMemoryBudgetMB = qMax(0, settings.value("performance/sheetMemoryBudgetMB", 2048).toInt());
+    s.sheetIdleMinutes = qMax(0, settings.value("performance/sheetIdleMinutes", 30).toInt());
+    return s;
+}
+
+int PerformanceSettings::effectiveWorkerThreads() const
+{
+    return workerThreads > 0 ? workerThreads : qMax(1, QThread::idealThreadCount());
+}
+
+bool PerformanceSettings::apply() const
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(effectiveWorkerThreads());
+    TaskScheduler::instance().setWorkerCount(effectiveWorkerThreads());
+
+    SheetResidencyManager& residency = SheetResidencyManager::instance();
+    residency.setBudget(qint64(sheetMemoryBudgetMB) * 1024 * 1024);
+    residency.setIdleTimeout(sheetIdleMinutes * 60);
+
+    LaplaceEvaluationCache& cache = LaplaceEvaluationCache::instance();
+    cache.setEnabled(laplaceCacheEnabled);
+    cache.setCapacity(laplaceCacheCapacity);
+
+    // 后端只影响求值位置，结果在积分容差内一致，不要求清空曲线缓存
+    LaplaceBatchBackend::setPreferredBackend(laplaceBackend);
+
+    const int previousNf = ModelSolver01_06::defaultFractureSegments();
+    ModelSolver01_06::setDefaultFractureSegments(defaultFractureSegments);
+    const bool nfChanged = ModelSolver01_06::defaultFractureSegments() != previousNf;
+
+    const bool libraryChanged = TypeCurveLibrary::setLibraryDirectory(typeCurveLibraryDir);
+    return nfChanged || libraryChanged;
+}
+
+bool PerformanceSettings::applyGlobalSettings()
+{
+    return fromGlobalSettings().apply();
+}
@@ -0,0 +1,44 @@
+/*
+ * performancesettings.h
+ * 文件作用: 进程级性能设置头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 汇总由设置页 "性能" 分组维护、作用于整个进程的设置项：
+ *    performance/workerThreads (工作线程数，0 表示按处理器核数)、solver/defaultFractureSegments (缺省裂缝离散段数)、
+ *    solver/laplaceCacheEnabled 与 solver/laplaceCacheCapacity (Laplace 像函数缓存)、solver/typeCurveLibraryDir (类型曲线库目录)、
+ *    performance/laplaceBackend (批量储层响应求值后端：cpu / opencl，见 LaplaceBatchBackend)、
+ *    performance/sheetMemoryBudgetMB 与 performance/sheetIdleMinutes (不活动数据页签的压缩驻留，见 SheetResidencyManager)。
+ * 2. applyGlobalSettings 把上述设置即时交给全局线程池、求解器、Laplace 缓存与类型曲线库注册表，无需重启；
+ *    启动时与设置保存后各调用一次 (与 Trace::applyGlobalSettings 相同)。
+ * 3. 反演方法与阶数、类型曲线库开关属于 SolverSettings (随求解器实例借出)，由持有 ModelEngine 的一方重新读取；
+ *    理论曲线缓存上限与预览质量由各自的使用方读取 (TheoryCurveCache / AdaptiveCurveSampler)。
+ */
+
+#ifndef PERFORMANCESETTINGS_H
+#define PERFORMANCESETTINGS_H
+
+#include <QString>
+
+struct PerformanceSettings {
+    int workerThreads = 0;              // 工作线程数 (0 表示 QThread::idealThreadCount)
+    int defaultFractureSegments = 10;   // 参数中未给出 nf 时的裂缝离散段数
+    bool laplaceCacheEnabled = true;    // Laplace 像函数缓存开关
+    int laplaceCacheCapacity = 65536;   // Laplace 像函数缓存条目上限
+    QString typeCurveLibraryDir;        // 类型曲线库目录 (为空时不加载)
+    QString laplaceBackend = "cpu";     // 批量储层响应求值后端 (设备不可用时自动回退到 CPU)
+    int sheetMemoryBudgetMB = 2048;     // 数据页签未压缩数据的预算 (MB，0 表示不限)
+    int sheetIdleMinutes = 30;          // 不活动页签超过该时间未使用即压缩 (分钟，0 表示不按时间压缩)
+
+    // 读取全局设置项
+    static PerformanceSettings fromGlobalSettings();
+
+    // 实际使用的工作线程数 (不小于 1)
+    int effectiveWorkerThreads() const;
+
+    // 应用到进程级对象，返回是否改变了理论曲线的计算结果 (缺省 nf 或类型曲线库目录改变，调用方据此清空曲线缓存)
+    bool apply() const;
+
+    // 读取并应用全局设置项
+    static bool applyGlobalSettings();
+};
+
+#endif // PERFORMANCESETTINGS_H
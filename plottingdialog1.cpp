@@ -14,7 +14,7 @@
 #include <QPainter>
 #include <QPixmap>
 
-PlottingDialog1::PlottingDialog1(const QMap<QString, QStandardItemModel*>& models, QWidget *parent) :
+PlottingDialog1::PlottingDialog1(const QMap<QString, ColumnarTableModel*>& models, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::PlottingDialog1),
     m_dataMap(models),
@@ -83,8 +83,8 @@ void PlottingDialog1::populateComboBoxes()
     if (m_currentModel) {
         QStringList headers;
         for(int i=0; i<m_currentModel->columnCount(); ++i) {
-            QStandardItem* item = m_currentModel->horizontalHeaderItem(i);
-            headers << (item ? item->text() : QString("列 %1").arg(i+1));
+            QString header = m_currentModel->headerText(i);
+            headers << (header.isEmpty() ? QString("列 %1").arg(i+1) : header);
         }
         ui->combo_XCol->addItems(headers);
         ui->combo_YCol->addItems(headers);
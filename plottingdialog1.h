@@ -13,7 +13,7 @@
 #define PLOTTINGDIALOG1_H
 
 #include <QDialog>
-#include <QStandardItemModel>
+#include "columnartablemodel.h"
 #include <QColor>
 #include <QMap>
 #include <QComboBox>
@@ -29,7 +29,7 @@ class PlottingDialog1 : public QDialog
 
 public:
     // 构造函数接收所有数据模型的映射表
-    explicit PlottingDialog1(const QMap<QString, QStandardItemModel*>& models, QWidget *parent = nullptr);
+    explicit PlottingDialog1(const QMap<QString, ColumnarTableModel*>& models, QWidget *parent = nullptr);
     ~PlottingDialog1();
 
     // --- 获取用户配置 ---
@@ -70,9 +70,9 @@ private:
     Ui::PlottingDialog1 *ui;
 
     // 存储所有可用模型
-    QMap<QString, QStandardItemModel*> m_dataMap;
+    QMap<QString, ColumnarTableModel*> m_dataMap;
     // 当前选中的模型指针
-    QStandardItemModel* m_currentModel;
+    ColumnarTableModel* m_currentModel;
 
     // 移除了静态计数器，因为名称由列名决定
 
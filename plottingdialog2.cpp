@@ -17,7 +17,7 @@
 
 int PlottingDialog2::s_chartCounter = 1;
 
-PlottingDialog2::PlottingDialog2(const QMap<QString, QStandardItemModel*>& models, QWidget *parent) :
+PlottingDialog2::PlottingDialog2(const QMap<QString, ColumnarTableModel*>& models, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::PlottingDialog2),
     m_dataMap(models),
@@ -143,8 +143,8 @@ void PlottingDialog2::populatePressColumns() {
     if (!m_pressModel) return;
     QStringList headers;
     for(int i=0; i<m_pressModel->columnCount(); ++i) {
-        QStandardItem* item = m_pressModel->horizontalHeaderItem(i);
-        headers << (item ? item->text() : QString("列 %1").arg(i+1));
+        QString header = m_pressModel->headerText(i);
+        headers << (header.isEmpty() ? QString("列 %1").arg(i+1) : header);
     }
     ui->combo_PressX->addItems(headers);
     ui->combo_PressY->addItems(headers);
@@ -158,8 +158,8 @@ void PlottingDialog2::populateProdColumns() {
     if (!m_prodModel) return;
     QStringList headers;
     for(int i=0; i<m_prodModel->columnCount(); ++i) {
-        QStandardItem* item = m_prodModel->horizontalHeaderItem(i);
-        headers << (item ? item->text() : QString("列 %1").arg(i+1));
+        QString header = m_prodModel->headerText(i);
+        headers << (header.isEmpty() ? QString("列 %1").arg(i+1) : header);
     }
     ui->combo_ProdX->addItems(headers);
     ui->combo_ProdY->addItems(headers);
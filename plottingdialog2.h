@@ -12,7 +12,7 @@
 #define PLOTTINGDIALOG2_H
 
 #include <QDialog>
-#include <QStandardItemModel>
+#include "columnartablemodel.h"
 #include <QColor>
 #include <QMap>
 #include <QComboBox>
@@ -27,7 +27,7 @@ class PlottingDialog2 : public QDialog
     Q_OBJECT
 
 public:
-    explicit PlottingDialog2(const QMap<QString, QStandardItemModel*>& models, QWidget *parent = nullptr);
+    explicit PlottingDialog2(const QMap<QString, ColumnarTableModel*>& models, QWidget *parent = nullptr);
     ~PlottingDialog2();
 
     // --- 获取曲线基础信息 ---
@@ -78,9 +78,9 @@ private slots:
 
 private:
     Ui::PlottingDialog2 *ui;
-    QMap<QString, QStandardItemModel*> m_dataMap;
-    QStandardItemModel* m_pressModel;
-    QStandardItemModel* m_prodModel;
+    QMap<QString, ColumnarTableModel*> m_dataMap;
+    ColumnarTableModel* m_pressModel;
+    ColumnarTableModel* m_prodModel;
 
     static int s_chartCounter; // 用于实现“数字自小到大自动排序”
     QString m_lastSuffix;
@@ -7,17 +7,19 @@
  * 3. 样式设置采用了统一的图标+中文风格。
  * 4. 默认名称前缀为“试井分析”。
  * 5. “显示数据来源”格式为 (文件名)。
+ * 6. 平滑处理可选择平滑方法 (移动平均 / Savitzky-Golay / 对数时间窗)。
  */
 
 #include "plottingdialog3.h"
 #include "ui_plottingdialog3.h"
 #include <QFileInfo>
 #include <QPainter>
+#include <cmath>
 #include <QPixmap>
 
 int PlottingDialog3::s_counter = 1;
 
-PlottingDialog3::PlottingDialog3(const QMap<QString, QStandardItemModel*>& models, QWidget *parent) :
+PlottingDialog3::PlottingDialog3(const QMap<QString, ColumnarTableModel*>& models, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::PlottingDialog3),
     m_dataMap(models),
@@ -128,8 +130,8 @@ void PlottingDialog3::populateComboBoxes()
 
     QStringList headers;
     for(int i=0; i<m_currentModel->columnCount(); ++i) {
-        QStandardItem* item = m_currentModel->horizontalHeaderItem(i);
-        headers << (item ? item->text() : QString("列 %1").arg(i+1));
+        QString header = m_currentModel->headerText(i);
+        headers << (header.isEmpty() ? QString("列 %1").arg(i+1) : header);
     }
     ui->comboTime->addItems(headers);
     ui->comboPress->addItems(headers);
@@ -162,7 +164,8 @@ void PlottingDialog3::updateInitialPressureDefault()
 
     int col = ui->comboPress->currentIndex();
     if (col >= 0 && m_currentModel->rowCount() > 0) {
-        double val = m_currentModel->item(0, col)->text().toDouble();
+        double val = m_currentModel->value(0, col);
+        if (std::isnan(val)) val = 0.0;
         ui->spinPi->setValue(val);
     }
 }
@@ -171,6 +174,7 @@ void PlottingDialog3::onSmoothToggled(bool checked)
 {
     ui->labelSmoothFactor->setEnabled(checked);
     ui->spinSmooth->setEnabled(checked);
+    ui->comboSmoothMethod->setEnabled(checked);
 }
 
 // --- 样式 UI 初始化 ---
@@ -303,6 +307,7 @@ double PlottingDialog3::getInitialPressure() const { return ui->spinPi->value();
 double PlottingDialog3::getLSpacing() const { return ui->spinL->value(); }
 bool PlottingDialog3::isSmoothEnabled() const { return ui->checkSmooth->isChecked(); }
 int PlottingDialog3::getSmoothFactor() const { return ui->spinSmooth->value(); }
+int PlottingDialog3::getSmoothMethod() const { return ui->comboSmoothMethod->currentIndex(); }
 
 QCPScatterStyle::ScatterShape PlottingDialog3::getPressShape() const {
     return (QCPScatterStyle::ScatterShape)ui->comboPressShape->currentData().toInt();
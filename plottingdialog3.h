@@ -13,7 +13,7 @@
 #define PLOTTINGDIALOG3_H
 
 #include <QDialog>
-#include <QStandardItemModel>
+#include "columnartablemodel.h"
 #include <QColor>
 #include <QMap>
 #include <QComboBox>
@@ -33,7 +33,7 @@ public:
         Buildup     // 压力恢复试井
     };
 
-    explicit PlottingDialog3(const QMap<QString, QStandardItemModel*>& models, QWidget *parent = nullptr);
+    explicit PlottingDialog3(const QMap<QString, ColumnarTableModel*>& models, QWidget *parent = nullptr);
     ~PlottingDialog3();
 
     // --- 基础数据接口 ---
@@ -50,6 +50,7 @@ public:
     double getLSpacing() const;
     bool isSmoothEnabled() const;
     int getSmoothFactor() const;
+    int getSmoothMethod() const; // DerivativeSmoother::Method
 
     // --- 坐标轴标签默认值 ---
     QString getXLabel() const { return "dt (h)"; }
@@ -93,8 +94,8 @@ private slots:
 
 private:
     Ui::PlottingDialog3 *ui;
-    QMap<QString, QStandardItemModel*> m_dataMap;
-    QStandardItemModel* m_currentModel;
+    QMap<QString, ColumnarTableModel*> m_dataMap;
+    ColumnarTableModel* m_currentModel;
 
     static int s_counter; // 用于实现“数字自小到大自动排序”
     QString m_lastSuffix;
@@ -5,6 +5,7 @@
  * 1. 修复了双栏布局中左侧控件无数据的问题（手动填充 _Dup 控件）。
  * 2. 优化了数据同步逻辑，确保文件切换时列选项正确更新。
  * 3. 实现了样式图标化和左右栏等宽布局逻辑（通过 C++ 代码设置 stretch）。
+ * 4. 压力导数曲线可选择平滑方法 (移动平均 / Savitzky-Golay / 对数时间窗)。
  */
 
 #include "plottingdialog4.h"
@@ -13,7 +14,7 @@
 #include <QPainter>
 #include <QDebug>
 
-PlottingDialog4::PlottingDialog4(const QMap<QString, QStandardItemModel*>& models, QWidget *parent) :
+PlottingDialog4::PlottingDialog4(const QMap<QString, ColumnarTableModel*>& models, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::PlottingDialog4),
     m_dataMap(models),
@@ -182,6 +183,7 @@ void PlottingDialog4::initialize(const DialogCurveInfo& info)
         ui->spinL->setValue(info.LSpacing);
         ui->checkSmooth->setChecked(info.isSmooth);
         ui->spinSmooth->setValue(info.smoothFactor);
+        ui->comboSmoothMethod->setCurrentIndex(qBound(0, info.smoothMethod, ui->comboSmoothMethod->count() - 1));
         onTestTypeChanged();
         onSmoothToggled(info.isSmooth);
 
@@ -257,6 +259,7 @@ DialogCurveInfo PlottingDialog4::getResult() const
         info.LSpacing = ui->spinL->value();
         info.isSmooth = ui->checkSmooth->isChecked();
         info.smoothFactor = ui->spinSmooth->value();
+        info.smoothMethod = ui->comboSmoothMethod->currentIndex();
 
         // Deriv Style
         info.style2PointShape = (QCPScatterStyle::ScatterShape)ui->comboDerivShape->currentData().toInt();
@@ -294,11 +297,11 @@ void PlottingDialog4::populateColumns(QString key, QComboBox* xCombo, QComboBox*
     if (yComboDup) yComboDup->clear();
 
     if(m_dataMap.contains(key)) {
-        QStandardItemModel* model = m_dataMap.value(key);
+        ColumnarTableModel* model = m_dataMap.value(key);
         QStringList headers;
         for(int i=0; i<model->columnCount(); ++i) {
-            QStandardItem* item = model->horizontalHeaderItem(i);
-            headers << (item ? item->text() : QString("列 %1").arg(i+1));
+            QString header = model->headerText(i);
+            headers << (header.isEmpty() ? QString("列 %1").arg(i+1) : header);
         }
         if (xCombo) xCombo->addItems(headers);
         if (yCombo) yCombo->addItems(headers);
@@ -334,6 +337,7 @@ void PlottingDialog4::onTestTypeChanged() {
 void PlottingDialog4::onSmoothToggled(bool checked) {
     ui->label_SmoothFactor->setEnabled(checked);
     ui->spinSmooth->setEnabled(checked);
+    ui->comboSmoothMethod->setEnabled(checked);
 }
 
 // --- 样式初始化 ---
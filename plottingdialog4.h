@@ -12,7 +12,7 @@
 #define PLOTTINGDIALOG4_H
 
 #include <QDialog>
-#include <QStandardItemModel>
+#include "columnartablemodel.h"
 #include <QColor>
 #include <QMap>
 #include <QComboBox>
@@ -41,6 +41,7 @@ struct DialogCurveInfo {
     double LSpacing;
     bool isSmooth;
     int smoothFactor;
+    int smoothMethod; // 平滑方法 (DerivativeSmoother::Method)
 
     // Style 1 (Main / Pressure / Delta P)
     QCPScatterStyle::ScatterShape pointShape;
@@ -63,7 +64,7 @@ class PlottingDialog4 : public QDialog
     Q_OBJECT
 
 public:
-    explicit PlottingDialog4(const QMap<QString, QStandardItemModel*>& models, QWidget *parent = nullptr);
+    explicit PlottingDialog4(const QMap<QString, ColumnarTableModel*>& models, QWidget *parent = nullptr);
     ~PlottingDialog4();
 
     // 初始化对话框数据和界面状态
@@ -87,7 +88,7 @@ private slots:
 
 private:
     Ui::PlottingDialog4 *ui;
-    QMap<QString, QStandardItemModel*> m_dataMap;
+    QMap<QString, ColumnarTableModel*> m_dataMap;
     int m_currentType;
 
     // 辅助函数
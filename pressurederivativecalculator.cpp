@@ -3,12 +3,16 @@
  * 文件作用: 压力导数计算器实现
  * 功能描述:
  * 1. 实现了基于试井类型的压差计算逻辑 (降落: Pi-P, 恢复: P-Pwf)。
- * 2. 实现了 Bourdet 导数算法。
+ * 2. 实现了 Bourdet 导数算法，以及理论曲线敏感度所需的 Bourdet 导数方向导数。
  * 3. 将计算生成的压差和导数写回数据模型。
+ * 4. Bourdet 导数的选点与求值由 BourdetDerivativeEngine 完成 (预先计算 ln t，有序数据双指针选点，O(n))。
+ * 5. 压降局部修改后只重算 L-Spacing 窗口内受影响的导数 (updateBourdetDerivative)。
+ * 6. [列存储] 时间与压力直接取数据模型的数值列，只有无法直接解析的单元格 (如带单位) 才按文本解析。
  */
 
 #include "pressurederivativecalculator.h"
-#include <QStandardItem>
+#include "bourdetderivative.h"
+#include "tracing.h"
 #include <QRegularExpression>
 #include <QDebug>
 #include <cmath>
@@ -23,8 +27,9 @@ PressureDerivativeCalculator::~PressureDerivativeCalculator()
 }
 
 PressureDerivativeResult PressureDerivativeCalculator::calculatePressureDerivative(
-    QStandardItemModel* model, const PressureDerivativeConfig& config)
+    ColumnarTableModel* model, const PressureDerivativeConfig& config)
 {
+    WT_TRACE_SCOPE("PressureDerivative::calculate");
     PressureDerivativeResult result;
     result.success = false;
     // 初始化索引
@@ -70,15 +75,15 @@ PressureDerivativeResult PressureDerivativeCalculator::calculatePressureDerivati
     timeData.reserve(rowCount);
     pressureData.reserve(rowCount);
 
+    const ColumnarTableModel::ColumnSpan timeColumn = model->columnSpan(config.timeColumnIndex);
+    const ColumnarTableModel::ColumnSpan pressureColumn = model->columnSpan(config.pressureColumnIndex);
     for (int row = 0; row < rowCount; ++row) {
-        QStandardItem* timeItem = model->item(row, config.timeColumnIndex);
-        QStandardItem* pressureItem = model->item(row, config.pressureColumnIndex);
+        double timeValue = timeColumn[row];
+        double pressureValue = pressureColumn[row];
 
-        double timeValue = 0.0;
-        double pressureValue = 0.0;
-
-        if (timeItem) timeValue = parseNumericValue(timeItem->text());
-        if (pressureItem) pressureValue = parseNumericValue(pressureItem->text());
+        // 数值列中的文本与空单元格 (NaN) 按原规则解析 (去掉末尾单位，空为 0)
+        if (std::isnan(timeValue)) timeValue = parseNumericValue(model->text(row, config.timeColumnIndex));
+        if (std::isnan(pressureValue)) pressureValue = parseNumericValue(model->text(row, config.pressureColumnIndex));
 
         // 检查时间值有效性
         if (timeValue < 0) {
@@ -165,14 +170,14 @@ PressureDerivativeResult PressureDerivativeCalculator::calculatePressureDerivati
     model->insertColumn(deltaPColIdx);
 
     QString deltaPHeader = QString("压差(Delta P)\\%1").arg(config.pressureUnit);
-    model->setHorizontalHeaderItem(deltaPColIdx, new QStandardItem(deltaPHeader));
+    model->setHeaderData(deltaPColIdx, Qt::Horizontal, deltaPHeader);
+    model->setColumnForeground(deltaPColIdx, QColor("darkgreen")); // 绿色文字区分压差
 
+    model->beginUpdate();
     for (int row = 0; row < rowCount; ++row) {
-        QString val = formatValue(deltaPData[row], 6);
-        QStandardItem* item = new QStandardItem(val);
-        item->setForeground(QBrush(QColor("darkgreen"))); // 绿色文字区分压差
-        model->setItem(row, deltaPColIdx, item);
+        model->setText(row, deltaPColIdx, formatValue(deltaPData[row], 6));
     }
+    model->endUpdate();
     // 记录压差列索引
     result.deltaPColumnIndex = deltaPColIdx;
     result.deltaPColumnName = deltaPHeader;
@@ -183,15 +188,15 @@ PressureDerivativeResult PressureDerivativeCalculator::calculatePressureDerivati
     model->insertColumn(derivColIdx);
 
     QString derivHeader = QString("压力导数\\%1").arg(config.pressureUnit);
-    model->setHorizontalHeaderItem(derivColIdx, new QStandardItem(derivHeader));
+    model->setHeaderData(derivColIdx, Qt::Horizontal, derivHeader);
+    model->setColumnForeground(derivColIdx, QColor("#1565C0")); // 蓝色文字区分导数
 
+    model->beginUpdate();
     for (int row = 0; row < rowCount; ++row) {
-        QString val = formatValue(derivativeData[row], 6);
-        QStandardItem* item = new QStandardItem(val);
-        item->setForeground(QBrush(QColor("#1565C0"))); // 蓝色文字区分导数
-        model->setItem(row, derivColIdx, item);
+        model->setText(row, derivColIdx, formatValue(derivativeData[row], 6));
         result.processedRows++;
     }
+    model->endUpdate();
 
     // 记录导数列索引
     result.derivativeColumnIndex = derivColIdx;
@@ -216,125 +221,49 @@ QVector<double> PressureDerivativeCalculator::calculateBourdetDerivative(
     const QVector<double>& pressureDropData,
     double lSpacing)
 {
-    QVector<double> derivativeData;
-    int n = timeData.size();
-    derivativeData.reserve(n);
-
-    if (n == 0) return derivativeData;
-
-    for (int i = 0; i < n; ++i) {
-        double derivative = 0.0;
-        double ti = timeData[i];
-        double pi = pressureDropData[i];
-
-        // 寻找左侧点j：ln(ti) - ln(tj) ≥ L
-        int leftIndex = findLeftPoint(timeData, i, lSpacing);
-
-        // 寻找右侧点k：ln(tk) - ln(ti) ≥ L
-        int rightIndex = findRightPoint(timeData, i, lSpacing);
-
-        // 1. 如果找到左右两个点，使用加权平均法 (Bourdet Standard)
-        if (leftIndex >= 0 && rightIndex >= 0) {
-            double tj = timeData[leftIndex];
-            double pj = pressureDropData[leftIndex];
-            double tk = timeData[rightIndex];
-            double pk = pressureDropData[rightIndex];
-
-            // 计算对数差值
-            double deltaXL = std::log(ti) - std::log(tj);
-            double deltaXR = std::log(tk) - std::log(ti);
-
-            // 计算左导数和右导数
-            double mL = calculateDerivativeValue(ti, tj, pi, pj);
-            double mR = calculateDerivativeValue(tk, ti, pk, pi);
-
-            // 加权平均公式
-            if (deltaXL + deltaXR > 1e-12) {
-                derivative = (mL * deltaXR + mR * deltaXL) / (deltaXL + deltaXR);
-            } else {
-                derivative = 0.0;
-            }
-        }
-        // 2. 边界情况：只找到左侧点 (曲线末端)
-        else if (leftIndex >= 0 && rightIndex < 0) {
-            double tj = timeData[leftIndex];
-            double pj = pressureDropData[leftIndex];
-            derivative = calculateDerivativeValue(ti, tj, pi, pj);
-        }
-        // 3. 边界情况：只找到右侧点 (曲线开端)
-        else if (leftIndex < 0 && rightIndex >= 0) {
-            double tk = timeData[rightIndex];
-            double pk = pressureDropData[rightIndex];
-            derivative = calculateDerivativeValue(tk, ti, pk, pi);
-        }
-        // 4. L-Spacing 范围内点不足
-        else {
-            // 使用简单的相邻点差分作为保底
-            if (i > 0) {
-                double t_prev = timeData[i-1];
-                double p_prev = pressureDropData[i-1];
-                derivative = calculateDerivativeValue(ti, t_prev, pi, p_prev);
-            } else if (i < n - 1) {
-                double t_next = timeData[i+1];
-                double p_next = pressureDropData[i+1];
-                derivative = calculateDerivativeValue(t_next, ti, p_next, pi);
-            } else {
-                derivative = 0.0;
-            }
-        }
-
-        // 导数结果取绝对值（双对数图要求正值）
-        derivativeData.append(std::abs(derivative));
-    }
+    if (timeData.isEmpty()) return QVector<double>();
 
-    return derivativeData;
+    // 导数结果取绝对值（双对数图要求正值）
+    return BourdetDerivativeEngine(timeData, lSpacing).derivative(pressureDropData);
 }
 
-int PressureDerivativeCalculator::findLeftPoint(const QVector<double>& timeData, int currentIndex, double lSpacing)
+QVector<double> PressureDerivativeCalculator::calculateBourdetDerivativeTangent(
+    const QVector<double>& timeData,
+    const QVector<double>& pressureDropData,
+    const QVector<double>& tangentData,
+    double lSpacing)
 {
-    if (currentIndex <= 0 || timeData.isEmpty()) return -1;
-    double ti = timeData[currentIndex];
-    if (ti <= 0) return -1;
-    double lnTi = std::log(ti);
-
-    for (int j = currentIndex - 1; j >= 0; --j) {
-        double tj = timeData[j];
-        if (tj <= 0) continue;
-        double lnTj = std::log(tj);
-        if ((lnTi - lnTj) >= lSpacing) return j;
-    }
-    return -1;
+    // 原导数与扰动方向共用同一组 L-Spacing 选点
+    return BourdetDerivativeEngine(timeData, lSpacing).tangent(pressureDropData, tangentData);
 }
 
-int PressureDerivativeCalculator::findRightPoint(const QVector<double>& timeData, int currentIndex, double lSpacing)
+bool PressureDerivativeCalculator::updateBourdetDerivative(
+    const QVector<double>& timeData,
+    const QVector<double>& pressureDropData,
+    double lSpacing, int firstDirty, int lastDirty,
+    QVector<double>& derivativeData,
+    int* updatedFirst, int* updatedLast)
 {
-    int n = timeData.size();
-    if (currentIndex >= n - 1 || timeData.isEmpty()) return -1;
-    double ti = timeData[currentIndex];
-    if (ti <= 0) return -1;
-    double lnTi = std::log(ti);
-
-    for (int k = currentIndex + 1; k < n; ++k) {
-        double tk = timeData[k];
-        if (tk <= 0) continue;
-        double lnTk = std::log(tk);
-        if ((lnTk - lnTi) >= lSpacing) return k;
+    const int n = timeData.size();
+    int from = 0, to = n - 1;
+    bool local = derivativeData.size() == n && pressureDropData.size() == n
+                 && BourdetDerivativeEngine::hasMonotoneTime(timeData);
+
+    if (local) {
+        BourdetDerivativeEngine::affectedRange(timeData, lSpacing, firstDirty, lastDirty, from, to);
+        QVector<double> window = BourdetDerivativeEngine::derivativeRange(timeData, pressureDropData, lSpacing, from, to);
+        double* out = derivativeData.data();
+        for (int i = from; i <= to; ++i) out[i] = window[i - from];
+    } else {
+        derivativeData = calculateBourdetDerivative(timeData, pressureDropData, lSpacing);
     }
-    return -1;
-}
-
-double PressureDerivativeCalculator::calculateDerivativeValue(double t1, double t2, double p1, double p2)
-{
-    if (t1 <= 0 || t2 <= 0) return 0.0;
-    double lnT1 = std::log(t1);
-    double lnT2 = std::log(t2);
-    double deltaLnT = lnT1 - lnT2;
 
-    if (std::abs(deltaLnT) < 1e-10) return 0.0;
-    return (p1 - p2) / deltaLnT;
+    if (updatedFirst) *updatedFirst = from;
+    if (updatedLast) *updatedLast = to;
+    return local;
 }
 
-PressureDerivativeConfig PressureDerivativeCalculator::autoDetectColumns(QStandardItemModel* model)
+PressureDerivativeConfig PressureDerivativeCalculator::autoDetectColumns(ColumnarTableModel* model)
 {
     PressureDerivativeConfig config;
     if (!model) return config;
@@ -343,19 +272,16 @@ PressureDerivativeConfig PressureDerivativeCalculator::autoDetectColumns(QStanda
     return config;
 }
 
-int PressureDerivativeCalculator::findPressureColumn(QStandardItemModel* model)
+int PressureDerivativeCalculator::findPressureColumn(ColumnarTableModel* model)
 {
     if (!model) return -1;
     QStringList pressureKeywords = {"压力", "pressure", "pres", "P\\", "压力\\"};
     for (int col = 0; col < model->columnCount(); ++col) {
-        QStandardItem* headerItem = model->horizontalHeaderItem(col);
-        if (headerItem) {
-            QString headerText = headerItem->text();
-            for (const QString& keyword : pressureKeywords) {
-                if (headerText.contains(keyword, Qt::CaseInsensitive)) {
-                    if (!headerText.contains("压降") && !headerText.contains("导数") && !headerText.contains("Delta")) {
-                        return col;
-                    }
+        QString headerText = model->headerText(col);
+        for (const QString& keyword : pressureKeywords) {
+            if (headerText.contains(keyword, Qt::CaseInsensitive)) {
+                if (!headerText.contains("压降") && !headerText.contains("导数") && !headerText.contains("Delta")) {
+                    return col;
                 }
             }
         }
@@ -363,18 +289,15 @@ int PressureDerivativeCalculator::findPressureColumn(QStandardItemModel* model)
     return -1;
 }
 
-int PressureDerivativeCalculator::findTimeColumn(QStandardItemModel* model)
+int PressureDerivativeCalculator::findTimeColumn(ColumnarTableModel* model)
 {
     if (!model) return -1;
     QStringList timeKeywords = {"时间", "time", "t\\", "小时", "hour", "min", "sec"};
     for (int col = 0; col < model->columnCount(); ++col) {
-        QStandardItem* headerItem = model->horizontalHeaderItem(col);
-        if (headerItem) {
-            QString headerText = headerItem->text();
-            for (const QString& keyword : timeKeywords) {
-                if (headerText.contains(keyword, Qt::CaseInsensitive)) {
-                    return col;
-                }
+        QString headerText = model->headerText(col);
+        for (const QString& keyword : timeKeywords) {
+            if (headerText.contains(keyword, Qt::CaseInsensitive)) {
+                return col;
             }
         }
     }
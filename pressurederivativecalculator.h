@@ -13,7 +13,7 @@
 #include <QObject>
 #include <QString>
 #include <QVector>
-#include <QStandardItemModel>
+#include "columnartablemodel.h"
 
 // 压力导数计算结果结构
 struct PressureDerivativeResult {
@@ -94,7 +94,7 @@ public:
      * @param config 计算配置
      * @return 计算结果
      */
-    PressureDerivativeResult calculatePressureDerivative(QStandardItemModel* model,
+    PressureDerivativeResult calculatePressureDerivative(ColumnarTableModel* model,
                                                          const PressureDerivativeConfig& config);
 
     /**
@@ -102,7 +102,7 @@ public:
      * @param model 数据模型
      * @return 配置对象，包含检测到的列索引
      */
-    PressureDerivativeConfig autoDetectColumns(QStandardItemModel* model);
+    PressureDerivativeConfig autoDetectColumns(ColumnarTableModel* model);
 
     // =========================================================================
     // 静态核心算法接口 (Saphir 风格 Bourdet 导数)
@@ -119,18 +119,44 @@ public:
                                                       const QVector<double>& pressureDropData,
                                                       double lSpacing);
 
+    /**
+     * @brief 计算 Bourdet 导数沿压降扰动方向的方向导数 (用于解析雅可比矩阵)
+     * @param timeData 时间数据 (t)
+     * @param pressureDropData 压降数据 (Delta P)
+     * @param tangentData 压降对某一参数的偏导数
+     * @param lSpacing L-Spacing参数
+     * @return calculateBourdetDerivative 结果对该参数的偏导数
+     */
+    static QVector<double> calculateBourdetDerivativeTangent(const QVector<double>& timeData,
+                                                             const QVector<double>& pressureDropData,
+                                                             const QVector<double>& tangentData,
+                                                             double lSpacing);
+
+    /**
+     * @brief 压降局部修改后就地更新导数 (时间不变)
+     * @param timeData 时间数据 (t)
+     * @param pressureDropData 修改后的压降数据 (Delta P)
+     * @param lSpacing L-Spacing参数
+     * @param firstDirty 被修改的第一个下标
+     * @param lastDirty 被修改的最后一个下标
+     * @param derivativeData 修改前的导数，只重算受影响的范围；长度不符时整体重算
+     * @param updatedFirst 输出：实际更新的第一个下标 (可为空)
+     * @param updatedLast 输出：实际更新的最后一个下标 (可为空)
+     * @return 是否只做了局部更新 (时间乱序或含非有限值时整体重算并返回 false)
+     */
+    static bool updateBourdetDerivative(const QVector<double>& timeData,
+                                        const QVector<double>& pressureDropData,
+                                        double lSpacing, int firstDirty, int lastDirty,
+                                        QVector<double>& derivativeData,
+                                        int* updatedFirst = nullptr, int* updatedLast = nullptr);
+
 signals:
     void progressUpdated(int progress, const QString& message);
     void calculationCompleted(const PressureDerivativeResult& result);
 
 private:
-    // 内部静态辅助函数
-    static int findLeftPoint(const QVector<double>& timeData, int currentIndex, double lSpacing);
-    static int findRightPoint(const QVector<double>& timeData, int currentIndex, double lSpacing);
-    static double calculateDerivativeValue(double t1, double t2, double p1, double p2);
-
-    int findPressureColumn(QStandardItemModel* model);
-    int findTimeColumn(QStandardItemModel* model);
+    int findPressureColumn(ColumnarTableModel* model);
+    int findTimeColumn(ColumnarTableModel* model);
     double parseNumericValue(const QString& str);
     QString formatValue(double value, int precision = 6);
 };
@@ -2,9 +2,15 @@
  * pressurederivativecalculator1.cpp
  * 文件作用：高级压力导数计算器实现文件
  * 功能描述：实现导数计算后的平滑处理逻辑
+ * 修改记录：
+ * 1. [局部更新] 压降局部修改后，平滑导数只在导数受影响范围按平滑窗口扩展后的范围内重算 (updateSmoothedDerivative)，
+ *    所需的原始导数由 BourdetDerivativeEngine 在其依赖范围上求得。
+ * 2. [平滑算法] 平滑由 DerivativeSmoother 完成：移动平均改为滑动求和 (O(n))，并可选 Savitzky-Golay 与对数时间窗。
+ * 3. [列存储] 时间与压力直接取数据模型的数值列。
  */
 
 #include "pressurederivativecalculator1.h"
+#include "bourdetderivative.h"
 #include <QtMath>
 #include <QDebug>
 
@@ -14,7 +20,7 @@ PressureDerivativeCalculator1::PressureDerivativeCalculator1(QObject *parent)
 }
 
 PressureDerivativeResult PressureDerivativeCalculator1::calculateSmoothedDerivative(
-    QStandardItemModel* model, const PressureDerivativeConfig& config, int smoothFactor)
+    ColumnarTableModel* model, const PressureDerivativeConfig& config, int smoothFactor)
 {
     // 1. 先使用基础计算器计算标准的Bourdet导数
     // 注意：这里我们借用基础计算器的逻辑，但在写入模型前拦截数据进行平滑
@@ -35,17 +41,13 @@ PressureDerivativeResult PressureDerivativeCalculator1::calculateSmoothedDerivat
     timeData.reserve(rows);
     pressureData.reserve(rows);
 
-    for(int i=0; i<rows; ++i) {
-        QStandardItem* tItem = model->item(i, config.timeColumnIndex);
-        QStandardItem* pItem = model->item(i, config.pressureColumnIndex);
-        if(tItem && pItem) {
-            bool okT, okP;
-            double t = tItem->text().toDouble(&okT);
-            double p = pItem->text().toDouble(&okP);
-            if(okT && okP) {
-                timeData.append(t);
-                pressureData.append(p);
-            }
+    const ColumnarTableModel::ColumnSpan tColumn = model->columnSpan(config.timeColumnIndex);
+    const ColumnarTableModel::ColumnSpan pColumn = model->columnSpan(config.pressureColumnIndex);
+    for(int i=0; i<tColumn.size && i<pColumn.size; ++i) {
+        // 文本与空单元格在数值列中为 NaN
+        if(!std::isnan(tColumn[i]) && !std::isnan(pColumn[i])) {
+            timeData.append(tColumn[i]);
+            pressureData.append(pColumn[i]);
         }
     }
 
@@ -74,11 +76,13 @@ PressureDerivativeResult PressureDerivativeCalculator1::calculateSmoothedDerivat
     int newCol = model->columnCount();
     model->insertColumn(newCol);
     QString header = QString("平滑导数(L=%1, S=%2)").arg(config.lSpacing).arg(smoothFactor);
-    model->setHorizontalHeaderItem(newCol, new QStandardItem(header));
+    model->setHeaderData(newCol, Qt::Horizontal, header);
 
+    model->beginUpdate();
     for(int i=0; i<smoothedDeriv.size() && i<rows; ++i) {
-        model->setItem(i, newCol, new QStandardItem(QString::number(smoothedDeriv[i], 'g', 6)));
+        model->setText(i, newCol, QString::number(smoothedDeriv[i], 'g', 6));
     }
+    model->endUpdate();
 
     result.success = true;
     result.addedColumnIndex = newCol;
@@ -90,33 +94,47 @@ PressureDerivativeResult PressureDerivativeCalculator1::calculateSmoothedDerivat
 
 QVector<double> PressureDerivativeCalculator1::smoothData(const QVector<double>& data, int span)
 {
-    int n = data.size();
-    if (n == 0) return QVector<double>();
-    if (span <= 1) return data;
-
-    // 确保span是奇数
-    if (span % 2 == 0) span++;
-
-    QVector<double> result(n);
-    int halfSpan = (span - 1) / 2;
-
-    for (int i = 0; i < n; ++i) {
-        double sum = 0;
-        int count = 0;
-
-        // 简单的移动平均，边缘处窗口自动缩小（类似Matlab默认行为）
-        int start = qMax(0, i - halfSpan);
-        int end = qMin(n - 1, i + halfSpan);
+    // 边缘处窗口自动缩小（类似Matlab默认行为），滑动求和与窗口大小无关
+    return DerivativeSmoother::smooth(QVector<double>(), data,
+                                      DerivativeSmoother::options(DerivativeSmoother::MovingAverage, span));
+}
 
-        for (int j = start; j <= end; ++j) {
-            sum += data[j];
-            count++;
-        }
+bool PressureDerivativeCalculator1::updateSmoothedDerivative(const QVector<double>& timeData,
+                                                             const QVector<double>& pressureDropData,
+                                                             double lSpacing, const DerivativeSmoother::Options& smoothing,
+                                                             int firstDirty, int lastDirty,
+                                                             QVector<double>& smoothedData,
+                                                             int* updatedFirst, int* updatedLast)
+{
+    if (smoothing.span <= 1) {
+        return PressureDerivativeCalculator::updateBourdetDerivative(timeData, pressureDropData, lSpacing,
+                                                                     firstDirty, lastDirty, smoothedData,
+                                                                     updatedFirst, updatedLast);
+    }
 
-        if (count > 0)
-            result[i] = sum / count;
-        else
-            result[i] = data[i];
+    const int n = timeData.size();
+    if (smoothedData.size() != n || pressureDropData.size() != n || !BourdetDerivativeEngine::hasMonotoneTime(timeData)) {
+        smoothedData = DerivativeSmoother::smooth(timeData,
+                                                  PressureDerivativeCalculator::calculateBourdetDerivative(timeData, pressureDropData, lSpacing),
+                                                  smoothing);
+        if (updatedFirst) *updatedFirst = 0;
+        if (updatedLast) *updatedLast = n - 1;
+        return false;
     }
-    return result;
+
+    // 导数受影响范围 -> 平滑结果受影响范围 -> 平滑所需的原始导数范围
+    const DerivativeSmoother::Options options = DerivativeSmoother::resolved(timeData, smoothing);
+    int from = 0, to = -1;
+    BourdetDerivativeEngine::affectedRange(timeData, lSpacing, firstDirty, lastDirty, from, to);
+    DerivativeSmoother::affectedRange(timeData, options, from, to, from, to);
+    int rawFrom = from, rawTo = to;
+    DerivativeSmoother::dependencyRange(timeData, options, from, to, rawFrom, rawTo);
+
+    const QVector<double> raw = BourdetDerivativeEngine::derivativeRange(timeData, pressureDropData, lSpacing, rawFrom, rawTo);
+    const QVector<double> smoothed = DerivativeSmoother::smooth(timeData.mid(rawFrom, rawTo - rawFrom + 1), raw, options);
+    for (int i = from; i <= to; ++i) smoothedData[i] = smoothed[i - rawFrom];
+
+    if (updatedFirst) *updatedFirst = from;
+    if (updatedLast) *updatedLast = to;
+    return true;
 }
@@ -13,6 +13,7 @@
 #include <QObject>
 #include <QVector>
 #include "pressurederivativecalculator.h" // 引用原有计算器结构体定义
+#include "derivativesmoother.h"
 
 class PressureDerivativeCalculator1 : public QObject
 {
@@ -27,18 +28,37 @@ public:
      * @param smoothFactor 平滑因子（窗口大小，奇数）
      * @return 计算结果
      */
-    PressureDerivativeResult calculateSmoothedDerivative(QStandardItemModel* model,
+    PressureDerivativeResult calculateSmoothedDerivative(ColumnarTableModel* model,
                                                          const PressureDerivativeConfig& config,
                                                          int smoothFactor);
 
     /**
-     * @brief 移动平均平滑算法 (类似Matlab smooth)
+     * @brief 移动平均平滑算法 (类似Matlab smooth，滑动求和 O(n)，见 DerivativeSmoother)
      * @param data 原始数据
      * @param span 平滑窗口大小 (必须为正奇数，偶数会自动+1)
      * @return 平滑后的数据
      */
     static QVector<double> smoothData(const QVector<double>& data, int span);
 
+    /**
+     * @brief 压降局部修改后就地更新平滑导数 (结果与 DerivativeSmoother::smooth(calculateBourdetDerivative(...)) 一致)
+     * @param timeData 时间数据
+     * @param pressureDropData 修改后的压降数据
+     * @param lSpacing L-Spacing参数
+     * @param smoothing 平滑方法与窗口 (span ≤ 1 表示不平滑)
+     * @param firstDirty 被修改的第一个下标
+     * @param lastDirty 被修改的最后一个下标
+     * @param smoothedData 修改前的平滑导数，只重算受影响的范围 (导数窗口两侧再按平滑窗口扩展)
+     * @param updatedFirst 输出：实际更新的第一个下标 (可为空)
+     * @param updatedLast 输出：实际更新的最后一个下标 (可为空)
+     * @return 是否只做了局部更新
+     */
+    static bool updateSmoothedDerivative(const QVector<double>& timeData, const QVector<double>& pressureDropData,
+                                         double lSpacing, const DerivativeSmoother::Options& smoothing,
+                                         int firstDirty, int lastDirty,
+                                         QVector<double>& smoothedData,
+                                         int* updatedFirst = nullptr, int* updatedLast = nullptr);
+
 signals:
     void progressUpdated(int progress, const QString& message);
     void calculationCompleted(const PressureDerivativeResult& result);
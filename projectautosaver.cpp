@@ -0,0 +1,243 @@
+/*
+ * 文件名: projectautosaver.cpp
+ * 文件作用: 项目后台自动备份实现文件
+ * 功能描述:
+ * 1. takeSnapshot 在界面线程收集项目各部分的隐式共享副本，writeBackup 在 QtConcurrent 线程中序列化并写入备份目录。
+ * 2. 每个文件经 QSaveFile 写入；数据表只压缩自上次备份以来修改过的，其余从缓存的压缩块原样写出。
+ * 3. 写入后按保留份数清理最旧的备份。
+ */
+
+#include "projectautosaver.h"
+#include "modelparameter.h"
+#include "wt_datawidget.h"
+#include "datasinglesheet.h"
+#include "fittingpage.h"
+
+#include <QtConcurrent>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+static bool writeBackupFile(const QString& path, const QByteArray& bytes)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    if (file.write(bytes) != bytes.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+ProjectAutoSaver::ProjectAutoSaver(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &ProjectAutoSaver::autoSaveNow);
+    connect(&m_watcher, &QFutureWatcher<Result>::finished, this, &ProjectAutoSaver::onBackupFinished);
+}
+
+ProjectAutoSaver::~ProjectAutoSaver()
+{
+    m_timer.stop();
+    m_watcher.waitForFinished();
+}
+
+void ProjectAutoSaver::setSources(WT_DataWidget* dataWidget, WT_PlottingWidget* plottingWidget, FittingPage* fittingPage)
+{
+    m_dataWidget = dataWidget;
+    m_plottingWidget = plottingWidget;
+    m_fittingPage = fittingPage;
+}
+
+void ProjectAutoSaver::configure(bool enabled, const QString& directory, int intervalMinutes, int maxBackups)
+{
+    m_enabled = enabled && !directory.isEmpty();
+    m_directory = directory;
+    m_maxBackups = qMax(1, maxBackups);
+    m_timer.setInterval(qMax(1, intervalMinutes) * 60 * 1000);
+
+    if (m_enabled && m_started) m_timer.start();
+    else m_timer.stop();
+}
+
+void ProjectAutoSaver::start()
+{
+    m_started = true;
+    if (m_enabled) m_timer.start();
+}
+
+void ProjectAutoSaver::stop()
+{
+    m_started = false;
+    m_timer.stop();
+    m_watcher.waitForFinished();
+
+    // 缓存只对当前项目有效
+    m_backedUpRevisions.clear();
+    m_worker = WorkerState();
+}
+
+void ProjectAutoSaver::autoSaveNow()
+{
+    if (!m_enabled || !m_started || isBusy()) return;
+    if (!ModelParameter::instance()->hasLoadedProject()) return;
+
+    const Snapshot snapshot = takeSnapshot();
+    if (snapshot.baseName.isEmpty()) return;
+
+    WorkerState* state = &m_worker;
+    m_watcher.setFuture(QtConcurrent::run([snapshot, state]() {
+        return writeBackup(snapshot, state);
+    }));
+}
+
+// 界面线程：只做浅复制，不做序列化与压缩
+ProjectAutoSaver::Snapshot ProjectAutoSaver::takeSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.backupDirectory = m_directory;
+    snapshot.baseName = QFileInfo(ModelParameter::instance()->getProjectFilePath()).completeBaseName();
+    snapshot.maxBackups = m_maxBackups;
+
+    snapshot.project = ModelParameter::instance()->projectSnapshot();
+    if (m_fittingPage) snapshot.project["fitting"] = m_fittingPage->collectFittingStates();
+
+    if (m_plottingWidget) snapshot.curves = m_plottingWidget->curves();
+
+    if (m_dataWidget) {
+        const QList<DataSingleSheet*> sheets = m_dataWidget->savableSheets();
+        for (DataSingleSheet* sheet : sheets) {
+            SheetSnapshot s;
+            s.revision = sheet->revision();
+            s.reuse = m_backedUpRevisions.contains(s.revision);
+            if (s.reuse) {
+                s.data.filePath = sheet->getFilePath();
+                s.data.headers = sheet->getHeaderLabels();
+            } else {
+                s.data = sheet->saveToStore(); // 列数组隐式共享；未修改的延迟加载表给出压缩块
+            }
+            snapshot.sheets.append(s);
+        }
+    }
+    return snapshot;
+}
+
+// 后台线程：序列化、压缩并写入一份完整备份
+ProjectAutoSaver::Result ProjectAutoSaver::writeBackup(const Snapshot& snapshot, WorkerState* state)
+{
+    Result result;
+
+    const QByteArray projectBytes = QJsonDocument(snapshot.project).toJson();
+
+    QJsonArray curvesArray;
+    for (auto it = snapshot.curves.begin(); it != snapshot.curves.end(); ++it)
+        curvesArray.append(it.value().toJson(&state->jsonCache));
+    state->jsonCache.prune();
+    QJsonObject chartObj;
+    chartObj["plotting_data"] = curvesArray;
+    const QByteArray chartBytes = QJsonDocument(chartObj).toJson(QJsonDocument::Compact);
+
+    QStringList sheetKeys;
+    bool sheetsUnchanged = true;
+    for (const SheetSnapshot& s : snapshot.sheets) {
+        sheetKeys.append(QString::number(s.revision) + '|' + s.data.filePath);
+        if (!s.reuse) sheetsUnchanged = false;
+    }
+    for (const SheetSnapshot& s : snapshot.sheets) result.revisions.insert(s.revision);
+
+    if (sheetsUnchanged && !state->lastProject.isEmpty() && projectBytes == state->lastProject
+        && chartBytes == state->lastChart && sheetKeys == state->lastSheetKeys) {
+        return result; // 与上次备份相同
+    }
+
+    QVector<ProjectTableStore::SheetData> sheets;
+    sheets.reserve(snapshot.sheets.size());
+    for (const SheetSnapshot& s : snapshot.sheets) {
+        if (!s.reuse) {
+            sheets.append(s.data);
+            continue;
+        }
+        auto it = state->encodedSheets.constFind(s.revision);
+        if (it == state->encodedSheets.constEnd()) {
+            result.error = QString("数据表 %1 的备份缓存缺失").arg(s.data.filePath);
+            result.revisions.clear();
+            return result;
+        }
+        ProjectTableStore::SheetData data = it.value();
+        data.filePath = s.data.filePath;
+        data.headers = s.data.headers;
+        sheets.append(data);
+    }
+
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    const QString directory = QDir(snapshot.backupDirectory).filePath(snapshot.baseName + "_autosave_" + stamp);
+    if (!QDir().mkpath(directory)) {
+        result.error = QString("无法创建备份目录: %1").arg(directory);
+        result.revisions.clear();
+        return result;
+    }
+
+    const QString prefix = QDir(directory).filePath(snapshot.baseName);
+    QString storeError;
+    if (!writeBackupFile(prefix + ".pwt", projectBytes)
+        || !writeBackupFile(prefix + "_chart.json", chartBytes)
+        || !ProjectTableStore::write(prefix + "_date.bin", sheets, &storeError)) {
+        result.error = storeError.isEmpty() ? QString("备份写入失败: %1").arg(directory) : storeError;
+        result.revisions.clear();
+        QDir(directory).removeRecursively();
+        return result;
+    }
+
+    // 缓存本次备份的压缩块，下次未修改的数据表直接复用 (不保持文件映射，以便清理旧备份)
+    QHash<quint64, ProjectTableStore::SheetData> encoded;
+    if (QSharedPointer<ProjectTableStore> store = ProjectTableStore::open(prefix + "_date.bin")) {
+        for (int i = 0; i < snapshot.sheets.size() && i < store->sheetCount(); ++i) {
+            ProjectTableStore::SheetData data;
+            if (store->readEncodedSheet(i, &data)) encoded.insert(snapshot.sheets[i].revision, data);
+        }
+    }
+    state->encodedSheets = encoded;
+    state->lastProject = projectBytes;
+    state->lastChart = chartBytes;
+    state->lastSheetKeys = sheetKeys;
+
+    removeOldBackups(snapshot.backupDirectory, snapshot.baseName, snapshot.maxBackups);
+
+    result.written = true;
+    result.directory = directory;
+    result.revisions.clear();
+    for (auto it = encoded.constBegin(); it != encoded.constEnd(); ++it) result.revisions.insert(it.key());
+    return result;
+}
+
+void ProjectAutoSaver::removeOldBackups(const QString& directory, const QString& baseName, int maxBackups)
+{
+    QDir dir(directory);
+    // 目录名中的时间戳使按名称排序即按时间排序
+    const QStringList backups = dir.entryList(QStringList() << baseName + "_autosave_*",
+                                              QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (int i = 0; i + maxBackups < backups.size(); ++i) {
+        if (!QDir(dir.filePath(backups[i])).removeRecursively())
+            qDebug() << "ProjectAutoSaver: 无法删除旧备份" << backups[i];
+    }
+}
+
+void ProjectAutoSaver::onBackupFinished()
+{
+    const Result result = m_watcher.result();
+    if (!m_started) return; // 已关闭项目
+
+    if (!result.error.isEmpty()) {
+        m_backedUpRevisions.clear();
+        qDebug() << "ProjectAutoSaver:" << result.error;
+        emit backupFailed(result.error);
+        return;
+    }
+    m_backedUpRevisions = result.revisions;
+    if (result.written) emit backupWritten(result.directory);
+}
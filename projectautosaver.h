@@ -0,0 +1,110 @@
+/*
+ * 文件名: projectautosaver.h
+ * 文件作用: 项目后台自动备份头文件
+ * 功能描述:
+ * 1. 按系统设置中的自动保存间隔 (system/autoSaveInterval，分钟) 定时备份当前项目，
+ *    备份写入设置的备份目录 (paths/backup)，每份为一个子目录，内含 .pwt、_chart.json 与 _date.bin，可直接作为项目打开。
+ * 2. 界面线程只取快照：项目参数与拟合状态的 JSON 对象、曲线表 (QMap<QString, CurveInfo>) 与数据表的列数组
+ *    均为隐式共享的浅复制；自上次备份以来未修改的数据表 (按 DataSingleSheet::revision 判断) 只记录修订号。
+ * 3. 序列化、压缩与写文件在后台线程完成：曲线数组经 JsonVectorCache 编码，未修改的数据表直接复用上次备份的压缩块；
+ *    内容与上次备份完全相同时不写新备份。
+ * 4. 备份目录按时间命名 (<项目名>_autosave_yyyyMMdd_HHmmss)，超出保留份数 (system/maxBackups) 的最旧备份被删除。
+ * 5. 上一次备份尚未写完时跳过本次定时；stop 等待正在写入的备份结束并清空缓存 (关闭项目时调用)。
+ */
+
+#ifndef PROJECTAUTOSAVER_H
+#define PROJECTAUTOSAVER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
+#include <QJsonObject>
+#include "projecttablestore.h"
+#include "wt_plottingwidget.h"
+#include "jsonvectorcache.h"
+
+class WT_DataWidget;
+class FittingPage;
+
+class ProjectAutoSaver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProjectAutoSaver(QObject* parent = nullptr);
+    ~ProjectAutoSaver();
+
+    // 快照来源 (均可为空)
+    void setSources(WT_DataWidget* dataWidget, WT_PlottingWidget* plottingWidget, FittingPage* fittingPage);
+
+    // 备份设置：enabled 为 false 时停止定时；intervalMinutes 至少为 1；maxBackups 至少保留 1 份
+    void configure(bool enabled, const QString& directory, int intervalMinutes, int maxBackups);
+
+    // 项目打开后开始定时，关闭前停止 (等待写入中的备份结束)
+    void start();
+    void stop();
+
+    bool isBusy() const { return m_watcher.isRunning(); }
+
+public slots:
+    // 立即取快照并提交后台写入 (未打开项目、未启用或上一次备份尚未完成时忽略)
+    void autoSaveNow();
+
+signals:
+    void backupWritten(const QString& directory);
+    void backupFailed(const QString& message);
+
+private:
+    struct SheetSnapshot {
+        quint64 revision = 0;
+        bool reuse = false;               // 与上次备份相同：只有 filePath 与 headers 有效
+        ProjectTableStore::SheetData data;
+    };
+
+    struct Snapshot {
+        QString backupDirectory;
+        QString baseName;
+        int maxBackups = 1;
+        QJsonObject project;              // .pwt 内容 (含拟合状态，不含绘图与表格数据)
+        QMap<QString, CurveInfo> curves;
+        QVector<SheetSnapshot> sheets;
+    };
+
+    struct Result {
+        bool written = false;             // false 且 error 为空表示内容未变，未写新备份
+        QString directory;
+        QString error;
+        QSet<quint64> revisions;          // 已备份的数据表修订号
+    };
+
+    // 仅由后台线程访问 (同一时刻至多一个备份在写)
+    struct WorkerState {
+        JsonVectorCache jsonCache;
+        QHash<quint64, ProjectTableStore::SheetData> encodedSheets; // 修订号 -> 上次备份中的压缩块
+        QByteArray lastProject;
+        QByteArray lastChart;
+        QStringList lastSheetKeys;
+    };
+
+    Snapshot takeSnapshot() const;
+    static Result writeBackup(const Snapshot& snapshot, WorkerState* state);
+    static void removeOldBackups(const QString& directory, const QString& baseName, int maxBackups);
+    void onBackupFinished();
+
+    WT_DataWidget* m_dataWidget = nullptr;
+    WT_PlottingWidget* m_plottingWidget = nullptr;
+    FittingPage* m_fittingPage = nullptr;
+
+    bool m_enabled = false;
+    bool m_started = false;
+    QString m_directory;
+    int m_maxBackups = 10;
+    QTimer m_timer;
+
+    QFutureWatcher<Result> m_watcher;
+    WorkerState m_worker;
+    QSet<quint64> m_backedUpRevisions; // 界面线程：最近一次备份中的数据表修订号
+};
+
+#endif // PROJECTAUTOSAVER_H
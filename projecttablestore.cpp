@@ -0,0 +1,348 @@
+/*
+ * projecttablestore.cpp
+ * 文件作用: 项目表格数据的二进制列存储文件实现文件
+ * 功能描述:
+ * 1. 文件格式：定长文件头 (标识、版本、索引位置与长度) + 各列数据块 (qCompress 格式) + 索引 (QDataStream)。
+ *    索引依次为各表的文件路径、表头、行数、列数，以及每列三个数据块的 (偏移, 长度)。
+ * 2. 写入时逐表并行压缩各列，按顺序写出后回填文件头；读取时校验文件头、索引及每块范围与解压长度。
+ * 3. 已压缩的数据表 (SheetData::encoded) 按原块写出，不解压。
+ */
+
+#include "projecttablestore.h"
+#include "memoryaccounting.h"
+
+#include <QDataStream>
+#include <QSaveFile>
+#include <QDebug>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+const char kMagic[8] = { 'W', 'T', 'T', 'A', 'B', 'L', 'E', '\0' };
+const qint32 kVersion = 1;
+const int kCompressLevel = 1; // 保存速度优先；数值块经差分与字节重排后，低压缩级别已足够
+
+struct FileHeader {
+    char magic[8];
+    qint32 version;
+    qint32 sheetCount;
+    qint64 indexOffset;
+    qint64 indexSize;
+};
+
+void setError(QString* errorMessage, const QString& text)
+{
+    if (errorMessage) *errorMessage = text;
+    qDebug() << "ProjectTableStore:" << text;
+}
+
+// 数值列：相邻位模式异或后按字节重排
+QByteArray encodeValues(const QVector<double>& values)
+{
+    const qint64 n = values.size();
+    QByteArray raw(n * 8, Qt::Uninitialized);
+    uchar* out = reinterpret_cast<uchar*>(raw.data());
+    quint64 previous = 0;
+    for (qint64 i = 0; i < n; ++i) {
+        quint64 bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        const quint64 x = bits ^ previous;
+        previous = bits;
+        for (int b = 0; b < 8; ++b) out[b * n + i] = uchar(x >> (8 * b));
+    }
+    return qCompress(raw, kCompressLevel);
+}
+
+void decodeValues(const QByteArray& raw, QVector<double>& values)
+{
+    const qint64 n = raw.size() / 8;
+    values.resize(n);
+    const uchar* in = reinterpret_cast<const uchar*>(raw.constData());
+    quint64 previous = 0;
+    for (qint64 i = 0; i < n; ++i) {
+        quint64 x = 0;
+        for (int b = 0; b < 8; ++b) x |= quint64(in[b * n + i]) << (8 * b);
+        previous ^= x;
+        std::memcpy(&values[i], &previous, sizeof(previous));
+    }
+}
+
+QByteArray encodeTexts(const QVector<QPair<int, QString>>& texts)
+{
+    QByteArray raw;
+    QDataStream out(&raw, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << qint32(texts.size());
+    for (const QPair<int, QString>& t : texts) out << qint32(t.first) << t.second;
+    return qCompress(raw, kCompressLevel);
+}
+
+bool decodeTexts(const QByteArray& raw, int rows, QVector<QPair<int, QString>>& texts)
+{
+    QDataStream in(raw);
+    in.setVersion(QDataStream::Qt_5_15);
+    qint32 count = 0;
+    in >> count;
+    if (count < 0 || count > rows) return false;
+    texts.resize(count);
+    for (QPair<int, QString>& t : texts) {
+        qint32 row = 0;
+        in >> row >> t.second;
+        if (row < 0 || row >= rows) return false;
+        t.first = row;
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+// 一列压缩后的三个数据块
+struct EncodedColumn {
+    QByteArray values;
+    QByteArray decimals;
+    QByteArray texts;
+};
+
+bool allEqual(const QVector<qint8>& v, qint8 x)
+{
+    return std::all_of(v.constBegin(), v.constEnd(), [x](qint8 d) { return d == x; });
+}
+
+bool allNaN(const QVector<double>& v)
+{
+    return std::all_of(v.constBegin(), v.constEnd(), [](double d) { return std::isnan(d); });
+}
+
+} // namespace
+
+// ---------------------- 写入 ----------------------
+
+bool ProjectTableStore::write(const QString& path, const QVector<SheetData>& sheets, QString* errorMessage)
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::ProjectIO);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        setError(errorMessage, "无法写入文件: " + path);
+        return false;
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.sheetCount = sheets.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    QByteArray index;
+    QDataStream out(&index, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_15);
+
+    auto writeBlock = [&file, &out](const QByteArray& data) {
+        out << qint64(data.isEmpty() ? 0 : file.pos()) << qint32(data.size());
+        if (!data.isEmpty()) file.write(data);
+    };
+
+    for (const SheetData& sheet : sheets) {
+        if (sheet.encoded) {
+            out << sheet.filePath << sheet.headers << qint32(sheet.rows) << qint32(sheet.blocks.size() / 3);
+            for (int b = 0; b + 2 < sheet.blocks.size(); b += 3) {
+                writeBlock(sheet.blocks[b]);
+                writeBlock(sheet.blocks[b + 1]);
+                writeBlock(sheet.blocks[b + 2]);
+            }
+            continue;
+        }
+
+        const ColumnarTableModel::RowBlock& block = sheet.block;
+        const int columns = block.values.size();
+
+        // 各列并行压缩，按列顺序写出
+        QVector<EncodedColumn> encoded(columns);
+        QVector<int> indices(columns);
+        std::iota(indices.begin(), indices.end(), 0);
+        QtConcurrent::blockingMap(indices, [&](int c) {
+            EncodedColumn& e = encoded[c];
+            if (!allNaN(block.values[c])) e.values = encodeValues(block.values[c]);
+            if (!allEqual(block.decimals[c], qint8(-1))) {
+                e.decimals = qCompress(reinterpret_cast<const uchar*>(block.decimals[c].constData()),
+                                       block.decimals[c].size(), kCompressLevel);
+            }
+            if (c < block.texts.size() && !block.texts[c].isEmpty()) e.texts = encodeTexts(block.texts[c]);
+        });
+
+        out << sheet.filePath << sheet.headers << qint32(block.rows) << qint32(columns);
+        for (const EncodedColumn& e : encoded) {
+            writeBlock(e.values);
+            writeBlock(e.decimals);
+            writeBlock(e.texts);
+        }
+    }
+
+    header.indexOffset = file.pos();
+    header.indexSize = index.size();
+    file.write(index);
+    file.seek(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (!file.commit()) {
+        setError(errorMessage, "写入文件失败: " + path);
+        return false;
+    }
+    return true;
+}
+
+// ---------------------- 读取 ----------------------
+
+ProjectTableStore::~ProjectTableStore()
+{
+    if (m_map) m_file.unmap(m_map);
+}
+
+QSharedPointer<ProjectTableStore> ProjectTableStore::open(const QString& path, QString* errorMessage)
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::ProjectIO);
+    QSharedPointer<ProjectTableStore> store(new ProjectTableStore());
+    store->m_file.setFileName(path);
+    if (!store->m_file.open(QIODevice::ReadOnly)) {
+        setError(errorMessage, "无法打开文件: " + path);
+        return QSharedPointer<ProjectTableStore>();
+    }
+    store->m_size = store->m_file.size();
+    if (store->m_size < qint64(sizeof(FileHeader))) {
+        setError(errorMessage, "文件过短: " + path);
+        return QSharedPointer<ProjectTableStore>();
+    }
+    store->m_map = store->m_file.map(0, store->m_size);
+    if (store->m_map) {
+        store->m_data = store->m_map;
+    } else {
+        store->m_buffer = store->m_file.readAll();
+        store->m_data = reinterpret_cast<const uchar*>(store->m_buffer.constData());
+        if (store->m_buffer.size() != store->m_size) {
+            setError(errorMessage, "读取文件失败: " + path);
+            return QSharedPointer<ProjectTableStore>();
+        }
+    }
+
+    // --- 文件头与索引 ---
+    FileHeader header;
+    std::memcpy(&header, store->m_data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || header.sheetCount < 0 || header.sheetCount > header.indexSize || header.indexOffset < qint64(sizeof(FileHeader)) || header.indexSize < 0
+        || header.indexOffset + header.indexSize > store->m_size) {
+        setError(errorMessage, "文件头无效: " + path);
+        return QSharedPointer<ProjectTableStore>();
+    }
+
+    const QByteArray index = QByteArray::fromRawData(
+        reinterpret_cast<const char*>(store->m_data + header.indexOffset), header.indexSize);
+    QDataStream in(index);
+    in.setVersion(QDataStream::Qt_5_15);
+
+    auto validBlock = [&store](const BlockRef& ref) {
+        return ref.size == 0 || (ref.offset >= qint64(sizeof(FileHeader)) && ref.size > 0
+                                 && ref.offset + ref.size <= store->m_size);
+    };
+
+    store->m_sheets.resize(header.sheetCount);
+    for (Sheet& sheet : store->m_sheets) {
+        qint32 rows = 0, columns = 0;
+        in >> sheet.info.filePath >> sheet.info.headers >> rows >> columns;
+        if (in.status() != QDataStream::Ok || rows < 0 || columns < 0 || columns > header.indexSize) {
+            setError(errorMessage, "索引无效: " + path);
+            return QSharedPointer<ProjectTableStore>();
+        }
+        sheet.info.rows = rows;
+        sheet.info.columns = columns;
+        sheet.columns.resize(columns);
+        for (ColumnRef& c : sheet.columns) {
+            in >> c.values.offset >> c.values.size >> c.decimals.offset >> c.decimals.size
+               >> c.texts.offset >> c.texts.size;
+            if (in.status() != QDataStream::Ok || !validBlock(c.values) || !validBlock(c.decimals) || !validBlock(c.texts)) {
+                setError(errorMessage, "索引无效: " + path);
+                return QSharedPointer<ProjectTableStore>();
+            }
+        }
+    }
+    return store;
+}
+
+QByteArray ProjectTableStore::uncompress(const BlockRef& ref) const
+{
+    return qUncompress(m_data + ref.offset, ref.size);
+}
+
+bool ProjectTableStore::readSheet(int index, ColumnarTableModel::RowBlock* block, QString* errorMessage) const
+{
+    WT_MEMORY_SCOPE(MemoryAccounting::ProjectIO);
+    if (!block || index < 0 || index >= m_sheets.size()) {
+        setError(errorMessage, "数据表不存在");
+        return false;
+    }
+    const Sheet& sheet = m_sheets[index];
+    const int rows = sheet.info.rows;
+    const int columns = sheet.columns.size();
+
+    block->rows = rows;
+    block->values.resize(columns);
+    block->decimals.resize(columns);
+    block->texts.resize(columns);
+
+    QVector<int> indices(columns);
+    std::iota(indices.begin(), indices.end(), 0);
+    QVector<char> failed(columns, 0);
+    QtConcurrent::blockingMap(indices, [&](int c) {
+        const ColumnRef& ref = sheet.columns[c];
+
+        if (ref.values.size > 0) {
+            const QByteArray raw = uncompress(ref.values);
+            if (raw.size() != qint64(rows) * 8) { failed[c] = 1; return; }
+            decodeValues(raw, block->values[c]);
+        } else {
+            block->values[c].fill(std::numeric_limits<double>::quiet_NaN(), rows);
+        }
+
+        if (ref.decimals.size > 0) {
+            const QByteArray raw = uncompress(ref.decimals);
+            if (raw.size() != rows) { failed[c] = 1; return; }
+            block->decimals[c].resize(rows);
+            std::memcpy(block->decimals[c].data(), raw.constData(), rows);
+        } else {
+            block->decimals[c].fill(qint8(-1), rows);
+        }
+
+        block->texts[c].clear();
+        if (ref.texts.size > 0 && !decodeTexts(uncompress(ref.texts), rows, block->texts[c])) failed[c] = 1;
+    });
+
+    if (failed.contains(1)) {
+        *block = ColumnarTableModel::RowBlock();
+        setError(errorMessage, "数据块损坏: " + sheet.info.filePath);
+        return false;
+    }
+    return true;
+}
+
+bool ProjectTableStore::readEncodedSheet(int index, SheetData* sheet) const
+{
+    if (!sheet || index < 0 || index >= m_sheets.size()) return false;
+    const Sheet& source = m_sheets[index];
+
+    // 深拷贝：调用方随后可能释放文件映射
+    auto copyBlock = [this](const BlockRef& ref) {
+        return ref.size > 0 ? QByteArray(reinterpret_cast<const char*>(m_data + ref.offset), ref.size) : QByteArray();
+    };
+    sheet->encoded = true;
+    sheet->rows = source.info.rows;
+    sheet->blocks.clear();
+    sheet->blocks.reserve(source.columns.size() * 3);
+    for (const ColumnRef& c : source.columns) {
+        sheet->blocks.append(copyBlock(c.values));
+        sheet->blocks.append(copyBlock(c.decimals));
+        sheet->blocks.append(copyBlock(c.texts));
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+/*
+ * projecttablestore.h
+ * 文件作用: 项目表格数据的二进制列存储文件 (_date.bin) 头文件
+ * 功能描述:
+ * 1. 替代逐格写成 JSON 字符串的 _date.json：每个数据表按列保存数值、小数位与文本三个数据块，
+ *    各块独立压缩，文件末尾的索引记录每块的位置与长度。
+ * 2. 数值块先对相邻数值的位模式做异或差分，再按字节重排 (所有数值的第 0 字节、第 1 字节 ...)，
+ *    时间、压力等缓变列压缩后通常只有原始数据的几分之一；小数位块与文本块直接压缩。
+ * 3. open 以只读内存映射打开文件，只读取索引 (表名、表头、行列数)；readSheet 按需解压单个数据表，
+ *    各列并行解压，供页签首次显示时延迟加载。
+ * 4. 写入经 QSaveFile 整体替换，写入失败时保留原文件。
+ * 5. [增量保存] 未修改的数据表可从旧文件复制压缩块原样写回 (readEncodedSheet)，保存时只压缩改变了的数据表。
+ */
+
+#ifndef PROJECTTABLESTORE_H
+#define PROJECTTABLESTORE_H
+
+#include <QFile>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "columnartablemodel.h"
+
+class ProjectTableStore
+{
+public:
+    // 数据表的索引信息 (打开文件时即可得到)
+    struct SheetInfo {
+        QString filePath;
+        QStringList headers;
+        int rows = 0;
+        int columns = 0;
+    };
+
+    // 写入用的一个数据表
+    struct SheetData {
+        QString filePath;
+        QStringList headers;
+        ColumnarTableModel::RowBlock block;
+
+        // 未修改的数据表：直接写出上次保存的压缩块 (encoded 为 true 时忽略 block)
+        bool encoded = false;
+        int rows = 0;
+        QVector<QByteArray> blocks; // 每列依次为数值、小数位、文本块 (空表示没有)
+    };
+
+    // 写入全部数据表 (各列并行压缩)，失败时原文件不变
+    static bool write(const QString& path, const QVector<SheetData>& sheets, QString* errorMessage = nullptr);
+
+    // 以只读内存映射打开并读取索引，失败时返回空指针
+    static QSharedPointer<ProjectTableStore> open(const QString& path, QString* errorMessage = nullptr);
+
+    ~ProjectTableStore();
+
+    int sheetCount() const { return m_sheets.size(); }
+    SheetInfo sheetInfo(int index) const { return m_sheets.value(index).info; }
+
+    // 解压一个数据表 (可在任意线程调用)
+    bool readSheet(int index, ColumnarTableModel::RowBlock* block, QString* errorMessage = nullptr) const;
+    // 复制一个数据表的压缩块 (不解压)，供增量保存时原样写回
+    bool readEncodedSheet(int index, SheetData* sheet) const;
+
+private:
+    // 数据块在文件中的位置 (size 为 0 表示该列没有此类数据)
+    struct BlockRef {
+        qint64 offset = 0;
+        qint32 size = 0;
+    };
+    struct ColumnRef {
+        BlockRef values;
+        BlockRef decimals;
+        BlockRef texts;
+    };
+    struct Sheet {
+        SheetInfo info;
+        QVector<ColumnRef> columns;
+    };
+
+    ProjectTableStore() = default;
+    QByteArray uncompress(const BlockRef& ref) const;
+
+    QFile m_file;
+    uchar* m_map = nullptr;
+    QByteArray m_buffer;      // 映射失败时整体读入
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    QVector<Sheet> m_sheets;
+};
+
+#endif // PROJECTTABLESTORE_H
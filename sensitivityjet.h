@@ -0,0 +1,188 @@
+/*
+ * sensitivityjet.h
+ * 文件作用: 前向自动微分 (对偶数) 标量类型
+ * 功能描述:
+ * 1. 定义 SensitivityJet<S>：值 v 与若干方向导数 d[0..n-1] 一起参与运算，S 为 double 或 std::complex<double>。
+ * 2. 重载四则运算及 sqrt / exp / log，使 Laplace 核函数模板可直接以 Jet 实例化，一次求值同时得到全部参数的偏导数。
+ * 3. abs / real 仅返回值部分的模长 / 实部，供核函数中的分支判断与收敛判断使用 (不参与求导)。
+ * 4. 导数分量个数 n 在运行时确定 (上限 MaxDirections)，常数 Jet 的 n 为 0，与有效 Jet 混合运算时自动补零。
+ */
+
+#ifndef SENSITIVITYJET_H
+#define SENSITIVITYJET_H
+
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include <type_traits>
+
+template <typename S>
+class SensitivityJet
+{
+public:
+    enum { MaxDirections = 12 };
+
+    S v;                  // 函数值
+    S d[MaxDirections];   // 各方向导数 (仅前 n 个有效)
+    int n;                // 有效导数分量个数
+
+    SensitivityJet() : v(0.0), n(0) {}
+    SensitivityJet(const S& value) : v(value), n(0) {}
+
+    // 允许由 double 等可转换为 S 的标量隐式构造 (S 为复数时使用)
+    template <typename U, typename = typename std::enable_if<std::is_arithmetic<U>::value && !std::is_same<U, S>::value>::type>
+    SensitivityJet(const U& value) : v(S(value)), n(0) {}
+
+    // 构造第 slot 个方向的自变量 (导数为单位向量)
+    static SensitivityJet variable(const S& value, int slot, int count) {
+        SensitivityJet r(value);
+        r.n = count;
+        for (int k = 0; k < count; ++k) r.d[k] = S(0.0);
+        if (slot >= 0 && slot < count) r.d[slot] = S(1.0);
+        return r;
+    }
+
+    // 第 k 个方向导数 (超出有效分量时为 0)
+    S derivative(int k) const { return (k < n) ? d[k] : S(0.0); }
+
+    SensitivityJet& operator+=(const SensitivityJet& o) { *this = *this + o; return *this; }
+    SensitivityJet& operator-=(const SensitivityJet& o) { *this = *this - o; return *this; }
+    SensitivityJet& operator*=(const SensitivityJet& o) { *this = *this * o; return *this; }
+    SensitivityJet& operator/=(const SensitivityJet& o) { *this = *this / o; return *this; }
+
+    SensitivityJet operator-() const {
+        SensitivityJet r(-v);
+        r.n = n;
+        for (int k = 0; k < n; ++k) r.d[k] = -d[k];
+        return r;
+    }
+
+    // 线性组合 r = a*x + b*y 的导数部分 (a, b 为标量系数)
+    static void combine(SensitivityJet& r, const S& a, const SensitivityJet& x, const S& b, const SensitivityJet& y) {
+        r.n = std::max(x.n, y.n);
+        int common = std::min(x.n, y.n);
+        for (int k = 0; k < common; ++k) r.d[k] = a * x.d[k] + b * y.d[k];
+        for (int k = common; k < x.n; ++k) r.d[k] = a * x.d[k];
+        for (int k = common; k < y.n; ++k) r.d[k] = b * y.d[k];
+    }
+
+    // 标量缩放 r = a*x 的导数部分
+    static void scale(SensitivityJet& r, const S& a, const SensitivityJet& x) {
+        r.n = x.n;
+        for (int k = 0; k < x.n; ++k) r.d[k] = a * x.d[k];
+    }
+
+    friend SensitivityJet operator+(const SensitivityJet& a, const SensitivityJet& b) {
+        SensitivityJet r(a.v + b.v);
+        combine(r, S(1.0), a, S(1.0), b);
+        return r;
+    }
+    friend SensitivityJet operator-(const SensitivityJet& a, const SensitivityJet& b) {
+        SensitivityJet r(a.v - b.v);
+        combine(r, S(1.0), a, S(-1.0), b);
+        return r;
+    }
+    friend SensitivityJet operator*(const SensitivityJet& a, const SensitivityJet& b) {
+        SensitivityJet r(a.v * b.v);
+        combine(r, b.v, a, a.v, b);
+        return r;
+    }
+    friend SensitivityJet operator/(const SensitivityJet& a, const SensitivityJet& b) {
+        // 值部分直接相除，保证与标量运算逐位一致；导数部分使用倒数
+        S inv = S(1.0) / b.v;
+        SensitivityJet r(a.v / b.v);
+        combine(r, inv, a, -r.v * inv, b);
+        return r;
+    }
+
+    // 与标量的混合运算 (标量导数为 0，省去无效乘加)
+    // 实数标量保持为 double 参与运算，使值部分与原 double/复数表达式逐位一致
+    template <typename U>
+    using ScalarOf = typename std::conditional<std::is_arithmetic<U>::value, double, S>::type;
+
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U, S>::value>::type>
+    friend SensitivityJet operator+(const SensitivityJet& a, const U& b) { SensitivityJet r(a); r.v = a.v + ScalarOf<U>(b); return r; }
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U, S>::value>::type>
+    friend SensitivityJet operator+(const U& b, const SensitivityJet& a) { SensitivityJet r(a); r.v = ScalarOf<U>(b) + a.v; return r; }
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U, S>::value>::type>
+    friend SensitivityJet operator-(const SensitivityJet& a, const U& b) { SensitivityJet r(a); r.v = a.v - ScalarOf<U>(b); return r; }
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U, S>::value>::type>
+    friend SensitivityJet operator-(const U& b, const SensitivityJet& a) { SensitivityJet r(-a); r.v = ScalarOf<U>(b) - a.v; return r; }
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U, S>::value>::type>
+    friend SensitivityJet operator*(const SensitivityJet& a, const U& b) {
+        ScalarOf<U> c(b);
+        SensitivityJet r(a.v * c);
+        scale(r, S(c), a);
+        return r;
+    }
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U, S>::value>::type>
+    friend SensitivityJet operator*(const U& b, const SensitivityJet& a) {
+        ScalarOf<U> c(b);
+        SensitivityJet r(c * a.v);
+        scale(r, S(c), a);
+        return r;
+    }
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U, S>::value>::type>
+    friend SensitivityJet operator/(const SensitivityJet& a, const U& b) {
+        ScalarOf<U> c(b);
+        SensitivityJet r(a.v / c);
+        scale(r, S(1.0) / S(c), a);
+        return r;
+    }
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U, S>::value>::type>
+    friend SensitivityJet operator/(const U& b, const SensitivityJet& a) {
+        ScalarOf<U> c(b);
+        SensitivityJet r(c / a.v);
+        scale(r, -r.v / a.v, a);
+        return r;
+    }
+};
+
+// ---------------------- 初等函数 ----------------------
+
+template <typename S>
+inline SensitivityJet<S> sqrt(const SensitivityJet<S>& x)
+{
+    using std::sqrt;
+    SensitivityJet<S> r(sqrt(x.v));
+    // 零点处导数发散，按 0 处理 (对应物理上无流动的退化情形)
+    S factor = (r.v == S(0.0)) ? S(0.0) : S(0.5) / r.v;
+    SensitivityJet<S>::scale(r, factor, x);
+    return r;
+}
+
+template <typename S>
+inline SensitivityJet<S> exp(const SensitivityJet<S>& x)
+{
+    using std::exp;
+    SensitivityJet<S> r(exp(x.v));
+    SensitivityJet<S>::scale(r, r.v, x);
+    return r;
+}
+
+template <typename S>
+inline SensitivityJet<S> log(const SensitivityJet<S>& x)
+{
+    using std::log;
+    SensitivityJet<S> r(log(x.v));
+    SensitivityJet<S>::scale(r, S(1.0) / x.v, x);
+    return r;
+}
+
+// 值部分的模长 (仅用于分支/收敛判断)
+template <typename S>
+inline double abs(const SensitivityJet<S>& x)
+{
+    using std::abs;
+    return abs(x.v);
+}
+
+// 值部分的实部 (仅用于分支判断)
+template <typename S>
+inline double real(const SensitivityJet<S>& x)
+{
+    using std::real;
+    return real(x.v);
+}
+
+#endif // SENSITIVITYJET_H
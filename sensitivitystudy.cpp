@@ -0,0 +1,328 @@
+/*
+ * 文件名: sensitivitystudy.cpp
+ * 文件作用: 多参数敏感性研究引擎实现文件
+ * 功能描述:
+ * 1. 拉丁超立方：每个因素把 [0, 1] 等分为 count 层，各层内随机取一点后按随机排列分配到工况 (std::mt19937，种子固定)。
+ * 2. 求值块大小约为 工况数 / (2 × 线程数)，且不超过 16 组参数；块内已登记的取消令牌在 Laplace 节点粒度上生效。
+ * 3. [任务调度] 各块经 TaskScheduler 并行，块内的批量求值继续在同一调度器中嵌套并行 (不再强制串行)。
+ */
+
+#include "sensitivitystudy.h"
+#include "fittingcore.h"
+#include "fitevaluationcache.h"
+#include "taskscheduler.h"
+#include <QSettings>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+const int kMaxChunk = 16;
+
+bool positiveCurve(const QVector<double>& t, const QVector<double>& v, int i)
+{
+    return i < t.size() && i < v.size() && t[i] > 0.0 && v[i] > 0.0 && std::isfinite(v[i]);
+}
+
+} // namespace
+
+// ============================================================================
+// SensitivityFactor
+// ============================================================================
+
+double SensitivityFactor::valueAt(double u) const
+{
+    u = qBound(0.0, u, 1.0);
+    if (logScale && low > 0.0 && high > 0.0)
+        return std::pow(10.0, std::log10(low) + u * (std::log10(high) - std::log10(low)));
+    return low + u * (high - low);
+}
+
+QVector<double> SensitivityFactor::gridValues() const
+{
+    if (!values.isEmpty()) return values;
+    QVector<double> out;
+    const int n = qMax(1, levels);
+    if (n == 1 || low == high) {
+        out.append(n == 1 ? valueAt(0.5) : low);
+        return out;
+    }
+    for (int i = 0; i < n; ++i) out.append(valueAt(double(i) / (n - 1)));
+    return out;
+}
+
+// ============================================================================
+// SensitivityStudy
+// ============================================================================
+
+SensitivityStudy::SensitivityStudy(FittingCore* core, ModelManager::ModelType modelType, const SolverSettings& settings,
+                                   const QVector<double>& t, ParameterLinker linker)
+    : m_core(core), m_modelType(modelType), m_settings(settings), m_t(t), m_linker(linker)
+{
+    QSettings appSettings("WellTestPro", "WellTestAnalysis");
+    m_capacity = qMax(64, appSettings.value("fitting/sensitivityCacheEntries", 4000).toInt());
+}
+
+SensitivityCase SensitivityStudy::makeCase(const QMap<QString, double>& base, const QMap<QString, double>& factors) const
+{
+    SensitivityCase c;
+    c.params = base;
+    c.factors = factors;
+    for (auto it = factors.constBegin(); it != factors.constEnd(); ++it) c.params[it.key()] = it.value();
+    if (m_linker) m_linker(c.params);
+    return c;
+}
+
+SensitivityCase SensitivityStudy::baseCase(const QMap<QString, double>& base) const
+{
+    return makeCase(base, QMap<QString, double>());
+}
+
+int SensitivityStudy::fullFactorialSize(const QList<SensitivityFactor>& factors)
+{
+    qint64 size = factors.isEmpty() ? 0 : 1;
+    for (const SensitivityFactor& factor : factors) {
+        size *= qMax(1, int(factor.gridValues().size()));
+        if (size > MaxCases) return MaxCases + 1;
+    }
+    return int(size);
+}
+
+QVector<SensitivityCase> SensitivityStudy::fullFactorial(const QMap<QString, double>& base,
+                                                         const QList<SensitivityFactor>& factors) const
+{
+    const int size = fullFactorialSize(factors);
+    if (size <= 0 || size > MaxCases) return QVector<SensitivityCase>();
+
+    QVector<QVector<double>> grids;
+    for (const SensitivityFactor& factor : factors) grids.append(factor.gridValues());
+
+    // 末位因素变化最快 (与表格中按因素顺序排列一致)
+    QVector<SensitivityCase> cases;
+    cases.reserve(size);
+    QVector<int> index(factors.size(), 0);
+    for (int n = 0; n < size; ++n) {
+        QMap<QString, double> values;
+        for (int f = 0; f < factors.size(); ++f) values[factors[f].name] = grids[f][index[f]];
+        cases.append(makeCase(base, values));
+        for (int f = factors.size() - 1; f >= 0; --f) {
+            if (++index[f] < grids[f].size()) break;
+            index[f] = 0;
+        }
+    }
+    return cases;
+}
+
+QVector<SensitivityCase> SensitivityStudy::latinHypercube(const QMap<QString, double>& base,
+                                                          const QList<SensitivityFactor>& factors,
+                                                          int count, quint32 seed) const
+{
+    QVector<SensitivityCase> cases;
+    if (factors.isEmpty() || count <= 0) return cases;
+    count = qMin(count, int(MaxCases));
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    QVector<QVector<double>> columns;
+    for (int f = 0; f < factors.size(); ++f) {
+        QVector<double> column(count);
+        for (int i = 0; i < count; ++i) column[i] = (i + uniform(rng)) / count;
+        std::shuffle(column.begin(), column.end(), rng);
+        columns.append(column);
+    }
+
+    cases.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QMap<QString, double> values;
+        for (int f = 0; f < factors.size(); ++f) values[factors[f].name] = factors[f].valueAt(columns[f][i]);
+        cases.append(makeCase(base, values));
+    }
+    return cases;
+}
+
+QVector<SensitivityCase> SensitivityStudy::tornado(const QMap<QString, double>& base,
+                                                   const QList<SensitivityFactor>& factors) const
+{
+    QVector<SensitivityCase> cases;
+    for (const SensitivityFactor& factor : factors) {
+        const double values[2] = { factor.low, factor.high };
+        for (int side = 0; side < 2; ++side) {
+            QMap<QString, double> value;
+            value[factor.name] = values[side];
+            SensitivityCase c = makeCase(base, value);
+            c.tornadoFactor = factor.name;
+            c.tornadoSide = side == 0 ? -1 : 1;
+            cases.append(c);
+        }
+    }
+    return cases;
+}
+
+QByteArray SensitivityStudy::cacheKey(const QMap<QString, double>& params) const
+{
+    return FitEvaluationCache::makeKey(int(m_modelType), m_settings, params, m_t, m_core ? m_core->contextHash() : 0);
+}
+
+bool SensitivityStudy::cachedCurve(const SensitivityCase& c, ModelCurveData& curve) const
+{
+    const QByteArray key = cacheKey(c.params);
+    QMutexLocker locker(&m_mutex);
+    auto it = m_current.constFind(key);
+    if (it != m_current.constEnd()) {
+        curve = it.value();
+        return true;
+    }
+    it = m_previous.constFind(key);
+    if (it != m_previous.constEnd()) {
+        curve = it.value();
+        return true;
+    }
+    return false;
+}
+
+void SensitivityStudy::store(const QByteArray& key, const ModelCurveData& curve)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_current.size() >= m_capacity / 2) {
+        m_previous.swap(m_current);
+        m_current.clear();
+    }
+    m_current.insert(key, curve);
+}
+
+int SensitivityStudy::cacheSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_current.size() + m_previous.size();
+}
+
+void SensitivityStudy::clearCache()
+{
+    QMutexLocker locker(&m_mutex);
+    m_current.clear();
+    m_previous.clear();
+}
+
+QVector<ModelCurveData> SensitivityStudy::evaluate(const QVector<SensitivityCase>& cases, const CancellationToken* token,
+                                                   QAtomicInteger<int>* progress)
+{
+    QVector<ModelCurveData> results(cases.size());
+    if (!m_core || cases.isEmpty()) return results;
+
+    // 1. 缓存命中的工况直接取出 (命中时提升回当前代)
+    QVector<int> pending;
+    QVector<QByteArray> keys(cases.size());
+    for (int i = 0; i < cases.size(); ++i) {
+        keys[i] = cacheKey(cases[i].params);
+        QMutexLocker locker(&m_mutex);
+        auto it = m_current.constFind(keys[i]);
+        if (it != m_current.constEnd()) {
+            results[i] = it.value();
+            continue;
+        }
+        it = m_previous.constFind(keys[i]);
+        if (it != m_previous.constEnd()) {
+            results[i] = it.value();
+            locker.unlock();
+            store(keys[i], results[i]);
+            continue;
+        }
+        pending.append(i);
+    }
+    if (progress) progress->storeRelaxed(cases.size() - pending.size());
+    if (pending.isEmpty()) return results;
+
+    // 2. 其余工况分块并行计算，每块一次批量调用
+    const int threads = TaskScheduler::instance().workerCount() + 1; // 调用线程同样参与
+    const int chunk = qBound(1, int(std::ceil(double(pending.size()) / (2 * threads))), kMaxChunk);
+    QVector<QVector<int>> chunks;
+    for (int start = 0; start < pending.size(); start += chunk)
+        chunks.append(pending.mid(start, chunk));
+
+    TaskScheduler::parallelFor(chunks.size(), [&](int c) {
+        const QVector<int>& indices = chunks.at(c);
+        CancellationToken::Scope cancellationScope(token);
+        if (token && token->isCancelled()) return;
+        QVector<QMap<QString, double>> sets;
+        sets.reserve(indices.size());
+        for (int i : indices) sets.append(cases[i].params);
+        const QVector<ModelCurveData> curves = m_core->calculateModelCurves(m_modelType, m_settings, sets, m_t);
+        if ((token && token->isCancelled()) || curves.size() != indices.size()) return;
+        for (int k = 0; k < indices.size(); ++k) {
+            results[indices[k]] = curves[k];
+            store(keys[indices[k]], curves[k]);
+        }
+        if (progress) progress->fetchAndAddRelaxed(indices.size());
+    });
+    return results;
+}
+
+SensitivityMetrics SensitivityStudy::metrics(const ModelCurveData& reference, const ModelCurveData& curve)
+{
+    SensitivityMetrics m;
+    const QVector<double>& t = std::get<0>(curve);
+    const QVector<double>& p = std::get<1>(curve);
+    const QVector<double>& d = std::get<2>(curve);
+    const QVector<double>& tRef = std::get<0>(reference);
+    const QVector<double>& pRef = std::get<1>(reference);
+    const QVector<double>& dRef = std::get<2>(reference);
+    const int n = qMin(t.size(), tRef.size());
+
+    // 按 floor(log10 t) 归入对数周期
+    QMap<int, QPair<double, int>> cycles;
+    double shiftSum = 0.0;
+    int shiftCount = 0;
+    for (int i = 0; i < n; ++i) {
+        if (positiveCurve(t, p, i) && positiveCurve(tRef, pRef, i))
+            m.maxPressureDeviation = qMax(m.maxPressureDeviation, std::fabs(std::log10(p[i] / pRef[i])));
+        if (!positiveCurve(t, d, i) || !positiveCurve(tRef, dRef, i)) continue;
+        const double shift = std::log10(d[i] / dRef[i]);
+        QPair<double, int>& cycle = cycles[int(std::floor(std::log10(t[i])))];
+        cycle.first += shift * shift;
+        ++cycle.second;
+        shiftSum += shift;
+        ++shiftCount;
+    }
+    if (shiftCount == 0) return m;
+
+    m.valid = true;
+    m.derivativeShift = shiftSum / shiftCount;
+    for (auto it = cycles.constBegin(); it != cycles.constEnd(); ++it) {
+        const double rms = std::sqrt(it.value().first / it.value().second);
+        m.cycleStart.append(it.key());
+        m.cycleDeviation.append(rms);
+        m.maxCycleDeviation = qMax(m.maxCycleDeviation, rms);
+    }
+    return m;
+}
+
+QVector<TornadoBar> SensitivityStudy::tornadoBars(const QVector<SensitivityCase>& cases,
+                                                  const QVector<SensitivityMetrics>& metrics)
+{
+    QVector<TornadoBar> bars;
+    QHash<QString, int> indexOf;
+    for (int i = 0; i < cases.size() && i < metrics.size(); ++i) {
+        const SensitivityCase& c = cases[i];
+        if (c.tornadoFactor.isEmpty() || c.tornadoSide == 0) continue;
+        if (!indexOf.contains(c.tornadoFactor)) {
+            indexOf.insert(c.tornadoFactor, bars.size());
+            TornadoBar bar;
+            bar.name = c.tornadoFactor;
+            bars.append(bar);
+        }
+        TornadoBar& bar = bars[indexOf.value(c.tornadoFactor)];
+        const double value = c.factors.value(c.tornadoFactor);
+        if (c.tornadoSide < 0) {
+            bar.lowValue = value;
+            bar.lowShift = metrics[i].derivativeShift;
+            bar.lowDeviation = metrics[i].maxCycleDeviation;
+        } else {
+            bar.highValue = value;
+            bar.highShift = metrics[i].derivativeShift;
+            bar.highDeviation = metrics[i].maxCycleDeviation;
+        }
+    }
+    std::stable_sort(bars.begin(), bars.end(), [](const TornadoBar& a, const TornadoBar& b) { return a.span() > b.span(); });
+    return bars;
+}
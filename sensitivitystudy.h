@@ -0,0 +1,139 @@
+/*
+ * 文件名: sensitivitystudy.h
+ * 文件作用: 多参数敏感性研究引擎头文件
+ * 功能描述:
+ * 1. 试验设计：多参数全因子网格 (各因素取给定值或 [low, high] 内的若干水平)、拉丁超立方抽样 (固定种子，可复现)
+ *    与围绕当前参数的单因素龙卷风研究 (每个因素取低值与高值各一次，其余参数保持基准值)。
+ * 2. 求值：未缓存的工况分块后在线程池中并行计算，每块经 FittingCore::calculateModelCurves 批量求值
+ *    (块内串行，避免线程池嵌套过度订阅)；结果按 (模型, 求解器设置, 参数, 时间网格, 产量历史) 缓存在研究对象中，
+ *    重新选择部分工况绘图或再次运行重叠的设计时不再重新计算。
+ * 3. 汇总指标：各工况相对基准曲线的导数偏差按对数周期统计 (每个周期内 |log10(dp'/dp'基准)| 的均方根)，
+ *    并给出最大周期偏差、导数平均对数偏移 (带符号，龙卷风图使用) 与压力最大对数偏差。
+ */
+
+#ifndef SENSITIVITYSTUDY_H
+#define SENSITIVITYSTUDY_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "cancellationtoken.h"
+#include "modelmanager.h"
+#include "solverpool.h"
+
+class FittingCore;
+
+// 研究因素：values 非空时直接使用这些取值，否则在 [low, high] 内取 levels 个水平 (logScale 为真且两端为正时按对数等距)
+struct SensitivityFactor {
+    QString name;
+    QVector<double> values;
+    double low = 0.0;
+    double high = 0.0;
+    int levels = 3;
+    bool logScale = false;
+
+    // 全因子设计中该因素的取值
+    QVector<double> gridValues() const;
+    // 区间内比例位置 u ∈ [0, 1] 对应的取值
+    double valueAt(double u) const;
+};
+
+// 一个工况：完整的求解器参数与各因素的取值 (龙卷风工况另记因素名与方向)
+struct SensitivityCase {
+    QMap<QString, double> params;
+    QMap<QString, double> factors;
+    QString tornadoFactor;  // 龙卷风工况对应的因素 (其他设计为空)
+    int tornadoSide = 0;    // -1 低值，+1 高值，0 基准
+};
+
+// 相对基准曲线的汇总指标 (valid 为假表示曲线无效或与基准无重叠的正值点)
+struct SensitivityMetrics {
+    bool valid = false;
+    QVector<double> cycleStart;      // 各对数周期的起点 log10(t)
+    QVector<double> cycleDeviation;  // 各周期内导数对数偏差的均方根
+    double maxCycleDeviation = 0.0;  // 最大周期偏差
+    double derivativeShift = 0.0;    // 导数平均对数偏移 log10(dp'/dp'基准) (带符号)
+    double maxPressureDeviation = 0.0; // 压力最大对数偏差 |log10(Δp/Δp基准)|
+};
+
+// 龙卷风图的一条：低值与高值工况的导数平均对数偏移
+struct TornadoBar {
+    QString name;
+    double lowValue = 0.0;
+    double highValue = 0.0;
+    double lowShift = 0.0;
+    double highShift = 0.0;
+    double lowDeviation = 0.0;   // 低值工况的最大周期偏差
+    double highDeviation = 0.0;  // 高值工况的最大周期偏差
+
+    double span() const { return qMax(lowDeviation, highDeviation); }
+};
+
+class SensitivityStudy
+{
+public:
+    // 因素取值改变后更新派生参数 (如 LfD、井储 C -> cD)
+    using ParameterLinker = std::function<void(QMap<QString, double>&)>;
+
+    // 全因子设计工况数的上限 (超出时 fullFactorial 返回空)
+    static const int MaxCases = 2000;
+
+    SensitivityStudy(FittingCore* core, ModelManager::ModelType modelType, const SolverSettings& settings,
+                     const QVector<double>& t, ParameterLinker linker = ParameterLinker());
+
+    ModelManager::ModelType modelType() const { return m_modelType; }
+    const QVector<double>& times() const { return m_t; }
+    const SolverSettings& settings() const { return m_settings; }
+
+    // 设计 (base 为基准参数；各工况均经 linker 更新派生参数)
+    static int fullFactorialSize(const QList<SensitivityFactor>& factors);
+    QVector<SensitivityCase> fullFactorial(const QMap<QString, double>& base, const QList<SensitivityFactor>& factors) const;
+    QVector<SensitivityCase> latinHypercube(const QMap<QString, double>& base, const QList<SensitivityFactor>& factors,
+                                            int count, quint32 seed = 1) const;
+    // 每个因素的低值与高值工况 (顺序为 因素1 低、因素1 高、因素2 低 …)
+    QVector<SensitivityCase> tornado(const QMap<QString, double>& base, const QList<SensitivityFactor>& factors) const;
+    // 基准工况
+    SensitivityCase baseCase(const QMap<QString, double>& base) const;
+
+    /**
+     * @brief 计算各工况的理论曲线 (可在任意线程调用；已缓存的工况直接返回)
+     * @param token 取消令牌 (可为空)；取消后未完成的工况曲线为空
+     * @param progress 输出：已完成的工况数 (含缓存命中，可为空)
+     */
+    QVector<ModelCurveData> evaluate(const QVector<SensitivityCase>& cases, const CancellationToken* token = nullptr,
+                                     QAtomicInteger<int>* progress = nullptr);
+    // 只查缓存：未缓存的工况返回 false
+    bool cachedCurve(const SensitivityCase& c, ModelCurveData& curve) const;
+    int cacheSize() const;
+    void clearCache();
+
+    // 相对基准曲线的指标 (两者应在同一时间网格上)
+    static SensitivityMetrics metrics(const ModelCurveData& reference, const ModelCurveData& curve);
+    // 龙卷风工况 (tornado() 的顺序) 的指标汇总为各因素的条形，按影响从大到小排序
+    static QVector<TornadoBar> tornadoBars(const QVector<SensitivityCase>& cases, const QVector<SensitivityMetrics>& metrics);
+
+private:
+    QByteArray cacheKey(const QMap<QString, double>& params) const;
+    void store(const QByteArray& key, const ModelCurveData& curve);
+    SensitivityCase makeCase(const QMap<QString, double>& base, const QMap<QString, double>& factors) const;
+
+    FittingCore* m_core;
+    ModelManager::ModelType m_modelType;
+    SolverSettings m_settings;
+    QVector<double> m_t;
+    ParameterLinker m_linker;
+
+    // 双代淘汰的曲线缓存 (与 LaplaceEvaluationCache 相同的方式)
+    mutable QMutex m_mutex;
+    QHash<QByteArray, ModelCurveData> m_current;
+    QHash<QByteArray, ModelCurveData> m_previous;
+    int m_capacity;
+};
+
+#endif // SENSITIVITYSTUDY_H
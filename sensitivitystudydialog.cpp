@@ -0,0 +1,437 @@
+/*
+ * 文件名: sensitivitystudydialog.cpp
+ * 文件作用: 敏感性研究对话框实现文件
+ * 功能描述:
+ * 1. 界面由代码构建：上部为研究方式与运行控制，中部为因素表，下部左侧为结果表、右侧为曲线图与龙卷风图。
+ * 2. 结果表的指标均相对基准工况 (第 0 行) 计算；选中多行时按选中顺序着色绘制压差 (实线) 与导数 (虚线)。
+ * 3. 关闭对话框时如计算仍在进行，先取消并等待后台线程结束。
+ */
+
+#include "sensitivitystudydialog.h"
+#include "qcustomplot.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+#include <cmath>
+
+namespace {
+
+enum FactorColumn {
+    FacUse = 0,
+    FacName,
+    FacBase,
+    FacLow,
+    FacHigh,
+    FacLevels,
+    FacLog,
+    FactorColumnCount
+};
+
+const int kMaxPlotted = 12; // 未选中任何工况时默认绘制的条数
+
+void setupLogLogPlot(QCustomPlot* plot)
+{
+    QSharedPointer<QCPAxisTickerLog> logTicker(new QCPAxisTickerLog);
+    plot->xAxis->setScaleType(QCPAxis::stLogarithmic);
+    plot->xAxis->setTicker(logTicker);
+    plot->yAxis->setScaleType(QCPAxis::stLogarithmic);
+    plot->yAxis->setTicker(logTicker);
+    plot->xAxis->setNumberFormat("eb");
+    plot->xAxis->setNumberPrecision(0);
+    plot->yAxis->setNumberFormat("eb");
+    plot->yAxis->setNumberPrecision(0);
+    plot->xAxis->setLabel("时间 Time (h)");
+    plot->yAxis->setLabel("压差 & 导数 (MPa)");
+    plot->legend->setVisible(true);
+    plot->legend->setFont(QFont("Microsoft YaHei", 8));
+    plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+}
+
+QColor caseColor(int i)
+{
+    static const QList<QColor> colors = { Qt::red, Qt::blue, QColor(0, 180, 0), Qt::magenta, QColor(255, 140, 0),
+                                          Qt::cyan, Qt::darkRed, Qt::darkBlue, Qt::darkGreen, Qt::darkMagenta };
+    return colors[i % colors.size()];
+}
+
+} // namespace
+
+SensitivityStudyDialog::SensitivityStudyDialog(QSharedPointer<SensitivityStudy> study, const QMap<QString, double>& base,
+                                               const QList<FitParameter>& params, QWidget* parent)
+    : QDialog(parent), m_study(study), m_base(base), m_done(0)
+{
+    setWindowTitle("敏感性研究");
+    resize(1100, 720);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // 1. 研究方式与运行控制
+    QHBoxLayout* controlLayout = new QHBoxLayout();
+    controlLayout->addWidget(new QLabel("研究方式:", this));
+    m_comboDesign = new QComboBox(this);
+    m_comboDesign->addItem("全因子网格", FullFactorial);
+    m_comboDesign->addItem("拉丁超立方抽样", LatinHypercube);
+    m_comboDesign->addItem("龙卷风 (单因素)", Tornado);
+    controlLayout->addWidget(m_comboDesign);
+    controlLayout->addSpacing(12);
+    controlLayout->addWidget(new QLabel("样本数:", this));
+    m_spinSamples = new QSpinBox(this);
+    m_spinSamples->setRange(2, SensitivityStudy::MaxCases);
+    m_spinSamples->setValue(50);
+    m_spinSamples->setToolTip("拉丁超立方抽样的工况数");
+    controlLayout->addWidget(m_spinSamples);
+    controlLayout->addSpacing(12);
+    controlLayout->addWidget(new QLabel("变化幅度 ±%:", this));
+    m_spinRange = new QDoubleSpinBox(this);
+    m_spinRange->setRange(1.0, 95.0);
+    m_spinRange->setValue(20.0);
+    controlLayout->addWidget(m_spinRange);
+    QPushButton* btnFill = new QPushButton("按幅度填充", this);
+    btnFill->setToolTip("勾选因素的低值与高值设为基准值的 (1 ± 幅度)");
+    controlLayout->addWidget(btnFill);
+    controlLayout->addStretch();
+    m_btnRun = new QPushButton("运行", this);
+    m_btnCancel = new QPushButton("取消", this);
+    m_btnCancel->setEnabled(false);
+    controlLayout->addWidget(m_btnRun);
+    controlLayout->addWidget(m_btnCancel);
+    mainLayout->addLayout(controlLayout);
+
+    // 2. 因素表
+    m_tableFactors = new QTableWidget(this);
+    m_tableFactors->setColumnCount(FactorColumnCount);
+    m_tableFactors->setHorizontalHeaderLabels(QStringList() << "参与" << "参数" << "基准值" << "低值" << "高值"
+                                                            << "水平数" << "对数取值");
+    m_tableFactors->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_tableFactors->verticalHeader()->setVisible(false);
+    m_tableFactors->setMaximumHeight(200);
+    const double range = m_spinRange->value() / 100.0;
+    for (const FitParameter& p : params) {
+        if (!p.isVisible) continue;
+        const int row = m_tableFactors->rowCount();
+        m_tableFactors->insertRow(row);
+
+        QTableWidgetItem* use = new QTableWidgetItem();
+        use->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
+        use->setCheckState(p.isFit ? Qt::Checked : Qt::Unchecked);
+        m_tableFactors->setItem(row, FacUse, use);
+
+        QTableWidgetItem* name = new QTableWidgetItem(p.displayName.isEmpty() ? p.name : p.displayName);
+        name->setData(Qt::UserRole, p.name);
+        name->setFlags(Qt::ItemIsEnabled);
+        m_tableFactors->setItem(row, FacName, name);
+
+        const double value = m_base.value(p.name, p.value);
+        QTableWidgetItem* baseItem = new QTableWidgetItem(QString::number(value, 'g', 6));
+        baseItem->setFlags(Qt::ItemIsEnabled);
+        m_tableFactors->setItem(row, FacBase, baseItem);
+        m_tableFactors->setItem(row, FacLow, new QTableWidgetItem(QString::number(value * (1.0 - range), 'g', 6)));
+        m_tableFactors->setItem(row, FacHigh, new QTableWidgetItem(QString::number(value * (1.0 + range), 'g', 6)));
+        m_tableFactors->setItem(row, FacLevels, new QTableWidgetItem("3"));
+
+        QTableWidgetItem* logItem = new QTableWidgetItem();
+        logItem->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
+        logItem->setCheckState(value > 0.0 ? Qt::Checked : Qt::Unchecked);
+        m_tableFactors->setItem(row, FacLog, logItem);
+    }
+    mainLayout->addWidget(m_tableFactors);
+
+    QHBoxLayout* statusLayout = new QHBoxLayout();
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setValue(0);
+    m_lblStatus = new QLabel(this);
+    statusLayout->addWidget(m_progressBar, 1);
+    statusLayout->addWidget(m_lblStatus, 2);
+    mainLayout->addLayout(statusLayout);
+
+    // 3. 结果表与图
+    QSplitter* splitter = new QSplitter(Qt::Horizontal, this);
+    m_tableResults = new QTableWidget(splitter);
+    m_tableResults->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tableResults->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_tableResults->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_tableResults->verticalHeader()->setVisible(false);
+
+    QTabWidget* tabs = new QTabWidget(splitter);
+    m_plotCurves = new QCustomPlot(tabs);
+    setupLogLogPlot(m_plotCurves);
+    m_plotTornado = new QCustomPlot(tabs);
+    m_plotTornado->xAxis->setLabel("导数平均对数偏移 log10(dp'/dp'基准)");
+    tabs->addTab(m_plotCurves, "曲线");
+    tabs->addTab(m_plotTornado, "龙卷风图");
+    splitter->setStretchFactor(0, 1);
+    splitter->setStretchFactor(1, 1);
+    mainLayout->addWidget(splitter, 1);
+
+    QHBoxLayout* btnLayout = new QHBoxLayout();
+    btnLayout->addStretch();
+    QPushButton* btnClose = new QPushButton("关闭", this);
+    btnLayout->addWidget(btnClose);
+    mainLayout->addLayout(btnLayout);
+
+    connect(m_btnRun, &QPushButton::clicked, this, &SensitivityStudyDialog::onRun);
+    connect(m_btnCancel, &QPushButton::clicked, this, &SensitivityStudyDialog::onCancel);
+    connect(btnFill, &QPushButton::clicked, this, &SensitivityStudyDialog::onFillRange);
+    connect(btnClose, &QPushButton::clicked, this, &SensitivityStudyDialog::reject);
+    connect(m_tableResults, &QTableWidget::itemSelectionChanged, this, &SensitivityStudyDialog::onSelectionChanged);
+    connect(&m_watcher, &QFutureWatcher<QVector<ModelCurveData>>::finished, this, &SensitivityStudyDialog::onFinished);
+    connect(&m_progressTimer, &QTimer::timeout, this, [this]() { m_progressBar->setValue(m_done.loadRelaxed()); });
+    connect(m_comboDesign, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        const Design design = Design(m_comboDesign->currentData().toInt());
+        m_spinSamples->setEnabled(design == LatinHypercube);
+        m_tableFactors->setColumnHidden(FacLevels, design != FullFactorial);
+    });
+    m_spinSamples->setEnabled(false);
+
+    m_lblStatus->setText(QString("已缓存 %1 条曲线").arg(m_study ? m_study->cacheSize() : 0));
+}
+
+SensitivityStudyDialog::~SensitivityStudyDialog()
+{
+    m_cancel.cancel();
+    m_watcher.waitForFinished();
+}
+
+void SensitivityStudyDialog::reject()
+{
+    if (m_watcher.isRunning()) {
+        m_cancel.cancel();
+        m_watcher.waitForFinished();
+    }
+    QDialog::reject();
+}
+
+QList<SensitivityFactor> SensitivityStudyDialog::selectedFactors() const
+{
+    QList<SensitivityFactor> factors;
+    for (int row = 0; row < m_tableFactors->rowCount(); ++row) {
+        if (m_tableFactors->item(row, FacUse)->checkState() != Qt::Checked) continue;
+        SensitivityFactor factor;
+        factor.name = m_tableFactors->item(row, FacName)->data(Qt::UserRole).toString();
+        factor.low = m_tableFactors->item(row, FacLow)->text().toDouble();
+        factor.high = m_tableFactors->item(row, FacHigh)->text().toDouble();
+        factor.levels = qMax(1, m_tableFactors->item(row, FacLevels)->text().toInt());
+        factor.logScale = m_tableFactors->item(row, FacLog)->checkState() == Qt::Checked;
+        factors.append(factor);
+    }
+    return factors;
+}
+
+void SensitivityStudyDialog::onFillRange()
+{
+    const double range = m_spinRange->value() / 100.0;
+    for (int row = 0; row < m_tableFactors->rowCount(); ++row) {
+        if (m_tableFactors->item(row, FacUse)->checkState() != Qt::Checked) continue;
+        const double value = m_tableFactors->item(row, FacBase)->text().toDouble();
+        m_tableFactors->item(row, FacLow)->setText(QString::number(value * (1.0 - range), 'g', 6));
+        m_tableFactors->item(row, FacHigh)->setText(QString::number(value * (1.0 + range), 'g', 6));
+    }
+}
+
+void SensitivityStudyDialog::onRun()
+{
+    if (!m_study || m_watcher.isRunning()) return;
+    const QList<SensitivityFactor> factors = selectedFactors();
+    if (factors.isEmpty()) {
+        QMessageBox::warning(this, "提示", "请至少勾选一个研究参数。");
+        return;
+    }
+
+    m_design = Design(m_comboDesign->currentData().toInt());
+    QVector<SensitivityCase> cases;
+    switch (m_design) {
+    case FullFactorial:
+        if (SensitivityStudy::fullFactorialSize(factors) > SensitivityStudy::MaxCases) {
+            QMessageBox::warning(this, "提示", QString("全因子网格的工况数超过 %1，请减少参数或水平数，或改用拉丁超立方抽样。")
+                                                   .arg(SensitivityStudy::MaxCases));
+            return;
+        }
+        cases = m_study->fullFactorial(m_base, factors);
+        break;
+    case LatinHypercube:
+        cases = m_study->latinHypercube(m_base, factors, m_spinSamples->value());
+        break;
+    case Tornado:
+        cases = m_study->tornado(m_base, factors);
+        break;
+    }
+
+    m_factorNames.clear();
+    for (const SensitivityFactor& factor : factors) m_factorNames.append(factor.name);
+    m_cases = QVector<SensitivityCase>() << m_study->baseCase(m_base);
+    m_cases += cases;
+    m_curves.clear();
+    m_metrics.clear();
+
+    m_cancel.reset();
+    m_done.storeRelaxed(0);
+    m_progressBar->setRange(0, m_cases.size());
+    m_progressBar->setValue(0);
+    m_lblStatus->setText(QString("正在计算 %1 个工况...").arg(m_cases.size()));
+    setRunning(true);
+
+    QSharedPointer<SensitivityStudy> study = m_study;
+    const QVector<SensitivityCase> runCases = m_cases;
+    m_watcher.setFuture(QtConcurrent::run([this, study, runCases]() {
+        return study->evaluate(runCases, &m_cancel, &m_done);
+    }));
+    m_progressTimer.start(100);
+}
+
+void SensitivityStudyDialog::onCancel()
+{
+    m_cancel.cancel();
+    m_lblStatus->setText("正在取消...");
+}
+
+void SensitivityStudyDialog::setRunning(bool running)
+{
+    m_btnRun->setEnabled(!running);
+    m_btnCancel->setEnabled(running);
+    m_comboDesign->setEnabled(!running);
+    m_tableFactors->setEnabled(!running);
+}
+
+void SensitivityStudyDialog::onFinished()
+{
+    m_progressTimer.stop();
+    setRunning(false);
+    m_curves = m_watcher.result();
+    m_progressBar->setValue(m_done.loadRelaxed());
+
+    const ModelCurveData& reference = m_curves.isEmpty() ? ModelCurveData() : m_curves.first();
+    m_metrics.clear();
+    int valid = 0;
+    for (const ModelCurveData& curve : m_curves) {
+        m_metrics.append(SensitivityStudy::metrics(reference, curve));
+        if (!std::get<0>(curve).isEmpty()) ++valid;
+    }
+
+    if (m_cancel.isCancelled()) m_lblStatus->setText(QString("已取消：完成 %1 / %2 个工况").arg(valid).arg(m_cases.size()));
+    else m_lblStatus->setText(QString("完成 %1 个工况 (已缓存 %2 条曲线)").arg(m_cases.size()).arg(m_study->cacheSize()));
+
+    fillResults();
+    plotTornado();
+    QVector<int> rows;
+    for (int i = 0; i < m_cases.size() && rows.size() < kMaxPlotted; ++i) rows.append(i);
+    plotCases(rows);
+}
+
+void SensitivityStudyDialog::fillResults()
+{
+    QStringList headers;
+    headers << "工况";
+    headers += m_factorNames;
+    headers << "导数最大周期偏差" << "导数平均偏移" << "压差最大偏差";
+    m_tableResults->blockSignals(true);
+    m_tableResults->clear();
+    m_tableResults->setColumnCount(headers.size());
+    m_tableResults->setHorizontalHeaderLabels(headers);
+    m_tableResults->setRowCount(m_cases.size());
+    for (int i = 0; i < m_cases.size(); ++i) {
+        const SensitivityCase& c = m_cases[i];
+        QString label = i == 0 ? QString("基准") : QString::number(i);
+        if (!c.tornadoFactor.isEmpty()) label += c.tornadoSide < 0 ? QString(" (%1 低)").arg(c.tornadoFactor)
+                                                                   : QString(" (%1 高)").arg(c.tornadoFactor);
+        m_tableResults->setItem(i, 0, new QTableWidgetItem(label));
+        for (int f = 0; f < m_factorNames.size(); ++f)
+            m_tableResults->setItem(i, 1 + f, new QTableWidgetItem(QString::number(c.params.value(m_factorNames[f]), 'g', 5)));
+
+        const int col = 1 + m_factorNames.size();
+        const SensitivityMetrics& m = m_metrics.value(i);
+        if (m.valid) {
+            m_tableResults->setItem(i, col, new QTableWidgetItem(QString::number(m.maxCycleDeviation, 'f', 4)));
+            m_tableResults->setItem(i, col + 1, new QTableWidgetItem(QString::number(m.derivativeShift, 'f', 4)));
+            m_tableResults->setItem(i, col + 2, new QTableWidgetItem(QString::number(m.maxPressureDeviation, 'f', 4)));
+        } else {
+            m_tableResults->setItem(i, col, new QTableWidgetItem("-"));
+        }
+    }
+    m_tableResults->resizeColumnsToContents();
+    m_tableResults->blockSignals(false);
+}
+
+void SensitivityStudyDialog::onSelectionChanged()
+{
+    QVector<int> rows;
+    for (const QModelIndex& index : m_tableResults->selectionModel()->selectedRows()) rows.append(index.row());
+    std::sort(rows.begin(), rows.end());
+    if (!rows.isEmpty()) plotCases(rows);
+}
+
+void SensitivityStudyDialog::plotCases(const QVector<int>& rows)
+{
+    m_plotCurves->clearGraphs();
+    for (int k = 0; k < rows.size(); ++k) {
+        const int i = rows[k];
+        if (i < 0 || i >= m_curves.size() || std::get<0>(m_curves[i]).isEmpty()) continue;
+        const ModelCurveData& curve = m_curves[i];
+        const QColor color = i == 0 ? QColor(Qt::black) : caseColor(k);
+        const QString name = m_tableResults->item(i, 0) ? m_tableResults->item(i, 0)->text() : QString::number(i);
+
+        QCPGraph* gP = m_plotCurves->addGraph();
+        gP->setData(std::get<0>(curve), std::get<1>(curve));
+        gP->setPen(QPen(color, i == 0 ? 2.5 : 1.5));
+        gP->setName(name);
+        QCPGraph* gD = m_plotCurves->addGraph();
+        gD->setData(std::get<0>(curve), std::get<2>(curve));
+        gD->setPen(QPen(color, i == 0 ? 2.5 : 1.5, Qt::DashLine));
+        gD->removeFromLegend();
+    }
+    m_plotCurves->rescaleAxes();
+    if (m_plotCurves->xAxis->range().lower <= 0) m_plotCurves->xAxis->setRangeLower(1e-4);
+    if (m_plotCurves->yAxis->range().lower <= 0) m_plotCurves->yAxis->setRangeLower(1e-4);
+    m_plotCurves->replot();
+}
+
+void SensitivityStudyDialog::plotTornado()
+{
+    m_plotTornado->clearPlottables();
+    if (m_design != Tornado) {
+        m_plotTornado->replot();
+        return;
+    }
+
+    // 条形从上到下按影响从大到小排列：低值工况 (蓝) 与高值工况 (红) 的导数平均对数偏移
+    const QVector<TornadoBar> bars = SensitivityStudy::tornadoBars(m_cases, m_metrics);
+    QCPBars* low = new QCPBars(m_plotTornado->yAxis, m_plotTornado->xAxis);
+    QCPBars* high = new QCPBars(m_plotTornado->yAxis, m_plotTornado->xAxis);
+    low->setName("低值");
+    high->setName("高值");
+    low->setBrush(QColor(70, 130, 220, 180));
+    high->setBrush(QColor(220, 80, 70, 180));
+    low->setWidth(0.6);
+    high->setWidth(0.6);
+
+    QSharedPointer<QCPAxisTickerText> ticker(new QCPAxisTickerText);
+    QVector<double> ticks, lowShift, highShift;
+    double extent = 1e-6;
+    for (int i = 0; i < bars.size(); ++i) {
+        const double y = bars.size() - i;
+        ticks.append(y);
+        lowShift.append(bars[i].lowShift);
+        highShift.append(bars[i].highShift);
+        ticker->addTick(y, QString("%1 [%2, %3]").arg(bars[i].name).arg(bars[i].lowValue, 0, 'g', 4).arg(bars[i].highValue, 0, 'g', 4));
+        extent = qMax(extent, qMax(std::fabs(bars[i].lowShift), std::fabs(bars[i].highShift)));
+    }
+    low->setData(ticks, lowShift);
+    high->setData(ticks, highShift);
+    m_plotTornado->yAxis->setTicker(ticker);
+    m_plotTornado->yAxis->setRange(0.3, bars.size() + 0.7);
+    m_plotTornado->xAxis->setRange(-1.1 * extent, 1.1 * extent);
+    m_plotTornado->legend->setVisible(true);
+    m_plotTornado->replot();
+}
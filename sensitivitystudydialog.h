@@ -0,0 +1,86 @@
+/*
+ * 文件名: sensitivitystudydialog.h
+ * 文件作用: 敏感性研究对话框头文件
+ * 功能描述:
+ * 1. 在当前拟合参数附近做多参数敏感性研究：全因子网格、拉丁超立方抽样或单因素龙卷风研究 (见 sensitivitystudy.h)。
+ * 2. 参数表勾选研究因素并设置低值、高值、水平数与是否按对数取值；"变化幅度" 一键按基准值 ±x% 填充区间。
+ * 3. 计算在后台线程执行 (可取消)；结果表列出各工况的因素取值与汇总指标，选中若干工况时只从缓存取曲线重绘，
+ *    龙卷风研究另给出按影响排序的龙卷风图。
+ */
+
+#ifndef SENSITIVITYSTUDYDIALOG_H
+#define SENSITIVITYSTUDYDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QTimer>
+#include "fittingparameterchart.h"
+#include "sensitivitystudy.h"
+
+class QComboBox;
+class QSpinBox;
+class QDoubleSpinBox;
+class QTableWidget;
+class QPushButton;
+class QProgressBar;
+class QLabel;
+class QCustomPlot;
+
+class SensitivityStudyDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    // study 由调用方持有，缓存在多次打开对话框之间保留；base 为当前参数 (已换算为求解器参数)
+    SensitivityStudyDialog(QSharedPointer<SensitivityStudy> study, const QMap<QString, double>& base,
+                           const QList<FitParameter>& params, QWidget* parent = nullptr);
+    ~SensitivityStudyDialog();
+
+protected:
+    void reject() override;
+
+private slots:
+    void onRun();
+    void onCancel();
+    void onFinished();
+    void onFillRange();
+    void onSelectionChanged();
+
+private:
+    enum Design { FullFactorial = 0, LatinHypercube, Tornado };
+
+    QList<SensitivityFactor> selectedFactors() const;
+    void fillResults();
+    void plotCases(const QVector<int>& rows);
+    void plotTornado();
+    void setRunning(bool running);
+
+    QSharedPointer<SensitivityStudy> m_study;
+    QMap<QString, double> m_base;
+
+    QComboBox* m_comboDesign;
+    QSpinBox* m_spinSamples;
+    QDoubleSpinBox* m_spinRange;
+    QTableWidget* m_tableFactors;
+    QPushButton* m_btnRun;
+    QPushButton* m_btnCancel;
+    QProgressBar* m_progressBar;
+    QLabel* m_lblStatus;
+    QTableWidget* m_tableResults;
+    QCustomPlot* m_plotCurves;
+    QCustomPlot* m_plotTornado;
+
+    // 本次运行：第 0 个工况为基准
+    Design m_design = FullFactorial;
+    QVector<SensitivityCase> m_cases;
+    QVector<ModelCurveData> m_curves;
+    QVector<SensitivityMetrics> m_metrics;
+    QStringList m_factorNames;
+
+    CancellationToken m_cancel;
+    QAtomicInteger<int> m_done;
+    QFutureWatcher<QVector<ModelCurveData>> m_watcher;
+    QTimer m_progressTimer;
+};
+
+#endif // SENSITIVITYSTUDYDIALOG_H
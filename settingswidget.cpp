@@ -6,12 +6,29 @@
  * 2. 实现五个功能模块（通用、单位、绘图、路径、系统）的具体的加载与保存逻辑
  * 3. 实现路径选择对话框的弹出与回填
  * 4. 实现“恢复默认值”逻辑，重置所有控件状态
+ * 5. [硬件加速] 绘图页的 OpenGL 开关保存为 plot/openGl，由主窗口在设置变更时交给所有图表
+ * 6. [性能跟踪] 系统页的跟踪开关保存为 diagnostics/traceEnabled，保存时立即生效；
+ *    导出按钮只发出 traceExportRequested，文件选择与写出由主窗口完成
+ * 7. [性能设置] 性能页的设置项与各计算模块读取的键一致 (performance/workerThreads、solver/*、fitting/theoryCurveCacheEntries、
+ *    display/*)；OpenGL 开关由绘图页移到性能页的显示分组，键仍为 plot/openGl。保存后发出 performanceSettingsChanged，
+ *    由主窗口把线程数、缓存上限与求解器默认值交给运行中的各模块
+ * 8. [内存诊断] 系统页的分配计数开关保存为 diagnostics/memoryAccountingEnabled，保存时立即生效 (未编译分配计数时开关不可用)；
+ *    诊断按钮只发出 memoryDiagnosticsRequested，面板由主窗口打开
+ * 9. [可复现拟合] 性能页的可复现开关保存为 fitting/reproducible，作为新建拟合分析的默认值 (已保存的分析沿用各自的设置)
+ * 10. [批量求值后端] 下拉框只列出本次编译可用的后端，保存为 performance/laplaceBackend；
+ *     设备后端回退到 CPU 的原因显示在下拉框的提示中
+ * 11. [页签驻留] 缓存分组的页签内存预算与压缩时间保存为 performance/sheetMemoryBudgetMB、performance/sheetIdleMinutes
  */
 
 #include "settingswidget.h"
 #include "ui_settingswidget.h"
 #include <QDebug>
 #include <QDate>
+#include "tracing.h"
+#include "memoryaccounting.h"
+#include "laplaceinversion.h"
+#include "laplacebatchbackend.h"
+#include <QThread>
 
 // 默认常量定义
 const int SettingsWidget::DEFAULT_AUTO_SAVE = 10;
@@ -74,6 +91,18 @@ void SettingsWidget::initInterface()
     // 4. 初始化日志级别
     ui->cmbLogLevel->clear();
     ui->cmbLogLevel->addItems({"仅错误 (Error)", "警告与错误 (Warning)", "一般信息 (Info)", "详细调试 (Debug)"});
+
+    // 5. 初始化性能页 (下拉框顺序即设置项的取值)
+    ui->spinWorkerThreads->setSpecialValueText(QString("自动 (%1 线程)").arg(QThread::idealThreadCount()));
+    ui->cmbInversionMethod->clear();
+    for (int m = LaplaceInversion::Stehfest; m <= LaplaceInversion::Euler; ++m)
+        ui->cmbInversionMethod->addItem(LaplaceInversion::methodName((LaplaceInversion::Method)m));
+    ui->spinInversionOrder->setSpecialValueText("默认");
+    ui->cmbLaplaceBackend->clear();
+    for (const QString& name : LaplaceBatchBackend::availableBackends())
+        ui->cmbLaplaceBackend->addItem(name == "cpu" ? QString("CPU (线程池)") : name, name);
+    ui->cmbPreviewQuality->clear();
+    ui->cmbPreviewQuality->addItems({"低 (150 点，响应最快)", "标准 (300 点)", "高 (600 点)"});
 }
 
 void SettingsWidget::loadSettings()
@@ -91,6 +120,7 @@ void SettingsWidget::loadSettings()
     ui->cmbPlotBackground->setCurrentIndex(m_settings->value("plot/background", 0).toInt());
     ui->chkShowGrid->setChecked(m_settings->value("plot/showGrid", true).toBool());
     ui->spinLineWidth->setValue(m_settings->value("plot/lineWidth", 2).toInt());
+    ui->chkOpenGl->setChecked(m_settings->value("plot/openGl", false).toBool());
 
     // --- 4. 路径设置 ---
     QString docPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
@@ -105,6 +135,27 @@ void SettingsWidget::loadSettings()
     ui->chkCleanupLogs->setChecked(m_settings->value("system/cleanupLogs", true).toBool());
     ui->spinLogDays->setValue(m_settings->value("system/logRetention", 30).toInt());
     ui->cmbLogLevel->setCurrentIndex(m_settings->value("system/logLevel", 2).toInt());
+    ui->chkTraceEnabled->setChecked(m_settings->value("diagnostics/traceEnabled", false).toBool());
+    ui->chkMemoryAccounting->setChecked(m_settings->value("diagnostics/memoryAccountingEnabled", false).toBool());
+    ui->chkMemoryAccounting->setEnabled(MemoryAccounting::isCompiledIn());
+
+    // --- 6. 性能设置 ---
+    ui->spinWorkerThreads->setValue(m_settings->value("performance/workerThreads", 0).toInt());
+    ui->chkReproducibleFit->setChecked(m_settings->value("fitting/reproducible", false).toBool());
+    ui->cmbInversionMethod->setCurrentIndex(m_settings->value("solver/inversionMethod", 0).toInt());
+    ui->spinInversionOrder->setValue(m_settings->value("solver/inversionOrder", 0).toInt());
+    ui->spinFractureSegments->setValue(m_settings->value("solver/defaultFractureSegments", 10).toInt());
+    ui->cmbLaplaceBackend->setCurrentIndex(qMax(0, ui->cmbLaplaceBackend->findData(m_settings->value("performance/laplaceBackend", "cpu").toString())));
+    ui->cmbLaplaceBackend->setToolTip(LaplaceBatchBackend::lastFallbackReason());
+    ui->chkLaplaceCache->setChecked(m_settings->value("solver/laplaceCacheEnabled", true).toBool());
+    ui->spinLaplaceCacheCapacity->setValue(m_settings->value("solver/laplaceCacheCapacity", 65536).toInt());
+    ui->spinCurveCacheEntries->setValue(m_settings->value("fitting/theoryCurveCacheEntries", 256).toInt());
+    ui->spinSheetMemoryBudget->setValue(m_settings->value("performance/sheetMemoryBudgetMB", 2048).toInt());
+    ui->spinSheetIdleMinutes->setValue(m_settings->value("performance/sheetIdleMinutes", 30).toInt());
+    ui->chkTypeCurveLibrary->setChecked(m_settings->value("solver/typeCurveLibraryEnabled", false).toBool());
+    ui->lineTypeCurveDir->setText(m_settings->value("solver/typeCurveLibraryDir").toString());
+    ui->cmbPreviewQuality->setCurrentIndex(m_settings->value("display/previewQuality", 1).toInt());
+    ui->chkAdaptiveSampling->setChecked(m_settings->value("display/adaptiveSampling", true).toBool());
 
     m_isModified = false;
 }
@@ -127,6 +178,7 @@ void SettingsWidget::applySettings()
     m_settings->setValue("plot/background", ui->cmbPlotBackground->currentIndex());
     m_settings->setValue("plot/showGrid", ui->chkShowGrid->isChecked());
     m_settings->setValue("plot/lineWidth", ui->spinLineWidth->value());
+    m_settings->setValue("plot/openGl", ui->chkOpenGl->isChecked());
 
     m_settings->setValue("paths/data", ui->lineDataPath->text());
     m_settings->setValue("paths/report", ui->lineReportPath->text());
@@ -138,13 +190,34 @@ void SettingsWidget::applySettings()
     m_settings->setValue("system/cleanupLogs", ui->chkCleanupLogs->isChecked());
     m_settings->setValue("system/logRetention", ui->spinLogDays->value());
     m_settings->setValue("system/logLevel", ui->cmbLogLevel->currentIndex());
+    m_settings->setValue("diagnostics/traceEnabled", ui->chkTraceEnabled->isChecked());
+    m_settings->setValue("diagnostics/memoryAccountingEnabled", ui->chkMemoryAccounting->isChecked());
+
+    m_settings->setValue("performance/workerThreads", ui->spinWorkerThreads->value());
+    m_settings->setValue("fitting/reproducible", ui->chkReproducibleFit->isChecked());
+    m_settings->setValue("solver/inversionMethod", ui->cmbInversionMethod->currentIndex());
+    m_settings->setValue("solver/inversionOrder", ui->spinInversionOrder->value());
+    m_settings->setValue("solver/defaultFractureSegments", ui->spinFractureSegments->value());
+    m_settings->setValue("performance/laplaceBackend", ui->cmbLaplaceBackend->currentData().toString());
+    m_settings->setValue("solver/laplaceCacheEnabled", ui->chkLaplaceCache->isChecked());
+    m_settings->setValue("solver/laplaceCacheCapacity", ui->spinLaplaceCacheCapacity->value());
+    m_settings->setValue("fitting/theoryCurveCacheEntries", ui->spinCurveCacheEntries->value());
+    m_settings->setValue("performance/sheetMemoryBudgetMB", ui->spinSheetMemoryBudget->value());
+    m_settings->setValue("performance/sheetIdleMinutes", ui->spinSheetIdleMinutes->value());
+    m_settings->setValue("solver/typeCurveLibraryEnabled", ui->chkTypeCurveLibrary->isChecked());
+    m_settings->setValue("solver/typeCurveLibraryDir", ui->lineTypeCurveDir->text());
+    m_settings->setValue("display/previewQuality", ui->cmbPreviewQuality->currentIndex());
+    m_settings->setValue("display/adaptiveSampling", ui->chkAdaptiveSampling->isChecked());
 
     m_settings->sync(); // 强制写入磁盘
+    Trace::setEnabled(ui->chkTraceEnabled->isChecked());
+    MemoryAccounting::setEnabled(ui->chkMemoryAccounting->isChecked());
 
     // 发射信号通知系统其他部分
     emit settingsChanged();
     emit unitSystemChanged();
     emit plotStyleChanged();
+    emit performanceSettingsChanged();
 
     QMessageBox::information(this, "系统设置", "设置已保存并生效！");
     m_isModified = false;
@@ -199,7 +272,8 @@ void SettingsWidget::on_navTupleList_currentRowChanged(int currentRow)
         "单位与精度 - 物理量单位配置",
         "绘图设置 - 图表默认风格",
         "路径配置 - 文件存储位置",
-        "系统与日志 - 运行维护设置"
+        "系统与日志 - 运行维护设置",
+        "性能 - 线程、求解器与缓存"
     };
     if(currentRow >= 0 && currentRow < titles.size())
         ui->lblPageTitle->setText(titles[currentRow]);
@@ -219,6 +293,19 @@ void SettingsWidget::on_btnBrowseBackup_clicked() {
     if(!dir.isEmpty()) ui->lineBackupPath->setText(dir);
 }
 
+void SettingsWidget::on_btnBrowseTypeCurveDir_clicked() {
+    QString dir = QFileDialog::getExistingDirectory(this, "选择类型曲线库目录", ui->lineTypeCurveDir->text());
+    if(!dir.isEmpty()) ui->lineTypeCurveDir->setText(dir);
+}
+
+void SettingsWidget::on_btnExportTrace_clicked() {
+    emit traceExportRequested();
+}
+
+void SettingsWidget::on_btnMemoryDiagnostics_clicked() {
+    emit memoryDiagnosticsRequested();
+}
+
 // 槽函数：底部按钮
 void SettingsWidget::on_btnRestoreDefaults_clicked() {
     restoreDefaults();
@@ -240,8 +327,10 @@ QString SettingsWidget::getReportPath() const { return ui->lineReportPath->text(
 QString SettingsWidget::getBackupPath() const { return ui->lineBackupPath->text(); }
 int SettingsWidget::getAutoSaveInterval() const { return ui->spinAutoSave->value(); }
 bool SettingsWidget::isBackupEnabled() const { return ui->chkEnableBackup->isChecked(); }
+int SettingsWidget::getMaxBackups() const { return ui->spinMaxBackups->value(); }
 int SettingsWidget::getPressureUnitIndex() const { return ui->cmbPressureUnit->currentIndex(); }
 int SettingsWidget::getRateUnitIndex() const { return ui->cmbRateUnit->currentIndex(); }
 int SettingsWidget::getPrecision() const { return ui->spinPrecision->value(); }
 int SettingsWidget::getPlotBackgroundStyle() const { return ui->cmbPlotBackground->currentIndex(); }
 bool SettingsWidget::isGridVisibleDefault() const { return ui->chkShowGrid->isChecked(); }
+bool SettingsWidget::isOpenGlEnabled() const { return ui->chkOpenGl->isChecked(); }
@@ -6,6 +6,8 @@
  * 2. 声明各个设置模块（通用、单位、绘图、路径、系统）的 UI 组件交互逻辑
  * 3. 声明配置数据的加载 (load)、保存 (apply) 和恢复默认 (restoreDefaults) 方法
  * 4. 定义配置变更的信号，供主程序响应（如切换单位、修改绘图风格）
+ * 5. [性能跟踪] 系统页的跟踪开关与导出按钮，导出请求由主窗口处理
+ * 6. [性能设置] 性能页 (线程数、求解器默认值、缓存上限、类型曲线库、预览质量与绘图后端)，保存后经 performanceSettingsChanged 即时应用
  */
 
 #ifndef SETTINGSWIDGET_H
@@ -41,6 +43,7 @@ public:
     // 系统配置
     int getAutoSaveInterval() const;
     bool isBackupEnabled() const;
+    int getMaxBackups() const;
 
     // 单位配置 [新增]
     int getPressureUnitIndex() const; // 0: MPa, 1: psi
@@ -50,6 +53,7 @@ public:
     // 绘图配置 [新增]
     int getPlotBackgroundStyle() const; // 0: 白色, 1: 深色
     bool isGridVisibleDefault() const;
+    bool isOpenGlEnabled() const;       // 硬件加速绘图
 
 signals:
     // 配置变更信号
@@ -57,6 +61,9 @@ signals:
     void themeChanged(int themeIdx);  // 主题变更
     void unitSystemChanged();         // 单位制变更
     void plotStyleChanged();          // 绘图风格变更
+    void traceExportRequested();      // 请求导出性能跟踪文件
+    void memoryDiagnosticsRequested(); // 请求打开内存诊断面板
+    void performanceSettingsChanged(); // 性能设置变更 (已写入设置项)
 
 private slots:
     // 侧边导航栏切换
@@ -66,6 +73,12 @@ private slots:
     void on_btnBrowseData_clicked();
     void on_btnBrowseReport_clicked();
     void on_btnBrowseBackup_clicked();
+    void on_btnBrowseTypeCurveDir_clicked();
+
+    // 导出性能跟踪
+    void on_btnExportTrace_clicked();
+    // 打开内存诊断面板
+    void on_btnMemoryDiagnostics_clicked();
 
     // 底部操作按钮
     void on_btnRestoreDefaults_clicked(); // 恢复默认
@@ -0,0 +1,507 @@
+/*
+ * sheetfilterproxy.cpp
+ * 文件作用: 数据表的后台过滤与排序代理模型实现文件
+ * 功能描述:
+ * 1. runQuery 取源模型的隐式共享快照与已缓存的有序索引，交给线程池执行；结果带查询序号与源数据修订号，
+ *    两者都与当前一致时才替换行映射 (一次模型复位)，否则丢弃或重新查询。
+ * 2. 范围条件在有序索引的数值段上二分查找，文本条件按 16384 行一段并行匹配；排序直接按有序索引输出。
+ * 3. 查询线程只使用按值传入的快照、索引与取消令牌，不访问本对象，析构时无需等待。
+ */
+
+#include "sheetfilterproxy.h"
+
+#include <QtConcurrent>
+#include <QRegularExpression>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+const int kDebounceMsecs = 250;
+const int kTextChunkRows = 16384;
+
+// 文本条件：含 * 或 ? 时按通配符匹配，否则为包含匹配 (均不区分大小写)
+struct TextMatcher {
+    QString text;
+    QRegularExpression pattern;
+    bool wildcard = false;
+
+    explicit TextMatcher(const QString& t)
+        : text(t), wildcard(t.contains(QLatin1Char('*')) || t.contains(QLatin1Char('?')))
+    {
+        if (wildcard) {
+            pattern = QRegularExpression(
+                QRegularExpression::wildcardToRegularExpression(t, QRegularExpression::UnanchoredWildcardConversion),
+                QRegularExpression::CaseInsensitiveOption);
+        }
+    }
+
+    bool matches(const QString& cell) const
+    {
+        if (cell.isEmpty()) return false;
+        return wildcard ? pattern.match(cell).hasMatch() : cell.contains(text, Qt::CaseInsensitive);
+    }
+};
+
+// 列名解析：$N、[表头]、表头全文或表头中 '\' 之前的名称 (不区分大小写)
+int resolveColumn(QString name, const QStringList& headers)
+{
+    name = name.trimmed();
+    if (name.startsWith(QLatin1Char('[')) && name.endsWith(QLatin1Char(']'))) name = name.mid(1, name.size() - 2).trimmed();
+    if (name.isEmpty()) return -1;
+    if (name.startsWith(QLatin1Char('$'))) {
+        bool ok = false;
+        const int n = name.mid(1).toInt(&ok);
+        return (ok && n >= 1 && n <= headers.size()) ? n - 1 : -1;
+    }
+    for (int i = 0; i < headers.size(); ++i) {
+        if (QString::compare(headers[i].trimmed(), name, Qt::CaseInsensitive) == 0) return i;
+    }
+    for (int i = 0; i < headers.size(); ++i) {
+        if (QString::compare(headers[i].section(QLatin1Char('\\'), 0, 0).trimmed(), name, Qt::CaseInsensitive) == 0) return i;
+    }
+    return -1;
+}
+}
+
+SheetFilterProxy::SheetFilterProxy(QObject* parent)
+    : QAbstractProxyModel(parent)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(kDebounceMsecs);
+    connect(&m_debounce, &QTimer::timeout, this, &SheetFilterProxy::runQuery);
+    connect(&m_watcher, &QFutureWatcher<Result>::finished, this, &SheetFilterProxy::onQueryFinished);
+}
+
+SheetFilterProxy::~SheetFilterProxy()
+{
+    m_debounce.stop();
+    if (m_cancel) m_cancel->cancel();
+}
+
+void SheetFilterProxy::setSourceModel(QAbstractItemModel* sourceModel)
+{
+    beginResetModel();
+    if (m_source) disconnect(m_source, nullptr, this, nullptr);
+    m_source = qobject_cast<ColumnarTableModel*>(sourceModel);
+    QAbstractProxyModel::setSourceModel(m_source);
+    resetToIdentity();
+    m_indices.clear();
+    ++m_revision;
+    connectSource();
+    endResetModel();
+}
+
+void SheetFilterProxy::connectSource()
+{
+    if (!m_source) return;
+
+    connect(m_source, &QAbstractItemModel::rowsAboutToBeInserted, this, [this](const QModelIndex&, int first, int last) {
+        if (m_mapped) beginStructureChange();
+        else beginInsertRows(QModelIndex(), first, last);
+    });
+    connect(m_source, &QAbstractItemModel::rowsInserted, this, [this]() {
+        sourceChanged();
+        if (m_structureReset) endStructureChange();
+        else endInsertRows();
+    });
+    connect(m_source, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this](const QModelIndex&, int first, int last) {
+        if (m_mapped) beginStructureChange();
+        else beginRemoveRows(QModelIndex(), first, last);
+    });
+    connect(m_source, &QAbstractItemModel::rowsRemoved, this, [this]() {
+        sourceChanged();
+        if (m_structureReset) endStructureChange();
+        else endRemoveRows();
+    });
+    connect(m_source, &QAbstractItemModel::columnsAboutToBeInserted, this, [this](const QModelIndex&, int first, int last) {
+        if (m_mapped) beginStructureChange();
+        else beginInsertColumns(QModelIndex(), first, last);
+    });
+    connect(m_source, &QAbstractItemModel::columnsInserted, this, [this]() {
+        sourceChanged();
+        if (m_structureReset) endStructureChange();
+        else endInsertColumns();
+    });
+    connect(m_source, &QAbstractItemModel::columnsAboutToBeRemoved, this, [this](const QModelIndex&, int first, int last) {
+        if (m_mapped) beginStructureChange();
+        else beginRemoveColumns(QModelIndex(), first, last);
+    });
+    connect(m_source, &QAbstractItemModel::columnsRemoved, this, [this]() {
+        sourceChanged();
+        if (m_structureReset) endStructureChange();
+        else endRemoveColumns();
+    });
+
+    // 行列移动、整体复位与布局变化一律按模型复位处理
+    auto begin = [this]() { beginStructureChange(); };
+    auto end = [this]() { sourceChanged(); endStructureChange(); };
+    connect(m_source, &QAbstractItemModel::rowsAboutToBeMoved, this, begin);
+    connect(m_source, &QAbstractItemModel::rowsMoved, this, end);
+    connect(m_source, &QAbstractItemModel::columnsAboutToBeMoved, this, begin);
+    connect(m_source, &QAbstractItemModel::columnsMoved, this, end);
+    connect(m_source, &QAbstractItemModel::modelAboutToBeReset, this, begin);
+    connect(m_source, &QAbstractItemModel::modelReset, this, end);
+    connect(m_source, &QAbstractItemModel::layoutAboutToBeChanged, this, begin);
+    connect(m_source, &QAbstractItemModel::layoutChanged, this, end);
+
+    connect(m_source, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex& topLeft, const QModelIndex& bottomRight, const QList<int>& roles) {
+        // 只有单元格内容的修改影响过滤与排序 (背景色等不影响)
+        const bool contentChanged = roles.isEmpty() || roles.contains(Qt::DisplayRole) || roles.contains(Qt::EditRole);
+        if (contentChanged) {
+            sourceChanged();
+            if (!filterText().isEmpty() || m_sortColumn >= 0) m_debounce.start();
+        }
+        if (!m_mapped) {
+            emit dataChanged(index(topLeft.row(), topLeft.column()), index(bottomRight.row(), bottomRight.column()), roles);
+            return;
+        }
+        if (topLeft.row() == bottomRight.row()) {
+            const QModelIndex mapped = mapFromSource(topLeft);
+            if (mapped.isValid())
+                emit dataChanged(mapped, index(mapped.row(), bottomRight.column()), roles);
+            return;
+        }
+        if (!m_rows.isEmpty())
+            emit dataChanged(index(0, topLeft.column()), index(m_rows.size() - 1, bottomRight.column()), roles);
+    });
+    connect(m_source, &QAbstractItemModel::headerDataChanged, this, [this](Qt::Orientation orientation, int first, int last) {
+        if (orientation == Qt::Horizontal || !m_mapped) emit headerDataChanged(orientation, first, last);
+        else if (!m_rows.isEmpty()) emit headerDataChanged(Qt::Vertical, 0, m_rows.size() - 1);
+    });
+}
+
+void SheetFilterProxy::sourceChanged()
+{
+    ++m_revision;
+    m_indices.clear();
+}
+
+void SheetFilterProxy::beginStructureChange()
+{
+    if (m_structureReset) return;
+    m_structureReset = true;
+    beginResetModel();
+}
+
+void SheetFilterProxy::endStructureChange()
+{
+    if (!m_structureReset) return;
+    const bool wasMapped = m_mapped;
+    resetToIdentity();
+    m_structureReset = false;
+    endResetModel();
+    if (wasMapped || !filterText().isEmpty() || m_sortColumn >= 0) m_debounce.start();
+}
+
+void SheetFilterProxy::resetToIdentity()
+{
+    m_mapped = false;
+    m_rows.clear();
+    m_inverse.clear();
+}
+
+QStringList SheetFilterProxy::sourceHeaders() const
+{
+    QStringList headers;
+    if (!m_source) return headers;
+    for (int i = 0; i < m_source->columnCount(); ++i) headers.append(m_source->headerText(i));
+    return headers;
+}
+
+SheetFilterProxy::Query SheetFilterProxy::parseFilter(const QString& text, const QStringList& headers)
+{
+    static const QRegularExpression between(QStringLiteral("^(.+?)\\s+between\\s+(\\S+)\\s+and\\s+(\\S+)(?:\\s+\\S+)?$"),
+                                            QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression compare(QStringLiteral("^(.+?)\\s*(>=|<=|>|<|=)\\s*(\\S+)(?:\\s+\\S+)?$"));
+    const double inf = std::numeric_limits<double>::infinity();
+
+    Query query;
+    QString normalized = text;
+    normalized.replace(QChar(0xFF1B), QLatin1Char(';')); // 全角分号
+    const QStringList clauses = normalized.split(QLatin1Char(';'), Qt::SkipEmptyParts);
+    for (const QString& raw : clauses) {
+        const QString clause = raw.trimmed();
+        if (clause.isEmpty()) continue;
+
+        RangeFilter range;
+        bool isRange = false;
+        QRegularExpressionMatch m = between.match(clause);
+        if (m.hasMatch()) {
+            bool ok1 = false, ok2 = false;
+            const double a = m.captured(2).toDouble(&ok1);
+            const double b = m.captured(3).toDouble(&ok2);
+            range.column = resolveColumn(m.captured(1), headers);
+            if (range.column >= 0 && ok1 && ok2) {
+                range.minimum = qMin(a, b);
+                range.maximum = qMax(a, b);
+                isRange = true;
+            }
+        } else if ((m = compare.match(clause)).hasMatch()) {
+            bool ok = false;
+            const double x = m.captured(3).toDouble(&ok);
+            range.column = resolveColumn(m.captured(1), headers);
+            if (range.column >= 0 && ok) {
+                const QString op = m.captured(2);
+                range.minimum = -inf;
+                range.maximum = inf;
+                if (op == ">=") range.minimum = x;
+                else if (op == ">") range.minimum = std::nextafter(x, inf);
+                else if (op == "<=") range.maximum = x;
+                else if (op == "<") range.maximum = std::nextafter(x, -inf);
+                else range.minimum = range.maximum = x;
+                isRange = true;
+            }
+        }
+
+        if (isRange) query.ranges.append(range);
+        else query.texts.append(clause);
+    }
+    return query;
+}
+
+void SheetFilterProxy::setFilterText(const QString& text)
+{
+    if (text == m_filterText) return;
+    m_filterText = text;
+    m_debounce.start();
+}
+
+void SheetFilterProxy::sort(int column, Qt::SortOrder order)
+{
+    m_sortColumn = column;
+    m_sortOrder = order;
+    runQuery();
+}
+
+void SheetFilterProxy::runQuery()
+{
+    m_debounce.stop();
+    if (!m_source) return;
+    if (m_cancel) m_cancel->cancel();
+    ++m_generation;
+
+    Query query = parseFilter(m_filterText, sourceHeaders());
+    query.sortColumn = m_sortColumn < m_source->columnCount() ? m_sortColumn : -1;
+    query.sortOrder = m_sortOrder;
+    if (query.isEmpty()) {
+        m_cancel.reset();
+        if (m_mapped) {
+            beginResetModel();
+            resetToIdentity();
+            endResetModel();
+            emit queryFinished(rowCount(), m_source->rowCount());
+        }
+        return;
+    }
+
+    m_cancel = QSharedPointer<CancellationToken>::create();
+    const ColumnarTableModel::Snapshot snapshot = m_source->snapshot();
+    const IndexCache indices = m_indices;
+    const QSharedPointer<CancellationToken> token = m_cancel;
+    const quint64 generation = m_generation;
+    const quint64 revision = m_revision;
+    m_watcher.setFuture(QtConcurrent::run([snapshot, query, indices, token, generation, revision]() {
+        Result result = executeQuery(snapshot, query, indices, token);
+        result.generation = generation;
+        result.revision = revision;
+        return result;
+    }));
+}
+
+void SheetFilterProxy::onQueryFinished()
+{
+    const Result result = m_watcher.result();
+    if (result.generation != m_generation || result.cancelled) return; // 已有更新的查询
+    if (result.revision != m_revision) {
+        runQuery(); // 查询期间数据已修改
+        return;
+    }
+
+    for (auto it = result.builtIndices.constBegin(); it != result.builtIndices.constEnd(); ++it)
+        m_indices.insert(it.key(), it.value());
+
+    beginResetModel();
+    m_mapped = !result.identity;
+    m_rows = result.identity ? QVector<int>() : result.rows;
+    m_inverse.clear();
+    endResetModel();
+    emit queryFinished(rowCount(), m_source->rowCount());
+}
+
+QSharedPointer<const SheetFilterProxy::SortedIndex>
+SheetFilterProxy::buildSortedIndex(const ColumnarTableModel::Snapshot& snapshot, int column)
+{
+    const QVector<double>& values = snapshot.values[column];
+    const QVector<qint32>& textIds = snapshot.textIds[column];
+
+    QVector<int> numeric, text, empty;
+    numeric.reserve(snapshot.rows);
+    for (int row = 0; row < snapshot.rows; ++row) {
+        if (snapshot.isText(row, column)) text.append(row);
+        else if (std::isnan(values[row])) empty.append(row);
+        else numeric.append(row);
+    }
+    std::stable_sort(numeric.begin(), numeric.end(), [&values](int a, int b) { return values[a] < values[b]; });
+    std::stable_sort(text.begin(), text.end(), [&](int a, int b) {
+        return QString::compare(snapshot.strings[textIds[a]], snapshot.strings[textIds[b]], Qt::CaseInsensitive) < 0;
+    });
+
+    QSharedPointer<SortedIndex> index = QSharedPointer<SortedIndex>::create();
+    index->numericCount = numeric.size();
+    index->nonEmptyCount = numeric.size() + text.size();
+    index->rows = numeric;
+    index->rows += text;
+    index->rows += empty;
+    return index;
+}
+
+SheetFilterProxy::Result SheetFilterProxy::executeQuery(const ColumnarTableModel::Snapshot& snapshot, const Query& query,
+                                                        IndexCache indices, const QSharedPointer<CancellationToken>& token)
+{
+    Result result;
+    const int rows = snapshot.rows;
+    const int columns = snapshot.columnCount();
+
+    auto indexFor = [&](int column) {
+        auto it = indices.constFind(column);
+        if (it != indices.constEnd()) return it.value();
+        QSharedPointer<const SortedIndex> index = buildSortedIndex(snapshot, column);
+        indices.insert(column, index);
+        result.builtIndices.insert(column, index);
+        return index;
+    };
+
+    std::vector<unsigned char> pass(rows, 1);
+
+    // 范围条件：有序索引数值段上的二分查找
+    for (const RangeFilter& range : query.ranges) {
+        if (token->isCancelled()) {
+            result.cancelled = true;
+            return result;
+        }
+        std::vector<unsigned char> hit(rows, 0);
+        if (range.column >= 0 && range.column < columns) {
+            const QSharedPointer<const SortedIndex> index = indexFor(range.column);
+            const QVector<double>& values = snapshot.values[range.column];
+            const auto begin = index->rows.constBegin();
+            const auto numericEnd = begin + index->numericCount;
+            const auto lo = std::lower_bound(begin, numericEnd, range.minimum,
+                                             [&values](int row, double v) { return values[row] < v; });
+            const auto hi = std::upper_bound(lo, numericEnd, range.maximum,
+                                             [&values](double v, int row) { return v < values[row]; });
+            for (auto it = lo; it != hi; ++it) hit[*it] = 1;
+        }
+        for (int row = 0; row < rows; ++row) pass[row] &= hit[row];
+    }
+
+    // 文本条件：每个条件须有一列匹配，分段并行
+    if (!query.texts.isEmpty()) {
+        QVector<TextMatcher> matchers;
+        for (const QString& t : query.texts) matchers.append(TextMatcher(t));
+
+        QVector<QPair<int, int>> chunks;
+        for (int start = 0; start < rows; start += kTextChunkRows) chunks.append(qMakePair(start, qMin(rows, start + kTextChunkRows)));
+        unsigned char* passData = pass.data();
+        QtConcurrent::blockingMap(chunks, [&](const QPair<int, int>& chunk) {
+            for (int row = chunk.first; row < chunk.second; ++row) {
+                if (!passData[row]) continue;
+                if (token->isCancelled()) return;
+                for (const TextMatcher& matcher : matchers) {
+                    bool any = false;
+                    for (int column = 0; column < columns && !any; ++column)
+                        any = matcher.matches(snapshot.text(row, column));
+                    if (!any) {
+                        passData[row] = 0;
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    if (token->isCancelled()) {
+        result.cancelled = true;
+        return result;
+    }
+
+    // 输出顺序：排序列的有序索引 (降序时非空段反向，空单元格仍在最后)，否则为原行序
+    result.identity = !query.hasFilter() && query.sortColumn < 0;
+    if (result.identity) return result;
+    result.rows.reserve(rows);
+    if (query.sortColumn >= 0 && query.sortColumn < columns) {
+        const QSharedPointer<const SortedIndex> index = indexFor(query.sortColumn);
+        const QVector<int>& order = index->rows;
+        if (query.sortOrder == Qt::AscendingOrder) {
+            for (int row : order) if (pass[row]) result.rows.append(row);
+        } else {
+            for (int i = index->nonEmptyCount - 1; i >= 0; --i) if (pass[order[i]]) result.rows.append(order[i]);
+            for (int i = index->nonEmptyCount; i < order.size(); ++i) if (pass[order[i]]) result.rows.append(order[i]);
+        }
+    } else {
+        for (int row = 0; row < rows; ++row) if (pass[row]) result.rows.append(row);
+    }
+    return result;
+}
+
+QModelIndex SheetFilterProxy::index(int row, int column, const QModelIndex& parent) const
+{
+    if (parent.isValid() || row < 0 || column < 0 || row >= rowCount() || column >= columnCount()) return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex SheetFilterProxy::parent(const QModelIndex&) const
+{
+    return QModelIndex();
+}
+
+QModelIndex SheetFilterProxy::sibling(int row, int column, const QModelIndex&) const
+{
+    return index(row, column);
+}
+
+int SheetFilterProxy::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() || !m_source) return 0;
+    return m_mapped ? m_rows.size() : m_source->rowCount();
+}
+
+int SheetFilterProxy::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() || !m_source) return 0;
+    return m_source->columnCount();
+}
+
+QModelIndex SheetFilterProxy::mapToSource(const QModelIndex& proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !m_source) return QModelIndex();
+    if (!m_mapped) return m_source->index(proxyIndex.row(), proxyIndex.column());
+    if (proxyIndex.row() >= m_rows.size()) return QModelIndex();
+    return m_source->index(m_rows[proxyIndex.row()], proxyIndex.column());
+}
+
+QModelIndex SheetFilterProxy::mapFromSource(const QModelIndex& sourceIndex) const
+{
+    if (!sourceIndex.isValid() || !m_source) return QModelIndex();
+    if (!m_mapped) return index(sourceIndex.row(), sourceIndex.column());
+    if (m_inverse.isEmpty()) {
+        m_inverse.fill(-1, m_source->rowCount());
+        for (int i = 0; i < m_rows.size(); ++i) {
+            if (m_rows[i] < m_inverse.size()) m_inverse[m_rows[i]] = i;
+        }
+    }
+    const int row = sourceIndex.row() < m_inverse.size() ? m_inverse[sourceIndex.row()] : -1;
+    return row >= 0 ? index(row, sourceIndex.column()) : QModelIndex();
+}
+
+QVariant SheetFilterProxy::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (!m_source) return QVariant();
+    // 行号显示源行号，过滤与排序后仍可对应原数据
+    if (orientation == Qt::Vertical && m_mapped) {
+        if (section < 0 || section >= m_rows.size()) return QVariant();
+        return m_source->headerData(m_rows[section], orientation, role);
+    }
+    return m_source->headerData(section, orientation, role);
+}
@@ -0,0 +1,138 @@
+/*
+ * sheetfilterproxy.h
+ * 文件作用: 数据表的后台过滤与排序代理模型头文件
+ * 功能描述:
+ * 1. 替代 QSortFilterProxyModel：过滤与排序在线程池中对 ColumnarTableModel 的只读快照进行，
+ *    结果为一份行映射 (代理行 -> 源行)，完成后在界面线程一次性替换，界面不随行数卡顿。
+ * 2. 每列的有序索引在第一次用于排序或范围过滤时于后台建立并缓存 (数值按大小，其后文本不区分大小写，空单元格在最后)，
+ *    源数据的任何修改使缓存失效。
+ * 3. 过滤文本以 ';' 分隔多个条件，全部满足的行才显示：
+ *    "列 between a and b" 与 "列 >= x" (> < <= = 同理) 为数值范围条件，按有序索引二分查找，末尾的单位词忽略；
+ *    其余为文本条件，任一列包含该文本即满足 (不区分大小写，可用 * ? 通配符)。列名可为表头全文、表头中 '\' 之前的名称或 $N。
+ * 4. setFilterText 防抖 250 ms 后才开始查询；新的查询取消仍在进行的旧查询，过期的结果丢弃。
+ * 5. 未过滤、未排序时为恒等映射，源模型的信号原样转发；有映射时源模型的行列结构变化使映射复位并重新查询。
+ */
+
+#ifndef SHEETFILTERPROXY_H
+#define SHEETFILTERPROXY_H
+
+#include <QAbstractProxyModel>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include "columnartablemodel.h"
+#include "cancellationtoken.h"
+
+class SheetFilterProxy : public QAbstractProxyModel
+{
+    Q_OBJECT
+public:
+    // 数值范围条件 (两端包含)
+    struct RangeFilter {
+        int column = -1;
+        double minimum = 0.0;
+        double maximum = 0.0;
+    };
+
+    // 一次查询：全部条件满足的行按排序列排列
+    struct Query {
+        QStringList texts;
+        QVector<RangeFilter> ranges;
+        int sortColumn = -1;
+        Qt::SortOrder sortOrder = Qt::AscendingOrder;
+
+        bool hasFilter() const { return !texts.isEmpty() || !ranges.isEmpty(); }
+        bool isEmpty() const { return !hasFilter() && sortColumn < 0; }
+    };
+
+    explicit SheetFilterProxy(QObject* parent = nullptr);
+    ~SheetFilterProxy() override;
+
+    // 源模型须为 ColumnarTableModel
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+
+    // 解析过滤文本 (列名按 headers 解析)
+    static Query parseFilter(const QString& text, const QStringList& headers);
+
+    // 设置过滤文本，防抖后在后台查询
+    void setFilterText(const QString& text);
+    QString filterText() const { return m_filterText; }
+    // 按列排序，立即在后台查询 (column < 0 取消排序)
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // 是否有行映射 (过滤或排序的结果已生效)
+    bool isMapped() const { return m_mapped; }
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    QModelIndex sibling(int row, int column, const QModelIndex& idx) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // 一列的有序索引：rows[0, numericCount) 为数值单元格按值升序，其后至 nonEmptyCount 为文本单元格，再后为空单元格
+    struct SortedIndex {
+        QVector<int> rows;
+        int numericCount = 0;
+        int nonEmptyCount = 0;
+    };
+    typedef QHash<int, QSharedPointer<const SortedIndex>> IndexCache;
+
+    // 后台查询结果
+    struct Result {
+        quint64 generation = 0;
+        quint64 revision = 0;
+        bool cancelled = false;
+        bool identity = true;
+        QVector<int> rows;
+        IndexCache builtIndices; // 本次新建的有序索引
+    };
+
+signals:
+    // 新的行映射已生效
+    void queryFinished(int visibleRows, int totalRows);
+
+private slots:
+    void runQuery();
+    void onQueryFinished();
+
+private:
+    static Result executeQuery(const ColumnarTableModel::Snapshot& snapshot, const Query& query, IndexCache indices,
+                               const QSharedPointer<CancellationToken>& token);
+    static QSharedPointer<const SortedIndex> buildSortedIndex(const ColumnarTableModel::Snapshot& snapshot, int column);
+
+    void connectSource();
+    // 源模型变化：使缓存失效；有映射时复位为恒等映射并安排重新查询
+    void sourceChanged();
+    void beginStructureChange();
+    void endStructureChange();
+    void resetToIdentity();
+    QStringList sourceHeaders() const;
+
+    ColumnarTableModel* m_source = nullptr;
+
+    QString m_filterText;
+    int m_sortColumn = -1;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+
+    // 行映射 (代理行 -> 源行) 与按需建立的逆映射
+    bool m_mapped = false;
+    QVector<int> m_rows;
+    mutable QVector<int> m_inverse;
+
+    bool m_structureReset = false; // 结构变化期间以模型复位代替逐项转发
+    quint64 m_revision = 0;        // 源数据修订号
+    quint64 m_generation = 0;      // 最近一次查询的序号
+    IndexCache m_indices;
+
+    QTimer m_debounce;
+    QSharedPointer<CancellationToken> m_cancel;
+    QFutureWatcher<Result> m_watcher;
+};
+
+#endif // SHEETFILTERPROXY_H
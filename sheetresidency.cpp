@@ -0,0 +1,108 @@
+/*
+ * 文件名: sheetresidency.cpp
+ * 文件作用: 数据表页签的内存驻留管理实现文件
+ * 功能描述:
+ * 1. enforce 先按使用时刻从旧到新排列不活动的模型，逐个判断是否超出预算或空闲时限；
+ *    压缩跳过的列 (数组被共享) 仍计入未压缩总量，因此可能继续压缩下一个模型。
+ * 2. 每次压缩了模型时输出一行调试信息 (压缩数、未压缩与压缩后的总量)。
+ */
+
+#include "sheetresidency.h"
+#include "columnartablemodel.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+SheetResidencyManager& SheetResidencyManager::instance()
+{
+    static SheetResidencyManager manager;
+    return manager;
+}
+
+void SheetResidencyManager::prune()
+{
+    m_models.erase(std::remove_if(m_models.begin(), m_models.end(),
+                                  [](const QPointer<ColumnarTableModel>& m) { return m.isNull(); }),
+                   m_models.end());
+}
+
+void SheetResidencyManager::registerModel(ColumnarTableModel* model)
+{
+    if (!model) return;
+    prune();
+    for (const QPointer<ColumnarTableModel>& m : m_models) {
+        if (m == model) return;
+    }
+    model->touch();
+    m_models.append(model);
+}
+
+void SheetResidencyManager::setActive(ColumnarTableModel* model)
+{
+    m_active = model;
+    if (!model) return;
+    registerModel(model);
+    model->ensureResident();
+    model->touch();
+}
+
+void SheetResidencyManager::setBudget(qint64 bytes)
+{
+    m_budget = qMax<qint64>(0, bytes);
+}
+
+void SheetResidencyManager::setIdleTimeout(int seconds)
+{
+    m_idleSeconds = qMax(0, seconds);
+}
+
+int SheetResidencyManager::enforce()
+{
+    prune();
+    if (m_budget <= 0 && m_idleSeconds <= 0) return 0;
+
+    qint64 total = residentBytes();
+    QVector<ColumnarTableModel*> candidates;
+    for (const QPointer<ColumnarTableModel>& m : m_models) {
+        if (m != m_active && m->residentBytes() > 0) candidates.append(m.data());
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const ColumnarTableModel* a, const ColumnarTableModel* b) { return a->lastUse() < b->lastUse(); });
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int compressed = 0;
+    for (ColumnarTableModel* model : candidates) {
+        const bool overBudget = m_budget > 0 && total > m_budget;
+        const bool idle = m_idleSeconds > 0 && now - model->lastUse() > qint64(m_idleSeconds) * 1000;
+        if (!overBudget && !idle) continue;
+        const qint64 before = model->residentBytes();
+        if (model->compress()) {
+            total -= before - model->residentBytes();
+            ++compressed;
+        }
+    }
+    if (compressed > 0) {
+        qDebug() << "SheetResidencyManager: compressed" << compressed << "sheet(s), resident"
+                 << total / (1024 * 1024) << "MB, compressed" << compressedBytes() / (1024 * 1024) << "MB";
+    }
+    return compressed;
+}
+
+qint64 SheetResidencyManager::residentBytes() const
+{
+    qint64 bytes = 0;
+    for (const QPointer<ColumnarTableModel>& m : m_models) {
+        if (m) bytes += m->residentBytes();
+    }
+    return bytes;
+}
+
+qint64 SheetResidencyManager::compressedBytes() const
+{
+    qint64 bytes = 0;
+    for (const QPointer<ColumnarTableModel>& m : m_models) {
+        if (m) bytes += m->compressedBytes();
+    }
+    return bytes;
+}
@@ -0,0 +1,56 @@
+/*
+ * 文件名: sheetresidency.h
+ * 文件作用: 数据表页签的内存驻留管理头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 登记各页签的数据模型 (ColumnarTableModel)，按 "最近使用" 排序：页签激活或下游读取数值列都会刷新使用时刻。
+ * 2. enforce 在未压缩数据的总量超过预算时，从最久未使用的不活动模型开始压缩 (ColumnarTableModel::compress)，
+ *    直到回到预算以内；设置了空闲时限时，超过时限未使用的不活动模型无论预算如何都压缩。当前页签的模型从不压缩。
+ * 3. 压缩后的模型仍可照常读取：读到的列单独解压，页签再次激活时整表解压。
+ * 4. 预算与空闲时限由 PerformanceSettings 设置 (performance/sheetMemoryBudgetMB、performance/sheetIdleMinutes)；
+ *    只在界面线程使用，enforce 由数据编辑器在切换页签、加载完成与定时器中调用。
+ */
+
+#ifndef SHEETRESIDENCY_H
+#define SHEETRESIDENCY_H
+
+#include <QPointer>
+#include <QVector>
+#include <QtGlobal>
+
+class ColumnarTableModel;
+
+class SheetResidencyManager
+{
+public:
+    static SheetResidencyManager& instance();
+
+    // 登记模型 (重复登记无效；模型销毁后自动移除)
+    void registerModel(ColumnarTableModel* model);
+    // 设置当前页签的模型：整表解压并刷新使用时刻，不参与压缩 (nullptr 表示没有当前页签)
+    void setActive(ColumnarTableModel* model);
+
+    // 未压缩数据的预算 (字节，0 表示不限)
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return m_budget; }
+    // 空闲时限 (秒，0 表示不按空闲时间压缩)
+    void setIdleTimeout(int seconds);
+    int idleTimeout() const { return m_idleSeconds; }
+
+    // 按预算与空闲时限压缩不活动的模型，返回压缩的模型数
+    int enforce();
+
+    // 全部登记模型的未压缩 / 压缩数据字节数
+    qint64 residentBytes() const;
+    qint64 compressedBytes() const;
+
+private:
+    SheetResidencyManager() = default;
+    void prune();
+
+    QVector<QPointer<ColumnarTableModel>> m_models;
+    QPointer<ColumnarTableModel> m_active;
+    qint64 m_budget = 0;
+    int m_idleSeconds = 0;
+};
+
+#endif // SHEETRESIDENCY_H
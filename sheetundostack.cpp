@@ -0,0 +1,385 @@
+/*
+ * sheetundostack.cpp
+ * 文件作用: 数据表的撤销栈与紧凑撤销命令实现文件
+ * 功能描述:
+ * 1. 删除行时对每段连续行取切片后删除，撤销时按行号升序放回；删除列与撤销新增列时整列取出 (共享列数组)。
+ * 2. 命令的内存只计入不在模型中的数据：已删除的行列切片、被覆盖的旧列、单元格文本。
+ * 3. 撤销栈每次入栈、撤销与重做后检查预算，超出时先丢弃最旧的可撤销命令，仍超出时丢弃可重做命令。
+ */
+
+#include "sheetundostack.h"
+
+#include <algorithm>
+
+// ============================================================================
+// SheetUndoCommand
+// ============================================================================
+
+SheetUndoCommand::SheetUndoCommand(const QString& text, QUndoCommand* parent)
+    : QUndoCommand(text, parent)
+{
+}
+
+qint64 SheetUndoCommand::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (int i = 0; i < childCount(); ++i) {
+        if (auto c = dynamic_cast<const SheetUndoCommand*>(child(i))) bytes += c->memoryBytes();
+    }
+    return bytes;
+}
+
+qint64 SheetUndoCommand::blockBytes(const ColumnarTableModel::RowBlock& block)
+{
+    qint64 bytes = 0;
+    for (const QVector<double>& v : block.values) bytes += qint64(v.size()) * qint64(sizeof(double));
+    for (const QVector<qint8>& d : block.decimals) bytes += d.size();
+    for (const QVector<QPair<int, QString>>& t : block.texts) {
+        for (const QPair<int, QString>& cell : t) bytes += qint64(sizeof(cell)) + qint64(cell.second.size()) * 2;
+    }
+    return bytes;
+}
+
+// ============================================================================
+// SetCellsCommand
+// ============================================================================
+
+SetCellsCommand::SetCellsCommand(ColumnarTableModel* model, int row, int column, const QString& oldText, const QString& newText)
+    : SheetUndoCommand(QStringLiteral("编辑单元格")), m_model(model)
+{
+    m_cells.append({row, column, oldText, newText});
+}
+
+void SetCellsCommand::undo()
+{
+    m_model->beginUpdate();
+    for (int i = m_cells.size() - 1; i >= 0; --i) m_model->setText(m_cells[i].row, m_cells[i].column, m_cells[i].oldText);
+    m_model->endUpdate();
+}
+
+void SetCellsCommand::redo()
+{
+    m_model->beginUpdate();
+    for (const Cell& cell : m_cells) m_model->setText(cell.row, cell.column, cell.newText);
+    m_model->endUpdate();
+}
+
+bool SetCellsCommand::mergeWith(const QUndoCommand* other)
+{
+    const SetCellsCommand* next = static_cast<const SetCellsCommand*>(other);
+    if (next->m_cells.size() != 1) return false;
+    const Cell& last = m_cells.last();
+    const Cell& cell = next->m_cells.first();
+    // 向下填充：紧邻的下一格填入相同文本
+    if (cell.column != last.column || cell.row != last.row + 1 || cell.newText != last.newText) return false;
+    m_cells.append(cell);
+    setText(QStringLiteral("填充 %1 个单元格").arg(m_cells.size()));
+    return true;
+}
+
+qint64 SetCellsCommand::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (const Cell& cell : m_cells) bytes += qint64(sizeof(Cell)) + qint64(cell.oldText.size() + cell.newText.size()) * 2;
+    return bytes;
+}
+
+// ============================================================================
+// RemoveRowsCommand
+// ============================================================================
+
+RemoveRowsCommand::RemoveRowsCommand(ColumnarTableModel* model, QList<int> rows)
+    : SheetUndoCommand(QString()), m_model(model)
+{
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // 合并为连续区间 (降序)
+    for (int row : rows) {
+        if (!m_ranges.isEmpty() && m_ranges.last().row == row + 1) {
+            --m_ranges.last().row;
+            ++m_ranges.last().count;
+        } else {
+            m_ranges.append({row, 1, ColumnarTableModel::RowBlock()});
+        }
+    }
+    setText(QStringLiteral("删除 %1 行").arg(rows.size()));
+}
+
+void RemoveRowsCommand::redo()
+{
+    for (Range& range : m_ranges) {
+        range.block = m_model->copyRows(range.row, range.count);
+        m_model->removeRows(range.row, range.count);
+    }
+}
+
+void RemoveRowsCommand::undo()
+{
+    for (int i = m_ranges.size() - 1; i >= 0; --i) {
+        Range& range = m_ranges[i];
+        m_model->insertBlock(range.row, range.block);
+        range.block = ColumnarTableModel::RowBlock();
+    }
+}
+
+qint64 RemoveRowsCommand::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (const Range& range : m_ranges) bytes += blockBytes(range.block);
+    return bytes;
+}
+
+// ============================================================================
+// InsertRowsCommand
+// ============================================================================
+
+InsertRowsCommand::InsertRowsCommand(ColumnarTableModel* model, int row, int count)
+    : SheetUndoCommand(QStringLiteral("插入行")), m_model(model), m_row(row), m_count(count)
+{
+}
+
+void InsertRowsCommand::redo()
+{
+    m_model->insertRows(m_row, m_count);
+}
+
+void InsertRowsCommand::undo()
+{
+    m_model->removeRows(m_row, m_count);
+}
+
+// ============================================================================
+// 列切片的取出与放回
+// ============================================================================
+
+static SheetColumnSlice takeColumn(ColumnarTableModel* model, QList<ColumnDefinition>* definitions, int column)
+{
+    SheetColumnSlice slice;
+    slice.column = column;
+    slice.data = model->copyColumns(column, 1);
+    slice.header = model->headerText(column);
+    slice.foreground = model->columnForeground(column);
+    if (definitions && column < definitions->size()) {
+        slice.definition = definitions->takeAt(column);
+        slice.hasDefinition = true;
+    }
+    model->removeColumns(column, 1);
+    return slice;
+}
+
+static void restoreColumn(ColumnarTableModel* model, QList<ColumnDefinition>* definitions, const SheetColumnSlice& slice)
+{
+    model->insertColumnBlock(slice.column, slice.data);
+    model->setHeaderData(slice.column, Qt::Horizontal, slice.header);
+    if (slice.foreground.isValid()) model->setColumnForeground(slice.column, slice.foreground);
+    if (definitions && slice.hasDefinition) definitions->insert(qMin(slice.column, int(definitions->size())), slice.definition);
+}
+
+// ============================================================================
+// RemoveColumnsCommand
+// ============================================================================
+
+RemoveColumnsCommand::RemoveColumnsCommand(ColumnarTableModel* model, QList<ColumnDefinition>* definitions, QList<int> columns)
+    : SheetUndoCommand(QString()), m_model(model), m_definitions(definitions)
+{
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+    m_columns = columns;
+    setText(QStringLiteral("删除 %1 列").arg(columns.size()));
+}
+
+void RemoveColumnsCommand::redo()
+{
+    m_slices.clear();
+    for (int i = m_columns.size() - 1; i >= 0; --i) m_slices.append(takeColumn(m_model, m_definitions, m_columns[i]));
+}
+
+void RemoveColumnsCommand::undo()
+{
+    // m_slices 按列号降序，放回时升序
+    for (int i = m_slices.size() - 1; i >= 0; --i) restoreColumn(m_model, m_definitions, m_slices[i]);
+    m_slices.clear();
+}
+
+qint64 RemoveColumnsCommand::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (const SheetColumnSlice& slice : m_slices) bytes += blockBytes(slice.data);
+    return bytes;
+}
+
+// ============================================================================
+// AddColumnsCommand
+// ============================================================================
+
+AddColumnsCommand::AddColumnsCommand(ColumnarTableModel* model, QList<ColumnDefinition>* definitions, int column, int count,
+                                     const QString& text, QUndoCommand* parent)
+    : SheetUndoCommand(text, parent), m_model(model), m_definitions(definitions), m_column(column), m_count(count)
+{
+    setApplied(true);
+}
+
+void AddColumnsCommand::undo()
+{
+    m_slices.clear();
+    for (int i = m_count - 1; i >= 0; --i) m_slices.append(takeColumn(m_model, m_definitions, m_column + i));
+}
+
+void AddColumnsCommand::redo()
+{
+    for (int i = m_slices.size() - 1; i >= 0; --i) restoreColumn(m_model, m_definitions, m_slices[i]);
+    m_slices.clear();
+}
+
+qint64 AddColumnsCommand::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (const SheetColumnSlice& slice : m_slices) bytes += blockBytes(slice.data);
+    return bytes;
+}
+
+// ============================================================================
+// ReplaceColumnsCommand
+// ============================================================================
+
+ReplaceColumnsCommand::ReplaceColumnsCommand(ColumnarTableModel* model, int column, const ColumnarTableModel::RowBlock& before,
+                                             const QString& text, QUndoCommand* parent)
+    : SheetUndoCommand(text, parent), m_model(model), m_column(column), m_other(before)
+{
+    setApplied(true);
+}
+
+void ReplaceColumnsCommand::swapColumns()
+{
+    const ColumnarTableModel::RowBlock current = m_model->copyColumns(m_column, m_other.values.size());
+    m_model->replaceColumns(m_column, m_other);
+    m_other = current;
+}
+
+void ReplaceColumnsCommand::undo()
+{
+    swapColumns();
+}
+
+void ReplaceColumnsCommand::redo()
+{
+    swapColumns();
+}
+
+qint64 ReplaceColumnsCommand::memoryBytes() const
+{
+    return blockBytes(m_other);
+}
+
+// ============================================================================
+// SheetUndoStack
+// ============================================================================
+
+SheetUndoStack::SheetUndoStack(QObject* parent)
+    : QObject(parent)
+{
+}
+
+SheetUndoStack::~SheetUndoStack()
+{
+    qDeleteAll(m_commands);
+}
+
+void SheetUndoStack::push(SheetUndoCommand* command)
+{
+    if (!command) return;
+    const bool couldUndo = canUndo(), couldRedo = canRedo();
+
+    // 新命令使可重做的命令失效
+    while (m_commands.size() > m_index) delete m_commands.takeLast();
+
+    if (!command->isApplied()) command->redo();
+
+    SheetUndoCommand* top = m_index > 0 ? m_commands[m_index - 1] : nullptr;
+    if (top && command->id() >= 0 && top->id() == command->id() && top->mergeWith(command)) {
+        delete command;
+    } else {
+        m_commands.append(command);
+        m_index = m_commands.size();
+    }
+    enforceBudget();
+    notifyState(couldUndo, couldRedo);
+}
+
+void SheetUndoStack::clear()
+{
+    if (m_commands.isEmpty()) return;
+    const bool couldUndo = canUndo(), couldRedo = canRedo();
+    qDeleteAll(m_commands);
+    m_commands.clear();
+    m_index = 0;
+    notifyState(couldUndo, couldRedo);
+}
+
+void SheetUndoStack::undo()
+{
+    if (!canUndo()) return;
+    const bool couldUndo = canUndo(), couldRedo = canRedo();
+    m_commands[--m_index]->undo();
+    enforceBudget();
+    notifyState(couldUndo, couldRedo);
+}
+
+void SheetUndoStack::redo()
+{
+    if (!canRedo()) return;
+    const bool couldUndo = canUndo(), couldRedo = canRedo();
+    m_commands[m_index++]->redo();
+    enforceBudget();
+    notifyState(couldUndo, couldRedo);
+}
+
+QString SheetUndoStack::undoText() const
+{
+    return canUndo() ? m_commands[m_index - 1]->text() : QString();
+}
+
+QString SheetUndoStack::redoText() const
+{
+    return canRedo() ? m_commands[m_index]->text() : QString();
+}
+
+void SheetUndoStack::setMemoryBudget(qint64 bytes)
+{
+    const bool couldUndo = canUndo(), couldRedo = canRedo();
+    m_budget = qMax<qint64>(0, bytes);
+    enforceBudget();
+    notifyState(couldUndo, couldRedo);
+}
+
+qint64 SheetUndoStack::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (const SheetUndoCommand* command : m_commands) bytes += command->memoryBytes();
+    return bytes;
+}
+
+void SheetUndoStack::enforceBudget()
+{
+    qint64 usage = memoryUsage();
+    // 先丢弃最旧的可撤销命令
+    while (usage > m_budget && m_index > 0) {
+        SheetUndoCommand* oldest = m_commands.takeFirst();
+        usage -= oldest->memoryBytes();
+        delete oldest;
+        --m_index;
+    }
+    // 仍超出时丢弃最远的可重做命令
+    while (usage > m_budget && m_commands.size() > m_index) {
+        SheetUndoCommand* last = m_commands.takeLast();
+        usage -= last->memoryBytes();
+        delete last;
+    }
+}
+
+void SheetUndoStack::notifyState(bool couldUndo, bool couldRedo)
+{
+    if (couldUndo != canUndo()) emit canUndoChanged(canUndo());
+    if (couldRedo != canRedo()) emit canRedoChanged(canRedo());
+}
@@ -0,0 +1,208 @@
+/*
+ * sheetundostack.h
+ * 文件作用: 数据表的撤销栈与紧凑撤销命令头文件
+ * 功能描述:
+ * 1. SheetUndoCommand 在 QUndoCommand 之上给出命令占用的内存 (memoryBytes)；各命令只保存操作的差量，不保存整表快照：
+ *    - SetCellsCommand: 单元格的原文与新文；向下连续填入相同文本 (拖动填充) 时合并为一条命令。
+ *    - RemoveRowsCommand: 删除的各段连续行按列切片保存 (ColumnarTableModel::copyRows)。
+ *    - RemoveColumnsCommand: 删除的列整列保存 (列数组隐式共享，不复制)，连同表头、列定义与文字颜色。
+ *    - AddColumnsCommand: 新增的列 (计算列、插入列) 以 "删除该列" 为逆操作，撤销前不占内存。
+ *    - InsertRowsCommand: 插入空行，逆操作为删除。
+ *    - ReplaceColumnsCommand: 原地改写的列 (数据分列的源列) 保存改写前的整列。
+ * 2. SheetUndoStack 替代 QUndoStack：总内存超过预算时从最旧的命令开始丢弃 (QUndoStack 只能按条数限制，且只能在空栈时设置)，
+ *    百万行的表也可保持撤销可用而不使内存翻倍。
+ * 3. 命令构造时可标记为 "已执行" (修改已由计算流程完成)，入栈时不再执行 redo。
+ */
+
+#ifndef SHEETUNDOSTACK_H
+#define SHEETUNDOSTACK_H
+
+#include <QObject>
+#include <QUndoCommand>
+#include <QList>
+#include <QVector>
+#include "columnartablemodel.h"
+#include "datasinglesheet.h"
+
+class SheetUndoCommand : public QUndoCommand
+{
+public:
+    explicit SheetUndoCommand(const QString& text, QUndoCommand* parent = nullptr);
+
+    // 当前占用的内存 (字节，含子命令)
+    virtual qint64 memoryBytes() const;
+    // 修改已在构造前完成，入栈时不执行 redo
+    bool isApplied() const { return m_applied; }
+    void setApplied(bool applied) { m_applied = applied; }
+
+    // RowBlock 占用的内存 (隐式共享的数组按全部计入)
+    static qint64 blockBytes(const ColumnarTableModel::RowBlock& block);
+
+private:
+    bool m_applied = false;
+};
+
+// 单元格编辑 (可合并的向下填充)
+class SetCellsCommand : public SheetUndoCommand
+{
+public:
+    SetCellsCommand(ColumnarTableModel* model, int row, int column, const QString& oldText, const QString& newText);
+
+    void undo() override;
+    void redo() override;
+    int id() const override { return 1; }
+    bool mergeWith(const QUndoCommand* other) override;
+    qint64 memoryBytes() const override;
+
+private:
+    struct Cell {
+        int row;
+        int column;
+        QString oldText;
+        QString newText;
+    };
+    ColumnarTableModel* m_model;
+    QVector<Cell> m_cells;
+};
+
+// 删除行 (可不连续)
+class RemoveRowsCommand : public SheetUndoCommand
+{
+public:
+    RemoveRowsCommand(ColumnarTableModel* model, QList<int> rows);
+
+    void undo() override;
+    void redo() override;
+    qint64 memoryBytes() const override;
+
+private:
+    struct Range {
+        int row;
+        int count;
+        ColumnarTableModel::RowBlock block; // 删除后保存的行切片
+    };
+    ColumnarTableModel* m_model;
+    QVector<Range> m_ranges; // 按行号降序
+};
+
+// 插入空行
+class InsertRowsCommand : public SheetUndoCommand
+{
+public:
+    InsertRowsCommand(ColumnarTableModel* model, int row, int count);
+
+    void undo() override;
+    void redo() override;
+
+private:
+    ColumnarTableModel* m_model;
+    int m_row;
+    int m_count;
+};
+
+// 列的完整内容 (删除列与撤销新增列时保存)
+struct SheetColumnSlice {
+    int column = -1;
+    ColumnarTableModel::RowBlock data;
+    QString header;
+    QColor foreground;
+    ColumnDefinition definition;
+    bool hasDefinition = false;
+};
+
+// 删除列 (可不连续)
+class RemoveColumnsCommand : public SheetUndoCommand
+{
+public:
+    RemoveColumnsCommand(ColumnarTableModel* model, QList<ColumnDefinition>* definitions, QList<int> columns);
+
+    void undo() override;
+    void redo() override;
+    qint64 memoryBytes() const override;
+
+private:
+    ColumnarTableModel* m_model;
+    QList<ColumnDefinition>* m_definitions;
+    QList<int> m_columns;              // 升序
+    QVector<SheetColumnSlice> m_slices; // 删除后保存的列
+};
+
+// 新增列 (已执行)：撤销即删除这些列，重做时放回
+class AddColumnsCommand : public SheetUndoCommand
+{
+public:
+    AddColumnsCommand(ColumnarTableModel* model, QList<ColumnDefinition>* definitions, int column, int count,
+                      const QString& text, QUndoCommand* parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+    qint64 memoryBytes() const override;
+
+private:
+    ColumnarTableModel* m_model;
+    QList<ColumnDefinition>* m_definitions;
+    int m_column;
+    int m_count;
+    QVector<SheetColumnSlice> m_slices; // 撤销后保存的列
+};
+
+// 原地改写的列 (已执行)：保存另一侧的整列，撤销与重做互换
+class ReplaceColumnsCommand : public SheetUndoCommand
+{
+public:
+    ReplaceColumnsCommand(ColumnarTableModel* model, int column, const ColumnarTableModel::RowBlock& before,
+                          const QString& text, QUndoCommand* parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+    qint64 memoryBytes() const override;
+
+private:
+    void swapColumns();
+
+    ColumnarTableModel* m_model;
+    int m_column;
+    ColumnarTableModel::RowBlock m_other; // 不在模型中的那一侧
+};
+
+class SheetUndoStack : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr qint64 DefaultMemoryBudget = qint64(256) * 1024 * 1024;
+
+    explicit SheetUndoStack(QObject* parent = nullptr);
+    ~SheetUndoStack() override;
+
+    // 入栈 (取得所有权)：丢弃可重做的命令，尝试与栈顶合并，未执行的命令执行 redo，然后按预算丢弃最旧的命令
+    void push(SheetUndoCommand* command);
+    void clear();
+
+    bool canUndo() const { return m_index > 0; }
+    bool canRedo() const { return m_index < m_commands.size(); }
+    QString undoText() const;
+    QString redoText() const;
+    int count() const { return m_commands.size(); }
+
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const { return m_budget; }
+    qint64 memoryUsage() const;
+
+public slots:
+    void undo();
+    void redo();
+
+signals:
+    void canUndoChanged(bool canUndo);
+    void canRedoChanged(bool canRedo);
+
+private:
+    void enforceBudget();
+    void notifyState(bool couldUndo, bool couldRedo);
+
+    QList<SheetUndoCommand*> m_commands;
+    int m_index = 0; // 下一条可重做命令的位置
+    qint64 m_budget = DefaultMemoryBudget;
+};
+
+#endif // SHEETUNDOSTACK_H
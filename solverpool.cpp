@@ -0,0 +1,198 @@
+/*
+ * solverpool.cpp
+ * 文件作用: 模型求解器实例池实现文件
+ * 功能描述:
+ * 1. 实现 SolverSettings 的全局设置读取与比较。
+ * 2. 实现求解器实例的借出/归还：互斥锁只保护空闲列表，曲线计算本身在锁外进行。
+ * 3. 新建实例时一次性应用精度、反演方法与并行设置，保证借出期间配置不变。
+ */
+
+#include "solverpool.h"
+
+#include <QMutexLocker>
+#include <QSettings>
+#include <QThread>
+#include <algorithm>
+
+// ---------------------- SolverSettings ----------------------
+
+SolverSettings SolverSettings::fromGlobalSettings()
+{
+    SolverSettings s;
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    s.inversionMethod = LaplaceInversion::methodFromValue(settings.value("solver/inversionMethod", 0).toInt());
+    s.inversionOrder = settings.value("solver/inversionOrder", 0).toInt();
+    s.useTypeCurveLibrary = settings.value("solver/typeCurveLibraryEnabled", false).toBool();
+    s.gridPointsPerDecade = std::max(0, settings.value("solver/gridPointsPerDecade", 0).toInt());
+    s.asymptoticEarlyArgument = std::max(0.0, settings.value("solver/asymptoticEarlyArgument", s.asymptoticEarlyArgument).toDouble());
+    s.asymptoticLateArgument = std::max(0.0, settings.value("solver/asymptoticLateArgument", s.asymptoticLateArgument).toDouble());
+    s.accuracyControl = settings.value("solver/accuracyControl", false).toBool();
+    s.mixedPrecision = settings.value("solver/mixedPrecision", false).toBool();
+    s.sharedLaplaceNodes = settings.value("solver/sharedLaplaceNodes", false).toBool();
+    s.laplaceInterpolation = settings.value("solver/laplaceInterpolation", false).toBool();
+    return s;
+}
+
+SolverSettings SolverSettings::withHighPrecision(bool high) const
+{
+    SolverSettings s = *this;
+    s.highPrecision = high;
+    return s;
+}
+
+bool SolverSettings::operator==(const SolverSettings& o) const
+{
+    return highPrecision == o.highPrecision && inversionMethod == o.inversionMethod
+           && inversionOrder == o.inversionOrder && parallelEvaluation == o.parallelEvaluation
+           && useTypeCurveLibrary == o.useTypeCurveLibrary && gridPointsPerDecade == o.gridPointsPerDecade
+           && asymptoticEarlyArgument == o.asymptoticEarlyArgument && asymptoticLateArgument == o.asymptoticLateArgument
+           && accuracyControl == o.accuracyControl && mixedPrecision == o.mixedPrecision
+           && sharedLaplaceNodes == o.sharedLaplaceNodes && laplaceInterpolation == o.laplaceInterpolation;
+}
+
+// ---------------------- Lease ----------------------
+
+SolverPool::Lease::Lease(Lease&& other)
+    : m_pool(other.m_pool), m_entry(other.m_entry), m_solver(other.m_solver)
+{
+    other.m_pool = nullptr;
+    other.m_entry = -1;
+    other.m_solver = nullptr;
+}
+
+SolverPool::Lease& SolverPool::Lease::operator=(Lease&& other)
+{
+    if (this != &other) {
+        release();
+        m_pool = other.m_pool;
+        m_entry = other.m_entry;
+        m_solver = other.m_solver;
+        other.m_pool = nullptr;
+        other.m_entry = -1;
+        other.m_solver = nullptr;
+    }
+    return *this;
+}
+
+SolverPool::Lease::~Lease()
+{
+    release();
+}
+
+void SolverPool::Lease::release()
+{
+    if (m_pool && m_solver) m_pool->release(m_entry, m_solver);
+    m_pool = nullptr;
+    m_entry = -1;
+    m_solver = nullptr;
+}
+
+// ---------------------- SolverPool ----------------------
+
+SolverPool::SolverPool()
+    : m_created(0)
+{
+    // 每种组合保留的空闲实例数不超过线程数的两倍 (雅可比矩阵各列并行 + 后台预览)
+    m_maxIdlePerEntry = std::max(2, 2 * QThread::idealThreadCount());
+}
+
+SolverPool::~SolverPool()
+{
+    // 池必须在所有 Lease 之后析构 (由 ModelEngine 持有，生命周期覆盖全部计算)
+    clear();
+}
+
+SolverPool::Lease SolverPool::acquire(ModelSolver01_06::ModelType type, const SolverSettings& settings)
+{
+    int entry = -1;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (int i = 0; i < m_entries.size(); ++i) {
+            if (m_entries[i].type == type && m_entries[i].settings == settings) { entry = i; break; }
+        }
+        if (entry < 0) {
+            Entry e;
+            e.type = type;
+            e.settings = settings;
+            m_entries.append(e);
+            entry = m_entries.size() - 1;
+        }
+        if (!m_entries[entry].idle.isEmpty()) {
+            ModelSolver01_06* solver = m_entries[entry].idle.takeLast();
+            return Lease(this, entry, solver);
+        }
+        ++m_created;
+    }
+
+    // 新建实例在锁外完成配置
+    ModelSolver01_06* solver = new ModelSolver01_06(type);
+    solver->setHighPrecision(settings.highPrecision);
+    solver->setInversionMethod(settings.inversionMethod, settings.inversionOrder);
+    solver->setParallelEvaluation(settings.parallelEvaluation);
+    solver->setTypeCurveLibraryEnabled(settings.useTypeCurveLibrary);
+    solver->setGridEvaluation(settings.gridPointsPerDecade);
+    solver->setAsymptoticRegimes(settings.asymptoticEarlyArgument, settings.asymptoticLateArgument);
+    solver->setAccuracyControl(settings.accuracyControl);
+    solver->setMixedPrecision(settings.mixedPrecision);
+    solver->setSharedLaplaceNodes(settings.sharedLaplaceNodes);
+    solver->setLaplaceInterpolation(settings.laplaceInterpolation);
+    return Lease(this, entry, solver);
+}
+
+void SolverPool::release(int entry, ModelSolver01_06* solver)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (entry >= 0 && entry < m_entries.size() && m_entries[entry].idle.size() < m_maxIdlePerEntry) {
+            m_entries[entry].idle.append(solver);
+            return;
+        }
+    }
+    delete solver;
+}
+
+void SolverPool::clear()
+{
+    QVector<ModelSolver01_06*> released;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (Entry& e : m_entries) {
+            released += e.idle;
+            e.idle.clear();
+        }
+    }
+    qDeleteAll(released);
+}
+
+void SolverPool::setMaxIdlePerEntry(int count)
+{
+    QVector<ModelSolver01_06*> released;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_maxIdlePerEntry = std::max(2, count);
+        for (Entry& e : m_entries) {
+            while (e.idle.size() > m_maxIdlePerEntry) released.append(e.idle.takeLast());
+        }
+    }
+    qDeleteAll(released);
+}
+
+int SolverPool::maxIdlePerEntry() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxIdlePerEntry;
+}
+
+int SolverPool::idleCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    int total = 0;
+    for (const Entry& e : m_entries) total += e.idle.size();
+    return total;
+}
+
+int SolverPool::createdCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_created;
+}
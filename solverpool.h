@@ -0,0 +1,116 @@
+/*
+ * solverpool.h
+ * 文件作用: 模型求解器实例池头文件
+ * 功能描述:
+ * 1. 定义 SolverSettings：求解器的精度、数值反演方法/阶数与时间点并行开关，作为不可变的值对象随调用传递。
+ * 2. 定义 SolverPool：按 (模型类型, 设置) 管理空闲的 ModelSolver01_06 实例，acquire() 借出独占实例，
+ *    Lease 析构时自动归还，不同线程始终使用不同实例，不存在共享状态的竞争。
+ * 3. 借出的实例在创建时即按设置完成配置，之后不再修改，调用方无需再通过 setHighPrecision 等全局开关切换精度。
+ * 4. 空闲实例数按 (模型类型, 设置) 设上限，超出部分在归还时释放；上限随工作线程数调整 (setMaxIdlePerEntry)。
+ */
+
+#ifndef SOLVERPOOL_H
+#define SOLVERPOOL_H
+
+#include <QMutex>
+#include <QVector>
+#include "modelsolver01-06.h"
+
+// 求解器设置 (值对象，借出实例后不再改变)
+struct SolverSettings {
+    bool highPrecision = true;                                         // 高精度计算标志
+    LaplaceInversion::Method inversionMethod = LaplaceInversion::Stehfest; // 数值反演方法
+    int inversionOrder = 0;                                            // 反演阶数 (0 表示默认阶数)
+    bool parallelEvaluation = true;                                    // 时间点并行计算
+    bool useTypeCurveLibrary = false;                                  // 类型曲线库快速路径 (插值代替反演)
+    int gridPointsPerDecade = 0;                                       // 网格求值模式每个对数周期的点数 (0 表示关闭)
+    double asymptoticEarlyArgument = ModelParams().earlyArgument;      // 早期渐近路径阈值 (0 表示关闭)
+    double asymptoticLateArgument = ModelParams().lateArgument;        // 晚期级数路径阈值 (0 表示关闭)
+    bool accuracyControl = false;                                      // 逐点精度控制模式 (目标误差由 highPrecision 决定)
+    bool mixedPrecision = false;                                       // Stehfest 混合精度模式 (只对误差估计超限的时间点扩展精度)
+    bool sharedLaplaceNodes = false;                                   // Stehfest 节点共享模式 (二进网格 + 节点去重)
+    bool laplaceInterpolation = false;                                 // 实数节点像函数插值模式 (Chebyshev 插值表)
+
+    // 求解器数值实现的版本：同一设置下计算结果会改变的修改 (求值路径、阈值、反演系数等) 须递增，
+    // 持久化的拟合求值缓存 (FitEvaluationCache) 据此丢弃旧版本计算的曲线
+    enum { NumericsVersion = 1 };
+
+    // 读取全局设置项 solver/inversionMethod、solver/inversionOrder、solver/typeCurveLibraryEnabled、solver/gridPointsPerDecade
+    // 与 solver/asymptoticEarlyArgument、solver/asymptoticLateArgument、solver/accuracyControl、solver/mixedPrecision、
+    // solver/sharedLaplaceNodes、solver/laplaceInterpolation
+    static SolverSettings fromGlobalSettings();
+
+    // 返回仅精度不同的副本 (拟合迭代期使用低精度，最终刷新使用高精度)
+    SolverSettings withHighPrecision(bool high) const;
+
+    bool operator==(const SolverSettings& other) const;
+    bool operator!=(const SolverSettings& other) const { return !(*this == other); }
+};
+
+class SolverPool
+{
+public:
+    // 借出凭证：持有期间独占一个已配置好的求解器实例，析构时归还到池中
+    class Lease
+    {
+    public:
+        Lease() : m_pool(nullptr), m_entry(-1), m_solver(nullptr) {}
+        Lease(Lease&& other);
+        Lease& operator=(Lease&& other);
+        ~Lease();
+
+        bool isValid() const { return m_solver != nullptr; }
+        ModelSolver01_06* operator->() const { return m_solver; }
+        ModelSolver01_06& operator*() const { return *m_solver; }
+        ModelSolver01_06* get() const { return m_solver; }
+
+    private:
+        friend class SolverPool;
+        Lease(SolverPool* pool, int entry, ModelSolver01_06* solver)
+            : m_pool(pool), m_entry(entry), m_solver(solver) {}
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        void release();
+
+        SolverPool* m_pool;
+        int m_entry;
+        ModelSolver01_06* m_solver;
+    };
+
+    SolverPool();
+    ~SolverPool();
+
+    // 借出指定模型类型与设置的求解器 (无空闲实例时新建)，可在任意线程调用
+    Lease acquire(ModelSolver01_06::ModelType type, const SolverSettings& settings);
+
+    // 释放全部空闲实例 (已借出的实例在归还时照常回收)
+    void clear();
+
+    // 每种 (模型类型, 设置) 组合保留的空闲实例上限 (默认线程数的两倍)，调小时立即释放多余实例
+    void setMaxIdlePerEntry(int count);
+    int maxIdlePerEntry() const;
+
+    // 统计信息：空闲实例数与累计创建数
+    int idleCount() const;
+    int createdCount() const;
+
+private:
+    SolverPool(const SolverPool&) = delete;
+    SolverPool& operator=(const SolverPool&) = delete;
+
+    // 单个 (模型类型, 设置) 组合的空闲实例列表；条目只增不删，Lease 以下标引用
+    struct Entry {
+        ModelSolver01_06::ModelType type;
+        SolverSettings settings;
+        QVector<ModelSolver01_06*> idle;
+    };
+
+    void release(int entry, ModelSolver01_06* solver);
+
+    mutable QMutex m_mutex;
+    QVector<Entry> m_entries;
+    int m_maxIdlePerEntry;
+    int m_created;
+};
+
+#endif // SOLVERPOOL_H
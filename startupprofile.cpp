@@ -0,0 +1,93 @@
+/*
+ * 文件名: startupprofile.cpp
+ * 文件作用: 启动耗时记录实现文件
+ * 功能描述:
+ * 1. 阶段与页面耗时按记录顺序保存；首帧之后构造的页面同样计入报告 (标记为"首次切换")。
+ * 2. 报告写入 QSettings("WellTestPro","WellTestAnalysis") 的 startup/firstFrameMs 与 startup/lastReport。
+ */
+
+#include "startupprofile.h"
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QSettings>
+#include <QStringList>
+#include <QDebug>
+
+namespace {
+
+QElapsedTimer& clock()
+{
+    static QElapsedTimer timer;
+    return timer;
+}
+
+struct Records {
+    QList<QPair<QString, qint64>> stages;   // 阶段名与自零点起的时间
+    QList<QPair<QString, qint64>> pages;    // 页面名与构造耗时
+    QList<bool> pagesAfterFrame;            // 页面在首帧之后构造
+    qint64 firstFrame = -1;
+};
+
+Records& records()
+{
+    static Records r;
+    return r;
+}
+
+}
+
+void StartupProfile::start()
+{
+    clock().start();
+}
+
+qint64 StartupProfile::elapsed()
+{
+    return clock().isValid() ? clock().elapsed() : 0;
+}
+
+void StartupProfile::mark(const QString& stage)
+{
+    records().stages.append(qMakePair(stage, elapsed()));
+}
+
+void StartupProfile::recordPage(const QString& page, qint64 msecs)
+{
+    Records& r = records();
+    r.pages.append(qMakePair(page, msecs));
+    r.pagesAfterFrame.append(r.firstFrame >= 0);
+    if (r.firstFrame >= 0) qInfo().noquote() << QString("[启动] 页面 \"%1\" 首次构造 %2 ms").arg(page).arg(msecs);
+}
+
+void StartupProfile::firstFrame()
+{
+    Records& r = records();
+    if (r.firstFrame >= 0) return;
+    r.firstFrame = elapsed();
+
+    const QString text = report();
+    qInfo().noquote() << text;
+
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    settings.setValue("startup/firstFrameMs", r.firstFrame);
+    settings.setValue("startup/lastReport", text);
+}
+
+bool StartupProfile::firstFrameShown()
+{
+    return records().firstFrame >= 0;
+}
+
+QString StartupProfile::report()
+{
+    const Records& r = records();
+    QStringList lines;
+    lines << (r.firstFrame >= 0 ? QString("[启动] 首帧 %1 ms").arg(r.firstFrame) : QString("[启动] 首帧尚未绘制"));
+    for (const auto& stage : r.stages) lines << QString("  阶段 %1: %2 ms").arg(stage.first).arg(stage.second);
+    for (int i = 0; i < r.pages.size(); ++i) {
+        lines << QString("  页面 %1: %2 ms%3").arg(r.pages[i].first).arg(r.pages[i].second)
+                     .arg(r.pagesAfterFrame[i] ? " (首次切换)" : "");
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,37 @@
+/*
+ * 文件名: startupprofile.h
+ * 文件作用: 启动耗时记录头文件
+ * 功能描述:
+ * 1. StartupProfile 以 main 入口为零点记录启动各阶段 (样式表、主窗口构造、首帧) 的时间点，
+ *    以及各功能页面首次构造的耗时 (页面在首次切换到时才构造，耗时可能发生在启动之后)。
+ * 2. 主窗口首次绘制后输出启动报告 (qInfo)，并把首帧时间与报告写入 QSettings (startup/*)，便于对比发现启动回退。
+ * 3. 只在界面线程使用。
+ */
+
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QString>
+
+class StartupProfile
+{
+public:
+    // 计时零点 (main 入口处调用)
+    static void start();
+    // 自零点起的毫秒数
+    static qint64 elapsed();
+
+    // 记录启动阶段：阶段结束时调用，记下自零点起的时间
+    static void mark(const QString& stage);
+    // 记录页面构造耗时 (毫秒)
+    static void recordPage(const QString& page, qint64 msecs);
+
+    // 主窗口首帧已绘制：记下首帧时间并输出报告 (只有第一次调用有效)
+    static void firstFrame();
+    static bool firstFrameShown();
+
+    // 当前的启动报告 (多行文本)
+    static QString report();
+};
+
+#endif // STARTUPPROFILE_H
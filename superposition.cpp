@@ -0,0 +1,312 @@
+/*
+ * superposition.cpp
+ * 文件作用: 变产量叠加计算实现文件
+ * 功能描述:
+ * 1. 产量历史的构造与近似相等产量的合并，合并阶段的产量按持续时间加权，累计产量不变。
+ * 2. 单位响应网格：按观测时刻与阶段起始时刻之差的范围生成对数等距网格。
+ * 3. 叠加求和：各阶段按 ln(t - t_i) 线性插值单位响应，压力与导数同时累加；
+ *    阶段过多时按观测时刻将较早阶段按时间差对数分箱 (累计产量前缀和，每箱 O(log n) 定位)。
+ * 4. 所在阶段的查询：RateHistory::stageAt 二分查找，RateCursor 在时刻递增时逐段前移。
+ */
+
+#include "superposition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 最短时间差相对最长时间差的下限 (防止观测时刻紧贴产量变化时网格过长)
+const double kMinLagRatio = 1e-8;
+
+// 自动分组时每个箱覆盖的时间差比例 (约每个对数周期 10 箱)
+const double kLagBinRatio = 1.25;
+
+// 单位响应在 ln τ 上的线性插值；τ 低于网格下限时按早期线性段 (p ∝ τ) 外推
+void interpolateResponse(const QVector<double>& logT, const QVector<double>& p, const QVector<double>& d,
+                         double tau, double& outP, double& outD)
+{
+    const double x = std::log(tau);
+    if (x <= logT.first()) {
+        double ratio = tau / std::exp(logT.first());
+        outP = p.first() * ratio;
+        outD = d.first() * ratio;
+        return;
+    }
+    if (x >= logT.last()) {
+        outP = p.last();
+        outD = d.last();
+        return;
+    }
+    int j = int(std::upper_bound(logT.constBegin(), logT.constEnd(), x) - logT.constBegin()) - 1;
+    double w = (x - logT[j]) / (logT[j + 1] - logT[j]);
+    outP = p[j] + w * (p[j + 1] - p[j]);
+    outD = d[j] + w * (d[j + 1] - d[j]);
+}
+
+// 两个产量是否在相对容差内相等 (零产量只与零产量合并，关井段保持独立)
+bool ratesMatch(double a, double b, double relTolerance)
+{
+    const double scale = std::max(std::abs(a), std::abs(b));
+    if (scale < 1e-12) return true;
+    if (std::abs(a) < 1e-12 || std::abs(b) < 1e-12) return false;
+    return std::abs(a - b) <= relTolerance * scale;
+}
+
+} // namespace
+
+// ---------------------- RateHistory ----------------------
+
+RateHistory RateHistory::fromSamples(const QVector<double>& t, const QVector<double>& q)
+{
+    RateHistory history;
+    const int n = std::min(t.size(), q.size());
+    for (int i = 0; i < n; ++i) {
+        if (!std::isfinite(t[i]) || !std::isfinite(q[i]) || t[i] < 0.0) continue;
+        if (!history.isEmpty() && t[i] <= history.startTime.last()) continue;
+        if (!history.isEmpty() && q[i] == history.rate.last()) continue;
+        // 首个阶段从时间零点开始 (观测时间以开井时刻为原点)
+        history.startTime.append(history.isEmpty() ? 0.0 : t[i]);
+        history.rate.append(q[i]);
+    }
+    return history;
+}
+
+bool RateHistory::isStartTimeSequence(const QVector<double>& x)
+{
+    if (x.size() < 2) return false;
+    for (int i = 0; i + 1 < x.size(); ++i) {
+        if (x[i + 1] <= x[i]) return false;
+    }
+    return true;
+}
+
+RateHistory RateHistory::fromStartTimes(const QVector<double>& x, const QVector<double>& q)
+{
+    RateHistory history;
+    const int n = std::min(x.size(), q.size());
+    for (int i = 0; i < n; ++i) {
+        if (!std::isfinite(x[i]) || !std::isfinite(q[i])) continue;
+        if (!history.isEmpty() && x[i] <= history.startTime.last()) {
+            history.rate.last() = q[i];
+            continue;
+        }
+        history.startTime.append(x[i]);
+        history.rate.append(q[i]);
+    }
+    return history;
+}
+
+int RateHistory::stageAt(double t) const
+{
+    return int(std::lower_bound(startTime.constBegin(), startTime.constEnd(), t) - startTime.constBegin()) - 1;
+}
+
+double RateHistory::rateAt(double t) const
+{
+    const int j = stageAt(t);
+    return j < 0 ? 0.0 : rate[j];
+}
+
+QVector<double> RateHistory::ratesAt(const QVector<double>& t) const
+{
+    QVector<double> out(t.size());
+    RateCursor cursor(*this);
+    for (int i = 0; i < t.size(); ++i) out[i] = cursor.rateAt(t[i]);
+    return out;
+}
+
+RateHistory RateHistory::fromSteps(const QVector<double>& x, const QVector<double>& q)
+{
+    RateHistory history;
+    const int n = std::min(x.size(), q.size());
+    if (n == 0) return history;
+
+    // 与 WT_PlottingWidget::drawStackedPlot 的判断一致：严格递增视为起始时间
+    const bool isAbsoluteTime = isStartTimeSequence(x.mid(0, n));
+
+    double start = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double s = isAbsoluteTime ? x[i] : start;
+        if (!isAbsoluteTime) start += std::max(0.0, x[i]);
+        if (!std::isfinite(s) || !std::isfinite(q[i])) continue;
+        if (!history.isEmpty() && s <= history.startTime.last()) {
+            history.rate.last() = q[i]; // 零时长阶段由后一阶段覆盖
+            continue;
+        }
+        history.startTime.append(s);
+        history.rate.append(q[i]);
+    }
+    return history;
+}
+
+RateHistory RateHistory::grouped(double relTolerance) const
+{
+    if (size() <= 1) return *this;
+
+    // 最后一个阶段无终点，与前一组合并时取自身产量
+    RateHistory merged;
+    double groupVolume = 0.0, groupDuration = 0.0;
+    for (int i = 0; i < size(); ++i) {
+        const bool last = (i + 1 == size());
+        const double duration = last ? 0.0 : startTime[i + 1] - startTime[i];
+        if (!merged.isEmpty() && ratesMatch(merged.rate.last(), rate[i], relTolerance)) {
+            groupVolume += rate[i] * duration;
+            groupDuration += duration;
+            if (last) merged.rate.last() = rate[i];
+            else if (groupDuration > 0.0) merged.rate.last() = groupVolume / groupDuration;
+            continue;
+        }
+        merged.startTime.append(startTime[i]);
+        merged.rate.append(rate[i]);
+        groupVolume = rate[i] * duration;
+        groupDuration = duration;
+    }
+    return merged;
+}
+
+// ---------------------- RateCursor ----------------------
+
+int RateCursor::stageAt(double t)
+{
+    const QVector<double>& start = m_history.startTime;
+    if (m_stage >= 0 && t <= start[m_stage]) {
+        m_stage = m_history.stageAt(t); // 时刻回退
+        return m_stage;
+    }
+    while (m_stage + 1 < start.size() && start[m_stage + 1] < t) ++m_stage;
+    return m_stage;
+}
+
+double RateCursor::rateAt(double t)
+{
+    const int j = stageAt(t);
+    return j < 0 ? 0.0 : m_history.rate[j];
+}
+
+// ---------------------- SuperpositionTerms ----------------------
+
+SuperpositionTerms::SuperpositionTerms(const RateHistory& history, bool autoGroup)
+    : m_history(history)
+    , m_grouping(autoGroup && history.size() > SuperpositionEngine::AutoGroupThreshold)
+{
+    const int steps = m_history.size();
+    if (m_grouping) {
+        const QVector<double>& start = m_history.startTime;
+        m_volume.resize(steps);
+        m_volume[0] = 0.0;
+        for (int i = 1; i < steps; ++i) m_volume[i] = m_volume[i - 1] + m_history.rate[i - 1] * (start[i] - start[i - 1]);
+    }
+    m_groupStart.reserve(m_grouping ? 64 : steps);
+    m_groupRate.reserve(m_grouping ? 64 : steps);
+}
+
+int SuperpositionTerms::collect(double t, QVector<double>& lag, QVector<double>& deltaRate) const
+{
+    const QVector<double>& start = m_history.startTime;
+    // 起点早于 t 的最后一个阶段
+    const int j = m_history.stageAt(t);
+    lag.clear();
+    deltaRate.clear();
+    if (j < 0) return 0;
+
+    // 参与叠加的阶段 (时间倒序收集)
+    m_groupStart.clear();
+    m_groupRate.clear();
+    if (!m_grouping) {
+        for (int i = j; i >= 0; --i) { m_groupStart.append(start[i]); m_groupRate.append(m_history.rate[i]); }
+    } else {
+        // 最近的阶段逐个保留
+        int end = std::max(0, j - SuperpositionEngine::ExactRecentSteps + 1);
+        for (int i = j; i >= end; --i) { m_groupStart.append(start[i]); m_groupRate.append(m_history.rate[i]); }
+        // 更早的阶段：箱的时间差跨度为 kLagBinRatio 倍，箱内按累计产量取平均产量
+        while (end > 0) {
+            const double lagEnd = t - start[end];
+            int a = int(std::lower_bound(start.constBegin(), start.constEnd(), t - lagEnd * kLagBinRatio) - start.constBegin());
+            a = std::min(a, end - 1);
+            m_groupStart.append(start[a]);
+            m_groupRate.append((m_volume[end] - m_volume[a]) / (start[end] - start[a]));
+            end = a;
+        }
+    }
+
+    const int n = m_groupStart.size();
+    lag.resize(n);
+    deltaRate.resize(n);
+    for (int g = 0; g < n; ++g) {
+        lag[g] = t - m_groupStart[g];
+        deltaRate[g] = m_groupRate[g] - (g + 1 < n ? m_groupRate[g + 1] : 0.0);
+    }
+    return n;
+}
+
+// ---------------------- SuperpositionEngine ----------------------
+
+RateHistory SuperpositionEngine::prepare(const RateHistory& history)
+{
+    return history.grouped(0.0);
+}
+
+QVector<double> SuperpositionEngine::responseGrid(const RateHistory& history, const QVector<double>& t)
+{
+    if (history.isEmpty() || t.isEmpty()) return QVector<double>();
+
+    // 最长时间差：最晚观测时刻减去首个阶段起点；最短时间差：各观测时刻减去其之前最近的阶段起点
+    double maxLag = 0.0;
+    double minLag = std::numeric_limits<double>::infinity();
+    RateCursor cursor(history);
+    for (double tk : t) {
+        const int j = cursor.stageAt(tk);
+        if (j < 0) continue;
+        maxLag = std::max(maxLag, tk - history.startTime[0]);
+        minLag = std::min(minLag, tk - history.startTime[j]);
+    }
+    if (!(maxLag > 0.0)) return QVector<double>();
+    minLag = std::max(minLag, maxLag * kMinLagRatio);
+    if (minLag >= maxLag) minLag = maxLag * 0.1;
+
+    const double startExp = std::log10(minLag);
+    const double endExp = std::log10(maxLag);
+    const int count = std::max(2, int(std::ceil((endExp - startExp) * GridPointsPerDecade)) + 1);
+    return ModelSolver01_06::generateLogTimeSteps(count, startExp, endExp);
+}
+
+ModelCurveData SuperpositionEngine::superpose(const ModelCurveData& unitResponse, double referenceRate,
+                                              const RateHistory& history, const QVector<double>& t, bool autoGroup)
+{
+    const QVector<double>& unitT = std::get<0>(unitResponse);
+    const QVector<double>& unitP = std::get<1>(unitResponse);
+    const QVector<double>& unitD = std::get<2>(unitResponse);
+
+    QVector<double> outP(t.size(), 0.0), outD(t.size(), 0.0);
+    if (unitT.size() < 2 || unitP.size() != unitT.size() || unitD.size() != unitT.size()
+        || history.isEmpty() || std::abs(referenceRate) < 1e-300) {
+        return std::make_tuple(t, outP, outD);
+    }
+
+    QVector<double> logT(unitT.size());
+    for (int i = 0; i < unitT.size(); ++i) logT[i] = std::log(unitT[i]);
+
+    SuperpositionTerms terms(history, autoGroup);
+    QVector<double> lag, deltaRate;
+    for (int k = 0; k < t.size(); ++k) {
+        const double tk = t[k];
+        const int n = terms.collect(tk, lag, deltaRate);
+
+        // 按时间顺序 (较早的阶段在前) 叠加各阶段的产量增量
+        double p = 0.0, d = 0.0;
+        for (int g = n - 1; g >= 0; --g) {
+            const double dq = deltaRate[g] / referenceRate;
+            if (dq == 0.0) continue;
+            const double tau = lag[g];
+            double pu, du;
+            interpolateResponse(logT, unitP, unitD, tau, pu, du);
+            p += dq * pu;
+            d += dq * du * (tk / tau); // t·dp/dt = (t/τ)·τ·dp/dτ
+        }
+        outP[k] = p;
+        outD[k] = d;
+    }
+    return std::make_tuple(t, outP, outD);
+}
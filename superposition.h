@@ -0,0 +1,111 @@
+/*
+ * superposition.h
+ * 文件作用: 变产量叠加计算头文件
+ * 功能描述:
+ * 1. 定义分段恒定的产量历史 RateHistory：各阶段起始时间与产量 (与模型参数 q 同单位)。
+ *    支持按逐点 (时间, 产量) 数据或阶梯数据 (起始时间 / 持续时间两种约定，与双坐标图一致) 构造。
+ * 2. 产量阶段过多时自动分组：对每个观测时刻，最近的若干阶段逐个叠加，更早的阶段按时间差的对数分箱，
+ *    箱内按累计产量 (前缀和) 合并为持续时间加权的平均产量，每个时刻的叠加项数随阶段数对数增长。
+ * 3. SuperpositionEngine 将定产量模型响应按产量变化叠加：
+ *    Δp(t) = Σ (q_i - q_{i-1}) / q_ref · p_u(t - t_i)，导数为 t·dΔp/dt。
+ *    单位响应只在一条共享对数时间网格上计算一次 (一次数值反演)，各阶段按对数时间插值取值。
+ * 4. SuperpositionTerms 单独给出每个观测时刻的叠加项 (时间差与产量增量)，供叠加与反褶积 (deconvolution.h) 共用。
+ * 5. 按时刻查询产量：stageAt / rateAt 二分查找所在阶段；RateCursor 顺序查询时逐段前移 (时刻升序时整体为一次归并遍历)，
+ *    供叠加计算、双坐标图的阶梯曲线与数据导出共用。产量变化时刻本身仍属于前一阶段 (与叠加项的 "起点早于 t" 一致)。
+ */
+
+#ifndef SUPERPOSITION_H
+#define SUPERPOSITION_H
+
+#include <QVector>
+#include "modelsolver01-06.h"
+
+// 分段恒定的产量历史：第 i 个阶段从 startTime[i] 开始，持续到下一阶段开始 (最后一个阶段无终点)
+struct RateHistory {
+    QVector<double> startTime; // 阶段起始时间 (h，严格递增，首个阶段之前产量为 0)
+    QVector<double> rate;      // 阶段产量
+
+    bool isEmpty() const { return startTime.isEmpty(); }
+    int size() const { return startTime.size(); }
+
+    // 最后一次产量变化的时刻 (恢复试井即为关井时刻)，历史为空时返回 0
+    double lastChangeTime() const { return startTime.isEmpty() ? 0.0 : startTime.last(); }
+
+    // 逐点数据：每个时间点记录当时的产量，产量变化处开始新阶段 (非正时间与非有限值被跳过)
+    static RateHistory fromSamples(const QVector<double>& t, const QVector<double>& q);
+
+    // 阶梯数据：x 严格递增时为各阶段起始时间，否则为各阶段持续时间 (首阶段从 0 开始)
+    static RateHistory fromSteps(const QVector<double>& x, const QVector<double>& q);
+    // 阶梯数据的 x 是否为起始时间 (严格递增且不少于两个点)
+    static bool isStartTimeSequence(const QVector<double>& x);
+    // 起始时间数据：x 为各阶段起始时间 (不递增处由后一阶段覆盖前一阶段)
+    static RateHistory fromStartTimes(const QVector<double>& x, const QVector<double>& q);
+
+    // 起点早于 t 的最后一个阶段 (t 不晚于首个阶段起点时为 -1)
+    int stageAt(double t) const;
+    // 时刻 t 的产量 (t 不晚于首个阶段起点时为 0)
+    double rateAt(double t) const;
+    // 一组时刻的产量 (t 升序时一次归并遍历)
+    QVector<double> ratesAt(const QVector<double>& t) const;
+
+    // 合并相对差异在 relTolerance 以内的相邻产量 (按持续时间加权，累计产量不变；零产量只与零产量合并)
+    RateHistory grouped(double relTolerance) const;
+};
+
+// 顺序查询产量：查询时刻不减时从上次的阶段向后移动，回退时重新二分查找
+class RateCursor
+{
+public:
+    explicit RateCursor(const RateHistory& history) : m_history(history), m_stage(-1) {}
+
+    int stageAt(double t);
+    double rateAt(double t);
+
+private:
+    const RateHistory& m_history;
+    int m_stage;
+};
+
+// 叠加项生成器：给出观测时刻 t 的各叠加项 (时间差 t - t_i 与产量增量 q_i - q_{i-1}，产量单位不变)，
+// 阶段数超过 SuperpositionEngine::AutoGroupThreshold 且允许分组时，较早阶段按对数时间差分箱 (见功能描述 2)
+class SuperpositionTerms
+{
+public:
+    explicit SuperpositionTerms(const RateHistory& history, bool autoGroup = true);
+
+    // 按时间差升序 (最近的阶段在前) 写入叠加项，返回项数；t 不晚于首个阶段起点时返回 0
+    int collect(double t, QVector<double>& lag, QVector<double>& deltaRate) const;
+
+    bool isGrouping() const { return m_grouping; }
+
+private:
+    RateHistory m_history;
+    bool m_grouping;
+    QVector<double> m_volume; // 累计产量前缀和：m_volume[i] 为第 i 阶段起点之前的累计产量
+    mutable QVector<double> m_groupStart, m_groupRate; // collect 的临时存储
+};
+
+class SuperpositionEngine
+{
+public:
+    // 超过该阶段数时自动分组；分组时每个观测时刻最近的 ExactRecentSteps 个阶段逐个叠加
+    enum { AutoGroupThreshold = 100, ExactRecentSteps = 10 };
+
+    // 单位响应网格每个对数周期的点数
+    enum { GridPointsPerDecade = 25 };
+
+    // 单位响应所需的对数时间网格：覆盖全部观测时刻与各阶段起始时刻之差 t - t_i > 0
+    // 最短时间差不小于最长时间差的 1e-8 倍，更短的时间差按早期线性段处理
+    static QVector<double> responseGrid(const RateHistory& history, const QVector<double>& t);
+
+    // 叠加：unitResponse 为 responseGrid 网格上、产量为 referenceRate 时的定产量理论曲线
+    // 返回 <t, Δp(t), t·dΔp/dt>；t 早于首个阶段的点压降为 0
+    // autoGroup 为真且阶段数超过 AutoGroupThreshold 时按观测时刻分组 (见功能描述 2)，否则逐阶段精确叠加
+    static ModelCurveData superpose(const ModelCurveData& unitResponse, double referenceRate,
+                                    const RateHistory& history, const QVector<double>& t, bool autoGroup = true);
+
+    // 叠加前的准备：合并与前一阶段产量相同的阶段
+    static RateHistory prepare(const RateHistory& history);
+};
+
+#endif // SUPERPOSITION_H
@@ -0,0 +1,233 @@
+/*
+ * 文件名: taskscheduler.cpp
+ * 文件作用: 工作窃取任务调度器实现文件
+ * 功能描述:
+ * 1. 一次 parallelFor 对应一个任务组：组内以原子计数器分发下标，队列中放入至多 "工作线程数" 个运行者，
+ *    每个运行者反复领取下标直到领完，负载自动均衡，队列操作次数与下标数无关。
+ * 2. 任务组由共享指针持有：调用线程返回后仍在队列中的运行者取出时发现下标已领完，立即结束，不再访问任务体。
+ * 3. 等待中的线程没有可帮助的任务时在条件变量上至多等待 1 ms 后重试 (新任务入队与任务组完成时都会唤醒)。
+ */
+
+#include "taskscheduler.h"
+#include "cancellationtoken.h"
+#include <QThread>
+#include <QtGlobal>
+#include <chrono>
+
+struct TaskScheduler::Group {
+    const std::function<void(int)>* body = nullptr;
+    int count = 0;
+    std::atomic<int> next{0};   // 下一个待领取的下标
+    std::atomic<int> done{0};   // 已完成的下标数
+    int priority = Foreground;
+    const CancellationToken* token = nullptr;
+};
+
+struct TaskScheduler::Worker {
+    std::mutex mutex;
+    std::deque<Task> queues[PriorityCount];
+    std::thread thread;
+};
+
+namespace {
+
+thread_local int t_workerIndex = -1;                       // 当前线程的工作线程下标 (非工作线程为 -1)
+thread_local int t_priority = TaskScheduler::Foreground;   // 当前线程提交任务的优先级
+thread_local unsigned t_victim = 0;                        // 下一次窃取的起始位置
+
+} // namespace
+
+TaskScheduler& TaskScheduler::instance()
+{
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler()
+{
+    m_active.store(qBound(1, QThread::idealThreadCount(), int(MaxWorkers)));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    const int created = m_created.load();
+    for (int i = 0; i < created; ++i)
+        if (m_workers[i]->thread.joinable()) m_workers[i]->thread.join();
+}
+
+void TaskScheduler::setWorkerCount(int count)
+{
+    m_active.store(qBound(1, count, int(MaxWorkers)));
+    if (m_created.load() > 0) ensureWorkers();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_wake.notify_all(); // 挂起的线程重新检查自己是否参与
+}
+
+int TaskScheduler::workerCount() const
+{
+    return m_active.load();
+}
+
+TaskScheduler::Priority TaskScheduler::currentPriority()
+{
+    return Priority(t_priority);
+}
+
+TaskScheduler::PriorityScope::PriorityScope(Priority priority)
+    : m_previous(Priority(t_priority))
+{
+    t_priority = priority;
+}
+
+TaskScheduler::PriorityScope::~PriorityScope()
+{
+    t_priority = m_previous;
+}
+
+void TaskScheduler::ensureWorkers()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int i = m_created.load(); i < m_active.load() && !m_stopping; ++i) {
+        m_workers[i].reset(new Worker);
+        m_workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+        m_created.store(i + 1, std::memory_order_release);
+    }
+}
+
+void TaskScheduler::workerLoop(int index)
+{
+    t_workerIndex = index;
+    for (;;) {
+        if (index < m_active.load(std::memory_order_relaxed) && runOne(Batch)) continue;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_stopping) return;
+        // 没有任务或本线程已被挂起 (下标不小于当前线程数) 时休眠
+        m_wake.wait(lock, [&] { return m_stopping || (index < m_active.load() && m_pending.load() > 0); });
+    }
+}
+
+void TaskScheduler::push(const Task& task, int copies)
+{
+    if (copies <= 0) return;
+    const int p = task->priority;
+    if (t_workerIndex >= 0) {
+        Worker& w = *m_workers[t_workerIndex];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        for (int i = 0; i < copies; ++i) w.queues[p].push_back(task);
+        m_pending.fetch_add(copies);
+    } else {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int i = 0; i < copies; ++i) m_global[p].push_back(task);
+        m_pending.fetch_add(copies);
+    }
+    {
+        // 与休眠线程的条件检查同步，避免丢失唤醒
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_wake.notify_all();
+}
+
+TaskScheduler::Task TaskScheduler::take(int priority)
+{
+    Task task;
+    const int self = t_workerIndex;
+    // 1. 自己队列的尾部 (最近提交的嵌套任务)
+    if (self >= 0) {
+        Worker& w = *m_workers[self];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.queues[priority].empty()) {
+            task = w.queues[priority].back();
+            w.queues[priority].pop_back();
+        }
+    }
+    // 2. 全局队列
+    if (!task) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_global[priority].empty()) {
+            task = m_global[priority].front();
+            m_global[priority].pop_front();
+        }
+    }
+    // 3. 从其他工作线程队列的头部窃取 (起始位置轮换，避免争抢同一个队列)
+    if (!task) {
+        const int created = m_created.load(std::memory_order_acquire);
+        const int start = created > 0 ? int(t_victim++ % unsigned(created)) : 0;
+        for (int k = 0; k < created && !task; ++k) {
+            const int victim = (start + k) % created;
+            if (victim == self) continue;
+            Worker& w = *m_workers[victim];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if (!w.queues[priority].empty()) {
+                task = w.queues[priority].front();
+                w.queues[priority].pop_front();
+            }
+        }
+    }
+    if (task) m_pending.fetch_sub(1);
+    return task;
+}
+
+bool TaskScheduler::runOne(int limit)
+{
+    if (m_pending.load() <= 0) return false;
+    for (int p = 0; p <= limit; ++p) {
+        Task task = take(p);
+        if (task) {
+            execute(*task);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::execute(Group& group)
+{
+    PriorityScope priorityScope(Priority(group.priority));
+    CancellationToken::Scope cancellationScope(group.token);
+    for (;;) {
+        const int i = group.next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= group.count) return;
+        (*group.body)(i);
+        if (group.done.fetch_add(1, std::memory_order_acq_rel) + 1 == group.count) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+            }
+            m_wake.notify_all();
+        }
+    }
+}
+
+void TaskScheduler::run(int count, const std::function<void(int)>& body)
+{
+    if (count <= 0) return;
+    if (count == 1) {
+        body(0);
+        return;
+    }
+    if (m_created.load(std::memory_order_acquire) < m_active.load()) ensureWorkers();
+
+    Task group = std::make_shared<Group>();
+    group->body = &body;
+    group->count = count;
+    group->priority = t_priority;
+    group->token = CancellationToken::current();
+
+    // 调用线程自己算一份，其余的运行者交给工作线程
+    push(group, qMin(count - 1, m_active.load()));
+    execute(*group);
+
+    // 其他线程手中的下标尚未完成：执行不低于本线程优先级的其他任务，没有时短暂等待
+    while (group->done.load(std::memory_order_acquire) < count) {
+        if (runOne(t_priority)) continue;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (group->done.load(std::memory_order_acquire) >= count) break;
+        m_wake.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * 文件名: taskscheduler.h
+ * 文件作用: 支持嵌套分叉/合并的工作窃取任务调度器头文件 (不依赖界面)
+ * 功能描述:
+ * 1. 计算密集的数据并行 (雅可比各列、Laplace 反演的时间点、敏感性工况、导入分段) 统一经 parallelFor 派发到
+ *    调度器自己的工作线程，不再在全局 QThreadPool 上嵌套阻塞：QThreadPool 只承载外层的长任务 (拟合线程、预览、导入)。
+ * 2. 工作线程各有一组本地双端队列，自己从尾部取 (后进先出，嵌套的子任务优先完成)，空闲时从其他线程的头部窃取；
+ *    非工作线程 (界面线程、QThreadPool 线程) 提交的任务进入全局队列。
+ * 3. 调用 parallelFor 的线程自己参与执行；下标领完后等待其他线程手中的下标时，执行队列中的其他任务而不是挂起，
+ *    因此在任务中再次调用 parallelFor (拟合线程 → 雅可比列 → 时间点) 不会让线程空等，也不会额外创建线程。
+ * 4. 优先级：交互预览 (Interactive) > 前台拟合 (Foreground，缺省) > 批量任务 (Batch)。工作线程总是先取优先级高的任务；
+ *    等待中的线程只帮助执行不低于自身优先级的任务，交互预览不会被卷入批量任务的长计算。
+ *    任务继承提交线程的优先级与取消令牌 (CancellationToken::current)，嵌套提交的子任务同样继承。
+ * 5. 工作线程数由 PerformanceSettings 设置 (performance/workerThreads)；线程在第一次并行时创建，
+ *    调小后多余的线程挂起 (其队列中剩余的任务由其他线程窃取)。
+ */
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class CancellationToken;
+
+class TaskScheduler
+{
+public:
+    // 任务优先级 (数值越小越优先)
+    enum Priority {
+        Interactive = 0, // 交互预览
+        Foreground = 1,  // 前台拟合与计算 (缺省)
+        Batch = 2,       // 批量拟合队列等后台任务
+        PriorityCount = 3
+    };
+
+    static TaskScheduler& instance();
+
+    // 设置工作线程数 (不小于 1)
+    void setWorkerCount(int count);
+    int workerCount() const;
+
+    // 并行执行 body(0) … body(count - 1)，全部完成后返回 (各下标的执行顺序不定)
+    void run(int count, const std::function<void(int)>& body);
+
+    // 便捷形式：使用全局调度器
+    static void parallelFor(int count, const std::function<void(int)>& body) { instance().run(count, body); }
+
+    // 按下标并行计算，结果按下标顺序返回
+    template <typename T, typename Fn>
+    static QVector<T> mapped(int count, Fn fn)
+    {
+        QVector<T> results(qMax(0, count));
+        parallelFor(count, [&](int i) { results[i] = fn(i); });
+        return results;
+    }
+
+    // 当前线程提交任务使用的优先级
+    static Priority currentPriority();
+
+    // 优先级守卫：作用域内提交的任务使用 priority，析构时恢复
+    class PriorityScope {
+    public:
+        explicit PriorityScope(Priority priority);
+        ~PriorityScope();
+    private:
+        Priority m_previous;
+    };
+
+private:
+    struct Group;
+    struct Worker;
+    using Task = std::shared_ptr<Group>;
+
+    TaskScheduler();
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void ensureWorkers();
+    void workerLoop(int index);
+    void push(const Task& task, int copies);
+    Task take(int priority);
+    // 取出一个优先级不低于 limit 的任务并执行，没有可执行的任务时返回 false
+    bool runOne(int limit);
+    void execute(Group& group);
+
+    static const int MaxWorkers = 256;
+
+    std::unique_ptr<Worker> m_workers[MaxWorkers];
+    std::atomic<int> m_created{0};   // 已创建的工作线程数 (m_workers 前 m_created 项有效)
+    std::atomic<int> m_active{0};    // 参与取任务的工作线程数
+    std::atomic<int> m_pending{0};   // 各队列中的任务总数
+    std::mutex m_mutex;              // 保护全局队列与线程的创建、休眠
+    std::condition_variable m_wake;
+    std::deque<Task> m_global[PriorityCount]; // 非工作线程提交的任务 (先进先出)
+    bool m_stopping = false;
+};
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,469 @@
+/*
+ * texttablereader.cpp
+ * 文件作用: 文本数据文件 (.csv / .txt) 快速导入实现文件
+ * 功能描述:
+ * 1. 段边界取在换行之后，各段第一遍只数引号与换行 (按段首引号状态的两种可能分别计数)，
+ *    之后顺序求前缀即可确定每段段首是否在引号内、之前有多少条记录，第二遍各段互不依赖。
+ * 2. 每条记录在所属段内解析 (可跨过段尾)；段首在引号内时先跳过上一段起始的记录的剩余部分。
+ * 3. 字段去除首尾空白后，首尾均为引号时去除引号 (与原先逐行读取一致)，引号内的 "" 还原为 "。
+ * 4. UTF-8 BOM 跳过；带 UTF-16 BOM 的文件先整体转为 UTF-8 再按字节解析 (原 QTextStream 同样自动识别 BOM)。
+ * 5. [分批交付] 各段按线程数分批解析，每批完成后按顺序交给 BlockSink 并释放，后台加载时表格可逐批显示；
+ *    取消令牌在批与批之间以及段内每若干条记录检查一次。
+ * 6. [有界预览] readHead 只映射文件开头并截到最后一个完整行；parse 对内存中的样本执行与 read 相同的解析，
+ *    导入对话框用它显示预览，样本即整个文件时预览结果直接作为导入结果。
+ * 7. [格式识别] 编码：有 BOM 或样本是合法 UTF-8 时取 UTF-8，否则取 GBK；
+ *    分隔符：逐行 (引号外) 统计制表符、逗号、分号与空格，取出现次数在最多行上一致的那个，空格只在其余三者都不出现时考虑。
+ * 8. [任务调度] 两遍扫描的各段经 TaskScheduler 并行 (导入线程自己也解析一段)，每批段数为工作线程数加一。
+ */
+
+#include "texttablereader.h"
+#include "columnartablemodel.h"
+#include "dataimportdialog.h"
+#include "cancellationtoken.h"
+#include "memoryaccounting.h"
+#include "taskscheduler.h"
+#include "tracing.h"
+
+#include <QFile>
+#include <QHash>
+#include <QStringDecoder>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const double kEmpty = std::numeric_limits<double>::quiet_NaN();
+const int kMaxDecimals = 17;
+const qint64 kMinChunkBytes = 1 << 20; // 每段至少 1 MB，小文件不分段
+const qint64 kMaxChunks = 1024;
+const int kCancelCheckRecords = 4096;  // 每解析若干条记录检查一次取消
+
+enum class TextEncoding { Utf8, Latin1, System };
+
+struct Field {
+    const char* begin;
+    const char* end;
+};
+
+struct Chunk {
+    qint64 begin = 0;
+    qint64 end = 0;
+    qint64 quotes = 0;
+    qint64 newlines[2] = {0, 0}; // 相对段首引号状态为偶 / 奇时遇到的换行数
+    bool startsInQuote = false;
+    qint64 firstRecord = 0;      // 段首之前结束的记录数
+    ColumnarTableModel::RowBlock block;
+    QStringList header;
+};
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// 去除首尾空白；首尾均为引号时去除引号
+void trimField(const char*& b, const char*& e, bool& quoted)
+{
+    while (b < e && isBlank(*b)) ++b;
+    while (e > b && isBlank(e[-1])) --e;
+    quoted = (e - b >= 2 && *b == '"' && e[-1] == '"');
+    if (quoted) { ++b; --e; }
+}
+
+QString decode(const char* b, qsizetype n, TextEncoding encoding)
+{
+    switch (encoding) {
+    case TextEncoding::Latin1: return QString::fromLatin1(b, n);
+    case TextEncoding::System: return QString::fromLocal8Bit(b, n);
+    default: return QString::fromUtf8(b, n);
+    }
+}
+
+QString fieldText(const char* b, const char* e, bool quoted, TextEncoding encoding)
+{
+    QString s = decode(b, e - b, encoding);
+    if (quoted && s.contains(QLatin1Char('"'))) s.replace(QLatin1String("\"\""), QLatin1String("\""));
+    if (s.contains(QLatin1Char('\r'))) s.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+    return s;
+}
+
+// 解析从 pos 开始的一条记录，返回下一条记录的起点；fields 为空时只定位记录末尾
+qint64 scanRecord(const char* data, qint64 pos, qint64 size, char separator, bool quoteAware, QVector<Field>* fields)
+{
+    bool inQuote = false;
+    qint64 fieldStart = pos;
+    qint64 i = pos;
+    for (; i < size; ++i) {
+        const char c = data[i];
+        if (c == '"' && quoteAware) { inQuote = !inQuote; continue; }
+        if (inQuote) continue;
+        if (c == '\n') break;
+        if (c == separator && fields) {
+            fields->append(Field{data + fieldStart, data + i});
+            fieldStart = i + 1;
+        }
+    }
+    if (fields) fields->append(Field{data + fieldStart, data + i});
+    return i < size ? i + 1 : size;
+}
+
+void appendRecord(ColumnarTableModel::RowBlock& block, const QVector<Field>& fields, TextEncoding encoding)
+{
+    const int row = block.rows;
+    if (fields.size() > block.values.size()) {
+        const int oldColumns = block.values.size();
+        block.values.resize(fields.size());
+        block.decimals.resize(fields.size());
+        block.texts.resize(fields.size());
+        for (int c = oldColumns; c < fields.size(); ++c) {
+            block.values[c].fill(kEmpty, row);
+            block.decimals[c].fill(qint8(-1), row);
+        }
+    }
+
+    for (int c = 0; c < block.values.size(); ++c) {
+        double v = kEmpty;
+        qint8 d = -1;
+        if (c < fields.size()) {
+            const char* b = fields[c].begin;
+            const char* e = fields[c].end;
+            bool quoted = false;
+            trimField(b, e, quoted);
+            if (b != e && !TextTableReader::parseNumber(b, e, v, d)) {
+                v = kEmpty;
+                d = -1;
+                block.texts[c].append(qMakePair(row, fieldText(b, e, quoted, encoding)));
+            }
+        }
+        block.values[c].append(v);
+        block.decimals[c].append(d);
+    }
+    ++block.rows;
+}
+
+void countChunk(const char* data, Chunk& chunk)
+{
+    int parity = 0;
+    for (qint64 i = chunk.begin; i < chunk.end; ++i) {
+        const char c = data[i];
+        if (c == '"') {
+            parity ^= 1;
+            ++chunk.quotes;
+        } else if (c == '\n') {
+            ++chunk.newlines[parity];
+        }
+    }
+}
+
+void parseChunk(const char* data, qint64 size, char separator, bool quoteAware,
+                const DataImportSettings& settings, TextEncoding encoding,
+                const CancellationToken* token, Chunk& chunk)
+{
+    qint64 pos = chunk.begin;
+    qint64 record = chunk.firstRecord;
+
+    if (chunk.startsInQuote) {
+        // 段首处在上一段起始的记录中：跳到该记录末尾
+        bool inQuote = true;
+        bool found = false;
+        while (pos < chunk.end) {
+            const char c = data[pos++];
+            if (c == '"') inQuote = !inQuote;
+            else if (c == '\n' && !inQuote) { found = true; break; }
+        }
+        if (!found) return;
+        ++record;
+    }
+
+    QVector<Field> fields;
+    while (pos < chunk.end) {
+        if (token && (record - chunk.firstRecord) % kCancelCheckRecords == 0 && token->isCancelled()) return;
+
+        const qint64 lineIdx = record + 1; // 行号从 1 开始
+        const bool isHeader = (settings.useHeader && lineIdx == settings.headerRow);
+        const bool isData = (lineIdx >= settings.startRow);
+        ++record;
+
+        if (!isHeader && !isData) {
+            pos = scanRecord(data, pos, size, separator, quoteAware, nullptr);
+            continue;
+        }
+
+        fields.clear();
+        pos = scanRecord(data, pos, size, separator, quoteAware, &fields);
+        if (isHeader) {
+            chunk.header.clear();
+            for (const Field& f : fields) {
+                const char* b = f.begin;
+                const char* e = f.end;
+                bool quoted = false;
+                trimField(b, e, quoted);
+                chunk.header.append(fieldText(b, e, quoted, encoding));
+            }
+        } else {
+            appendRecord(chunk.block, fields, encoding);
+        }
+    }
+}
+
+char resolveSeparator(const QString& setting, const char* data, qint64 size)
+{
+    if (setting.contains("Tab")) return '\t';
+    if (setting.contains("Space")) return ' ';
+    if (setting.contains("Semicolon")) return ';';
+    if (setting.contains("Comma")) return ',';
+    if (setting.contains("Auto")) {
+        // 自动识别：首行制表符多于逗号时取制表符
+        const void* nl = std::memchr(data, '\n', size_t(size));
+        const char* lineEnd = nl ? static_cast<const char*>(nl) : data + size;
+        const qint64 tabs = std::count(data, lineEnd, '\t');
+        const qint64 commas = std::count(data, lineEnd, ',');
+        if (tabs > commas) return '\t';
+    }
+    return ',';
+}
+
+// 解析内存中的文本 (read 与 parse 共用)
+void parseBuffer(const char* data, qint64 size, const DataImportSettings& settings,
+                 const TextTableReader::BlockSink& sink, const CancellationToken* token)
+{
+    // 1. 编码 (与原逐行读取的对应关系相同) 与 BOM
+    QByteArray buffer;
+    TextEncoding encoding = TextEncoding::Utf8;
+    if (settings.encoding.startsWith("GBK")) encoding = TextEncoding::System; // 兼容中文系统编码
+    else if (settings.encoding.startsWith("ISO")) encoding = TextEncoding::Latin1;
+
+    if (size >= 2 && ((uchar(data[0]) == 0xFF && uchar(data[1]) == 0xFE) ||
+                      (uchar(data[0]) == 0xFE && uchar(data[1]) == 0xFF))) {
+        QStringDecoder toUtf16(QStringDecoder::Utf16);
+        const QString text = toUtf16(QByteArrayView(data, size));
+        buffer = text.toUtf8();
+        data = buffer.constData();
+        size = buffer.size();
+        encoding = TextEncoding::Utf8;
+    } else if (size >= 3 && uchar(data[0]) == 0xEF && uchar(data[1]) == 0xBB && uchar(data[2]) == 0xBF) {
+        data += 3;
+        size -= 3;
+    }
+    if (size <= 0) return;
+
+    const char separator = resolveSeparator(settings.separator, data, size);
+
+    // 2. 按换行切段
+    const int chunkCount = int(qBound<qint64>(1, size / kMinChunkBytes, kMaxChunks));
+    QVector<Chunk> chunks;
+    chunks.reserve(chunkCount);
+    qint64 begin = 0;
+    for (int k = 1; k <= chunkCount && begin < size; ++k) {
+        qint64 end = (k == chunkCount) ? size : size * k / chunkCount;
+        if (end < size) {
+            const void* nl = std::memchr(data + end, '\n', size_t(size - end));
+            end = nl ? (static_cast<const char*>(nl) - data) + 1 : size;
+        }
+        if (end <= begin) continue;
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = end;
+        chunks.append(chunk);
+        begin = end;
+    }
+
+    // 3. 第一遍：各段引号与换行计数，顺序求出段首状态与记录号
+    Chunk* chunkData = chunks.data();
+    TaskScheduler::parallelFor(chunks.size(), [data, chunkData](int k) { countChunk(data, chunkData[k]); });
+    if (token && token->isCancelled()) return;
+
+    qint64 quotes = 0;
+    for (const Chunk& c : chunks) quotes += c.quotes;
+    const bool quoteAware = (quotes % 2 == 0); // 引号不成对时按原规则逐行处理
+
+    qint64 records = 0;
+    bool inQuote = false;
+    for (Chunk& c : chunks) {
+        c.startsInQuote = quoteAware && inQuote;
+        c.firstRecord = records;
+        records += quoteAware ? c.newlines[inQuote ? 1 : 0] : c.newlines[0] + c.newlines[1];
+        if (c.quotes % 2) inQuote = !inQuote;
+    }
+
+    // 4. 第二遍：每批 (线程数个段) 并行解析，批内按顺序交付后释放，前面的行可先显示
+    auto parse = [&](Chunk& chunk) { parseChunk(data, size, separator, quoteAware, settings, encoding, token, chunk); };
+    const int wave = TaskScheduler::instance().workerCount() + 1;
+    for (int first = 0; first < chunks.size(); first += wave) {
+        if (token && token->isCancelled()) break;
+        QVector<Chunk> batch = chunks.mid(first, wave);
+        Chunk* batchData = batch.data();
+        TaskScheduler::parallelFor(batch.size(), [&](int k) { parse(batchData[k]); });
+        if (token && token->isCancelled()) break;
+
+        for (const Chunk& c : batch) sink(c.block, c.header, c.end, size);
+    }
+}
+
+} // namespace
+
+bool TextTableReader::parseNumber(const char* begin, const char* end, double& value, qint8& decimals)
+{
+    // std::from_chars 不接受前导 '+'
+    const char* p = begin;
+    if (p != end && *p == '+') {
+        ++p;
+        if (p != end && *p == '-') return false;
+    }
+    if (p == end) return false;
+
+    const std::from_chars_result r = std::from_chars(p, end, value);
+    if (r.ec != std::errc() || r.ptr != end || !std::isfinite(value)) return false;
+
+    qint64 dot = -1;
+    for (const char* c = begin; c != end; ++c) {
+        if (*c == 'e' || *c == 'E') { decimals = -1; return true; }
+        if (*c == '.') dot = c - begin;
+    }
+    const qint64 count = (dot < 0) ? 0 : (end - begin) - dot - 1;
+    decimals = qint8(count <= kMaxDecimals ? count : -1);
+    return true;
+}
+
+bool TextTableReader::read(const QString& path, const DataImportSettings& settings,
+                           ColumnarTableModel* model, QStringList* headerLabels)
+{
+    if (headerLabels) headerLabels->clear();
+    if (!model) return false;
+
+    return read(path, settings, [model, headerLabels](const ColumnarTableModel::RowBlock& block, const QStringList& header,
+                                                      qint64, qint64) {
+        if (!header.isEmpty()) {
+            model->setHorizontalHeaderLabels(header);
+            if (headerLabels) *headerLabels = header;
+        }
+        model->appendBlock(block);
+    });
+}
+
+bool TextTableReader::read(const QString& path, const DataImportSettings& settings,
+                           const BlockSink& sink, const CancellationToken* token)
+{
+    WT_TRACE_SCOPE("Import::readText");
+    WT_MEMORY_SCOPE(MemoryAccounting::DataModel);
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+
+    // 映射文件 (失败时整体读入)
+    QByteArray buffer;
+    const char* data = nullptr;
+    qint64 size = f.size();
+    if (size > 0) {
+        if (uchar* mapped = f.map(0, size)) {
+            data = reinterpret_cast<const char*>(mapped);
+        } else {
+            buffer = f.readAll();
+            data = buffer.constData();
+            size = buffer.size();
+        }
+    }
+    parseBuffer(data, size, settings, sink, token);
+
+    f.close();
+    return true;
+}
+
+void TextTableReader::parse(const QByteArray& data, const DataImportSettings& settings,
+                            const BlockSink& sink, const CancellationToken* token)
+{
+    WT_TRACE_SCOPE("Import::parseText");
+    parseBuffer(data.constData(), data.size(), settings, sink, token);
+}
+
+bool TextTableReader::readHead(const QString& path, qint64 maxBytes, QByteArray& sample, bool* complete)
+{
+    WT_TRACE_SCOPE("Import::sampleText");
+    sample.clear();
+    if (complete) *complete = false;
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = f.size();
+    const qint64 length = qMin(size, maxBytes);
+    if (length > 0) {
+        if (uchar* mapped = f.map(0, length)) {
+            sample = QByteArray(reinterpret_cast<const char*>(mapped), length);
+            f.unmap(mapped);
+        } else {
+            sample = f.read(length);
+        }
+    }
+    if (complete) *complete = (sample.size() >= size);
+    if (sample.size() >= size) return true;
+
+    // 截到最后一个完整行 (UTF-16 文件截在偶数字节处，换行的另一字节一并保留)
+    const qsizetype nl = sample.lastIndexOf('\n');
+    if (nl < 0) return true;
+    qsizetype end = nl + 1;
+    const bool utf16 = sample.size() >= 2 && ((uchar(sample[0]) == 0xFF && uchar(sample[1]) == 0xFE) ||
+                                              (uchar(sample[0]) == 0xFE && uchar(sample[1]) == 0xFF));
+    if (utf16 && (end % 2)) ++end;
+    sample.truncate(qMin(end, sample.size()));
+    return true;
+}
+
+QString TextTableReader::detectEncoding(const QByteArray& sample)
+{
+    if (sample.startsWith("\xEF\xBB\xBF") || sample.startsWith("\xFF\xFE") || sample.startsWith("\xFE\xFF")) return "UTF-8";
+    QStringDecoder utf8(QStringDecoder::Utf8);
+    const QString text = utf8(sample);
+    return utf8.hasError() ? "GBK/GB2312" : "UTF-8";
+}
+
+char TextTableReader::detectSeparator(const QByteArray& sample)
+{
+    static const char candidates[] = {'\t', ',', ';', ' '};
+    const int kMaxLines = 200;
+
+    // 每行 (引号外) 各候选字符的个数
+    QVector<QVector<int>> counts(4);
+    const char* p = sample.constData();
+    const char* end = p + sample.size();
+    for (int line = 0; p < end && line < kMaxLines; ++line) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        const char* lineEnd = nl ? nl : end;
+        const char* b = p;
+        const char* e = lineEnd;
+        while (b < e && isBlank(*b) && *b != '\t') ++b;
+        while (e > b && isBlank(e[-1]) && e[-1] != '\t') --e;
+        if (b < e) {
+            int n[4] = {0, 0, 0, 0};
+            bool inQuote = false;
+            char prev = 0;
+            for (const char* c = b; c < e; prev = *c, ++c) {
+                if (*c == '"') { inQuote = !inQuote; continue; }
+                if (inQuote) continue;
+                for (int k = 0; k < 4; ++k) {
+                    // 连续空格只算一次
+                    if (*c == candidates[k] && !(k == 3 && prev == ' ')) ++n[k];
+                }
+            }
+            for (int k = 0; k < 4; ++k) counts[k].append(n[k]);
+        }
+        p = nl ? nl + 1 : end;
+    }
+
+    // 候选字符的得分：出现次数相同 (且大于 0) 的最多行数
+    char best = 0;
+    int bestLines = 0;
+    for (int k = 0; k < 4; ++k) {
+        if (k == 3 && best) break; // 空格只在其余分隔符都不出现时考虑
+        QHash<int, int> lines;
+        for (int n : counts[k]) if (n > 0) ++lines[n];
+        for (auto it = lines.cbegin(); it != lines.cend(); ++it) {
+            if (it.value() > bestLines) {
+                bestLines = it.value();
+                best = candidates[k];
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,85 @@
+/*
+ * texttablereader.h
+ * 文件作用: 文本数据文件 (.csv / .txt) 快速导入头文件
+ * 功能描述:
+ * 1. 将文件映射到内存 (映射失败时整体读入)，按字节扫描，不再逐行经 QTextStream 解码、QString::split 分割。
+ * 2. 文件按行边界切分为若干段并行处理：第一遍统计各段的引号数与换行数，由前缀和得到每段开头是否处在引号内
+ *    及其第一条记录的行号；第二遍各段独立解析自己起始的记录，结果按顺序整块追加到 ColumnarTableModel。
+ * 3. 引号内的分隔符与换行不作为字段、记录边界，"" 表示字面引号；文件中引号总数为奇数 (引号不成对) 时
+ *    按原规则处理：每个换行都是记录边界，只去除字段首尾的引号。
+ * 4. 数值字段在字节上以与区域设置无关的 std::from_chars 解析，接受的格式与小数位记录规则与 QString::toDouble 相同；
+ *    其余字段按所选编码解码为文本。分隔符、引号与换行均为 ASCII，在 UTF-8、GBK 与 Latin-1 中都不会出现在多字节字符内部。
+ * 5. DataImportSettings 的编码、分隔符 (含自动识别)、起始行与表头行的含义与原逐行读取相同，
+ *    行号按记录计 (引号内换行不另计行)。
+ * 6. [后台加载] 另一重载把结果按批交给回调，可在后台线程中运行并随时取消。
+ * 7. [有界预览] readHead 只读取文件开头的完整行，parse 以与 read 相同的规则解析内存中的样本；
+ *    detectEncoding / detectSeparator 从样本识别编码与分隔符 (导入对话框在后台线程调用)。
+ */
+
+#ifndef TEXTTABLEREADER_H
+#define TEXTTABLEREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include "columnartablemodel.h"
+
+struct DataImportSettings;
+class CancellationToken;
+
+class TextTableReader
+{
+public:
+    // 逐批接收读取结果 (在读取线程中按文件顺序调用)：一段数据行、该段内的表头行 (没有时为空)、
+    // 已读取量与总量 (用于进度显示，文本文件为字节数)
+    using BlockSink = std::function<void(const ColumnarTableModel::RowBlock& block, const QStringList& header,
+                                         qint64 done, qint64 total)>;
+
+    /**
+     * @brief 读取文本数据文件并追加到数据模型 (调用方负责 beginLoad / endLoad)
+     * @param path 文件路径
+     * @param settings 导入配置 (编码、分隔符、起始行、表头行)
+     * @param model 目标数据模型
+     * @param headerLabels 输出：表头行的字段 (未读到表头行时为空)
+     * @return 文件能否打开
+     */
+    static bool read(const QString& path, const DataImportSettings& settings,
+                     ColumnarTableModel* model, QStringList* headerLabels = nullptr);
+
+    /**
+     * @brief 读取文本数据文件，按批交给 sink (可在后台线程调用)
+     * @param token 取消令牌 (可为空)；取消后不再交付，已交付的部分保持有效
+     * @return 文件能否打开
+     */
+    static bool read(const QString& path, const DataImportSettings& settings,
+                     const BlockSink& sink, const CancellationToken* token = nullptr);
+
+    /**
+     * @brief 按与 read 相同的规则解析内存中的文本 (如 readHead 取得的样本)，按批交给 sink
+     */
+    static void parse(const QByteArray& data, const DataImportSettings& settings,
+                      const BlockSink& sink, const CancellationToken* token = nullptr);
+
+    /**
+     * @brief 读取文件开头至多 maxBytes 字节，未读完时截到最后一个完整行
+     * @param complete 输出：样本是否为整个文件
+     * @return 文件能否打开
+     */
+    static bool readHead(const QString& path, qint64 maxBytes, QByteArray& sample, bool* complete = nullptr);
+
+    // 从样本识别编码，返回导入配置使用的名称 ("UTF-8" 或 "GBK/GB2312")
+    static QString detectEncoding(const QByteArray& sample);
+
+    // 从样本识别分隔符 ('\t'、','、';' 或 ' ')，无法判断 (如只有一列) 时返回 0
+    static char detectSeparator(const QByteArray& sample);
+
+    /**
+     * @brief 按 QString::toDouble 的规则解析 ASCII 数值 (与区域设置无关，首尾不得有空白)
+     * @param decimals 输出：原文的小数位 (带指数或超过 17 位时为 -1)
+     * @return 是否为有限数值
+     */
+    static bool parseNumber(const char* begin, const char* end, double& value, qint8& decimals);
+};
+
+#endif // TEXTTABLEREADER_H
@@ -0,0 +1,89 @@
+/*
+ * 文件名: theorycurvecache.cpp
+ * 文件作用: 理论曲线的内容寻址缓存实现文件
+ * 功能描述:
+ * 1. 当前代写满 (上限的一半) 时整体降为旧代，旧代中的条目被命中时提升回当前代。
+ * 2. 上限调小后当前代已超过新上限的一半时，当前代降为旧代 (原旧代丢弃)。
+ */
+
+#include "theorycurvecache.h"
+#include "fitevaluationcache.h"
+#include <QSettings>
+
+TheoryCurveCache::TheoryCurveCache()
+    : m_capacity(capacityFromSettings())
+{
+}
+
+int TheoryCurveCache::capacityFromSettings()
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    return qMax(16, settings.value("fitting/theoryCurveCacheEntries", 256).toInt());
+}
+
+void TheoryCurveCache::setCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_capacity = qMax(16, capacity);
+    if (m_current.size() >= m_capacity / 2) {
+        m_previous.swap(m_current);
+        m_current.clear();
+    } else if (m_current.size() + m_previous.size() > m_capacity) {
+        m_previous.clear();
+    }
+}
+
+int TheoryCurveCache::capacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_capacity;
+}
+
+QByteArray TheoryCurveCache::makeKey(ModelManager::ModelType type, const SolverSettings& settings,
+                                     const QMap<QString, double>& params, const QVector<double>& t)
+{
+    return FitEvaluationCache::makeKey(int(type), settings, params, t, 0);
+}
+
+bool TheoryCurveCache::lookup(const QByteArray& key, ModelCurveData& curve)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_current.constFind(key);
+    if (it != m_current.constEnd()) {
+        curve = it.value();
+        return true;
+    }
+    it = m_previous.constFind(key);
+    if (it == m_previous.constEnd()) return false;
+    curve = it.value();
+    m_previous.erase(it);
+    if (m_current.size() >= m_capacity / 2) {
+        m_previous.swap(m_current);
+        m_current.clear();
+    }
+    m_current.insert(key, curve);
+    return true;
+}
+
+void TheoryCurveCache::insert(const QByteArray& key, const ModelCurveData& curve)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_current.size() >= m_capacity / 2) {
+        m_previous.swap(m_current);
+        m_current.clear();
+    }
+    m_current.insert(key, curve);
+}
+
+int TheoryCurveCache::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_current.size() + m_previous.size();
+}
+
+void TheoryCurveCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_current.clear();
+    m_previous.clear();
+}
@@ -0,0 +1,55 @@
+/*
+ * 文件名: theorycurvecache.h
+ * 文件作用: 理论曲线的内容寻址缓存头文件
+ * 功能描述:
+ * 1. 以 (模型类型, 求解器设置, 参数字典, 时间网格) 为键缓存定产量理论曲线 (键的构成与 FitEvaluationCache::makeKey 相同)，
+ *    参数与网格不变的分析再次显示时直接取出，不再调用求解器。
+ * 2. 由拟合页面 (FittingPage) 持有并交给各多分析对比页签共用，页签重建或重新加载项目状态后仍可命中。
+ * 3. 线程安全；内存中采用双代淘汰 (与 LaplaceEvaluationCache 相同)，条目数上限由设置项 fitting/theoryCurveCacheEntries 决定，
+ *    性能设置变更时经 setCapacity 立即生效。
+ */
+
+#ifndef THEORYCURVECACHE_H
+#define THEORYCURVECACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include "modelmanager.h"
+#include "solverpool.h"
+
+class TheoryCurveCache
+{
+public:
+    TheoryCurveCache();
+
+    static QByteArray makeKey(ModelManager::ModelType type, const SolverSettings& settings,
+                              const QMap<QString, double>& params, const QVector<double>& t);
+
+    // 查询与写入 (线程安全)
+    bool lookup(const QByteArray& key, ModelCurveData& curve);
+    void insert(const QByteArray& key, const ModelCurveData& curve);
+
+    int size() const;
+    void clear();
+
+    // 条目数上限 (不小于 16)；调小时丢弃旧代
+    void setCapacity(int capacity);
+    int capacity() const;
+    // 设置项 fitting/theoryCurveCacheEntries (默认 256)
+    static int capacityFromSettings();
+
+private:
+    TheoryCurveCache(const TheoryCurveCache&) = delete;
+    TheoryCurveCache& operator=(const TheoryCurveCache&) = delete;
+
+    mutable QMutex m_mutex;
+    QHash<QByteArray, ModelCurveData> m_current;  // 当前代
+    QHash<QByteArray, ModelCurveData> m_previous; // 旧代 (命中时提升回当前代)
+    int m_capacity; // 两代合计的条目数上限
+};
+
+#endif // THEORYCURVECACHE_H
@@ -0,0 +1,151 @@
+/*
+ * timestampparser.cpp
+ * 文件作用: 日期/时刻文本的快速解析器实现文件
+ * 功能描述:
+ * 1. detect 对每种候选格式 (日期分隔符 × 日期时刻分隔符) 试解析全部样本，保留成功数最多的一种。
+ * 2. parse 直接在 QString 的字符数组上读数字与分隔符，不分配内存；日期换算为天数使用公历的直接公式。
+ */
+
+#include "timestampparser.h"
+
+static bool readDigits(const QChar*& p, const QChar* end, int minDigits, int maxDigits, int* value)
+{
+    int v = 0;
+    int n = 0;
+    while (p < end && n < maxDigits) {
+        const ushort c = p->unicode();
+        if (c < '0' || c > '9') break;
+        v = v * 10 + (c - '0');
+        ++p;
+        ++n;
+    }
+    if (n < minDigits) return false;
+    *value = v;
+    return true;
+}
+
+static bool isLeapYear(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int daysInMonth(int year, int month)
+{
+    static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (month == 2 && isLeapYear(year)) ? 29 : days[month - 1];
+}
+
+qint64 TimestampParser::daysFromCivil(int year, int month, int day)
+{
+    // 以 3 月为年首，闰日落在年末
+    year -= month <= 2 ? 1 : 0;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const qint64 yoe = year - era * 400;
+    const qint64 doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const qint64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+TimestampParser TimestampParser::detect(const QStringList& samples, Kind kind)
+{
+    const QChar dateSeparators[] = {QLatin1Char('-'), QLatin1Char('/'), QLatin1Char('.')};
+    const QChar dateTimeSeparators[] = {QLatin1Char(' '), QLatin1Char('T')};
+
+    TimestampParser best;
+    int bestCount = 0;
+    const int dateCandidates = kind == Time ? 1 : 3;
+    const int dateTimeCandidates = kind == DateTime ? 2 : 1;
+    for (int i = 0; i < dateCandidates; ++i) {
+        for (int j = 0; j < dateTimeCandidates; ++j) {
+            TimestampParser candidate(kind, dateSeparators[i], dateTimeSeparators[j]);
+            int count = 0;
+            double seconds = 0.0;
+            for (const QString& s : samples) {
+                if (candidate.parse(s, &seconds)) ++count;
+            }
+            if (count > bestCount) {
+                best = candidate;
+                bestCount = count;
+            }
+        }
+    }
+    return best;
+}
+
+bool TimestampParser::parseDate(const QChar*& p, const QChar* end, qint64* days) const
+{
+    int year = 0, month = 0, day = 0;
+    if (!readDigits(p, end, 4, 4, &year)) return false;
+    if (p >= end || *p != m_dateSeparator) return false;
+    ++p;
+    if (!readDigits(p, end, 1, 2, &month)) return false;
+    if (p >= end || *p != m_dateSeparator) return false;
+    ++p;
+    if (!readDigits(p, end, 1, 2, &day)) return false;
+
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) return false;
+    *days = daysFromCivil(year, month, day);
+    return true;
+}
+
+bool TimestampParser::parseTime(const QChar*& p, const QChar* end, double* seconds)
+{
+    int hour = 0, minute = 0, second = 0;
+    if (!readDigits(p, end, 1, 2, &hour)) return false;
+    if (p >= end || *p != QLatin1Char(':')) return false;
+    ++p;
+    if (!readDigits(p, end, 2, 2, &minute)) return false;
+
+    double fraction = 0.0;
+    if (p < end && *p == QLatin1Char(':')) {
+        ++p;
+        if (!readDigits(p, end, 2, 2, &second)) return false;
+        if (p < end && *p == QLatin1Char('.')) {
+            ++p;
+            double scale = 0.1;
+            const QChar* start = p;
+            while (p < end && p->unicode() >= '0' && p->unicode() <= '9') {
+                fraction += (p->unicode() - '0') * scale;
+                scale *= 0.1;
+                ++p;
+            }
+            if (p == start) return false;
+        }
+    }
+
+    if (hour > 23 || minute > 59 || second > 59) return false;
+    *seconds = hour * 3600.0 + minute * 60.0 + second + fraction;
+    return true;
+}
+
+bool TimestampParser::parse(const QString& text, double* seconds) const
+{
+    if (!m_valid) return false;
+
+    const QChar* p = text.constData();
+    const QChar* end = p + text.size();
+    while (p < end && p->isSpace()) ++p;
+    while (end > p && (end - 1)->isSpace()) --end;
+    if (p == end) return false;
+
+    qint64 days = 0;
+    double timeOfDay = 0.0;
+    switch (m_kind) {
+    case Date:
+        if (!parseDate(p, end, &days)) return false;
+        break;
+    case Time:
+        if (!parseTime(p, end, &timeOfDay)) return false;
+        break;
+    case DateTime:
+        if (!parseDate(p, end, &days)) return false;
+        if (p >= end || *p != m_dateTimeSeparator) return false;
+        while (p < end && *p == m_dateTimeSeparator) ++p;
+        if (!parseTime(p, end, &timeOfDay)) return false;
+        break;
+    }
+    if (p != end) return false;
+
+    *seconds = double(days) * 86400.0 + timeOfDay;
+    return true;
+}
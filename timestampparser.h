@@ -0,0 +1,54 @@
+/*
+ * timestampparser.h
+ * 文件作用: 日期/时刻文本的快速解析器头文件
+ * 功能描述:
+ * 1. detect 从一列的样本文本中识别一次格式 (日期分隔符 '-'、'/' 或 '.'，日期与时刻之间为空格或 'T'，
+ *    时刻是否带秒与小数秒)，之后的每个单元格按该格式逐字符解析，不再对每格逐个尝试 QDate/QTime::fromString。
+ * 2. 支持的格式: 日期 yyyy-M-d (月、日可为一或两位)，时刻 h:mm[:ss[.f...]]，以及二者以空格或 'T' 相连的日期时刻。
+ * 3. 解析结果为秒数：日期与日期时刻为自 1970-01-01 00:00:00 起的秒数 (按日历直接计算，不受本地时区与夏令时影响)，
+ *    时刻为当天零点起的秒数。parse 只读成员，可在多个线程中同时调用。
+ */
+
+#ifndef TIMESTAMPPARSER_H
+#define TIMESTAMPPARSER_H
+
+#include <QString>
+#include <QStringList>
+
+class TimestampParser
+{
+public:
+    enum Kind {
+        Date = 0,    // 仅日期
+        Time = 1,    // 仅时刻
+        DateTime = 2 // 日期 + 时刻
+    };
+
+    TimestampParser() = default;
+
+    // 由样本识别格式，取能解析最多样本的格式；没有样本能解析时 isValid 为 false
+    static TimestampParser detect(const QStringList& samples, Kind kind);
+
+    bool isValid() const { return m_valid; }
+    Kind kind() const { return m_kind; }
+
+    // 按识别出的格式解析 (首尾空白忽略)；格式不符或日期时刻不合法时返回 false
+    bool parse(const QString& text, double* seconds) const;
+
+    // 1970-01-01 至 year-month-day 的天数 (公历)
+    static qint64 daysFromCivil(int year, int month, int day);
+
+private:
+    TimestampParser(Kind kind, QChar dateSeparator, QChar dateTimeSeparator)
+        : m_valid(true), m_kind(kind), m_dateSeparator(dateSeparator), m_dateTimeSeparator(dateTimeSeparator) {}
+
+    bool parseDate(const QChar*& p, const QChar* end, qint64* days) const;
+    static bool parseTime(const QChar*& p, const QChar* end, double* seconds);
+
+    bool m_valid = false;
+    Kind m_kind = Date;
+    QChar m_dateSeparator = QLatin1Char('-');
+    QChar m_dateTimeSeparator = QLatin1Char(' ');
+};
+
+#endif // TIMESTAMPPARSER_H
@@ -0,0 +1,215 @@
+/*
+ * 文件名: tracing.cpp
+ * 文件作用: 热点路径跟踪实现文件
+ * 功能描述:
+ * 1. 线程缓冲区由线程局部的共享指针持有并登记在全局表中 (只有首次登记加锁)；
+ *    写入序号以 release 发布，导出时以 acquire 读取，只读出已完整写入的事件。
+ * 2. 线程名取 QThread::objectName，为空时主线程记为 "主线程"，其余按登记顺序编号。
+ * 3. 导出格式: {"traceEvents": [...], "displayTimeUnit": "ms"}，另附 thread_name 元数据事件。
+ */
+
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSettings>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <vector>
+
+std::atomic<bool> Trace::s_enabled(false);
+
+namespace {
+
+struct TraceEvent {
+    const char* name = nullptr;
+    qint64 start = 0;     // ns
+    qint64 duration = 0;  // ns (计数事件为 0)
+    double value = 0.0;   // 计数值
+    bool counter = false;
+};
+
+struct ThreadBuffer {
+    int tid = 0;
+    QString name;
+    QVector<TraceEvent> events;
+    std::atomic<quint64> written{0};
+
+    void push(const TraceEvent& e)
+    {
+        quint64 index = written.load(std::memory_order_relaxed);
+        events[(int)(index % (quint64)events.size())] = e;
+        written.store(index + 1, std::memory_order_release);
+    }
+};
+
+struct Registry {
+    QMutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    int nextTid = 1;
+};
+
+Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+
+const std::chrono::steady_clock::time_point& origin()
+{
+    static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    return t0;
+}
+
+ThreadBuffer& threadBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(Trace::ThreadCapacity);
+        QThread* thread = QThread::currentThread();
+        Registry& r = registry();
+        QMutexLocker locker(&r.mutex);
+        buffer->tid = r.nextTid++;
+        buffer->name = thread ? thread->objectName() : QString();
+        if (buffer->name.isEmpty()) {
+            const bool isMain = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+            buffer->name = isMain ? QString("主线程") : QString("线程 %1").arg(buffer->tid);
+        }
+        r.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+QByteArray jsonString(const QString& text)
+{
+    QByteArray out = "\"";
+    for (QChar c : text) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c.toLatin1(); }
+        else if (c.unicode() < 0x20) out += QByteArray("\\u") + QByteArray::number(c.unicode(), 16).rightJustified(4, '0');
+        else out += QString(c).toUtf8();
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace
+
+qint64 Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin()).count();
+}
+
+void Trace::setEnabled(bool enabled)
+{
+    origin(); // 开启前确定时间起点
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::applyGlobalSettings()
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    setEnabled(settings.value("diagnostics/traceEnabled", false).toBool());
+}
+
+void Trace::recordSpan(const char* name, qint64 startNs, qint64 endNs)
+{
+    TraceEvent e;
+    e.name = name;
+    e.start = startNs;
+    e.duration = endNs - startNs;
+    threadBuffer().push(e);
+}
+
+void Trace::recordCounter(const char* name, double value)
+{
+    TraceEvent e;
+    e.name = name;
+    e.start = now();
+    e.value = value;
+    e.counter = true;
+    threadBuffer().push(e);
+}
+
+void Trace::clear()
+{
+    Registry& r = registry();
+    QMutexLocker locker(&r.mutex);
+    for (const auto& buffer : r.buffers) buffer->written.store(0, std::memory_order_release);
+}
+
+int Trace::eventCount()
+{
+    Registry& r = registry();
+    QMutexLocker locker(&r.mutex);
+    quint64 total = 0;
+    for (const auto& buffer : r.buffers)
+        total += std::min<quint64>(buffer->written.load(std::memory_order_acquire), (quint64)buffer->events.size());
+    return (int)std::min<quint64>(total, (quint64)INT_MAX);
+}
+
+bool Trace::exportChromeTrace(const QString& filePath, QString* errorMessage)
+{
+    // 导出期间暂停记录，避免读到正在覆盖的事件
+    const bool wasEnabled = isEnabled();
+    s_enabled.store(false, std::memory_order_relaxed);
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        Registry& r = registry();
+        QMutexLocker locker(&r.mutex);
+        buffers = r.buffers;
+    }
+
+    QByteArray out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto append = [&](const QByteArray& line) {
+        if (!first) out += ",\n";
+        out += line;
+        first = false;
+    };
+
+    for (const auto& buffer : buffers) {
+        append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + QByteArray::number(buffer->tid)
+               + ",\"args\":{\"name\":" + jsonString(buffer->name) + "}}");
+
+        const quint64 written = buffer->written.load(std::memory_order_acquire);
+        const quint64 capacity = (quint64)buffer->events.size();
+        const quint64 begin = written > capacity ? written - capacity : 0;
+        for (quint64 i = begin; i < written; ++i) {
+            const TraceEvent& e = buffer->events[(int)(i % capacity)];
+            if (!e.name) continue;
+            const QByteArray ts = QByteArray::number(e.start / 1000.0, 'f', 3);
+            const QByteArray name = jsonString(QString::fromUtf8(e.name));
+            if (e.counter) {
+                append("{\"name\":" + name + ",\"ph\":\"C\",\"pid\":1,\"tid\":" + QByteArray::number(buffer->tid)
+                       + ",\"ts\":" + ts + ",\"args\":{\"value\":" + QByteArray::number(e.value, 'g', 12) + "}}");
+            } else {
+                append("{\"name\":" + name + ",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number(buffer->tid)
+                       + ",\"ts\":" + ts + ",\"dur\":" + QByteArray::number(e.duration / 1000.0, 'f', 3) + "}");
+            }
+        }
+    }
+    out += "\n]}\n";
+
+    s_enabled.store(wasEnabled, std::memory_order_relaxed);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorMessage) *errorMessage = QString("无法写入文件: %1").arg(filePath);
+        return false;
+    }
+    file.write(out);
+    if (!file.commit()) {
+        if (errorMessage) *errorMessage = QString("写入失败: %1").arg(filePath);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+ * 文件名: tracing.h
+ * 文件作用: 热点路径跟踪 (轻量级性能埋点) 头文件
+ * 功能描述:
+ * 1. WT_TRACE_SCOPE(name) 记录所在作用域的起止时间 (Chrome trace 的 "X" 事件)，
+ *    WT_TRACE_COUNTER(name, value) 记录一个计数值 ("C" 事件)；name 须为字符串字面量 (只保存指针)。
+ * 2. 每个线程一个固定容量的环形缓冲区 (首次记录时创建并登记)，写入只在本线程进行、不加锁，
+ *    缓冲区写满后覆盖最早的事件；线程结束后缓冲区仍保留到下次清空。
+ * 3. 运行期开关 (设置项 diagnostics/traceEnabled，默认关闭)：关闭时每个埋点只有一次原子读取；
+ *    定义 WT_DISABLE_TRACING 编译时宏全部展开为空，不产生任何代码。
+ * 4. exportChromeTrace 导出为 Chrome trace / Perfetto 可直接打开的 JSON (时间单位微秒，每个线程一条轨道)，
+ *    导出期间暂停记录。
+ */
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+class Trace
+{
+public:
+    // 每个线程缓冲区的事件容量
+    static const int ThreadCapacity = 1 << 16;
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+    // 按设置项 diagnostics/traceEnabled 设置开关
+    static void applyGlobalSettings();
+
+    // 丢弃已记录的全部事件
+    static void clear();
+    // 当前保留的事件数 (各线程缓冲区之和)
+    static int eventCount();
+
+    // 写出 Chrome trace JSON (QSaveFile 原子写入)
+    static bool exportChromeTrace(const QString& filePath, QString* errorMessage = nullptr);
+
+    // 跟踪起点以来的纳秒数
+    static qint64 now();
+
+    static void recordSpan(const char* name, qint64 startNs, qint64 endNs);
+    static void recordCounter(const char* name, double value);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// 作用域跟踪：构造时取开关状态，关闭时析构不做任何事
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name)
+        : m_name(Trace::isEnabled() ? name : nullptr), m_start(m_name ? Trace::now() : 0) {}
+    ~TraceScope() { if (m_name) Trace::recordSpan(m_name, m_start, Trace::now()); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_start;
+};
+
+#ifdef WT_DISABLE_TRACING
+#define WT_TRACE_SCOPE(name) do {} while (0)
+#define WT_TRACE_COUNTER(name, value) do {} while (0)
+#else
+#define WT_TRACE_CONCAT_INNER(a, b) a##b
+#define WT_TRACE_CONCAT(a, b) WT_TRACE_CONCAT_INNER(a, b)
+#define WT_TRACE_SCOPE(name) TraceScope WT_TRACE_CONCAT(wtTraceScope_, __LINE__)(name)
+#define WT_TRACE_COUNTER(name, value) \
+    do { if (Trace::isEnabled()) Trace::recordCounter(name, (double)(value)); } while (0)
+#endif
+
+#endif // TRACING_H
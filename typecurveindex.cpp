@@ -0,0 +1,352 @@
+/*
+ * typecurveindex.cpp
+ * 文件作用: 类型曲线最近邻索引实现文件
+ * 功能描述:
+ * 1. 签名：窗口内 SamplePoints 个对数等距时间点，ln pD / ln pD' 线性插值后减去 ln pD 均值；
+ *    非正值按窗口最大压力的 1e-6 倍截断，噪声段不会产生无穷大距离。
+ * 2. 窗口滑动步长取采样间距与 0.2 个对数周期中的较小者，时间系数的分辨率与之相当，其余由 LM 迭代修正。
+ * 3. KD 树：按散布最大的维度取中位数划分，查询时先搜近侧子树，远侧子树按分割面距离剪枝。
+ * 4. 索引缓存：互斥锁保护的 (库, 跨度) → 索引列表。
+ */
+
+#include "typecurveindex.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const int kLeafSize = 8;
+
+// 截断比例：非正值或极小值按窗口最大压力的 1e-6 倍处理
+const double kLogFloorRatio = std::log(1e6);
+
+// 窗口滑动步长上限 (0.2 个对数周期)
+const double kMaxWindowStep = 0.2 * std::log(10.0);
+
+// 跨度取整单位 (0.25 个对数周期) 与最小跨度 (0.5 个对数周期)
+const double kSpanQuantum = 0.25 * std::log(10.0);
+const double kMinSpan = 0.5 * std::log(10.0);
+
+// 在单调递增的横坐标 xs 上线性插值 (超出范围时取端点值)
+double interpolateSorted(const QVector<double>& xs, const QVector<double>& ys, double x)
+{
+    if (x <= xs.first()) return ys.first();
+    if (x >= xs.last()) return ys.last();
+    int j = int(std::upper_bound(xs.constBegin(), xs.constEnd(), x) - xs.constBegin()) - 1;
+    double w = (x - xs[j]) / (xs[j + 1] - xs[j]);
+    return ys[j] + w * (ys[j + 1] - ys[j]);
+}
+
+// 由窗口内的 ln p / ln p' 采样值生成签名 (截断后减去 ln p 均值)，返回 ln p 均值
+double finishSignature(double* logP, double* logD, float* signature)
+{
+    const int n = TypeCurveIndex::SamplePoints;
+    double maxLog = logP[0];
+    for (int i = 1; i < n; ++i) maxLog = std::max(maxLog, logP[i]);
+    const double floorLog = maxLog - kLogFloorRatio;
+    double mean = 0.0;
+    for (int i = 0; i < n; ++i) {
+        logP[i] = std::max(logP[i], floorLog);
+        logD[i] = std::max(logD[i], floorLog);
+        mean += logP[i];
+    }
+    mean /= n;
+    for (int i = 0; i < n; ++i) {
+        signature[i] = float(logP[i] - mean);
+        signature[n + i] = float(logD[i] - mean);
+    }
+    return mean;
+}
+
+// 安全对数：非正值返回 -inf，由 finishSignature 截断
+inline double safeLog(double v)
+{
+    return (v > 0.0) ? std::log(v) : -std::numeric_limits<double>::infinity();
+}
+
+// 索引缓存
+struct IndexCache {
+    QMutex mutex;
+    struct Entry {
+        QSharedPointer<TypeCurveLibrary> library;
+        double logSpan;
+        QSharedPointer<TypeCurveIndex> index;
+    };
+    QVector<Entry> entries;
+};
+
+IndexCache& indexCache()
+{
+    static IndexCache s_cache;
+    return s_cache;
+}
+
+} // namespace
+
+double TypeCurveIndex::quantizeSpan(double logSpan)
+{
+    return std::floor(logSpan / kSpanQuantum + 1e-9) * kSpanQuantum;
+}
+
+bool TypeCurveIndex::observedLogRange(const QVector<double>& t, const QVector<double>& p, double& logMin, double& logMax)
+{
+    bool found = false;
+    const int n = std::min(t.size(), p.size());
+    for (int i = 0; i < n; ++i) {
+        if (!(t[i] > 0.0) || !(p[i] > 0.0)) continue;
+        double lt = std::log(t[i]);
+        if (!found) { logMin = logMax = lt; found = true; }
+        logMin = std::min(logMin, lt);
+        logMax = std::max(logMax, lt);
+    }
+    return found && logMax - logMin >= kMinSpan;
+}
+
+bool TypeCurveIndex::makeQuery(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                               double logStart, double logSpan, Query& query)
+{
+    // 有效点按时间排序 (压力要求为正，导数非正时按截断处理)
+    QVector<QPair<double, int>> order;
+    const int n = std::min(t.size(), p.size());
+    for (int i = 0; i < n; ++i) {
+        if (t[i] > 0.0 && p[i] > 0.0) order.append(qMakePair(std::log(t[i]), i));
+    }
+    if (order.size() < 4) return false;
+    std::sort(order.begin(), order.end());
+
+    QVector<double> xs, lp, ld;
+    for (const QPair<double, int>& o : order) {
+        if (!xs.isEmpty() && o.first <= xs.last()) continue; // 重复时间点只保留一个
+        xs.append(o.first);
+        lp.append(std::log(p[o.second]));
+        ld.append(o.second < d.size() ? safeLog(d[o.second]) : -std::numeric_limits<double>::infinity());
+    }
+    if (xs.size() < 4) return false;
+
+    double logP[SamplePoints], logD[SamplePoints];
+    const double step = logSpan / (SamplePoints - 1);
+    for (int i = 0; i < SamplePoints; ++i) {
+        double x = logStart + i * step;
+        logP[i] = interpolateSorted(xs, lp, x);
+        logD[i] = interpolateSorted(xs, ld, x);
+        if (std::isnan(logD[i])) logD[i] = -std::numeric_limits<double>::infinity();
+    }
+    query.logT0 = logStart;
+    query.meanLogP = finishSignature(logP, logD, query.signature);
+    return true;
+}
+
+QSharedPointer<TypeCurveIndex> TypeCurveIndex::build(const QSharedPointer<TypeCurveLibrary>& library, double logSpan)
+{
+    if (!library || logSpan < kMinSpan) return QSharedPointer<TypeCurveIndex>();
+    const QVector<double>& grid = library->logTimeGrid();
+    const double available = grid.last() - grid.first();
+    if (logSpan > available) return QSharedPointer<TypeCurveIndex>();
+
+    QSharedPointer<TypeCurveIndex> index(new TypeCurveIndex());
+    index->m_library = library;
+    index->m_logSpan = logSpan;
+
+    // --- 1. 每条曲线在各窗口位置上生成签名 ---
+    const double sampleStep = logSpan / (SamplePoints - 1);
+    const double windowStep = std::min(sampleStep, kMaxWindowStep);
+    const int windowCount = int(std::floor((available - logSpan) / windowStep + 1e-9)) + 1;
+    const int timeCount = grid.size();
+    const int curveCount = library->curveCount();
+
+    index->m_signatures.reserve((qint64)curveCount * windowCount * SignatureLength);
+    QVector<double> logPD(timeCount), logDeriv(timeCount);
+    float signature[SignatureLength];
+    for (int c = 0; c < curveCount; ++c) {
+        const double* pd = library->curvePD(c);
+        const double* deriv = library->curveDerivative(c);
+        for (int j = 0; j < timeCount; ++j) {
+            logPD[j] = safeLog(pd[j]);
+            logDeriv[j] = safeLog(deriv[j]);
+        }
+        for (int w = 0; w < windowCount; ++w) {
+            const double start = grid.first() + w * windowStep;
+            double logP[SamplePoints], logD[SamplePoints];
+            for (int i = 0; i < SamplePoints; ++i) {
+                double x = start + i * sampleStep;
+                logP[i] = interpolateSorted(grid, logPD, x);
+                logD[i] = interpolateSorted(grid, logDeriv, x);
+                if (std::isnan(logP[i])) logP[i] = -std::numeric_limits<double>::infinity();
+                if (std::isnan(logD[i])) logD[i] = -std::numeric_limits<double>::infinity();
+            }
+            // 整个窗口无正压力 (噪声段) 的条目不入索引
+            bool anyPositive = false;
+            for (int i = 0; i < SamplePoints; ++i) anyPositive |= std::isfinite(logP[i]);
+            if (!anyPositive) continue;
+
+            double mean = finishSignature(logP, logD, signature);
+            for (int i = 0; i < SignatureLength; ++i) index->m_signatures.append(signature[i]);
+            index->m_entryCurve.append(c);
+            index->m_entryLogTD0.append(start);
+            index->m_entryMeanLogPD.append(mean);
+        }
+    }
+    if (index->m_entryCurve.isEmpty()) return QSharedPointer<TypeCurveIndex>();
+
+    // --- 2. 构建 KD 树 ---
+    index->m_order.resize(index->m_entryCurve.size());
+    for (int i = 0; i < index->m_order.size(); ++i) index->m_order[i] = i;
+    index->buildNode(0, index->m_order.size());
+    return index;
+}
+
+int TypeCurveIndex::buildNode(int begin, int end)
+{
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    const int self = m_nodes.size();
+    m_nodes.append(node);
+    if (end - begin <= kLeafSize) return self;
+
+    // 选择散布最大的维度，按中位数划分
+    int bestDim = 0;
+    float bestSpread = -1.0f;
+    for (int dim = 0; dim < SignatureLength; ++dim) {
+        float lo = m_signatures[(qint64)m_order[begin] * SignatureLength + dim], hi = lo;
+        for (int i = begin + 1; i < end; ++i) {
+            float v = m_signatures[(qint64)m_order[i] * SignatureLength + dim];
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+        if (hi - lo > bestSpread) { bestSpread = hi - lo; bestDim = dim; }
+    }
+    if (bestSpread <= 0.0f) return self; // 全部签名相同，保留为叶节点
+
+    const int mid = begin + (end - begin) / 2;
+    const float* sig = m_signatures.constData();
+    std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end,
+                     [sig, bestDim](int a, int b) {
+                         return sig[(qint64)a * SignatureLength + bestDim] < sig[(qint64)b * SignatureLength + bestDim];
+                     });
+    const float split = sig[(qint64)m_order[mid] * SignatureLength + bestDim];
+    const int left = buildNode(begin, mid);
+    const int right = buildNode(mid, end);
+    m_nodes[self].dim = bestDim;
+    m_nodes[self].split = split;
+    m_nodes[self].left = left;
+    m_nodes[self].right = right;
+    return self;
+}
+
+void TypeCurveIndex::searchNode(int nodeIndex, const float* query, int k, QVector<QPair<float, int>>& heap) const
+{
+    const Node& node = m_nodes[nodeIndex];
+    if (node.dim < 0) {
+        // 叶节点：逐个计算距离，维护大小为 k 的最大堆
+        for (int i = node.begin; i < node.end; ++i) {
+            const int entry = m_order[i];
+            const float* sig = m_signatures.constData() + (qint64)entry * SignatureLength;
+            float dist = 0.0f;
+            for (int dim = 0; dim < SignatureLength; ++dim) {
+                float diff = sig[dim] - query[dim];
+                dist += diff * diff;
+            }
+            if (heap.size() < k) {
+                heap.append(qMakePair(dist, entry));
+                std::push_heap(heap.begin(), heap.end());
+            } else if (dist < heap.first().first) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.last() = qMakePair(dist, entry);
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+
+    const float diff = query[node.dim] - node.split;
+    const int nearChild = (diff < 0.0f) ? node.left : node.right;
+    const int farChild = (diff < 0.0f) ? node.right : node.left;
+    searchNode(nearChild, query, k, heap);
+    if (heap.size() < k || diff * diff < heap.first().first) {
+        searchNode(farChild, query, k, heap);
+    }
+}
+
+QVector<TypeCurveIndex::Match> TypeCurveIndex::nearest(const QVector<double>& t, const QVector<double>& p,
+                                                       const QVector<double>& d, int k) const
+{
+    QVector<Match> matches;
+    if (k <= 0) return matches;
+
+    // 观测窗口取有效时间范围的中段，跨度与索引一致
+    double logMin = 0.0, logMax = 0.0;
+    if (!observedLogRange(t, p, logMin, logMax) || logMax - logMin + 1e-9 < m_logSpan) return matches;
+    Query query;
+    const double logStart = logMin + 0.5 * (logMax - logMin - m_logSpan);
+    if (!makeQuery(t, p, d, logStart, m_logSpan, query)) return matches;
+
+    // 同一曲线的相邻窗口往往同时入选，多取若干候选后按曲线去重
+    const int candidates = std::min(m_entryCurve.size(), std::max(8 * k, 32));
+    QVector<QPair<float, int>> heap;
+    heap.reserve(candidates);
+    searchNode(0, query.signature, candidates, heap);
+    std::sort_heap(heap.begin(), heap.end());
+
+    QVector<int> usedCurves;
+    for (const QPair<float, int>& hit : heap) {
+        const int entry = hit.second;
+        const int curve = m_entryCurve[entry];
+        if (usedCurves.contains(curve)) continue;
+        usedCurves.append(curve);
+
+        Match m;
+        m.library = m_library;
+        m.curve = curve;
+        m_library->curveKernelValues(curve, m.kernel);
+        m.tdCoeff = std::exp(m_entryLogTD0[entry] - query.logT0);
+        m.pCoeff = std::exp(query.meanLogP - m_entryMeanLogPD[entry]);
+        m.distance = std::sqrt((double)hit.first);
+        matches.append(m);
+        if (matches.size() >= k) break;
+    }
+    return matches;
+}
+
+QVector<TypeCurveIndex::Match> TypeCurveIndex::search(int modelType, int nf, const QVector<double>& t,
+                                                      const QVector<double>& p, const QVector<double>& d, int k)
+{
+    QVector<Match> all;
+    double logMin = 0.0, logMax = 0.0;
+    if (k <= 0 || !observedLogRange(t, p, logMin, logMax)) return all;
+    const double logSpan = quantizeSpan(logMax - logMin);
+
+    IndexCache& cache = indexCache();
+    for (const QSharedPointer<TypeCurveLibrary>& lib : TypeCurveLibrary::installed()) {
+        if (lib->modelType() != modelType || lib->fractureSegments() != nf) continue;
+
+        QSharedPointer<TypeCurveIndex> index;
+        {
+            QMutexLocker locker(&cache.mutex);
+            for (const IndexCache::Entry& e : cache.entries) {
+                if (e.library == lib && e.logSpan == logSpan) { index = e.index; break; }
+            }
+            if (!index) {
+                index = build(lib, logSpan);
+                if (!index) continue;
+                cache.entries.append({ lib, logSpan, index });
+            }
+        }
+        all += index->nearest(t, p, d, k);
+    }
+
+    std::sort(all.begin(), all.end(), [](const Match& a, const Match& b) { return a.distance < b.distance; });
+    if (all.size() > k) all.resize(k);
+    return all;
+}
+
+void TypeCurveIndex::clearCache()
+{
+    IndexCache& cache = indexCache();
+    QMutexLocker locker(&cache.mutex);
+    cache.entries.clear();
+}
@@ -0,0 +1,91 @@
+/*
+ * typecurveindex.h
+ * 文件作用: 类型曲线最近邻索引头文件 (拟合初值自动推荐)
+ * 功能描述:
+ * 1. 将类型曲线库 (typecurvelibrary.h) 中每条无因次曲线在若干时间窗口位置上截取，
+ *    对数重采样为定长签名：[ln pD_i - μ, ln pD'_i - μ]，μ 为窗口内 ln pD 的均值。
+ *    减去均值消除压力缩放系数，窗口滑动覆盖时间缩放系数，签名只反映双对数曲线的形状。
+ * 2. 签名存入 KD 树 (float 存储，叶节点 8 个签名)，k 近邻查询为精确搜索，通常为毫秒级。
+ * 3. 观测数据 (如 getLogSampledData 的抽样结果) 按相同规则生成查询签名，匹配结果同时给出
+ *    网格参数取值、无因次时间系数 tD/t 与压力系数 p/pD，供调用方换算为有因次初值。
+ * 4. 索引按 (库, 观测时间跨度) 惰性构建并缓存，时间跨度按 0.25 个对数周期取整。
+ */
+
+#ifndef TYPECURVEINDEX_H
+#define TYPECURVEINDEX_H
+
+#include <QPair>
+#include <QSharedPointer>
+#include <QVector>
+#include "typecurvelibrary.h"
+
+class TypeCurveIndex
+{
+public:
+    // 签名的时间采样点数 (签名总维数为 2 倍：压力与导数)
+    enum { SamplePoints = 16, SignatureLength = 2 * SamplePoints };
+
+    // 单个匹配结果
+    struct Match {
+        QSharedPointer<TypeCurveLibrary> library;            // 所属类型曲线库
+        int curve = -1;                                      // 库中的曲线序号
+        double kernel[ModelParams::KernelParamCount] = { 0.0 }; // 曲线的无因次核函数参数取值
+        double tdCoeff = 0.0;                                // 无因次时间系数 tD = tdCoeff * t
+        double pCoeff = 0.0;                                 // 压力系数 p = pCoeff * pD
+        double distance = 0.0;                               // 签名欧氏距离 (越小越相似)
+    };
+
+    // 对单个库、给定观测时间跨度 (自然对数) 构建索引
+    static QSharedPointer<TypeCurveIndex> build(const QSharedPointer<TypeCurveLibrary>& library, double logSpan);
+
+    // 返回与观测数据最相似的 k 条曲线 (每条库曲线至多一个结果，按距离升序)
+    QVector<Match> nearest(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, int k) const;
+
+    // 在全部已注册库中搜索 (按模型类型与 nf 筛选，索引自动构建并缓存)
+    static QVector<Match> search(int modelType, int nf, const QVector<double>& t, const QVector<double>& p,
+                                 const QVector<double>& d, int k);
+
+    // 清空索引缓存 (库重新加载后调用)
+    static void clearCache();
+
+    int entryCount() const { return m_entryCurve.size(); }
+
+private:
+    TypeCurveIndex() : m_logSpan(0.0) {}
+
+    // 观测数据的查询签名：返回 false 表示有效数据不足
+    struct Query {
+        float signature[SignatureLength];
+        double logT0 = 0.0;    // 窗口起点 ln t
+        double meanLogP = 0.0; // 窗口内 ln p 的均值
+    };
+    static bool makeQuery(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                          double logStart, double logSpan, Query& query);
+
+    // 观测数据的有效时间范围 (t > 0 且 p > 0 的点，自然对数)
+    static bool observedLogRange(const QVector<double>& t, const QVector<double>& p, double& logMin, double& logMax);
+
+    // 时间跨度按 0.25 个对数周期向下取整 (同一跨度的查询共享索引)
+    static double quantizeSpan(double logSpan);
+
+    // KD 树节点：叶节点覆盖 m_order[begin, end)，内部节点按 dim 维的 split 值划分
+    struct Node {
+        int dim = -1;
+        float split = 0.0f;
+        int left = -1, right = -1;
+        int begin = 0, end = 0;
+    };
+    int buildNode(int begin, int end);
+    void searchNode(int node, const float* query, int k, QVector<QPair<float, int>>& heap) const;
+
+    QSharedPointer<TypeCurveLibrary> m_library;
+    double m_logSpan;                 // 窗口跨度 (自然对数)
+    QVector<float> m_signatures;      // 各条目的签名 (条目数 × SignatureLength)
+    QVector<int> m_entryCurve;        // 条目对应的库曲线
+    QVector<double> m_entryLogTD0;    // 条目窗口起点 ln tD
+    QVector<double> m_entryMeanLogPD; // 条目窗口内 ln pD 的均值
+    QVector<int> m_order;             // KD 树叶节点引用的条目序号
+    QVector<Node> m_nodes;
+};
+
+#endif // TYPECURVEINDEX_H
@@ -0,0 +1,556 @@
+/*
+ * typecurvelibrary.cpp
+ * 文件作用: 无因次类型曲线库实现文件
+ * 功能描述:
+ * 1. 文件格式：定长文件头 + 各轴节点 + 时间网格 + 曲线数据 (double，[曲线][pD | 导数][时间]，最后一轴变化最快)。
+ * 2. 离线生成：网格点按块并行计算 (块内各曲线串行反演，避免线程池嵌套)，每块计算完成后顺序写盘并回调进度。
+ * 3. 读取：QFile::map 只读映射，文件头与总长度校验通过后直接在映射区上插值。
+ * 4. 插值：参数方向多线性 (全正节点的轴在对数空间)，时间方向在两端均为正值时双对数插值，否则线性插值。
+ * 5. 注册表：互斥锁保护的库列表，首次查询时按设置项 solver/typeCurveLibraryDir 加载目录；
+ *    目录改变时整体卸载后重新加载 (已取出的库由共享指针保持映射，直到使用方释放)。
+ */
+
+#include "typecurvelibrary.h"
+#include "typecurveindex.h"
+
+#include <QDir>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSettings>
+#include <QDebug>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+const char kMagic[8] = { 'W', 'T', 'T', 'C', 'L', 'I', 'B', '\0' };
+const qint32 kVersion = 1;
+
+// 定长文件头 (8 字节对齐，之后依次为各轴节点、时间网格与曲线数据)
+struct FileHeader {
+    char magic[8];
+    qint32 version;
+    qint32 modelType;
+    qint32 nf;
+    qint32 stehfestN;
+    qint32 inversion;
+    qint32 axisCount;
+    qint32 timeCount;
+    qint32 reserved;
+    qint64 curveCount;
+    double fixedValue[ModelParams::KernelParamCount];
+    qint32 axisParam[ModelParams::KernelParamCount];
+    qint32 axisSize[ModelParams::KernelParamCount];
+    qint32 axisLog[ModelParams::KernelParamCount];
+    qint32 padding;
+};
+static_assert(sizeof(FileHeader) % sizeof(double) == 0, "FileHeader must keep the payload 8-byte aligned");
+
+// 固定参数的比较容差 (相对)：库以精确取值制表，只接受舍入级别的差异
+const double kFixedTolerance = 1e-9;
+
+// 生成时每块计算的曲线数 (块间回调进度并写盘)
+const int kGenerateChunk = 64;
+
+// 按核函数参数编号读写参数块中的无因次量
+double kernelValue(const ModelParams& p, int param)
+{
+    switch (param) {
+    case ModelParams::Kernel_M12: return p.M12;
+    case ModelParams::Kernel_LfD: return p.LfD;
+    case ModelParams::Kernel_rmD: return p.rmD;
+    case ModelParams::Kernel_reD: return p.reD;
+    case ModelParams::Kernel_omega1: return p.omega1;
+    case ModelParams::Kernel_omega2: return p.omega2;
+    case ModelParams::Kernel_lambda1: return p.lambda1;
+    case ModelParams::Kernel_lambda2: return p.lambda2;
+    case ModelParams::Kernel_eta12: return p.eta12;
+    case ModelParams::Kernel_cD: return p.cD;
+    case ModelParams::Kernel_S: return p.S;
+    default: return 0.0;
+    }
+}
+
+void setKernelValue(ModelParams& p, int param, double value)
+{
+    switch (param) {
+    case ModelParams::Kernel_M12: p.M12 = value; break;
+    case ModelParams::Kernel_LfD: p.LfD = value; break;
+    case ModelParams::Kernel_rmD: p.rmD = value; break;
+    case ModelParams::Kernel_reD: p.reD = value; break;
+    case ModelParams::Kernel_omega1: p.omega1 = value; break;
+    case ModelParams::Kernel_omega2: p.omega2 = value; break;
+    case ModelParams::Kernel_lambda1: p.lambda1 = value; break;
+    case ModelParams::Kernel_lambda2: p.lambda2 = value; break;
+    case ModelParams::Kernel_eta12: p.eta12 = value; break;
+    case ModelParams::Kernel_cD: p.cD = value; break;
+    case ModelParams::Kernel_S: p.S = value; break;
+    default: break;
+    }
+}
+
+// 模型 1/3/5 含井储表皮；2/4/6 的 cD/S 不参与计算，查询时不比较
+bool hasWellboreStorage(int modelType)
+{
+    return modelType == ModelSolver01_06::Model_1 || modelType == ModelSolver01_06::Model_3
+           || modelType == ModelSolver01_06::Model_5;
+}
+
+bool isStorageParam(int param)
+{
+    return param == ModelParams::Kernel_cD || param == ModelParams::Kernel_S;
+}
+
+bool strictlyIncreasing(const QVector<double>& v)
+{
+    for (int i = 1; i < v.size(); ++i) {
+        if (!(v[i] > v[i - 1])) return false;
+    }
+    return !v.isEmpty();
+}
+
+void setError(QString* errorMessage, const QString& text)
+{
+    if (errorMessage) *errorMessage = text;
+}
+
+// 时间方向插值：两端均为正值时在对数空间插值 (幂律段更准确)，否则线性
+inline double interpolateInTime(double left, double right, double w)
+{
+    if (w <= 0.0) return left;
+    if (left > 0.0 && right > 0.0) return left * std::exp(w * std::log(right / left));
+    return left + w * (right - left);
+}
+
+// 全局注册表
+struct Registry {
+    QMutex mutex;
+    QVector<QSharedPointer<TypeCurveLibrary>> libraries;
+    bool settingsLoaded = false;
+    QString directory; // 按设置项加载的目录
+};
+
+Registry& registry()
+{
+    static Registry s_registry;
+    return s_registry;
+}
+
+} // namespace
+
+// ---------------------- 离线生成 ----------------------
+
+bool TypeCurveLibrary::generate(const TypeCurveGridSpec& spec, const QString& path, QString* errorMessage,
+                                const std::function<bool(int, int)>& progress)
+{
+    // --- 1. 网格校验 ---
+    if (spec.modelType < ModelSolver01_06::Model_1 || spec.modelType > ModelSolver01_06::Model_6) {
+        setError(errorMessage, "无效的模型类型");
+        return false;
+    }
+    if (spec.axes.size() != spec.nodes.size() || spec.axes.size() > ModelParams::KernelParamCount) {
+        setError(errorMessage, "网格轴定义不一致");
+        return false;
+    }
+    if (!strictlyIncreasing(spec.tD) || spec.tD.first() <= 0.0) {
+        setError(errorMessage, "无因次时间网格必须为严格递增的正数");
+        return false;
+    }
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.modelType = spec.modelType;
+    header.nf = spec.base.xwD.size();
+    header.stehfestN = spec.base.N;
+    header.inversion = spec.base.inversion;
+    header.axisCount = spec.axes.size();
+    header.timeCount = spec.tD.size();
+
+    qint64 curveCount = 1;
+    bool used[ModelParams::KernelParamCount] = { false };
+    for (int a = 0; a < spec.axes.size(); ++a) {
+        int param = spec.axes[a];
+        if (param < 0 || param >= ModelParams::KernelParamCount || used[param]) {
+            setError(errorMessage, "网格轴参数无效或重复");
+            return false;
+        }
+        if (!strictlyIncreasing(spec.nodes[a])) {
+            setError(errorMessage, "网格节点必须严格递增");
+            return false;
+        }
+        used[param] = true;
+        header.axisParam[a] = param;
+        header.axisSize[a] = spec.nodes[a].size();
+        header.axisLog[a] = (spec.nodes[a].first() > 0.0) ? 1 : 0;
+        curveCount *= spec.nodes[a].size();
+    }
+    if (curveCount > std::numeric_limits<int>::max() / 2) {
+        setError(errorMessage, "网格规模过大");
+        return false;
+    }
+    header.curveCount = curveCount;
+    for (int k = 0; k < ModelParams::KernelParamCount; ++k) header.fixedValue[k] = kernelValue(spec.base, k);
+
+    // --- 2. 写文件头、节点与时间网格 ---
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        setError(errorMessage, "无法写入文件: " + path);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const QVector<double>& axisNodes : spec.nodes) {
+        file.write(reinterpret_cast<const char*>(axisNodes.constData()), axisNodes.size() * sizeof(double));
+    }
+    file.write(reinterpret_cast<const char*>(spec.tD.constData()), spec.tD.size() * sizeof(double));
+
+    // --- 3. 按块并行计算各网格点的无因次曲线 ---
+    // 最后一轴变化最快；压敏摄动不制表 (查询时解析叠加)，因此 gamaD 固定为 0
+    QVector<int> strides(spec.axes.size(), 1);
+    for (int a = spec.axes.size() - 2; a >= 0; --a) strides[a] = strides[a + 1] * spec.nodes[a + 1].size();
+
+    const int timeCount = spec.tD.size();
+    const int total = (int)curveCount;
+    QVector<double> chunk;
+    for (int begin = 0; begin < total; begin += kGenerateChunk) {
+        const int count = std::min(kGenerateChunk, total - begin);
+        chunk.resize(count * 2 * timeCount);
+        double* out = chunk.data();
+
+        QVector<int> indices(count);
+        std::iota(indices.begin(), indices.end(), 0);
+        QtConcurrent::blockingMap(indices, [&](int local) {
+            ModelParams p = spec.base;
+            p.gamaD = 0.0;
+            int flat = begin + local;
+            for (int a = 0; a < spec.axes.size(); ++a) {
+                setKernelValue(p, spec.axes[a], spec.nodes[a][(flat / strides[a]) % spec.nodes[a].size()]);
+            }
+
+            ModelSolver01_06::ScopedSerialEvaluation serial;
+            ModelSolver01_06 solver((ModelSolver01_06::ModelType)spec.modelType);
+            solver.setHighPrecision(true);
+            QVector<double> pd, deriv;
+            solver.calculateDimensionlessCurve(spec.tD, p, pd, deriv);
+            std::copy(pd.constBegin(), pd.constEnd(), out + (qint64)local * 2 * timeCount);
+            std::copy(deriv.constBegin(), deriv.constEnd(), out + (qint64)local * 2 * timeCount + timeCount);
+        });
+
+        file.write(reinterpret_cast<const char*>(chunk.constData()), chunk.size() * sizeof(double));
+        if (progress && !progress(begin + count, total)) {
+            file.cancelWriting();
+            setError(errorMessage, "已取消");
+            return false;
+        }
+    }
+
+    if (!file.commit()) {
+        setError(errorMessage, "写入文件失败: " + path);
+        return false;
+    }
+    return true;
+}
+
+// ---------------------- 读取 ----------------------
+
+TypeCurveLibrary::TypeCurveLibrary()
+    : m_modelType(0)
+    , m_nf(0)
+    , m_curveCount(0)
+    , m_map(nullptr)
+    , m_data(nullptr)
+{
+    std::fill(m_fixedValue, m_fixedValue + ModelParams::KernelParamCount, 0.0);
+    std::fill(m_gridded, m_gridded + ModelParams::KernelParamCount, false);
+}
+
+TypeCurveLibrary::~TypeCurveLibrary()
+{
+    if (m_map) m_file.unmap(m_map);
+}
+
+QSharedPointer<TypeCurveLibrary> TypeCurveLibrary::open(const QString& path, QString* errorMessage)
+{
+    QSharedPointer<TypeCurveLibrary> lib(new TypeCurveLibrary());
+    lib->m_file.setFileName(path);
+    if (!lib->m_file.open(QIODevice::ReadOnly)) {
+        setError(errorMessage, "无法打开文件: " + path);
+        return QSharedPointer<TypeCurveLibrary>();
+    }
+    const qint64 fileSize = lib->m_file.size();
+    if (fileSize < (qint64)sizeof(FileHeader)) {
+        setError(errorMessage, "文件过短: " + path);
+        return QSharedPointer<TypeCurveLibrary>();
+    }
+    lib->m_map = lib->m_file.map(0, fileSize);
+    if (!lib->m_map) {
+        setError(errorMessage, "内存映射失败: " + path);
+        return QSharedPointer<TypeCurveLibrary>();
+    }
+
+    // --- 文件头校验 ---
+    FileHeader header;
+    std::memcpy(&header, lib->m_map, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || header.axisCount < 0 || header.axisCount > ModelParams::KernelParamCount
+        || header.timeCount < 2 || header.curveCount < 1
+        || header.modelType < ModelSolver01_06::Model_1 || header.modelType > ModelSolver01_06::Model_6) {
+        setError(errorMessage, "文件头无效: " + path);
+        return QSharedPointer<TypeCurveLibrary>();
+    }
+    qint64 nodeTotal = 0, curveCount = 1;
+    for (int a = 0; a < header.axisCount; ++a) {
+        if (header.axisSize[a] < 1 || header.axisParam[a] < 0 || header.axisParam[a] >= ModelParams::KernelParamCount) {
+            setError(errorMessage, "网格轴定义无效: " + path);
+            return QSharedPointer<TypeCurveLibrary>();
+        }
+        nodeTotal += header.axisSize[a];
+        curveCount *= header.axisSize[a];
+    }
+    const qint64 expected = (qint64)sizeof(FileHeader)
+                            + (nodeTotal + header.timeCount + curveCount * 2 * header.timeCount) * (qint64)sizeof(double);
+    if (curveCount != header.curveCount || expected != fileSize) {
+        setError(errorMessage, "文件长度与网格定义不符: " + path);
+        return QSharedPointer<TypeCurveLibrary>();
+    }
+
+    // --- 节点与时间网格 (小数组，拷贝并预先取对数) ---
+    lib->m_modelType = header.modelType;
+    lib->m_nf = header.nf;
+    lib->m_curveCount = (int)curveCount;
+    std::copy(header.fixedValue, header.fixedValue + ModelParams::KernelParamCount, lib->m_fixedValue);
+
+    const double* cursor = reinterpret_cast<const double*>(lib->m_map + sizeof(FileHeader));
+    for (int a = 0; a < header.axisCount; ++a) {
+        GridAxis axis;
+        axis.param = header.axisParam[a];
+        axis.logScale = header.axisLog[a] != 0;
+        axis.nodes.resize(header.axisSize[a]);
+        axis.rawNodes.resize(header.axisSize[a]);
+        for (int i = 0; i < header.axisSize[a]; ++i) {
+            axis.rawNodes[i] = cursor[i];
+            axis.nodes[i] = axis.logScale ? std::log(cursor[i]) : cursor[i];
+        }
+        cursor += header.axisSize[a];
+        lib->m_gridded[axis.param] = true;
+        lib->m_axes.append(axis);
+    }
+    for (int a = lib->m_axes.size() - 1, stride = 1; a >= 0; --a) {
+        lib->m_axes[a].stride = stride;
+        stride *= lib->m_axes[a].nodes.size();
+    }
+    lib->m_logTD.resize(header.timeCount);
+    for (int j = 0; j < header.timeCount; ++j) lib->m_logTD[j] = std::log(cursor[j]);
+    cursor += header.timeCount;
+    lib->m_data = cursor;
+
+    return lib;
+}
+
+void TypeCurveLibrary::curveKernelValues(int curve, double* values) const
+{
+    std::copy(m_fixedValue, m_fixedValue + ModelParams::KernelParamCount, values);
+    for (const GridAxis& axis : m_axes) {
+        values[axis.param] = axis.rawNodes[(curve / axis.stride) % axis.rawNodes.size()];
+    }
+}
+
+bool TypeCurveLibrary::locate(const GridAxis& axis, double value, int& index, double& weight)
+{
+    if (axis.logScale) {
+        if (!(value > 0.0)) return false;
+        value = std::log(value);
+    }
+    const QVector<double>& nodes = axis.nodes;
+    const double tol = kFixedTolerance * std::max(1.0, std::abs(value));
+    if (value < nodes.first() - tol || value > nodes.last() + tol) return false;
+    if (nodes.size() == 1) {
+        index = 0;
+        weight = 0.0;
+        return true;
+    }
+    value = std::min(std::max(value, nodes.first()), nodes.last());
+    index = int(std::upper_bound(nodes.constBegin(), nodes.constEnd(), value) - nodes.constBegin()) - 1;
+    index = std::min(std::max(index, 0), nodes.size() - 2);
+    weight = (value - nodes[index]) / (nodes[index + 1] - nodes[index]);
+    return true;
+}
+
+bool TypeCurveLibrary::covers(int modelType, const ModelParams& params, double tDMin, double tDMax) const
+{
+    if (modelType != m_modelType || params.xwD.size() != m_nf) return false;
+
+    // 固定参数需一致 (无井储模型忽略 cD/S)
+    for (int k = 0; k < ModelParams::KernelParamCount; ++k) {
+        if (m_gridded[k]) continue;
+        if (isStorageParam(k) && !hasWellboreStorage(modelType)) continue;
+        double v = kernelValue(params, k);
+        if (std::abs(v - m_fixedValue[k]) > kFixedTolerance * std::max(1.0, std::abs(m_fixedValue[k]))) return false;
+    }
+
+    // 网格参数位于节点凸包内
+    for (const GridAxis& axis : m_axes) {
+        int index;
+        double weight;
+        if (!locate(axis, kernelValue(params, axis.param), index, weight)) return false;
+    }
+
+    // 时间范围位于制表范围内
+    if (tDMax >= tDMin && tDMin > 0.0) {
+        const double tol = kFixedTolerance * std::max(1.0, std::abs(m_logTD.last()));
+        if (std::log(tDMin) < m_logTD.first() - tol || std::log(tDMax) > m_logTD.last() + tol) return false;
+    }
+    return true;
+}
+
+bool TypeCurveLibrary::interpolate(const ModelParams& params, const QVector<double>& tD,
+                                   QVector<double>& outPD, QVector<double>& outDeriv) const
+{
+    // --- 1. 参数方向：定位各轴并枚举 2^d 个角点 ---
+    const int axisCount = m_axes.size();
+    int baseIndex = 0;
+    QVector<double> axisWeight(axisCount, 0.0);
+    for (int a = 0; a < axisCount; ++a) {
+        int index;
+        double weight;
+        if (!locate(m_axes[a], kernelValue(params, m_axes[a].param), index, weight)) return false;
+        baseIndex += index * m_axes[a].stride;
+        axisWeight[a] = weight;
+    }
+
+    QVector<int> cornerOffset;
+    QVector<double> cornerWeight;
+    for (int mask = 0; mask < (1 << axisCount); ++mask) {
+        double w = 1.0;
+        int offset = baseIndex;
+        for (int a = 0; a < axisCount && w > 0.0; ++a) {
+            if (mask & (1 << a)) {
+                w *= axisWeight[a];
+                offset += m_axes[a].stride;
+            } else {
+                w *= 1.0 - axisWeight[a];
+            }
+        }
+        if (w > 0.0) {
+            cornerOffset.append(offset);
+            cornerWeight.append(w);
+        }
+    }
+
+    // --- 2. 时间方向：逐点定位后对各角点曲线插值并加权 ---
+    const int numPoints = tD.size();
+    const int timeCount = m_logTD.size();
+    outPD.fill(0.0, numPoints);
+    outDeriv.fill(0.0, numPoints);
+    for (int k = 0; k < numPoints; ++k) {
+        if (tD[k] <= 1e-10) continue; // 与求解器一致：极小时间输出 0
+        double x = std::log(tD[k]);
+        const double tol = kFixedTolerance * std::max(1.0, std::abs(m_logTD.last()));
+        if (x < m_logTD.first() - tol || x > m_logTD.last() + tol) return false;
+        x = std::min(std::max(x, m_logTD.first()), m_logTD.last());
+        int j = int(std::upper_bound(m_logTD.constBegin(), m_logTD.constEnd(), x) - m_logTD.constBegin()) - 1;
+        j = std::min(std::max(j, 0), timeCount - 2);
+        double w = (x - m_logTD[j]) / (m_logTD[j + 1] - m_logTD[j]);
+
+        double pd = 0.0, deriv = 0.0;
+        for (int c = 0; c < cornerOffset.size(); ++c) {
+            const double* curve = m_data + (qint64)cornerOffset[c] * 2 * timeCount;
+            pd += cornerWeight[c] * interpolateInTime(curve[j], curve[j + 1], w);
+            deriv += cornerWeight[c] * interpolateInTime(curve[timeCount + j], curve[timeCount + j + 1], w);
+        }
+        outPD[k] = pd;
+        outDeriv[k] = deriv;
+    }
+    return true;
+}
+
+// ---------------------- 全局注册表 ----------------------
+
+void TypeCurveLibrary::install(const QSharedPointer<TypeCurveLibrary>& library)
+{
+    if (!library) return;
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    reg.libraries.append(library);
+}
+
+void TypeCurveLibrary::uninstallAll()
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    reg.libraries.clear();
+}
+
+int TypeCurveLibrary::loadDirectory(const QString& directory)
+{
+    if (directory.isEmpty()) return 0;
+    QDir dir(directory);
+    const QStringList files = dir.entryList(QStringList() << QString("*.%1").arg(fileSuffix()), QDir::Files, QDir::Name);
+    int loaded = 0;
+    for (const QString& name : files) {
+        QString error;
+        QSharedPointer<TypeCurveLibrary> lib = open(dir.absoluteFilePath(name), &error);
+        if (!lib) {
+            qDebug() << "TypeCurveLibrary:" << error;
+            continue;
+        }
+        install(lib);
+        ++loaded;
+    }
+    return loaded;
+}
+
+void TypeCurveLibrary::ensureSettingsLoaded()
+{
+    Registry& reg = registry();
+    QString directory;
+    {
+        QMutexLocker locker(&reg.mutex);
+        if (reg.settingsLoaded) return;
+        reg.settingsLoaded = true;
+        QSettings settings("WellTestPro", "WellTestAnalysis");
+        directory = settings.value("solver/typeCurveLibraryDir").toString();
+        reg.directory = directory;
+    }
+    if (!directory.isEmpty()) loadDirectory(directory);
+}
+
+bool TypeCurveLibrary::setLibraryDirectory(const QString& directory)
+{
+    Registry& reg = registry();
+    {
+        QMutexLocker locker(&reg.mutex);
+        // 尚未按设置加载过时只记录目录，首次查询时再加载
+        if (!reg.settingsLoaded) return false;
+        if (reg.directory == directory) return false;
+        reg.directory = directory;
+        reg.libraries.clear();
+    }
+    TypeCurveIndex::clearCache();
+    if (!directory.isEmpty()) loadDirectory(directory);
+    return true;
+}
+
+QSharedPointer<TypeCurveLibrary> TypeCurveLibrary::find(int modelType, const ModelParams& params, double tDMin, double tDMax)
+{
+    ensureSettingsLoaded();
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const QSharedPointer<TypeCurveLibrary>& lib : reg.libraries) {
+        if (lib->covers(modelType, params, tDMin, tDMax)) return lib;
+    }
+    return QSharedPointer<TypeCurveLibrary>();
+}
+
+QVector<QSharedPointer<TypeCurveLibrary>> TypeCurveLibrary::installed()
+{
+    ensureSettingsLoaded();
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    return reg.libraries;
+}
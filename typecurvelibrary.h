@@ -0,0 +1,123 @@
+/*
+ * typecurvelibrary.h
+ * 文件作用: 无因次类型曲线库头文件 (离线生成 + 内存映射读取)
+ * 功能描述:
+ * 1. 定义类型曲线网格 TypeCurveGridSpec：按模型类型，在若干无因次形状参数 (M12, LfD, rmD, reD,
+ *    omega1/2, lambda1/2, eta12, cD, S) 的节点网格上，对无因次时间网格制表 pD 及 Bourdet 导数。
+ *    未列入网格的参数取 base 中的固定值，11 维全网格不可行，通常只对关心的 2~4 个参数制表。
+ * 2. TypeCurveLibrary::generate 离线生成库文件：各网格点的曲线并行计算、按块顺序写盘 (QSaveFile 原子替换)。
+ * 3. TypeCurveLibrary::open 以只读内存映射打开库文件，查询时不拷贝曲线数据，多个线程可同时读取。
+ * 4. 查询点位于制表范围内 (模型类型、nf 与固定参数一致，网格参数与时间位于节点凸包内) 时，
+ *    参数方向按 (对数) 多线性插值，时间方向按双对数插值，给出无因次压力与导数。
+ * 5. 全局注册表：按设置项 solver/typeCurveLibraryDir 自动加载目录下全部 *.wtcl 文件，
+ *    求解器的快速路径 (solver/typeCurveLibraryEnabled) 通过 find() 查找覆盖查询点的库；
+ *    目录设置改变后经 setLibraryDirectory 重新加载，无需重启。
+ * 6. 提供逐曲线的只读访问 (时间网格、pD/导数、网格参数取值)，供类型曲线索引 (typecurveindex.h) 构建签名。
+ */
+
+#ifndef TYPECURVELIBRARY_H
+#define TYPECURVELIBRARY_H
+
+#include <QFile>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "modelsolver01-06.h"
+
+// 类型曲线库的网格定义 (离线生成输入)
+struct TypeCurveGridSpec {
+    int modelType = 0;               // ModelSolver01_06::ModelType
+    ModelParams base;                // 未列入网格的无因次参数取值，以及 nf / N / 反演方法 (gamaD 不制表，查询时解析叠加)
+    QVector<int> axes;               // 参与制表的核函数参数 (ModelParams::KernelParam)，顺序即数据存储顺序
+    QVector<QVector<double>> nodes;  // 各轴节点 (严格递增)；全部为正的轴按对数插值
+    QVector<double> tD;              // 无因次时间网格 (严格递增，建议对数均匀)
+};
+
+class TypeCurveLibrary
+{
+public:
+    // 库文件扩展名 (注册表按目录加载时使用)
+    static const char* fileSuffix() { return "wtcl"; }
+
+    // ---------------------- 离线生成 ----------------------
+    // 按网格逐点计算无因次曲线并写入 path；progress(done, total) 在调用线程中按块回调，返回 false 时取消生成
+    static bool generate(const TypeCurveGridSpec& spec, const QString& path, QString* errorMessage = nullptr,
+                         const std::function<bool(int, int)>& progress = std::function<bool(int, int)>());
+
+    // ---------------------- 读取 ----------------------
+    // 以只读内存映射打开库文件 (校验文件头与长度)，失败时返回空指针
+    static QSharedPointer<TypeCurveLibrary> open(const QString& path, QString* errorMessage = nullptr);
+
+    ~TypeCurveLibrary();
+
+    int modelType() const { return m_modelType; }
+    int curveCount() const { return m_curveCount; }
+    int timeCount() const { return m_logTD.size(); }
+    QString filePath() const { return m_file.fileName(); }
+    int fractureSegments() const { return m_nf; }
+
+    // 逐曲线访问 (供类型曲线索引构建签名)：无因次时间网格 (自然对数)、曲线的 pD / 导数数据及其核函数参数取值
+    const QVector<double>& logTimeGrid() const { return m_logTD; }
+    const double* curvePD(int curve) const { return m_data + (qint64)curve * 2 * m_logTD.size(); }
+    const double* curveDerivative(int curve) const { return curvePD(curve) + m_logTD.size(); }
+    void curveKernelValues(int curve, double* values) const;
+
+    // 查询点是否位于制表范围内 (tDMin / tDMax 为待求正值无因次时间的范围)
+    bool covers(int modelType, const ModelParams& params, double tDMin, double tDMax) const;
+
+    // 插值求无因次压力与 Bourdet 导数 (不含压敏摄动)；查询点不在范围内时返回 false
+    bool interpolate(const ModelParams& params, const QVector<double>& tD,
+                     QVector<double>& outPD, QVector<double>& outDeriv) const;
+
+    // ---------------------- 全局注册表 ----------------------
+    // 注册 / 清空已加载的库 (线程安全)
+    static void install(const QSharedPointer<TypeCurveLibrary>& library);
+    static void uninstallAll();
+
+    // 加载目录下全部库文件，返回成功加载的数量
+    static int loadDirectory(const QString& directory);
+
+    // 切换设置项目录：与当前目录不同时卸载全部库、清空类型曲线索引并加载新目录，返回目录是否改变
+    static bool setLibraryDirectory(const QString& directory);
+
+    // 查找覆盖查询点的库 (首次调用时按设置项 solver/typeCurveLibraryDir 自动加载)，无则返回空指针
+    static QSharedPointer<TypeCurveLibrary> find(int modelType, const ModelParams& params, double tDMin, double tDMax);
+
+    // 当前已注册的全部库 (首次调用时同样按设置项自动加载)
+    static QVector<QSharedPointer<TypeCurveLibrary>> installed();
+
+private:
+    TypeCurveLibrary();
+    TypeCurveLibrary(const TypeCurveLibrary&) = delete;
+    TypeCurveLibrary& operator=(const TypeCurveLibrary&) = delete;
+
+    // 单个网格轴：节点 (对数轴已取自然对数) 与跨距
+    struct GridAxis {
+        int param = 0;
+        bool logScale = false;
+        QVector<double> nodes;     // 插值用节点 (对数轴为自然对数)
+        QVector<double> rawNodes;  // 文件中的原始节点取值
+        int stride = 1;
+    };
+
+    // 在网格轴上定位查询值：返回左节点下标与右节点权重，超出凸包时返回 false
+    static bool locate(const GridAxis& axis, double value, int& index, double& weight);
+
+    // 首次访问注册表时按设置项 solver/typeCurveLibraryDir 加载目录
+    static void ensureSettingsLoaded();
+
+    int m_modelType;
+    int m_nf;
+    double m_fixedValue[ModelParams::KernelParamCount]; // 固定参数取值 (网格轴对应项无意义)
+    bool m_gridded[ModelParams::KernelParamCount];      // 该参数是否为网格轴
+    QVector<GridAxis> m_axes;
+    QVector<double> m_logTD;                            // 无因次时间网格 (自然对数)
+    int m_curveCount;
+
+    QFile m_file;
+    uchar* m_map;
+    const double* m_data; // 映射区中的曲线数据：[曲线][pD | 导数][时间]
+};
+
+#endif // TYPECURVELIBRARY_H
@@ -7,20 +7,35 @@
  * 3. 实现了数据的同步保存与恢复。
  * 4. [保留优化] 实现了 getAllDataModels，遍历所有页签收集数据模型。
  * 5. [新增] 增加了 applyDataDialogStyle 函数，统一数据界面弹窗的按钮样式为“灰底黑字”，解决看不清的问题。
+ * 6. [后台加载] createNewTab 先加入页签再后台加载；加载中的页签不计入 getDataModel / getAllDataModels，
+ *    不参与保存，工具栏计算按钮禁用；加载失败或取消时移除页签。
+ * 7. [二进制表格] 保存写入 _date.bin (ProjectTableStore)；恢复时优先读取该文件，各页签延迟解压，
+ *    取数据模型前先确保已加载；没有 _date.bin 的旧项目仍从 _date.json 恢复。
+ * 8. [增量保存] 未修改的页签 (包括尚未解压的) 直接复制旧文件中的压缩块；页签均未修改、顺序与数量不变时不写文件。
+ * 9. [后台过滤] 工具栏的过滤框作用于当前页签 (各页签各自保留过滤条件)，切换页签时显示该页签的条件。
+ * 10. [变更合并] 页签的内容修改以合并后的变更集经 sheetDataChanged 转发 (所有页签，不只当前页签)；
+ *    dataChanged 只在页签集合变化 (打开、关闭、恢复、切换) 时发出。
+ * 11. [分段加载] 旧格式项目的表格仍在后台解析时不保存 (此时页签尚未恢复，保存会覆盖磁盘上的表格)。
+ * 12. [压缩驻留] 切换页签、加载完成与每分钟一次的定时检查时调用 updateResidency：当前页签整表解压，
+ *    其余页签由 SheetResidencyManager 按最近使用顺序压缩；下游经 getAllDataModels 读取的压缩页签只解压所读的列。
  */
 
 #include "wt_datawidget.h"
 #include "ui_wt_datawidget.h"
 #include "modelparameter.h"
 #include "dataimportdialog.h"
+#include "projecttablestore.h"
+#include "sheetresidency.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QDebug>
+#include <QFile>
 #include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QTimer>
 
 // [新增] 静态辅助函数：强制应用“灰底黑字”的按钮样式
 // 解决某些弹窗按钮背景为白色导致看不清文字的问题
@@ -47,6 +62,11 @@ WT_DataWidget::WT_DataWidget(QWidget *parent) :
     ui->setupUi(this);
     initUI();
     setupConnections();
+
+    m_residencyTimer = new QTimer(this);
+    m_residencyTimer->setInterval(60 * 1000);
+    connect(m_residencyTimer, &QTimer::timeout, this, &WT_DataWidget::updateResidency);
+    m_residencyTimer->start();
 }
 
 WT_DataWidget::~WT_DataWidget()
@@ -70,10 +90,12 @@ void WT_DataWidget::setupConnections()
     connect(ui->btnTimeConvert, &QPushButton::clicked, this, &WT_DataWidget::onTimeConvert);
     connect(ui->btnPressureDropCalc, &QPushButton::clicked, this, &WT_DataWidget::onPressureDropCalc);
     connect(ui->btnCalcPwf, &QPushButton::clicked, this, &WT_DataWidget::onCalcPwf);
+    connect(ui->btnExpression, &QPushButton::clicked, this, &WT_DataWidget::onExpressionColumn);
     connect(ui->btnErrorCheck, &QPushButton::clicked, this, &WT_DataWidget::onHighlightErrors);
 
     // TabWidget 信号连接
     connect(ui->tabWidget, &QTabWidget::currentChanged, this, &WT_DataWidget::onTabChanged);
+    connect(ui->filterEdit, &QLineEdit::textEdited, this, &WT_DataWidget::onFilterTextEdited);
     connect(ui->tabWidget, &QTabWidget::tabCloseRequested, this, &WT_DataWidget::onTabCloseRequested);
 }
 
@@ -81,31 +103,45 @@ DataSingleSheet* WT_DataWidget::currentSheet() const {
     return qobject_cast<DataSingleSheet*>(ui->tabWidget->currentWidget());
 }
 
-QStandardItemModel* WT_DataWidget::getDataModel() const {
+ColumnarTableModel* WT_DataWidget::getDataModel() const {
     if (auto sheet = currentSheet()) {
-        return sheet->getDataModel();
+        if (!sheet->isLoading()) {
+            sheet->ensureDataLoaded();
+            return sheet->getDataModel();
+        }
     }
     return nullptr;
 }
 
 // [保留功能] 获取所有数据模型映射表
-QMap<QString, QStandardItemModel*> WT_DataWidget::getAllDataModels() const
+QMap<QString, ColumnarTableModel*> WT_DataWidget::getAllDataModels() const
 {
-    QMap<QString, QStandardItemModel*> map;
+    QMap<QString, ColumnarTableModel*> map;
     for (int i = 0; i < ui->tabWidget->count(); ++i) {
         DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(ui->tabWidget->widget(i));
-        if (sheet) {
+        if (sheet && !sheet->isLoading()) {
             // 优先使用文件路径作为Key，如果为空则使用页签标题
             QString key = sheet->getFilePath();
             if (key.isEmpty()) {
                 key = ui->tabWidget->tabText(i);
             }
+            sheet->ensureDataLoaded();
             map.insert(key, sheet->getDataModel());
         }
     }
     return map;
 }
 
+QList<DataSingleSheet*> WT_DataWidget::savableSheets() const
+{
+    QList<DataSingleSheet*> sheets;
+    for (int i = 0; i < ui->tabWidget->count(); ++i) {
+        DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(ui->tabWidget->widget(i));
+        if (sheet && !sheet->isLoading()) sheets.append(sheet);
+    }
+    return sheets;
+}
+
 QString WT_DataWidget::getCurrentFileName() const {
     if (auto sheet = currentSheet()) {
         return sheet->getFilePath();
@@ -120,13 +156,17 @@ bool WT_DataWidget::hasData() const {
 void WT_DataWidget::updateButtonsState()
 {
     bool hasSheet = (ui->tabWidget->count() > 0);
+    // 当前页签仍在加载时不允许对其操作
+    bool sheetReady = hasSheet && currentSheet() && !currentSheet()->isLoading();
     ui->btnSave->setEnabled(hasSheet);
-    ui->btnExport->setEnabled(hasSheet);
-    ui->btnDefineColumns->setEnabled(hasSheet);
-    ui->btnTimeConvert->setEnabled(hasSheet);
-    ui->btnPressureDropCalc->setEnabled(hasSheet);
-    ui->btnCalcPwf->setEnabled(hasSheet);
-    ui->btnErrorCheck->setEnabled(hasSheet);
+    ui->btnExport->setEnabled(sheetReady);
+    ui->btnDefineColumns->setEnabled(sheetReady);
+    ui->btnTimeConvert->setEnabled(sheetReady);
+    ui->btnPressureDropCalc->setEnabled(sheetReady);
+    ui->btnCalcPwf->setEnabled(sheetReady);
+    ui->btnExpression->setEnabled(sheetReady);
+    ui->btnErrorCheck->setEnabled(sheetReady);
+    ui->filterEdit->setEnabled(sheetReady);
 
     if (auto sheet = currentSheet()) {
         ui->filePathLabel->setText(sheet->getFilePath());
@@ -159,20 +199,39 @@ void WT_DataWidget::onOpenFile()
 }
 
 void WT_DataWidget::createNewTab(const QString& filePath, const DataImportSettings& settings) {
+    // 页签立即出现，数据在后台加载并逐批显示；完成后由 onSheetLoadFinished 通知下游
     DataSingleSheet* sheet = new DataSingleSheet(this);
-    if (sheet->loadData(filePath, settings)) {
-        QFileInfo fi(filePath);
-        ui->tabWidget->addTab(sheet, fi.fileName());
-        ui->tabWidget->setCurrentWidget(sheet);
+    QFileInfo fi(filePath);
+    ui->tabWidget->addTab(sheet, fi.fileName());
+    ui->tabWidget->setCurrentWidget(sheet);
+
+    connect(sheet, &DataSingleSheet::changesCommitted, this, &WT_DataWidget::onSheetChangesCommitted);
+    connect(sheet, &DataSingleSheet::loadFinished, this, &WT_DataWidget::onSheetLoadFinished);
 
-        connect(sheet, &DataSingleSheet::dataChanged, this, &WT_DataWidget::onSheetDataChanged);
+    ui->statusLabel->setText("正在加载: " + fi.fileName());
+    sheet->loadDataAsync(filePath, settings);
+    updateButtonsState();
+}
+
+void WT_DataWidget::onSheetLoadFinished(bool success) {
+    DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(sender());
+    if (!sheet) return;
+    const int index = ui->tabWidget->indexOf(sheet);
+    if (index < 0) return; // 页签已被清除
 
+    const QString filePath = sheet->getFilePath();
+    if (success) {
+        ui->statusLabel->setText("加载完成: " + QFileInfo(filePath).fileName());
         updateButtonsState();
         emit fileChanged(filePath, "text");
         emit dataChanged();
+        updateResidency();
     } else {
-        delete sheet;
-        ui->statusLabel->setText("加载文件失败: " + filePath);
+        // 加载失败或被取消：移除页签 (当前处在该页签发出的信号中，延后删除)
+        ui->tabWidget->removeTab(index);
+        sheet->deleteLater();
+        ui->statusLabel->setText("加载文件失败或已取消: " + filePath);
+        updateButtonsState();
     }
 }
 
@@ -192,15 +251,46 @@ void WT_DataWidget::loadData(const QString& filePath, const QString& fileType)
 }
 
 void WT_DataWidget::onSave() {
-    QJsonArray allData;
-    for (int i = 0; i < ui->tabWidget->count(); ++i) {
-        DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(ui->tabWidget->widget(i));
-        if (sheet) {
-            allData.append(sheet->saveToJson());
+    if (!ModelParameter::instance()->isSectionLoaded(ModelParameter::TableSection)) {
+        QMessageBox msgBox(this);
+        msgBox.setWindowTitle("保存");
+        msgBox.setText("项目表格数据仍在加载，请稍后再保存。");
+        msgBox.setIcon(QMessageBox::Information);
+        msgBox.addButton(QMessageBox::Ok);
+        applyDataDialogStyle(&msgBox);
+        msgBox.exec();
+        return;
+    }
+    const QList<DataSingleSheet*> saved = savableSheets();
+    QVector<int> previousIndex;
+    QVector<ProjectTableStore::SheetData> sheets;
+    for (DataSingleSheet* sheet : saved) previousIndex.append(sheet->storeIndex());
+
+    const QString storePath = ModelParameter::instance()->getTableStoreFilePath();
+    bool unchanged = !storePath.isEmpty() && storePath == m_storePath
+                     && saved.size() == m_storeSheetCount && QFile::exists(storePath);
+    for (int i = 0; unchanged && i < saved.size(); ++i)
+        unchanged = (previousIndex[i] == i);
+
+    if (!storePath.isEmpty() && !unchanged) {
+        for (DataSingleSheet* sheet : saved) sheets.append(sheet->saveToStore());
+        // 写入会替换 _date.bin，先释放各页签对旧文件 (映射) 的引用；压缩块已复制到 sheets
+        for (DataSingleSheet* sheet : saved) sheet->releaseStore();
+        const bool written = ProjectTableStore::write(storePath, sheets);
+
+        QSharedPointer<ProjectTableStore> store = ProjectTableStore::open(storePath);
+        m_storePath.clear();
+        m_storeSheetCount = -1;
+        if (store) {
+            // 写入成功时各页签与新文件一致；失败时旧文件未变，仅原先一致的页签重新关联
+            for (int i = 0; i < saved.size(); ++i) {
+                if (written) saved[i]->attachStore(store, i);
+                else if (previousIndex[i] >= 0) saved[i]->attachStore(store, previousIndex[i]);
+            }
+            m_storePath = storePath;
+            m_storeSheetCount = store->sheetCount();
         }
     }
-
-    ModelParameter::instance()->saveTableData(allData);
     ModelParameter::instance()->saveProject();
 
     // [修改] 使用 QMessageBox 对象替代静态调用，以便应用样式
@@ -215,6 +305,32 @@ void WT_DataWidget::onSave() {
 
 void WT_DataWidget::loadFromProjectData() {
     clearAllData();
+
+    // 二进制表格文件：只读取索引，各页签在首次显示时解压
+    const QString storePath = ModelParameter::instance()->getTableStoreFilePath();
+    if (!storePath.isEmpty() && QFile::exists(storePath)) {
+        QSharedPointer<ProjectTableStore> store = ProjectTableStore::open(storePath);
+        if (store) {
+            m_storePath = storePath;
+            m_storeSheetCount = store->sheetCount();
+        }
+        if (store && store->sheetCount() > 0) {
+            for (int i = 0; i < store->sheetCount(); ++i) {
+                DataSingleSheet* sheet = new DataSingleSheet(this);
+                sheet->loadFromStore(store, i);
+
+                QFileInfo fi(sheet->getFilePath());
+                ui->tabWidget->addTab(sheet, fi.fileName().isEmpty() ? "恢复数据" : fi.fileName());
+                connect(sheet, &DataSingleSheet::changesCommitted, this, &WT_DataWidget::onSheetChangesCommitted);
+            }
+            updateButtonsState();
+            ui->statusLabel->setText("数据已恢复");
+        } else {
+            ui->statusLabel->setText("无数据");
+        }
+        return;
+    }
+
     QJsonArray dataArray = ModelParameter::instance()->getTableData();
     if (dataArray.isEmpty()) {
         ui->statusLabel->setText("无数据");
@@ -239,7 +355,7 @@ void WT_DataWidget::loadFromProjectData() {
             QFileInfo fi(path);
             ui->tabWidget->addTab(sheet, fi.fileName().isEmpty() ? "恢复数据" : fi.fileName());
 
-            connect(sheet, &DataSingleSheet::dataChanged, this, &WT_DataWidget::onSheetDataChanged);
+            connect(sheet, &DataSingleSheet::changesCommitted, this, &WT_DataWidget::onSheetChangesCommitted);
         }
     } else {
         // 旧版兼容
@@ -260,7 +376,7 @@ void WT_DataWidget::loadFromProjectData() {
 
         sheet->loadFromJson(sheetObj);
         ui->tabWidget->addTab(sheet, "恢复数据");
-        connect(sheet, &DataSingleSheet::dataChanged, this, &WT_DataWidget::onSheetDataChanged);
+        connect(sheet, &DataSingleSheet::changesCommitted, this, &WT_DataWidget::onSheetChangesCommitted);
     }
 
     updateButtonsState();
@@ -269,6 +385,8 @@ void WT_DataWidget::loadFromProjectData() {
 
 void WT_DataWidget::clearAllData() {
     ui->tabWidget->clear();
+    m_storePath.clear();
+    m_storeSheetCount = -1;
     ui->filePathLabel->setText("未加载文件");
     ui->statusLabel->setText("无数据");
     updateButtonsState();
@@ -280,12 +398,28 @@ void WT_DataWidget::onDefineColumns() { if (auto s = currentSheet()) s->onDefine
 void WT_DataWidget::onTimeConvert() { if (auto s = currentSheet()) s->onTimeConvert(); }
 void WT_DataWidget::onPressureDropCalc() { if (auto s = currentSheet()) s->onPressureDropCalc(); }
 void WT_DataWidget::onCalcPwf() { if (auto s = currentSheet()) s->onCalcPwf(); }
+void WT_DataWidget::onExpressionColumn() { if (auto s = currentSheet()) s->onExpressionColumn(); }
 void WT_DataWidget::onHighlightErrors() { if (auto s = currentSheet()) s->onHighlightErrors(); }
 
+void WT_DataWidget::onFilterTextEdited(const QString& text) { if (auto s = currentSheet()) s->setFilterText(text); }
+
 void WT_DataWidget::onTabChanged(int index) {
     Q_UNUSED(index);
+    ui->filterEdit->setText(currentSheet() ? currentSheet()->filterText() : QString());
     updateButtonsState();
     emit dataChanged();
+    updateResidency();
+}
+
+void WT_DataWidget::updateResidency() {
+    SheetResidencyManager& residency = SheetResidencyManager::instance();
+    for (int i = 0; i < ui->tabWidget->count(); ++i) {
+        DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(ui->tabWidget->widget(i));
+        if (sheet && !sheet->isLoading()) residency.registerModel(sheet->getDataModel());
+    }
+    DataSingleSheet* sheet = currentSheet();
+    residency.setActive(sheet ? sheet->getDataModel() : nullptr);
+    residency.enforce();
 }
 
 void WT_DataWidget::onTabCloseRequested(int index) {
@@ -298,9 +432,10 @@ void WT_DataWidget::onTabCloseRequested(int index) {
     emit dataChanged();
 }
 
-void WT_DataWidget::onSheetDataChanged() {
-    if (sender() == currentSheet()) {
-        emit dataChanged();
-    }
+// 页签内容修改：只转发变更集，页签集合未变，无需重新交接数据模型
+void WT_DataWidget::onSheetChangesCommitted(const DataChangeSet& changes) {
+    DataSingleSheet* sheet = qobject_cast<DataSingleSheet*>(sender());
+    if (!sheet || sheet->isLoading()) return;
+    emit sheetDataChanged(sheet->getDataModel(), changes);
 }
 
@@ -7,17 +7,23 @@
  * 3. 协调顶部工具栏与当前活动页签的交互。
  * 4. 负责将所有页签数据同步保存到项目文件中。
  * 5. [保留优化] 提供了 getAllDataModels 接口，支持多文件数据传递。
+ * 6. [后台加载] 打开文件时立即创建页签并在后台加载，加载完成后才通知下游 (fileChanged / dataChanged 各一次)。
+ * 7. [增量保存] 记录页签关联的 _date.bin，页签均未修改时保存不重写该文件。
+ * 8. [自动备份] savableSheets 给出参与保存的页签，供 ProjectAutoSaver 取快照。
+ * 9. [变更合并] sheetDataChanged 转发各页签合并后的变更集。
+ * 10. [压缩驻留] 页签的数据模型登记到 SheetResidencyManager，不活动页签按内存预算与空闲时限在内存中压缩。
  */
 
 #ifndef WT_DATAWIDGET_H
 #define WT_DATAWIDGET_H
 
 #include <QWidget>
-#include <QStandardItemModel>
 #include <QJsonArray>
 #include <QMap>
 #include "datasinglesheet.h" // 包含单页类
 
+class QTimer;
+
 namespace Ui {
 class WT_DataWidget;
 }
@@ -37,10 +43,13 @@ public:
     void loadFromProjectData();
 
     // 获取当前活动页的模型（兼容旧接口）
-    QStandardItemModel* getDataModel() const;
+    ColumnarTableModel* getDataModel() const;
 
     // [保留功能] 获取所有已打开文件的数据模型 (用于多文件绘图/拟合选择)
-    QMap<QString, QStandardItemModel*> getAllDataModels() const;
+    QMap<QString, ColumnarTableModel*> getAllDataModels() const;
+
+    // 参与项目保存的页签 (按页签顺序，不含加载中的页签)
+    QList<DataSingleSheet*> savableSheets() const;
 
     // 加载指定文件数据
     void loadData(const QString& filePath, const QString& fileType = "auto");
@@ -52,7 +61,10 @@ public:
     bool hasData() const;
 
 signals:
+    // 页签集合变化 (打开、关闭、恢复、切换)
     void dataChanged();
+    // 页签内容修改 (每个页签每个事件循环周期最多一次)
+    void sheetDataChanged(ColumnarTableModel* model, const DataChangeSet& changes);
     void fileChanged(const QString& filePath, const QString& fileType);
 
 private slots:
@@ -66,12 +78,15 @@ private slots:
     void onTimeConvert();
     void onPressureDropCalc();
     void onCalcPwf();
+    void onExpressionColumn();
     void onHighlightErrors();
 
     // 状态
     void onTabChanged(int index);
+    void onFilterTextEdited(const QString& text);
     void onTabCloseRequested(int index);
-    void onSheetDataChanged();
+    void onSheetChangesCommitted(const DataChangeSet& changes);
+    void onSheetLoadFinished(bool success);
 
 private:
     Ui::WT_DataWidget *ui;
@@ -79,11 +94,19 @@ private:
     void initUI();
     void setupConnections();
     void updateButtonsState();
+    // 登记各页签的数据模型，解压当前页签并按预算压缩其余页签
+    void updateResidency();
 
     // 辅助函数：创建新页签
     void createNewTab(const QString& filePath, const DataImportSettings& settings);
     // 辅助函数：获取当前活动页签
     DataSingleSheet* currentSheet() const;
+
+    // 增量保存：各页签所关联的表格文件路径与其中的数据表数 (所有页签与之一致时不重写)
+    QString m_storePath;
+    int m_storeSheetCount = -1;
+
+    QTimer* m_residencyTimer = nullptr; // 定时检查不活动页签的空闲时限
 };
 
 #endif // WT_DATAWIDGET_H
@@ -8,6 +8,35 @@
  * - 移除 kf/km 和 omega1/omega2 的强制约束。
  * - 增加 rw 默认值处理。
  * 2. [修复] 保持 onIterationUpdate 中重绘抽样点的逻辑。
+ * 3. [性能优化] 敏感性分析模式下各取值的理论曲线改为一次批量计算 (calculateTheoreticalCurvesBatch)。
+ * 4. [变产量叠加] 降落试井数据选择产量列时按产量历史叠加计算理论曲线，预览与拟合一致。
+ * 5. [反褶积] 加载数据时可将变产量压力记录反褶积为等效定产量响应，作为观测数据拟合。
+ * 6. [自适应布点] 双对数图的理论曲线按曲率自适应选取时间点 (预算 300 点，见 adaptivecurvesampler.h)。
+ * 7. [批量拟合] 批量任务复制本页的观测数据、参数、权重、产量历史与抽样设置；回写结果时按任务模型切换参数表。
+ * 8. [参数不确定性] 拟合结束时取回参数不确定性；导出报告时仅当参数表仍为该次拟合结果 (未切换模型或手动修改) 才写入报告。
+ * 9. [分箱抽样] 抽样方式随抽样设置一起保存到项目 (samplingMode)，并复制到批量拟合任务。
+ * 10. [持久缓存] 拟合前为拟合核心指定项目的求值缓存与断点文件；存在未完成的同一分析时询问是否从上次的最优参数继续。
+ * 11. [平滑算法] 导数平滑按加载设置选择的方法 (移动平均 / Savitzky-Golay / 对数时间窗) 计算。
+ * 12. [列存储] 加载数据时直接读取数据模型的数值列。
+ * 13. [增量保存] getJsonState 的观测数据数组经 JsonVectorCache 编码，数据未变时不再逐元素转换。
+ * 14. [共享数据集] 观测数据改为 ObservedDataset 句柄，与拟合核心、绘图管理器及批量任务共享；
+ *    getJsonState 写入数据集缓存的 JSON 与其 id (observedDataId)，项目保存时同一数据集只写一份；
+ *    界面绘制的抽样点取自数据集上缓存的抽样视图，迭代刷新时不再重复抽样。
+ * 15. [硬件加速] 多窗口区域中的三个图表使用较低的 OpenGL 多重采样数；最小化的子窗口释放其 OpenGL 缓冲。
+ * 16. [分层重绘] 敏感性曲线经 FittingChart 加在模型层上；界面刷新只请求合并重绘，观测数据层不再随每次迭代重绘。
+ * 17. [异步预览] 滚轮调参改为向 ModelPreviewPipeline 提交请求 (后到者为准，旧请求协作取消)，先显示粗略曲线再替换为精细曲线；
+ *    参数换算与显示时间点提取为 prepareModelParams / displayTimeGrid，与同步刷新共用。
+ * 18. [后台导出] 拟合曲线与参数表经 DataExportService 写出 (csv / xlsx)，曲线数据在后台线程写出并可取消；
+ *    曲线导出完成后可经 viewExportedFile 在数据界面打开导出的文件。
+ * 19. [敏感性研究] 参数工具栏的 "敏感性研究..." 打开 SensitivityStudyDialog (全因子 / 拉丁超立方 / 龙卷风)；
+ *    参数表中有多个多值参数时按全因子组合绘制，经本页的 SensitivityStudy 并行计算并缓存，重复刷新不再计算。
+ * 20. [后台报告] 导出报告时界面线程只离屏绘制三个图表，图像编码与报告写出经 FittingReportGenerator 在后台进行 (可取消)。
+ * 21. [性能设置] 理论曲线的显示网格与自适应布点预算由预览质量设置给出 (150 / 300 / 600 点)。
+ * 22. [可复现拟合] 分析状态保存拟合核心的可复现模式与随机种子 (reproducibility)，重新打开后按原设置拟合；
+ *    批量任务同样复制该设置。
+ * 23. [投机预计算] 精细预览到达或同步刷新后界面空闲 200 ms，即为正在调节的参数向两侧各预计算 3 格滚轮取值
+ *    (取值规则与滚轮相同，经 prepareModelParams 换算)，之后的滚轮预览命中时立即显示；
+ *    换选参数或开始拟合时丢弃暂存结果，其他参数改变后旧结果因键不同在下一次预计算时被淘汰。
  */
 
 #include "wt_fittingwidget.h"
@@ -20,8 +49,14 @@
 #include "paramselectdialog.h"
 #include "fittingreport.h"
 #include "fittingchart.h"
+#include "deconvolution.h"
+#include "adaptivecurvesampler.h"
+#include "dataexportservice.h"
+#include "graphlod.h"
+#include "sensitivitystudydialog.h"
 
 #include <QMessageBox>
+#include <QApplication>
 #include <QDebug>
 #include <cmath>
 #include <QFileDialog>
@@ -34,6 +69,8 @@
 #include <QBuffer>
 #include <QFileInfo>
 #include <QDateTime>
+#include <QTimer>
+#include <algorithm>
 
 FittingWidget::FittingWidget(QWidget *parent) :
     QWidget(parent),
@@ -41,13 +78,17 @@ FittingWidget::FittingWidget(QWidget *parent) :
     m_modelManager(nullptr),
     m_core(new FittingCore(this)),
     m_chartManager(new FittingChart(this)),
+    m_preview(new ModelPreviewPipeline(m_core, this)),
     m_mdiArea(nullptr),
     m_chartLogLog(nullptr), m_chartSemiLog(nullptr), m_chartCartesian(nullptr),
     m_subWinLogLog(nullptr), m_subWinSemiLog(nullptr), m_subWinCartesian(nullptr),
     m_plotLogLog(nullptr), m_plotSemiLog(nullptr), m_plotCartesian(nullptr),
     m_currentModelType(ModelManager::Model_1),
+    m_observed(ObservedDataset::empty()),
     m_isFitting(false),
-    m_isCustomSamplingEnabled(false)
+    m_lastUncertaintyModel(ModelManager::Model_1),
+    m_isCustomSamplingEnabled(false),
+    m_samplingMode(Sampling_NearestPoint)
 {
     ui->setupUi(this);
 
@@ -78,6 +119,11 @@ FittingWidget::FittingWidget(QWidget *parent) :
     m_plotSemiLog = m_chartSemiLog->getPlot();
     m_plotCartesian = m_chartCartesian->getPlot();
 
+    // 三个子窗口同屏，各自持有 OpenGL 上下文与缓冲：降低多重采样数，4K 屏幕下显存占用约为默认的一半
+    m_plotLogLog->setOpenGlSamples(4);
+    m_plotSemiLog->setOpenGlSamples(4);
+    m_plotCartesian->setOpenGlSamples(4);
+
     m_chartLogLog->setTitle("双对数曲线 (Log-Log)");
     m_chartSemiLog->setTitle("半对数曲线 (Semi-Log)");
     m_chartCartesian->setTitle("历史拟合曲线 (History Plot)");
@@ -96,9 +142,14 @@ FittingWidget::FittingWidget(QWidget *parent) :
     ui->splitter->setCollapsible(0, false);
 
     m_paramChart = new FittingParameterChart(ui->tableParams, this);
-    connect(m_paramChart, &FittingParameterChart::parameterChangedByWheel, this, [this](){
-        updateModelCurve(nullptr);
-    });
+    connect(m_paramChart, &FittingParameterChart::parameterChangedByWheel, this, &FittingWidget::onParameterWheelChanged);
+    connect(m_preview, &ModelPreviewPipeline::previewReady, this, &FittingWidget::onPreviewReady);
+    connect(m_paramChart, &FittingParameterChart::activeParameterChanged, this, &FittingWidget::onActiveParameterChanged);
+
+    m_speculationTimer = new QTimer(this);
+    m_speculationTimer->setSingleShot(true);
+    m_speculationTimer->setInterval(200);
+    connect(m_speculationTimer, &QTimer::timeout, this, &FittingWidget::onSpeculationIdle);
 
     setupPlot();
     m_chartManager->initializeCharts(m_plotLogLog, m_plotSemiLog, m_plotCartesian);
@@ -114,6 +165,12 @@ FittingWidget::FittingWidget(QWidget *parent) :
     connect(ui->sliderWeight, &QSlider::valueChanged, this, &FittingWidget::onSliderWeightChanged);
     connect(ui->btnSamplingSettings, &QPushButton::clicked, this, &FittingWidget::onOpenSamplingSettings);
 
+    // [敏感性研究] 参数工具栏增加入口
+    QPushButton* btnStudy = new QPushButton("敏感性研究...", this);
+    btnStudy->setToolTip("在当前参数附近做多参数网格、拉丁超立方或龙卷风敏感性研究");
+    ui->horizontalLayout_ParamTools->addWidget(btnStudy);
+    connect(btnStudy, &QPushButton::clicked, this, &FittingWidget::onSensitivityStudy);
+
     ui->sliderWeight->setRange(0, 100);
     ui->sliderWeight->setValue(50);
     onSliderWeightChanged(50);
@@ -135,11 +192,11 @@ void FittingWidget::setModelManager(ModelManager *m)
 {
     m_modelManager = m;
     m_paramChart->setModelManager(m);
-    if (m_core) m_core->setModelManager(m);
+    if (m_core) m_core->setModelEngine(m ? m->engine() : nullptr);
     initializeDefaultModel();
 }
 
-void FittingWidget::setProjectDataModels(const QMap<QString, QStandardItemModel *> &models)
+void FittingWidget::setProjectDataModels(const QMap<QString, ColumnarTableModel *> &models)
 {
     m_dataMap = models;
 }
@@ -194,13 +251,15 @@ void FittingWidget::setObservedData(const QVector<double>& t, const QVector<doub
 void FittingWidget::setObservedData(const QVector<double>& t, const QVector<double>& deltaP,
                                     const QVector<double>& d, const QVector<double>& rawP)
 {
-    m_obsTime = t;
-    m_obsDeltaP = deltaP;
-    m_obsDerivative = d;
-    m_obsRawP = rawP;
+    setObservedDataset(ObservedDataset::create(t, deltaP, d, rawP));
+}
+
+void FittingWidget::setObservedDataset(const ObservedDataset::Handle& dataset)
+{
+    m_observed = dataset ? dataset : ObservedDataset::empty();
 
-    if (m_core) m_core->setObservedData(t, deltaP, d);
-    if (m_chartManager) m_chartManager->setObservedData(t, deltaP, d, rawP);
+    if (m_core) m_core->setObservedDataset(m_observed);
+    if (m_chartManager) m_chartManager->setObservedDataset(m_observed);
 
     updateModelCurve();
 }
@@ -210,35 +269,35 @@ void FittingWidget::on_btnLoadData_clicked() {
     if (dlg.exec() != QDialog::Accepted) return;
 
     FittingDataSettings settings = dlg.getSettings();
-    QStandardItemModel* sourceModel = dlg.getPreviewModel();
+    ColumnarTableModel* sourceModel = dlg.getPreviewModel();
 
     if (!sourceModel || sourceModel->rowCount() == 0) {
         QMessageBox::warning(this, "警告", "所选数据源为空，无法加载！");
         return;
     }
 
-    QVector<double> rawTime, rawPressureData, finalDeriv;
+    QVector<double> rawTime, rawPressureData, finalDeriv, rawRate;
     int skip = settings.skipRows;
     int rows = sourceModel->rowCount();
 
-    for (int i = skip; i < rows; ++i) {
-        QStandardItem* itemT = sourceModel->item(i, settings.timeColIndex);
-        QStandardItem* itemP = sourceModel->item(i, settings.pressureColIndex);
-
-        if (itemT && itemP) {
-            bool okT, okP;
-            double t = itemT->text().toDouble(&okT);
-            double p = itemP->text().toDouble(&okP);
-
-            if (okT && okP && t > 0) {
-                rawTime.append(t);
-                rawPressureData.append(p);
-                if (settings.derivColIndex >= 0) {
-                    QStandardItem* itemD = sourceModel->item(i, settings.derivColIndex);
-                    if (itemD) finalDeriv.append(itemD->text().toDouble());
-                    else finalDeriv.append(0.0);
-                }
-            }
+    // 直接读取数值列 (文本与空单元格为 NaN；导数、产量列中按 0 处理)
+    const ColumnarTableModel::ColumnSpan colT = sourceModel->columnSpan(settings.timeColIndex);
+    const ColumnarTableModel::ColumnSpan colP = sourceModel->columnSpan(settings.pressureColIndex);
+    const ColumnarTableModel::ColumnSpan colD = sourceModel->columnSpan(settings.derivColIndex);
+    const ColumnarTableModel::ColumnSpan colQ = sourceModel->columnSpan(settings.rateColIndex);
+    auto cellOrZero = [](const ColumnarTableModel::ColumnSpan& col, int i) {
+        return (i < col.size && !std::isnan(col[i])) ? col[i] : 0.0;
+    };
+
+    for (int i = skip; i < rows && i < colT.size && i < colP.size; ++i) {
+        double t = colT[i];
+        double p = colP[i];
+
+        if (!std::isnan(t) && !std::isnan(p) && t > 0) {
+            rawTime.append(t);
+            rawPressureData.append(p);
+            if (settings.derivColIndex >= 0) finalDeriv.append(cellOrZero(colD, i));
+            if (settings.rateColIndex >= 0) rawRate.append(cellOrZero(colQ, i));
         }
     }
 
@@ -263,20 +322,61 @@ void FittingWidget::on_btnLoadData_clicked() {
     if (settings.derivColIndex == -1) {
         finalDeriv = PressureDerivativeCalculator::calculateBourdetDerivative(rawTime, finalDeltaP, settings.lSpacing);
         if (settings.enableSmoothing) {
-            finalDeriv = PressureDerivativeCalculator1::smoothData(finalDeriv, settings.smoothingSpan);
+            finalDeriv = DerivativeSmoother::smooth(rawTime, finalDeriv,
+                DerivativeSmoother::options(settings.smoothingMethod, settings.smoothingSpan));
         }
     } else {
         if (settings.enableSmoothing) {
-            finalDeriv = PressureDerivativeCalculator1::smoothData(finalDeriv, settings.smoothingSpan);
+            finalDeriv = DerivativeSmoother::smooth(rawTime, finalDeriv,
+                DerivativeSmoother::options(settings.smoothingMethod, settings.smoothingSpan));
         }
         if (finalDeriv.size() != rawTime.size()) {
             finalDeriv.resize(rawTime.size());
         }
     }
 
+    // 变产量叠加：降落试井的产量列与时间列共用时间原点 (恢复试井缺少关井前的产量历史，仍按定产量计算)
+    RateHistory rateHistory;
+    if (settings.testType == Test_Drawdown && !rawRate.isEmpty()) {
+        rateHistory = RateHistory::fromSamples(rawTime, rawRate);
+    }
+
+    // 反褶积：以等效定产量响应替代原始记录作为观测数据，失败时退回变产量叠加
+    if (settings.enableDeconvolution && rateHistory.size() > 1) {
+        DeconvolutionSettings deconv;
+        deconv.initialPressure = settings.initialPressure;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        DeconvolutionResult result = PressureRateDeconvolution::run(rawTime, rawPressureData, rateHistory, deconv);
+        QApplication::restoreOverrideCursor();
+        if (result.success) {
+            QVector<double> equivalentP(result.deltaP.size());
+            for (int i = 0; i < result.deltaP.size(); ++i) equivalentP[i] = result.initialPressure - result.deltaP[i];
+            if (m_core) m_core->clearRateHistory();
+            m_chartManager->setSettings(settings);
+            setObservedData(result.tau, result.deltaP, result.derivative, equivalentP);
+            QMessageBox::information(this, "成功",
+                QString("反褶积完成：%1 个原始点压缩为 %2 个，初始压力 %3，压力残差均方根 %4。\n"
+                        "观测数据为参考产量 %5 下的等效定产量响应，拟合时请将产量参数 q 设为该值。")
+                    .arg(rawTime.size()).arg(result.observationsUsed)
+                    .arg(result.initialPressure, 0, 'f', 4).arg(result.rmsResidual, 0, 'g', 3)
+                    .arg(result.referenceRate, 0, 'g', 6));
+            return;
+        }
+        QMessageBox::warning(this, "警告", "反褶积失败：" + result.errorMessage + "\n将按变产量叠加处理原始数据。");
+    }
+
+    if (m_core) {
+        if (rateHistory.size() > 1) m_core->setRateHistory(rateHistory, false);
+        else m_core->clearRateHistory();
+    }
+
     m_chartManager->setSettings(settings);
     setObservedData(rawTime, finalDeltaP, finalDeriv, rawPressureData);
-    QMessageBox::information(this, "成功", "观测数据已成功加载。");
+    if (rateHistory.size() > 1) {
+        QMessageBox::information(this, "成功", QString("观测数据已成功加载，已启用变产量叠加 (%1 个产量阶段)。").arg(rateHistory.size()));
+    } else {
+        QMessageBox::information(this, "成功", "观测数据已成功加载。");
+    }
 }
 
 void FittingWidget::onSliderWeightChanged(int value)
@@ -304,40 +404,108 @@ void FittingWidget::on_btnSelectParams_clicked()
 
 void FittingWidget::onOpenSamplingSettings()
 {
-    if (m_obsTime.isEmpty()) {
+    if (m_observed->isEmpty()) {
         QMessageBox::warning(this, "提示", "请先加载观测数据，以便确定时间范围。");
         return;
     }
-    double tMin = m_obsTime.first();
-    double tMax = m_obsTime.last();
+    double tMin = m_observed->time().first();
+    double tMax = m_observed->time().last();
 
     SamplingSettingsDialog dlg(m_customIntervals, m_isCustomSamplingEnabled, tMin, tMax, this);
+    dlg.setSamplingMode(m_samplingMode);
     if (dlg.exec() == QDialog::Accepted) {
         m_customIntervals = dlg.getIntervals();
         m_isCustomSamplingEnabled = dlg.isCustomSamplingEnabled();
-        if(m_core) m_core->setSamplingSettings(m_customIntervals, m_isCustomSamplingEnabled);
+        m_samplingMode = dlg.samplingMode();
+        if(m_core) {
+            m_core->setSamplingSettings(m_customIntervals, m_isCustomSamplingEnabled);
+            m_core->setSamplingMode(m_samplingMode);
+        }
         updateModelCurve();
     }
 }
 
 void FittingWidget::on_btnRunFit_clicked() {
     if(m_isFitting) return;
-    if(m_obsTime.isEmpty()) {
+    if(m_observed->isEmpty()) {
         QMessageBox::warning(this,"错误","请先加载观测数据。");
         return;
     }
 
     m_paramChart->updateParamsFromTable();
-    m_isFitting = true;
-    ui->btnRunFit->setEnabled(false);
 
     ModelManager::ModelType modelType = m_currentModelType;
     QList<FitParameter> paramsCopy = m_paramChart->getParameters();
     double w = ui->sliderWeight->value() / 100.0;
 
+    // 项目级求值缓存与断点；上次同一分析未正常结束时可从其最优参数继续
+    if (m_core) {
+        ModelParameter* mp = ModelParameter::instance();
+        m_core->setPersistence(mp->getFitCacheFilePath(), mp->getFitStateFilePath());
+        FitCheckpoint cp = m_core->resumableCheckpoint(modelType, paramsCopy, w);
+        if (cp.valid) {
+            QString text = QString("检测到上次未完成的拟合 (%1，误差 %2)。\n是否从上次的最优参数继续拟合？")
+                               .arg(cp.time.toString("yyyy-MM-dd hh:mm:ss")).arg(cp.error, 0, 'g', 4);
+            if (QMessageBox::question(this, "继续拟合", text) == QMessageBox::Yes) {
+                for (auto& p : paramsCopy) {
+                    if (p.isFit && cp.params.contains(p.name)) p.value = cp.params.value(p.name);
+                }
+                m_paramChart->setParameters(paramsCopy);
+            }
+        }
+    }
+
+    m_isFitting = true;
+    m_preview->cancel(); // 未完成的滚轮预览不再覆盖拟合过程中的曲线
+    m_speculationTimer->stop();
+    m_preview->clearSpeculation();
+    ui->btnRunFit->setEnabled(false);
+
+    m_lastUncertainty = FitUncertainty();
+    m_lastUncertaintyModel = modelType;
     if(m_core) m_core->startFit(modelType, paramsCopy, w);
 }
 
+ModelManager::ModelType FittingWidget::currentModelType() const {
+    return m_currentModelType;
+}
+
+bool FittingWidget::createFittingJob(ModelManager::ModelType type, FittingJob& job) {
+    if(m_observed->isEmpty()) return false;
+
+    m_paramChart->updateParamsFromTable();
+    QList<FitParameter> params = m_paramChart->getParameters();
+    job.modelType = type;
+    job.params = (type == m_currentModelType) ? params : FittingParameterChart::adaptParameters(params, type);
+    job.weight = ui->sliderWeight->value() / 100.0;
+    job.observed = m_observed;
+    if (m_core && m_core->hasRateHistory()) {
+        job.rateHistory = m_core->rateHistory();
+        job.rateHistoryBuildup = m_core->isRateHistoryBuildup();
+    }
+    job.samplingIntervals = m_customIntervals;
+    job.customSampling = m_isCustomSamplingEnabled;
+    job.samplingMode = m_samplingMode;
+    if (m_core) job.reproducibility = m_core->reproducibility();
+    return true;
+}
+
+void FittingWidget::applyFittingResult(const FittingJob& job) {
+    if(m_isFitting || job.result.isEmpty()) return;
+
+    if (job.modelType != m_currentModelType) {
+        m_paramChart->switchModel(job.modelType);
+        m_currentModelType = job.modelType;
+        ui->btn_modelSelect->setText("当前: " + ModelManager::getModelTypeName(m_currentModelType));
+    }
+    QList<FitParameter> params = m_paramChart->getParameters();
+    for (auto& p : params) {
+        if (job.result.contains(p.name)) p.value = job.result.value(p.name);
+    }
+    m_paramChart->setParameters(params);
+    updateModelCurve();
+}
+
 void FittingWidget::on_btnStop_clicked() {
     if(m_core) m_core->stopFit();
 }
@@ -381,150 +549,367 @@ void FittingWidget::on_btn_modelSelect_clicked() {
     }
 }
 
-// [核心修正] 与 WT_ModelWidget 的参数预处理逻辑完全对齐
-void FittingWidget::updateModelCurve(const QMap<QString, double>* explicitParams) {
-    if(!m_modelManager) {
-        QMessageBox::critical(this, "错误", "ModelManager 未初始化！");
-        return;
-    }
-    ui->tableParams->clearFocus();
-
+// 当前参数表 (或 explicitParams) 换算为求解器参数：LfD、M12 映射与井储 C -> cD；多值文本的第一个值作为基准值
+QMap<QString, double> FittingWidget::prepareModelParams(const QMap<QString, double>* explicitParams,
+                                                       QString& sensitivityKey, QVector<double>& sensitivityValues,
+                                                       QMap<QString, QVector<double>>* multiValued) const
+{
     QMap<QString, double> baseParams;
-    QString sensitivityKey = "";
-    QVector<double> sensitivityValues;
+    sensitivityKey.clear();
+    sensitivityValues.clear();
+    if (multiValued) multiValued->clear();
 
     if (explicitParams) {
         baseParams = *explicitParams;
     } else {
-        QList<FitParameter> allParams = m_paramChart->getParameters();
-        for(const auto& p : allParams) baseParams.insert(p.name, p.value);
-
-        QMap<QString, QString> rawTexts = m_paramChart->getRawParamTexts();
-        for(auto it = rawTexts.begin(); it != rawTexts.end(); ++it) {
-            QVector<double> vals = parseSensitivityValues(it.value());
-            if (!vals.isEmpty()) {
-                baseParams.insert(it.key(), vals.first());
-                if (vals.size() > 1 && sensitivityKey.isEmpty()) {
-                    sensitivityKey = it.key();
-                    sensitivityValues = vals;
-                }
-            } else {
-                baseParams.insert(it.key(), 0.0);
-            }
-        }
+        baseParams = tableParams(sensitivityKey, sensitivityValues, multiValued);
     }
 
     // 1. [修正] 移除旧的约束 (kf <= km 等)，因为模型界面没有这些约束
     // 原来的 if(kf <= km) ... 代码块已删除
 
-    // 2. [对齐] 计算 LfD
-    if(baseParams.contains("L") && baseParams.contains("Lf") && baseParams["L"] > 1e-9)
-        baseParams["LfD"] = baseParams["Lf"] / baseParams["L"];
-    else
-        baseParams["LfD"] = 0.0;
-
-    // 3. [对齐] 处理 M12 映射 (WT_ModelWidget 中 UI kmEdit 对应参数 M12)
+    // 2. [对齐] 处理 M12 映射 (WT_ModelWidget 中 UI kmEdit 对应参数 M12)
     // 如果参数表里只有 km 而没有 M12，则视为 M12
     if (!baseParams.contains("M12") && baseParams.contains("km")) {
         baseParams["M12"] = baseParams["km"];
     }
 
-    // 4. [对齐] 处理井筒储集转换 (C -> cD)
+    // 3. [对齐] LfD 与井筒储集转换 (C -> cD)
+    applyDerivedParams(baseParams);
+
+    return baseParams;
+}
+
+QMap<QString, double> FittingWidget::tableParams(QString& sensitivityKey, QVector<double>& sensitivityValues,
+                                                QMap<QString, QVector<double>>* multiValued) const
+{
+    QMap<QString, double> baseParams;
+    sensitivityKey.clear();
+    sensitivityValues.clear();
+    if (multiValued) multiValued->clear();
+
+    QList<FitParameter> allParams = m_paramChart->getParameters();
+    for(const auto& p : allParams) baseParams.insert(p.name, p.value);
+
+    QMap<QString, QString> rawTexts = m_paramChart->getRawParamTexts();
+    for(auto it = rawTexts.begin(); it != rawTexts.end(); ++it) {
+        QVector<double> vals = parseSensitivityValues(it.value());
+        if (!vals.isEmpty()) {
+            baseParams.insert(it.key(), vals.first());
+            if (vals.size() > 1 && sensitivityKey.isEmpty()) {
+                sensitivityKey = it.key();
+                sensitivityValues = vals;
+            }
+            if (vals.size() > 1 && multiValued) multiValued->insert(it.key(), vals);
+        } else {
+            baseParams.insert(it.key(), 0.0);
+        }
+    }
+    return baseParams;
+}
+
+void FittingWidget::applyDerivedParams(QMap<QString, double>& params) const
+{
+    if(params.contains("L") && params.contains("Lf") && params["L"] > 1e-9)
+        params["LfD"] = params["Lf"] / params["L"];
+    else
+        params["LfD"] = 0.0;
+
     // WT_ModelWidget 中：ui->cDEdit (单位 m3/MPa) -> 转换为无因次 cD
     // 公式：cD = 0.159 * C / (phi * h * Ct * rw^2)
     // 只有当模型支持井储时才计算，否则为 0
     ModelManager::ModelType type = m_currentModelType;
     bool hasStorage = (type == ModelManager::Model_1 || type == ModelManager::Model_3 || type == ModelManager::Model_5);
 
-    if (hasStorage && baseParams.contains("C")) {
-        double phi = baseParams.value("phi", 0.05);
-        double Ct = baseParams.value("Ct", 5e-4);
-        double h = baseParams.value("h", 20.0);
-        double rw = baseParams.value("rw", 0.1); // 默认 rw = 0.1，与 ModelWidget 一致
+    if (hasStorage && params.contains("C")) {
+        double phi = params.value("phi", 0.05);
+        double Ct = params.value("Ct", 5e-4);
+        double h = params.value("h", 20.0);
+        double rw = params.value("rw", 0.1); // 默认 rw = 0.1，与 ModelWidget 一致
 
-        double valC = baseParams["C"];
         double denom = phi * h * Ct * rw * rw;
-        double cD = 0.0;
-        if (denom > 1e-20) cD = 0.159 * valC / denom;
-
-        baseParams["cD"] = cD;
+        params["cD"] = denom > 1e-20 ? 0.159 * params["C"] / denom : 0.0;
     } else if (!hasStorage) {
         // 对于不支持井储的模型，强制为 0
-        baseParams["cD"] = 0.0;
-        baseParams["S"] = 0.0;
+        params["cD"] = 0.0;
+        params["S"] = 0.0;
     }
-    // 如果 baseParams 已经包含 cD (用户直接输入无因次)，则不做覆盖，保持原样
+    // 如果参数已经包含 cD (用户直接输入无因次)，则不做覆盖，保持原样
+}
 
+QSharedPointer<SensitivityStudy> FittingWidget::sensitivityStudy(const QVector<double>& t)
+{
+    const SolverSettings settings = m_modelManager->solverSettings();
+    if (!m_study || m_study->modelType() != m_currentModelType || m_study->times() != t || m_study->settings() != settings) {
+        m_study = QSharedPointer<SensitivityStudy>::create(m_core, m_currentModelType, settings, t,
+                                                           [this](QMap<QString, double>& params) { applyDerivedParams(params); });
+    }
+    return m_study;
+}
+
+// 显示理论曲线的时间点：观测点多于点数预算 (预览质量设置，标准为 300) 时取观测范围内的对数网格
+QVector<double> FittingWidget::displayTimeGrid() const
+{
     QVector<double> targetT;
-    if (m_obsTime.size() > 300) {
-        double tMin = m_obsTime.first() > 1e-5 ? m_obsTime.first() : 1e-5;
-        double tMax = m_obsTime.last();
-        targetT = ModelManager::generateLogTimeSteps(300, log10(tMin), log10(tMax));
-    } else if (!m_obsTime.isEmpty()) {
-        targetT = m_obsTime;
+    const QVector<double>& obsTime = m_observed->time();
+    const int budget = AdaptiveCurveSampler::previewPointBudget();
+    if (obsTime.size() > budget) {
+        double tMin = obsTime.first() > 1e-5 ? obsTime.first() : 1e-5;
+        double tMax = obsTime.last();
+        targetT = ModelManager::generateLogTimeSteps(budget, log10(tMin), log10(tMax));
+    } else if (!obsTime.isEmpty()) {
+        targetT = obsTime;
     } else {
         for(double e = -4; e <= 4; e += 0.1) targetT.append(pow(10, e));
     }
+    return targetT;
+}
+
+// [核心修正] 与 WT_ModelWidget 的参数预处理逻辑完全对齐
+void FittingWidget::updateModelCurve(const QMap<QString, double>* explicitParams) {
+    if(!m_modelManager) {
+        QMessageBox::critical(this, "错误", "ModelManager 未初始化！");
+        return;
+    }
+    ui->tableParams->clearFocus();
+    // 同步刷新：之前提交的异步预览结果作废
+    if (m_preview) m_preview->cancel();
+
+    QString sensitivityKey;
+    QVector<double> sensitivityValues;
+    QMap<QString, QVector<double>> multiValued;
+    QMap<QString, double> baseParams = prepareModelParams(explicitParams, sensitivityKey, sensitivityValues, &multiValued);
+    ModelManager::ModelType type = m_currentModelType;
+    const QVector<double> targetT = displayTimeGrid();
+
+    // 显示曲线：自适应布点时在目标时间范围内按曲率加密，否则直接在目标时间点上计算
+    // (变产量叠加每次求值都需重算整条单位响应，逐轮加密并不省时，仍在目标时间点上一次计算)
+    auto calculateDisplayCurves = [&](const QVector<QMap<QString, double>>& paramSets) {
+        auto evaluate = [&](const QVector<double>& times) {
+            return m_core ? m_core->calculateModelCurves(type, m_modelManager->solverSettings(), paramSets, times)
+                          : m_modelManager->calculateTheoreticalCurvesBatch(type, paramSets, times);
+        };
+        QVector<ModelCurveData> curves;
+        if (AdaptiveCurveSampler::isEnabledInSettings() && targetT.size() > 1 && !(m_core && m_core->hasRateHistory())) {
+            AdaptiveSamplingOptions sampling;
+            sampling.maxPoints = AdaptiveCurveSampler::previewPointBudget();
+            curves = AdaptiveCurveSampler::sample(evaluate, *std::min_element(targetT.constBegin(), targetT.constEnd()),
+                                                  *std::max_element(targetT.constBegin(), targetT.constEnd()), sampling);
+        }
+        if (curves.isEmpty()) curves = evaluate(targetT);
+        return curves;
+    };
 
     bool isSensitivityMode = !sensitivityKey.isEmpty();
     ui->btnRunFit->setEnabled(!isSensitivityMode);
 
-    if (isSensitivityMode) {
+    if (multiValued.size() > 1 && m_core) {
+        // 多个多值参数：全因子网格，经敏感性研究并行计算并缓存 (再次刷新相同组合时不再计算)
+        QList<SensitivityFactor> factors;
+        for (auto it = multiValued.constBegin(); it != multiValued.constEnd(); ++it) {
+            SensitivityFactor factor;
+            factor.name = it.key();
+            factor.values = it.value();
+            factors.append(factor);
+        }
+        const int total = SensitivityStudy::fullFactorialSize(factors);
+        if (total > SensitivityStudy::MaxCases) {
+            QMessageBox::warning(this, "提示", QString("多值参数的组合数超过 %1，请减少取值个数。").arg(SensitivityStudy::MaxCases));
+            return;
+        }
+        ui->label_Error->setText(QString("敏感性分析模式: %1 (%2 个组合)").arg(QStringList(multiValued.keys()).join(" × ")).arg(total));
+        m_chartManager->plotAll(QVector<double>(), QVector<double>(), QVector<double>(), false);
+        m_chartManager->clearSampledPoints();
+
+        QSharedPointer<SensitivityStudy> study = sensitivityStudy(targetT);
+        const QVector<SensitivityCase> cases = study->fullFactorial(baseParams, factors);
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        const QVector<ModelCurveData> curves = study->evaluate(cases);
+        QApplication::restoreOverrideCursor();
+
+        QList<QColor> colors = { Qt::red, Qt::blue, QColor(0,180,0), Qt::magenta, QColor(255,140,0), Qt::cyan, Qt::darkRed, Qt::darkBlue };
+        for (int i = 0; i < curves.size(); ++i) {
+            const ModelCurveData& res = curves[i];
+            QStringList parts;
+            for (auto it = cases[i].factors.constBegin(); it != cases[i].factors.constEnd(); ++it)
+                parts << QString("%1=%2").arg(it.key()).arg(it.value());
+            const QString suffix = parts.join(", ");
+            QColor c = colors[i % colors.size()];
+
+            QCPGraph* gP = m_chartManager->addSensitivityGraph();
+            gP->setData(std::get<0>(res), std::get<1>(res));
+            gP->setPen(QPen(c, 2)); gP->setName("P: "+suffix);
+
+            QCPGraph* gD = m_chartManager->addSensitivityGraph();
+            gD->setData(std::get<0>(res), std::get<2>(res));
+            gD->setPen(QPen(c, 2, Qt::DashLine)); gD->setName("P': "+suffix);
+        }
+        m_chartManager->requestReplot();
+    } else if (isSensitivityMode) {
         ui->label_Error->setText(QString("敏感性分析模式: %1 (%2 个值)").arg(sensitivityKey).arg(sensitivityValues.size()));
-        m_plotLogLog->clearGraphs();
         m_chartManager->plotAll(QVector<double>(), QVector<double>(), QVector<double>(), false);
+        m_chartManager->clearSampledPoints();
 
         QList<QColor> colors = { Qt::red, Qt::blue, QColor(0,180,0), Qt::magenta, QColor(255,140,0), Qt::cyan, Qt::darkRed, Qt::darkBlue };
+        QVector<QMap<QString, double>> paramSets;
         for(int i = 0; i < sensitivityValues.size(); ++i) {
             double val = sensitivityValues[i];
             QMap<QString, double> currentParams = baseParams;
             currentParams[sensitivityKey] = val;
 
-            // 联动更新 LfD
-            if (sensitivityKey == "L" || sensitivityKey == "Lf") {
-                if(currentParams["L"] > 1e-9) currentParams["LfD"] = currentParams["Lf"] / currentParams["L"];
-            }
-            // 重新计算 cD (如果敏感性参数是 C, phi 等)
-            if (hasStorage && (sensitivityKey == "C" || sensitivityKey == "phi" || sensitivityKey == "h" || sensitivityKey == "Ct" || sensitivityKey == "rw")) {
-                double phi = currentParams.value("phi", 0.05);
-                double Ct = currentParams.value("Ct", 5e-4);
-                double h = currentParams.value("h", 20.0);
-                double rw = currentParams.value("rw", 0.1);
-                double valC = currentParams.value("C", 0.0);
-                double denom = phi * h * Ct * rw * rw;
-                if (denom > 1e-20) currentParams["cD"] = 0.159 * valC / denom;
-                else currentParams["cD"] = 0.0;
-            }
+            // 联动更新 LfD 与 cD (直接给出多个 cD 时保持输入值)
+            if (sensitivityKey != "cD") applyDerivedParams(currentParams);
 
-            ModelCurveData res = m_modelManager->calculateTheoreticalCurve(type, currentParams, targetT);
+            paramSets.append(currentParams);
+        }
+
+        // 全部取值一次批量计算，再逐条绘制
+        QVector<ModelCurveData> curves = calculateDisplayCurves(paramSets);
+        for(int i = 0; i < curves.size(); ++i) {
+            double val = sensitivityValues[i];
+            const ModelCurveData& res = curves[i];
             QColor c = colors[i % colors.size()];
             QString suffix = QString("%1=%2").arg(sensitivityKey).arg(val);
 
-            QCPGraph* gP = m_plotLogLog->addGraph();
+            QCPGraph* gP = m_chartManager->addSensitivityGraph();
             gP->setData(std::get<0>(res), std::get<1>(res));
             gP->setPen(QPen(c, 2)); gP->setName("P: "+suffix);
 
-            QCPGraph* gD = m_plotLogLog->addGraph();
+            QCPGraph* gD = m_chartManager->addSensitivityGraph();
             gD->setData(std::get<0>(res), std::get<2>(res));
             gD->setPen(QPen(c, 2, Qt::DashLine)); gD->setName("P': "+suffix);
         }
-        m_plotLogLog->replot();
+        m_chartManager->requestReplot();
     } else {
-        ModelCurveData res = m_modelManager->calculateTheoreticalCurve(type, baseParams, targetT);
+        QVector<ModelCurveData> displayCurves = calculateDisplayCurves(QVector<QMap<QString, double>>() << baseParams);
+        ModelCurveData res = displayCurves.isEmpty() ? ModelCurveData() : displayCurves.first();
         m_chartManager->plotAll(std::get<0>(res), std::get<1>(res), std::get<2>(res), true);
 
-        if (!m_obsTime.isEmpty() && m_core) {
+        if (!m_observed->isEmpty() && m_core) {
             QVector<double> sampleT, sampleP, sampleD;
-            m_core->getLogSampledData(m_obsTime, m_obsDeltaP, m_obsDerivative, sampleT, sampleP, sampleD);
+            m_core->getSampledObservedData(sampleT, sampleP, sampleD);
 
             QVector<double> residuals = m_core->calculateResiduals(baseParams, type, ui->sliderWeight->value()/100.0, sampleT, sampleP, sampleD);
             double sse = m_core->calculateSumSquaredError(residuals);
             ui->label_Error->setText(QString("误差(MSE): %1").arg(sse/residuals.size(), 0, 'e', 3));
 
-            if (m_isCustomSamplingEnabled) {
+            if (m_isCustomSamplingEnabled || m_samplingMode != Sampling_NearestPoint) {
                 m_chartManager->plotSampledPoints(sampleT, sampleP, sampleD);
+            } else {
+                m_chartManager->clearSampledPoints();
             }
+        } else {
+            m_chartManager->clearSampledPoints();
         }
+        scheduleSpeculation();
+    }
+}
+
+void FittingWidget::onParameterWheelChanged()
+{
+    if (!m_modelManager) return;
+    QString sensitivityKey;
+    QVector<double> sensitivityValues;
+    const QMap<QString, double> params = prepareModelParams(nullptr, sensitivityKey, sensitivityValues);
+    // 敏感性分析 (多值参数) 与拟合进行中仍同步刷新
+    if (!sensitivityKey.isEmpty() || m_isFitting) {
+        updateModelCurve(nullptr);
+        return;
+    }
+
+    ui->btnRunFit->setEnabled(true);
+    m_speculationTimer->stop();
+    m_preview->submit(previewRequest(params));
+}
+
+ModelPreviewRequest FittingWidget::previewRequest(const QMap<QString, double>& params) const
+{
+    ModelPreviewRequest request;
+    request.modelType = m_currentModelType;
+    request.params = params;
+    request.settings = m_modelManager->solverSettings();
+    request.targetT = displayTimeGrid();
+    request.adaptive = AdaptiveCurveSampler::isEnabledInSettings() && !m_core->hasRateHistory();
+    request.computeError = !m_observed->isEmpty();
+    request.weight = ui->sliderWeight->value() / 100.0;
+    return request;
+}
+
+void FittingWidget::scheduleSpeculation()
+{
+    if (!m_isFitting) m_speculationTimer->start();
+}
+
+void FittingWidget::onActiveParameterChanged(const QString& name)
+{
+    Q_UNUSED(name);
+    m_preview->clearSpeculation();
+    scheduleSpeculation();
+}
+
+void FittingWidget::onSpeculationIdle()
+{
+    if (!m_modelManager || !m_core || m_isFitting) return;
+    const QString name = m_paramChart->activeParameter();
+    FitParameter target;
+    bool found = false;
+    for (const FitParameter& p : m_paramChart->getParameters()) {
+        if (p.name == name && p.isVisible) { target = p; found = true; break; }
+    }
+    QString sensitivityKey;
+    QVector<double> sensitivityValues;
+    const QMap<QString, double> raw = tableParams(sensitivityKey, sensitivityValues);
+    // LfD 不响应滚轮；有多值参数时滚轮走同步刷新，不做预计算
+    if (!found || name == "LfD" || !sensitivityKey.isEmpty() || !raw.contains(name) || target.step == 0.0) {
+        m_preview->clearSpeculation();
+        return;
+    }
+
+    // 候选顺序 +1、-1、+2、-2 ...：离当前值近的先算；到达取值边界的方向不再延伸
+    QVector<ModelPreviewRequest> candidates;
+    double values[2] = { raw.value(name), raw.value(name) };
+    for (int s = 1; s <= ModelPreviewPipeline::SpeculativeSteps; ++s) {
+        for (int d = 0; d < 2; ++d) {
+            const double next = FittingParameterChart::steppedValue(target, values[d], d == 0 ? 1 : -1);
+            if (next == values[d]) continue;
+            values[d] = next;
+            QMap<QString, double> candidate = raw;
+            candidate[name] = next;
+            QString key;
+            QVector<double> keyValues;
+            candidates.append(previewRequest(prepareModelParams(&candidate, key, keyValues)));
+        }
+    }
+    m_preview->speculate(candidates);
+}
+
+void FittingWidget::onSensitivityStudy()
+{
+    if (!m_modelManager || !m_core) return;
+    if (m_isFitting) {
+        QMessageBox::warning(this, "提示", "拟合进行中，请先停止拟合。");
+        return;
+    }
+    QString sensitivityKey;
+    QVector<double> sensitivityValues;
+    const QMap<QString, double> base = prepareModelParams(nullptr, sensitivityKey, sensitivityValues);
+    SensitivityStudyDialog dlg(sensitivityStudy(displayTimeGrid()), base, m_paramChart->getParameters(), this);
+    dlg.exec();
+}
+
+void FittingWidget::onPreviewReady(const ModelPreviewResult& result)
+{
+    m_chartManager->plotAll(std::get<0>(result.curve), std::get<1>(result.curve), std::get<2>(result.curve), true);
+    if (!result.refined) return;
+    scheduleSpeculation();
+
+    if (result.mse >= 0.0) ui->label_Error->setText(QString("误差(MSE): %1").arg(result.mse, 0, 'e', 3));
+    if (!m_observed->isEmpty() && (m_isCustomSamplingEnabled || m_samplingMode != Sampling_NearestPoint)) {
+        QVector<double> sampleT, sampleP, sampleD;
+        m_core->getSampledObservedData(sampleT, sampleP, sampleD);
+        m_chartManager->plotSampledPoints(sampleT, sampleP, sampleD);
+    } else {
+        m_chartManager->clearSampledPoints();
     }
 }
 
@@ -542,19 +927,21 @@ void FittingWidget::onIterationUpdate(double err, const QMap<QString,double>& p,
     }
     ui->tableParams->blockSignals(false);
 
-    // plotAll 会清空整个图表，必须在此之后重绘抽样点
+    // 观测数据与抽样点位于缓存的静态层，迭代时只重绘理论曲线所在的模型层
     m_chartManager->plotAll(t, p_curve, d_curve, true);
 
-    if (m_isCustomSamplingEnabled && m_core) {
+    if ((m_isCustomSamplingEnabled || m_samplingMode != Sampling_NearestPoint) && m_core) {
         QVector<double> sampleT, sampleP, sampleD;
-        m_core->getLogSampledData(m_obsTime, m_obsDeltaP, m_obsDerivative, sampleT, sampleP, sampleD);
+        m_core->getSampledObservedData(sampleT, sampleP, sampleD);
         m_chartManager->plotSampledPoints(sampleT, sampleP, sampleD);
-        if(m_plotLogLog) m_plotLogLog->replot();
+    } else {
+        m_chartManager->clearSampledPoints();
     }
 }
 
 void FittingWidget::onFitFinished() {
     m_isFitting = false;
+    if (m_core) m_lastUncertainty = m_core->lastUncertainty();
     ui->btnRunFit->setEnabled(true);
     QMessageBox::information(this, "完成", "拟合完成。");
 }
@@ -566,31 +953,42 @@ void FittingWidget::on_btnExportData_clicked() {
     QString defaultDir = ModelParameter::instance()->getProjectPath();
     if(defaultDir.isEmpty()) defaultDir = ".";
 
-    QString fileName = QFileDialog::getSaveFileName(this, "导出拟合参数", defaultDir + "/FittingParameters.csv", "CSV Files (*.csv);;Text Files (*.txt)");
+    QString fileName = QFileDialog::getSaveFileName(this, "导出拟合参数", defaultDir + "/FittingParameters.csv", "CSV Files (*.csv);;Excel Files (*.xlsx);;Text Files (*.txt)");
     if (fileName.isEmpty()) return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
-    QTextStream out(&file);
-
-    if(fileName.endsWith(".csv", Qt::CaseInsensitive)) {
-        file.write("\xEF\xBB\xBF");
-        out << QString("参数中文名,参数英文名,拟合值,单位\n");
+    if (DataExportService::formatOf(fileName) == DataExportService::Txt) {
+        // 文本格式为逐行的参数说明，不是表格
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+        QTextStream out(&file);
         for(const auto& param : params) {
             QString htmlSym, uniSym, unitStr, dummyName;
             FittingParameterChart::getParamDisplayInfo(param.name, dummyName, htmlSym, uniSym, unitStr);
             if(unitStr == "无因次" || unitStr == "小数") unitStr = "";
-            out << QString("%1,%2,%3,%4\n").arg(param.displayName).arg(uniSym).arg(param.value, 0, 'g', 10).arg(unitStr);
+            out << QString("%1 (%2): %3 %4").arg(param.displayName).arg(uniSym).arg(param.value, 0, 'g', 10).arg(unitStr) << "\n";
         }
+        file.close();
     } else {
+        QStringList names, symbols, units;
+        QVector<double> values;
         for(const auto& param : params) {
             QString htmlSym, uniSym, unitStr, dummyName;
             FittingParameterChart::getParamDisplayInfo(param.name, dummyName, htmlSym, uniSym, unitStr);
             if(unitStr == "无因次" || unitStr == "小数") unitStr = "";
-            out << QString("%1 (%2): %3 %4").arg(param.displayName).arg(uniSym).arg(param.value, 0, 'g', 10).arg(unitStr) << "\n";
+            names << param.displayName;
+            symbols << uniSym;
+            values << param.value;
+            units << unitStr;
+        }
+        ExportTable table;
+        table.columns << ExportColumn::text("参数中文名", names) << ExportColumn::text("参数英文名", symbols)
+                      << ExportColumn::numbers("拟合值", values, 10) << ExportColumn::text("单位", units);
+        QString error;
+        if (!DataExportService::write(fileName, table, nullptr, nullptr, &error)) {
+            QMessageBox::warning(this, "错误", error);
+            return;
         }
     }
-    file.close();
     QMessageBox::information(this, "完成", "参数数据已成功导出。");
 }
 
@@ -598,7 +996,7 @@ void FittingWidget::onExportCurveData() {
     QString defaultDir = ModelParameter::instance()->getProjectPath();
     if(defaultDir.isEmpty()) defaultDir = ".";
 
-    QString path = QFileDialog::getSaveFileName(this, "导出拟合曲线数据", defaultDir + "/FittingCurves.csv", "CSV Files (*.csv)");
+    QString path = QFileDialog::getSaveFileName(this, "导出拟合曲线数据", defaultDir + "/FittingCurves.csv", "CSV Files (*.csv);;Excel Files (*.xlsx);;Text Files (*.txt)");
     if (path.isEmpty()) return;
 
     auto graphObsP = m_plotLogLog->graph(0);
@@ -609,52 +1007,39 @@ void FittingWidget::onExportCurveData() {
     QCPGraph *graphModP = (m_plotLogLog->graphCount() > 2) ? m_plotLogLog->graph(2) : nullptr;
     QCPGraph *graphModD = (m_plotLogLog->graphCount() > 3) ? m_plotLogLog->graph(3) : nullptr;
 
-    QFile f(path);
-    if (f.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&f);
-        out << "Obs_Time,Obs_DP,Obs_Deriv,Model_Time,Model_DP,Model_Deriv\n";
-
-        auto itObsP = graphObsP->data()->begin();
-        auto itObsD = graphObsD->data()->begin();
-        auto endObsP = graphObsP->data()->end();
-
-        QCPGraphDataContainer::const_iterator itModP, endModP, itModD;
-        bool hasModel = (graphModP != nullptr && graphModD != nullptr);
-        if(hasModel) {
-            itModP = graphModP->data()->begin();
-            endModP = graphModP->data()->end();
-            itModD = graphModD->data()->begin();
-        }
+    // 各列取曲线的完整数据；观测与理论曲线点数不同时，较短一侧的单元格留空
+    QVector<double> obsT, obsP, obsDT, obsD, modT, modP, modDT, modD;
+    GraphLod::graphData(graphObsP, obsT, obsP);
+    GraphLod::graphData(graphObsD, obsDT, obsD);
+    if (graphModP && graphModD) {
+        GraphLod::graphData(graphModP, modT, modP);
+        GraphLod::graphData(graphModD, modDT, modD);
+    }
 
-        while (itObsP != endObsP || (hasModel && itModP != endModP)) {
-            QStringList line;
-            if (itObsP != endObsP) {
-                line << QString::number(itObsP->key, 'g', 10);
-                line << QString::number(itObsP->value, 'g', 10);
-                if (itObsD != graphObsD->data()->end()) {
-                    line << QString::number(itObsD->value, 'g', 10);
-                    ++itObsD;
-                } else { line << ""; }
-                ++itObsP;
-            } else { line << "" << "" << ""; }
-
-            if (hasModel && itModP != endModP) {
-                line << QString::number(itModP->key, 'g', 10);
-                line << QString::number(itModP->value, 'g', 10);
-                if (itModD != graphModD->data()->end()) {
-                    line << QString::number(itModD->value, 'g', 10);
-                    ++itModD;
-                } else { line << ""; }
-                ++itModP;
-            } else { line << "" << "" << ""; }
-            out << line.join(",") << "\n";
-        }
-        f.close();
-        QMessageBox::information(this, "导出成功", "拟合曲线数据已保存。");
+    ExportTable table;
+    table.columns << ExportColumn::numbers("Obs_Time", obsT, 10) << ExportColumn::numbers("Obs_DP", obsP, 10)
+                  << ExportColumn::numbers("Obs_Deriv", obsD, 10) << ExportColumn::numbers("Model_Time", modT, 10)
+                  << ExportColumn::numbers("Model_DP", modP, 10) << ExportColumn::numbers("Model_Deriv", modD, 10);
+
+    QString error;
+    const DataExportService::Result result = DataExportService::exportWithProgress(this, path, table, &error);
+    if (result == DataExportService::Cancelled) return;
+    if (result == DataExportService::Failed) {
+        QMessageBox::warning(this, "错误", error);
+        return;
     }
+
+    QMessageBox openMsg(this);
+    openMsg.setWindowTitle("导出成功");
+    openMsg.setText("拟合曲线数据已保存。\n路径: " + path + "\n\n是否在数据界面打开导出的文件？");
+    openMsg.setIcon(QMessageBox::Question);
+    QPushButton* btnYes = openMsg.addButton("打开文件", QMessageBox::ActionRole);
+    openMsg.addButton("关闭", QMessageBox::RejectRole);
+    openMsg.exec();
+    if (openMsg.clickedButton() == btnYes) emit viewExportedFile(path);
 }
 
-void FittingWidget::on_btnExportReport_clicked()
+QString FittingWidget::reportWellName()
 {
     QString wellName = "未命名井";
     QString projectFilePath = ModelParameter::instance()->getProjectFilePath();
@@ -676,49 +1061,63 @@ void FittingWidget::on_btnExportReport_clicked()
         QFileInfo fi(projectFilePath);
         wellName = fi.completeBaseName();
     }
+    return wellName;
+}
 
+FittingReportData FittingWidget::createReportData()
+{
     FittingReportData reportData;
-    reportData.wellName = wellName;
+    reportData.wellName = reportWellName();
     reportData.modelType = m_currentModelType;
 
     QString mseText = ui->label_Error->text().remove("误差(MSE): ");
     reportData.mse = mseText.toDouble();
 
-    reportData.t = m_obsTime;
-    reportData.p = m_obsDeltaP;
-    reportData.d = m_obsDerivative;
+    reportData.t = m_observed->time();
+    reportData.p = m_observed->deltaP();
+    reportData.d = m_observed->derivative();
 
     m_paramChart->updateParamsFromTable();
     reportData.params = m_paramChart->getParameters();
 
-    reportData.imgLogLog = getPlotImageBase64(m_plotLogLog);
-    reportData.imgSemiLog = getPlotImageBase64(m_plotSemiLog);
-    reportData.imgCartesian = getPlotImageBase64(m_plotCartesian);
+    QMap<QString, double> paramValues;
+    for (const FitParameter& p : reportData.params) paramValues.insert(p.name, p.value);
+    if (m_currentModelType == m_lastUncertaintyModel && m_lastUncertainty.matches(paramValues))
+        reportData.uncertainty = m_lastUncertainty;
+
+    reportData.imageLogLog = FittingReportGenerator::renderPlot(m_plotLogLog);
+    reportData.imageSemiLog = FittingReportGenerator::renderPlot(m_plotSemiLog);
+    reportData.imageCartesian = FittingReportGenerator::renderPlot(m_plotCartesian);
+    return reportData;
+}
+
+void FittingWidget::on_btnExportReport_clicked()
+{
+    FittingReportJob job;
+    job.data = createReportData();
 
-    QString reportFileName = QString("%1试井解释报告.doc").arg(wellName);
+    QString projectFilePath = ModelParameter::instance()->getProjectFilePath();
+    QString reportFileName = QString("%1试井解释报告.doc").arg(job.data.wellName);
     QString defaultDir = QFileInfo(projectFilePath).absolutePath();
     if(defaultDir.isEmpty() || defaultDir == ".") defaultDir = ModelParameter::instance()->getProjectPath();
     if(defaultDir.isEmpty()) defaultDir = ".";
 
     QString fileName = QFileDialog::getSaveFileName(this, "导出报告", defaultDir + "/" + reportFileName, "Word 文档 (*.doc);;HTML 文件 (*.html)");
     if(fileName.isEmpty()) return;
+    job.filePath = fileName;
 
-    QString errorMsg;
-    if (FittingReportGenerator::generate(fileName, reportData, &errorMsg)) {
+    QStringList errors;
+    const DataExportService::Result result = FittingReportGenerator::generateWithProgress(this, {job}, &errors);
+    if (result == DataExportService::Cancelled) return;
+    if (result == DataExportService::Succeeded) {
         QMessageBox::information(this, "成功", QString("报告及数据已导出！\n\n文件路径: %1").arg(fileName));
     } else {
-        QMessageBox::critical(this, "错误", "报告导出失败:\n" + errorMsg);
+        QMessageBox::critical(this, "错误", "报告导出失败:\n" + errors.join("\n"));
     }
 }
 
 QString FittingWidget::getPlotImageBase64(MouseZoom* plot) {
-    if(!plot) return "";
-    QPixmap pixmap = plot->toPixmap(800, 600);
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    buffer.open(QIODevice::WriteOnly);
-    pixmap.save(&buffer, "PNG");
-    return QString::fromLatin1(byteArray.toBase64().data());
+    return FittingReportGenerator::encodeImage(FittingReportGenerator::renderPlot(plot));
 }
 
 void FittingWidget::on_btnSaveFit_clicked()
@@ -757,18 +1156,9 @@ QJsonObject FittingWidget::getJsonState() const
     }
     root["parameters"] = paramsArray;
 
-    QJsonArray timeArr, pressArr, derivArr, rawPArr;
-    for(double v : m_obsTime) timeArr.append(v);
-    for(double v : m_obsDeltaP) pressArr.append(v);
-    for(double v : m_obsDerivative) derivArr.append(v);
-    for(double v : m_obsRawP) rawPArr.append(v);
-
-    QJsonObject obsData;
-    obsData["time"] = timeArr;
-    obsData["pressure"] = pressArr;
-    obsData["derivative"] = derivArr;
-    obsData["rawPressure"] = rawPArr;
-    root["observedData"] = obsData;
+    // 观测数据的 JSON 在数据集上只编码一次 (各分析共享)；id 供项目保存时合并相同的数据集
+    root["observedData"] = m_observed->toJson();
+    root["observedDataId"] = m_observed->idString();
 
     root["useCustomSampling"] = m_isCustomSamplingEnabled;
     QJsonArray intervalArr;
@@ -780,6 +1170,8 @@ QJsonObject FittingWidget::getJsonState() const
         intervalArr.append(obj);
     }
     root["customIntervals"] = intervalArr;
+    root["samplingMode"] = (int)m_samplingMode;
+    if (m_core) root["reproducibility"] = m_core->reproducibility().toJson();
 
     return root;
 }
@@ -823,20 +1215,8 @@ void FittingWidget::loadFittingState(const QJsonObject& root)
     if (root.contains("fitWeightVal")) ui->sliderWeight->setValue(root["fitWeightVal"].toInt());
 
     if (root.contains("observedData")) {
-        QJsonObject obs = root["observedData"].toObject();
-        QJsonArray tArr = obs["time"].toArray();
-        QJsonArray pArr = obs["pressure"].toArray();
-        QJsonArray dArr = obs["derivative"].toArray();
-        QJsonArray rawPArr;
-        if (obs.contains("rawPressure")) rawPArr = obs["rawPressure"].toArray();
-
-        QVector<double> t, p, d, rawP;
-        for(auto v : tArr) t.append(v.toDouble());
-        for(auto v : pArr) p.append(v.toDouble());
-        for(auto v : dArr) d.append(v.toDouble());
-        for(auto v : rawPArr) rawP.append(v.toDouble());
-
-        setObservedData(t, p, d, rawP);
+        // 内容相同的数据集 (复制的分析、同一项目中的多个分析) 共享同一实例
+        setObservedDataset(ObservedDataset::fromJson(root["observedData"].toObject()));
     }
 
     if (root.contains("useCustomSampling")) m_isCustomSamplingEnabled = root["useCustomSampling"].toBool();
@@ -853,6 +1233,14 @@ void FittingWidget::loadFittingState(const QJsonObject& root)
         }
         if(m_core) m_core->setSamplingSettings(m_customIntervals, m_isCustomSamplingEnabled);
     }
+    // 保存了可复现设置的分析按其模式与种子重新拟合；旧项目沿用全局设置
+    if (root.contains("reproducibility") && m_core)
+        m_core->setReproducibility(FitReproducibility::fromJson(root["reproducibility"].toObject()));
+    if (root.contains("samplingMode")) {
+        int mode = root["samplingMode"].toInt();
+        m_samplingMode = (mode == Sampling_BinMean || mode == Sampling_BinMedian) ? (SamplingMode)mode : Sampling_NearestPoint;
+        if(m_core) m_core->setSamplingMode(m_samplingMode);
+    }
 
     updateModelCurve(&explicitParamsMap);
 
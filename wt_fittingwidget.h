@@ -3,6 +3,16 @@
  * 文件作用: 试井拟合分析主界面头文件
  * 修改记录:
  * 1. [新增] 添加 showEvent 声明，用于处理界面显示时的布局刷新。
+ * 2. [批量拟合] 添加 createFittingJob / applyFittingResult，供拟合页面的批量拟合队列生成任务与回写结果。
+ * 3. [参数不确定性] 保存最近一次拟合的参数不确定性，导出报告时附带。
+ * 4. [分箱抽样] 保存本页的抽样方式 (最近点 / 分箱平均 / 分箱中值)。
+ * 5. [后台导出] 添加 viewExportedFile 信号，导出的拟合曲线数据可在数据界面打开。
+ * 6. [敏感性研究] 保存本页的 SensitivityStudy (曲线缓存在多次研究与多参数刷新之间共用)；
+ *    prepareModelParams 可返回全部多值参数，派生参数 (LfD、C -> cD) 的换算提取为 applyDerivedParams。
+ * 7. [后台报告] 添加 createReportData / reportWellName，报告数据 (含离屏绘制的图表图像) 可供拟合页面批量生成报告。
+ * 8. [实时监测] 添加 isFitting，实时监测的滚动拟合在本页手动拟合期间跳过。
+ * 9. [投机预计算] 界面空闲时为正在调节的参数预计算两侧几格滚轮取值的预览 (ModelPreviewPipeline::speculate)；
+ *    参数表取值与预览请求的组装提取为 tableParams / previewRequest。
  */
 
 #ifndef WT_FITTINGWIDGET_H
@@ -18,6 +28,7 @@
 #include <QShowEvent> // [新增] 必须包含此头文件
 
 #include "modelmanager.h"
+#include "columnartablemodel.h"
 #include "fittingparameterchart.h"
 #include "chartwidget.h"
 #include "mousezoom.h"
@@ -25,6 +36,10 @@
 #include "fittingsamplingdialog.h"
 #include "fittingreport.h"
 #include "fittingchart.h"
+#include "fittingjobqueue.h"
+#include "observeddataset.h"
+#include "modelpreviewpipeline.h"
+#include "sensitivitystudy.h"
 
 namespace Ui {
 class FittingWidget;
@@ -42,7 +57,7 @@ public:
     void setModelManager(ModelManager* m);
 
     // 设置项目数据模型集合
-    void setProjectDataModels(const QMap<QString, QStandardItemModel*>& models);
+    void setProjectDataModels(const QMap<QString, ColumnarTableModel*>& models);
 
     // 兼容性接口：仅设置压差数据 (rawP 默认为空)
     void setObservedData(const QVector<double>& t, const QVector<double>& deltaP, const QVector<double>& d);
@@ -51,11 +66,32 @@ public:
     void setObservedData(const QVector<double>& t, const QVector<double>& deltaP,
                          const QVector<double>& d, const QVector<double>& rawP);
 
+    // 共享数据集句柄 (拟合核心、绘图与批量任务持有同一份数据)
+    void setObservedDataset(const ObservedDataset::Handle& dataset);
+    ObservedDataset::Handle observedDataset() const { return m_observed; }
+
     void updateBasicParameters();
     QJsonObject getJsonState() const;
     void loadFittingState(const QJsonObject& root);
     QString getPlotImageBase64(MouseZoom* plot);
 
+    // 报告数据：当前参数、观测数据与三个图表的离屏图像 (图像尚未编码，交给 FittingReportGenerator 在后台编码)
+    FittingReportData createReportData();
+    // 项目中的井名 (未设置时为项目文件名)
+    static QString reportWellName();
+
+    // 当前模型类型
+    ModelManager::ModelType currentModelType() const;
+
+    // 按当前数据、参数与抽样设置生成 type 模型的批量拟合任务 (换模型时共有参数沿用当前值)，无观测数据时返回 false
+    bool createFittingJob(ModelManager::ModelType type, FittingJob& job);
+
+    // 把批量拟合任务的模型与结果参数写回本页并刷新曲线 (本页正在拟合时忽略)
+    void applyFittingResult(const FittingJob& job);
+
+    // 本页是否正在拟合
+    bool isFitting() const { return m_isFitting; }
+
 protected:
     void resizeEvent(QResizeEvent* event) override;
 
@@ -64,6 +100,8 @@ protected:
 
 signals:
     void sigRequestSave();
+    // 导出的曲线数据需要在数据界面打开
+    void viewExportedFile(const QString& filePath);
 
 private slots:
     void on_btnLoadData_clicked();
@@ -82,6 +120,14 @@ private slots:
     void on_btnSaveFit_clicked();
     void updateModelCurve(const QMap<QString, double>* explicitParams = nullptr);
     void onIterationUpdate(double err, const QMap<QString,double>& p, const QVector<double>& t, const QVector<double>& p_curve, const QVector<double>& d_curve);
+    // [异步预览] 滚轮调参提交预览请求；结果到达 (先粗略后精细) 时刷新曲线
+    void onParameterWheelChanged();
+    void onPreviewReady(const ModelPreviewResult& result);
+    // [投机预计算] 换选参数时丢弃暂存结果；空闲定时器到时按当前参数表发起预计算
+    void onActiveParameterChanged(const QString& name);
+    void onSpeculationIdle();
+    // [敏感性研究] 打开多参数敏感性研究对话框
+    void onSensitivityStudy();
 
     // [新增] 布局刷新槽函数（配合 QTimer 使用）
     void layoutCharts();
@@ -91,6 +137,9 @@ private:
     ModelManager* m_modelManager;
     FittingCore* m_core;
     FittingChart* m_chartManager;
+    ModelPreviewPipeline* m_preview;
+    QTimer* m_speculationTimer; // 预览或刷新结束后等待界面空闲再发起投机预计算
+    QSharedPointer<SensitivityStudy> m_study; // 敏感性研究 (模型、求解器设置或时间网格改变时重建)
 
     QMdiArea* m_mdiArea;
     ChartWidget* m_chartLogLog;
@@ -104,24 +153,40 @@ private:
     MouseZoom* m_plotCartesian;
 
     FittingParameterChart* m_paramChart;
-    QMap<QString, QStandardItemModel*> m_dataMap;
+    QMap<QString, ColumnarTableModel*> m_dataMap;
     ModelManager::ModelType m_currentModelType;
 
     // 观测数据
-    QVector<double> m_obsTime;
-    QVector<double> m_obsDeltaP;
-    QVector<double> m_obsDerivative;
-    QVector<double> m_obsRawP;
+    ObservedDataset::Handle m_observed;
 
     bool m_isFitting;
+    FitUncertainty m_lastUncertainty; // 最近一次拟合结束时的参数不确定性
+    ModelManager::ModelType m_lastUncertaintyModel; // 该次拟合的模型
     bool m_isCustomSamplingEnabled;
     QList<SamplingInterval> m_customIntervals;
+    SamplingMode m_samplingMode;
 
     // 内部初始化
     void setupPlot();
+    // 参数表换算为求解器参数 (多值文本返回第一个敏感性参数名与取值，multiValued 非空时返回全部多值参数)；显示理论曲线的时间点
+    QMap<QString, double> prepareModelParams(const QMap<QString, double>* explicitParams,
+                                             QString& sensitivityKey, QVector<double>& sensitivityValues,
+                                             QMap<QString, QVector<double>>* multiValued = nullptr) const;
+    // 参数表中的原始取值 (多值文本取第一个值，含义同 prepareModelParams)，尚未做参数映射与派生参数换算
+    QMap<QString, double> tableParams(QString& sensitivityKey, QVector<double>& sensitivityValues,
+                                      QMap<QString, QVector<double>>* multiValued = nullptr) const;
+    // 参数取值改变后更新派生参数 (LfD；支持井储的模型由 C 换算 cD)
+    void applyDerivedParams(QMap<QString, double>& params) const;
+    // 当前模型、求解器设置与显示网格下的预览请求
+    ModelPreviewRequest previewRequest(const QMap<QString, double>& params) const;
+    // 重新开始空闲计时 (到时发起投机预计算)
+    void scheduleSpeculation();
+    // 与当前模型、求解器设置和时间网格对应的敏感性研究 (条件不变时沿用，保留曲线缓存)
+    QSharedPointer<SensitivityStudy> sensitivityStudy(const QVector<double>& t);
+    QVector<double> displayTimeGrid() const;
     void initializeDefaultModel();
 
-    QVector<double> parseSensitivityValues(const QString& text);
+    static QVector<double> parseSensitivityValues(const QString& text);
 };
 
 #endif // WT_FITTINGWIDGET_H
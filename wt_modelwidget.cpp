@@ -7,12 +7,20 @@
  * 3. 响应用户操作，收集界面参数。
  * 4. [修正] 读取 rw 参数，并用于 C -> cD 的无因次转换。
  * 5. 调用 ModelSolver01_06 进行计算并将结果绘制在 QCustomPlot 图表上。
+ * 6. 敏感性分析的多条曲线先组装参数组，再通过批量接口一次计算。
+ * 7. 开启自适应布点 (display/adaptiveSampling) 时，点数作为预算，只在曲率较大处加密 (见 adaptivecurvesampler.h)。
+ * 8. [后台计算] 点击 "开始计算" 后收集参数并派发后台任务立即返回：敏感性分析的各取值各自一个任务 (独立求解器实例) 并行计算，
+ *    只有井储表皮或产量缩放不同的取值仍合为一次批量调用以共享储层响应；每个任务完成即绘制其曲线。
+ *    计算期间按钮显示 "取消计算 (已完成/总数)"，取消经 CancellationToken 在 Laplace 节点粒度上生效，已绘制的曲线保留。
+ * 9. 后台任务以交互优先级向 TaskScheduler 提交时间点与工作项，与同时运行的批量拟合并存时优先完成。
  */
 
 #include "wt_modelwidget.h"
 #include "ui_wt_modelwidget.h"
 #include "modelmanager.h"
 #include "modelparameter.h"
+#include "adaptivecurvesampler.h"
+#include "taskscheduler.h"
 
 #include <QDebug>
 #include <QMessageBox>
@@ -24,6 +32,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QGridLayout>
+#include <QtConcurrent>
 #include <cmath>
 
 WT_ModelWidget::WT_ModelWidget(ModelType type, QWidget *parent)
@@ -59,6 +68,9 @@ WT_ModelWidget::WT_ModelWidget(ModelType type, QWidget *parent)
 
 WT_ModelWidget::~WT_ModelWidget()
 {
+    // 后台任务持有各自的求解器与令牌，取消后等待结束即可
+    if (m_token) m_token->cancel();
+    for (QFutureWatcher<QVector<ModelCurveData>>* watcher : m_watchers) watcher->waitForFinished();
     delete m_solver; // 清理求解器资源
     delete ui;
 }
@@ -76,6 +88,15 @@ WT_ModelWidget::ModelCurveData WT_ModelWidget::calculateTheoreticalCurve(const Q
     return ModelCurveData();
 }
 
+QVector<WT_ModelWidget::ModelCurveData> WT_ModelWidget::calculateTheoreticalCurves(const QVector<QMap<QString, double>>& paramSets,
+                                                                                   const QVector<double>& providedTime)
+{
+    if (m_solver) {
+        return m_solver->calculateTheoreticalCurvesBatch(paramSets, providedTime);
+    }
+    return QVector<ModelCurveData>(paramSets.size());
+}
+
 void WT_ModelWidget::setHighPrecision(bool high)
 {
     m_highPrecision = high;
@@ -276,17 +297,17 @@ void WT_ModelWidget::onShowPointsToggled(bool checked) {
 }
 
 void WT_ModelWidget::onCalculateClicked() {
-    ui->calculateButton->setEnabled(false);
-    ui->calculateButton->setText("计算中...");
-    QCoreApplication::processEvents();
-    runCalculation();
-    ui->calculateButton->setEnabled(true);
-    ui->calculateButton->setText("开始计算");
+    // 计算期间按钮用于取消
+    if (m_pendingJobs > 0) cancelCalculation();
+    else runCalculation();
 }
 
 void WT_ModelWidget::runCalculation() {
     MouseZoom* plot = ui->chartWidget->getPlot();
     plot->clearGraphs();
+    res_tD.clear();
+    res_pD.clear();
+    res_dpD.clear();
 
     // 收集界面输入参数
     QMap<QString, QVector<double>> rawParams;
@@ -386,52 +407,168 @@ void WT_ModelWidget::runCalculation() {
     int iterations = isSensitivity ? sensitivityValues.size() : 1;
     iterations = qMin(iterations, (int)m_colorList.size());
 
-    QString resultTextHeader = QString("计算完成 (%1)\n").arg(getModelName());
-    if(isSensitivity) resultTextHeader += QString("敏感性参数: %1\n").arg(sensitivityKey);
-
-    // 循环计算
+    // 组装各条曲线的参数 (敏感性分析时每个取值一组)
+    QVector<QMap<QString, double>> paramSets;
     for(int i = 0; i < iterations; ++i) {
         QMap<QString, double> currentParams = baseParams;
-        double val = 0;
         if (isSensitivity) {
-            val = sensitivityValues[i];
-            currentParams[sensitivityKey] = val;
+            currentParams[sensitivityKey] = sensitivityValues[i];
 
             // 联动更新 LfD
             if (sensitivityKey == "L" || sensitivityKey == "Lf") {
                 if(currentParams["L"] > 1e-9) currentParams["LfD"] = currentParams["Lf"] / currentParams["L"];
             }
         }
+        paramSets.append(currentParams);
+    }
+    // 本次计算的上下文 (后台任务完成时逐条绘制)
+    ++m_generation;
+    m_token = QSharedPointer<CancellationToken>::create();
+    m_sensitivityKey = sensitivityKey;
+    m_sensitivityValues = sensitivityValues;
+    m_baseParams = baseParams;
+    m_results = QVector<ModelCurveData>(paramSets.size());
+    m_received = QVector<bool>(paramSets.size(), false);
+
+    // 分组：只有井储表皮或产量缩放不同的取值共享储层响应，合为一个批量任务；其余每个取值一个任务并行计算
+    QVector<QVector<int>> jobs;
+    if (isSensitivity && sharesReservoirResponse(sensitivityKey)) {
+        QVector<int> all;
+        for (int i = 0; i < paramSets.size(); ++i) all.append(i);
+        jobs.append(all);
+    } else {
+        for (int i = 0; i < paramSets.size(); ++i) jobs.append(QVector<int>() << i);
+    }
 
-        ModelCurveData res = calculateTheoreticalCurve(currentParams, t);
+    const bool adaptive = AdaptiveCurveSampler::isEnabledInSettings();
+    const quint64 generation = m_generation;
+    const QSharedPointer<CancellationToken> token = m_token;
+    m_pendingJobs = jobs.size();
+    for (const QVector<int>& indices : jobs) {
+        QVector<QMap<QString, double>> sets;
+        for (int i : indices) sets.append(paramSets[i]);
+        // 每个任务使用独立的求解器实例 (求解器记录最近一次计算的误差估计，不能跨线程共用)
+        QSharedPointer<ModelSolver01_06> solver(new ModelSolver01_06(m_type));
+        solver->setHighPrecision(m_highPrecision);
+
+        QFuture<QVector<ModelCurveData>> future = QtConcurrent::run([solver, sets, t, nPoints, adaptive, token]() {
+            CancellationToken::Scope cancellationScope(token.data());
+            TaskScheduler::PriorityScope priorityScope(TaskScheduler::Interactive);
+            QVector<ModelCurveData> curves;
+            if (adaptive) {
+                AdaptiveSamplingOptions sampling;
+                sampling.maxPoints = nPoints;
+                curves = AdaptiveCurveSampler::sample([&](const QVector<double>& times) {
+                    return solver->calculateTheoreticalCurvesBatch(sets, times);
+                }, t.first(), t.last(), sampling);
+            }
+            if (!token->isCancelled() && curves.isEmpty()) curves = solver->calculateTheoreticalCurvesBatch(sets, t);
+            if (token->isCancelled()) curves.clear();
+            return curves;
+        });
+
+        auto* watcher = new QFutureWatcher<QVector<ModelCurveData>>(this);
+        connect(watcher, &QFutureWatcher<QVector<ModelCurveData>>::finished, this, [this, watcher, generation, indices]() {
+            m_watchers.removeOne(watcher);
+            watcher->deleteLater();
+            onCurvesReady(generation, indices, watcher->result());
+        });
+        watcher->setFuture(future);
+        m_watchers.append(watcher);
+    }
+    updateCalculateButton();
+}
 
-        res_tD = std::get<0>(res);
-        res_pD = std::get<1>(res);
-        res_dpD = std::get<2>(res);
+bool WT_ModelWidget::sharesReservoirResponse(const QString& key)
+{
+    // 与 calculateTheoreticalCurvesBatch 的共享规则一致
+    static const QStringList keys = { "cD", "S", "gamaD", "q", "B", "h" };
+    return keys.contains(key);
+}
 
-        QColor curveColor = isSensitivity ? m_colorList[i] : Qt::red;
-        QString legendName;
-        if (isSensitivity) legendName = QString("%1 = %2").arg(sensitivityKey).arg(val);
-        else legendName = "理论曲线";
+void WT_ModelWidget::updateCalculateButton()
+{
+    if (m_pendingJobs > 0) {
+        int done = 0;
+        for (bool received : m_received) if (received) ++done;
+        ui->calculateButton->setText(m_received.size() > 1 ? QString("取消计算 (%1/%2)").arg(done).arg(m_received.size())
+                                                            : QString("取消计算"));
+    } else {
+        ui->calculateButton->setText("开始计算");
+    }
+}
+
+void WT_ModelWidget::cancelCalculation()
+{
+    if (m_pendingJobs <= 0) return;
+    if (m_token) m_token->cancel();
+    ++m_generation; // 仍在运行的任务结束后结果被丢弃
+    m_pendingJobs = 0;
+    finishCalculation(true);
+}
+
+void WT_ModelWidget::onCurvesReady(quint64 generation, const QVector<int>& indices, const QVector<ModelCurveData>& curves)
+{
+    if (generation != m_generation) return;
+    --m_pendingJobs;
+
+    if (curves.size() == indices.size()) {
+        MouseZoom* plot = ui->chartWidget->getPlot();
+        const bool isSensitivity = !m_sensitivityKey.isEmpty();
+        for (int k = 0; k < indices.size(); ++k) {
+            const int i = indices[k];
+            m_results[i] = curves[k];
+            m_received[i] = true;
+
+            QColor curveColor = isSensitivity ? m_colorList[i] : Qt::red;
+            QString legendName;
+            if (isSensitivity) legendName = QString("%1 = %2").arg(m_sensitivityKey).arg(m_sensitivityValues[i]);
+            else legendName = "理论曲线";
+            plotCurve(curves[k], legendName, curveColor, isSensitivity);
+        }
+        plot->rescaleAxes();
+        if(plot->xAxis->range().lower <= 0) plot->xAxis->setRangeLower(1e-3);
+        if(plot->yAxis->range().lower <= 0) plot->yAxis->setRangeLower(1e-3);
+        onShowPointsToggled(ui->checkShowPoints->isChecked());
+    }
 
-        plotCurve(res, legendName, curveColor, isSensitivity);
+    if (m_pendingJobs <= 0) finishCalculation(false);
+    else updateCalculateButton();
+}
+
+void WT_ModelWidget::finishCalculation(bool cancelled)
+{
+    MouseZoom* plot = ui->chartWidget->getPlot();
+
+    // 结果文本取最后一条已完成的曲线
+    for (int i = m_results.size() - 1; i >= 0; --i) {
+        if (!m_received[i]) continue;
+        res_tD = std::get<0>(m_results[i]);
+        res_pD = std::get<1>(m_results[i]);
+        res_dpD = std::get<2>(m_results[i]);
+        break;
     }
 
     // 更新结果
-    QString resultText = resultTextHeader;
+    QString resultText = QString(cancelled ? "计算已取消 (%1)\n" : "计算完成 (%1)\n").arg(getModelName());
+    if(!m_sensitivityKey.isEmpty()) resultText += QString("敏感性参数: %1\n").arg(m_sensitivityKey);
     resultText += "t(h)\t\tDp(MPa)\t\tdDp(MPa)\n";
     for(int i=0; i<res_pD.size(); ++i) {
         resultText += QString("%1\t%2\t%3\n").arg(res_tD[i],0,'e',4).arg(res_pD[i],0,'e',4).arg(res_dpD[i],0,'e',4);
     }
     ui->resultTextEdit->setText(resultText);
 
-    ui->chartWidget->getPlot()->rescaleAxes();
-    if(plot->xAxis->range().lower <= 0) plot->xAxis->setRangeLower(1e-3);
-    if(plot->yAxis->range().lower <= 0) plot->yAxis->setRangeLower(1e-3);
+    if (plot->graphCount() > 0) {
+        plot->rescaleAxes();
+        if(plot->xAxis->range().lower <= 0) plot->xAxis->setRangeLower(1e-3);
+        if(plot->yAxis->range().lower <= 0) plot->yAxis->setRangeLower(1e-3);
+    }
     plot->replot();
-
     onShowPointsToggled(ui->checkShowPoints->isChecked());
-    emit calculationCompleted(getModelName(), baseParams);
+
+    m_token.clear();
+    updateCalculateButton();
+    if (!cancelled) emit calculationCompleted(getModelName(), m_baseParams);
 }
 
 void WT_ModelWidget::plotCurve(const ModelCurveData& data, const QString& name, QColor color, bool isSensitivity) {
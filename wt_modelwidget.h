@@ -5,6 +5,7 @@
  * 1. 管理用户界面，处理参数输入、按钮响应和图表展示。
  * 2. 包含 ModelSolver01_06 实例，调用其进行数学计算。
  * 3. 继承自 QWidget，不再包含复杂的数学算法实现。
+ * 4. [后台计算] 界面触发的计算在后台线程执行，敏感性分析的各取值并行计算、逐条绘制；计算期间按钮变为 "取消计算"。
  */
 
 #ifndef WT_MODELWIDGET_H
@@ -14,7 +15,10 @@
 #include <QMap>
 #include <QVector>
 #include <QColor>
+#include <QFutureWatcher>
+#include <QSharedPointer>
 #include <tuple>
+#include "cancellationtoken.h"
 #include "chartwidget.h"
 #include "modelsolver01-06.h"
 
@@ -40,6 +44,9 @@ public:
 
     // 直接调用求解器计算（供外部管理器使用，非 UI 交互）
     ModelCurveData calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>());
+    // 批量计算多组参数 (敏感性分析)，结果顺序与 paramSets 一致
+    QVector<ModelCurveData> calculateTheoreticalCurves(const QVector<QMap<QString, double>>& paramSets,
+                                                       const QVector<double>& providedTime = QVector<double>());
 
     // 获取当前模型名称
     QString getModelName() const;
@@ -65,7 +72,16 @@ private:
     void initUi();
     void initChart();
     void setupConnections();
-    void runCalculation(); // UI 触发的计算流程封装
+    void runCalculation(); // UI 触发的计算流程封装 (收集参数并派发后台任务后立即返回)
+    // 取消进行中的计算 (已绘制的曲线保留)
+    void cancelCalculation();
+    // 一个后台任务完成：indices 为其曲线在本次计算中的序号
+    void onCurvesReady(quint64 generation, const QVector<int>& indices, const QVector<ModelCurveData>& curves);
+    // 全部任务结束 (或已取消) 后更新结果文本、坐标范围与按钮状态
+    void finishCalculation(bool cancelled);
+    void updateCalculateButton();
+    // 敏感性参数只影响井储表皮或产量缩放 (各取值共享储层响应，适合合并为一次批量计算)
+    static bool sharesReservoirResponse(const QString& key);
 
     // 辅助函数
     QVector<double> parseInput(const QString& text);
@@ -80,6 +96,17 @@ private:
     bool m_highPrecision;
     QList<QColor> m_colorList;
 
+    // 进行中的计算
+    quint64 m_generation = 0;
+    QSharedPointer<CancellationToken> m_token;
+    QList<QFutureWatcher<QVector<ModelCurveData>>*> m_watchers;
+    int m_pendingJobs = 0;
+    QString m_sensitivityKey;
+    QVector<double> m_sensitivityValues;
+    QMap<QString, double> m_baseParams;
+    QVector<ModelCurveData> m_results;
+    QVector<bool> m_received;
+
     // 缓存计算结果
     QVector<double> res_tD;
     QVector<double> res_pD;
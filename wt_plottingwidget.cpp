@@ -8,6 +8,26 @@
  * 4. [本次修改]
  * - 修复导出 CSV 时中文表头乱码的问题（添加 UTF-8 BOM）。
  * - 导出后发出的 viewExportedFile 信号将在 MainWindow 中处理跳转逻辑。
+ * 5. [局部更新] 双对数图的压差曲线被移动后同步更新导数曲线：时间不变时只重算 L-Spacing 窗口内受影响的导数点，
+ *    并就地改写导数曲线的数据 (不重建数据容器)。
+ * 6. [平滑算法] 压力导数曲线可选移动平均、Savitzky-Golay 或对数时间窗平滑 (smoothMethod，随曲线保存)。
+ * 7. [列存储] 曲线数据直接取数据模型的数值列，任一列为空或非数值的行跳过。
+ * 8. [增量保存] 保存时曲线数据数组经 JsonVectorCache 编码，只有改变了的数组重新转换；内容未变时不重写 _chart.json。
+ * 9. [变更合并] 三类曲线的取数统一在 extractCurveData 中；数据表修改后只有 X/Y 列 (或产量列) 在变更集中的曲线重新取数，
+ *    当前显示的曲线保持视图范围重绘。
+ * 10. [多级抽稀] 曲线数据经 GraphLod 写入：大数据量曲线 (压力、产量、压差与导数) 只显示与可见范围和像素宽度相称的
+ *    最小/最大值 (折线) 或 LTTB (散点) 抽稀点；编辑、导出与产量插值读取完整数据。
+ * 11. [产量索引] 阶梯产量曲线的阶段划分与查询共用 RateHistory (superposition.h)：导出时按阶段索引顺序查找产量；
+ *    导出数据逐行直接写入文件 (xlsx 经 XlsxStreamWriter 流式写出)，不再先在内存中组装整张表。
+ * 12. [后台导出] 导出列直接引用曲线数组 (部分导出的相对时间以偏移量表示)，由 DataExportService 在后台线程写出，
+ *    期间显示可取消的进度框；完成后仍可经 viewExportedFile 在数据界面打开导出的文件。
+ * 13. [数据引用] 由数据源列生成且未被拖动修改的曲线在 _chart.json 中只保存数据源、列序号与表头名及取数配方，
+ *    打开项目时不读入数组，首次显示 (或导出、修改) 时从数据表生成；生成结果按 "数据表 + 列 + 配方" 缓存，
+ *    多条曲线引用同一组列时共用一份数组。表头名用于在数据表插入或删除列后重新定位列；
+ *    已修改的曲线或数据源已关闭的曲线以 Base64 二进制内嵌数据 (读取时兼容旧的数字数组)。
+ * 14. [共享数据] 主界面与独立图表窗口显示同一条曲线时共用 GraphLod 的数据源，不再各自复制数据；
+ *    双对数图的导数曲线经 GraphLod::updateValues 只改写 L-Spacing 窗口内的点，共用该数据源的窗口随之重绘。
+ * 15. [分段加载] 绘图数据仍在后台解析时不保存 (曲线尚未恢复)。
  */
 
 #include "wt_plottingwidget.h"
@@ -21,7 +41,9 @@
 #include "chartsetting1.h"
 #include "pressurederivativecalculator.h"
 #include "pressurederivativecalculator1.h"
-#include "xlsxdocument.h" //  QtXlsx 库
+#include "dataexportservice.h"
+#include "graphlod.h"
+#include "superposition.h"
 
 #include <QMessageBox>
 #include <QFileDialog>
@@ -31,27 +53,65 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QtMath>
+#include <cmath>
 #include <QDebug>
 #include <QSplitter>
+#include <QSet>
+#include <functional>
 #include <QStringConverter> // Qt6 编码支持
 
 // ============================================================================
 // 辅助函数与 CurveInfo 实现
 // ============================================================================
 
-QJsonArray vectorToJson(const QVector<double>& vec) {
-    QJsonArray arr;
-    for(double v : vec) arr.append(v);
-    return arr;
-}
-
 QVector<double> jsonToVector(const QJsonArray& arr) {
     QVector<double> vec;
     for(const auto& val : arr) vec.append(val.toDouble());
     return vec;
 }
 
-QJsonObject CurveInfo::toJson() const {
+// 读取两列数值 (任一列为空或非数值的行跳过)
+static void appendColumnPair(const ColumnarTableModel* model, int xCol, int yCol,
+                             QVector<double>& xData, QVector<double>& yData) {
+    if (!model) return;
+    const ColumnarTableModel::ColumnSpan xs = model->columnSpan(xCol);
+    const ColumnarTableModel::ColumnSpan ys = model->columnSpan(yCol);
+    for(int i=0; i<xs.size && i<ys.size; ++i) {
+        if (std::isnan(xs[i]) || std::isnan(ys[i])) continue;
+        xData.append(xs[i]);
+        yData.append(ys[i]);
+    }
+}
+
+// 经缓存 (可为空) 编码数据数组 (Base64 二进制)
+static QJsonValue encodeVector(const QVector<double>& vec, JsonVectorCache* cache) {
+    return cache ? cache->encodeBinary(vec) : JsonVectorCache::toBinary(vec);
+}
+
+// 读取数据数组：二进制字符串或 (旧格式的) 数字数组
+static QVector<double> decodeVector(const QJsonValue& value) {
+    if (value.isString()) return JsonVectorCache::fromBinary(value.toString());
+    return jsonToVector(value.toArray());
+}
+
+// 按表头名校正列序号：序号处的表头与记录不符时改用唯一同名的列；之后记录当前的表头名
+static void resolveColumn(const ColumnarTableModel* model, int& column, QString& header) {
+    if (!model) return;
+    if (!header.isEmpty() && model->headerText(column) != header) {
+        int found = -1;
+        int matches = 0;
+        for (int c = 0; c < model->columnCount(); ++c) {
+            if (model->headerText(c) == header) {
+                found = c;
+                ++matches;
+            }
+        }
+        if (matches == 1) column = found;
+    }
+    header = model->headerText(column);
+}
+
+QJsonObject CurveInfo::toJson(JsonVectorCache* cache) const {
     QJsonObject obj;
     obj["name"] = name;
     obj["legendName"] = legendName;
@@ -60,8 +120,14 @@ QJsonObject CurveInfo::toJson() const {
     obj["type"] = type;
     obj["xCol"] = xCol;
     obj["yCol"] = yCol;
-    obj["xData"] = vectorToJson(xData);
-    obj["yData"] = vectorToJson(yData);
+    obj["linked"] = linked;
+    if (linked) {
+        obj["xHeader"] = xHeader;
+        obj["yHeader"] = yHeader;
+    } else {
+        obj["xData"] = encodeVector(xData, cache);
+        obj["yData"] = encodeVector(yData, cache);
+    }
     obj["pointShape"] = (int)pointShape;
     obj["pointColor"] = pointColor.name();
     obj["lineStyle"] = (int)lineStyle;
@@ -71,8 +137,13 @@ QJsonObject CurveInfo::toJson() const {
     if (type == 1) {
         obj["x2Col"] = x2Col;
         obj["y2Col"] = y2Col;
-        obj["x2Data"] = vectorToJson(x2Data);
-        obj["y2Data"] = vectorToJson(y2Data);
+        if (linked) {
+            obj["x2Header"] = x2Header;
+            obj["y2Header"] = y2Header;
+        } else {
+            obj["x2Data"] = encodeVector(x2Data, cache);
+            obj["y2Data"] = encodeVector(y2Data, cache);
+        }
         obj["prodLegendName"] = prodLegendName;
         obj["prodGraphType"] = prodGraphType;
         obj["prodColor"] = prodColor.name();
@@ -89,7 +160,8 @@ QJsonObject CurveInfo::toJson() const {
         obj["LSpacing"] = LSpacing;
         obj["isSmooth"] = isSmooth;
         obj["smoothFactor"] = smoothFactor;
-        obj["derivData"] = vectorToJson(derivData);
+        obj["smoothMethod"] = smoothMethod;
+        if (!linked) obj["derivData"] = encodeVector(derivData, cache);
         obj["derivShape"] = (int)derivShape;
         obj["derivPointColor"] = derivPointColor.name();
         obj["derivLineStyle"] = (int)derivLineStyle;
@@ -110,8 +182,15 @@ CurveInfo CurveInfo::fromJson(const QJsonObject& json) {
     info.xCol = json["xCol"].toInt(-1);
     info.yCol = json["yCol"].toInt(-1);
 
-    info.xData = jsonToVector(json["xData"].toArray());
-    info.yData = jsonToVector(json["yData"].toArray());
+    // 引用数据源的曲线只读入列的定位信息，数据在首次使用时生成 (见 ensureCurveData)
+    info.linked = json["linked"].toBool(false);
+    info.materialized = !info.linked;
+    info.xHeader = json["xHeader"].toString();
+    info.yHeader = json["yHeader"].toString();
+    if (!info.linked) {
+        info.xData = decodeVector(json["xData"]);
+        info.yData = decodeVector(json["yData"]);
+    }
 
     info.pointShape = (QCPScatterStyle::ScatterShape)json["pointShape"].toInt();
     info.pointColor = QColor(json["pointColor"].toString());
@@ -122,8 +201,12 @@ CurveInfo CurveInfo::fromJson(const QJsonObject& json) {
     if (info.type == 1) {
         info.x2Col = json["x2Col"].toInt(-1);
         info.y2Col = json["y2Col"].toInt(-1);
-        info.x2Data = jsonToVector(json["x2Data"].toArray());
-        info.y2Data = jsonToVector(json["y2Data"].toArray());
+        info.x2Header = json["x2Header"].toString();
+        info.y2Header = json["y2Header"].toString();
+        if (!info.linked) {
+            info.x2Data = decodeVector(json["x2Data"]);
+            info.y2Data = decodeVector(json["y2Data"]);
+        }
         info.prodLegendName = json["prodLegendName"].toString();
         info.prodGraphType = json["prodGraphType"].toInt();
         info.prodColor = QColor(json["prodColor"].toString());
@@ -139,7 +222,8 @@ CurveInfo CurveInfo::fromJson(const QJsonObject& json) {
         info.LSpacing = json["LSpacing"].toDouble();
         info.isSmooth = json["isSmooth"].toBool();
         info.smoothFactor = json["smoothFactor"].toInt();
-        info.derivData = jsonToVector(json["derivData"].toArray());
+        info.smoothMethod = json["smoothMethod"].toInt(DerivativeSmoother::MovingAverage);
+        if (!info.linked) info.derivData = decodeVector(json["derivData"]);
         info.derivShape = (QCPScatterStyle::ScatterShape)json["derivShape"].toInt();
         info.derivPointColor = QColor(json["derivPointColor"].toString());
         info.derivLineStyle = (Qt::PenStyle)json["derivLineStyle"].toInt();
@@ -188,7 +272,7 @@ WT_PlottingWidget::WT_PlottingWidget(QWidget *parent) :
 
 WT_PlottingWidget::~WT_PlottingWidget()
 {
-    qDeleteAll(m_openedWindows);
+    for (const QPointer<QWidget>& window : m_openedWindows) delete window.data();
     delete ui;
 }
 
@@ -252,13 +336,32 @@ void WT_PlottingWidget::onChartGraphsChanged()
     }
 }
 
-void WT_PlottingWidget::setDataModels(const QMap<QString, QStandardItemModel*>& models) {
+void WT_PlottingWidget::setDataModels(const QMap<QString, ColumnarTableModel*>& models) {
     m_dataMap = models;
     if (!m_dataMap.isEmpty()) {
         m_defaultModel = m_dataMap.first();
     } else {
         m_defaultModel = nullptr;
     }
+
+    // 已关闭的数据表：缓存的数组丢弃，引用它的曲线改为内嵌保存已生成的数据
+    QSet<const ColumnarTableModel*> open;
+    for (ColumnarTableModel* m : std::as_const(m_dataMap)) open.insert(m);
+    for (auto it = m_seriesCache.begin(); it != m_seriesCache.end();) {
+        if (!open.contains(it->model)) it = m_seriesCache.erase(it);
+        else ++it;
+    }
+    for (auto it = m_curves.begin(); it != m_curves.end(); ++it) {
+        if (it->linked && it->materialized && !curveSourcesAvailable(*it)) it->linked = false;
+    }
+
+    // 当前曲线在数据表就绪之前无法生成数据时，就绪后补画
+    if (m_curves.contains(m_currentDisplayedCurve) && !m_curves[m_currentDisplayedCurve].materialized
+        && ensureCurveData(m_curves[m_currentDisplayedCurve])) {
+        m_graphPress = nullptr;
+        m_graphProd = nullptr;
+        displayCurve(m_curves[m_currentDisplayedCurve], ui->customPlot);
+    }
 }
 
 void WT_PlottingWidget::setProjectFolderPath(const QString& path) { Q_UNUSED(path); }
@@ -312,10 +415,16 @@ void WT_PlottingWidget::loadProjectData() {
 
 void WT_PlottingWidget::saveProjectData() {
     if (!ModelParameter::instance()->hasLoadedProject()) return;
+    if (!ModelParameter::instance()->isSectionLoaded(ModelParameter::PlottingSection)) {
+        QMessageBox::information(this, "保存", "绘图数据仍在加载，请稍后再保存。");
+        return;
+    }
     QJsonArray curvesArray;
     for(auto it = m_curves.begin(); it != m_curves.end(); ++it) {
-        curvesArray.append(it.value().toJson());
+        curvesArray.append(it.value().toJson(&m_jsonCache));
     }
+    m_jsonCache.prune();
+    pruneSeriesCache();
     ModelParameter::instance()->savePlottingData(curvesArray);
     QMessageBox::information(this, "保存", "绘图数据已保存。");
 }
@@ -324,12 +433,14 @@ void WT_PlottingWidget::on_btn_Save_clicked() { saveProjectData(); }
 
 void WT_PlottingWidget::clearAllPlots() {
     m_curves.clear();
+    m_jsonCache.clear();
+    m_seriesCache.clear();
     m_viewStates.clear();
     m_currentDisplayedCurve.clear();
     ui->listWidget_Curves->clear();
     ui->customPlot->clearGraphs();
     ui->customPlot->setTitle("试井分析图表");
-    qDeleteAll(m_openedWindows);
+    for (const QPointer<QWidget>& window : m_openedWindows) delete window.data();
     m_openedWindows.clear();
 }
 
@@ -396,6 +507,7 @@ void WT_PlottingWidget::on_listWidget_Curves_itemDoubleClicked(QListWidgetItem *
         saveCurveViewState(m_currentDisplayedCurve);
     }
 
+    ensureCurveData(m_curves[name]);
     CurveInfo info = m_curves[name];
     m_currentDisplayedCurve = name;
 
@@ -406,6 +518,164 @@ void WT_PlottingWidget::on_listWidget_Curves_itemDoubleClicked(QListWidgetItem *
     restoreCurveViewState(name);
 }
 
+bool WT_PlottingWidget::curveSourcesAvailable(const CurveInfo& info) const {
+    if (!m_dataMap.value(info.sourceFileName, nullptr)) return false;
+    return info.type != 1 || info.sourceFileName2.isEmpty() || m_dataMap.value(info.sourceFileName2, nullptr);
+}
+
+bool WT_PlottingWidget::ensureCurveData(CurveInfo& info) const {
+    if (info.materialized) return true;
+    if (!curveSourcesAvailable(info)) return false;
+    return extractCurveData(info);
+}
+
+// 缓存键：数据表 + 取数配方
+static QString seriesKey(const ColumnarTableModel* model, const QString& recipe) {
+    return QString::number(quintptr(model), 16) + '|' + recipe;
+}
+
+void WT_PlottingWidget::dropCachedSeries(const ColumnarTableModel* model, const DataChangeSet& changes) {
+    for (auto it = m_seriesCache.begin(); it != m_seriesCache.end();) {
+        if (it->model == model && (changes.touchesColumn(it->xCol) || changes.touchesColumn(it->yCol))) it = m_seriesCache.erase(it);
+        else ++it;
+    }
+}
+
+void WT_PlottingWidget::pruneSeriesCache() {
+    QSet<const double*> used;
+    for (const CurveInfo& info : std::as_const(m_curves)) used << info.xData.constData() << info.x2Data.constData();
+    for (auto it = m_seriesCache.begin(); it != m_seriesCache.end();) {
+        if (!used.contains(it->x.constData())) it = m_seriesCache.erase(it);
+        else ++it;
+    }
+}
+
+bool WT_PlottingWidget::extractCurveData(CurveInfo& info) const {
+    ColumnarTableModel* model = m_dataMap.value(info.sourceFileName, nullptr);
+
+    // 取缓存中的数组 (没有时按 compute 生成并登记)
+    auto cached = [this](const ColumnarTableModel* m, int xCol, int yCol, const QString& recipe,
+                         const std::function<void(CachedSeries&)>& compute) {
+        const QString key = seriesKey(m, QString("%1|%2|%3").arg(recipe).arg(xCol).arg(yCol));
+        auto it = m_seriesCache.constFind(key);
+        if (it != m_seriesCache.constEnd()) return *it;
+        CachedSeries series;
+        series.model = m;
+        series.xCol = xCol;
+        series.yCol = yCol;
+        compute(series);
+        m_seriesCache.insert(key, series);
+        return series;
+    };
+
+    if (info.type == 1) { // 压力 + 产量，两个数据源
+        ColumnarTableModel* model2 = m_dataMap.value(info.sourceFileName2, nullptr);
+        if (!model && !model2) return false;
+        if (model) {
+            resolveColumn(model, info.xCol, info.xHeader);
+            resolveColumn(model, info.yCol, info.yHeader);
+            const CachedSeries s = cached(model, info.xCol, info.yCol, "pair", [&](CachedSeries& out) {
+                appendColumnPair(model, info.xCol, info.yCol, out.x, out.y);
+            });
+            info.xData = s.x;
+            info.yData = s.y;
+        }
+        if (model2) {
+            resolveColumn(model2, info.x2Col, info.x2Header);
+            resolveColumn(model2, info.y2Col, info.y2Header);
+            const CachedSeries s = cached(model2, info.x2Col, info.y2Col, "pair", [&](CachedSeries& out) {
+                appendColumnPair(model2, info.x2Col, info.y2Col, out.x, out.y);
+            });
+            info.x2Data = s.x;
+            info.y2Data = s.y;
+        }
+        // 只有全部数据都来自数据源时才按引用保存
+        info.linked = model && (model2 || info.sourceFileName2.isEmpty());
+        info.materialized = true;
+        return true;
+    }
+
+    if (!model) {
+        if (info.type == 2) info.derivData.clear();
+        return false;
+    }
+    resolveColumn(model, info.xCol, info.xHeader);
+    resolveColumn(model, info.yCol, info.yHeader);
+
+    if (info.type == 2) { // 压差与压力导数
+        const QString recipe = QString("deriv|%1|%2|%3|%4|%5|%6")
+                                   .arg(info.testType).arg(info.initialPressure, 0, 'g', 17).arg(info.LSpacing, 0, 'g', 17)
+                                   .arg(info.isSmooth ? 1 : 0).arg(info.smoothFactor).arg(info.smoothMethod);
+        const CachedSeries s = cached(model, info.xCol, info.yCol, recipe, [&](CachedSeries& out) {
+            const ColumnarTableModel::ColumnSpan xs = model->columnSpan(info.xCol);
+            const ColumnarTableModel::ColumnSpan ys = model->columnSpan(info.yCol);
+            double p_shutin = 0;
+            if (model->rowCount() > 0 && model->isNumeric(0, info.yCol)) {
+                p_shutin = model->value(0, info.yCol);
+            }
+            for(int i=0; i<xs.size && i<ys.size; ++i) {
+                double t = xs[i];
+                double p = ys[i];
+                double dp = (info.testType == 0) ? std::abs(info.initialPressure - p) : std::abs(p - p_shutin);
+                if(t > 0 && dp > 0) { // NaN 不满足比较条件
+                    out.x.append(t);
+                    out.y.append(dp);
+                }
+            }
+            out.d = PressureDerivativeCalculator::calculateBourdetDerivative(out.x, out.y, info.LSpacing);
+            if (info.isSmooth) out.d = DerivativeSmoother::smooth(out.x, out.d, DerivativeSmoother::options(info.smoothMethod, info.smoothFactor));
+        });
+        info.xData = s.x;
+        info.yData = s.y;
+        info.derivData = s.d;
+    } else {
+        const CachedSeries s = cached(model, info.xCol, info.yCol, "positive", [&](CachedSeries& out) {
+            const ColumnarTableModel::ColumnSpan xs = model->columnSpan(info.xCol);
+            const ColumnarTableModel::ColumnSpan ys = model->columnSpan(info.yCol);
+            for(int i=0; i<xs.size && i<ys.size; ++i) {
+                double xVal = xs[i];
+                double yVal = ys[i];
+                if (xVal > 1e-9 && yVal > 1e-9) { // NaN 不满足比较条件
+                    out.x.append(xVal);
+                    out.y.append(yVal);
+                }
+            }
+        });
+        info.xData = s.x;
+        info.yData = s.y;
+    }
+    info.linked = true;
+    info.materialized = true;
+    return true;
+}
+
+bool WT_PlottingWidget::curveDependsOn(const CurveInfo& info, const ColumnarTableModel* model, const DataChangeSet& changes) const {
+    if (m_dataMap.value(info.sourceFileName, nullptr) == model
+        && (changes.touchesColumn(info.xCol) || changes.touchesColumn(info.yCol))) return true;
+    return info.type == 1 && m_dataMap.value(info.sourceFileName2, nullptr) == model
+        && (changes.touchesColumn(info.x2Col) || changes.touchesColumn(info.y2Col));
+}
+
+void WT_PlottingWidget::onSourceDataChanged(ColumnarTableModel* model, const DataChangeSet& changes) {
+    if (!model || changes.isEmpty() || m_curves.isEmpty()) return;
+
+    dropCachedSeries(model, changes);
+    bool currentChanged = false;
+    for (auto it = m_curves.begin(); it != m_curves.end(); ++it) {
+        // 尚未生成数据的引用曲线在首次使用时取最新数据
+        if (!it->materialized || !curveDependsOn(it.value(), model, changes)) continue;
+        if (extractCurveData(it.value()) && it.key() == m_currentDisplayedCurve) currentChanged = true;
+    }
+    if (!currentChanged) return;
+
+    // 保持当前的缩放与平移重绘当前曲线
+    saveCurveViewState(m_currentDisplayedCurve);
+    m_graphPress = nullptr;
+    m_graphProd = nullptr;
+    displayCurve(m_curves[m_currentDisplayedCurve], ui->customPlot);
+    restoreCurveViewState(m_currentDisplayedCurve);
+}
+
 // 通用绘图入口函数
 void WT_PlottingWidget::displayCurve(const CurveInfo& info, ChartWidget* widget) {
     if (!widget) return;
@@ -440,7 +710,7 @@ void WT_PlottingWidget::displayCurve(const CurveInfo& info, ChartWidget* widget)
         plot->xAxis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
         plot->yAxis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
 
-        QStandardItemModel* model = m_defaultModel;
+        ColumnarTableModel* model = m_defaultModel;
         if (!info.sourceFileName.isEmpty() && m_dataMap.contains(info.sourceFileName)) {
             model = m_dataMap.value(info.sourceFileName);
         }
@@ -458,7 +728,7 @@ void WT_PlottingWidget::addCurveToPlot(const CurveInfo& info, ChartWidget* widge
 
     QCPGraph* graph = plot->addGraph();
     graph->setName(info.legendName);
-    graph->setData(info.xData, info.yData);
+    GraphLod::setGraphData(graph, info.xData, info.yData);
     graph->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
     graph->setPen(QPen(info.lineColor, info.lineWidth, info.lineStyle));
     graph->setLineStyle(info.lineStyle == Qt::NoPen ? QCPGraph::lsNone : QCPGraph::lsLine);
@@ -480,7 +750,7 @@ void WT_PlottingWidget::drawStackedPlot(const CurveInfo& info, ChartWidget* widg
 
     // 绘制压力曲线
     QCPGraph* gPress = plot->addGraph(topRect->axis(QCPAxis::atBottom), topRect->axis(QCPAxis::atLeft));
-    gPress->setData(info.xData, info.yData);
+    GraphLod::setGraphData(gPress, info.xData, info.yData);
     gPress->setName(info.legendName);
     gPress->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
     gPress->setPen(QPen(info.lineColor, info.lineWidth, info.lineStyle));
@@ -491,37 +761,18 @@ void WT_PlottingWidget::drawStackedPlot(const CurveInfo& info, ChartWidget* widg
     QVector<double> px, py;
 
     if(info.prodGraphType == 0) { // 阶梯图
-        bool isAbsoluteTime = true;
-        if (info.x2Data.size() > 1) {
-            for (int i = 0; i < info.x2Data.size() - 1; ++i) {
-                if (info.x2Data[i+1] <= info.x2Data[i]) {
-                    isAbsoluteTime = false;
-                    break;
-                }
-            }
-        } else {
-            isAbsoluteTime = false;
-        }
-
-        if (isAbsoluteTime && !info.x2Data.isEmpty()) {
-            px = info.x2Data;
-            py = info.y2Data;
-        } else {
-            double t_cum = 0;
-            if(!info.x2Data.isEmpty() && !info.y2Data.isEmpty()) {
-                px.append(0);
-                py.append(info.y2Data[0]);
-            }
-            for(int i=0; i<info.x2Data.size(); ++i) {
-                t_cum += info.x2Data[i];
-                if(i+1 < info.y2Data.size()) {
-                    px.append(t_cum);
-                    py.append(info.y2Data[i+1]);
-                }
-                else if (i < info.y2Data.size()) {
-                    px.append(t_cum);
-                    py.append(info.y2Data[i]);
-                }
+        // 阶段划分与变产量叠加共用 RateHistory::fromSteps (起始时间 / 持续时间两种约定)
+        const RateHistory history = RateHistory::fromSteps(info.x2Data, info.y2Data);
+        px = history.startTime;
+        py = history.rate;
+        // 持续时间数据：末尾补一点，画出最后一个阶段的宽度
+        if (!RateHistory::isStartTimeSequence(info.x2Data) && !px.isEmpty()) {
+            const int n = qMin(info.x2Data.size(), info.y2Data.size());
+            double total = 0.0;
+            for (int i = 0; i < n; ++i) total += qMax(0.0, info.x2Data[i]);
+            if (total > px.last()) {
+                px.append(total);
+                py.append(py.last());
             }
         }
 
@@ -561,7 +812,7 @@ void WT_PlottingWidget::drawStackedPlot(const CurveInfo& info, ChartWidget* widg
         }
     }
 
-    gProd->setData(px, py);
+    GraphLod::setGraphData(gProd, px, py);
     gProd->setName(info.prodLegendName);
 
     gPress->rescaleAxes();
@@ -580,14 +831,14 @@ void WT_PlottingWidget::drawDerivativePlot(const CurveInfo& info, ChartWidget* w
 
     QCPGraph* g1 = plot->addGraph();
     g1->setName(info.legendName);
-    g1->setData(info.xData, info.yData);
+    GraphLod::setGraphData(g1, info.xData, info.yData);
     g1->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
     g1->setPen(QPen(info.lineColor, info.lineWidth, info.lineStyle));
     g1->setLineStyle(info.lineStyle == Qt::NoPen ? QCPGraph::lsNone : QCPGraph::lsLine);
 
     QCPGraph* g2 = plot->addGraph();
     g2->setName(info.prodLegendName);
-    g2->setData(info.xData, info.derivData);
+    GraphLod::setGraphData(g2, info.xData, info.derivData);
     g2->setScatterStyle(QCPScatterStyle(info.derivShape, info.derivPointColor, info.derivPointColor, 6));
     g2->setPen(QPen(info.derivLineColor, info.derivLineWidth, info.derivLineStyle));
     g2->setLineStyle(info.derivLineStyle == Qt::NoPen ? QCPGraph::lsNone : QCPGraph::lsLine);
@@ -604,20 +855,64 @@ void WT_PlottingWidget::onGraphDataModified(QCPGraph* graph) {
 
     if (info.type == 1) { // 压力产量图
         QVector<double> newX, newY;
-        auto dataPtr = graph->data();
-        for (auto it = dataPtr->begin(); it != dataPtr->end(); ++it) {
-            newX.append(it->key);
-            newY.append(it->value);
-        }
+        GraphLod::graphData(graph, newX, newY);
 
         if (graph == m_graphPress) {
             info.xData = newX;
             info.yData = newY;
+            info.linked = false; // 数据已不同于数据源，改为内嵌保存
         }
         else if (graph == m_graphProd) {
             info.x2Data = newX;
             info.y2Data = newY;
+            info.linked = false;
+        }
+    }
+    else if (info.type == 2) { // 双对数图：压差曲线被修改后更新导数曲线
+        QCustomPlot* plot = ui->customPlot->getPlot();
+        if (plot->graphCount() < 2 || graph != plot->graph(0)) return;
+        QCPGraph* derivGraph = plot->graph(1);
+
+        QVector<double> newX, newY;
+        GraphLod::graphData(graph, newX, newY);
+
+        const int n = newX.size();
+        bool sameTime = (n == info.xData.size() && n == info.yData.size() && n == info.derivData.size());
+        for (int i = 0; sameTime && i < n; ++i) sameTime = (newX[i] == info.xData[i]);
+
+        if (!sameTime) {
+            // 时间被修改：整体重算 (数据已不同于数据源，改为内嵌保存)
+            info.linked = false;
+            info.xData = newX;
+            info.yData = newY;
+            QVector<double> derData = PressureDerivativeCalculator::calculateBourdetDerivative(info.xData, info.yData, info.LSpacing);
+            if (info.isSmooth) derData = DerivativeSmoother::smooth(info.xData, derData, DerivativeSmoother::options(info.smoothMethod, info.smoothFactor));
+            info.derivData = derData;
+            GraphLod::updateData(derivGraph, info.xData, info.derivData);
+            plot->replot();
+            return;
+        }
+
+        // 只有压差被修改：在 L-Spacing 窗口内更新导数，并就地改写导数曲线的对应点
+        int first = -1, last = -1;
+        for (int i = 0; i < n; ++i) {
+            if (newY[i] != info.yData[i]) {
+                if (first < 0) first = i;
+                last = i;
+            }
         }
+        if (first < 0) return;
+        info.yData = newY;
+        info.linked = false;
+
+        int from = 0, to = -1;
+        PressureDerivativeCalculator1::updateSmoothedDerivative(info.xData, info.yData, info.LSpacing,
+                                                                DerivativeSmoother::options(info.smoothMethod, info.isSmooth ? info.smoothFactor : 1),
+                                                                first, last, info.derivData, &from, &to);
+        // 经数据源改写：各窗口中共用同一导数数据的曲线一起更新
+        if (!GraphLod::updateValues(derivGraph, info.xData, info.derivData, from, to))
+            GraphLod::updateData(derivGraph, info.xData, info.derivData);
+        plot->replot();
     }
 }
 
@@ -630,6 +925,7 @@ void WT_PlottingWidget::on_btn_Manage_clicked() {
     QString name = item->text();
     if (!m_curves.contains(name)) return;
     CurveInfo& info = m_curves[name];
+    ensureCurveData(info);
 
     DialogCurveInfo dlgInfo;
     dlgInfo.type = info.type;
@@ -659,6 +955,7 @@ void WT_PlottingWidget::on_btn_Manage_clicked() {
         dlgInfo.LSpacing = info.LSpacing;
         dlgInfo.isSmooth = info.isSmooth;
         dlgInfo.smoothFactor = info.smoothFactor;
+        dlgInfo.smoothMethod = info.smoothMethod;
         dlgInfo.style2PointShape = info.derivShape;
         dlgInfo.style2PointColor = info.derivPointColor;
         dlgInfo.style2LineStyle = info.derivLineStyle;
@@ -691,37 +988,9 @@ void WT_PlottingWidget::on_btn_Manage_clicked() {
         currentInfo.xCol = result.xCol;
         currentInfo.yCol = result.yCol;
 
-        if (m_dataMap.contains(currentInfo.sourceFileName)) {
-            QStandardItemModel* model = m_dataMap.value(currentInfo.sourceFileName);
-            if (model && currentInfo.xCol >= 0 && currentInfo.xCol < model->columnCount() &&
-                currentInfo.yCol >= 0 && currentInfo.yCol < model->columnCount()) {
-
-                currentInfo.xData.clear();
-                currentInfo.yData.clear();
-
-                for(int i=0; i<model->rowCount(); ++i) {
-                    QStandardItem* itemX = model->item(i, currentInfo.xCol);
-                    QStandardItem* itemY = model->item(i, currentInfo.yCol);
-
-                    if (itemX && itemY) {
-                        double xVal = itemX->text().toDouble();
-                        double yVal = itemY->text().toDouble();
-
-                        if(currentInfo.type != 2) {
-                            if (xVal > 1e-9 && yVal > 1e-9) {
-                                currentInfo.xData.append(xVal);
-                                currentInfo.yData.append(yVal);
-                            }
-                        } else {
-                            if (xVal > 0) {
-                                currentInfo.xData.append(xVal);
-                                currentInfo.yData.append(yVal);
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        // 列由用户重新选定：按当前表头重新记录
+        currentInfo.xHeader.clear();
+        currentInfo.yHeader.clear();
 
         currentInfo.pointShape = result.pointShape;
         currentInfo.pointColor = result.pointColor;
@@ -734,23 +1003,8 @@ void WT_PlottingWidget::on_btn_Manage_clicked() {
             currentInfo.x2Col = result.x2Col;
             currentInfo.y2Col = result.y2Col;
 
-            if (m_dataMap.contains(currentInfo.sourceFileName2)) {
-                QStandardItemModel* model = m_dataMap.value(currentInfo.sourceFileName2);
-                if (model && currentInfo.x2Col >= 0 && currentInfo.x2Col < model->columnCount() &&
-                    currentInfo.y2Col >= 0 && currentInfo.y2Col < model->columnCount()) {
-
-                    currentInfo.x2Data.clear();
-                    currentInfo.y2Data.clear();
-                    for(int i=0; i<model->rowCount(); ++i) {
-                        QStandardItem* itemX = model->item(i, currentInfo.x2Col);
-                        QStandardItem* itemY = model->item(i, currentInfo.y2Col);
-                        if (itemX && itemY) {
-                            currentInfo.x2Data.append(itemX->text().toDouble());
-                            currentInfo.y2Data.append(itemY->text().toDouble());
-                        }
-                    }
-                }
-            }
+            currentInfo.x2Header.clear();
+            currentInfo.y2Header.clear();
 
             currentInfo.prodGraphType = result.prodGraphType;
             currentInfo.prodPointShape = result.style2PointShape;
@@ -765,36 +1019,18 @@ void WT_PlottingWidget::on_btn_Manage_clicked() {
             currentInfo.LSpacing = result.LSpacing;
             currentInfo.isSmooth = result.isSmooth;
             currentInfo.smoothFactor = result.smoothFactor;
+            currentInfo.smoothMethod = result.smoothMethod;
 
             currentInfo.derivShape = result.style2PointShape;
             currentInfo.derivPointColor = result.style2PointColor;
             currentInfo.derivLineStyle = result.style2LineStyle;
             currentInfo.derivLineColor = result.style2LineColor;
             currentInfo.derivLineWidth = result.style2LineWidth;
-
-            QVector<double> rawT = currentInfo.xData;
-            QVector<double> rawP = currentInfo.yData;
-            currentInfo.xData.clear();
-            currentInfo.yData.clear();
-
-            double p_shutin = (rawP.isEmpty()) ? 0 : rawP[0];
-
-            for(int i=0; i<rawT.size(); ++i) {
-                if (i >= rawP.size()) break;
-                double t = rawT[i];
-                double p = rawP[i];
-                double dp = (currentInfo.testType == 0) ? std::abs(currentInfo.initialPressure - p) : std::abs(p - p_shutin);
-                if(t > 0 && dp > 0) {
-                    currentInfo.xData.append(t);
-                    currentInfo.yData.append(dp);
-                }
-            }
-
-            QVector<double> derData = PressureDerivativeCalculator::calculateBourdetDerivative(currentInfo.xData, currentInfo.yData, currentInfo.LSpacing);
-            if (currentInfo.isSmooth) derData = PressureDerivativeCalculator1::smoothData(derData, currentInfo.smoothFactor);
-            currentInfo.derivData = derData;
         }
 
+        // 按新的数据源、列与导数参数重新取数 (与新建曲线相同)
+        extractCurveData(currentInfo);
+
         if(m_currentDisplayedCurve == currentInfo.name) {
             displayCurve(currentInfo, ui->customPlot);
             m_viewStates.remove(currentInfo.name);
@@ -825,22 +1061,7 @@ void WT_PlottingWidget::on_btn_NewCurve_clicked() {
         info.lineWidth = dlg.getLineWidth();
 
         info.type = 0;
-        if (m_dataMap.contains(info.sourceFileName)) {
-            QStandardItemModel* model = m_dataMap.value(info.sourceFileName);
-            for(int i=0; i<model->rowCount(); ++i) {
-                QStandardItem* itemX = model->item(i, info.xCol);
-                QStandardItem* itemY = model->item(i, info.yCol);
-
-                if (itemX && itemY) {
-                    double xVal = itemX->text().toDouble();
-                    double yVal = itemY->text().toDouble();
-                    if (xVal > 1e-9 && yVal > 1e-9) {
-                        info.xData.append(xVal);
-                        info.yData.append(yVal);
-                    }
-                }
-            }
-        }
+        extractCurveData(info);
         m_curves.insert(info.name, info);
         ui->listWidget_Curves->addItem(info.name);
 
@@ -880,29 +1101,7 @@ void WT_PlottingWidget::on_btn_PressureRate_clicked() {
         info.x2Col = dlg.getProdXCol();
         info.y2Col = dlg.getProdYCol();
 
-        if (m_dataMap.contains(info.sourceFileName)) {
-            QStandardItemModel* modelP = m_dataMap.value(info.sourceFileName);
-            for(int i=0; i<modelP->rowCount(); ++i) {
-                QStandardItem* itemX = modelP->item(i, info.xCol);
-                QStandardItem* itemY = modelP->item(i, info.yCol);
-                if (itemX && itemY) {
-                    info.xData.append(itemX->text().toDouble());
-                    info.yData.append(itemY->text().toDouble());
-                }
-            }
-        }
-
-        if (m_dataMap.contains(info.sourceFileName2)) {
-            QStandardItemModel* modelQ = m_dataMap.value(info.sourceFileName2);
-            for(int i=0; i<modelQ->rowCount(); ++i) {
-                QStandardItem* itemX = modelQ->item(i, info.x2Col);
-                QStandardItem* itemY = modelQ->item(i, info.y2Col);
-                if (itemX && itemY) {
-                    info.x2Data.append(itemX->text().toDouble());
-                    info.y2Data.append(itemY->text().toDouble());
-                }
-            }
-        }
+        extractCurveData(info);
 
         info.pointShape = dlg.getPressShape();
         info.pointColor = dlg.getPressPointColor();
@@ -957,33 +1156,8 @@ void WT_PlottingWidget::on_btn_Derivative_clicked() {
         info.LSpacing = dlg.getLSpacing();
         info.isSmooth = dlg.isSmoothEnabled();
         info.smoothFactor = dlg.getSmoothFactor();
-        if (m_dataMap.contains(info.sourceFileName)) {
-            QStandardItemModel* model = m_dataMap.value(info.sourceFileName);
-
-            double p_shutin = 0;
-            if (model->rowCount() > 0) {
-                QStandardItem* item0 = model->item(0, info.yCol);
-                if(item0) p_shutin = item0->text().toDouble();
-            }
-
-            for(int i=0; i<model->rowCount(); ++i) {
-                QStandardItem* itemX = model->item(i, info.xCol);
-                QStandardItem* itemY = model->item(i, info.yCol);
-
-                if (itemX && itemY) {
-                    double t = itemX->text().toDouble();
-                    double p = itemY->text().toDouble();
-                    double dp = (info.testType == 0) ? std::abs(info.initialPressure - p) : std::abs(p - p_shutin);
-                    if(t > 0 && dp > 0) {
-                        info.xData.append(t);
-                        info.yData.append(dp);
-                    }
-                }
-            }
-        }
-        QVector<double> derData = PressureDerivativeCalculator::calculateBourdetDerivative(info.xData, info.yData, info.LSpacing);
-        if (info.isSmooth) derData = PressureDerivativeCalculator1::smoothData(derData, info.smoothFactor);
-        info.derivData = derData;
+        info.smoothMethod = dlg.getSmoothMethod();
+        extractCurveData(info);
         info.pointShape = dlg.getPressShape();
         info.pointColor = dlg.getPressPointColor();
         info.lineStyle = dlg.getPressLineStyle();
@@ -1020,6 +1194,7 @@ void WT_PlottingWidget::on_btn_Delete_clicked() {
     if(QMessageBox::question(this, "确认删除", "确定要删除曲线 \"" + name + "\" 吗？") == QMessageBox::Yes) {
         m_curves.remove(name); delete item;
         m_viewStates.remove(name);
+        pruneSeriesCache();
         if(m_currentDisplayedCurve == name) { ui->customPlot->clearGraphs(); m_currentDisplayedCurve.clear(); }
     }
 }
@@ -1072,10 +1247,11 @@ void WT_PlottingWidget::onGraphClicked(QCPAbstractPlottable *plottable, int data
     }
 }
 
-// 导出数据：使用 QtXlsx 导出真正的 Excel 文件，支持不同曲线的列定义
+// 导出数据：按曲线类型组织导出列，经 DataExportService 在后台写出 xlsx / csv / txt
 void WT_PlottingWidget::executeExport(bool fullRange, double start, double end) {
     if (m_currentDisplayedCurve.isEmpty() || !m_curves.contains(m_currentDisplayedCurve)) return;
     CurveInfo& info = m_curves[m_currentDisplayedCurve];
+    if (!ensureCurveData(info)) return;
 
     // 1. 获取保存路径
     QString dir = ModelParameter::instance()->getProjectPath();
@@ -1088,11 +1264,7 @@ void WT_PlottingWidget::executeExport(bool fullRange, double start, double end)
     QString file = QFileDialog::getSaveFileName(this, "导出数据", defaultName, filter);
     if(file.isEmpty()) return;
 
-    // 2. 准备数据容器
-    QStringList headers;
-    QVector<QStringList> dataRows;
-
-    // 获取通用曲线的轴标签
+    // 2. 获取通用曲线的轴标签 (表头)
     QString xLabel = "X轴";
     QString yLabel = "Y轴";
     if (ui->customPlot->getPlot()->xAxis) xLabel = ui->customPlot->getPlot()->xAxis->label();
@@ -1101,150 +1273,67 @@ void WT_PlottingWidget::executeExport(bool fullRange, double start, double end)
     if (yLabel.isEmpty()) yLabel = "Y数据";
 
     // =========================================================
-    // 数据组装逻辑
+    // 3. 组织导出列：直接引用曲线数组，部分导出的相对时间以偏移量表示 (不复制数据)
     // =========================================================
-
-    // --- Type 0: 通用曲线 ---
-    if (info.type == 0) {
-        if (fullRange) {
-            // 全量: X轴名, Y轴名
-            headers << xLabel << yLabel;
-        } else {
-            // 部分: X轴名, Y轴名, 原始+X轴名
-            headers << xLabel << yLabel << ("原始" + xLabel);
-        }
-
+    ExportTable table;
+    if (!fullRange) {
         for (int i = 0; i < info.xData.size(); ++i) {
-            double t = info.xData[i];
-            if (!fullRange && (t < start || t > end)) continue;
-
-            QStringList row;
-            double val = info.yData[i];
-
-            if (fullRange) {
-                row << QString::number(t) << QString::number(val);
-            } else {
-                row << QString::number(t - start) << QString::number(val) << QString::number(t);
-            }
-            dataRows.append(row);
+            const double t = info.xData[i];
+            if (t >= start && t <= end) table.rows.append(i);
         }
-    }
-    // --- Type 1: 压力产量分析 ---
-    else if (info.type == 1) {
-        // 始终保持: 时间, 压力, 产量, 原始时间
-        headers << "时间" << "压力" << "产量" << "原始时间";
-
-        for (int i = 0; i < info.xData.size(); ++i) {
-            double t = info.xData[i];
-            if (!fullRange && (t < start || t > end)) continue;
-
-            double p = info.yData[i];
-            double q = 0.0;
-            // 获取产量值
-            if (m_graphProd) {
-                q = getProductionValueFromGraph(t, m_graphProd);
-            } else if (i < info.y2Data.size()) {
-                q = info.y2Data[i];
-            }
-
-            QStringList row;
-            double timeExport = fullRange ? t : (t - start);
-
-            row << QString::number(timeExport)
-                << QString::number(p)
-                << QString::number(q)
-                << QString::number(t);
-            dataRows.append(row);
-        }
-    }
-    // --- Type 2: 压力导数分析 ---
-    else if (info.type == 2) {
-        if (fullRange) {
-            // 全量: 时间, 压差, 压力导数
-            headers << "时间" << "压差" << "压力导数";
-        } else {
-            // 部分: 时间, 压差, 原始时间
-            headers << "时间" << "压差" << "原始时间";
-        }
-
-        for (int i = 0; i < info.xData.size(); ++i) {
-            double t = info.xData[i];
-            if (!fullRange && (t < start || t > end)) continue;
-
-            double dp = info.yData[i];
-
-            QStringList row;
-            if (fullRange) {
-                double deriv = (i < info.derivData.size()) ? info.derivData[i] : 0.0;
-                row << QString::number(t) << QString::number(dp) << QString::number(deriv);
-            } else {
-                // 部分导出不包含导数值
-                row << QString::number(t - start) << QString::number(dp) << QString::number(t);
-            }
-            dataRows.append(row);
+        if (table.rows.isEmpty()) {
+            QMessageBox::information(this, "提示", "所选范围内没有数据。");
+            return;
         }
+    } else {
+        table.rowCount = info.xData.size();
     }
+    const double offset = fullRange ? 0.0 : start;
 
-    // =========================================================
-    // 文件写入逻辑
-    // =========================================================
-
-    bool isXlsx = file.endsWith(".xlsx", Qt::CaseInsensitive);
-
-    if (isXlsx) {
-        // 使用 QtXlsx 库写入
-        QXlsx::Document xlsx;
-
-        // 1. 写表头 (第一行)
-        for (int col = 0; col < headers.size(); ++col) {
-            // QtXlsx 行列从 1 开始
-            xlsx.write(1, col + 1, headers[col]);
-        }
-
-        // 2. 写数据
-        for (int row = 0; row < dataRows.size(); ++row) {
-            QStringList& lineData = dataRows[row];
-            for (int col = 0; col < lineData.size(); ++col) {
-                // 尝试转为 double 写入以保持数字格式，否则存为文本
-                bool ok;
-                double val = lineData[col].toDouble(&ok);
-                if (ok) {
-                    xlsx.write(row + 2, col + 1, val);
-                } else {
-                    xlsx.write(row + 2, col + 1, lineData[col]);
-                }
-            }
-        }
-
-        if (xlsx.saveAs(file)) {
-            // Success
-        } else {
-            QMessageBox::warning(this, "错误", "保存 xlsx 文件失败，请检查文件是否被占用。");
-            return;
+    if (info.type == 0) {
+        // 全量: X轴名, Y轴名；部分: X轴名, Y轴名, 原始+X轴名
+        table.columns << ExportColumn::numbers(xLabel, info.xData, 0, offset)
+                      << ExportColumn::numbers(yLabel, info.yData);
+        if (!fullRange) table.columns << ExportColumn::numbers("原始" + xLabel, info.xData);
+    } else if (info.type == 1) {
+        // 始终保持: 时间, 压力, 产量, 原始时间
+        // 阶梯产量曲线按其完整数据建立阶段索引，压力时刻递增时整段导出只需一次归并遍历
+        QVector<double> rates(info.xData.size(), 0.0);
+        RateHistory rateSteps;
+        const bool stepRates = m_graphProd && m_graphProd->lineStyle() == QCPGraph::lsStepLeft;
+        if (stepRates) {
+            QVector<double> keys, values;
+            GraphLod::graphData(m_graphProd, keys, values);
+            rateSteps = RateHistory::fromStartTimes(keys, values);
         }
-
-    } else {
-        // CSV 或 TXT (保持 UTF-8 BOM)
-        QFile f(file);
-        if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QMessageBox::warning(this, "错误", "无法打开文件进行写入。");
-            return;
+        RateCursor cursor(rateSteps);
+        const int count = table.size();
+        for (int k = 0; k < count; ++k) {
+            const int i = table.rowAt(k);
+            const double t = info.xData[i];
+            if (stepRates) rates[i] = cursor.rateAt(t);
+            else if (m_graphProd) rates[i] = getProductionValueFromGraph(t, m_graphProd);
+            else if (i < info.y2Data.size()) rates[i] = info.y2Data[i];
         }
+        table.columns << ExportColumn::numbers("时间", info.xData, 0, offset)
+                      << ExportColumn::numbers("压力", info.yData)
+                      << ExportColumn::numbers("产量", rates)
+                      << ExportColumn::numbers("原始时间", info.xData);
+    } else if (info.type == 2) {
+        // 全量: 时间, 压差, 压力导数；部分: 时间, 压差, 原始时间 (部分导出不包含导数值)
+        table.columns << ExportColumn::numbers("时间", info.xData, 0, offset)
+                      << ExportColumn::numbers("压差", info.yData)
+                      << (fullRange ? ExportColumn::numbers("压力导数", info.derivData)
+                                    : ExportColumn::numbers("原始时间", info.xData));
+    }
 
-        QTextStream out(&f);
-        out.setGenerateByteOrderMark(true);
-        out.setEncoding(QStringConverter::Utf8);
-
-        QString sep = file.endsWith(".csv", Qt::CaseInsensitive) ? "," : "\t";
-
-        // 写表头
-        out << headers.join(sep) << "\n";
-
-        // 写数据
-        for (const QStringList& row : dataRows) {
-            out << row.join(sep) << "\n";
-        }
-        f.close();
+    // 后台线程写出 (xlsx 经 XlsxStreamWriter 流式写出)，期间显示可取消的进度框
+    QString error;
+    const DataExportService::Result result = DataExportService::exportWithProgress(this, file, table, &error);
+    if (result == DataExportService::Cancelled) return;
+    if (result == DataExportService::Failed) {
+        QMessageBox::warning(this, "错误", error);
+        return;
     }
 
     // 4. 导出后交互
@@ -1265,6 +1354,22 @@ void WT_PlottingWidget::executeExport(bool fullRange, double start, double end)
 double WT_PlottingWidget::getProductionValueFromGraph(double t, QCPGraph* graph) {
     if (!graph) return 0.0;
 
+    // 抽稀显示的曲线按完整数据查找 (与下方 findBegin 的规则相同；不抽稀时数组未必有序，按数据容器查找)
+    const GraphLod* lod = GraphLod::find(graph);
+    if (lod && lod->source()->useLod()) {
+        const QVector<double>& keys = lod->keys();
+        const QVector<double>& values = lod->values();
+        if (keys.isEmpty()) return 0.0;
+        int i = int(std::lower_bound(keys.constBegin(), keys.constEnd(), t) - keys.constBegin());
+        if (i > 0) --i;
+        if (graph->lineStyle() == QCPGraph::lsStepLeft) return values[i];
+        if (qAbs(keys[i] - t) < 1e-9 || i == 0) return values[i];
+        const double t1 = keys[i - 1], v1 = values[i - 1];
+        const double t2 = keys[i], v2 = values[i];
+        if (qAbs(t2 - t1) < 1e-9) return v1;
+        return v1 + (t - t1) * (v2 - v1) / (t2 - t1);
+    }
+
     if (graph->lineStyle() == QCPGraph::lsStepLeft) {
         auto data = graph->data();
         auto it = data->findBegin(t);
@@ -1287,5 +1392,9 @@ double WT_PlottingWidget::getProductionValueFromGraph(double t, QCPGraph* graph)
     return v1 + (t - t1) * (v2 - v1) / (t2 - t1);
 }
 
-double WT_PlottingWidget::getProductionValueAt(double t, const CurveInfo& info) { Q_UNUSED(t); return info.y2Data.isEmpty() ? 0 : info.y2Data.last(); }
+double WT_PlottingWidget::getProductionValueAt(double t, const CurveInfo& info)
+{
+    // 产量数据按阶梯约定 (与双坐标图一致) 查找所在阶段
+    return RateHistory::fromSteps(info.x2Data, info.y2Data).rateAt(t);
+}
 QListWidgetItem* WT_PlottingWidget::getCurrentSelectedItem() { return ui->listWidget_Curves->currentItem(); }
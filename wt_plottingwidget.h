@@ -6,17 +6,27 @@
  * 2. CurveInfo 结构体支持双文件数据源（压力+产量）。
  * 3. 增加了视图状态保存功能，切换曲线时可保持上次的缩放和平移视图。
  * 4. [本次修改] 优化导出功能，支持中文表头，修正产量读取，增加导出后跳转文件的信号。
+ * 5. [增量保存] 曲线数据数组的 JSON 编码经 JsonVectorCache 缓存，保存时只重新编码改变了的数组。
+ * 6. [自动备份] curves 返回曲线表的隐式共享副本，供后台自动备份在其他线程编码。
+ * 7. [变更合并] onSourceDataChanged 按变更集只为依赖变化列的曲线重新取数，当前显示的曲线随即重绘。
+ * 8. [数据引用] CurveInfo 的数据可只保存为对数据源列的引用 (linked)：打开项目时不读入数据数组，
+ *    首次使用时按列与取数配方从数据表生成，相同配方的曲线共用缓存中的同一份数组。
+ * 9. [共享数据] 独立图表窗口以 QPointer 记录 (窗口关闭即自行删除，不留下悬空指针)。
  */
 
 #ifndef WT_PLOTTINGWIDGET_H
 #define WT_PLOTTINGWIDGET_H
 
 #include <QWidget>
-#include <QStandardItemModel>
+#include "columnartablemodel.h"
 #include <QMap>
+#include <QHash>
+#include <QPointer>
 #include <QListWidgetItem>
 #include "chartwidget.h"
 #include "chartwindow.h"
+#include "jsonvectorcache.h"
+#include "datachangeset.h"
 
 // 曲线配置结构体
 struct CurveInfo {
@@ -55,6 +65,7 @@ struct CurveInfo {
     double LSpacing;
     bool isSmooth;
     int smoothFactor;
+    int smoothMethod = 0; // 平滑方法 (DerivativeSmoother::Method)
     QVector<double> derivData;
     QCPScatterStyle::ScatterShape derivShape = QCPScatterStyle::ssNone;
     QColor derivPointColor = Qt::red;
@@ -62,7 +73,14 @@ struct CurveInfo {
     QColor derivLineColor = Qt::red;
     int derivLineWidth = 2; // [新增] 导数曲线线宽
 
-    QJsonObject toJson() const;
+    // 数据来源：linked 为真时数据数组由数据源的列 (序号与表头名) 按上面的配方 (压差、导数 L-Spacing、平滑) 生成，
+    // 保存时只写引用；曲线被拖动修改过或数据源已关闭时为假，数据数组以二进制内嵌保存
+    bool linked = false;
+    bool materialized = true; // 数据数组已生成 (按引用读入的曲线在首次使用时生成)
+    QString xHeader, yHeader, x2Header, y2Header;
+
+    // cache 非空时数据数组经缓存编码 (未改变的数组不再逐元素转换)
+    QJsonObject toJson(JsonVectorCache* cache = nullptr) const;
     static CurveInfo fromJson(const QJsonObject& json);
 };
 
@@ -79,13 +97,15 @@ public:
     ~WT_PlottingWidget();
 
     // 设置数据模型映射表
-    void setDataModels(const QMap<QString, QStandardItemModel*>& models);
+    void setDataModels(const QMap<QString, ColumnarTableModel*>& models);
 
     // 设置项目文件夹路径 (已弃用，改用 ModelParameter)
     void setProjectFolderPath(const QString& path);
 
     void loadProjectData();
     void saveProjectData();
+    // 全部曲线配置 (隐式共享副本，可交给后台线程序列化)
+    QMap<QString, CurveInfo> curves() const { return m_curves; }
 
     // 清除所有图表
     void clearAllPlots();
@@ -93,6 +113,10 @@ public:
     // 更新图表标题
     void updateChartTitle(const QString& title);
 
+public slots:
+    // 数据表内容修改：依赖于变化列的曲线重新取数
+    void onSourceDataChanged(ColumnarTableModel* model, const DataChangeSet& changes);
+
 signals:
     // [新增] 信号：请求在数据界面打开导出的文件
     void viewExportedFile(const QString& filePath);
@@ -126,15 +150,28 @@ private:
     Ui::WT_PlottingWidget *ui;
 
     // 存储所有已打开文件的数据模型
-    QMap<QString, QStandardItemModel*> m_dataMap;
+    QMap<QString, ColumnarTableModel*> m_dataMap;
 
     // 默认模型 (Fallback)
-    QStandardItemModel* m_defaultModel;
+    ColumnarTableModel* m_defaultModel;
 
     QMap<QString, CurveInfo> m_curves;
     QString m_currentDisplayedCurve;
+    JsonVectorCache m_jsonCache; // 保存时的数据数组编码缓存
 
-    QList<QWidget*> m_openedWindows;
+    // 按数据源列与取数配方缓存的曲线数组 (配方相同的曲线共用；数据表修改或关闭后按表失效)
+    struct CachedSeries {
+        const ColumnarTableModel* model = nullptr;
+        int xCol = -1, yCol = -1;
+        QVector<double> x, y, d;
+    };
+    mutable QHash<QString, CachedSeries> m_seriesCache;
+    // 丢弃变更集涉及的列上的缓存数组
+    void dropCachedSeries(const ColumnarTableModel* model, const DataChangeSet& changes);
+    // 丢弃已没有曲线使用的缓存数组
+    void pruneSeriesCache();
+
+    QList<QPointer<QWidget>> m_openedWindows;
 
     bool m_isSelectingForExport;
     int m_selectionStep;
@@ -165,6 +202,14 @@ private:
     void saveCurveViewState(const QString& name);
     void restoreCurveViewState(const QString& name);
 
+    // 按曲线的数据源与列 (及导数参数) 重新取曲线数据；数据源不在当前模型表中时返回 false
+    bool extractCurveData(CurveInfo& info) const;
+    // 曲线的数据源均已打开
+    bool curveSourcesAvailable(const CurveInfo& info) const;
+    // 按引用读入、尚未生成数据的曲线在数据源可用时生成数据；返回曲线是否有数据可用
+    bool ensureCurveData(CurveInfo& info) const;
+    bool curveDependsOn(const CurveInfo& info, const ColumnarTableModel* model, const DataChangeSet& changes) const;
+
     // [新增] 通用绘图入口：在指定组件上显示曲线
     void displayCurve(const CurveInfo& info, ChartWidget* widget);
 
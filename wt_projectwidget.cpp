@@ -6,6 +6,7 @@
  * 2. 实现"新建"、"打开"、"关闭"、"退出"的详细交互逻辑。
  * 3. 修复了双重弹窗问题：操作成功后不在此处弹窗，而是发送信号由主界面统一提示。
  * 4. 统一了所有交互弹窗的样式为白底黑字。
+ * 5. [分段加载] 打开项目经 ModelParameter::openProject：只同步读取 .pwt，图表与表格数据在后台解析，由主界面按部分恢复。
  */
 
 #include "wt_projectwidget.h"
@@ -220,8 +221,8 @@ void WT_ProjectWidget::onOpenProjectClicked()
 
     if (filePath.isEmpty()) return;
 
-    // 加载项目数据
-    if (ModelParameter::instance()->loadProject(filePath)) {
+    // 加载项目数据 (附属文件在后台解析)
+    if (ModelParameter::instance()->openProject(filePath)) {
         // 设置状态为已打开
         setProjectState(true, filePath);
 
@@ -0,0 +1,601 @@
+/*
+ * xlsxstream.cpp
+ * 文件作用: .xlsx 工作簿流式读写实现文件
+ * 功能描述:
+ * 1. 读取顺序：workbook.xml (日期系统、第一个工作表) -> workbook.xml.rels (工作表路径) ->
+ *    sharedStrings.xml -> styles.xml (哪些单元格样式是日期格式) -> 工作表 (逐行拉取)。
+ * 2. 工作表中缺失的行按空行补齐，每行至少补齐到 <dimension> 记录的列数，与原先按 dimension 遍历单元格的结果相同。
+ * 3. 写入时先写出固定部件 ([Content_Types].xml、关系、workbook、styles)，再流式写工作表条目。
+ * 4. [有界预览] 工作表按行拉取 (SheetRowReader)，完整读取与只取前若干行的预览共用同一套取值规则。
+ */
+
+#include "xlsxstream.h"
+#include "dataimportdialog.h"
+#include "cancellationtoken.h"
+#include "memoryaccounting.h"
+#include "tracing.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QLocale>
+#include <QXmlStreamReader>
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+const int kBatchRows = 4096;
+const int kFlushBytes = 64 * 1024;
+
+// 内置日期时间数字格式 (含中文区域设置使用的 27-36、50-58)
+bool isBuiltInDateFormat(int id)
+{
+    return (id >= 14 && id <= 22) || (id >= 27 && id <= 36) || (id >= 45 && id <= 47) || (id >= 50 && id <= 58);
+}
+
+// 自定义格式码是否为日期时间：去掉引号内文本、转义字符与颜色/条件等 [] 段后，第一节含 y/m/d/h/s
+bool isDateFormatCode(const QString& code)
+{
+    bool inQuote = false;
+    for (int i = 0; i < code.size(); ++i) {
+        const QChar c = code[i];
+        if (inQuote) {
+            if (c == '"') inQuote = false;
+            continue;
+        }
+        if (c == '"') { inQuote = true; continue; }
+        if (c == '\\' || c == '_' || c == '*') { ++i; continue; }
+        if (c == ';') break;
+        if (c == '[') {
+            const int close = code.indexOf(']', i);
+            if (close < 0) break;
+            // [h]、[mm]、[ss] 为累计时间，属于日期时间格式
+            const QString inner = code.mid(i + 1, close - i - 1).toLower();
+            if (!inner.isEmpty() && inner.count(inner[0]) == inner.size() && QString("hms").contains(inner[0])) return true;
+            i = close;
+            continue;
+        }
+        switch (c.toLower().unicode()) {
+        case 'y': case 'm': case 'd': case 'h': case 's':
+            return true;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+// 单元格引用中的列号 (A -> 0)；没有字母时返回 -1
+int columnFromReference(QStringView ref)
+{
+    int column = 0;
+    int letters = 0;
+    for (QChar c : ref) {
+        const ushort u = c.unicode();
+        if (u >= 'A' && u <= 'Z') column = column * 26 + (u - 'A' + 1);
+        else if (u >= 'a' && u <= 'z') column = column * 26 + (u - 'a' + 1);
+        else break;
+        ++letters;
+    }
+    return letters > 0 ? column - 1 : -1;
+}
+
+QString serialToDateTime(double serial, bool date1904)
+{
+    // 1900 日期系统沿用 Lotus 1-2-3 的闰年错误 (1900-02-29 存在)，60 之后的序号需减一天
+    QDate base;
+    if (date1904) base = QDate(1904, 1, 1);
+    else base = serial < 61 ? QDate(1899, 12, 31) : QDate(1899, 12, 30);
+    const QDateTime dt(base, QTime(0, 0), Qt::UTC);
+    return dt.addMSecs(qRound64(serial * 86400000.0)).toString("yyyy-MM-dd hh:mm:ss");
+}
+
+// 读取当前元素内 (不含 <rPh> 注音) 所有 <t> 的文本，读到该元素结束
+QString readRichText(QXmlStreamReader& xml)
+{
+    QString text;
+    const QString endName = xml.name().toString();
+    int skipDepth = 0;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement()) {
+            if (skipDepth > 0 || xml.name() == QLatin1String("rPh")) ++skipDepth;
+            else if (xml.name() == QLatin1String("t")) text += xml.readElementText();
+        } else if (xml.isEndElement()) {
+            if (skipDepth > 0) --skipDepth;
+            else if (xml.name() == endName) break;
+        }
+    }
+    return text;
+}
+
+QString resolveTarget(const QString& target)
+{
+    if (target.startsWith('/')) return target.mid(1);
+    return "xl/" + target;
+}
+
+struct WorkbookInfo {
+    QString sheetPath = "xl/worksheets/sheet1.xml";
+    bool date1904 = false;
+};
+
+WorkbookInfo readWorkbook(const ZipArchiveReader& zip)
+{
+    WorkbookInfo info;
+    QString sheetId;
+    QXmlStreamReader xml(zip.readEntry("xl/workbook.xml"));
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement()) continue;
+        if (xml.name() == QLatin1String("workbookPr")) {
+            const QStringView v = xml.attributes().value("date1904");
+            info.date1904 = (v == QLatin1String("1") || v == QLatin1String("true"));
+        } else if (xml.name() == QLatin1String("sheet") && sheetId.isEmpty()) {
+            for (const QXmlStreamAttribute& a : xml.attributes()) {
+                if (a.name() == QLatin1String("id") && a.prefix() == QLatin1String("r")) sheetId = a.value().toString();
+            }
+        }
+    }
+    if (sheetId.isEmpty()) return info;
+
+    QXmlStreamReader rels(zip.readEntry("xl/_rels/workbook.xml.rels"));
+    while (!rels.atEnd()) {
+        rels.readNext();
+        if (rels.isStartElement() && rels.name() == QLatin1String("Relationship") &&
+            rels.attributes().value("Id") == sheetId) {
+            info.sheetPath = resolveTarget(rels.attributes().value("Target").toString());
+            break;
+        }
+    }
+    return info;
+}
+
+QStringList readSharedStrings(const ZipArchiveReader& zip)
+{
+    QStringList strings;
+    QIODevice* device = zip.openEntry("xl/sharedStrings.xml");
+    if (!device) return strings;
+    QXmlStreamReader xml(device);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement()) continue;
+        if (xml.name() == QLatin1String("sst")) {
+            const int count = xml.attributes().value("uniqueCount").toInt();
+            if (count > 0) strings.reserve(count);
+        } else if (xml.name() == QLatin1String("si")) {
+            strings.append(readRichText(xml));
+        }
+    }
+    delete device;
+    return strings;
+}
+
+// 每个单元格样式 (cellXfs 的序号) 是否为日期时间格式
+QVector<bool> readDateStyles(const ZipArchiveReader& zip)
+{
+    QHash<int, bool> customFormats;
+    QVector<bool> dateStyles;
+    QXmlStreamReader xml(zip.readEntry("xl/styles.xml"));
+    bool inCellXfs = false;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement()) {
+            if (xml.name() == QLatin1String("numFmt")) {
+                customFormats.insert(xml.attributes().value("numFmtId").toInt(),
+                                     isDateFormatCode(xml.attributes().value("formatCode").toString()));
+            } else if (xml.name() == QLatin1String("cellXfs")) {
+                inCellXfs = true;
+            } else if (inCellXfs && xml.name() == QLatin1String("xf")) {
+                const int id = xml.attributes().value("numFmtId").toInt();
+                dateStyles.append(customFormats.contains(id) ? customFormats.value(id) : isBuiltInDateFormat(id));
+            }
+        } else if (xml.isEndElement() && xml.name() == QLatin1String("cellXfs")) {
+            inCellXfs = false;
+        }
+    }
+    return dateStyles;
+}
+
+// 按行拉取第一个工作表：缺失的行按空行补齐，每行至少补齐到 <dimension> 记录的列数
+class SheetRowReader
+{
+public:
+    explicit SheetRowReader(const QString& path)
+        : m_zip(path)
+    {
+        if (!m_zip.isValid()) return;
+        m_workbook = readWorkbook(m_zip);
+        m_device = m_zip.openEntry(m_workbook.sheetPath);
+        if (!m_device) return;
+        m_sharedStrings = readSharedStrings(m_zip);
+        m_dateStyles = readDateStyles(m_zip);
+        m_total = m_device->size();
+        m_xml.setDevice(m_device);
+    }
+
+    ~SheetRowReader() { delete m_device; }
+
+    bool isOpen() const { return m_device != nullptr; }
+    bool hasError() const { return m_xml.hasError(); }
+    QString errorString() const { return m_xml.errorString(); }
+    qint64 pos() const { return m_device ? m_device->pos() : 0; }
+    qint64 total() const { return m_total; }
+
+    // 读取下一行 (行号从 1 开始)；工作表结束或格式错误时返回 false
+    bool next(int& row, QStringList& fields)
+    {
+        if (!m_device) return false;
+        if (m_pendingRow > 0) {
+            // 先补齐缺失的行，再交出已读取的行
+            row = ++m_lastRow;
+            if (row < m_pendingRow) {
+                fields.clear();
+                for (int c = 0; c < m_minColumns; ++c) fields.append(QString());
+            } else {
+                fields = m_pendingFields;
+                m_pendingRow = 0;
+            }
+            return true;
+        }
+
+        while (!m_xml.atEnd()) {
+            m_xml.readNext();
+            if (!m_xml.isStartElement()) continue;
+
+            if (m_xml.name() == QLatin1String("dimension")) {
+                // ref 形如 "A1:F100"
+                const QStringView ref = m_xml.attributes().value("ref");
+                const int colon = ref.indexOf(':');
+                m_minColumns = columnFromReference(colon >= 0 ? ref.mid(colon + 1) : ref) + 1;
+            } else if (m_xml.name() == QLatin1String("row")) {
+                const int r = m_xml.attributes().value("r").toInt();
+                const int current = r > m_lastRow ? r : m_lastRow + 1;
+                readRow(fields);
+                if (current > m_lastRow + 1) {
+                    m_pendingRow = current;
+                    m_pendingFields = fields;
+                    return next(row, fields);
+                }
+                row = m_lastRow = current;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    void readRow(QStringList& fields)
+    {
+        fields.clear();
+        int nextColumn = 0;
+        while (!m_xml.atEnd()) {
+            m_xml.readNext();
+            if (m_xml.isEndElement() && m_xml.name() == QLatin1String("row")) break;
+            if (!m_xml.isStartElement() || m_xml.name() != QLatin1String("c")) continue;
+
+            const QXmlStreamAttributes attrs = m_xml.attributes();
+            int column = columnFromReference(attrs.value("r"));
+            if (column < 0) column = nextColumn;
+            nextColumn = column + 1;
+            const QString type = attrs.value("t").toString();
+            const int style = attrs.value("s").toInt();
+
+            QString value;
+            bool hasValue = false;
+            while (!m_xml.atEnd()) {
+                m_xml.readNext();
+                if (m_xml.isEndElement() && m_xml.name() == QLatin1String("c")) break;
+                if (!m_xml.isStartElement()) continue;
+                if (m_xml.name() == QLatin1String("v")) {
+                    value = m_xml.readElementText();
+                    hasValue = true;
+                } else if (m_xml.name() == QLatin1String("is")) {
+                    value = readRichText(m_xml);
+                    hasValue = true;
+                } else {
+                    m_xml.skipCurrentElement(); // 公式等
+                }
+            }
+            if (!hasValue) continue;
+
+            QString text;
+            if (type == QLatin1String("s")) {
+                const int index = value.toInt();
+                if (index >= 0 && index < m_sharedStrings.size()) text = m_sharedStrings[index];
+            } else if (type == QLatin1String("b")) {
+                text = (value.trimmed() == QLatin1String("1")) ? "true" : "false";
+            } else if (type == QLatin1String("d")) {
+                const QDateTime dt = QDateTime::fromString(value, Qt::ISODate);
+                text = dt.isValid() ? dt.toString("yyyy-MM-dd hh:mm:ss") : value;
+            } else if (type.isEmpty() || type == QLatin1String("n")) {
+                bool ok = false;
+                const double v = value.toDouble(&ok);
+                if (!ok) text = value;
+                else if (style >= 0 && style < m_dateStyles.size() && m_dateStyles[style]) text = serialToDateTime(v, m_workbook.date1904);
+                else text = QString::number(v, 'g', QLocale::FloatingPointShortest);
+            } else {
+                text = value; // str / inlineStr / e
+            }
+
+            while (fields.size() < column) fields.append(QString());
+            if (fields.size() == column) fields.append(text);
+            else fields[column] = text; // 引用重复时以后者为准
+        }
+        while (fields.size() < m_minColumns) fields.append(QString());
+    }
+
+    ZipArchiveReader m_zip;
+    WorkbookInfo m_workbook;
+    QIODevice* m_device = nullptr;
+    QStringList m_sharedStrings;
+    QVector<bool> m_dateStyles;
+    QXmlStreamReader m_xml;
+    qint64 m_total = 0;
+    int m_minColumns = 0;
+    int m_lastRow = 0;
+    int m_pendingRow = 0;        // 已读取、排在缺失行之后的行号 (0 表示没有)
+    QStringList m_pendingFields;
+};
+
+} // namespace
+
+// ============================================================================
+// XlsxStreamReader
+// ============================================================================
+bool XlsxStreamReader::read(const QString& path, const DataImportSettings& settings,
+                            const TextTableReader::BlockSink& sink, const CancellationToken* token,
+                            QString* errorMessage)
+{
+    WT_TRACE_SCOPE("Import::readXlsx");
+    WT_MEMORY_SCOPE(MemoryAccounting::DataModel);
+    SheetRowReader sheet(path);
+    if (!sheet.isOpen()) {
+        if (errorMessage) *errorMessage = "无法加载 .xlsx 文件";
+        return false;
+    }
+
+    ColumnarTableModel::RowBlock block;
+    QStringList header;
+    QStringList fields;
+    int row = 0;
+    while (!(token && token->isCancelled()) && sheet.next(row, fields)) {
+        // 按导入配置归类一行：表头、数据或跳过
+        if (settings.useHeader && row == settings.headerRow) header = fields;
+        else if (row >= settings.startRow) block.appendRow(fields);
+        if (block.rows >= kBatchRows) {
+            sink(block, header, sheet.pos(), sheet.total());
+            block = ColumnarTableModel::RowBlock();
+            header.clear();
+        }
+    }
+
+    if (sheet.hasError() && !(token && token->isCancelled())) {
+        if (errorMessage) *errorMessage = QString("工作表数据格式错误：%1").arg(sheet.errorString());
+        return false;
+    }
+    if (!(token && token->isCancelled())) sink(block, header, sheet.total(), sheet.total());
+    return true;
+}
+
+bool XlsxStreamReader::readRows(const QString& path, int maxRows, QList<QStringList>& rows,
+                                bool* complete, QString* errorMessage)
+{
+    WT_TRACE_SCOPE("Import::sampleXlsx");
+    rows.clear();
+    if (complete) *complete = false;
+    SheetRowReader sheet(path);
+    if (!sheet.isOpen()) {
+        if (errorMessage) *errorMessage = "无法加载 .xlsx 文件";
+        return false;
+    }
+
+    QStringList fields;
+    int row = 0;
+    while (rows.size() < maxRows && sheet.next(row, fields)) rows.append(fields);
+    const bool more = rows.size() >= maxRows && sheet.next(row, fields);
+    if (sheet.hasError()) {
+        if (errorMessage) *errorMessage = QString("工作表数据格式错误：%1").arg(sheet.errorString());
+        return false;
+    }
+    if (complete) *complete = !more;
+    return true;
+}
+
+bool XlsxStreamReader::isWorkbookFile(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) && file.read(4) == QByteArray("PK\x03\x04", 4);
+}
+
+// ============================================================================
+// XlsxStreamWriter
+// ============================================================================
+namespace {
+
+const char* const kContentTypes =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+    "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+    "<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+    "<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+    "<Override PartName=\"/xl/worksheets/sheet1.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+    "<Override PartName=\"/xl/styles.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml\"/>"
+    "</Types>";
+
+const char* const kRootRels =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+    "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument\" Target=\"xl/workbook.xml\"/>"
+    "</Relationships>";
+
+const char* const kWorkbook =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<workbook xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" "
+    "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">"
+    "<sheets><sheet name=\"Sheet1\" sheetId=\"1\" r:id=\"rId1\"/></sheets>"
+    "</workbook>";
+
+const char* const kWorkbookRels =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+    "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet1.xml\"/>"
+    "<Relationship Id=\"rId2\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles\" Target=\"styles.xml\"/>"
+    "</Relationships>";
+
+// 样式 0：默认；样式 1：表头 (粗体、F0F0F0 底纹、细边框、水平居中)
+const char* const kStyles =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<styleSheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+    "<fonts count=\"2\"><font><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+    "<font><b/><sz val=\"11\"/><name val=\"Calibri\"/></font></fonts>"
+    "<fills count=\"3\"><fill><patternFill patternType=\"none\"/></fill><fill><patternFill patternType=\"gray125\"/></fill>"
+    "<fill><patternFill patternType=\"solid\"><fgColor rgb=\"FFF0F0F0\"/><bgColor indexed=\"64\"/></patternFill></fill></fills>"
+    "<borders count=\"2\"><border><left/><right/><top/><bottom/><diagonal/></border>"
+    "<border><left style=\"thin\"><color auto=\"1\"/></left><right style=\"thin\"><color auto=\"1\"/></right>"
+    "<top style=\"thin\"><color auto=\"1\"/></top><bottom style=\"thin\"><color auto=\"1\"/></bottom><diagonal/></border></borders>"
+    "<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+    "<cellXfs count=\"2\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\"/>"
+    "<xf numFmtId=\"0\" fontId=\"1\" fillId=\"2\" borderId=\"1\" xfId=\"0\" applyFont=\"1\" applyFill=\"1\" applyBorder=\"1\" applyAlignment=\"1\">"
+    "<alignment horizontal=\"center\"/></xf></cellXfs>"
+    "<cellStyles count=\"1\"><cellStyle name=\"Normal\" xfId=\"0\" builtinId=\"0\"/></cellStyles>"
+    "</styleSheet>";
+
+// XML 转义 (去掉 XML 1.0 不允许的控制字符)
+QByteArray escapeXml(const QString& text)
+{
+    QString out;
+    out.reserve(text.size());
+    for (QChar c : text) {
+        const ushort u = c.unicode();
+        switch (u) {
+        case '&': out += QLatin1String("&amp;"); break;
+        case '<': out += QLatin1String("&lt;"); break;
+        case '>': out += QLatin1String("&gt;"); break;
+        case '"': out += QLatin1String("&quot;"); break;
+        default:
+            if (u >= 0x20 || u == '\t' || u == '\n' || u == '\r') out += c;
+            break;
+        }
+    }
+    return out.toUtf8();
+}
+
+// 首尾有空白或含换行的文本需保留空白
+bool needsPreserve(const QString& text)
+{
+    return !text.isEmpty() && (text.front().isSpace() || text.back().isSpace() || text.contains('\n'));
+}
+
+} // namespace
+
+XlsxStreamWriter::XlsxStreamWriter(const QString& fileName)
+    : m_zip(fileName)
+{
+}
+
+void XlsxStreamWriter::setColumnHidden(int column, bool hidden)
+{
+    if (hidden) m_hiddenColumns.insert(column);
+    else m_hiddenColumns.remove(column);
+}
+
+bool XlsxStreamWriter::open()
+{
+    m_ok = m_zip.open() &&
+           m_zip.addEntry("[Content_Types].xml", kContentTypes) &&
+           m_zip.addEntry("_rels/.rels", kRootRels) &&
+           m_zip.addEntry("xl/workbook.xml", kWorkbook) &&
+           m_zip.addEntry("xl/_rels/workbook.xml.rels", kWorkbookRels) &&
+           m_zip.addEntry("xl/styles.xml", kStyles) &&
+           m_zip.beginEntry("xl/worksheets/sheet1.xml");
+    if (!m_ok) return false;
+
+    m_row = 0;
+    m_buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+               "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" "
+               "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">";
+    if (!m_hiddenColumns.isEmpty()) {
+        QList<int> columns = m_hiddenColumns.values();
+        std::sort(columns.begin(), columns.end());
+        m_buffer += "<cols>";
+        for (int c : columns) {
+            m_buffer += "<col min=\"" + QByteArray::number(c + 1) + "\" max=\"" + QByteArray::number(c + 1) +
+                        "\" width=\"9.140625\" hidden=\"1\" customWidth=\"1\"/>";
+        }
+        m_buffer += "</cols>";
+    }
+    m_buffer += "<sheetData>";
+    return true;
+}
+
+QByteArray XlsxStreamWriter::cellReference() const
+{
+    QByteArray letters;
+    for (int c = m_column + 1; c > 0; c = (c - 1) / 26) letters.prepend(char('A' + (c - 1) % 26));
+    return letters + QByteArray::number(m_row);
+}
+
+void XlsxStreamWriter::beginRow(bool hidden)
+{
+    ++m_row;
+    m_column = 0;
+    m_buffer += "<row r=\"" + QByteArray::number(m_row) + (hidden ? "\" hidden=\"1\">" : "\">");
+}
+
+void XlsxStreamWriter::addHeader(const QString& text)
+{
+    m_buffer += "<c r=\"" + cellReference() + "\" s=\"1\" t=\"inlineStr\"><is><t" +
+                (needsPreserve(text) ? " xml:space=\"preserve\">" : ">") + escapeXml(text) + "</t></is></c>";
+    ++m_column;
+}
+
+void XlsxStreamWriter::addNumber(double value)
+{
+    if (qIsFinite(value)) {
+        m_buffer += "<c r=\"" + cellReference() + "\"><v>" +
+                    QByteArray::number(value, 'g', QLocale::FloatingPointShortest) + "</v></c>";
+    }
+    ++m_column;
+}
+
+void XlsxStreamWriter::addText(const QString& text)
+{
+    if (text.startsWith('=') && text.size() > 1) {
+        m_buffer += "<c r=\"" + cellReference() + "\"><f>" + escapeXml(text.mid(1)) + "</f></c>";
+    } else if (!text.isEmpty()) {
+        m_buffer += "<c r=\"" + cellReference() + "\" t=\"inlineStr\"><is><t" +
+                    (needsPreserve(text) ? " xml:space=\"preserve\">" : ">") + escapeXml(text) + "</t></is></c>";
+    }
+    ++m_column;
+}
+
+void XlsxStreamWriter::addBlank()
+{
+    ++m_column;
+}
+
+void XlsxStreamWriter::endRow()
+{
+    m_buffer += "</row>";
+    if (m_buffer.size() >= kFlushBytes) flush();
+}
+
+void XlsxStreamWriter::flush()
+{
+    if (m_ok && !m_buffer.isEmpty()) m_ok = m_zip.write(m_buffer);
+    m_buffer.clear();
+}
+
+bool XlsxStreamWriter::close()
+{
+    if (m_ok) {
+        m_buffer += "</sheetData></worksheet>";
+        flush();
+        m_ok = m_ok && m_zip.endEntry();
+    }
+    const bool closed = m_zip.close();
+    return m_ok && closed;
+}
@@ -0,0 +1,82 @@
+/*
+ * xlsxstream.h
+ * 文件作用: .xlsx 工作簿流式读写头文件
+ * 功能描述:
+ * 1. XlsxStreamReader：从 ZIP 条目直接拉取式解析 (QXmlStreamReader) 第一个工作表，逐行生成字段，
+ *    按批交给 TextTableReader::BlockSink；不建立整张表的单元格对象，内存只与共享字符串表及一批数据行有关。
+ *    可在后台线程运行并随时取消，进度按已解压的工作表字节计。
+ * 2. 单元格取值与原 QXlsx 读取一致：共享字符串 / 内联字符串 / 布尔 / 数值 (最短表示)；
+ *    数字格式为日期时间的单元格转换为 "yyyy-MM-dd hh:mm:ss" (支持 1900 与 1904 日期系统)。
+ * 3. XlsxStreamWriter：逐行写出工作表，数据边写边进入 ZIP 条目 (约 64 KB 一次)，内存与行数无关；
+ *    文本使用内联字符串，以 '=' 开头的文本写为公式；表头共用一个样式 (粗体、浅灰底纹、细边框、居中)。
+ * 4. [有界预览] readRows 只解析第一个工作表的前若干行 (导入对话框预览)，并报告是否已读到表尾；
+ *    isWorkbookFile 按 ZIP 文件头识别扩展名为 .xls 的 OOXML 工作簿，使其同样走流式读取。
+ */
+
+#ifndef XLSXSTREAM_H
+#define XLSXSTREAM_H
+
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+#include "texttablereader.h"
+#include "ziparchive.h"
+
+class XlsxStreamReader
+{
+public:
+    /**
+     * @brief 读取 .xlsx 文件的第一个工作表，按批交给 sink (可在后台线程调用)
+     * @param settings 导入配置 (只使用起始行与表头行)
+     * @param token 取消令牌 (可为空)
+     * @param errorMessage 输出：失败原因
+     * @return 文件是否为可读取的工作簿
+     */
+    static bool read(const QString& path, const DataImportSettings& settings,
+                     const TextTableReader::BlockSink& sink, const CancellationToken* token = nullptr,
+                     QString* errorMessage = nullptr);
+
+    /**
+     * @brief 读取第一个工作表的前 maxRows 行原始字段 (缺失的行按空行补齐，rows[i] 为第 i + 1 行)
+     * @param complete 输出：工作表是否已全部读入
+     * @return 文件是否为可读取的工作簿
+     */
+    static bool readRows(const QString& path, int maxRows, QList<QStringList>& rows,
+                         bool* complete = nullptr, QString* errorMessage = nullptr);
+
+    // 文件是否为 ZIP 封装的 OOXML 工作簿 (与扩展名无关)
+    static bool isWorkbookFile(const QString& path);
+};
+
+class XlsxStreamWriter
+{
+public:
+    explicit XlsxStreamWriter(const QString& fileName);
+
+    // 隐藏列 (从 0 开始，须在 open 之前设置)
+    void setColumnHidden(int column, bool hidden);
+
+    bool open();
+    // 行号自动递增 (从 1 开始)
+    void beginRow(bool hidden = false);
+    void addHeader(const QString& text);
+    void addNumber(double value);
+    void addText(const QString& text);
+    void addBlank();
+    void endRow();
+    // 写出其余部件并关闭文件；任一步写入失败时返回 false
+    bool close();
+
+private:
+    void flush();
+    QByteArray cellReference() const;
+
+    ZipArchiveWriter m_zip;
+    QSet<int> m_hiddenColumns;
+    QByteArray m_buffer;
+    int m_row = 0;
+    int m_column = 0;
+    bool m_ok = false;
+};
+
+#endif // XLSXSTREAM_H
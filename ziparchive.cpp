@@ -0,0 +1,633 @@
+/*
+ * ziparchive.cpp
+ * 文件作用: ZIP 归档流式读写实现文件
+ * 功能描述:
+ * 1. Inflater：按 RFC 1951 逐块解码 Deflate 数据，输入每次从磁盘读取 64 KB，输出写入 32 KB 环形窗口；
+ *    Huffman 解码先查 10 位快速表，更长的码字逐位解码。可以在任意符号处暂停，下次 read 时继续。
+ * 2. ZipEntryDevice：条目的只读设备，size() 为解压后长度，pos() 可用于显示进度；不支持随机定位。
+ * 3. 写入的时间戳取打开归档时的本地时间；文件名按 UTF-8 保存 (通用标志第 11 位)。
+ */
+
+#include "ziparchive.h"
+
+#include <QDateTime>
+#include <QtEndian>
+#include <array>
+#include <cstring>
+
+namespace {
+
+const quint32 kLocalHeaderSignature = 0x04034b50;
+const quint32 kCentralHeaderSignature = 0x02014b50;
+const quint32 kEndOfCentralDirSignature = 0x06054b50;
+const quint16 kUtf8NameFlag = 0x0800;
+
+// CRC-32 (ZIP 使用的多项式 0xEDB88320)；局部静态量的初始化是线程安全的，后台导入与导出可同时使用
+const quint32* crcTable()
+{
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> t{};
+        for (quint32 n = 0; n < 256; ++n) {
+            quint32 c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : (c >> 1);
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table.data();
+}
+
+quint32 updateCrc(quint32 crc, const char* data, qint64 size)
+{
+    const quint32* table = crcTable();
+    crc = ~crc;
+    for (qint64 i = 0; i < size; ++i) crc = table[(crc ^ uchar(data[i])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+quint16 readU16(const uchar* p) { return qFromLittleEndian<quint16>(p); }
+quint32 readU32(const uchar* p) { return qFromLittleEndian<quint32>(p); }
+
+void appendU16(QByteArray& out, quint16 v)
+{
+    uchar b[2];
+    qToLittleEndian(v, b);
+    out.append(reinterpret_cast<const char*>(b), 2);
+}
+
+void appendU32(QByteArray& out, quint32 v)
+{
+    uchar b[4];
+    qToLittleEndian(v, b);
+    out.append(reinterpret_cast<const char*>(b), 4);
+}
+
+// ============================================================================
+// Deflate 解码器
+// ============================================================================
+class Inflater
+{
+public:
+    Inflater(QIODevice* input, qint64 compressedSize)
+        : m_input(input), m_inputLeft(compressedSize)
+    {
+        m_in.resize(kInputChunk);
+    }
+
+    // 解压至多 maxlen 字节，返回实际字节数 (0 表示数据结束，-1 表示数据错误)
+    qint64 read(char* out, qint64 maxlen)
+    {
+        qint64 n = 0;
+        while (n < maxlen && !m_error) {
+            if (m_copyLen > 0) {
+                // 未完成的匹配复制
+                const uchar c = m_window[(m_windowPos - m_copyDist) & kWindowMask];
+                put(c);
+                out[n++] = char(c);
+                --m_copyLen;
+                continue;
+            }
+
+            if (m_state == State::Done) break;
+
+            if (m_state == State::Header) {
+                if (m_lastBlock) { m_state = State::Done; break; }
+                startBlock();
+                continue;
+            }
+
+            if (m_state == State::Stored) {
+                if (m_storedLeft == 0) { m_state = State::Header; continue; }
+                const int c = bits(8);
+                if (m_error) break;
+                put(uchar(c));
+                out[n++] = char(c);
+                --m_storedLeft;
+                continue;
+            }
+
+            // Huffman 块
+            const int symbol = decode(m_lengthCode);
+            if (symbol < 0) { m_error = true; break; }
+            if (symbol < 256) {
+                put(uchar(symbol));
+                out[n++] = char(symbol);
+            } else if (symbol == 256) {
+                m_state = State::Header;
+            } else {
+                static const quint16 lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                                       35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+                static const quint8 lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                       3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+                static const quint16 distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                                     257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                                     8193, 12289, 16385, 24577};
+                static const quint8 distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                                     7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+                const int ls = symbol - 257;
+                if (ls >= 29) { m_error = true; break; }
+                const int length = lengthBase[ls] + bits(lengthExtra[ls]);
+                const int ds = decode(m_distCode);
+                if (ds < 0 || ds >= 30) { m_error = true; break; }
+                const int dist = distBase[ds] + bits(distExtra[ds]);
+                if (m_error || dist > m_produced || dist > kWindowSize) { m_error = true; break; }
+                m_copyLen = length;
+                m_copyDist = dist;
+            }
+        }
+        return m_error ? -1 : n;
+    }
+
+    bool isFinished() const { return m_state == State::Done && m_copyLen == 0; }
+
+private:
+    static const int kWindowSize = 32768;
+    static const int kWindowMask = kWindowSize - 1;
+    static const int kInputChunk = 65536;
+    static const int kFastBits = 10;
+    static const int kMaxBits = 15;
+
+    struct Huffman {
+        quint16 count[kMaxBits + 1];
+        quint16 symbol[288];
+        quint16 fast[1 << kFastBits]; // (符号 << 4) | 码长，0 表示需逐位解码
+    };
+
+    enum class State { Header, Stored, Huffman, Done };
+
+    void put(uchar c)
+    {
+        m_window[m_windowPos & kWindowMask] = c;
+        ++m_windowPos;
+        if (m_produced < kWindowSize) ++m_produced;
+    }
+
+    bool refill()
+    {
+        if (m_inputLeft <= 0) return false;
+        const qint64 got = m_input->read(m_in.data(), qMin<qint64>(kInputChunk, m_inputLeft));
+        if (got <= 0) return false;
+        m_inputLeft -= got;
+        m_inPos = 0;
+        m_inLen = int(got);
+        return true;
+    }
+
+    bool fill(int n)
+    {
+        while (m_bitCount < n) {
+            if (m_inPos >= m_inLen && !refill()) return false;
+            m_bitBuf |= quint32(uchar(m_in[m_inPos++])) << m_bitCount;
+            m_bitCount += 8;
+        }
+        return true;
+    }
+
+    int bits(int n)
+    {
+        if (n == 0) return 0;
+        if (!fill(n)) { m_error = true; return 0; }
+        const int v = int(m_bitBuf & ((1u << n) - 1));
+        m_bitBuf >>= n;
+        m_bitCount -= n;
+        return v;
+    }
+
+    int decode(const Huffman& h)
+    {
+        fill(kFastBits); // 数据末尾不足时由下面的判断处理
+        if (m_bitCount > 0) {
+            const quint16 entry = h.fast[m_bitBuf & ((1u << kFastBits) - 1)];
+            const int len = entry & 15;
+            if (len > 0 && len <= m_bitCount) {
+                m_bitBuf >>= len;
+                m_bitCount -= len;
+                return entry >> 4;
+            }
+        }
+
+        // 逐位解码 (规范 Huffman 码)
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len <= kMaxBits; ++len) {
+            code |= bits(1);
+            if (m_error) return -1;
+            const int count = h.count[len];
+            if (code - count < first) return h.symbol[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    static bool build(Huffman& h, const quint8* lengths, int n)
+    {
+        std::memset(h.count, 0, sizeof(h.count));
+        std::memset(h.fast, 0, sizeof(h.fast));
+        for (int s = 0; s < n; ++s) ++h.count[lengths[s]];
+        h.count[0] = 0;
+
+        int left = 1;
+        for (int len = 1; len <= kMaxBits; ++len) {
+            left <<= 1;
+            left -= h.count[len];
+            if (left < 0) return false; // 码字超额
+        }
+
+        quint16 offsets[kMaxBits + 2];
+        offsets[1] = 0;
+        for (int len = 1; len <= kMaxBits; ++len) offsets[len + 1] = offsets[len] + h.count[len];
+        for (int s = 0; s < n; ++s) {
+            if (lengths[s]) h.symbol[offsets[lengths[s]]++] = quint16(s);
+        }
+
+        // 快速表：码字按位反转后 (Deflate 码字高位先入流) 填满所有后缀
+        int nextCode[kMaxBits + 1];
+        int code = 0;
+        for (int len = 1; len <= kMaxBits; ++len) {
+            nextCode[len] = code;
+            code = (code + h.count[len]) << 1;
+        }
+        for (int s = 0; s < n; ++s) {
+            const int len = lengths[s];
+            if (len == 0) continue;
+            const int c = nextCode[len]++;
+            if (len > kFastBits) continue;
+            int reversed = 0;
+            for (int i = 0; i < len; ++i) reversed |= ((c >> i) & 1) << (len - 1 - i);
+            for (int k = reversed; k < (1 << kFastBits); k += (1 << len)) h.fast[k] = quint16((s << 4) | len);
+        }
+        return true;
+    }
+
+    void startBlock()
+    {
+        m_lastBlock = bits(1) != 0;
+        const int type = bits(2);
+        if (m_error) return;
+
+        if (type == 0) {
+            // 存储块：丢弃当前字节的剩余位，读取 LEN / NLEN
+            bits(m_bitCount & 7);
+            const int len = bits(16);
+            const int nlen = bits(16);
+            if (m_error || len != (~nlen & 0xFFFF)) { m_error = true; return; }
+            m_storedLeft = len;
+            m_state = State::Stored;
+        } else if (type == 1) {
+            quint8 lengths[320];
+            int s = 0;
+            for (; s < 144; ++s) lengths[s] = 8;
+            for (; s < 256; ++s) lengths[s] = 9;
+            for (; s < 280; ++s) lengths[s] = 7;
+            for (; s < 288; ++s) lengths[s] = 8;
+            build(m_lengthCode, lengths, 288);
+            for (s = 0; s < 30; ++s) lengths[s] = 5;
+            build(m_distCode, lengths, 30);
+            m_state = State::Huffman;
+        } else if (type == 2) {
+            readDynamicTables();
+            if (!m_error) m_state = State::Huffman;
+        } else {
+            m_error = true;
+        }
+    }
+
+    void readDynamicTables()
+    {
+        static const quint8 order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        const int nlen = bits(5) + 257;
+        const int ndist = bits(5) + 1;
+        const int ncode = bits(4) + 4;
+        if (m_error || nlen > 286 || ndist > 30) { m_error = true; return; }
+
+        quint8 lengths[320] = {0};
+        for (int i = 0; i < ncode; ++i) lengths[order[i]] = quint8(bits(3));
+        Huffman codeLengths;
+        if (m_error || !build(codeLengths, lengths, 19)) { m_error = true; return; }
+
+        std::memset(lengths, 0, sizeof(lengths));
+        int index = 0;
+        while (index < nlen + ndist) {
+            int symbol = decode(codeLengths);
+            if (symbol < 0) { m_error = true; return; }
+            if (symbol < 16) {
+                lengths[index++] = quint8(symbol);
+                continue;
+            }
+            int value = 0, repeat = 0;
+            if (symbol == 16) {
+                if (index == 0) { m_error = true; return; }
+                value = lengths[index - 1];
+                repeat = 3 + bits(2);
+            } else if (symbol == 17) {
+                repeat = 3 + bits(3);
+            } else {
+                repeat = 11 + bits(7);
+            }
+            if (m_error || index + repeat > nlen + ndist) { m_error = true; return; }
+            while (repeat--) lengths[index++] = quint8(value);
+        }
+        if (lengths[256] == 0) { m_error = true; return; } // 必须有块结束符
+        if (!build(m_lengthCode, lengths, nlen) || !build(m_distCode, lengths + nlen, ndist)) m_error = true;
+    }
+
+    QIODevice* m_input;
+    qint64 m_inputLeft;
+    QByteArray m_in;
+    int m_inPos = 0;
+    int m_inLen = 0;
+    quint32 m_bitBuf = 0;
+    int m_bitCount = 0;
+
+    uchar m_window[kWindowSize];
+    quint32 m_windowPos = 0;
+    int m_produced = 0; // 已输出字节数 (上限为窗口大小，用于检查距离)
+
+    State m_state = State::Header;
+    bool m_lastBlock = false;
+    bool m_error = false;
+    int m_storedLeft = 0;
+    int m_copyLen = 0;
+    int m_copyDist = 0;
+    Huffman m_lengthCode;
+    Huffman m_distCode;
+};
+
+// ============================================================================
+// 条目读取设备
+// ============================================================================
+class ZipEntryDevice : public QIODevice
+{
+public:
+    ZipEntryDevice(const QString& archive, qint64 dataOffset, quint16 method,
+                   quint32 compressedSize, quint32 uncompressedSize)
+        : m_file(archive), m_method(method), m_compressedLeft(compressedSize), m_size(uncompressedSize)
+    {
+        if (m_file.open(QIODevice::ReadOnly) && m_file.seek(dataOffset)) {
+            if (m_method == 8) m_inflater = new Inflater(&m_file, compressedSize);
+            open(QIODevice::ReadOnly);
+        }
+    }
+
+    ~ZipEntryDevice() override { delete m_inflater; }
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_size; }
+
+protected:
+    qint64 readData(char* data, qint64 maxlen) override
+    {
+        maxlen = qMin<qint64>(maxlen, m_size - m_produced);
+        if (maxlen <= 0) return 0;
+
+        qint64 got = -1;
+        if (m_method == 0) {
+            got = m_file.read(data, qMin<qint64>(maxlen, m_compressedLeft));
+            if (got > 0) m_compressedLeft -= got;
+        } else if (m_inflater) {
+            got = m_inflater->read(data, maxlen);
+            if (got == 0) got = -1; // 解压数据短于目录记录的长度
+        }
+        if (got > 0) m_produced += got;
+        return got;
+    }
+
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    QFile m_file;
+    quint16 m_method;
+    qint64 m_compressedLeft;
+    qint64 m_size;
+    qint64 m_produced = 0;
+    Inflater* m_inflater = nullptr;
+};
+
+} // namespace
+
+// ============================================================================
+// ZipArchiveReader
+// ============================================================================
+ZipArchiveReader::ZipArchiveReader(const QString& fileName)
+    : m_fileName(fileName)
+{
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly)) m_valid = readCentralDirectory(file);
+}
+
+bool ZipArchiveReader::readCentralDirectory(QFile& file)
+{
+    // 目录结束记录位于文件末尾 22 字节 + 至多 64 KB 注释之内
+    const qint64 size = file.size();
+    const qint64 tail = qMin<qint64>(size, 22 + 65535);
+    if (tail < 22 || !file.seek(size - tail)) return false;
+    const QByteArray end = file.read(tail);
+    const uchar* e = reinterpret_cast<const uchar*>(end.constData());
+
+    int eocd = -1;
+    for (int i = int(end.size()) - 22; i >= 0; --i) {
+        if (readU32(e + i) == kEndOfCentralDirSignature) { eocd = i; break; }
+    }
+    if (eocd < 0) return false;
+
+    const quint16 count = readU16(e + eocd + 10);
+    const quint32 dirSize = readU32(e + eocd + 12);
+    const quint32 dirOffset = readU32(e + eocd + 16);
+    if (dirOffset == 0xFFFFFFFFu || qint64(dirOffset) + dirSize > size || !file.seek(dirOffset)) return false;
+
+    const QByteArray dir = file.read(dirSize);
+    if (dir.size() != qint64(dirSize)) return false;
+    const uchar* d = reinterpret_cast<const uchar*>(dir.constData());
+
+    qint64 pos = 0;
+    for (int i = 0; i < count; ++i) {
+        if (pos + 46 > dir.size() || readU32(d + pos) != kCentralHeaderSignature) return false;
+        const quint16 flags = readU16(d + pos + 8);
+        Entry entry;
+        entry.method = readU16(d + pos + 10);
+        entry.crc = readU32(d + pos + 16);
+        entry.compressedSize = readU32(d + pos + 20);
+        entry.uncompressedSize = readU32(d + pos + 24);
+        const quint16 nameLen = readU16(d + pos + 28);
+        const quint16 extraLen = readU16(d + pos + 30);
+        const quint16 commentLen = readU16(d + pos + 32);
+        entry.localHeaderOffset = readU32(d + pos + 42);
+        if (pos + 46 + nameLen > dir.size()) return false;
+
+        const char* name = dir.constData() + pos + 46;
+        const QString entryName = (flags & kUtf8NameFlag) ? QString::fromUtf8(name, nameLen)
+                                                          : QString::fromLatin1(name, nameLen);
+        m_entries.insert(entryName, entry);
+        pos += 46 + nameLen + extraLen + commentLen;
+    }
+    return true;
+}
+
+QIODevice* ZipArchiveReader::openEntry(const QString& name) const
+{
+    auto it = m_entries.constFind(name);
+    if (it == m_entries.constEnd()) return nullptr;
+    const Entry& entry = it.value();
+    if (entry.method != 0 && entry.method != 8) return nullptr;
+    if (entry.compressedSize == 0xFFFFFFFFu || entry.uncompressedSize == 0xFFFFFFFFu) return nullptr; // ZIP64
+
+    // 本地文件头之后才是数据 (本地头中的文件名与扩展字段长度可能与中央目录不同)
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(entry.localHeaderOffset)) return nullptr;
+    const QByteArray header = file.read(30);
+    if (header.size() != 30) return nullptr;
+    const uchar* h = reinterpret_cast<const uchar*>(header.constData());
+    if (readU32(h) != kLocalHeaderSignature) return nullptr;
+    const qint64 dataOffset = qint64(entry.localHeaderOffset) + 30 + readU16(h + 26) + readU16(h + 28);
+    file.close();
+
+    ZipEntryDevice* device = new ZipEntryDevice(m_fileName, dataOffset, entry.method,
+                                                entry.compressedSize, entry.uncompressedSize);
+    if (!device->isOpen()) {
+        delete device;
+        return nullptr;
+    }
+    return device;
+}
+
+QByteArray ZipArchiveReader::readEntry(const QString& name) const
+{
+    QIODevice* device = openEntry(name);
+    if (!device) return QByteArray();
+    const QByteArray data = device->readAll();
+    delete device;
+    return data;
+}
+
+// ============================================================================
+// ZipArchiveWriter
+// ============================================================================
+ZipArchiveWriter::ZipArchiveWriter(const QString& fileName)
+    : m_file(fileName)
+{
+}
+
+ZipArchiveWriter::~ZipArchiveWriter()
+{
+    if (m_file.isOpen()) m_file.close();
+}
+
+bool ZipArchiveWriter::open()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    const QDate date = now.date();
+    const QTime time = now.time();
+    m_dosDate = quint16(((qMax(date.year(), 1980) - 1980) << 9) | (date.month() << 5) | date.day());
+    m_dosTime = quint16((time.hour() << 11) | (time.minute() << 5) | (time.second() / 2));
+
+    m_written.clear();
+    m_inEntry = false;
+    m_ok = m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    return m_ok;
+}
+
+bool ZipArchiveWriter::beginEntry(const QString& name)
+{
+    if (!m_ok || m_inEntry) return false;
+    const qint64 offset = m_file.pos();
+    if (offset > 0xFFFFFFFFll) { m_ok = false; return false; }
+
+    m_current = Written();
+    m_current.name = name.toUtf8();
+    m_current.offset = quint32(offset);
+
+    // CRC 与长度先写 0，endEntry 时回填
+    QByteArray header;
+    appendU32(header, kLocalHeaderSignature);
+    appendU16(header, 20);            // 解压所需版本
+    appendU16(header, kUtf8NameFlag);
+    appendU16(header, 0);             // 存储
+    appendU16(header, m_dosTime);
+    appendU16(header, m_dosDate);
+    appendU32(header, 0);
+    appendU32(header, 0);
+    appendU32(header, 0);
+    appendU16(header, quint16(m_current.name.size()));
+    appendU16(header, 0);
+    header.append(m_current.name);
+
+    m_ok = (m_file.write(header) == header.size());
+    m_inEntry = m_ok;
+    return m_ok;
+}
+
+bool ZipArchiveWriter::write(const char* data, qint64 size)
+{
+    if (!m_ok || !m_inEntry) return false;
+    if (qint64(m_current.size) + size > 0xFFFFFFFFll) { m_ok = false; return false; }
+    m_current.crc = updateCrc(m_current.crc, data, size);
+    m_current.size += quint32(size);
+    m_ok = (m_file.write(data, size) == size);
+    return m_ok;
+}
+
+bool ZipArchiveWriter::endEntry()
+{
+    if (!m_ok || !m_inEntry) return false;
+    m_inEntry = false;
+
+    const qint64 end = m_file.pos();
+    QByteArray fields;
+    appendU32(fields, m_current.crc);
+    appendU32(fields, m_current.size);
+    appendU32(fields, m_current.size);
+    m_ok = m_file.seek(qint64(m_current.offset) + 14) && m_file.write(fields) == fields.size() && m_file.seek(end);
+    if (m_ok) m_written.append(m_current);
+    return m_ok;
+}
+
+bool ZipArchiveWriter::addEntry(const QString& name, const QByteArray& data)
+{
+    return beginEntry(name) && write(data) && endEntry();
+}
+
+bool ZipArchiveWriter::close()
+{
+    if (!m_file.isOpen()) return false;
+    if (m_inEntry) endEntry();
+
+    if (m_ok) {
+        const qint64 dirOffset = m_file.pos();
+        QByteArray dir;
+        for (const Written& w : m_written) {
+            appendU32(dir, kCentralHeaderSignature);
+            appendU16(dir, 20);           // 创建版本
+            appendU16(dir, 20);           // 解压所需版本
+            appendU16(dir, kUtf8NameFlag);
+            appendU16(dir, 0);
+            appendU16(dir, m_dosTime);
+            appendU16(dir, m_dosDate);
+            appendU32(dir, w.crc);
+            appendU32(dir, w.size);
+            appendU32(dir, w.size);
+            appendU16(dir, quint16(w.name.size()));
+            appendU16(dir, 0);            // 扩展字段
+            appendU16(dir, 0);            // 注释
+            appendU16(dir, 0);            // 磁盘号
+            appendU16(dir, 0);            // 内部属性
+            appendU32(dir, 0);            // 外部属性
+            appendU32(dir, w.offset);
+            dir.append(w.name);
+        }
+        QByteArray end;
+        appendU32(end, kEndOfCentralDirSignature);
+        appendU16(end, 0);
+        appendU16(end, 0);
+        appendU16(end, quint16(m_written.size()));
+        appendU16(end, quint16(m_written.size()));
+        appendU32(end, quint32(dir.size()));
+        appendU32(end, quint32(dirOffset));
+        appendU16(end, 0);
+        m_ok = dirOffset <= 0xFFFFFFFFll && m_written.size() <= 0xFFFF &&
+               m_file.write(dir) == dir.size() && m_file.write(end) == end.size();
+    }
+    m_file.close();
+    return m_ok;
+}
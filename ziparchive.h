@@ -0,0 +1,88 @@
+/*
+ * ziparchive.h
+ * 文件作用: ZIP 归档流式读写头文件 (供 .xlsx 等 OOXML 文件使用)
+ * 功能描述:
+ * 1. ZipArchiveReader：读取中央目录，按名称打开条目。openEntry 返回只读设备 (只能顺序读取)，
+ *    读取时才从磁盘取压缩数据并解压 (Deflate 解码器仅保留 32 KB 窗口)，内存占用与条目大小无关，
+ *    可直接交给 QXmlStreamReader 逐元素解析。
+ * 2. ZipArchiveWriter：逐条目写出，条目数据可分多次追加；条目以存储方式 (不压缩) 写入，
+ *    CRC 与长度在条目结束时回填到本地文件头，无需在内存中保留条目内容。
+ * 3. 仅支持单卷、非 ZIP64 的归档 (单个条目与整个归档均小于 4 GB)，条目压缩方式支持存储 (0) 与 Deflate (8)。
+ */
+
+#ifndef ZIPARCHIVE_H
+#define ZIPARCHIVE_H
+
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class ZipArchiveReader
+{
+public:
+    explicit ZipArchiveReader(const QString& fileName);
+
+    // 中央目录是否读取成功
+    bool isValid() const { return m_valid; }
+    QStringList entryNames() const { return m_entries.keys(); }
+    bool contains(const QString& name) const { return m_entries.contains(name); }
+
+    // 以流方式打开条目 (调用方负责删除返回的设备；条目不存在或格式不支持时返回 nullptr)
+    QIODevice* openEntry(const QString& name) const;
+    // 读取整个条目 (只用于较小的条目)
+    QByteArray readEntry(const QString& name) const;
+
+private:
+    struct Entry {
+        quint16 method = 0;
+        quint32 crc = 0;
+        quint32 compressedSize = 0;
+        quint32 uncompressedSize = 0;
+        quint32 localHeaderOffset = 0;
+    };
+
+    bool readCentralDirectory(QFile& file);
+
+    QString m_fileName;
+    QHash<QString, Entry> m_entries;
+    bool m_valid = false;
+};
+
+class ZipArchiveWriter
+{
+public:
+    explicit ZipArchiveWriter(const QString& fileName);
+    ~ZipArchiveWriter();
+
+    bool open();
+    // 开始一个条目，之后以 write 追加数据，endEntry 结束
+    bool beginEntry(const QString& name);
+    bool write(const char* data, qint64 size);
+    bool write(const QByteArray& data) { return write(data.constData(), data.size()); }
+    bool endEntry();
+    // 写入一个完整的条目
+    bool addEntry(const QString& name, const QByteArray& data);
+    // 写出中央目录并关闭文件；此前任一步失败时返回 false
+    bool close();
+
+private:
+    struct Written {
+        QByteArray name;
+        quint32 crc = 0;
+        quint32 size = 0;
+        quint32 offset = 0;
+    };
+
+    QFile m_file;
+    QVector<Written> m_written;
+    Written m_current;
+    bool m_inEntry = false;
+    bool m_ok = true;
+    quint16 m_dosTime = 0;
+    quint16 m_dosDate = 0;
+};
+
+#endif // ZIPARCHIVE_H